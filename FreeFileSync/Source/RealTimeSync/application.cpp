@@ -47,7 +47,7 @@ bool Application::OnInit()
         std::cerr << utfTo<std::string>(titleFmt + SPACED_DASH + msg) << '\n';
     };
 
-    try { imageResourcesInit(fff::getResourceDirPf() + Zstr("Icons.zip")); }
+    try { imageResourcesInit(fff::getResourceDirPf() + Zstr("Icons.zip"), fff::getConfigDirPathPf() + Zstr("Icons.db")); }
     catch (const FileError& e) { logInitError(e.toString()); }
     //errors are not really critical in this context
 
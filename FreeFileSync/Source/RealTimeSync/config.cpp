@@ -68,6 +68,8 @@ void readConfig(const XmlIn& in, XmlRealConfig& cfg, int formatVer)
     in["Directories"](cfg.directories);
     in["Delay"      ](cfg.delay);
     in["Commandline"](cfg.commandline);
+    if (in["PersistentJournal"]) //optional: expert setting
+        in["PersistentJournal"].attribute("Enabled", cfg.persistentJournal);
 
     //TODO: remove if clause after migration! 2020-04-14
     if (formatVer < 2)
@@ -82,6 +84,7 @@ void writeConfig(const XmlRealConfig& cfg, XmlOut& out)
     out["Directories"](cfg.directories);
     out["Delay"      ](cfg.delay);
     out["Commandline"](cfg.commandline);
+    out["PersistentJournal"].attribute("Enabled", cfg.persistentJournal);
 }
 }
 
@@ -18,6 +18,7 @@ struct XmlRealConfig
     std::vector<Zstring> directories;
     Zstring commandline;
     unsigned int delay = 10;
+    bool persistentJournal = false; //keep changes not yet synced across restarts and reboots (no GUI option)
 };
 
 void readConfig(const Zstring& filePath, XmlRealConfig& config, std::wstring& warningMsg); //throw FileError
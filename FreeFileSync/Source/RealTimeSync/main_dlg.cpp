@@ -346,6 +346,8 @@ void MainDialog::setConfiguration(const XmlRealConfig& cfg)
 
     m_textCtrlCommand->SetValue(utfTo<wxString>(cfg.commandline));
     m_spinCtrlDelay  ->SetValue(static_cast<int>(cfg.delay));
+
+    persistentJournal_ = cfg.persistentJournal; //no GUI option
 }
 
 
@@ -360,6 +362,7 @@ XmlRealConfig MainDialog::getConfiguration()
 
     output.commandline = utfTo<Zstring>(m_textCtrlCommand->GetValue());
     output.delay       = m_spinCtrlDelay->GetValue();
+    output.persistentJournal = persistentJournal_;
 
     return output;
 }
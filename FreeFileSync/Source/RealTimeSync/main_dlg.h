@@ -66,6 +66,8 @@ private:
 
     Zstring folderLastSelected_;
 
+    bool persistentJournal_ = false; //expert setting: preserve when saving config
+
     zen::AsyncGuiQueue guiQueue_; //schedule and run long-running tasks asynchronously, but process results on GUI queue
 
     const zen::SharedRef<std::function<void()>> onBeforeSystemShutdownCookie_ = zen::makeSharedRef<std::function<void()>>([this] { onBeforeSystemShutdown(); });
@@ -9,21 +9,37 @@
 #include <zen/dir_watcher.h>
 #include <zen/thread.h>
 #include <zen/resolve_path.h>
+#include <zen/file_io.h>
+#include <zen/scope_guard.h>
+#include <fcntl.h> //open
+#include <sys/sysmacros.h> //major, minor
 //#include "../library/db_file.h"     //SYNC_DB_FILE_ENDING -> complete file too much of a dependency; file ending too little to decouple into single header
 //#include "../library/lock_holder.h" //LOCK_FILE_ENDING
 //TEMP_FILE_ENDING
 
 using namespace zen;
+using fff::ChangeJournal;
 
 
 namespace
 {
 constexpr std::chrono::seconds FOLDER_EXISTENCE_CHECK_INTERVAL(1);
 
+using WaitForEventsCb = std::function<void(const std::vector<int>& fds, std::chrono::milliseconds timeout)>;
+
+
+//wait for UI events, fds or until "waitUntil" - whatever comes first
+void waitIdle(const WaitForEventsCb& waitForEvents, const std::vector<int>& fds, std::chrono::steady_clock::time_point waitUntil) //throw X
+{
+    const auto now = std::chrono::steady_clock::now();
+    waitForEvents(fds, now < waitUntil ? std::chrono::ceil<std::chrono::milliseconds>(waitUntil - now) : std::chrono::milliseconds(0)); //throw X
+}
+
 
 //wait until all directories become available (again) + logs in network share
 std::set<Zstring, LessNativePath> waitForMissingDirs(const std::vector<Zstring>& folderPathPhrases, //throw FileError
-                                                     const std::function<void(const Zstring& folderPath)>& requestUiUpdate, std::chrono::milliseconds cbInterval)
+                                                     const std::function<void(const Zstring& folderPath)>& requestUiUpdate,
+                                                     const WaitForEventsCb& waitForEvents, std::chrono::milliseconds cbInterval)
 {
     //early failure! check for unsupported folder paths:
     for (const char* protoName : {"ftp", "sftp", "mtp", "gdrive"})
@@ -80,7 +96,7 @@ std::set<Zstring, LessNativePath> waitForMissingDirs(const std::vector<Zstring>&
                 for (auto now = std::chrono::steady_clock::now(); now < delayUntil; now = std::chrono::steady_clock::now())
                 {
                     requestUiUpdate(folderPath); //throw X
-                    std::this_thread::sleep_for(cbInterval);
+                    waitIdle(waitForEvents, {}, delayUntil); //throw X
                 }
 
                 std::future<bool> folderAvailable = runAsync([folderPath]
@@ -100,16 +116,16 @@ std::set<Zstring, LessNativePath> waitForMissingDirs(const std::vector<Zstring>&
 }
 
 
-//wait until changes are detected or if a directory is not available (anymore)
-DirWatcher::Change waitForChanges(const std::set<Zstring, LessNativePath>& folderPaths, //throw FileError
-                                  const std::function<void(bool readyForSync)>& requestUiUpdate, std::chrono::milliseconds cbInterval)
+using FolderWatches = std::vector<std::pair<Zstring /*folderPath*/, std::unique_ptr<DirWatcher>>>;
+
+//keep watching while the command is running => the change journal doesn't miss changes between command executions
+std::optional<DirWatcher::Change> installWatches(FolderWatches& watches, const std::set<Zstring, LessNativePath>& folderPaths) //throw FileError
 {
     assert(std::all_of(folderPaths.begin(), folderPaths.end(), [](const Zstring& folderPath) { return dirAvailable(folderPath); }));
-    if (folderPaths.empty()) //pathological case, but we have to check else this function will wait endlessly
+    if (folderPaths.empty()) //pathological case, but we have to check else waitForChanges() will wait endlessly
         throw FileError(_("A folder input field is empty.")); //should have been checked by caller!
 
-    std::vector<std::pair<Zstring, std::unique_ptr<DirWatcher>>> watches;
-
+    watches.clear();
     for (const Zstring& folderPath : folderPaths)
         try
         {
@@ -118,17 +134,84 @@ DirWatcher::Change waitForChanges(const std::set<Zstring, LessNativePath>& folde
         catch (FileError&)
         {
             if (!dirAvailable(folderPath)) //folder not existing or can't access
-                return {DirWatcher::ChangeType::baseFolderUnavailable, folderPath};
+                return DirWatcher::Change{DirWatcher::ChangeType::baseFolderUnavailable, folderPath};
+            throw;
+        }
+    return {};
+}
+
+
+//report changes seen since last call, or return if a directory is not available (anymore)
+std::optional<DirWatcher::Change> fetchChanges(FolderWatches& watches, bool checkDirNow, //throw FileError
+                                               const std::function<void(const DirWatcher::Change& change)>& onChange,
+                                               const std::function<void()>& requestUiUpdate, std::chrono::milliseconds cbInterval)
+{
+    auto fetchRelevantChanges = [&](DirWatcher& watcher) //throw FileError
+    {
+        std::vector<DirWatcher::Change> changes = watcher.fetchChanges(requestUiUpdate, cbInterval); //throw FileError
+
+        std::erase_if(changes, [](const DirWatcher::Change& e)
+        {
+            return
+                endsWith(e.itemPath, Zstr(".ffs_tmp"))  || //sync.8ea2.ffs_tmp
+                endsWith(e.itemPath, Zstr(".ffs_lock")) || //sync.ffs_lock, sync.Del.ffs_lock
+                endsWith(e.itemPath, Zstr(".ffs_db"));     //sync.ffs_db
+            //no need to ignore temporary recycle bin directory: this must be caused by a file deletion anyway
+        });
+        return changes;
+    };
+
+    for (auto& [folderPath, watcher] : watches)
+    {
+        //IMPORTANT CHECK: DirWatcher has problems detecting removal of top watched directories!
+        if (checkDirNow)
+            if (!dirAvailable(folderPath)) //catch errors related to directory removal, e.g. ERROR_NETNAME_DELETED
+                return DirWatcher::Change{DirWatcher::ChangeType::baseFolderUnavailable, folderPath};
+        try
+        {
+            std::vector<DirWatcher::Change> changes = fetchRelevantChanges(*watcher); //throw FileError
+            if (!changes.empty() && !watcher->watchesNewSubfolders())
+            {
+                //Linux: newly added subdirectories are not watched => reinstall watch; do so *before* removing the old one to not miss changes in between
+                auto watcherNew = std::make_unique<DirWatcher>(folderPath); //throw FileError
+                append(changes, fetchRelevantChanges(*watcher)); //throw FileError
+                watcher = std::move(watcherNew);
+            }
+
+            //give precedence to ChangeType::baseFolderUnavailable
+            for (const DirWatcher::Change& change : changes)
+                if (change.type == DirWatcher::ChangeType::baseFolderUnavailable)
+                    return change;
+
+            for (const DirWatcher::Change& change : changes)
+                onChange(change);
+        }
+        catch (FileError&)
+        {
+            if (!dirAvailable(folderPath)) //a benign(?) race condition with FileError
+                return DirWatcher::Change{DirWatcher::ChangeType::baseFolderUnavailable, folderPath};
             throw;
         }
+    }
+    return {};
+}
+
 
+//wait until a directory is not available (anymore), report detected changes meanwhile
+DirWatcher::Change waitForChanges(FolderWatches& watches, //throw FileError
+                                  const std::function<void(const DirWatcher::Change& change)>& onChange,
+                                  const std::function<void(bool readyForSync)>& requestUiUpdate,
+                                  const WaitForEventsCb& waitForEvents,
+                                  const std::chrono::steady_clock::time_point& nextExecTime, //updated by onChange()
+                                  std::chrono::milliseconds cbInterval)
+{
     auto lastCheckTime = std::chrono::steady_clock::now();
     for (;;)
     {
         const bool checkDirNow = [&] //checking once per sec should suffice
         {
             const auto now = std::chrono::steady_clock::now();
-            if (now > lastCheckTime + FOLDER_EXISTENCE_CHECK_INTERVAL)
+            if (now >= lastCheckTime + FOLDER_EXISTENCE_CHECK_INTERVAL)
             {
                 lastCheckTime = now;
                 return true;
@@ -136,45 +219,118 @@ DirWatcher::Change waitForChanges(const std::set<Zstring, LessNativePath>& folde
             return false;
         }();
 
-        for (const auto& [folderPath, watcher] : watches)
-        {
-            //IMPORTANT CHECK: DirWatcher has problems detecting removal of top watched directories!
-            if (checkDirNow)
-                if (!dirAvailable(folderPath)) //catch errors related to directory removal, e.g. ERROR_NETNAME_DELETED
-                    return {DirWatcher::ChangeType::baseFolderUnavailable, folderPath};
-            try
-            {
-                std::vector<DirWatcher::Change> changes = watcher->fetchChanges([&] { requestUiUpdate(false /*readyForSync*/); /*throw X*/ },
-                                                                                cbInterval); //throw FileError
+        bool changesSeen = false;
+        auto onChangeSeen = [&](const DirWatcher::Change& change) { changesSeen = true; onChange(change); };
 
-                //give precedence to ChangeType::baseFolderUnavailable
-                for (const DirWatcher::Change& change : changes)
-                    if (change.type == DirWatcher::ChangeType::baseFolderUnavailable)
-                        return change;
+        if (std::optional<DirWatcher::Change> folderUnavailable = fetchChanges(watches, checkDirNow, onChangeSeen,
+                                                                               [&] { requestUiUpdate(false /*readyForSync*/); /*throw X*/ }, cbInterval)) //throw FileError
+            return *folderUnavailable;
 
-                std::erase_if(changes, [](const DirWatcher::Change& e)
-                {
-                    return
-                        endsWith(e.itemPath, Zstr(".ffs_tmp"))  || //sync.8ea2.ffs_tmp
-                        endsWith(e.itemPath, Zstr(".ffs_lock")) || //sync.ffs_lock, sync.Del.ffs_lock
-                        endsWith(e.itemPath, Zstr(".ffs_db"));     //sync.ffs_db
-                    //no need to ignore temporary recycle bin directory: this must be caused by a file deletion anyway
-                });
+        requestUiUpdate(true /*readyForSync*/); //throw X: may start sync at this presumably idle time
 
-                if (!changes.empty())
-                    return changes[0];
-            }
-            catch (FileError&)
-            {
-                if (!dirAvailable(folderPath)) //a benign(?) race condition with FileError
-                    return {DirWatcher::ChangeType::baseFolderUnavailable, folderPath};
-                throw;
-            }
-        }
+        //sleep until next change, UI event, folder existence check or command execution
+        auto waitUntil = std::min(lastCheckTime + FOLDER_EXISTENCE_CHECK_INTERVAL, nextExecTime);
+        std::vector<int> fds;
 
-        std::this_thread::sleep_for(cbInterval);
-        requestUiUpdate(true /*readyForSync*/); //throw X: may start sync at this presumably idle time
+        if (changesSeen && !std::all_of(watches.begin(), watches.end(), [](const auto& item) { return item.second->watchesNewSubfolders(); }))
+            //inotify: changes mean a costly watch reinstall => don't wake up for each change of a burst
+            waitUntil = std::min(waitUntil, std::chrono::steady_clock::now() + cbInterval);
+        else
+            for (const auto& [folderPath, watcher] : watches)
+                fds.push_back(watcher->getNotifyHandle());
+
+        waitIdle(waitForEvents, fds, waitUntil); //throw X
+    }
+}
+
+
+/*  persistent journal: changes made while RealTimeSync is not running are unknown
+    => valid only if the volumes weren't written to since: compare their lifetime write counters (ext4 only, survive reboots)
+    => flush pending writes first (syncfs), or they'd be counted only *after* the generation was recorded       */
+Zstring getVolumeGeneration(const Zstring& folderPath) //throw FileError; empty if not available
+{
+    const int fdDir = ::open(folderPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fdDir == -1)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot open directory %x."), L"%x", fmtPath(folderPath)), "open");
+    ZEN_ON_SCOPE_EXIT(::close(fdDir));
+
+    if (::syncfs(fdDir) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(folderPath)), "syncfs");
+
+    struct stat folderInfo = {};
+    if (::fstat(fdDir, &folderInfo) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(folderPath)), "fstat");
+
+    //e.g. /sys/dev/block/8:1 -> ../../devices/pci0000:00/.../block/sda/sda1
+    const std::string devLinkPath = "/sys/dev/block/" + numberTo<std::string>(major(folderInfo.st_dev)) + ':' + numberTo<std::string>(minor(folderInfo.st_dev));
+    char devPath[PATH_MAX] = {};
+    if (!::realpath(devLinkPath.c_str(), devPath))
+        return Zstring(); //not a block device (e.g. network share, Btrfs)
+
+    const Zstring counterPath = Zstr("/sys/fs/ext4/") + afterLast(Zstring(devPath), FILE_NAME_SEPARATOR, IfNotFoundReturn::all) + Zstr("/lifetime_write_kbytes");
+    if (!fileAvailable(counterPath))
+        return Zstring(); //not ext4
+
+    const std::string writtenKB = trimCpy(getFileContent(counterPath, nullptr /*notifyUnbufferedIO*/)); //throw FileError
+    if (writtenKB.empty())
+        return Zstring();
+
+    return numberTo<Zstring>(folderInfo.st_dev) + Zstr(':') + utfTo<Zstring>(writtenKB);
+}
+
+
+Zstring getVolumesGeneration(const std::set<Zstring, LessNativePath>& folderPaths) //throw FileError; empty if not available
+{
+    Zstring generation;
+    for (const Zstring& folderPath : folderPaths)
+    {
+        const Zstring& volumeGen = getVolumeGeneration(folderPath); //throw FileError
+        if (volumeGen.empty())
+            return Zstring();
+
+        generation += (generation.empty() ? Zstr("") : Zstr("|")) + volumeGen;
+    }
+    return generation;
+}
+
+
+std::optional<std::vector<Zstring>> loadPendingChanges(const Zstring& journalFilePath, const std::set<Zstring, LessNativePath>& folderPaths) //noexcept
+{
+    try
+    {
+        if (!fileAvailable(journalFilePath))
+            return std::nullopt;
+
+        ChangeJournal journal = fff::loadChangeJournal(journalFilePath); //throw FileError
+
+        if (journal.generation.empty() ||
+            !std::equal(journal.monitoredFolders.begin(), journal.monitoredFolders.end(), folderPaths.begin(), folderPaths.end(),
+                        [](const Zstring& lhs, const Zstring& rhs) { return equalNativePath(lhs, rhs); }))
+            return std::nullopt;
+
+        if (journal.generation != getVolumesGeneration(folderPaths)) //throw FileError
+            return std::nullopt; //written to while not monitored
+
+        return std::move(journal.changedItems);
+    }
+    catch (FileError&) { return std::nullopt; } //not critical: full comparison
+}
+
+
+void savePendingChanges(const Zstring& journalFilePath, const std::set<Zstring, LessNativePath>& folderPaths, FolderWatches& watches,
+                        std::set<Zstring, LessNativePath>& changedItems, std::chrono::milliseconds cbInterval) //noexcept
+{
+    try
+    {
+        const Zstring generation = getVolumesGeneration(folderPaths); //throw FileError
+
+        //changes written before syncfs() are queued by now
+        if (fetchChanges(watches, true /*checkDirNow*/, [&](const DirWatcher::Change& change) { changedItems.insert(change.itemPath); }, [] {}, cbInterval)) //throw FileError
+            return; //folder unavailable: don't know what changed
+
+        fff::saveChangeJournal({{folderPaths.begin(), folderPaths.end()}, {changedItems.begin(), changedItems.end()}, generation}, journalFilePath); //throw FileError
     }
+    catch (FileError&) {} //not critical: full comparison after restart
 }
 
 
@@ -199,9 +355,10 @@ struct ExecCommandNowException {};
 }
 
 
-void rts::monitorDirectories(const std::vector<Zstring>& folderPathPhrases, std::chrono::seconds delay,
-                             const std::function<void(const Zstring& itemPath, const std::wstring& actionName)>& executeExternalCommand /*throw FileError*/,
+void rts::monitorDirectories(const std::vector<Zstring>& folderPathPhrases, std::chrono::seconds delay, const Zstring& journalFilePath,
+                             const std::function<void(const Zstring& itemPath, const std::wstring& actionName, const ChangeJournal& journal)>& executeExternalCommand /*throw FileError*/,
                              const std::function<void(const Zstring* missingFolderPath)>& requestUiUpdate,
+                             const WaitForEventsCb& waitForEvents,
                              const std::function<void(const std::wstring& msg         )>& reportError,
                              std::chrono::milliseconds cbInterval)
 {
@@ -212,42 +369,80 @@ void rts::monitorDirectories(const std::vector<Zstring>& folderPathPhrases, std:
     for (;;)
         try
         {
-            std::set<Zstring, LessNativePath> folderPaths = waitForMissingDirs(folderPathPhrases, [&](const Zstring& folderPath) { requestUiUpdate(&folderPath); }, cbInterval); //throw FileError
+            std::set<Zstring, LessNativePath> folderPaths = waitForMissingDirs(folderPathPhrases, [&](const Zstring& folderPath) { requestUiUpdate(&folderPath); }, waitForEvents, cbInterval); //throw FileError
 
             //schedule initial execution (*after* all directories have arrived)
             auto nextExecTime = std::chrono::steady_clock::now() + delay;
 
-            for (;;) //command executions
+            //initial execution (or after error): we don't know what changed => report base folders (unless known from persistent journal)
+            std::set<Zstring, LessNativePath> changedItems(folderPaths.begin(), folderPaths.end());
+
+            auto onChange = [&](const DirWatcher::Change& change) { changedItems.insert(change.itemPath); };
+
+            FolderWatches watches;
+            std::optional<DirWatcher::Change> folderUnavailable = installWatches(watches, folderPaths); //throw FileError
+
+            //watching *before* checking the generation => no gap
+            if (!journalFilePath.empty() && !folderUnavailable)
+                if (std::optional<std::vector<Zstring>> pendingItems = loadPendingChanges(journalFilePath, folderPaths)) //noexcept
+                    changedItems = {pendingItems->begin(), pendingItems->end()};
+
+            try
             {
-                DirWatcher::Change lastChangeDetected;
-                try
+                for (;;) //command executions
                 {
-                    for (;;) //detected changes
+                    DirWatcher::Change lastChangeDetected;
+                    try
                     {
-                        lastChangeDetected = waitForChanges(folderPaths, [&](bool readyForSync) //throw FileError, ExecCommandNowException
+                        for (;;) //detected changes
                         {
-                            requestUiUpdate(nullptr);
+                            if (!folderUnavailable)
+                                folderUnavailable = waitForChanges(watches, [&](const DirWatcher::Change& change) //throw FileError, ExecCommandNowException
+                            {
+                                onChange(change);
+                                lastChangeDetected = change;
+                                nextExecTime = std::chrono::steady_clock::now() + delay;
+                            },
+                            [&](bool readyForSync)
+                            {
+                                requestUiUpdate(nullptr);
+
+                                if (readyForSync && std::chrono::steady_clock::now() >= nextExecTime)
+                                    throw ExecCommandNowException(); //abort wait and start sync
+                            }, waitForEvents, nextExecTime, cbInterval);
 
-                            if (readyForSync && std::chrono::steady_clock::now() >= nextExecTime)
-                                throw ExecCommandNowException(); //abort wait and start sync
-                        }, cbInterval);
-
-                        if (lastChangeDetected.type == DirWatcher::ChangeType::baseFolderUnavailable)
                             //don't execute the command before all directories are available!
-                            folderPaths = waitForMissingDirs(folderPathPhrases, [&](const Zstring& folderPath) { requestUiUpdate(&folderPath); }, cbInterval); //throw FileError
+                            lastChangeDetected = *folderUnavailable;
+                            changedItems.insert(folderUnavailable->itemPath); //folder may have been replaced entirely
+
+                            folderPaths = waitForMissingDirs(folderPathPhrases, [&](const Zstring& folderPath) { requestUiUpdate(&folderPath); }, waitForEvents, cbInterval); //throw FileError
+                            folderUnavailable = installWatches(watches, folderPaths); //throw FileError
 
-                        nextExecTime = std::chrono::steady_clock::now() + delay;
+                            nextExecTime = std::chrono::steady_clock::now() + delay;
+                        }
                     }
-                }
-                catch (ExecCommandNowException&) {}
+                    catch (ExecCommandNowException&) {}
 
-                try
-                {
-                    executeExternalCommand(lastChangeDetected.itemPath, getChangeTypeName(lastChangeDetected.type)); //throw FileError
-                }
-                catch (const FileError& e) { reportError(e.toString()); }
+                    const ChangeJournal journal{{folderPaths.begin(), folderPaths.end()}, {changedItems.begin(), changedItems.end()}};
+                    try
+                    {
+                        executeExternalCommand(lastChangeDetected.itemPath, getChangeTypeName(lastChangeDetected.type), journal); //throw FileError
+                        changedItems.clear(); //keep journal after failure: changes may not have been synced yet
+                    }
+                    catch (const FileError& e) { reportError(e.toString()); }
+
+                    //record changes made while the command was running (including its own), but don't trigger a new execution
+                    folderUnavailable = fetchChanges(watches, true /*checkDirNow*/, onChange, [&] { requestUiUpdate(nullptr); }, cbInterval); //throw FileError
 
-                nextExecTime = std::chrono::steady_clock::time_point::max();
+                    nextExecTime = std::chrono::steady_clock::time_point::max();
+                }
+            }
+            catch (FileError&) { throw; } //changes may have been missed: full comparison after restart
+            catch (...) //shutdown
+            {
+                if (!journalFilePath.empty() && !folderUnavailable)
+                    savePendingChanges(journalFilePath, folderPaths, watches, changedItems, cbInterval); //noexcept
+                throw;
             }
         }
         catch (const FileError& e)
@@ -9,7 +9,9 @@
 
 #include <chrono>
 #include <functional>
+#include <vector>
 #include <zen/zstring.h>
+#include "../base/change_journal.h"
 
 
 namespace rts
@@ -17,8 +19,11 @@ namespace rts
 void monitorDirectories(const std::vector<Zstring>& folderPathPhrases,
                         //non-formatted paths that yet require call to getFormattedDirectoryName(); empty directories must be checked by caller!
                         std::chrono::seconds delay,
-                        const std::function<void(const Zstring& changedItemPath, const std::wstring& actionName)>& executeExternalCommand,
+                        const Zstring& journalFilePath, //empty: don't persist changes not yet synced; else: keep them across restarts
+                        const std::function<void(const Zstring& changedItemPath, const std::wstring& actionName, const fff::ChangeJournal& journal)>& executeExternalCommand,
                         const std::function<void(const Zstring* missingFolderPath)>& requestUiUpdate, //either waiting for change notifications or at least one folder is missing
+                        //idle: block until a UI event arrives, one of "fds" becomes readable, or timeout => no periodic wake-ups
+                        const std::function<void(const std::vector<int>& fds, std::chrono::milliseconds timeout)>& waitForEvents,
                         const std::function<void(const std::wstring& msg         )>& reportError, //automatically retries after return!
                         std::chrono::milliseconds cbInterval);
 }
@@ -11,13 +11,20 @@
 #include <wx/taskbar.h>
 #include <wx/icon.h> //Linux needs this
 #include <wx/app.h>
+#include <wx/evtloop.h>
+#include <wx/evtloopsrc.h>
 #include <wx/menu.h>
 #include <wx/timer.h>
 #include <wx+/image_tools.h>
 #include <zen/process_exec.h>
+#include <zen/file_access.h>
+#include <zen/scope_guard.h>
+#include <zen/stl_tools.h>
+#include <unistd.h> //getpid()
 #include <wx+/popup_dlg.h>
 #include <wx+/image_resources.h>
 #include "monitor.h"
+#include "../ffs_paths.h"
 
 using namespace zen;
 using namespace rts;
@@ -45,6 +52,33 @@ bool uiUpdateDue()
 }
 
 
+//block until a UI event arrives, one of "fds" becomes readable, or timeout: let the wx event loop do the waiting instead of polling
+void waitForUiEvents(const std::vector<int>& fds, std::chrono::milliseconds timeout)
+{
+    wxEventLoopBase* evtLoop = wxEventLoopBase::GetActive();
+    assert(evtLoop); //runFolderMonitor() is called from an event handler
+    if (!evtLoop)
+        return std::this_thread::sleep_for(std::min(timeout, UI_UPDATE_INTERVAL));
+
+    struct FdReadyHandler : public wxEventLoopSourceHandler
+    {
+        //nothing to do: being called is enough to wake up DispatchTimeout()
+        void OnReadWaiting     () override {}
+        void OnWriteWaiting    () override {}
+        void OnExceptionWaiting() override {}
+    } fdHandler;
+
+    std::vector<std::unique_ptr<wxEventLoopSource>> fdSources; //stop watching when going out of scope
+    for (const int fd : fds)
+        if (wxEventLoopSource* fdSrc = wxEventLoopBase::AddSourceForFD(fd, &fdHandler, wxEVENT_SOURCE_INPUT))
+            fdSources.emplace_back(fdSrc);
+        else
+            timeout = std::min(timeout, UI_UPDATE_INTERVAL); //fall back to polling
+
+    evtLoop->DispatchTimeout(static_cast<unsigned long>(std::max<std::chrono::milliseconds::rep>(timeout.count(), 0)));
+}
+
+
 enum TrayMode
 {
     active,
@@ -249,10 +283,40 @@ rts::AbortReason rts::runFolderMonitor(const XmlRealConfig& config, const wxStri
 
     TrayIconHolder trayIcon(jobname);
 
-    auto executeExternalCommand = [&](const Zstring& changedItemPath, const std::wstring& actionName) //throw FileError
+    //persistent journal: one per set of monitored folders
+    Zstring persistentJournalPath;
+    if (config.persistentJournal)
+    {
+        std::vector<Zstring> folderPhrases = dirNamesNonFmt;
+        std::sort(folderPhrases.begin(), folderPhrases.end());
+
+        std::string folderPhrasesBuf;
+        for (const Zstring& phrase : folderPhrases)
+            folderPhrasesBuf += utfTo<std::string>(trimCpy(phrase)) + '\n';
+
+        persistentJournalPath = fff::getConfigDirPathPf() + Zstr("RealTimeSync.") +
+                                printNumber<Zstring>(Zstr("%016llx"), static_cast<unsigned long long>(hashArray<uint64_t>(folderPhrasesBuf.begin(), folderPhrasesBuf.end()))) +
+                                Zstr(".ffs_journal");
+    }
+
+    std::optional<Zstring> journalFilePath;
+    ZEN_ON_SCOPE_EXIT(if (journalFilePath) try { removeFilePlain(*journalFilePath); /*throw FileError*/ } catch (FileError&) {});
+
+    auto executeExternalCommand = [&](const Zstring& changedItemPath, const std::wstring& actionName, const fff::ChangeJournal& journal) //throw FileError
     {
         ::wxSetEnv(L"change_path", utfTo<wxString>(changedItemPath)); //crude way to report changed file
         ::wxSetEnv(L"change_action", actionName);                     //
+
+        //all changes since last successful execution: FreeFileSync -ChangeJournal "%change_journal%"
+        try
+        {
+            if (!journalFilePath)
+                journalFilePath = nativeAppendPaths(getTempFolderPath(), Zstr("RealTimeSync.") + numberTo<Zstring>(::getpid()) + Zstr(".ffs_journal")); //throw FileError
+
+            fff::saveChangeJournal(journal, *journalFilePath); //throw FileError
+            ::wxSetEnv(L"change_journal", utfTo<wxString>(*journalFilePath));
+        }
+        catch (FileError&) { ::wxSetEnv(L"change_journal", L""); } //not critical: FreeFileSync falls back to full comparison
         auto cmdLineExp = expandMacros(cmdLine);
 
         try
@@ -276,6 +340,12 @@ rts::AbortReason rts::runFolderMonitor(const XmlRealConfig& config, const wxStri
             trayIcon.doUiRefreshNow(); //throw AbortMonitoring
     };
 
+    auto waitForEvents = [&](const std::vector<int>& fds, std::chrono::milliseconds timeout)
+    {
+        waitForUiEvents(fds, timeout);
+        trayIcon.doUiRefreshNow(); //throw AbortMonitoring
+    };
+
     auto reportError = [&](const std::wstring& msg)
     {
         trayIcon.setMode(TrayMode::error, Zstring());
@@ -297,15 +367,16 @@ rts::AbortReason rts::runFolderMonitor(const XmlRealConfig& config, const wxStri
                     case ConfirmationButton::cancel:
                         throw AbortMonitoring(AbortReason::REQUEST_GUI);
                 }
-            std::this_thread::sleep_for(UI_UPDATE_INTERVAL);
+            waitForUiEvents({}, std::chrono::ceil<std::chrono::milliseconds>(delayUntil - std::chrono::steady_clock::now()));
         }
     };
 
     try
     {
-        monitorDirectories(dirNamesNonFmt, std::chrono::seconds(config.delay),
+        monitorDirectories(dirNamesNonFmt, std::chrono::seconds(config.delay), persistentJournalPath,
                            executeExternalCommand /*throw FileError*/,
                            requestUiUpdate, //throw AbortMonitoring
+                           waitForEvents,   //
                            reportError,     //
                            UI_UPDATE_INTERVAL / 2);
         assert(false);
@@ -8,6 +8,11 @@
 #include <zen/serialize.h>
 #include <zen/guid.h>
 #include <zen/crc.h>
+#include <zen/thread.h>
+#include <zen/stream_buffer.h>
+#include <zen/perf.h>
+#include <zen/file_access.h>
+#include <zen/open_ssl.h>
 #include <typeindex>
 
 using namespace zen;
@@ -66,6 +71,159 @@ std::optional<AfsPath> AFS::getParentPath(const AfsPath& afsPath)
 }
 
 
+//------------------------------------------------------------------------------------------------------------------------
+//instrumentation of device operations: latency per operation and device + byte counters (only if tracing/metrics enabled)
+namespace
+{
+std::string getMetricsDeviceLabel(const AfsDevice& afsDevice)
+{
+    return utfTo<std::string>(AFS::getDisplayPath(AbstractPath(afsDevice, AfsPath())));
+}
+
+
+TraceSpan traceAfsOperation(const char* name /*string literal!*/, const AbstractPath& ap)
+{
+    return TraceSpan(name, [&] { return utfTo<std::string>(AFS::getDisplayPath(ap)); },
+    [&] { return getMetricsDeviceLabel(ap.afsDevice); });
+}
+
+
+template <class Function>
+IoCallback countUnbufferedIO(const char* counterName /*string literal!*/, Function getDeviceLabel, const IoCallback& notifyUnbufferedIO /*throw X*/)
+{
+    if (!metricsEnabled())
+        return notifyUnbufferedIO;
+
+    return [counterName, deviceLabel = getDeviceLabel(), notifyUnbufferedIO](int64_t bytesDelta) //caveat: may be called by worker thread
+    {
+        addMetricCount(counterName, [&] { return deviceLabel; }, bytesDelta);
+        if (notifyUnbufferedIO) notifyUnbufferedIO(bytesDelta); //throw X
+    };
+}
+}
+
+
+int AFS::selectWorkerNumaNode(const AbstractPath& ap) //noexcept
+{
+    if (!numaAffinityEnabled())
+        return -1;
+
+    const std::optional<Zstring> nativePath = ap.afsDevice.ref().getNativeItemPath(ap.afsPath);
+    const int numaNode = selectNumaNode(nativePath ? getBlockDeviceNumaNode(*nativePath) : getNetworkNumaNode());
+
+    if (numaNode >= 0)
+        addMetricCount("numa device pools", [&] { return numberTo<std::string>(numaNode) + '\t' + getMetricsDeviceLabel(ap.afsDevice); }, 1);
+    return numaNode;
+}
+
+
+std::string AFS::getPhysicalDeviceId(const AbstractPath& ap) //noexcept
+{
+    if (const std::optional<Zstring> nativePath = ap.afsDevice.ref().getNativeItemPath(ap.afsPath))
+        return zen::getPhysicalDeviceId(*nativePath); //folder may not exist (yet) => empty
+    return {};
+}
+
+
+AFS::ItemType AFS::getItemType(const AbstractPath& ap) //throw FileError
+{
+    const TraceSpan span = traceAfsOperation("afs get item type", ap);
+    return ap.afsDevice.ref().getItemType(ap.afsPath); //throw FileError
+}
+
+
+std::optional<AFS::ItemType> AFS::itemStillExists(const AbstractPath& ap) //throw FileError
+{
+    const TraceSpan span = traceAfsOperation("afs item still exists", ap);
+    return ap.afsDevice.ref().itemStillExists(ap.afsPath); //throw FileError
+}
+
+
+void AFS::createFolderPlain(const AbstractPath& ap) //throw FileError
+{
+    const TraceSpan span = traceAfsOperation("afs create folder", ap);
+    ap.afsDevice.ref().createFolderPlain(ap.afsPath); //throw FileError
+}
+
+
+void AFS::removeFilePlain(const AbstractPath& ap) //throw FileError
+{
+    const TraceSpan span = traceAfsOperation("afs remove file plain", ap);
+    ap.afsDevice.ref().removeFilePlain(ap.afsPath); //throw FileError
+}
+
+
+void AFS::removeSymlinkPlain(const AbstractPath& ap) //throw FileError
+{
+    const TraceSpan span = traceAfsOperation("afs remove symlink plain", ap);
+    ap.afsDevice.ref().removeSymlinkPlain(ap.afsPath); //throw FileError
+}
+
+
+void AFS::removeFolderPlain(const AbstractPath& ap) //throw FileError
+{
+    const TraceSpan span = traceAfsOperation("afs remove folder plain", ap);
+    ap.afsDevice.ref().removeFolderPlain(ap.afsPath); //throw FileError
+}
+
+
+std::unique_ptr<AFS::InputStream> AFS::getInputStream(const AbstractPath& ap, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, ErrorFileLocked
+{
+    const TraceSpan span = traceAfsOperation("afs open input", ap);
+    return ap.afsDevice.ref().getInputStream(ap.afsPath, countUnbufferedIO("bytes read", [&] { return getMetricsDeviceLabel(ap.afsDevice); }, notifyUnbufferedIO)); //throw FileError, ErrorFileLocked
+}
+
+
+std::unique_ptr<AFS::OutputStream> AFS::getOutputStream(const AbstractPath& ap, //throw FileError
+                                                        std::optional<uint64_t> streamSize,
+                                                        std::optional<time_t> modTime,
+                                                        const IoCallback& notifyUnbufferedIO /*throw X*/)
+{
+    const TraceSpan span = traceAfsOperation("afs open output", ap);
+    return std::make_unique<OutputStream>(ap.afsDevice.ref().getOutputStream(ap.afsPath, streamSize, modTime,
+                                                                             countUnbufferedIO("bytes written", [&] { return getMetricsDeviceLabel(ap.afsDevice); }, notifyUnbufferedIO)), //throw FileError
+                                          ap, streamSize);
+}
+
+
+void AFS::traverseFolderRecursive(const AfsDevice& afsDevice, const TraverserWorkload& workload /*throw X*/, size_t parallelOps)
+{
+    const TraceSpan span("afs traverse folders", [&] { return numberTo<std::string>(workload.size()) + " folders"; },
+    [&] { return getMetricsDeviceLabel(afsDevice); });
+    afsDevice.ref().traverseFolderRecursive(workload, parallelOps); //throw X
+}
+
+
+void AFS::traverseFolderFlat(const AbstractPath& ap, //throw FileError
+                             const std::function<void (const FileInfo&    fi)>& onFile,
+                             const std::function<void (const FolderInfo&  fi)>& onFolder,
+                             const std::function<void (const SymlinkInfo& si)>& onSymlink)
+{
+    const TraceSpan span = traceAfsOperation("afs traverse folder flat", ap);
+    ap.afsDevice.ref().traverseFolderFlat(ap.afsPath, onFile, onFolder, onSymlink); //throw FileError
+}
+
+
+void AFS::moveAndRenameItem(const AbstractPath& pathFrom, const AbstractPath& pathTo) //throw FileError, ErrorMoveUnsupported
+{
+    if (typeid(pathFrom.afsDevice.ref()) != typeid(pathTo.afsDevice.ref()))
+        throw ErrorMoveUnsupported(replaceCpy(replaceCpy(_("Cannot move file %x to %y."),
+                                                         L"%x", L'\n' + fmtPath(getDisplayPath(pathFrom))),
+                                              L"%y", L'\n' + fmtPath(getDisplayPath(pathTo))), _("Operation not supported between different devices."));
+
+    const TraceSpan span = traceAfsOperation("afs move item", pathFrom);
+    //already existing: undefined behavior! (e.g. fail/overwrite)
+    pathFrom.afsDevice.ref().moveAndRenameItemForSameAfsType(pathFrom.afsPath, pathTo); //throw FileError, ErrorMoveUnsupported
+}
+
+
+void AFS::recycleItemIfExists(const AbstractPath& ap) //throw FileError
+{
+    const TraceSpan span = traceAfsOperation("afs recycle item", ap);
+    ap.afsDevice.ref().recycleItemIfExists(ap.afsPath); //throw FileError
+}
+
+
 namespace
 {
 struct FlatTraverserCallback : public AFS::TraverserCallback
@@ -89,6 +247,161 @@ private:
     const std::function<void (const AFS::FolderInfo&  fi)> onFolder_;
     const std::function<void (const AFS::SymlinkInfo& si)> onSymlink_;
 };
+
+
+//avoid the intermediate buffer of bufferedStreamCopy() if either side lends its internal buffer
+//hasher: optional; fed with the bytes written (in stream order)
+void streamCopyBorrowed(AFS::InputStream& streamIn, AFS::OutputStream& streamOut, Sha256Hasher* hasher) //throw FileError, ErrorFileLocked, SysError, X
+{
+    if (streamIn.supportsReadBorrowed())
+        for (;;)
+        {
+            const std::span<const std::byte> block = streamIn.readBorrowed(); //throw FileError, ErrorFileLocked, X
+            if (block.empty()) //end of stream
+                return;
+            if (hasher)
+                hasher->update(block.data(), block.size()); //throw SysError
+            streamOut.write(block.data(), block.size()); //throw FileError, X
+        }
+
+    const size_t blockSize = streamIn.getBlockSize();
+    if (blockSize == 0)
+        throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
+
+    std::vector<std::byte> buffer; //fallback: target doesn't lend (currently)
+    for (;;)
+    {
+        std::span<std::byte> block = streamOut.getWriteBuffer(); //throw FileError, X
+        const bool isBorrowed = !block.empty();
+        if (!isBorrowed)
+        {
+            buffer.resize(blockSize);
+            block = buffer;
+        }
+
+        const size_t bytesRead = streamIn.read(block.data(), block.size()); //throw FileError, ErrorFileLocked, X; return "bytesToRead" bytes unless end of stream!
+        if (hasher)
+            hasher->update(block.data(), bytesRead); //throw SysError
+
+        if (isBorrowed)
+            streamOut.commitWrite(bytesRead); //throw FileError, X
+        else
+            streamOut.write(block.data(), bytesRead); //throw FileError, X
+
+        if (bytesRead != block.size()) //end of stream
+            return;
+    }
+}
+
+
+const uint64_t PIPELINED_COPY_MIN_SIZE = 1024 * 1024; //don't waste a thread creation on small files
+const size_t PIPELINE_BLOCK_SIZE_MIN = 512 * 1024;
+
+/*  read ahead on a worker thread: source and target device are busy at the same time, e.g. local disk while waiting for SFTP server
+    - streamIn was created with bytesReadAsync as its notifyUnbufferedIO callback: worker thread must not call back into the UI!
+    - bounded queue: AsyncStreamBuffer holding two blocks                                                                          */
+void streamCopyPipelined(AFS::InputStream& streamIn, AFS::OutputStream& streamOut, Sha256Hasher* hasher, //throw FileError, ErrorFileLocked, SysError, X
+                         const std::atomic<int64_t>& bytesReadAsync, const IoCallback& notifyUnbufferedRead /*throw X*/)
+{
+    const size_t blockSize = streamIn.getBlockSize();
+    if (blockSize == 0)
+        throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
+
+    const auto asyncStream = std::make_shared<AsyncStreamBuffer>(2 * std::max(blockSize, PIPELINE_BLOCK_SIZE_MIN));
+
+    InterruptibleThread worker([&streamIn, blockSize, asyncStreamOut = asyncStream]
+    {
+        setCurrentThreadName(Zstr("Istream[Pipeline]"));
+        try
+        {
+            if (streamIn.supportsReadBorrowed())
+                for (;;)
+                {
+                    const std::span<const std::byte> block = streamIn.readBorrowed(); //throw FileError, ErrorFileLocked
+                    if (block.empty()) //end of stream
+                        break;
+                    asyncStreamOut->write(block.data(), block.size()); //throw ThreadStopRequest
+                }
+            else
+            {
+                std::vector<std::byte> buffer(blockSize);
+                for (;;)
+                {
+                    const size_t bytesRead = streamIn.read(&buffer[0], blockSize); //throw FileError, ErrorFileLocked; return "bytesToRead" bytes unless end of stream!
+                    asyncStreamOut->write(&buffer[0], bytesRead); //throw ThreadStopRequest
+                    if (bytesRead != blockSize) //end of stream
+                        break;
+                }
+            }
+            asyncStreamOut->closeStream();
+        }
+        catch (FileError&) { asyncStreamOut->setWriteError(std::current_exception()); } //let ThreadStopRequest pass through!
+    });
+    ZEN_ON_SCOPE_EXIT(asyncStream->setReadError(std::make_exception_ptr(ThreadStopRequest()))); //unblock worker *before* ~InterruptibleThread() joins
+
+    int64_t bytesReported = 0;
+    auto reportBytesRead = [&] //throw X
+    {
+        const int64_t bytesReadTotal = bytesReadAsync;
+        if (notifyUnbufferedRead) notifyUnbufferedRead(bytesReadTotal - bytesReported); //throw X
+        bytesReported = bytesReadTotal;
+    };
+
+    std::vector<std::byte> buffer; //fallback: target doesn't lend (currently)
+    for (;;)
+    {
+        std::span<std::byte> block = streamOut.getWriteBuffer(); //throw FileError, X
+        const bool isBorrowed = !block.empty();
+        if (!isBorrowed)
+        {
+            buffer.resize(blockSize);
+            block = buffer;
+        }
+
+        const size_t bytesRead = asyncStream->read(block.data(), block.size()); //throw FileError, ErrorFileLocked; return "bytesToRead" bytes unless end of stream!
+        reportBytesRead(); //throw X
+
+        if (hasher) //overlaps with worker thread reading the next block
+            hasher->update(block.data(), bytesRead); //throw SysError
+
+        if (isBorrowed)
+            streamOut.commitWrite(bytesRead); //throw FileError, X
+        else
+            streamOut.write(block.data(), bytesRead); //throw FileError, X
+
+        if (bytesRead != block.size()) //end of stream
+            break;
+    }
+    worker.join(); //worker's last notifyUnbufferedIO happens before closeStream(), but let's be sure the input stream is not in use anymore
+    reportBytesRead(); //throw X
+}
+
+
+//resumed copy: stream source data starting at an offset via positional reads
+class InputStreamAtOffset : public AFS::InputStream
+{
+public:
+    InputStreamAtOffset(AFS::InputStream& streamIn, uint64_t offset) : streamIn_(streamIn), streamPos_(offset) { assert(streamIn.supportsReadAt()); }
+
+    size_t read(void* buffer, size_t bytesToRead) override //throw FileError, ErrorFileLocked, X; return "bytesToRead" bytes unless end of stream!
+    {
+        const size_t bytesRead = streamIn_.readAt(streamPos_, buffer, bytesToRead); //throw FileError, ErrorFileLocked, X
+        streamPos_ += bytesRead;
+        return bytesRead;
+    }
+    size_t getBlockSize() const override { return streamIn_.getBlockSize(); }
+    std::optional<AFS::StreamAttributes> getAttributesBuffered() override { return streamIn_.getAttributesBuffered(); } //throw FileError
+
+    bool supportsReadAt() const override { return false; }
+    size_t readAt(uint64_t offset, void* buffer, size_t bytesToRead) override
+    { throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__)); }
+
+private:
+    AFS::InputStream& streamIn_;
+    uint64_t streamPos_;
+};
+
+const size_t RESUME_VERIFY_SIZE = 256 * 1024; //compare tail of partial file with source before continuing: catches unflushed or foreign data
 }
 
 
@@ -104,7 +417,8 @@ void AFS::traverseFolderFlat(const AfsPath& afsPath, //throw FileError
 
 //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
 AFS::FileCopyResult AFS::copyFileAsStream(const AfsPath& afsSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
-                                          const AbstractPath& apTarget, const IoCallback& notifyUnbufferedIO /*throw X*/) const
+                                          const AbstractPath& apTarget, bool calcContentHash, const IoCallback& notifyUnbufferedIO /*throw X*/,
+                                          bool resumable) const
 {
     int64_t totalUnbufferedIO = 0;
     IOCallbackDivider cbd(notifyUnbufferedIO, totalUnbufferedIO);
@@ -115,7 +429,17 @@ AFS::FileCopyResult AFS::copyFileAsStream(const AfsPath& afsSource, const Stream
     auto notifyUnbufferedWrite = [&](int64_t bytesDelta) { totalBytesWritten += bytesDelta; cbd(bytesDelta); };
     //--------------------------------------------------------------------------------------------------------
 
-    auto streamIn = getInputStream(afsSource, notifyUnbufferedRead); //throw FileError, ErrorFileLocked
+    //decide early: input stream's callback must be thread-safe if read from worker thread
+    const bool pipelined = attrSource.fileSize >= PIPELINED_COPY_MIN_SIZE; //stale size is good enough here
+
+    std::atomic<int64_t> bytesReadAsync{0};
+    auto notifyUnbufferedReadAsync = [&](int64_t bytesDelta) { bytesReadAsync += bytesDelta; }; //noexcept; called by worker thread
+
+    //bypasses AFS::getInputStream(AbstractPath): count bytes read separately
+    const IoCallback notifySourceRead = countUnbufferedIO("bytes read", [&] { return utfTo<std::string>(getDisplayPath(AfsPath())); },
+                                                          pipelined ? IoCallback(notifyUnbufferedReadAsync) : IoCallback(notifyUnbufferedRead));
+
+    auto streamIn = getInputStream(afsSource, notifySourceRead); //throw FileError, ErrorFileLocked
 
     StreamAttributes attrSourceNew = {};
     //try to get the most current attributes if possible (input file might have changed after comparison!)
@@ -125,16 +449,64 @@ AFS::FileCopyResult AFS::copyFileAsStream(const AfsPath& afsSource, const Stream
         attrSourceNew = attrSource; //SFTP/FTP
     //TODO: evaluate: consequences of stale attributes
 
+    //resumable: continue writing a partial file of a previous copy (content hash needs all data => not resumed)
+    uint64_t resumeOffset = 0;
+    if (resumable && !calcContentHash && streamIn->supportsReadAt())
+        if (const std::optional<uint64_t> partialSize = apTarget.afsDevice.ref().getPartialFileSize(apTarget.afsPath))
+        {
+            if (*partialSize > RESUME_VERIFY_SIZE && *partialSize < attrSourceNew.fileSize)
+            {
+                //verify tail: don't mix with streamIn's data stream, don't report as sync progress
+                std::vector<std::byte> tailSource(RESUME_VERIFY_SIZE);
+                std::vector<std::byte> tailTarget(RESUME_VERIFY_SIZE);
+                const uint64_t tailOffset = *partialSize - RESUME_VERIFY_SIZE;
+
+                if (getInputStream(afsSource, nullptr /*notifyUnbufferedIO*/)->readAt(tailOffset, tailSource.data(), tailSource.size()) == tailSource.size() && //throw FileError, ErrorFileLocked
+                    AFS::getInputStream(apTarget, nullptr /*notifyUnbufferedIO*/)->readAt(tailOffset, tailTarget.data(), tailTarget.size()) == tailTarget.size() && //
+                    tailSource == tailTarget)
+                    resumeOffset = *partialSize;
+            }
+            if (resumeOffset == 0) //stale or complete (e.g. modification time failed) => start over
+                removeFilePlain(apTarget); //throw FileError
+        }
+
+    std::optional<InputStreamAtOffset> streamInResumed;
+    if (resumeOffset > 0)
+        streamInResumed.emplace(*streamIn, resumeOffset);
+    InputStream& streamInData = streamInResumed ? static_cast<InputStream&>(*streamInResumed) : *streamIn;
+
+    const uint64_t bytesToCopy = attrSourceNew.fileSize - resumeOffset;
+
     //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
-    auto streamOut = getOutputStream(apTarget, attrSourceNew.fileSize, attrSourceNew.modTime, notifyUnbufferedWrite); //throw FileError
+    auto streamOut = resumeOffset > 0 ?
+                     std::make_unique<OutputStream>(apTarget.afsDevice.ref().getOutputStreamAppend(apTarget.afsPath, bytesToCopy, attrSourceNew.modTime, //throw FileError
+                                                    notifyUnbufferedWrite), apTarget, bytesToCopy) :
+                     getOutputStream(apTarget, attrSourceNew.fileSize, attrSourceNew.modTime, notifyUnbufferedWrite); //throw FileError
+    if (resumable)
+        streamOut->keepOnFailure();
+
+    std::string contentHash;
+    try
+    {
+        std::optional<Sha256Hasher> hasher;
+        if (calcContentHash)
+            hasher.emplace(); //throw SysError
 
-    bufferedStreamCopy(*streamIn, *streamOut); //throw FileError, ErrorFileLocked, X
+        if (pipelined)
+            streamCopyPipelined(streamInData, *streamOut, hasher ? &*hasher : nullptr, bytesReadAsync, notifyUnbufferedRead); //throw FileError, ErrorFileLocked, SysError, X
+        else
+            streamCopyBorrowed(streamInData, *streamOut, hasher ? &*hasher : nullptr); //throw FileError, ErrorFileLocked, SysError, X
+
+        if (hasher)
+            contentHash = hasher->finalize(); //throw SysError
+    }
+    catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getDisplayPath(afsSource))), e.toString()); }
 
     //check incomplete input *before* failing with (slightly) misleading error message in OutputStream::finalize()
-    if (totalBytesRead != makeSigned(attrSourceNew.fileSize))
+    if (totalBytesRead != makeSigned(bytesToCopy))
         throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getDisplayPath(afsSource))),
                         replaceCpy(replaceCpy(_("Unexpected size of data stream.\nExpected: %x bytes\nActual: %y bytes"),
-                                              L"%x", formatNumber(attrSourceNew.fileSize)),
+                                              L"%x", formatNumber(bytesToCopy)),
                                    L"%y", formatNumber(totalBytesRead)) + L" [notifyUnbufferedRead]");
 
     const FinalizeResult finResult = streamOut->finalize(); //throw FileError, X
@@ -154,6 +526,7 @@ AFS::FileCopyResult AFS::copyFileAsStream(const AfsPath& afsSource, const Stream
     cpResult.sourceFilePrint = attrSourceNew.filePrint;
     cpResult.targetFilePrint = finResult.filePrint;
     cpResult.errorModTime    = finResult.errorModTime;
+    cpResult.contentHash     = std::move(contentHash);
     /* Failing to set modification time is not a serious problem from synchronization perspective (treat like external update)
             => Support additional scenarios:
             - GVFS failing to set modTime for FTP: https://freefilesync.org/forum/viewtopic.php?t=2372
@@ -164,14 +537,75 @@ AFS::FileCopyResult AFS::copyFileAsStream(const AfsPath& afsSource, const Stream
 }
 
 
+namespace
+{
+Zstring getTempFileName(const Zstring& fileName, const Zstring& tag)
+{
+    Zstring tmpName = beforeLast(fileName, Zstr('.'), IfNotFoundReturn::all);
+
+    //don't make the temp name longer than the original when hitting file system name length limitations: "lpMaximumComponentLength is commonly 255 characters"
+    while (tmpName.size() > 200) //BUT don't trim short names! we want early failure on filename-related issues
+        tmpName = getUnicodeSubstring(tmpName, 0 /*uniPosFirst*/, unicodeLength(tmpName) / 2 /*uniPosLast*/); //consider UTF encoding when cutting in the middle! (e.g. for macOS)
+
+    return tmpName + Zstr('~') + tag + AFS::TEMP_FILE_ENDING;
+}
+
+
+//resumable: same temp file for the same source version => continue a failed copy, see copyFileAsStream()
+AbstractPath getTempFilePath(const AbstractPath& apTarget, const AFS::StreamAttributes* resumeSource) //throw FileError
+{
+    const std::optional<AbstractPath> parentPath = AFS::getParentPath(apTarget);
+    if (!parentPath)
+        throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(AFS::getDisplayPath(apTarget))), L"Path is device root.");
+    const Zstring fileName = AFS::getItemName(apTarget);
+
+    if (resumeSource)
+        return AFS::appendRelPath(*parentPath, AFS::getResumableTempFileName(fileName, resumeSource->fileSize, resumeSource->modTime));
+
+    //- generate (hopefully) unique file name to avoid clashing with some remnant ffs_tmp file
+    //- do not loop: avoid pathological cases, e.g. https://freefilesync.org/forum/viewtopic.php?t=1592
+    const Zstring& shortGuid = printNumber<Zstring>(Zstr("%04x"), static_cast<unsigned int>(getCrc16(generateGUID())));
+
+    return AFS::appendRelPath(*parentPath, getTempFileName(fileName, shortGuid));
+}
+}
+
+
+Zstring AFS::getResumableTempFileName(const Zstring& targetFileName, uint64_t sourceFileSize, time_t sourceModTime)
+{
+    //longer tag than for random temp names: a stale remnant must not be mistaken for a partial copy (tail is verified nevertheless)
+    const std::string versionId = utfTo<std::string>(targetFileName) + '|' + numberTo<std::string>(sourceFileSize) + '|' + numberTo<std::string>(sourceModTime);
+
+    return getTempFileName(targetFileName, printNumber<Zstring>(Zstr("%016llx"), static_cast<unsigned long long>(hashArray<uint64_t>(versionId.begin(), versionId.end()))));
+}
+
+
 //already existing + no onDeleteTargetFile: undefined behavior! (e.g. fail/overwrite/auto-rename)
 AFS::FileCopyResult AFS::copyFileTransactional(const AbstractPath& apSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
                                                const AbstractPath& apTarget,
                                                bool copyFilePermissions,
                                                bool transactionalCopy,
                                                const std::function<void()>& onDeleteTargetFile,
+                                               bool deleteTargetPermanently,
+                                               bool calcContentHash,
                                                const IoCallback& notifyUnbufferedIO /*throw X*/)
 {
+    const TraceSpan span = traceAfsOperation("afs copy file", apTarget);
+
+    //per-device throughput: attribute to target device
+    const auto copyStartTime = std::chrono::steady_clock::now();
+    ZEN_ON_SCOPE_SUCCESS
+    (
+        if (metricsEnabled())
+        {
+            const std::string deviceLabel = getMetricsDeviceLabel(apTarget.afsDevice);
+            auto getDeviceLabel = [&] { return deviceLabel; };
+            addMetricCount("items copied", getDeviceLabel, 1);
+            addMetricCount("bytes copied", getDeviceLabel, static_cast<int64_t>(attrSource.fileSize));
+            addMetricCount("copy time us", getDeviceLabel, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - copyStartTime).count());
+        }
+    );
+
     auto copyFilePlain = [&](const AbstractPath& apTargetTmp)
     {
         //caveat: typeid returns static type for pointers, dynamic type for references!!!
@@ -186,35 +620,31 @@ AFS::FileCopyResult AFS::copyFileTransactional(const AbstractPath& apSource, con
                             _("Operation not supported between different devices."));
 
         //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
-        return apSource.afsDevice.ref().copyFileAsStream(apSource.afsPath, attrSource, apTargetTmp, notifyUnbufferedIO); //throw FileError, ErrorFileLocked, X
+        return apSource.afsDevice.ref().copyFileAsStream(apSource.afsPath, attrSource, apTargetTmp, calcContentHash, notifyUnbufferedIO); //throw FileError, ErrorFileLocked, X
     };
 
     if (transactionalCopy && !hasNativeTransactionalCopy(apTarget))
     {
-        const std::optional<AbstractPath> parentPath = getParentPath(apTarget);
-        if (!parentPath)
-            throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(getDisplayPath(apTarget))), L"Path is device root.");
-        const Zstring fileName = getItemName(apTarget);
-
-        //- generate (hopefully) unique file name to avoid clashing with some remnant ffs_tmp file
-        //- do not loop: avoid pathological cases, e.g. https://freefilesync.org/forum/viewtopic.php?t=1592
-        Zstring tmpName = beforeLast(fileName, Zstr('.'), IfNotFoundReturn::all);
+        //stream-based copy of a large file: keep the partial temp file on failure => next try continues where it stopped
+        const bool resumable = attrSource.fileSize >= RESUMABLE_COPY_MIN_SIZE && !calcContentHash && !copyFilePermissions &&
+                               typeid(apSource.afsDevice.ref()) != typeid(apTarget.afsDevice.ref());
 
-        //don't make the temp name longer than the original when hitting file system name length limitations: "lpMaximumComponentLength is commonly 255 characters"
-        while (tmpName.size() > 200) //BUT don't trim short names! we want early failure on filename-related issues
-            tmpName = getUnicodeSubstring(tmpName, 0 /*uniPosFirst*/, unicodeLength(tmpName) / 2 /*uniPosLast*/); //consider UTF encoding when cutting in the middle! (e.g. for macOS)
+        const AbstractPath apTargetTmp = getTempFilePath(apTarget, resumable ? &attrSource : nullptr); //throw FileError
 
-        const Zstring& shortGuid = printNumber<Zstring>(Zstr("%04x"), static_cast<unsigned int>(getCrc16(generateGUID())));
-
-        const AbstractPath apTargetTmp = appendRelPath(*parentPath, tmpName + Zstr('~') + shortGuid + TEMP_FILE_ENDING);
-        //-------------------------------------------------------------------------------------------
-
-        const FileCopyResult result = copyFilePlain(apTargetTmp); //throw FileError, ErrorFileLocked
+        const FileCopyResult result = resumable ?
+                                      apSource.afsDevice.ref().copyFileAsStream(apSource.afsPath, attrSource, apTargetTmp, calcContentHash, notifyUnbufferedIO, true /*resumable*/) : //throw FileError, ErrorFileLocked, X
+                                      copyFilePlain(apTargetTmp); //throw FileError, ErrorFileLocked
 
         //transactional behavior: ensure cleanup; not needed before copyFilePlain() which is already transactional
         ZEN_ON_SCOPE_FAIL( try { removeFilePlain(apTargetTmp); }
         catch (FileError&) {});
 
+        //save the delete round trip: overwrite target in a single rename operation (if supported by device)
+        if (onDeleteTargetFile && deleteTargetPermanently &&
+            typeid(apTargetTmp.afsDevice.ref()) == typeid(apTarget.afsDevice.ref()) &&
+            apTargetTmp.afsDevice.ref().tryMoveAndReplaceFileForSameAfsType(apTargetTmp.afsPath, apTarget)) //throw FileError
+            return result;
+
         //have target file deleted (after read access on source and target has been confirmed) => allow for almost transactional overwrite
         if (onDeleteTargetFile)
             onDeleteTargetFile(); //throw X
@@ -245,25 +675,331 @@ AFS::FileCopyResult AFS::copyFileTransactional(const AbstractPath& apSource, con
 }
 
 
+namespace
+{
+const size_t FAN_OUT_LAG_BUFFER_SIZE = 32 * 1024 * 1024; //per target: bounded lag of a slow target before the source read waits
+}
+
+
+//- one writer thread per target: AsyncStreamBuffer decouples targets => slowest target determines overall speed once its lag buffer is full
+//- writer threads count their bytes only: notifyUnbufferedIO is then called from the main thread
+std::vector<std::variant<AFS::FileCopyResult, FileError>> AFS::copyNewFileFanOut(const AbstractPath& apSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
+                                                                                 const std::vector<AbstractPath>& apTargets,
+                                                                                 bool transactionalCopy,
+                                                                                 const IoCallback& notifyUnbufferedIO /*throw X*/)
+{
+    std::atomic<int64_t> bytesWrittenAsync{0};
+    auto notifyUnbufferedWriteAsync = [&](int64_t bytesDelta) { bytesWrittenAsync += bytesDelta; }; //noexcept; called by writer threads
+
+    int64_t bytesReported = 0;
+    auto reportBytesWritten = [&] //throw X
+    {
+        const int64_t bytesWrittenTotal = bytesWrittenAsync;
+        if (notifyUnbufferedIO) notifyUnbufferedIO(bytesWrittenTotal - bytesReported); //throw X
+        bytesReported = bytesWrittenTotal;
+    };
+
+    const auto streamIn = getInputStream(apSource, nullptr /*notifyUnbufferedIO*/); //throw FileError, ErrorFileLocked; bytes read are not reported: reporting bytes written
+
+    StreamAttributes attrSourceNew = attrSource; //see copyFileAsStream()
+    if (std::optional<StreamAttributes> attr = streamIn->getAttributesBuffered()) //throw FileError
+        attrSourceNew = *attr;
+
+    const size_t blockSize = streamIn->getBlockSize();
+    if (blockSize == 0)
+        throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
+
+    struct TargetStream
+    {
+        AbstractPath apTarget;
+        AbstractPath apTargetTmp; //= apTarget for non-transactional copy
+        std::shared_ptr<AsyncStreamBuffer> asyncStream;
+        std::future<FinalizeResult> futFinalized;
+        InterruptibleThread writer;
+        std::optional<FileError> error;
+        bool finalized = false;
+    };
+    std::vector<TargetStream> targets;
+
+    for (const AbstractPath& apTarget : apTargets)
+    {
+        TargetStream& ts = targets.emplace_back(TargetStream{apTarget, apTarget});
+        try
+        {
+            if (transactionalCopy && !hasNativeTransactionalCopy(apTarget))
+                ts.apTargetTmp = getTempFilePath(apTarget, nullptr /*resumeSource*/); //throw FileError
+        }
+        catch (const FileError& e) { ts.error = e; continue; }
+
+        ts.asyncStream = std::make_shared<AsyncStreamBuffer>(FAN_OUT_LAG_BUFFER_SIZE);
+
+        std::promise<FinalizeResult> pFinalized;
+        ts.futFinalized = pFinalized.get_future();
+
+        ts.writer = InterruptibleThread([apTargetTmp = ts.apTargetTmp, attrSourceNew, blockSize, notifyUnbufferedWriteAsync,
+                                                     asyncStreamIn = ts.asyncStream,
+                                                     pFinalized    = std::move(pFinalized)]() mutable
+        {
+            setCurrentThreadName(Zstr("Ostream[Fan-out] ") + utfTo<Zstring>(getDisplayPath(apTargetTmp)));
+            try
+            {
+                //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
+                auto streamOut = getOutputStream(apTargetTmp, attrSourceNew.fileSize, attrSourceNew.modTime, notifyUnbufferedWriteAsync); //throw FileError
+
+                std::vector<std::byte> buffer(blockSize);
+                for (;;)
+                {
+                    const size_t bytesRead = asyncStreamIn->read(&buffer[0], blockSize); //throw ThreadStopRequest; return "bytesToRead" bytes unless end of stream!
+                    streamOut->write(&buffer[0], bytesRead); //throw FileError
+                    if (bytesRead != blockSize) //end of stream
+                        break;
+                }
+                pFinalized.set_value(streamOut->finalize()); //throw FileError
+            }
+            catch (FileError&)
+            {
+                const std::exception_ptr exptr = std::current_exception();
+                asyncStreamIn->setReadError(exptr); //set both!
+                pFinalized.set_exception(exptr);    //
+            }
+            //let ThreadStopRequest pass through!
+        });
+    }
+
+    //transactional behavior: ensure cleanup of finalized temp files
+    ZEN_ON_SCOPE_FAIL
+    (
+        for (TargetStream& ts : targets)
+        {
+            if (ts.asyncStream)
+                ts.asyncStream->setWriteError(std::make_exception_ptr(ThreadStopRequest())); //unblock writers *before* ~InterruptibleThread() joins
+            if (ts.finalized)
+                try { removeFilePlain(ts.apTargetTmp); /*throw FileError*/ }
+                catch (FileError&) {}
+        }
+    );
+
+    //feed all targets from a single source read
+    uint64_t totalBytesRead = 0;
+    std::vector<std::byte> buffer(blockSize);
+    for (;;)
+    {
+        const size_t bytesRead = streamIn->read(&buffer[0], blockSize); //throw FileError, ErrorFileLocked, X; return "bytesToRead" bytes unless end of stream!
+        totalBytesRead += bytesRead;
+
+        for (TargetStream& ts : targets)
+            if (!ts.error)
+                try
+                {
+                    ts.asyncStream->write(&buffer[0], bytesRead); //throw FileError; blocks while lag buffer is full
+                }
+                catch (const FileError& e) { ts.error = e; }
+
+        reportBytesWritten(); //throw X
+
+        if (bytesRead != blockSize) //end of stream
+            break;
+    }
+
+    //check incomplete input *before* failing with (slightly) misleading error message in OutputStream::finalize()
+    if (totalBytesRead != attrSourceNew.fileSize)
+        throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getDisplayPath(apSource))),
+                        replaceCpy(replaceCpy(_("Unexpected size of data stream.\nExpected: %x bytes\nActual: %y bytes"),
+                                              L"%x", formatNumber(attrSourceNew.fileSize)),
+                                   L"%y", formatNumber(totalBytesRead)));
+    for (TargetStream& ts : targets)
+        if (!ts.error)
+            ts.asyncStream->closeStream();
+
+    std::vector<std::variant<FileCopyResult, FileError>> results;
+    for (TargetStream& ts : targets)
+    {
+        if (!ts.error)
+            try
+            {
+                while (ts.futFinalized.wait_for(std::chrono::milliseconds(50)) == std::future_status::timeout)
+                    reportBytesWritten(); //throw X
+
+                const FinalizeResult finResult = ts.futFinalized.get(); //throw FileError
+                ts.finalized = true;
+
+                if (ts.apTargetTmp != ts.apTarget)
+                {
+                    //already existing: undefined behavior! (e.g. fail/overwrite)
+                    moveAndRenameItem(ts.apTargetTmp, ts.apTarget); //throw FileError, (ErrorMoveUnsupported)
+                    ts.finalized = false; //not a temp file anymore
+                }
+
+                FileCopyResult cpResult;
+                cpResult.fileSize        = attrSourceNew.fileSize;
+                cpResult.modTime         = attrSourceNew.modTime;
+                cpResult.sourceFilePrint = attrSourceNew.filePrint;
+                cpResult.targetFilePrint = finResult.filePrint;
+                cpResult.errorModTime    = finResult.errorModTime;
+                results.emplace_back(std::move(cpResult));
+                continue;
+            }
+            catch (const FileError& e)
+            {
+                ts.error = e;
+                if (ts.finalized)
+                {
+                    ts.finalized = false;
+                    try { removeFilePlain(ts.apTargetTmp); /*throw FileError*/ }
+                    catch (FileError&) {}
+                }
+            }
+        results.emplace_back(*ts.error);
+    }
+    reportBytesWritten(); //throw X
+    return results;
+}
+
+
+std::optional<AFS::FileCopyResult> AFS::updateFileDelta(const AbstractPath& apSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
+                                                        const AbstractPath& apTarget, uint64_t targetSize,
+                                                        const std::optional<EqualPrefix>& equalPrefix,
+                                                        bool transactionalCopy,
+                                                        const std::function<void()>& onDeleteTargetFile,
+                                                        bool deleteTargetPermanently,
+                                                        bool calcContentHash,
+                                                        const IoCallback& notifyUnbufferedIO /*throw X*/)
+{
+    const TraceSpan span = traceAfsOperation("afs delta update file", apTarget);
+
+    if (!transactionalCopy)
+    {
+        if (!deleteTargetPermanently) //old version must be kept (recycle bin, versioning)
+            return {};
+
+        //onDeleteTargetFile() is skipped just like for an atomic overwrite via tryMoveAndReplaceFileForSameAfsType()
+        return apTarget.afsDevice.ref().updateFileDeltaAsTarget(apTarget.afsPath, std::nullopt, apSource, attrSource, targetSize, equalPrefix, //throw FileError, ErrorFileLocked, X
+                                                                calcContentHash, notifyUnbufferedIO);
+    }
+
+    const AbstractPath apTargetTmp = getTempFilePath(apTarget, nullptr /*resumeSource*/); //throw FileError
+
+    const std::optional<FileCopyResult> result = apTarget.afsDevice.ref().updateFileDeltaAsTarget(apTarget.afsPath, apTargetTmp.afsPath, apSource, attrSource, targetSize, equalPrefix, //throw FileError, ErrorFileLocked, X
+                                                                                                  calcContentHash, notifyUnbufferedIO);
+    if (!result)
+        return {}; //not supported => nothing done
+
+    ZEN_ON_SCOPE_FAIL( try { removeFilePlain(apTargetTmp); }
+    catch (FileError&) {});
+
+    if (deleteTargetPermanently &&
+        apTarget.afsDevice.ref().tryMoveAndReplaceFileForSameAfsType(apTargetTmp.afsPath, apTarget)) //throw FileError
+        return result;
+
+    onDeleteTargetFile(); //throw X
+
+    //already existing: undefined behavior! (e.g. fail/overwrite)
+    moveAndRenameItem(apTargetTmp, apTarget); //throw FileError, (ErrorMoveUnsupported)
+    return result;
+}
+
+
+std::optional<std::vector<std::variant<AFS::FileCopyResult, FileError>>> AFS::copyNewFilesBulk(const std::vector<BulkCopyFile>& files, //throw X
+                                                                                              bool transactionalCopy,
+                                                                                              const IoCallback& notifyUnbufferedIO /*throw X*/)
+{
+    if (files.empty())
+        return std::vector<std::variant<FileCopyResult, FileError>>();
+
+    const std::optional<AbstractPath> parentPath = getParentPath(files[0].apTarget);
+    if (!parentPath || !supportsBulkCopy(files[0].apTarget))
+        return {};
+
+    const TraceSpan span = traceAfsOperation("afs bulk copy files", *parentPath);
+
+    std::vector<std::variant<FileCopyResult, FileError>> results(files.size());
+    std::vector<BulkFileData> bulkFiles;
+    std::vector<size_t> bulkIdxs; //bulkFiles[i] => results[bulkIdxs[i]]
+
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        const BulkCopyFile& file = files[i];
+        assert(getParentPath(file.apTarget) == parentPath);
+        try
+        {
+            const auto streamIn = getInputStream(file.apSource, nullptr /*notifyUnbufferedIO*/); //throw FileError, ErrorFileLocked; bytes read are not reported: reporting bytes written
+
+            StreamAttributes attrSourceNew = file.attrSource; //see copyFileAsStream()
+            if (std::optional<StreamAttributes> attr = streamIn->getAttributesBuffered()) //throw FileError
+                attrSourceNew = *attr;
+
+            BulkFileData bulkFile{getItemName(file.apTarget)};
+            if (transactionalCopy && !hasNativeTransactionalCopy(file.apTarget))
+                bulkFile.itemNameTmp = getItemName(getTempFilePath(file.apTarget, nullptr /*resumeSource*/)); //throw FileError
+            bulkFile.modTime = attrSourceNew.modTime;
+            bulkFile.data = bufferedLoad<std::string>(*streamIn); //throw FileError, ErrorFileLocked
+
+            bulkFiles.push_back(std::move(bulkFile));
+            bulkIdxs.push_back(i);
+            std::get<FileCopyResult>(results[i]).sourceFilePrint = attrSourceNew.filePrint;
+        }
+        catch (const FileError& e) { results[i] = e; }
+    }
+
+    if (bulkFiles.empty())
+        return results;
+
+    std::optional<std::vector<std::variant<FileCopyResult, FileError>>> bulkResults =
+        parentPath->afsDevice.ref().createNewFilesBulk(parentPath->afsPath, bulkFiles, notifyUnbufferedIO); //throw X
+    if (!bulkResults)
+        return {}; //=> nothing done
+
+    assert(bulkResults->size() == bulkFiles.size());
+    for (size_t i = 0; i < bulkFiles.size() && i < bulkResults->size(); ++i)
+    {
+        std::variant<FileCopyResult, FileError>& result = results[bulkIdxs[i]];
+
+        if (FileCopyResult* fcr = std::get_if<FileCopyResult>(&(*bulkResults)[i]))
+            fcr->sourceFilePrint = std::get<FileCopyResult>(result).sourceFilePrint;
+        result = std::move((*bulkResults)[i]);
+    }
+    return results;
+}
+
+
 bool AFS::createFolderIfMissingRecursion(const AbstractPath& ap) //throw FileError
+{
+    return createFolderIfMissingRecursionImpl(ap, nullptr); //throw FileError
+}
+
+
+bool AFS::createFolderIfMissingRecursion(const AbstractPath& ap, ExistingFolderCache& knownFolders) //throw FileError
+{
+    return createFolderIfMissingRecursionImpl(ap, &knownFolders); //throw FileError
+}
+
+
+bool AFS::createFolderIfMissingRecursionImpl(const AbstractPath& ap, ExistingFolderCache* knownFolders) //throw FileError
 {
     const std::optional<AbstractPath> parentPath = getParentPath(ap);
     if (!parentPath) //device root
         return false;
 
+    if (knownFolders && knownFolders->contains(ap))
+        return false;
+
     try //generally we expect that path already exists (see: versioning, base folder, log file path) => check first
     {
         if (getItemType(ap) != ItemType::file) //throw FileError
+        {
+            if (knownFolders) knownFolders->insert(ap);
             return false;
+        }
     }
     catch (FileError&) {} //not yet existing or access error? let's find out...
 
-    createFolderIfMissingRecursion(*parentPath); //throw FileError
+    createFolderIfMissingRecursionImpl(*parentPath, knownFolders); //throw FileError
 
     try
     {
         //already existing: fail
         createFolderPlain(ap); //throw FileError
+        if (knownFolders) knownFolders->insert(ap);
         return true;
     }
     catch (FileError&)
@@ -271,7 +1007,10 @@ bool AFS::createFolderIfMissingRecursion(const AbstractPath& ap) //throw FileErr
         try
         {
             if (getItemType(ap) != ItemType::file) //throw FileError
+            {
+                if (knownFolders) knownFolders->insert(ap);
                 return true; //already existing => possible, if createFolderIfMissingRecursion() is run in parallel
+            }
         }
         catch (FileError&) {} //not yet existing or access error
 
@@ -385,6 +1124,7 @@ void AFS::removeFolderIfExistsRecursion(const AfsPath& afsPath, //throw FileErro
 
 void AFS::removeFileIfExists(const AbstractPath& ap) //throw FileError
 {
+    const TraceSpan span = traceAfsOperation("afs remove file", ap);
     try
     {
         removeFilePlain(ap); //throw FileError
@@ -406,6 +1146,7 @@ void AFS::removeFileIfExists(const AbstractPath& ap) //throw FileError
 
 void AFS::removeSymlinkIfExists(const AbstractPath& ap) //throw FileError
 {
+    const TraceSpan span = traceAfsOperation("afs remove symlink", ap);
     try
     {
         removeSymlinkPlain(ap); //throw FileError
@@ -427,6 +1168,7 @@ void AFS::removeSymlinkIfExists(const AbstractPath& ap) //throw FileError
 
 void AFS::removeEmptyFolderIfExists(const AbstractPath& ap) //throw FileError
 {
+    const TraceSpan span = traceAfsOperation("afs remove folder", ap);
     try
     {
         removeFolderPlain(ap); //throw FileError
@@ -9,6 +9,10 @@
 
 #include <functional>
 #include <chrono>
+#include <span>
+#include <mutex>
+#include <set>
+#include <variant>
 #include <zen/file_error.h>
 #include <zen/zstring.h>
 #include <zen/serialize.h> //InputStream/OutputStream support buffered stream concept
@@ -22,6 +26,7 @@ bool isValidRelPath(const Zstring& relPath);
 AfsPath sanitizeDeviceRelativePath(Zstring relPath);
 
 struct AbstractFileSystem;
+class ExistingFolderCache;
 
 //==============================================================================================================
 using AfsDevice = zen::SharedRef<const AbstractFileSystem>;
@@ -75,9 +80,21 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
 
     static int getAccessTimeout(const AbstractPath& ap) { return ap.afsDevice.ref().getAccessTimeout(); } //returns "0" if no timeout in force
 
+    //hint: "sessionCount" parallel operations are coming up => connect asynchronously and keep sessions alive for a while (e.g. between comparison and sync)
+    static void prepareSessions(const AfsDevice& afsDevice, size_t sessionCount) { afsDevice.ref().prepareSessions(sessionCount); } //noexcept
+
     static bool supportPermissionCopy(const AbstractPath& apSource, const AbstractPath& apTarget); //throw FileError
 
     static bool hasNativeTransactionalCopy(const AbstractPath& ap) { return ap.afsDevice.ref().hasNativeTransactionalCopy(); }
+
+    //copyFileForSameAfsType() within the device doesn't transfer the data through this machine's network connection, e.g. server-side copy, local disk
+    static bool hasServerSideCopy(const AbstractPath& ap) { return ap.afsDevice.ref().hasServerSideCopy(); }
+
+    //NUMA node for the worker pool of a device: local disk => disk controller, else network adapters; -1: don't pin (see zen::selectNumaNode())
+    static int selectWorkerNumaNode(const AbstractPath& ap); //noexcept
+
+    //scan scheduling: native => underlying disk (see zen::getPhysicalDeviceId()); empty: device is identified by the AfsDevice alone
+    static std::string getPhysicalDeviceId(const AbstractPath& ap); //noexcept
     //----------------------------------------------------------------------------------------------------------------
 
     using FingerPrint = uint64_t; //AfsDevice-dependent persistent unique ID
@@ -90,22 +107,24 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
     };
     //(hopefully) fast: does not distinguish between error/not existing
     //root path? => do access test
-    static ItemType getItemType(const AbstractPath& ap) { return ap.afsDevice.ref().getItemType(ap.afsPath); } //throw FileError
+    static ItemType getItemType(const AbstractPath& ap); //throw FileError
 
     //assumes: - base path still exists
     //         - all child item path parts must correspond to folder traversal
     //    => we can conclude whether an item is *not* existing anymore by doing a *case-sensitive* name search => potentially SLOW!
     //      root path? => do access test
-    static std::optional<ItemType> itemStillExists(const AbstractPath& ap) { return ap.afsDevice.ref().itemStillExists(ap.afsPath); } //throw FileError
+    static std::optional<ItemType> itemStillExists(const AbstractPath& ap); //throw FileError
     //----------------------------------------------------------------------------------------------------------------
 
     //already existing: fail
     //does NOT create parent directories recursively if not existing
-    static void createFolderPlain(const AbstractPath& ap) { ap.afsDevice.ref().createFolderPlain(ap.afsPath); } //throw FileError
+    static void createFolderPlain(const AbstractPath& ap); //throw FileError
 
     //creates directories recursively if not existing
     //returns false if folder already exists
     static bool createFolderIfMissingRecursion(const AbstractPath& ap); //throw FileError
+    //skip existence checks for folders already known to exist (e.g. parent folders shared by many items)
+    static bool createFolderIfMissingRecursion(const AbstractPath& ap, ExistingFolderCache& knownFolders); //throw FileError
 
     static void removeFolderIfExistsRecursion(const AbstractPath& ap, //throw FileError
                                               const std::function<void (const std::wstring& displayPath)>& onBeforeFileDeletion /*throw X*/, //optional
@@ -116,9 +135,9 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
     static void removeSymlinkIfExists    (const AbstractPath& ap); //throw FileError
     static void removeEmptyFolderIfExists(const AbstractPath& ap); //
 
-    static void removeFilePlain   (const AbstractPath& ap) { ap.afsDevice.ref().removeFilePlain   (ap.afsPath); } //
-    static void removeSymlinkPlain(const AbstractPath& ap) { ap.afsDevice.ref().removeSymlinkPlain(ap.afsPath); } //throw FileError
-    static void removeFolderPlain (const AbstractPath& ap) { ap.afsDevice.ref().removeFolderPlain (ap.afsPath); } //
+    static void removeFilePlain   (const AbstractPath& ap); //
+    static void removeSymlinkPlain(const AbstractPath& ap); //throw FileError
+    static void removeFolderPlain (const AbstractPath& ap); //
     //----------------------------------------------------------------------------------------------------------------
     //static void setModTime(const AbstractPath& ap, time_t modTime) { ap.afsDevice.ref().setModTime(ap.afsPath, modTime); } //throw FileError, follows symlinks
 
@@ -136,6 +155,12 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
         FingerPrint filePrint; //optional
     };
 
+    struct EqualPrefix //leading bytes found equal when comparing source and target by content
+    {
+        uint64_t byteCount = 0;
+        time_t targetModTime = 0; //as of comparison: void if target (or source: StreamAttributes) changed since
+    };
+
     //----------------------------------------------------------------------------------------------------------------
     struct InputStream
     {
@@ -145,10 +170,37 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
 
         //only returns attributes if they are already buffered within stream handle and determination would be otherwise expensive (e.g. FTP/SFTP):
         virtual std::optional<StreamAttributes> getAttributesBuffered() = 0; //throw FileError
+
+        //positional reads (e.g. sampling, range-parallel comparison): independent from read() stream position => don't mix both on the same stream!
+        virtual bool supportsReadAt() const = 0;
+        virtual size_t readAt(uint64_t offset, void* buffer, size_t bytesToRead) = 0; //throw FileError, ErrorFileLocked, X; return "bytesToRead" bytes unless end of stream! (offset >= file size: 0)
+
+        //zero-copy: lend the stream's internal buffer holding the next block(s); valid until the next call on this stream; empty: end of stream
+        //don't mix with read()!
+        virtual bool supportsReadBorrowed() const { return false; }
+        virtual std::span<const std::byte> readBorrowed() //throw FileError, ErrorFileLocked, X
+        { throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + zen::numberTo<std::string>(__LINE__)); }
     };
     //return value always bound:
-    static std::unique_ptr<InputStream> getInputStream(const AbstractPath& ap, const zen::IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, ErrorFileLocked
-    { return ap.afsDevice.ref().getInputStream(ap.afsPath, notifyUnbufferedIO); }
+    static std::unique_ptr<InputStream> getInputStream(const AbstractPath& ap, const zen::IoCallback& notifyUnbufferedIO /*throw X*/); //throw FileError, ErrorFileLocked
+
+    //digests of file content known to the server, i.e. available without reading the data (e.g. Google Drive metadata, FTP HASH)
+    struct FileDigest
+    {
+        std::string md5;    //16 raw bytes; empty if not available
+        std::string sha256; //32 raw bytes; empty if not available
+    };
+    //symlink handling: follow
+    static FileDigest getServerFileDigest(const AbstractPath& ap) { return ap.afsDevice.ref().getServerFileDigest(ap.afsPath); } //throw FileError
+
+    //incremental comparison: items changed since the last committed checkpoint (old and new locations, relative to folderPath)
+    //  - starts a new checkpoint => commitChangeCheckpoint() once the last synchronous state of the folder pair is saved
+    //  - std::nullopt: not supported, no checkpoint yet, or changes not fully known => traverse everything
+    static std::optional<std::vector<Zstring>> getChangesSinceCheckpoint(const AbstractPath& folderPath, const std::string& checkpointId) //throw FileError
+    { return folderPath.afsDevice.ref().getChangesSinceCheckpoint(folderPath.afsPath, checkpointId); }
+
+    static void commitChangeCheckpoint(const AbstractPath& folderPath, const std::string& checkpointId) //throw FileError
+    { folderPath.afsDevice.ref().commitChangeCheckpoint(folderPath.afsPath, checkpointId); }
 
 
     struct FinalizeResult
@@ -162,6 +214,11 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
         virtual ~OutputStreamImpl() {}
         virtual void write(const void* buffer, size_t bytesToWrite) = 0; //throw FileError, X
         virtual FinalizeResult finalize() = 0;                           //throw FileError, X
+
+        //zero-copy: let caller fill the stream's internal buffer directly, then commit the bytes filled; empty: not supported (currently)
+        virtual std::span<std::byte> getWriteBuffer() { return {}; } //throw FileError, X
+        virtual void commitWrite(size_t bytesWritten)                //throw FileError, X
+        { throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + zen::numberTo<std::string>(__LINE__)); }
     };
 
     struct OutputStream //call finalize when done!
@@ -169,12 +226,16 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
         OutputStream(std::unique_ptr<OutputStreamImpl>&& outStream, const AbstractPath& filePath, std::optional<uint64_t> streamSize);
         ~OutputStream();
         void write(const void* buffer, size_t bytesToWrite); //throw FileError, X
+        std::span<std::byte> getWriteBuffer() { return outStream_->getWriteBuffer(); } //throw FileError, X
+        void commitWrite(size_t bytesWritten);               //throw FileError, X
         FinalizeResult finalize();                           //throw FileError, X
+        void keepOnFailure() { keepOnFailure_ = true; } //resumable copy: don't delete the partial file if not finalized
 
     private:
         std::unique_ptr<OutputStreamImpl> outStream_; //bound!
         const AbstractPath filePath_;
         bool finalizeSucceeded_ = false;
+        bool keepOnFailure_ = false;
         const std::optional<uint64_t> bytesExpected_;
         uint64_t bytesWrittenTotal_ = 0;
     };
@@ -182,8 +243,7 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
     static std::unique_ptr<OutputStream> getOutputStream(const AbstractPath& ap, //throw FileError
                                                          std::optional<uint64_t> streamSize,
                                                          std::optional<time_t> modTime,
-                                                         const zen::IoCallback& notifyUnbufferedIO /*throw X*/)
-    { return std::make_unique<OutputStream>(ap.afsDevice.ref().getOutputStream(ap.afsPath, streamSize, modTime, notifyUnbufferedIO), ap, streamSize); }
+                                                         const zen::IoCallback& notifyUnbufferedIO /*throw X*/);
     //----------------------------------------------------------------------------------------------------------------
 
     struct SymlinkInfo
@@ -199,12 +259,15 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
         time_t modTime; //number of seconds since Jan. 1st 1970 UTC
         FingerPrint filePrint; //optional; persistent + unique (relative to device) or 0!
         bool isFollowedSymlink;
+        uint32_t linkCount = 0; //optional: number of hard links (> 1: other items share filePrint) or 0!
     };
 
     struct FolderInfo
     {
         Zstring itemName;
         bool isFollowedSymlink;
+        uint64_t linkTargetDevice = 0;      //optional: followed symlinks only; identity of the link target folder
+        FingerPrint linkTargetFilePrint = 0; //=> e.g. st_dev + st_ino, or 0 if not supported
     };
 
     struct TraverserCallback
@@ -242,13 +305,12 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
     using TraverserWorkload = std::vector<std::pair<AfsPath, std::shared_ptr<TraverserCallback> /*throw X*/>>;
 
     //- client needs to handle duplicate file reports! (FilePlusTraverser fallback, retrying to read directory contents, ...)
-    static void traverseFolderRecursive(const AfsDevice& afsDevice, const TraverserWorkload& workload /*throw X*/, size_t parallelOps) { afsDevice.ref().traverseFolderRecursive(workload, parallelOps); }
+    static void traverseFolderRecursive(const AfsDevice& afsDevice, const TraverserWorkload& workload /*throw X*/, size_t parallelOps);
 
     static void traverseFolderFlat(const AbstractPath& ap, //throw FileError
                                    const std::function<void (const FileInfo&    fi)>& onFile,    //
                                    const std::function<void (const FolderInfo&  fi)>& onFolder,  //optional
-                                   const std::function<void (const SymlinkInfo& si)>& onSymlink) //
-    { ap.afsDevice.ref().traverseFolderFlat(ap.afsPath, onFile, onFolder, onSymlink); }
+                                   const std::function<void (const SymlinkInfo& si)>& onSymlink); //
     //----------------------------------------------------------------------------------------------------------------
 
     //already existing: undefined behavior! (e.g. fail/overwrite)
@@ -259,6 +321,11 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
     static inline const Zchar* const TEMP_FILE_ENDING = Zstr(".ffs_tmp"); //don't use Zstring as global constant: avoid static initialization order problem in global namespace!
     // caveat: ending is hard-coded by RealTimeSync
 
+    //large files: partial temp file of a failed copy is kept => next copy of the same source version continues at its end (after verifying the tail)
+    static inline const uint64_t RESUMABLE_COPY_MIN_SIZE = 64 * 1024 * 1024;
+    //deterministic name of a resumable temp file: depends on target file name and source version
+    static Zstring getResumableTempFileName(const Zstring& targetFileName, uint64_t sourceFileSize, time_t sourceModTime);
+
     struct FileCopyResult
     {
         uint64_t fileSize = 0;
@@ -266,6 +333,7 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
         FingerPrint sourceFilePrint = 0; //optional
         FingerPrint targetFilePrint = 0; //
         std::optional<zen::FileError> errorModTime; //failure to set modification time
+        std::string contentHash; //optional: SHA-256 (32 raw bytes) of the data written; see calcContentHash
     };
 
     //symlink handling: follow
@@ -278,9 +346,61 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
                                                 //if target is existing user *must* implement deletion to avoid undefined behavior
                                                 //if transactionalCopy == true, full read access on source had been proven at this point, so it's safe to delete it.
                                                 const std::function<void()>& onDeleteTargetFile /*throw X*/,
+                                                //true: onDeleteTargetFile() does nothing but delete apTarget permanently => may be skipped in favor of an atomic replace
+                                                bool deleteTargetPermanently,
+                                                //true: hash the data while streaming => FileCopyResult::contentHash; not available for copies within same AFS type (e.g. native file copy)
+                                                bool calcContentHash,
                                                 //accummulated delta != file size! consider ADS, sparse, compressed files
                                                 const zen::IoCallback& notifyUnbufferedIO /*throw X*/);
 
+    //fan-out: read source once, stream into several new files => failing targets don't affect the others
+    //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
+    //throws source errors only; returns one result per target
+    //symlink handling: follow
+    static std::vector<std::variant<FileCopyResult, zen::FileError>> copyNewFileFanOut(const AbstractPath& apSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
+                                                                                       const std::vector<AbstractPath>& apTargets,
+                                                                                       bool transactionalCopy,
+                                                                                       //bytes written, accumulated over all targets
+                                                                                       const zen::IoCallback& notifyUnbufferedIO /*throw X*/);
+
+    //update existing target file by transferring changed blocks only
+    //  transactionalCopy == true:  new file is built at a temp path, then replaces target (like copyFileTransactional())
+    //  transactionalCopy == false: target is modified in place (only if deleteTargetPermanently: no old version to keep)
+    //returns none if not supported by target device (or not applicable for this file) => nothing done: caller falls back to copyFileTransactional()
+    //symlink handling: follow
+    static std::optional<FileCopyResult> updateFileDelta(const AbstractPath& apSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
+                                                         const AbstractPath& apTarget, uint64_t targetSize /*possibly stale*/,
+                                                         const std::optional<EqualPrefix>& equalPrefix, //optional: range to neither read nor write
+                                                         bool transactionalCopy,
+                                                         const std::function<void()>& onDeleteTargetFile /*throw X*/, //must delete apTarget
+                                                         bool deleteTargetPermanently,
+                                                         bool calcContentHash,
+                                                         const zen::IoCallback& notifyUnbufferedIO /*throw X*/);
+
+    //bulk copy of small new files into one target folder: a single transfer instead of several round trips per file (e.g. SFTP: tar stream via SSH exec channel)
+    //  sources are read into memory first (=> small files only!) => source errors are reported per file without affecting the others
+    //already existing: undefined behavior! (e.g. fail/overwrite)
+    //returns one result per file; none: not supported by target device or bulk transfer failed as a whole => nothing done: caller copies file by file
+    //symlink handling: follow
+    struct BulkCopyFile
+    {
+        AbstractPath apSource;
+        StreamAttributes attrSource;
+        AbstractPath apTarget; //same parent folder for all files
+    };
+    static std::optional<std::vector<std::variant<FileCopyResult, zen::FileError>>> copyNewFilesBulk(const std::vector<BulkCopyFile>& files, //throw X
+                                                                                                     bool transactionalCopy,
+                                                                                                     const zen::IoCallback& notifyUnbufferedIO /*throw X*/);
+    static bool supportsBulkCopy(const AbstractPath& apTarget) { return apTarget.afsDevice.ref().supportsBulkCopy(); } //noexcept
+
+    struct BulkFileData //see createNewFilesBulk()
+    {
+        Zstring itemName;
+        Zstring itemNameTmp; //empty: write itemName in place
+        time_t modTime = 0;
+        std::string data;
+    };
+
     //already existing: fail
     //symlink handling: follow
     static void copyNewFolder(const AbstractPath& apSource, const AbstractPath& apTarget, bool copyFilePermissions); //throw FileError
@@ -288,6 +408,11 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
     //already existing: fail
     static void copySymlink(const AbstractPath& apSource, const AbstractPath& apTarget, bool copyFilePermissions); //throw FileError
 
+    //additional name for existing file apExisting (same device)
+    //already existing: fail
+    //returns false if not supported => nothing done: caller falls back to copying
+    static bool createHardLink(const AbstractPath& apExisting, const AbstractPath& apNew); //throw FileError
+
     //----------------------------------------------------------------------------------------------------------------
 
     static int64_t getFreeDiskSpace(const AbstractPath& ap) { return ap.afsDevice.ref().getFreeDiskSpace(ap.afsPath); } //throw FileError, returns < 0 if not available
@@ -306,7 +431,7 @@ struct AbstractFileSystem //THREAD-SAFETY: "const" member functions must model t
     //precondition: supportsRecycleBin() must return true!
     static std::unique_ptr<RecycleSession> createRecyclerSession(const AbstractPath& ap) { return ap.afsDevice.ref().createRecyclerSession(ap.afsPath); } //throw FileError, return value must be bound!
 
-    static void recycleItemIfExists(const AbstractPath& ap) { ap.afsDevice.ref().recycleItemIfExists(ap.afsPath); } //throw FileError
+    static void recycleItemIfExists(const AbstractPath& ap); //throw FileError
 
     //================================================================================================================
 
@@ -329,12 +454,57 @@ protected:
                             const std::function<void (const SymlinkInfo& si)>& onSymlink) const; //
 
     //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
+    //resumable: apTarget may be the partial file of a previous copy => continue if the data matches; failure: keep partial file
     FileCopyResult copyFileAsStream(const AfsPath& afsSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
-                                    const AbstractPath& apTarget, const zen::IoCallback& notifyUnbufferedIO /*throw X*/) const;
+                                    const AbstractPath& apTarget, bool calcContentHash, const zen::IoCallback& notifyUnbufferedIO /*throw X*/,
+                                    bool resumable = false) const;
+
+    //can items be renamed between both devices? e.g. same server/account, but different root paths; different mount points of the same file system
+    //default implementation: equivalent devices only
+    virtual bool isMoveCompatibleSameAfsType(const AbstractFileSystem& afsRhs) const { return compareDeviceSameAfsType(afsRhs) == std::weak_ordering::equivalent; } //noexcept
 
 private:
     virtual std::optional<Zstring> getNativeItemPath(const AfsPath& afsPath) const { return {}; };
 
+    //default implementation: not supported
+    //afsTargetTmp: not existing; on success: complete copy of apSource (including modification time), on failure: cleaned up
+    //              none: update afsTarget in place instead
+    virtual std::optional<FileCopyResult> updateFileDeltaAsTarget(const AfsPath& afsTarget, const std::optional<AfsPath>& afsTargetTmp, //throw FileError, ErrorFileLocked, X
+                                                                  const AbstractPath& apSource, const StreamAttributes& attrSource, uint64_t targetSize,
+                                                                  const std::optional<EqualPrefix>& equalPrefix,
+                                                                  bool calcContentHash, const zen::IoCallback& notifyUnbufferedIO /*throw X*/) const { return {}; }
+
+    //default implementation: not supported
+    virtual bool supportsBulkCopy() const { return false; }
+    //precondition: supportsBulkCopy() == true
+    //write new files into afsFolder; none: failed as a whole => cleaned up
+    virtual std::optional<std::vector<std::variant<FileCopyResult, zen::FileError>>> createNewFilesBulk(const AfsPath& afsFolder, const std::vector<BulkFileData>& files, //throw X
+                                                                                                        const zen::IoCallback& notifyUnbufferedIO /*throw X*/) const
+    { throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + zen::numberTo<std::string>(__LINE__)); }
+
+    //default implementation: not supported
+    virtual FileDigest getServerFileDigest(const AfsPath& afsPath) const { return {}; } //throw FileError
+
+    //default implementation: not supported
+    virtual bool hasServerSideCopy() const { return false; }
+
+    //default implementation: not supported
+    //resumable copy: size of an existing partial file; none: not existing, not accessible, or appending not supported
+    virtual std::optional<uint64_t> getPartialFileSize(const AfsPath& afsPath) const { return {}; } //noexcept
+    //continue writing at the end of an existing file (=> only if getPartialFileSize() is supported)
+    virtual std::unique_ptr<OutputStreamImpl> getOutputStreamAppend(const AfsPath& afsPath, //throw FileError
+                                                                    std::optional<uint64_t> bytesToAppend,
+                                                                    std::optional<time_t> modTime,
+                                                                    const zen::IoCallback& notifyUnbufferedIO /*throw X*/) const
+    { throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + zen::numberTo<std::string>(__LINE__)); }
+
+    //default implementation: not supported
+    virtual std::optional<std::vector<Zstring>> getChangesSinceCheckpoint(const AfsPath& folderPath, const std::string& checkpointId) const { return {}; } //throw FileError
+    virtual void commitChangeCheckpoint(const AfsPath& folderPath, const std::string& checkpointId) const {} //throw FileError
+
+    //default implementation: not supported
+    virtual bool createHardLinkForSameAfsType(const AfsPath& afsExisting, const AbstractPath& apNew) const { return false; } //throw FileError
+
     virtual Zstring getInitPathPhrase(const AfsPath& afsPath) const = 0;
 
     virtual std::wstring getDisplayPath(const AfsPath& afsPath) const = 0;
@@ -377,6 +547,9 @@ private:
     //already existing: undefined behavior! (e.g. fail/overwrite)
     virtual void moveAndRenameItemForSameAfsType(const AfsPath& pathFrom, const AbstractPath& pathTo) const = 0; //throw FileError, ErrorMoveUnsupported
 
+    //already existing: replace atomically (no point in time without target file); returns false if not supported by device => nothing done
+    virtual bool tryMoveAndReplaceFileForSameAfsType(const AfsPath& pathFrom, const AbstractPath& pathTo) const = 0; //throw FileError
+
     //symlink handling: follow
     //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
     virtual FileCopyResult copyFileForSameAfsType(const AfsPath& afsSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
@@ -400,6 +573,8 @@ private:
 
     virtual int getAccessTimeout() const = 0; //returns "0" if no timeout in force
 
+    virtual void prepareSessions(size_t sessionCount) const = 0; //noexcept
+
     virtual bool hasNativeTransactionalCopy() const = 0;
     //----------------------------------------------------------------------------------------------------------------
 
@@ -407,6 +582,8 @@ private:
     virtual bool supportsRecycleBin(const AfsPath& afsPath) const  = 0; //throw FileError
     virtual std::unique_ptr<RecycleSession> createRecyclerSession(const AfsPath& afsPath) const = 0; //throw FileError, return value must be bound!
     virtual void recycleItemIfExists(const AfsPath& afsPath) const = 0; //throw FileError
+
+    static bool createFolderIfMissingRecursionImpl(const AbstractPath& ap, ExistingFolderCache* knownFolders); //throw FileError
 };
 
 
@@ -424,6 +601,35 @@ inline
 bool operator==(const AbstractPath& lhs, const AbstractPath& rhs) { return lhs.afsPath == rhs.afsPath && lhs.afsDevice == rhs.afsDevice; }
 
 
+/*  folders known to exist during a multi-item operation (e.g. versioning, "copy to"): each item's parent path is checked only once;
+    on SFTP, FTP, Google Drive every check is a round trip. THREAD-SAFETY: internally synchronized
+    => only valid while no one else deletes these folders: don't keep beyond a single operation */
+class ExistingFolderCache
+{
+public:
+    ExistingFolderCache() {}
+
+    bool contains(const AbstractPath& folderPath) const
+    {
+        std::lock_guard dummy(lockFolders_);
+        return folders_.contains(folderPath);
+    }
+
+    void insert(const AbstractPath& folderPath)
+    {
+        std::lock_guard dummy(lockFolders_);
+        folders_.insert(folderPath);
+    }
+
+private:
+    ExistingFolderCache           (const ExistingFolderCache&) = delete;
+    ExistingFolderCache& operator=(const ExistingFolderCache&) = delete;
+
+    mutable std::mutex lockFolders_;
+    std::set<AbstractPath> folders_; //protected by lockFolders_
+};
+
+
 
 
 
@@ -453,7 +659,7 @@ AbstractFileSystem::OutputStream::~OutputStream()
     //we delete the file on errors: => file should not have existed prior to creating OutputStream instance!!
     outStream_.reset(); //close file handle *before* remove!
 
-    if (!finalizeSucceeded_) //transactional output stream! => clean up!
+    if (!finalizeSucceeded_ && !keepOnFailure_) //transactional output stream! => clean up!
         //- needed for Google Drive: e.g. user might cancel during OutputStreamImpl::finalize(), just after file was written transactionally
         //- also for Native: setFileTime() may fail *after* FileOutput::finalize()
         try { AbstractFileSystem::removeFilePlain(filePath_); /*throw FileError*/ }
@@ -469,6 +675,14 @@ void AbstractFileSystem::OutputStream::write(const void* data, size_t len) //thr
 }
 
 
+inline
+void AbstractFileSystem::OutputStream::commitWrite(size_t bytesWritten) //throw FileError, X
+{
+    outStream_->commitWrite(bytesWritten); //throw FileError, X
+    bytesWrittenTotal_ += bytesWritten;
+}
+
+
 inline
 AbstractFileSystem::FinalizeResult AbstractFileSystem::OutputStream::finalize() //throw FileError, X
 {
@@ -509,21 +723,6 @@ bool AbstractFileSystem::equalSymlinkContent(const AbstractPath& apLhs, const Ab
 }
 
 
-inline
-void AbstractFileSystem::moveAndRenameItem(const AbstractPath& pathFrom, const AbstractPath& pathTo) //throw FileError, ErrorMoveUnsupported
-{
-    using namespace zen;
-
-    if (typeid(pathFrom.afsDevice.ref()) != typeid(pathTo.afsDevice.ref()))
-        throw ErrorMoveUnsupported(replaceCpy(replaceCpy(_("Cannot move file %x to %y."),
-                                                         L"%x", L'\n' + fmtPath(getDisplayPath(pathFrom))),
-                                              L"%y", L'\n' + fmtPath(getDisplayPath(pathTo))), _("Operation not supported between different devices."));
-
-    //already existing: undefined behavior! (e.g. fail/overwrite)
-    pathFrom.afsDevice.ref().moveAndRenameItemForSameAfsType(pathFrom.afsPath, pathTo); //throw FileError, ErrorMoveUnsupported
-}
-
-
 inline
 void AbstractFileSystem::copyNewFolder(const AbstractPath& apSource, const AbstractPath& apTarget, bool copyFilePermissions) //throw FileError
 {
@@ -558,6 +757,17 @@ void AbstractFileSystem::copySymlink(const AbstractPath& apSource, const Abstrac
     //already existing: fail
     apSource.afsDevice.ref().copySymlinkForSameAfsType(apSource.afsPath, apTarget, copyFilePermissions); //throw FileError
 }
+
+
+inline
+bool AbstractFileSystem::createHardLink(const AbstractPath& apExisting, const AbstractPath& apNew) //throw FileError
+{
+    if (typeid(apExisting.afsDevice.ref()) != typeid(apNew.afsDevice.ref()))
+        return false;
+
+    //already existing: fail
+    return apExisting.afsDevice.ref().createHardLinkForSameAfsType(apExisting.afsPath, apNew); //throw FileError
+}
 }
 
 #endif //ABSTRACT_H_873450978453042524534234
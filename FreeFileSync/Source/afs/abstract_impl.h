@@ -7,6 +7,7 @@
 #ifndef IMPL_HELPER_H_873450978453042524534234
 #define IMPL_HELPER_H_873450978453042524534234
 
+#include <array>
 #include "abstract.h"
 #include <zen/thread.h>
 #include <zen/stream_buffer.h>
@@ -73,6 +74,8 @@ class PathAccessLocker
             Google Drive => put dummy entry in GdriveFileState? problem: there is no fail-free removal: accessGlobalFileState() can throw!
             MTP          => no (buffered) state                                                   */
     };
+    using PathLockMap = std::map<NativePath, std::weak_ptr<BlockInfo>>;
+
 public:
     PathAccessLocker() {}
 
@@ -86,31 +89,30 @@ public:
     class Lock
     {
     public:
-        Lock(const NativePath& nativePath, BlockType blockType) : blockType_(blockType) //throw SysError
+        Lock(const NativePath& nativePath, BlockType blockType) : blockType_(blockType), nativePath_(nativePath) //throw SysError
         {
             using namespace zen;
 
-            if (const std::shared_ptr<PathAccessLocker> pal = getGlobalInstance())
-                pal->pathLocks_.access([&](std::map<NativePath, std::weak_ptr<BlockInfo>>& pathLocks)
-            {
-                //clean up obsolete entries
-                std::erase_if(pathLocks, [](const auto& v) { return !v.second.lock(); });
+            pal_ = getGlobalInstance();
+            if (!pal_)
+                throw SysError(L"PathAccessLocker::Lock() function call not allowed during init/shutdown.");
 
+            pal_->getShard(nativePath_).access([&](PathLockMap& pathLocks)
+            {
                 //get or create:
-                std::weak_ptr<BlockInfo>& weakPtr = pathLocks[nativePath];
+                std::weak_ptr<BlockInfo>& weakPtr = pathLocks[nativePath_];
                 blockInfo_ = weakPtr.lock();
                 if (!blockInfo_)
                     weakPtr = blockInfo_ = std::make_shared<BlockInfo>();
             });
-            else
-                throw SysError(L"PathAccessLocker::Lock() function call not allowed during init/shutdown.");
+            ZEN_ON_SCOPE_FAIL(releaseBlockInfo());
 
             blockInfo_->m.lock();
 
             if (blockInfo_->itemInUse)
             {
                 blockInfo_->m.unlock();
-                throw SysError(replaceCpy(_("The item %x is currently in use."), L"%x", fmtPath(getItemName(nativePath))));
+                throw SysError(replaceCpy(_("The item %x is currently in use."), L"%x", fmtPath(getItemName(nativePath_))));
             }
 
             if (blockType == BlockType::otherFail)
@@ -129,13 +131,28 @@ public:
             }
 
             blockInfo_->m.unlock();
+            releaseBlockInfo();
         }
 
     private:
         Lock           (const Lock&) = delete;
         Lock& operator=(const Lock&) = delete;
 
+        void releaseBlockInfo() //noexcept
+        {
+            blockInfo_.reset();
+            //last user cleans up: no need to scan for obsolete entries; lookup happens under the same shard lock => no race with get-or-create
+            pal_->getShard(nativePath_).access([&](PathLockMap& pathLocks)
+            {
+                if (auto it = pathLocks.find(nativePath_);
+                    it != pathLocks.end() && it->second.expired())
+                    pathLocks.erase(it);
+            });
+        }
+
         const BlockType blockType_; //[!] needed: we can't instead check "itemInUse" (without locking first)
+        const NativePath nativePath_;
+        std::shared_ptr<PathAccessLocker> pal_;
         std::shared_ptr<BlockInfo> blockInfo_;
     };
 
@@ -145,8 +162,12 @@ private:
 
     static std::shared_ptr<PathAccessLocker> getGlobalInstance();
     static Zstring getItemName(const NativePath& nativePath);
+    static size_t getPathHash(const NativePath& nativePath); //equal paths (see operator<=>) => equal hash
+
+    //striped by path hash: many parallel operations (e.g. Google Drive) don't all contend for a single mutex
+    zen::Protected<PathLockMap>& getShard(const NativePath& nativePath) { return pathLocks_[getPathHash(nativePath) % pathLocks_.size()]; }
 
-    zen::Protected<std::map<NativePath, std::weak_ptr<BlockInfo>>> pathLocks_;
+    std::array<zen::Protected<PathLockMap>, 64> pathLocks_;
 };
 
 }
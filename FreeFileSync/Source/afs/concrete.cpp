@@ -9,6 +9,9 @@
 #include "ftp.h"
 #include "sftp.h"
 #include "gdrive.h"
+#include "simulated.h"
+#include "listing_cache.h"
+#include "init_curl_libssh2.h"
 
 using namespace fff;
 
@@ -19,12 +22,18 @@ void fff::initAfs(const AfsConfig& cfg)
     sftpInit();
     gdriveInit(appendSeparator(cfg.configDirPathPf)   + Zstr("GoogleDrive"),
                appendSeparator(cfg.resourceDirPathPf) + Zstr("cacert.pem"));
+    listingCacheInit(appendSeparator(cfg.configDirPathPf) + Zstr("ListingCache"));
 }
 
 
 std::wstring /*warningMsg*/ fff::teardownAfs()
 {
     std::wstring warningMsg = gdriveTeardown();
+
+    if (const std::wstring& msg = listingCacheTeardown();
+        !msg.empty())
+        warningMsg += (warningMsg.empty() ? L"" : L"\n\n") + msg;
+
     sftpTeardown();
     ftpTeardown();
     return warningMsg;
@@ -45,13 +54,25 @@ AbstractPath fff::createAbstractPath(const Zstring& itemPathPhrase) //noexcept
 
     //then the rest:
     if (acceptsItemPathPhraseFtp(itemPathPhrase)) //noexcept
+    {
+        zen::startLibsshCurlUnifiedInit(); //noexcept; overlap network stack init with the remaining setup
         return createItemPathFtp(itemPathPhrase); //noexcept
+    }
 
     if (acceptsItemPathPhraseSftp(itemPathPhrase)) //noexcept
+    {
+        zen::startLibsshCurlUnifiedInit(); //noexcept; overlap network stack init with the remaining setup
         return createItemPathSftp(itemPathPhrase); //noexcept
+    }
 
     if (acceptsItemPathPhraseGdrive(itemPathPhrase)) //noexcept
+    {
+        zen::startLibsshCurlUnifiedInit(); //noexcept; overlap network stack init with the remaining setup
         return createItemPathGdrive(itemPathPhrase); //noexcept
+    }
+
+    if (acceptsItemPathPhraseSimulated(itemPathPhrase)) //noexcept
+        return createItemPathSimulated(itemPathPhrase); //noexcept
 
 
     //no idea? => native!
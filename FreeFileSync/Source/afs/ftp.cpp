@@ -10,10 +10,12 @@
 #include <zen/globals.h>
 #include <zen/resolve_path.h>
 #include <zen/time.h>
+#include <zen/socket.h>
 #include <libcurl/curl_wrap.h> //DON'T include <curl/curl.h> directly!
 #include "init_curl_libssh2.h"
 #include "ftp_common.h"
 #include "abstract_impl.h"
+#include "listing_cache.h"
     #include <glib.h>
     #include <fcntl.h>
 
@@ -29,6 +31,8 @@ namespace
 
 constexpr std::chrono::seconds FTP_SESSION_MAX_IDLE_TIME  (20);
 constexpr std::chrono::seconds FTP_SESSION_CLEANUP_INTERVAL(4);
+constexpr std::chrono::seconds FTP_SESSION_KEEP_WARM_TIME (60); //after last prepareSessions() hint: e.g. user reviewing comparison result before sync
+const size_t FTP_SESSION_WARM_UP_PARALLEL_MAX = 16;
 const int FTP_STREAM_BUFFER_SIZE = 512 * 1024; //unit: [byte]
 //FTP stream buffer should be at least as big as the biggest AFS block size (currently 256 KB for MTP),
 //but there seems to be no reason for an upper limit
@@ -64,8 +68,8 @@ std::weak_ordering operator<=>(const FtpSessionId& lhs, const FtpSessionId& rhs)
     const int portLhs = getEffectivePort(lhs.port);
     const int portRhs = getEffectivePort(rhs.port);
 
-    return std::tie(portLhs, lhs.username, lhs.password, lhs.useTls) <=> //username, password: case sensitive!
-           std::tie(portRhs, rhs.username, rhs.password, rhs.useTls);
+    return std::tie(portLhs, lhs.username, lhs.password, lhs.useTls, lhs.socketBufferBytes, lhs.socketNotSentLowAt, lhs.congestionControl) <=> //username, password: case sensitive!
+           std::tie(portRhs, rhs.username, rhs.password, rhs.useTls, rhs.socketBufferBytes, rhs.socketNotSentLowAt, rhs.congestionControl);
 }
 }
 
@@ -75,7 +79,7 @@ namespace
 Zstring concatenateFtpFolderPathPhrase(const FtpLogin& login, const AfsPath& afsPath); //noexcept
 
 
-Zstring ansiToUtfEncoding(const std::string& str) //throw SysError
+Zstring ansiToUtfEncoding(const std::string_view str) //throw SysError
 {
     gsize bytesWritten = 0; //not including the terminating null
 
@@ -83,7 +87,7 @@ Zstring ansiToUtfEncoding(const std::string& str) //throw SysError
     ZEN_ON_SCOPE_EXIT(if (error) ::g_error_free(error));
 
     //https://developer.gnome.org/glib/stable/glib-Character-Set-Conversion.html#g-convert
-    gchar* utfStr = ::g_convert(str.c_str(),   //const gchar* str
+    gchar* utfStr = ::g_convert(str.data(),    //const gchar* str
                                 str.size(),    //gssize len
                                 "UTF-8",       //const gchar* to_codeset
                                 "LATIN1",      //const gchar* from_codeset
@@ -91,7 +95,7 @@ Zstring ansiToUtfEncoding(const std::string& str) //throw SysError
                                 &bytesWritten, //gsize* bytes_written
                                 &error);       //GError** error
     if (!utfStr)
-        throw SysError(formatGlibError("g_convert(" + utfTo<std::string>(str) + ')', error));
+        throw SysError(formatGlibError("g_convert(" + std::string(str) + ')', error));
     ZEN_ON_SCOPE_EXIT(::g_free(utfStr));
 
     return {utfStr, bytesWritten};
@@ -123,7 +127,7 @@ std::string utfToAnsiEncoding(const Zstring& str) //throw SysError
 }
 
 
-Zstring serverToUtfEncoding(const std::string& str, ServerEncoding enc) //throw SysError
+Zstring serverToUtfEncoding(const std::string_view str, ServerEncoding enc) //throw SysError
 {
     switch (enc)
     {
@@ -187,13 +191,27 @@ std::vector<std::string> splitFtpResponse(const std::string& buf)
 }
 
 
+//same as splitFtpResponse(), but without allocations: for (huge) folder listings
+template <class Function> inline
+void forEachFtpResponseLine(const std::string& buf, Function onLine /*(std::string_view line) throw X*/) //throw X
+{
+    split2(buf, [](char c) { return isLineBreak(c) || c == '\0'; },
+    [&onLine](const char* blockFirst, const char* blockLast)
+    {
+        if (blockFirst != blockLast)
+            onLine(makeStringView(blockFirst, blockLast)); //throw X
+    });
+}
+
+
 class FtpLineParser
 {
 public:
-    explicit FtpLineParser(const std::string& line) : line_(line), it_(line_.begin()) {}
+    explicit FtpLineParser(const std::string_view line) : line_(line), it_(line_.begin()) {}
 
+    //returned ranges are views into the line
     template <class Function>
-    std::string readRange(size_t count, Function acceptChar) //throw SysError
+    std::string_view readRange(size_t count, Function acceptChar) //throw SysError
     {
         if (static_cast<ptrdiff_t>(count) > line_.end() - it_)
             throw SysError(L"Unexpected end of line.");
@@ -201,16 +219,16 @@ public:
         if (!std::all_of(it_, it_ + count, acceptChar))
             throw SysError(L"Expected char type not found.");
 
-        std::string output(it_, it_ + count);
+        const std::string_view output = makeStringView(it_, it_ + count);
         it_ += count;
         return output;
     }
 
     template <class Function> //expects non-empty range!
-    std::string readRange(Function acceptChar) //throw SysError
+    std::string_view readRange(Function acceptChar) //throw SysError
     {
         auto itEnd = std::find_if_not(it_, line_.end(), acceptChar);
-        std::string output(it_, itEnd);
+        const std::string_view output = makeStringView(it_, itEnd);
         if (output.empty())
             throw SysError(L"Expected char range not found.");
         it_ = itEnd;
@@ -220,8 +238,8 @@ public:
     char peekNextChar() const { return it_ == line_.end() ? '\0' : *it_; }
 
 private:
-    const std::string line_;
-    std::string::const_iterator it_;
+    const std::string_view line_;
+    std::string_view::const_iterator it_;
 };
 
 //----------------------------------------------------------------------------------------------------------------
@@ -373,6 +391,13 @@ public:
         options.emplace_back(CURLOPT_TCP_KEEPALIVE, 1); //=> CURLOPT_TCP_KEEPIDLE (=delay) and CURLOPT_TCP_KEEPINTVL both default to 60 sec
 
 
+        const SocketTuning socketTuning //control + data connections
+        {
+            .bufferBytes       = sessionId_.socketBufferBytes,
+            .notSentLowAtBytes = sessionId_.socketNotSentLowAt,
+            .congestionControl = utfTo<std::string>(sessionId_.congestionControl),
+        };
+
         std::optional<SysError> callbackException;
         //libcurl does *not* set FD_CLOEXEC for us! https://github.com/curl/curl/issues/2252
         auto onSocketCreate = [&](curl_socket_t curlfd, curlsocktype purpose)
@@ -383,6 +408,16 @@ public:
                 callbackException = SysError(formatSystemError("fcntl(FD_CLOEXEC)", errno));
                 return CURL_SOCKOPT_ERROR;
             }
+
+            try
+            {
+                applySocketTuning(curlfd, socketTuning); //throw SysError
+            }
+            catch (const SysError& e)
+            {
+                callbackException = e;
+                return CURL_SOCKOPT_ERROR;
+            }
             return CURL_SOCKOPT_OK;
         };
 
@@ -480,6 +515,8 @@ public:
         {
             options.emplace_back(CURLOPT_USE_SSL,    CURLUSESSL_ALL); //require SSL for both control and data
             options.emplace_back(CURLOPT_FTPSSLAUTH, CURLFTPAUTH_TLS); //try TLS first, then SSL (currently: CURLFTPAUTH_DEFAULT == CURLFTPAUTH_SSL)
+            //data connections resume the control connection's TLS session (required by e.g. vsftpd "require_ssl_reuse"):
+            //  session ID cache is per easy handle and survives curl_easy_reset() => reuse easyHandle_ for the life time of FtpSession!
         }
 
         //let's not hold our breath until Curl adds a reasonable PASV handling => patch libcurl accordingly!
@@ -643,6 +680,34 @@ public:
     bool supportsClnt() { return getFeatureSupport(&Features::clnt); } //
     bool supportsUtf8() { return getFeatureSupport(&Features::utf8); } //
 
+    //server-side checksum without downloading: empty if the server supports none of HASH, XSHA256, XMD5
+    AFS::FileDigest getFileDigest(const AfsPath& afsPath) //throw SysError
+    {
+        AFS::FileDigest digest;
+        const std::string serverPath = getServerPathInternal(afsPath); //throw SysError
+
+        if (getFeatureSupport(&Features::hashSha256)) //throw SysError
+        {
+            //"213" SP hashname SP bytes SP hash SP pathname, e.g. "213 SHA-256 0-49 169cd22282da7f147cb491e559e9dd... filename"
+            if (selectHashAlgorithm("SHA-256")) //throw SysError
+                digest.sha256 = parseHashResponse(runSingleFtpCommand("*HASH " + serverPath, true /*requiresUtf8*/), 32); //throw SysError
+        }
+        else if (getFeatureSupport(&Features::xsha256)) //throw SysError
+            digest.sha256 = parseHashResponse(runSingleFtpCommand("*XSHA256 " + serverPath, true /*requiresUtf8*/), 32); //throw SysError
+
+        if (digest.sha256.empty())
+        {
+            if (getFeatureSupport(&Features::hashMd5)) //throw SysError
+            {
+                if (selectHashAlgorithm("MD5")) //throw SysError
+                    digest.md5 = parseHashResponse(runSingleFtpCommand("*HASH " + serverPath, true /*requiresUtf8*/), 16); //throw SysError
+            }
+            else if (getFeatureSupport(&Features::xmd5)) //throw SysError
+                digest.md5 = parseHashResponse(runSingleFtpCommand("*XMD5 " + serverPath, true /*requiresUtf8*/), 16); //throw SysError
+        }
+        return digest;
+    }
+
     ServerEncoding getServerEncoding() { return supportsUtf8() ? ServerEncoding::utf8 : ServerEncoding::ansi; } //throw SysError
 
     bool isHealthy() const
@@ -650,6 +715,21 @@ public:
         return std::chrono::steady_clock::now() - lastSuccessfulUseTime_ <= FTP_SESSION_MAX_IDLE_TIME;
     }
 
+    //prevent idle session from timing out (both server-side and isHealthy())
+    void keepAlive(int timeoutSec) //noexcept
+    {
+        assert(isHealthy());
+        if (std::chrono::steady_clock::now() - lastSuccessfulUseTime_ > FTP_SESSION_MAX_IDLE_TIME / 2)
+            try
+            {
+                const std::shared_ptr<int> timeoutSecCtx = std::make_shared<int>(timeoutSec); //context option: valid only for duration of this call!
+                setContextTimeout(timeoutSecCtx);
+
+                runSingleFtpCommand("*NOOP", false /*requiresUtf8*/); //throw SysError; any FTP response will do: see testConnection()
+            }
+            catch (SysError&) { lastSuccessfulUseTime_ = std::chrono::steady_clock::time_point(); } //=> !isHealthy()
+    }
+
     std::string getServerPathInternal(const AfsPath& afsPath) //throw SysError
     {
         const Zstring serverPath = getServerRelPath(afsPath);
@@ -746,6 +826,10 @@ private:
         bool mfmt = false;
         bool clnt = false;
         bool utf8 = false;
+        bool hashSha256 = false;
+        bool hashMd5    = false;
+        bool xsha256    = false;
+        bool xmd5       = false;
     };
     using FeatureList = std::map<Zstring /*server name*/, std::optional<Features>, LessAsciiNoCase>;
 
@@ -765,8 +849,13 @@ private:
             if (!featureCache_)
             {
                 //*: ignore error if server does not support/allow FEAT
-                featureCache_ = parseFeatResponse(runSingleFtpCommand("*FEAT", false /*requiresUtf8*/)); //throw SysError
+                const std::string& featBuf = runSingleFtpCommand("*FEAT", false /*requiresUtf8*/); //throw SysError
                 //used by ensureUtf8()! => requiresUtf8 = false!!!
+                featureCache_ = parseFeatResponse(featBuf);
+
+                //no feature list at all, e.g. "550 FEAT: Operation not permitted": don't fall back to LIST (imprecise times, fragile parsing) without asking
+                if (!featureCache_->mlsd && !hasFeatList(featBuf))
+                    featureCache_->mlsd = probeMlst(); //throw SysError
 
                 sf->access([&](FeatureList& feat) { feat[sessionId_.server] = featureCache_; });
             }
@@ -774,6 +863,64 @@ private:
         return (*featureCache_).*status;
     }
 
+    bool selectHashAlgorithm(const std::string& algo) //throw SysError
+    {
+        //the HASH algorithm is connection state, just like "TYPE I"
+        if (std::optional<curl_socket_t> currentSocket = getActiveSocket()) //throw SysError
+            if (*currentSocket == hashAlgoSocket_ && hashAlgoSelected_ == algo)
+                return true;
+
+        const std::string& response = runSingleFtpCommand("*OPTS HASH " + algo, false /*requiresUtf8*/); //throw SysError
+        const std::vector<std::string> lines = splitFtpResponse(response);
+        if (lines.empty() || !startsWith(lines.back(), "200"))
+            return false;
+
+        if (std::optional<curl_socket_t> currentSocket = getActiveSocket()) //throw SysError
+        {
+            hashAlgoSocket_ = *currentSocket;
+            hashAlgoSelected_ = algo;
+        }
+        return true;
+    }
+
+    //take the first token of the final reply line consisting of hex digits only and matching the expected digest size
+    static std::string parseHashResponse(const std::string& response, size_t digestBytes)
+    {
+        const std::vector<std::string> lines = splitFtpResponse(response);
+        if (lines.empty() || !startsWith(lines.back(), "2"))
+            return {};
+
+        for (const std::string& token : split(lines.back(), ' ', SplitOnEmpty::skip))
+            if (token.size() == 2 * digestBytes &&
+                std::all_of(token.begin(), token.end(), [](char c) { return isHexDigit(c); }))
+            {
+                std::string digest;
+                for (size_t i = 0; i < token.size(); i += 2)
+                    digest += unhexify(token[i], token[i + 1]);
+                return digest;
+            }
+        return {};
+    }
+
+    static bool hasFeatList(const std::string& featResponse)
+    {
+        for (const std::string& line : splitFtpResponse(featResponse))
+            if (startsWith(line, "211-") || startsWith(line, "211 "))
+                return true;
+        return false;
+    }
+
+    bool probeMlst() //throw SysError
+    {
+        //MLST without path: facts of the current working directory: https://tools.ietf.org/html/rfc3659#section-7.1
+        const std::string& mlstBuf = runSingleFtpCommand("*MLST", false /*requiresUtf8*/); //throw SysError
+
+        for (const std::string& line : splitFtpResponse(mlstBuf))
+            if (startsWith(line, "250-") || startsWith(line, "250 "))
+                return true;
+        return false;
+    }
+
     static Features parseFeatResponse(const std::string& featResponse)
     {
         Features output; //FEAT command: https://tools.ietf.org/html/rfc2389#page-4
@@ -815,6 +962,24 @@ private:
 
                 else if (equalAsciiNoCase(line, " CLNT"))
                     output.clnt = true;
+
+                //https://datatracker.ietf.org/doc/html/draft-bryan-ftpext-hash-02#section-3.3
+                //SP "HASH" SP hashlist CRLF, e.g. " HASH SHA-1;SHA-256*;MD5" ('*' marks the currently selected algorithm)
+                else if (startsWithAsciiNoCase(line, " HASH "))
+                    for (std::string algo : split(afterFirst(line, "HASH ", IfNotFoundReturn::none), ';', SplitOnEmpty::skip))
+                    {
+                        trim(algo, true, true, [](char c) { return c == '*' || isWhiteSpace(c); });
+                        if (equalAsciiNoCase(algo, "SHA-256"))
+                            output.hashSha256 = true;
+                        else if (equalAsciiNoCase(algo, "MD5"))
+                            output.hashMd5 = true;
+                    }
+
+                //non-standard, but widespread (e.g. FileZilla Server, Serv-U, Gene6)
+                else if (equalAsciiNoCase(line, " XSHA256"))
+                    output.xsha256 = true;
+                else if (equalAsciiNoCase(line, " XMD5"))
+                    output.xmd5 = true;
             }
         }
         return output;
@@ -825,6 +990,8 @@ private:
 
     curl_socket_t utf8EnabledSocket_ = 0;
     curl_socket_t binaryEnabledSocket_ = 0;
+    curl_socket_t hashAlgoSocket_ = 0;
+    std::string hashAlgoSelected_;
 
     std::optional<Features> featureCache_;
     std::optional<AfsPath> homePathCached_;
@@ -839,7 +1006,7 @@ private:
 
 class FtpSessionManager //reuse (healthy) FTP sessions globally
 {
-    using IdleFtpSessions = std::vector<std::unique_ptr<FtpSession>>;
+    struct IdleFtpSessions;
 
 public:
     FtpSessionManager() : sessionCleaner_([this]
@@ -857,10 +1024,10 @@ public:
         sessionStore.access([&](IdleFtpSessions& sessions)
         {
             //assume "isHealthy()" to avoid hitting server connection limits: (clean up of !isHealthy() after use, idle sessions via worker thread)
-            if (!sessions.empty())
+            if (!sessions.idleFtpSessions.empty())
             {
-                ftpSession = std::move(sessions.back    ());
-                /**/                   sessions.pop_back();
+                ftpSession = std::move(sessions.idleFtpSessions.back    ());
+                /**/                   sessions.idleFtpSessions.pop_back();
             }
         });
 
@@ -873,11 +1040,48 @@ public:
 
         ZEN_ON_SCOPE_EXIT(
             if (ftpSession->isHealthy()) //thread that created the "!isHealthy()" session is responsible for clean up (avoid hitting server connection limits!)
-        sessionStore.access([&](IdleFtpSessions& sessions) { sessions.push_back(std::move(ftpSession)); }); );
+        sessionStore.access([&](IdleFtpSessions& sessions) { sessions.idleFtpSessions.push_back(std::move(ftpSession)); }); );
 
         useFtpSession(*ftpSession); //throw X
     }
 
+    //open missing sessions in parallel + let session cleaner keep them alive for a while
+    void prepareSessions(const FtpLogin& login, size_t sessionCount) //noexcept
+    {
+        Protected<IdleFtpSessions>& sessionStore = getSessionStore(login);
+
+        size_t sessionsMissing = 0;
+        sessionStore.access([&](IdleFtpSessions& sessions)
+        {
+            sessions.keepWarmCount = sessionCount;
+            sessions.keepWarmUntil = std::chrono::steady_clock::now() + FTP_SESSION_KEEP_WARM_TIME;
+            sessions.keepWarmTimeoutSec = login.timeoutSec;
+
+            const size_t sessionsAvailable = sessions.idleFtpSessions.size() + sessions.sessionsWarmingUp; //sessions currently in use: unknown
+            if (sessionCount > sessionsAvailable)
+                sessionsMissing = sessionCount - sessionsAvailable;
+            sessions.sessionsWarmingUp += sessionsMissing;
+        });
+
+        for (size_t i = 0; i < sessionsMissing; ++i)
+            sessionWarmer_.run([login, &sessionStore]
+        {
+            ZEN_ON_SCOPE_EXIT(sessionStore.access([](IdleFtpSessions& sessions) { --sessions.sessionsWarmingUp; }));
+            try
+            {
+                auto ftpSession = std::make_unique<FtpSession>(login); //throw SysError
+
+                const std::shared_ptr<int> timeoutSec = std::make_shared<int>(login.timeoutSec); //context option: valid only for duration of this call!
+                ftpSession->setContextTimeout(timeoutSec);
+
+                ftpSession->testConnection(); //throw SysError
+
+                sessionStore.access([&](IdleFtpSessions& sessions) { sessions.idleFtpSessions.push_back(std::move(ftpSession)); });
+            }
+            catch (SysError&) {} //just a hint: errors are reported when the session is actually needed
+        });
+    }
+
 private:
     FtpSessionManager           (const FtpSessionManager&) = delete;
     FtpSessionManager& operator=(const FtpSessionManager&) = delete;
@@ -922,11 +1126,22 @@ private:
                 for (bool done = false; !done;)
                     sessionStore->access([&](IdleFtpSessions& sessions)
                 {
-                    for (std::unique_ptr<FtpSession>& sshSession : sessions)
+                    if (std::chrono::steady_clock::now() < sessions.keepWarmUntil)
+                    {
+                        size_t keptWarm = 0;
+                        for (std::unique_ptr<FtpSession>& ftpSession : sessions.idleFtpSessions)
+                            if (keptWarm < sessions.keepWarmCount && ftpSession->isHealthy())
+                            {
+                                ftpSession->keepAlive(sessions.keepWarmTimeoutSec); //noexcept
+                                ++keptWarm;
+                            }
+                    }
+
+                    for (std::unique_ptr<FtpSession>& sshSession : sessions.idleFtpSessions)
                         if (!sshSession->isHealthy()) //!isHealthy() sessions are destroyed after use => in this context this means they have been idle for too long
                         {
-                            sshSession.swap(sessions.back());
-                            /**/            sessions.pop_back(); //run ~FtpSession *inside* the lock! => avoid hitting server limits!
+                            sshSession.swap(sessions.idleFtpSessions.back());
+                            /**/            sessions.idleFtpSessions.pop_back(); //run ~FtpSession *inside* the lock! => avoid hitting server limits!
                             std::this_thread::yield();
                             return; //don't hold lock for too long: delete only one session at a time, then yield...
                         }
@@ -935,10 +1150,21 @@ private:
         }
     }
 
+    struct IdleFtpSessions
+    {
+        std::vector<std::unique_ptr<FtpSession>> idleFtpSessions; //extract *temporarily* from this list during use
+
+        size_t sessionsWarmingUp = 0;
+        size_t keepWarmCount = 0;
+        std::chrono::steady_clock::time_point keepWarmUntil;
+        int keepWarmTimeoutSec = 0;
+    };
+
     using GlobalFtpSessions = std::map<FtpSessionId, Protected<IdleFtpSessions>>;
 
     Protected<GlobalFtpSessions> globalSessionStore_;
     InterruptibleThread sessionCleaner_;
+    ThreadGroup<std::function<void()>> sessionWarmer_{FTP_SESSION_WARM_UP_PARALLEL_MAX, Zstr("Session Warm-up[FTP]")}; //accesses globalSessionStore_ => destroy first
 };
 
 //--------------------------------------------------------------------------------------
@@ -955,6 +1181,13 @@ void accessFtpSession(const FtpLogin& login, const std::function<void(FtpSession
         throw SysError(formatSystemError("accessFtpSession", L"", L"Function call not allowed during init/shutdown."));
 }
 
+
+void prepareFtpSessions(const FtpLogin& login, size_t sessionCount) //noexcept
+{
+    if (const std::shared_ptr<FtpSessionManager> mgr = globalFtpSessionManager.get())
+        mgr->prepareSessions(login, sessionCount); //noexcept
+}
+
 //===========================================================================================================================
 
 struct FtpItem
@@ -1044,7 +1277,8 @@ FtpItem getFtpSymlinkInfo(const FtpLogin& login, const AfsPath& linkPath) //thro
 class FtpDirectoryReader
 {
 public:
-    static std::vector<FtpItem> execute(const FtpLogin& login, const AfsPath& afsDirPath) //throw FileError
+    //usedMlsd: LIST has imprecise modification times (minutes, or even days for older items)
+    static std::vector<FtpItem> execute(const FtpLogin& login, const AfsPath& afsDirPath, bool* usedMlsd = nullptr) //throw FileError
     {
         std::string rawListing; //get raw FTP directory listing
 
@@ -1104,6 +1338,9 @@ public:
                     output = parseMlsd(rawListing, encoding); //throw SysError
                 else
                     output = parseUnknown(rawListing, encoding); //throw SysError
+
+                if (usedMlsd)
+                    *usedMlsd = session.supportsMlsd(); //throw SysError
             });
         }
         catch (const SysError& e)
@@ -1117,20 +1354,24 @@ private:
     FtpDirectoryReader           (const FtpDirectoryReader&) = delete;
     FtpDirectoryReader& operator=(const FtpDirectoryReader&) = delete;
 
+    static size_t estimateItemCount(const std::string& buf) { return std::count(buf.begin(), buf.end(), '\n'); }
+
     static std::vector<FtpItem> parseMlsd(const std::string& buf, ServerEncoding enc) //throw SysError
     {
         std::vector<FtpItem> output;
-        for (const std::string& line : splitFtpResponse(buf))
+        output.reserve(estimateItemCount(buf));
+
+        forEachFtpResponseLine(buf, [&](const std::string_view line) //throw SysError
         {
-            const FtpItem item = parseMlstLine(line, enc); //throw SysError
+            FtpItem item = parseMlstLine(line, enc); //throw SysError
             if (item.itemName != Zstr(".") &&
                 item.itemName != Zstr(".."))
-                output.push_back(item);
-        }
+                output.push_back(std::move(item));
+        });
         return output;
     }
 
-    static FtpItem parseMlstLine(const std::string& rawLine, ServerEncoding enc) //throw SysError
+    static FtpItem parseMlstLine(const std::string_view rawLine, ServerEncoding enc) //throw SysError
     {
         /*  https://tools.ietf.org/html/rfc3659
             type=cdir;sizd=4096;modify=20170116230740;UNIX.mode=0755;UNIX.uid=874;UNIX.gid=869;unique=902g36e1c55; .
@@ -1148,23 +1389,25 @@ private:
             if (itBlank == rawLine.end())
                 throw SysError(L"Item name not available.");
 
-            const std::string facts(itBegin, itBlank);
-            item.itemName = serverToUtfEncoding(std::string(itBlank + 1, rawLine.end()), enc); //throw SysError
+            const std::string_view facts = makeStringView(itBegin, itBlank);
+            item.itemName = serverToUtfEncoding(makeStringView(itBlank + 1, rawLine.end()), enc); //throw SysError
 
-            std::string typeFact;
+            std::string_view typeFact;
             std::optional<uint64_t> fileSize;
 
-            for (const std::string& fact : split(facts, ';', SplitOnEmpty::skip))
+            split2(facts, [](char c) { return c == ';'; }, [&](const char* factFirst, const char* factLast)
+            {
+                const std::string_view fact = makeStringView(factFirst, factLast);
                 if (startsWithAsciiNoCase(fact, "type=")) //must be case-insensitive!!!
                 {
-                    const std::string tmp = afterFirst(fact, '=', IfNotFoundReturn::none);
+                    const std::string_view tmp = afterFirst(fact, '=', IfNotFoundReturn::none);
                     typeFact = beforeFirst(tmp, ':', IfNotFoundReturn::all);
                 }
                 else if (startsWithAsciiNoCase(fact, "size="))
                     fileSize = stringTo<uint64_t>(afterFirst(fact, '=', IfNotFoundReturn::none));
                 else if (startsWithAsciiNoCase(fact, "modify="))
                 {
-                    std::string modifyFact = afterFirst(fact, '=', IfNotFoundReturn::none);
+                    std::string_view modifyFact = afterFirst(fact, '=', IfNotFoundReturn::none);
                     modifyFact = beforeLast(modifyFact, '.', IfNotFoundReturn::all); //truncate millisecond precision if available
 
                     const TimeComp tc = parseTime("%Y%m%d%H%M%S", modifyFact);
@@ -1183,11 +1426,12 @@ private:
 
                         => not necessarily *persistent* as far as the RFC goes!
                            BUT: practially this will be the inode ID/file index, so we can assume persistence */
-                    const std::string uniqueId = afterFirst(fact, '=', IfNotFoundReturn::none);
+                    const std::string_view uniqueId = afterFirst(fact, '=', IfNotFoundReturn::none);
                     assert(!uniqueId.empty());
                     item.filePrint = hashArray<AFS::FingerPrint>(uniqueId.begin(), uniqueId.end());
                     //other metadata to hash e.g. create fact? => not available on Linux-hosted FTP!
                 }
+            }); //throw SysError
 
             if (equalAsciiNoCase(typeFact, "cdir"))
                 return {AFS::ItemType::folder, Zstr("."), 0, 0};
@@ -1229,12 +1473,6 @@ private:
     //"ls -l"
     static std::vector<FtpItem> parseUnix(const std::string& buf, ServerEncoding enc) //throw SysError
     {
-        const std::vector<std::string> lines = splitFtpResponse(buf);
-        auto it = lines.begin();
-
-        if (it != lines.end() && startsWith(*it, "total "))
-            ++it;
-
         const time_t utcTimeNow = std::time(nullptr);
         const TimeComp tc = getUtcTime(utcTimeNow);
         if (tc == TimeComp())
@@ -1244,23 +1482,32 @@ private:
 
         std::optional<bool> unixListingHaveGroup_; //different listing format: better store at session level!?
         std::vector<FtpItem> output;
+        output.reserve(estimateItemCount(buf));
 
-        for (; it != lines.end(); ++it)
+        bool firstLine = true;
+        forEachFtpResponseLine(buf, [&](const std::string_view line) //throw SysError
         {
+            if (firstLine)
+            {
+                firstLine = false;
+                if (startsWith(line, "total "))
+                    return;
+            }
+
             //unix listing without group: https://freefilesync.org/forum/viewtopic.php?t=4306
             if (!unixListingHaveGroup_)
                 unixListingHaveGroup_ = [&]
             {
                 try
                 {
-                    parseUnixLine(*it, utcTimeNow, utcCurrentYear, true /*haveGroup*/, enc); //throw SysError
+                    parseUnixLine(line, utcTimeNow, utcCurrentYear, true /*haveGroup*/, enc); //throw SysError
                     return true;
                 }
                 catch (SysError&)
                 {
                     try
                     {
-                        parseUnixLine(*it, utcTimeNow, utcCurrentYear, false /*haveGroup*/, enc); //throw SysError
+                        parseUnixLine(line, utcTimeNow, utcCurrentYear, false /*haveGroup*/, enc); //throw SysError
                         return false;
                     }
                     catch (SysError&) {}
@@ -1268,16 +1515,16 @@ private:
                 }
             }();
 
-            const FtpItem item = parseUnixLine(*it, utcTimeNow, utcCurrentYear, *unixListingHaveGroup_, enc); //throw SysError
+            FtpItem item = parseUnixLine(line, utcTimeNow, utcCurrentYear, *unixListingHaveGroup_, enc); //throw SysError
             if (item.itemName != Zstr(".") &&
                 item.itemName != Zstr(".."))
-                output.push_back(item);
-        }
+                output.push_back(std::move(item));
+        });
 
         return output;
     }
 
-    static FtpItem parseUnixLine(const std::string& rawLine, time_t utcTimeNow, int utcCurrentYear, bool haveGroup, ServerEncoding enc) //throw SysError
+    static FtpItem parseUnixLine(const std::string_view rawLine, time_t utcTimeNow, int utcCurrentYear, bool haveGroup, ServerEncoding enc) //throw SysError
     {
         /*  total 4953                                                  <- optional first line
             drwxr-xr-x 1 root root    4096 Jan 10 11:58 version
@@ -1307,7 +1554,7 @@ private:
         {
             FtpLineParser parser(rawLine);
 
-            const std::string typeTag = parser.readRange(1, [](char c) //throw SysError
+            const std::string_view typeTag = parser.readRange(1, [](char c) //throw SysError
             {
                 return c == '-' || c == 'b' || c == 'c' || c == 'd' || c == 'l' || c == 'p' || c == 's';
             });
@@ -1338,7 +1585,7 @@ private:
             const uint64_t fileSize = stringTo<uint64_t>(parser.readRange(&isDigit<char>)); //throw SysError
             parser.readRange(&isWhiteSpace<char>);                                          //throw SysError
             //------------------------------------------------------------------------------------
-            const std::string monthStr = parser.readRange(std::not_fn(isWhiteSpace<char>)); //throw SysError
+            const std::string_view monthStr = parser.readRange(std::not_fn(isWhiteSpace<char>)); //throw SysError
             parser.readRange(&isWhiteSpace<char>);                                                  //throw SysError
 
             const char* months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
@@ -1351,7 +1598,7 @@ private:
             if (day < 1 || day > 31)
                 throw SysError(L"Failed to parse day of month.");
             //------------------------------------------------------------------------------------
-            const std::string timeOrYear = parser.readRange([](char c) { return c == ':' || isDigit(c); }); //throw SysError
+            const std::string_view timeOrYear = parser.readRange([](char c) { return c == ':' || isDigit(c); }); //throw SysError
             parser.readRange(&isWhiteSpace<char>);                                                          //throw SysError
 
             TimeComp timeComp;
@@ -1391,8 +1638,8 @@ private:
             if (utcTime == -1)
                 throw SysError(L"Modification time could not be parsed.");
             //------------------------------------------------------------------------------------
-            const std::string trail = parser.readRange([](char) { return true; }); //throw SysError
-            std::string itemName;
+            const std::string_view trail = parser.readRange([](char) { return true; }); //throw SysError
+            std::string_view itemName;
             if (typeTag == "l")
                 itemName = beforeFirst(trail, " -> ", IfNotFoundReturn::none);
             else
@@ -1454,7 +1701,9 @@ private:
         const int utcCurrentYear = tc.year;
 
         std::vector<FtpItem> output;
-        for (const std::string& line : splitFtpResponse(buf))
+        output.reserve(estimateItemCount(buf));
+
+        forEachFtpResponseLine(buf, [&](const std::string_view line) //throw SysError
         {
             try
             {
@@ -1464,7 +1713,7 @@ private:
                 parser.readRange(1, [](char c) { return c == '-' || c == '/'; });         //throw SysError
                 const int day = stringTo<int>(parser.readRange(2, &isDigit<char>));       //throw SysError
                 parser.readRange(1, [](char c) { return c == '-' || c == '/'; });         //throw SysError
-                const std::string yearString = parser.readRange(&isDigit<char>);          //throw SysError
+                const std::string_view yearString = parser.readRange(&isDigit<char>);     //throw SysError
                 parser.readRange(&isWhiteSpace<char>);                                    //throw SysError
 
                 if (month < 1 || month > 12 || day < 1 || day > 31)
@@ -1487,7 +1736,7 @@ private:
                 const int minute = stringTo<int>(parser.readRange(2, &isDigit<char>)); //throw SysError
                 if (!isWhiteSpace(parser.peekNextChar()))
                 {
-                    const std::string period = parser.readRange(2, [](char c) { return c == 'A' || c == 'P' || c == 'M'; }); //throw SysError
+                    const std::string_view period = parser.readRange(2, [](char c) { return c == 'A' || c == 'P' || c == 'M'; }); //throw SysError
                     if (period == "PM")
                     {
                         if (0 <= hour && hour < 12)
@@ -1513,22 +1762,21 @@ private:
                 if (utcTime == -1)
                     throw SysError(L"Modification time could not be parsed.");
                 //------------------------------------------------------------------------------------
-                const std::string dirTagOrSize = parser.readRange(std::not_fn(isWhiteSpace<char>)); //throw SysError
+                const std::string_view dirTagOrSize = parser.readRange(std::not_fn(isWhiteSpace<char>)); //throw SysError
                 parser.readRange(&isWhiteSpace<char>); //throw SysError
 
                 const bool isDir = dirTagOrSize == "<DIR>";
                 uint64_t fileSize = 0;
                 if (!isDir)
                 {
-                    std::string sizeStr = dirTagOrSize;
-                    replace(sizeStr, ',', "");
-                    replace(sizeStr, '.', "");
-                    if (!std::all_of(sizeStr.begin(), sizeStr.end(), &isDigit<char>))
-                        throw SysError(L"Failed to parse file size.");
-                    fileSize = stringTo<uint64_t>(sizeStr);
+                    for (const char c : dirTagOrSize) //skip thousands separators
+                        if (isDigit(c))
+                            fileSize = fileSize * 10 + static_cast<uint64_t>(c - '0');
+                        else if (c != ',' && c != '.')
+                            throw SysError(L"Failed to parse file size.");
                 }
                 //------------------------------------------------------------------------------------
-                const std::string itemName = parser.readRange([](char) { return true; }); //throw SysError
+                const std::string_view itemName = parser.readRange([](char) { return true; }); //throw SysError
                 if (itemName.empty())
                     throw SysError(L"Folder contains an item without name.");
 
@@ -1543,14 +1791,14 @@ private:
                     item.fileSize = fileSize;
                     item.modTime  = utcTime;
 
-                    output.push_back(item);
+                    output.push_back(std::move(item));
                 }
             }
             catch (const SysError& e)
             {
                 throw SysError(L"Unexpected FTP response. (" + utfTo<std::wstring>(line) + L") " + e.toString());
             }
-        }
+        });
 
         return output;
     }
@@ -1560,19 +1808,22 @@ private:
 class SingleFolderTraverser
 {
 public:
-    SingleFolderTraverser(const FtpLogin& login, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/)
-        : workload_(workload), login_(login)
+    SingleFolderTraverser(const FtpLogin& login, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/) :
+        login_(login),
+        deviceKey_(utfTo<Zstring>(getCurlDisplayPath(login, AfsPath())))
     {
+        for (const auto& [folderPath, cb] : workload)
+            workload_.push_back(WorkItem{folderPath, cb, std::nullopt /*folderModTime: base folders are never cached*/});
+
         while (!workload_.empty())
         {
             auto wi = std::move(workload_.    back()); //yes, no strong exception guarantee (std::bad_alloc)
             /**/                workload_.pop_back();  //
-            const auto& [folderPath, cb] = wi;
 
             tryReportingDirError([&] //throw X
             {
-                traverseWithException(folderPath, *cb); //throw FileError, X
-            }, *cb);
+                traverseWithException(wi.folderPath, wi.folderModTime, *wi.cb); //throw FileError, X
+            }, *wi.cb);
         }
     }
 
@@ -1580,12 +1831,50 @@ private:
     SingleFolderTraverser           (const SingleFolderTraverser&) = delete;
     SingleFolderTraverser& operator=(const SingleFolderTraverser&) = delete;
 
-    void traverseWithException(const AfsPath& dirPath, AFS::TraverserCallback& cb) //throw FileError, X
+    struct WorkItem
+    {
+        AfsPath folderPath;
+        std::shared_ptr<AFS::TraverserCallback> cb;
+        std::optional<time_t> folderModTime; //as reported by a *fresh* MLSD listing of the parent folder
+    };
+
+    //returns "true" if sub folder modification times are suitable to validate the listing cache
+    bool getDirContent(const AfsPath& dirPath, const std::optional<time_t>& folderModTime, std::vector<FtpItem>& items) //throw FileError
+    {
+        if (login_.listingCache && folderModTime)
+            if (std::optional<std::vector<CachedFolderItem>> cached = getCachedFolderListing(deviceKey_, dirPath, *folderModTime)) //noexcept
+            {
+                for (const CachedFolderItem& ci : *cached)
+                    items.push_back({ci.type, ci.itemName, ci.fileSize, ci.modTime, ci.filePrint});
+                return false;
+            }
+
+        bool usedMlsd = false;
+        items = FtpDirectoryReader::execute(login_, dirPath, &usedMlsd); //throw FileError
+
+        if (login_.listingCache && folderModTime)
+        {
+            std::vector<CachedFolderItem> cached;
+            for (const FtpItem& item : items)
+                cached.push_back({item.type, item.itemName, item.fileSize, item.modTime, item.filePrint});
+
+            setCachedFolderListing(deviceKey_, dirPath, *folderModTime, cached); //noexcept
+        }
+        return usedMlsd;
+    }
+
+    void traverseWithException(const AfsPath& dirPath, const std::optional<time_t>& folderModTime, AFS::TraverserCallback& cb) //throw FileError, X
     {
-        for (const FtpItem& item : FtpDirectoryReader::execute(login_, dirPath)) //throw FileError
+        std::vector<FtpItem> items;
+        const bool freshListing = getDirContent(dirPath, folderModTime, items); //throw FileError
+
+        for (const FtpItem& item : items)
         {
             const AfsPath itemPath(nativeAppendPaths(dirPath.value, item.itemName));
 
+            //sub folder modification times from a cached listing may be outdated => can't be used to validate the cache
+            const std::optional<time_t> itemModTime = freshListing ? std::optional(item.modTime) : std::nullopt;
+
             switch (item.type)
             {
                 case AFS::ItemType::file:
@@ -1594,7 +1883,7 @@ private:
 
                 case AFS::ItemType::folder:
                     if (std::shared_ptr<AFS::TraverserCallback> cbSub = cb.onFolder({item.itemName, false /*isFollowedSymlink*/})) //throw X
-                        workload_.push_back({itemPath, std::move(cbSub)});
+                        workload_.push_back({itemPath, std::move(cbSub), itemModTime});
                     break;
 
                 case AFS::ItemType::symlink:
@@ -1612,7 +1901,7 @@ private:
                             if (target.type == AFS::ItemType::folder)
                             {
                                 if (std::shared_ptr<AFS::TraverserCallback> cbSub = cb.onFolder({item.itemName, true /*isFollowedSymlink*/})) //throw X
-                                    workload_.push_back({itemPath, std::move(cbSub)});
+                                    workload_.push_back({itemPath, std::move(cbSub), std::nullopt /*don't trust precision of symlink target details*/});
                             }
                             else //a file or named pipe, etc.
                                 cb.onFile({item.itemName, target.fileSize, target.modTime, item.filePrint, true /*isFollowedSymlink*/}); //throw X
@@ -1627,8 +1916,9 @@ private:
         }
     }
 
-    std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>> workload_;
     const FtpLogin login_;
+    const Zstring deviceKey_; //listing cache
+    std::vector<WorkItem> workload_;
 };
 
 
@@ -1640,7 +1930,8 @@ void traverseFolderRecursiveFTP(const FtpLogin& login, const std::vector<std::pa
 //===========================================================================================================================
 
 void ftpFileDownload(const FtpLogin& login, const AfsPath& afsFilePath, //throw FileError, X
-                     const std::function<void(const void* buffer, size_t bytesToWrite)>& writeBlock /*throw X*/)
+                     const std::function<void(const void* buffer, size_t bytesToWrite)>& writeBlock /*throw X*/,
+                     std::optional<std::pair<uint64_t, uint64_t>> byteRange = {}) //[first, last]; first must not exceed file size
 {
     std::exception_ptr exception;
 
@@ -1665,16 +1956,25 @@ void ftpFileDownload(const FtpLogin& login, const AfsPath& afsFilePath, //throw
         return (*callbackData)(buffer, size * nitems); //free this poor little C-API from its shackles and redirect to a proper lambda
     };
 
+    //lifetime: keep alive until after perform()
+    const std::string rangeSpec = byteRange ? numberTo<std::string>(byteRange->first) + '-' + numberTo<std::string>(byteRange->second) : std::string();
+
+    std::vector<CurlOption> options
+    {
+        {CURLOPT_WRITEDATA, &onBytesReceived},
+        {CURLOPT_WRITEFUNCTION, onBytesReceivedWrapper},
+    };
+    if (byteRange)
+        options.emplace_back(CURLOPT_RANGE, rangeSpec.c_str()); //REST + RETR: needs "SIZE" => no CURLOPT_IGNORE_CONTENT_LENGTH
+    else
+        options.emplace_back(CURLOPT_IGNORE_CONTENT_LENGTH, 1L); //skip FTP "SIZE" command before download (=> download until actual EOF if file size changes)
+
     try
     {
         accessFtpSession(login, [&](FtpSession& session) //throw SysError
         {
             session.perform(afsFilePath, false /*isDir*/, CURLFTPMETHOD_NOCWD, //are there any servers that require CURLFTPMETHOD_SINGLECWD? let's find out
-            {
-                {CURLOPT_WRITEDATA, &onBytesReceived},
-                {CURLOPT_WRITEFUNCTION, onBytesReceivedWrapper},
-                {CURLOPT_IGNORE_CONTENT_LENGTH, 1L}, //skip FTP "SIZE" command before download (=> download until actual EOF if file size changes)
-            }, true /*requiresUtf8*/); //throw SysError
+                            options, true /*requiresUtf8*/); //throw SysError
         });
     }
     catch (const SysError& e)
@@ -1687,12 +1987,27 @@ void ftpFileDownload(const FtpLogin& login, const AfsPath& afsFilePath, //throw
 }
 
 
+std::string formatMfmtTime(time_t modTime) //throw SysError
+{
+    const std::string isoTime = utfTo<std::string>(formatTime(Zstr("%Y%m%d%H%M%S"), getUtcTime(modTime))); //returns empty string on failure
+    if (isoTime.empty())
+        throw SysError(L"Invalid modification time (time_t: " + numberTo<std::wstring>(modTime) + L')');
+    return isoTime;
+}
+
+
 /* File already existing:
     freefilesync.org: overwrites
     FileZilla Server: overwrites
-    Windows IIS:      overwrites                          */
-void ftpFileUpload(const FtpLogin& login, const AfsPath& afsFilePath, //throw FileError, X
-                   const std::function<size_t(void* buffer, size_t bytesToRead)>& readBlock /*throw X*/) //returning 0 signals EOF: Posix read() semantics
+    Windows IIS:      overwrites
+
+    modTime: set via MFMT as CURLOPT_POSTQUOTE of the same transfer (if supported)
+      => small files: saves a session round trip + curl_easy_perform() per file; the extra FTP round trip remains
+      => returns false if not set: caller falls back to a separate MFMT for proper error reporting  */
+bool /*modTimeSet*/ ftpFileUpload(const FtpLogin& login, const AfsPath& afsFilePath, //throw FileError, X
+                                  const std::function<size_t(void* buffer, size_t bytesToRead)>& readBlock /*throw X*/, //returning 0 signals EOF: Posix read() semantics
+                                  std::optional<time_t> modTime = {},
+                                  bool append = false) //resumed copy: APPE instead of STOR
 {
     std::exception_ptr exception;
 
@@ -1719,10 +2034,24 @@ void ftpFileUpload(const FtpLogin& login, const AfsPath& afsFilePath, //throw Fi
         return (*callbackData)(buffer, size * nitems); //free this poor little C-API from its shackles and redirect to a proper lambda
     };
 
+    bool modTimeSet = false;
     try
     {
         accessFtpSession(login, [&](FtpSession& session) //throw SysError
         {
+            curl_slist* postQuote = nullptr;
+            ZEN_ON_SCOPE_EXIT(::curl_slist_free_all(postQuote));
+
+            if (modTime)
+                try
+                {
+                    if (session.supportsMfmt()) //throw SysError
+                        //"*": don't fail the upload => check MFMT response below
+                        postQuote = ::curl_slist_append(postQuote, ("*MFMT " + formatMfmtTime(*modTime) + ' ' + //throw SysError
+                                                                    session.getServerPathInternal(afsFilePath)).c_str()); //
+                }
+                catch (SysError&) {} //=> fall back to separate MFMT
+
             /*
                 curl_slist* quote = nullptr;
                 ZEN_ON_SCOPE_EXIT(::curl_slist_free_all(quote));
@@ -1732,7 +2061,7 @@ void ftpFileUpload(const FtpLogin& login, const AfsPath& afsFilePath, //throw Fi
 
                 //optimize fail-safe copy with RNFR/RNTO as CURLOPT_POSTQUOTE? -> even slightly *slower* than RNFR/RNTO as additional curl_easy_perform()
             */
-            session.perform(afsFilePath, false /*isDir*/, CURLFTPMETHOD_NOCWD, //are there any servers that require CURLFTPMETHOD_SINGLECWD? let's find out
+            std::vector<CurlOption> options
             {
                 {CURLOPT_UPLOAD, 1L},
                 {CURLOPT_READDATA, &getBytesToSend},
@@ -1742,8 +2071,18 @@ void ftpFileUpload(const FtpLogin& login, const AfsPath& afsFilePath, //throw Fi
                 //=> CURLOPT_INFILESIZE_LARGE does not issue a specific FTP command, but is used by libcurl only!
 
                 //{CURLOPT_PREQUOTE,  quote},
-                //{CURLOPT_POSTQUOTE, quote},
-            }, true /*requiresUtf8*/); //throw SysError
+            };
+            if (postQuote)
+                options.emplace_back(CURLOPT_POSTQUOTE, postQuote);
+            if (append)
+                options.emplace_back(CURLOPT_APPEND, 1L);
+
+            const std::string response = session.perform(afsFilePath, false /*isDir*/, CURLFTPMETHOD_NOCWD, //are there any servers that require CURLFTPMETHOD_SINGLECWD? let's find out
+                                                         options, true /*requiresUtf8*/); //throw SysError
+            if (postQuote)
+                if (const std::vector<std::string>& lines = splitFtpResponse(response);
+                    !lines.empty() && startsWith(lines.back(), "213")) //POSTQUOTE runs after transfer => last response is MFMT's
+                    modTimeSet = true;
         });
     }
     catch (const SysError& e)
@@ -1753,6 +2092,7 @@ void ftpFileUpload(const FtpLogin& login, const AfsPath& afsFilePath, //throw Fi
 
         throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(getCurlDisplayPath(login, afsFilePath))), e.toString());
     }
+    return modTimeSet;
 }
 
 //===========================================================================================================================
@@ -1762,24 +2102,9 @@ struct InputStreamFtp : public AFS::InputStream
     InputStreamFtp(const FtpLogin& login,
                    const AfsPath& afsPath,
                    const IoCallback& notifyUnbufferedIO /*throw X*/) :
-        notifyUnbufferedIO_(notifyUnbufferedIO)
-    {
-        worker_ = InterruptibleThread([asyncStreamOut = this->asyncStreamIn_, login, afsPath]
-        {
-            setCurrentThreadName(Zstr("Istream[FTP] ") + utfTo<Zstring>(getCurlDisplayPath(login, afsPath)));
-            try
-            {
-                auto writeBlock = [&](const void* buffer, size_t bytesToWrite)
-                {
-                    return asyncStreamOut->write(buffer, bytesToWrite); //throw ThreadStopRequest
-                };
-                ftpFileDownload(login, afsPath, writeBlock); //throw FileError, ThreadStopRequest
-
-                asyncStreamOut->closeStream();
-            }
-            catch (FileError&) { asyncStreamOut->setWriteError(std::current_exception()); } //let ThreadStopRequest pass through!
-        });
-    }
+        login_(login),
+        afsPath_(afsPath),
+        notifyUnbufferedIO_(notifyUnbufferedIO) {}
 
     ~InputStreamFtp()
     {
@@ -1788,6 +2113,9 @@ struct InputStreamFtp : public AFS::InputStream
 
     size_t read(void* buffer, size_t bytesToRead) override //throw FileError, (ErrorFileLocked), X; return "bytesToRead" bytes unless end of stream!
     {
+        if (!worker_.joinable()) //start download lazily: stream might be used for readAt() only
+            startDownload();
+
         const size_t bytesRead = asyncStreamIn_->read(buffer, bytesToRead); //throw FileError
         reportBytesProcessed(); //throw X
         return bytesRead;
@@ -1804,7 +2132,46 @@ struct InputStreamFtp : public AFS::InputStream
         //  CURLOPT_PREQUOTE/CURLOPT_PREQUOTE/CURLOPT_POSTQUOTE + MDTM: test case 77 files, 4MB: overall copy time increases by 12%
     }
 
+    bool supportsReadAt() const override { return true; }
+
+    size_t readAt(uint64_t offset, void* buffer, size_t bytesToRead) override //throw FileError, (ErrorFileLocked), X; return "bytesToRead" bytes unless end of stream!
+    {
+        assert(!worker_.joinable()); //don't mix with read()
+        if (bytesToRead == 0)
+            return 0;
+
+        size_t bytesRead = 0;
+        auto writeBlock = [&](const void* blockBuf, size_t blockSize)
+        {
+            const size_t junkSize = std::min(blockSize, bytesToRead - bytesRead); //don't trust the server to honor the range
+            std::memcpy(static_cast<std::byte*>(buffer) + bytesRead, blockBuf, junkSize);
+            bytesRead += junkSize;
+            if (notifyUnbufferedIO_) notifyUnbufferedIO_(blockSize); //throw X
+        };
+        ftpFileDownload(login_, afsPath_, writeBlock, std::pair(offset, offset + bytesToRead - 1)); //throw FileError, X
+        return bytesRead;
+    }
+
 private:
+    void startDownload()
+    {
+        worker_ = InterruptibleThread([asyncStreamOut = this->asyncStreamIn_, login = login_, afsPath = afsPath_]
+        {
+            setCurrentThreadName(Zstr("Istream[FTP] ") + utfTo<Zstring>(getCurlDisplayPath(login, afsPath)));
+            try
+            {
+                auto writeBlock = [&](const void* buffer, size_t bytesToWrite)
+                {
+                    return asyncStreamOut->write(buffer, bytesToWrite); //throw ThreadStopRequest
+                };
+                ftpFileDownload(login, afsPath, writeBlock); //throw FileError, ThreadStopRequest
+
+                asyncStreamOut->closeStream();
+            }
+            catch (FileError&) { asyncStreamOut->setWriteError(std::current_exception()); } //let ThreadStopRequest pass through!
+        });
+    }
+
     void reportBytesProcessed() //throw X
     {
         const int64_t totalBytesDownloaded = asyncStreamIn_->getTotalBytesWritten();
@@ -1812,6 +2179,8 @@ private:
         totalBytesReported_ = totalBytesDownloaded;
     }
 
+    const FtpLogin login_;
+    const AfsPath afsPath_;
     const IoCallback notifyUnbufferedIO_; //throw X
     int64_t totalBytesReported_ = 0;
     std::shared_ptr<AsyncStreamBuffer> asyncStreamIn_ = std::make_shared<AsyncStreamBuffer>(FTP_STREAM_BUFFER_SIZE);
@@ -1827,16 +2196,17 @@ struct OutputStreamFtp : public AFS::OutputStreamImpl
     OutputStreamFtp(const FtpLogin& login,
                     const AfsPath& afsPath,
                     std::optional<time_t> modTime,
-                    const IoCallback& notifyUnbufferedIO /*throw X*/) :
+                    const IoCallback& notifyUnbufferedIO /*throw X*/,
+                    bool append = false) :
         login_(login),
         afsPath_(afsPath),
         modTime_(modTime),
         notifyUnbufferedIO_(notifyUnbufferedIO)
     {
-        std::promise<void> pUploadDone;
+        std::promise<bool /*modTimeSet*/> pUploadDone;
         futUploadDone_ = pUploadDone.get_future();
 
-        worker_ = InterruptibleThread([login, afsPath,
+        worker_ = InterruptibleThread([login, afsPath, modTime, append,
                                               asyncStreamIn = this->asyncStreamOut_,
                                               pUploadDone   = std::move(pUploadDone)]() mutable
         {
@@ -1848,10 +2218,10 @@ struct OutputStreamFtp : public AFS::OutputStreamImpl
                     //returns "bytesToRead" bytes unless end of stream! => maps nicely into Posix read() semantics expected by ftpFileUpload()
                     return asyncStreamIn->read(buffer, bytesToRead); //throw ThreadStopRequest
                 };
-                ftpFileUpload(login, afsPath, readBlock); //throw FileError, ThreadStopRequest
+                const bool modTimeSet = ftpFileUpload(login, afsPath, readBlock, modTime, append); //throw FileError, ThreadStopRequest
                 assert(asyncStreamIn->getTotalBytesRead() == asyncStreamIn->getTotalBytesWritten());
 
-                pUploadDone.set_value();
+                pUploadDone.set_value(modTimeSet);
             }
             catch (FileError&)
             {
@@ -1886,17 +2256,16 @@ struct OutputStreamFtp : public AFS::OutputStreamImpl
         //--------------------------------------------------------------------
 
         assert(isReady(futUploadDone_));
-        futUploadDone_.get(); //throw FileError
+        const bool modTimeSet = futUploadDone_.get(); //throw FileError
 
         AFS::FinalizeResult result;
         //result.filePrint = ... -> yet unknown at this point
-        try
-        {
-            setModTimeIfAvailable(); //throw FileError, follows symlinks
-            /* is setting modtime after closing the file handle a pessimization?
-                FTP:    no: could set modtime via CURLOPT_POSTQUOTE (but this would internally trigger an extra round-trip anyway!) */
-        }
-        catch (const FileError& e) { result.errorModTime = FileError(e.toString()); /*avoid slicing*/ }
+        if (!modTimeSet) //usually set already via CURLOPT_POSTQUOTE: one less session round trip per file
+            try
+            {
+                setModTimeIfAvailable(); //throw FileError, follows symlinks
+            }
+            catch (const FileError& e) { result.errorModTime = FileError(e.toString()); /*avoid slicing*/ }
 
         return result;
     }
@@ -1915,9 +2284,7 @@ private:
         if (modTime_)
             try
             {
-                const std::string isoTime = utfTo<std::string>(formatTime(Zstr("%Y%m%d%H%M%S"), getUtcTime(*modTime_))); //returns empty string on failure
-                if (isoTime.empty())
-                    throw SysError(L"Invalid modification time (time_t: " + numberTo<std::wstring>(*modTime_) + L')');
+                const std::string isoTime = formatMfmtTime(*modTime_); //throw SysError
 
                 accessFtpSession(login_, [&](FtpSession& session) //throw SysError
                 {
@@ -1942,7 +2309,7 @@ private:
     int64_t totalBytesReported_ = 0;
     std::shared_ptr<AsyncStreamBuffer> asyncStreamOut_ = std::make_shared<AsyncStreamBuffer>(FTP_STREAM_BUFFER_SIZE);
     InterruptibleThread worker_;
-    std::future<void> futUploadDone_;
+    std::future<bool /*modTimeSet*/> futUploadDone_;
 };
 
 //---------------------------------------------------------------------------------------------------------------------------
@@ -2160,6 +2527,40 @@ private:
         return std::make_unique<OutputStreamFtp>(login_, afsPath, modTime, notifyUnbufferedIO);
     }
 
+    std::optional<uint64_t> getPartialFileSize(const AfsPath& afsPath) const override //noexcept
+    {
+        try
+        {
+            const FtpItem item = getFtpSymlinkInfo(login_, afsPath); //throw FileError
+            if (item.type != AFS::ItemType::file)
+                return {};
+            return item.fileSize;
+        }
+        catch (FileError&) { return {}; } //not existing: most likely case
+    }
+
+    std::unique_ptr<OutputStreamImpl> getOutputStreamAppend(const AfsPath& afsPath, //throw FileError
+                                                            std::optional<uint64_t> bytesToAppend,
+                                                            std::optional<time_t> modTime,
+                                                            const IoCallback& notifyUnbufferedIO /*throw X*/) const override
+    {
+        return std::make_unique<OutputStreamFtp>(login_, afsPath, modTime, notifyUnbufferedIO, true /*append*/);
+    }
+
+    FileDigest getServerFileDigest(const AfsPath& afsPath) const override //throw FileError
+    {
+        try
+        {
+            FileDigest digest;
+            accessFtpSession(login_, [&](FtpSession& session) //throw SysError
+            {
+                digest = session.getFileDigest(afsPath); //throw SysError
+            });
+            return digest;
+        }
+        catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(getDisplayPath(afsPath))), e.toString()); }
+    }
+
     //----------------------------------------------------------------------------------------------------------------
     void traverseFolderRecursive(const TraverserWorkload& workload /*throw X*/, size_t parallelOps) const override
     {
@@ -2177,7 +2578,7 @@ private:
             throw FileError(replaceCpy(_("Cannot write permissions of %x."), L"%x", fmtPath(AFS::getDisplayPath(apTarget))), _("Operation not supported by device."));
 
         //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
-        return copyFileAsStream(afsSource, attrSource, apTarget, notifyUnbufferedIO); //throw FileError, (ErrorFileLocked), X
+        return copyFileAsStream(afsSource, attrSource, apTarget, false /*calcContentHash*/, notifyUnbufferedIO); //throw FileError, (ErrorFileLocked), X
     }
 
     //symlink handling: follow
@@ -2211,7 +2612,7 @@ private:
                                                         L"%y", L'\n' + fmtPath(AFS::getDisplayPath(pathTo)));
                                     };
 
-        if (compareDeviceSameAfsType(pathTo.afsDevice.ref()) != std::weak_ordering::equivalent)
+        if (!isMoveCompatibleSameAfsType(pathTo.afsDevice.ref()))
             throw ErrorMoveUnsupported(generateErrorMsg(), _("Operation not supported between different devices."));
 
         try
@@ -2236,6 +2637,9 @@ private:
         }
     }
 
+    //RNTO on existing target: server-dependent (see above)
+    bool tryMoveAndReplaceFileForSameAfsType(const AfsPath& pathFrom, const AbstractPath& pathTo) const override { return false; } //throw FileError
+
     bool supportsPermissions(const AfsPath& afsPath) const override { return false; } //throw FileError
     //wait until there is real demand for copying from and to FTP with permissions => use stream-based file copy:
 
@@ -2247,6 +2651,8 @@ private:
 
     int getAccessTimeout() const override { return login_.timeoutSec; } //returns "0" if no timeout in force
 
+    void prepareSessions(size_t sessionCount) const override { prepareFtpSessions(login_, sessionCount); } //noexcept
+
     bool hasNativeTransactionalCopy() const override { return false; }
     //----------------------------------------------------------------------------------------------------------------
 
@@ -2293,6 +2699,18 @@ Zstring concatenateFtpFolderPathPhrase(const FtpLogin& login, const AfsPath& afs
     if (login.useTls)
         options += Zstr("|ssl");
 
+    if (login.socketBufferBytes > 0)
+        options += Zstr("|sockbuf=") + numberTo<Zstring>(login.socketBufferBytes);
+
+    if (login.socketNotSentLowAt > 0)
+        options += Zstr("|notsent=") + numberTo<Zstring>(login.socketNotSentLowAt);
+
+    if (!login.congestionControl.empty())
+        options += Zstr("|cc=") + login.congestionControl;
+
+    if (login.listingCache)
+        options += Zstr("|listcache");
+
     if (!login.password.empty()) //password always last => visually truncated by folder input field
         options += Zstr("|pass64=") + encodePasswordBase64(login.password);
 
@@ -2337,8 +2755,11 @@ AfsDevice fff::condenseToFtpDevice(const FtpLogin& login) //noexcept
     FtpLogin loginTmp = login;
     trim(loginTmp.server);
     trim(loginTmp.username);
+    trim(loginTmp.congestionControl);
 
     loginTmp.timeoutSec = std::max(1, loginTmp.timeoutSec);
+    loginTmp.socketBufferBytes  = std::max(0, loginTmp.socketBufferBytes);
+    loginTmp.socketNotSentLowAt = std::max(0, loginTmp.socketNotSentLowAt);
 
     if (startsWithAsciiNoCase(loginTmp.server, "http:" ) ||
         startsWithAsciiNoCase(loginTmp.server, "https:") ||
@@ -2406,6 +2827,14 @@ AbstractPath fff::createItemPathFtp(const Zstring& itemPathPhrase) //noexcept
             login.timeoutSec = stringTo<int>(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none));
         else if (optPhrase == Zstr("ssl"))
             login.useTls = true;
+        else if (startsWith(optPhrase, Zstr("sockbuf=")))
+            login.socketBufferBytes = stringTo<int>(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none));
+        else if (startsWith(optPhrase, Zstr("notsent=")))
+            login.socketNotSentLowAt = stringTo<int>(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none));
+        else if (startsWith(optPhrase, Zstr("cc=")))
+            login.congestionControl = afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none);
+        else if (optPhrase == Zstr("listcache"))
+            login.listingCache = true;
         else if (startsWith(optPhrase, Zstr("pass64=")))
             login.password = decodePasswordBase64(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none));
         else
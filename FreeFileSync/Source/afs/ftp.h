@@ -28,6 +28,10 @@ struct FtpSessionId
     Zstring username;
     Zstring password;
     bool useTls = false;
+    //TCP tuning for high bandwidth-delay product links: see zen/socket.h
+    int socketBufferBytes = 0;  //0: OS auto-tuning
+    int socketNotSentLowAt = 0; //0: OS default
+    Zstring congestionControl;  //empty: OS default
 };
 const int DEFAULT_PORT_FTP = 21; //TLS enabled? => same for explicit FTP, but *implicit* FTP uses port 990
 
@@ -35,6 +39,7 @@ struct FtpLogin : FtpSessionId
 {
     //other settings not specific to FTP session:
     int timeoutSec = 15;
+    bool listingCache = false; //reuse folder listings of previous runs (MLSD only): see listing_cache.h
 };
 AfsDevice condenseToFtpDevice(const FtpLogin& login); //noexcept; potentially messy user input
 FtpLogin extractFtpLogin(const AfsDevice& afsDevice); //noexcept
@@ -5,6 +5,7 @@
 // *****************************************************************************
 
 #include "gdrive.h"
+#include <deque>
 #include <variant>
 #include <unordered_set> //needed by clang
 #include <unordered_map> //
@@ -61,6 +62,14 @@ GLOBAL_RUN_ONCE(globalGdrivePathAccessLocker.set(std::make_unique<PathAccessLock
 
 template <> std::shared_ptr<PathAccessLocker<GdriveRawPath>> PathAccessLocker<GdriveRawPath>::getGlobalInstance() { return globalGdrivePathAccessLocker.get(); }
 template <> Zstring PathAccessLocker<GdriveRawPath>::getItemName(const GdriveRawPath& nativePath) { return nativePath.itemName; }
+template <> size_t PathAccessLocker<GdriveRawPath>::getPathHash(const GdriveRawPath& nativePath)
+{
+    //consistent with operator<=>: compareNativePath() is a byte-wise comparison
+    FNV1aHash<size_t> hash;
+    for (const char c : nativePath.parentId) hash.add(static_cast<unsigned char>(c));
+    for (const Zchar c : nativePath.itemName) hash.add(static_cast<std::make_unsigned_t<Zchar>>(c));
+    return hash.get();
+}
 
 using PathAccessLock = PathAccessLocker<GdriveRawPath>::Lock; //throw SysError
 using PathBlockType  = PathAccessLocker<GdriveRawPath>::BlockType;
@@ -79,12 +88,35 @@ constexpr std::chrono::seconds GDRIVE_SYNC_INTERVAL         (5);
 
 const int GDRIVE_STREAM_BUFFER_SIZE = 512 * 1024; //unit: [byte]
 
+const size_t GDRIVE_BATCH_REQUESTS_MAX = 100; //"You're limited to 100 calls in a single batch request."
+
+const size_t GDRIVE_LIST_PARENTS_MAX = 25; //folders listed by a single files.list query; keep "q" clear of "The query is too complex"
+
+//resumable uploads in chunks: https://developers.google.com/drive/api/guides/manage-uploads#uploading
+const uint64_t GDRIVE_CHUNKED_UPLOAD_MIN_SIZE   = 64 * 1024 * 1024; //[byte] smaller files: single request, gzip-compressed
+const size_t   GDRIVE_UPLOAD_CHUNK_GRANULARITY  = 256 * 1024;       //[byte] "must be a multiple of 256 KB" (except for last chunk)
+const size_t   GDRIVE_UPLOAD_CHUNK_SIZE_MIN     =   8 * 1024 * 1024; //[byte]
+const size_t   GDRIVE_UPLOAD_CHUNK_SIZE_MAX     = 128 * 1024 * 1024; //[byte] buffered in memory per upload!
+constexpr std::chrono::seconds GDRIVE_UPLOAD_CHUNK_TARGET_TIME(10);  //adapt chunk size to bandwidth
+const int GDRIVE_UPLOAD_CHUNK_RETRIES_MAX = 5; //consecutive errors without progress
+static_assert(GDRIVE_UPLOAD_CHUNK_SIZE_MIN % GDRIVE_UPLOAD_CHUNK_GRANULARITY == 0 && GDRIVE_UPLOAD_CHUNK_SIZE_MAX % GDRIVE_UPLOAD_CHUNK_SIZE_MIN == 0);
+
+//parallel range downloads: throughput is throttled per connection
+const uint64_t GDRIVE_PARALLEL_DOWNLOAD_MIN_SIZE    = 64 * 1024 * 1024; //[byte]
+const size_t   GDRIVE_PARALLEL_DOWNLOAD_CHUNK_SIZE  =  8 * 1024 * 1024; //[byte] buffered in memory: up to GDRIVE_PARALLEL_DOWNLOAD_CONNECTIONS chunks per download
+const size_t   GDRIVE_PARALLEL_DOWNLOAD_CONNECTIONS = 4;
+
 const Zchar gdrivePrefix[] = Zstr("gdrive:");
 const char gdriveFolderMimeType  [] = "application/vnd.google-apps.folder";
 const char gdriveShortcutMimeType[] = "application/vnd.google-apps.shortcut"; //= symbolic link!
 
 const char DB_FILE_DESCR[] = "FreeFileSync";
-const int  DB_FILE_VERSION = 5; //2021-05-15
+const int  DB_FILE_VERSION = 8; //2026-10-14
+
+const int GDRIVE_FOLDER_STATE_EXPIRATION_DAYS = 30; //don't persist buffered folders that were not accessed for a while
+const int GDRIVE_FOLDER_ACCESS_TIME_PRECISION = 24 * 3600; //[sec] avoid rewriting the DB just to update access times
+
+const size_t GDRIVE_CHECKPOINT_CHANGES_MAX = 100'000; //more changed items since checkpoint: full comparison is cheaper
 
 std::string getGdriveClientId    () { return ""; } // => replace with live credentials
 std::string getGdriveClientSecret() { return ""; } //
@@ -92,17 +124,28 @@ std::string getGdriveClientSecret() { return ""; } //
 
 
 
+enum class HttpConnection
+{
+    multiplexed, //HTTP/2: share one connection per server => small requests: save TCP + TLS handshakes, avoid hitting server connection limits
+    dedicated,   //curl callbacks may block (e.g. streaming file content) => must not stall other transfers on a shared event loop
+};
+
 struct HttpSessionId
 {
-    /*explicit*/ HttpSessionId(const Zstring& serverName) :
-        server(serverName) {}
+    /*explicit*/ HttpSessionId(const Zstring& serverName, HttpConnection conn = HttpConnection::dedicated) :
+        server(serverName), connection(conn) {}
 
     Zstring server;
+    HttpConnection connection = HttpConnection::dedicated;
 };
 std::weak_ordering operator<=>(const HttpSessionId& lhs, const HttpSessionId& rhs)
 {
     //exactly the type of case insensitive comparison we need for server names!
-    return compareAsciiNoCase(lhs.server, rhs.server); //https://docs.microsoft.com/en-us/windows/win32/api/ws2tcpip/nf-ws2tcpip-getaddrinfow#IDNs
+    if (const std::weak_ordering cmp = compareAsciiNoCase(lhs.server, rhs.server); //https://docs.microsoft.com/en-us/windows/win32/api/ws2tcpip/nf-ws2tcpip-getaddrinfow#IDNs
+        cmp != std::weak_ordering::equivalent)
+        return cmp;
+
+    return lhs.connection <=> rhs.connection;
 }
 
 
@@ -210,7 +253,11 @@ public:
 
         //create new HTTP session outside the lock: 1. don't block other threads 2. non-atomic regarding "sessionStore"! => one session too many is not a problem!
         if (!httpSession)
-            httpSession = std::make_unique<HttpInitSession>(getLibsshCurlUnifiedInitCookie(httpSessionCount), login.server, caCertFilePath_); //throw SysError
+        {
+            HttpMultiplexer* multiplexer = login.connection == HttpConnection::multiplexed ? &getMultiplexer(login) : nullptr; //throw SysError
+
+            httpSession = std::make_unique<HttpInitSession>(getLibsshCurlUnifiedInitCookie(httpSessionCount), login.server, caCertFilePath_, multiplexer); //throw SysError
+        }
 
         ZEN_ON_SCOPE_EXIT(
             if (isHealthy(httpSession->session)) //thread that created the "!isHealthy()" session is responsible for clean up (avoid hitting server connection limits!)
@@ -226,12 +273,36 @@ private:
     //associate session counting (for initialization/teardown)
     struct HttpInitSession
     {
-        HttpInitSession(std::shared_ptr<UniCounterCookie> cook, const Zstring& server, const Zstring& caCertFilePath) :
-            cookie(std::move(cook)), session(server, true /*useTls*/, caCertFilePath) {}
+        HttpInitSession(std::shared_ptr<UniCounterCookie> cook, const Zstring& server, const Zstring& caCertFilePath, HttpMultiplexer* multiplexer) :
+            cookie(std::move(cook)), session(server, true /*useTls*/, caCertFilePath, multiplexer) {}
 
         std::shared_ptr<UniCounterCookie> cookie;
         HttpSession session; //life time must be subset of UniCounterCookie
     };
+
+    struct HttpInitMultiplexer
+    {
+        explicit HttpInitMultiplexer(std::shared_ptr<UniCounterCookie> cook) : cookie(std::move(cook)) {}
+
+        std::shared_ptr<UniCounterCookie> cookie;
+        HttpMultiplexer multiplexer; //life time must be subset of UniCounterCookie
+    };
+
+    HttpMultiplexer& getMultiplexer(const HttpSessionId& login) //throw SysError
+    {
+        //one multiplexer (= shared connection cache + event loop) per server; life-time bound to globalInstance => never remove!
+        HttpMultiplexer* multiplexer = nullptr;
+
+        globalMultiplexers_.access([&](GlobalHttpMultiplexers& multiplexersById)
+        {
+            std::unique_ptr<HttpInitMultiplexer>& muxInit = multiplexersById[login]; //get or create
+            if (!muxInit) //create inside the lock: rare + cheap
+                muxInit = std::make_unique<HttpInitMultiplexer>(getLibsshCurlUnifiedInitCookie(httpSessionCount)); //throw SysError
+
+            multiplexer = &muxInit->multiplexer;
+        });
+        return *multiplexer;
+    }
     static bool isHealthy(const HttpSession& s) { return std::chrono::steady_clock::now() - s.getLastUseTime() <= HTTP_SESSION_MAX_IDLE_TIME; }
 
     using IdleHttpSessions = std::vector<std::unique_ptr<HttpInitSession>>;
@@ -289,8 +360,10 @@ private:
         }
     }
 
-    using GlobalHttpSessions = std::map<HttpSessionId, Protected<IdleHttpSessions>>;
+    using GlobalHttpSessions     = std::map<HttpSessionId, Protected<IdleHttpSessions>>;
+    using GlobalHttpMultiplexers = std::map<HttpSessionId, std::unique_ptr<HttpInitMultiplexer>>;
 
+    Protected<GlobalHttpMultiplexers> globalMultiplexers_; //life time must be superset of the HttpSessions using them => declare before globalSessionStore_
     Protected<GlobalHttpSessions> globalSessionStore_;
     const Zstring caCertFilePath_;
     InterruptibleThread sessionCleaner_;
@@ -308,14 +381,147 @@ struct GdriveAccess
 
 //===========================================================================================================================
 
+/*  shared rate limit per account: Google Drive answers bursts of parallel requests with 403 "userRateLimitExceeded"/"rateLimitExceeded" or 429
+    => independent per-thread backoff results in retry storms => all requests of an account pass one governor instead:
+    - token bucket: at most "rate" requests per second, bursts up to GDRIVE_RATE_BURST_MAX
+    - AIMD: quota error => halve rate (at most once per GDRIVE_RATE_DECREASE_INTERVAL) + pause all requests; success => increase rate additively
+    - waiting requests are served transfers first (uploads/downloads), then metadata, each in FIFO order      */
+const double GDRIVE_RATE_INIT     = 20; //requests per second
+const double GDRIVE_RATE_MIN      = 1;  //
+const double GDRIVE_RATE_MAX      = 200; //"Queries per 100 seconds per user: 20.000"
+const double GDRIVE_RATE_BURST_MAX = 10; //requests
+const std::chrono::seconds GDRIVE_RATE_DECREASE_INTERVAL(1); //quota errors of requests in flight belong to the same overload
+const int GDRIVE_RATE_RETRY_MAX = 6;
+
+
+enum class GdriveTraffic
+{
+    transfer, //=> served first
+    metadata,
+};
+
+
+class GdriveRateGovernor
+{
+public:
+    void acquire(const std::string& accountKey, GdriveTraffic traffic)
+    {
+        std::unique_lock dummy(lockAccounts_);
+
+        Account& acct = accounts_[accountKey]; //std::map: reference stays valid
+        const Ticket ticket{traffic, nextTicketNo_++};
+        acct.waiting.insert(ticket);
+        ZEN_ON_SCOPE_EXIT(acct.waiting.erase(ticket); conditionAccountChanged_.notify_all()); //next in line may proceed
+
+        for (;;)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            refill(acct, now);
+
+            if (*acct.waiting.begin() == ticket)
+            {
+                if (now >= acct.pausedUntil && acct.tokens >= 1)
+                {
+                    acct.tokens -= 1;
+                    return;
+                }
+                const auto nextTokenTime = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>((1 - acct.tokens) / acct.rate));
+                conditionAccountChanged_.wait_until(dummy, std::max(acct.pausedUntil, nextTokenTime));
+            }
+            else
+                conditionAccountChanged_.wait(dummy); //notified when a ticket ahead leaves
+        }
+    }
+
+    void reportQuotaExceeded(const std::string& accountKey, int retryCount)
+    {
+        std::lock_guard dummy(lockAccounts_);
+        Account& acct = accounts_[accountKey];
+
+        const auto now = std::chrono::steady_clock::now();
+        const std::chrono::milliseconds backoff(std::min(250 << retryCount, 16'000) + getRandomJitterMs());
+
+        refill(acct, now);
+        if (now >= acct.lastDecrease + GDRIVE_RATE_DECREASE_INTERVAL)
+        {
+            acct.rate = std::max(acct.rate / 2, GDRIVE_RATE_MIN);
+            acct.lastDecrease = now;
+        }
+        acct.tokens = 0; //no bursts right after overload
+        acct.pausedUntil = std::max(acct.pausedUntil, now + backoff);
+    }
+
+    void reportSuccess(const std::string& accountKey)
+    {
+        std::lock_guard dummy(lockAccounts_);
+        Account& acct = accounts_[accountKey];
+
+        //additive increase: ~ +1 request/sec per second at full utilization
+        acct.rate = std::min(acct.rate + 1 / acct.rate, GDRIVE_RATE_MAX);
+    }
+
+private:
+    struct Ticket
+    {
+        GdriveTraffic traffic;
+        uint64_t ticketNo;
+        std::strong_ordering operator<=>(const Ticket&) const = default;
+    };
+
+    struct Account
+    {
+        double rate   = GDRIVE_RATE_INIT;
+        double tokens = GDRIVE_RATE_BURST_MAX;
+        std::chrono::steady_clock::time_point lastRefill = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point lastDecrease;
+        std::chrono::steady_clock::time_point pausedUntil;
+        std::set<Ticket> waiting;
+    };
+
+    static void refill(Account& acct, std::chrono::steady_clock::time_point now)
+    {
+        const double elapsedSec = std::chrono::duration<double>(now - acct.lastRefill).count();
+        acct.tokens = std::min(acct.tokens + elapsedSec * acct.rate, GDRIVE_RATE_BURST_MAX);
+        acct.lastRefill = now;
+    }
+
+    int getRandomJitterMs() //don't let all threads of an account retry in lockstep
+    {
+        return static_cast<int>(jitterSeed_++ * 2654435761U % 250);
+    }
+
+    std::mutex lockAccounts_;
+    std::condition_variable conditionAccountChanged_;
+    std::map<std::string /*access token*/, Account> accounts_;
+    uint64_t nextTicketNo_ = 0;
+    uint32_t jitterSeed_ = 0;
+};
+
+constinit Global<GdriveRateGovernor> globalGdriveRateGovernor;
+GLOBAL_RUN_ONCE(globalGdriveRateGovernor.set(std::make_unique<GdriveRateGovernor>()));
+
+
+bool isGdriveQuotaError(int statusCode, const std::string& response)
+{
+    //https://developers.google.com/drive/api/guides/limits#exponential
+    return statusCode == 429 ||
+           (statusCode == 403 && (contains(response, "\"userRateLimitExceeded\"") ||
+                                  contains(response, "\"rateLimitExceeded\"")));
+}
+
+//===========================================================================================================================
+
 HttpSession::Result googleHttpsRequest(const Zstring& serverName, const std::string& serverRelPath, //throw SysError, X
                                        const std::vector<std::string>& extraHeaders,
                                        std::vector<CurlOption> extraOptions,
                                        const std::function<void  (std::span<const char> buf)>& writeResponse /*throw X*/, //optional
                                        const std::function<size_t(std::span<      char> buf)>& readRequest   /*throw X*/, //optional; returning 0 signals EOF
                                        const std::function<void  (const std::string_view& header)>& receiveHeader /*throw X*/, //optional
-                                       int timeoutSec)
+                                       int timeoutSec, HttpConnection connection = HttpConnection::multiplexed)
 {
+    if (readRequest) //uploads: callback may block on the input stream
+        connection = HttpConnection::dedicated;
+
     //https://developers.google.com/drive/api/v3/performance
     //"In order to receive a gzip-encoded response you must do two things: Set an Accept-Encoding header, ["gzip" automatically set by HttpSession]
     extraOptions.emplace_back(CURLOPT_USERAGENT, "FreeFileSync (gzip)"); //and modify your user agent to contain the string gzip."
@@ -326,7 +532,7 @@ HttpSession::Result googleHttpsRequest(const Zstring& serverName, const std::str
 
     HttpSession::Result httpResult;
 
-    mgr->access(HttpSessionId(serverName), [&](HttpSession& session) //throw SysError
+    mgr->access(HttpSessionId(serverName, connection), [&](HttpSession& session) //throw SysError
     {
         httpResult = session.perform(serverRelPath, extraHeaders, extraOptions, writeResponse, readRequest, receiveHeader, timeoutSec); //throw SysError, X
     });
@@ -341,16 +547,270 @@ HttpSession::Result gdriveHttpsRequest(const std::string& serverRelPath, //throw
                                        const std::function<void  (std::span<const char> buf)>& writeResponse /*throw X*/, //optional
                                        const std::function<size_t(std::span<      char> buf)>& readRequest   /*throw X*/, //optional; returning 0 signals EOF
                                        const std::function<void  (const std::string_view& header)>& receiveHeader /*throw X*/, //optional
-                                       const GdriveAccess& access)
+                                       const GdriveAccess& access, HttpConnection connection = HttpConnection::multiplexed)
 {
     extraHeaders.push_back("Authorization: Bearer " + access.token);
 
-    return googleHttpsRequest(GOOGLE_REST_API_SERVER, serverRelPath,
-                              extraHeaders,
-                              extraOptions,
-                              writeResponse /*throw X*/,
-                              readRequest   /*throw X*/,
-                              receiveHeader /*throw X*/, access.timeoutSec); //throw SysError, X
+    const std::shared_ptr<GdriveRateGovernor> governor = globalGdriveRateGovernor.get();
+    if (!governor)
+        throw SysError(formatSystemError("gdriveHttpsRequest", L"", L"Function call not allowed during init/shutdown."));
+
+    const GdriveTraffic traffic = readRequest || connection == HttpConnection::dedicated ? GdriveTraffic::transfer : GdriveTraffic::metadata;
+
+    for (int retryCount = 0;; ++retryCount)
+    {
+        governor->acquire(access.token, traffic);
+
+        //hold back body of potential quota errors: pass to caller only if not retrying
+        int statusCode = 0;
+        std::string errorResponse;
+
+        const HttpSession::Result httpResult = googleHttpsRequest(GOOGLE_REST_API_SERVER, serverRelPath,
+                                                                  extraHeaders,
+                                                                  extraOptions,
+                                                                  [&](std::span<const char> buf)
+        {
+            if (statusCode == 403 || statusCode == 429)
+                errorResponse.append(buf.data(), buf.size());
+            else if (writeResponse)
+                writeResponse(buf); //throw X
+        },
+        readRequest /*throw X*/,
+        [&](const std::string_view& header)
+        {
+            //HTTP/2 429 (last status line counts: "100 Continue", redirects)
+            if (startsWith(header, "HTTP/"))
+                statusCode = stringTo<int>(beforeFirst(afterFirst(header, ' ', IfNotFoundReturn::none), ' ', IfNotFoundReturn::all));
+            if (receiveHeader)
+                receiveHeader(header); //throw X
+        }, access.timeoutSec, connection); //throw SysError, X
+
+        const bool quotaExceeded = isGdriveQuotaError(httpResult.statusCode, errorResponse);
+        if (quotaExceeded)
+            governor->reportQuotaExceeded(access.token, retryCount);
+        else
+            governor->reportSuccess(access.token);
+
+        if (!quotaExceeded || readRequest /*request body can't be replayed*/ || retryCount >= GDRIVE_RATE_RETRY_MAX)
+        {
+            if (!errorResponse.empty() && writeResponse)
+                writeResponse(errorResponse); //throw X
+            return httpResult;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------------------
+
+//metadata-only REST call: small JSON request/response => candidate for the batch endpoint
+struct GdriveMetaRequest
+{
+    std::string method; //"POST", "PATCH", "DELETE"
+    std::string serverRelPath;
+    std::string jsonBody; //optional
+};
+
+struct GdriveMetaResult
+{
+    int statusCode = 0;
+    std::string response;
+};
+
+
+std::string_view getPartBody(std::string_view part) //skip header lines until first empty line
+{
+    for (const std::string_view blankLine : {"\r\n\r\n", "\n\n"})
+        if (const size_t pos = part.find(blankLine);
+            pos != std::string_view::npos)
+            return part.substr(pos + blankLine.size());
+    return {};
+}
+
+
+std::vector<std::optional<GdriveMetaResult>> parseGdriveBatchResponse(const std::string& response, const std::string& boundary, size_t requestCount)
+{
+    std::vector<std::optional<GdriveMetaResult>> results(requestCount);
+
+    const std::string delimiter = "--" + boundary;
+    for (size_t pos = response.find(delimiter); pos != std::string::npos;)
+    {
+        const size_t partBegin = pos + delimiter.size();
+        const size_t partEnd = response.find(delimiter, partBegin);
+        const std::string_view part = makeStringView(response.begin() + partBegin, partEnd == std::string::npos ? response.end() : response.begin() + partEnd);
+        pos = partEnd;
+
+        //Content-ID: <response-item7>
+        const std::string_view contentId = afterFirst(part, "<response-item", IfNotFoundReturn::none);
+        const size_t idx = stringTo<size_t>(beforeFirst(contentId, '>', IfNotFoundReturn::none));
+        if (contentId.empty() || idx >= requestCount)
+            continue; //e.g. closing delimiter "--"
+
+        //HTTP/1.1 200 OK
+        const std::string_view httpResponse = getPartBody(part);
+        const std::string_view statusCode = beforeFirst(afterFirst(httpResponse, ' ', IfNotFoundReturn::none), ' ', IfNotFoundReturn::all);
+
+        GdriveMetaResult& result = results[idx].emplace();
+        result.statusCode = stringTo<int>(statusCode);
+        result.response = trimCpy(std::string(getPartBody(httpResponse)));
+    }
+    return results;
+}
+
+
+/*  group commit for metadata-only requests, e.g. deleting 50k files: https://developers.google.com/drive/api/guides/performance#batch-requests
+    - requests arriving while a batch is in flight are collected and sent together by whichever waiting thread is first => no extra latency for a single thread
+    - single request: sent as is, without batch overhead
+    - errors of individual requests are mapped back to the caller; failure of the batch request fails all of them  */
+class GdriveRequestBatcher
+{
+public:
+    GdriveMetaResult perform(const GdriveMetaRequest& request, const GdriveAccess& access) //throw SysError
+    {
+        auto item = std::make_shared<PendingRequest>(request);
+
+        std::unique_lock dummy(lockQueues_);
+        queues_[access.token].pending.push_back(item); //few access tokens per session => never remove entries
+
+        for (;;)
+        {
+            if (item->result)
+                return *item->result;
+            if (item->error)
+                std::rethrow_exception(item->error); //throw SysError
+
+            RequestQueue& queue = queues_[access.token];
+            if (!queue.batchInFlight)
+            {
+                queue.batchInFlight = true;
+
+                std::vector<std::shared_ptr<PendingRequest>> batch;
+                while (!queue.pending.empty() && batch.size() < GDRIVE_BATCH_REQUESTS_MAX)
+                {
+                    batch.push_back(std::move(queue.pending.front()));
+                    queue.pending.pop_front();
+                }
+                dummy.unlock();
+                try
+                {
+                    const std::vector<GdriveMetaResult>& results = sendBatch(batch, access); //throw SysError
+                    for (size_t i = 0; i < batch.size(); ++i)
+                        batch[i]->result = results[i];
+                }
+                catch (SysError&)
+                {
+                    for (const std::shared_ptr<PendingRequest>& pr : batch)
+                        pr->error = std::current_exception();
+                }
+                dummy.lock();
+
+                queues_[access.token].batchInFlight = false;
+                conditionBatchDone_.notify_all();
+            }
+            else
+                conditionBatchDone_.wait(dummy); //bounded by HTTP time out of the batch in flight
+        }
+    }
+
+private:
+    struct PendingRequest
+    {
+        explicit PendingRequest(const GdriveMetaRequest& req) : request(req) {}
+
+        const GdriveMetaRequest request;
+        std::optional<GdriveMetaResult> result;
+        std::exception_ptr error;
+    };
+
+    struct RequestQueue
+    {
+        std::deque<std::shared_ptr<PendingRequest>> pending;
+        bool batchInFlight = false;
+    };
+
+    static std::vector<GdriveMetaResult> sendBatch(const std::vector<std::shared_ptr<PendingRequest>>& batch, const GdriveAccess& access) //throw SysError
+    {
+        if (batch.size() == 1)
+        {
+            const GdriveMetaRequest& req = batch[0]->request;
+
+            std::vector<CurlOption> extraOptions;
+            if (req.method != "POST")
+                extraOptions.emplace_back(CURLOPT_CUSTOMREQUEST, req.method.c_str());
+            if (!req.jsonBody.empty())
+                extraOptions.emplace_back(CURLOPT_POSTFIELDS, req.jsonBody.c_str());
+
+            GdriveMetaResult result;
+            result.statusCode = gdriveHttpsRequest(req.serverRelPath, req.jsonBody.empty() ? std::vector<std::string>() :
+                                                   std::vector<std::string> {"Content-Type: application/json; charset=UTF-8"}, extraOptions,
+            [&](std::span<const char> buf) { result.response.append(buf.data(), buf.size()); },
+            nullptr /*readRequest*/, nullptr /*receiveHeader*/, access).statusCode; //throw SysError
+            return {result};
+        }
+
+        //https://developers.google.com/drive/api/guides/performance#format-of-a-batch-request
+        const std::string boundaryString = stringEncodeBase64(generateGUID() + generateGUID());
+
+        std::string postBuf;
+        for (size_t i = 0; i < batch.size(); ++i)
+        {
+            const GdriveMetaRequest& req = batch[i]->request;
+            postBuf += "--" + boundaryString +                     "\r\n"
+                       "Content-Type: application/http"             "\r\n"
+                       "Content-ID: <item" + numberTo<std::string>(i) + ">\r\n"
+                       /**/                                         "\r\n" +
+                       req.method + ' ' + req.serverRelPath + " HTTP/1.1\r\n";
+            if (!req.jsonBody.empty())
+                postBuf += "Content-Type: application/json; charset=UTF-8\r\n"
+                           /**/                                    "\r\n" + req.jsonBody;
+            postBuf += "\r\n";
+        }
+        postBuf += "--" + boundaryString + "--";
+
+        std::string responseBoundary;
+        auto onHeaderData = [&](const std::string_view& header)
+        {
+            //Content-Type: multipart/mixed; boundary=batch_xyz
+            if (startsWithAsciiNoCase(header, "Content-Type:"))
+            {
+                responseBoundary = afterFirst(header, "boundary=", IfNotFoundReturn::none);
+                trim(responseBoundary, true, true, [](char c) { return isWhiteSpace(c) || c == '"'; });
+            }
+        };
+
+        std::string response;
+        const HttpSession::Result httpResult = gdriveHttpsRequest("/batch/drive/v3", {"Content-Type: multipart/mixed; boundary=" + boundaryString},
+        {{CURLOPT_POSTFIELDS, postBuf.c_str()}}, [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); },
+        nullptr /*readRequest*/, onHeaderData, access); //throw SysError
+
+        if (httpResult.statusCode != 200 || responseBoundary.empty())
+            throw SysError(formatGdriveErrorRaw(response));
+
+        std::vector<GdriveMetaResult> results;
+        for (std::optional<GdriveMetaResult>& result : parseGdriveBatchResponse(response, responseBoundary, batch.size()))
+        {
+            if (!result)
+                throw SysError(formatSystemError("GdriveRequestBatcher", L"", L"Batch response incomplete.")); //user should never see this...
+            results.push_back(std::move(*result));
+        }
+        return results;
+    }
+
+    std::mutex lockQueues_;
+    std::condition_variable conditionBatchDone_;
+    std::map<std::string /*access token*/, RequestQueue> queues_;
+};
+
+constinit Global<GdriveRequestBatcher> globalGdriveRequestBatcher;
+GLOBAL_RUN_ONCE(globalGdriveRequestBatcher.set(std::make_unique<GdriveRequestBatcher>()));
+
+
+GdriveMetaResult gdriveMetaRequest(const GdriveMetaRequest& request, const GdriveAccess& access) //throw SysError
+{
+    const std::shared_ptr<GdriveRequestBatcher> batcher = globalGdriveRequestBatcher.get();
+    if (!batcher)
+        throw SysError(formatSystemError("gdriveMetaRequest", L"", L"Function call not allowed during init/shutdown."));
+
+    return batcher->perform(request, access); //throw SysError
 }
 
 //========================================================================================================
@@ -915,61 +1375,99 @@ struct GdriveItemDetails
 };
 
 
-GdriveItemDetails extractItemDetails(const JsonValue& jvalue) //throw SysError
+//"files" resource as sent by Google: read via JsonPullParser, validated by extractItemDetails()
+struct GdriveItemFields
 {
-    assert(jvalue.type == JsonValue::Type::object);
+    std::optional<std::string> id;
+    std::optional<std::string> trashed;
+    std::optional<std::string> name;
+    std::optional<std::string> mimeType;
+    std::optional<std::string> ownedByMe;
+    std::optional<std::string> size;
+    std::optional<std::string> modifiedTime;
+    std::vector<std::string> parentIds; //item without "parents" array is possible! e.g. 1. shared item located in "Shared with me", referenced via a Shortcut 2. root folder under "Computers"
+    bool haveShortcut = false;
+    std::optional<std::string> shortcutTargetId;
+    std::string_view rawJson; //for error messages
+};
 
-    /**/  std::optional<std::string> itemName     = getPrimitiveFromJsonObject(jvalue, "name");
-    const std::optional<std::string> mimeType     = getPrimitiveFromJsonObject(jvalue, "mimeType");
-    const std::optional<std::string> ownedByMe    = getPrimitiveFromJsonObject(jvalue, "ownedByMe");
-    const std::optional<std::string> size         = getPrimitiveFromJsonObject(jvalue, "size");
-    const std::optional<std::string> modifiedTime = getPrimitiveFromJsonObject(jvalue, "modifiedTime");
-    const JsonValue*                 parents      = getChildFromJsonObject    (jvalue, "parents");
-    const JsonValue*                 shortcut     = getChildFromJsonObject    (jvalue, "shortcutDetails");
 
-    if (!itemName || itemName->empty() || !mimeType || !modifiedTime)
-        throw SysError(formatGdriveErrorRaw(serializeJson(jvalue)));
+GdriveItemFields readItemFields(JsonPullParser& jp) //throw JsonParsingError
+{
+    GdriveItemFields fields;
+    const size_t posFirst = jp.getPos();
+
+    jp.beginObject(); //throw JsonParsingError
+    while (const std::optional<std::string_view> name = jp.nextMember()) //throw JsonParsingError
+        //*INDENT-OFF*
+        if      (*name == "id")           fields.id           = jp.readPrimitive(); //throw JsonParsingError
+        else if (*name == "trashed")      fields.trashed      = jp.readPrimitive(); //
+        else if (*name == "name")         fields.name         = jp.readPrimitive(); //
+        else if (*name == "mimeType")     fields.mimeType     = jp.readPrimitive(); //
+        else if (*name == "ownedByMe")    fields.ownedByMe    = jp.readPrimitive(); //
+        else if (*name == "size")         fields.size         = jp.readPrimitive(); //
+        else if (*name == "modifiedTime") fields.modifiedTime = jp.readPrimitive(); //
+        //*INDENT-ON*
+        else if (*name == "parents")
+        {
+            jp.beginArray(); //throw JsonParsingError
+            while (jp.nextElement()) //throw JsonParsingError
+                fields.parentIds.push_back(jp.readString()); //throw JsonParsingError
+        }
+        else if (*name == "shortcutDetails")
+        {
+            fields.haveShortcut = true;
+            jp.beginObject(); //throw JsonParsingError
+            while (const std::optional<std::string_view> nameSub = jp.nextMember()) //throw JsonParsingError
+                if (*nameSub == "targetId")
+                    fields.shortcutTargetId = jp.readPrimitive(); //throw JsonParsingError
+                else
+                    jp.skipValue(); //throw JsonParsingError
+        }
+        else
+            jp.skipValue(); //throw JsonParsingError
+
+    fields.rawJson = jp.getRawSince(posFirst);
+    return fields;
+}
+
+
+GdriveItemDetails extractItemDetails(GdriveItemFields&& fields) //throw SysError
+{
+    if (!fields.name || fields.name->empty() || !fields.mimeType || !fields.modifiedTime)
+        throw SysError(formatGdriveErrorRaw(std::string(fields.rawJson)));
 
-    const GdriveItemType type = *mimeType == gdriveFolderMimeType   ? GdriveItemType::folder :
-                                *mimeType == gdriveShortcutMimeType ? GdriveItemType::shortcut :
+    const GdriveItemType type = *fields.mimeType == gdriveFolderMimeType   ? GdriveItemType::folder :
+                                *fields.mimeType == gdriveShortcutMimeType ? GdriveItemType::shortcut :
                                 GdriveItemType::file;
 
-    const FileOwner owner = ownedByMe ? (*ownedByMe == "true" ? FileOwner::me : FileOwner::other) : FileOwner::none; //"Not populated for items in Shared Drives"
-    const uint64_t fileSize = size ? stringTo<uint64_t>(*size) : 0; //not available for folders and shortcuts
+    const FileOwner owner = fields.ownedByMe ? (*fields.ownedByMe == "true" ? FileOwner::me : FileOwner::other) : FileOwner::none; //"Not populated for items in Shared Drives"
+    const uint64_t fileSize = fields.size ? stringTo<uint64_t>(*fields.size) : 0; //not available for folders and shortcuts
 
     //RFC 3339 date-time: e.g. "2018-09-29T08:39:12.053Z"
-    const TimeComp tc = parseTime("%Y-%m-%dT%H:%M:%S", beforeLast(*modifiedTime, '.', IfNotFoundReturn::all));
-    if (tc == TimeComp() || !endsWith(*modifiedTime, 'Z')) //'Z' means "UTC" => it seems Google doesn't use the time-zone offset postfix
-        throw SysError(L"Modification time could not be parsed. (" + utfTo<std::wstring>(*modifiedTime) + L')');
+    const std::string& modifiedTime = *fields.modifiedTime;
+    const TimeComp tc = parseTime("%Y-%m-%dT%H:%M:%S", beforeLast(modifiedTime, '.', IfNotFoundReturn::all));
+    if (tc == TimeComp() || !endsWith(modifiedTime, 'Z')) //'Z' means "UTC" => it seems Google doesn't use the time-zone offset postfix
+        throw SysError(L"Modification time could not be parsed. (" + utfTo<std::wstring>(modifiedTime) + L')');
 
     const time_t modTime = utcToTimeT(tc); //returns -1 on error
     if (modTime == -1)
-        throw SysError(L"Modification time could not be parsed. (" + utfTo<std::wstring>(*modifiedTime) + L')');
+        throw SysError(L"Modification time could not be parsed. (" + utfTo<std::wstring>(modifiedTime) + L')');
 
-    std::vector<std::string> parentIds;
-    if (parents) //item without "parents" array is possible! e.g. 1. shared item located in "Shared with me", referenced via a Shortcut 2. root folder under "Computers"
-        for (const JsonValue& parentVal : parents->arrayVal)
-        {
-            if (parentVal.type != JsonValue::Type::string)
-                throw SysError(formatGdriveErrorRaw(serializeJson(jvalue)));
-            parentIds.emplace_back(parentVal.primVal);
-        }
-
-    if (!!shortcut != (type == GdriveItemType::shortcut))
-        throw SysError(formatGdriveErrorRaw(serializeJson(jvalue)));
+    if (fields.haveShortcut != (type == GdriveItemType::shortcut))
+        throw SysError(formatGdriveErrorRaw(std::string(fields.rawJson)));
 
     std::string targetId;
-    if (shortcut)
+    if (fields.haveShortcut)
     {
-        std::optional<std::string> targetItemId = getPrimitiveFromJsonObject(*shortcut, "targetId");
-        if (!targetItemId || targetItemId->empty())
-            throw SysError(formatGdriveErrorRaw(serializeJson(jvalue)));
+        if (!fields.shortcutTargetId || fields.shortcutTargetId->empty())
+            throw SysError(formatGdriveErrorRaw(std::string(fields.rawJson)));
 
-        targetId = std::move(*targetItemId);
+        targetId = std::move(*fields.shortcutTargetId);
         //evaluate "targetMimeType" ? don't bother: "The MIME type of a shortcut can become stale"!
     }
 
-    return {utfTo<Zstring>(*itemName), fileSize, modTime, type, owner, std::move(targetId), std::move(parentIds)};
+    return {utfTo<Zstring>(*fields.name), fileSize, modTime, type, owner, std::move(targetId), std::move(fields.parentIds)};
 }
 
 
@@ -985,20 +1483,64 @@ GdriveItemDetails getItemDetails(const std::string& itemId, const GdriveAccess&
     gdriveHttpsRequest("/drive/v3/files/" + itemId + '?' + queryParams, {} /*extraHeaders*/, {} /*extraOptions*/,
     [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); },
     nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
+    GdriveItemFields fields;
     try
     {
-        const JsonValue jvalue = parseJson(response); //throw JsonParsingError
+        JsonPullParser jp(response);
+        fields = readItemFields(jp); //throw JsonParsingError
+        jp.finish();                 //
+    }
+    catch (JsonParsingError&) { throw SysError(formatGdriveErrorRaw(response)); }
 
-        //careful: do NOT return details about trashed items! they don't exist as far as FFS is concerned!!!
-        const std::optional<std::string> trashed = getPrimitiveFromJsonObject(jvalue, "trashed");
-        if (!trashed)
-            throw SysError(formatGdriveErrorRaw(response));
-        else if (*trashed == "true")
-            throw SysError(L"Item has been trashed.");
+    //careful: do NOT return details about trashed items! they don't exist as far as FFS is concerned!!!
+    if (!fields.trashed)
+        throw SysError(formatGdriveErrorRaw(response));
+    else if (*fields.trashed == "true")
+        throw SysError(L"Item has been trashed.");
+
+    return extractItemDetails(std::move(fields)); //throw SysError
+}
 
-        return extractItemDetails(jvalue); //throw SysError
+
+//checksums calculated by Google: not available for Google Docs and other items without binary content
+AFS::FileDigest gdriveGetFileDigest(const std::string& fileId, const GdriveAccess& access) //throw SysError
+{
+    //https://developers.google.com/drive/api/v3/reference/files#resource
+    const std::string& queryParams = xWwwFormUrlEncode(
+    {
+        {"fields", "md5Checksum,sha256Checksum"},
+        {"supportsAllDrives", "true"},
+    });
+    std::string response;
+    gdriveHttpsRequest("/drive/v3/files/" + fileId + '?' + queryParams, {} /*extraHeaders*/, {} /*extraOptions*/,
+    [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); },
+    nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
+
+    std::string md5Hex;
+    std::string sha256Hex;
+    try
+    {
+        JsonPullParser jp(response);
+        jp.beginObject(); //throw JsonParsingError
+        while (const std::optional<std::string_view> name = jp.nextMember()) //throw JsonParsingError
+            if      (*name == "md5Checksum")    md5Hex    = jp.readPrimitive(); //throw JsonParsingError
+            else if (*name == "sha256Checksum") sha256Hex = jp.readPrimitive(); //
+            else
+                jp.skipValue(); //throw JsonParsingError
+        jp.finish(); //throw JsonParsingError
     }
     catch (JsonParsingError&) { throw SysError(formatGdriveErrorRaw(response)); }
+
+    auto unhexifyDigest = [](const std::string& hex, size_t digestSize) -> std::string
+    {
+        if (hex.size() != 2 * digestSize || !std::all_of(hex.begin(), hex.end(), [](char c) { return isHexDigit(c); }))
+            return {}; //not available or unexpected format: fall back to content comparison
+        std::string digest;
+        for (size_t i = 0; i < hex.size(); i += 2)
+            digest += unhexify(hex[i], hex[i + 1]);
+        return digest;
+    };
+    return {unhexifyDigest(md5Hex, 16), unhexifyDigest(sha256Hex, 32)};
 }
 
 
@@ -1007,10 +1549,24 @@ struct GdriveItem
     std::string itemId;
     GdriveItemDetails details;
 };
-std::vector<GdriveItem> readFolderContent(const std::string& folderId, const GdriveAccess& access) //throw SysError
+//list several folders with one query: "'a' in parents or 'b' in parents ..." => results are split by parent ID (same order as folderIds)
+std::vector<std::vector<GdriveItem>> readFoldersContent(const std::vector<std::string>& folderIds, const GdriveAccess& access) //throw SysError
 {
+    assert(!folderIds.empty());
+    std::string parentsQuery;
+    for (const std::string& folderId : folderIds)
+    {
+        if (!parentsQuery.empty())
+            parentsQuery += " or ";
+        parentsQuery += '\'' + folderId + "' in parents";
+    }
+
+    std::unordered_map<std::string_view, size_t> folderIdxs;
+    for (size_t i = 0; i < folderIds.size(); ++i)
+        folderIdxs.emplace(folderIds[i], i);
+
     //https://developers.google.com/drive/api/v3/reference/files/list
-    std::vector<GdriveItem> childItems;
+    std::vector<std::vector<GdriveItem>> childItems(folderIds.size());
     {
         std::optional<std::string> nextPageToken;
         do
@@ -1020,7 +1576,7 @@ std::vector<GdriveItem> readFolderContent(const std::string& folderId, const Gdr
                 {"corpora", "allDrives"}, //"The 'user' corpus includes all files in "My Drive" and "Shared with me" https://developers.google.com/drive/api/v3/reference/files/list
                 {"includeItemsFromAllDrives", "true"},
                 {"pageSize", "1000"}, //"[1, 1000] Default: 100"
-                {"q", "not trashed and '" + folderId + "' in parents"},
+                {"q", "not trashed and (" + parentsQuery + ')'},
                 {"spaces", "drive"},
                 {"supportsAllDrives", "true"},
                 {"fields", "nextPageToken,incompleteSearch,files(id,name,mimeType,ownedByMe,size,modifiedTime,parents,shortcutDetails(targetId))"}, //https://developers.google.com/drive/api/v3/reference/files
@@ -1033,26 +1589,56 @@ std::vector<GdriveItem> readFolderContent(const std::string& folderId, const Gdr
             [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); },
             nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
 
-            JsonValue jresponse;
-            try { jresponse = parseJson(response); }
-            catch (JsonParsingError&) {}
+            //pages of up to 1000 items: read straight into GdriveItem, no JsonValue tree
+            nextPageToken.reset();
+            std::optional<std::string> incompleteSearch;
+            std::vector<GdriveItemFields> files;
+            bool haveFiles = false;
+            try
+            {
+                JsonPullParser jp(response);
+                jp.beginObject(); //throw JsonParsingError
+                while (const std::optional<std::string_view> name = jp.nextMember()) //throw JsonParsingError
+                    if (*name == "nextPageToken")
+                        nextPageToken = jp.readPrimitive(); //throw JsonParsingError
+                    else if (*name == "incompleteSearch")
+                        incompleteSearch = jp.readPrimitive(); //throw JsonParsingError
+                    else if (*name == "files")
+                    {
+                        haveFiles = true;
+                        jp.beginArray(); //throw JsonParsingError
+                        while (jp.nextElement()) //throw JsonParsingError
+                            files.push_back(readItemFields(jp)); //throw JsonParsingError
+                    }
+                    else
+                        jp.skipValue(); //throw JsonParsingError
+                jp.finish(); //throw JsonParsingError
+            }
+            catch (JsonParsingError&) { throw SysError(formatGdriveErrorRaw(response)); }
 
-            /**/                             nextPageToken    = getPrimitiveFromJsonObject(jresponse, "nextPageToken");
-            const std::optional<std::string> incompleteSearch = getPrimitiveFromJsonObject(jresponse, "incompleteSearch");
-            const JsonValue*                 files            = getChildFromJsonObject    (jresponse, "files");
-            if (!incompleteSearch || *incompleteSearch != "false" || !files || files->type != JsonValue::Type::array)
+            if (!incompleteSearch || *incompleteSearch != "false" || !haveFiles)
                 throw SysError(formatGdriveErrorRaw(response));
 
-            for (const JsonValue& childVal : files->arrayVal)
+            for (GdriveItemFields& fields : files)
             {
-                std::optional<std::string> itemId = getPrimitiveFromJsonObject(childVal, "id");
-                if (!itemId || itemId->empty())
-                    throw SysError(formatGdriveErrorRaw(serializeJson(childVal)));
-
-                GdriveItemDetails itemDetails(extractItemDetails(childVal)); //throw SysError
-                assert(std::find(itemDetails.parentIds.begin(), itemDetails.parentIds.end(), folderId) != itemDetails.parentIds.end());
-
-                childItems.push_back({std::move(*itemId), std::move(itemDetails)});
+                if (!fields.id || fields.id->empty())
+                    throw SysError(formatGdriveErrorRaw(std::string(fields.rawJson)));
+
+                std::string itemId = std::move(*fields.id);
+                GdriveItemDetails itemDetails(extractItemDetails(std::move(fields))); //throw SysError
+
+                std::vector<size_t> parentIdxs; //item may be in more than one of the listed folders
+                for (const std::string& parentId : itemDetails.parentIds)
+                    if (auto it = folderIdxs.find(parentId);
+                        it != folderIdxs.end() && std::find(parentIdxs.begin(), parentIdxs.end(), it->second) == parentIdxs.end())
+                        parentIdxs.push_back(it->second);
+                assert(!parentIdxs.empty());
+
+                for (size_t i = 0; i < parentIdxs.size(); ++i)
+                    if (i + 1 < parentIdxs.size())
+                        childItems[parentIdxs[i]].push_back({itemId, itemDetails});
+                    else
+                        childItems[parentIdxs[i]].push_back({std::move(itemId), std::move(itemDetails)});
             }
         }
         while (nextPageToken);
@@ -1061,6 +1647,12 @@ std::vector<GdriveItem> readFolderContent(const std::string& folderId, const Gdr
 }
 
 
+std::vector<GdriveItem> readFolderContent(const std::string& folderId, const GdriveAccess& access) //throw SysError
+{
+    return std::move(readFoldersContent({folderId}, access)[0]); //throw SysError
+}
+
+
 struct FileChange
 {
     std::string itemId;
@@ -1104,70 +1696,114 @@ ChangesDelta getChangesDelta(const std::string& sharedDriveId /*empty for "My Dr
         [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); },
         nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
 
-        JsonValue jresponse;
-        try { jresponse = parseJson(response); }
-        catch (JsonParsingError&) {}
+        struct ChangeFields
+        {
+            std::optional<std::string> kind;
+            std::optional<std::string> changeType;
+            std::optional<std::string> removed;
+            std::optional<std::string> fileId;
+            std::optional<GdriveItemFields> file;
+            std::optional<std::string> driveId;
+            bool haveDrive = false;
+            std::optional<std::string> driveName;
+            std::string_view rawJson; //for error messages
+        };
+        nextPageToken.reset();
+        std::optional<std::string> newStartPageToken;
+        std::optional<std::string> listKind;
+        std::vector<ChangeFields> changes;
+        bool haveChanges = false;
+        try
+        {
+            JsonPullParser jp(response);
+            jp.beginObject(); //throw JsonParsingError
+            while (const std::optional<std::string_view> name = jp.nextMember()) //throw JsonParsingError
+                //*INDENT-OFF*
+                if      (*name == "nextPageToken")     nextPageToken     = jp.readPrimitive(); //throw JsonParsingError
+                else if (*name == "newStartPageToken") newStartPageToken = jp.readPrimitive(); //
+                else if (*name == "kind")              listKind          = jp.readPrimitive(); //
+                //*INDENT-ON*
+                else if (*name == "changes")
+                {
+                    haveChanges = true;
+                    jp.beginArray(); //throw JsonParsingError
+                    while (jp.nextElement()) //throw JsonParsingError
+                    {
+                        ChangeFields& change = changes.emplace_back();
+                        const size_t posFirst = jp.getPos();
+
+                        jp.beginObject(); //throw JsonParsingError
+                        while (const std::optional<std::string_view> nameSub = jp.nextMember()) //throw JsonParsingError
+                            //*INDENT-OFF*
+                            if      (*nameSub == "kind")       change.kind       = jp.readPrimitive(); //throw JsonParsingError
+                            else if (*nameSub == "changeType") change.changeType = jp.readPrimitive(); //
+                            else if (*nameSub == "removed")    change.removed    = jp.readPrimitive(); //
+                            else if (*nameSub == "fileId")     change.fileId     = jp.readPrimitive(); //
+                            else if (*nameSub == "driveId")    change.driveId    = jp.readPrimitive(); //
+                            else if (*nameSub == "file")       change.file       = readItemFields(jp); //
+                            //*INDENT-ON*
+                            else if (*nameSub == "drive")
+                            {
+                                change.haveDrive = true;
+                                jp.beginObject(); //throw JsonParsingError
+                                while (const std::optional<std::string_view> nameDrive = jp.nextMember()) //throw JsonParsingError
+                                    if (*nameDrive == "name")
+                                        change.driveName = jp.readPrimitive(); //throw JsonParsingError
+                                    else
+                                        jp.skipValue(); //throw JsonParsingError
+                            }
+                            else
+                                jp.skipValue(); //throw JsonParsingError
 
-        /**/                             nextPageToken     = getPrimitiveFromJsonObject(jresponse, "nextPageToken");
-        const std::optional<std::string> newStartPageToken = getPrimitiveFromJsonObject(jresponse, "newStartPageToken");
-        const std::optional<std::string> listKind          = getPrimitiveFromJsonObject(jresponse, "kind");
-        const JsonValue*                 changes           = getChildFromJsonObject    (jresponse, "changes");
+                        change.rawJson = jp.getRawSince(posFirst);
+                    }
+                }
+                else
+                    jp.skipValue(); //throw JsonParsingError
+            jp.finish(); //throw JsonParsingError
+        }
+        catch (JsonParsingError&) { throw SysError(formatGdriveErrorRaw(response)); }
 
         if (!!nextPageToken == !!newStartPageToken || //there can be only one
             !listKind || *listKind != "drive#changeList" ||
-            !changes || changes->type != JsonValue::Type::array)
+            !haveChanges)
             throw SysError(formatGdriveErrorRaw(response));
 
-        for (const JsonValue& childVal : changes->arrayVal)
+        for (ChangeFields& changeFields : changes)
         {
-            const std::optional<std::string> kind       = getPrimitiveFromJsonObject(childVal, "kind");
-            const std::optional<std::string> changeType = getPrimitiveFromJsonObject(childVal, "changeType");
-            const std::optional<std::string> removed    = getPrimitiveFromJsonObject(childVal, "removed");
-            if (!kind || *kind != "drive#change" || !changeType || !removed)
-                throw SysError(formatGdriveErrorRaw(serializeJson(childVal)));
+            if (!changeFields.kind || *changeFields.kind != "drive#change" || !changeFields.changeType || !changeFields.removed)
+                throw SysError(formatGdriveErrorRaw(std::string(changeFields.rawJson)));
 
-            if (*changeType == "file")
+            if (*changeFields.changeType == "file")
             {
-                std::optional<std::string> fileId = getPrimitiveFromJsonObject(childVal, "fileId");
-                if (!fileId || fileId->empty())
-                    throw SysError(formatGdriveErrorRaw(serializeJson(childVal)));
+                if (!changeFields.fileId || changeFields.fileId->empty())
+                    throw SysError(formatGdriveErrorRaw(std::string(changeFields.rawJson)));
 
                 FileChange change;
-                change.itemId = std::move(*fileId);
-                if (*removed != "true")
+                change.itemId = std::move(*changeFields.fileId);
+                if (*changeFields.removed != "true")
                 {
-                    const JsonValue* file = getChildFromJsonObject(childVal, "file");
-                    if (!file)
-                        throw SysError(formatGdriveErrorRaw(serializeJson(childVal)));
+                    if (!changeFields.file || !changeFields.file->trashed)
+                        throw SysError(formatGdriveErrorRaw(std::string(changeFields.rawJson)));
 
-                    const std::optional<std::string> trashed = getPrimitiveFromJsonObject(*file, "trashed");
-                    if (!trashed)
-                        throw SysError(formatGdriveErrorRaw(serializeJson(childVal)));
-
-                    if (*trashed != "true")
-                        change.details = extractItemDetails(*file); //throw SysError
+                    if (*changeFields.file->trashed != "true")
+                        change.details = extractItemDetails(std::move(*changeFields.file)); //throw SysError
                 }
                 delta.fileChanges.push_back(std::move(change));
             }
-            else if (*changeType == "drive")
+            else if (*changeFields.changeType == "drive")
             {
-                std::optional<std::string> driveId = getPrimitiveFromJsonObject(childVal, "driveId");
-                if (!driveId || driveId->empty())
-                    throw SysError(formatGdriveErrorRaw(serializeJson(childVal)));
+                if (!changeFields.driveId || changeFields.driveId->empty())
+                    throw SysError(formatGdriveErrorRaw(std::string(changeFields.rawJson)));
 
                 DriveChange change;
-                change.driveId = std::move(*driveId);
-                if (*removed != "true")
+                change.driveId = std::move(*changeFields.driveId);
+                if (*changeFields.removed != "true")
                 {
-                    const JsonValue* drive = getChildFromJsonObject(childVal, "drive");
-                    if (!drive)
-                        throw SysError(formatGdriveErrorRaw(serializeJson(childVal)));
-
-                    const std::optional<std::string> name = getPrimitiveFromJsonObject(*drive, "name");
-                    if (!name || name->empty())
-                        throw SysError(formatGdriveErrorRaw(serializeJson(childVal)));
+                    if (!changeFields.haveDrive || !changeFields.driveName || changeFields.driveName->empty())
+                        throw SysError(formatGdriveErrorRaw(std::string(changeFields.rawJson)));
 
-                    change.driveName = utfTo<Zstring>(*name);
+                    change.driveName = utfTo<Zstring>(*changeFields.driveName);
                 }
                 delta.driveChanges.push_back(std::move(change));
             }
@@ -1219,12 +1855,9 @@ void gdriveDeleteItem(const std::string& itemId, const GdriveAccess& access) //t
     {
         {"supportsAllDrives", "true"},
     });
-    std::string response;
-    const HttpSession::Result httpResult = gdriveHttpsRequest("/drive/v3/files/" + itemId + '?' + queryParams,
-    {} /*extraHeaders*/, {{CURLOPT_CUSTOMREQUEST, "DELETE"}}, [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); },
-    nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
+    const auto& [statusCode, response] = gdriveMetaRequest({"DELETE", "/drive/v3/files/" + itemId + '?' + queryParams, {} /*jsonBody*/}, access); //throw SysError
 
-    if (response.empty() && httpResult.statusCode == 204)
+    if (response.empty() && statusCode == 204)
         return; //"If successful, this method returns an empty response body"
 
     throw SysError(formatGdriveErrorRaw(response));
@@ -1241,12 +1874,9 @@ void gdriveUnlinkParent(const std::string& itemId, const std::string& parentId,
         {"supportsAllDrives", "true"},
         {"fields", "id,parents"}, //for test if operation was successful
     });
-    std::string response;
-    const HttpSession::Result httpResult = gdriveHttpsRequest("/drive/v3/files/" + itemId + '?' + queryParams,
-    {"Content-Type: application/json; charset=UTF-8"}, {{CURLOPT_CUSTOMREQUEST, "PATCH"}, { CURLOPT_POSTFIELDS, "{}"}},
-    [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); }, nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
+    const auto& [statusCode, response] = gdriveMetaRequest({"PATCH", "/drive/v3/files/" + itemId + '?' + queryParams, "{}"}, access); //throw SysError
 
-    if (response.empty() && httpResult.statusCode == 204)
+    if (response.empty() && statusCode == 204)
         return; //removing last parent of item not owned by us returns "204 No Content" (instead of 200 + file body)
 
     JsonValue jresponse;
@@ -1278,10 +1908,7 @@ void gdriveMoveToTrash(const std::string& itemId, const GdriveAccess& access) //
     });
     const std::string postBuf = R"({ "trashed": true })";
 
-    std::string response;
-    gdriveHttpsRequest("/drive/v3/files/" + itemId + '?' + queryParams,
-    {"Content-Type: application/json; charset=UTF-8"}, {{CURLOPT_CUSTOMREQUEST, "PATCH"}, {CURLOPT_POSTFIELDS, postBuf.c_str()}},
-    [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); }, nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
+    const std::string response = gdriveMetaRequest({"PATCH", "/drive/v3/files/" + itemId + '?' + queryParams, postBuf}, access).response; //throw SysError
 
     JsonValue jresponse;
     try { jresponse = parseJson(response); /*throw JsonParsingError*/ }
@@ -1308,10 +1935,7 @@ std::string /*folderId*/ gdriveCreateFolderPlain(const Zstring& folderName, cons
     postParams.objectVal.emplace("parents", std::vector<JsonValue> {JsonValue(parentId)});
     const std::string& postBuf = serializeJson(postParams, "" /*lineBreak*/, "" /*indent*/);
 
-    std::string response;
-    gdriveHttpsRequest("/drive/v3/files?" + queryParams,
-    {"Content-Type: application/json; charset=UTF-8"}, {{CURLOPT_POSTFIELDS, postBuf.c_str()}},
-    [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); }, nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
+    const std::string response = gdriveMetaRequest({"POST", "/drive/v3/files?" + queryParams, postBuf}, access).response; //throw SysError
 
     JsonValue jresponse;
     try { jresponse = parseJson(response); }
@@ -1345,10 +1969,7 @@ std::string /*shortcutId*/ gdriveCreateShortcutPlain(const Zstring& shortcutName
     postParams.objectVal.emplace("shortcutDetails", std::move(shortcutDetails));
     const std::string& postBuf = serializeJson(postParams, "" /*lineBreak*/, "" /*indent*/);
 
-    std::string response;
-    gdriveHttpsRequest("/drive/v3/files?" + queryParams, {"Content-Type: application/json; charset=UTF-8"},
-    {{CURLOPT_POSTFIELDS, postBuf.c_str()}}, [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); },
-    nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
+    const std::string response = gdriveMetaRequest({"POST", "/drive/v3/files?" + queryParams, postBuf}, access).response; //throw SysError
 
     JsonValue jresponse;
     try { jresponse = parseJson(response); }
@@ -1434,11 +2055,7 @@ void gdriveMoveAndRenameItem(const std::string& itemId, const std::string& paren
     postParams.objectVal.emplace("modifiedTime", modTimeRfc);
     const std::string& postBuf = serializeJson(postParams, "" /*lineBreak*/, "" /*indent*/);
 
-    std::string response;
-    gdriveHttpsRequest("/drive/v3/files/" + itemId + '?' + queryParams,
-    {"Content-Type: application/json; charset=UTF-8"}, {{CURLOPT_CUSTOMREQUEST, "PATCH"}, {CURLOPT_POSTFIELDS, postBuf.c_str()}},
-    [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); },
-    nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError
+    const std::string response = gdriveMetaRequest({"PATCH", "/drive/v3/files/" + itemId + '?' + queryParams, postBuf}, access).response; //throw SysError
 
     JsonValue jresponse;
     try { jresponse = parseJson(response); /*throw JsonParsingError*/ }
@@ -1491,7 +2108,7 @@ void setModTime(const std::string& itemId, time_t modTime, const GdriveAccess& a
 
 DEFINE_NEW_SYS_ERROR(SysErrorAbusiveFile)
 void gdriveDownloadFileImpl(const std::string& fileId, const std::function<void(const void* buffer, size_t bytesToWrite)>& writeBlock /*throw X*/, //throw SysError, SysErrorAbusiveFile, X
-                            bool acknowledgeAbuse, const GdriveAccess& access)
+                            const std::optional<std::pair<uint64_t, uint64_t>>& byteRange /*[first, last]*/, bool acknowledgeAbuse, const GdriveAccess& access)
 {
     //https://developers.google.com/drive/api/v3/manage-downloads
     //doesn't work for Google-specific file types (.gdoc, .gsheet, .gslides)
@@ -1506,10 +2123,14 @@ void gdriveDownloadFileImpl(const std::string& fileId, const std::function<void(
     if (acknowledgeAbuse) //apply on demand only! https://freefilesync.org/forum/viewtopic.php?t=7520")
         queryParams += '&' + xWwwFormUrlEncode({{"acknowledgeAbuse", "true"}});
 
+    std::vector<std::string> extraHeaders;
+    if (byteRange) //https://developers.google.com/drive/api/guides/manage-downloads#partial_download
+        extraHeaders.push_back("Range: bytes=" + numberTo<std::string>(byteRange->first) + '-' + numberTo<std::string>(byteRange->second));
+
     std::string responseHead; //save front part of the response in case we get an error
     bool headFlushed = false;
 
-    const HttpSession::Result httpResult = gdriveHttpsRequest("/drive/v3/files/" + fileId + '?' + queryParams, {} /*extraHeaders*/, {} /*extraOptions*/,
+    const HttpSession::Result httpResult = gdriveHttpsRequest("/drive/v3/files/" + fileId + '?' + queryParams, extraHeaders, {} /*extraOptions*/,
                                                               [&](std::span<const char> buf)
     {
         if (responseHead.size() < 10000) //don't access writeBlock() in case of error! (=> support acknowledgeAbuse retry handling)
@@ -1524,7 +2145,10 @@ void gdriveDownloadFileImpl(const std::string& fileId, const std::function<void(
 
             writeBlock(buf.data(), buf.size()); //throw X
         }
-    }, nullptr /*readRequest*/, nullptr /*receiveHeader*/, access); //throw SysError, X
+    }, nullptr /*readRequest*/, nullptr /*receiveHeader*/, access, HttpConnection::dedicated /*writeBlock() may block*/); //throw SysError, X
+
+    if (byteRange && httpResult.statusCode == 416) //"Range Not Satisfiable": range starts at/beyond end of file
+        return;
 
     if (httpResult.statusCode / 100 != 2)
     {
@@ -1541,21 +2165,24 @@ void gdriveDownloadFileImpl(const std::string& fileId, const std::function<void(
         throw SysError(formatGdriveErrorRaw(responseHead));
     }
 
+    if (byteRange && byteRange->first != 0 && httpResult.statusCode != 206) //"Partial Content"; server ignoring the range would return the file from the beginning
+        throw SysError(formatSystemError("gdriveDownloadFile", L"HTTP status " + numberTo<std::wstring>(httpResult.statusCode), L"Range request not supported."));
+
     if (!headFlushed)
         writeBlock(responseHead.c_str(), responseHead.size()); //throw X
 }
 
 
 void gdriveDownloadFile(const std::string& fileId, const std::function<void(const void* buffer, size_t bytesToWrite)>& writeBlock /*throw X*/, //throw SysError, X
-                        const GdriveAccess& access)
+                        const GdriveAccess& access, const std::optional<std::pair<uint64_t, uint64_t>>& byteRange = {} /*[first, last]*/)
 {
     try
     {
-        gdriveDownloadFileImpl(fileId, writeBlock /*throw X*/, false /*acknowledgeAbuse*/, access); //throw SysError, SysErrorAbusiveFile, X
+        gdriveDownloadFileImpl(fileId, writeBlock /*throw X*/, byteRange, false /*acknowledgeAbuse*/, access); //throw SysError, SysErrorAbusiveFile, X
     }
     catch (SysErrorAbusiveFile&)
     {
-        gdriveDownloadFileImpl(fileId, writeBlock /*throw X*/, true /*acknowledgeAbuse*/, access); //throw SysError, (SysErrorAbusiveFile), X
+        gdriveDownloadFileImpl(fileId, writeBlock /*throw X*/, byteRange, true /*acknowledgeAbuse*/, access); //throw SysError, (SysErrorAbusiveFile), X
     }
 }
 
@@ -1664,77 +2291,146 @@ TODO:
 #endif
 
 
-//file name already existing? => duplicate file created!
-//note: Google Drive upload is already transactional!
-std::string /*itemId*/ gdriveUploadFile(const Zstring& fileName, const std::string& parentId, std::optional<time_t> modTime, //throw SysError, X
-                                        const std::function<size_t(void* buffer, size_t bytesToRead)>& readBlock /*throw X*/, //returning 0 signals EOF: Posix read() semantics
-                                        const GdriveAccess& access)
+//https://developers.google.com/drive/api/v3/folder#inserting_a_file_in_a_folder
+//https://developers.google.com/drive/api/v3/manage-uploads#resumable
+std::string /*uploadUrlRelative*/ gdriveInitUploadSession(const Zstring& fileName, const std::string& parentId, std::optional<time_t> modTime, //throw SysError
+                                                           const GdriveAccess& access)
 {
-    //https://developers.google.com/drive/api/v3/folder#inserting_a_file_in_a_folder
-    //https://developers.google.com/drive/api/v3/manage-uploads#resumable
+    const std::string& queryParams = xWwwFormUrlEncode(
+    {
+        {"supportsAllDrives", "true"},
+        {"uploadType", "resumable"},
+    });
+    JsonValue postParams(JsonValue::Type::object);
+    postParams.objectVal.emplace("name", utfTo<std::string>(fileName));
+    postParams.objectVal.emplace("parents", std::vector<JsonValue> {JsonValue(parentId)});
+    if (modTime) //convert to RFC 3339 date-time: e.g. "2018-09-29T08:39:12.053Z"
+    {
+        const std::string& modTimeRfc = utfTo<std::string>(formatTime(Zstr("%Y-%m-%dT%H:%M:%S.000Z"), getUtcTime(*modTime))); //returns empty string on failure
+        if (modTimeRfc.empty())
+            throw SysError(L"Invalid modification time (time_t: " + numberTo<std::wstring>(*modTime) + L')');
 
-    //step 1: initiate resumable upload session
-    std::string uploadUrlRelative;
+        postParams.objectVal.emplace("modifiedTime", modTimeRfc);
+    }
+    const std::string& postBuf = serializeJson(postParams, "" /*lineBreak*/, "" /*indent*/);
+    //---------------------------------------------------
+
+    std::string uploadUrl;
+
+    auto onHeaderData = [&](const std::string_view& header)
     {
-        const std::string& queryParams = xWwwFormUrlEncode(
+        //"The callback will be called once for each header and only complete header lines are passed on to the callback" (including \r\n at the end)
+        if (startsWithAsciiNoCase(header, "Location:"))
         {
-            {"supportsAllDrives", "true"},
-            {"uploadType", "resumable"},
-        });
-        JsonValue postParams(JsonValue::Type::object);
-        postParams.objectVal.emplace("name", utfTo<std::string>(fileName));
-        postParams.objectVal.emplace("parents", std::vector<JsonValue> {JsonValue(parentId)});
-        if (modTime) //convert to RFC 3339 date-time: e.g. "2018-09-29T08:39:12.053Z"
-        {
-            const std::string& modTimeRfc = utfTo<std::string>(formatTime(Zstr("%Y-%m-%dT%H:%M:%S.000Z"), getUtcTime(*modTime))); //returns empty string on failure
-            if (modTimeRfc.empty())
-                throw SysError(L"Invalid modification time (time_t: " + numberTo<std::wstring>(*modTime) + L')');
-
-            postParams.objectVal.emplace("modifiedTime", modTimeRfc);
+            uploadUrl = header;
+            uploadUrl = afterFirst(uploadUrl, ':', IfNotFoundReturn::none);
+            trim(uploadUrl);
         }
-        const std::string& postBuf = serializeJson(postParams, "" /*lineBreak*/, "" /*indent*/);
-        //---------------------------------------------------
+    };
 
-        std::string uploadUrl;
+    std::string response;
+    const HttpSession::Result httpResult = gdriveHttpsRequest("/upload/drive/v3/files?" + queryParams,
+    {"Content-Type: application/json; charset=UTF-8"}, {{CURLOPT_POSTFIELDS, postBuf.c_str()}},
+    [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); },
+    nullptr /*readRequest*/, onHeaderData, access); //throw SysError
 
-        auto onHeaderData = [&](const std::string_view& header)
-        {
-            //"The callback will be called once for each header and only complete header lines are passed on to the callback" (including \r\n at the end)
-            if (startsWithAsciiNoCase(header, "Location:"))
-            {
-                uploadUrl = header;
-                uploadUrl = afterFirst(uploadUrl, ':', IfNotFoundReturn::none);
-                trim(uploadUrl);
-            }
-        };
+    if (httpResult.statusCode != 200)
+        throw SysError(formatGdriveErrorRaw(response));
 
-        std::string response;
-        const HttpSession::Result httpResult = gdriveHttpsRequest("/upload/drive/v3/files?" + queryParams,
-        {"Content-Type: application/json; charset=UTF-8"}, {{CURLOPT_POSTFIELDS, postBuf.c_str()}},
-        [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); },
-        nullptr /*readRequest*/, onHeaderData, access); //throw SysError
+    if (!startsWith(uploadUrl, "https://www.googleapis.com/"))
+        throw SysError(L"Invalid upload URL: " + utfTo<std::wstring>(uploadUrl)); //user should never see this
 
-        if (httpResult.statusCode != 200)
-            throw SysError(formatGdriveErrorRaw(response));
+    return afterFirst(uploadUrl, "googleapis.com", IfNotFoundReturn::none);
+}
 
-        if (!startsWith(uploadUrl, "https://www.googleapis.com/"))
-            throw SysError(L"Invalid upload URL: " + utfTo<std::wstring>(uploadUrl)); //user should never see this
 
-        uploadUrlRelative = afterFirst(uploadUrl, "googleapis.com", IfNotFoundReturn::none);
-    }
+/*  gzip upload costs CPU per byte: zlib limits the upload thread's throughput on fast connections
+    => don't bother for data that doesn't compress: media, archives, encrypted files
+    - extension hint: formats that are compressed internally, but may start with a low-entropy header (EXIF, ZIP directory, MP4 atoms)
+    - byte entropy of the first block: compressed/encrypted data is close to 8 bits/byte                                  */
+const size_t GDRIVE_COMPRESSION_SAMPLE_SIZE = 64 * 1024;
+const int    GDRIVE_UPLOAD_GZIP_LEVEL = 1; //fastest: upload bandwidth, not size is the goal
+
+bool gdriveShouldCompress(const Zstring& fileName, std::span<const char> sample)
+{
+    static const char* const compressedExtensions[] =
+    {
+        "jpg", "jpeg", "png", "gif", "webp", "heic", "avif", "mp3", "m4a", "aac", "ogg", "opus", "flac", "mp4", "m4v", "mov", "mkv", "avi", "webm",
+        "zip", "7z", "rar", "gz", "tgz", "bz2", "xz", "zst", "lz4", "cab", "jar", "apk", "docx", "xlsx", "pptx", "odt", "ods", "epub", "pdf", "gpg", "ffs_db",
+    };
+    const Zstring ext = getFileExtension(fileName);
+    for (const char* compressedExt : compressedExtensions)
+        if (equalAsciiNoCase(ext, compressedExt))
+            return false;
+
+    if (sample.empty())
+        return true;
+
+    size_t histogram[256] = {};
+    for (const char c : sample)
+        ++histogram[static_cast<unsigned char>(c)];
+
+    double entropy = 0; //bits per byte
+    for (const size_t count : histogram)
+        if (count > 0)
+        {
+            const double p = static_cast<double>(count) / sample.size();
+            entropy -= p * std::log2(p);
+        }
+    return entropy < 7.5; //random data: > 7.99 for a 64 KiB sample; text: ~4.5; executables: ~6
+}
+
+
+//file name already existing? => duplicate file created!
+//note: Google Drive upload is already transactional!
+std::string /*itemId*/ gdriveUploadFile(const Zstring& fileName, const std::string& parentId, std::optional<time_t> modTime, //throw SysError, X
+                                        const std::function<size_t(void* buffer, size_t bytesToRead)>& readBlock /*throw X*/, //returning 0 signals EOF: Posix read() semantics
+                                        const GdriveAccess& access)
+{
+    //step 1: initiate resumable upload session
+    const std::string uploadUrlRelative = gdriveInitUploadSession(fileName, parentId, modTime, access); //throw SysError
     //---------------------------------------------------
     //step 2: upload file content
 
-    //not officially documented, but Google Drive supports compressed file upload when "Content-Encoding: gzip" is set! :)))
-    InputStreamAsGzip gzipStream(readBlock); //throw SysError
+    //sample first block: decide compression before sending the first byte
+    std::string sample(GDRIVE_COMPRESSION_SAMPLE_SIZE, '\0');
+    size_t samplePos = 0;
+    sample.resize(readBlock(sample.data(), sample.size())); //throw X; returns "bytesToRead" bytes unless end of stream!
+    const bool sampleEof = sample.size() < GDRIVE_COMPRESSION_SAMPLE_SIZE;
 
-    auto readBlockAsGzip = [&](std::span<char> buf) { return gzipStream.read(buf.data(), buf.size()); }; //throw SysError, X
+    auto readBlockWithSample = [&](void* buffer, size_t bytesToRead) -> size_t //throw X
+    {
+        if (samplePos < sample.size())
+        {
+            const size_t junkSize = std::min(bytesToRead, sample.size() - samplePos);
+            std::memcpy(buffer, sample.data() + samplePos, junkSize);
+            samplePos += junkSize;
+            if (junkSize == bytesToRead || sampleEof)
+                return junkSize;
+            return junkSize + readBlock(static_cast<char*>(buffer) + junkSize, bytesToRead - junkSize); //throw X
+        }
+        return sampleEof ? 0 : readBlock(buffer, bytesToRead); //throw X
+    };
     //returns "bytesToRead" bytes unless end of stream! => fits into "0 signals EOF: Posix read() semantics"
 
     std::string response; //don't need "Authorization: Bearer":
-    googleHttpsRequest(GOOGLE_REST_API_SERVER, uploadUrlRelative, { "Content-Encoding: gzip" }, {} /*extraOptions*/,
-    [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); }, readBlockAsGzip,
-    nullptr /*receiveHeader*/, access.timeoutSec); //throw SysError, X
+    if (gdriveShouldCompress(fileName, sample))
+    {
+        //not officially documented, but Google Drive supports compressed file upload when "Content-Encoding: gzip" is set! :)))
+        InputStreamAsGzip gzipStream(readBlockWithSample, GDRIVE_UPLOAD_GZIP_LEVEL); //throw SysError
+
+        auto readBlockAsGzip = [&](std::span<char> buf) { return gzipStream.read(buf.data(), buf.size()); }; //throw SysError, X
+        //returns "bytesToRead" bytes unless end of stream! => fits into "0 signals EOF: Posix read() semantics"
+
+        googleHttpsRequest(GOOGLE_REST_API_SERVER, uploadUrlRelative, { "Content-Encoding: gzip" }, {} /*extraOptions*/,
+        [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); }, readBlockAsGzip,
+        nullptr /*receiveHeader*/, access.timeoutSec); //throw SysError, X
+    }
+    else
+        googleHttpsRequest(GOOGLE_REST_API_SERVER, uploadUrlRelative, {} /*extraHeaders*/, {} /*extraOptions*/,
+        [&](std::span<const char> buf) { response.append(buf.data(), buf.size()); },
+        [&](std::span<char> buf) { return readBlockWithSample(buf.data(), buf.size()); }, //throw X
+        nullptr /*receiveHeader*/, access.timeoutSec); //throw SysError, X
 
     JsonValue jresponse;
     try { jresponse = parseJson(response); }
@@ -1748,14 +2444,147 @@ std::string /*itemId*/ gdriveUploadFile(const Zstring& fileName, const std::stri
 }
 
 
+/*  large files: upload in chunks, so that a transient error doesn't throw away all progress
+    - keep upload session across retries; ask server for committed offset, then resend only the rest of the current chunk
+    - no gzip: a compressed stream can't be resumed in the middle
+    - chunk size adapts to bandwidth: roughly GDRIVE_UPLOAD_CHUNK_TARGET_TIME per request  */
+std::string /*itemId*/ gdriveUploadLargeFile(const Zstring& fileName, const std::string& parentId, std::optional<time_t> modTime, //throw SysError, X
+                                             const std::function<size_t(void* buffer, size_t bytesToRead)>& readBlock /*throw X*/, //returning 0 signals EOF: Posix read() semantics
+                                             const GdriveAccess& access)
+{
+    const std::string uploadUrlRelative = gdriveInitUploadSession(fileName, parentId, modTime, access); //throw SysError
+
+    std::string chunkBuf;   //bytes [committedPos, committedPos + chunkBuf.size())
+    uint64_t committedPos = 0; //confirmed by server
+    bool eof = false;
+    size_t chunkSize = GDRIVE_UPLOAD_CHUNK_SIZE_MIN;
+    int errorCount = 0;
+
+    struct PutResult
+    {
+        int statusCode = 0;
+        std::optional<uint64_t> committedEnd; //"Range: bytes=0-42" => 43
+        std::string response;
+    };
+    //PUT [committedPos, committedPos + byteCount) of chunkBuf; byteCount == 0: query upload status
+    auto putRange = [&](size_t byteCount) //throw SysError
+    {
+        const std::string totalSize = eof ? numberTo<std::string>(committedPos + chunkBuf.size()) : "*";
+        const std::string contentRange = "Content-Range: bytes " + (byteCount == 0 ? std::string("*") :
+                                                                    numberTo<std::string>(committedPos) + '-' + numberTo<std::string>(committedPos + byteCount - 1)) + '/' + totalSize;
+        PutResult result;
+
+        auto onHeaderData = [&](const std::string_view& header)
+        {
+            if (startsWithAsciiNoCase(header, "Range:"))
+                if (const std::string_view range = afterLast(header, '-', IfNotFoundReturn::none); //bytes=0-42
+                    !range.empty())
+                    result.committedEnd = stringTo<uint64_t>(trimCpy(std::string(range))) + 1;
+        };
+
+        size_t bytesSent = 0;
+        auto readChunk = [&](std::span<char> buf)
+        {
+            const size_t junkSize = std::min(buf.size(), byteCount - bytesSent);
+            std::memcpy(buf.data(), chunkBuf.data() + bytesSent, junkSize);
+            bytesSent += junkSize;
+            return junkSize;
+        };
+
+        //don't need "Authorization: Bearer":
+        result.statusCode = googleHttpsRequest(GOOGLE_REST_API_SERVER, uploadUrlRelative, {contentRange},
+        {{CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(byteCount)}}, //=> "Content-Length" instead of chunked transfer encoding
+        [&](std::span<const char> buf) { result.response.append(buf.data(), buf.size()); }, readChunk,
+        onHeaderData, access.timeoutSec).statusCode; //throw SysError
+        return result;
+    };
+
+    for (;;)
+    {
+        if (!eof && chunkBuf.size() < chunkSize)
+        {
+            const size_t oldSize = chunkBuf.size();
+            chunkBuf.resize(chunkSize);
+            const size_t bytesRead = readBlock(chunkBuf.data() + oldSize, chunkSize - oldSize); //throw X; return "bytesToRead" bytes unless end of stream!
+            chunkBuf.resize(oldSize + bytesRead);
+            eof = bytesRead < chunkSize - oldSize;
+        }
+        //-----------------------------------------------------------
+        const auto startTime = std::chrono::steady_clock::now();
+
+        PutResult result;
+        std::optional<SysError> transientError;
+        try
+        {
+            result = putRange(chunkBuf.size()); //throw SysError
+
+            if (result.statusCode >= 500) //e.g. 503 Service Unavailable
+                transientError = SysError(formatGdriveErrorRaw(result.response));
+        }
+        catch (const SysError& e) { transientError = e; } //e.g. network errors, time out
+
+        if (transientError)
+        {
+            if (++errorCount > GDRIVE_UPLOAD_CHUNK_RETRIES_MAX)
+                throw* transientError;
+
+            interruptibleSleep(std::chrono::seconds(1 << errorCount)); //throw ThreadStopRequest; exponential backoff as recommended by Google
+            try
+            {
+                result = putRange(0); //throw SysError
+            }
+            catch (SysError&) { continue; } //retry same range
+        }
+
+        if (result.statusCode == 200 || result.statusCode == 201) //upload complete
+        {
+            JsonValue jresponse;
+            try { jresponse = parseJson(result.response); }
+            catch (JsonParsingError&) {}
+
+            const std::optional<std::string> itemId = getPrimitiveFromJsonObject(jresponse, "id");
+            if (!itemId)
+                throw SysError(formatGdriveErrorRaw(result.response));
+            return *itemId;
+        }
+
+        if (result.statusCode != 308) //"Resume Incomplete"; 4XX: e.g. 404 upload session expired => restart from scratch (not our job)
+        {
+            if (result.statusCode >= 500)
+                continue; //status query failed: retry same range
+            throw SysError(formatGdriveErrorRaw(result.response));
+        }
+
+        const uint64_t committedEnd = result.committedEnd ? *result.committedEnd : 0; //no "Range" header: nothing committed yet
+        if (committedEnd < committedPos || committedEnd > committedPos + chunkBuf.size())
+            throw SysError(L"Unexpected upload range: " + numberTo<std::wstring>(committedEnd) + L" (expected: " +
+                           numberTo<std::wstring>(committedPos) + L'-' + numberTo<std::wstring>(committedPos + chunkBuf.size()) + L')');
+
+        if (committedEnd > committedPos)
+            errorCount = 0; //made progress
+
+        if (!transientError && committedEnd == committedPos + chunkBuf.size()) //full chunk => tune chunk size
+        {
+            const auto chunkTime = std::chrono::steady_clock::now() - startTime;
+            if (chunkTime < GDRIVE_UPLOAD_CHUNK_TARGET_TIME / 2 && chunkSize < GDRIVE_UPLOAD_CHUNK_SIZE_MAX)
+                chunkSize *= 2;
+            else if (chunkTime > GDRIVE_UPLOAD_CHUNK_TARGET_TIME * 2 && chunkSize > GDRIVE_UPLOAD_CHUNK_SIZE_MIN)
+                chunkSize /= 2;
+        }
+
+        chunkBuf.erase(0, static_cast<size_t>(committedEnd - committedPos));
+        committedPos = committedEnd;
+    }
+}
+
 class GdriveAccessBuffer //per-user-session & drive! => serialize access (perf: amortized fully buffered!)
 {
 public:
     //GdriveDrivesBuffer constructor calls GdriveAccessBuffer::getAccessToken()
     explicit GdriveAccessBuffer(const GdriveAccessInfo& accessInfo) :
-        accessInfo_(accessInfo) {}
+        accessInfo_(accessInfo), modified_(true) {}
 
-    GdriveAccessBuffer(MemoryStreamIn<std::string>& stream) //throw SysError
+    GdriveAccessBuffer(InputStreamFromZlib& stream) //throw SysError, FileError
     {
         accessInfo_.accessToken.validUntil = readNumber<int64_t>(stream);                             //
         accessInfo_.accessToken.value      = readContainer<std::string>(stream);                      //
@@ -1764,7 +2593,7 @@ public:
         accessInfo_.userInfo.email         =                     readContainer<std::string>(stream);  //
     }
 
-    void serialize(MemoryStreamOut<std::string>& stream) const
+    void serialize(OutputStreamAsZlib& stream) const //throw SysError, FileError
     {
         writeNumber<int64_t>(stream, accessInfo_.accessToken.validUntil);
         static_assert(sizeof(accessInfo_.accessToken.validUntil) <= sizeof(int64_t)); //ensure cross-platform compatibility!
@@ -1791,6 +2620,7 @@ public:
                 throw SysError(_("Please set up a shorter time out for Google Drive.") + L" [" + _P("1 sec", "%x sec", timeoutSec) + L']');
 
             accessInfo_.accessToken = std::move(token);
+            modified_ = true;
         }
 
         return {accessInfo_.accessToken.value, timeoutSec};
@@ -1803,8 +2633,13 @@ public:
         if (!equalAsciiNoCase(accessInfo.userInfo.email, accessInfo_.userInfo.email))
             throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
         accessInfo_ = accessInfo;
+        modified_ = true;
     }
 
+    //changed since loaded from/saved to DB?
+    bool isModified() const { return modified_; }
+    void resetModified() { modified_ = false; }
+
 private:
     GdriveAccessBuffer           (const GdriveAccessBuffer&) = delete;
     GdriveAccessBuffer& operator=(const GdriveAccessBuffer&) = delete;
@@ -1821,6 +2656,7 @@ private:
 
     GdriveAccessInfo accessInfo_;
     std::weak_ptr<int> timeoutSec_;
+    bool modified_ = false;
 };
 
 
@@ -1837,9 +2673,10 @@ public:
         lastSyncToken_(getChangesCurrentToken(sharedDriveName.empty() ? std::string() : driveId, accessBuf.getAccessToken())), //throw SysError
         driveId_(driveId),
         sharedDriveName_(sharedDriveName),
-        accessBuf_(accessBuf) { assert(!driveId.empty() && sharedDriveName != Zstr("My Drive")); }
+        accessBuf_(accessBuf),
+        modified_(true) { assert(!driveId.empty() && sharedDriveName != Zstr("My Drive")); }
 
-    GdriveFileState(MemoryStreamIn<std::string>& stream, GdriveAccessBuffer& accessBuf) : //throw SysError
+    GdriveFileState(InputStreamFromZlib& stream, int dbVersion, GdriveAccessBuffer& accessBuf) : //throw SysError, FileError
         accessBuf_(accessBuf)
     {
         lastSyncToken_   = readContainer<std::string>(stream); //
@@ -1851,7 +2688,10 @@ public:
             const std::string folderId = readContainer<std::string>(stream); //SysErrorUnexpectedEos
             if (folderId.empty())
                 break;
-            folderContents_[folderId].isKnownFolder = true;
+            FolderContent& content = folderContents_[folderId];
+            content.isKnownFolder = true;
+            //TODO: remove migration code at some time! 2026-10-14
+            content.lastAccess = dbVersion <= 5 ? std::time(nullptr) : readNumber<int64_t>(stream); //SysErrorUnexpectedEos
         }
 
         for (;;)
@@ -1874,19 +2714,45 @@ public:
 
             updateItemState(itemId, &details);
         }
+
+        if (dbVersion >= 8) //TODO: remove migration code at some time! 2026-10-14
+        {
+            size_t checkpointCount = readNumber<uint32_t>(stream); //SysErrorUnexpectedEos
+            while (checkpointCount-- != 0)
+            {
+                const std::string checkpointId = readContainer<std::string>(stream); //SysErrorUnexpectedEos
+                ChangeLog& changeLog = checkpoints_[checkpointId].committed.emplace();
+
+                changeLog.complete = readNumber<int8_t>(stream) != 0; //SysErrorUnexpectedEos
+                size_t changeCount = readNumber<uint32_t>(stream);    //
+                while (changeCount-- != 0)
+                {
+                    std::string parentId = readContainer<std::string>(stream);             //SysErrorUnexpectedEos
+                    Zstring itemName = utfTo<Zstring>(readContainer<std::string>(stream)); //
+                    changeLog.changes.emplace(std::move(parentId), std::move(itemName));
+                }
+            }
+        }
     }
 
-    void serialize(MemoryStreamOut<std::string>& stream) const
+    void serialize(OutputStreamAsZlib& stream) const //throw SysError, FileError
     {
         writeContainer(stream, lastSyncToken_);
         writeContainer(stream, driveId_);
         writeContainer(stream, utfTo<std::string>(sharedDriveName_));
 
+        //scope DB to folders actually used by recent syncs: cold folders are evicted (and listed again on next access)
+        const time_t expirationTime = std::time(nullptr) - GDRIVE_FOLDER_STATE_EXPIRATION_DAYS * 24 * 3600;
+        auto isPersistedFolder = [&](const FolderContent& content) { return content.isKnownFolder && content.lastAccess > expirationTime; };
+
         for (const auto& [folderId, content] : folderContents_)
             if (folderId.empty())
                 throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
-            else if (content.isKnownFolder)
+            else if (isPersistedFolder(content))
+            {
                 writeContainer(stream, folderId);
+                writeNumber<int64_t>(stream, content.lastAccess);
+            }
         writeContainer(stream, std::string()); //sentinel
 
         auto serializeItem = [&](const std::string& itemId, const GdriveItemDetails& details)
@@ -1907,7 +2773,7 @@ public:
 
         //serialize + clean up: only save items in "known folders" + items referenced by shortcuts
         for (const auto& [folderId, content] : folderContents_)
-            if (content.isKnownFolder)
+            if (isPersistedFolder(content))
                 for (const auto& itItem : content.childItems)
                 {
                     const auto& [itemId, details] = *itItem;
@@ -1926,13 +2792,45 @@ public:
                     }
                 }
         writeContainer(stream, std::string()); //sentinel
+
+        //changes within evicted folders won't be seen after reload
+        const bool foldersEvicted = std::any_of(folderContents_.begin(), folderContents_.end(), [&](const auto& item)
+        { return item.second.isKnownFolder && !isPersistedFolder(item.second); });
+
+        writeNumber(stream, static_cast<uint32_t>(std::count_if(checkpoints_.begin(), checkpoints_.end(), [](const auto& item) { return item.second.committed.has_value(); })));
+        for (const auto& [checkpointId, checkpoint] : checkpoints_)
+            if (checkpoint.committed)
+            {
+                const bool complete = checkpoint.committed->complete && !foldersEvicted;
+                writeContainer(stream, checkpointId);
+                writeNumber<int8_t>(stream, complete);
+
+                writeNumber(stream, static_cast<uint32_t>(complete ? checkpoint.committed->changes.size() : 0));
+                if (complete)
+                    for (const auto& [parentId, itemName] : checkpoint.committed->changes)
+                    {
+                        writeContainer(stream, parentId);
+                        writeContainer(stream, utfTo<std::string>(itemName));
+                    }
+            }
     }
 
     std::string getDriveId() const { return driveId_; }
 
     Zstring getSharedDriveName() const { return sharedDriveName_; } //*empty* for "My Drive"
 
-    void setSharedDriveName(const Zstring& sharedDriveName) { sharedDriveName_ = sharedDriveName; }
+    void setSharedDriveName(const Zstring& sharedDriveName)
+    {
+        if (sharedDriveName_ != sharedDriveName)
+        {
+            sharedDriveName_ = sharedDriveName;
+            modified_ = true;
+        }
+    }
+
+    //changed since loaded from/saved to DB?
+    bool isModified() const { return modified_; }
+    void resetModified() { modified_ = false; }
 
     struct PathStatus
     {
@@ -1988,12 +2886,20 @@ public:
         return {};
     }
 
-    std::optional<std::vector<GdriveItem>> tryGetBufferedFolderContent(const std::string& folderId) const
+    bool isBufferedFolderContent(const std::string& folderId) const
+    {
+        auto it = folderContents_.find(folderId);
+        return it != folderContents_.end() && it->second.isKnownFolder;
+    }
+
+    std::optional<std::vector<GdriveItem>> tryGetBufferedFolderContent(const std::string& folderId)
     {
         auto it = folderContents_.find(folderId);
         if (it == folderContents_.end() || !it->second.isKnownFolder)
             return std::nullopt;
 
+        notifyFolderAccess(it->second);
+
         std::vector<GdriveItem> childItems;
         for (auto itChild : it->second.childItems)
         {
@@ -2003,6 +2909,73 @@ public:
         return std::move(childItems); //[!] need std::move!
     }
 
+    //-------------- incremental comparison --------------
+    /*  changes since the last committed checkpoint: recorded by updateItemState() as (parent folder, item name) before and after each change
+        - recorded changes are resolved to paths at the time of the query: moved/deleted parent folders are recorded themselves
+        - only items in known folders are seen: evicting folders from the DB invalidates all checkpoints
+        - starts a new pending checkpoint => becomes the committed checkpoint with commitChangeCheckpoint()    */
+    std::optional<std::vector<Zstring>> getChangesSinceCheckpoint(const std::string& locationRootId, const AfsPath& folderPath, const std::string& checkpointId) //throw SysError
+    {
+        syncWithGoogle(); //throw SysError => don't miss changes of the last GDRIVE_SYNC_INTERVAL
+
+        ChangeCheckpoint& checkpoint = checkpoints_[checkpointId];
+        checkpoint.pending.emplace();
+
+        if (!checkpoint.committed || !checkpoint.committed->complete)
+            return std::nullopt;
+
+        std::unordered_map<std::string, std::optional<Zstring>> folderPaths; //relative to location root; std::nullopt: not within location
+        std::function<const std::optional<Zstring>&(const std::string& folderId, int depth)> getFolderPath;
+        getFolderPath = [&](const std::string& folderId, int depth) -> const std::optional<Zstring>&
+        {
+            if (auto it = folderPaths.find(folderId); it != folderPaths.end())
+                return it->second;
+
+            std::optional<Zstring> path;
+            if (folderId == locationRootId)
+                path = Zstring();
+            else if (auto it = itemDetails_.find(folderId);
+                     it != itemDetails_.end() && !it->second.parentIds.empty() && depth < 1000 /*no cycles, please*/)
+                if (const std::optional<Zstring>& parentPath = getFolderPath(it->second.parentIds.front(), depth + 1))
+                    path = nativeAppendPaths(*parentPath, it->second.itemName);
+
+            return folderPaths[folderId] = std::move(path);
+        };
+
+        const Zstring folderPathSep = appendSeparator(folderPath.value);
+
+        std::vector<Zstring> changedItems;
+        for (const auto& [parentId, itemName] : checkpoint.committed->changes)
+            if (const std::optional<Zstring>& parentPath = getFolderPath(parentId, 0))
+            {
+                const Zstring itemPath = nativeAppendPaths(*parentPath, itemName);
+
+                if (folderPath.value.empty())
+                    changedItems.push_back(itemPath);
+                else if (equalNativePath(itemPath, folderPath.value))
+                    changedItems.push_back(Zstring()); //base folder itself: full comparison
+                else if (itemPath.size() > folderPathSep.size() && equalNativePath(Zstring(itemPath.begin(), itemPath.begin() + folderPathSep.size()), folderPathSep))
+                    changedItems.push_back(Zstring(itemPath.begin() + folderPathSep.size(), itemPath.end()));
+            }
+        return changedItems;
+    }
+
+    void commitChangeCheckpoint(const std::string& checkpointId)
+    {
+        if (auto it = checkpoints_.find(checkpointId);
+            it != checkpoints_.end())
+        {
+            if (it->second.pending)
+            {
+                it->second.committed = std::move(it->second.pending);
+                it->second.pending.reset();
+            }
+            else //saved without comparison in this process? => no reference point
+                checkpoints_.erase(it);
+            modified_ = true;
+        }
+    }
+
     //-------------- notifications --------------
     using ItemIdDelta = std::unordered_set<std::string>;
 
@@ -2017,7 +2990,16 @@ public:
 
     void notifyFolderContent(const FileStateDelta& stateDelta, const std::string& folderId, const std::vector<GdriveItem>& childItems)
     {
-        folderContents_[folderId].isKnownFolder = true;
+        fillingFolderContent_ = true;
+        ZEN_ON_SCOPE_EXIT(fillingFolderContent_ = false);
+
+        FolderContent& content = folderContents_[folderId];
+        if (!content.isKnownFolder)
+        {
+            content.isKnownFolder = true;
+            modified_ = true;
+        }
+        notifyFolderAccess(content);
 
         for (const GdriveItem& item : childItems)
             notifyItemUpdated(stateDelta, item.itemId, &item.details);
@@ -2109,6 +3091,15 @@ private:
 
     friend class GdriveDrivesBuffer;
 
+    using DetailsIterator = std::unordered_map<std::string, GdriveItemDetails>::iterator;
+
+    struct FolderContent
+    {
+        bool isKnownFolder = false; //:= we've seen its full content at least once; further changes are calculated via change notifications
+        time_t lastAccess = 0;      //precision: GDRIVE_FOLDER_ACCESS_TIME_PRECISION
+        std::vector<DetailsIterator> childItems;
+    };
+
     std::wstring getShortDisplayPath(const AfsPath& afsPath) const
     {
         return utfTo<std::wstring>(FILE_NAME_SEPARATOR + afsPath.value); //sufficient info for SysError + we don't have a locationName anyway
@@ -2145,9 +3136,16 @@ private:
         const ChangesDelta delta = getChangesDelta(sharedDriveName_.empty() ? std::string() : driveId_, lastSyncToken_, accessBuf_.getAccessToken()); //throw SysError
 
         for (const FileChange& change : delta.fileChanges)
-            updateItemState(change.itemId, get(change.details));
+            if (isBufferedItem(change.itemId, get(change.details)))
+                updateItemState(change.itemId, get(change.details));
+            else //huge shared drives: don't buffer changes outside of the folders we've seen => listed on first access anyway
+                logItemChange(change.itemId); //...but still consider for conflict detection
 
-        lastSyncToken_ = delta.newStartPageToken;
+        if (lastSyncToken_ != delta.newStartPageToken)
+        {
+            lastSyncToken_ = delta.newStartPageToken;
+            modified_ = true;
+        }
         lastSyncTime_ = std::chrono::steady_clock::now();
 
         //good to know: if item is created and deleted between polling for changes it is still reported as deleted by Google!
@@ -2168,6 +3166,8 @@ private:
             if (!itKnown->second.isKnownFolder)
                 throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
         }
+        else
+            notifyFolderAccess(itKnown->second);
 
         auto itFound = itemDetails_.cend();
         for (const DetailsIterator& itChild : itKnown->second.childItems)
@@ -2239,13 +3239,31 @@ private:
         }
     }
 
-    void updateItemState(const std::string& itemId, const GdriveItemDetails* details)
+    //item is part of the buffered subtrees?
+    bool isBufferedItem(const std::string& itemId, const GdriveItemDetails* details) const
     {
-        auto it = itemDetails_.find(itemId);
-        if (!details == (it == itemDetails_.end()))
-            if (!details || *details == it->second) //notified changes match our current file state
-                return; //=> avoid misleading changeLog_ entries after Google Drive sync!!!
+        if (itemDetails_.contains(itemId) || folderContents_.contains(itemId))
+            return true;
+
+        return details && std::any_of(details->parentIds.begin(), details->parentIds.end(), [&](const std::string& parentId)
+        {
+            auto it = folderContents_.find(parentId);
+            return it != folderContents_.end() && it->second.isKnownFolder;
+        });
+    }
+
+    void notifyFolderAccess(FolderContent& content)
+    {
+        const time_t now = std::time(nullptr);
+        if (content.lastAccess < now - GDRIVE_FOLDER_ACCESS_TIME_PRECISION)
+        {
+            content.lastAccess = now;
+            modified_ = true;
+        }
+    }
 
+    void logItemChange(const std::string& itemId)
+    {
         //update change logs (and clean up obsolete entries)
         std::erase_if(changeLog_, [&](std::weak_ptr<ItemIdDelta>& weakPtr)
         {
@@ -2257,6 +3275,22 @@ private:
             else
                 return true;
         });
+    }
+
+    void updateItemState(const std::string& itemId, const GdriveItemDetails* details)
+    {
+        auto it = itemDetails_.find(itemId);
+        if (!details == (it == itemDetails_.end()))
+            if (!details || *details == it->second) //notified changes match our current file state
+                return; //=> avoid misleading changeLog_ entries after Google Drive sync!!!
+
+        logItemChange(itemId);
+        modified_ = true;
+
+        //first-time listing of a folder is not a change
+        const bool logCheckpoint = !(fillingFolderContent_ && it == itemDetails_.end());
+        if (logCheckpoint)
+            logCheckpointChange(itemId); //old location
 
         //update file state
         if (details)
@@ -2312,15 +3346,47 @@ private:
                 folderContents_.erase(itP);
             }
         }
+
+        if (logCheckpoint)
+            logCheckpointChange(itemId); //new location
     }
 
-    using DetailsIterator = std::unordered_map<std::string, GdriveItemDetails>::iterator;
+    void logCheckpointChange(const std::string& itemId)
+    {
+        if (checkpoints_.empty())
+            return;
 
-    struct FolderContent
+        if (auto it = itemDetails_.find(itemId);
+            it != itemDetails_.end())
+            for (auto& [checkpointId, checkpoint] : checkpoints_)
+                for (std::optional<ChangeLog>* changeLog : {&checkpoint.committed, &checkpoint.pending})
+                    if (*changeLog && (*changeLog)->complete)
+                    {
+                        for (const std::string& parentId : it->second.parentIds)
+                            (*changeLog)->changes.emplace(parentId, it->second.itemName);
+
+                        if ((*changeLog)->changes.size() > GDRIVE_CHECKPOINT_CHANGES_MAX)
+                        {
+                            (*changeLog)->complete = false;
+                            (*changeLog)->changes.clear();
+                        }
+                    }
+        //else: location unknown => not within known folders
+    }
+
+    struct ChangeLog
     {
-        bool isKnownFolder = false; //:= we've seen its full content at least once; further changes are calculated via change notifications
-        std::vector<DetailsIterator> childItems;
+        bool complete = true;
+        std::set<std::pair<std::string /*parentId*/, Zstring /*itemName*/>> changes;
+    };
+    struct ChangeCheckpoint
+    {
+        std::optional<ChangeLog> committed; //persisted
+        std::optional<ChangeLog> pending;   //since last getChangesSinceCheckpoint() of this process
     };
+    std::map<std::string /*checkpointId*/, ChangeCheckpoint> checkpoints_;
+    bool fillingFolderContent_ = false;
+
     std::unordered_map<std::string /*folderId*/, FolderContent> folderContents_;
     std::unordered_map<std::string /*itemId*/, GdriveItemDetails> itemDetails_; //contains ALL known, existing items!
 
@@ -2333,6 +3399,7 @@ private:
     Zstring sharedDriveName_; //name of shared drive: empty for "My Drive"!
 
     GdriveAccessBuffer& accessBuf_;
+    bool modified_ = false;
 };
 
 
@@ -2356,6 +3423,11 @@ public:
         return fileState_.getFileAttributes(locationRootId_, afsPath, followLeafShortcut); //throw SysError
     }
 
+    std::optional<std::vector<Zstring>> getChangesSinceCheckpoint(const AfsPath& folderPath, const std::string& checkpointId) //throw SysError
+    {
+        return fileState_.getChangesSinceCheckpoint(locationRootId_, folderPath, checkpointId); //throw SysError
+    }
+
     GdriveFileState& all() { return fileState_; }
 
 private:
@@ -2369,21 +3441,22 @@ class GdriveDrivesBuffer
 public:
     explicit GdriveDrivesBuffer(GdriveAccessBuffer& accessBuf) :
         accessBuf_(accessBuf),
-        myDrive_(getMyDriveId(accessBuf.getAccessToken()), Zstring() /*sharedDriveName*/, accessBuf) {} //throw SysError
+        myDrive_(getMyDriveId(accessBuf.getAccessToken()), Zstring() /*sharedDriveName*/, accessBuf), //throw SysError
+        modified_(true) {}
 
-    GdriveDrivesBuffer(MemoryStreamIn<std::string>& stream, GdriveAccessBuffer& accessBuf) : //throw SysError
+    GdriveDrivesBuffer(InputStreamFromZlib& stream, int dbVersion, GdriveAccessBuffer& accessBuf) : //throw SysError, FileError
         accessBuf_(accessBuf),
-        myDrive_(stream, accessBuf) //throw SysError
+        myDrive_(stream, dbVersion, accessBuf) //throw SysError, FileError
     {
         size_t sharedDrivesCount = readNumber<uint32_t>(stream); //SysErrorUnexpectedEos
         while (sharedDrivesCount-- != 0)
         {
-            auto fileState = makeSharedRef<GdriveFileState>(stream, accessBuf); //throw SysError
+            auto fileState = makeSharedRef<GdriveFileState>(stream, dbVersion, accessBuf); //throw SysError, FileError
             sharedDrives_.emplace(fileState.ref().getDriveId(), fileState);
         }
     }
 
-    void serialize(MemoryStreamOut<std::string>& stream) const
+    void serialize(OutputStreamAsZlib& stream) const //throw SysError, FileError
     {
         myDrive_.serialize(stream);
 
@@ -2394,6 +3467,21 @@ public:
         //starredFolders_? no, will be fully restored by syncWithGoogle()
     }
 
+    //changed since loaded from/saved to DB? => skip rewriting DB files of unchanged sessions
+    bool isModified() const
+    {
+        return modified_ || myDrive_.isModified() ||
+               std::any_of(sharedDrives_.begin(), sharedDrives_.end(), [](const auto& item) { return item.second.ref().isModified(); });
+    }
+
+    void resetModified()
+    {
+        modified_ = false;
+        myDrive_.resetModified();
+        for (auto& [driveId, fileState] : sharedDrives_)
+            fileState.ref().resetModified();
+    }
+
     std::vector<Zstring /*locationName*/> listLocations() //throw SysError
     {
         if (syncIsDue())
@@ -2468,6 +3556,9 @@ private:
         }
 
         starredFolders_ = ftStarredFolders.get(); //throw SysError //
+        if (currentDrives.size() != sharedDrives_.size() ||
+            std::any_of(currentDrives.begin(), currentDrives.end(), [&](const auto& item) { return !sharedDrives_.contains(item.first); }))
+            modified_ = true;
         sharedDrives_.swap(currentDrives);                         //transaction!
         lastSyncTime_ = std::chrono::steady_clock::now(); //...(uhm, mostly, except for setSharedDriveName())
     }
@@ -2527,6 +3618,7 @@ private:
     std::unordered_map<std::string /*drive ID*/, SharedRef<GdriveFileState>> sharedDrives_;
 
     std::vector<StarredFolderDetails> starredFolders_;
+    bool modified_ = false;
 };
 
 //==========================================================================================
@@ -2562,8 +3654,15 @@ public:
                 if (holder.session)
                     try
                     {
-                        const Zstring dbFilePath = getDbFilePath(holder.session->accessBuf.ref().getUserEmail());
-                        saveSession(dbFilePath, *holder.session); //throw FileError
+                        if (holder.session->accessBuf.ref().isModified() ||
+                            holder.session->drivesBuf.ref().isModified())
+                        {
+                            const Zstring dbFilePath = getDbFilePath(holder.session->accessBuf.ref().getUserEmail());
+                            saveSession(dbFilePath, *holder.session); //throw FileError
+
+                            holder.session->accessBuf.ref().resetModified();
+                            holder.session->drivesBuf.ref().resetModified();
+                        }
                     }
                     catch (FileError&) { if (!firstError) firstError = std::current_exception(); }
             });
@@ -2746,29 +3845,31 @@ private:
 
     static void saveSession(const Zstring& dbFilePath, const UserSession& userSession) //throw FileError
     {
-        MemoryStreamOut<std::string> streamOut;
-        writeArray(streamOut, DB_FILE_DESCR, sizeof(DB_FILE_DESCR));
-        writeNumber<int32_t>(streamOut, DB_FILE_VERSION);
-
-        MemoryStreamOut<std::string> streamOutBody;
-        userSession.accessBuf.ref().serialize(streamOutBody);
-        userSession.drivesBuf.ref().serialize(streamOutBody);
+        TempFileOutput fileOut(dbFilePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+        writeArray(fileOut, DB_FILE_DESCR, sizeof(DB_FILE_DESCR)); //throw FileError
+        writeNumber<int32_t>(fileOut, DB_FILE_VERSION);            //
 
         try
         {
-            streamOut.ref() += compress(streamOutBody.ref(), 3 /*best compression level: see db_file.cpp*/); //throw SysError
+            //stream body through zlib: don't hold serialized + compressed DB in memory at the same time
+            OutputStreamAsZlib streamOutBody(3 /*best compression level: see db_file.cpp*/,
+            [&](const void* buffer, size_t bytesToWrite) { fileOut.write(buffer, bytesToWrite); }); //throw SysError
+
+            userSession.accessBuf.ref().serialize(streamOutBody); //throw SysError, FileError
+            userSession.drivesBuf.ref().serialize(streamOutBody); //
+            streamOutBody.finalize();                             //
         }
         catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(dbFilePath)), e.toString()); }
 
-        setFileContent(dbFilePath, streamOut.ref(), nullptr /*notifyUnbufferedIO*/); //throw FileError
+        fileOut.commit(); //throw FileError
     }
 
     static std::optional<UserSession> loadSession(const Zstring& dbFilePath, int timeoutSec) //throw FileError
     {
-        std::string byteStream;
+        std::optional<FileInput> fileIn;
         try
         {
-            byteStream = getFileContent(dbFilePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+            fileIn.emplace(dbFilePath, nullptr /*notifyUnbufferedIO*/); //throw FileError, ErrorFileLocked
         }
         catch (FileError&)
         {
@@ -2780,21 +3881,24 @@ private:
 
         try
         {
-            MemoryStreamIn streamIn(byteStream);
             //-------- file format header --------
             char tmp[sizeof(DB_FILE_DESCR)] = {};
-            readArray(streamIn, &tmp, sizeof(tmp)); //throw SysErrorUnexpectedEos
+            readArray(*fileIn, &tmp, sizeof(tmp)); //throw FileError, SysErrorUnexpectedEos
 
             const std::shared_ptr<int> timeoutSec2 = std::make_shared<int>(timeoutSec); //context option: valid only for duration of this call!
 
             //TODO: remove migration code at some time! 2020-07-03
             if (!std::equal(std::begin(tmp), std::end(tmp), std::begin(DB_FILE_DESCR)))
             {
-                MemoryStreamIn streamIn2(decompress(byteStream)); //throw SysError
+                //complete file is compress() output: skip 8-byte uncompressed size
+                FileInput fileInOld(dbFilePath, nullptr /*notifyUnbufferedIO*/); //throw FileError, ErrorFileLocked
+                readNumber<uint64_t>(fileInOld); //throw FileError, SysErrorUnexpectedEos
+
+                InputStreamFromZlib streamIn2([&](void* buffer, size_t bytesToRead) { return fileInOld.read(buffer, bytesToRead); }); //throw SysError
                 //-------- file format header --------
                 const char DB_FILE_DESCR_OLD[] = "FreeFileSync: Google Drive Database";
                 char tmp2[sizeof(DB_FILE_DESCR_OLD)] = {};
-                readArray(streamIn2, &tmp2, sizeof(tmp2)); //throw SysErrorUnexpectedEos
+                readArray(streamIn2, &tmp2, sizeof(tmp2)); //throw SysError, FileError, SysErrorUnexpectedEos
 
                 if (!std::equal(std::begin(tmp2), std::end(tmp2), std::begin(DB_FILE_DESCR_OLD)))
                     throw SysError(_("File content is corrupted.") + L" (invalid header)");
@@ -2807,24 +3911,28 @@ private:
 
                 //version 1 + 2: fully discard old state due to missing "ownedByMe" attribute + shortcut support
                 //version 3:     fully discard old state due to revamped shared drive handling
-                auto accessBuf = makeSharedRef<GdriveAccessBuffer>(streamIn2); //throw SysError
+                auto accessBuf = makeSharedRef<GdriveAccessBuffer>(streamIn2); //throw SysError, FileError
                 accessBuf.ref().setContextTimeout(timeoutSec2); //not used by GdriveDrivesBuffer(), but let's be consistent
                 auto drivesBuf = makeSharedRef<GdriveDrivesBuffer>(accessBuf.ref()); //throw SysError
                 return UserSession{accessBuf, drivesBuf};
             }
             else
             {
-                if (!std::equal(std::begin(tmp), std::end(tmp), std::begin(DB_FILE_DESCR)))
-                    throw SysError(_("File content is corrupted.") + L" (invalid header)");
-
-                const int version = readNumber<int32_t>(streamIn);
-                if (version != 4 &&
+                const int version = readNumber<int32_t>(*fileIn); //throw FileError, SysErrorUnexpectedEos
+                if (version != 4 && //TODO: remove migration code at some time! 2021-05-15
+                    version != 5 && //TODO: remove migration code at some time! 2026-10-14
+                    version != 6 && //TODO: remove migration code at some time! 2026-10-14
                     version != DB_FILE_VERSION)
                     throw SysError(_("Unsupported data format.") + L' ' + replaceCpy(_("Version: %x"), L"%x", numberTo<std::wstring>(version)));
 
-                MemoryStreamIn streamInBody(decompress(std::string(byteStream.begin() + streamIn.pos(), byteStream.end()))); //throw SysError
+                //TODO: remove migration code at some time! 2026-10-14
+                if (version <= 6) //body written by compress(): skip 8-byte uncompressed size
+                    readNumber<uint64_t>(*fileIn); //throw FileError, SysErrorUnexpectedEos
 
-                auto accessBuf = makeSharedRef<GdriveAccessBuffer>(streamInBody); //throw SysError
+                //stream body through zlib: peak memory independent from DB size
+                InputStreamFromZlib streamInBody([&](void* buffer, size_t bytesToRead) { return fileIn->read(buffer, bytesToRead); }); //throw SysError
+
+                auto accessBuf = makeSharedRef<GdriveAccessBuffer>(streamInBody); //throw SysError, FileError
                 accessBuf.ref().setContextTimeout(timeoutSec2); //not used by GdriveDrivesBuffer(), but let's be consistent
                 auto drivesBuf = [&]
                 {
@@ -2832,7 +3940,7 @@ private:
                     if (version <= 4) //fully discard old state due to revamped shared drive handling
                         return makeSharedRef<GdriveDrivesBuffer>(accessBuf.ref()); //throw SysError
                     else
-                        return makeSharedRef<GdriveDrivesBuffer>(streamInBody, accessBuf.ref()); //throw SysError
+                        return makeSharedRef<GdriveDrivesBuffer>(streamInBody, version, accessBuf.ref()); //throw SysError, FileError
                 }();
                 return UserSession{accessBuf, drivesBuf};
             }
@@ -2985,6 +4093,8 @@ public:
     {
         while (!workload_.empty())
         {
+            prefetchFolderContents(); //throw X
+
             auto wi = std::move(workload_.    back()); //yes, no strong exception guarantee (std::bad_alloc)
             /**/                workload_.pop_back();  //
             const auto& [folderPath, cb] = wi;
@@ -3000,6 +4110,43 @@ private:
     SingleFolderTraverser           (const SingleFolderTraverser&) = delete;
     SingleFolderTraverser& operator=(const SingleFolderTraverser&) = delete;
 
+    /*  initial scan of many small folders is dominated by per-folder request latency
+        => next folder up is not buffered: list it together with the following unbuffered folders of the workload (usually siblings) in a single query
+        => errors are ignored here: GetDirDetails() will list and report each folder separately                                                       */
+    void prefetchFolderContents()
+    {
+        try
+        {
+            std::vector<std::string> folderIds;
+            const GdrivePersistentSessions::AsyncAccessInfo aai = accessGlobalFileState(gdriveLogin_, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+            {
+                for (auto it = workload_.rbegin(); it != workload_.rend() && folderIds.size() < GDRIVE_LIST_PARENTS_MAX; ++it)
+                    try
+                    {
+                        const auto& [itemId, itemDetails] = fileState.getFileAttributes(it->first, true /*followLeafShortcut*/); //throw SysError
+
+                        if (itemDetails.type == GdriveItemType::folder && !fileState.all().isBufferedFolderContent(itemId))
+                            folderIds.push_back(itemId);
+                        else if (it == workload_.rbegin())
+                            return; //next folder up is buffered: nothing to gain
+                    }
+                    catch (SysError&) { if (it == workload_.rbegin()) return; }
+            });
+
+            if (folderIds.size() < 2)
+                return;
+
+            const std::vector<std::vector<GdriveItem>>& childItems = readFoldersContent(folderIds, aai.access); //throw SysError
+
+            accessGlobalFileState(gdriveLogin_, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+            {
+                for (size_t i = 0; i < folderIds.size(); ++i)
+                    fileState.all().notifyFolderContent(aai.stateDelta, folderIds[i], childItems[i]);
+            });
+        }
+        catch (SysError&) {}
+    }
+
     void traverseWithException(const AfsPath& folderPath, AFS::TraverserCallback& cb) //throw FileError, X
     {
         const std::vector<GdriveItem>& childItems = GetDirDetails({gdriveLogin_, folderPath})().childItems; //throw FileError
@@ -3066,44 +4213,111 @@ void gdriveTraverseFolderRecursive(const GdriveLogin& gdriveLogin, const std::ve
 //==========================================================================================
 //==========================================================================================
 
-struct InputStreamGdrive : public AFS::InputStream
+/*  download large files as byte ranges over several HTTPS connections in parallel
+    - chunks are passed to the stream buffer in order; workers fetch at most GDRIVE_PARALLEL_DOWNLOAD_CONNECTIONS chunks ahead of the consumer
+    - last range is open-ended: file size of the buffered file state might be outdated                                                    */
+void gdriveDownloadFileParallel(const std::string& fileId, uint64_t fileSize, const GdriveAccess& access, AsyncStreamBuffer& streamOut, const Zstring& threadName) //throw SysError, ThreadStopRequest
 {
-    InputStreamGdrive(const GdrivePath& gdrivePath, const IoCallback& notifyUnbufferedIO /*throw X*/) :
-        gdrivePath_(gdrivePath),
-        notifyUnbufferedIO_(notifyUnbufferedIO)
+    const size_t chunkCount = static_cast<size_t>((fileSize + GDRIVE_PARALLEL_DOWNLOAD_CHUNK_SIZE - 1) / GDRIVE_PARALLEL_DOWNLOAD_CHUNK_SIZE);
+
+    struct ChunkState
+    {
+        std::mutex lockChunks;
+        std::condition_variable conditionChunkDone;
+        std::condition_variable conditionChunkConsumed;
+
+        size_t nextChunkNo = 0;     //next chunk to fetch
+        size_t consumedChunkNo = 0; //next chunk to pass to the stream buffer
+        std::map<size_t, std::vector<std::byte>> chunksDone;
+        std::exception_ptr error; //SysError
+    };
+    const auto state = std::make_shared<ChunkState>();
+
+    std::vector<InterruptibleThread> workers;
+    ZEN_ON_SCOPE_EXIT(for (InterruptibleThread& wt : workers) wt.requestStop()); //stop all workers first, then join
+
+    for (size_t i = 0; i < std::min(GDRIVE_PARALLEL_DOWNLOAD_CONNECTIONS, chunkCount); ++i)
+        workers.emplace_back([state, fileId, access, chunkCount, threadName = threadName + Zstr('[') + numberTo<Zstring>(i + 1) + Zstr(']')]
     {
-        worker_ = InterruptibleThread([asyncStreamOut = this->asyncStreamIn_, gdrivePath]
+        setCurrentThreadName(threadName);
+        try
         {
-            setCurrentThreadName(Zstr("Istream[Gdrive] ") + utfTo<Zstring>(getGdriveDisplayPath(gdrivePath)));
-            try
+            for (;;)
             {
-                GdriveAccess access;
-                std::string fileId;
-                try
+                size_t chunkNo = 0;
                 {
-                    access = accessGlobalFileState(gdrivePath.gdriveLogin, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+                    std::unique_lock dummy(state->lockChunks);
+                    interruptibleWait(state->conditionChunkConsumed, dummy, [&] //throw ThreadStopRequest
                     {
-                        fileId = fileState.getItemId(gdrivePath.itemPath, true /*followLeafShortcut*/); //throw SysError
-                    }).access;
+                        return state->error || state->nextChunkNo >= chunkCount ||
+                               state->nextChunkNo < state->consumedChunkNo + GDRIVE_PARALLEL_DOWNLOAD_CONNECTIONS;
+                    });
+                    if (state->error || state->nextChunkNo >= chunkCount)
+                        return;
+                    chunkNo = state->nextChunkNo++;
                 }
-                catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot open file %x."), L"%x", fmtPath(getGdriveDisplayPath(gdrivePath))), e.toString()); }
 
-                try
+                const bool lastChunk = chunkNo + 1 == chunkCount;
+                const uint64_t rangeFirst = static_cast<uint64_t>(chunkNo) * GDRIVE_PARALLEL_DOWNLOAD_CHUNK_SIZE;
+                const uint64_t rangeLast  = lastChunk ? std::numeric_limits<int64_t>::max() : rangeFirst + GDRIVE_PARALLEL_DOWNLOAD_CHUNK_SIZE - 1;
+
+                std::vector<std::byte> buf;
+                buf.reserve(GDRIVE_PARALLEL_DOWNLOAD_CHUNK_SIZE);
+
+                gdriveDownloadFile(fileId, [&](const void* buffer, size_t bytesToWrite) //throw SysError, ThreadStopRequest
                 {
-                    auto writeBlock = [&](const void* buffer, size_t bytesToWrite)
-                    {
-                        return asyncStreamOut->write(buffer, bytesToWrite); //throw ThreadStopRequest
-                    };
+                    interruptionPoint(); //throw ThreadStopRequest
+                    buf.insert(buf.end(), static_cast<const std::byte*>(buffer), static_cast<const std::byte*>(buffer) + bytesToWrite);
+                }, access, std::pair(rangeFirst, rangeLast));
 
-                    gdriveDownloadFile(fileId, writeBlock, access); //throw SysError, ThreadStopRequest
-                }
-                catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getGdriveDisplayPath(gdrivePath))), e.toString()); }
+                if (!lastChunk && buf.size() != GDRIVE_PARALLEL_DOWNLOAD_CHUNK_SIZE) //file changed after it was listed?
+                    throw SysError(formatSystemError("gdriveDownloadFile", L"", L"Unexpected size of data range: " + formatNumber(buf.size()) + L" bytes"));
 
-                asyncStreamOut->closeStream();
+                {
+                    std::lock_guard dummy(state->lockChunks);
+                    state->chunksDone.emplace(chunkNo, std::move(buf));
+                }
+                state->conditionChunkDone.notify_all();
             }
-            catch (FileError&) { asyncStreamOut->setWriteError(std::current_exception()); } //let ThreadStopRequest pass through!
-        });
+        }
+        catch (SysError&)
+        {
+            {
+                std::lock_guard dummy(state->lockChunks);
+                if (!state->error)
+                    state->error = std::current_exception();
+            }
+            state->conditionChunkDone    .notify_all();
+            state->conditionChunkConsumed.notify_all();
+        }
+    });
+
+    for (size_t chunkNo = 0; chunkNo < chunkCount; ++chunkNo)
+    {
+        std::vector<std::byte> chunk;
+        {
+            std::unique_lock dummy(state->lockChunks);
+            interruptibleWait(state->conditionChunkDone, dummy, [&] { return state->error || state->chunksDone.contains(chunkNo); }); //throw ThreadStopRequest
+            if (state->error)
+                std::rethrow_exception(state->error); //throw SysError
+
+            auto it = state->chunksDone.find(chunkNo);
+            chunk = std::move(it->second);
+            state->chunksDone.erase(it);
+            state->consumedChunkNo = chunkNo + 1;
+        }
+        state->conditionChunkConsumed.notify_all();
+
+        streamOut.write(chunk.data(), chunk.size()); //throw ThreadStopRequest
     }
+}
+
+
+struct InputStreamGdrive : public AFS::InputStream
+{
+    InputStreamGdrive(const GdrivePath& gdrivePath, const IoCallback& notifyUnbufferedIO /*throw X*/) :
+        gdrivePath_(gdrivePath),
+        notifyUnbufferedIO_(notifyUnbufferedIO) {}
 
     ~InputStreamGdrive()
     {
@@ -3112,6 +4326,9 @@ struct InputStreamGdrive : public AFS::InputStream
 
     size_t read(void* buffer, size_t bytesToRead) override //throw FileError, (ErrorFileLocked), X; return "bytesToRead" bytes unless end of stream!
     {
+        if (!worker_.joinable()) //start download lazily: stream might be used for readAt() only
+            startDownload();
+
         const size_t bytesRead = asyncStreamIn_->read(buffer, bytesToRead); //throw FileError
         reportBytesProcessed(); //throw X
         return bytesRead;
@@ -3137,7 +4354,86 @@ struct InputStreamGdrive : public AFS::InputStream
         return std::move(attr); //[!]
     }
 
+    bool supportsReadAt() const override { return true; }
+
+    size_t readAt(uint64_t offset, void* buffer, size_t bytesToRead) override //throw FileError, (ErrorFileLocked), X; return "bytesToRead" bytes unless end of stream!
+    {
+        assert(!worker_.joinable()); //don't mix with read()
+        if (bytesToRead == 0)
+            return 0;
+
+        const auto& [fileId, fileSize, access] = getFileIdAndAccess(gdrivePath_); //throw FileError
+
+        size_t bytesRead = 0;
+        auto writeBlock = [&](const void* blockBuf, size_t blockSize)
+        {
+            const size_t junkSize = std::min(blockSize, bytesToRead - bytesRead); //don't trust the server to honor the range
+            std::memcpy(static_cast<std::byte*>(buffer) + bytesRead, blockBuf, junkSize);
+            bytesRead += junkSize;
+            if (notifyUnbufferedIO_) notifyUnbufferedIO_(blockSize); //throw X
+        };
+        try
+        {
+            gdriveDownloadFile(fileId, writeBlock, access, std::pair(offset, offset + bytesToRead - 1)); //throw SysError, X
+        }
+        catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getGdriveDisplayPath(gdrivePath_))), e.toString()); }
+        return bytesRead;
+    }
+
 private:
+    struct FileAccessInfo
+    {
+        std::string fileId;
+        uint64_t fileSize = 0; //as buffered: might be outdated
+        GdriveAccess access;
+    };
+    static FileAccessInfo getFileIdAndAccess(const GdrivePath& gdrivePath) //throw FileError
+    {
+        try
+        {
+            FileAccessInfo fai;
+            fai.access = accessGlobalFileState(gdrivePath.gdriveLogin, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+            {
+                const auto& [itemId, itemDetails] = fileState.getFileAttributes(gdrivePath.itemPath, true /*followLeafShortcut*/); //throw SysError
+                fai.fileId   = itemId;
+                fai.fileSize = itemDetails.fileSize;
+            }).access;
+            return fai;
+        }
+        catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot open file %x."), L"%x", fmtPath(getGdriveDisplayPath(gdrivePath))), e.toString()); }
+    }
+
+    void startDownload()
+    {
+        worker_ = InterruptibleThread([asyncStreamOut = this->asyncStreamIn_, gdrivePath = gdrivePath_]
+        {
+            setCurrentThreadName(Zstr("Istream[Gdrive] ") + utfTo<Zstring>(getGdriveDisplayPath(gdrivePath)));
+            try
+            {
+                const auto& [fileId, fileSize, access] = getFileIdAndAccess(gdrivePath); //throw FileError
+
+                try
+                {
+                    if (fileSize >= GDRIVE_PARALLEL_DOWNLOAD_MIN_SIZE)
+                        gdriveDownloadFileParallel(fileId, fileSize, access, *asyncStreamOut, Zstr("Download[Gdrive] ") + utfTo<Zstring>(getGdriveDisplayPath(gdrivePath))); //throw SysError, ThreadStopRequest
+                    else
+                    {
+                        auto writeBlock = [&](const void* buffer, size_t bytesToWrite)
+                        {
+                            return asyncStreamOut->write(buffer, bytesToWrite); //throw ThreadStopRequest
+                        };
+
+                        gdriveDownloadFile(fileId, writeBlock, access); //throw SysError, ThreadStopRequest
+                    }
+                }
+                catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getGdriveDisplayPath(gdrivePath))), e.toString()); }
+
+                asyncStreamOut->closeStream();
+            }
+            catch (FileError&) { asyncStreamOut->setWriteError(std::current_exception()); } //let ThreadStopRequest pass through!
+        });
+    }
+
     void reportBytesProcessed() //throw X
     {
         const int64_t totalBytesDownloaded = asyncStreamIn_->getTotalBytesWritten();
@@ -3158,7 +4454,7 @@ private:
 struct OutputStreamGdrive : public AFS::OutputStreamImpl
 {
     OutputStreamGdrive(const GdrivePath& gdrivePath, //throw SysError
-                       std::optional<uint64_t> /*streamSize*/,
+                       std::optional<uint64_t> streamSize,
                        std::optional<time_t> modTime,
                        const IoCallback& notifyUnbufferedIO /*throw X*/,
                        std::unique_ptr<PathAccessLock>&& pal) :
@@ -3183,7 +4479,7 @@ struct OutputStreamGdrive : public AFS::OutputStreamImpl
             parentId = ps.existingItemId;
         });
 
-        worker_ = InterruptibleThread([gdrivePath, modTime, fileName, asyncStreamIn = this->asyncStreamOut_,
+        worker_ = InterruptibleThread([gdrivePath, streamSize, modTime, fileName, asyncStreamIn = this->asyncStreamOut_,
                                                    pFilePrint = std::move(pFilePrint),
                                                    parentId   = std::move(parentId),
                                                    aai        = std::move(aai),
@@ -3200,9 +4496,11 @@ struct OutputStreamGdrive : public AFS::OutputStreamImpl
                 };
                 //for whatever reason, gdriveUploadFile() is slightly faster than gdriveUploadSmallFile()! despite its two roundtrips! even when file sizes are 0!
                 //=> 1. issue likely on Google's side => 2. persists even after having fixed "Expect: 100-continue"
-                const std::string fileIdNew = //streamSize && *streamSize < 5 * 1024 * 1024 ?
-                    //gdriveUploadSmallFile(fileName, parentId, *streamSize, modTime, readBlock, aai.access) : //throw SysError, ThreadStopRequest
-                    gdriveUploadFile       (fileName, parentId,              modTime, readBlock, aai.access);  //throw SysError, ThreadStopRequest
+                const std::string fileIdNew = streamSize && *streamSize >= GDRIVE_CHUNKED_UPLOAD_MIN_SIZE ?
+                                              gdriveUploadLargeFile(fileName, parentId, modTime, readBlock, aai.access) : //throw SysError, ThreadStopRequest
+                                              //streamSize && *streamSize < 5 * 1024 * 1024 ?
+                                              //gdriveUploadSmallFile(fileName, parentId, *streamSize, modTime, readBlock, aai.access) : //throw SysError, ThreadStopRequest
+                                              gdriveUploadFile     (fileName, parentId,              modTime, readBlock, aai.access);  //throw SysError, ThreadStopRequest
                 assert(asyncStreamIn->getTotalBytesRead() == asyncStreamIn->getTotalBytesWritten());
                 //already existing: creates duplicate
 
@@ -3570,7 +4868,7 @@ private:
         if (!equalAsciiNoCase(gdriveLogin_.email, fsTarget.gdriveLogin_.email))
             //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
             //=> actual behavior: 1. fails or 2. creates duplicate (unlikely)
-            return copyFileAsStream(afsSource, attrSource, apTarget, notifyUnbufferedIO); //throw FileError, (ErrorFileLocked), X
+            return copyFileAsStream(afsSource, attrSource, apTarget, false /*calcContentHash*/, notifyUnbufferedIO); //throw FileError, (ErrorFileLocked), X
         //else: copying files within account works, e.g. between My Drive <-> shared drives
 
         try
@@ -3647,6 +4945,51 @@ private:
         AFS::createFolderPlain(apTarget); //throw FileError
     }
 
+    FileDigest getServerFileDigest(const AfsPath& afsPath) const override //throw FileError
+    {
+        try
+        {
+            std::string fileId;
+            const GdrivePersistentSessions::AsyncAccessInfo aai = accessGlobalFileState(gdriveLogin_, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+            {
+                const auto& [itemId, itemDetails] = fileState.getFileAttributes(afsPath, true /*followLeafShortcut*/); //throw SysError
+                if (itemDetails.type == GdriveItemType::file)
+                    fileId = itemId;
+            });
+            if (fileId.empty())
+                return {};
+
+            return gdriveGetFileDigest(fileId, aai.access); //throw SysError
+        }
+        catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(getDisplayPath(afsPath))), e.toString()); }
+    }
+
+    std::optional<std::vector<Zstring>> getChangesSinceCheckpoint(const AfsPath& folderPath, const std::string& checkpointId) const override //throw FileError
+    {
+        try
+        {
+            std::optional<std::vector<Zstring>> changedItems;
+            accessGlobalFileState(gdriveLogin_, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+            {
+                changedItems = fileState.getChangesSinceCheckpoint(folderPath, checkpointId); //throw SysError
+            });
+            return changedItems;
+        }
+        catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read directory %x."), L"%x", fmtPath(getDisplayPath(folderPath))), e.toString()); }
+    }
+
+    void commitChangeCheckpoint(const AfsPath& folderPath, const std::string& checkpointId) const override //throw FileError
+    {
+        try
+        {
+            accessGlobalFileState(gdriveLogin_, [&](GdriveFileStateAtLocation& fileState) //throw SysError
+            {
+                fileState.all().commitChangeCheckpoint(checkpointId);
+            });
+        }
+        catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(getDisplayPath(folderPath))), e.toString()); }
+    }
+
     //already existing: fail
     void copySymlinkForSameAfsType(const AfsPath& afsSource, const AbstractPath& apTarget, bool copyFilePermissions) const override //throw FileError
     {
@@ -3706,7 +5049,7 @@ private:
                                                         L"%y",  L'\n' + fmtPath(AFS::getDisplayPath(pathTo)));
                                     };
 
-        if (compareDeviceSameAfsType(pathTo.afsDevice.ref()) != std::weak_ordering::equivalent)
+        if (!isMoveCompatibleSameAfsType(pathTo.afsDevice.ref()))
             throw ErrorMoveUnsupported(generateErrorMsg(), _("Operation not supported between different devices."));
         //note: moving files within account works, e.g. between My Drive <-> shared drives
         //      BUT: not supported by our model with separate GdriveFileStates; e.g. how to handle complexity of a moved folder (tree)?
@@ -3767,6 +5110,9 @@ private:
         catch (const SysError& e) { throw FileError(generateErrorMsg(), e.toString()); }
     }
 
+    //hasNativeTransactionalCopy() => no temp files to rename
+    bool tryMoveAndReplaceFileForSameAfsType(const AfsPath& pathFrom, const AbstractPath& pathTo) const override { return false; } //throw FileError
+
     bool supportsPermissions(const AfsPath& afsPath) const override { return false; } //throw FileError
 
     //----------------------------------------------------------------------------------------------------------------
@@ -3794,7 +5140,11 @@ private:
 
     int getAccessTimeout() const override { return gdriveLogin_.timeoutSec; } //returns "0" if no timeout in force
 
+    void prepareSessions(size_t sessionCount) const override {} //noexcept
+
     bool hasNativeTransactionalCopy() const override { return true; }
+
+    bool hasServerSideCopy() const override { return true; } //gdriveCopyFile(): within the same account
     //----------------------------------------------------------------------------------------------------------------
 
     int64_t getFreeDiskSpace(const AfsPath& afsPath) const override //throw FileError, returns < 0 if not available
@@ -17,6 +17,10 @@ namespace
 int uniInitLevel = 0; //support interleaving initialization calls! (e.g. use for libssh2 and libcurl)
 //zero-initialized POD => not subject to static initialization order fiasco
 
+constinit std::once_flag libsshInitOnce;           //trivially destructible + constant-initialized
+constinit std::atomic<bool> libsshInitDone{false}; //
+constinit std::atomic<bool> asyncInitStarted{false};
+
 void libsshCurlUnifiedInit()
 {
     assert(runningOnMainThread());
@@ -24,16 +28,27 @@ void libsshCurlUnifiedInit()
     if (++uniInitLevel != 1) //non-atomic => require call from main thread
         return;
 
-    libcurlInit(); //includes WSAStartup() also needed by libssh2
+    libcurlInit(); //=> deferred: see libsshCurlUnifiedEnsureInit()
+}
+
 
-    [[maybe_unused]] const int rc2 = ::libssh2_init(0);
-    assert(rc2 == 0); //libssh2 unconditionally returns 0 => why then have a return value in first place???
-    /*  we need libssh2's crypto init:
-        - there is other OpenSSL-related initialization which might be needed (and hopefully won't hurt...)
+//network stack is initialized on first use only: local jobs don't need OpenSSL, libcurl or libssh2
+void libsshCurlUnifiedEnsureInit() //noexcept
+{
+    libcurlEnsureInit(); //includes WSAStartup() also needed by libssh2
 
-        2019-02-26: following reasons are obsolete due to HAVE_EVP_AES_128_CTR:
-        // - initializes a few statically allocated constants => avoid (minor) race condition if these were initialized by worker threads
-        // - enable proper clean up of these variables in libssh2_exit() (otherwise: memory leaks!)  */
+    std::call_once(libsshInitOnce, []
+    {
+        [[maybe_unused]] const int rc2 = ::libssh2_init(0);
+        assert(rc2 == 0); //libssh2 unconditionally returns 0 => why then have a return value in first place???
+        /*  we need libssh2's crypto init:
+            - there is other OpenSSL-related initialization which might be needed (and hopefully won't hurt...)
+
+            2019-02-26: following reasons are obsolete due to HAVE_EVP_AES_128_CTR:
+            // - initializes a few statically allocated constants => avoid (minor) race condition if these were initialized by worker threads
+            // - enable proper clean up of these variables in libssh2_exit() (otherwise: memory leaks!)  */
+        libsshInitDone = true;
+    });
 }
 
 
@@ -44,12 +59,30 @@ void libsshCurlUnifiedTearDown()
     if (--uniInitLevel != 0)
         return;
 
-    ::libssh2_exit();
+    std::call_once(libsshInitOnce, [] {}); //wait for init still running on some thread (if any), prevent later ones
+    if (libsshInitDone)
+        ::libssh2_exit();
     libcurlTearDown();
 }
 }
 
 
+void zen::startLibsshCurlUnifiedInit()
+{
+    if (!asyncInitStarted.exchange(true))
+        try
+        {
+            //teardown waits (std::call_once) if init is still running => fine to detach
+            std::thread([]
+            {
+                setCurrentThreadName(Zstr("Init: libcurl, libssh2"));
+                libsshCurlUnifiedEnsureInit();
+            }).detach();
+        }
+        catch (const std::system_error&) { assert(false); } //no big deal: init on first use instead
+}
+
+
 class zen::UniSessionCounter::Impl
 {
 public:
@@ -138,6 +171,8 @@ std::shared_ptr<UniCounterCookie> zen::getLibsshCurlUnifiedInitCookie(Global<Uni
         throw SysError(formatSystemError("getLibsshCurlUnifiedInitCookie", L"", L"Function call not allowed during init/shutdown.")); //=> ~UniCounterCookie() *not* called!
     sessionCounter->pimpl->inc(); //throw SysError                                                                                    //
 
+    libsshCurlUnifiedEnsureInit(); //first (S)FTP/HTTP session
+
     //pass "ownership" of having to call UniSessionCounter::dec()
     return std::make_shared<UniCounterCookie>(sessionCounter); //throw SysError
 }
@@ -32,6 +32,11 @@ class UniCounterCookie;
 std::shared_ptr<UniCounterCookie> getLibsshCurlUnifiedInitCookie(Global<UniSessionCounter>& globalSftpSessionCount); //throw SysError
 
 
+//optional: start initialization of libcurl, libssh2 and OpenSSL on a worker thread, e.g. as soon as a remote path is known
+//else: happens on first getLibsshCurlUnifiedInitCookie() => purely local jobs never initialize the network libraries
+void startLibsshCurlUnifiedInit(); //noexcept
+
+
 //3. Create static "UniInitializer globalInitSftp(*globalSftpSessionCount.get());" instance *before* constructing objects like "SftpSessionManager"
 // => ~SftpSessionManager will run first and all remaining sessions are on non-main threads => can be waited on in ~UniInitializer
 class UniInitializer
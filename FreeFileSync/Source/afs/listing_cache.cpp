@@ -0,0 +1,288 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "listing_cache.h"
+#include <zen/crc.h>
+#include <zen/file_access.h>
+#include <zen/file_io.h>
+#include <zen/globals.h>
+#include <zen/thread.h>
+#include <zen/zlib_wrap.h>
+
+using namespace zen;
+using namespace fff;
+
+
+namespace
+{
+const char DB_FILE_DESCR[] = "FreeFileSync";
+const int  DB_FILE_VERSION = 1; //2026-10-14
+
+const int CACHE_MIN_FOLDER_AGE_SEC = 5 * 60; //don't cache folders modified "just now"
+const int CACHE_EXPIRATION_DAYS = 30;        //discard folders not accessed for a while (e.g. deleted on server)
+
+
+class ListingCache
+{
+public:
+    explicit ListingCache(const Zstring& configDirPath) : configDirPath_(configDirPath) {}
+
+    std::optional<std::vector<CachedFolderItem>> getFolderListing(const Zstring& deviceKey, const AfsPath& folderPath, time_t folderModTime) //noexcept
+    {
+        return devices_.access([&](DeviceCaches& devices) -> std::optional<std::vector<CachedFolderItem>>
+        {
+            DeviceCache& dc = getDeviceCache(devices, deviceKey);
+
+            auto it = dc.folders.find(folderPath.value);
+            if (it == dc.folders.end())
+                return std::nullopt;
+
+            if (it->second.folderModTime != folderModTime)
+            {
+                dc.folders.erase(it);
+                return std::nullopt;
+            }
+
+            it->second.lastAccess = std::time(nullptr);
+            return it->second.items;
+        });
+    }
+
+    void setFolderListing(const Zstring& deviceKey, const AfsPath& folderPath, time_t folderModTime, const std::vector<CachedFolderItem>& items) //noexcept
+    {
+        const time_t now = std::time(nullptr);
+
+        devices_.access([&](DeviceCaches& devices)
+        {
+            DeviceCache& dc = getDeviceCache(devices, deviceKey);
+
+            if (folderModTime > now - CACHE_MIN_FOLDER_AGE_SEC) //=> changes within the same second (after listing) would go unnoticed
+                dc.folders.erase(folderPath.value);
+            else
+                dc.folders[folderPath.value] = {folderModTime, now, items};
+        });
+    }
+
+    void saveLoadedDevices() //throw FileError
+    {
+        devices_.access([&](DeviceCaches& devices)
+        {
+            if (!devices.empty())
+            {
+                createDirectoryIfMissingRecursion(configDirPath_); //throw FileError
+
+                std::exception_ptr firstError;
+                for (const auto& [deviceKey, dc] : devices)
+                    try
+                    {
+                        saveDeviceCache(getDbFilePath(deviceKey), deviceKey, dc); //throw FileError
+                    }
+                    catch (FileError&) { if (!firstError) firstError = std::current_exception(); }
+
+                if (firstError)
+                    std::rethrow_exception(firstError); //throw FileError
+            }
+        });
+    }
+
+private:
+    ListingCache           (const ListingCache&) = delete;
+    ListingCache& operator=(const ListingCache&) = delete;
+
+    struct FolderListing
+    {
+        time_t folderModTime = 0;
+        time_t lastAccess = 0;
+        std::vector<CachedFolderItem> items;
+    };
+    struct DeviceCache
+    {
+        std::map<Zstring /*AfsPath*/, FolderListing> folders;
+    };
+    using DeviceCaches = std::map<Zstring /*deviceKey*/, DeviceCache>;
+
+    Zstring getDbFilePath(const Zstring& deviceKey) const
+    {
+        //device key contains characters not allowed in file names, e.g. "sftp://user@server:22"; hash collisions are detected when loading
+        return appendSeparator(configDirPath_) + utfTo<Zstring>(printNumber<std::string>("%08x", static_cast<unsigned int>(getCrc32(utfTo<std::string>(deviceKey))))) + Zstr(".db");
+    }
+
+    DeviceCache& getDeviceCache(DeviceCaches& devices, const Zstring& deviceKey) //noexcept
+    {
+        auto it = devices.find(deviceKey);
+        if (it == devices.end())
+        {
+            it = devices.emplace(deviceKey, DeviceCache()).first;
+            try
+            {
+                it->second = loadDeviceCache(getDbFilePath(deviceKey), deviceKey); //throw FileError
+            }
+            catch (FileError&) {} //it's just a cache: start from scratch; corrupted DB file will be overwritten at teardown
+        }
+        return it->second;
+    }
+
+    static void saveDeviceCache(const Zstring& dbFilePath, const Zstring& deviceKey, const DeviceCache& dc) //throw FileError
+    {
+        const time_t now = std::time(nullptr);
+
+        MemoryStreamOut<std::string> streamOut;
+        writeArray(streamOut, DB_FILE_DESCR, sizeof(DB_FILE_DESCR));
+        writeNumber<int32_t>(streamOut, DB_FILE_VERSION);
+
+        MemoryStreamOut<std::string> streamOutBody;
+        writeContainer(streamOutBody, utfTo<std::string>(deviceKey));
+
+        size_t folderCount = 0;
+        for (const auto& [folderPath, listing] : dc.folders)
+            if (listing.lastAccess > now - CACHE_EXPIRATION_DAYS * 24 * 3600)
+                ++folderCount;
+        writeNumber<uint32_t>(streamOutBody, static_cast<uint32_t>(folderCount));
+
+        for (const auto& [folderPath, listing] : dc.folders)
+            if (listing.lastAccess > now - CACHE_EXPIRATION_DAYS * 24 * 3600)
+            {
+                writeContainer(streamOutBody, utfTo<std::string>(folderPath));
+                writeNumber<int64_t>(streamOutBody, listing.folderModTime);
+                writeNumber<int64_t>(streamOutBody, listing.lastAccess);
+
+                writeNumber<uint32_t>(streamOutBody, static_cast<uint32_t>(listing.items.size()));
+                for (const CachedFolderItem& item : listing.items)
+                {
+                    writeNumber<AbstractFileSystem::ItemType>(streamOutBody, item.type);
+                    writeContainer(streamOutBody, utfTo<std::string>(item.itemName));
+                    writeNumber<uint64_t>(streamOutBody, item.fileSize);
+                    writeNumber<int64_t >(streamOutBody, item.modTime);
+                    writeNumber<AbstractFileSystem::FingerPrint>(streamOutBody, item.filePrint);
+                }
+            }
+
+        try
+        {
+            streamOut.ref() += compress(streamOutBody.ref(), 3 /*best compression level: see db_file.cpp*/); //throw SysError
+        }
+        catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(dbFilePath)), e.toString()); }
+
+        setFileContent(dbFilePath, streamOut.ref(), nullptr /*notifyUnbufferedIO*/); //throw FileError
+    }
+
+    static DeviceCache loadDeviceCache(const Zstring& dbFilePath, const Zstring& deviceKey) //throw FileError
+    {
+        std::string byteStream;
+        try
+        {
+            byteStream = getFileContent(dbFilePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+        }
+        catch (FileError&)
+        {
+            if (itemStillExists(dbFilePath)) //throw FileError
+                throw;
+
+            return {};
+        }
+
+        try
+        {
+            MemoryStreamIn streamIn(byteStream);
+            //-------- file format header --------
+            char tmp[sizeof(DB_FILE_DESCR)] = {};
+            readArray(streamIn, &tmp, sizeof(tmp)); //throw SysErrorUnexpectedEos
+
+            if (!std::equal(std::begin(tmp), std::end(tmp), std::begin(DB_FILE_DESCR)))
+                throw SysError(_("File content is corrupted.") + L" (invalid header)");
+
+            const int version = readNumber<int32_t>(streamIn); //throw SysErrorUnexpectedEos
+            if (version != DB_FILE_VERSION)
+                throw SysError(_("Unsupported data format.") + L' ' + replaceCpy(_("Version: %x"), L"%x", numberTo<std::wstring>(version)));
+
+            MemoryStreamIn streamInBody(decompress(std::string(byteStream.begin() + streamIn.pos(), byteStream.end()))); //throw SysError
+
+            if (utfTo<Zstring>(readContainer<std::string>(streamInBody)) != deviceKey) //throw SysErrorUnexpectedEos
+                return {}; //hash collision: different device
+
+            DeviceCache dc;
+            size_t folderCount = readNumber<uint32_t>(streamInBody); //throw SysErrorUnexpectedEos
+            while (folderCount-- != 0)
+            {
+                const Zstring folderPath = utfTo<Zstring>(readContainer<std::string>(streamInBody)); //
+
+                FolderListing& listing = dc.folders[folderPath];
+                listing.folderModTime = readNumber<int64_t>(streamInBody); //
+                listing.lastAccess    = readNumber<int64_t>(streamInBody); //throw SysErrorUnexpectedEos
+
+                size_t itemCount = readNumber<uint32_t>(streamInBody); //
+                while (itemCount-- != 0)
+                {
+                    CachedFolderItem item;
+                    item.type      = readNumber<AbstractFileSystem::ItemType>(streamInBody);    //
+                    item.itemName  = utfTo<Zstring>(readContainer<std::string>(streamInBody));  //
+                    item.fileSize  = readNumber<uint64_t>(streamInBody);                         //throw SysErrorUnexpectedEos
+                    item.modTime   = readNumber<int64_t >(streamInBody);                         //
+                    item.filePrint = readNumber<AbstractFileSystem::FingerPrint>(streamInBody); //
+                    listing.items.push_back(std::move(item));
+                }
+            }
+            return dc;
+        }
+        catch (const SysError& e)
+        {
+            throw FileError(replaceCpy(_("Cannot read database file %x."), L"%x", fmtPath(dbFilePath)), e.toString());
+        }
+    }
+
+    const Zstring configDirPath_;
+    Protected<DeviceCaches> devices_; //lazy-load DB files: only for devices that are actually traversed
+};
+
+constinit Global<ListingCache> globalListingCache;
+}
+
+
+void fff::listingCacheInit(const Zstring& configDirPath)
+{
+    assert(!globalListingCache.get());
+    globalListingCache.set(std::make_unique<ListingCache>(configDirPath));
+}
+
+
+std::wstring /*warningMsg*/ fff::listingCacheTeardown()
+{
+    std::wstring warningMsg;
+    try
+    {
+        if (const std::shared_ptr<ListingCache> lc = globalListingCache.get())
+            lc->saveLoadedDevices(); //throw FileError
+    }
+    catch (const FileError& e) { warningMsg = e.toString(); }
+
+    assert(globalListingCache.get());
+    globalListingCache.set(nullptr);
+
+    return warningMsg;
+}
+
+
+std::optional<std::vector<CachedFolderItem>> fff::getCachedFolderListing(const Zstring& deviceKey, const AfsPath& folderPath, time_t folderModTime) //noexcept
+{
+    try
+    {
+        if (const std::shared_ptr<ListingCache> lc = globalListingCache.get())
+            return lc->getFolderListing(deviceKey, folderPath, folderModTime); //noexcept
+    }
+    catch (const std::bad_alloc&) {} //let's not fail traversal just because of the cache
+    return std::nullopt;
+}
+
+
+void fff::setCachedFolderListing(const Zstring& deviceKey, const AfsPath& folderPath, time_t folderModTime, const std::vector<CachedFolderItem>& items) //noexcept
+{
+    try
+    {
+        if (const std::shared_ptr<ListingCache> lc = globalListingCache.get())
+            lc->setFolderListing(deviceKey, folderPath, folderModTime, items); //noexcept
+    }
+    catch (const std::bad_alloc&) {}
+}
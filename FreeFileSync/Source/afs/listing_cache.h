@@ -0,0 +1,39 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef LISTING_CACHE_H_2830475619283746501
+#define LISTING_CACHE_H_2830475619283746501
+
+#include "abstract.h"
+
+
+namespace fff
+{
+/*  persistent folder listings for high-latency devices (SFTP, FTP): don't list folders again that are unchanged since the last run
+
+    - key: device + folder path; validated by the folder's modification time as found in a *fresh* listing of its parent folder
+      => base folders are always listed; children of a folder served from cache must be listed, too (their modification times may be outdated)
+    - caveat: a folder's modification time changes when items are created, deleted or renamed, but NOT when a file is overwritten in-place
+      => opt-in per connection
+    - folders modified during the last few minutes are not cached: one-second time precision + clock skew between client and server  */
+struct CachedFolderItem
+{
+    AbstractFileSystem::ItemType type = AbstractFileSystem::ItemType::file;
+    Zstring itemName;
+    uint64_t fileSize = 0;
+    time_t modTime = 0;
+    AbstractFileSystem::FingerPrint filePrint = 0; //optional
+};
+
+void listingCacheInit(const Zstring& configDirPath);
+std::wstring /*warningMsg*/ listingCacheTeardown();
+
+//thread-safe:
+std::optional<std::vector<CachedFolderItem>> getCachedFolderListing(const Zstring& deviceKey, const AfsPath& folderPath, time_t folderModTime); //noexcept
+void setCachedFolderListing(const Zstring& deviceKey, const AfsPath& folderPath, time_t folderModTime, const std::vector<CachedFolderItem>& items); //noexcept
+}
+
+#endif //LISTING_CACHE_H_2830475619283746501
@@ -6,6 +6,7 @@
 
 #include "native.h"
 #include <zen/file_access.h>
+#include <zen/file_traverser.h>
 #include <zen/symlink_target.h>
 #include <zen/file_io.h>
 #include <zen/stl_tools.h>
@@ -15,6 +16,7 @@
 #include <zen/guid.h>
 #include <zen/crc.h>
 #include "abstract_impl.h"
+#include "snapshot_changes.h"
 #include "../base/icon_loader.h"
 
     #include <sys/vfs.h> //statfs
@@ -35,6 +37,9 @@ void initComForThread() //throw FileError
 {
 }
 
+
+const uint64_t NATIVE_DELTA_MIN_SIZE = 64 * 1024 * 1024; //delta update reads source *and* target: not worth it for small files
+
 //====================================================================================================
 //====================================================================================================
 
@@ -95,88 +100,14 @@ NativeFileInfo getFileAttributes(FileBase::FileHandle fh) //throw SysError
 }
 
 
-struct FsItem
-{
-    Zstring itemName;
-};
-std::vector<FsItem> getDirContentFlat(const Zstring& dirPath) //throw FileError
-{
-    //no need to check for endless recursion:
-    //1. Linux has a fixed limit on the number of symbolic links in a path
-    //2. fails with "too many open files" or "path too long" before reaching stack overflow
-
-    DIR* folder = ::opendir(dirPath.c_str()); //directory must NOT end with path separator, except "/"
-    if (!folder)
-        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot open directory %x."), L"%x", fmtPath(dirPath)), "opendir");
-    ZEN_ON_SCOPE_EXIT(::closedir(folder)); //never close nullptr handles! -> crash
-
-    std::vector<FsItem> output;
-    for (;;)
-    {
-        /* Linux: https://man7.org/linux/man-pages/man3/readdir_r.3.html
-                "It is recommended that applications use readdir(3) instead of readdir_r"
-                "... in modern implementations (including the glibc implementation), concurrent calls to readdir(3) that specify different directory streams are thread-safe"
-
-           macOS: - libc: readdir thread-safe already in code from 2000: https://opensource.apple.com/source/Libc/Libc-166/gen.subproj/readdir.c.auto.html
-                  - and in the latest version from 2017:                 https://opensource.apple.com/source/Libc/Libc-1244.30.3/gen/FreeBSD/readdir.c.auto.html                   */
-        errno = 0;
-        const dirent* dirEntry = ::readdir(folder);
-        if (!dirEntry)
-        {
-            if (errno == 0) //errno left unchanged => no more items
-                return output;
-
-            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read directory %x."), L"%x", fmtPath(dirPath)), "readdir");
-            //don't retry but restart dir traversal on error! https://devblogs.microsoft.com/oldnewthing/20140612-00/?p=753
-        }
-
-        const char* itemNameRaw = dirEntry->d_name;
-
-        //skip "." and ".."
-        if (itemNameRaw[0] == '.' &&
-            (itemNameRaw[1] == 0 || (itemNameRaw[1] == '.' && itemNameRaw[2] == 0)))
-            continue;
-
-        if (itemNameRaw[0] == 0) //show error instead of endless recursion!!!
-            throw FileError(replaceCpy(_("Cannot read directory %x."), L"%x", fmtPath(dirPath)), formatSystemError("readdir", L"", L"Folder contains an item without name."));
-
-        output.push_back({itemNameRaw});
-
-        /* Unicode normalization is file-system-dependent:
-
-               OS                 Accepts   Gives back
-               ----------         -------   ----------
-               macOS (HFS+)         all        NFD
-               Linux                all      <input>
-               Windows (NTFS, FAT)  all      <input>
-
-            some file systems return precomposed others decomposed UTF8: https://developer.apple.com/library/archive/qa/qa1173/_index.html
-                  - OS X edit controls and text fields may return precomposed UTF as directly received by keyboard or decomposed UTF that was copy & pasted!
-                  - Posix APIs require decomposed form: https://freefilesync.org/forum/viewtopic.php?t=2480
-
-            => General recommendation: always preserve input UNCHANGED (both unicode normalization and case sensitivity)
-            => normalize only when needed during string comparison
-
-            Create sample files on Linux: touch  decomposed-$'\x6f\xcc\x81'.txt
-                                          touch precomposed-$'\xc3\xb3'.txt
-
-            - list file name hex chars in terminal:  ls | od -c -t x1
-
-            - SMB sharing case-sensitive or NFD file names is fundamentally broken on macOS:
-                => the macOS SMB manager internally buffers file names as case-insensitive and NFC (= just like NTFS on Windows)
-                => test: create SMB share from Linux => *boom* on macOS: "Error Code 2: No such file or directory [lstat]"
-                    or WORSE: folders "test" and "Test" *both* incorrectly return the content of one of the two
-                => Update 2020-04-24: converting to NFC doesn't help: both NFD/NFC forms fail(ENOENT) lstat in FFS, AS WELL AS IN FINDER => macOS bug!         */
-    }
-}
-
-
 struct FsItemDetails
 {
     ItemType type;
     time_t   modTime; //number of seconds since Jan. 1st 1970 UTC
     uint64_t fileSize; //unit: bytes!
     AFS::FingerPrint filePrint;
+    uint32_t linkCount;
+    uint64_t deviceId = 0; //symlink targets only
 };
 FsItemDetails getItemDetails(const Zstring& itemPath) //throw FileError
 {
@@ -188,7 +119,8 @@ FsItemDetails getItemDetails(const Zstring& itemPath) //throw FileError
             /**/ (S_ISDIR(itemInfo.st_mode) ? ItemType::folder : ItemType::file), //a file or named pipe, etc. => dont't check using S_ISREG(): see comment in file_traverser.cpp
             itemInfo.st_mtime,
             makeUnsigned(itemInfo.st_size),
-            getFileFingerprint(itemInfo.st_ino)};
+            getFileFingerprint(itemInfo.st_ino),
+            static_cast<uint32_t>(itemInfo.st_nlink)};
 }
 
 
@@ -202,11 +134,12 @@ FsItemDetails getSymlinkTargetDetails(const Zstring& linkPath) //throw FileError
 
         const ItemType targetType = S_ISDIR(itemInfo.st_mode) ? ItemType::folder : ItemType::file;
 
-        const AFS::FingerPrint filePrint = targetType == ItemType::folder ? 0 : getFileFingerprint(itemInfo.st_ino);
         return {targetType,
                 itemInfo.st_mtime,
                 makeUnsigned(itemInfo.st_size),
-                filePrint};
+                getFileFingerprint(itemInfo.st_ino), //folders: identity of the link target, see DirCallback::onFolder()
+                static_cast<uint32_t>(itemInfo.st_nlink),
+                static_cast<uint64_t>(itemInfo.st_dev)};
     }
     catch (const SysError& e)
     {
@@ -221,7 +154,7 @@ public:
     SingleFolderTraverser(const std::vector<std::pair<Zstring, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/)
     {
         for (const auto& [folderPath, cb] : workload)
-            workload_.push_back({folderPath, cb});
+            workload_.push_back({folderPath, cb, isRotationalDevice(folderPath)});
 
         while (!workload_.empty())
         {
@@ -230,7 +163,7 @@ public:
 
             tryReportingDirError([&] //throw X
             {
-                traverseWithException(wi.dirPath, *wi.cb); //throw FileError, X
+                traverseWithException(wi.dirPath, wi.inodeOrder, *wi.cb); //throw FileError, X
             }, *wi.cb);
         }
     }
@@ -239,14 +172,22 @@ private:
     SingleFolderTraverser           (const SingleFolderTraverser&) = delete;
     SingleFolderTraverser& operator=(const SingleFolderTraverser&) = delete;
 
-    void traverseWithException(const Zstring& dirPath, AFS::TraverserCallback& cb) //throw FileError, X
+    void traverseWithException(const Zstring& dirPath, bool inodeOrder, AFS::TraverserCallback& cb) //throw FileError, X
     {
-        for (const auto& [itemName] : getDirContentFlat(dirPath)) //throw FileError
+        for (const DirEntryDetails& de : getDirContentDetailed(dirPath, true /*statFiles*/, true /*statSymlinks*/, inodeOrder)) //throw FileError
         {
+            const Zstring& itemName = de.itemName;
             const Zstring itemPath = appendSeparator(dirPath) + itemName;
 
             FsItemDetails itemDetails = {};
-            if (!tryReportingItemError([&] //throw X
+            if (de.haveDetails) //statx() relative to directory handle succeeded (or not needed for folders)
+                itemDetails = {de.type == DirEntryDetails::Type::symlink ? ItemType::symlink :
+                               de.type == DirEntryDetails::Type::folder  ? ItemType::folder : ItemType::file,
+                               de.modTime,
+                               de.fileSize,
+                               getFileFingerprint(de.fileIndex),
+                               de.linkCount};
+            else if (!tryReportingItemError([&] //throw X
         {
             itemDetails = getItemDetails(itemPath); //throw FileError
             }, cb, itemName))
@@ -255,12 +196,12 @@ private:
             switch (itemDetails.type)
             {
                 case ItemType::file:
-                    cb.onFile({itemName, itemDetails.fileSize, itemDetails.modTime, itemDetails.filePrint, false /*isFollowedSymlink*/}); //throw X
+                    cb.onFile({itemName, itemDetails.fileSize, itemDetails.modTime, itemDetails.filePrint, false /*isFollowedSymlink*/, itemDetails.linkCount}); //throw X
                     break;
 
                 case ItemType::folder:
                     if (std::shared_ptr<AFS::TraverserCallback> cbSub = cb.onFolder({itemName, false /*isFollowedSymlink*/})) //throw X
-                        workload_.push_back({itemPath, std::move(cbSub)});
+                        workload_.push_back({itemPath, std::move(cbSub), inodeOrder}); //same device (except for mount points: obscure)
                     break;
 
                 case ItemType::symlink:
@@ -277,11 +218,11 @@ private:
 
                             if (targetDetails.type == ItemType::folder)
                             {
-                                if (std::shared_ptr<AFS::TraverserCallback> cbSub = cb.onFolder({itemName, true /*isFollowedSymlink*/})) //throw X
-                                    workload_.push_back({itemPath, std::move(cbSub)}); //symlink may link to different volume!
+                                if (std::shared_ptr<AFS::TraverserCallback> cbSub = cb.onFolder({itemName, true /*isFollowedSymlink*/, targetDetails.deviceId, targetDetails.filePrint})) //throw X
+                                    workload_.push_back({itemPath, std::move(cbSub), isRotationalDevice(itemPath)}); //symlink may link to different volume!
                             }
                             else //a file or named pipe, etc.
-                                cb.onFile({itemName, targetDetails.fileSize, targetDetails.modTime, targetDetails.filePrint, true /*isFollowedSymlink*/}); //throw X
+                                cb.onFile({itemName, targetDetails.fileSize, targetDetails.modTime, targetDetails.filePrint, true /*isFollowedSymlink*/, targetDetails.linkCount}); //throw X
                         }
                         break;
 
@@ -297,6 +238,7 @@ private:
     {
         Zstring dirPath;
         std::shared_ptr<AFS::TraverserCallback> cb;
+        bool inodeOrder = false; //rotational media
     };
     std::vector<WorkItem> workload_;
 };
@@ -342,6 +284,9 @@ struct InputStreamNative : public AFS::InputStream
         catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(fi_.getFilePath())), e.toString()); }
     }
 
+    bool supportsReadAt() const override { return true; }
+    size_t readAt(uint64_t offset, void* buffer, size_t bytesToRead) override { return fi_.readAt(offset, buffer, bytesToRead); } //throw FileError, X
+
 private:
     FileInput fi_;
 };
@@ -361,6 +306,13 @@ struct OutputStreamNative : public AFS::OutputStreamImpl
             fo_.reserveSpace(*streamSize); //throw FileError
     }
 
+    //resumed copy: continue at the end of file
+    OutputStreamNative(FileBase::FileHandle handle, const Zstring& filePath,
+                       std::optional<time_t> modTime,
+                       const IoCallback& notifyUnbufferedIO /*throw X*/) :
+        fo_(handle, filePath, notifyUnbufferedIO), //pass ownership
+        modTime_(modTime) {}
+
     void write(const void* buffer, size_t bytesToWrite) override { fo_.write(buffer, bytesToWrite); } //throw FileError, X
 
     AFS::FinalizeResult finalize() override //throw FileError, X
@@ -393,6 +345,21 @@ private:
     const std::optional<time_t> modTime_;
 };
 
+
+FileBase::FileHandle openHandleForAppend(const Zstring& filePath) //throw FileError
+{
+    const int fdFile = ::open(filePath.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fdFile == -1)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(filePath)), "open");
+    ZEN_ON_SCOPE_FAIL(::close(fdFile));
+
+    //no O_APPEND: FileOutput needs the stream position, e.g. for io_uring and cache drop-behind
+    if (::lseek(fdFile, 0, SEEK_END) < 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(filePath)), "lseek");
+
+    return fdFile; //pass ownership
+}
+
 //===========================================================================================================================
 
 class NativeFileSystem : public AbstractFileSystem
@@ -420,6 +387,24 @@ private:
         return compareNativePath(rootPath_, static_cast<const NativeFileSystem&>(afsRhs).rootPath_);
     }
 
+    bool isMoveCompatibleSameAfsType(const AbstractFileSystem& afsRhs) const override //noexcept
+    {
+        const Zstring& rootPathRhs = static_cast<const NativeFileSystem&>(afsRhs).rootPath_;
+        if (compareNativePath(rootPath_, rootPathRhs) == std::weak_ordering::equivalent)
+            return true;
+
+        if (isNullFileSystem() || rootPathRhs.empty())
+            return false;
+
+        //different root paths can still be the same file system: e.g. "/" and "/mnt/data" if "data" is just a folder
+        //=> same st_dev: try rename(); bind mounts of one file system fail with EXDEV => ErrorMoveUnsupported => caller falls back to copy + delete
+        struct stat rootInfoLhs = {};
+        struct stat rootInfoRhs = {};
+        return ::stat(rootPath_   .c_str(), &rootInfoLhs) == 0 &&
+               ::stat(rootPathRhs.c_str(), &rootInfoRhs) == 0 &&
+               rootInfoLhs.st_dev == rootInfoRhs.st_dev;
+    }
+
     //----------------------------------------------------------------------------------------------------------------
     ItemType getItemType(const AfsPath& afsPath) const override //throw FileError
     {
@@ -473,8 +458,15 @@ private:
                                        const std::function<void (const std::wstring& displayPath)>& onBeforeFileDeletion /*throw X*/, //optional
                                        const std::function<void (const std::wstring& displayPath)>& onBeforeFolderDeletion) const override //one call for each object!
     {
-        //default implementation: folder traversal
-        AFS::removeFolderIfExistsRecursion(afsPath, onBeforeFileDeletion, onBeforeFolderDeletion); //throw FileError, X
+        initComForThread(); //throw FileError
+
+        //no error situation if directory is not existing! manual deletion relies on it!
+        if (itemStillExists(afsPath)) //throw FileError
+            zen::removeDirectoryPlainRecursion(getNativePath(afsPath), //throw FileError, X
+            [&](const Zstring& itemPath) { if (onBeforeFileDeletion) onBeforeFileDeletion(utfTo<std::wstring>(itemPath)); }, //throw X
+            [&](const Zstring& folderPath) { if (onBeforeFolderDeletion) onBeforeFolderDeletion(utfTo<std::wstring>(folderPath)); }); //
+        else //even if the folder did not exist anymore, significant I/O work was done => report
+            if (onBeforeFolderDeletion) onBeforeFolderDeletion(getDisplayPath(afsPath)); //throw X
     }
 
     //----------------------------------------------------------------------------------------------------------------
@@ -526,6 +518,26 @@ private:
         return std::make_unique<OutputStreamNative>(getNativePath(afsPath), streamSize, modTime, notifyUnbufferedIO); //throw FileError
     }
 
+    std::optional<uint64_t> getPartialFileSize(const AfsPath& afsPath) const override //noexcept
+    {
+        try
+        {
+            initComForThread(); //throw FileError
+            return getFileSize(getNativePath(afsPath)); //throw FileError
+        }
+        catch (FileError&) { return {}; } //not existing: most likely case
+    }
+
+    std::unique_ptr<OutputStreamImpl> getOutputStreamAppend(const AfsPath& afsPath, //throw FileError
+                                                            std::optional<uint64_t> bytesToAppend,
+                                                            std::optional<time_t> modTime,
+                                                            const IoCallback& notifyUnbufferedIO /*throw X*/) const override
+    {
+        initComForThread(); //throw FileError
+        const Zstring filePath = getNativePath(afsPath);
+        return std::make_unique<OutputStreamNative>(openHandleForAppend(filePath), filePath, modTime, notifyUnbufferedIO); //throw FileError
+    }
+
     //----------------------------------------------------------------------------------------------------------------
     void traverseFolderRecursive(const TraverserWorkload& workload /*throw X*/, size_t parallelOps) const override
     {
@@ -549,15 +561,8 @@ private:
 
         initComForThread(); //throw FileError
 
-        const zen::FileCopyResult nativeResult = copyNewFile(getNativePath(afsSource), nativePathTarget, notifyUnbufferedIO); //throw FileError, ErrorTargetExisting, ErrorFileLocked, X
-
-        //at this point we know we created a new file, so it's fine to delete it for cleanup!
-        ZEN_ON_SCOPE_FAIL(try { zen::removeFilePlain(nativePathTarget); }
-        catch (FileError&) {});
-
-        if (copyFilePermissions)
-            copyItemPermissions(getNativePath(afsSource), nativePathTarget, ProcSymlink::follow); //throw FileError
-
+        const zen::FileCopyResult nativeResult = copyNewFile(getNativePath(afsSource), nativePathTarget, copyFilePermissions, //throw FileError, ErrorTargetExisting, ErrorFileLocked, X
+                                                             notifyUnbufferedIO);
         FileCopyResult result;
         result.fileSize = nativeResult.fileSize;
         //caveat: modTime will be incorrect for file systems with imprecise file times, e.g. see FAT_FILE_TIME_PRECISION_SEC
@@ -568,6 +573,51 @@ private:
         return result;
     }
 
+    std::optional<FileCopyResult> updateFileDeltaAsTarget(const AfsPath& afsTarget, const std::optional<AfsPath>& afsTargetTmp, //throw FileError, ErrorFileLocked, X
+                                                          const AbstractPath& apSource, const StreamAttributes& attrSource, uint64_t targetSize,
+                                                          const std::optional<EqualPrefix>& equalPrefix,
+                                                          bool calcContentHash, const IoCallback& notifyUnbufferedIO /*throw X*/) const override
+    {
+        //caveat: typeid returns static type for pointers, dynamic type for references!!!
+        if (typeid(apSource.afsDevice.ref()) != typeid(*this) ||
+            attrSource.fileSize < NATIVE_DELTA_MIN_SIZE ||
+            targetSize          < NATIVE_DELTA_MIN_SIZE)
+            return {};
+
+        const Zstring nativePathSource = static_cast<const NativeFileSystem&>(apSource.afsDevice.ref()).getNativePath(apSource.afsPath);
+
+        initComForThread(); //throw FileError
+
+        std::optional<zen::EqualPrefixHint> equalPrefixHint;
+        if (equalPrefix && attrSource.fileSize == targetSize)
+            equalPrefixHint = zen::EqualPrefixHint{equalPrefix->byteCount, targetSize, attrSource.modTime, equalPrefix->targetModTime};
+
+        //no contentHash: same as copyFileForSameAfsType()
+        const std::optional<zen::FileCopyResult> nativeResult = zen::updateFileDelta(nativePathSource, getNativePath(afsTarget), //throw FileError, ErrorFileLocked, X
+                                                                                     afsTargetTmp ? getNativePath(*afsTargetTmp) : Zstring(), equalPrefixHint, notifyUnbufferedIO);
+        if (!nativeResult)
+            return {};
+
+        FileCopyResult result;
+        result.fileSize = nativeResult->fileSize;
+        result.modTime = nativeFileTimeToTimeT(nativeResult->sourceModTime);
+        result.sourceFilePrint = getFileFingerprint(nativeResult->sourceFileIdx);
+        result.targetFilePrint = getFileFingerprint(nativeResult->targetFileIdx);
+        result.errorModTime = nativeResult->errorModTime;
+        return result;
+    }
+
+    //already existing: fail
+    bool createHardLinkForSameAfsType(const AfsPath& afsExisting, const AbstractPath& apNew) const override //throw FileError
+    {
+        initComForThread(); //throw FileError
+
+        const Zstring& existingPath = getNativePath(afsExisting);
+        const Zstring& newPath = static_cast<const NativeFileSystem&>(apNew.afsDevice.ref()).getNativePath(apNew.afsPath);
+
+        return tryCreateHardLink(existingPath, newPath); //throw FileError, ErrorTargetExisting
+    }
+
     //symlink handling: follow
     //already existing: fail
     void copyNewFolderForSameAfsType(const AfsPath& afsSource, const AbstractPath& apTarget, bool copyFilePermissions) const override //throw FileError
@@ -612,7 +662,7 @@ private:
     {
         //perf test: detecting different volumes by path is ~30 times faster than having ::MoveFileEx() fail with ERROR_NOT_SAME_DEVICE (6µs vs 190µs)
         //=> maybe we can even save some actual I/O in some cases?
-        if (compareDeviceSameAfsType(pathTo.afsDevice.ref()) != std::weak_ordering::equivalent)
+        if (!isMoveCompatibleSameAfsType(pathTo.afsDevice.ref()))
             throw ErrorMoveUnsupported(replaceCpy(replaceCpy(_("Cannot move file %x to %y."),
                                                              L"%x", L'\n' + fmtPath(getDisplayPath(pathFrom))),
                                                   L"%y", L'\n' + fmtPath(AFS::getDisplayPath(pathTo))),
@@ -622,6 +672,22 @@ private:
         zen::moveAndRenameItem(getNativePath(pathFrom), nativePathTarget, false /*replaceExisting*/); //throw FileError, ErrorTargetExisting, ErrorMoveUnsupported
     }
 
+    bool tryMoveAndReplaceFileForSameAfsType(const AfsPath& pathFrom, const AbstractPath& pathTo) const override //throw FileError
+    {
+        if (!isMoveCompatibleSameAfsType(pathTo.afsDevice.ref()))
+            return false;
+
+        initComForThread(); //throw FileError
+        const Zstring nativePathTarget = static_cast<const NativeFileSystem&>(pathTo.afsDevice.ref()).getNativePath(pathTo.afsPath);
+        try
+        {
+            //rename() replaces an existing target atomically => no delete + no "already existing" check needed
+            zen::moveAndRenameItem(getNativePath(pathFrom), nativePathTarget, true /*replaceExisting*/); //throw FileError, (ErrorTargetExisting), ErrorMoveUnsupported
+        }
+        catch (ErrorMoveUnsupported&) { return false; } //EXDEV: e.g. target is a mount point
+        return true;
+    }
+
     bool supportsPermissions(const AfsPath& afsPath) const override //throw FileError
     {
         initComForThread(); //throw FileError
@@ -657,7 +723,11 @@ private:
 
     int getAccessTimeout() const override { return 0; } //returns "0" if no timeout in force
 
+    void prepareSessions(size_t sessionCount) const override {} //noexcept
+
     bool hasNativeTransactionalCopy() const override { return false; }
+
+    bool hasServerSideCopy() const override { return true; } //local copy (or reflink)
     //----------------------------------------------------------------------------------------------------------------
 
     int64_t getFreeDiskSpace(const AfsPath& afsPath) const override //throw FileError, returns < 0 if not available
@@ -666,6 +736,19 @@ private:
         return zen::getFreeDiskSpace(getNativePath(afsPath)); //throw FileError
     }
 
+    std::optional<std::vector<Zstring>> getChangesSinceCheckpoint(const AfsPath& folderPath, const std::string& checkpointId) const override //throw FileError
+    {
+        if (!isSnapshotChangeSourceEnabled())
+            return {};
+        return getSnapshotChanges(getNativePath(folderPath), checkpointId); //throw FileError
+    }
+
+    void commitChangeCheckpoint(const AfsPath& folderPath, const std::string& checkpointId) const override //throw FileError
+    {
+        if (isSnapshotChangeSourceEnabled())
+            commitSnapshotCheckpoint(getNativePath(folderPath), checkpointId); //throw FileError
+    }
+
     bool supportsRecycleBin(const AfsPath& afsPath) const override //throw FileError
     {
         return true; //truth be told: no idea!!!
@@ -17,6 +17,7 @@
 #include "init_curl_libssh2.h"
 #include "ftp_common.h"
 #include "abstract_impl.h"
+#include "listing_cache.h"
     #include <poll.h>
 
 using namespace zen;
@@ -51,6 +52,8 @@ const Zchar sftpPrefix[] = Zstr("sftp:");
 
 constexpr std::chrono::seconds SFTP_SESSION_MAX_IDLE_TIME           (20);
 constexpr std::chrono::seconds SFTP_SESSION_CLEANUP_INTERVAL         (4); //facilitate default of 5-seconds delay for error retry
+constexpr std::chrono::seconds SFTP_SESSION_KEEP_WARM_TIME          (60); //after last prepareSessions() hint: e.g. user reviewing comparison result before sync
+const size_t SFTP_SESSION_WARM_UP_PARALLEL_MAX = 16;
 constexpr std::chrono::seconds SFTP_CHANNEL_LIMIT_DETECTION_TIME_OUT(30);
 
 //permissions for new files: rw- rw- rw- [0666] => consider umask! (e.g. 0022 for ffs.org)
@@ -99,6 +102,24 @@ SFTP_OPTIMAL_BLOCK_SIZE_READ:              SFTP_OPTIMAL_BLOCK_SIZE_WRITE:
     DSL maximum download speed: 5,96 MB/s      DSL maximum upload speed: 1220 KB/s
 
 => libssh2_sftp_read/libssh2_sftp_write may take quite long for 16x and larger => use smallest multiple that fills bandwidth!            */
+
+//high-latency links: grow the number of requests in flight per file handle up to the bandwidth-delay product (see SftpTransferWindow)
+//=> limited by the SSH channel windows negotiated with the server (see SftpTransferLimits): OpenSSH, libssh2: 2 MB => ~64 requests
+const size_t SFTP_PIPELINE_REQUESTS_MAX = 256; //upper bound for servers with large windows (e.g. HPN-SSH)
+
+//per SSH session: all SFTP channels are opened against the same server
+struct SftpTransferLimits
+{
+    size_t readRequestsMax  = 64; //requests in flight per file handle
+    size_t writeRequestsMax = 64; //
+};
+
+//"zlib=auto": libssh2 compresses on the calling thread => CPU-bound transfers mean zlib is the bottleneck (fast LAN), otherwise the link is (slow WAN)
+const uint64_t SFTP_AUTO_ZLIB_SAMPLE_BYTES = 8 * 1024 * 1024; //transferred with compression before deciding
+const double   SFTP_AUTO_ZLIB_CPU_SHARE_MAX = 0.5;             //CPU time / wall time during libssh2_sftp_read/write
+
+//hardware-accelerated AEAD ciphers first; remaining ciphers supported by libssh2 keep their default order
+const char* const SFTP_AUTO_CIPHERS_PREFERRED[] = {"aes128-gcm@openssh.com", "chacha20-poly1305@openssh.com", "aes256-gcm@openssh.com"};
 }
 
 
@@ -123,8 +144,8 @@ std::weak_ordering operator<=>(const SshSessionId& lhs, const SshSessionId& rhs)
     const int portLhs = getEffectivePort(lhs.port);
     const int portRhs = getEffectivePort(rhs.port);
 
-    if (const std::strong_ordering cmp = std::tie(portLhs, lhs.username, lhs.authType, lhs.allowZlib) <=> //username: case sensitive!
-                                         std::tie(portRhs, rhs.username, rhs.authType, rhs.allowZlib);
+    if (const std::strong_ordering cmp = std::tie(portLhs, lhs.username, lhs.authType, lhs.allowZlib, lhs.autoZlib, lhs.socketBufferBytes, lhs.socketNotSentLowAt, lhs.congestionControl) <=> //username: case sensitive!
+                                         std::tie(portRhs, rhs.username, rhs.authType, rhs.allowZlib, rhs.autoZlib, rhs.socketBufferBytes, rhs.socketNotSentLowAt, rhs.congestionControl);
         cmp != std::strong_ordering::equal)
         return cmp;
 
@@ -194,6 +215,72 @@ constinit Global<UniSessionCounter> globalSftpSessionCount;
 GLOBAL_RUN_ONCE(globalSftpSessionCount.set(createUniSessionCounter()));
 
 
+std::chrono::nanoseconds getThreadCpuTime() //noexcept
+{
+    timespec ts = {};
+    if (::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+        return {};
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+
+
+//decide on compression per SSH login (zlib=auto): sample the first transfers with compression, then keep it for new sessions unless CPU-bound
+class SftpCompressionTuner
+{
+public:
+    bool useCompression(const SshSessionId& sessionId)
+    {
+        assert(sessionId.autoZlib);
+        return linkStats_.access([&](LinkStatsById& statsById)
+        {
+            auto it = statsById.find(sessionId);
+            return it == statsById.end() || !it->second.useZlib || *it->second.useZlib; //sampling phase: compress
+        });
+    }
+
+    void reportTransfer(const SshSessionId& sessionId, uint64_t bytes, std::chrono::nanoseconds wallTime, std::chrono::nanoseconds cpuTime)
+    {
+        assert(sessionId.autoZlib);
+        linkStats_.access([&](LinkStatsById& statsById)
+        {
+            LinkStats& stats = statsById[sessionId];
+            if (!stats.useZlib)
+            {
+                stats.bytes    += bytes;
+                stats.wallTime += wallTime;
+                stats.cpuTime  += cpuTime;
+
+                if (stats.bytes >= SFTP_AUTO_ZLIB_SAMPLE_BYTES && stats.wallTime.count() > 0)
+                    stats.useZlib = static_cast<double>(stats.cpuTime.count()) / stats.wallTime.count() < SFTP_AUTO_ZLIB_CPU_SHARE_MAX;
+            }
+        });
+    }
+
+private:
+    struct LinkStats
+    {
+        uint64_t bytes = 0;
+        std::chrono::nanoseconds wallTime{};
+        std::chrono::nanoseconds cpuTime{};
+        std::optional<bool> useZlib; //decision made
+    };
+    using LinkStatsById = std::map<SshSessionId, LinkStats>;
+
+    Protected<LinkStatsById> linkStats_;
+};
+
+constinit Global<SftpCompressionTuner> globalSftpCompressionTuner;
+GLOBAL_RUN_ONCE(globalSftpCompressionTuner.set(std::make_unique<SftpCompressionTuner>()));
+
+
+void reportSftpTransfer(const SshSessionId& sessionId, uint64_t bytes, std::chrono::steady_clock::time_point startTime, std::chrono::nanoseconds startCpuTime)
+{
+    if (sessionId.autoZlib)
+        if (const std::shared_ptr<SftpCompressionTuner> tuner = globalSftpCompressionTuner.get())
+            tuner->reportTransfer(sessionId, bytes, std::chrono::steady_clock::now() - startTime, getThreadCpuTime() - startCpuTime);
+}
+
+
 class SshSession
 {
 public:
@@ -205,7 +292,12 @@ public:
 
         const Zstring& serviceName = numberTo<Zstring>(getEffectivePort(sessionId_.port));
 
-        socket_ = std::make_unique<Socket>(sessionId_.server, serviceName); //throw SysError
+        socket_ = std::make_unique<Socket>(sessionId_.server, serviceName, SocketTuning
+        {
+            .bufferBytes       = sessionId_.socketBufferBytes,
+            .notSentLowAtBytes = sessionId_.socketNotSentLowAt,
+            .congestionControl = utfTo<std::string>(sessionId_.congestionControl),
+        }); //throw SysError
 
         sshSession_ = ::libssh2_session_init();
         if (!sshSession_) //does not set ssh last error; source: only memory allocation may fail
@@ -213,11 +305,21 @@ public:
 
         //if zlib compression causes trouble, make it a user setting: https://freefilesync.org/forum/viewtopic.php?t=6663
         //=> surprise: it IS causing trouble: slow-down in local syncs: https://freefilesync.org/forum/viewtopic.php?t=7244#p24250
-        if (sessionId.allowZlib)
+        const bool useZlib = [&]
+        {
+            if (sessionId.autoZlib)
+                if (const std::shared_ptr<SftpCompressionTuner> tuner = globalSftpCompressionTuner.get())
+                    return tuner->useCompression(sessionId);
+            return sessionId.allowZlib;
+        }();
+        if (useZlib)
             if (const int rc = ::libssh2_session_flag(sshSession_, LIBSSH2_FLAG_COMPRESS, 1);
                 rc != 0) //does not set SSH last error
                 throw SysError(formatSystemError("libssh2_session_flag", formatSshStatusCode(rc), L""));
 
+        if (sessionId.autoZlib)
+            preferFastCiphers(); //throw SysError
+
         ::libssh2_session_set_blocking(sshSession_, 1);
 
         //we don't consider the timeout part of the session when it comes to reuse! but we already require it during initialization
@@ -422,6 +524,8 @@ public:
 
     const SshSessionId& getSessionId() const { return sessionId_; }
 
+    const SftpTransferLimits& getTransferLimits() const { return transferLimits_; }
+
     bool isHealthy() const
     {
         for (const SftpChannelInfo& ci : sftpChannels_)
@@ -442,6 +546,22 @@ public:
 
     void markAsCorrupted() { possiblyCorrupted_ = true; }
 
+    //prevent idle session from timing out (both server-side and isHealthy())
+    void keepAlive() //noexcept
+    {
+        assert(isHealthy());
+        if (std::chrono::steady_clock::now() > lastSuccessfulUseTime_ + SFTP_SESSION_MAX_IDLE_TIME / 2)
+        {
+            ::libssh2_keepalive_config(sshSession_, 0 /*want_reply*/, 1 /*interval [sec]*/);
+
+            int secondsToNext = 0;
+            if (::libssh2_keepalive_send(sshSession_, &secondsToNext) != 0)
+                possiblyCorrupted_ = true;
+            else
+                lastSuccessfulUseTime_ = std::chrono::steady_clock::now();
+        }
+    }
+
     struct Details
     {
         LIBSSH2_SESSION* sshSession;
@@ -596,6 +716,9 @@ public:
                             return std::min(::libssh2_session_last_errno(sd.sshSession), LIBSSH2_ERROR_SOCKET_NONE);
                         //just in case libssh2 failed to properly set last error; e.g. https://github.com/libssh2/libssh2/pull/123
 
+                        if (pendingSessions[pos]->sftpChannels_.empty())
+                            pendingSessions[pos]->transferLimits_ = queryTransferLimits(sftpChannelNew);
+
                         pendingSessions[pos]->sftpChannels_.emplace_back(sftpChannelNew);
                         return LIBSSH2_ERROR_NONE;
                     }, timeoutSec)) //throw SysError, FatalSshError
@@ -631,6 +754,40 @@ private:
     SshSession           (const SshSession&) = delete;
     SshSession& operator=(const SshSession&) = delete;
 
+    void preferFastCiphers() //throw SysError; call before handshake
+    {
+        for (const int methodType : {LIBSSH2_METHOD_CRYPT_CS, LIBSSH2_METHOD_CRYPT_SC})
+        {
+            const char** algs = nullptr;
+            const int algCount = ::libssh2_session_supported_algs(sshSession_, methodType, &algs);
+            if (algCount < 0) //does not set SSH last error
+                throw SysError(formatSystemError("libssh2_session_supported_algs", formatSshStatusCode(algCount), L""));
+            ZEN_ON_SCOPE_EXIT(if (algs) ::libssh2_free(sshSession_, algs));
+
+            const std::vector<std::string_view> supported(algs, algs + algCount);
+            std::vector<std::string_view> prefs;
+
+            for (const char* cipher : SFTP_AUTO_CIPHERS_PREFERRED)
+                if (std::find(supported.begin(), supported.end(), cipher) != supported.end())
+                    prefs.push_back(cipher);
+
+            if (!prefs.empty()) //else: keep libssh2 defaults
+            {
+                for (const std::string_view cipher : supported)
+                    if (std::find(prefs.begin(), prefs.end(), cipher) == prefs.end())
+                        prefs.push_back(cipher);
+
+                std::string prefList;
+                for (const std::string_view cipher : prefs)
+                    prefList += std::string(prefList.empty() ? "" : ",") + std::string(cipher);
+
+                if (const int rc = ::libssh2_session_method_pref(sshSession_, methodType, prefList.c_str());
+                    rc != 0)
+                    throw SysError(formatLastSshError("libssh2_session_method_pref", nullptr));
+            }
+        }
+    }
+
     void cleanup() //attention: may block heavily after error!
     {
         for (SftpChannelInfo& ci : sftpChannels_)
@@ -672,6 +829,28 @@ private:
         std::string functionName;
     };
 
+    /*  "limits@openssh.com" (max read/write length) is not available: libssh2 has no generic SFTP extension support
+        and splits requests at MAX_SFTP_READ_SIZE/MAX_SFTP_OUTGOING_SIZE anyway
+        => what bounds the pipeline instead: the channel windows; no extra round trip: exchanged during channel open  */
+    static SftpTransferLimits queryTransferLimits(LIBSSH2_SFTP* sftpChannel) //noexcept
+    {
+        LIBSSH2_CHANNEL* channel = ::libssh2_sftp_get_channel(sftpChannel);
+
+        unsigned long readWindowInit = 0; //our receive window: download
+        ::libssh2_channel_window_read_ex(channel, nullptr /*read_avail*/, &readWindowInit);
+
+        unsigned long writeWindowInit = 0; //server's receive window: upload
+        ::libssh2_channel_window_write_ex(channel, &writeWindowInit);
+
+        const size_t writeRequestSize = MAX_SFTP_OUTGOING_SIZE + 300; //+ SSH_FXP_WRITE header incl. file handle (<= 256 bytes)
+        const SftpTransferLimits defaults;
+        return
+        {
+            .readRequestsMax  = readWindowInit  == 0 ? defaults.readRequestsMax  : std::clamp<size_t>(readWindowInit  / MAX_SFTP_READ_SIZE, 1, SFTP_PIPELINE_REQUESTS_MAX),
+            .writeRequestsMax = writeWindowInit == 0 ? defaults.writeRequestsMax : std::clamp<size_t>(writeWindowInit / writeRequestSize,   1, SFTP_PIPELINE_REQUESTS_MAX),
+        };
+    }
+
     struct SftpChannelInfo
     {
         explicit SftpChannelInfo(LIBSSH2_SFTP* sc) : sftpChannel(sc) {}
@@ -683,6 +862,7 @@ private:
     std::unique_ptr<Socket> socket_; //*bound* after constructor has run
     LIBSSH2_SESSION* sshSession_ = nullptr;
     std::vector<SftpChannelInfo> sftpChannels_;
+    SftpTransferLimits transferLimits_; //determined with first SFTP channel
     bool possiblyCorrupted_ = false;
 
     SftpNonBlockInfo nbInfo_; //for SSH session, e.g. libssh2_sftp_init()
@@ -726,6 +906,8 @@ public:
 
         //bool isHealthy() const { return session_->isHealthy(); }
 
+        const SftpTransferLimits& getTransferLimits() const { return session_->getTransferLimits(); }
+
         void executeBlocking(const char* functionName, const std::function<int(const SshSession::Details& sd)>& sftpCommand /*noexcept!*/) //throw SysError, FatalSshError
         {
             assert(threadId_ == std::this_thread::get_id());
@@ -855,6 +1037,42 @@ public:
     }
 
 
+    //open missing sessions in parallel + let session cleaner keep them alive for a while
+    void prepareSessions(const SftpLogin& login, size_t sessionCount) //noexcept
+    {
+        Protected<IdleSshSessions>& sessionStore = getSessionStore(login);
+
+        size_t sessionsMissing = 0;
+        sessionStore.access([&](IdleSshSessions& sessions)
+        {
+            sessions.keepWarmCount = sessionCount;
+            sessions.keepWarmUntil = std::chrono::steady_clock::now() + SFTP_SESSION_KEEP_WARM_TIME;
+
+            const size_t sessionsAvailable = sessions.idleSshSessions.size() + sessions.sessionsWarmingUp +
+            std::count_if(sessions.sshSessionsWithThreadAffinity.begin(), sessions.sshSessionsWithThreadAffinity.end(), [](const auto& v) { return !v.second.expired(); });
+
+            if (sessionCount > sessionsAvailable)
+                sessionsMissing = sessionCount - sessionsAvailable;
+            sessions.sessionsWarmingUp += sessionsMissing;
+        });
+
+        for (size_t i = 0; i < sessionsMissing; ++i)
+            sessionWarmer_.run([login, &sessionStore]
+        {
+            ZEN_ON_SCOPE_EXIT(sessionStore.access([](IdleSshSessions& sessions) { --sessions.sessionsWarmingUp; }));
+            try
+            {
+                auto sshSession = std::make_unique<SshSession>(login, login.timeoutSec); //throw SysError
+                SshSession::addSftpChannel({sshSession.get()}, login.timeoutSec); //throw SysError, FatalSshError
+
+                sessionStore.access([&](IdleSshSessions& sessions) { sessions.idleSshSessions.push_back(std::move(sshSession)); });
+            }
+            catch (SysError&) {} //
+            catch (FatalSshError&) {} //just a hint: errors are reported when the session is actually needed
+        });
+    }
+
+
     std::unique_ptr<SshSessionExclusive> getExclusiveSession(const SftpLogin& login) //throw SysError
     {
         Protected<IdleSshSessions>& sessionStore = getSessionStore(login);
@@ -922,6 +1140,17 @@ private:
                 for (bool done = false; !done;)
                     sessionStore->access([&](IdleSshSessions& sessions)
                 {
+                    if (std::chrono::steady_clock::now() < sessions.keepWarmUntil)
+                    {
+                        size_t keptWarm = 0;
+                        for (std::unique_ptr<SshSession>& sshSession : sessions.idleSshSessions)
+                            if (keptWarm < sessions.keepWarmCount && sshSession->isHealthy())
+                            {
+                                sshSession->keepAlive(); //noexcept
+                                ++keptWarm;
+                            }
+                    }
+
                     for (std::unique_ptr<SshSession>& sshSession : sessions.idleSshSessions)
                         if (!sshSession->isHealthy()) //!isHealthy() sessions are destroyed after use => in this context this means they have been idle for too long
                         {
@@ -940,12 +1169,17 @@ private:
     {
         std::vector<std::unique_ptr<SshSession>>                   idleSshSessions; //extract *temporarily* from this list during use
         std::map<std::thread::id, std::weak_ptr<SshSessionShared>> sshSessionsWithThreadAffinity; //Win32 thread IDs may be REUSED! still, shouldn't be a problem...
+
+        size_t sessionsWarmingUp = 0;
+        size_t keepWarmCount = 0;
+        std::chrono::steady_clock::time_point keepWarmUntil;
     };
 
     using GlobalSshSessions = std::map<SshSessionId, Protected<IdleSshSessions>>;
 
     Protected<GlobalSshSessions> globalSessionStore_;
     InterruptibleThread sessionCleaner_;
+    ThreadGroup<std::function<void()>> sessionWarmer_{SFTP_SESSION_WARM_UP_PARALLEL_MAX, Zstr("Session Warm-up[SFTP]")}; //accesses globalSessionStore_ => destroy first
 };
 
 //--------------------------------------------------------------------------------------
@@ -991,6 +1225,13 @@ std::unique_ptr<SftpSessionManager::SshSessionExclusive> getExclusiveSftpSession
 }
 
 
+void prepareSftpSessions(const SftpLogin& login, size_t sessionCount) //noexcept
+{
+    if (const std::shared_ptr<SftpSessionManager> mgr = globalSftpSessionManager.get())
+        mgr->prepareSessions(login, sessionCount); //noexcept
+}
+
+
 void runSftpCommand(const SftpLogin& login, const char* functionName,
                     const std::function<int(const SshSession::Details& sd)>& sftpCommand /*noexcept!*/) //throw SysError
 {
@@ -1016,6 +1257,37 @@ struct SftpItem
     Zstring         itemName;
     SftpItemDetails details;
 };
+//returns std::nullopt for "." and ".."
+std::optional<SftpItem> makeSftpItem(const SftpLogin& login, const AfsPath& dirPath, const std::string_view sftpItemName, const LIBSSH2_SFTP_ATTRIBUTES& attribs) //throw FileError
+{
+    if (sftpItemName == "." || sftpItemName == "..") //check needed for SFTP, too!
+        return std::nullopt;
+
+    const Zstring& itemName = utfTo<Zstring>(sftpItemName);
+    const AfsPath itemPath(nativeAppendPaths(dirPath.value, itemName));
+
+    if ((attribs.flags & LIBSSH2_SFTP_ATTR_PERMISSIONS) == 0) //server probably does not support these attributes => fail at folder level
+        throw FileError(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(getSftpDisplayPath(login, itemPath))), L"File attributes not available.");
+
+    if (LIBSSH2_SFTP_S_ISLNK(attribs.permissions))
+    {
+        if ((attribs.flags & LIBSSH2_SFTP_ATTR_ACMODTIME) == 0) //server probably does not support these attributes => fail at folder level
+            throw FileError(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(getSftpDisplayPath(login, itemPath))), L"Modification time not supported.");
+        return SftpItem{itemName, {AFS::ItemType::symlink, 0, static_cast<time_t>(attribs.mtime)}};
+    }
+    else if (LIBSSH2_SFTP_S_ISDIR(attribs.permissions))
+        return SftpItem{itemName, {AFS::ItemType::folder, 0, static_cast<time_t>(attribs.mtime)}};
+    else //a file or named pipe, ect: LIBSSH2_SFTP_S_ISREG, LIBSSH2_SFTP_S_ISCHR, LIBSSH2_SFTP_S_ISBLK, LIBSSH2_SFTP_S_ISFIFO, LIBSSH2_SFTP_S_ISSOCK
+    {
+        if ((attribs.flags & LIBSSH2_SFTP_ATTR_ACMODTIME) == 0) //server probably does not support these attributes => fail at folder level
+            throw FileError(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(getSftpDisplayPath(login, itemPath))), L"Modification time not supported.");
+        if ((attribs.flags & LIBSSH2_SFTP_ATTR_SIZE) == 0)
+            throw FileError(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(getSftpDisplayPath(login, itemPath))), L"File size not supported.");
+        return SftpItem{itemName, {AFS::ItemType::file, attribs.filesize, static_cast<time_t>(attribs.mtime)}};
+    }
+}
+
+
 std::vector<SftpItem> getDirContentFlat(const SftpLogin& login, const AfsPath& dirPath) //throw FileError
 {
     LIBSSH2_SFTP_HANDLE* dirHandle = nullptr;
@@ -1055,33 +1327,8 @@ std::vector<SftpItem> getDirContentFlat(const SftpLogin& login, const AfsPath& d
         if (rc == 0) //no more items
             return output;
 
-        const std::string_view sftpItemName = makeStringView(&buf[0], rc);
-
-        if (sftpItemName == "." || sftpItemName == "..") //check needed for SFTP, too!
-            continue;
-
-        const Zstring& itemName = utfTo<Zstring>(sftpItemName);
-        const AfsPath itemPath(nativeAppendPaths(dirPath.value, itemName));
-
-        if ((attribs.flags & LIBSSH2_SFTP_ATTR_PERMISSIONS) == 0) //server probably does not support these attributes => fail at folder level
-            throw FileError(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(getSftpDisplayPath(login, itemPath))), L"File attributes not available.");
-
-        if (LIBSSH2_SFTP_S_ISLNK(attribs.permissions))
-        {
-            if ((attribs.flags & LIBSSH2_SFTP_ATTR_ACMODTIME) == 0) //server probably does not support these attributes => fail at folder level
-                throw FileError(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(getSftpDisplayPath(login, itemPath))), L"Modification time not supported.");
-            output.push_back({itemName, {AFS::ItemType::symlink, 0, static_cast<time_t>(attribs.mtime)}});
-        }
-        else if (LIBSSH2_SFTP_S_ISDIR(attribs.permissions))
-            output.push_back({itemName, {AFS::ItemType::folder, 0, static_cast<time_t>(attribs.mtime)}});
-        else //a file or named pipe, ect: LIBSSH2_SFTP_S_ISREG, LIBSSH2_SFTP_S_ISCHR, LIBSSH2_SFTP_S_ISBLK, LIBSSH2_SFTP_S_ISFIFO, LIBSSH2_SFTP_S_ISSOCK
-        {
-            if ((attribs.flags & LIBSSH2_SFTP_ATTR_ACMODTIME) == 0) //server probably does not support these attributes => fail at folder level
-                throw FileError(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(getSftpDisplayPath(login, itemPath))), L"Modification time not supported.");
-            if ((attribs.flags & LIBSSH2_SFTP_ATTR_SIZE) == 0)
-                throw FileError(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(getSftpDisplayPath(login, itemPath))), L"File size not supported.");
-            output.push_back({itemName, {AFS::ItemType::file, attribs.filesize, static_cast<time_t>(attribs.mtime)}});
-        }
+        if (std::optional<SftpItem> item = makeSftpItem(login, dirPath, makeStringView(&buf[0], rc), attribs)) //throw FileError
+            output.push_back(std::move(*item));
     }
 }
 
@@ -1113,176 +1360,1224 @@ SftpItemDetails getSymlinkTargetDetails(const SftpLogin& login, const AfsPath& l
 }
 
 
-class SingleFolderTraverser
+//run command on server via SSH exec channel => stdout is streamed to onOutput; requires shell access (not available e.g. for "ForceCommand internal-sftp" accounts)
+//input (optional): written to stdin before reading any output => command must not write much output before it has consumed its input!
+//caveat: fails with a time out if command does not write output for longer than timeoutSec
+void runSshCommand(SftpSessionManager::SshSessionShared& session, const std::string& command, const std::function<void(const char* data, size_t size)>& onOutput /*throw X*/, //throw SysError, FatalSshError, X
+                   std::string_view input = {}, const IoCallback& notifyInputWritten = nullptr /*throw X*/)
 {
-public:
-    using WorkItem = std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>;
-
-    SingleFolderTraverser(const SftpLogin& login, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/) :
-        login_(login)
+    LIBSSH2_CHANNEL* channel = nullptr;
+    session.executeBlocking("libssh2_channel_open_session", //throw SysError, FatalSshError
+                            [&](const SshSession::Details& sd) //noexcept!
+    {
+        channel = ::libssh2_channel_open_session(sd.sshSession);
+        if (!channel)
+            return std::min(::libssh2_session_last_errno(sd.sshSession), LIBSSH2_ERROR_SOCKET_NONE);
+        return LIBSSH2_ERROR_NONE;
+    });
+    ZEN_ON_SCOPE_EXIT(try
     {
-        for (const auto& [folderPath, cb] : workload)
-            workload_.push_back(WorkItem{folderPath, cb});
+        session.executeBlocking("libssh2_channel_free", //throw SysError, FatalSshError
+        [&](const SshSession::Details& sd) { return ::libssh2_channel_free(channel); }); //noexcept!
+    }
+    catch (const SysError&) {}
+    catch (const FatalSshError&) {}); //SSH session corrupted! => stop using session
 
-        while (!workload_.empty())
+    session.executeBlocking("libssh2_channel_exec", //throw SysError, FatalSshError
+    [&](const SshSession::Details& sd) { return ::libssh2_channel_exec(channel, command.c_str()); }); //noexcept!
+
+    for (size_t bytesWritten = 0; bytesWritten < input.size();)
+    {
+        const size_t bytesToWrite = std::min<size_t>(input.size() - bytesWritten, SFTP_OPTIMAL_BLOCK_SIZE_WRITE);
+        ssize_t rv = 0;
+        session.executeBlocking("libssh2_channel_write", //throw SysError, FatalSshError
+                                [&](const SshSession::Details& sd) //noexcept!
         {
-            auto wi = std::move(workload_.    front()); //yes, no strong exception guarantee (std::bad_alloc)
-            /**/                workload_.pop_front();  //
-            const auto& [folderPath, cb] = wi;
+            rv = ::libssh2_channel_write(channel, input.data() + bytesWritten, bytesToWrite);
+            return static_cast<int>(rv);
+        });
+        if (rv > static_cast<ssize_t>(bytesToWrite)) //better safe than sorry
+            throw SysError(formatSystemError("libssh2_channel_write", L"", L"Buffer overflow."));
 
-            tryReportingDirError([&] //throw X
-            {
-                traverseWithException(folderPath, *cb); //throw FileError, X
-            }, *cb);
-        }
+        bytesWritten += rv; //rv == 0 is no error according to doc!
+        if (notifyInputWritten) notifyInputWritten(rv); //throw X
     }
 
-private:
-    SingleFolderTraverser           (const SingleFolderTraverser&) = delete;
-    SingleFolderTraverser& operator=(const SingleFolderTraverser&) = delete;
+    session.executeBlocking("libssh2_channel_send_eof", //throw SysError, FatalSshError
+    [&](const SshSession::Details& sd) { return ::libssh2_channel_send_eof(channel); }); //noexcept!
 
-    void traverseWithException(const AfsPath& dirPath, AFS::TraverserCallback& cb) //throw FileError, X
+    std::vector<char> buf(64 * 1024);
+    for (;;)
     {
-        for (const SftpItem& item : getDirContentFlat(login_, dirPath)) //throw FileError
+        ssize_t bytesRead = 0;
+        session.executeBlocking("libssh2_channel_read", //throw SysError, FatalSshError
+                                [&](const SshSession::Details& sd) //noexcept!
         {
-            const AfsPath itemPath(nativeAppendPaths(dirPath.value, item.itemName));
+            bytesRead = ::libssh2_channel_read(channel, buf.data(), buf.size());
+            return static_cast<int>(bytesRead);
+        });
+        if (bytesRead > static_cast<ssize_t>(buf.size())) //better safe than sorry
+            throw SysError(formatSystemError("libssh2_channel_read", L"", L"Buffer overflow."));
 
-            switch (item.details.type)
-            {
-                case AFS::ItemType::file:
-                    cb.onFile({item.itemName, item.details.fileSize, item.details.modTime, AFS::FingerPrint() /*not supported by SFTP*/, false /*isFollowedSymlink*/}); //throw X
-                    break;
+        if (bytesRead == 0) //end of stream
+            break;
 
-                case AFS::ItemType::folder:
-                    if (std::shared_ptr<AFS::TraverserCallback> cbSub = cb.onFolder({item.itemName, false /*isFollowedSymlink*/})) //throw X
-                        workload_.push_back(WorkItem{itemPath, std::move(cbSub)});
-                    break;
+        onOutput(buf.data(), bytesRead); //throw X
+    }
 
-                case AFS::ItemType::symlink:
-                    switch (cb.onSymlink({item.itemName, item.details.modTime})) //throw X
-                    {
-                        case AFS::TraverserCallback::HandleLink::follow:
-                        {
-                            SftpItemDetails targetDetails = {};
-                            if (!tryReportingItemError([&] //throw X
-                        {
-                            targetDetails = getSymlinkTargetDetails(login_, itemPath); //throw FileError
-                            }, cb, item.itemName))
-                            continue;
+    session.executeBlocking("libssh2_channel_close", //throw SysError, FatalSshError
+    [&](const SshSession::Details& sd) { return ::libssh2_channel_close(channel); }); //noexcept!
 
-                            if (targetDetails.type == AFS::ItemType::folder)
-                            {
-                                if (std::shared_ptr<AFS::TraverserCallback> cbSub = cb.onFolder({item.itemName, true /*isFollowedSymlink*/})) //throw X
-                                    workload_.push_back(WorkItem{itemPath, std::move(cbSub)});
-                            }
-                            else //a file or named pipe, etc.
-                                cb.onFile({item.itemName, targetDetails.fileSize, targetDetails.modTime, AFS::FingerPrint() /*not supported by SFTP*/, true /*isFollowedSymlink*/}); //throw X
-                        }
-                        break;
+    session.executeBlocking("libssh2_channel_wait_closed", //throw SysError, FatalSshError
+    [&](const SshSession::Details& sd) { return ::libssh2_channel_wait_closed(channel); }); //noexcept!
 
-                        case AFS::TraverserCallback::HandleLink::skip:
-                            break;
-                    }
-                    break;
-            }
-        }
-    }
+    if (const int exitStatus = ::libssh2_channel_get_exit_status(channel);
+        exitStatus != 0)
+        throw SysError(formatSystemError("libssh2_channel_exec", L"", L"Command failed with exit code " + numberTo<std::wstring>(exitStatus) + L'.'));
+}
 
-    const SftpLogin login_;
-    RingBuffer<WorkItem> workload_;
-};
 
+std::string runSshCommand(SftpSessionManager::SshSessionShared& session, const std::string& command, size_t outputSizeMax) //throw SysError, FatalSshError
+{
+    std::string output;
+    runSshCommand(session, command, [&](const char* data, size_t size) //throw SysError, FatalSshError
+    {
+        output.append(data, size);
+        if (output.size() > outputSizeMax)
+            throw SysError(formatSystemError("libssh2_channel_read", L"", L"Unexpected size of command output."));
+    });
+    return output;
+}
 
-void traverseFolderRecursiveSftp(const SftpLogin& login, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/, size_t) //throw X
+
+//single-quote for POSIX shells (and csh/fish alike)
+std::string quoteShellArg(const std::string& arg)
 {
-    SingleFolderTraverser dummy(login, workload); //throw X
+    return '\'' + replaceCpy(arg, "'", "'\\''") + '\'';
 }
 
-//===========================================================================================================================
 
-struct InputStreamSftp : public AFS::InputStream
+/*  list the next queued folders ahead of time: one SFTP channel per outstanding listing, all driven non-blocking on a single SSH session
+    => round trips of opendir/readdir/closedir for sibling folders overlap instead of adding up
+
+    - opt-in: SftpLogin::traverserChannelsPerConnection > 1
+    - prefetch errors are not reported: folder is listed again via getDirContentFlat() => regular error handling + retry  */
+class SftpListingPrefetcher
 {
-    InputStreamSftp(const SftpLogin& login, const AfsPath& filePath, const IoCallback& notifyUnbufferedIO /*throw X*/) : //throw FileError
-        displayPath_(getSftpDisplayPath(login, filePath)),
-        notifyUnbufferedIO_(notifyUnbufferedIO)
+public:
+    explicit SftpListingPrefetcher(const SftpLogin& login) : //throw SysError
+        login_(login),
+        exSession_(getExclusiveSftpSession(login)) //throw SysError
     {
-        try
-        {
-            session_ = getSharedSftpSession(login); //throw SysError
-
-            session_->executeBlocking("libssh2_sftp_open", //throw SysError, FatalSshError
-                                      [&](const SshSession::Details& sd) //noexcept!
+        while (exSession_->getSftpChannelCount() < static_cast<size_t>(login.traverserChannelsPerConnection)) //reuse channels already open on the session
+            try
             {
-                fileHandle_ = ::libssh2_sftp_open(sd.sftpChannel, getLibssh2Path(filePath), LIBSSH2_FXF_READ, 0);
-                if (!fileHandle_)
-                    return std::min(::libssh2_session_last_errno(sd.sshSession), LIBSSH2_ERROR_SOCKET_NONE);
-                return LIBSSH2_ERROR_NONE;
-            });
-        }
-        catch (const SysError&      e) { throw FileError(replaceCpy(_("Cannot open file %x."), L"%x", fmtPath(displayPath_)), e.toString()); }
-        catch (const FatalSshError& e) { throw FileError(replaceCpy(_("Cannot open file %x."), L"%x", fmtPath(displayPath_)), e.toString()); } //SSH session corrupted! => stop using session
+                SftpSessionManager::SshSessionExclusive::addSftpChannel({exSession_.get()}); //throw SysError, FatalSshError
+            }
+            catch (const SysError&       ) { if (exSession_->getSftpChannelCount() == 0) throw; break; } //server channel limit: use what we've got
+            catch (const FatalSshError& e) { exSession_->markAsCorrupted(); throw SysError(e.toString()); }
+
+        channels_.resize(exSession_->getSftpChannelCount());
     }
 
-    ~InputStreamSftp()
+    ~SftpListingPrefetcher()
     {
-        try
-        {
-            session_->executeBlocking("libssh2_sftp_close", //throw SysError, FatalSshError
-            [&](const SshSession::Details& sd) { return ::libssh2_sftp_close(fileHandle_); }); //noexcept!
-        }
-        catch (const SysError&) {}
-        catch (const FatalSshError&) {} //SSH session corrupted! => stop using session
+        if (exSession_)
+            for (const ChannelState& cs : channels_)
+                if (cs.step != Step::idle) //abandoned listing: don't block on completion, don't reuse session with SFTP command or directory handle pending
+                    exSession_->markAsCorrupted();
     }
 
-    size_t read(void* buffer, size_t bytesToRead) override //throw FileError, (ErrorFileLocked), X; return "bytesToRead" bytes unless end of stream!
-    {
-        const size_t blockSize = getBlockSize();
-        assert(memBuf_.size() >= blockSize);
-        assert(bufPos_ <= bufPosEnd_ && bufPosEnd_ <= memBuf_.size());
+    void enqueue(const AfsPath& folderPath) { if (exSession_) queued_.push_back(AfsPath(folderPath)); }
 
-        auto       it    = static_cast<std::byte*>(buffer);
-        const auto itEnd = it + bytesToRead;
+    //returns std::nullopt if not prefetched or failed => caller should list folder the regular way
+    std::optional<std::vector<SftpItem>> getDirContent(const AfsPath& folderPath) //noexcept
+    {
         for (;;)
         {
-            const size_t junkSize = std::min(static_cast<size_t>(itEnd - it), bufPosEnd_ - bufPos_);
-            std::memcpy(it, &memBuf_[0] + bufPos_, junkSize);
-            bufPos_ += junkSize;
-            it      += junkSize;
+            if (auto it = done_.find(folderPath.value);
+                it != done_.end())
+            {
+                std::optional<std::vector<SftpItem>> items = std::move(it->second);
+                done_.erase(it);
+                return items;
+            }
 
-            if (it == itEnd)
-                break;
-            //--------------------------------------------------------------------
-            const size_t bytesRead = tryRead(&memBuf_[0], blockSize); //throw FileError; may return short, only 0 means EOF! => CONTRACT: bytesToRead > 0
-            bufPos_ = 0;
-            bufPosEnd_ = bytesRead;
+            if (!exSession_ || !isPending(folderPath))
+                return std::nullopt;
 
-            if (notifyUnbufferedIO_) notifyUnbufferedIO_(bytesRead); //throw X
+            startQueued(folderPath);
 
-            if (bytesRead == 0) //end of file
-                break;
+            bool progress = false;
+            try
+            {
+                for (size_t channelNo = 0; channelNo < channels_.size(); ++channelNo)
+                    if (channels_[channelNo].step != Step::idle)
+                        if (continueListing(channelNo)) //throw FatalSshError
+                            progress = true;
+
+                if (!progress && !done_.contains(folderPath.value))
+                    SftpSessionManager::SshSessionExclusive::waitForTraffic({exSession_.get()}); //throw FatalSshError
+            }
+            catch (FatalSshError&) //SSH session corrupted => give up prefetching
+            {
+                for (ChannelState& cs : channels_)
+                    if (cs.step != Step::idle)
+                        done_[cs.folderPath.value] = std::nullopt;
+                queued_.clear();
+                exSession_.reset(); //pending commands => session is not reused
+            }
         }
-        return it - static_cast<std::byte*>(buffer);
     }
 
-    size_t getBlockSize() const override { return SFTP_OPTIMAL_BLOCK_SIZE_READ; } //non-zero block size is AFS contract!
+private:
+    SftpListingPrefetcher           (const SftpListingPrefetcher&) = delete;
+    SftpListingPrefetcher& operator=(const SftpListingPrefetcher&) = delete;
 
-    std::optional<AFS::StreamAttributes> getAttributesBuffered() override //throw FileError
+    enum class Step
     {
-        return {}; //although have an SFTP stream handle, attribute access requires an extra (expensive) round-trip!
-        //PERF: test case 148 files, 1MB: overall copy time increases by 20% if libssh2_sftp_fstat() gets called per each file
-    }
+        idle,
+        opendir,
+        readdir,
+        closedir,
+    };
 
-private:
-    size_t tryRead(void* buffer, size_t bytesToRead) //throw FileError; may return short, only 0 means EOF! => CONTRACT: bytesToRead > 0
+    struct ChannelState
     {
-        //libssh2_sftp_read has same semantics as Posix read:
-        if (bytesToRead == 0) //"read() with a count of 0 returns zero" => indistinguishable from end of file! => check!
-            throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
-        assert(bytesToRead == getBlockSize());
+        Step step = Step::idle;
+        AfsPath folderPath;
+        std::chrono::steady_clock::time_point commandStartTime;
+        LIBSSH2_SFTP_HANDLE* dirHandle = nullptr;
+        std::array<char, 1024> buf; //see getDirContentFlat()
+        LIBSSH2_SFTP_ATTRIBUTES attribs = {};
+        std::optional<std::vector<SftpItem>> items; //std::nullopt on failure
+    };
+
+    bool isPending(const AfsPath& folderPath) const
+    {
+        return (!queued_.empty() && queued_.front() == folderPath) || //listings are requested in queue order
+               std::any_of(channels_.begin(), channels_.end(), [&](const ChannelState& cs) { return cs.step != Step::idle && cs.folderPath == folderPath; });
+    }
+
+    void startQueued(const AfsPath& requestedPath)
+    {
+        for (ChannelState& cs : channels_)
+            if (cs.step == Step::idle && !queued_.empty())
+            {
+                const size_t listingsAhead = done_.size() + std::count_if(channels_.begin(), channels_.end(), [](const ChannelState& cs2) { return cs2.step != Step::idle; });
+                if (listingsAhead >= channels_.size() && queued_.front() != requestedPath) //don't buffer too many listings nobody asked for yet
+                    return;
+
+                cs.step = Step::opendir;
+                cs.folderPath = std::move(queued_.front());
+                /**/                      queued_.pop_front();
+                cs.commandStartTime = std::chrono::steady_clock::now();
+                cs.items = std::vector<SftpItem>();
+            }
+    }
+
+    //returns "true" if listing made progress
+    bool continueListing(size_t channelNo) //throw FatalSshError
+    {
+        ChannelState& cs = channels_[channelNo];
+        try
+        {
+            switch (cs.step)
+            {
+                case Step::idle:
+                    assert(false);
+                    return false;
+
+                case Step::opendir:
+                    if (!exSession_->tryNonBlocking(channelNo, cs.commandStartTime, "libssh2_sftp_opendir", //throw SysError, FatalSshError
+                                                    [&](const SshSession::Details& sd) //noexcept!
+                {
+                    cs.dirHandle = ::libssh2_sftp_opendir(sd.sftpChannel, getLibssh2Path(cs.folderPath));
+                        if (!cs.dirHandle)
+                            return std::min(::libssh2_session_last_errno(sd.sshSession), LIBSSH2_ERROR_SOCKET_NONE);
+                        return LIBSSH2_ERROR_NONE;
+                    }))
+                    return false;
+
+                    cs.step = Step::readdir;
+                    break;
+
+                case Step::readdir:
+                {
+                    int rc = 0;
+                    if (!exSession_->tryNonBlocking(channelNo, cs.commandStartTime, "libssh2_sftp_readdir", //throw SysError, FatalSshError
+                    [&](const SshSession::Details& sd) { return rc = ::libssh2_sftp_readdir(cs.dirHandle, &cs.buf[0], cs.buf.size(), &cs.attribs); })) //noexcept!
+                    return false;
+
+                    if (rc == 0) //no more items
+                        cs.step = Step::closedir;
+                    else
+                        try
+                        {
+                            if (std::optional<SftpItem> item = makeSftpItem(login_, cs.folderPath, makeStringView(&cs.buf[0], rc), cs.attribs)) //throw FileError
+                                cs.items->push_back(std::move(*item));
+                        }
+                        catch (FileError&)
+                        {
+                            cs.items = std::nullopt;
+                            cs.step = Step::closedir;
+                        }
+                    cs.attribs = {};
+                }
+                break;
+
+                case Step::closedir:
+                    try
+                    {
+                        if (!exSession_->tryNonBlocking(channelNo, cs.commandStartTime, "libssh2_sftp_closedir", //throw SysError, FatalSshError
+                        [&](const SshSession::Details& sd) { return ::libssh2_sftp_closedir(cs.dirHandle); })) //noexcept!
+                        return false;
+                    }
+                    catch (SysError&) {}
+
+                    cs.dirHandle = nullptr;
+                    finishListing(cs);
+                    return true;
+            }
+        }
+        catch (SysError&) //e.g. access denied
+        {
+            cs.items = std::nullopt;
+            if (cs.dirHandle)
+                cs.step = Step::closedir;
+            else
+            {
+                finishListing(cs);
+                return true;
+            }
+        }
+
+        cs.commandStartTime = std::chrono::steady_clock::now(); //next SFTP command
+        return true;
+    }
+
+    void finishListing(ChannelState& cs)
+    {
+        done_[cs.folderPath.value] = std::move(cs.items);
+        cs.items = std::nullopt;
+        cs.step = Step::idle;
+    }
+
+    const SftpLogin login_;
+    std::unique_ptr<SftpSessionManager::SshSessionExclusive> exSession_; //nullptr after fatal SSH error
+    std::vector<ChannelState> channels_;
+    RingBuffer<AfsPath> queued_; //in traversal order
+    std::map<Zstring /*AfsPath*/, std::optional<std::vector<SftpItem>>> done_;
+};
+
+
+class SingleFolderTraverser
+{
+public:
+    SingleFolderTraverser(const SftpLogin& login, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/) :
+        login_(login),
+        deviceKey_(utfTo<Zstring>(getSftpDisplayPath(login, AfsPath())))
+    {
+        if (login.traverserChannelsPerConnection > 1)
+            try
+            {
+                prefetcher_ = std::make_unique<SftpListingPrefetcher>(login); //throw SysError
+            }
+            catch (SysError&) {} //just an optimization: list folders sequentially
+
+        for (const auto& [folderPath, cb] : workload)
+            pushWorkItem(folderPath, cb, std::nullopt /*folderModTime: base folders are never cached*/);
+
+        while (!workload_.empty())
+        {
+            auto wi = std::move(workload_.    front()); //yes, no strong exception guarantee (std::bad_alloc)
+            /**/                workload_.pop_front();  //
+
+            tryReportingDirError([&] //throw X
+            {
+                traverseWithException(wi); //throw FileError, X
+            }, *wi.cb);
+        }
+    }
+
+private:
+    SingleFolderTraverser           (const SingleFolderTraverser&) = delete;
+    SingleFolderTraverser& operator=(const SingleFolderTraverser&) = delete;
+
+    struct WorkItem
+    {
+        AfsPath folderPath;
+        std::shared_ptr<AFS::TraverserCallback> cb;
+        std::optional<time_t> folderModTime; //as reported by a *fresh* listing of the parent folder
+        std::optional<std::vector<CachedFolderItem>> cachedListing; //looked up when queued => don't prefetch
+    };
+
+    void pushWorkItem(const AfsPath& folderPath, const std::shared_ptr<AFS::TraverserCallback>& cb, const std::optional<time_t>& folderModTime)
+    {
+        WorkItem wi{folderPath, cb, folderModTime, std::nullopt};
+
+        if (login_.listingCache && folderModTime)
+            wi.cachedListing = getCachedFolderListing(deviceKey_, folderPath, *folderModTime); //noexcept
+
+        if (!wi.cachedListing && prefetcher_)
+            prefetcher_->enqueue(folderPath);
+
+        workload_.push_back(std::move(wi));
+    }
+
+    //returns "false" if served from cache
+    bool getDirContent(const WorkItem& wi, std::vector<SftpItem>& items) //throw FileError
+    {
+        const AfsPath& dirPath = wi.folderPath;
+
+        if (wi.cachedListing)
+        {
+            for (const CachedFolderItem& ci : *wi.cachedListing)
+                items.push_back({ci.itemName, {ci.type, ci.fileSize, ci.modTime}});
+            return false;
+        }
+
+        std::optional<std::vector<SftpItem>> prefetched;
+        if (prefetcher_)
+            prefetched = prefetcher_->getDirContent(dirPath); //noexcept
+
+        if (prefetched)
+            items = std::move(*prefetched);
+        else
+            items = getDirContentFlat(login_, dirPath); //throw FileError
+
+        if (const std::optional<time_t>& folderModTime = wi.folderModTime;
+            login_.listingCache && folderModTime)
+        {
+            std::vector<CachedFolderItem> cached;
+            for (const SftpItem& item : items)
+                cached.push_back({item.details.type, item.itemName, item.details.fileSize, item.details.modTime, AFS::FingerPrint() /*not supported by SFTP*/});
+
+            setCachedFolderListing(deviceKey_, dirPath, *folderModTime, cached); //noexcept
+        }
+        return true;
+    }
+
+    void traverseWithException(const WorkItem& wi) //throw FileError, X
+    {
+        const AfsPath& dirPath = wi.folderPath;
+        AFS::TraverserCallback& cb = *wi.cb;
+
+        std::vector<SftpItem> items;
+        const bool freshListing = getDirContent(wi, items); //throw FileError
+
+        for (const SftpItem& item : items)
+        {
+            const AfsPath itemPath(nativeAppendPaths(dirPath.value, item.itemName));
+
+            //sub folder modification times from a cached listing may be outdated => can't be used to validate the cache
+            const std::optional<time_t> itemModTime = freshListing ? std::optional(item.details.modTime) : std::nullopt;
+
+            switch (item.details.type)
+            {
+                case AFS::ItemType::file:
+                    cb.onFile({item.itemName, item.details.fileSize, item.details.modTime, AFS::FingerPrint() /*not supported by SFTP*/, false /*isFollowedSymlink*/}); //throw X
+                    break;
+
+                case AFS::ItemType::folder:
+                    if (std::shared_ptr<AFS::TraverserCallback> cbSub = cb.onFolder({item.itemName, false /*isFollowedSymlink*/})) //throw X
+                        pushWorkItem(itemPath, cbSub, itemModTime);
+                    break;
+
+                case AFS::ItemType::symlink:
+                    switch (cb.onSymlink({item.itemName, item.details.modTime})) //throw X
+                    {
+                        case AFS::TraverserCallback::HandleLink::follow:
+                        {
+                            SftpItemDetails targetDetails = {};
+                            if (!tryReportingItemError([&] //throw X
+                        {
+                            targetDetails = getSymlinkTargetDetails(login_, itemPath); //throw FileError
+                            }, cb, item.itemName))
+                            continue;
+
+                            if (targetDetails.type == AFS::ItemType::folder)
+                            {
+                                if (std::shared_ptr<AFS::TraverserCallback> cbSub = cb.onFolder({item.itemName, true /*isFollowedSymlink*/})) //throw X
+                                    pushWorkItem(itemPath, cbSub, targetDetails.modTime); //target details are always fresh
+                            }
+                            else //a file or named pipe, etc.
+                                cb.onFile({item.itemName, targetDetails.fileSize, targetDetails.modTime, AFS::FingerPrint() /*not supported by SFTP*/, true /*isFollowedSymlink*/}); //throw X
+                        }
+                        break;
+
+                        case AFS::TraverserCallback::HandleLink::skip:
+                            break;
+                    }
+                    break;
+            }
+        }
+    }
+
+    const SftpLogin login_;
+    const Zstring deviceKey_; //listing cache
+    std::unique_ptr<SftpListingPrefetcher> prefetcher_; //optional
+    RingBuffer<WorkItem> workload_;
+};
+
+
+/*  remote scanning agent (SFTP login option "|remotescan"): list the complete folder tree with a single "find" via SSH exec channel
+    => no SFTP round trips per folder: huge trees are listed in minutes instead of hours
+    - requires shell access + GNU find (-printf, -readable): otherwise regular SFTP traversal
+    - output is streamed into the traverser callbacks: memory does not grow with tree size
+    - record per item: <type> <size> <mtime> <link count> <inode> <relative path> '\0'
+      type: "find %y", or 'D' for a folder which can't be listed => let the regular traverser report the error (+ retry)
+    - trailer record '#' <exit status of find>: missing or != 0 => listing is not reliable => caller traverses regularly (duplicate reports are fine)  */
+bool traverseFolderByAgent(const SftpLogin& login, const AfsPath& baseFolderPath, const std::shared_ptr<AFS::TraverserCallback>& baseCb, //throw X
+                           AFS::TraverserWorkload& workloadRegular)
+{
+    std::vector<std::pair<std::string /*relative path*/, std::shared_ptr<AFS::TraverserCallback>>> folderStack{{"", baseCb}}; //"find": parent before children
+    std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>> foundFolders; //excluding base folder
+    std::vector<std::tuple<AfsPath, Zstring /*itemName*/, std::shared_ptr<AFS::TraverserCallback>>> followLinks; //resolve after listing: channel is still open
+    std::optional<int> findStatus;
+
+    auto processRecord = [&](std::string_view record) //throw SysError, X
+    {
+        if (startsWith(record, '#'))
+        {
+            findStatus = stringTo<int>(record.substr(1));
+            return;
+        }
+
+        std::string_view fields[5];
+        for (std::string_view& field : fields)
+        {
+            const size_t pos = record.find(' ');
+            if (pos == std::string_view::npos)
+                throw SysError(L"Unexpected output of \"find\": " + utfTo<std::wstring>(record));
+            field = record.substr(0, pos);
+            record.remove_prefix(pos + 1);
+        }
+        const std::string relPath(record);
+        const std::string parentPath = beforeLast(relPath, '/', IfNotFoundReturn::none);
+
+        while (folderStack.size() > 1 && folderStack.back().first != parentPath)
+            folderStack.pop_back();
+        if (folderStack.back().first != parentPath) //parent folder excluded by callback
+            return;
+
+        AFS::TraverserCallback& cb = *folderStack.back().second;
+        const Zstring itemName = utfTo<Zstring>(afterLast(relPath, '/', IfNotFoundReturn::all));
+        const AfsPath itemPath(nativeAppendPaths(baseFolderPath.value, utfTo<Zstring>(relPath)));
+        const time_t modTime = stringTo<time_t>(beforeFirst(fields[2], '.', IfNotFoundReturn::all)); //"find %T@": seconds + fraction
+
+        switch (fields[0] == "D" ? 'D' : fields[0] == "d" ? 'd' : fields[0] == "l" ? 'l' : 'f')
+        {
+            case 'd':
+                if (std::shared_ptr<AFS::TraverserCallback> cbSub = cb.onFolder({itemName, false /*isFollowedSymlink*/})) //throw X
+                    folderStack.emplace_back(relPath, cbSub);
+                break;
+
+            case 'D':
+                if (std::shared_ptr<AFS::TraverserCallback> cbSub = cb.onFolder({itemName, false /*isFollowedSymlink*/})) //throw X
+                    foundFolders.emplace_back(itemPath, cbSub);
+                break;
+
+            case 'l':
+                switch (cb.onSymlink({itemName, modTime})) //throw X
+                {
+                    case AFS::TraverserCallback::HandleLink::follow:
+                        followLinks.emplace_back(itemPath, itemName, folderStack.back().second);
+                        break;
+                    case AFS::TraverserCallback::HandleLink::skip:
+                        break;
+                }
+                break;
+
+            default: //a file or named pipe, etc.
+                cb.onFile({itemName, stringTo<uint64_t>(fields[1]), modTime,
+                           stringTo<AFS::FingerPrint>(fields[4]) /*inode*/, false /*isFollowedSymlink*/, stringTo<uint32_t>(fields[3])}); //throw X
+                break;
+        }
+    };
+
+    try
+    {
+        const std::shared_ptr<SftpSessionManager::SshSessionShared> session = getSharedSftpSession(login); //throw SysError
+
+        std::string pending;
+        runSshCommand(*session, "sh -c " + quoteShellArg("LC_ALL=C find \"$1\" -mindepth 1 "  //throw SysError, FatalSshError, X
+                                                          "\\( -type d ! \\( -readable -executable \\) -printf 'D %s %T@ %n %i %P\\0' -prune \\) -o "
+                                                          "-printf '%y %s %T@ %n %i %P\\0'; "
+                                                          "printf '#%d\\0' $?") +
+                      " sh " + quoteShellArg(getLibssh2Path(baseFolderPath)),
+                      [&](const char* data, size_t size) //throw SysError, X
+        {
+            pending.append(data, size);
+
+            size_t recordStart = 0;
+            for (size_t pos = pending.find('\0'); pos != std::string::npos; pos = pending.find('\0', recordStart))
+            {
+                processRecord(makeStringView(pending.data() + recordStart, pos - recordStart)); //throw SysError, X
+                recordStart = pos + 1;
+            }
+            pending.erase(0, recordStart);
+        });
+    }
+    catch (const SysError&) { return false; } //e.g. exec not available, no GNU find
+    catch (const FatalSshError&) { return false; } //SSH session corrupted! => stop using session
+
+    if (findStatus != 0) //e.g. folder vanished while listing => details are missing from the output
+        return false;
+
+    for (const auto& [linkPath, itemName, cbPtr] : followLinks)
+    {
+        AFS::TraverserCallback& cb = *cbPtr;
+
+        SftpItemDetails targetDetails = {};
+        if (!tryReportingItemError([&] //throw X
+    {
+        targetDetails = getSymlinkTargetDetails(login, linkPath); //throw FileError
+        }, cb, itemName))
+        continue;
+
+        if (targetDetails.type == AFS::ItemType::folder)
+        {
+            if (std::shared_ptr<AFS::TraverserCallback> cbSub = cb.onFolder({itemName, true /*isFollowedSymlink*/})) //throw X
+                foundFolders.emplace_back(linkPath, cbSub);
+        }
+        else //a file or named pipe, etc.
+            cb.onFile({itemName, targetDetails.fileSize, targetDetails.modTime, AFS::FingerPrint() /*not supported by SFTP*/, true /*isFollowedSymlink*/}); //throw X
+    }
+
+    append(workloadRegular, foundFolders);
+    return true;
+}
+
+
+void traverseFolderRecursiveSftp(const SftpLogin& login, const std::vector<std::pair<AfsPath, std::shared_ptr<AFS::TraverserCallback>>>& workload /*throw X*/, size_t) //throw X
+{
+    if (!login.remoteScan)
+    {
+        SingleFolderTraverser dummy(login, workload); //throw X
+        return;
+    }
+
+    AFS::TraverserWorkload workloadRegular; //folders not (reliably) listed by "find"
+    for (const auto& [folderPath, cb] : workload)
+        if (!traverseFolderByAgent(login, folderPath, cb, workloadRegular)) //throw X
+            workloadRegular.emplace_back(folderPath, cb);
+
+    SingleFolderTraverser dummy(login, workloadRegular); //throw X
+}
+
+//===========================================================================================================================
+
+/*  pipelined transfer: libssh2 splits each libssh2_sftp_read/write() buffer into requests of MAX_SFTP_READ_SIZE/MAX_SFTP_OUTGOING_SIZE bytes
+    and keeps all of them in flight => buffer size passed = number of outstanding requests per file handle
+
+    size window by bandwidth-delay product: transferring one window takes "RTT + window / bandwidth"
+        => less than 2 x RTT: latency-bound (window < BDP) => double window
+        => otherwise:         bandwidth-bound              => keep window      */
+class SftpTransferWindow
+{
+public:
+    SftpTransferWindow(size_t requestSize, size_t requestCountInit, size_t requestCountMax, std::chrono::nanoseconds roundTripTime) :
+        requestSize_(requestSize), requestCount_(std::min(requestCountInit, requestCountMax)), requestCountMax_(requestCountMax), roundTripTime_(roundTripTime) {}
+
+    size_t size() const { return requestSize_ * requestCount_; }
+
+    void reportTransfer(std::chrono::steady_clock::time_point callStartTime, size_t bytesTransferred)
+    {
+        if (haveBdp_)
+            return;
+
+        if (!measureStartTime_)
+            measureStartTime_ = callStartTime;
+        measuredBytes_ += bytesTransferred;
+
+        if (measuredBytes_ >= size()) //full window transferred (excluding the last, short transfer at end of file)
+        {
+            if (std::chrono::steady_clock::now() - *measureStartTime_ < 2 * roundTripTime_ &&
+                requestCount_ < requestCountMax_)
+                requestCount_ = std::min(2 * requestCount_, requestCountMax_);
+            else
+                haveBdp_ = true;
+
+            measureStartTime_ = std::nullopt;
+            measuredBytes_ = 0;
+        }
+    }
+
+private:
+    size_t requestSize_;
+    size_t requestCount_;
+    size_t requestCountMax_; //negotiated channel window: see SftpTransferLimits
+    std::chrono::nanoseconds roundTripTime_; //estimate: libssh2_sftp_open() => one round trip (at least)
+
+    bool haveBdp_ = false;
+    std::optional<std::chrono::steady_clock::time_point> measureStartTime_;
+    size_t measuredBytes_ = 0;
+};
+
+
+//===========================================================================================================================
+
+/*  transfer a single large file over several SSH connections in parallel: worker threads move disjoint chunks, each over its own session
+    (=> getSharedSftpSession() has thread affinity) and file handle => overcome throughput limits of a single TCP stream on long fat pipes
+
+    - opt-in: SftpLogin::connectionsPerFileTransfer > 1
+    - upload: target is the temp file of copyFileTransactional() => replaced atomically after finalize() as usual
+    - download: starts after SFTP_PARALLEL_TRANSFER_MIN_SIZE bytes were read sequentially => no extra round trips for small files  */
+const size_t SFTP_PARALLEL_CHUNK_SIZE         = 8 * 1024 * 1024;
+const size_t SFTP_PARALLEL_TRANSFER_MIN_SIZE  = 4 * SFTP_PARALLEL_CHUNK_SIZE;
+constexpr std::chrono::milliseconds SFTP_PARALLEL_PROGRESS_INTERVAL(100);
+
+
+LIBSSH2_SFTP_HANDLE* openSftpFile(SftpSessionManager::SshSessionShared& session, const AfsPath& filePath, unsigned long flags) //throw SysError, FatalSshError
+{
+    LIBSSH2_SFTP_HANDLE* fileHandle = nullptr;
+    session.executeBlocking("libssh2_sftp_open", //throw SysError, FatalSshError
+                            [&](const SshSession::Details& sd) //noexcept!
+    {
+        fileHandle = ::libssh2_sftp_open(sd.sftpChannel, getLibssh2Path(filePath), flags, 0);
+        if (!fileHandle)
+            return std::min(::libssh2_session_last_errno(sd.sshSession), LIBSSH2_ERROR_SOCKET_NONE);
+        return LIBSSH2_ERROR_NONE;
+    });
+    return fileHandle;
+}
+
+
+void closeSftpFile(SftpSessionManager::SshSessionShared& session, LIBSSH2_SFTP_HANDLE* fileHandle) //noexcept
+{
+    try
+    {
+        session.executeBlocking("libssh2_sftp_close", //throw SysError, FatalSshError
+        [&](const SshSession::Details& sd) { return ::libssh2_sftp_close(fileHandle); }); //noexcept!
+    }
+    catch (const SysError&) {}
+    catch (const FatalSshError&) {} //SSH session corrupted! => stop using session
+}
+
+
+void seekSftpFile(SftpSessionManager::SshSessionShared& session, LIBSSH2_SFTP_HANDLE* fileHandle, uint64_t offset) //throw SysError, FatalSshError
+{
+    session.executeBlocking("libssh2_sftp_seek64", //throw SysError, FatalSshError
+                            [&](const SshSession::Details& sd) //noexcept!
+    {
+        ::libssh2_sftp_seek64(fileHandle, offset);
+        return LIBSSH2_ERROR_NONE;
+    });
+}
+
+
+class SftpParallelDownload
+{
+public:
+    SftpParallelDownload(const SftpLogin& login, const AfsPath& filePath, uint64_t startOffset)
+    {
+        const size_t workerCount = login.connectionsPerFileTransfer;
+        state_->maxChunksAhead = 2 * workerCount;
+
+        for (size_t i = 0; i < workerCount; ++i)
+            workers_.emplace_back([state = state_, login, filePath, startOffset]
+        {
+            setCurrentThreadName(Zstr("Download[SFTP] ") + utfTo<Zstring>(getSftpDisplayPath(login, filePath)));
+            try
+            {
+                readChunks(*state, login, filePath, startOffset); //throw FileError, ThreadStopRequest
+            }
+            catch (FileError&)
+            {
+                {
+                    std::lock_guard dummy(state->lockChunks);
+                    if (!state->error)
+                        state->error = std::current_exception();
+                }
+                state->conditionChunkDone.notify_all();
+            }
+        });
+    }
+
+    ~SftpParallelDownload()
+    {
+        for (InterruptibleThread& wt : workers_)
+            wt.requestStop(); //stop all workers first, then join
+    }
+
+    //returns empty buffer at end of stream
+    std::vector<std::byte> getNextChunk(const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+    {
+        for (;;)
+        {
+            std::optional<std::vector<std::byte>> chunk;
+            bool endOfStream = false;
+            int64_t bytesDelta = 0;
+            {
+                std::unique_lock dummy(state_->lockChunks);
+                state_->conditionChunkDone.wait_for(dummy, SFTP_PARALLEL_PROGRESS_INTERVAL, [&]
+                {
+                    return state_->error || state_->endOfStream() || state_->chunksDone.contains(state_->consumedChunkNo);
+                });
+                if (state_->error)
+                    std::rethrow_exception(state_->error); //throw FileError
+
+                bytesDelta = state_->bytesTransferred - bytesReported_;
+                bytesReported_ = state_->bytesTransferred;
+
+                if (state_->endOfStream())
+                    endOfStream = true;
+                else if (auto it = state_->chunksDone.find(state_->consumedChunkNo);
+                         it != state_->chunksDone.end())
+                {
+                    chunk = std::move(it->second);
+                    state_->chunksDone.erase(it);
+                    ++state_->consumedChunkNo;
+                }
+            }
+            if (chunk)
+                state_->conditionChunkConsumed.notify_all();
+
+            if (notifyUnbufferedIO) notifyUnbufferedIO(bytesDelta); //throw X
+
+            if (endOfStream)
+                return {};
+            if (chunk)
+                return std::move(*chunk);
+        }
+    }
+
+private:
+    struct ChunkState
+    {
+        bool endOfStream() const { return eofChunkNo && consumedChunkNo > *eofChunkNo; }
+        bool fetchComplete() const { return error || (eofChunkNo && nextChunkNo > *eofChunkNo); }
+
+        std::mutex lockChunks;
+        std::condition_variable conditionChunkDone;
+        std::condition_variable conditionChunkConsumed;
+
+        size_t maxChunksAhead = 0;
+        size_t nextChunkNo = 0;     //next chunk to fetch
+        size_t consumedChunkNo = 0; //next chunk to return from getNextChunk()
+        std::optional<size_t> eofChunkNo; //first chunk shorter than SFTP_PARALLEL_CHUNK_SIZE
+        std::map<size_t, std::vector<std::byte>> chunksDone;
+        int64_t bytesTransferred = 0;
+        std::exception_ptr error; //FileError
+    };
+
+    //context of worker thread:
+    static void readChunks(ChunkState& state, const SftpLogin& login, const AfsPath& filePath, uint64_t startOffset) //throw FileError, ThreadStopRequest
+    {
+        try
+        {
+            const std::shared_ptr<SftpSessionManager::SshSessionShared> session = getSharedSftpSession(login); //throw SysError
+
+            const auto openStartTime = std::chrono::steady_clock::now();
+            LIBSSH2_SFTP_HANDLE* fileHandle = openSftpFile(*session, filePath, LIBSSH2_FXF_READ); //throw SysError, FatalSshError
+            ZEN_ON_SCOPE_EXIT(closeSftpFile(*session, fileHandle));
+
+            SftpTransferWindow readWindow(MAX_SFTP_READ_SIZE, SFTP_OPTIMAL_BLOCK_SIZE_READ / MAX_SFTP_READ_SIZE, session->getTransferLimits().readRequestsMax,
+                                          std::chrono::steady_clock::now() - openStartTime);
+
+            for (;;)
+            {
+                size_t chunkNo = 0;
+                {
+                    std::unique_lock dummy(state.lockChunks);
+                    interruptibleWait(state.conditionChunkConsumed, dummy, [&] //throw ThreadStopRequest
+                    {
+                        return state.fetchComplete() || state.nextChunkNo < state.consumedChunkNo + state.maxChunksAhead;
+                    });
+                    if (state.fetchComplete())
+                        return;
+                    chunkNo = state.nextChunkNo++;
+                }
+
+                seekSftpFile(*session, fileHandle, startOffset + chunkNo * SFTP_PARALLEL_CHUNK_SIZE); //throw SysError, FatalSshError
+
+                std::vector<std::byte> buf(SFTP_PARALLEL_CHUNK_SIZE);
+                size_t bytesRead = 0;
+                while (bytesRead < buf.size())
+                {
+                    //libssh2 reads ahead 4 x buffer size => don't request (much) beyond the end of this chunk
+                    const size_t bytesToRead = std::min(buf.size() - bytesRead, std::min(readWindow.size(), std::max<size_t>(MAX_SFTP_READ_SIZE, (buf.size() - bytesRead) / 4)));
+
+                    const auto readStartTime = std::chrono::steady_clock::now();
+                    ssize_t rv = 0;
+                    session->executeBlocking("libssh2_sftp_read", //throw SysError, FatalSshError
+                                             [&](const SshSession::Details& sd) //noexcept!
+                    {
+                        rv = ::libssh2_sftp_read(fileHandle, reinterpret_cast<char*>(&buf[bytesRead]), bytesToRead);
+                        return static_cast<int>(rv);
+                    });
+                    if (static_cast<size_t>(rv) > bytesToRead) //better safe than sorry
+                        throw SysError(formatSystemError("libssh2_sftp_read", L"", L"Buffer overflow.")); //user should never see this
+
+                    if (rv == 0) //end of file
+                        break;
+
+                    readWindow.reportTransfer(readStartTime, rv);
+                    bytesRead += rv;
+                    {
+                        std::lock_guard dummy(state.lockChunks);
+                        state.bytesTransferred += rv;
+                    }
+                    interruptionPoint(); //throw ThreadStopRequest
+                }
+                buf.resize(bytesRead);
+                {
+                    std::lock_guard dummy(state.lockChunks);
+                    if (bytesRead < SFTP_PARALLEL_CHUNK_SIZE)
+                        state.eofChunkNo = std::min(state.eofChunkNo.value_or(chunkNo), chunkNo);
+                    state.chunksDone.emplace(chunkNo, std::move(buf));
+                }
+                state.conditionChunkDone.notify_all();
+                state.conditionChunkConsumed.notify_all(); //other workers: fetch may be complete now
+            }
+        }
+        catch (const SysError&      e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getSftpDisplayPath(login, filePath))), e.toString()); }
+        catch (const FatalSshError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getSftpDisplayPath(login, filePath))), e.toString()); } //SSH session corrupted! => stop using session
+    }
+
+    const std::shared_ptr<ChunkState> state_ = std::make_shared<ChunkState>();
+    int64_t bytesReported_ = 0;
+    std::vector<InterruptibleThread> workers_; //[!] life time must be subset of state_ => declare last! (~InterruptibleThread() stops and joins)
+};
+
+
+class SftpParallelUpload
+{
+public:
+    SftpParallelUpload(const SftpLogin& login, const AfsPath& filePath) //file must already exist!
+    {
+        const size_t workerCount = login.connectionsPerFileTransfer;
+        state_->maxChunksQueued = workerCount;
+
+        for (size_t i = 0; i < workerCount; ++i)
+            workers_.emplace_back([state = state_, login, filePath]
+        {
+            setCurrentThreadName(Zstr("Upload[SFTP] ") + utfTo<Zstring>(getSftpDisplayPath(login, filePath)));
+            try
+            {
+                writeChunks(*state, login, filePath); //throw FileError, ThreadStopRequest
+            }
+            catch (FileError&)
+            {
+                {
+                    std::lock_guard dummy(state->lockChunks);
+                    if (!state->error)
+                        state->error = std::current_exception();
+                }
+                state->conditionChunkWritten.notify_all();
+                state->conditionChunkQueued .notify_all(); //other workers: stop
+            }
+        });
+    }
+
+    ~SftpParallelUpload()
+    {
+        for (InterruptibleThread& wt : workers_)
+            wt.requestStop(); //stop all workers first, then join
+    }
+
+    void writeChunk(uint64_t offset, std::vector<std::byte>&& chunk, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+    {
+        waitForChunks([&] { return state_->chunksQueued.size() < state_->maxChunksQueued; }, notifyUnbufferedIO); //throw FileError, X
+        {
+            std::lock_guard dummy(state_->lockChunks);
+            state_->chunksQueued.push_back(std::pair(offset, std::move(chunk)));
+            ++state_->chunksPending;
+        }
+        state_->conditionChunkQueued.notify_all();
+    }
+
+    void finish(const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+    {
+        {
+            std::lock_guard dummy(state_->lockChunks);
+            state_->noMoreChunks = true;
+        }
+        state_->conditionChunkQueued.notify_all();
+
+        waitForChunks([&] { return state_->chunksPending == 0; }, notifyUnbufferedIO); //throw FileError, X
+
+        for (InterruptibleThread& wt : workers_)
+            wt.join(); //all workers done: closes file handles *before* caller sets modification time
+        workers_.clear();
+    }
+
+private:
+    struct ChunkState
+    {
+        std::mutex lockChunks;
+        std::condition_variable conditionChunkQueued;
+        std::condition_variable conditionChunkWritten;
+
+        size_t maxChunksQueued = 0;
+        RingBuffer<std::pair<uint64_t /*offset*/, std::vector<std::byte>>> chunksQueued;
+        size_t chunksPending = 0; //queued + in progress
+        bool noMoreChunks = false;
+        int64_t bytesTransferred = 0;
+        std::exception_ptr error; //FileError
+    };
+
+    template <class Predicate>
+    void waitForChunks(Predicate pred, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+    {
+        for (;;)
+        {
+            bool done = false;
+            int64_t bytesDelta = 0;
+            {
+                std::unique_lock dummy(state_->lockChunks);
+                done = state_->conditionChunkWritten.wait_for(dummy, SFTP_PARALLEL_PROGRESS_INTERVAL, [&] { return state_->error || pred(); });
+
+                if (state_->error)
+                    std::rethrow_exception(state_->error); //throw FileError
+
+                bytesDelta = state_->bytesTransferred - bytesReported_;
+                bytesReported_ = state_->bytesTransferred;
+            }
+            if (notifyUnbufferedIO) notifyUnbufferedIO(bytesDelta); //throw X
+
+            if (done)
+                return;
+        }
+    }
+
+    //context of worker thread:
+    static void writeChunks(ChunkState& state, const SftpLogin& login, const AfsPath& filePath) //throw FileError, ThreadStopRequest
+    {
+        try
+        {
+            const std::shared_ptr<SftpSessionManager::SshSessionShared> session = getSharedSftpSession(login); //throw SysError
+
+            const auto openStartTime = std::chrono::steady_clock::now();
+            LIBSSH2_SFTP_HANDLE* fileHandle = openSftpFile(*session, filePath, LIBSSH2_FXF_WRITE); //throw SysError, FatalSshError
+            ZEN_ON_SCOPE_EXIT(closeSftpFile(*session, fileHandle));
+
+            SftpTransferWindow writeWindow(MAX_SFTP_OUTGOING_SIZE, SFTP_OPTIMAL_BLOCK_SIZE_WRITE / MAX_SFTP_OUTGOING_SIZE, session->getTransferLimits().writeRequestsMax,
+                                           std::chrono::steady_clock::now() - openStartTime);
+
+            for (;;)
+            {
+                std::pair<uint64_t, std::vector<std::byte>> chunk;
+                {
+                    std::unique_lock dummy(state.lockChunks);
+                    interruptibleWait(state.conditionChunkQueued, dummy, [&] { return state.error || state.noMoreChunks || !state.chunksQueued.empty(); }); //throw ThreadStopRequest
+                    if (state.error || state.chunksQueued.empty())
+                        return;
+                    chunk = std::move(state.chunksQueued.front());
+                    state.chunksQueued.pop_front();
+                }
+                state.conditionChunkWritten.notify_all(); //queue has space again
+
+                const auto& [offset, buf] = chunk;
+                seekSftpFile(*session, fileHandle, offset); //throw SysError, FatalSshError
+
+                size_t bytesWritten = 0;
+                while (bytesWritten < buf.size())
+                {
+                    const size_t bytesToWrite = std::min(buf.size() - bytesWritten, writeWindow.size());
+
+                    const auto writeStartTime = std::chrono::steady_clock::now();
+                    ssize_t rv = 0;
+                    session->executeBlocking("libssh2_sftp_write", //throw SysError, FatalSshError
+                                             [&](const SshSession::Details& sd) //noexcept!
+                    {
+                        rv = ::libssh2_sftp_write(fileHandle, reinterpret_cast<const char*>(&buf[bytesWritten]), bytesToWrite);
+                        return static_cast<int>(rv);
+                    });
+                    if (rv > static_cast<ssize_t>(bytesToWrite)) //better safe than sorry
+                        throw SysError(formatSystemError("libssh2_sftp_write", L"", L"Buffer overflow."));
+
+                    writeWindow.reportTransfer(writeStartTime, rv);
+                    bytesWritten += rv; //rv == 0 is no error according to doc!
+                    {
+                        std::lock_guard dummy(state.lockChunks);
+                        state.bytesTransferred += rv;
+                    }
+                    interruptionPoint(); //throw ThreadStopRequest
+                }
+                {
+                    std::lock_guard dummy(state.lockChunks);
+                    --state.chunksPending;
+                }
+                state.conditionChunkWritten.notify_all();
+            }
+        }
+        catch (const SysError&      e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(getSftpDisplayPath(login, filePath))), e.toString()); }
+        catch (const FatalSshError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(getSftpDisplayPath(login, filePath))), e.toString()); } //SSH session corrupted! => stop using session
+    }
+
+    const std::shared_ptr<ChunkState> state_ = std::make_shared<ChunkState>();
+    int64_t bytesReported_ = 0;
+    std::vector<InterruptibleThread> workers_; //[!] life time must be subset of state_ => declare last! (~InterruptibleThread() stops and joins)
+};
+
+//===========================================================================================================================
+
+struct InputStreamSftp : public AFS::InputStream
+{
+    InputStreamSftp(const SftpLogin& login, const AfsPath& filePath, const IoCallback& notifyUnbufferedIO /*throw X*/) : //throw FileError
+        login_(login),
+        filePath_(filePath),
+        displayPath_(getSftpDisplayPath(login, filePath)),
+        notifyUnbufferedIO_(notifyUnbufferedIO)
+    {
+        try
+        {
+            session_ = getSharedSftpSession(login); //throw SysError
+
+            const auto openStartTime = std::chrono::steady_clock::now();
+
+            session_->executeBlocking("libssh2_sftp_open", //throw SysError, FatalSshError
+                                      [&](const SshSession::Details& sd) //noexcept!
+            {
+                fileHandle_ = ::libssh2_sftp_open(sd.sftpChannel, getLibssh2Path(filePath), LIBSSH2_FXF_READ, 0);
+                if (!fileHandle_)
+                    return std::min(::libssh2_session_last_errno(sd.sshSession), LIBSSH2_ERROR_SOCKET_NONE);
+                return LIBSSH2_ERROR_NONE;
+            });
+
+            readWindow_ = SftpTransferWindow(MAX_SFTP_READ_SIZE, SFTP_OPTIMAL_BLOCK_SIZE_READ / MAX_SFTP_READ_SIZE, session_->getTransferLimits().readRequestsMax,
+                                             std::chrono::steady_clock::now() - openStartTime);
+        }
+        catch (const SysError&      e) { throw FileError(replaceCpy(_("Cannot open file %x."), L"%x", fmtPath(displayPath_)), e.toString()); }
+        catch (const FatalSshError& e) { throw FileError(replaceCpy(_("Cannot open file %x."), L"%x", fmtPath(displayPath_)), e.toString()); } //SSH session corrupted! => stop using session
+    }
+
+    ~InputStreamSftp()
+    {
+        try
+        {
+            session_->executeBlocking("libssh2_sftp_close", //throw SysError, FatalSshError
+            [&](const SshSession::Details& sd) { return ::libssh2_sftp_close(fileHandle_); }); //noexcept!
+        }
+        catch (const SysError&) {}
+        catch (const FatalSshError&) {} //SSH session corrupted! => stop using session
+
+        releaseIoBuffer(std::move(memBuf_));
+    }
+
+    size_t read(void* buffer, size_t bytesToRead) override //throw FileError, (ErrorFileLocked), X; return "bytesToRead" bytes unless end of stream!
+    {
+        assert(bufPos_ <= bufPosEnd_ && bufPosEnd_ <= memBuf_.size());
+
+        auto       it    = static_cast<std::byte*>(buffer);
+        const auto itEnd = it + bytesToRead;
+        for (;;)
+        {
+            const size_t junkSize = std::min(static_cast<size_t>(itEnd - it), bufPosEnd_ - bufPos_);
+            std::memcpy(it, &memBuf_[0] + bufPos_, junkSize);
+            bufPos_ += junkSize;
+            it      += junkSize;
+
+            if (it == itEnd)
+                break;
+            //--------------------------------------------------------------------
+            if (fillBuffer() == 0) //throw FileError, X
+                break; //end of file
+        }
+        return it - static_cast<std::byte*>(buffer);
+    }
+
+    bool supportsReadBorrowed() const override { return true; }
+
+    std::span<const std::byte> readBorrowed() override //throw FileError, (ErrorFileLocked), X
+    {
+        assert(bufPos_ <= bufPosEnd_ && bufPosEnd_ <= memBuf_.size());
+
+        if (bufPos_ == bufPosEnd_)
+            fillBuffer(); //throw FileError, X
+
+        const std::span<const std::byte> block(memBuf_.data() + bufPos_, bufPosEnd_ - bufPos_); //empty: end of file
+        bufPos_ = bufPosEnd_;
+        return block;
+    }
+
+    size_t getBlockSize() const override { return SFTP_OPTIMAL_BLOCK_SIZE_READ; } //non-zero block size is AFS contract!
+
+    std::optional<AFS::StreamAttributes> getAttributesBuffered() override //throw FileError
+    {
+        return {}; //although have an SFTP stream handle, attribute access requires an extra (expensive) round-trip!
+        //PERF: test case 148 files, 1MB: overall copy time increases by 20% if libssh2_sftp_fstat() gets called per each file
+    }
+
+    bool supportsReadAt() const override { return true; }
+
+    size_t readAt(uint64_t offset, void* buffer, size_t bytesToRead) override //throw FileError, (ErrorFileLocked), X; return "bytesToRead" bytes unless end of stream!
+    {
+        try
+        {
+            //discards libssh2's read-ahead buffer => don't mix with read()
+            session_->executeBlocking("libssh2_sftp_seek64", //throw SysError, FatalSshError
+                                      [&](const SshSession::Details& sd) //noexcept!
+            {
+                ::libssh2_sftp_seek64(fileHandle_, offset);
+                return LIBSSH2_ERROR_NONE;
+            });
+        }
+        catch (const SysError&      e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(displayPath_)), e.toString()); }
+        catch (const FatalSshError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(displayPath_)), e.toString()); } //SSH session corrupted! => caller (will/should) stop using session
+
+        bufPos_ = bufPosEnd_ = 0;
+
+        auto       it    = static_cast<std::byte*>(buffer);
+        const auto itEnd = it + bytesToRead;
+        while (it != itEnd)
+        {
+            memBuf_.resize(readWindow_.size()); //window may have grown
+            const size_t bytesRead = tryRead(&memBuf_[0], memBuf_.size()); //throw FileError; may return short, only 0 means EOF! => CONTRACT: bytesToRead > 0
+            if (notifyUnbufferedIO_) notifyUnbufferedIO_(bytesRead); //throw X
+
+            if (bytesRead == 0) //end of file
+                break;
+
+            const size_t junkSize = std::min(static_cast<size_t>(itEnd - it), bytesRead);
+            std::memcpy(it, &memBuf_[0], junkSize);
+            it += junkSize;
+        }
+        return it - static_cast<std::byte*>(buffer);
+    }
+
+private:
+    size_t fillBuffer() //throw FileError, X; only 0 means EOF! => CONTRACT: buffer empty
+    {
+        assert(bufPos_ == bufPosEnd_);
+
+        if (!parallelDownload_ && login_.connectionsPerFileTransfer > 1 && streamPos_ >= SFTP_PARALLEL_TRANSFER_MIN_SIZE)
+            parallelDownload_ = std::make_unique<SftpParallelDownload>(login_, filePath_, streamPos_); //libssh2's read-ahead on fileHandle_ is discarded
+
+        size_t bytesRead = 0;
+        if (parallelDownload_)
+        {
+            memBuf_ = parallelDownload_->getNextChunk(notifyUnbufferedIO_); //throw FileError, X
+            bytesRead = memBuf_.size();
+        }
+        else
+        {
+            memBuf_.resize(readWindow_.size()); //window may have grown
+            bytesRead = tryRead(&memBuf_[0], memBuf_.size()); //throw FileError; may return short, only 0 means EOF! => CONTRACT: bytesToRead > 0
+
+            if (notifyUnbufferedIO_) notifyUnbufferedIO_(bytesRead); //throw X
+        }
+        bufPos_ = 0;
+        bufPosEnd_ = bytesRead;
+        streamPos_ += bytesRead;
+        return bytesRead;
+    }
+
+    size_t tryRead(void* buffer, size_t bytesToRead) //throw FileError; may return short, only 0 means EOF! => CONTRACT: bytesToRead > 0
+    {
+        //libssh2_sftp_read has same semantics as Posix read:
+        if (bytesToRead == 0) //"read() with a count of 0 returns zero" => indistinguishable from end of file! => check!
+            throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
+        assert(bytesToRead == readWindow_.size());
 
         ssize_t bytesRead = 0;
         try
         {
+            const auto readStartTime = std::chrono::steady_clock::now();
+            const auto readStartCpuTime = login_.autoZlib ? getThreadCpuTime() : std::chrono::nanoseconds();
+
             session_->executeBlocking("libssh2_sftp_read", //throw SysError, FatalSshError
                                       [&](const SshSession::Details& sd) //noexcept!
             {
@@ -1292,6 +2587,9 @@ private:
 
             if (static_cast<size_t>(bytesRead) > bytesToRead) //better safe than sorry
                 throw SysError(formatSystemError("libssh2_sftp_read", L"", L"Buffer overflow.")); //user should never see this
+
+            readWindow_.reportTransfer(readStartTime, bytesRead);
+            reportSftpTransfer(login_, bytesRead, readStartTime, readStartCpuTime);
         }
         catch (const SysError&      e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(displayPath_)), e.toString()); }
         catch (const FatalSshError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(displayPath_)), e.toString()); } //SSH session corrupted! => caller (will/should) stop using session
@@ -1299,12 +2597,17 @@ private:
         return bytesRead; //"zero indicates end of file"
     }
 
+    const SftpLogin login_;
+    const AfsPath filePath_;
     const std::wstring displayPath_;
     LIBSSH2_SFTP_HANDLE* fileHandle_ = nullptr;
     const IoCallback notifyUnbufferedIO_; //throw X
     std::shared_ptr<SftpSessionManager::SshSessionShared> session_;
+    uint64_t streamPos_ = 0; //read()
+    std::unique_ptr<SftpParallelDownload> parallelDownload_;
+    SftpTransferWindow readWindow_{MAX_SFTP_READ_SIZE, SFTP_OPTIMAL_BLOCK_SIZE_READ / MAX_SFTP_READ_SIZE, SFTP_PIPELINE_REQUESTS_MAX, std::chrono::nanoseconds(0)};
 
-    std::vector<std::byte> memBuf_ = std::vector<std::byte>(getBlockSize());
+    std::vector<std::byte> memBuf_ = getIoBuffer(readWindow_.size());
     size_t bufPos_    = 0; //buffered I/O; see file_io.cpp
     size_t bufPosEnd_ = 0; //
 };
@@ -1316,27 +2619,42 @@ struct OutputStreamSftp : public AFS::OutputStreamImpl
 {
     OutputStreamSftp(const SftpLogin& login, //throw FileError
                      const AfsPath& filePath,
+                     std::optional<uint64_t> streamSize,
                      std::optional<time_t> modTime,
-                     const IoCallback& notifyUnbufferedIO /*throw X*/) :
+                     const IoCallback& notifyUnbufferedIO /*throw X*/,
+                     std::optional<uint64_t> appendOffset = {}) : //resumed copy: continue writing existing file at its end
+        sessionId_(login),
         filePath_(filePath),
         displayPath_(getSftpDisplayPath(login, filePath)),
         modTime_(modTime),
-        notifyUnbufferedIO_(notifyUnbufferedIO)
+        notifyUnbufferedIO_(notifyUnbufferedIO),
+        chunkOffset_(appendOffset.value_or(0))
     {
         try
         {
             session_ = getSharedSftpSession(login); //throw SysError
 
+            const auto openStartTime = std::chrono::steady_clock::now();
+
             session_->executeBlocking("libssh2_sftp_open", //throw SysError, FatalSshError
                                       [&](const SshSession::Details& sd) //noexcept!
             {
                 fileHandle_ = ::libssh2_sftp_open(sd.sftpChannel, getLibssh2Path(filePath),
-                                                  LIBSSH2_FXF_WRITE | LIBSSH2_FXF_CREAT | LIBSSH2_FXF_EXCL,
+                                                  appendOffset ? LIBSSH2_FXF_WRITE : LIBSSH2_FXF_WRITE | LIBSSH2_FXF_CREAT | LIBSSH2_FXF_EXCL,
                                                   SFTP_DEFAULT_PERMISSION_FILE); //note: server may also apply umask! (e.g. 0022 for ffs.org)
                 if (!fileHandle_)
                     return std::min(::libssh2_session_last_errno(sd.sshSession), LIBSSH2_ERROR_SOCKET_NONE);
                 return LIBSSH2_ERROR_NONE;
             });
+
+            if (appendOffset) //no LIBSSH2_FXF_APPEND: not reliably supported by servers
+                seekSftpFile(*session_, fileHandle_, *appendOffset); //throw SysError, FatalSshError
+
+            writeWindow_ = SftpTransferWindow(MAX_SFTP_OUTGOING_SIZE, SFTP_OPTIMAL_BLOCK_SIZE_WRITE / MAX_SFTP_OUTGOING_SIZE, session_->getTransferLimits().writeRequestsMax,
+                                              std::chrono::steady_clock::now() - openStartTime);
+
+            if (login.connectionsPerFileTransfer > 1 && streamSize && *streamSize >= SFTP_PARALLEL_TRANSFER_MIN_SIZE)
+                parallelUpload_ = std::make_unique<SftpParallelUpload>(login, filePath); //noexcept
         }
         catch (const SysError&      e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayPath_)), e.toString()); }
         catch (const FatalSshError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayPath_)), e.toString()); } //SSH session corrupted! => stop using session
@@ -1348,33 +2666,42 @@ struct OutputStreamSftp : public AFS::OutputStreamImpl
 
     ~OutputStreamSftp()
     {
+        parallelUpload_.reset(); //stop workers *before* closing the file (and ~AFS::OutputStream() deleting it)
+
         if (fileHandle_)
             try
             {
                 close(); //throw FileError
             }
             catch (FileError&) {}
+
+        releaseIoBuffer(std::move(memBuf_));
     }
 
     void write(const void* buffer, size_t bytesToWrite) override //throw FileError, X
     {
-        const size_t blockSize = getBlockSize();
-        assert(memBuf_.size() >= blockSize);
+        if (parallelUpload_)
+            return writeParallel(buffer, bytesToWrite); //throw FileError, X
+
         assert(bufPos_ <= bufPosEnd_ && bufPosEnd_ <= memBuf_.size());
 
         auto       it    = static_cast<const std::byte*>(buffer);
         const auto itEnd = it + bytesToWrite;
         for (;;)
         {
-            if (memBuf_.size() - bufPos_ < blockSize) //support memBuf_.size() > blockSize to reduce memmove()s, but perf test shows: not really needed!
-                // || bufPos_ == bufPosEnd_) -> not needed while memBuf_.size() == blockSize
+            const size_t windowSize = writeWindow_.size();
+            if (memBuf_.size() < windowSize) //window has grown
+                memBuf_.resize(windowSize);
+
+            if (memBuf_.size() - bufPos_ < windowSize) //support memBuf_.size() > windowSize to reduce memmove()s, but perf test shows: not really needed!
+                // || bufPos_ == bufPosEnd_) -> not needed while memBuf_.size() == windowSize
             {
                 std::memmove(&memBuf_[0], &memBuf_[0] + bufPos_, bufPosEnd_ - bufPos_);
                 bufPosEnd_ -= bufPos_;
                 bufPos_ = 0;
             }
 
-            const size_t junkSize = std::min(static_cast<size_t>(itEnd - it), blockSize - (bufPosEnd_ - bufPos_));
+            const size_t junkSize = std::min(static_cast<size_t>(itEnd - it), windowSize - (bufPosEnd_ - bufPos_));
             std::memcpy(&memBuf_[0] + bufPosEnd_, it, junkSize);
             bufPosEnd_ += junkSize;
             it         += junkSize;
@@ -1382,15 +2709,59 @@ struct OutputStreamSftp : public AFS::OutputStreamImpl
             if (it == itEnd)
                 return;
             //--------------------------------------------------------------------
-            const size_t bytesWritten = tryWrite(&memBuf_[bufPos_], blockSize); //throw FileError; may return short! CONTRACT: bytesToWrite > 0
+            const size_t bytesWritten = tryWrite(&memBuf_[bufPos_], windowSize); //throw FileError; may return short! CONTRACT: bytesToWrite > 0
+            bufPos_ += bytesWritten;
+            if (notifyUnbufferedIO_) notifyUnbufferedIO_(bytesWritten); //throw X!
+        }
+    }
+
+    std::span<std::byte> getWriteBuffer() override //throw FileError, X
+    {
+        if (parallelUpload_)
+            return {}; //chunks are moved to the upload workers => nothing to lend
+
+        assert(bufPos_ <= bufPosEnd_ && bufPosEnd_ <= memBuf_.size());
+
+        const size_t windowSize = writeWindow_.size();
+        if (memBuf_.size() < windowSize) //window has grown
+            memBuf_.resize(windowSize);
+
+        if (bufPosEnd_ - bufPos_ == windowSize) //buffer full: same as write()
+        {
+            const size_t bytesWritten = tryWrite(&memBuf_[bufPos_], windowSize); //throw FileError; may return short! CONTRACT: bytesToWrite > 0
             bufPos_ += bytesWritten;
             if (notifyUnbufferedIO_) notifyUnbufferedIO_(bytesWritten); //throw X!
         }
+
+        if (memBuf_.size() - bufPos_ < windowSize)
+        {
+            std::memmove(&memBuf_[0], &memBuf_[0] + bufPos_, bufPosEnd_ - bufPos_);
+            bufPosEnd_ -= bufPos_;
+            bufPos_ = 0;
+        }
+        return {&memBuf_[0] + bufPosEnd_, windowSize - (bufPosEnd_ - bufPos_)};
+    }
+
+    void commitWrite(size_t bytesWritten) override //throw FileError, X
+    {
+        if (parallelUpload_ || bufPosEnd_ + bytesWritten > memBuf_.size() || bufPosEnd_ - bufPos_ + bytesWritten > writeWindow_.size())
+            throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
+
+        bufPosEnd_ += bytesWritten; //written to the wire by next getWriteBuffer(), write() or finalize()
     }
 
     AFS::FinalizeResult finalize() override //throw FileError, X
     {
-        assert(bufPosEnd_ - bufPos_ <= getBlockSize());
+        if (parallelUpload_)
+        {
+            if (!chunkBuf_.empty())
+                parallelUpload_->writeChunk(chunkOffset_, std::move(chunkBuf_), notifyUnbufferedIO_); //throw FileError, X
+
+            parallelUpload_->finish(notifyUnbufferedIO_); //throw FileError, X
+            parallelUpload_.reset();
+        }
+
+        assert(bufPosEnd_ - bufPos_ <= writeWindow_.size());
         assert(bufPos_ <= bufPosEnd_ && bufPosEnd_ <= memBuf_.size());
         while (bufPos_ != bufPosEnd_)
         {
@@ -1399,26 +2770,41 @@ struct OutputStreamSftp : public AFS::OutputStreamImpl
             if (notifyUnbufferedIO_) notifyUnbufferedIO_(bytesWritten); //throw X!
         }
 
-        //~OutputStreamSftp() would call this one, too, but we want to propagate errors if any:
-        close(); //throw FileError
-
         //it seems libssh2_sftp_fsetstat() triggers bugs on synology server => set mtime by path! https://freefilesync.org/forum/viewtopic.php?t=1281
+        /* is setting modtime after closing the file handle a pessimization?
+            SFTP: no, needed for functional correctness (synology server), same as for Native
+            => but no need to wait for the close response: pipeline SETSTAT right behind CLOSE (server processes requests in order) */
 
         AFS::FinalizeResult result;
         //result.filePrint = ... -> not supported by SFTP
-        try
-        {
-            setModTimeIfAvailable(); //throw FileError, follows symlinks
-            /* is setting modtime after closing the file handle a pessimization?
-                SFTP: no, needed for functional correctness (synology server), same as for Native */
-        }
-        catch (const FileError& e) { result.errorModTime = e; /*slicing?*/ }
+
+        //~OutputStreamSftp() would call close(), too, but we want to propagate errors if any:
+        if (const std::optional<FileError> errorModTime = closeAndSetModTime()) //throw FileError, follows symlinks
+            result.errorModTime = *errorModTime;
 
         return result;
     }
 
 private:
-    size_t getBlockSize() const { return SFTP_OPTIMAL_BLOCK_SIZE_WRITE; } //non-zero block size is AFS contract!
+    void writeParallel(const void* buffer, size_t bytesToWrite) //throw FileError, X
+    {
+        auto       it    = static_cast<const std::byte*>(buffer);
+        const auto itEnd = it + bytesToWrite;
+        while (it != itEnd)
+        {
+            const size_t junkSize = std::min(static_cast<size_t>(itEnd - it), SFTP_PARALLEL_CHUNK_SIZE - chunkBuf_.size());
+            chunkBuf_.insert(chunkBuf_.end(), it, it + junkSize);
+            it += junkSize;
+
+            if (chunkBuf_.size() == SFTP_PARALLEL_CHUNK_SIZE)
+            {
+                parallelUpload_->writeChunk(chunkOffset_, std::move(chunkBuf_), notifyUnbufferedIO_); //throw FileError, X
+                chunkOffset_ += SFTP_PARALLEL_CHUNK_SIZE;
+                chunkBuf_.clear(); //moved-from vector: valid but unspecified state
+                chunkBuf_.reserve(SFTP_PARALLEL_CHUNK_SIZE);
+            }
+        }
+    }
 
     void close() //throw FileError
     {
@@ -1435,15 +2821,95 @@ private:
         catch (const FatalSshError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayPath_)), e.toString()); } //SSH session corrupted! => caller (will/should) stop using session
     }
 
+    //return failure to set modification time
+    std::optional<FileError> closeAndSetModTime() //throw FileError, follows symlinks
+    {
+        if (!modTime_)
+        {
+            close(); //throw FileError
+            return std::nullopt;
+        }
+
+        LIBSSH2_SFTP_ATTRIBUTES attribNew = {};
+        attribNew.flags = LIBSSH2_SFTP_ATTR_ACMODTIME;
+        attribNew.mtime = static_cast<decltype(attribNew.mtime)>(*modTime_);        //32-bit target! loss of data!
+        attribNew.atime = static_cast<decltype(attribNew.atime)>(::time(nullptr));  //
+
+        std::optional<std::wstring> closeError;
+        std::optional<std::wstring> setstatError;
+        try
+        {
+            if (!fileHandle_)
+                throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
+            ZEN_ON_SCOPE_EXIT(fileHandle_ = nullptr);
+
+            bool closeDone   = false;
+            bool setstatDone = false;
+            bool setstatSent = false;
+
+            session_->executeBlocking("libssh2_sftp_close", //throw SysError, FatalSshError
+                                      [&](const SshSession::Details& sd) //noexcept!
+            {
+                auto continueClose = [&] //return LIBSSH2_ERROR_NONE when completed
+                {
+                    const int rc = ::libssh2_sftp_close(fileHandle_);
+                    if (rc == LIBSSH2_ERROR_SFTP_PROTOCOL) //don't return yet: SETSTAT may be pending
+                        closeError = formatSystemError("libssh2_sftp_close", formatSshStatusCode(rc), formatSftpStatusCode(::libssh2_sftp_last_error(sd.sftpChannel)));
+                    else if (rc < 0)
+                        return rc;
+                    closeDone = true;
+                    return LIBSSH2_ERROR_NONE;
+                };
+
+                if (!closeDone)
+                    if (const int rc = continueClose();
+                        rc != LIBSSH2_ERROR_NONE)
+                        if (rc != LIBSSH2_ERROR_EAGAIN || setstatDone ||
+                            (!setstatSent && (::libssh2_session_block_directions(sd.sshSession) & LIBSSH2_SESSION_BLOCK_OUTBOUND))) //CLOSE not yet completely sent: don't interleave packets!
+                            return rc; //SSH session error => session is not reused
+
+                if (!setstatDone)
+                {
+                    const int rc = ::libssh2_sftp_setstat(sd.sftpChannel, getLibssh2Path(filePath_), &attribNew);
+                    setstatSent = true;
+                    if (rc == LIBSSH2_ERROR_EAGAIN)
+                        return rc;
+                    setstatDone = true;
+
+                    if (rc == LIBSSH2_ERROR_SFTP_PROTOCOL)
+                        setstatError = formatSystemError("libssh2_sftp_setstat", formatSshStatusCode(rc), formatSftpStatusCode(::libssh2_sftp_last_error(sd.sftpChannel)));
+                    else if (rc < 0)
+                        return rc;
+                }
+
+                if (!closeDone) //last libssh2 call must be the pending one: block directions are evaluated by waitForTraffic()
+                    return continueClose();
+                return LIBSSH2_ERROR_NONE;
+            });
+        }
+        catch (const SysError&      e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayPath_)), e.toString()); }
+        catch (const FatalSshError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayPath_)), e.toString()); } //SSH session corrupted! => caller (will/should) stop using session
+
+        if (closeError)
+            throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayPath_)), *closeError);
+
+        if (setstatError)
+            return FileError(replaceCpy(_("Cannot write modification time of %x."), L"%x", fmtPath(displayPath_)), *setstatError);
+        return std::nullopt;
+    }
+
     size_t tryWrite(const void* buffer, size_t bytesToWrite) //throw FileError; may return short! CONTRACT: bytesToWrite > 0
     {
         if (bytesToWrite == 0)
             throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
-        assert(bytesToWrite <= getBlockSize());
+        assert(bytesToWrite <= writeWindow_.size());
 
         ssize_t bytesWritten = 0;
         try
         {
+            const auto writeStartTime = std::chrono::steady_clock::now();
+            const auto writeStartCpuTime = sessionId_.autoZlib ? getThreadCpuTime() : std::chrono::nanoseconds();
+
             session_->executeBlocking("libssh2_sftp_write", //throw SysError, FatalSshError
                                       [&](const SshSession::Details& sd) //noexcept!
             {
@@ -1453,6 +2919,9 @@ private:
 
             if (bytesWritten > static_cast<ssize_t>(bytesToWrite)) //better safe than sorry
                 throw SysError(formatSystemError("libssh2_sftp_write", L"", L"Buffer overflow."));
+
+            writeWindow_.reportTransfer(writeStartTime, bytesWritten);
+            reportSftpTransfer(sessionId_, bytesWritten, writeStartTime, writeStartCpuTime);
         }
         catch (const SysError&      e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayPath_)), e.toString()); }
         catch (const FatalSshError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayPath_)), e.toString()); } //SSH session corrupted! => caller (will/should) stop using session
@@ -1461,40 +2930,372 @@ private:
         return bytesWritten;
     }
 
-    void setModTimeIfAvailable() const //throw FileError, follows symlinks
-    {
-        assert(!fileHandle_);
-        if (modTime_)
-        {
-            LIBSSH2_SFTP_ATTRIBUTES attribNew = {};
-            attribNew.flags = LIBSSH2_SFTP_ATTR_ACMODTIME;
-            attribNew.mtime = static_cast<decltype(attribNew.mtime)>(*modTime_);        //32-bit target! loss of data!
-            attribNew.atime = static_cast<decltype(attribNew.atime)>(::time(nullptr));  //
-
-            try
-            {
-                session_->executeBlocking("libssh2_sftp_setstat", //throw SysError, FatalSshError
-                [&](const SshSession::Details& sd) { return ::libssh2_sftp_setstat(sd.sftpChannel, getLibssh2Path(filePath_), &attribNew); }); //noexcept!
-            }
-            catch (const SysError&      e) { throw FileError(replaceCpy(_("Cannot write modification time of %x."), L"%x", fmtPath(displayPath_)), e.toString()); }
-            catch (const FatalSshError& e) { throw FileError(replaceCpy(_("Cannot write modification time of %x."), L"%x", fmtPath(displayPath_)), e.toString()); } //SSH session corrupted! => caller (will/should) stop using session
-        }
-    }
-
+    const SshSessionId sessionId_;
     const AfsPath filePath_;
     const std::wstring displayPath_;
     LIBSSH2_SFTP_HANDLE* fileHandle_ = nullptr;
     const std::optional<time_t> modTime_;
     const IoCallback notifyUnbufferedIO_; //throw X
     std::shared_ptr<SftpSessionManager::SshSessionShared> session_;
+    SftpTransferWindow writeWindow_{MAX_SFTP_OUTGOING_SIZE, SFTP_OPTIMAL_BLOCK_SIZE_WRITE / MAX_SFTP_OUTGOING_SIZE, SFTP_PIPELINE_REQUESTS_MAX, std::chrono::nanoseconds(0)};
 
-    std::vector<std::byte> memBuf_ = std::vector<std::byte>(getBlockSize());
+    std::vector<std::byte> memBuf_ = getIoBuffer(writeWindow_.size());
     size_t bufPos_    = 0; //buffered I/O see file_io.cpp
     size_t bufPosEnd_ = 0; //
+
+    std::unique_ptr<SftpParallelUpload> parallelUpload_;
+    std::vector<std::byte> chunkBuf_; //parallel upload
+    uint64_t chunkOffset_;            //
 };
 
 //===========================================================================================================================
 
+/*  delta update of large files (SFTP login option "|delta"):
+    1. server: stream target into temp file, calculating SHA-256 per block on the fly: "split --filter" (GNU coreutils) via SSH exec channel
+    2. client: read source, upload only those blocks into the temp file whose hash differs, cut off remainder
+    => upload bandwidth ~ size of changed blocks (+ 68 bytes hash download per block)
+
+    blocks are compared at fixed offsets only (no rolling checksum): temp file is patched in place, so a shifted match would be of no use
+    => ideal for in-place modifications (databases, VM images), no savings after insertions/deletions that shift the remaining data    */
+const size_t   SFTP_DELTA_BLOCK_SIZE = 1024 * 1024;
+const uint64_t SFTP_DELTA_MIN_SIZE   = 64 * 1024 * 1024; //not worth the extra round trips for smaller files
+
+
+//returns SHA-256 (32 raw bytes) for all blocks of the temp file, or none if not supported by server, e.g. no shell access (=> temp file cleaned up)
+std::optional<std::vector<std::string>> copyToTempWithBlockHashes(const SftpLogin& login, const AfsPath& afsTarget, const AfsPath& afsTargetTmp, uint64_t targetSize) //noexcept
+{
+    try
+    {
+        const std::shared_ptr<SftpSessionManager::SshSessionShared> session = getSharedSftpSession(login); //throw SysError
+
+        //"tee" has the temp file written block by block => command keeps sending output (hashes) and won't run into the SFTP time out
+        const std::string output = runSshCommand(*session, "env T=" + quoteShellArg(getLibssh2Path(afsTargetTmp)) + //throw SysError, FatalSshError
+                                                 " split -b " + numberTo<std::string>(SFTP_DELTA_BLOCK_SIZE) + " --filter='tee -a -- \"$T\" | sha256sum'" +
+                                                 " -- " + quoteShellArg(getLibssh2Path(afsTarget)) + " 2>/dev/null",
+                                                 static_cast<size_t>(2 * (targetSize / SFTP_DELTA_BLOCK_SIZE + 1) * 68)); //allow target to grow while waiting
+
+        auto getFileSize = [&](const AfsPath& afsPath) //throw SysError, FatalSshError
+        {
+            LIBSSH2_SFTP_ATTRIBUTES attribs = {};
+            session->executeBlocking("libssh2_sftp_stat", //throw SysError, FatalSshError
+            [&](const SshSession::Details& sd) { return ::libssh2_sftp_stat(sd.sftpChannel, getLibssh2Path(afsPath), &attribs); }); //noexcept!
+
+            if ((attribs.flags & LIBSSH2_SFTP_ATTR_SIZE) == 0)
+                throw SysError(formatSystemError("libssh2_sftp_stat", L"", L"File size not available."));
+            return static_cast<uint64_t>(attribs.filesize);
+        };
+        //- temp file incomplete, e.g. disk full? ("tee" failing inside the filter is not reported by split)
+        //- temp file not where SFTP sees it, e.g. chroot?
+        //- target changed size in the meantime?
+        const uint64_t tmpSize = getFileSize(afsTargetTmp); //throw SysError, FatalSshError
+        if (tmpSize == 0 || tmpSize != getFileSize(afsTarget)) //throw SysError, FatalSshError
+            throw SysError(L"Temporary file size mismatch.");
+
+        std::vector<std::string> blockHashes;
+        for (const std::string& line : split(output, '\n', SplitOnEmpty::skip))
+        {
+            //sha256sum: "<64 hex digits>  -"
+            if (line.size() != 64 + 3 || line.compare(64, 3, "  -") != 0 ||
+                !std::all_of(line.begin(), line.begin() + 64, [](char c) { return isHexDigit(c); }))
+                throw SysError(L"Unexpected command output.");
+
+            std::string& hash = blockHashes.emplace_back();
+            for (size_t i = 0; i < 64; i += 2)
+                hash += unhexify(line[i], line[i + 1]);
+        }
+        if (blockHashes.size() != (tmpSize + SFTP_DELTA_BLOCK_SIZE - 1) / SFTP_DELTA_BLOCK_SIZE)
+            throw SysError(L"Unexpected command output.");
+
+        return blockHashes;
+    }
+    catch (const SysError&) {}
+    catch (const FatalSshError&) {} //SSH session corrupted! => stop using session
+
+    try
+    {
+        runSftpCommand(login, "libssh2_sftp_unlink", //throw SysError
+        [&](const SshSession::Details& sd) { return ::libssh2_sftp_unlink(sd.sftpChannel, getLibssh2Path(afsTargetTmp)); }); //noexcept!
+    }
+    catch (const SysError&) {} //not existing (e.g. exec not available)
+    return {};
+}
+
+//===========================================================================================================================
+
+/*  server-side file copy within the same server (SFTP login option "|remotecopy"): "cp" via SSH exec channel
+    => no download + upload, e.g. for versioning or when re-organizing folders on the server
+    (libssh2 has no generic SFTP extension support => "copy-data" extension not available)
+
+    - "cp" in background, printing a dot per second => command keeps sending output and won't run into the SFTP time out
+    - run by "sh": login shell may be csh/fish
+    - already existing target: fail (exit code 17) without touching it => caller falls back to stream copy, which reports the proper error
+    - returns none if not supported => fall back to stream copy                                                                                */
+std::optional<AFS::FileCopyResult> copyFileOnServer(const SftpLogin& login, const AfsPath& afsSource, const AFS::StreamAttributes& attrSource, const AfsPath& afsTarget) //throw FileError
+{
+    try
+    {
+        const std::shared_ptr<SftpSessionManager::SshSessionShared> session = getSharedSftpSession(login); //throw SysError
+
+        runSshCommand(*session, "sh -c " + quoteShellArg("[ -e \"$2\" ] && exit 17; "
+                                                         "cp -- \"$1\" \"$2\" 2>/dev/null & p=$!; "
+                                                         "while kill -0 $p 2>/dev/null; do echo .; sleep 1; done; "
+                                                         "if wait $p; then touch -c -r \"$1\" -- \"$2\" 2>/dev/null; exit 0; fi; "
+                                                         "rm -f -- \"$2\"; exit 1") +
+                      " sh " + quoteShellArg(getLibssh2Path(afsSource)) + ' ' + quoteShellArg(getLibssh2Path(afsTarget)),
+                      10 * 1024 * 1024); //throw SysError, FatalSshError
+
+        auto getFileAttributes = [&](const AfsPath& afsPath) //throw SysError, FatalSshError
+        {
+            LIBSSH2_SFTP_ATTRIBUTES attribs = {};
+            session->executeBlocking("libssh2_sftp_stat", //throw SysError, FatalSshError
+            [&](const SshSession::Details& sd) { return ::libssh2_sftp_stat(sd.sftpChannel, getLibssh2Path(afsPath), &attribs); }); //noexcept!
+
+            if ((attribs.flags & LIBSSH2_SFTP_ATTR_SIZE) == 0 || (attribs.flags & LIBSSH2_SFTP_ATTR_ACMODTIME) == 0)
+                throw SysError(formatSystemError("libssh2_sftp_stat", L"", L"File attributes not available."));
+            return attribs;
+        };
+        const LIBSSH2_SFTP_ATTRIBUTES attrSrc = getFileAttributes(afsSource); //throw SysError, FatalSshError
+        LIBSSH2_SFTP_ATTRIBUTES attrTrg = {};
+        try
+        {
+            attrTrg = getFileAttributes(afsTarget); //throw SysError, FatalSshError
+        }
+        catch (const SysError& e) //target not where SFTP sees it, e.g. chroot? => don't fall back into creating a second copy
+        {
+            throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(getSftpDisplayPath(login, afsTarget))), e.toString());
+        }
+
+        if (attrTrg.filesize != attrSrc.filesize) //source changed in the meantime?
+        {
+            runSftpCommand(login, "libssh2_sftp_unlink", //throw SysError
+            [&](const SshSession::Details& sd) { return ::libssh2_sftp_unlink(sd.sftpChannel, getLibssh2Path(afsTarget)); }); //noexcept!
+            return {};
+        }
+
+        AFS::FileCopyResult result;
+        result.fileSize        = attrTrg.filesize;
+        result.modTime         = static_cast<time_t>(attrSrc.mtime);
+        result.sourceFilePrint = attrSource.filePrint;
+        if (attrTrg.mtime != attrSrc.mtime) //"touch -r" failed
+            result.errorModTime = FileError(replaceCpy(_("Cannot write modification time of %x."), L"%x", fmtPath(getSftpDisplayPath(login, afsTarget))));
+        return result;
+    }
+    catch (const SysError&) {} //e.g. exec not available, already existing
+    catch (const FatalSshError&) {} //SSH session corrupted! => stop using session
+    return {};
+}
+
+
+//POSIX ustar entry + pax extended header if needed (long name, negative time) => understood by GNU tar, bsdtar, BusyBox
+void appendTarEntry(std::string& stream, const std::string& itemName, time_t modTime, const std::string& data)
+{
+    auto appendEntry = [&](char typeFlag, const std::string& name, const std::string& content)
+    {
+        char header[512] = {};
+        auto setOctal = [&](size_t offset, size_t fieldSize, uint64_t num) //zero-padded + \0
+        { std::snprintf(header + offset, fieldSize, "%0*llo", static_cast<int>(fieldSize - 1), static_cast<unsigned long long>(num)); };
+
+        std::memcpy(header, name.c_str(), std::min<size_t>(name.size(), 100));
+        setOctal(100,  8, 0666); //mode: umask applies (see SFTP_DEFAULT_PERMISSION_FILE)
+        setOctal(108,  8, 0);    //uid
+        setOctal(116,  8, 0);    //gid
+        setOctal(124, 12, content.size());
+        setOctal(136, 12, std::max<time_t>(modTime, 0));
+        header[156] = typeFlag;
+        std::memcpy(header + 257, "ustar", 6); //magic (incl. \0)
+        std::memcpy(header + 263, "00", 2);    //version
+
+        std::memset(header + 148, ' ', 8); //checksum is calculated with blanks in its own field
+        unsigned int checkSum = 0;
+        for (const char c : header)
+            checkSum += static_cast<unsigned char>(c);
+        std::snprintf(header + 148, 7, "%06o", checkSum); //followed by \0 + blank
+        header[155] = ' ';
+
+        stream.append(header, sizeof(header));
+        stream += content;
+        stream.append((512 - content.size() % 512) % 512, '\0');
+    };
+
+    std::string paxRecords;
+    auto addPaxRecord = [&](const std::string& key, const std::string& value)
+    {
+        //"<length> <key>=<value>\n": length includes its own digits
+        const size_t recordLen = key.size() + value.size() + 3;
+        size_t lenTotal = recordLen + 1;
+        while (lenTotal != recordLen + numberTo<std::string>(lenTotal).size())
+            lenTotal = recordLen + numberTo<std::string>(lenTotal).size();
+
+        paxRecords += numberTo<std::string>(lenTotal) + ' ' + key + '=' + value + '\n';
+    };
+    if (itemName.size() > 100)
+        addPaxRecord("path", itemName);
+    if (modTime < 0)
+        addPaxRecord("mtime", numberTo<std::string>(modTime));
+
+    if (!paxRecords.empty())
+        appendEntry('x', "PaxHeader", paxRecords);
+    appendEntry('0', itemName, data);
+}
+
+
+/*  bulk upload of small new files (SFTP login option "|bulkupload"): a single tar stream via SSH exec channel
+    => no open/write/close/setstat/rename round trips per file
+    - tar extracts into the target folder (modification time from tar header), then each file is renamed from its temp name and stat'ed
+    - tar fails (e.g. not installed, disk full): all extracted files are removed => none: caller copies file by file, which reports the proper errors
+    - requires shell access + tar + "stat -c" (GNU coreutils)
+    - record per file: <size> <mtime> <inode> '\0', or '!' <error message> '\0'                                                                  */
+std::optional<std::vector<std::variant<AFS::FileCopyResult, FileError>>> createNewFilesByTar(const SftpLogin& login, const AfsPath& afsFolder, //throw X
+                                                                                              const std::vector<AFS::BulkFileData>& files,
+                                                                                              const IoCallback& notifyUnbufferedIO /*throw X*/)
+{
+    std::string tarStream;
+    std::vector<std::pair<size_t /*stream offset*/, size_t /*size*/>> dataRanges; //report bytes of file data, not of the tar stream
+    std::string fileArgs;
+
+    for (const AFS::BulkFileData& file : files)
+    {
+        const std::string itemName    = utfTo<std::string>(file.itemName);
+        const std::string itemNameTmp = file.itemNameTmp.empty() ? itemName : utfTo<std::string>(file.itemNameTmp);
+
+        appendTarEntry(tarStream, itemNameTmp, file.modTime, file.data);
+        dataRanges.emplace_back(tarStream.size() - (file.data.size() + 511) / 512 * 512, file.data.size());
+        fileArgs += ' ' + quoteShellArg(itemNameTmp) + ' ' + quoteShellArg(itemName);
+    }
+    tarStream.append(2 * 512, '\0'); //end of archive
+
+    size_t streamPos = 0;
+    size_t rangeIdx = 0;
+    uint64_t dataBytesDone = 0;
+    uint64_t dataBytesReported = 0;
+    auto notifyTarWritten = [&](int64_t bytesDelta) //throw X
+    {
+        streamPos += bytesDelta;
+        for (; rangeIdx < dataRanges.size() && dataRanges[rangeIdx].first + dataRanges[rangeIdx].second <= streamPos; ++rangeIdx)
+            dataBytesDone += dataRanges[rangeIdx].second;
+
+        const uint64_t dataBytesWritten = dataBytesDone + (rangeIdx < dataRanges.size() && streamPos > dataRanges[rangeIdx].first ? streamPos - dataRanges[rangeIdx].first : 0);
+        if (notifyUnbufferedIO) notifyUnbufferedIO(dataBytesWritten - dataBytesReported); //throw X
+        dataBytesReported = dataBytesWritten;
+    };
+
+    std::string output;
+    try
+    {
+        const std::shared_ptr<SftpSessionManager::SshSessionShared> session = getSharedSftpSession(login); //throw SysError
+
+        runSshCommand(*session, "sh -c " + quoteShellArg("cd -- \"$1\" || exit 1; shift; "  //throw SysError, FatalSshError, X
+                                                          "if ! tar -x --no-same-owner --no-same-permissions -f - >/dev/null 2>&1; then "
+                                                          "while [ $# -gt 1 ]; do rm -f -- \"$1\"; shift 2; done; exit 1; fi; "
+                                                          "while [ $# -gt 1 ]; do "
+                                                          "if [ \"$1\" != \"$2\" ] && ! e=$(mv -f -- \"$1\" \"$2\" 2>&1); then rm -f -- \"$1\"; printf '!%s\\0' \"$e\"; "
+                                                          "elif s=$(stat -c '%s %Y %i' -- \"$2\" 2>&1); then printf '%s\\0' \"$s\"; "
+                                                          "else printf '!%s\\0' \"$s\"; fi; "
+                                                          "shift 2; done") +
+                      " sh " + quoteShellArg(getLibssh2Path(afsFolder)) + fileArgs,
+                      [&](const char* data, size_t size) //throw SysError
+        {
+            output.append(data, size);
+            if (output.size() > 1024 * 1024)
+                throw SysError(formatSystemError("libssh2_channel_read", L"", L"Unexpected size of command output."));
+        },
+        tarStream, notifyTarWritten); //throw X
+    }
+    catch (const SysError&) { return {}; } //e.g. exec not available, no tar
+    catch (const FatalSshError&) { return {}; } //SSH session corrupted! => stop using session
+
+    const std::vector<std::string> records = split(output, '\0', SplitOnEmpty::allow);
+
+    std::vector<std::variant<AFS::FileCopyResult, FileError>> results;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        const AfsPath afsTarget(nativeAppendPaths(afsFolder.value, files[i].itemName));
+        const std::wstring errorMsg = replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(getSftpDisplayPath(login, afsTarget)));
+
+        const std::string record = i < records.size() ? records[i] : std::string();
+        const std::vector<std::string> fields = split(record, ' ', SplitOnEmpty::skip);
+
+        if (startsWith(record, '!') || fields.size() != 3)
+            results.emplace_back(FileError(errorMsg, utfTo<std::wstring>(startsWith(record, '!') ? record.substr(1) : record)));
+        else
+        {
+            AFS::FileCopyResult result;
+            result.fileSize = stringTo<uint64_t>(fields[0]);
+            result.modTime  = stringTo<time_t>(fields[1]);
+            if (login.remoteScan) //same file identity as reported by traverseFolderByAgent()
+                result.targetFilePrint = stringTo<AFS::FingerPrint>(fields[2]);
+
+            if (result.fileSize != files[i].data.size())
+                results.emplace_back(FileError(errorMsg, L"Unexpected size of extracted file."));
+            else
+            {
+                if (result.modTime != files[i].modTime) //tar could not set the modification time
+                {
+                    result.modTime = files[i].modTime;
+                    result.errorModTime = FileError(replaceCpy(_("Cannot write modification time of %x."), L"%x", fmtPath(getSftpDisplayPath(login, afsTarget))));
+                }
+                results.emplace_back(std::move(result));
+            }
+        }
+    }
+
+    //shell doesn't see the same paths as SFTP, e.g. chroot? => report all as failed: caller copies them via SFTP
+    for (size_t i = 0; i < files.size(); ++i)
+        if (std::holds_alternative<AFS::FileCopyResult>(results[i]))
+        {
+            const AfsPath afsTarget(nativeAppendPaths(afsFolder.value, files[i].itemName));
+            try
+            {
+                LIBSSH2_SFTP_ATTRIBUTES attribs = {};
+                runSftpCommand(login, "libssh2_sftp_stat", //throw SysError
+                [&](const SshSession::Details& sd) { return ::libssh2_sftp_stat(sd.sftpChannel, getLibssh2Path(afsTarget), &attribs); }); //noexcept!
+            }
+            catch (const SysError& e)
+            {
+                for (size_t j = 0; j < files.size(); ++j)
+                    results[j] = FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(getSftpDisplayPath(login, AfsPath(nativeAppendPaths(afsFolder.value, files[j].itemName))))), e.toString());
+            }
+            break; //one check per batch is enough
+        }
+
+    return results;
+}
+
+
+/*  SHA-256 of file content calculated on the server (SFTP login option "|remotehash"): "sha256sum" via SSH exec channel
+    => "compare by content" and copy verification don't need to download the file
+    - "sha256sum" in background, printing a dot per second: see copyFileOnServer()
+    - returns none if not supported => caller reads the file content as usual            */
+std::optional<std::string> getFileSha256OnServer(const SftpLogin& login, const AfsPath& afsPath) //noexcept
+{
+    try
+    {
+        const std::shared_ptr<SftpSessionManager::SshSessionShared> session = getSharedSftpSession(login); //throw SysError
+
+        const std::string output = runSshCommand(*session, "sh -c " + quoteShellArg("sha256sum < \"$1\" 2>/dev/null & p=$!; " //throw SysError, FatalSshError
+                                                                                     "while kill -0 $p 2>/dev/null; do echo .; sleep 1; done; "
+                                                                                     "wait $p") +
+                                                 " sh " + quoteShellArg(getLibssh2Path(afsPath)),
+                                                 1024 * 1024);
+
+        for (const std::string& line : split(output, '\n', SplitOnEmpty::skip))
+            //sha256sum: "<64 hex digits>  -"
+            if (line.size() == 64 + 3 && line.compare(64, 3, "  -") == 0 &&
+                std::all_of(line.begin(), line.begin() + 64, [](char c) { return isHexDigit(c); }))
+            {
+                std::string hash;
+                for (size_t i = 0; i < 64; i += 2)
+                    hash += unhexify(line[i], line[i + 1]);
+                return hash;
+            }
+    }
+    catch (const SysError&) {} //e.g. exec not available, no "sha256sum"
+    catch (const FatalSshError&) {} //SSH session corrupted! => stop using session
+    return {};
+}
+
+//===========================================================================================================================
+
 class SftpFileSystem : public AbstractFileSystem
 {
 public:
@@ -1699,7 +3500,34 @@ private:
                                                       std::optional<time_t> modTime,
                                                       const IoCallback& notifyUnbufferedIO /*throw X*/) const override
     {
-        return std::make_unique<OutputStreamSftp>(login_, afsPath, modTime, notifyUnbufferedIO); //throw FileError
+        return std::make_unique<OutputStreamSftp>(login_, afsPath, streamSize, modTime, notifyUnbufferedIO); //throw FileError
+    }
+
+    std::optional<uint64_t> getPartialFileSize(const AfsPath& afsPath) const override //noexcept
+    {
+        try
+        {
+            LIBSSH2_SFTP_ATTRIBUTES attribs = {};
+            runSftpCommand(login_, "libssh2_sftp_stat", //throw SysError
+            [&](const SshSession::Details& sd) { return ::libssh2_sftp_stat(sd.sftpChannel, getLibssh2Path(afsPath), &attribs); }); //noexcept!
+
+            if ((attribs.flags & LIBSSH2_SFTP_ATTR_SIZE) == 0 || ((attribs.flags & LIBSSH2_SFTP_ATTR_PERMISSIONS) && !LIBSSH2_SFTP_S_ISREG(attribs.permissions)))
+                return {};
+            return attribs.filesize;
+        }
+        catch (SysError&) { return {}; } //not existing: most likely case
+    }
+
+    std::unique_ptr<OutputStreamImpl> getOutputStreamAppend(const AfsPath& afsPath, //throw FileError
+                                                            std::optional<uint64_t> bytesToAppend,
+                                                            std::optional<time_t> modTime,
+                                                            const IoCallback& notifyUnbufferedIO /*throw X*/) const override
+    {
+        const std::optional<uint64_t> partialSize = getPartialFileSize(afsPath); //noexcept
+        if (!partialSize)
+            throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(getDisplayPath(afsPath))), L"File size not available.");
+
+        return std::make_unique<OutputStreamSftp>(login_, afsPath, bytesToAppend, modTime, notifyUnbufferedIO, *partialSize); //throw FileError
     }
 
     //----------------------------------------------------------------------------------------------------------------
@@ -1718,8 +3546,163 @@ private:
         if (copyFilePermissions)
             throw FileError(replaceCpy(_("Cannot write permissions of %x."), L"%x", fmtPath(AFS::getDisplayPath(apTarget))), _("Operation not supported by device."));
 
+        const SftpLogin& loginTrg = static_cast<const SftpFileSystem&>(apTarget.afsDevice.ref()).login_;
+
+        if (login_.remoteCopy && std::is_eq(static_cast<const SshSessionId&>(login_) <=> static_cast<const SshSessionId&>(loginTrg))) //same server + account
+            if (std::optional<FileCopyResult> result = copyFileOnServer(login_, afsSource, attrSource, apTarget.afsPath)) //throw FileError
+                return *result;
+
         //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
-        return copyFileAsStream(afsSource, attrSource, apTarget, notifyUnbufferedIO); //throw FileError, (ErrorFileLocked), X
+        return copyFileAsStream(afsSource, attrSource, apTarget, false /*calcContentHash*/, notifyUnbufferedIO); //throw FileError, (ErrorFileLocked), X
+    }
+
+    std::optional<FileCopyResult> updateFileDeltaAsTarget(const AfsPath& afsTarget, const std::optional<AfsPath>& afsTargetTmpOpt, //throw FileError, (ErrorFileLocked), X
+                                                          const AbstractPath& apSource, const StreamAttributes& attrSource, uint64_t targetSize,
+                                                          const std::optional<EqualPrefix>& equalPrefix /*unused: block hashes are calculated server-side anyway*/,
+                                                          bool calcContentHash, const IoCallback& notifyUnbufferedIO /*throw X*/) const override
+    {
+        if (!afsTargetTmpOpt || //patching the target in place: not supported
+            !login_.deltaTransfer ||
+            attrSource.fileSize < SFTP_DELTA_MIN_SIZE ||
+            targetSize          < SFTP_DELTA_MIN_SIZE)
+            return {};
+
+        const AfsPath& afsTargetTmp = *afsTargetTmpOpt;
+
+        const std::optional<std::vector<std::string>> blockHashes = copyToTempWithBlockHashes(login_, afsTarget, afsTargetTmp, targetSize); //noexcept
+        if (!blockHashes)
+            return {}; //=> fall back to full copy
+
+        //transactional behavior: ensure cleanup
+        ZEN_ON_SCOPE_FAIL(try { removeFilePlain(afsTargetTmp); /*throw FileError*/ }
+        catch (FileError&) {});
+
+        const std::wstring displayPathTmp = getDisplayPath(afsTargetTmp);
+
+        //unchanged blocks are neither written nor reported: count bytes read only
+        auto streamIn = AFS::getInputStream(apSource, notifyUnbufferedIO); //throw FileError, ErrorFileLocked
+
+        StreamAttributes attrSourceNew = attrSource;
+        //try to get the most current attributes if possible (input file might have changed after comparison!)
+        if (std::optional<StreamAttributes> attr = streamIn->getAttributesBuffered()) //throw FileError
+            attrSourceNew = *attr;
+
+        uint64_t bytesRead = 0;
+        std::string contentHash;
+        try
+        {
+            const std::shared_ptr<SftpSessionManager::SshSessionShared> session = getSharedSftpSession(login_); //throw SysError
+
+            const auto openStartTime = std::chrono::steady_clock::now();
+            LIBSSH2_SFTP_HANDLE* fileHandle = openSftpFile(*session, afsTargetTmp, LIBSSH2_FXF_WRITE); //throw SysError, FatalSshError; no truncation!
+            ZEN_ON_SCOPE_EXIT(if (fileHandle) closeSftpFile(*session, fileHandle));
+
+            SftpTransferWindow writeWindow(MAX_SFTP_OUTGOING_SIZE, SFTP_OPTIMAL_BLOCK_SIZE_WRITE / MAX_SFTP_OUTGOING_SIZE, session->getTransferLimits().writeRequestsMax,
+                                           std::chrono::steady_clock::now() - openStartTime);
+
+            std::optional<Sha256Hasher> hasher;
+            if (calcContentHash)
+                hasher.emplace(); //throw SysError
+
+            std::vector<std::byte> buf(SFTP_DELTA_BLOCK_SIZE);
+            for (size_t blockNo = 0;; ++blockNo)
+            {
+                const size_t blockSize = streamIn->read(buf.data(), buf.size()); //throw FileError, ErrorFileLocked, X
+                if (blockSize == 0)
+                    break;
+
+                if (hasher)
+                    hasher->update(buf.data(), blockSize); //throw SysError
+
+                Sha256Hasher blockHasher; //throw SysError
+                blockHasher.update(buf.data(), blockSize); //throw SysError
+
+                if (blockNo >= blockHashes->size() || blockHasher.finalize() != (*blockHashes)[blockNo]) //throw SysError
+                {
+                    seekSftpFile(*session, fileHandle, bytesRead); //throw SysError, FatalSshError
+
+                    size_t bytesWritten = 0;
+                    while (bytesWritten < blockSize)
+                    {
+                        const size_t bytesToWrite = std::min(blockSize - bytesWritten, writeWindow.size());
+
+                        const auto writeStartTime = std::chrono::steady_clock::now();
+                        ssize_t rv = 0;
+                        session->executeBlocking("libssh2_sftp_write", //throw SysError, FatalSshError
+                                                 [&](const SshSession::Details& sd) //noexcept!
+                        {
+                            rv = ::libssh2_sftp_write(fileHandle, reinterpret_cast<const char*>(&buf[bytesWritten]), bytesToWrite);
+                            return static_cast<int>(rv);
+                        });
+                        if (rv > static_cast<ssize_t>(bytesToWrite)) //better safe than sorry
+                            throw SysError(formatSystemError("libssh2_sftp_write", L"", L"Buffer overflow."));
+
+                        writeWindow.reportTransfer(writeStartTime, rv);
+                        bytesWritten += rv; //rv == 0 is no error according to doc!
+                    }
+                }
+                bytesRead += blockSize;
+
+                if (blockSize < buf.size()) //end of stream
+                    break;
+            }
+
+            if (hasher)
+                contentHash = hasher->finalize(); //throw SysError
+
+            //source smaller than target: cut off remainder
+            LIBSSH2_SFTP_ATTRIBUTES attribSize = {};
+            attribSize.flags    = LIBSSH2_SFTP_ATTR_SIZE;
+            attribSize.filesize = bytesRead;
+
+            session->executeBlocking("libssh2_sftp_fsetstat", //throw SysError, FatalSshError
+            [&](const SshSession::Details& sd) { return ::libssh2_sftp_fsetstat(fileHandle, &attribSize); }); //noexcept!
+
+            {
+                LIBSSH2_SFTP_HANDLE* fileHandleClose = fileHandle;
+                fileHandle = nullptr; //no second close on error
+                session->executeBlocking("libssh2_sftp_close", //throw SysError, FatalSshError
+                [&](const SshSession::Details& sd) { return ::libssh2_sftp_close(fileHandleClose); }); //noexcept!
+            }
+        }
+        catch (const SysError&      e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayPathTmp)), e.toString()); }
+        catch (const FatalSshError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayPathTmp)), e.toString()); } //SSH session corrupted! => stop using session
+
+        if (bytesRead != attrSourceNew.fileSize)
+            throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(AFS::getDisplayPath(apSource))),
+                            replaceCpy(replaceCpy(_("Unexpected size of data stream.\nExpected: %x bytes\nActual: %y bytes"),
+                                                  L"%x", formatNumber(attrSourceNew.fileSize)),
+                                       L"%y", formatNumber(bytesRead)));
+
+        std::optional<FileError> errorModTime;
+        try
+        {
+            LIBSSH2_SFTP_ATTRIBUTES attribNew = {};
+            attribNew.flags = LIBSSH2_SFTP_ATTR_ACMODTIME;
+            attribNew.mtime = static_cast<decltype(attribNew.mtime)>(attrSourceNew.modTime); //32-bit target! loss of data!
+            attribNew.atime = static_cast<decltype(attribNew.atime)>(::time(nullptr));       //
+
+            runSftpCommand(login_, "libssh2_sftp_setstat", //throw SysError
+            [&](const SshSession::Details& sd) { return ::libssh2_sftp_setstat(sd.sftpChannel, getLibssh2Path(afsTargetTmp), &attribNew); }); //noexcept!
+        }
+        catch (const SysError& e) { errorModTime = FileError(replaceCpy(_("Cannot write modification time of %x."), L"%x", fmtPath(displayPathTmp)), e.toString()); }
+
+        FileCopyResult cpResult;
+        cpResult.fileSize        = attrSourceNew.fileSize;
+        cpResult.modTime         = attrSourceNew.modTime;
+        cpResult.sourceFilePrint = attrSourceNew.filePrint;
+        cpResult.errorModTime    = std::move(errorModTime);
+        cpResult.contentHash     = std::move(contentHash);
+        return cpResult;
+    }
+
+    FileDigest getServerFileDigest(const AfsPath& afsPath) const override //throw FileError
+    {
+        FileDigest digest;
+        if (login_.remoteHash)
+            if (std::optional<std::string> sha256 = getFileSha256OnServer(login_, afsPath)) //noexcept
+                digest.sha256 = std::move(*sha256);
+        return digest;
     }
 
     //symlink handling: follow
@@ -1750,7 +3733,7 @@ private:
                                                         L"%y", L'\n' + fmtPath(AFS::getDisplayPath(pathTo)));
                                     };
 
-        if (compareDeviceSameAfsType(pathTo.afsDevice.ref()) != std::weak_ordering::equivalent)
+        if (!isMoveCompatibleSameAfsType(pathTo.afsDevice.ref()))
             throw ErrorMoveUnsupported(generateErrorMsg(), _("Operation not supported between different devices."));
 
         try
@@ -1778,6 +3761,10 @@ private:
         }
     }
 
+    //SFTP v3: no overwriting rename (see above); "posix-rename@openssh.com" is not exposed by libssh2
+    //=> and we've seen servers corrupting the session on unsupported extensions (see getFreeDiskSpace())
+    bool tryMoveAndReplaceFileForSameAfsType(const AfsPath& pathFrom, const AbstractPath& pathTo) const override { return false; } //throw FileError
+
     bool supportsPermissions(const AfsPath& afsPath) const override { return false; } //throw FileError
     //wait until there is real demand for copying from and to SFTP with permissions => use stream-based file copy:
 
@@ -1789,7 +3776,19 @@ private:
 
     int getAccessTimeout() const override { return login_.timeoutSec; } //returns "0" if no timeout in force
 
+    void prepareSessions(size_t sessionCount) const override { prepareSftpSessions(login_, sessionCount); } //noexcept
+
     bool hasNativeTransactionalCopy() const override { return false; }
+
+    bool hasServerSideCopy() const override { return login_.remoteCopy; } //see copyFileOnServer()
+
+    bool supportsBulkCopy() const override { return login_.bulkUpload; } //see createNewFilesByTar()
+
+    std::optional<std::vector<std::variant<FileCopyResult, FileError>>> createNewFilesBulk(const AfsPath& afsFolder, const std::vector<BulkFileData>& files, //throw X
+                                                                                          const IoCallback& notifyUnbufferedIO /*throw X*/) const override
+    {
+        return createNewFilesByTar(login_, afsFolder, files, notifyUnbufferedIO); //throw X
+    }
     //----------------------------------------------------------------------------------------------------------------
 
     int64_t getFreeDiskSpace(const AfsPath& afsPath) const override //throw FileError, returns < 0 if not available
@@ -1861,9 +3860,41 @@ Zstring concatenateSftpFolderPathPhrase(const SftpLogin& login, const AfsPath& a
     if (login.traverserChannelsPerConnection != loginDefault.traverserChannelsPerConnection)
         options += Zstr("|chan=") + numberTo<Zstring>(login.traverserChannelsPerConnection);
 
-    if (login.allowZlib)
+    if (login.connectionsPerFileTransfer != loginDefault.connectionsPerFileTransfer)
+        options += Zstr("|fileconn=") + numberTo<Zstring>(login.connectionsPerFileTransfer);
+
+    if (login.autoZlib)
+        options += Zstr("|zlib=auto");
+    else if (login.allowZlib)
         options += Zstr("|zlib");
 
+    if (login.socketBufferBytes > 0)
+        options += Zstr("|sockbuf=") + numberTo<Zstring>(login.socketBufferBytes);
+
+    if (login.socketNotSentLowAt > 0)
+        options += Zstr("|notsent=") + numberTo<Zstring>(login.socketNotSentLowAt);
+
+    if (!login.congestionControl.empty())
+        options += Zstr("|cc=") + login.congestionControl;
+
+    if (login.listingCache)
+        options += Zstr("|listcache");
+
+    if (login.deltaTransfer)
+        options += Zstr("|delta");
+
+    if (login.remoteCopy)
+        options += Zstr("|remotecopy");
+
+    if (login.remoteHash)
+        options += Zstr("|remotehash");
+
+    if (login.remoteScan)
+        options += Zstr("|remotescan");
+
+    if (login.bulkUpload)
+        options += Zstr("|bulkupload");
+
     switch (login.authType)
     {
         case SftpAuthType::password:
@@ -1914,9 +3945,13 @@ AfsDevice fff::condenseToSftpDevice(const SftpLogin& login) //noexcept
     trim(loginTmp.server);
     trim(loginTmp.username);
     trim(loginTmp.privateKeyFilePath);
+    trim(loginTmp.congestionControl);
 
     loginTmp.timeoutSec = std::max(1, loginTmp.timeoutSec);
+    loginTmp.socketBufferBytes  = std::max(0, loginTmp.socketBufferBytes);
+    loginTmp.socketNotSentLowAt = std::max(0, loginTmp.socketNotSentLowAt);
     loginTmp.traverserChannelsPerConnection = std::max(1, loginTmp.traverserChannelsPerConnection);
+    loginTmp.connectionsPerFileTransfer     = std::max(1, loginTmp.connectionsPerFileTransfer);
 
     if (startsWithAsciiNoCase(loginTmp.server, "http:" ) ||
         startsWithAsciiNoCase(loginTmp.server, "https:") ||
@@ -2011,13 +4046,15 @@ AbstractPath fff::createItemPathSftp(const Zstring& itemPathPhrase) //noexcept
     const Zstring port =  afterLast(serverPort, Zstr(':'), IfNotFoundReturn::none);
     login.port = stringTo<int>(port); //0 if empty
 
-    assert(login.allowZlib == false);
+    assert(login.allowZlib == false && login.autoZlib == false);
 
     for (const Zstring& optPhrase : split(options, Zstr('|'), SplitOnEmpty::skip))
         if (startsWith(optPhrase, Zstr("timeout=")))
             login.timeoutSec = stringTo<int>(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none));
         else if (startsWith(optPhrase, Zstr("chan=")))
             login.traverserChannelsPerConnection = stringTo<int>(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none));
+        else if (startsWith(optPhrase, Zstr("fileconn=")))
+            login.connectionsPerFileTransfer = stringTo<int>(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none));
         else if (startsWith(optPhrase, Zstr("keyfile=")))
         {
             login.authType = SftpAuthType::keyFile;
@@ -2029,6 +4066,26 @@ AbstractPath fff::createItemPathSftp(const Zstring& itemPathPhrase) //noexcept
             login.password = decodePasswordBase64(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none));
         else if (optPhrase == Zstr("zlib"))
             login.allowZlib = true;
+        else if (optPhrase == Zstr("zlib=auto"))
+            login.autoZlib = true;
+        else if (startsWith(optPhrase, Zstr("sockbuf=")))
+            login.socketBufferBytes = stringTo<int>(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none));
+        else if (startsWith(optPhrase, Zstr("notsent=")))
+            login.socketNotSentLowAt = stringTo<int>(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none));
+        else if (startsWith(optPhrase, Zstr("cc=")))
+            login.congestionControl = afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none);
+        else if (optPhrase == Zstr("listcache"))
+            login.listingCache = true;
+        else if (optPhrase == Zstr("delta"))
+            login.deltaTransfer = true;
+        else if (optPhrase == Zstr("remotecopy"))
+            login.remoteCopy = true;
+        else if (optPhrase == Zstr("remotehash"))
+            login.remoteHash = true;
+        else if (optPhrase == Zstr("remotescan"))
+            login.remoteScan = true;
+        else if (optPhrase == Zstr("bulkupload"))
+            login.bulkUpload = true;
         else
             assert(false);
 
@@ -37,6 +37,11 @@ struct SshSessionId
     Zstring password;           //authType == password or keyFile
     Zstring privateKeyFilePath; //authType == keyFile: use PEM-encoded private key (protected by password) for authentication
     bool allowZlib = false;
+    bool autoZlib  = false; //ignore allowZlib: measure the first transfers, then decide on compression for new sessions + prefer fast AEAD ciphers
+    //TCP tuning for high bandwidth-delay product links: see zen/socket.h
+    int socketBufferBytes = 0;  //0: OS auto-tuning
+    int socketNotSentLowAt = 0; //0: OS default
+    Zstring congestionControl;  //empty: OS default
 };
 const int DEFAULT_PORT_SFTP = 22;
 //SFTP default port: 22, see %WINDIR%\system32\drivers\etc\services
@@ -47,6 +52,13 @@ struct SftpLogin : SshSessionId
     //other settings not specific to SFTP session:
     int timeoutSec = 15;                    //valid range: [1, inf)
     int traverserChannelsPerConnection = 1; //valid range: [1, inf)
+    int connectionsPerFileTransfer = 1;     //valid range: [1, inf); > 1: transfer large files in chunks over parallel connections
+    bool listingCache = false;              //reuse folder listings of previous runs: see listing_cache.h
+    bool deltaTransfer = false;             //update large files by uploading changed blocks only: requires shell access (exec channel) + GNU coreutils on server
+    bool remoteCopy = false;                //copy files within the same server using "cp" instead of download + upload: requires shell access (exec channel)
+    bool remoteHash = false;                //"compare by content": get SHA-256 from "sha256sum" on server instead of downloading: requires shell access (exec channel)
+    bool remoteScan = false;                //list folder trees with a single "find" on server instead of SFTP round trips per folder: requires shell access (exec channel) + GNU find
+    bool bulkUpload = false;                //create small new files in batches via a tar stream instead of SFTP round trips per file: requires shell access (exec channel) + tar + GNU coreutils
 };
 AfsDevice condenseToSftpDevice(const SftpLogin& login); //noexcept; potentially messy user input
 SftpLogin extractSftpLogin(const AfsDevice& afsDevice); //noexcept
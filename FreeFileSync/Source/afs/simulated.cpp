@@ -0,0 +1,532 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "simulated.h"
+#include <random>
+#include <condition_variable>
+#include <zen/file_traverser.h>
+#include <zen/resolve_path.h>
+#include <zen/thread.h>
+#include "abstract_impl.h"
+#include "native.h"
+
+    #include <sys/stat.h>
+
+using namespace zen;
+using namespace fff;
+using AFS = AbstractFileSystem;
+
+
+namespace
+{
+const Zchar simPrefix[] = Zstr("sim:");
+
+
+struct SimConfig
+{
+    Zstring rootPath; //native folder
+    std::chrono::milliseconds latency{0};
+    int64_t bandwidth = 0; //bytes/sec; 0: unlimited
+    int errorsPerMille = 0;
+    size_t connectionsMax = 0; //0: unlimited
+    uint64_t seed = 0;
+};
+
+std::weak_ordering operator<=>(const SimConfig& lhs, const SimConfig& rhs)
+{
+    if (const std::weak_ordering cmp = compareNativePath(lhs.rootPath, rhs.rootPath);
+        cmp != std::weak_ordering::equivalent)
+        return cmp;
+
+    return std::tie(lhs.latency, lhs.bandwidth, lhs.errorsPerMille, lhs.connectionsMax, lhs.seed) <=>
+           std::tie(rhs.latency, rhs.bandwidth, rhs.errorsPerMille, rhs.connectionsMax, rhs.seed);
+}
+
+
+//state shared by all SimFileSystem instances with the same configuration (= same "server")
+class SimServer
+{
+public:
+    explicit SimServer(const SimConfig& cfg) : cfg_(cfg), rng_(cfg.seed) {}
+
+    class Connection //blocks while cfg.connectionsMax are in use
+    {
+    public:
+        explicit Connection(SimServer& server) : server_(server)
+        {
+            if (server_.cfg_.connectionsMax > 0)
+            {
+                std::unique_lock dummy(server_.lockConnections_);
+                server_.conditionConnectionFree_.wait(dummy, [&] { return server_.connectionsInUse_ < server_.cfg_.connectionsMax; });
+                ++server_.connectionsInUse_;
+            }
+        }
+
+        ~Connection()
+        {
+            if (server_.cfg_.connectionsMax > 0)
+            {
+                {
+                    std::lock_guard dummy(server_.lockConnections_);
+                    --server_.connectionsInUse_;
+                }
+                server_.conditionConnectionFree_.notify_one();
+            }
+        }
+
+    private:
+        Connection           (const Connection&) = delete;
+        Connection& operator=(const Connection&) = delete;
+
+        SimServer& server_;
+    };
+
+    void simulateRoundTrip() const
+    {
+        if (cfg_.latency > std::chrono::milliseconds(0))
+            std::this_thread::sleep_for(cfg_.latency); //not interruptible: keep latencies small
+    }
+
+    //shared link: streams of the device compete for the bandwidth
+    void simulateTransfer(size_t bytes)
+    {
+        if (cfg_.bandwidth > 0)
+        {
+            const auto transferTime = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(static_cast<double>(bytes) / cfg_.bandwidth));
+
+            std::chrono::steady_clock::time_point transferEnd;
+            {
+                std::lock_guard dummy(lockLink_);
+                linkFreeTime_ = std::max(linkFreeTime_, std::chrono::steady_clock::now()) + transferTime;
+                transferEnd = linkFreeTime_;
+            }
+            std::this_thread::sleep_until(transferEnd);
+        }
+    }
+
+    bool nextOperationFails()
+    {
+        if (cfg_.errorsPerMille <= 0)
+            return false;
+
+        std::lock_guard dummy(lockRng_);
+        return static_cast<int>(rng_() % 1000) < cfg_.errorsPerMille;
+    }
+
+    const SimConfig& getConfig() const { return cfg_; }
+
+private:
+    SimServer           (const SimServer&) = delete;
+    SimServer& operator=(const SimServer&) = delete;
+
+    const SimConfig cfg_;
+
+    std::mutex lockConnections_;
+    std::condition_variable conditionConnectionFree_;
+    size_t connectionsInUse_ = 0; //protected by lockConnections_
+
+    std::mutex lockLink_;
+    std::chrono::steady_clock::time_point linkFreeTime_; //protected by lockLink_
+
+    std::mutex lockRng_;
+    std::mt19937_64 rng_; //protected by lockRng_: same seed => same sequence of failures (for a given order of operations)
+};
+
+
+std::shared_ptr<SimServer> getSimServer(const SimConfig& cfg)
+{
+    static Protected<std::map<SimConfig, std::shared_ptr<SimServer>>> globalSimServers; //lifetime: process
+    std::shared_ptr<SimServer> server;
+    globalSimServers.access([&](std::map<SimConfig, std::shared_ptr<SimServer>>& servers)
+    {
+        std::shared_ptr<SimServer>& srv = servers[cfg];
+        if (!srv)
+            srv = std::make_shared<SimServer>(cfg);
+        server = srv;
+    });
+    return server;
+}
+
+//===========================================================================================================================
+
+struct InputStreamSim : public AFS::InputStream
+{
+    InputStreamSim(std::unique_ptr<AFS::InputStream>&& streamIn, const std::shared_ptr<SimServer>& server) :
+        conn_(std::make_unique<SimServer::Connection>(*server)), //keep "connection" for the lifetime of the stream, like (S)FTP file transfers
+        streamIn_(std::move(streamIn)),
+        server_(server) {}
+
+    size_t read(void* buffer, size_t bytesToRead) override //throw FileError, ErrorFileLocked, X; return "bytesToRead" bytes unless end of stream!
+    {
+        const size_t bytesRead = streamIn_->read(buffer, bytesToRead); //throw FileError, ErrorFileLocked, X
+        server_->simulateTransfer(bytesRead);
+        return bytesRead;
+    }
+
+    size_t getBlockSize() const override { return streamIn_->getBlockSize(); }
+
+    std::optional<AFS::StreamAttributes> getAttributesBuffered() override { return {}; } //like SFTP/FTP: attributes not available without extra round trip
+
+    bool supportsReadAt() const override { return streamIn_->supportsReadAt(); }
+
+    size_t readAt(uint64_t offset, void* buffer, size_t bytesToRead) override //throw FileError, ErrorFileLocked, X
+    {
+        server_->simulateRoundTrip();
+        const size_t bytesRead = streamIn_->readAt(offset, buffer, bytesToRead); //throw FileError, ErrorFileLocked, X
+        server_->simulateTransfer(bytesRead);
+        return bytesRead;
+    }
+
+private:
+    const std::unique_ptr<SimServer::Connection> conn_;
+    const std::unique_ptr<AFS::InputStream> streamIn_;
+    const std::shared_ptr<SimServer> server_;
+};
+
+
+struct OutputStreamSim : public AFS::OutputStreamImpl
+{
+    OutputStreamSim(std::unique_ptr<AFS::OutputStream>&& streamOut, const std::shared_ptr<SimServer>& server) :
+        conn_(std::make_unique<SimServer::Connection>(*server)),
+        streamOut_(std::move(streamOut)),
+        server_(server) {}
+
+    void write(const void* buffer, size_t bytesToWrite) override //throw FileError, X
+    {
+        server_->simulateTransfer(bytesToWrite);
+        streamOut_->write(buffer, bytesToWrite); //throw FileError, X
+    }
+
+    AFS::FinalizeResult finalize() override //throw FileError, X
+    {
+        server_->simulateRoundTrip();
+        AFS::FinalizeResult result = streamOut_->finalize(); //throw FileError, X
+        result.filePrint = 0; //like SFTP: no file IDs
+        return result;
+    }
+
+private:
+    const std::unique_ptr<SimServer::Connection> conn_;
+    const std::unique_ptr<AFS::OutputStream> streamOut_; //native, transactional: deletes file if not finalized
+    const std::shared_ptr<SimServer> server_;
+};
+
+//===========================================================================================================================
+
+class SimFileSystem : public AbstractFileSystem
+{
+public:
+    explicit SimFileSystem(const SimConfig& cfg) : cfg_(cfg), server_(getSimServer(cfg)) {}
+
+    AbstractPath getNativePath(const AfsPath& afsPath) const { return createItemPathNativeNoFormatting(nativeAppendPaths(cfg_.rootPath, afsPath.value)); }
+
+private:
+    static AbstractPath getNativePath(const AbstractPath& apSim) { return static_cast<const SimFileSystem&>(apSim.afsDevice.ref()).getNativePath(apSim.afsPath); }
+
+    //one "round trip" holding one connection; fails randomly as configured
+    template <class Function>
+    auto runOperation(const AfsPath& afsPath, Function op) const //throw FileError, (X)
+    {
+        const SimServer::Connection conn(*server_);
+        server_->simulateRoundTrip();
+
+        if (server_->nextOperationFails())
+            throw FileError(replaceCpy<std::wstring>(L"Simulated error for %x.", L"%x", fmtPath(getDisplayPath(afsPath))),
+                            L"errors=" + numberTo<std::wstring>(cfg_.errorsPerMille) + L" per mille");
+        return op(); //throw FileError, (X)
+    }
+
+    Zstring getInitPathPhrase(const AfsPath& afsPath) const override
+    {
+        const SimConfig cfgDefault;
+
+        Zstring options;
+        if (cfg_.latency != cfgDefault.latency)
+            options += Zstr("|latency=") + numberTo<Zstring>(cfg_.latency.count());
+
+        if (cfg_.bandwidth != cfgDefault.bandwidth)
+            options += Zstr("|bandwidth=") + numberTo<Zstring>(cfg_.bandwidth);
+
+        if (cfg_.errorsPerMille != cfgDefault.errorsPerMille)
+            options += Zstr("|errors=") + numberTo<Zstring>(cfg_.errorsPerMille);
+
+        if (cfg_.connectionsMax != cfgDefault.connectionsMax)
+            options += Zstr("|conn=") + numberTo<Zstring>(cfg_.connectionsMax);
+
+        if (cfg_.seed != cfgDefault.seed)
+            options += Zstr("|seed=") + numberTo<Zstring>(cfg_.seed);
+
+        return Zstring(simPrefix) + nativeAppendPaths(cfg_.rootPath, afsPath.value) + options;
+    }
+
+    std::wstring getDisplayPath(const AfsPath& afsPath) const override { return utfTo<std::wstring>(Zstring(simPrefix) + nativeAppendPaths(cfg_.rootPath, afsPath.value)); }
+
+    bool isNullFileSystem() const override { return cfg_.rootPath.empty(); }
+
+    std::weak_ordering compareDeviceSameAfsType(const AbstractFileSystem& afsRhs) const override
+    {
+        return cfg_ <=> static_cast<const SimFileSystem&>(afsRhs).cfg_;
+    }
+
+    //----------------------------------------------------------------------------------------------------------------
+    ItemType getItemType(const AfsPath& afsPath) const override //throw FileError
+    {
+        return runOperation(afsPath, [&] { return AFS::getItemType(getNativePath(afsPath)); }); //throw FileError
+    }
+
+    std::optional<ItemType> itemStillExists(const AfsPath& afsPath) const override //throw FileError
+    {
+        return runOperation(afsPath, [&] { return AFS::itemStillExists(getNativePath(afsPath)); }); //throw FileError
+    }
+
+    //----------------------------------------------------------------------------------------------------------------
+    //already existing: fail
+    void createFolderPlain(const AfsPath& afsPath) const override //throw FileError
+    {
+        runOperation(afsPath, [&] { AFS::createFolderPlain(getNativePath(afsPath)); }); //throw FileError
+    }
+
+    void removeFilePlain(const AfsPath& afsPath) const override //throw FileError
+    {
+        runOperation(afsPath, [&] { AFS::removeFilePlain(getNativePath(afsPath)); }); //throw FileError
+    }
+
+    void removeSymlinkPlain(const AfsPath& afsPath) const override //throw FileError
+    {
+        runOperation(afsPath, [&] { AFS::removeSymlinkPlain(getNativePath(afsPath)); }); //throw FileError
+    }
+
+    void removeFolderPlain(const AfsPath& afsPath) const override //throw FileError
+    {
+        runOperation(afsPath, [&] { AFS::removeFolderPlain(getNativePath(afsPath)); }); //throw FileError
+    }
+
+    void removeFolderIfExistsRecursion(const AfsPath& afsPath, //throw FileError
+                                       const std::function<void (const std::wstring& displayPath)>& onBeforeFileDeletion /*throw X*/, //optional
+                                       const std::function<void (const std::wstring& displayPath)>& onBeforeFolderDeletion) const override //one call for each object!
+    {
+        //default implementation: traversal + one round trip per item, like a remote server
+        AbstractFileSystem::removeFolderIfExistsRecursion(afsPath, onBeforeFileDeletion, onBeforeFolderDeletion); //throw FileError
+    }
+
+    //----------------------------------------------------------------------------------------------------------------
+    AbstractPath getSymlinkResolvedPath(const AfsPath& afsPath) const override //throw FileError
+    {
+        return runOperation(afsPath, [&] { return AFS::getSymlinkResolvedPath(getNativePath(afsPath)); }); //throw FileError
+    }
+
+    bool equalSymlinkContentForSameAfsType(const AfsPath& afsLhs, const AbstractPath& apRhs) const override //throw FileError
+    {
+        return runOperation(afsLhs, [&] { return AFS::equalSymlinkContent(getNativePath(afsLhs), getNativePath(apRhs)); }); //throw FileError
+    }
+
+    //----------------------------------------------------------------------------------------------------------------
+    std::unique_ptr<InputStream> getInputStream(const AfsPath& afsPath, const IoCallback& notifyUnbufferedIO /*throw X*/) const override //throw FileError, ErrorFileLocked
+    {
+        return runOperation(afsPath, [&]
+        {
+            return std::make_unique<InputStreamSim>(AFS::getInputStream(getNativePath(afsPath), notifyUnbufferedIO), server_); //throw FileError, ErrorFileLocked
+        });
+    }
+
+    //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
+    std::unique_ptr<OutputStreamImpl> getOutputStream(const AfsPath& afsPath, //throw FileError
+                                                      std::optional<uint64_t> streamSize,
+                                                      std::optional<time_t> modTime,
+                                                      const IoCallback& notifyUnbufferedIO /*throw X*/) const override
+    {
+        return runOperation(afsPath, [&]
+        {
+            return std::make_unique<OutputStreamSim>(AFS::getOutputStream(getNativePath(afsPath), streamSize, modTime, notifyUnbufferedIO), server_); //throw FileError
+        });
+    }
+
+    //----------------------------------------------------------------------------------------------------------------
+    //like SFTP: single-threaded, one round trip per folder listing; callbacks run on caller's thread
+    void traverseFolderRecursive(const TraverserWorkload& workload /*throw X*/, size_t parallelOps) const override
+    {
+        RingBuffer<std::pair<AfsPath, std::shared_ptr<TraverserCallback>>> workItems;
+        for (const auto& wi : workload)
+            workItems.push_back(wi);
+
+        while (!workItems.empty())
+        {
+            auto [folderPath, cb] = std::move(workItems.    front()); //yes, no strong exception guarantee (std::bad_alloc)
+            /**/                                workItems.pop_front();  //
+
+            tryReportingDirError([&] //throw X
+            {
+                const Zstring nativeFolderPath = nativeAppendPaths(cfg_.rootPath, folderPath.value);
+
+                const std::vector<DirEntryDetails> items = runOperation(folderPath, [&] //throw FileError
+                {
+                    return getDirContentDetailed(nativeFolderPath, true /*statFiles*/, true /*statSymlinks*/, false /*statInodeOrder*/); //throw FileError
+                });
+
+                for (const DirEntryDetails& item : items)
+                {
+                    const AfsPath itemPath(nativeAppendPaths(folderPath.value, item.itemName));
+
+                    switch (item.type)
+                    {
+                        case DirEntryDetails::Type::file:
+                            cb->onFile({item.itemName, item.fileSize, item.modTime, FingerPrint() /*like SFTP: no file IDs*/, false /*isFollowedSymlink*/}); //throw X
+                            break;
+
+                        case DirEntryDetails::Type::folder:
+                            if (std::shared_ptr<TraverserCallback> cbSub = cb->onFolder({item.itemName, false /*isFollowedSymlink*/})) //throw X
+                                workItems.push_back(std::pair(itemPath, cbSub));
+                            break;
+
+                        case DirEntryDetails::Type::symlink:
+                            switch (cb->onSymlink({item.itemName, item.modTime})) //throw X
+                            {
+                                case TraverserCallback::HandleLink::follow:
+                                {
+                                    struct stat targetInfo = {};
+                                    if (!tryReportingItemError([&] //throw X
+                                {
+                                    runOperation(itemPath, [&] //throw FileError
+                                    {
+                                        if (::stat(nativeAppendPaths(nativeFolderPath, item.itemName).c_str(), &targetInfo) != 0)
+                                            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot resolve symbolic link %x."), L"%x", fmtPath(getDisplayPath(itemPath))), "stat");
+                                    });
+                                }, *cb, item.itemName))
+                                    continue;
+
+                                    if (S_ISDIR(targetInfo.st_mode))
+                                    {
+                                        if (std::shared_ptr<TraverserCallback> cbSub = cb->onFolder({item.itemName, true /*isFollowedSymlink*/})) //throw X
+                                            workItems.push_back(std::pair(itemPath, cbSub));
+                                    }
+                                    else //a file or named pipe, etc.
+                                        cb->onFile({item.itemName, makeUnsigned(targetInfo.st_size), targetInfo.st_mtime, FingerPrint(), true /*isFollowedSymlink*/}); //throw X
+                                }
+                                break;
+
+                                case TraverserCallback::HandleLink::skip:
+                                    break;
+                            }
+                            break;
+                    }
+                }
+            }, *cb);
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------------------
+    bool supportsPermissions(const AfsPath& afsPath) const override { return false; } //throw FileError
+
+    //already existing: undefined behavior! (e.g. fail/overwrite)
+    void moveAndRenameItemForSameAfsType(const AfsPath& pathFrom, const AbstractPath& pathTo) const override //throw FileError, ErrorMoveUnsupported
+    {
+        runOperation(pathFrom, [&] { AFS::moveAndRenameItem(getNativePath(pathFrom), getNativePath(pathTo)); }); //throw FileError, ErrorMoveUnsupported
+    }
+
+    bool tryMoveAndReplaceFileForSameAfsType(const AfsPath& pathFrom, const AbstractPath& pathTo) const override { return false; } //throw FileError
+
+    //symlink handling: follow
+    //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
+    FileCopyResult copyFileForSameAfsType(const AfsPath& afsSource, const StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
+                                          const AbstractPath& apTarget, bool copyFilePermissions, const IoCallback& notifyUnbufferedIO /*throw X*/) const override
+    {
+        //no server-side copy: download + upload like (S)FTP
+        if (copyFilePermissions)
+            throw FileError(replaceCpy(_("Cannot write permissions of %x."), L"%x", fmtPath(AFS::getDisplayPath(apTarget))), _("Operation not supported by device."));
+
+        return copyFileAsStream(afsSource, attrSource, apTarget, false /*calcContentHash*/, notifyUnbufferedIO); //throw FileError, ErrorFileLocked, X
+    }
+
+    //symlink handling: follow
+    //already existing: fail
+    void copyNewFolderForSameAfsType(const AfsPath& afsSource, const AbstractPath& apTarget, bool copyFilePermissions) const override //throw FileError
+    {
+        if (copyFilePermissions)
+            throw FileError(replaceCpy(_("Cannot write permissions of %x."), L"%x", fmtPath(AFS::getDisplayPath(apTarget))), _("Operation not supported by device."));
+
+        AFS::createFolderPlain(apTarget); //throw FileError
+    }
+
+    //already existing: fail
+    void copySymlinkForSameAfsType(const AfsPath& afsSource, const AbstractPath& apTarget, bool copyFilePermissions) const override //throw FileError
+    {
+        runOperation(afsSource, [&] { AFS::copySymlink(getNativePath(afsSource), getNativePath(apTarget), copyFilePermissions); }); //throw FileError
+    }
+
+    //----------------------------------------------------------------------------------------------------------------
+    FileIconHolder getFileIcon      (const AfsPath& afsPath, int pixelSize) const override { return {}; } //throw SysError; optional return value
+    ImageHolder    getThumbnailImage(const AfsPath& afsPath, int pixelSize) const override { return {}; } //throw SysError; optional return value
+
+    void authenticateAccess(bool allowUserInteraction) const override {} //throw FileError
+
+    int getAccessTimeout() const override { return 0; } //returns "0" if no timeout in force
+
+    void prepareSessions(size_t sessionCount) const override {} //noexcept
+
+    bool hasNativeTransactionalCopy() const override { return false; }
+    //----------------------------------------------------------------------------------------------------------------
+
+    int64_t getFreeDiskSpace(const AfsPath& afsPath) const override { return -1; } //throw FileError, returns < 0 if not available
+
+    bool supportsRecycleBin(const AfsPath& afsPath) const override { return false; } //throw FileError
+
+    std::unique_ptr<RecycleSession> createRecyclerSession(const AfsPath& afsPath) const override //throw FileError, return value must be bound!
+    {
+        assert(false); //see supportsRecycleBin()
+        throw FileError(L"Recycle bin not supported by device.");
+    }
+
+    void recycleItemIfExists(const AfsPath& afsPath) const override //throw FileError
+    {
+        assert(false); //see supportsRecycleBin()
+        throw FileError(replaceCpy(_("Unable to move %x to the recycle bin."), L"%x", fmtPath(getDisplayPath(afsPath))), _("Operation not supported by device."));
+    }
+
+    const SimConfig cfg_;
+    const std::shared_ptr<SimServer> server_;
+};
+}
+
+
+bool fff::acceptsItemPathPhraseSimulated(const Zstring& itemPathPhrase) //noexcept
+{
+    Zstring path = expandMacros(itemPathPhrase); //expand before trimming!
+    trim(path);
+    return startsWithAsciiNoCase(path, simPrefix);
+}
+
+
+//syntax: sim:<native folder path>[|option_name=value], see simulated.h
+AbstractPath fff::createItemPathSimulated(const Zstring& itemPathPhrase) //noexcept
+{
+    Zstring pathPhrase = expandMacros(itemPathPhrase); //expand before trimming!
+    trim(pathPhrase);
+
+    if (startsWithAsciiNoCase(pathPhrase, simPrefix))
+        pathPhrase = pathPhrase.c_str() + strLength(simPrefix);
+
+    const Zstring fullPath = beforeFirst(pathPhrase, Zstr('|'), IfNotFoundReturn::all);
+    const Zstring options  =  afterFirst(pathPhrase, Zstr('|'), IfNotFoundReturn::none);
+
+    SimConfig cfg;
+    cfg.rootPath = getResolvedFilePath(fullPath);
+
+    for (const Zstring& optPhrase : split(options, Zstr('|'), SplitOnEmpty::skip))
+        if (startsWith(optPhrase, Zstr("latency=")))
+            cfg.latency = std::chrono::milliseconds(stringTo<int>(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none)));
+        else if (startsWith(optPhrase, Zstr("bandwidth=")))
+            cfg.bandwidth = stringTo<int64_t>(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none));
+        else if (startsWith(optPhrase, Zstr("errors=")))
+            cfg.errorsPerMille = stringTo<int>(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none));
+        else if (startsWith(optPhrase, Zstr("conn=")))
+            cfg.connectionsMax = stringTo<size_t>(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none));
+        else if (startsWith(optPhrase, Zstr("seed=")))
+            cfg.seed = stringTo<uint64_t>(afterFirst(optPhrase, Zstr("="), IfNotFoundReturn::none));
+        else
+            assert(false);
+
+    return AbstractPath(makeSharedRef<SimFileSystem>(cfg), AfsPath());
+}
@@ -0,0 +1,30 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef SIMULATED_H_4389570283475023475
+#define SIMULATED_H_4389570283475023475
+
+#include "abstract.h"
+
+
+namespace fff
+{
+/*  testing only: "remote" device backed by a native folder, simulating a slow server
+    => measure traversal, prefetching, pipelining and parallel operations reproducibly without an SFTP/FTP/Google Drive server
+
+    syntax: sim:<native folder path>[|latency=<ms>][|bandwidth=<bytes/sec>][|errors=<per mille>][|conn=<max connections>][|seed=<n>]
+
+    e.g. sim:/tmp/remote|latency=80|bandwidth=2000000|conn=4
+
+    - latency:   per operation (item type, create, delete, move, stream open, each folder listed)
+    - bandwidth: shared by all streams of the device (reads and writes)
+    - errors:    share of operations that fail with a FileError (pseudo-random sequence from seed)
+    - conn:      operations + open streams per device at the same time; further operations wait     */
+bool  acceptsItemPathPhraseSimulated(const Zstring& itemPathPhrase); //noexcept
+AbstractPath createItemPathSimulated(const Zstring& itemPathPhrase); //noexcept
+}
+
+#endif //SIMULATED_H_4389570283475023475
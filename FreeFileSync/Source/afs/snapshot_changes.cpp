@@ -0,0 +1,385 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "snapshot_changes.h"
+#include <atomic>
+#include <zen/file_access.h>
+#include <zen/file_path.h>
+#include <zen/process_exec.h>
+#include <zen/stl_tools.h>
+
+    #include <sys/vfs.h> //statfs
+    #include <sys/stat.h>
+
+using namespace zen;
+using namespace fff;
+
+
+namespace
+{
+std::atomic<bool> globalSnapshotChangesEnabled{false};
+
+//https://man7.org/linux/man-pages/man2/statfs.2.html
+const decltype(statfs::f_type) STATFS_MAGIC_ZFS   = 0x2FC12FC1;
+const decltype(statfs::f_type) STATFS_MAGIC_BTRFS = 0x9123683E;
+
+const ino_t BTRFS_SUBVOLUME_ROOT_INODE = 256; //BTRFS_FIRST_FREE_OBJECTID
+
+const Zchar BTRFS_SNAPSHOT_FOLDER_NAME[] = Zstr(".ffs_snapshots");
+
+
+Zstring getSnapshotName(const std::string& checkpointId)
+{
+    return Zstr("ffs_") + printNumber<Zstring>(Zstr("%016llx"), static_cast<unsigned long long>(hashArray<uint64_t>(checkpointId.begin(), checkpointId.end())));
+}
+
+
+Zstring runSnapshotTool(const Zstring& cmdLine) //throw SysError
+{
+    const auto& [exitCode, output] = consoleExecute(cmdLine, std::nullopt /*timeoutMs*/); //throw SysError, SysErrorTimeOut
+    if (exitCode != 0)
+        throw SysError(formatSystemError(utfTo<std::string>(cmdLine),
+                                         replaceCpy(_("Exit code %x"), L"%x", numberTo<std::wstring>(exitCode)), utfTo<std::wstring>(trimCpy(output))));
+    return output;
+}
+
+
+bool snapshotToolSucceeds(const Zstring& cmdLine) //throw SysError
+{
+    return consoleExecute(cmdLine, std::nullopt /*timeoutMs*/).first == 0; //throw SysError, SysErrorTimeOut
+}
+
+
+//ZFS: "\0040" (always 4 octal digits), Btrfs: "\ ", "\n" or "\040" (3 octal digits)
+Zstring unescapeToolPath(const std::string_view& str, size_t octalDigitsMax)
+{
+    Zstring output;
+    for (auto it = str.begin(); it != str.end(); ++it)
+        if (*it == '\\' && it + 1 != str.end())
+        {
+            ++it;
+            if ('0' <= *it && *it <= '7')
+            {
+                unsigned int c = 0;
+                for (size_t i = 0; i < octalDigitsMax && it != str.end() && '0' <= *it && *it <= '7'; ++i, ++it)
+                    c = c * 8 + (*it - '0');
+                --it;
+                output += static_cast<char>(c);
+            }
+            else
+                switch (*it)
+                {
+                    //*INDENT-OFF*
+                    case 'a': output += '\a'; break;
+                    case 'b': output += '\b'; break;
+                    case 'e': output += '\x1b'; break;
+                    case 'f': output += '\f'; break;
+                    case 'n': output += '\n'; break;
+                    case 'r': output += '\r'; break;
+                    case 't': output += '\t'; break;
+                    case 'v': output += '\v'; break;
+                    default:  output += *it;  break; //"\ ", "\\", "\'", "\""
+                    //*INDENT-ON*
+                }
+        }
+        else
+            output += *it;
+    return output;
+}
+
+
+//relPath relative to basePath (no trailing separator); none: basePath itself or outside
+std::optional<Zstring> getRelativeSnapshotPath(const Zstring& basePath, const Zstring& itemPath)
+{
+    if (basePath.empty())
+        return itemPath.empty() ? std::nullopt : std::optional(itemPath);
+
+    if (startsWith(itemPath, basePath) && itemPath.size() > basePath.size() + 1 && itemPath[basePath.size()] == FILE_NAME_SEPARATOR)
+        return Zstring(itemPath.begin() + basePath.size() + 1, itemPath.end());
+    return std::nullopt;
+}
+
+//----------------------------------------------------------------------------------------------------------------
+
+struct ZfsSnapshots
+{
+    Zstring committed;
+    Zstring pending;
+};
+
+ZfsSnapshots getZfsSnapshots(const Zstring& folderPath, const std::string& checkpointId) //throw SysError
+{
+    const Zstring output = runSnapshotTool(Zstr("zfs list -H -o name ") + escapeCommandArg(folderPath)); //throw SysError
+    const Zstring dataset = trimCpy(beforeFirst(output, '\n', IfNotFoundReturn::all));
+    if (dataset.empty())
+        throw SysError(L"zfs list: Unexpected output.");
+
+    const Zstring snapshot = dataset + Zstr('@') + getSnapshotName(checkpointId);
+    return {snapshot, snapshot + Zstr("_new")};
+}
+
+
+bool zfsSnapshotExists(const Zstring& snapshot) //throw SysError
+{
+    return snapshotToolSucceeds(Zstr("zfs list -H -t snapshot -o name ") + escapeCommandArg(snapshot)); //throw SysError
+}
+
+
+std::optional<std::vector<Zstring>> getZfsChanges(const Zstring& folderPath, const std::string& checkpointId) //throw SysError
+{
+    const ZfsSnapshots snap = getZfsSnapshots(folderPath, checkpointId); //throw SysError
+
+    if (zfsSnapshotExists(snap.pending)) //throw SysError
+        runSnapshotTool(Zstr("zfs destroy ") + escapeCommandArg(snap.pending)); //throw SysError
+    runSnapshotTool(Zstr("zfs snapshot ") + escapeCommandArg(snap.pending)); //throw SysError
+
+    if (!zfsSnapshotExists(snap.committed)) //throw SysError
+        return std::nullopt; //first comparison: next one will be incremental
+
+    //https://openzfs.github.io/openzfs-docs/man/master/8/zfs-diff.8.html
+    //"<change>\t<file type>\t<path>[\t<new path>]": paths are absolute, based on the dataset's mount point
+    const Zstring output = runSnapshotTool(Zstr("zfs diff -FH ") + escapeCommandArg(snap.committed) + Zstr(' ') + escapeCommandArg(snap.pending)); //throw SysError
+
+    std::vector<Zstring> changes;
+    split2(output, [](char c) { return c == '\n'; }, [&](const char* first, const char* last)
+    {
+        const std::vector<Zstring> items = split(Zstring(first, last), '\t', SplitOnEmpty::allow);
+        if (items.size() < 3)
+            return;
+
+        if (items[0] == Zstr("M") && items[1] == Zstr("/")) //folder modification time, attributes or content: content changes are reported separately
+            return;
+
+        std::for_each(items.begin() + 2, items.end(), [&](const Zstring& pathEsc)
+        {
+            if (const std::optional<Zstring> relPath = getRelativeSnapshotPath(folderPath, unescapeToolPath(makeStringView(pathEsc.begin(), pathEsc.end()), 4)))
+                changes.push_back(*relPath);
+        });
+    });
+    return changes;
+}
+
+
+void commitZfsCheckpoint(const Zstring& folderPath, const std::string& checkpointId) //throw SysError
+{
+    const ZfsSnapshots snap = getZfsSnapshots(folderPath, checkpointId); //throw SysError
+
+    if (!zfsSnapshotExists(snap.pending)) //throw SysError
+        return; //no comparison since last commit: keep the older checkpoint (reports a superset of the changes)
+
+    if (zfsSnapshotExists(snap.committed)) //throw SysError
+        runSnapshotTool(Zstr("zfs destroy ") + escapeCommandArg(snap.committed)); //throw SysError
+
+    runSnapshotTool(Zstr("zfs rename ") + escapeCommandArg(snap.pending) + Zstr(' ') + escapeCommandArg(snap.committed)); //throw SysError
+}
+
+//----------------------------------------------------------------------------------------------------------------
+
+struct BtrfsSnapshots
+{
+    Zstring subvolumePath;
+    Zstring folderRelPath; //folderPath relative to subvolumePath
+    Zstring committed;
+    Zstring pending;
+};
+
+std::optional<BtrfsSnapshots> getBtrfsSnapshots(const Zstring& folderPath, const std::string& checkpointId) //throw SysError
+{
+    Zstring subvolumePath = folderPath;
+    for (;;)
+    {
+        struct stat fileInfo = {};
+        if (::lstat(subvolumePath.c_str(), &fileInfo) != 0)
+            THROW_LAST_SYS_ERROR("lstat");
+
+        if (fileInfo.st_ino == BTRFS_SUBVOLUME_ROOT_INODE)
+            break;
+
+        const std::optional<Zstring> parentPath = getParentFolderPath(subvolumePath);
+        if (!parentPath)
+            throw SysError(L"Btrfs subvolume not found.");
+        subvolumePath = *parentPath;
+    }
+
+    //snapshots must be outside the subvolume: nested subvolumes would show up as empty folders during traversal
+    const std::optional<Zstring> parentPath = getParentFolderPath(subvolumePath);
+    if (!parentPath)
+        return std::nullopt; //subvolume mounted as root folder: no place for the snapshots
+
+    const Zstring snapshotFolderPath = nativeAppendPaths(*parentPath, BTRFS_SNAPSHOT_FOLDER_NAME);
+    const Zstring snapshotPath = nativeAppendPaths(snapshotFolderPath, afterLast(subvolumePath, FILE_NAME_SEPARATOR, IfNotFoundReturn::all) + Zstr('_') + getSnapshotName(checkpointId));
+
+    return BtrfsSnapshots
+    {
+        subvolumePath,
+        folderPath == subvolumePath ? Zstring() : Zstring(folderPath.begin() + subvolumePath.size() + (endsWith(subvolumePath, FILE_NAME_SEPARATOR) ? 0 : 1), folderPath.end()),
+        snapshotPath,
+        snapshotPath + Zstr("_new"),
+    };
+}
+
+
+bool itemExists(const Zstring& itemPath) //throw SysError
+{
+    struct stat fileInfo = {};
+    if (::lstat(itemPath.c_str(), &fileInfo) == 0)
+        return true;
+    if (errno != ENOENT)
+        THROW_LAST_SYS_ERROR("lstat");
+    return false;
+}
+
+
+std::optional<std::vector<Zstring>> getBtrfsChanges(const Zstring& folderPath, const std::string& checkpointId) //throw SysError
+{
+    const std::optional<BtrfsSnapshots> snap = getBtrfsSnapshots(folderPath, checkpointId); //throw SysError
+    if (!snap)
+        return std::nullopt;
+
+    try
+    {
+        createDirectoryIfMissingRecursion(beforeLast(snap->pending, FILE_NAME_SEPARATOR, IfNotFoundReturn::none)); //throw FileError
+    }
+    catch (const FileError& e) { throw SysError(e.toString()); }
+
+    if (itemExists(snap->pending)) //throw SysError
+        runSnapshotTool(Zstr("btrfs subvolume delete ") + escapeCommandArg(snap->pending)); //throw SysError
+    runSnapshotTool(Zstr("btrfs subvolume snapshot -r ") + escapeCommandArg(snap->subvolumePath) + Zstr(' ') + escapeCommandArg(snap->pending)); //throw SysError
+
+    if (!itemExists(snap->committed)) //throw SysError
+        return std::nullopt; //first comparison: next one will be incremental
+
+    //send stream without file data, decoded as "<command> ./<snapshot name>/<path> [key=value]...": paths are escaped, e.g. "\ "
+    //commands for orphaned items use temporary names ("o257-5-0"), followed by a rename => superfluous, but harmless
+    const Zstring output = runSnapshotTool(Zstr("btrfs send --no-data -q -p ") + escapeCommandArg(snap->committed) + Zstr(' ') + escapeCommandArg(snap->pending) +
+                                                Zstr(" | btrfs receive --dump")); //throw SysError
+
+    auto nextToken = [](std::string_view& line)
+    {
+        auto it = line.begin();
+        while (it != line.end() && *it == ' ')
+            ++it;
+        auto itEnd = it;
+        while (itEnd != line.end() && *itEnd != ' ')
+            if (*itEnd++ == '\\' && itEnd != line.end())
+                ++itEnd;
+
+        const std::string_view token = makeStringView(it, itEnd);
+        line = makeStringView(itEnd, line.end());
+        return token;
+    };
+
+    //"./<snapshot name>/<path>" => <path> relative to folderPath
+    auto getRelPath = [&](const std::string_view& pathEsc) -> std::optional<Zstring>
+    {
+        const Zstring streamPath = unescapeToolPath(pathEsc, 3);
+        if (!startsWith(streamPath, Zstr("./")))
+            return std::nullopt;
+
+        return getRelativeSnapshotPath(snap->folderRelPath, afterFirst(Zstring(streamPath.begin() + 2, streamPath.end()), FILE_NAME_SEPARATOR, IfNotFoundReturn::none));
+    };
+
+    std::vector<Zstring> changes;
+    split2(output, [](char c) { return c == '\n'; }, [&](const char* first, const char* last)
+    {
+        std::string_view line = makeStringView(first, last);
+        const std::string_view command = nextToken(line);
+        const std::optional<Zstring> relPath = getRelPath(nextToken(line));
+        if (!relPath)
+            return;
+
+        if (command == "snapshot" ||
+            command == "end")
+            return;
+
+        if (command == "utimes" ||
+            command == "chmod" ||
+            command == "chown" ||
+            command == "set_xattr" ||
+            command == "remove_xattr")
+        {
+            //parent folders get "utimes" for every child item changed => would rescan the complete folder
+            struct stat fileInfo = {};
+            if (::lstat(nativeAppendPaths(snap->subvolumePath, *relPath).c_str(), &fileInfo) == 0 && S_ISDIR(fileInfo.st_mode))
+                return;
+        }
+
+        changes.push_back(*relPath);
+
+        if (command == "rename") //"dest=./<snapshot name>/<new path>"
+            if (const std::string_view dest = nextToken(line);
+                startsWith(dest, "dest="))
+                if (const std::optional<Zstring> relPathNew = getRelPath(dest.substr(strLength("dest="))))
+                    changes.push_back(*relPathNew);
+    });
+    return changes;
+}
+
+
+void commitBtrfsCheckpoint(const Zstring& folderPath, const std::string& checkpointId) //throw SysError
+{
+    const std::optional<BtrfsSnapshots> snap = getBtrfsSnapshots(folderPath, checkpointId); //throw SysError
+    if (!snap || !itemExists(snap->pending)) //throw SysError
+        return; //no comparison since last commit: keep the older checkpoint (reports a superset of the changes)
+
+    if (itemExists(snap->committed)) //throw SysError
+        runSnapshotTool(Zstr("btrfs subvolume delete ") + escapeCommandArg(snap->committed)); //throw SysError
+
+    try
+    {
+        moveAndRenameItem(snap->pending, snap->committed, false /*replaceExisting*/); //throw FileError, ErrorMoveUnsupported, ErrorTargetExisting
+    }
+    catch (const FileError& e) { throw SysError(e.toString()); }
+}
+
+//----------------------------------------------------------------------------------------------------------------
+
+std::optional<decltype(statfs::f_type)> getSnapshotFileSystem(const Zstring& folderPath) //throw SysError
+{
+    struct statfs info = {};
+    if (::statfs(folderPath.c_str(), &info) != 0)
+        THROW_LAST_SYS_ERROR("statfs");
+
+    if (info.f_type == STATFS_MAGIC_ZFS ||
+        info.f_type == STATFS_MAGIC_BTRFS)
+        return info.f_type;
+    return std::nullopt;
+}
+}
+
+
+void fff::setSnapshotChangeSource(bool enabled) { globalSnapshotChangesEnabled = enabled; }
+bool fff::isSnapshotChangeSourceEnabled() { return globalSnapshotChangesEnabled; }
+
+
+std::optional<std::vector<Zstring>> fff::getSnapshotChanges(const Zstring& folderPath, const std::string& checkpointId) //throw FileError
+{
+    try
+    {
+        if (const std::optional<decltype(statfs::f_type)> fsType = getSnapshotFileSystem(folderPath)) //throw SysError
+            return *fsType == STATFS_MAGIC_ZFS ?
+                   getZfsChanges  (folderPath, checkpointId) : //throw SysError
+                   getBtrfsChanges(folderPath, checkpointId);  //
+        return std::nullopt;
+    }
+    catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read directory %x."), L"%x", fmtPath(folderPath)), e.toString()); }
+}
+
+
+void fff::commitSnapshotCheckpoint(const Zstring& folderPath, const std::string& checkpointId) //throw FileError
+{
+    try
+    {
+        if (const std::optional<decltype(statfs::f_type)> fsType = getSnapshotFileSystem(folderPath)) //throw SysError
+        {
+            if (*fsType == STATFS_MAGIC_ZFS)
+                commitZfsCheckpoint(folderPath, checkpointId); //throw SysError
+            else
+                commitBtrfsCheckpoint(folderPath, checkpointId); //throw SysError
+        }
+    }
+    catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(folderPath)), e.toString()); }
+}
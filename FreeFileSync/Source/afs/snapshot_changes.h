@@ -0,0 +1,33 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef SNAPSHOT_CHANGES_H_7230958173049857134
+#define SNAPSHOT_CHANGES_H_7230958173049857134
+
+#include <optional>
+#include <vector>
+#include <zen/file_error.h>
+
+
+namespace fff
+{
+/*  incremental comparison for native folders on ZFS and Btrfs: changes between two read-only file system snapshots
+    instead of a change journal => no monitoring process needed, changes made while FFS was not running are included
+
+    - one snapshot per checkpoint: ZFS:   <dataset>@ffs_<checkpoint hash>
+                                   Btrfs: <parent of subvolume>/.ffs_snapshots/<subvolume name>_<checkpoint hash>
+    - every query creates "..._new" which replaces the checkpoint's snapshot on commit
+    - requires the rights to run "zfs snapshot/diff/rename/destroy" (e.g. "zfs allow"), respectively "btrfs subvolume/send" (root)   */
+void setSnapshotChangeSource(bool enabled); //applies to comparisons started afterwards
+bool isSnapshotChangeSourceEnabled();
+
+//paths relative to folderPath; std::nullopt: no ZFS/Btrfs, or no snapshot of the checkpoint yet
+std::optional<std::vector<Zstring>> getSnapshotChanges(const Zstring& folderPath, const std::string& checkpointId); //throw FileError
+
+void commitSnapshotCheckpoint(const Zstring& folderPath, const std::string& checkpointId); //throw FileError
+}
+
+#endif //SNAPSHOT_CHANGES_H_7230958173049857134
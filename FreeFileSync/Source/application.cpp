@@ -65,8 +65,7 @@ bool Application::OnInit()
         std::cerr << utfTo<std::string>(titleFmt + SPACED_DASH + msg) << '\n';
     };
 
-    //parallel xBRZ-scaling! => run as early as possible
-    try { imageResourcesInit(getResourceDirPf() + Zstr("Icons.zip")); }
+    try { imageResourcesInit(getResourceDirPf() + Zstr("Icons.zip"), getConfigDirPathPf() + Zstr("Icons.db")); }
     catch (const FileError& e) { logInitError(e.toString()); }
     //errors are not really critical in this context
 
@@ -143,7 +142,7 @@ bool Application::OnInit()
     try { localizationInit(getResourceDirPf() + Zstr("Languages.zip")); } //throw FileError
     catch (const FileError& e) { logInitError(e.toString()); }
 
-    initAfs({getResourceDirPf(), getConfigDirPathPf()}); //bonus: using FTP Gdrive implicitly inits OpenSSL (used in runSanityChecks() on Linux) already during globals init
+    initAfs({getResourceDirPf(), getConfigDirPathPf()}); //network libraries (OpenSSL, libcurl, libssh2) are initialized lazily: only once a remote path is used
 
 
 
@@ -177,6 +176,8 @@ void Application::onEnterEventLoop(wxEvent& event)
 
 int Application::OnExit()
 {
+    writeTraceFile(); //noexcept
+
     localizationCleanup();
     imageResourcesCleanup();
 
@@ -222,7 +223,7 @@ void Application::OnUnhandledException() //handles both wxApp::OnInit() + wxApp:
 
 void runGuiMode  (const Zstring& globalConfigFile);
 void runGuiMode  (const Zstring& globalConfigFile, const XmlGuiConfig& guiCfg, const std::vector<Zstring>& cfgFilePaths, bool startComparison);
-void runBatchMode(const Zstring& globalConfigFile, const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath, FfsExitCode& exitCode);
+void runBatchMode(const Zstring& globalConfigFile, const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath, const Zstring& changeJournalPath, FfsExitCode& exitCode);
 void showSyntaxHelp();
 
 
@@ -250,10 +251,13 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
     std::vector<std::pair<Zstring, Zstring>> dirPathPhrasePairs;
     std::vector<std::pair<Zstring, XmlType>> configFiles; //XmlType: batch or GUI files only
     Zstring globalConfigFile;
+    Zstring changeJournalPath;
     bool openForEdit = false;
     {
         const char* optionEdit    = "-edit";
         const char* optionDirPair = "-dirpair";
+        const char* optionChangeJournal = "-changejournal";
+        const char* optionTrace   = "-trace";
         const char* optionSendTo  = "-sendto"; //remaining arguments are unspecified number of folder paths; wonky syntax; let's keep it undocumented
 
         auto isHelpRequest = [](const Zstring& arg)
@@ -271,6 +275,8 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
         {
             return equalAsciiNoCase(arg, optionEdit   ) ||
                    equalAsciiNoCase(arg, optionDirPair) ||
+                   equalAsciiNoCase(arg, optionChangeJournal) ||
+                   equalAsciiNoCase(arg, optionTrace  ) ||
                    equalAsciiNoCase(arg, optionSendTo ) ||
                    isHelpRequest(arg);
         };
@@ -290,6 +296,18 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
                     return notifyFatalError(replaceCpy(_("A left and a right directory path are expected after %x."), L"%x", utfTo<std::wstring>(optionDirPair)), _("Syntax error"));
                 dirPathPhrasePairs.back().second = *it;
             }
+            else if (equalAsciiNoCase(*it, optionChangeJournal))
+            {
+                if (++it == commandArgs.end() || isCommandLineOption(*it))
+                    return notifyFatalError(replaceCpy(_("A file path is expected after %x."), L"%x", utfTo<std::wstring>(optionChangeJournal)), _("Syntax error"));
+                changeJournalPath = *it; //may be empty if RealTimeSync failed to write the journal => full comparison
+            }
+            else if (equalAsciiNoCase(*it, optionTrace))
+            {
+                if (++it == commandArgs.end() || isCommandLineOption(*it))
+                    return notifyFatalError(replaceCpy(_("A file path is expected after %x."), L"%x", utfTo<std::wstring>(optionTrace)), _("Syntax error"));
+                enableTraceFile(getResolvedFilePath(*it)); //takes precedence over GlobalSettings.xml
+            }
             else if (equalAsciiNoCase(*it, optionSendTo))
             {
                 for (size_t i = 0; ; ++i)
@@ -442,7 +460,7 @@ void Application::launch(const std::vector<Zstring>& commandArgs)
             }
             if (!replaceDirectories(batchCfg.mainCfg))
                 return;
-            runBatchMode(globalConfigFilePath, batchCfg, filepath, exitCode_);
+            runBatchMode(globalConfigFilePath, batchCfg, filepath, changeJournalPath, exitCode_);
         }
         //GUI mode: single config (ffs_gui *or* ffs_batch)
         else
@@ -515,6 +533,8 @@ void showSyntaxHelp()
                                                  L"    [" + _("config files:") + L" *.ffs_gui/*.ffs_batch]" + L'\n' +
                                                  L"    [-DirPair " + _("directory") + L' ' + _("directory") + L"]" L"\n" +
                                                  L"    [-Edit]" + L'\n' +
+                                                 L"    [-ChangeJournal " + _("file") + L"]" + L'\n' +
+                                                 L"    [-Trace " + _("file") + L"]" + L'\n' +
                                                  L"    [" + _("global config file:") + L" GlobalSettings.xml]" + L"\n\n" +
 
                                                  _("config files:") + L'\n' +
@@ -526,12 +546,18 @@ void showSyntaxHelp()
                                                  L"-Edit" + '\n' +
                                                  _("Open the selected configuration for editing only, without executing it.") + L"\n\n" +
 
+                                                 L"-ChangeJournal " + _("file") + L'\n' +
+                                                 _("Compare only items changed since the last synchronization as reported by RealTimeSync (%change_journal%).") + L"\n\n" +
+
+                                                 L"-Trace " + _("file") + L'\n' +
+                                                 _("Record where the time is spent and save it as a trace file (Chrome trace format).") + L"\n\n" +
+
                                                  _("global config file:") + L'\n' +
                                                  _("Path to an alternate GlobalSettings.xml file.")));
 }
 
 
-void runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath, FfsExitCode& exitCode)
+void runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& batchCfg, const Zstring& cfgFilePath, const Zstring& changeJournalPath, FfsExitCode& exitCode)
 {
     const bool showPopupAllowed = !batchCfg.mainCfg.ignoreErrors && batchCfg.batchExCfg.batchErrorHandling == BatchErrorHandling::showPopup;
 
@@ -582,6 +608,8 @@ void runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& bat
         //continue!
     }
 
+    applyProcessSettings(globalCfg);
+
     //all settings have been read successfully...
 
     //regular check for program updates -> disabled for batch
@@ -608,6 +636,7 @@ void runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& bat
                                      globalCfg.dpiLayouts[getDpiScalePercent()].progressDlg.dlgSize,
                                      globalCfg.dpiLayouts[getDpiScalePercent()].progressDlg.isMaximized,
                                      batchCfg.batchExCfg.autoCloseSummary,
+                                     globalCfg.progressDlgDiagnostics,
                                      batchCfg.batchExCfg.postSyncAction,
                                      batchCfg.batchExCfg.batchErrorHandling);
     try
@@ -618,14 +647,27 @@ void runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& bat
         //batch mode: place directory locks on directories during both comparison AND synchronization
         std::unique_ptr<LockHolder> dirLocks;
 
+        std::optional<ChangeJournal> changeJournal;
+        if (!changeJournalPath.empty())
+            try
+            {
+                changeJournal = loadChangeJournal(changeJournalPath); //throw FileError
+            }
+            catch (const FileError& e) { statusHandler.logInfo(e.toString()); } //not critical: fall back to full comparison
+
         //COMPARE DIRECTORIES
         FolderComparison cmpResult = compare(globalCfg.warnDlgs,
                                              globalCfg.fileTimeTolerance,
+                                             getContentPrefilterMinSize(globalCfg),
+                                             true, //pruneSoftFiltered
                                              showPopupAllowed, //allowUserInteraction
                                              globalCfg.runWithBackgroundPriority,
                                              globalCfg.createLockFile,
                                              dirLocks,
                                              extractCompareCfg(batchCfg.mainCfg),
+                                             batchCfg.mainCfg.deviceParallelOps,
+                                             globalCfg.autoTuneParallelOps,
+                                             changeJournal,
                                              statusHandler); //throw AbortProcess
         //START SYNCHRONIZATION
         if (!cmpResult.empty())
@@ -634,17 +676,20 @@ void runBatchMode(const Zstring& globalConfigFilePath, const XmlBatchConfig& bat
                         globalCfg.copyLockedFiles,
                         globalCfg.copyFilePermissions,
                         globalCfg.failSafeFileCopy,
+                        batchCfg.mainCfg.cacheNeutralCopy,
                         globalCfg.runWithBackgroundPriority,
                         extractSyncCfg(batchCfg.mainCfg),
                         cmpResult,
+                        batchCfg.mainCfg.deviceParallelOps,
                         globalCfg.warnDlgs,
                         statusHandler); //throw AbortProcess
     }
     catch (AbortProcess&) {} //exit used by statusHandler
 
     BatchStatusHandler::Result r = statusHandler.reportResults(batchCfg.mainCfg.postSyncCommand, batchCfg.mainCfg.postSyncCondition,
-                                                               batchCfg.mainCfg.altLogFolderPathPhrase, globalCfg.logfilesMaxAgeDays, globalCfg.logFormat, logFilePathsToKeep,
-                                                               batchCfg.mainCfg.emailNotifyAddress, batchCfg.mainCfg.emailNotifyCondition); //noexcept
+                                                               batchCfg.mainCfg.altLogFolderPathPhrase, globalCfg.logfilesMaxAgeDays, globalCfg.logFormat, globalCfg.logFileGzip, logFilePathsToKeep,
+                                                               batchCfg.mainCfg.emailNotifyAddress, batchCfg.mainCfg.emailNotifyCondition,
+                                                               globalCfg.metricsFilePath); //noexcept
     //----------------------------------------------------------------------
     switch (r.syncResult)
     {
@@ -7,11 +7,14 @@
 #include "algorithm.h"
 #include <set>
 #include <unordered_map>
+#include <unordered_set>
 #include <zen/perf.h>
 #include <zen/crc.h>
 #include <zen/guid.h>
 #include <zen/file_access.h> //needed for TempFileBuffer only
+#include <sys/stat.h>          //
 #include <zen/serialize.h>
+#include <zen/thread.h>
 #include "norm_filter.h"
 #include "db_file.h"
 #include "cmp_filetime.h"
@@ -24,95 +27,144 @@ using namespace zen;
 using namespace fff;
 
 
+//----------------------------------------------------------------------------------------------
+
 namespace
 {
-class RecursiveObjectVisitorImpl
-{
-public:
-    RecursiveObjectVisitorImpl(std::function<void (FolderPair&   folder)> onFolder,
-                               std::function<void (FilePair&       file)> onFile,
-                               std::function<void (SymlinkPair& symlink)> onSymlink) :
-        onFolder_(onFolder), onFile_(onFile), onSymlink_(onSymlink) {}
-
-    void execute(FileSystemObject& fsObj)
-    {
-        visitFSObject(fsObj,
-        [&](const FolderPair&   folder) { visit(const_cast<FolderPair& >(folder )); },  //
-        [&](const FilePair&       file) { visit(const_cast<FilePair&   >(file   )); },  //physical object is not const anyway
-        [&](const SymlinkPair& symlink) { visit(const_cast<SymlinkPair&>(symlink)); }); //
-    }
+using SubTreeThreadGroup = ThreadGroup<std::function<void()>>;
 
-private:
-    void visit(FolderPair& folder)
+//setting sync directions is independent for disjoint sub trees => parallelize by top-level folder
+//=> no bottom-up notification while running: see FileSystemObject::suspendSyncCfgNotify()
+template <class Function>
+void runOnSubTree(SubTreeThreadGroup& tg, Function&& fun)
+{
+    tg.run([fun = std::forward<Function>(fun)]
     {
-        if (onFolder_)
-            onFolder_(folder);
-
-        for (FilePair& file : folder.refSubFiles())
-            visit(file);
-        for (SymlinkPair& symlink : folder.refSubLinks())
-            visit(symlink);
-        for (FolderPair& subFolder : folder.refSubFolders())
-            visit(subFolder);
-    }
+        FileSystemObject::suspendSyncCfgNotify(true);
+        ZEN_ON_SCOPE_EXIT(FileSystemObject::suspendSyncCfgNotify(false));
+        fun();
+    });
+}
 
-    void visit(FilePair& file)
-    {
-        if (onFile_)
-            onFile_(file);
-    }
 
-    void visit(SymlinkPair& symlink)
+SyncDirection getMirroredDirection(SyncDirection dir)
+{
+    switch (dir)
     {
-        if (onSymlink_)
-            onSymlink_(symlink);
+        //*INDENT-OFF*
+        case SyncDirection::left:  return SyncDirection::right;
+        case SyncDirection::right: return SyncDirection::left;
+        case SyncDirection::none:  return SyncDirection::none;
+        //*INDENT-ON*
     }
-
-    std::function<void (FolderPair&   folder)> onFolder_;
-    std::function<void (FilePair&       file)> onFile_;
-    std::function<void (SymlinkPair& symlink)> onSymlink_;
-};
+    assert(false);
+    return dir;
 }
 
 
-void fff::recursiveObjectVisitor(FileSystemObject& fsObj,
-                                 std::function<void (FolderPair&   folder)> onFolder,
-                                 std::function<void (FilePair&       file)> onFile,
-                                 std::function<void (SymlinkPair& symlink)> onSymlink)
+//swapping sides yields the mirrored sync directions => no need to redetermine: e.g. no sync.ffs_db loading for two-way
+bool hasSymmetricDirections(const SyncDirectionConfig& dirCfg)
 {
-    RecursiveObjectVisitorImpl(onFolder, onFile, onSymlink).execute(fsObj);
+    if (dirCfg.var == SyncVariant::twoWay) //database has no orientation; first sync: getTwoWayUpdateSet() is symmetric, too
+        return true;
+
+    const DirectionSet dirs = extractDirections(dirCfg);
+    return dirs.exLeftSideOnly == getMirroredDirection(dirs.exRightSideOnly) &&
+           dirs.leftNewer      == getMirroredDirection(dirs.rightNewer) &&
+           dirs.different      == getMirroredDirection(dirs.different) &&
+           dirs.conflict       == getMirroredDirection(dirs.conflict);
+}
 }
 
 
 void fff::swapGrids(const MainConfiguration& mainCfg, FolderComparison& folderCmp,
                     PhaseCallback& callback /*throw X*/) //throw X
 {
-    std::for_each(begin(folderCmp), end(folderCmp), [](BaseFolderPair& baseFolder) { baseFolder.flip(); });
+    const std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>>& directCfgs = extractDirectionCfg(folderCmp, mainCfg);
+
+    std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>> redetermineCfgs;
+    {
+        //tens of millions of rows => parallelize by folder pair and top-level sub tree
+        SubTreeThreadGroup tg(std::max<size_t>(std::thread::hardware_concurrency(), 1), Zstr("Swap Sides"));
+
+        for (const auto& [baseFolder, dirCfg] : directCfgs)
+        {
+            const bool mirrorSyncDir = hasSymmetricDirections(dirCfg); //=> keeps manually changed directions, too (mirrored)
+            if (!mirrorSyncDir)
+                redetermineCfgs.emplace_back(baseFolder, dirCfg);
+
+            for (FolderPair& folder : baseFolder->refSubFolders())
+                runOnSubTree(tg, [&folder, mirrorSyncDir] { BaseFolderPair::flipSubFolder(folder, mirrorSyncDir); });
+        }
+        tg.wait();
+    }
 
-    redetermineSyncDirection(extractDirectionCfg(folderCmp, mainCfg),
-                             callback); //throw FileError
+    for (const auto& [baseFolder, dirCfg] : directCfgs)
+    {
+        const bool mirrorSyncDir = hasSymmetricDirections(dirCfg);
+        FileSystemObject::suspendSyncCfgNotify(true);
+        ZEN_ON_SCOPE_EXIT(FileSystemObject::suspendSyncCfgNotify(false));
+        baseFolder->flipBase(mirrorSyncDir);
+    }
+
+    for (const auto& [baseFolder, dirCfg] : directCfgs)
+        baseFolder->resetSyncCfgBufferedRec(); //notifications were suspended
+
+    redetermineSyncDirection(redetermineCfgs, mainCfg.deviceParallelOps, callback); //throw X
 }
 
-//----------------------------------------------------------------------------------------------
 
 namespace
 {
+//partial temp file of a failed copy which the next copy of a sibling would continue: see AFS::copyFileTransactional()
+template <SelectSide side>
+bool isResumableTempFile(const FilePair& tmpFile)
+{
+    //resumable copies only between different device types
+    const BaseFolderPair& baseFolder = tmpFile.base();
+    if (typeid(baseFolder.getAbstractPath<side>().afsDevice.ref()) == typeid(baseFolder.getAbstractPath<OtherSide<side>::value>().afsDevice.ref()))
+        return false;
+
+    const Zstring& tmpName = tmpFile.getItemName<side>();
+
+    for (const FilePair& file : tmpFile.parent().refSubFiles())
+        if (!file.isEmpty<OtherSide<side>::value>() &&
+            file.getFileSize<OtherSide<side>::value>() >= AFS::RESUMABLE_COPY_MIN_SIZE &&
+            AFS::getResumableTempFileName(file.getItemName<side>(),
+                                          file.getFileSize     <OtherSide<side>::value>(),
+                                          file.getLastWriteTime<OtherSide<side>::value>()) == tmpName)
+            return true;
+    return false;
+}
+
+
 class Redetermine
 {
 public:
-    static void execute(const DirectionSet& dirCfgIn, ContainerObject& hierObj) { Redetermine(dirCfgIn).recurse(hierObj); }
+    static void execute(const DirectionSet& dirCfgIn, BaseFolderPair& baseFolder, SubTreeThreadGroup& tg)
+    {
+        runOnSubTree(tg, [dirCfgIn, &baseFolder] { Redetermine(dirCfgIn).processItems(baseFolder); });
+
+        for (FolderPair& folder : baseFolder.refSubFolders())
+            runOnSubTree(tg, [dirCfgIn, &folder] { Redetermine(dirCfgIn).processFolder(folder); });
+    }
 
 private:
     Redetermine(const DirectionSet& dirCfgIn) : dirCfg_(dirCfgIn) {}
 
     void recurse(ContainerObject& hierObj) const
+    {
+        processItems(hierObj);
+        for (FolderPair& folder : hierObj.refSubFolders())
+            processFolder(folder);
+    }
+
+    void processItems(ContainerObject& hierObj) const //files and symlinks only
     {
         for (FilePair& file : hierObj.refSubFiles())
             processFile(file);
         for (SymlinkPair& link : hierObj.refSubLinks())
             processLink(link);
-        for (FolderPair& folder : hierObj.refSubFolders())
-            processFolder(folder);
     }
 
     void processFile(FilePair& file) const
@@ -121,9 +173,9 @@ private:
 
         //##################### schedule old temporary files for deletion ####################
         if (cat == FILE_LEFT_SIDE_ONLY && endsWith(file.getItemName<SelectSide::left>(), AFS::TEMP_FILE_ENDING))
-            return file.setSyncDir(SyncDirection::left);
+            return file.setSyncDir(isResumableTempFile<SelectSide::left>(file) ? SyncDirection::none : SyncDirection::left);
         else if (cat == FILE_RIGHT_SIDE_ONLY && endsWith(file.getItemName<SelectSide::right>(), AFS::TEMP_FILE_ENDING))
-            return file.setSyncDir(SyncDirection::right);
+            return file.setSyncDir(isResumableTempFile<SelectSide::right>(file) ? SyncDirection::none : SyncDirection::right);
         //####################################################################################
 
         switch (cat)
@@ -351,6 +403,16 @@ bool stillInSync(const InSyncFolder& dbFolder)
     return true;
 }
 
+
+//do left/right item names map to the same database entry? perf: skip Unicode normalization for identical names (= the common case)
+inline
+bool haveSameDbName(const FileSystemObject& fsObj)
+{
+    const Zstring& itemNameL = fsObj.getItemName<SelectSide::left >();
+    const Zstring& itemNameR = fsObj.getItemName<SelectSide::right>();
+    return itemNameL == itemNameR || getUnicodeNormalForm(itemNameL) == getUnicodeNormalForm(itemNameR);
+}
+
 //----------------------------------------------------------------------------------------------
 
 class DetectMovedFiles
@@ -369,11 +431,39 @@ private:
         purgeDuplicates<SelectSide::left >(filesL_,  exLeftOnlyById_);
         purgeDuplicates<SelectSide::right>(filesR_, exRightOnlyById_);
 
-        if ((!exLeftOnlyById_ .empty() || !exLeftOnlyByPath_ .empty()) &&
-            (!exRightOnlyById_.empty() || !exRightOnlyByPath_.empty()))
+        if ((!exLeftOnlyById_ .empty() || !exLeftOnlyByPath_ .empty() || !exLeftOnlyBySizeTime_ .empty()) &&
+            (!exRightOnlyById_.empty() || !exRightOnlyByPath_.empty() || !exRightOnlyBySizeTime_.empty()))
+        {
+            if (!exLeftOnlyBySizeTime_.empty() || !exRightOnlyBySizeTime_.empty())
+                countDbMatches(dbFolder);
+
             detectMovePairs(dbFolder);
+        }
     }
 
+    struct SizeTimeKey
+    {
+        uint64_t fileSize = 0;
+        time_t modTime = 0;
+
+        bool operator==(const SizeTimeKey&) const = default;
+
+        struct Hash
+        {
+            size_t operator()(const SizeTimeKey& key) const { return std::hash<uint64_t>()(key.fileSize * 0x9E3779B97F4A7C15ULL ^ static_cast<uint64_t>(key.modTime)); }
+        };
+    };
+
+    struct SizeTimeCandidate
+    {
+        FilePair* file = nullptr; //nullptr: (size, date) not unique among one-side-only files
+        size_t dbMatches = 0;     //accept only if unique among database files, too
+    };
+    using SizeTimeMap = std::unordered_map<SizeTimeKey, SizeTimeCandidate, SizeTimeKey::Hash>;
+
+    template <SelectSide side>
+    static SizeTimeKey getSizeTimeKey(const InSyncFile& dbFile) { return {dbFile.fileSize, SelectParam<side>::ref(dbFile.left, dbFile.right).modTime}; }
+
     void recurse(ContainerObject& hierObj, const InSyncFolder* dbFolderL, const InSyncFolder* dbFolderR)
     {
         for (FilePair& file : hierObj.refSubFiles())
@@ -393,16 +483,28 @@ private:
                 return nullptr;
             };
 
+            auto addSizeTimeCandidate = [&file](SizeTimeMap& exOneSideBySizeTime, const SizeTimeKey& key)
+            {
+                if (key.fileSize > 0) //empty files: collisions likely, nothing to gain
+                    if (const auto [it, inserted] = exOneSideBySizeTime.try_emplace(key, SizeTimeCandidate{&file});
+                        !inserted)
+                        it->second.file = nullptr; //ambiguous
+            };
+
             if (const CompareFileResult cat = file.getCategory();
                 cat == FILE_LEFT_SIDE_ONLY)
             {
                 if (const InSyncFile* dbEntry = getDbEntry(dbFolderL, file.getItemName<SelectSide::left>()))
                     exLeftOnlyByPath_.emplace(dbEntry, &file);
+                else if (filePrintL == 0) //no file ID (FAT, network share, most remote AFS)
+                    addSizeTimeCandidate(exLeftOnlyBySizeTime_, {file.getFileSize<SelectSide::left>(), file.getLastWriteTime<SelectSide::left>()});
             }
             else if (cat == FILE_RIGHT_SIDE_ONLY)
             {
                 if (const InSyncFile* dbEntry = getDbEntry(dbFolderR, file.getItemName<SelectSide::right>()))
                     exRightOnlyByPath_.emplace(dbEntry, &file);
+                else if (filePrintR == 0)
+                    addSizeTimeCandidate(exRightOnlyBySizeTime_, {file.getFileSize<SelectSide::right>(), file.getLastWriteTime<SelectSide::right>()});
             }
         }
 
@@ -418,9 +520,7 @@ private:
             };
             const InSyncFolder* dbEntryL = getDbEntry(dbFolderL, folder.getItemName<SelectSide::left>());
             const InSyncFolder* dbEntryR = dbEntryL;
-            if (dbFolderL != dbFolderR ||
-                getUnicodeNormalForm(folder.getItemName<SelectSide::left >()) !=
-                getUnicodeNormalForm(folder.getItemName<SelectSide::right>()))
+            if (dbFolderL != dbFolderR || !haveSameDbName(folder))
                 dbEntryR = getDbEntry(dbFolderR, folder.getItemName<SelectSide::right>());
 
             recurse(folder, dbEntryL, dbEntryR);
@@ -464,6 +564,23 @@ private:
         }
     }
 
+    void countDbMatches(const InSyncFolder& container)
+    {
+        for (const auto& [fileName, dbAttrib] : container.files)
+        {
+            if (auto it = exLeftOnlyBySizeTime_.find(getSizeTimeKey<SelectSide::left>(dbAttrib));
+                it != exLeftOnlyBySizeTime_.end())
+                ++it->second.dbMatches;
+
+            if (auto it = exRightOnlyBySizeTime_.find(getSizeTimeKey<SelectSide::right>(dbAttrib));
+                it != exRightOnlyBySizeTime_.end())
+                ++it->second.dbMatches;
+        }
+
+        for (const auto& [folderName, subFolder] : container.folders)
+            countDbMatches(subFolder);
+    }
+
     void detectMovePairs(const InSyncFolder& container) const
     {
         for (const auto& [fileName, dbAttrib] : container.files)
@@ -510,26 +627,58 @@ private:
         return nullptr;
     }
 
+    //2nd tier for devices without file IDs: (size, date) must be unique among one-side-only files *and* database files
+    template <SelectSide side>
+    FilePair* getAssocFilePairBySizeTime(const InSyncFile& dbFile) const
+    {
+        const InSyncDescrFile& dbDescr = SelectParam<side>::ref(dbFile.left, dbFile.right);
+        if (dbDescr.filePrint != 0) //device supports file IDs after all => different ID means: not the same file
+            return nullptr;
+
+        const SizeTimeMap& exOneSideBySizeTime = SelectParam<side>::ref(exLeftOnlyBySizeTime_, exRightOnlyBySizeTime_);
+
+        if (const auto it = exOneSideBySizeTime.find(getSizeTimeKey<side>(dbFile));
+            it != exOneSideBySizeTime.end())
+            if (FilePair* file = it->second.file;
+                file && it->second.dbMatches == 1)
+            {
+                const ContentHash& fileHash = file->getContentHash<side>(); //optional: usually not available for one-side-only files
+                if (fileHash != ContentHash{} && dbDescr.contentHash != ContentHash{} && fileHash != dbDescr.contentHash)
+                    return nullptr;
+                return file;
+            }
+        return nullptr;
+    }
+
     void findAndSetMovePair(const InSyncFile& dbFile) const
     {
         if (stillInSync(dbFile, cmpVar_, fileTimeTolerance_, ignoreTimeShiftMinutes_))
-            if (FilePair* fileLeftOnly = getAssocFilePair<SelectSide::left>(dbFile))
-                if (sameSizeAndDate<SelectSide::left>(*fileLeftOnly, dbFile))
-                    if (FilePair* fileRightOnly = getAssocFilePair<SelectSide::right>(dbFile))
-                        if (sameSizeAndDate<SelectSide::right>(*fileRightOnly, dbFile))
-                        {
-                            assert((!fileLeftOnly ->getMoveRef() &&
-                                    !fileRightOnly->getMoveRef()) ||
-                                   (fileLeftOnly ->getMoveRef() == fileRightOnly->getId() &&
-                                    fileRightOnly->getMoveRef() == fileLeftOnly ->getId()));
-
-                            if (fileLeftOnly ->getMoveRef() == nullptr && //needless check!? file prints are unique in this context!
-                                fileRightOnly->getMoveRef() == nullptr)   //
-                            {
-                                fileLeftOnly ->setMoveRef(fileRightOnly->getId()); //found a pair, mark it!
-                                fileRightOnly->setMoveRef(fileLeftOnly ->getId()); //
-                            }
-                        }
+        {
+            FilePair* fileLeftOnly  = getAssocFilePair<SelectSide::left >(dbFile);
+            FilePair* fileRightOnly = getAssocFilePair<SelectSide::right>(dbFile);
+
+            //match by (size, date) only if the other side is still found at the database path: we need *some* evidence of a move!
+            if (!fileLeftOnly && fileRightOnly && exRightOnlyByPath_.contains(&dbFile))
+                fileLeftOnly = getAssocFilePairBySizeTime<SelectSide::left>(dbFile);
+            else if (fileLeftOnly && !fileRightOnly && exLeftOnlyByPath_.contains(&dbFile))
+                fileRightOnly = getAssocFilePairBySizeTime<SelectSide::right>(dbFile);
+
+            if (fileLeftOnly && sameSizeAndDate<SelectSide::left>(*fileLeftOnly, dbFile))
+                if (fileRightOnly && sameSizeAndDate<SelectSide::right>(*fileRightOnly, dbFile))
+                {
+                    assert((!fileLeftOnly ->getMoveRef() &&
+                            !fileRightOnly->getMoveRef()) ||
+                           (fileLeftOnly ->getMoveRef() == fileRightOnly->getId() &&
+                            fileRightOnly->getMoveRef() == fileLeftOnly ->getId()));
+
+                    if (fileLeftOnly ->getMoveRef() == nullptr && //needless check!? file prints are unique in this context!
+                        fileRightOnly->getMoveRef() == nullptr)   //
+                    {
+                        fileLeftOnly ->setMoveRef(fileRightOnly->getId()); //found a pair, mark it!
+                        fileRightOnly->setMoveRef(fileLeftOnly ->getId()); //
+                    }
+                }
+        }
     }
 
     const CompareVariant cmpVar_;
@@ -545,6 +694,9 @@ private:
     std::unordered_map<const InSyncFile*, FilePair*>  exLeftOnlyByPath_; //MSVC: only 4% faster than std::map for 1 million items!
     std::unordered_map<const InSyncFile*, FilePair*> exRightOnlyByPath_;
 
+    SizeTimeMap  exLeftOnlyBySizeTime_; //one-side-only files without file ID and without association by path
+    SizeTimeMap exRightOnlyBySizeTime_; //
+
     /*  Detect Renamed Files:
 
          X  ->  |_|      Create right
@@ -562,6 +714,11 @@ private:
              \|/                                        \|/
         file left only                             file right only
 
+        no file IDs (FAT, network shares, most remote AFS): fall back to unique (size, date) for one side if the other side is associated by path
+          - (size, date) must be unique among one-side-only files *and* all database files: ambiguity => copy + delete as before
+          - database file must not have a file ID for this side: device with file IDs + different ID => not the same file
+          - content hash from database is compared if also available for the file
+
        FAT caveat: file IDs are generally not stable when file is either moved or renamed!
          1. Move/rename operations on FAT cannot be detected reliably.
          2. database generally contains wrong file ID on FAT after renaming from .ffs_tmp files => correct file IDs in database only after next sync
@@ -573,28 +730,36 @@ private:
 class RedetermineTwoWay
 {
 public:
-    static void execute(BaseFolderPair& baseFolder, const InSyncFolder& dbFolder) { RedetermineTwoWay(baseFolder, dbFolder); }
-
-private:
-    RedetermineTwoWay(BaseFolderPair& baseFolder, const InSyncFolder& dbFolder) :
-        cmpVar_                (baseFolder.getCompVariant()),
-        fileTimeTolerance_     (baseFolder.getFileTimeTolerance()),
-        ignoreTimeShiftMinutes_(baseFolder.getIgnoredTimeShift())
+    static void execute(BaseFolderPair& baseFolder, const InSyncFolder& dbFolder, SubTreeThreadGroup& tg)
     {
         //-> considering filter not relevant:
         //  if stricter filter than last time: all ok;
         //  if less strict filter (if file ex on both sides -> conflict, fine; if file ex. on one side: copy to other side: fine)
-        recurse(baseFolder, &dbFolder, &dbFolder);
+        runOnSubTree(tg, [&baseFolder, &dbFolder] { RedetermineTwoWay(baseFolder).processItems(baseFolder, &dbFolder, &dbFolder); });
+
+        for (FolderPair& folder : baseFolder.refSubFolders())
+            runOnSubTree(tg, [&baseFolder, &dbFolder, &folder] { RedetermineTwoWay(baseFolder).processDir(folder, &dbFolder, &dbFolder); });
     }
 
+private:
+    explicit RedetermineTwoWay(const BaseFolderPair& baseFolder) : //one instance per task: don't share ref-counted conflict texts between threads needlessly
+        cmpVar_                (baseFolder.getCompVariant()),
+        fileTimeTolerance_     (baseFolder.getFileTimeTolerance()),
+        ignoreTimeShiftMinutes_(baseFolder.getIgnoredTimeShift()) {}
+
     void recurse(ContainerObject& hierObj, const InSyncFolder* dbFolderL, const InSyncFolder* dbFolderR) const
+    {
+        processItems(hierObj, dbFolderL, dbFolderR);
+        for (FolderPair& folder : hierObj.refSubFolders())
+            processDir(folder, dbFolderL, dbFolderR);
+    }
+
+    void processItems(ContainerObject& hierObj, const InSyncFolder* dbFolderL, const InSyncFolder* dbFolderR) const //files and symlinks only
     {
         for (FilePair& file : hierObj.refSubFiles())
             processFile(file, dbFolderL, dbFolderR);
         for (SymlinkPair& link : hierObj.refSubLinks())
             processSymlink(link, dbFolderL, dbFolderR);
-        for (FolderPair& folder : hierObj.refSubFolders())
-            processDir(folder, dbFolderL, dbFolderR);
     }
 
     void processFile(FilePair& file, const InSyncFolder* dbFolderL, const InSyncFolder* dbFolderR) const
@@ -605,9 +770,9 @@ private:
 
         //##################### schedule old temporary files for deletion ####################
         if (cat == FILE_LEFT_SIDE_ONLY && endsWith(file.getItemName<SelectSide::left>(), AFS::TEMP_FILE_ENDING))
-            return file.setSyncDir(SyncDirection::left);
+            return file.setSyncDir(isResumableTempFile<SelectSide::left>(file) ? SyncDirection::none : SyncDirection::left);
         else if (cat == FILE_RIGHT_SIDE_ONLY && endsWith(file.getItemName<SelectSide::right>(), AFS::TEMP_FILE_ENDING))
-            return file.setSyncDir(SyncDirection::right);
+            return file.setSyncDir(isResumableTempFile<SelectSide::right>(file) ? SyncDirection::none : SyncDirection::right);
         //####################################################################################
 
         //try to find corresponding database entry
@@ -623,7 +788,7 @@ private:
         };
         const InSyncFile* dbEntryL = getDbEntry(dbFolderL, file.getItemName<SelectSide::left>());
         const InSyncFile* dbEntryR = dbEntryL;
-        if (dbFolderL != dbFolderR || getUnicodeNormalForm(file.getItemName<SelectSide::left>()) != getUnicodeNormalForm(file.getItemName<SelectSide::right>()))
+        if (dbFolderL != dbFolderR || !haveSameDbName(file))
             dbEntryR = getDbEntry(dbFolderR, file.getItemName<SelectSide::right>());
 
         //evaluation
@@ -667,7 +832,7 @@ private:
         };
         const InSyncSymlink* dbEntryL = getDbEntry(dbFolderL, symlink.getItemName<SelectSide::left>());
         const InSyncSymlink* dbEntryR = dbEntryL;
-        if (dbFolderL != dbFolderR || getUnicodeNormalForm(symlink.getItemName<SelectSide::left>()) != getUnicodeNormalForm(symlink.getItemName<SelectSide::right>()))
+        if (dbFolderL != dbFolderR || !haveSameDbName(symlink))
             dbEntryR = getDbEntry(dbFolderR, symlink.getItemName<SelectSide::right>());
 
         //evaluation
@@ -716,7 +881,7 @@ private:
         };
         const InSyncFolder* dbEntryL = getDbEntry(dbFolderL, folder.getItemName<SelectSide::left>());
         const InSyncFolder* dbEntryR = dbEntryL;
-        if (dbFolderL != dbFolderR || getUnicodeNormalForm(folder.getItemName<SelectSide::left>()) != getUnicodeNormalForm(folder.getItemName<SelectSide::right>()))
+        if (dbFolderL != dbFolderR || !haveSameDbName(folder))
             dbEntryR = getDbEntry(dbFolderR, folder.getItemName<SelectSide::right>());
 
         if (cat != DIR_EQUAL)
@@ -786,6 +951,7 @@ std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>> fff::extractDirecti
 
 
 void fff::redetermineSyncDirection(const std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>>& directCfgs,
+                                   const std::map<AfsDevice, size_t>& deviceParallelOps,
                                    PhaseCallback& callback /*throw X*/) //throw X
 {
     if (directCfgs.empty())
@@ -798,36 +964,53 @@ void fff::redetermineSyncDirection(const std::vector<std::pair<BaseFolderPair*,
     ZEN_ON_SCOPE_EXIT
     (
         //*INDENT-OFF*
-        for (const auto& [baseFolder, dirCfg] : directCfgs)
-            if (!allEqualPairs.contains(baseFolder))
-            {
-                auto it = lastSyncStates.find(baseFolder);
-                const InSyncFolder* lastSyncState = it != lastSyncStates.end() ? &it->second.ref() : nullptr;
+        auto getLastSyncState = [&](const BaseFolderPair* baseFolder) -> const InSyncFolder*
+        {
+            auto it = lastSyncStates.find(baseFolder);
+            return it != lastSyncStates.end() ? &it->second.ref() : nullptr;
+        };
+        {
+            //tens of millions of rows => parallelize by folder pair and top-level sub tree
+            SubTreeThreadGroup tg(std::max<size_t>(std::thread::hardware_concurrency(), 1), Zstr("Sync Directions"));
 
-                //set sync directions
-                if (dirCfg.var == SyncVariant::twoWay)
+            for (const auto& [baseFolder, dirCfg] : directCfgs)
+                if (!allEqualPairs.contains(baseFolder))
                 {
-                    if (lastSyncState)
-                        RedetermineTwoWay::execute(*baseFolder, *lastSyncState);
-                    else //default fallback
+                    const InSyncFolder* lastSyncState = getLastSyncState(baseFolder);
+
+                    //set sync directions
+                    if (dirCfg.var == SyncVariant::twoWay)
                     {
-                        std::wstring msg = _("Setting directions for first synchronization: Old files will be overwritten with newer files.");
-                        if (directCfgs.size() > 1)
-                            msg += L'\n' + AFS::getDisplayPath(baseFolder->getAbstractPath<SelectSide::left >()) + L' ' + getVariantNameWithSymbol(dirCfg.var) + L' ' +
-                                          AFS::getDisplayPath(baseFolder->getAbstractPath<SelectSide::right>());
+                        if (lastSyncState)
+                            RedetermineTwoWay::execute(*baseFolder, *lastSyncState, tg);
+                        else //default fallback
+                        {
+                            std::wstring msg = _("Setting directions for first synchronization: Old files will be overwritten with newer files.");
+                            if (directCfgs.size() > 1)
+                                msg += L'\n' + AFS::getDisplayPath(baseFolder->getAbstractPath<SelectSide::left >()) + L' ' + getVariantNameWithSymbol(dirCfg.var) + L' ' +
+                                              AFS::getDisplayPath(baseFolder->getAbstractPath<SelectSide::right>());
 
-                        try { callback.logInfo(msg); /*throw X*/} catch (...) {};
+                            try { callback.logInfo(msg); /*throw X*/} catch (...) {};
 
-                        Redetermine::execute(getTwoWayUpdateSet(), *baseFolder);
+                            Redetermine::execute(getTwoWayUpdateSet(), *baseFolder, tg);
+                        }
                     }
+                    else
+                        Redetermine::execute(extractDirections(dirCfg), *baseFolder, tg);
                 }
-                else
-                    Redetermine::execute(extractDirections(dirCfg), *baseFolder);
+            tg.wait();
+
+            //detect renamed files: requires sync directions of the complete folder pair
+            for (const auto& [baseFolder, dirCfg] : directCfgs)
+                if (!allEqualPairs.contains(baseFolder))
+                    if (const InSyncFolder* lastSyncState = getLastSyncState(baseFolder))
+                        runOnSubTree(tg, [baseFolder, lastSyncState] { DetectMovedFiles::execute(*baseFolder, *lastSyncState); });
+            tg.wait();
+        }
 
-                //detect renamed files
-                if (lastSyncState)
-                    DetectMovedFiles::execute(*baseFolder, *lastSyncState);
-            }
+        for (const auto& [baseFolder, dirCfg] : directCfgs)
+            if (!allEqualPairs.contains(baseFolder))
+                baseFolder->resetSyncCfgBufferedRec(); //notifications were suspended
         //*INDENT-ON*
     );
 
@@ -842,7 +1025,7 @@ void fff::redetermineSyncDirection(const std::vector<std::pair<BaseFolderPair*,
         }
 
     //(try to) load sync-database files
-    lastSyncStates = loadLastSynchronousState(baseFoldersForDbLoad,
+    lastSyncStates = loadLastSynchronousState(baseFoldersForDbLoad, deviceParallelOps,
                                               callback /*throw X*/); //throw X
 
     callback.updateStatus(_("Calculating sync directions...")); //throw X
@@ -967,34 +1150,35 @@ public:
     static void execute(ContainerObject& hierObj, const PathFilter& filterProcIn) { ApplyHardFilter(hierObj, filterProcIn); }
 
 private:
-    ApplyHardFilter(ContainerObject& hierObj, const PathFilter& filterProcIn) : filterProc(filterProcIn)  { recurse(hierObj); }
+    ApplyHardFilter(ContainerObject& hierObj, const PathFilter& filterProcIn) : filterProc(filterProcIn)  { recurse(hierObj, FolderFilterState()); }
 
-    void recurse(ContainerObject& hierObj) const
+    void recurse(ContainerObject& hierObj, const FolderFilterState& parentState) const
     {
         for (FilePair& file : hierObj.refSubFiles())
-            processFile(file);
+            processFile(file, parentState);
         for (SymlinkPair& link : hierObj.refSubLinks())
-            processLink(link);
+            processLink(link, parentState);
         for (FolderPair& folder : hierObj.refSubFolders())
-            processDir(folder);
+            processDir(folder, parentState);
     }
 
-    void processFile(FilePair& file) const
+    void processFile(FilePair& file, const FolderFilterState& parentState) const
     {
         if (Eval<strategy>::process(file))
-            file.setActive(filterProc.passFileFilter(file.getRelativePathAny()));
+            file.setActive(filterProc.passFileFilter(file.getRelativePathAny(), parentState));
     }
 
-    void processLink(SymlinkPair& symlink) const
+    void processLink(SymlinkPair& symlink, const FolderFilterState& parentState) const
     {
         if (Eval<strategy>::process(symlink))
-            symlink.setActive(filterProc.passFileFilter(symlink.getRelativePathAny()));
+            symlink.setActive(filterProc.passFileFilter(symlink.getRelativePathAny(), parentState));
     }
 
-    void processDir(FolderPair& folder) const
+    void processDir(FolderPair& folder, const FolderFilterState& parentState) const
     {
         bool childItemMightMatch = true;
-        const bool filterPassed = filterProc.passDirFilter(folder.getRelativePathAny(), &childItemMightMatch);
+        FolderFilterState dirState;
+        const bool filterPassed = filterProc.passDirFilter(folder.getRelativePathAny(), parentState, childItemMightMatch, dirState);
 
         if (Eval<strategy>::process(folder))
             folder.setActive(filterPassed);
@@ -1005,7 +1189,7 @@ private:
             return;
         }
 
-        recurse(folder);
+        recurse(folder, dirState);
     }
 
     const PathFilter& filterProc;
@@ -1288,20 +1472,18 @@ void copyToAlternateFolderFrom(const std::vector<const FileSystemObject*>& rowsT
                                const AbstractPath& targetFolderPath,
                                bool keepRelPaths,
                                bool overwriteIfExists,
-                               ProcessCallback& callback /*throw X*/) //throw X
+                               const std::map<AfsDevice, size_t>& deviceParallelOps,
+                               PhaseCallback& callback /*throw X*/) //throw X
 {
-    auto notifyItemCopy = [&](const std::wstring& statusText, const std::wstring& displayPath)
-    {
-        std::wstring msg = replaceCpy(statusText, L"%x", fmtPath(displayPath));
-        callback.logInfo(msg);                 //throw X
-        callback.updateStatus(std::move(msg)); //
-    };
     const std::wstring txtCreatingFile  (_("Creating file %x"         ));
     const std::wstring txtCreatingFolder(_("Creating folder %x"       ));
     const std::wstring txtCreatingLink  (_("Creating symbolic link %x"));
 
-    auto copyItem = [&](const AbstractPath& targetPath, //throw FileError
-                        const std::function<void(const std::function<void()>& deleteTargetItem)>& copyItemPlain) //throw FileError
+    ExistingFolderCache knownFolders; //target folders: shared parent paths are checked only once
+
+    //runs on worker threads: FileSystemObject is only read while massParallelExecute() is running
+    auto copyItem = [overwriteIfExists, &knownFolders](const AbstractPath& targetPath, //throw FileError
+                                        const std::function<void(const std::function<void()>& deleteTargetItem)>& copyItemPlain) //throw FileError
     {
         //start deleting existing target as required by copyFileTransactional():
         //best amortized performance if "already existing" is the most common case
@@ -1338,17 +1520,25 @@ void copyToAlternateFolderFrom(const std::vector<const FileSystemObject*>& rowsT
             }
 
             //parent folder missing  => create + retry
-            //parent folder existing (maybe externally created shortly after copy attempt) => retry
+            //parent folder existing (maybe externally created shortly after copy attempt, e.g. by a parallel task) => retry
             if (const std::optional<AbstractPath>& targetParentPath = AFS::getParentPath(targetPath))
-                AFS::createFolderIfMissingRecursion(*targetParentPath); //throw FileError
+                AFS::createFolderIfMissingRecursion(*targetParentPath, knownFolders); //throw FileError
 
             //retry:
             copyItemPlain(nullptr /*deleteTargetItem*/); //throw FileError
         }
     };
 
+    //schedule on the device with the smaller parallelOps budget: source and target are both busy during the copy
+    auto getWorkloadPath = [&](const AbstractPath& sourcePath, const AbstractPath& targetPath)
+    {
+        return getDeviceParallelOps(deviceParallelOps, sourcePath.afsDevice) <=
+               getDeviceParallelOps(deviceParallelOps, targetPath.afsDevice) ? sourcePath : targetPath;
+    };
+
+    std::vector<std::pair<AbstractPath, ParallelWorkItem>> parallelWorkload;
+
     for (const FileSystemObject* fsObj : rowsToCopy)
-        tryReportingError([&]
     {
         const Zstring& relPath = keepRelPaths ? fsObj->getRelativePath<side>() : fsObj->getItemName<side>();
         const AbstractPath sourcePath = fsObj->getAbstractPath<side>();
@@ -1356,53 +1546,72 @@ void copyToAlternateFolderFrom(const std::vector<const FileSystemObject*>& rowsT
 
         visitFSObject(*fsObj, [&](const FolderPair& folder)
         {
-            ItemStatReporter statReporter(1, 0, callback);
-            notifyItemCopy(txtCreatingFolder, AFS::getDisplayPath(targetPath));
+            parallelWorkload.emplace_back(getWorkloadPath(sourcePath, targetPath), [targetPath, &txtCreatingFolder, &knownFolders](ParallelContext& ctx) //throw ThreadStopRequest
+            {
+                tryReportingError([&] //throw ThreadStopRequest
+                {
+                    AsyncItemStatReporter statReporter(1, 0, ctx.acb);
+                    ctx.acb.reportInfo(replaceCpy(txtCreatingFolder, L"%x", fmtPath(AFS::getDisplayPath(targetPath)))); //throw ThreadStopRequest
 
-            AFS::createFolderIfMissingRecursion(targetPath); //throw FileError
-            statReporter.reportDelta(1, 0);
-            //folder might already exist: see creation of intermediate directories below
+                    AFS::createFolderIfMissingRecursion(targetPath, knownFolders); //throw FileError
+                    statReporter.reportDelta(1, 0);
+                    //folder might already exist: see creation of intermediate directories below
+                }, ctx.acb);
+            });
         },
 
         [&](const FilePair& file)
         {
-            std::wstring statusMsg = replaceCpy(txtCreatingFile, L"%x", fmtPath(AFS::getDisplayPath(targetPath)));
-            callback.logInfo(statusMsg); //throw X
-            PercentStatReporter statReporter(std::move(statusMsg), file.getFileSize<side>(), callback); //throw X
-
-            const FileAttributes attr = file.getAttributes<side>();
-            const AFS::StreamAttributes sourceAttr{attr.modTime, attr.fileSize, attr.filePrint};
-
-            copyItem(targetPath, [&](const std::function<void()>& deleteTargetItem) //throw FileError
+            parallelWorkload.emplace_back(getWorkloadPath(sourcePath, targetPath), [sourcePath, targetPath, attr = file.getAttributes<side>(), &txtCreatingFile, &copyItem](ParallelContext& ctx) //throw ThreadStopRequest
             {
-                //already existing + !overwriteIfExists: undefined behavior! (e.g. fail/overwrite/auto-rename)
-                /*const AFS::FileCopyResult result =*/ AFS::copyFileTransactional(sourcePath, sourceAttr, targetPath, //throw FileError, ErrorFileLocked, X
-                                                                                  false /*copyFilePermissions*/, true /*transactionalCopy*/, deleteTargetItem,
-                                                                                  [&](int64_t bytesDelta)
+                tryReportingError([&] //throw ThreadStopRequest
                 {
-                    statReporter.updateStatus(0, bytesDelta); //throw X
-                    callback.requestUiUpdate(); //throw X  => not reliably covered by PercentStatReporter::updateStatus()! e.g. during first few seconds: STATUS_PERCENT_DELAY!
-                });
-                //result.errorModTime? => probably irrelevant (behave like Windows Explorer)
+                    std::wstring statusMsg = replaceCpy(txtCreatingFile, L"%x", fmtPath(AFS::getDisplayPath(targetPath)));
+                    ctx.acb.logInfo(statusMsg); //throw ThreadStopRequest
+                    AsyncPercentStatReporter statReporter(std::move(statusMsg), attr.fileSize, ctx.acb); //throw ThreadStopRequest
+
+                    const AFS::StreamAttributes sourceAttr{attr.modTime, attr.fileSize, attr.filePrint};
+
+                    copyItem(targetPath, [&](const std::function<void()>& deleteTargetItem) //throw FileError
+                    {
+                        //already existing + !overwriteIfExists: undefined behavior! (e.g. fail/overwrite/auto-rename)
+                        /*const AFS::FileCopyResult result =*/ AFS::copyFileTransactional(sourcePath, sourceAttr, targetPath, //throw FileError, ErrorFileLocked, ThreadStopRequest
+                                                                                          false /*copyFilePermissions*/, true /*transactionalCopy*/, deleteTargetItem,
+                                                                                          false /*deleteTargetPermanently*/, false /*calcContentHash*/,
+                                                                                          [&](int64_t bytesDelta)
+                        {
+                            statReporter.updateStatus(0, bytesDelta); //throw ThreadStopRequest
+                            interruptionPoint(); //throw ThreadStopRequest => not reliably covered by AsyncPercentStatReporter::updateStatus()!
+                        });
+                        //result.errorModTime? => probably irrelevant (behave like Windows Explorer)
+                    });
+                    statReporter.updateStatus(1, 0); //throw ThreadStopRequest
+                }, ctx.acb);
             });
-            statReporter.updateStatus(1, 0); //throw X
         },
 
         [&](const SymlinkPair& symlink)
         {
-            ItemStatReporter statReporter(1, 0, callback);
-            notifyItemCopy(txtCreatingLink, AFS::getDisplayPath(targetPath));
-
-            copyItem(targetPath, [&](const std::function<void()>& deleteTargetItem) //throw FileError
+            parallelWorkload.emplace_back(getWorkloadPath(sourcePath, targetPath), [sourcePath, targetPath, &txtCreatingLink, &copyItem](ParallelContext& ctx) //throw ThreadStopRequest
             {
-                deleteTargetItem(); //throw FileError
-                AFS::copySymlink(sourcePath, targetPath, false /*copyFilePermissions*/); //throw FileError
+                tryReportingError([&] //throw ThreadStopRequest
+                {
+                    AsyncItemStatReporter statReporter(1, 0, ctx.acb);
+                    ctx.acb.reportInfo(replaceCpy(txtCreatingLink, L"%x", fmtPath(AFS::getDisplayPath(targetPath)))); //throw ThreadStopRequest
+
+                    copyItem(targetPath, [&](const std::function<void()>& deleteTargetItem) //throw FileError
+                    {
+                        deleteTargetItem(); //throw FileError
+                        AFS::copySymlink(sourcePath, targetPath, false /*copyFilePermissions*/); //throw FileError
+                    });
+                    statReporter.reportDelta(1, 0);
+                }, ctx.acb);
             });
-            statReporter.reportDelta(1, 0);
         });
+    }
 
-        callback.requestUiUpdate(); //throw X
-    }, callback); //throw X
+    massParallelExecute(parallelWorkload, deviceParallelOps,
+                        Zstr("Copy To"), callback /*throw X*/); //throw X
 }
 }
 
@@ -1412,6 +1621,7 @@ void fff::copyToAlternateFolder(std::span<const FileSystemObject* const> rowsToC
                                 const Zstring& targetFolderPathPhrase,
                                 bool keepRelPaths,
                                 bool overwriteIfExists,
+                                const std::map<AfsDevice, size_t>& deviceParallelOps,
                                 WarningDialogs& warnings,
                                 ProcessCallback& callback /*throw X*/) //throw X
 {
@@ -1437,8 +1647,8 @@ void fff::copyToAlternateFolder(std::span<const FileSystemObject* const> rowsToC
 
     const AbstractPath targetFolderPath = createAbstractPath(targetFolderPathPhrase);
 
-    copyToAlternateFolderFrom<SelectSide::left >(itemSelectionLeft,  targetFolderPath, keepRelPaths, overwriteIfExists, callback);
-    copyToAlternateFolderFrom<SelectSide::right>(itemSelectionRight, targetFolderPath, keepRelPaths, overwriteIfExists, callback);
+    copyToAlternateFolderFrom<SelectSide::left >(itemSelectionLeft,  targetFolderPath, keepRelPaths, overwriteIfExists, deviceParallelOps, callback);
+    copyToAlternateFolderFrom<SelectSide::right>(itemSelectionRight, targetFolderPath, keepRelPaths, overwriteIfExists, deviceParallelOps, callback);
 }
 
 //############################################################################################################
@@ -1448,15 +1658,9 @@ namespace
 template <SelectSide side>
 void deleteFromGridAndHDOneSide(std::vector<FileSystemObject*>& rowsToDelete,
                                 bool useRecycleBin,
+                                const std::map<AfsDevice, size_t>& deviceParallelOps,
                                 PhaseCallback& callback)
 {
-    auto notifyItemDeletion = [&](const std::wstring& statusText, const std::wstring& displayPath)
-    {
-        std::wstring msg = replaceCpy(statusText, L"%x", fmtPath(displayPath));
-        callback.logInfo(msg);                 //throw X
-        callback.updateStatus(std::move(msg)); //
-    };
-
     std::wstring txtRemovingFile;
     std::wstring txtRemovingDirectory;
     std::wstring txtRemovingSymlink;
@@ -1474,69 +1678,126 @@ void deleteFromGridAndHDOneSide(std::vector<FileSystemObject*>& rowsToDelete,
         txtRemovingSymlink   = _("Deleting symbolic link %x");
     }
 
+    //items within a selected folder are deleted implicitly: don't race the folder's (recursive) deletion
+    std::unordered_set<const ContainerObject*> foldersToDelete;
+    for (const FileSystemObject* fsObj : rowsToDelete)
+        if (auto folder = dynamic_cast<const FolderPair*>(fsObj))
+            foldersToDelete.insert(folder);
+
+    auto isInFolderToDelete = [&](const FileSystemObject& fsObj)
+    {
+        for (const ContainerObject* parent = &fsObj.parent();;)
+        {
+            if (foldersToDelete.contains(parent))
+                return true;
+            auto parentFolder = dynamic_cast<const FolderPair*>(parent);
+            if (!parentFolder)
+                return false; //reached BaseFolderPair
+            parent = &parentFolder->parent();
+        }
+    };
+
+    //runs on worker threads: FileSystemObject is only read while massParallelExecute() is running => update file model afterwards
+    std::vector<char> deleted(rowsToDelete.size()); //each item is owned by a single task
+    int itemsSkipped = 0;
 
-    for (FileSystemObject* fsObj : rowsToDelete) //all pointers are required(!) to be bound
-        tryReportingError([&]
+    std::vector<std::pair<AbstractPath, ParallelWorkItem>> parallelWorkload;
+
+    for (size_t i = 0; i < rowsToDelete.size(); ++i) //all pointers are required(!) to be bound
     {
-        ItemStatReporter statReporter(1, 0, callback);
+        const FileSystemObject& fsObj = *rowsToDelete[i];
+
+        if (fsObj.isEmpty<side>() || isInFolderToDelete(fsObj))
+        {
+            ++itemsSkipped;
+            continue;
+        }
 
-        if (!fsObj->isEmpty<side>()) //element may be implicitly deleted, e.g. if parent folder was deleted first
+        auto deleteItem = [&deleted = deleted[i]](ParallelContext& ctx, const std::wstring& txtRemoving, //throw ThreadStopRequest
+                                                  const std::function<void(AsyncItemStatReporter& statReporter)>& removeItem /*throw FileError*/)
         {
-            visitFSObject(*fsObj,
-                          [&](const FolderPair& folder)
+            const std::wstring errMsg = tryReportingError([&] //throw ThreadStopRequest
             {
-                if (useRecycleBin)
-                {
-                    notifyItemDeletion(txtRemovingDirectory, AFS::getDisplayPath(folder.getAbstractPath<side>())); //throw X
+                AsyncItemStatReporter statReporter(1, 0, ctx.acb);
+                ctx.acb.reportInfo(replaceCpy(txtRemoving, L"%x", fmtPath(AFS::getDisplayPath(ctx.itemPath)))); //throw ThreadStopRequest
 
-                    AFS::recycleItemIfExists(folder.getAbstractPath<side>()); //throw FileError
-                    statReporter.reportDelta(1, 0);
-                }
-                else
-                {
-                    auto onBeforeFileDeletion = [&](const std::wstring& displayPath)
-                    {
-                        notifyItemDeletion(txtRemovingFile, displayPath); //throw X
-                        statReporter.reportDelta(1, 0);
-                    };
-                    auto onBeforeDirDeletion = [&](const std::wstring& displayPath)
-                    {
-                        notifyItemDeletion(txtRemovingDirectory, displayPath); //throw X
-                        statReporter.reportDelta(1, 0);
-                    };
+                removeItem(statReporter); //throw FileError
+                statReporter.reportDelta(1, 0);
+            }, ctx.acb);
 
-                    AFS::removeFolderIfExistsRecursion(folder.getAbstractPath<side>(), onBeforeFileDeletion, onBeforeDirDeletion); //throw FileError
-                }
-            },
+            if (errMsg.empty())
+                deleted = true;
+        };
 
-            [&](const FilePair& file)
+        visitFSObject(fsObj, [&](const FolderPair& folder)
+        {
+            parallelWorkload.emplace_back(folder.getAbstractPath<side>(), [deleteItem, useRecycleBin, &txtRemovingDirectory, &txtRemovingFile](ParallelContext& ctx) //throw ThreadStopRequest
             {
-                notifyItemDeletion(txtRemovingFile, AFS::getDisplayPath(file.getAbstractPath<side>())); //throw X
+                deleteItem(ctx, txtRemovingDirectory, [&](AsyncItemStatReporter& statReporter) //throw FileError
+                {
+                    if (useRecycleBin)
+                        AFS::recycleItemIfExists(ctx.itemPath); //throw FileError
+                    else
+                    {
+                        auto onBeforeFileDeletion = [&](const std::wstring& displayPath)
+                        {
+                            ctx.acb.reportInfo(replaceCpy(txtRemovingFile, L"%x", fmtPath(displayPath))); //throw ThreadStopRequest
+                            statReporter.reportDelta(1, 0);
+                        };
+                        auto onBeforeDirDeletion = [&](const std::wstring& displayPath)
+                        {
+                            ctx.acb.reportInfo(replaceCpy(txtRemovingDirectory, L"%x", fmtPath(displayPath))); //throw ThreadStopRequest
+                            statReporter.reportDelta(1, 0);
+                        };
 
-                if (useRecycleBin)
-                    AFS::recycleItemIfExists(file.getAbstractPath<side>()); //throw FileError
-                else
-                    AFS::removeFileIfExists(file.getAbstractPath<side>()); //throw FileError
-                statReporter.reportDelta(1, 0);
-            },
+                        AFS::removeFolderIfExistsRecursion(ctx.itemPath, onBeforeFileDeletion, onBeforeDirDeletion); //throw FileError, ThreadStopRequest
+                    }
+                });
+            });
+        },
 
-            [&](const SymlinkPair& symlink)
+        [&](const FilePair& file)
+        {
+            parallelWorkload.emplace_back(file.getAbstractPath<side>(), [deleteItem, useRecycleBin, &txtRemovingFile](ParallelContext& ctx) //throw ThreadStopRequest
             {
-                notifyItemDeletion(txtRemovingSymlink, AFS::getDisplayPath(symlink.getAbstractPath<side>())); //throw X
+                deleteItem(ctx, txtRemovingFile, [&](AsyncItemStatReporter& statReporter) //throw FileError
+                {
+                    if (useRecycleBin)
+                        AFS::recycleItemIfExists(ctx.itemPath); //throw FileError
+                    else
+                        AFS::removeFileIfExists(ctx.itemPath); //throw FileError
+                });
+            });
+        },
 
-                if (useRecycleBin)
-                    AFS::recycleItemIfExists(symlink.getAbstractPath<side>()); //throw FileError
-                else
-                    AFS::removeSymlinkIfExists(symlink.getAbstractPath<side>()); //throw FileError
-                statReporter.reportDelta(1, 0);
+        [&](const SymlinkPair& symlink)
+        {
+            parallelWorkload.emplace_back(symlink.getAbstractPath<side>(), [deleteItem, useRecycleBin, &txtRemovingSymlink](ParallelContext& ctx) //throw ThreadStopRequest
+            {
+                deleteItem(ctx, txtRemovingSymlink, [&](AsyncItemStatReporter& statReporter) //throw FileError
+                {
+                    if (useRecycleBin)
+                        AFS::recycleItemIfExists(ctx.itemPath); //throw FileError
+                    else
+                        AFS::removeSymlinkIfExists(ctx.itemPath); //throw FileError
+                });
             });
+        });
+    }
 
-            fsObj->removeObject<side>(); //if directory: removes recursively!
-        }
+    //already removed or deleted implicitly, e.g. together with parent folder
+    callback.updateDataTotal(-itemsSkipped, 0); //noexcept
 
-        //remain transactional as much as possible => allow for abort only *after* updating file model
-        callback.requestUiUpdate(); //throw X
-    }, callback); //throw X
+    //remain transactional as much as possible => update file model even if aborted
+    ZEN_ON_SCOPE_EXIT
+    (
+        for (size_t i = 0; i < rowsToDelete.size(); ++i)
+            if (deleted[i])
+                rowsToDelete[i]->removeObject<side>(); //if directory: removes recursively!
+    );
+
+    massParallelExecute(parallelWorkload, deviceParallelOps,
+                        Zstr("Delete"), callback /*throw X*/); //throw X
 }
 
 
@@ -1581,6 +1842,7 @@ void fff::deleteFromGridAndHD(const std::vector<FileSystemObject*>& rowsToDelete
                               const std::vector<FileSystemObject*>& rowsToDeleteOnRight, //all pointers need to be bound!
                               const std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>>& directCfgs, //attention: rows will be physically deleted!
                               bool useRecycleBin,
+                              const std::map<AfsDevice, size_t>& deviceParallelOps,
                               bool& warnRecyclerMissing,
                               ProcessCallback& callback /*throw X*/) //throw X
 {
@@ -1666,11 +1928,11 @@ void fff::deleteFromGridAndHD(const std::vector<FileSystemObject*>& rowsToDelete
         callback.reportWarning(msg, warnRecyclerMissing); //throw?
     }
 
-    deleteFromGridAndHDOneSide<SelectSide::left>(deleteRecylerLeft,   true,  callback);
-    deleteFromGridAndHDOneSide<SelectSide::left>(deletePermanentLeft, false, callback);
+    deleteFromGridAndHDOneSide<SelectSide::left>(deleteRecylerLeft,   true,  deviceParallelOps, callback);
+    deleteFromGridAndHDOneSide<SelectSide::left>(deletePermanentLeft, false, deviceParallelOps, callback);
 
-    deleteFromGridAndHDOneSide<SelectSide::right>(deleteRecylerRight,   true,  callback);
-    deleteFromGridAndHDOneSide<SelectSide::right>(deletePermanentRight, false, callback);
+    deleteFromGridAndHDOneSide<SelectSide::right>(deleteRecylerRight,   true,  deviceParallelOps, callback);
+    deleteFromGridAndHDOneSide<SelectSide::right>(deletePermanentRight, false, deviceParallelOps, callback);
 }
 
 //############################################################################################################
@@ -1714,22 +1976,81 @@ Zstring TempFileBuffer::getAndCreateFolderPath() //throw FileError
 //returns empty if not available (item not existing, error during copy)
 Zstring TempFileBuffer::getTempPath(const FileDescriptor& descr) const
 {
-    auto it = tempFilePaths_.find(descr);
-    if (it != tempFilePaths_.end())
-        return it->second;
+    auto it = tempFiles_.find(descr);
+    if (it != tempFiles_.end())
+        return it->second.tempFilePath;
     return Zstring();
 }
 
 
-void TempFileBuffer::createTempFiles(const std::set<FileDescriptor>& workLoad, ProcessCallback& callback /*throw X*/) //throw X
+void TempFileBuffer::removeTempFile(std::map<FileDescriptor, BufferedFile>::iterator it) //noexcept
 {
-    const int itemTotal = static_cast<int>(workLoad.size());
-    int64_t bytesTotal = 0;
+    try
+    {
+        if (fileAvailable(it->second.tempFilePath)) //noexcept
+            removeFilePlain(it->second.tempFilePath); //throw FileError
+    }
+    catch (FileError&) {} //not our problem: temp folder is cleaned up with ~TempFileBuffer() at the latest
+    tempFiles_.erase(it);
+}
+
+
+namespace
+{
+//upper bound for buffered temp files: least recently used are removed first
+constexpr uint64_t TEMP_FILE_BUFFER_SIZE_MAX = 2'000'000'000; //bytes
+
+
+//the external app might have modified or deleted the temporary copy in the meantime
+bool tempFileUnchanged(const Zstring& tempFilePath, const FileAttributes& attr) //noexcept
+{
+    struct stat fileInfo = {};
+    if (::stat(tempFilePath.c_str(), &fileInfo) != 0)
+        return false;
+
+    return S_ISREG(fileInfo.st_mode) &&
+           makeUnsigned(fileInfo.st_size) == attr.fileSize &&
+           nativeFileTimeToTimeT(fileInfo.st_mtim) == attr.modTime; //copyFileTransactional() sets source modification time
+}
+}
+
+
+std::set<FileDescriptor> TempFileBuffer::getFilesToCreate(const std::set<FileDescriptor>& workLoad) //noexcept
+{
+    ++invocationCount_;
+
+    //FileDescriptor includes the file attributes => different version <=> different buffer entry
+    std::set<FileDescriptor> filesToCreate;
 
     for (const FileDescriptor& descr : workLoad)
-        bytesTotal += descr.attr.fileSize;
+        if (auto it = tempFiles_.find(descr);
+            it != tempFiles_.end() && tempFileUnchanged(it->second.tempFilePath, descr.attr))
+            it->second.lastUsed = invocationCount_;
+        else
+        {
+            if (it != tempFiles_.end())
+                removeTempFile(it); //noexcept
 
-    callback.initNewPhase(itemTotal, bytesTotal, ProcessPhase::none); //throw X
+            filesToCreate.insert(descr);
+        }
+    return filesToCreate;
+}
+
+
+void TempFileBuffer::createTempFiles(const std::set<FileDescriptor>& workLoad,
+                                     const std::map<AfsDevice, size_t>& deviceParallelOps,
+                                     ProcessCallback& callback /*throw X*/) //throw X
+{
+    const std::vector<FileDescriptor> filesToCopy(workLoad.begin(), workLoad.end());
+    int64_t bytesToCopy = 0;
+
+    for (const FileDescriptor& descr : filesToCopy)
+    {
+        assert(!tempFiles_.contains(descr)); //ensure correct stats, NO overwrite-copy => caller-contract!
+        bytesToCopy += descr.attr.fileSize;
+    }
+
+    callback.initNewPhase(static_cast<int>(filesToCopy.size()), bytesToCopy, ProcessPhase::none); //throw X
     //------------------------------------------------------------------------------
 
     const std::wstring errMsg = tryReportingError([&]
@@ -1738,9 +2059,36 @@ void TempFileBuffer::createTempFiles(const std::set<FileDescriptor>& workLoad, P
     }, callback); //throw X
     if (!errMsg.empty()) return;
 
-    for (const FileDescriptor& descr : workLoad)
+    //make room: remove least recently used files, except for those requested right now
     {
-        assert(!tempFilePaths_.contains(descr)); //ensure correct stats, NO overwrite-copy => caller-contract!
+        uint64_t bytesBuffered = 0;
+        std::vector<std::map<FileDescriptor, BufferedFile>::iterator> lruOrder;
+
+        for (auto it = tempFiles_.begin(); it != tempFiles_.end(); ++it)
+        {
+            bytesBuffered += it->first.attr.fileSize;
+            if (it->second.lastUsed != invocationCount_)
+                lruOrder.push_back(it);
+        }
+        std::sort(lruOrder.begin(), lruOrder.end(), [](const auto& lhs, const auto& rhs) { return lhs->second.lastUsed < rhs->second.lastUsed; });
+
+        for (auto it : lruOrder)
+        {
+            if (bytesBuffered + bytesToCopy <= TEMP_FILE_BUFFER_SIZE_MAX)
+                break;
+            bytesBuffered -= it->first.attr.fileSize;
+            removeTempFile(it); //noexcept
+        }
+    }
+
+    //worker threads must not access tempFiles_: update after massParallelExecute()
+    std::vector<Zstring> tempFilePaths(filesToCopy.size()); //each item is owned by a single task
+
+    std::vector<std::pair<AbstractPath, ParallelWorkItem>> parallelWorkload;
+
+    for (size_t i = 0; i < filesToCopy.size(); ++i)
+    {
+        const FileDescriptor& descr = filesToCopy[i];
 
         MemoryStreamOut<std::string> cookie; //create hash to distinguish different versions and file locations
         writeNumber   (cookie, descr.attr.modTime);
@@ -1758,30 +2106,48 @@ void TempFileBuffer::createTempFiles(const std::set<FileDescriptor>& workLoad, P
         const Zstring tempFileName = Zstring(fileName.begin(), it) + Zstr('~') + descrHash + Zstring(it, fileName.end());
 
         const Zstring tempFilePath = appendSeparator(tempFolderPath_) + tempFileName;
-        const AFS::StreamAttributes sourceAttr{descr.attr.modTime, descr.attr.fileSize, descr.attr.filePrint};
 
-        tryReportingError([&]
+        parallelWorkload.emplace_back(descr.path, [attr = descr.attr, tempFilePath, &tempFilePathOut = tempFilePaths[i]](ParallelContext& ctx) //throw ThreadStopRequest
         {
-            std::wstring statusMsg = replaceCpy(_("Creating file %x"), L"%x", fmtPath(tempFilePath));
-            callback.logInfo(statusMsg); //throw X
-            PercentStatReporter statReporter(std::move(statusMsg), descr.attr.fileSize, callback); //throw X
-
-            //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
-            /*const AFS::FileCopyResult result =*/
-            AFS::copyFileTransactional(descr.path, sourceAttr, //throw FileError, ErrorFileLocked, X
-                                       createItemPathNative(tempFilePath),
-                                       false /*copyFilePermissions*/, true /*transactionalCopy*/, nullptr /*onDeleteTargetFile*/,
-                                       [&](int64_t bytesDelta)
-            {
-                statReporter.updateStatus(0, bytesDelta); //throw X
-                callback.requestUiUpdate(); //throw X  => not reliably covered by PercentStatReporter::updateStatus()! e.g. during first few seconds: STATUS_PERCENT_DELAY!
-            });
-            //result.errorModTime? => irrelevant for temp files!
-            statReporter.updateStatus(1, 0); //throw X
+            const AFS::StreamAttributes sourceAttr{attr.modTime, attr.fileSize, attr.filePrint};
 
-            tempFilePaths_[descr] = tempFilePath;
-        }, callback); //throw X
+            tryReportingError([&] //throw ThreadStopRequest
+            {
+                std::wstring statusMsg = replaceCpy(_("Creating file %x"), L"%x", fmtPath(tempFilePath));
+                ctx.acb.logInfo(statusMsg); //throw ThreadStopRequest
+                AsyncPercentStatReporter statReporter(std::move(statusMsg), attr.fileSize, ctx.acb); //throw ThreadStopRequest
+
+                //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
+                /*const AFS::FileCopyResult result =*/
+                AFS::copyFileTransactional(ctx.itemPath, sourceAttr, //throw FileError, ErrorFileLocked, ThreadStopRequest
+                                           createItemPathNative(tempFilePath),
+                                           false /*copyFilePermissions*/, true /*transactionalCopy*/, nullptr /*onDeleteTargetFile*/, false /*deleteTargetPermanently*/,
+                                           false /*calcContentHash*/,
+                                           [&](int64_t bytesDelta)
+                {
+                    statReporter.updateStatus(0, bytesDelta); //throw ThreadStopRequest
+                    interruptionPoint(); //throw ThreadStopRequest => not reliably covered by AsyncPercentStatReporter::updateStatus()!
+                });
+                //result.errorModTime? => irrelevant for temp files!
+                statReporter.updateStatus(1, 0); //throw ThreadStopRequest
 
-        callback.requestUiUpdate(); //throw X
+                tempFilePathOut = tempFilePath;
+            }, ctx.acb);
+        });
     }
+
+    //keep files copied so far, even if aborted
+    ZEN_ON_SCOPE_EXIT
+    (
+        for (size_t i = 0; i < filesToCopy.size(); ++i)
+            if (!tempFilePaths[i].empty())
+            {
+                BufferedFile& bufFile = tempFiles_[filesToCopy[i]];
+                bufFile.tempFilePath = tempFilePaths[i];
+                bufFile.lastUsed     = invocationCount_;
+            }
+    );
+
+    massParallelExecute(parallelWorkload, deviceParallelOps,
+                        Zstr("Temp Files"), callback /*throw X*/); //throw X
 }
@@ -17,10 +17,9 @@
 
 namespace fff
 {
-void recursiveObjectVisitor(FileSystemObject& fsObj,
-                            std::function<void (FolderPair&   folder)> onFolder,
-                            std::function<void (FilePair&       file)> onFile,
-                            std::function<void (SymlinkPair& symlink)> onSymlink);
+//visit fsObj and (for folders) its sub tree; static dispatch below the top level item, see visitSubTree()
+template <class FunFolder, class FunFile, class FunSymlink>
+void recursiveObjectVisitor(FileSystemObject& fsObj, FunFolder onFolder, FunFile onFile, FunSymlink onSymlink);
 
 void swapGrids(const MainConfiguration& mainCfg, FolderComparison& folderCmp,
                PhaseCallback& callback /*throw X*/); //throw X
@@ -28,6 +27,7 @@ void swapGrids(const MainConfiguration& mainCfg, FolderComparison& folderCmp,
 std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>> extractDirectionCfg(FolderComparison& folderCmp, const MainConfiguration& mainCfg);
 
 void redetermineSyncDirection(const std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>>& directCfgs,
+                              const std::map<AfsDevice, size_t>& deviceParallelOps, //for loading sync.ffs_db
                               PhaseCallback& callback /*throw X*/); //throw X
 
 void setSyncDirectionRec(SyncDirection newDirection, FileSystemObject& fsObj); //set new direction (recursively)
@@ -63,6 +63,7 @@ void copyToAlternateFolder(std::span<const FileSystemObject* const> rowsToCopyOn
                            const Zstring& targetFolderPathPhrase,
                            bool keepRelPaths,
                            bool overwriteIfExists,
+                           const std::map<AfsDevice, size_t>& deviceParallelOps, //items on the same device are processed in parallel up to this limit
                            WarningDialogs& warnings,
                            ProcessCallback& callback /*throw X*/); //throw X
 
@@ -71,6 +72,7 @@ void deleteFromGridAndHD(const std::vector<FileSystemObject*>& rowsToDeleteOnLef
                          const std::vector<FileSystemObject*>& rowsToDeleteOnRight, //all pointers need to be bound!
                          const std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>>& directCfgs, //attention: rows will be physically deleted!
                          bool useRecycleBin,
+                         const std::map<AfsDevice, size_t>& deviceParallelOps, //items on the same device are processed in parallel up to this limit
                          //global warnings:
                          bool& warnRecyclerMissing,
                          ProcessCallback& callback /*throw X*/); //throw X
@@ -94,8 +96,14 @@ public:
 
     Zstring getTempPath(const FileDescriptor& descr) const; //returns empty if not in buffer (item not existing, error during copy)
 
-    //contract: only add files not yet in the buffer!
-    void createTempFiles(const std::set<FileDescriptor>& workLoad, ProcessCallback& callback /*throw X*/); //throw X
+    //marks buffered files as recently used if still unmodified, returns files that need to be (re-)created
+    std::set<FileDescriptor> getFilesToCreate(const std::set<FileDescriptor>& workLoad); //noexcept
+
+    //contract: only add files returned by getFilesToCreate()!
+    //least recently used files are removed when exceeding the buffer's size limit
+    void createTempFiles(const std::set<FileDescriptor>& workLoad,
+                         const std::map<AfsDevice, size_t>& deviceParallelOps, //items on the same device are processed in parallel up to this limit
+                         ProcessCallback& callback /*throw X*/); //throw X
 
 private:
     TempFileBuffer           (const TempFileBuffer&) = delete;
@@ -103,8 +111,32 @@ private:
 
     void createTempFolderPath(); //throw FileError
 
-    std::map<FileDescriptor, Zstring> tempFilePaths_;
+    struct BufferedFile
+    {
+        Zstring tempFilePath;
+        uint64_t lastUsed = 0; //getFilesToCreate() invocation => LRU order
+    };
+    void removeTempFile(std::map<FileDescriptor, BufferedFile>::iterator it); //noexcept
+
+    std::map<FileDescriptor, BufferedFile> tempFiles_;
+    uint64_t invocationCount_ = 0;
     Zstring tempFolderPath_;
 };
+
+
+
+//--------------------- implementation ------------------------------------------
+template <class FunFolder, class FunFile, class FunSymlink> inline
+void recursiveObjectVisitor(FileSystemObject& fsObj, FunFolder onFolder, FunFile onFile, FunSymlink onSymlink)
+{
+    visitFSObject(fsObj, [&](const FolderPair& folderConst)
+    {
+        FolderPair& folder = const_cast<FolderPair&>(folderConst); //physical object is not const anyway
+        onFolder(folder);
+        visitSubTree(folder, onFolder, onFile, onSymlink);
+    },
+    [&](const FilePair&       file) { onFile   (const_cast<FilePair&   >(file   )); },
+    [&](const SymlinkPair& symlink) { onSymlink(const_cast<SymlinkPair&>(symlink)); });
+}
 }
 #endif //ALGORITHM_H_34218518475321452548
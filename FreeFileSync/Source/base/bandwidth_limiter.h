@@ -0,0 +1,57 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef BANDWIDTH_LIMITER_H_7302915846203958712
+#define BANDWIDTH_LIMITER_H_7302915846203958712
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+
+namespace fff
+{
+//token bucket: shared by all file copies (or content comparisons) reading from or writing to the same device
+class BandwidthLimiter
+{
+public:
+    explicit BandwidthLimiter(uint64_t bytesPerSec) :
+        bytesPerSec_(static_cast<double>(bytesPerSec)),
+        burstMax_(bytesPerSec_ * std::chrono::duration<double>(BURST_TIME).count()) {}
+
+    //charge bytes already transferred => returns time when the bucket is balanced again (caller waits until then)
+    std::chrono::steady_clock::time_point consume(int64_t bytes) //noexcept
+    {
+        std::lock_guard dummy(lockBucket_);
+        const auto now = std::chrono::steady_clock::now();
+
+        tokens_ = std::min(tokens_ + std::chrono::duration<double>(now - lastRefill_).count() * bytesPerSec_, burstMax_);
+        lastRefill_ = now;
+
+        tokens_ -= static_cast<double>(bytes); //negative: debt, to be paid off by whoever comes next, too
+        if (tokens_ >= 0)
+            return now;
+
+        return now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(-tokens_ / bytesPerSec_));
+    }
+
+private:
+    BandwidthLimiter           (const BandwidthLimiter&) = delete;
+    BandwidthLimiter& operator=(const BandwidthLimiter&) = delete;
+
+    static constexpr std::chrono::milliseconds BURST_TIME{500}; //allow short bursts (e.g. after an idle phase) of this many seconds' worth of data
+
+    const double bytesPerSec_;
+    const double burstMax_;
+
+    std::mutex lockBucket_;
+    double tokens_ = 0; //protected by lockBucket_
+    std::chrono::steady_clock::time_point lastRefill_ = std::chrono::steady_clock::now(); //
+};
+}
+
+#endif //BANDWIDTH_LIMITER_H_7302915846203958712
@@ -7,6 +7,11 @@
 #include "binary.h"
 #include <vector>
 #include <chrono>
+#include <zen/thread.h>
+#include <zen/stream_buffer.h>
+#include <zen/open_ssl.h>
+#include <zen/mem_compare.h>
+#include <zen/process_priority.h>
 
 using namespace zen;
 using namespace fff;
@@ -37,14 +42,28 @@ Impact of buffer size when files are on same disk:
 const size_t BLOCK_SIZE_MAX =  16 * 1024 * 1024;
 
 
+const size_t BLOCK_SIZE_COMPARE = 1024 * 1024; //granularity of comparison for prefetched streams
+
+const uint64_t RANGE_PARALLEL_MIN_FILE_SIZE = 1024 * 1024 * 1024; //split huge files into ranges for parallel comparison...
+const uint64_t RANGE_SIZE_MIN               =  256 * 1024 * 1024; //...but don't make ranges too small: sequential reads are still fastest
+
+const size_t SAMPLE_BLOCK_SIZE   = 64 * 1024; //sampledContentMatches(): head + tail + SAMPLE_COUNT_INNER blocks in between
+const int    SAMPLE_COUNT_INNER  = 3;
+
+
+//files below this size are compared synchronously: not worth two thread creations
+const uint64_t PREFETCH_MIN_FILE_SIZE = 1024 * 1024;
+
+
 struct StreamReader
 {
-    StreamReader(const AbstractPath& filePath, const IoCallback& notifyUnbufferedIO) : //throw FileError
-        stream_(AFS::getInputStream(filePath, notifyUnbufferedIO)), //throw FileError, ErrorFileLocked
+    explicit StreamReader(const AbstractPath& filePath) : //throw FileError, ErrorFileLocked
+        //notifyUnbufferedIO may throw X => must not be called from prefetch thread => just count bytes
+        stream_(AFS::getInputStream(filePath, [&bytesRead = bytesRead_](int64_t bytesDelta) { bytesRead += bytesDelta; })), //throw FileError, ErrorFileLocked
         defaultBlockSize_(stream_->getBlockSize()),
         dynamicBlockSize_(defaultBlockSize_) { assert(defaultBlockSize_ > 0); }
 
-    void appendChunk(std::vector<std::byte>& buffer) //throw FileError, X
+    void appendChunk(std::vector<std::byte>& buffer) //throw FileError, ErrorFileLocked
     {
         assert(!eof_);
         if (eof_) return;
@@ -52,7 +71,7 @@ struct StreamReader
         buffer.resize(buffer.size() + dynamicBlockSize_);
 
         const auto startTime = std::chrono::steady_clock::now();
-        const size_t bytesRead = stream_->read(&*(buffer.end() - dynamicBlockSize_), dynamicBlockSize_); //throw FileError, ErrorFileLocked, X; return "bytesToRead" bytes unless end of stream!
+        const size_t bytesRead = stream_->read(&*(buffer.end() - dynamicBlockSize_), dynamicBlockSize_); //throw FileError, ErrorFileLocked, (X); return "bytesToRead" bytes unless end of stream!
         const auto stopTime = std::chrono::steady_clock::now();
 
         buffer.resize(buffer.size() - dynamicBlockSize_ + bytesRead); //caveat: unsigned arithmetics
@@ -84,57 +103,518 @@ struct StreamReader
 
     bool isEof() const { return eof_; }
 
+    bool supportsReadAt() const { return stream_->supportsReadAt(); }
+
+    std::optional<uint64_t> getFileSizeBuffered() //throw FileError
+    {
+        if (const std::optional<AFS::StreamAttributes> attr = stream_->getAttributesBuffered()) //throw FileError
+            return attr->fileSize;
+        return {};
+    }
+
+    //context of calling thread: notifyUnbufferedIO for bytes read since last call
+    void reportBytesRead(const IoCallback& notifyUnbufferedIO /*throw X*/) //throw X
+    {
+        const int64_t bytesReadTotal = bytesRead_;
+        if (notifyUnbufferedIO && bytesReadTotal != bytesReported_)
+            notifyUnbufferedIO(bytesReadTotal - bytesReported_); //throw X
+        bytesReported_ = bytesReadTotal;
+    }
+
 private:
+    StreamReader           (const StreamReader&) = delete;
+    StreamReader& operator=(const StreamReader&) = delete;
+
+    std::atomic<int64_t> bytesRead_{0}; //updated by prefetch thread; std:atomic is uninitialized by default!
+    int64_t bytesReported_ = 0;
+
     const std::unique_ptr<AFS::InputStream> stream_;
     const size_t defaultBlockSize_;
     size_t dynamicBlockSize_;
     std::chrono::steady_clock::time_point lastDelayViolation_ = std::chrono::steady_clock::now();
     bool eof_ = false;
 };
-}
 
 
-bool fff::filesHaveSameContent(const AbstractPath& filePath1, const AbstractPath& filePath2, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+/* read ahead on a worker thread: while the caller compares block n, both devices are already busy reading block n+1
+    => two block buffers per side: one being filled by the prefetch thread, one buffered in AsyncStreamBuffer   */
+class PrefetchReader
 {
-    int64_t totalUnbufferedIO = 0;
+public:
+    PrefetchReader(StreamReader& reader, const AbstractPath& filePath) : reader_(reader)
+    {
+        worker_ = InterruptibleThread([&reader, asyncStreamOut = asyncStreamIn_, displayPath = AFS::getDisplayPath(filePath)]
+        {
+            setCurrentThreadName(Zstr("Prefetch ") + utfTo<Zstring>(displayPath));
+            const ScheduleThreadForBackground backgroundPrio(BackgroundWork::compute);
+            try
+            {
+                std::vector<std::byte> buffer;
+                while (!reader.isEof())
+                {
+                    buffer.clear();
+                    reader.appendChunk(buffer); //throw FileError, ErrorFileLocked
+                    if (!buffer.empty())
+                        asyncStreamOut->write(&buffer[0], buffer.size()); //throw ThreadStopRequest
+                }
+                asyncStreamOut->closeStream();
+            }
+            catch (FileError&) { asyncStreamOut->setWriteError(std::current_exception()); } //let ThreadStopRequest pass through!
+        });
+    }
 
-    StreamReader reader1(filePath1, IOCallbackDivider(notifyUnbufferedIO, totalUnbufferedIO)); //throw FileError
-    StreamReader reader2(filePath2, IOCallbackDivider(notifyUnbufferedIO, totalUnbufferedIO)); //
+    ~PrefetchReader()
+    {
+        asyncStreamIn_->setReadError(std::make_exception_ptr(ThreadStopRequest())); //unblock worker (if needed) before joining
+    }
+
+    //return "bytesToRead" bytes unless end of stream!
+    size_t read(void* buffer, size_t bytesToRead) { return asyncStreamIn_->read(buffer, bytesToRead); } //throw FileError, ErrorFileLocked
+
+    void reportBytesRead(const IoCallback& notifyUnbufferedIO /*throw X*/) { reader_.reportBytesRead(notifyUnbufferedIO); } //throw X
+
+private:
+    StreamReader& reader_; //accessed by worker thread only (except for atomic byte count)
+    std::shared_ptr<AsyncStreamBuffer> asyncStreamIn_ = std::make_shared<AsyncStreamBuffer>(BLOCK_SIZE_MAX);
+    InterruptibleThread worker_;
+};
+
+
+//hasher: optional; fed with the bytes found equal (in stream order)
+//equalPrefix: bytes compared equal so far
+bool haveSameContentPrefetched(PrefetchReader& reader1, PrefetchReader& reader2, Sha256Hasher* hasher, uint64_t& equalPrefix, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, ErrorFileLocked, SysError, X
+{
+    std::vector<std::byte> buffer1(BLOCK_SIZE_COMPARE);
+    std::vector<std::byte> buffer2(BLOCK_SIZE_COMPARE);
+    for (;;)
+    {
+        const size_t bytesRead1 = reader1.read(&buffer1[0], buffer1.size()); //throw FileError, ErrorFileLocked
+        const size_t bytesRead2 = reader2.read(&buffer2[0], buffer2.size()); //
+
+        reader1.reportBytesRead(notifyUnbufferedIO); //throw X
+        reader2.reportBytesRead(notifyUnbufferedIO); //
+
+        if (bytesRead1 != bytesRead2)
+            return false;
 
+        if (!equalBytes(&buffer1[0], &buffer2[0], bytesRead1))
+            return false;
+        equalPrefix += bytesRead1;
+
+        if (hasher)
+            hasher->update(&buffer1[0], bytesRead1); //throw SysError
+
+        if (bytesRead1 < buffer1.size()) //end of stream for both
+            return true;
+    }
+}
+
+
+bool haveSameContentSequential(StreamReader& reader1, StreamReader& reader2, Sha256Hasher* hasher, uint64_t& equalPrefix, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, ErrorFileLocked, SysError, X
+{
     StreamReader* readerLow  = &reader1;
     StreamReader* readerHigh = &reader2;
 
     std::vector<std::byte> bufferLow;
     std::vector<std::byte> bufferHigh;
+    size_t posHigh = 0; //bufferHigh[0, posHigh) was already compared: avoid erase-from-front (memmove) on each round
 
     for (;;)
     {
-        readerLow->appendChunk(bufferLow); //throw FileError, X
+        readerLow->appendChunk(bufferLow); //throw FileError, ErrorFileLocked
+        readerLow->reportBytesRead(notifyUnbufferedIO); //throw X
 
-        if (bufferLow.size() > bufferHigh.size())
+        if (bufferLow.size() > bufferHigh.size() - posHigh)
         {
+            //compact only when changing roles: bufferHigh becomes bufferLow and will be appended to
+            bufferHigh.erase(bufferHigh.begin(), bufferHigh.begin() + posHigh);
+            posHigh = 0;
+
             bufferLow.swap(bufferHigh);
             std::swap(readerLow, readerHigh);
         }
 
-        if (!std::equal(bufferLow. begin(), bufferLow.end(),
-                        bufferHigh.begin()))
+        if (!equalBytes(bufferLow.data(), bufferHigh.data() + posHigh, bufferLow.size()))
             return false;
+        equalPrefix += bufferLow.size();
+
+        if (hasher && !bufferLow.empty()) //bufferLow is compared exactly once and in stream order
+            hasher->update(bufferLow.data(), bufferLow.size()); //throw SysError
 
         if (readerLow->isEof())
         {
-            if (bufferLow.size() < bufferHigh.size())
+            if (bufferLow.size() < bufferHigh.size() - posHigh)
                 return false;
             if (readerHigh->isEof())
-                break;
+                return true;
             //bufferLow.swap(bufferHigh); not needed
             std::swap(readerLow, readerHigh);
         }
 
-        //don't let sliding buffer grow too large
-        bufferHigh.erase(bufferHigh.begin(), bufferHigh.begin() + bufferLow.size());
+        posHigh += bufferLow.size();
         bufferLow.clear();
+
+        if (posHigh == bufferHigh.size()) //fully compared => cheap reset
+        {
+            bufferHigh.clear();
+            posHigh = 0;
+        }
+    }
+}
+}
+
+
+namespace
+{
+//read "bytesToRead" bytes unless end of stream
+size_t readAtFully(AFS::InputStream& stream, uint64_t offset, void* buffer, size_t bytesToRead) //throw FileError, ErrorFileLocked, X
+{
+    size_t bytesRead = 0;
+    while (bytesRead < bytesToRead)
+    {
+        const size_t bytesReadNew = stream.readAt(offset + bytesRead, static_cast<std::byte*>(buffer) + bytesRead, bytesToRead - bytesRead); //throw FileError, ErrorFileLocked, X
+        if (bytesReadNew == 0) //EOF: file was truncated meanwhile?
+            break;
+        bytesRead += bytesReadNew;
+    }
+    return bytesRead;
+}
+
+
+/* compare [offset, offset + length) of both files on each worker thread using positional reads (AFS::InputStream::readAt())
+    => stop all workers as soon as one range differs or fails
+    last range: read until end of file (in case files grew since scanning)                 */
+bool haveSameContentRangeParallel(const AbstractPath& filePath1, const AbstractPath& filePath2, uint64_t fileSize, size_t rangeCount, //throw FileError, X
+                                  const IoCallback& notifyUnbufferedIO /*throw X*/)
+{
+    assert(rangeCount >= 2);
+    struct SharedStatus
+    {
+        std::atomic<int64_t> bytesRead{0};        //std:atomic is uninitialized by default!
+        std::atomic<bool> stopComparison{false}; //
+
+        std::mutex lockDone;
+        std::condition_variable conditionRangeDone;
+        size_t rangesDone = 0;
+        bool differenceFound = false;
+        std::exception_ptr firstError;
+    };
+    const auto status = std::make_shared<SharedStatus>();
+
+    std::vector<InterruptibleThread> workers;
+    const uint64_t rangeSize = fileSize / rangeCount;
+
+    for (size_t i = 0; i < rangeCount; ++i)
+        workers.emplace_back([status, filePath1, filePath2, i,
+                                      rangeBegin = rangeSize * i,
+                                      rangeEnd   = i + 1 == rangeCount ? std::numeric_limits<uint64_t>::max() : rangeSize * (i + 1)]
+    {
+        setCurrentThreadName(Zstr("Compare range ") + numberTo<Zstring>(i + 1));
+        const ScheduleThreadForBackground backgroundPrio(BackgroundWork::compute);
+
+        bool rangeDiffers = false;
+        std::exception_ptr error;
+        try
+        {
+            //notifyUnbufferedIO may throw X => must not be called from worker thread => just count bytes
+            const IoCallback countBytes = [&bytesRead = status->bytesRead](int64_t bytesDelta) { bytesRead += bytesDelta; };
+            const std::unique_ptr<AFS::InputStream> stream1 = AFS::getInputStream(filePath1, countBytes); //throw FileError, ErrorFileLocked
+            const std::unique_ptr<AFS::InputStream> stream2 = AFS::getInputStream(filePath2, countBytes); //
+
+            std::vector<std::byte> buffer1(BLOCK_SIZE_COMPARE);
+            std::vector<std::byte> buffer2(BLOCK_SIZE_COMPARE);
+
+            for (uint64_t offset = rangeBegin; offset < rangeEnd && !status->stopComparison; offset += BLOCK_SIZE_COMPARE)
+            {
+                interruptionPoint(); //throw ThreadStopRequest
+
+                const size_t bytesToRead = static_cast<size_t>(std::min<uint64_t>(BLOCK_SIZE_COMPARE, rangeEnd - offset));
+                const size_t bytesRead1 = readAtFully(*stream1, offset, &buffer1[0], bytesToRead); //throw FileError, ErrorFileLocked
+                const size_t bytesRead2 = readAtFully(*stream2, offset, &buffer2[0], bytesToRead); //
+
+                if (bytesRead1 != bytesRead2 ||
+                    !equalBytes(&buffer1[0], &buffer2[0], bytesRead1))
+                {
+                    rangeDiffers = true;
+                    break;
+                }
+                if (bytesRead1 < bytesToRead) //end of file for both
+                    break;
+            }
+        }
+        catch (const FileError&) { error = std::current_exception(); } //let ThreadStopRequest pass through!
+
+        std::lock_guard dummy(status->lockDone);
+        ++status->rangesDone;
+        if (rangeDiffers || error)
+        {
+            status->stopComparison = true;
+            status->differenceFound |= rangeDiffers;
+            if (error && !status->firstError)
+                status->firstError = error;
+        }
+        status->conditionRangeDone.notify_all();
+    });
+
+    //notifyUnbufferedIO may throw X => call on this thread only; on X: ~InterruptibleThread() stops and joins all workers
+    int64_t bytesReported = 0;
+    for (;;)
+    {
+        bool allDone = false;
+        {
+            std::unique_lock dummy(status->lockDone);
+            allDone = status->conditionRangeDone.wait_for(dummy, std::chrono::milliseconds(50), [&] { return status->rangesDone == rangeCount; });
+        }
+        const int64_t bytesReadTotal = status->bytesRead;
+        if (notifyUnbufferedIO && bytesReadTotal != bytesReported)
+            notifyUnbufferedIO(bytesReadTotal - bytesReported); //throw X
+        bytesReported = bytesReadTotal;
+
+        if (allDone)
+            break;
+    }
+
+    if (status->firstError && !status->differenceFound)
+        std::rethrow_exception(status->firstError); //throw FileError
+    return !status->differenceFound;
+}
+}
+
+
+ContentHash fff::toContentHash(const std::string& sha256)
+{
+    //truncate SHA-256 to 128 bit
+    static_assert(sizeof(ContentHash) <= 32);
+    assert(sha256.size() == 32);
+    ContentHash hash{};
+    std::memcpy(hash.data(), sha256.c_str(), std::min(hash.size(), sha256.size()));
+    return hash;
+}
+
+
+namespace
+{
+//read file end to end, feeding the requested hashers
+AFS::FileDigest calcFileDigest(const AbstractPath& filePath, bool calcMd5, bool calcSha256, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+{
+    StreamReader reader(filePath); //throw FileError, ErrorFileLocked
+
+    const std::optional<uint64_t> fileSize = reader.getFileSizeBuffered(); //throw FileError
+    try
+    {
+        std::optional<Md5Hasher> md5Hasher;
+        std::optional<Sha256Hasher> sha256Hasher;
+        if (calcMd5)
+            md5Hasher.emplace(); //throw SysError
+        if (calcSha256)
+            sha256Hasher.emplace(); //throw SysError
+
+        auto updateHashers = [&](const void* buffer, size_t bytesRead)
+        {
+            if (md5Hasher)
+                md5Hasher->update(buffer, bytesRead); //throw SysError
+            if (sha256Hasher)
+                sha256Hasher->update(buffer, bytesRead); //throw SysError
+        };
+
+        if (fileSize && *fileSize < PREFETCH_MIN_FILE_SIZE)
+        {
+            std::vector<std::byte> buffer;
+            while (!reader.isEof())
+            {
+                buffer.clear();
+                reader.appendChunk(buffer); //throw FileError, ErrorFileLocked
+                reader.reportBytesRead(notifyUnbufferedIO); //throw X
+                if (!buffer.empty())
+                    updateHashers(buffer.data(), buffer.size()); //throw SysError
+            }
+        }
+        else
+        {
+            PrefetchReader prefetch(reader, filePath); //hash block n while block n+1 is read
+
+            std::vector<std::byte> buffer(BLOCK_SIZE_COMPARE);
+            for (;;)
+            {
+                const size_t bytesRead = prefetch.read(&buffer[0], buffer.size()); //throw FileError, ErrorFileLocked
+                prefetch.reportBytesRead(notifyUnbufferedIO); //throw X
+
+                updateHashers(&buffer[0], bytesRead); //throw SysError
+                if (bytesRead < buffer.size()) //end of stream
+                    break;
+            }
+        }    //=> prefetch thread is joined: all bytes read are accounted for
+        reader.reportBytesRead(notifyUnbufferedIO); //throw X
+
+        AFS::FileDigest digest;
+        if (md5Hasher)
+            digest.md5 = md5Hasher->finalize(); //throw SysError
+        if (sha256Hasher)
+            digest.sha256 = sha256Hasher->finalize(); //throw SysError
+        return digest;
     }
+    catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(AFS::getDisplayPath(filePath))), e.toString()); }
+}
+}
+
+
+std::string fff::getFileSha256(const AbstractPath& filePath, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+{
+    return calcFileDigest(filePath, false /*calcMd5*/, true /*calcSha256*/, notifyUnbufferedIO).sha256; //throw FileError, X
+}
+
+
+std::optional<bool> fff::digestContentMatches(const AbstractPath& filePath1, const AbstractPath& filePath2, ContentHash* contentHash, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+{
+    const AFS::FileDigest digest1 = AFS::getServerFileDigest(filePath1); //throw FileError
+    const AFS::FileDigest digest2 = AFS::getServerFileDigest(filePath2); //
+
+    auto compareDigests = [contentHash](const AFS::FileDigest& lhs, const AFS::FileDigest& rhs) -> std::optional<bool>
+    {
+        const std::string& sha256 = !lhs.sha256.empty() ? lhs.sha256 : rhs.sha256;
+
+        if (!lhs.sha256.empty() && !rhs.sha256.empty())
+        {
+            if (lhs.sha256 != rhs.sha256)
+                return false;
+        }
+        else if (!lhs.md5.empty() && !rhs.md5.empty())
+        {
+            if (lhs.md5 != rhs.md5)
+                return false;
+        }
+        else
+            return std::nullopt;
+
+        if (contentHash && !sha256.empty())
+            *contentHash = toContentHash(sha256);
+        return true;
+    };
+
+    if (const std::optional<bool> rv = compareDigests(digest1, digest2))
+        return rv;
+
+    //server-side digest for one side only: read the other side end to end instead of both
+    auto readOtherSide = [&](const AFS::FileDigest& known, const AbstractPath& otherPath) -> std::optional<bool>
+    {
+        const bool needSha256 = !known.sha256.empty() || contentHash;
+        const bool needMd5    = known.sha256.empty() && !known.md5.empty();
+        if (!needMd5 && known.sha256.empty())
+            return std::nullopt;
+
+        return compareDigests(known, calcFileDigest(otherPath, needMd5, needSha256, notifyUnbufferedIO)); //throw FileError, X
+    };
+
+    if (!digest2.md5.empty() || !digest2.sha256.empty())
+        return readOtherSide(digest2, filePath1); //throw FileError, X
+    if (!digest1.md5.empty() || !digest1.sha256.empty())
+        return readOtherSide(digest1, filePath2); //throw FileError, X
+    return std::nullopt;
+}
+
+
+bool fff::sampledContentMatches(const AbstractPath& filePath1, const AbstractPath& filePath2, uint64_t fileSize) //throw FileError
+{
+    if (fileSize <= SAMPLE_BLOCK_SIZE * (SAMPLE_COUNT_INNER + 2)) //not worth it
+        return true;
+
+    //FTP/Google Drive: no download is started until first read
+    const std::unique_ptr<AFS::InputStream> stream1 = AFS::getInputStream(filePath1, nullptr /*notifyUnbufferedIO*/); //throw FileError, (ErrorFileLocked)
+    const std::unique_ptr<AFS::InputStream> stream2 = AFS::getInputStream(filePath2, nullptr /*notifyUnbufferedIO*/); //
+    if (!stream1->supportsReadAt() || !stream2->supportsReadAt())
+        return true;
+
+    std::vector<std::byte> buffer1(SAMPLE_BLOCK_SIZE);
+    std::vector<std::byte> buffer2(SAMPLE_BLOCK_SIZE);
+
+    //most likely differences first: tail, head, then inner blocks
+    std::vector<uint64_t> sampleOffsets{fileSize - SAMPLE_BLOCK_SIZE, 0};
+    for (int i = 1; i <= SAMPLE_COUNT_INNER; ++i)
+        sampleOffsets.push_back((fileSize - SAMPLE_BLOCK_SIZE) / (SAMPLE_COUNT_INNER + 1) * i);
+
+    for (const uint64_t offset : sampleOffsets)
+    {
+        const size_t bytesRead1 = readAtFully(*stream1, offset, &buffer1[0], SAMPLE_BLOCK_SIZE); //throw FileError, (ErrorFileLocked)
+        const size_t bytesRead2 = readAtFully(*stream2, offset, &buffer2[0], SAMPLE_BLOCK_SIZE); //
+
+        if (bytesRead1 != bytesRead2 ||
+            !equalBytes(&buffer1[0], &buffer2[0], bytesRead1))
+            return false;
+    }
+    return true;
+}
+
+
+bool fff::filesHaveSameContent(const AbstractPath& filePath1, const AbstractPath& filePath2, size_t parallelOps, ContentHash* contentHash, uint64_t* equalPrefix, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+{
+    int64_t totalUnbufferedIO = 0;
+    const IoCallback notifyIoDivided = IOCallbackDivider(notifyUnbufferedIO, totalUnbufferedIO);
+
+    StreamReader reader1(filePath1); //throw FileError, ErrorFileLocked
+    StreamReader reader2(filePath2); //
+
+    //range-parallel comparison: SHA-256 cannot be split => huge files are not hashed (= not cached in sync.ffs_db)
+    if (parallelOps >= 2 && !contentHash &&
+        reader1.supportsReadAt() && reader2.supportsReadAt())
+    {
+        const std::optional<uint64_t> fileSize1 = reader1.getFileSizeBuffered(); //throw FileError
+        const std::optional<uint64_t> fileSize2 = reader2.getFileSizeBuffered(); //
+        if (fileSize1 && *fileSize1 >= RANGE_PARALLEL_MIN_FILE_SIZE &&
+            fileSize2 && *fileSize2 == *fileSize1)
+        {
+            const size_t rangeCount = static_cast<size_t>(std::min<uint64_t>(parallelOps, *fileSize1 / RANGE_SIZE_MIN));
+
+            if (!haveSameContentRangeParallel(filePath1, filePath2, *fileSize1, rangeCount, notifyIoDivided)) //throw FileError, X
+            {
+                if (equalPrefix) *equalPrefix = 0; //ranges are compared out of order: prefix unknown
+                return false;
+            }
+
+            if (totalUnbufferedIO % 2 != 0)
+                throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
+            return true;
+        }
+    }
+
+    const bool smallFiles = [&]
+    {
+        const std::optional<uint64_t> fileSize1 = reader1.getFileSizeBuffered(); //throw FileError
+        const std::optional<uint64_t> fileSize2 = reader2.getFileSizeBuffered(); //
+        return fileSize1 && *fileSize1 < PREFETCH_MIN_FILE_SIZE &&
+               fileSize2 && *fileSize2 < PREFETCH_MIN_FILE_SIZE;
+    }();
+
+    try
+    {
+        std::optional<Sha256Hasher> hasher;
+        if (contentHash)
+            hasher.emplace(); //throw SysError
+
+        bool sameContent = false;
+        uint64_t bytesEqual = 0;
+        if (smallFiles)
+            sameContent = haveSameContentSequential(reader1, reader2, hasher ? &*hasher : nullptr, bytesEqual, notifyIoDivided); //throw FileError, ErrorFileLocked, SysError, X
+        else
+        {
+            PrefetchReader prefetch1(reader1, filePath1);
+            PrefetchReader prefetch2(reader2, filePath2);
+
+            sameContent = haveSameContentPrefetched(prefetch1, prefetch2, hasher ? &*hasher : nullptr, bytesEqual, notifyIoDivided); //throw FileError, ErrorFileLocked, SysError, X
+        }    //=> prefetch threads are joined: all bytes read are accounted for
+
+        if (!sameContent)
+        {
+            if (equalPrefix) *equalPrefix = bytesEqual;
+            return false;
+        }
+
+        if (hasher) //same content => same hash for both files
+            *contentHash = toContentHash(hasher->finalize()); //throw SysError
+    }
+    catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(AFS::getDisplayPath(filePath1))), e.toString()); }
+
+    reader1.reportBytesRead(notifyIoDivided); //throw X
+    reader2.reportBytesRead(notifyIoDivided); //
 
     if (totalUnbufferedIO % 2 != 0)
         throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
@@ -7,14 +7,43 @@
 #ifndef BINARY_H_3941281398513241134
 #define BINARY_H_3941281398513241134
 
+#include <array>
 #include "../afs/abstract.h"
 
 
 namespace fff
 {
+//fingerprint of file content: SHA-256 truncated to 128 bit; all zero: not available
+using ContentHash = std::array<unsigned char, 16>;
+
+ContentHash toContentHash(const std::string& sha256); //32 raw bytes, e.g. AFS::FileCopyResult::contentHash
+
+
 bool filesHaveSameContent(const AbstractPath& filePath1, //throw FileError, X
                           const AbstractPath& filePath2,
+                          size_t parallelOps, //> 1: split huge files into ranges compared in parallel (requires AFS::InputStream::readAt(), no contentHash)
+                          ContentHash* contentHash, //optional: calculated while comparing; only set if content is equal
+                          uint64_t* equalPrefix,    //optional: only set if content differs: leading bytes found equal (block granularity)
                           const zen::IoCallback& notifyUnbufferedIO  /*throw X*/);
+
+//read file end to end: SHA-256 (32 raw bytes), e.g. to verify a copy against AFS::FileCopyResult::contentHash
+std::string getFileSha256(const AbstractPath& filePath, const zen::IoCallback& notifyUnbufferedIO /*throw X*/); //throw FileError, X
+
+/* use server-side checksums (AFS::getServerFileDigest()) instead of reading both files:
+    - both digests available: compare without reading any file content
+    - one digest available:   read only the other file (e.g. the local one) end to end
+    none: inconclusive => filesHaveSameContent() needed; contentHash: only set if content is equal and SHA-256 is known    */
+std::optional<bool> digestContentMatches(const AbstractPath& filePath1, //throw FileError, X
+                                         const AbstractPath& filePath2,
+                                         ContentHash* contentHash, //optional
+                                         const zen::IoCallback& notifyUnbufferedIO /*throw X*/);
+
+/* cheap pre-check before reading large files end to end: compare first, last and a few blocks in between
+    => files differing in header or tail (VM images, media files with changed metadata) are rejected early
+    false: content differs; true: inconclusive => filesHaveSameContent() needed
+    requires random access: devices without AFS::InputStream::readAt() are "inconclusive"    */
+bool sampledContentMatches(const AbstractPath& filePath1, //throw FileError
+                           const AbstractPath& filePath2, uint64_t fileSize);
 }
 
 #endif //BINARY_H_3941281398513241134
@@ -0,0 +1,132 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "change_journal.h"
+#include <set>
+#include <map>
+#include <zen/file_io.h>
+
+using namespace zen;
+using namespace fff;
+
+
+namespace
+{
+const char SECTION_GENERATION[] = "[Generation]"; //optional
+const char SECTION_FOLDERS[] = "[Folders]";
+const char SECTION_CHANGES[] = "[Changes]";
+
+const size_t COALESCE_CHILD_COUNT_MIN = 1000; //many changes within one folder: traversing the folder is cheaper than matching each item
+
+//one path per line => represent change of a path containing line breaks by the (changed) parent folder
+Zstring getLineSafePath(const Zstring& itemPath)
+{
+    if (!contains(itemPath, Zstr('\n')))
+        return itemPath;
+
+    return beforeLast(beforeFirst(itemPath, Zstr('\n'), IfNotFoundReturn::all), FILE_NAME_SEPARATOR, IfNotFoundReturn::none);
+}
+
+
+bool isWithinFolder(const Zstring& itemPath, const Zstring& folderPath)
+{
+    const Zstring folderPathSep = appendSeparator(folderPath);
+    return equalNativePath(appendSeparator(itemPath), folderPathSep) ||
+           (itemPath.size() > folderPathSep.size() && equalNativePath(Zstring(itemPath.begin(), itemPath.begin() + folderPathSep.size()), folderPathSep));
+}
+
+
+/*  keep the journal compact: (a changed folder is traversed completely during incremental comparison)
+    - drop items contained in a changed folder
+    - report the parent folder instead of its items if too many of them changed (but don't go beyond the monitored folders!) */
+std::vector<Zstring> coalesceChangedItems(const std::vector<Zstring>& changedItems, const std::vector<Zstring>& monitoredFolders)
+{
+    std::set<Zstring, LessNativePath> items;
+    for (const Zstring& itemPath : changedItems)
+        if (const Zstring& linePath = getLineSafePath(itemPath);
+            !linePath.empty())
+            items.insert(linePath);
+
+    std::map<Zstring, size_t, LessNativePath> childCount;
+    for (const Zstring& itemPath : items)
+        if (const Zstring& parentPath = beforeLast(itemPath, FILE_NAME_SEPARATOR, IfNotFoundReturn::none);
+            !parentPath.empty())
+            ++childCount[parentPath];
+
+    for (const auto& [folderPath, count] : childCount)
+        if (count >= COALESCE_CHILD_COUNT_MIN)
+            if (std::any_of(monitoredFolders.begin(), monitoredFolders.end(), [&](const Zstring& monFolderPath) { return isWithinFolder(folderPath, monFolderPath); }))
+                items.insert(folderPath);
+
+    std::vector<Zstring> output;
+    for (const Zstring& itemPath : items)
+    {
+        bool parentChanged = false;
+        for (Zstring parentPath = beforeLast(itemPath, FILE_NAME_SEPARATOR, IfNotFoundReturn::none);
+             !parentPath.empty() && !parentChanged;
+             parentPath = beforeLast(parentPath, FILE_NAME_SEPARATOR, IfNotFoundReturn::none))
+            parentChanged = items.contains(parentPath);
+
+        if (!parentChanged)
+            output.push_back(itemPath);
+    }
+    return output;
+}
+}
+
+
+void fff::saveChangeJournal(const ChangeJournal& journal, const Zstring& filePath) //throw FileError
+{
+    std::string byteStream;
+    if (!journal.generation.empty() && !contains(journal.generation, Zstr('\n')))
+    {
+        byteStream += SECTION_GENERATION;
+        byteStream += '\n';
+        byteStream += utfTo<std::string>(journal.generation) + '\n';
+    }
+    byteStream += SECTION_FOLDERS;
+    byteStream += '\n';
+    for (const Zstring& folderPath : journal.monitoredFolders)
+        if (!contains(folderPath, Zstr('\n'))) //=> not monitored as far as incremental comparison is concerned
+            byteStream += utfTo<std::string>(folderPath) + '\n';
+
+    byteStream += SECTION_CHANGES;
+    byteStream += '\n';
+    for (const Zstring& itemPath : coalesceChangedItems(journal.changedItems, journal.monitoredFolders))
+        byteStream += utfTo<std::string>(itemPath) + '\n';
+
+    setFileContent(filePath, byteStream, nullptr /*notifyUnbufferedIO*/); //throw FileError
+}
+
+
+ChangeJournal fff::loadChangeJournal(const Zstring& filePath) //throw FileError
+{
+    const std::string byteStream = getFileContent(filePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+
+    ChangeJournal journal;
+    std::vector<Zstring>* section = nullptr;
+    std::vector<Zstring> generation;
+
+    for (const std::string& line : split(byteStream, '\n', SplitOnEmpty::skip))
+        if (line == SECTION_GENERATION)
+            section = &generation;
+        else if (line == SECTION_FOLDERS)
+            section = &journal.monitoredFolders;
+        else if (line == SECTION_CHANGES)
+            section = &journal.changedItems;
+        else if (!section)
+            throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(filePath)), _("File content is corrupted.") + L" (invalid header)");
+        else
+            section->push_back(utfTo<Zstring>(line));
+
+    if (section != &journal.changedItems)
+        throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(filePath)), _("File content is corrupted.") + L" (changes missing)");
+
+    if (generation.size() == 1)
+        journal.generation = generation[0];
+
+    return journal;
+}
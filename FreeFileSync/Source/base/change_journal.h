@@ -0,0 +1,34 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef CHANGE_JOURNAL_H_4708230957102384756
+#define CHANGE_JOURNAL_H_4708230957102384756
+
+#include <vector>
+#include <zen/file_error.h>
+
+
+namespace fff
+{
+/*  changes seen by RealTimeSync since the last command execution => input for incremental comparison
+
+    - written by RealTimeSync, path is passed via %change_journal% environment variable: FreeFileSync.exe job.ffs_batch -ChangeJournal "%change_journal%"
+    - only folder pairs whose base folders are *both* monitored are compared incrementally;
+      devices tracking their own changes (Google Drive) count as monitored, see AFS::getChangesSinceCheckpoint()
+    - a changed base folder (e.g. temporarily unavailable) means "everything changed"
+    - a changed folder is traversed completely => saveChangeJournal() coalesces items into their folders where this is cheaper */
+struct ChangeJournal
+{
+    std::vector<Zstring> monitoredFolders; //native paths
+    std::vector<Zstring> changedItems;     //native paths: created, updated or deleted files, folders, symlinks
+    Zstring generation; //RealTimeSync persistent journal: state of the volumes when changedItems was complete; empty if unknown
+};
+
+void saveChangeJournal(const ChangeJournal& journal, const Zstring& filePath); //throw FileError
+ChangeJournal loadChangeJournal(const Zstring& filePath); //throw FileError
+}
+
+#endif //CHANGE_JOURNAL_H_4708230957102384756
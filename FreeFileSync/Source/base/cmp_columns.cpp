@@ -0,0 +1,96 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "cmp_columns.h"
+
+using namespace zen;
+using namespace fff;
+
+
+static_assert(FILE_CONFLICT          <= std::numeric_limits<unsigned char>::max());
+static_assert(SO_UNRESOLVED_CONFLICT <= std::numeric_limits<unsigned char>::max());
+
+
+void ComparisonColumns::clear()
+{
+    objIds_    .clear();
+    itemTypes_ .clear();
+    categories_.clear();
+    syncOps_   .clear();
+    flags_     .clear();
+    fileSizesL_.clear();
+    fileSizesR_.clear();
+    modTimesL_ .clear();
+    modTimesR_ .clear();
+}
+
+
+void ComparisonColumns::reserve(size_t rowCount)
+{
+    objIds_    .reserve(rowCount);
+    itemTypes_ .reserve(rowCount);
+    categories_.reserve(rowCount);
+    syncOps_   .reserve(rowCount);
+    flags_     .reserve(rowCount);
+    fileSizesL_.reserve(rowCount);
+    fileSizesR_.reserve(rowCount);
+    modTimesL_ .reserve(rowCount);
+    modTimesR_ .reserve(rowCount);
+}
+
+
+void ComparisonColumns::append(const FileSystemObject& fsObj)
+{
+    ItemType itemType = ItemType::folder;
+    uint64_t fileSizeL = 0;
+    uint64_t fileSizeR = 0;
+    time_t modTimeL = 0;
+    time_t modTimeR = 0;
+
+    visitFSObject(fsObj, [&](const FolderPair& folder) {},
+
+    [&](const FilePair& file)
+    {
+        itemType  = ItemType::file;
+        fileSizeL = file.getFileSize<SelectSide::left >();
+        fileSizeR = file.getFileSize<SelectSide::right>();
+        modTimeL  = file.getLastWriteTime<SelectSide::left >();
+        modTimeR  = file.getLastWriteTime<SelectSide::right>();
+    },
+
+    [&](const SymlinkPair& symlink)
+    {
+        itemType = ItemType::symlink;
+        modTimeL = symlink.getLastWriteTime<SelectSide::left >();
+        modTimeR = symlink.getLastWriteTime<SelectSide::right>();
+    });
+
+    objIds_    .push_back(fsObj.getId());
+    itemTypes_ .push_back(itemType);
+    categories_.push_back(static_cast<unsigned char>(fsObj.getCategory()));
+    syncOps_   .push_back(static_cast<unsigned char>(fsObj.getSyncOperation()));
+    flags_     .push_back((fsObj.isActive() ? FLAG_ACTIVE : 0) |
+                          (fsObj.isEmpty<SelectSide::left >() ? 0 : FLAG_EXISTS_LEFT) |
+                          (fsObj.isEmpty<SelectSide::right>() ? 0 : FLAG_EXISTS_RIGHT));
+    fileSizesL_.push_back(fileSizeL);
+    fileSizesR_.push_back(fileSizeR);
+    modTimesL_ .push_back(modTimeL);
+    modTimesR_ .push_back(modTimeR);
+}
+
+
+void ComparisonColumns::append(const ContainerObject& hierObj)
+{
+    for (const FilePair& file : hierObj.refSubFiles())
+        append(file);
+    for (const SymlinkPair& symlink : hierObj.refSubLinks())
+        append(symlink);
+    for (const FolderPair& folder : hierObj.refSubFolders())
+    {
+        append(static_cast<const FileSystemObject&>(folder));
+        append(static_cast<const ContainerObject&>(folder));
+    }
+}
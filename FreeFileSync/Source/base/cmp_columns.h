@@ -0,0 +1,66 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef CMP_COLUMNS_H_3840917238461023948712
+#define CMP_COLUMNS_H_3840917238461023948712
+
+#include "file_hierarchy.h"
+
+
+namespace fff
+{
+/*  struct-of-arrays snapshot of the comparison result: row i holds the i-th appended FileSystemObject
+
+    - aggregations over all rows (view filters, sync statistics) run as linear scans over a few packed columns
+      instead of chasing FilePair/FolderPair pointers and calling virtual getSyncOperation() per row
+    - snapshot only: rebuild after the comparison result, sync directions or active status changed!
+    - folders: file size and time columns are 0; symlinks: file size column is 0            */
+class ComparisonColumns
+{
+public:
+    enum class ItemType : unsigned char
+    {
+        folder,
+        file,
+        symlink,
+    };
+
+    void clear();
+    void reserve(size_t rowCount);
+
+    void append(const FileSystemObject& fsObj);
+    void append(const ContainerObject& hierObj); //recursively adds all sub-items: files, symlinks, folders (pre-order)
+
+    size_t size() const { return objIds_.size(); }
+
+    FileSystemObject::ObjectIdConst getObjectId(size_t row) const { return objIds_[row]; }
+    ItemType            getItemType     (size_t row) const { return itemTypes_[row]; }
+    CompareFileResult   getCategory     (size_t row) const { return static_cast<CompareFileResult>(categories_[row]); }
+    SyncOperation       getSyncOperation(size_t row) const { return static_cast<SyncOperation>(syncOps_[row]); }
+    bool                isActive        (size_t row) const { return flags_[row] & FLAG_ACTIVE; }
+
+    template <SelectSide side> bool     isEmpty         (size_t row) const { return !(flags_[row] & SelectParam<side>::ref(FLAG_EXISTS_LEFT, FLAG_EXISTS_RIGHT)); }
+    template <SelectSide side> uint64_t getFileSize     (size_t row) const { return SelectParam<side>::ref(fileSizesL_, fileSizesR_)[row]; }
+    template <SelectSide side> time_t   getLastWriteTime(size_t row) const { return SelectParam<side>::ref(modTimesL_, modTimesR_)[row]; }
+
+private:
+    static constexpr unsigned char FLAG_ACTIVE       = 0x1;
+    static constexpr unsigned char FLAG_EXISTS_LEFT  = 0x2;
+    static constexpr unsigned char FLAG_EXISTS_RIGHT = 0x4;
+
+    std::vector<FileSystemObject::ObjectIdConst> objIds_;
+    std::vector<ItemType>      itemTypes_;
+    std::vector<unsigned char> categories_; //CompareFileResult
+    std::vector<unsigned char> syncOps_;    //SyncOperation
+    std::vector<unsigned char> flags_;      //FLAG_*
+    std::vector<uint64_t> fileSizesL_;
+    std::vector<uint64_t> fileSizesR_;
+    std::vector<time_t> modTimesL_;
+    std::vector<time_t> modTimesR_;
+};
+}
+
+#endif //CMP_COLUMNS_H_3840917238461023948712
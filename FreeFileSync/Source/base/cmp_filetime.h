@@ -9,6 +9,7 @@
 
 #include <ctime>
 #include <algorithm>
+#include <type_traits>
 
 
 namespace fff
@@ -67,10 +68,18 @@ enum class TimeResult
 
 
 inline
-TimeResult compareFileTime(time_t lhs, time_t rhs, int tolerance, const std::vector<unsigned int>& ignoreTimeShiftMinutes)
+time_t getOneYearFromNow()
 {
     //number of seconds since Jan 1st 1970 + 1 year (needn't be too precise)
     static const time_t oneYearFromNow = std::time(nullptr) + 365 * 24 * 3600;
+    return oneYearFromNow;
+}
+
+
+inline
+TimeResult compareFileTime(time_t lhs, time_t rhs, int tolerance, const std::vector<unsigned int>& ignoreTimeShiftMinutes)
+{
+    const time_t oneYearFromNow = getOneYearFromNow();
 
     if (sameFileTime(lhs, rhs, tolerance, ignoreTimeShiftMinutes)) //last write time may differ by up to 2 seconds (NTFS vs FAT32)
         return TimeResult::equal;
@@ -88,6 +97,86 @@ TimeResult compareFileTime(time_t lhs, time_t rhs, int tolerance, const std::vec
     else
         return TimeResult::leftNewer;
 }
+
+//---------------------------------------------------------------------------------------------------------------
+/*  perf: categorizing millions of file pairs => evaluate the time comparison config once per folder pair, not per item
+    FileTimeCmp::anyTime:     unlimited tolerance => all times are equal
+    FileTimeCmp::noTimeShift: tolerance >= 0, no ignored time shifts (default config) => a single range check
+    FileTimeCmp::generic:     everything else       */
+enum class FileTimeCmp
+{
+    generic,
+    noTimeShift,
+    anyTime,
+};
+
+inline
+FileTimeCmp getFileTimeCmp(int tolerance, const std::vector<unsigned int>& ignoreTimeShiftMinutes)
+{
+    if (tolerance < 0)
+        return FileTimeCmp::anyTime;
+    if (ignoreTimeShiftMinutes.empty())
+        return FileTimeCmp::noTimeShift;
+    return FileTimeCmp::generic;
+}
+
+
+template <FileTimeCmp cmp> inline
+bool sameFileTime(time_t lhs, time_t rhs, int tolerance, const std::vector<unsigned int>& ignoreTimeShiftMinutes)
+{
+    if constexpr (cmp == FileTimeCmp::anyTime)
+        return true;
+    else if constexpr (cmp == FileTimeCmp::noTimeShift)
+    {
+        assert(tolerance >= 0 && ignoreTimeShiftMinutes.empty());
+        const time_t low  = std::min(lhs, rhs);
+        const time_t high = std::max(lhs, rhs);
+        return low > std::numeric_limits<time_t>::max() - tolerance || //protect against overflow!
+               high <= low + tolerance;
+    }
+    else
+        return sameFileTime(lhs, rhs, tolerance, ignoreTimeShiftMinutes);
+}
+
+
+template <FileTimeCmp cmp> inline
+TimeResult compareFileTime(time_t lhs, time_t rhs, int tolerance, const std::vector<unsigned int>& ignoreTimeShiftMinutes)
+{
+    if constexpr (cmp == FileTimeCmp::generic)
+        return compareFileTime(lhs, rhs, tolerance, ignoreTimeShiftMinutes);
+    else
+    {
+        if (sameFileTime<cmp>(lhs, rhs, tolerance, ignoreTimeShiftMinutes))
+            return TimeResult::equal;
+
+        const time_t oneYearFromNow = getOneYearFromNow(); //harmonize with compareFileTime() above!
+
+        if (lhs < 0 || lhs > oneYearFromNow)
+            return TimeResult::leftInvalid;
+
+        if (rhs < 0 || rhs > oneYearFromNow)
+            return TimeResult::rightInvalid;
+
+        return lhs < rhs ? TimeResult::rightNewer : TimeResult::leftNewer;
+    }
+}
+
+
+//fun(std::integral_constant<FileTimeCmp, cmp>): instantiate the item loop for each configuration
+template <class Function> inline
+decltype(auto) dispatchFileTimeCmp(FileTimeCmp cmp, Function fun)
+{
+    switch (cmp)
+    {
+        case FileTimeCmp::anyTime:
+            return fun(std::integral_constant<FileTimeCmp, FileTimeCmp::anyTime>());
+        case FileTimeCmp::noTimeShift:
+            return fun(std::integral_constant<FileTimeCmp, FileTimeCmp::noTimeShift>());
+        case FileTimeCmp::generic:
+            break;
+    }
+    return fun(std::integral_constant<FileTimeCmp, FileTimeCmp::generic>());
+}
 }
 
 #endif //CMP_FILETIME_H_032180451675845
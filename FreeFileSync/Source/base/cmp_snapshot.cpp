@@ -0,0 +1,392 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "cmp_snapshot.h"
+#include <unordered_map>
+#include <zen/crc.h>
+#include <zen/file_access.h>
+#include <zen/file_io.h>
+#include <zen/zlib_wrap.h>
+#include "../afs/concrete.h"
+
+using namespace zen;
+using namespace fff;
+
+
+namespace
+{
+const char SNAPSHOT_FILE_DESCR[] = "FreeFileSync";
+const int SNAPSHOT_FILE_VERSION = 1; //2026-10-14
+
+/*  file format:  header | zlib-compressed tree stream | CRC32
+    tree stream:  per base folder: settings + items, recursively: files, symlinks, folders (= visitSubTree() order)
+                  move pairs: partner referenced by its position in visitSubTree() order (one-based, 0 if none)      */
+
+using FileIndexes = std::unordered_map<const FileSystemObject*, uint32_t>;
+
+
+void writeUtf8(MemoryStreamOut<std::string>& streamOut, const Zstring& itemName) { writeContainer(streamOut, utfTo<std::string>(itemName)); }
+Zstring readUtf8(MemoryStreamIn<std::string_view>& streamIn) { return utfTo<Zstring>(readContainer<std::string>(streamIn)); } //throw SysErrorUnexpectedEos
+
+
+void writeFsObject(MemoryStreamOut<std::string>& streamOut, const FileSystemObject& fsObj)
+{
+    writeUtf8(streamOut, fsObj.isEmpty<SelectSide::left >() ? Zstring() : fsObj.getItemName<SelectSide::left >()); //getItemName(): returns other side's
+    writeUtf8(streamOut, fsObj.isEmpty<SelectSide::right>() ? Zstring() : fsObj.getItemName<SelectSide::right>()); //name if not existing
+
+    writeNumber<int8_t>(streamOut, static_cast<int8_t>(fsObj.getCategory()));
+    if (fsObj.getCategory() == FILE_CONFLICT ||
+        fsObj.getCategory() == FILE_DIFFERENT_METADATA)
+        writeContainer(streamOut, fsObj.getCatExtraDescription());
+
+    writeNumber<int8_t>(streamOut, static_cast<int8_t>(fsObj.getSyncDir()));
+    writeContainer     (streamOut, fsObj.getSyncDirConflict());
+    writeNumber<int8_t>(streamOut, fsObj.isActive());
+}
+
+
+void writeFileAttributes(MemoryStreamOut<std::string>& streamOut, const FileAttributes& attr)
+{
+    writeNumber<int64_t >(streamOut, attr.modTime);
+    writeNumber<uint64_t>(streamOut, attr.fileSize);
+    writeNumber<AFS::FingerPrint>(streamOut, attr.filePrint);
+    writeNumber<int8_t  >(streamOut, attr.isFollowedSymlink);
+    writeNumber<uint32_t>(streamOut, attr.linkCount);
+}
+
+
+void writeContainerObject(MemoryStreamOut<std::string>& streamOut, const ContainerObject& conObj, const FileIndexes& fileIndexes)
+{
+    writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(conObj.refSubFiles().size()));
+    for (const FilePair& file : conObj.refSubFiles())
+    {
+        writeFsObject(streamOut, file);
+        writeFileAttributes(streamOut, file.getAttributes<SelectSide::left >());
+        writeFileAttributes(streamOut, file.getAttributes<SelectSide::right>());
+        writeArray(streamOut, file.getContentHash<SelectSide::left >().data(), sizeof(ContentHash));
+        writeArray(streamOut, file.getContentHash<SelectSide::right>().data(), sizeof(ContentHash));
+        writeNumber<uint64_t>(streamOut, file.getEqualPrefix());
+
+        uint32_t moveRefPos = 0;
+        if (const FileSystemObject* refFile = FileSystemObject::retrieve(file.getMoveRef()))
+            if (auto it = fileIndexes.find(refFile);
+                it != fileIndexes.end())
+                moveRefPos = it->second + 1;
+        writeNumber<uint32_t>(streamOut, moveRefPos);
+    }
+
+    writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(conObj.refSubLinks().size()));
+    for (const SymlinkPair& symlink : conObj.refSubLinks())
+    {
+        writeFsObject(streamOut, symlink);
+        writeNumber<int64_t>(streamOut, symlink.getLastWriteTime<SelectSide::left >());
+        writeNumber<int64_t>(streamOut, symlink.getLastWriteTime<SelectSide::right>());
+    }
+
+    writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(conObj.refSubFolders().size()));
+    for (const FolderPair& folder : conObj.refSubFolders())
+    {
+        writeFsObject(streamOut, folder);
+        writeNumber<int8_t>(streamOut, folder.isFollowedSymlink<SelectSide::left >());
+        writeNumber<int8_t>(streamOut, folder.isFollowedSymlink<SelectSide::right>());
+
+        writeContainerObject(streamOut, folder, fileIndexes); //recurse
+    }
+}
+
+
+void writeBaseFolder(MemoryStreamOut<std::string>& streamOut, const BaseFolderPair& baseFolder)
+{
+    writeUtf8(streamOut, AFS::getInitPathPhrase(baseFolder.getAbstractPath<SelectSide::left >()));
+    writeUtf8(streamOut, AFS::getInitPathPhrase(baseFolder.getAbstractPath<SelectSide::right>()));
+    writeNumber<int8_t>(streamOut, static_cast<int8_t>(baseFolder.getFolderStatus<SelectSide::left >()));
+    writeNumber<int8_t>(streamOut, static_cast<int8_t>(baseFolder.getFolderStatus<SelectSide::right>()));
+
+    writeNumber<int8_t >(streamOut, static_cast<int8_t>(baseFolder.getCompVariant()));
+    writeNumber<int32_t>(streamOut, baseFolder.getFileTimeTolerance());
+    writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(baseFolder.getIgnoredTimeShift().size()));
+    for (const unsigned int minutes : baseFolder.getIgnoredTimeShift())
+        writeNumber<uint32_t>(streamOut, minutes);
+
+    FileIndexes fileIndexes;
+    visitSubTree(baseFolder,
+    [](const FolderPair&) {},
+    [&](const FilePair& file) { fileIndexes.emplace(&file, static_cast<uint32_t>(fileIndexes.size())); },
+    [](const SymlinkPair&) {});
+
+    writeContainerObject(streamOut, baseFolder, fileIndexes);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------
+
+class SnapshotParser
+{
+public:
+    static std::optional<FolderComparison> execute(MemoryStreamIn<std::string_view>& streamIn, const std::vector<FolderPairCfg>& fpCfgList) //throw SysError
+    {
+        if (readNumber<uint32_t>(streamIn) != fpCfgList.size()) //throw SysErrorUnexpectedEos
+            return std::nullopt; //folder pairs added or removed
+
+        FolderComparison output;
+        for (const FolderPairCfg& fpCfg : fpCfgList)
+        {
+            const AbstractPath folderPathL = createAbstractPath(fpCfg.folderPathPhraseLeft_);
+            const AbstractPath folderPathR = createAbstractPath(fpCfg.folderPathPhraseRight_);
+
+            const Zstring initPathL = readUtf8(streamIn); //throw SysErrorUnexpectedEos
+            const Zstring initPathR = readUtf8(streamIn); //
+            const BaseFolderStatus folderStatusL = readEnum<BaseFolderStatus>(streamIn, BaseFolderStatus::failure); //throw SysError
+            const BaseFolderStatus folderStatusR = readEnum<BaseFolderStatus>(streamIn, BaseFolderStatus::failure); //
+
+            const CompareVariant cmpVar = readEnum<CompareVariant>(streamIn, CompareVariant::size); //throw SysError
+            const int fileTimeTolerance = readNumber<int32_t>(streamIn); //throw SysErrorUnexpectedEos
+            std::vector<unsigned int> ignoreTimeShiftMinutes(readNumber<uint32_t>(streamIn)); //
+            for (unsigned int& minutes : ignoreTimeShiftMinutes)
+                minutes = readNumber<uint32_t>(streamIn); //throw SysErrorUnexpectedEos
+
+            if (initPathL != AFS::getInitPathPhrase(folderPathL) ||
+                initPathR != AFS::getInitPathPhrase(folderPathR) ||
+                cmpVar != fpCfg.compareVar ||
+                ignoreTimeShiftMinutes != fpCfg.ignoreTimeShiftMinutes)
+                return std::nullopt; //configuration changed
+
+            std::shared_ptr<BaseFolderPair> baseFolder(new BaseFolderPair(folderPathL, folderStatusL,
+                                                                          folderPathR, folderStatusR,
+                                                                          fpCfg.filter.nameFilter,
+                                                                          cmpVar,
+                                                                          fileTimeTolerance,
+                                                                          ignoreTimeShiftMinutes),
+                                                       BaseFolderPair::destroyAsync);
+            {
+                //bulk update: skip bottom-up notification for each item
+                FileSystemObject::suspendSyncCfgNotify(true);
+                ZEN_ON_SCOPE_EXIT(FileSystemObject::suspendSyncCfgNotify(false));
+
+                SnapshotParser parser(streamIn);
+                parser.readContainerObject(*baseFolder); //throw SysError
+
+                for (const auto& [file, moveRefPos] : parser.moveRefs_)
+                {
+                    if (moveRefPos > parser.files_.size())
+                        throw SysError(_("File content is corrupted.") + L" (invalid move reference)");
+                    file->setMoveRef(parser.files_[moveRefPos - 1]->getId());
+                }
+            }
+            baseFolder->resetSyncCfgBufferedRec();
+
+            output.push_back(baseFolder);
+        }
+        return output;
+    }
+
+private:
+    explicit SnapshotParser(MemoryStreamIn<std::string_view>& streamIn) : streamIn_(streamIn) {}
+
+    template <class Enum>
+    static Enum readEnum(MemoryStreamIn<std::string_view>& streamIn, Enum maxVal) //throw SysError
+    {
+        const int8_t val = readNumber<int8_t>(streamIn); //throw SysErrorUnexpectedEos
+        if (val < 0 || val > static_cast<int8_t>(maxVal))
+            throw SysError(_("File content is corrupted.") + L" (invalid enum value)");
+        return static_cast<Enum>(val);
+    }
+
+    struct FsObjectData
+    {
+        Zstring itemNameL;
+        Zstring itemNameR;
+        CompareFileResult cmpResult = FILE_EQUAL;
+        Zstringc cmpResultDescr;
+        SyncDirection syncDir = SyncDirection::none;
+        Zstringc syncDirConflict;
+        bool active = true;
+    };
+
+    FsObjectData readFsObject() //throw SysError
+    {
+        FsObjectData data;
+        data.itemNameL = readUtf8(streamIn_); //throw SysErrorUnexpectedEos
+        data.itemNameR = readUtf8(streamIn_); //
+        if (data.itemNameL.empty() && data.itemNameR.empty())
+            throw SysError(_("File content is corrupted.") + L" (empty item name)");
+
+        data.cmpResult = readEnum<CompareFileResult>(streamIn_, FILE_CONFLICT); //throw SysError
+        if (data.cmpResult == FILE_CONFLICT ||
+            data.cmpResult == FILE_DIFFERENT_METADATA)
+            data.cmpResultDescr = readContainer<Zstringc>(streamIn_); //throw SysErrorUnexpectedEos
+
+        data.syncDir         = readEnum<SyncDirection>(streamIn_, SyncDirection::right); //throw SysError
+        data.syncDirConflict = readContainer<Zstringc>(streamIn_); //throw SysErrorUnexpectedEos
+        data.active          = readNumber<int8_t>(streamIn_) != 0; //
+        return data;
+    }
+
+    static void restoreFsObject(FileSystemObject& fsObj, const FsObjectData& data)
+    {
+        if (data.cmpResult == FILE_CONFLICT)
+            fsObj.setCategoryConflict(data.cmpResultDescr.empty() ? Zstringc("?") : data.cmpResultDescr);
+        else if (data.cmpResult == FILE_DIFFERENT_METADATA)
+            fsObj.setCategoryDiffMetadata(data.cmpResultDescr.empty() ? Zstringc("?") : data.cmpResultDescr);
+
+        if (!data.syncDirConflict.empty())
+            fsObj.setSyncDirConflict(data.syncDirConflict);
+        else
+            fsObj.setSyncDir(data.syncDir);
+
+        fsObj.setActive(data.active);
+    }
+
+    FileAttributes readFileAttributes() //throw SysErrorUnexpectedEos
+    {
+        FileAttributes attr;
+        attr.modTime           = readNumber<int64_t >(streamIn_);
+        attr.fileSize          = readNumber<uint64_t>(streamIn_);
+        attr.filePrint         = readNumber<AFS::FingerPrint>(streamIn_);
+        attr.isFollowedSymlink = readNumber<int8_t  >(streamIn_) != 0;
+        attr.linkCount         = readNumber<uint32_t>(streamIn_);
+        return attr;
+    }
+
+    void readContainerObject(ContainerObject& conObj) //throw SysError
+    {
+        size_t fileCount = readNumber<uint32_t>(streamIn_); //throw SysErrorUnexpectedEos
+        while (fileCount-- != 0)
+        {
+            const FsObjectData data = readFsObject(); //throw SysError
+            const FileAttributes attrL = readFileAttributes(); //throw SysErrorUnexpectedEos
+            const FileAttributes attrR = readFileAttributes(); //
+            ContentHash contentHashL{};
+            ContentHash contentHashR{};
+            readArray(streamIn_, contentHashL.data(), sizeof(ContentHash)); //throw SysErrorUnexpectedEos
+            readArray(streamIn_, contentHashR.data(), sizeof(ContentHash)); //
+            const uint64_t equalPrefix = readNumber<uint64_t>(streamIn_);    //
+            const uint32_t moveRefPos  = readNumber<uint32_t>(streamIn_);    //
+
+            FilePair& file = conObj.addSubFile(data.itemNameL, attrL, data.cmpResult, data.itemNameR, attrR);
+            restoreFsObject(file, data);
+            file.setContentHash(contentHashL, contentHashR);
+            file.setEqualPrefix(equalPrefix);
+
+            files_.push_back(&file);
+            if (moveRefPos != 0) //partner may not be created yet
+                moveRefs_.emplace_back(&file, moveRefPos);
+        }
+
+        size_t linkCount = readNumber<uint32_t>(streamIn_); //throw SysErrorUnexpectedEos
+        while (linkCount-- != 0)
+        {
+            const FsObjectData data = readFsObject(); //throw SysError
+            const LinkAttributes attrL(readNumber<int64_t>(streamIn_)); //throw SysErrorUnexpectedEos
+            const LinkAttributes attrR(readNumber<int64_t>(streamIn_)); //
+
+            restoreFsObject(conObj.addSubLink(data.itemNameL, attrL, static_cast<CompareSymlinkResult>(data.cmpResult), data.itemNameR, attrR), data);
+        }
+
+        size_t folderCount = readNumber<uint32_t>(streamIn_); //throw SysErrorUnexpectedEos
+        while (folderCount-- != 0)
+        {
+            const FsObjectData data = readFsObject(); //throw SysError
+            const FolderAttributes attrL(readNumber<int8_t>(streamIn_) != 0); //throw SysErrorUnexpectedEos
+            const FolderAttributes attrR(readNumber<int8_t>(streamIn_) != 0); //
+
+            FolderPair& folder = conObj.addSubFolder(data.itemNameL, attrL, static_cast<CompareDirResult>(data.cmpResult), data.itemNameR, attrR);
+            restoreFsObject(folder, data);
+
+            readContainerObject(folder); //recurse
+        }
+    }
+
+    MemoryStreamIn<std::string_view>& streamIn_;
+    std::vector<FilePair*> files_; //visitSubTree() order
+    std::vector<std::pair<FilePair*, uint32_t /*moveRefPos*/>> moveRefs_;
+};
+}
+
+
+Zstring fff::getComparisonSnapshotName(const std::vector<FolderPairCfg>& fpCfgList)
+{
+    std::string folderPairs;
+    for (const FolderPairCfg& fpCfg : fpCfgList)
+        folderPairs += utfTo<std::string>(fpCfg.folderPathPhraseLeft_ + Zstr('|') + fpCfg.folderPathPhraseRight_ + Zstr('\n'));
+
+    return Zstr("Comparison_") + printNumber<Zstring>(Zstr("%08x"), static_cast<unsigned int>(getCrc32(folderPairs))) + Zstr(".dat");
+}
+
+
+void fff::saveComparisonSnapshot(const FolderComparison& folderCmp, time_t compareTime, const Zstring& filePath) //throw FileError
+{
+    MemoryStreamOut<std::string> treeStreamOut;
+    writeNumber<uint32_t>(treeStreamOut, static_cast<uint32_t>(folderCmp.size()));
+    for (const std::shared_ptr<BaseFolderPair>& baseFolder : folderCmp)
+        writeBaseFolder(treeStreamOut, *baseFolder);
+
+    MemoryStreamOut<std::string> memStreamOut;
+    writeArray(memStreamOut, SNAPSHOT_FILE_DESCR, sizeof(SNAPSHOT_FILE_DESCR));
+    writeNumber<int32_t>(memStreamOut, SNAPSHOT_FILE_VERSION);
+    writeNumber<int64_t>(memStreamOut, compareTime);
+    try
+    {
+        writeContainer(memStreamOut, compress(treeStreamOut.ref(), 3 /*level*/)); //throw SysError
+    }
+    catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(filePath)), e.toString()); }
+
+    writeNumber<uint32_t>(memStreamOut, getCrc32(memStreamOut.ref()));
+
+    setFileContent(filePath, memStreamOut.ref(), nullptr /*notifyUnbufferedIO*/); //throw FileError
+}
+
+
+std::optional<ComparisonSnapshot> fff::loadComparisonSnapshot(const Zstring& filePath, const std::vector<FolderPairCfg>& fpCfgList) //throw FileError
+{
+    std::string byteStream;
+    try
+    {
+        byteStream = getFileContent(filePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+    }
+    catch (FileError&)
+    {
+        if (!itemStillExists(filePath)) //throw FileError
+            return std::nullopt;
+        throw;
+    }
+
+    try
+    {
+        MemoryStreamIn<std::string_view> memStreamIn(byteStream);
+
+        char formatDescr[sizeof(SNAPSHOT_FILE_DESCR)] = {};
+        readArray(memStreamIn, formatDescr, sizeof(formatDescr)); //throw SysErrorUnexpectedEos
+
+        if (!std::equal(SNAPSHOT_FILE_DESCR, SNAPSHOT_FILE_DESCR + sizeof(SNAPSHOT_FILE_DESCR), formatDescr))
+            throw SysError(_("File content is corrupted.") + L" (invalid header)");
+
+        const int version = readNumber<int32_t>(memStreamIn); //throw SysErrorUnexpectedEos
+        if (version != SNAPSHOT_FILE_VERSION)
+            return std::nullopt; //just a cache: compare again
+
+        MemoryStreamOut<std::string> crcStreamOut;
+        writeNumber<uint32_t>(crcStreamOut, getCrc32(byteStream.begin(), byteStream.end() - std::min(byteStream.size(), sizeof(uint32_t))));
+        if (!endsWith(byteStream, crcStreamOut.ref()))
+            throw SysError(_("File content is corrupted.") + L" (invalid checksum)");
+
+        ComparisonSnapshot snapshot;
+        snapshot.compareTime = readNumber<int64_t>(memStreamIn); //throw SysErrorUnexpectedEos
+
+        const std::string treeStream = decompress(readContainer<std::string>(memStreamIn)); //throw SysError, SysErrorUnexpectedEos
+        MemoryStreamIn<std::string_view> treeStreamIn(treeStream);
+
+        std::optional<FolderComparison> folderCmp = SnapshotParser::execute(treeStreamIn, fpCfgList); //throw SysError
+        if (!folderCmp)
+            return std::nullopt;
+
+        snapshot.folderCmp = std::move(*folderCmp);
+        return snapshot;
+    }
+    catch (const SysError& e)
+    {
+        throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(filePath)), e.toString());
+    }
+}
@@ -0,0 +1,35 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef CMP_SNAPSHOT_H_3857109238475610293
+#define CMP_SNAPSHOT_H_3857109238475610293
+
+#include <optional>
+#include "comparison.h"
+
+
+namespace fff
+{
+/*  comparison result persisted by the GUI: review a large comparison after restart (or crash) without comparing again
+    - tree, categories, sync directions and active flags; gone are only the items' object ids (=> e.g. grid selection)
+    - stale by definition: "Compare" for an up-to-date view (incremental, if changes are known, see prepareIncrementalComparison())
+    - only valid for the same folder pairs and comparison settings                                                                */
+struct ComparisonSnapshot
+{
+    time_t compareTime = 0; //when the folders were traversed
+    FolderComparison folderCmp;
+};
+
+//file name: identifies the folder pairs of a configuration
+Zstring getComparisonSnapshotName(const std::vector<FolderPairCfg>& fpCfgList);
+
+void saveComparisonSnapshot(const FolderComparison& folderCmp, time_t compareTime, const Zstring& filePath); //throw FileError
+
+//std::nullopt: no snapshot, or not matching fpCfgList (anymore)
+std::optional<ComparisonSnapshot> loadComparisonSnapshot(const Zstring& filePath, const std::vector<FolderPairCfg>& fpCfgList); //throw FileError
+}
+
+#endif //CMP_SNAPSHOT_H_3857109238475610293
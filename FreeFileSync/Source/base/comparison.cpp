@@ -10,12 +10,15 @@
 #include <zen/time.h>
 #include <wx/datetime.h>
 #include "algorithm.h"
+#include "bandwidth_limiter.h"
 #include "parallel_scan.h"
 #include "dir_exist_async.h"
 #include "db_file.h"
 #include "binary.h"
 #include "cmp_filetime.h"
+#include "speed_test.h"
 #include "status_handler_impl.h"
+#include "synchronization.h"
 #include "../afs/concrete.h"
 #include "../afs/native.h"
 
@@ -54,6 +57,15 @@ std::vector<FolderPairCfg> fff::extractCompareCfg(const MainConfiguration& mainC
     return output;
 }
 
+
+namespace
+{
+std::atomic<uint64_t> globalContentBandwidthLimit{0}; //bytes/sec; 0: unlimited
+}
+
+
+void fff::setContentBandwidthLimit(uint64_t bytesPerSec) { globalContentBandwidthLimit = bytesPerSec; }
+
 //------------------------------------------------------------------------------------------
 namespace
 {
@@ -96,7 +108,8 @@ ResolvedBaseFolders initializeBaseFolders(const std::vector<FolderPairCfg>& fpCf
         }
         //---------------------------------------------------------------------------
         output.baseFolderStatus = getFolderStatusNonBlocking(allFolders,
-                                                             allowUserInteraction, callback); //throw X
+                                                             allowUserInteraction, callback, true /*deferSlowChecks*/); //throw X
+        //checks still pending: resolved during ComparisonBuffer::bufferFolders() => failure is reported per folder pair
         if (!output.baseFolderStatus.failedChecks.empty())
         {
             std::wstring msg = _("Cannot find the following folders:") + L'\n';
@@ -150,20 +163,353 @@ ResolvedBaseFolders initializeBaseFolders(const std::vector<FolderPairCfg>& fpCf
     return output;
 }
 
+
+//memory accounting of scan results not yet merged: estimate is O(items) => only if metrics are requested
+int64_t getMemoryUsage(const DirectoryValue& folderVal)
+{
+    return metricsEnabled() ? static_cast<int64_t>(folderVal.folderCont.getMemoryUsage()) : 0;
+}
+
+//#############################################################################################################################
+/*  incremental comparison: traverse only the items reported by the change journal, take everything else from sync.ffs_db
+    - changed item:              traverse recursively (a folder may have been replaced entirely)
+    - parent folders of changes: traverse to find the changed items; all other child items are taken from the database
+    - Google Drive: changes since the checkpoint saved with the database take the place of the journal, see getDeviceChanges()
+    - limitation: items that were not in sync after the last synchronization and didn't change since are not found!  */
+class ChangedItems
+{
+public:
+    void add(const Zstring& relPath) //empty: base folder
+    {
+        changed_.insert(relPath);
+
+        for (Zstring parentPath = relPath; !parentPath.empty();)
+        {
+            parentPath = beforeLast(parentPath, FILE_NAME_SEPARATOR, IfNotFoundReturn::none);
+            if (!parents_.insert(parentPath).second)
+                break; //all further parents already known
+        }
+    }
+
+    bool isFullRescan() const { return changed_.contains(Zstring()); }
+
+    //item or one of its parent folders changed
+    bool isChanged(const Zstring& relPath) const
+    {
+        if (changed_.contains(relPath))
+            return true;
+
+        for (auto it = relPath.begin(); it != relPath.end(); ++it)
+            if (*it == FILE_NAME_SEPARATOR)
+                if (changed_.contains(Zstring(relPath.begin(), it)))
+                    return true;
+
+        return isFullRescan();
+    }
+
+    //folder contains changed items
+    bool isParentOfChanged(const Zstring& relFolderPath) const { return parents_.contains(relFolderPath); }
+
+    std::strong_ordering operator<=>(const ChangedItems& other) const { return changed_ <=> other.changed_; }
+    bool operator==(const ChangedItems& other) const { return changed_ == other.changed_; }
+
+private:
+    std::set<ZstringNoCase> changed_; //relative paths; ignore case: better rescan too much than too little
+    std::set<ZstringNoCase> parents_; //
+};
+
+
+class ChangedItemsFilter : public PathFilter //apply filter and traverse changed items only
+{
+public:
+    ChangedItemsFilter(const FilterRef& filter, const SharedRef<const ChangedItems>& changedItems) : filter_(filter), changedItems_(changedItems) {}
+
+    bool passFileFilter(const Zstring& relFilePath) const override
+    {
+        return changedItems_.ref().isChanged(relFilePath) && filter_.ref().passFileFilter(relFilePath);
+    }
+
+    bool passDirFilter(const Zstring& relDirPath, bool* childItemMightMatch) const override
+    {
+        if (changedItems_.ref().isChanged(relDirPath))
+            return filter_.ref().passDirFilter(relDirPath, childItemMightMatch);
+
+        if (changedItems_.ref().isParentOfChanged(relDirPath))
+            filter_.ref().passDirFilter(relDirPath, childItemMightMatch); //=> traverse unless excluded by user
+        else if (childItemMightMatch)
+            *childItemMightMatch = false;
+        return false;
+    }
+
+    bool passFileFilter(const Zstring& relFilePath, const FolderFilterState& parentState) const override
+    {
+        return changedItems_.ref().isChanged(relFilePath) && filter_.ref().passFileFilter(relFilePath, parentState);
+    }
+
+    bool passDirFilter(const Zstring& relDirPath, const FolderFilterState& parentState, bool& childItemMightMatch, FolderFilterState& dirState) const override
+    {
+        if (changedItems_.ref().isChanged(relDirPath))
+            return filter_.ref().passDirFilter(relDirPath, parentState, childItemMightMatch, dirState);
+
+        if (changedItems_.ref().isParentOfChanged(relDirPath))
+            filter_.ref().passDirFilter(relDirPath, parentState, childItemMightMatch, dirState); //=> traverse unless excluded by user
+        else
+            childItemMightMatch = false;
+        return false;
+    }
+
+    bool isNull() const override { return false; }
+
+    FilterRef copyFilterAddingExclusion(const Zstring& excludePhrase) const override
+    {
+        return makeSharedRef<ChangedItemsFilter>(filter_.ref().copyFilterAddingExclusion(excludePhrase), changedItems_);
+    }
+
+private:
+    std::strong_ordering compareSameType(const PathFilter& other) const override
+    {
+        assert(typeid(*this) == typeid(other));
+        const ChangedItemsFilter& rhs = static_cast<const ChangedItemsFilter&>(other);
+
+        if (const std::strong_ordering cmp = filter_ <=> rhs.filter_;
+            cmp != std::strong_ordering::equal)
+            return cmp;
+
+        return changedItems_.ref() <=> rhs.changedItems_.ref();
+    }
+
+    const FilterRef filter_;
+    const SharedRef<const ChangedItems> changedItems_;
+};
+
+
+struct IncrementalBaseFolder
+{
+    FilterRef traverseFilter; //ChangedItemsFilter
+    SharedRef<const ChangedItems> changedItems;
+    SharedRef<const InSyncFolder> lastSyncState;
+    SelectSide side;
+};
+
+
+//complete traversal result with items that didn't change since last sync
+template <SelectSide side>
+void addUnchangedItems(FolderContainer& folderCont, const InSyncFolder& dbFolder, const Zstring& relPath, //relPath: folder is not changed itself
+                       const ChangedItems& changedItems, const PathFilter& filter, SymLinkHandling handleSymlinks)
+{
+    for (const auto& [fileName, dbFile] : dbFolder.files)
+        if (const Zstring& fileRelPath = nativeAppendPaths(relPath, fileName);
+            !changedItems.isChanged(fileRelPath) && !changedItems.isParentOfChanged(fileRelPath) /*file replaced by folder*/ &&
+            filter.passFileFilter(fileRelPath))
+        {
+            const InSyncDescrFile& descr = SelectParam<side>::ref(dbFile.left, dbFile.right);
+            folderCont.addSubFile(fileName, FileAttributes(descr.modTime, dbFile.fileSize, descr.filePrint, false /*isFollowedSymlink*/));
+        }
+
+    if (handleSymlinks == SymLinkHandling::direct)
+        for (const auto& [linkName, dbLink] : dbFolder.symlinks)
+            if (const Zstring& linkRelPath = nativeAppendPaths(relPath, linkName);
+                !changedItems.isChanged(linkRelPath) && !changedItems.isParentOfChanged(linkRelPath) &&
+                filter.passFileFilter(linkRelPath))
+                folderCont.addSubLink(linkName, LinkAttributes(SelectParam<side>::ref(dbLink.left, dbLink.right).modTime));
+
+    for (const auto& [folderName, dbSubFolder] : dbFolder.folders)
+    {
+        const Zstring& folderRelPath = nativeAppendPaths(relPath, folderName);
+
+        if (changedItems.isChanged(folderRelPath))
+            continue; //traversed completely
+
+        if (changedItems.isParentOfChanged(folderRelPath)) //traversed, but only to find changed items
+        {
+            auto it = std::find_if(folderCont.folders.begin(), folderCont.folders.end(), [&](const auto& item) { return equalNoCase(item.first, folderName); });
+            if (it != folderCont.folders.end())
+                addUnchangedItems<side>(*it->second.second, dbSubFolder, folderRelPath, changedItems, filter, handleSymlinks);
+            //else: folder has been deleted or excluded via filter
+        }
+        else
+        {
+            if (dbSubFolder.status == InSyncFolder::DIR_STATUS_STRAW_MAN &&
+                dbSubFolder.files.empty() && dbSubFolder.symlinks.empty() && dbSubFolder.folders.empty())
+                continue; //no evidence the folder exists
+
+            bool childItemMightMatch = true;
+            if (filter.passDirFilter(folderRelPath, &childItemMightMatch) || childItemMightMatch)
+                addUnchangedItems<side>(folderCont.addSubFolder(folderName, FolderAttributes(false /*isFollowedSymlink*/)),
+                                        dbSubFolder, folderRelPath, changedItems, filter, handleSymlinks);
+        }
+    }
+}
+
+
+//relative path if itemPath is basePath or one of its sub items
+std::optional<Zstring> getRelativeNativePath(const Zstring& basePath, const Zstring& itemPath)
+{
+    const Zstring basePathSep = appendSeparator(basePath);
+
+    if (equalNativePath(appendSeparator(itemPath), basePathSep))
+        return Zstring();
+
+    if (itemPath.size() > basePathSep.size() && equalNativePath(Zstring(itemPath.begin(), itemPath.begin() + basePathSep.size()), basePathSep))
+        return Zstring(itemPath.begin() + basePathSep.size(), itemPath.end());
+
+    return std::nullopt;
+}
+
+
+//changes tracked by the device itself since the last synchronous state (e.g. Google Drive changes feed)
+struct DeviceChanges
+{
+    std::optional<std::vector<Zstring>> left;  //relative paths
+    std::optional<std::vector<Zstring>> right; //
+};
+
+//every comparison starts a new checkpoint: committed when saving the last synchronous state
+std::vector<DeviceChanges> getDeviceChanges(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad,
+                                            const FolderStatus& baseFolderStatus,
+                                            PhaseCallback& callback) //throw X
+{
+    std::vector<DeviceChanges> output;
+    for (const auto& [folderPair, fpCfg] : workLoad)
+    {
+        DeviceChanges& dc = output.emplace_back();
+
+        for (const auto& [folderPath, changes, side] :
+             {
+                 std::tuple(folderPair.folderPathLeft,  &dc.left,  SelectSide::left),
+                 std::tuple(folderPair.folderPathRight, &dc.right, SelectSide::right)
+             })
+            if (baseFolderStatus.existing.contains(folderPath))
+                try
+                {
+                    *changes = AFS::getChangesSinceCheckpoint(folderPath, getChangeCheckpointId(folderPair.folderPathLeft, folderPair.folderPathRight, side)); //throw FileError
+
+                    if (fpCfg.handleSymlinks == SymLinkHandling::follow) //changes are tracked by location, not via shortcuts
+                        changes->reset();
+                }
+                catch (const FileError& e) { callback.logInfo(e.toString()); } //throw X; not critical: full comparison
+    }
+    return output;
+}
+
+
+std::map<DirectoryKey, IncrementalBaseFolder> prepareIncrementalComparison(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad,
+                                                                           const FolderStatus& baseFolderStatus,
+                                                                           const ChangeJournal& journal,
+                                                                           const std::vector<DeviceChanges>& deviceChanges,
+                                                                           const std::map<AfsDevice, size_t>& deviceParallelOps,
+                                                                           PhaseCallback& callback) //throw X
+{
+    auto isMonitored = [&](const Zstring& folderPath)
+    {
+        return std::any_of(journal.monitoredFolders.begin(), journal.monitoredFolders.end(),
+        [&](const Zstring& monitoredPath) { return static_cast<bool>(getRelativeNativePath(monitoredPath, folderPath)); });
+    };
+
+    //last synchronous state is specific to a folder pair: can't share traversal with other pairs
+    std::map<DirectoryKey, int> keyUsage;
+    for (const auto& [folderPair, fpCfg] : workLoad)
+    {
+        ++keyUsage[{folderPair.folderPathLeft,  fpCfg.filter.nameFilter, fpCfg.handleSymlinks}];
+        ++keyUsage[{folderPair.folderPathRight, fpCfg.filter.nameFilter, fpCfg.handleSymlinks}];
+    }
+
+    //changes of *both* sides must be known: from the journal or from the device
+    auto changesKnown = [&](const AbstractPath& folderPath, const std::optional<std::vector<Zstring>>& changes)
+    {
+        const Zstring& nativePath = getNativeItemPath(folderPath);
+        return changes || (!nativePath.empty() && isMonitored(nativePath));
+    };
+
+    std::vector<std::tuple<ResolvedFolderPair, FolderPairCfg, DeviceChanges>> candidates;
+    std::vector<std::pair<AbstractPath, AbstractPath>> dbFolderPairs;
+
+    for (size_t i = 0; i < workLoad.size(); ++i)
+        if (const auto& [folderPair, fpCfg] = workLoad[i];
+            fpCfg.compareVar != CompareVariant::content && //untouched files would need content comparison, too
+            keyUsage[{folderPair.folderPathLeft,  fpCfg.filter.nameFilter, fpCfg.handleSymlinks}] == 1 &&
+            keyUsage[{folderPair.folderPathRight, fpCfg.filter.nameFilter, fpCfg.handleSymlinks}] == 1 &&
+            baseFolderStatus.existing.contains(folderPair.folderPathLeft) &&
+            baseFolderStatus.existing.contains(folderPair.folderPathRight) &&
+            changesKnown(folderPair.folderPathLeft,  deviceChanges[i].left) &&
+            changesKnown(folderPair.folderPathRight, deviceChanges[i].right))
+        {
+            candidates.emplace_back(folderPair, fpCfg, deviceChanges[i]);
+            dbFolderPairs.emplace_back(folderPair.folderPathLeft, folderPair.folderPathRight);
+        }
+
+    if (candidates.empty())
+        return {};
+
+    const std::map<std::pair<AbstractPath, AbstractPath>, SharedRef<const InSyncFolder>> lastSyncStates = loadLastSynchronousState(dbFolderPairs, deviceParallelOps, callback); //throw X
+
+    std::map<DirectoryKey, IncrementalBaseFolder> output;
+
+    for (const auto& [folderPair, fpCfg, devChanges] : candidates)
+        if (auto it = lastSyncStates.find({folderPair.folderPathLeft, folderPair.folderPathRight});
+            it != lastSyncStates.end()) //else: first sync => full comparison
+        {
+            auto changedItems = makeSharedRef<ChangedItems>();
+
+            for (const auto& [folderPath, changes] :
+                 {
+                     std::pair(folderPair.folderPathLeft,  &devChanges.left),
+                     std::pair(folderPair.folderPathRight, &devChanges.right)
+                 })
+                if (*changes)
+                    for (const Zstring& relPath : **changes)
+                        changedItems.ref().add(relPath);
+                else
+                {
+                    const Zstring& nativePath = getNativeItemPath(folderPath);
+                    for (const Zstring& itemPath : journal.changedItems)
+                        if (const std::optional<Zstring> relPath = getRelativeNativePath(nativePath, itemPath))
+                            changedItems.ref().add(*relPath);
+                }
+
+            if (!changedItems.ref().isFullRescan())
+            {
+                const FilterRef traverseFilter = makeSharedRef<ChangedItemsFilter>(fpCfg.filter.nameFilter, changedItems);
+
+                output.emplace(DirectoryKey({folderPair.folderPathLeft, fpCfg.filter.nameFilter, fpCfg.handleSymlinks}),
+                               IncrementalBaseFolder{traverseFilter, changedItems, it->second, SelectSide::left});
+                output.emplace(DirectoryKey({folderPair.folderPathRight, fpCfg.filter.nameFilter, fpCfg.handleSymlinks}),
+                               IncrementalBaseFolder{traverseFilter, changedItems, it->second, SelectSide::right});
+            }
+        }
+    return output;
+}
+
 //#############################################################################################################################
 
 class ComparisonBuffer
 {
 public:
-    ComparisonBuffer(const std::set<DirectoryKey>& folderKeys,
+    ComparisonBuffer(const std::map<DirectoryKey, size_t>& folderKeys, //number of folder pair sides using each key
                      const FolderStatus& baseFolderStatus,
                      int fileTimeTolerance,
+                     uint64_t contentPrefilterMinSize,
+                     bool pruneSoftFiltered,
+                     const std::map<AfsDevice, size_t>& deviceParallelOps,
+                     bool autoTuneParallelOps,
                      ProcessCallback& callback);
 
+    ~ComparisonBuffer()
+    {
+        for (const auto& [folderKey, folderVal] : folderBuffer_) //e.g. comparison aborted
+            addMemoryUsage("scan results", -getMemoryUsage(folderVal));
+    }
+
+    //read all folders: onFolderBuffered() is called (main thread) as soon as a folder's content is final
+    //=> folder pairs can be compared while other devices are still being scanned
+    void bufferFolders(const std::map<DirectoryKey, IncrementalBaseFolder>& incrementalFolders,
+                       const std::function<void(const DirectoryKey& folderKey)>& onFolderBuffered /*throw X*/); //throw X
+
     //create comparison result table and fill category except for files existing on both sides: undefinedFiles and undefinedSymlinks are appended!
-    std::shared_ptr<BaseFolderPair> compareByTimeSize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig) const;
-    std::shared_ptr<BaseFolderPair> compareBySize    (const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig) const;
-    std::list<std::shared_ptr<BaseFolderPair>> compareByContent(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad) const;
+    //each folder pair must be compared exactly once: scan results are released after the last pair using them is merged
+    std::shared_ptr<BaseFolderPair> compareByTimeSize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig);
+    std::shared_ptr<BaseFolderPair> compareBySize    (const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig);
+    std::list<std::shared_ptr<BaseFolderPair>> compareByContent(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad);
 
 private:
     ComparisonBuffer           (const ComparisonBuffer&) = delete;
@@ -172,65 +518,155 @@ private:
     std::shared_ptr<BaseFolderPair> performComparison(const ResolvedFolderPair& fp,
                                                       const FolderPairCfg& fpCfg,
                                                       std::vector<FilePair*>& undefinedFiles,
-                                                      std::vector<SymlinkPair*>& undefinedSymlinks) const;
+                                                      std::vector<SymlinkPair*>& undefinedSymlinks);
+
+    void releaseFolderContent(const DirectoryKey& folderKey);
 
-    std::map<DirectoryKey, DirectoryValue> folderBuffer_; //contains entries for *all* scanned folders!
+    std::map<DirectoryKey, DirectoryValue> folderBuffer_; //contains entries for *all* scanned folders not yet merged!
+    std::map<DirectoryKey, size_t> pendingMerges_; //=> peak memory: don't hold scan results *and* comparison results for all folder pairs
     const int fileTimeTolerance_;
-    const FolderStatus& folderStatus_;
+    const uint64_t contentPrefilterMinSize_;
+    const bool pruneSoftFiltered_;
+    const std::map<AfsDevice, size_t> deviceParallelOps_;
+    const bool autoTuneParallelOps_;
+    FolderStatus folderStatus_; //copy: pending checks are resolved during bufferFolders()
     ProcessCallback& cb_;
 };
 
 
-ComparisonBuffer::ComparisonBuffer(const std::set<DirectoryKey>& folderKeys,
+ComparisonBuffer::ComparisonBuffer(const std::map<DirectoryKey, size_t>& folderKeys,
                                    const FolderStatus& folderStatus,
                                    int fileTimeTolerance,
+                                   uint64_t contentPrefilterMinSize,
+                                   bool pruneSoftFiltered,
+                                   const std::map<AfsDevice, size_t>& deviceParallelOps,
+                                   bool autoTuneParallelOps,
                                    ProcessCallback& callback) :
+    pendingMerges_(folderKeys),
     fileTimeTolerance_(fileTimeTolerance),
+    contentPrefilterMinSize_(contentPrefilterMinSize),
+    pruneSoftFiltered_(pruneSoftFiltered),
+    deviceParallelOps_(deviceParallelOps),
+    autoTuneParallelOps_(autoTuneParallelOps),
     folderStatus_(folderStatus),
-    cb_(callback)
+    cb_(callback) {}
+
+
+void ComparisonBuffer::bufferFolders(const std::map<DirectoryKey, IncrementalBaseFolder>& incrementalFolders,
+                                     const std::function<void(const DirectoryKey& folderKey)>& onFolderBuffered /*throw X*/) //throw X
 {
-    std::set<DirectoryKey> foldersToRead;
-    for (const DirectoryKey& folderKey : folderKeys)
-        if (folderStatus.existing.contains(folderKey.folderPath))
-            foldersToRead.insert(folderKey); //only traverse *existing* folders
+    std::vector<DirectoryKey> folderKeys; //copy: onFolderBuffered() may release entries of pendingMerges_
+    for (const auto& [folderKey, useCount] : pendingMerges_)
+        folderKeys.push_back(folderKey);
+
+    std::set<DirectoryKey> foldersBuffered;
+    auto addFolderBuffer = [&](const DirectoryKey& folderKey, DirectoryValue&& folderVal) //throw X
+    {
+        [[maybe_unused]] const bool inserted = foldersBuffered.insert(folderKey).second;
+        assert(inserted);
+        addMemoryUsage("scan results", getMemoryUsage(folderVal));
+        folderBuffer_.emplace(folderKey, std::move(folderVal));
+        onFolderBuffered(folderKey); //throw X
+    };
 
-    //------------------------------------------------------------------
     const std::chrono::steady_clock::time_point compareStartTime = std::chrono::steady_clock::now();
     int itemsReported = 0;
+    int itemsPrevRounds = 0; //itemsTotal is per parallelDeviceTraversal() call
 
     auto onStatusUpdate = [&, textScanning = _("Scanning:") + L' '](const std::wstring& statusLine, int itemsTotal)
     {
-        callback.updateDataProcessed(itemsTotal - itemsReported, 0); //noexcept
-        itemsReported = itemsTotal;
+        cb_.updateDataProcessed(itemsPrevRounds + itemsTotal - itemsReported, 0); //noexcept
+        itemsReported = itemsPrevRounds + itemsTotal;
 
-        callback.updateStatus(textScanning + statusLine); //throw X
+        cb_.updateStatus(textScanning + statusLine); //throw X
     };
 
-    folderBuffer_ = parallelDeviceTraversal(foldersToRead,
-    [&](const PhaseCallback::ErrorInfo& errorInfo) { return callback.reportError(errorInfo); }, //throw X
-    onStatusUpdate, //throw X
-    UI_UPDATE_INTERVAL / 2); //every ~50 ms
+    auto bufferFolderKeys = [&](const std::vector<DirectoryKey>& roundKeys) //throw X
+    {
+        std::set<DirectoryKey> foldersToRead;
+        std::map<DirectoryKey, DirectoryKey> travKeyToFolderKey; //incremental comparison: traverse with a different filter
+        for (const DirectoryKey& folderKey : roundKeys)
+            if (folderStatus_.existing.contains(folderKey.folderPath)) //only traverse *existing* folders
+            {
+                DirectoryKey travKey = folderKey;
+                if (auto it = incrementalFolders.find(folderKey);
+                    it != incrementalFolders.end())
+                    travKey.filter = it->second.traverseFilter;
+
+                foldersToRead.insert(travKey);
+                travKeyToFolderKey.emplace(travKey, folderKey);
+            }
+
+        //no traversal needed: buffer entries for non-existing folders right away
+        for (const DirectoryKey& folderKey : roundKeys)
+            if (auto it = folderStatus_.failedChecks.find(folderKey.folderPath);
+                it != folderStatus_.failedChecks.end())
+            {
+                DirectoryValue folderVal;
+                //make sure all items are disabled => avoid user panicking: https://freefilesync.org/forum/viewtopic.php?t=7582
+                folderVal.failedFolderReads[Zstring() /*empty string for root*/] = utfTo<Zstringc>(it->second.toString());
+                addFolderBuffer(folderKey, std::move(folderVal)); //throw X
+            }
+            else if (!folderStatus_.existing.contains(folderKey.folderPath))
+            {
+                assert(folderStatus_.notExisting.contains(folderKey.folderPath) ||
+                       AFS::isNullPath(folderKey.folderPath));
+                addFolderBuffer(folderKey, DirectoryValue()); //throw X
+            }
+
+        auto onFolderDone = [&](const DirectoryKey& travKey, DirectoryValue&& folderVal) //throw X
+        {
+            const DirectoryKey& folderKey = travKeyToFolderKey.find(travKey)->second;
+
+            if (auto it = incrementalFolders.find(folderKey);
+                it != incrementalFolders.end())
+            {
+                const IncrementalBaseFolder& incFolder = it->second;
+                if (incFolder.side == SelectSide::left)
+                    addUnchangedItems<SelectSide::left >(folderVal.folderCont, incFolder.lastSyncState.ref(), Zstring(), incFolder.changedItems.ref(), folderKey.filter.ref(), folderKey.handleSymlinks);
+                else
+                    addUnchangedItems<SelectSide::right>(folderVal.folderCont, incFolder.lastSyncState.ref(), Zstring(), incFolder.changedItems.ref(), folderKey.filter.ref(), folderKey.handleSymlinks);
+
+                folderVal.folderCont.sortItems();
+            }
+            addFolderBuffer(folderKey, std::move(folderVal)); //throw X
+        };
+
+        [[maybe_unused]] const std::map<DirectoryKey, DirectoryValue> notHandedOver = parallelDeviceTraversal(foldersToRead, deviceParallelOps_,
+        [&](const PhaseCallback::ErrorInfo& errorInfo) { return cb_.reportError(errorInfo); }, //throw X
+        onStatusUpdate, //throw X
+        UI_UPDATE_INTERVAL / 2, //every ~50 ms
+        onFolderDone); //throw X
+        assert(notHandedOver.empty());
+    };
+
+    //existence check of slow devices still pending (see getFolderStatusNonBlocking()): don't let them hold up traversal of the others
+    std::vector<DirectoryKey> folderKeysReady;
+    std::vector<DirectoryKey> folderKeysPending;
+    for (const DirectoryKey& folderKey : folderKeys)
+        (folderStatus_.pending.contains(folderKey.folderPath) ? folderKeysPending : folderKeysReady).push_back(folderKey);
+
+    bufferFolderKeys(folderKeysReady); //throw X
+
+    if (!folderKeysPending.empty())
+    {
+        resolvePendingFolderStatus(folderStatus_, cb_); //throw X
+        itemsPrevRounds = itemsReported;
+        bufferFolderKeys(folderKeysPending); //throw X
+    }
+    assert(folderStatus_.pending.empty());
 
     const int64_t totalTimeSec = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - compareStartTime).count();
 
-    callback.logInfo(_("Comparison finished:") + L' ' +
-                     _P("1 item found", "%x items found", itemsReported) + L" | " +
-                     _("Time elapsed:") + L' ' + copyStringTo<std::wstring>(wxTimeSpan::Seconds(totalTimeSec).Format())); //throw X
+    cb_.logInfo(_("Comparison finished:") + L' ' +
+                _P("1 item found", "%x items found", itemsReported) + L" | " +
+                _("Time elapsed:") + L' ' + copyStringTo<std::wstring>(wxTimeSpan::Seconds(totalTimeSec).Format())); //throw X
     //------------------------------------------------------------------
 
-    //folderStatus_.existing already in buffer, now create entries for the rest:
+    //contract: entries for *all* folders (existing or not), e.g. two folder keys sharing the same traversal key
     for (const DirectoryKey& folderKey : folderKeys)
-        if (auto it = folderStatus_.failedChecks.find(folderKey.folderPath);
-            it != folderStatus_.failedChecks.end())
-            //make sure all items are disabled => avoid user panicking: https://freefilesync.org/forum/viewtopic.php?t=7582
-            folderBuffer_[folderKey].failedFolderReads[Zstring() /*empty string for root*/] = utfTo<Zstringc>(it->second.toString());
-        else
-        {
-            folderBuffer_[folderKey];
-            assert(folderStatus_.existing   .contains(folderKey.folderPath) ||
-                   folderStatus_.notExisting.contains(folderKey.folderPath) ||
-                   AFS::isNullPath(folderKey.folderPath));
-        }
+        if (!foldersBuffered.contains(folderKey))
+            addFolderBuffer(folderKey, DirectoryValue()); //throw X
 }
 
 
@@ -292,19 +728,30 @@ Zstringc getConflictAmbiguousItemName(const Zstring& itemName)
 
 //-----------------------------------------------------------------------------
 
-void categorizeSymlinkByTime(SymlinkPair& symlink)
+//perf: item names match byte-wise on both sides for all but a few items => skip the normalization (allocates for non-ASCII names)
+template <class FileOrLinkPair> inline
+bool sameItemNameCase(const FileOrLinkPair& item)
+{
+    const Zstring& itemNameL = item.template getItemName<SelectSide::left >();
+    const Zstring& itemNameR = item.template getItemName<SelectSide::right>();
+    return itemNameL == itemNameR ||
+           getUnicodeNormalForm(itemNameL) == getUnicodeNormalForm(itemNameR);
+}
+
+
+template <FileTimeCmp timeCmp>
+void categorizeSymlinkByTime(SymlinkPair& symlink, int fileTimeTolerance, const std::vector<unsigned int>& ignoreTimeShiftMinutes)
 {
     //categorize symlinks that exist on both sides
-    switch (compareFileTime(symlink.getLastWriteTime<SelectSide::left>(),
-                            symlink.getLastWriteTime<SelectSide::right>(), symlink.base().getFileTimeTolerance(), symlink.base().getIgnoredTimeShift()))
+    switch (compareFileTime<timeCmp>(symlink.getLastWriteTime<SelectSide::left>(),
+                                     symlink.getLastWriteTime<SelectSide::right>(), fileTimeTolerance, ignoreTimeShiftMinutes))
     {
         case TimeResult::equal:
             //Caveat:
             //1. SYMLINK_EQUAL may only be set if short names match in case: InSyncFolder's mapping tables use short name as a key! see db_file.cpp
             //2. harmonize with "bool stillInSync()" in algorithm.cpp
 
-            if (getUnicodeNormalForm(symlink.getItemName<SelectSide::left >()) ==
-                getUnicodeNormalForm(symlink.getItemName<SelectSide::right>()))
+            if (sameItemNameCase(symlink))
                 symlink.setCategory<FILE_EQUAL>();
             else
                 symlink.setCategoryDiffMetadata(getDescrDiffMetaShortnameCase(symlink));
@@ -329,57 +776,98 @@ void categorizeSymlinkByTime(SymlinkPair& symlink)
 }
 
 
-std::shared_ptr<BaseFolderPair> ComparisonBuffer::compareByTimeSize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig) const
+template <FileTimeCmp timeCmp>
+void categorizeFileByTimeSize(FilePair& file, int fileTimeTolerance, const std::vector<unsigned int>& ignoreTimeShiftMinutes)
+{
+    switch (compareFileTime<timeCmp>(file.getLastWriteTime<SelectSide::left>(),
+                                     file.getLastWriteTime<SelectSide::right>(), fileTimeTolerance, ignoreTimeShiftMinutes))
+    {
+        case TimeResult::equal:
+            //Caveat:
+            //1. FILE_EQUAL may only be set if short names match in case: InSyncFolder's mapping tables use short name as a key! see db_file.cpp
+            //2. FILE_EQUAL is expected to mean identical file sizes! See InSyncFile
+            //3. harmonize with "bool stillInSync()" in algorithm.cpp, FilePair::setSyncedTo() in file_hierarchy.h
+            if (file.getFileSize<SelectSide::left>() == file.getFileSize<SelectSide::right>())
+            {
+                if (sameItemNameCase(file))
+                    file.setCategory<FILE_EQUAL>();
+                else
+                    file.setCategoryDiffMetadata(getDescrDiffMetaShortnameCase(file));
+            }
+            else
+                file.setCategoryConflict(getConflictSameDateDiffSize(file)); //same date, different filesize
+            break;
+
+        case TimeResult::leftNewer:
+            file.setCategory<FILE_LEFT_NEWER>();
+            break;
+
+        case TimeResult::rightNewer:
+            file.setCategory<FILE_RIGHT_NEWER>();
+            break;
+
+        case TimeResult::leftInvalid:
+            file.setCategoryConflict(getConflictInvalidDate<SelectSide::left>(file));
+            break;
+
+        case TimeResult::rightInvalid:
+            file.setCategoryConflict(getConflictInvalidDate<SelectSide::right>(file));
+            break;
+    }
+}
+
+
+const size_t CATEGORIZE_FILES_PER_THREAD_MIN = 100'000; //don't bother with threads for small comparisons
+
+//categorization is independent per item: FileSystemObject::setCategory*() doesn't touch the parent containers
+//=> fan out over consecutive ranges of the files found on both sides
+template <class Function> //fun(FilePair& file)
+void categorizeFilesParallel(const std::vector<FilePair*>& files, Function fun)
+{
+    const size_t threadCount = std::clamp<size_t>(files.size() / CATEGORIZE_FILES_PER_THREAD_MIN, 1, std::max<size_t>(std::thread::hardware_concurrency(), 1));
+
+    auto categorizeRange = [&](size_t first, size_t last)
+    {
+        std::for_each(files.begin() + first, files.begin() + last, [&](FilePair* file) { fun(*file); });
+    };
+
+    if (threadCount == 1)
+        return categorizeRange(0, files.size());
+
+    ThreadGroup<std::function<void()>> tg(threadCount, Zstr("Categorize files"));
+    for (size_t i = 0; i < threadCount; ++i)
+        tg.run([&categorizeRange, first = files.size() * i / threadCount, last = files.size() * (i + 1) / threadCount]
+    {
+        const ScheduleThreadForBackground backgroundPrio(BackgroundWork::compute);
+        categorizeRange(first, last);
+    });
+    tg.wait();
+}
+
+
+std::shared_ptr<BaseFolderPair> ComparisonBuffer::compareByTimeSize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig)
 {
     //do basis scan and retrieve files existing on both sides as "compareCandidates"
     std::vector<FilePair*> uncategorizedFiles;
     std::vector<SymlinkPair*> uncategorizedLinks;
     std::shared_ptr<BaseFolderPair> output = performComparison(fp, fpConfig, uncategorizedFiles, uncategorizedLinks);
 
-    //finish symlink categorization
-    for (SymlinkPair* symlink : uncategorizedLinks)
-        categorizeSymlinkByTime(*symlink);
+    //decide time comparison once per folder pair => specialized categorization loops
+    dispatchFileTimeCmp(getFileTimeCmp(output->getFileTimeTolerance(), output->getIgnoredTimeShift()), [&](auto timeCmp)
+    {
+        //finish symlink categorization
+        for (SymlinkPair* symlink : uncategorizedLinks)
+            categorizeSymlinkByTime<timeCmp>(*symlink, output->getFileTimeTolerance(), output->getIgnoredTimeShift());
+    });
 
     //categorize files that exist on both sides
-    for (FilePair* file : uncategorizedFiles)
+    dispatchFileTimeCmp(getFileTimeCmp(fileTimeTolerance_, fpConfig.ignoreTimeShiftMinutes), [&](auto timeCmp)
     {
-        switch (compareFileTime(file->getLastWriteTime<SelectSide::left>(),
-                                file->getLastWriteTime<SelectSide::right>(), fileTimeTolerance_, fpConfig.ignoreTimeShiftMinutes))
+        categorizeFilesParallel(uncategorizedFiles, [&](FilePair& file)
         {
-            case TimeResult::equal:
-                //Caveat:
-                //1. FILE_EQUAL may only be set if short names match in case: InSyncFolder's mapping tables use short name as a key! see db_file.cpp
-                //2. FILE_EQUAL is expected to mean identical file sizes! See InSyncFile
-                //3. harmonize with "bool stillInSync()" in algorithm.cpp, FilePair::setSyncedTo() in file_hierarchy.h
-                if (file->getFileSize<SelectSide::left>() == file->getFileSize<SelectSide::right>())
-                {
-                    if (getUnicodeNormalForm(file->getItemName<SelectSide::left >()) ==
-                        getUnicodeNormalForm(file->getItemName<SelectSide::right>()))
-                        file->setCategory<FILE_EQUAL>();
-                    else
-                        file->setCategoryDiffMetadata(getDescrDiffMetaShortnameCase(*file));
-                }
-                else
-                    file->setCategoryConflict(getConflictSameDateDiffSize(*file)); //same date, different filesize
-                break;
-
-            case TimeResult::leftNewer:
-                file->setCategory<FILE_LEFT_NEWER>();
-                break;
-
-            case TimeResult::rightNewer:
-                file->setCategory<FILE_RIGHT_NEWER>();
-                break;
-
-            case TimeResult::leftInvalid:
-                file->setCategoryConflict(getConflictInvalidDate<SelectSide::left>(*file));
-                break;
-
-            case TimeResult::rightInvalid:
-                file->setCategoryConflict(getConflictInvalidDate<SelectSide::right>(*file));
-                break;
-        }
-    }
+            categorizeFileByTimeSize<timeCmp>(file, fileTimeTolerance_, fpConfig.ignoreTimeShiftMinutes);
+        });
+    });
     return output;
 }
 
@@ -409,8 +897,7 @@ void categorizeSymlinkByContent(SymlinkPair& symlink, PhaseCallback& callback)
             //1. SYMLINK_EQUAL may only be set if short names match in case: InSyncFolder's mapping tables use short name as a key! see db_file.cpp
             //2. harmonize with "bool stillInSync()" in algorithm.cpp, FilePair::setSyncedTo() in file_hierarchy.h
 
-            if (getUnicodeNormalForm(symlink.getItemName<SelectSide::left >()) !=
-                getUnicodeNormalForm(symlink.getItemName<SelectSide::right>()))
+            if (!sameItemNameCase(symlink))
                 symlink.setCategoryDiffMetadata(getDescrDiffMetaShortnameCase(symlink));
             //else if (!sameFileTime(symlink.getLastWriteTime<SelectSide::left>(),
             //                       symlink.getLastWriteTime<SelectSide::right>(), symlink.base().getFileTimeTolerance(), symlink.base().getIgnoredTimeShift()))
@@ -425,7 +912,7 @@ void categorizeSymlinkByContent(SymlinkPair& symlink, PhaseCallback& callback)
 }
 
 
-std::shared_ptr<BaseFolderPair> ComparisonBuffer::compareBySize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig) const
+std::shared_ptr<BaseFolderPair> ComparisonBuffer::compareBySize(const ResolvedFolderPair& fp, const FolderPairCfg& fpConfig)
 {
     //do basis scan and retrieve files existing on both sides as "compareCandidates"
     std::vector<FilePair*> uncategorizedFiles;
@@ -438,23 +925,22 @@ std::shared_ptr<BaseFolderPair> ComparisonBuffer::compareBySize(const ResolvedFo
     //harmonize with algorithm.cpp, stillInSync()!
 
     //categorize files that exist on both sides
-    for (FilePair* file : uncategorizedFiles)
+    categorizeFilesParallel(uncategorizedFiles, [](FilePair& file)
     {
         //Caveat:
         //1. FILE_EQUAL may only be set if short names match in case: InSyncFolder's mapping tables use short name as a key! see db_file.cpp
         //2. FILE_EQUAL is expected to mean identical file sizes! See InSyncFile
         //3. harmonize with "bool stillInSync()" in algorithm.cpp, FilePair::setSyncedTo() in file_hierarchy.h
-        if (file->getFileSize<SelectSide::left>() == file->getFileSize<SelectSide::right>())
+        if (file.getFileSize<SelectSide::left>() == file.getFileSize<SelectSide::right>())
         {
-            if (getUnicodeNormalForm(file->getItemName<SelectSide::left >()) ==
-                getUnicodeNormalForm(file->getItemName<SelectSide::right>()))
-                file->setCategory<FILE_EQUAL>();
+            if (sameItemNameCase(file))
+                file.setCategory<FILE_EQUAL>();
             else
-                file->setCategoryDiffMetadata(getDescrDiffMetaShortnameCase(*file));
+                file.setCategoryDiffMetadata(getDescrDiffMetaShortnameCase(file));
         }
         else
-            file->setCategory<FILE_DIFFERENT_CONTENT>();
-    }
+            file.setCategory<FILE_DIFFERENT_CONTENT>();
+    });
     return output;
 }
 
@@ -466,31 +952,102 @@ namespace parallel
 //--------------------------------------------------------------
 inline
 bool filesHaveSameContent(const AbstractPath& filePath1, const AbstractPath& filePath2, //throw FileError, X
+                          size_t parallelOps,
+                          ContentHash* contentHash,
+                          uint64_t* equalPrefix,
                           const IoCallback& notifyUnbufferedIO /*throw X*/,
                           std::mutex& singleThread)
-{ return parallelScope([=] { return filesHaveSameContent(filePath1, filePath2, notifyUnbufferedIO); /*throw FileError, X*/ }, singleThread); }
+{ return parallelScope([=] { return filesHaveSameContent(filePath1, filePath2, parallelOps, contentHash, equalPrefix, notifyUnbufferedIO); /*throw FileError, X*/ }, singleThread); }
+
+inline
+bool sampledContentMatches(const AbstractPath& filePath1, const AbstractPath& filePath2, uint64_t fileSize, std::mutex& singleThread) //throw FileError
+{ return parallelScope([=] { return sampledContentMatches(filePath1, filePath2, fileSize); /*throw FileError*/ }, singleThread); }
+
+inline
+std::optional<bool> digestContentMatches(const AbstractPath& filePath1, const AbstractPath& filePath2, //throw FileError, X
+                                         ContentHash* contentHash,
+                                         const IoCallback& notifyUnbufferedIO /*throw X*/,
+                                         std::mutex& singleThread)
+{ return parallelScope([=] { return digestContentMatches(filePath1, filePath2, contentHash, notifyUnbufferedIO); /*throw FileError, X*/ }, singleThread); }
 }
 
 
 namespace
 {
-void categorizeFileByContent(FilePair& file, const std::wstring& txtComparingContentOfFiles, AsyncCallback& acb, std::mutex& singleThread) //throw ThreadStopRequest
+void categorizeSameContent(FilePair& file)
+{
+    //Caveat:
+    //1. FILE_EQUAL may only be set if short names match in case: InSyncFolder's mapping tables use short name as a key! see db_file.cpp
+    //2. FILE_EQUAL is expected to mean identical file sizes! See InSyncFile
+    //3. harmonize with "bool stillInSync()" in algorithm.cpp, FilePair::setSyncedTo() in file_hierarchy.h
+    if (!sameItemNameCase(file))
+        file.setCategoryDiffMetadata(getDescrDiffMetaShortnameCase(file));
+#if 0 //don't synchronize modtime only see FolderPairSyncer::synchronizeFileInt(), SO_COPY_METADATA_TO_*
+    else if (!sameFileTime(file.getLastWriteTime<SelectSide::left>(),
+                           file.getLastWriteTime<SelectSide::right>(), file.base().getFileTimeTolerance(), file.base().getIgnoredTimeShift()))
+        file.setCategoryDiffMetadata(getDescrDiffMetaData(file));
+#endif
+    else
+        file.setCategory<FILE_EQUAL>();
+}
+
+
+//calcContentHash: only needed if sync.ffs_db is saved: see matchesContentHash()
+//prefilterMinSize: sample blocks first to reject differing large files early; 0 to disable
+//parallelOps: huge files may be compared range-parallel (unless calcContentHash)
+//limiterL/R: optional
+void categorizeFileByContent(FilePair& file, bool calcContentHash, uint64_t prefilterMinSize, size_t parallelOps,
+                             BandwidthLimiter* limiterL, BandwidthLimiter* limiterR,
+                             const std::wstring& txtComparingContentOfFiles, AsyncCallback& acb, std::mutex& singleThread) //throw ThreadStopRequest
 {
     bool haveSameContent = false;
+    ContentHash contentHash{};
+    uint64_t equalPrefix = 0;
     const std::wstring errMsg = tryReportingError([&]
     {
         PercentStatReporter statReporter(replaceCpy(txtComparingContentOfFiles, L"%x", fmtPath(file.getRelativePathAny())),
                                          file.getFileSize<SelectSide::left>(), acb); //throw ThreadStopRequest
 
         //callbacks run *outside* singleThread_ lock! => fine
-        auto notifyUnbufferedIO = [&statReporter](int64_t bytesDelta)
+        auto notifyUnbufferedIO = [&statReporter, limiterL, limiterR](int64_t bytesDelta)
         {
             statReporter.updateStatus(0, bytesDelta); //throw ThreadStopRequest
+
+            if (limiterL || limiterR)
+            {
+                const auto now = std::chrono::steady_clock::now();
+                const auto resumeTime = std::max(limiterL ? limiterL->consume(bytesDelta) : now,
+                                                 limiterR ? limiterR->consume(bytesDelta) : now);
+                if (resumeTime > now)
+                    interruptibleSleep(resumeTime - now); //throw ThreadStopRequest
+            }
             interruptionPoint(); //throw ThreadStopRequest => not reliably covered by AsyncPercentStatReporter::updateStatus()!
         };
 
+        const uint64_t fileSize = file.getFileSize<SelectSide::left>(); //left and right file sizes are equal
+
+        if (prefilterMinSize > 0 && fileSize >= prefilterMinSize &&
+            !parallel::sampledContentMatches(file.getAbstractPath<SelectSide::left >(),
+                                             file.getAbstractPath<SelectSide::right>(), fileSize, singleThread)) //throw FileError
+        {
+            haveSameContent = false;
+            statReporter.updateStatus(1, 0); //throw ThreadStopRequest
+            return;
+        }
+
+        //server-side checksums (FTP HASH, Google Drive, SFTP opt-in): avoid downloading
+        if (const std::optional<bool> sameDigest = parallel::digestContentMatches(file.getAbstractPath<SelectSide::left >(),
+                                                                                  file.getAbstractPath<SelectSide::right>(),
+                                                                                  calcContentHash ? &contentHash : nullptr, notifyUnbufferedIO, singleThread)) //throw FileError, ThreadStopRequest
+        {
+            haveSameContent = *sameDigest;
+            statReporter.updateStatus(1, 0); //throw ThreadStopRequest
+            return;
+        }
+
         haveSameContent = parallel::filesHaveSameContent(file.getAbstractPath<SelectSide::left >(),
-                                                         file.getAbstractPath<SelectSide::right>(), notifyUnbufferedIO, singleThread); //throw FileError, ThreadStopRequest
+                                                         file.getAbstractPath<SelectSide::right>(), parallelOps,
+                                                         calcContentHash ? &contentHash : nullptr, &equalPrefix, notifyUnbufferedIO, singleThread); //throw FileError, ThreadStopRequest
         statReporter.updateStatus(1, 0); //throw ThreadStopRequest
     }, acb); //throw ThreadStopRequest
 
@@ -500,51 +1057,127 @@ void categorizeFileByContent(FilePair& file, const std::wstring& txtComparingCon
     {
         if (haveSameContent)
         {
-            //Caveat:
-            //1. FILE_EQUAL may only be set if short names match in case: InSyncFolder's mapping tables use short name as a key! see db_file.cpp
-            //2. FILE_EQUAL is expected to mean identical file sizes! See InSyncFile
-            //3. harmonize with "bool stillInSync()" in algorithm.cpp, FilePair::setSyncedTo() in file_hierarchy.h
-            if (getUnicodeNormalForm(file.getItemName<SelectSide::left >()) !=
-                getUnicodeNormalForm(file.getItemName<SelectSide::right>()))
-                file.setCategoryDiffMetadata(getDescrDiffMetaShortnameCase(file));
-#if 0 //don't synchronize modtime only see FolderPairSyncer::synchronizeFileInt(), SO_COPY_METADATA_TO_*
-            else if (!sameFileTime(file.getLastWriteTime<SelectSide::left>(),
-                                   file.getLastWriteTime<SelectSide::right>(), file.base().getFileTimeTolerance(), file.base().getIgnoredTimeShift()))
-                file.setCategoryDiffMetadata(getDescrDiffMetaData(file));
-#endif
-            else
-                file.setCategory<FILE_EQUAL>();
+            categorizeSameContent(file);
+            file.setContentHash(contentHash, contentHash); //same content => same hash
         }
         else
+        {
             file.setCategory<FILE_DIFFERENT_CONTENT>();
+            file.setEqualPrefix(equalPrefix); //=> synchronization won't read these bytes again
+        }
+    }
+}
+}
+
+
+namespace
+{
+template <SelectSide side> inline
+bool matchesContentHash(const FilePair& file, const InSyncDescrFile& descrDb)
+{
+    return descrDb.contentHash != ContentHash{} &&
+           //exact match required: we're not interested in "fileTimeTolerance" here!
+           file.getLastWriteTime<side>() == descrDb.modTime &&
+           file.getFilePrint<side>() == descrDb.filePrint;
+}
+
+
+//file content verified as equal and unchanged since last sync? => skip byte-wise comparison
+const InSyncFile* findContentVerifiedDbFile(const FilePair& file, const InSyncFolder& lastSyncState)
+{
+    const InSyncFolder* dbFolder = &lastSyncState;
+
+    //DB keys are short names of left side (ignoring Unicode normal forms): see db_file.cpp
+    const std::vector<Zstring> relPathItems = split(file.getRelativePathAny(), FILE_NAME_SEPARATOR, SplitOnEmpty::skip);
+    assert(!relPathItems.empty());
+    for (auto it = relPathItems.begin(); it + 1 < relPathItems.end(); ++it)
+    {
+        auto itDb = dbFolder->folders.find(*it);
+        if (itDb == dbFolder->folders.end())
+            return nullptr;
+        dbFolder = &itDb->second;
     }
+
+    auto itDb = dbFolder->files.find(relPathItems.back());
+    if (itDb == dbFolder->files.end())
+        return nullptr;
+
+    const InSyncFile& dbFile = itDb->second;
+    if (dbFile.cmpVar == CompareVariant::content &&
+        dbFile.fileSize == file.getFileSize<SelectSide::left>() &&
+        dbFile.left.contentHash == dbFile.right.contentHash &&
+        matchesContentHash<SelectSide::left >(file, dbFile.left) &&
+        matchesContentHash<SelectSide::right>(file, dbFile.right))
+        return &dbFile;
+
+    return nullptr;
 }
 }
 
 
-std::list<std::shared_ptr<BaseFolderPair>> ComparisonBuffer::compareByContent(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad) const
+std::list<std::shared_ptr<BaseFolderPair>> ComparisonBuffer::compareByContent(const std::vector<std::pair<ResolvedFolderPair, FolderPairCfg>>& workLoad)
 {
     struct ParallelOps
     {
         size_t current      = 0;
+        std::optional<ParallelOpsTuner> tuner; //auto-tune: number of files compared in parallel
+        int     itemsDone = 0;
+        int64_t bytesDone = 0;
+
+        size_t getFreeSlots() const
+        {
+            const size_t limit = tuner ? tuner->getParallelOps() : 1;
+            return limit > current ? limit - current : 0; //tuner may shrink limit below current
+        }
     };
     std::map<AfsDevice, ParallelOps> parallelOpsStatus;
 
+    //one token bucket per device: shared by all folder pairs
+    std::map<AfsDevice, BandwidthLimiter> bandwidthLimiters;
+    const uint64_t bandwidthLimit = globalContentBandwidthLimit;
+
     struct BinaryWorkload
     {
         ParallelOps& parallelOpsL; //
         ParallelOps& parallelOpsR; //consider aliasing!
         RingBuffer<FilePair*> filesToCompareBytewise;
+        bool calcContentHash;
+        size_t parallelOps; //range-parallel comparison of huge files: min of left/right device
+        BandwidthLimiter* limiterL; //optional
+        BandwidthLimiter* limiterR; //
     };
     std::vector<BinaryWorkload> fpWorkload;
 
-    auto addToBinaryWorkload = [&](const AbstractPath& basePathL, const AbstractPath& basePathR, RingBuffer<FilePair*>&& filesToCompareBytewise)
+    auto addToBinaryWorkload = [&](const AbstractPath& basePathL, const AbstractPath& basePathR, RingBuffer<FilePair*>&& filesToCompareBytewise, bool calcContentHash)
     {
         ParallelOps& posL = parallelOpsStatus[basePathL.afsDevice];
         ParallelOps& posR = parallelOpsStatus[basePathR.afsDevice];
-        fpWorkload.push_back({posL, posR, std::move(filesToCompareBytewise)});
+        const size_t parallelOpsL = getDeviceParallelOps(deviceParallelOps_, basePathL.afsDevice);
+        const size_t parallelOpsR = getDeviceParallelOps(deviceParallelOps_, basePathR.afsDevice);
+        const size_t parallelOps = std::min(parallelOpsL, parallelOpsR);
+
+        if (autoTuneParallelOps_)
+        {
+            if (!posL.tuner && parallelOpsL > 1) posL.tuner.emplace(parallelOpsL);
+            if (!posR.tuner && parallelOpsR > 1) posR.tuner.emplace(parallelOpsR);
+        }
+        BandwidthLimiter* limiterL = nullptr;
+        BandwidthLimiter* limiterR = nullptr;
+        if (bandwidthLimit > 0)
+        {
+            limiterL = &bandwidthLimiters.try_emplace(basePathL.afsDevice, bandwidthLimit).first->second;
+            limiterR = &bandwidthLimiters.try_emplace(basePathR.afsDevice, bandwidthLimit).first->second;
+        }
+        fpWorkload.push_back({posL, posR, std::move(filesToCompareBytewise), calcContentHash, parallelOps, limiterL, limiterR});
     };
 
+    struct ContentCandidates
+    {
+        const BaseFolderPair* baseFolder;
+        RingBuffer<FilePair*> files;
+    };
+    std::vector<ContentCandidates> hashCacheCandidates; //content hashes are persisted in sync.ffs_db only if it is saved at all: see saveSyncDB
+
     //PERF_START;
     std::list<std::shared_ptr<BaseFolderPair>> output;
 
@@ -574,14 +1207,51 @@ std::list<std::shared_ptr<BaseFolderPair>> ComparisonBuffer::compareByContent(co
                     filesToCompareBytewise.push_back(file);
             }
         if (!filesToCompareBytewise.empty())
-            addToBinaryWorkload(output.back()->getAbstractPath<SelectSide::left >(),
-                                output.back()->getAbstractPath<SelectSide::right>(), std::move(filesToCompareBytewise));
+        {
+            if (detectMovedFilesEnabled(fpCfg.directionCfg)) //=> saveSyncDB
+                hashCacheCandidates.push_back({output.back().get(), std::move(filesToCompareBytewise)});
+            else
+                addToBinaryWorkload(output.back()->getAbstractPath<SelectSide::left >(),
+                                    output.back()->getAbstractPath<SelectSide::right>(),
+                                    std::move(filesToCompareBytewise), false /*calcContentHash*/);
+        }
 
         //finish symlink categorization
         for (SymlinkPair* symlink : uncategorizedLinks)
             categorizeSymlinkByContent(*symlink, cb_);
     }
 
+    //skip files that were found equal by content during last sync and are unchanged since: avoid full read for mostly static data
+    if (!hashCacheCandidates.empty())
+    {
+        std::vector<const BaseFolderPair*> baseFolders;
+        for (const ContentCandidates& cc : hashCacheCandidates)
+            baseFolders.push_back(cc.baseFolder);
+
+        const std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> lastSyncStates =
+            loadLastSynchronousState(baseFolders, deviceParallelOps_, cb_); //throw X
+
+        for (const ContentCandidates& cc : hashCacheCandidates)
+        {
+            auto it = lastSyncStates.find(cc.baseFolder);
+            const InSyncFolder* lastSyncState = it != lastSyncStates.end() ? &it->second.ref() : nullptr;
+
+            RingBuffer<FilePair*> filesToCompareBytewise;
+            for (FilePair* file : cc.files)
+                if (const InSyncFile* dbFile = lastSyncState ? findContentVerifiedDbFile(*file, *lastSyncState) : nullptr)
+                {
+                    categorizeSameContent(*file);
+                    file->setContentHash(dbFile->left.contentHash, dbFile->right.contentHash);
+                }
+                else
+                    filesToCompareBytewise.push_back(file);
+
+            if (!filesToCompareBytewise.empty())
+                addToBinaryWorkload(cc.baseFolder->getAbstractPath<SelectSide::left >(),
+                                    cc.baseFolder->getAbstractPath<SelectSide::right>(), std::move(filesToCompareBytewise), true /*calcContentHash*/);
+        }
+    }
+
     //finish categorization: compare files (that have same size) bytewise...
     if (!fpWorkload.empty()) //run ProcessPhase::comparingContent only when needed
     {
@@ -604,7 +1274,17 @@ std::list<std::shared_ptr<BaseFolderPair>> ComparisonBuffer::compareByContent(co
         std::function<void()> scheduleMoreTasks; //manage life time: enclose ThreadGroup!
         const std::wstring txtComparingContentOfFiles = _("Comparing content of files %x"); //
 
-        ThreadGroup<std::function<void()>> tg(std::numeric_limits<size_t>::max(), Zstr("Binary Comparison"));
+        auto addTunerSample = [](ParallelOps& pos, uint64_t fileSize)
+        {
+            if (pos.tuner)
+            {
+                ++pos.itemsDone;
+                pos.bytesDone += static_cast<int64_t>(fileSize);
+                pos.tuner->addSample(pos.itemsDone, pos.bytesDone);
+            }
+        };
+
+        WorkStealingThreadGroup<std::function<void()>> tg(std::numeric_limits<size_t>::max(), Zstr("Binary Comparison")); //follow-up tasks are scheduled by the workers themselves
 
         scheduleMoreTasks = [&]
         {
@@ -615,25 +1295,35 @@ std::list<std::shared_ptr<BaseFolderPair>> ComparisonBuffer::compareByContent(co
                 BinaryWorkload& bwl = fpWorkload[j];
                 ParallelOps& posL = bwl.parallelOpsL;
                 ParallelOps& posR = bwl.parallelOpsR;
-                const size_t newTaskCount = std::min<size_t>({1                 - posL.current, 1                 - posR.current, bwl.filesToCompareBytewise.size()});
+                const size_t newTaskCount = std::min<size_t>({posL.getFreeSlots(), posR.getFreeSlots(), bwl.filesToCompareBytewise.size()});
                 if (&posL != &posR)
                     posL.current += newTaskCount; //
                 posR.current += newTaskCount;     //consider aliasing!
 
                 for (size_t i = 0; i < newTaskCount; ++i)
                 {
-                    tg.run([&, statusPrio = j, &file = *bwl.filesToCompareBytewise.front()]
+                    //auto-tune: the same budget caps comparing ranges of one huge file in parallel
+                    size_t parallelOps = bwl.parallelOps;
+                    if (posL.tuner) parallelOps = std::min(parallelOps, posL.tuner->getParallelOps());
+                    if (posR.tuner) parallelOps = std::min(parallelOps, posR.tuner->getParallelOps());
+
+                    tg.run([&, statusPrio = j, &file = *bwl.filesToCompareBytewise.front(), calcContentHash = bwl.calcContentHash, parallelOps,
+                                              limiterL = bwl.limiterL, limiterR = bwl.limiterR]
                     {
+                        const ScheduleThreadForBackground backgroundPrio(BackgroundWork::compute); //small files are read on this thread: see filesHaveSameContent()
                         acb.notifyTaskBegin(statusPrio); //prioritize status messages according to natural order of folder pairs
                         ZEN_ON_SCOPE_EXIT(acb.notifyTaskEnd());
 
-                        std::lock_guard dummy(singleThread); //protect ALL variable accesses unless explicitly not needed ("parallel" scope)!
+                        lockSingleThread(singleThread);
+                        std::lock_guard dummy(singleThread, std::adopt_lock); //protect ALL variable accesses unless explicitly not needed ("parallel" scope)!
                         //---------------------------------------------------------------------------------------------------
                         ZEN_ON_SCOPE_SUCCESS(if (&posL != &posR) --posL.current;
                                              /**/                --posR.current;
+                                             /**/                addTunerSample(posL, file.getFileSize<SelectSide::left>());
+                                             if (&posL != &posR) addTunerSample(posR, file.getFileSize<SelectSide::left>());
                                              scheduleMoreTasks());
 
-                        categorizeFileByContent(file, txtComparingContentOfFiles, acb, singleThread); //throw ThreadStopRequest
+                        categorizeFileByContent(file, calcContentHash, contentPrefilterMinSize_, parallelOps, limiterL, limiterR, txtComparingContentOfFiles, acb, singleThread); //throw ThreadStopRequest
                     });
 
                     bwl.filesToCompareBytewise.pop_front();
@@ -662,9 +1352,11 @@ class MergeSides
 {
 public:
     MergeSides(const std::map<ZstringNoCase, Zstringc>& errorsByRelPath,
+               const SoftFilter* pruneFilter, //optional: skip files and symlinks excluded on both sides
                std::vector<FilePair*>& undefinedFilesOut,
                std::vector<SymlinkPair*>& undefinedSymlinksOut) :
         errorsByRelPath_(errorsByRelPath),
+        pruneFilter_(pruneFilter),
         undefinedFiles_(undefinedFilesOut),
         undefinedSymlinks_(undefinedSymlinksOut) {}
 
@@ -685,7 +1377,20 @@ private:
 
     const Zstringc* checkFailedRead(FileSystemObject& fsObj, const Zstringc* errorMsg);
 
+    //same result as ApplySoftFilter, see algorithm.cpp: row would be excluded => not needed at all (failed reads excepted: need to show up as conflict)
+    bool isPruned(const FileAttributes* attrL, const FileAttributes* attrR, const Zstringc* errorMsg) const
+    {
+        auto match = [&](const FileAttributes* attr) { return attr && pruneFilter_->matchSize(attr->fileSize) && pruneFilter_->matchTime(attr->modTime); };
+        return pruneFilter_ && !errorMsg && !match(attrL) && !match(attrR);
+    }
+    bool isPruned(const LinkAttributes* attrL, const LinkAttributes* attrR, const Zstringc* errorMsg) const
+    {
+        auto match = [&](const LinkAttributes* attr) { return attr && pruneFilter_->matchTime(attr->modTime); };
+        return pruneFilter_ && !errorMsg && !match(attrL) && !match(attrR);
+    }
+
     const std::map<ZstringNoCase, Zstringc>& errorsByRelPath_; //base-relative paths or empty if read-error for whole base directory
+    const SoftFilter* const pruneFilter_;
     std::vector<FilePair*>&    undefinedFiles_;
     std::vector<SymlinkPair*>& undefinedSymlinks_;
 };
@@ -713,44 +1418,43 @@ template <SelectSide side>
 void MergeSides::fillOneSide(const FolderContainer& folderCont, const Zstringc* errorMsg, ContainerObject& output)
 {
     for (const auto& [fileName, attrib] : folderCont.files)
-    {
-        FilePair& newItem = output.addSubFile<side>(fileName, attrib);
-        checkFailedRead(newItem, errorMsg);
-    }
+        if (!isPruned(&attrib, nullptr, errorMsg))
+        {
+            FilePair& newItem = output.addSubFile<side>(fileName, attrib);
+            checkFailedRead(newItem, errorMsg);
+        }
 
     for (const auto& [linkName, attrib] : folderCont.symlinks)
-    {
-        SymlinkPair& newItem = output.addSubLink<side>(linkName, attrib);
-        checkFailedRead(newItem, errorMsg);
-    }
+        if (!isPruned(&attrib, nullptr, errorMsg))
+        {
+            SymlinkPair& newItem = output.addSubLink<side>(linkName, attrib);
+            checkFailedRead(newItem, errorMsg);
+        }
 
     for (const auto& [folderName, attrAndSub] : folderCont.folders)
     {
         FolderPair& newFolder = output.addSubFolder<side>(folderName, attrAndSub.first);
         const Zstringc* errorMsgNew = checkFailedRead(newFolder, errorMsg);
-        fillOneSide<side>(attrAndSub.second, errorMsgNew, newFolder); //recurse
+        fillOneSide<side>(*attrAndSub.second, errorMsgNew, newFolder); //recurse
     }
 }
 
 
-template <class MapType, class ProcessLeftOnly, class ProcessRightOnly, class ProcessBoth> inline
-void matchFolders(const MapType& mapLeft, const MapType& mapRight, ProcessLeftOnly lo, ProcessRightOnly ro, ProcessBoth bo)
+//merge-join: both item lists are already sorted by upper-case name (see FolderContainer::sortItems())
+//upper-case names were computed during traversal (FolderContainer::fileKeys, ...) => no getUpperCase() on the main thread
+template <class ItemList, class ProcessLeftOnly, class ProcessRightOnly, class ProcessBoth> inline
+void matchFolders(const ItemList& itemsLeft,  const std::vector<Zstring>& upperCaseLeft,
+                  const ItemList& itemsRight, const std::vector<Zstring>& upperCaseRight,
+                  ProcessLeftOnly lo, ProcessRightOnly ro, ProcessBoth bo)
 {
+    assert(itemsLeft.size() == upperCaseLeft.size() && itemsRight.size() == upperCaseRight.size());
+
     struct FileRef
     {
-        Zstring upperCaseName; //buffer expensive getUpperCase() calls!!
-        const typename MapType::value_type* ref;
+        const typename ItemList::value_type* ref;
         bool leftSide;
+        Zstring normalName; //only set for ambiguous ranges
     };
-    std::vector<FileRef> fileList;
-    fileList.reserve(mapLeft.size() + mapRight.size()); //perf: ~5% shorter runtime
-
-    for (const auto& item : mapLeft ) fileList.push_back({getUpperCase(item.first), &item, true});
-    for (const auto& item : mapRight) fileList.push_back({getUpperCase(item.first), &item, false});
-
-    //primary sort: ignore unicode normal form and case
-    //bonus: natural default sequence on file guid UI
-    std::sort(fileList.begin(), fileList.end(), [](const FileRef& lhs, const FileRef& rhs) { return lhs.upperCaseName < rhs.upperCaseName; });
 
     auto tryMatchRange = [&](auto it, auto itLast)
     {
@@ -773,19 +1477,20 @@ void matchFolders(const MapType& mapLeft, const MapType& mapRight, ProcessLeftOn
         return true;
     };
 
-    for (auto it = fileList.begin(); it != fileList.end();)
+    auto processEqualRange = [&](std::vector<FileRef>& equalRange) //equal range: ignore case, ignore Unicode normalization
     {
-        //find equal range: ignore case, ignore Unicode normalization
-        auto itEndEq = std::find_if(it + 1, fileList.end(), [&](const FileRef& fr) { return fr.upperCaseName != it->upperCaseName; });
-        if (!tryMatchRange(it, itEndEq))
+        if (!tryMatchRange(equalRange.begin(), equalRange.end()))
         {
             //secondary sort: respect case, ignore unicode normal forms
-            std::sort(it, itEndEq, [](const FileRef& lhs, const FileRef& rhs) { return getUnicodeNormalForm(lhs.ref->first) < getUnicodeNormalForm(rhs.ref->first); });
+            for (FileRef& fr : equalRange) //buffer expensive getUnicodeNormalForm() calls: not once per comparison!
+                fr.normalName = getUnicodeNormalForm(fr.ref->first);
 
-            for (auto itCase = it; itCase != itEndEq;)
+            std::sort(equalRange.begin(), equalRange.end(), [](const FileRef& lhs, const FileRef& rhs) { return lhs.normalName < rhs.normalName; });
+
+            for (auto itCase = equalRange.begin(); itCase != equalRange.end();)
             {
                 //find equal range: respect case, ignore Unicode normalization
-                auto itEndCase = std::find_if(itCase + 1, itEndEq, [&](const FileRef& fr) { return getUnicodeNormalForm(fr.ref->first) != getUnicodeNormalForm(itCase->ref->first); });
+                auto itEndCase = std::find_if(itCase + 1, equalRange.end(), [&](const FileRef& fr) { return fr.normalName != itCase->normalName; });
                 if (!tryMatchRange(itCase, itEndCase))
                 {
                     const Zstringc& conflictMsg = getConflictAmbiguousItemName(itCase->ref->first);
@@ -800,7 +1505,35 @@ void matchFolders(const MapType& mapLeft, const MapType& mapRight, ProcessLeftOn
                 itCase = itEndCase;
             }
         }
-        it = itEndEq;
+    };
+
+    size_t idxL = 0;
+    size_t idxR = 0;
+
+    std::vector<FileRef> equalRange; //buffer
+    while (idxL < itemsLeft.size() || idxR < itemsRight.size())
+    {
+        const Zstring& upperCaseName = idxL == itemsLeft .size() ? upperCaseRight[idxR] :
+                                       idxR == itemsRight.size() ? upperCaseLeft [idxL] :
+                                       std::min(upperCaseLeft[idxL], upperCaseRight[idxR]);
+        equalRange.clear();
+
+        for (; idxL < itemsLeft.size() && upperCaseLeft[idxL] == upperCaseName; ++idxL)
+            equalRange.push_back({&itemsLeft[idxL], true, {}});
+
+        for (; idxR < itemsRight.size() && upperCaseRight[idxR] == upperCaseName; ++idxR)
+            equalRange.push_back({&itemsRight[idxR], false, {}});
+        assert(!equalRange.empty());
+
+        if (equalRange.size() == 1) //fast path: item exists on one side only
+        {
+            if (equalRange[0].leftSide)
+                lo(*equalRange[0].ref, nullptr);
+            else
+                ro(*equalRange[0].ref, nullptr);
+        }
+        else
+            processEqualRange(equalRange);
     }
 }
 
@@ -809,18 +1542,24 @@ void MergeSides::mergeTwoSides(const FolderContainer& lhs, const FolderContainer
 {
     using FileData = FolderContainer::FileList::value_type;
 
-    matchFolders(lhs.files, rhs.files, [&](const FileData& fileLeft, const Zstringc* conflictMsg)
+    matchFolders(lhs.files, lhs.fileKeys, rhs.files, rhs.fileKeys, [&](const FileData& fileLeft, const Zstringc* conflictMsg)
     {
+        if (isPruned(&fileLeft.second, nullptr, conflictMsg ? conflictMsg : errorMsg))
+            return;
         FilePair& newItem = output.addSubFile<SelectSide::left >(fileLeft .first, fileLeft .second);
         checkFailedRead(newItem, conflictMsg ? conflictMsg : errorMsg);
     },
     [&](const FileData& fileRight, const Zstringc* conflictMsg)
     {
+        if (isPruned(nullptr, &fileRight.second, conflictMsg ? conflictMsg : errorMsg))
+            return;
         FilePair& newItem = output.addSubFile<SelectSide::right>(fileRight.first, fileRight.second);
         checkFailedRead(newItem, conflictMsg ? conflictMsg : errorMsg);
     },
     [&](const FileData& fileLeft, const FileData& fileRight)
     {
+        if (isPruned(&fileLeft.second, &fileRight.second, errorMsg))
+            return;
         FilePair& newItem = output.addSubFile(fileLeft.first,
                                               fileLeft.second,
                                               FILE_CONFLICT, //dummy-value until categorization is finished later
@@ -828,24 +1567,30 @@ void MergeSides::mergeTwoSides(const FolderContainer& lhs, const FolderContainer
                                               fileRight.second);
         if (!checkFailedRead(newItem, errorMsg))
             undefinedFiles_.push_back(&newItem);
-        static_assert(std::is_same_v<ContainerObject::FileList, std::list<FilePair>>); //ContainerObject::addSubFile() must NOT invalidate references used in "undefinedFiles"!
+        static_assert(std::is_same_v<ContainerObject::FileList, std::list<FilePair, ArenaAllocator<FilePair>>>); //ContainerObject::addSubFile() must NOT invalidate references used in "undefinedFiles"!
     });
 
     //-----------------------------------------------------------------------------------------------
     using SymlinkData = FolderContainer::SymlinkList::value_type;
 
-    matchFolders(lhs.symlinks, rhs.symlinks, [&](const SymlinkData& symlinkLeft, const Zstringc* conflictMsg)
+    matchFolders(lhs.symlinks, lhs.symlinkKeys, rhs.symlinks, rhs.symlinkKeys, [&](const SymlinkData& symlinkLeft, const Zstringc* conflictMsg)
     {
+        if (isPruned(&symlinkLeft.second, nullptr, conflictMsg ? conflictMsg : errorMsg))
+            return;
         SymlinkPair& newItem = output.addSubLink<SelectSide::left >(symlinkLeft .first, symlinkLeft .second);
         checkFailedRead(newItem, conflictMsg ? conflictMsg : errorMsg);
     },
     [&](const SymlinkData& symlinkRight, const Zstringc* conflictMsg)
     {
+        if (isPruned(nullptr, &symlinkRight.second, conflictMsg ? conflictMsg : errorMsg))
+            return;
         SymlinkPair& newItem = output.addSubLink<SelectSide::right>(symlinkRight.first, symlinkRight.second);
         checkFailedRead(newItem, conflictMsg ? conflictMsg : errorMsg);
     },
     [&](const SymlinkData& symlinkLeft, const SymlinkData& symlinkRight) //both sides
     {
+        if (isPruned(&symlinkLeft.second, &symlinkRight.second, errorMsg))
+            return;
         SymlinkPair& newItem = output.addSubLink(symlinkLeft.first,
                                                  symlinkLeft.second,
                                                  SYMLINK_CONFLICT, //dummy-value until categorization is finished later
@@ -858,17 +1603,17 @@ void MergeSides::mergeTwoSides(const FolderContainer& lhs, const FolderContainer
     //-----------------------------------------------------------------------------------------------
     using FolderData = FolderContainer::FolderList::value_type;
 
-    matchFolders(lhs.folders, rhs.folders, [&](const FolderData& dirLeft, const Zstringc* conflictMsg)
+    matchFolders(lhs.folders, lhs.folderKeys, rhs.folders, rhs.folderKeys, [&](const FolderData& dirLeft, const Zstringc* conflictMsg)
     {
         FolderPair& newFolder = output.addSubFolder<SelectSide::left>(dirLeft.first, dirLeft.second.first);
         const Zstringc* errorMsgNew = checkFailedRead(newFolder, conflictMsg ? conflictMsg : errorMsg);
-        this->fillOneSide<SelectSide::left>(dirLeft.second.second, errorMsgNew, newFolder); //recurse
+        this->fillOneSide<SelectSide::left>(*dirLeft.second.second, errorMsgNew, newFolder); //recurse
     },
     [&](const FolderData& dirRight, const Zstringc* conflictMsg)
     {
         FolderPair& newFolder = output.addSubFolder<SelectSide::right>(dirRight.first, dirRight.second.first);
         const Zstringc* errorMsgNew = checkFailedRead(newFolder, conflictMsg ? conflictMsg : errorMsg);
-        this->fillOneSide<SelectSide::right>(dirRight.second.second, errorMsgNew, newFolder); //recurse
+        this->fillOneSide<SelectSide::right>(*dirRight.second.second, errorMsgNew, newFolder); //recurse
     },
     [&](const FolderData& dirLeft, const FolderData& dirRight)
     {
@@ -880,7 +1625,7 @@ void MergeSides::mergeTwoSides(const FolderContainer& lhs, const FolderContainer
                 getUnicodeNormalForm(dirRight.first))
                 newFolder.setCategoryDiffMetadata(getDescrDiffMetaShortnameCase(newFolder));
 
-        mergeTwoSides(dirLeft.second.second, dirRight.second.second, errorMsgNew, newFolder); //recurse
+        mergeTwoSides(*dirLeft.second.second, *dirRight.second.second, errorMsgNew, newFolder); //recurse
     });
 }
 
@@ -895,7 +1640,7 @@ void stripExcludedDirectories(ContainerObject& hierObj, const PathFilter& filter
     //remove superfluous directories:
     //   this does not invalidate "std::vector<FilePair*>& undefinedFiles", since we delete folders only
     //   and there is no side-effect for memory positions of FilePair and SymlinkPair thanks to std::list!
-    static_assert(std::is_same_v<std::list<FolderPair>, ContainerObject::FolderList>);
+    static_assert(std::is_same_v<std::list<FolderPair, ArenaAllocator<FolderPair>>, ContainerObject::FolderList>);
 
     hierObj.refSubFolders().remove_if([&](FolderPair& folder)
     {
@@ -912,12 +1657,32 @@ void stripExcludedDirectories(ContainerObject& hierObj, const PathFilter& filter
 }
 
 
+void ComparisonBuffer::releaseFolderContent(const DirectoryKey& folderKey)
+{
+    auto it = pendingMerges_.find(folderKey);
+    assert(it != pendingMerges_.end() && it->second > 0);
+    if (it != pendingMerges_.end() && --it->second == 0)
+    {
+        pendingMerges_.erase(it);
+
+        if (auto itBuf = folderBuffer_.find(folderKey);
+            itBuf != folderBuffer_.end())
+        {
+            addMemoryUsage("scan results", -getMemoryUsage(itBuf->second));
+            folderBuffer_.erase(itBuf); //the comparison result holds its own copy of all item attributes
+        }
+    }
+}
+
+
 //create comparison result table and fill category except for files existing on both sides: undefinedFiles and undefinedSymlinks are appended!
 std::shared_ptr<BaseFolderPair> ComparisonBuffer::performComparison(const ResolvedFolderPair& fp,
                                                                     const FolderPairCfg& fpCfg,
                                                                     std::vector<FilePair*>& undefinedFiles,
-                                                                    std::vector<SymlinkPair*>& undefinedSymlinks) const
+                                                                    std::vector<SymlinkPair*>& undefinedSymlinks)
 {
+    TraceSpan span("compare pair", [&] { return utfTo<std::string>(AFS::getDisplayPath(fp.folderPathLeft) + L" | " + AFS::getDisplayPath(fp.folderPathRight)); });
+
     cb_.updateStatus(_("Generating file list...")); //throw X
     cb_.requestUiUpdate(true /*force*/); //throw X
 
@@ -971,18 +1736,30 @@ std::shared_ptr<BaseFolderPair> ComparisonBuffer::performComparison(const Resolv
         return BaseFolderStatus::notExisting;
     };
 
-    std::shared_ptr<BaseFolderPair> output = std::make_shared<BaseFolderPair>(fp.folderPathLeft,
-                                                                              getBaseFolderStatus(fp.folderPathLeft), //dir existence must be checked only once!
-                                                                              fp.folderPathRight,
-                                                                              getBaseFolderStatus(fp.folderPathRight),
-                                                                              fpCfg.filter.nameFilter.ref().copyFilterAddingExclusion(excludefilterFailedRead),
-                                                                              fpCfg.compareVar,
-                                                                              fileTimeTolerance_,
-                                                                              fpCfg.ignoreTimeShiftMinutes);
+    std::shared_ptr<BaseFolderPair> output(new BaseFolderPair(fp.folderPathLeft,
+                                                              getBaseFolderStatus(fp.folderPathLeft), //dir existence must be checked only once!
+                                                              fp.folderPathRight,
+                                                              getBaseFolderStatus(fp.folderPathRight),
+                                                              fpCfg.filter.nameFilter.ref().copyFilterAddingExclusion(excludefilterFailedRead),
+                                                              fpCfg.compareVar,
+                                                              fileTimeTolerance_,
+                                                              fpCfg.ignoreTimeShiftMinutes),
+                                           BaseFolderPair::destroyAsync); //huge trees: don't block the main thread during re-compare
+    /*  soft filter: can't be applied during traversal: folder buffer is shared by folder pairs (with different soft filters), and a file excluded
+        on one side only is still needed => apply while merging instead: rows excluded on both sides never reach the comparison result
+        - not if sync.ffs_db is used: pruned items would be taken as deleted, see LastSynchronousStateUpdater
+        - not for the GUI: pruned rows cannot be shown as excluded, manually included, or included by a changed filter without comparing again  */
+    const SoftFilter& timeSizeFilter = fpCfg.filter.timeSizeFilter;
+    const bool pruneSoftFiltered = pruneSoftFiltered_ && !timeSizeFilter.isNull() && !detectMovedFilesEnabled(fpCfg.directionCfg);
+
     //PERF_START;
-    MergeSides(failedReads, undefinedFiles, undefinedSymlinks).execute(folderContL, folderContR, *output);
+    MergeSides(failedReads, pruneSoftFiltered ? &timeSizeFilter : nullptr, undefinedFiles, undefinedSymlinks).execute(folderContL, folderContR, *output);
     //PERF_STOP;
 
+    //*after* MergeSides: folderContL/folderContR are dangling from here on!
+    releaseFolderContent({fp.folderPathLeft,  fpCfg.filter.nameFilter, fpCfg.handleSymlinks});
+    releaseFolderContent({fp.folderPathRight, fpCfg.filter.nameFilter, fpCfg.handleSymlinks});
+
     //##################### in/exclude rows according to filtering #####################
     //NOTE: we need to finish de-activating rows BEFORE binary comparison is run so that it can skip them!
 
@@ -1001,11 +1778,16 @@ std::shared_ptr<BaseFolderPair> ComparisonBuffer::performComparison(const Resolv
 
 FolderComparison fff::compare(WarningDialogs& warnings,
                               int fileTimeTolerance,
+                              uint64_t contentPrefilterMinSize,
+                              bool pruneSoftFiltered,
                               bool allowUserInteraction,
                               bool runWithBackgroundPriority,
                               bool createDirLocks,
                               std::unique_ptr<LockHolder>& dirLocks,
                               const std::vector<FolderPairCfg>& fpCfgList,
+                              const std::map<AfsDevice, size_t>& deviceParallelOps,
+                              bool autoTuneParallelOps,
+                              const std::optional<ChangeJournal>& changeJournal,
                               ProcessCallback& callback)
 {
     //PERF_START;
@@ -1036,6 +1818,19 @@ FolderComparison fff::compare(WarningDialogs& warnings,
         callback.logInfo(e.toString()); //throw X
     }
 
+    //connect to all devices in parallel while checking base folder existence
+    {
+        std::set<AfsDevice> devices;
+        for (const FolderPairCfg& fpCfg : fpCfgList)
+        {
+            devices.insert(createAbstractPath(fpCfg.folderPathPhraseLeft_ ).afsDevice);
+            devices.insert(createAbstractPath(fpCfg.folderPathPhraseRight_).afsDevice);
+        }
+        for (const AfsDevice& afsDevice : devices)
+            if (!AFS::isNullDevice(afsDevice))
+                AFS::prepareSessions(afsDevice, getDeviceParallelOps(deviceParallelOps, afsDevice)); //noexcept
+    }
+
     const ResolvedBaseFolders& resInfo = initializeBaseFolders(fpCfgList,
                                                                allowUserInteraction, warnings, callback); //throw X
     //directory existence only checked *once* to avoid race conditions!
@@ -1105,17 +1900,57 @@ FolderComparison fff::compare(WarningDialogs& warnings,
         //reduce peak memory by restricting lifetime of ComparisonBuffer to have ended when loading potentially huge InSyncFolder instance in redetermineSyncDirection()
         {
             //------------------- fill directory buffer: traverse/read folders --------------------------
-            std::set<DirectoryKey> folderKeys;
+            std::map<DirectoryKey, size_t> folderKeys; //folder pair sides per key: same folder may be used by multiple pairs
             for (const auto& [folderPair, fpCfg] : workLoad)
             {
-                folderKeys.emplace(DirectoryKey({folderPair.folderPathLeft,  fpCfg.filter.nameFilter, fpCfg.handleSymlinks}));
-                folderKeys.emplace(DirectoryKey({folderPair.folderPathRight, fpCfg.filter.nameFilter, fpCfg.handleSymlinks}));
+                ++folderKeys[DirectoryKey({folderPair.folderPathLeft,  fpCfg.filter.nameFilter, fpCfg.handleSymlinks})];
+                ++folderKeys[DirectoryKey({folderPair.folderPathRight, fpCfg.filter.nameFilter, fpCfg.handleSymlinks})];
+            }
+
+            //start new change checkpoints even without a journal: the last synchronous state is saved after the next synchronization
+            const std::vector<DeviceChanges>& deviceChanges = getDeviceChanges(workLoad, resInfo.baseFolderStatus, callback); //throw X
+
+            //device changes alone suffice if known for both sides (e.g. Google Drive, ZFS/Btrfs snapshots): no RealTimeSync journal needed
+            std::map<DirectoryKey, IncrementalBaseFolder> incrementalFolders;
+            if (changeJournal || std::any_of(deviceChanges.begin(), deviceChanges.end(), [](const DeviceChanges& dc) { return dc.left && dc.right; }))
+            {
+                incrementalFolders = prepareIncrementalComparison(workLoad, resInfo.baseFolderStatus, changeJournal ? *changeJournal : ChangeJournal(),
+                                                                  deviceChanges, deviceParallelOps, callback); //throw X
+
+                const int pairCount = static_cast<int>(incrementalFolders.size() / 2);
+                callback.logInfo(_P("Incremental comparison of 1 folder pair", "Incremental comparison of %x folder pairs", pairCount)); //throw X
             }
 
-            //PERF_START;
             ComparisonBuffer cmpBuff(folderKeys,
                                      resInfo.baseFolderStatus,
-                                     fileTimeTolerance, callback);
+                                     fileTimeTolerance, contentPrefilterMinSize, pruneSoftFiltered, deviceParallelOps, autoTuneParallelOps, callback);
+
+            //pipeline: compare by time/size as soon as both sides are buffered, while slower devices are still scanning
+            std::vector<std::shared_ptr<BaseFolderPair>> outputByPair(workLoad.size());
+            std::set<DirectoryKey> foldersBuffered;
+
+            //PERF_START;
+            cmpBuff.bufferFolders(incrementalFolders, [&](const DirectoryKey& folderKey) //throw X
+            {
+                foldersBuffered.insert(folderKey);
+
+                for (size_t i = 0; i < workLoad.size(); ++i)
+                    if (const auto& [folderPair, fpCfg] = workLoad[i];
+                        !outputByPair[i] &&
+                        foldersBuffered.contains({folderPair.folderPathLeft,  fpCfg.filter.nameFilter, fpCfg.handleSymlinks}) &&
+                        foldersBuffered.contains({folderPair.folderPathRight, fpCfg.filter.nameFilter, fpCfg.handleSymlinks}))
+                        switch (fpCfg.compareVar)
+                        {
+                            case CompareVariant::timeSize:
+                                outputByPair[i] = cmpBuff.compareByTimeSize(folderPair, fpCfg);
+                                break;
+                            case CompareVariant::size:
+                                outputByPair[i] = cmpBuff.compareBySize(folderPair, fpCfg);
+                                break;
+                            case CompareVariant::content: //binary comparison runs as one junk: see below
+                                break;
+                        }
+            });
             //PERF_STOP;
 
             //process binary comparison as one junk
@@ -1127,23 +1962,20 @@ FolderComparison fff::compare(WarningDialogs& warnings,
             std::list<std::shared_ptr<BaseFolderPair>> outputByContent = cmpBuff.compareByContent(workLoadByContent);
 
             //write output in expected order
-            for (const auto& [folderPair, fpCfg] : workLoad)
-                switch (fpCfg.compareVar)
+            for (size_t i = 0; i < workLoad.size(); ++i)
+                if (workLoad[i].second.compareVar == CompareVariant::content)
                 {
-                    case CompareVariant::timeSize:
-                        output.push_back(cmpBuff.compareByTimeSize(folderPair, fpCfg));
-                        break;
-                    case CompareVariant::size:
-                        output.push_back(cmpBuff.compareBySize(folderPair, fpCfg));
-                        break;
-                    case CompareVariant::content:
-                        assert(!outputByContent.empty());
-                        if (!outputByContent.empty())
-                        {
-                            output.push_back(outputByContent.front());
-                            /**/             outputByContent.pop_front();
-                        }
-                        break;
+                    assert(!outputByContent.empty());
+                    if (!outputByContent.empty())
+                    {
+                        output.push_back(outputByContent.front());
+                        /**/             outputByContent.pop_front();
+                    }
+                }
+                else
+                {
+                    assert(outputByPair[i]);
+                    output.push_back(outputByPair[i]);
                 }
         }
         assert(output.size() == fpCfgList.size());
@@ -1153,9 +1985,14 @@ FolderComparison fff::compare(WarningDialogs& warnings,
         for (auto it = output.begin(); it != output.end(); ++it)
             directCfgs.emplace_back(&** it, fpCfgList[it - output.begin()].directionCfg);
 
-        redetermineSyncDirection(directCfgs,
+        redetermineSyncDirection(directCfgs, deviceParallelOps,
                                  callback); //throw X
 
+        prepareSyncSessions(output); //noexcept
+
+        if (metricsEnabled()) //estimate is O(items)
+            setMemoryUsage("comparison tree", getMemoryUsage(output));
+
         return output;
     }
     catch (const std::bad_alloc& e)
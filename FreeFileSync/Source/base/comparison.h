@@ -11,6 +11,7 @@
 #include "process_callback.h"
 #include "norm_filter.h"
 #include "lock_holder.h"
+#include "change_journal.h"
 
 
 namespace fff
@@ -46,14 +47,22 @@ struct FolderPairCfg
 
 std::vector<FolderPairCfg> extractCompareCfg(const MainConfiguration& mainCfg); //fill FolderPairCfg and resolve folder pairs
 
+//limit file content reads of compare by content per device (shared by all files compared on it): 0 = unlimited
+void setContentBandwidthLimit(uint64_t bytesPerSec); //applies to compare() calls started afterwards
+
 //FFS core routine:     output.size() == fpCfgList.size() or 0 on fatal error
 FolderComparison compare(WarningDialogs& warnings,
                          int fileTimeTolerance,
+                         uint64_t contentPrefilterMinSize, //compare by content: sample blocks of large files first; 0 to disable
+                         bool pruneSoftFiltered, //drop rows excluded by time/size filter instead of deactivating them: no GUI to show them
                          bool allowUserInteraction,
                          bool runWithBackgroundPriority,
                          bool createDirLocks,
                          std::unique_ptr<LockHolder>& dirLocks, //out
                          const std::vector<FolderPairCfg>& fpCfgList,
+                         const std::map<AfsDevice, size_t>& deviceParallelOps,
+                         bool autoTuneParallelOps, //deviceParallelOps is the ceiling
+                         const std::optional<ChangeJournal>& changeJournal, //incremental comparison: traverse changed items only, see change_journal.h
                          ProcessCallback& callback);
 }
 
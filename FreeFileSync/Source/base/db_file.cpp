@@ -6,10 +6,13 @@
 
 #include "db_file.h"
 #include <bit> //std::endian
+#include <deque>
 #include <zen/guid.h>
 #include <zen/crc.h>
 #include <zen/build_info.h>
 #include <zen/zlib_wrap.h>
+#include <zen/thread.h>
+#include <zen/perf.h>
 #include "../afs/concrete.h"
 #include "../afs/native.h"
 #include "status_handler_impl.h"
@@ -23,30 +26,40 @@ namespace
 {
 //-------------------------------------------------------------------------------------------------------------------------------
 const char DB_FILE_DESCR[] = "FreeFileSync";
-const int DB_FILE_VERSION   = 11; //2020-02-07
-const int DB_STREAM_VERSION =  4; //2021-02-14
+const int DB_FILE_VERSION    = 12; //2026-10-14: same format as v11, but journal-aware => older versions must not read a stale state
+const int DB_STREAM_VERSION  =  6; //2026-10-14
+const int DB_JOURNAL_VERSION =  1; //2026-10-14
+
+const size_t DB_BLOCK_SIZE_MIN = 1024 * 1024; //[bytes, uncompressed] group consecutive top-level folders until block is large enough
+
+const size_t DB_JOURNAL_DELTAS_MAX = 16; //compact journal into the database file after this many updates
+const size_t DB_JOURNAL_SIZE_RATIO =  8; //... or when journal exceeds 1/8 of the session's stream size
 //-------------------------------------------------------------------------------------------------------------------------------
 
 DEFINE_NEW_FILE_ERROR(FileErrorDatabaseNotExisting)
 
+using UniqueId = std::string;
+
 struct SessionData
 {
     bool isLeadStream = false;
     std::string rawStream;
 
+    //journaled updates: not yet compacted into rawStream
+    UniqueId baseSessionID; //session ID of rawStream within the database file; empty if not journaled
+    std::vector<std::string> rawDeltas; //lead stream only
+
     bool operator==(const SessionData&) const = default;
 };
 
-
-using UniqueId  = std::string;
 using DbStreams = std::unordered_map<UniqueId, SessionData>; //list of streams by session GUID
 
 /*------------------------------------------------------------------------------
   | ensure 32/64 bit portability: use fixed size data types only e.g. uint32_t |
   ------------------------------------------------------------------------------*/
 
-template <SelectSide side> inline
-AbstractPath getDatabaseFilePath(const BaseFolderPair& baseFolder)
+inline
+AbstractPath getDatabaseFilePath(const AbstractPath& baseFolderPath)
 {
     static_assert(std::endian::native == std::endian::little);
     /* Windows, Linux, macOS considerations for uniform database format:
@@ -59,7 +72,114 @@ AbstractPath getDatabaseFilePath(const BaseFolderPair& baseFolder)
 
         => give db files different names:                   */
     const Zstring dbName = Zstr(".sync"); //files beginning with dots are usually hidden
-    return AFS::appendRelPath(baseFolder.getAbstractPath<side>(), dbName + SYNC_DB_FILE_ENDING);
+    return AFS::appendRelPath(baseFolderPath, dbName + SYNC_DB_FILE_ENDING);
+}
+
+
+template <SelectSide side> inline
+AbstractPath getDatabaseFilePath(const BaseFolderPair& baseFolder) { return getDatabaseFilePath(baseFolder.getAbstractPath<side>()); }
+
+
+//small updates are appended to a journal instead of rewriting the (potentially huge) database file
+//=> file ending: excluded from comparison + ignored by RealTimeSync like the database file itself
+inline
+AbstractPath getDatabaseJournalPath(const AbstractPath& dbPath)
+{
+    return AFS::appendRelPath(*AFS::getParentPath(dbPath), beforeLast(AFS::getItemName(dbPath), Zstr('.'), IfNotFoundReturn::none) + Zstr(".journal") + SYNC_DB_FILE_ENDING);
+}
+
+
+/* database catalog: keep the database (+ journal) of remote base folders in a local folder instead of up- and downloading it for each run
+    - remote folder only gets a small marker file referencing its catalog entry by a random ID
+      => recreated remote folder (marker gone) does not pick up the stale state of the old one
+    - catalog entry contains the same session GUIDs as the database file it replaces => disabling the catalog later is safe:
+      the other side's database no longer references the catalog's (now outdated) session after the next sync   */
+Protected<Zstring> globalDbCatalogFolderPath; //empty: disabled
+
+const char DB_CATALOG_MARKER_DESCR[] = "FreeFileSync database catalog: ";
+
+
+bool usesDbCatalog(const AbstractPath& dbPath)
+{
+    return getNativeItemPath(dbPath).empty() && //native folders: nothing to gain
+           !globalDbCatalogFolderPath.access([](const Zstring& folderPath) { return folderPath.empty(); });
+}
+
+
+inline
+AbstractPath getDbCatalogMarkerPath(const AbstractPath& dbPath) //file ending: excluded from comparison like the database file
+{
+    return AFS::appendRelPath(*AFS::getParentPath(dbPath), beforeLast(AFS::getItemName(dbPath), Zstr('.'), IfNotFoundReturn::none) + Zstr(".catalog") + SYNC_DB_FILE_ENDING);
+}
+
+
+AbstractPath getDbCatalogPath(const std::string& catalogId)
+{
+    const Zstring catalogFolderPath = globalDbCatalogFolderPath.access([](const Zstring& folderPath) { return folderPath; });
+    return AFS::appendRelPath(createItemPathNativeNoFormatting(catalogFolderPath), utfTo<Zstring>(catalogId) + SYNC_DB_FILE_ENDING);
+}
+
+
+std::optional<std::string> readDbCatalogMarker(const AbstractPath& markerPath) //throw FileError
+{
+    std::string byteStream;
+    try
+    {
+        const std::unique_ptr<AFS::InputStream> fileStreamIn = AFS::getInputStream(markerPath, nullptr /*notifyUnbufferedIO*/); //throw FileError, ErrorFileLocked
+        byteStream = bufferedLoad<std::string>(*fileStreamIn); //throw FileError, ErrorFileLocked
+    }
+    catch (FileError&)
+    {
+        if (AFS::itemStillExists(markerPath)) //throw FileError
+            throw;
+        return std::nullopt; //database not (yet) in catalog
+    }
+
+    const std::string catalogId = trimCpy(afterFirst(byteStream, DB_CATALOG_MARKER_DESCR, IfNotFoundReturn::none));
+    if (!startsWith(byteStream, DB_CATALOG_MARKER_DESCR) || catalogId.empty() ||
+        !std::all_of(catalogId.begin(), catalogId.end(), [](char c) { return isHexDigit(c); }))
+        throw FileError(replaceCpy(_("Cannot read database file %x."), L"%x", fmtPath(AFS::getDisplayPath(markerPath))),
+                        _("File content is corrupted.") + L" (invalid catalog marker)");
+    return catalogId;
+}
+
+
+void writeDbCatalogMarker(const AbstractPath& markerPath, const std::string& catalogId) //throw FileError
+{
+    const std::string byteStream = DB_CATALOG_MARKER_DESCR + catalogId + '\n';
+
+    //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
+    AFS::removeFileIfExists(markerPath); //throw FileError
+    const std::unique_ptr<AFS::OutputStream> fileStreamOut = AFS::getOutputStream(markerPath, byteStream.size(), std::nullopt /*modTime*/, nullptr /*notifyUnbufferedIO*/); //throw FileError
+    fileStreamOut->write(byteStream.c_str(), byteStream.size()); //throw FileError
+    fileStreamOut->finalize();                                   //throw FileError
+}
+
+
+//location to write the database to; may differ from dbPath if database catalog is enabled
+AbstractPath prepareDbSavePath(const AbstractPath& dbPath, bool& dbFileExisting) //throw FileError
+{
+    dbFileExisting = true;
+    if (!usesDbCatalog(dbPath))
+        return dbPath;
+
+    const AbstractPath markerPath = getDbCatalogMarkerPath(dbPath);
+    std::optional<std::string> catalogId = readDbCatalogMarker(markerPath); //throw FileError
+    if (!catalogId)
+    {
+        catalogId = formatAsHexString(generateGUID());
+        writeDbCatalogMarker(markerPath, *catalogId); //throw FileError
+
+        //database (+ journal) within remote folder is superseded by the catalog entry
+        AFS::removeFileIfExists(getDatabaseJournalPath(dbPath)); //throw FileError
+        AFS::removeFileIfExists(dbPath);                         //
+    }
+
+    const AbstractPath catalogPath = getDbCatalogPath(*catalogId);
+    AFS::createFolderIfMissingRecursion(*AFS::getParentPath(catalogPath)); //throw FileError
+
+    dbFileExisting = static_cast<bool>(AFS::itemStillExists(catalogPath)); //throw FileError
+    return catalogPath;
 }
 
 //#######################################################################################################################################
@@ -79,7 +199,7 @@ void saveStreams(const DbStreams& streamList, const AbstractPath& dbPath, const
 
     for (const auto& [sessionID, sessionData] : streamList)
     {
-        writeContainer<std::string>(memStreamOut, sessionID);
+        writeContainer<std::string>(memStreamOut, sessionData.baseSessionID.empty() ? sessionID : sessionData.baseSessionID); //journaled sessions: see saveJournal()
 
         writeNumber<int8_t>(memStreamOut, sessionData.isLeadStream);
         writeContainer     (memStreamOut, sessionData.rawStream);
@@ -99,8 +219,112 @@ void saveStreams(const DbStreams& streamList, const AbstractPath& dbPath, const
 }
 
 
-DbStreams loadStreams(const AbstractPath& dbPath, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, FileErrorDatabaseNotExisting, X
+//journal: one entry per journaled session => complements (and supersedes) session "baseSessionID" within the database file
+void saveJournal(const DbStreams& streamList, const AbstractPath& journalPath, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+{
+    MemoryStreamOut<std::string> memStreamOut;
+
+    writeArray(memStreamOut, DB_FILE_DESCR, sizeof(DB_FILE_DESCR));
+    writeNumber<int32_t>(memStreamOut, DB_JOURNAL_VERSION);
+
+    const size_t entryCount = std::count_if(streamList.begin(), streamList.end(), [](const auto& v) { return !v.second.baseSessionID.empty(); });
+    writeNumber(memStreamOut, static_cast<uint32_t>(entryCount));
+
+    for (const auto& [sessionID, sessionData] : streamList)
+        if (!sessionData.baseSessionID.empty())
+        {
+            writeContainer<std::string>(memStreamOut, sessionID);
+            writeContainer<std::string>(memStreamOut, sessionData.baseSessionID);
+            writeNumber<int8_t>(memStreamOut, sessionData.isLeadStream);
+
+            writeNumber(memStreamOut, static_cast<uint32_t>(sessionData.rawDeltas.size()));
+            for (const std::string& rawDelta : sessionData.rawDeltas)
+                writeContainer(memStreamOut, rawDelta);
+        }
+
+    writeNumber<uint32_t>(memStreamOut, getCrc32(memStreamOut.ref()));
+    //------------------------------------------------------------------------------------------------------------------------
+
+    //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
+    const std::unique_ptr<AFS::OutputStream> fileStreamOut = AFS::getOutputStream(journalPath, //throw FileError
+                                                                                  memStreamOut.ref().size(),
+                                                                                  std::nullopt /*modTime*/,
+                                                                                  notifyUnbufferedIO /*throw X*/);
+    fileStreamOut->write(memStreamOut.ref().c_str(), memStreamOut.ref().size()); //throw FileError, X
+    fileStreamOut->finalize();                                                   //throw FileError, X
+}
+
+
+void mergeJournal(DbStreams& streams, const AbstractPath& journalPath, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
 {
+    std::string byteStream;
+    try
+    {
+        const std::unique_ptr<AFS::InputStream> fileStreamIn = AFS::getInputStream(journalPath, notifyUnbufferedIO); //throw FileError, ErrorFileLocked
+        byteStream = bufferedLoad<std::string>(*fileStreamIn); //throw FileError, ErrorFileLocked, X
+    }
+    catch (FileError&)
+    {
+        if (AFS::itemStillExists(journalPath)) //throw FileError
+            throw;
+        return; //no journaled updates
+    }
+    //------------------------------------------------------------------------------------------------------------------------
+    try
+    {
+        MemoryStreamIn<std::string_view> memStreamIn(byteStream);
+
+        char formatDescr[sizeof(DB_FILE_DESCR)] = {};
+        readArray(memStreamIn, formatDescr, sizeof(formatDescr)); //throw SysErrorUnexpectedEos
+
+        if (!std::equal(DB_FILE_DESCR, DB_FILE_DESCR + sizeof(DB_FILE_DESCR), formatDescr))
+            throw SysError(_("File content is corrupted.") + L" (invalid header)");
+
+        const int version = readNumber<int32_t>(memStreamIn); //throw SysErrorUnexpectedEos
+        if (version != DB_JOURNAL_VERSION)
+            throw SysError(_("Unsupported data format.") + L' ' + replaceCpy(_("Version: %x"), L"%x", numberTo<std::wstring>(version)));
+
+        MemoryStreamOut<std::string> crcStreamOut;
+        writeNumber<uint32_t>(crcStreamOut, getCrc32(byteStream.begin(), byteStream.end() - std::min(byteStream.size(), sizeof(uint32_t))));
+        if (!endsWith(byteStream, crcStreamOut.ref()))
+            throw SysError(_("File content is corrupted.") + L" (invalid checksum)");
+
+        size_t entryCount = readNumber<uint32_t>(memStreamIn); //throw SysErrorUnexpectedEos
+        while (entryCount-- != 0)
+        {
+            const UniqueId sessionID     = readContainer<std::string>(memStreamIn); //
+            const UniqueId baseSessionID = readContainer<std::string>(memStreamIn); //throw SysErrorUnexpectedEos
+            const bool isLeadStream      = readNumber<int8_t>(memStreamIn) != 0;    //
+
+            std::vector<std::string> rawDeltas;
+            size_t deltaCount = readNumber<uint32_t>(memStreamIn); //throw SysErrorUnexpectedEos
+            while (deltaCount-- != 0)
+                rawDeltas.push_back(readContainer<std::string>(memStreamIn)); //throw SysErrorUnexpectedEos
+
+            //journal entries are rewritten together with the database file => base session missing: stale entry
+            if (auto it = streams.find(baseSessionID);
+                it != streams.end() && it->second.isLeadStream == isLeadStream && it->second.baseSessionID.empty())
+            {
+                SessionData sessionData = std::move(it->second);
+                streams.erase(it);
+
+                sessionData.baseSessionID = baseSessionID;
+                sessionData.rawDeltas     = std::move(rawDeltas);
+                streams[sessionID] = std::move(sessionData);
+            }
+        }
+    }
+    catch (const SysError& e)
+    {
+        throw FileError(replaceCpy(_("Cannot read database file %x."), L"%x", fmtPath(AFS::getDisplayPath(journalPath))), e.toString());
+    }
+}
+
+
+DbStreams loadStreams(const AbstractPath& dbPath, bool& journalAware, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, FileErrorDatabaseNotExisting, X
+{
+    journalAware = false;
+
     std::string byteStream;
     try
     {
@@ -122,7 +346,7 @@ DbStreams loadStreams(const AbstractPath& dbPath, const IoCallback& notifyUnbuff
     //------------------------------------------------------------------------------------------------------------------------
     try
     {
-        MemoryStreamIn memStreamIn(byteStream);
+        MemoryStreamIn<std::string_view> memStreamIn(byteStream);
 
         char formatDescr[sizeof(DB_FILE_DESCR)] = {};
         readArray(memStreamIn, formatDescr, sizeof(formatDescr)); //throw SysErrorUnexpectedEos
@@ -134,7 +358,8 @@ DbStreams loadStreams(const AbstractPath& dbPath, const IoCallback& notifyUnbuff
         if (version ==  9 || //TODO: remove migration code at some time!  v9 used until 2017-02-01
             version == 10)   //TODO: remove migration code at some time! v10 used until 2020-02-07
             ;
-        else if (version == DB_FILE_VERSION) //catch data corruption ASAP + don't rely on std::bad_alloc for consistency checking
+        else if (version == 11 || //TODO: remove migration code at some time! v11 used until 2026-10-14
+                 version == DB_FILE_VERSION) //catch data corruption ASAP + don't rely on std::bad_alloc for consistency checking
             // => only "partially" useful for container/stream metadata since the streams data is zlib-compressed
         {
             assert(byteStream.size() >= sizeof(uint32_t)); //obviously in this context!
@@ -161,7 +386,7 @@ DbStreams loadStreams(const AbstractPath& dbPath, const IoCallback& notifyUnbuff
             {
                 sessionData.rawStream = readContainer<std::string>(memStreamIn); //throw SysErrorUnexpectedEos
 
-                MemoryStreamIn streamIn(sessionData.rawStream);
+                MemoryStreamIn<std::string_view> streamIn(sessionData.rawStream);
                 const int streamVersion = readNumber<int32_t>(streamIn); //throw SysErrorUnexpectedEos
                 if (streamVersion != 2) //don't throw here due to old stream formats
                     continue;
@@ -175,6 +400,12 @@ DbStreams loadStreams(const AbstractPath& dbPath, const IoCallback& notifyUnbuff
 
             output[sessionID] = std::move(sessionData);
         }
+
+        if (version == DB_FILE_VERSION)
+        {
+            journalAware = true;
+            mergeJournal(output, getDatabaseJournalPath(dbPath), notifyUnbufferedIO); //throw FileError, X
+        }
         return output;
     }
     catch (const SysError& e)
@@ -183,14 +414,72 @@ DbStreams loadStreams(const AbstractPath& dbPath, const IoCallback& notifyUnbuff
     }
 }
 
+
+DbStreams loadDbStreams(const AbstractPath& dbPath, bool& journalAware, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, FileErrorDatabaseNotExisting, X
+{
+    if (usesDbCatalog(dbPath))
+        if (const std::optional<std::string> catalogId = readDbCatalogMarker(getDbCatalogMarkerPath(dbPath))) //throw FileError
+            return loadStreams(getDbCatalogPath(*catalogId), journalAware, notifyUnbufferedIO); //throw FileError, FileErrorDatabaseNotExisting, X
+    //not yet migrated: database file (if any) within the remote folder
+
+    return loadStreams(dbPath, journalAware, notifyUnbufferedIO); //throw FileError, FileErrorDatabaseNotExisting, X
+}
+
 //#######################################################################################################################################
 
+//reuse compression of unchanged blocks when saving; don't hold on to the (much larger) raw blocks => verify hash matches by decompressing
+using DbBlockCache = std::unordered_map<uint64_t /*hash of raw block*/, std::string /*compressed block*/>;
+
+
+uint64_t getBlockHash(std::string_view bufText, std::string_view bufSmallNum, std::string_view bufBigNum)
+{
+    FNV1aHash<uint64_t> hash;
+    for (const std::string_view buf : {bufText, bufSmallNum, bufBigNum})
+    {
+        hash.add(buf.size());
+        for (const char c : buf)
+            hash.add(static_cast<unsigned char>(c));
+    }
+    return hash.get();
+}
+
+
+//verify cached block without allocating its decompressed copy: compress() output = 8-byte uncompressed size + zlib stream
+bool decompressedEquals(const std::string& compressed, const std::string& raw) //throw SysError
+{
+    if (compressed.empty() || raw.empty()) //compress() maps empty -> empty container
+        return compressed.empty() && raw.empty();
+
+    MemoryStreamIn<std::string_view> streamIn(compressed);
+    if (readNumber<uint64_t>(streamIn) != raw.size()) //throw SysErrorUnexpectedEos
+        return false;
+
+    InputStreamFromZlib zlibStream([&](void* buffer, size_t bytesToRead) { return streamIn.read(buffer, bytesToRead); }); //throw SysError
+
+    std::string buf(std::min<size_t>(raw.size(), 64 * 1024), '\0');
+    for (size_t pos = 0; pos < raw.size();)
+    {
+        const size_t bytesRead = zlibStream.read(buf.data(), std::min(buf.size(), raw.size() - pos)); //throw SysError
+        if (bytesRead == 0 || raw.compare(pos, bytesRead, buf.data(), bytesRead) != 0)
+            return false;
+        pos += bytesRead;
+    }
+    return true;
+}
+
+using DbBlockThreadGroup = ThreadGroup<std::function<void()>>;
+
+
+/*  stream layout since v6: blocks compressed independently => compress and parse in parallel + reuse blocks that did not change
+        root block: files and symlinks of the base folder + names of the top-level folders
+        block list: content of consecutive top-level folders                                     */
 class StreamGenerator
 {
 public:
     static void execute(const InSyncFolder& dbFolder, //throw FileError
                         const std::wstring& displayFilePathL, //used for diagnostics only
                         const std::wstring& displayFilePathR,
+                        const DbBlockCache& blockCache,
                         std::string& streamL,
                         std::string& streamR)
     {
@@ -200,43 +489,71 @@ public:
         writeNumber<int32_t>(outL, DB_STREAM_VERSION);
         writeNumber<int32_t>(outR, DB_STREAM_VERSION);
 
-        auto compStream = [&](const std::string& stream) //throw FileError
+        const size_t threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+        //serialize top-level folders in parallel: no state is shared between items => concatenating their streams yields the same block content
+        std::deque<StreamGenerator> folderGenerators(dbFolder.folders.size()); //MemoryStreamOut is not movable
+        std::deque<StreamGenerator> generators(1); //[0]: root block
+        //PERF_START
         {
-            try
-            {
-                /* Zlib: optimal level - test case 1 million files
-                level|size [MB]|time [ms]
-                  0    49.54      272 (uncompressed)
-                  1    14.53     1013
-                  2    14.13     1106
-                  3    13.76     1288 - best compromise between speed and compression
-                  4    13.20     1526
-                  5    12.73     1916
-                  6    12.58     2765
-                  7    12.54     3633
-                  8    12.51     9032
-                  9    12.50    19698 (maximal compression) */
-                return compress(stream, 3 /*level*/); //throw SysError
-            }
-            catch (const SysError& e)
+            DbBlockThreadGroup tg(std::min(threadCount, folderGenerators.size() + 1), Zstr("Serialize sync.ffs_db"));
+
+            tg.run([&] { generators[0].recurse(dbFolder, false /*recursive*/); });
+
+            size_t i = 0;
+            for (const auto& [itemName, inSyncData] : dbFolder.folders)
+                tg.run([&gen = folderGenerators[i++], &inSyncData = inSyncData] { gen.recurse(inSyncData); });
+            tg.wait();
+        }
+
+        //group consecutive top-level folders: same blocks as serializing sequentially => block cache still applies
+        std::vector<size_t> blockFolderCounts;
+        for (StreamGenerator& folderGen : folderGenerators)
+        {
+            if (blockFolderCounts.empty() || generators.back().getRawSize() >= DB_BLOCK_SIZE_MIN)
             {
-                throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayFilePathL + L"/" + displayFilePathR)), e.toString());
+                generators.emplace_back();
+                blockFolderCounts.push_back(0);
             }
-        };
-
-        StreamGenerator generator;
-        //PERF_START
-        generator.recurse(dbFolder);
+            generators.back().append(folderGen);
+            ++blockFolderCounts.back();
+        }
         //PERF_STOP
 
-        const std::string bufText     = compStream(generator.streamOutText_    .ref());
-        const std::string bufSmallNum = compStream(generator.streamOutSmallNum_.ref());
-        const std::string bufBigNum   = compStream(generator.streamOutBigNum_  .ref());
+        std::vector<std::string> blocks(generators.size());
+        std::vector<std::wstring> errorMsgs(generators.size());
+        {
+            DbBlockThreadGroup tg(std::min(threadCount, generators.size()), Zstr("Save sync.ffs_db"));
+
+            for (size_t i = 0; i < generators.size(); ++i)
+                tg.run([&, i]
+            {
+                try
+                {
+                    if (auto it = blockCache.find(generators[i].getBlockHash());
+                        it != blockCache.end() && generators[i].matchesCompressedBlock(it->second)) //throw SysError
+                        blocks[i] = it->second;
+                    else
+                        blocks[i] = generators[i].getCompressedBlock(); //throw SysError
+                }
+                catch (const SysError& e) { errorMsgs[i] = e.toString(); }
+            });
+            tg.wait();
+        }
+
+        for (const std::wstring& errorMsg : errorMsgs)
+            if (!errorMsg.empty())
+                throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(displayFilePathL + L"/" + displayFilePathR)), errorMsg);
 
         MemoryStreamOut<std::string> streamOut;
-        writeContainer(streamOut, bufText);
-        writeContainer(streamOut, bufSmallNum);
-        writeContainer(streamOut, bufBigNum);
+        writeContainer(streamOut, blocks[0]);
+
+        writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(blockFolderCounts.size()));
+        for (size_t i = 0; i < blockFolderCounts.size(); ++i)
+        {
+            writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(blockFolderCounts[i]));
+            writeContainer(streamOut, blocks[i + 1]);
+        }
 
         const std::string& buf = streamOut.ref();
 
@@ -255,7 +572,68 @@ public:
     }
 
 private:
-    void recurse(const InSyncFolder& container)
+    size_t getRawSize() const { return streamOutText_.ref().size() + streamOutSmallNum_.ref().size() + streamOutBigNum_.ref().size(); }
+
+    void append(StreamGenerator& other) //other is empty afterwards => free memory as soon as possible
+    {
+        auto appendStream = [](MemoryStreamOut<std::string>& streamOut, MemoryStreamOut<std::string>& otherOut)
+        {
+            if (streamOut.ref().empty())
+                streamOut.ref().swap(otherOut.ref());
+            else
+            {
+                streamOut.ref() += otherOut.ref();
+                std::string().swap(otherOut.ref());
+            }
+        };
+        appendStream(streamOutText_,     other.streamOutText_);
+        appendStream(streamOutSmallNum_, other.streamOutSmallNum_);
+        appendStream(streamOutBigNum_,   other.streamOutBigNum_);
+    }
+
+    uint64_t getBlockHash() const { return ::getBlockHash(streamOutText_.ref(), streamOutSmallNum_.ref(), streamOutBigNum_.ref()); }
+
+    bool matchesCompressedBlock(const std::string& compressedBlock) const //noexcept
+    {
+        try
+        {
+            MemoryStreamIn<std::string_view> streamIn(compressedBlock);
+            return decompressedEquals(readContainer<std::string>(streamIn), streamOutText_    .ref()) && //throw SysError, SysErrorUnexpectedEos
+                   decompressedEquals(readContainer<std::string>(streamIn), streamOutSmallNum_.ref()) && //
+                   decompressedEquals(readContainer<std::string>(streamIn), streamOutBigNum_  .ref());   //
+        }
+        catch (SysError&) { return false; } //just a cache
+    }
+
+    static std::string getBlock(const std::string& bufText, const std::string& bufSmallNum, const std::string& bufBigNum)
+    {
+        MemoryStreamOut<std::string> streamOut;
+        writeContainer(streamOut, bufText);
+        writeContainer(streamOut, bufSmallNum);
+        writeContainer(streamOut, bufBigNum);
+        return std::move(streamOut.ref());
+    }
+
+    std::string getCompressedBlock() const //throw SysError
+    {
+        /* Zlib: optimal level - test case 1 million files
+        level|size [MB]|time [ms]
+          0    49.54      272 (uncompressed)
+          1    14.53     1013
+          2    14.13     1106
+          3    13.76     1288 - best compromise between speed and compression
+          4    13.20     1526
+          5    12.73     1916
+          6    12.58     2765
+          7    12.54     3633
+          8    12.51     9032
+          9    12.50    19698 (maximal compression) */
+        return getBlock(compress(streamOutText_    .ref(), 3 /*level*/),  //
+                        compress(streamOutSmallNum_.ref(), 3 /*level*/),  //throw SysError
+                        compress(streamOutBigNum_  .ref(), 3 /*level*/)); //
+    }
+
+    void recurse(const InSyncFolder& container, bool recursive = true)
     {
         writeNumber<uint32_t>(streamOutSmallNum_, static_cast<uint32_t>(container.files.size()));
         for (const auto& [itemName, inSyncData] : container.files)
@@ -284,7 +662,8 @@ private:
             writeItemName(itemName);
             writeNumber<int32_t>(streamOutSmallNum_, inSyncData.status);
 
-            recurse(inSyncData);
+            if (recursive)
+                recurse(inSyncData);
         }
     }
 
@@ -295,6 +674,12 @@ private:
         writeNumber<int64_t         >(streamOutBigNum_, descr.modTime);
         writeNumber<AFS::FingerPrint>(streamOutBigNum_, descr.filePrint);
         static_assert(sizeof(descr.modTime) <= sizeof(int64_t)); //ensure cross-platform compatibility!
+
+        //content hash is available for "compare by content" only => don't waste space otherwise
+        const bool haveHash = descr.contentHash != ContentHash{};
+        writeNumber<int8_t>(streamOutSmallNum_, haveHash);
+        if (haveHash)
+            writeArray(streamOutBigNum_, descr.contentHash.data(), descr.contentHash.size());
     }
 
     /* maximize zlib compression by grouping similar data (=> 20% size reduction!)
@@ -319,12 +704,13 @@ public:
                                            const std::string& streamL,
                                            const std::string& streamR,
                                            const std::wstring& displayFilePathL, //for diagnostics only
-                                           const std::wstring& displayFilePathR)
+                                           const std::wstring& displayFilePathR,
+                                           DbBlockCache* blockCache /*optional: v6+*/)
     {
         try
         {
-            MemoryStreamIn streamInL(streamL);
-            MemoryStreamIn streamInR(streamR);
+            MemoryStreamIn<std::string_view> streamInL(streamL);
+            MemoryStreamIn<std::string_view> streamInR(streamR);
 
             const int streamVersion  = readNumber<int32_t>(streamInL); //throw SysErrorUnexpectedEos
             const int streamVersionR = readNumber<int32_t>(streamInR); //
@@ -343,8 +729,8 @@ public:
                 if (has1stPartL != leadStreamLeft)
                     throw SysError(_("File content is corrupted.") + L" (has1stPartL != leadStreamLeft)");
 
-                MemoryStreamIn<std::string>& in1stPart = leadStreamLeft ? streamInL : streamInR;
-                MemoryStreamIn<std::string>& in2ndPart = leadStreamLeft ? streamInR : streamInL;
+                MemoryStreamIn<std::string_view>& in1stPart = leadStreamLeft ? streamInL : streamInR;
+                MemoryStreamIn<std::string_view>& in2ndPart = leadStreamLeft ? streamInR : streamInL;
 
                 const size_t size1stPart = static_cast<size_t>(readNumber<uint64_t>(in1stPart));
                 const size_t size2ndPart = static_cast<size_t>(readNumber<uint64_t>(in2ndPart));
@@ -356,18 +742,21 @@ public:
                 const std::string tmpL = readContainer<std::string>(streamInL);
                 const std::string tmpR = readContainer<std::string>(streamInR);
 
+                const std::string bufL = decompress(tmpL); //
+                const std::string bufR = decompress(tmpR); //throw SysError
+                const std::string bufB = decompress(tmpB); //
+
                 auto output = makeSharedRef<InSyncFolder>(InSyncFolder::DIR_STATUS_IN_SYNC);
-                StreamParserV2 parser(decompress(tmpL),  //
-                                      decompress(tmpR),  //throw SysError
-                                      decompress(tmpB)); //
+                StreamParserV2 parser(bufL, bufR, bufB);
                 parser.recurse(output.ref()); //throw SysError
                 return output;
             }
             else if (streamVersion == 3 || //TODO: remove migration code at some time! 2021-02-14
-                     streamVersion == DB_STREAM_VERSION)
+                     streamVersion == 4 || //TODO: remove migration code at some time! 2026-10-14
+                     streamVersion == 5)   //TODO: remove migration code at some time! 2026-10-14
             {
-                MemoryStreamIn<std::string>& streamInPart1 = leadStreamLeft ? streamInL : streamInR;
-                MemoryStreamIn<std::string>& streamInPart2 = leadStreamLeft ? streamInR : streamInL;
+                MemoryStreamIn<std::string_view>& streamInPart1 = leadStreamLeft ? streamInL : streamInR;
+                MemoryStreamIn<std::string_view>& streamInPart2 = leadStreamLeft ? streamInR : streamInL;
 
                 const size_t sizePart1 = static_cast<size_t>(readNumber<uint64_t>(streamInPart1));
                 const size_t sizePart2 = static_cast<size_t>(readNumber<uint64_t>(streamInPart2));
@@ -376,22 +765,47 @@ public:
                 if (sizePart1 > 0) readArray(streamInPart1, &buf[0],             sizePart1); //throw SysErrorUnexpectedEos
                 if (sizePart2 > 0) readArray(streamInPart2, &buf[0] + sizePart1, sizePart2); //
 
-                MemoryStreamIn streamIn(buf);
-                const std::string bufText     = readContainer<std::string>(streamIn); //
-                const std::string bufSmallNum = readContainer<std::string>(streamIn); //throw SysErrorUnexpectedEos
-                const std::string bufBigNum   = readContainer<std::string>(streamIn); //
+                MemoryStreamIn<std::string_view> streamIn(buf);
+                const std::string bufText     = decompress(readContainer<std::string>(streamIn)); //
+                const std::string bufSmallNum = decompress(readContainer<std::string>(streamIn)); //throw SysError, SysErrorUnexpectedEos
+                const std::string bufBigNum   = decompress(readContainer<std::string>(streamIn)); //
 
                 auto output = makeSharedRef<InSyncFolder>(InSyncFolder::DIR_STATUS_IN_SYNC);
-                StreamParser parser(streamVersion,
-                                    decompress(bufText),     //
-                                    decompress(bufSmallNum), //throw SysError
-                                    decompress(bufBigNum));  //
+                StreamParser parser(streamVersion, bufText, bufSmallNum, bufBigNum);
                 if (leadStreamLeft)
                     parser.recurse<SelectSide::left>(output.ref()); //throw SysError
                 else
                     parser.recurse<SelectSide::right>(output.ref()); //throw SysError
                 return output;
             }
+            else if (streamVersion == DB_STREAM_VERSION)
+            {
+                MemoryStreamIn<std::string_view>& streamInPart1 = leadStreamLeft ? streamInL : streamInR;
+                MemoryStreamIn<std::string_view>& streamInPart2 = leadStreamLeft ? streamInR : streamInL;
+
+                const size_t sizePart1 = static_cast<size_t>(readNumber<uint64_t>(streamInPart1));
+                const size_t sizePart2 = static_cast<size_t>(readNumber<uint64_t>(streamInPart2));
+
+                std::string buf(sizePart1 + sizePart2, '\0');
+                if (sizePart1 > 0) readArray(streamInPart1, &buf[0],             sizePart1); //throw SysErrorUnexpectedEos
+                if (sizePart2 > 0) readArray(streamInPart2, &buf[0] + sizePart1, sizePart2); //
+
+                MemoryStreamIn<std::string_view> streamIn(buf);
+                std::vector<std::pair<size_t /*top-level folder count*/, std::string /*compressed block*/>> blocks;
+
+                std::string rootBlock = readContainer<std::string>(streamIn); //throw SysErrorUnexpectedEos
+                size_t blockCount = readNumber<uint32_t>(streamIn);           //
+                while (blockCount-- != 0)
+                {
+                    const size_t folderCount = readNumber<uint32_t>(streamIn); //throw SysErrorUnexpectedEos
+                    blocks.emplace_back(folderCount, readContainer<std::string>(streamIn)); //
+                }
+                blocks.emplace(blocks.begin(), 0, std::move(rootBlock));
+
+                return leadStreamLeft ?
+                       parseBlocks<SelectSide::left >(streamVersion, blocks, blockCache) : //throw SysError
+                       parseBlocks<SelectSide::right>(streamVersion, blocks, blockCache);  //
+            }
             else
                 throw SysError(_("Unsupported data format.") + L' ' + replaceCpy(_("Version: %x"), L"%x", numberTo<std::wstring>(streamVersion)));
         }
@@ -402,14 +816,82 @@ public:
     }
 
 private:
-    StreamParser(int streamVersion, const std::string& bufText, const std::string& bufSmallNumbers, const std::string& bufBigNumbers) :
+    //blocks[0]: root block
+    template <SelectSide leadSide>
+    static SharedRef<InSyncFolder> parseBlocks(int streamVersion, const std::vector<std::pair<size_t, std::string>>& blocks, DbBlockCache* blockCache) //throw SysError
+    {
+        auto output = makeSharedRef<InSyncFolder>(InSyncFolder::DIR_STATUS_IN_SYNC);
+        std::vector<InSyncFolder*> topFolders;
+
+        std::vector<uint64_t> blockHashes(blocks.size());
+        std::vector<std::wstring> errorMsgs(blocks.size());
+
+        auto parseBlock = [&](size_t blockIdx, const std::function<void(StreamParser& parser)>& parseItems) //throw SysError
+        {
+            MemoryStreamIn<std::string_view> streamIn(blocks[blockIdx].second);
+            const std::string bufText     = decompress(readContainer<std::string>(streamIn)); //
+            const std::string bufSmallNum = decompress(readContainer<std::string>(streamIn)); //throw SysError, SysErrorUnexpectedEos
+            const std::string bufBigNum   = decompress(readContainer<std::string>(streamIn)); //
+
+            StreamParser parser(streamVersion, bufText, bufSmallNum, bufBigNum);
+            parseItems(parser); //throw SysError
+
+            if (blockCache)
+                blockHashes[blockIdx] = getBlockHash(bufText, bufSmallNum, bufBigNum);
+        };
+
+        parseBlock(0, [&](StreamParser& parser) { parser.recurse<leadSide>(output.ref(), &topFolders); }); //throw SysError
+
+        size_t folderCountTotal = 0;
+        for (size_t i = 1; i < blocks.size(); ++i)
+            folderCountTotal += blocks[i].first;
+        if (folderCountTotal != topFolders.size())
+            throw SysError(_("File content is corrupted.") + L" (invalid block list)");
+
+        //top-level folders are disjoint sub trees => parse in parallel
+        {
+            DbBlockThreadGroup tg(std::max<size_t>(std::min<size_t>(std::thread::hardware_concurrency(), blocks.size()), 1), Zstr("Load sync.ffs_db"));
+
+            size_t folderIdx = 0;
+            for (size_t i = 1; i < blocks.size(); ++i)
+            {
+                tg.run([&, i, folderFirst = folderIdx]
+                {
+                    try
+                    {
+                        parseBlock(i, [&](StreamParser& parser) //throw SysError
+                        {
+                            for (size_t j = folderFirst; j < folderFirst + blocks[i].first; ++j)
+                                parser.recurse<leadSide>(*topFolders[j]); //throw SysError
+                        });
+                    }
+                    catch (const SysError& e) { errorMsgs[i] = e.toString(); }
+                });
+                folderIdx += blocks[i].first;
+            }
+            tg.wait();
+        }
+
+        for (const std::wstring& errorMsg : errorMsgs)
+            if (!errorMsg.empty())
+                throw SysError(errorMsg);
+
+        if (blockCache)
+            for (size_t i = 0; i < blocks.size(); ++i)
+                blockCache->emplace(blockHashes[i], blocks[i].second);
+
+        return output;
+    }
+
+    StreamParser(int streamVersion, std::string_view bufText, std::string_view bufSmallNumbers, std::string_view bufBigNumbers) : //referenced, not copied!
         streamVersion_(streamVersion),
         streamInText_(bufText),
         streamInSmallNum_(bufSmallNumbers),
         streamInBigNum_(bufBigNumbers) {}
 
+    //topFolders: don't recurse, but return sub folders for parsing their content separately
     template <SelectSide leadSide>
-    void recurse(InSyncFolder& container) //throw SysError
+    void recurse(InSyncFolder& container, std::vector<InSyncFolder*>* topFolders = nullptr) //throw SysError
     {
         size_t fileCount = readNumber<uint32_t>(streamInSmallNum_); //throw SysErrorUnexpectedEos
         while (fileCount-- != 0)
@@ -447,7 +929,10 @@ private:
             const auto status = static_cast<InSyncFolder::InSyncStatus>(readNumber<int32_t>(streamInSmallNum_)); //
 
             InSyncFolder& dbFolder = container.addFolder(itemName, status);
-            recurse<leadSide>(dbFolder);
+            if (topFolders)
+                topFolders->push_back(&dbFolder);
+            else
+                recurse<leadSide>(dbFolder);
         }
     }
 
@@ -472,16 +957,21 @@ private:
         else
             filePrint = readNumber<AFS::FingerPrint>(streamInBigNum_); //throw SysErrorUnexpectedEos
 
-        return InSyncDescrFile(modTime, filePrint);
+        ContentHash contentHash{};
+        if (streamVersion_ >= 5)
+            if (readNumber<int8_t>(streamInSmallNum_) != 0) //throw SysErrorUnexpectedEos
+                readArray(streamInBigNum_, contentHash.data(), contentHash.size()); //
+
+        return InSyncDescrFile(modTime, filePrint, contentHash);
     }
 
     //TODO: remove migration code at some time! 2017-02-01
     class StreamParserV2
     {
     public:
-        StreamParserV2(const std::string& bufferL,
-                       const std::string& bufferR,
-                       const std::string& bufferB) :
+        StreamParserV2(std::string_view bufferL, //referenced, not copied!
+                       std::string_view bufferR, //
+                       std::string_view bufferB) :
             inputLeft_ (bufferL),
             inputRight_(bufferR),
             inputBoth_ (bufferB) {}
@@ -523,19 +1013,271 @@ private:
         }
 
     private:
-        MemoryStreamIn<std::string> inputLeft_;  //data related to one side only
-        MemoryStreamIn<std::string> inputRight_; //
-        MemoryStreamIn<std::string> inputBoth_;  //data concerning both sides
+        MemoryStreamIn<std::string_view> inputLeft_;  //data related to one side only
+        MemoryStreamIn<std::string_view> inputRight_; //
+        MemoryStreamIn<std::string_view> inputBoth_;  //data concerning both sides
     };
 
     const int streamVersion_;
-    MemoryStreamIn<std::string> streamInText_;     //
-    MemoryStreamIn<std::string> streamInSmallNum_; //data with bias to lead side
-    MemoryStreamIn<std::string> streamInBigNum_;   //
+    MemoryStreamIn<std::string_view> streamInText_;     //
+    MemoryStreamIn<std::string_view> streamInSmallNum_; //data with bias to lead side
+    MemoryStreamIn<std::string_view> streamInBigNum_;   //
 };
 
 //#######################################################################################################################################
 
+//journal: changes between two last synchronous states; lead side first like StreamGenerator
+class DeltaGenerator
+{
+public:
+    static std::string execute(const InSyncFolder& dbFolderOld, const InSyncFolder& dbFolderNew) //throw SysError
+    {
+        MemoryStreamOut<std::string> streamOut;
+        if (!recurse(dbFolderOld, dbFolderNew, streamOut))
+            return {}; //no changes
+
+        return compress(streamOut.ref(), 3 /*level*/); //throw SysError
+    }
+
+private:
+    //write nothing and return "false" if there are no changes
+    static bool recurse(const InSyncFolder& dbFolderOld, const InSyncFolder& dbFolderNew, MemoryStreamOut<std::string>& streamOut)
+    {
+        std::vector<const Zstring*> removedFiles, removedLinks, removedFolders;
+        std::vector<const InSyncFolder::FileList   ::value_type*> changedFiles;
+        std::vector<const InSyncFolder::SymlinkList::value_type*> changedLinks;
+        std::vector<std::pair<const InSyncFolder::FolderList::value_type*, std::string /*sub folder delta*/>> changedFolders;
+
+        getChanges(dbFolderOld.files,    dbFolderNew.files,    removedFiles, changedFiles);
+        getChanges(dbFolderOld.symlinks, dbFolderNew.symlinks, removedLinks, changedLinks);
+
+        for (const auto& [itemName, inSyncData] : dbFolderOld.folders)
+            if (!dbFolderNew.folders.contains(itemName))
+                removedFolders.push_back(&itemName);
+
+        for (const auto& item : dbFolderNew.folders)
+        {
+            const auto& [itemName, inSyncData] = item;
+            const auto itOld = dbFolderOld.folders.find(itemName);
+
+            MemoryStreamOut<std::string> subStreamOut;
+            const bool childrenChanged = itOld != dbFolderOld.folders.end() ?
+                                         recurse(itOld->second, inSyncData, subStreamOut) :
+                                         recurse(InSyncFolder(InSyncFolder::DIR_STATUS_STRAW_MAN), inSyncData, subStreamOut);
+
+            if (childrenChanged ||
+                itOld == dbFolderOld.folders.end() ||
+                itOld->first         != itemName || //Unicode normal form may differ
+                itOld->second.status != inSyncData.status)
+            {
+                if (!childrenChanged)
+                    writeEmptyDelta(subStreamOut);
+                changedFolders.emplace_back(&item, std::move(subStreamOut.ref()));
+            }
+        }
+
+        if (removedFiles.empty() && changedFiles.empty() &&
+            removedLinks.empty() && changedLinks.empty() &&
+            removedFolders.empty() && changedFolders.empty())
+            return false;
+
+        writeNames(streamOut, removedFiles);
+        writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(changedFiles.size()));
+        for (const auto* item : changedFiles)
+        {
+            const auto& [itemName, inSyncData] = *item;
+            writeContainer(streamOut, utfTo<std::string>(itemName));
+            writeNumber(streamOut, static_cast<int32_t>(inSyncData.cmpVar));
+            writeNumber<uint64_t>(streamOut, inSyncData.fileSize);
+            writeFileDescr(streamOut, inSyncData.left);
+            writeFileDescr(streamOut, inSyncData.right);
+        }
+
+        writeNames(streamOut, removedLinks);
+        writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(changedLinks.size()));
+        for (const auto* item : changedLinks)
+        {
+            const auto& [itemName, inSyncData] = *item;
+            writeContainer(streamOut, utfTo<std::string>(itemName));
+            writeNumber(streamOut, static_cast<int32_t>(inSyncData.cmpVar));
+            writeNumber<int64_t>(streamOut, inSyncData.left .modTime);
+            writeNumber<int64_t>(streamOut, inSyncData.right.modTime);
+        }
+
+        writeNames(streamOut, removedFolders);
+        writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(changedFolders.size()));
+        for (const auto& [item, subDelta] : changedFolders)
+        {
+            writeContainer(streamOut, utfTo<std::string>(item->first));
+            writeNumber<int32_t>(streamOut, item->second.status);
+            writeArray(streamOut, subDelta.c_str(), subDelta.size());
+        }
+        return true;
+    }
+
+    template <class ItemList>
+    static void getChanges(const ItemList& itemsOld, const ItemList& itemsNew, std::vector<const Zstring*>& removed, std::vector<const typename ItemList::value_type*>& changed)
+    {
+        for (const auto& [itemName, inSyncData] : itemsOld)
+            if (!itemsNew.contains(itemName))
+                removed.push_back(&itemName);
+
+        for (const auto& item : itemsNew)
+            if (const auto itOld = itemsOld.find(item.first);
+                itOld == itemsOld.end() ||
+                itOld->first  != item.first || //Unicode normal form may differ
+                itOld->second != item.second)
+                changed.push_back(&item);
+    }
+
+    static void writeNames(MemoryStreamOut<std::string>& streamOut, const std::vector<const Zstring*>& itemNames)
+    {
+        writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(itemNames.size()));
+        for (const Zstring* itemName : itemNames)
+            writeContainer(streamOut, utfTo<std::string>(*itemName));
+    }
+
+    static void writeEmptyDelta(MemoryStreamOut<std::string>& streamOut)
+    {
+        for (int i = 0; i < 6; ++i) //removed/changed files, symlinks, folders
+            writeNumber<uint32_t>(streamOut, 0);
+    }
+
+    static void writeFileDescr(MemoryStreamOut<std::string>& streamOut, const InSyncDescrFile& descr)
+    {
+        writeNumber<int64_t         >(streamOut, descr.modTime);
+        writeNumber<AFS::FingerPrint>(streamOut, descr.filePrint);
+
+        const bool haveHash = descr.contentHash != ContentHash{};
+        writeNumber<int8_t>(streamOut, haveHash);
+        if (haveHash)
+            writeArray(streamOut, descr.contentHash.data(), descr.contentHash.size());
+    }
+};
+
+
+class DeltaParser
+{
+public:
+    template <SelectSide leadSide>
+    static void execute(InSyncFolder& dbFolder, const std::string& rawDelta) //throw SysError
+    {
+        const std::string& delta = decompress(rawDelta); //throw SysError
+        MemoryStreamIn<std::string_view> streamIn(delta);
+        recurse<leadSide>(dbFolder, streamIn); //throw SysErrorUnexpectedEos
+    }
+
+private:
+    template <SelectSide leadSide>
+    static void recurse(InSyncFolder& dbFolder, MemoryStreamIn<std::string_view>& streamIn) //throw SysErrorUnexpectedEos
+    {
+        size_t removedCount = readNumber<uint32_t>(streamIn);
+        while (removedCount-- != 0)
+            dbFolder.files.erase(readItemName(streamIn));
+
+        size_t fileCount = readNumber<uint32_t>(streamIn);
+        while (fileCount-- != 0)
+        {
+            const Zstring itemName = readItemName(streamIn);
+            const auto cmpVar = static_cast<CompareVariant>(readNumber<int32_t>(streamIn));
+            const uint64_t fileSize = readNumber<uint64_t>(streamIn);
+            const InSyncDescrFile dataL = readFileDescr(streamIn);
+            const InSyncDescrFile dataT = readFileDescr(streamIn);
+
+            dbFolder.files.erase(itemName); //update item name, too
+            dbFolder.addFile(itemName,
+                             SelectParam<leadSide>::ref(dataL, dataT),
+                             SelectParam<leadSide>::ref(dataT, dataL), cmpVar, fileSize);
+        }
+
+        removedCount = readNumber<uint32_t>(streamIn);
+        while (removedCount-- != 0)
+            dbFolder.symlinks.erase(readItemName(streamIn));
+
+        size_t linkCount = readNumber<uint32_t>(streamIn);
+        while (linkCount-- != 0)
+        {
+            const Zstring itemName = readItemName(streamIn);
+            const auto cmpVar = static_cast<CompareVariant>(readNumber<int32_t>(streamIn));
+            const InSyncDescrLink dataL(readNumber<int64_t>(streamIn));
+            const InSyncDescrLink dataT(readNumber<int64_t>(streamIn));
+
+            dbFolder.symlinks.erase(itemName);
+            dbFolder.addSymlink(itemName,
+                                SelectParam<leadSide>::ref(dataL, dataT),
+                                SelectParam<leadSide>::ref(dataT, dataL), cmpVar);
+        }
+
+        removedCount = readNumber<uint32_t>(streamIn);
+        while (removedCount-- != 0)
+            dbFolder.folders.erase(readItemName(streamIn));
+
+        size_t folderCount = readNumber<uint32_t>(streamIn);
+        while (folderCount-- != 0)
+        {
+            const Zstring itemName = readItemName(streamIn);
+            const auto status = static_cast<InSyncFolder::InSyncStatus>(readNumber<int32_t>(streamIn));
+
+            auto it = dbFolder.folders.find(itemName);
+            if (it == dbFolder.folders.end())
+                it = dbFolder.folders.emplace(itemName, InSyncFolder(status)).first;
+            else if (it->first != itemName) //update item name, but keep child items
+            {
+                auto node = dbFolder.folders.extract(it);
+                node.key() = itemName;
+                it = dbFolder.folders.insert(std::move(node)).position;
+            }
+            it->second.status = status;
+
+            recurse<leadSide>(it->second, streamIn);
+        }
+    }
+
+    static Zstring readItemName(MemoryStreamIn<std::string_view>& streamIn) { return utfTo<Zstring>(readContainer<std::string>(streamIn)); } //throw SysErrorUnexpectedEos
+
+    static InSyncDescrFile readFileDescr(MemoryStreamIn<std::string_view>& streamIn) //throw SysErrorUnexpectedEos
+    {
+        const auto modTime   = readNumber<int64_t         >(streamIn);
+        const auto filePrint = readNumber<AFS::FingerPrint>(streamIn);
+
+        ContentHash contentHash{};
+        if (readNumber<int8_t>(streamIn) != 0)
+            readArray(streamIn, contentHash.data(), contentHash.size());
+
+        return InSyncDescrFile(modTime, filePrint, contentHash);
+    }
+};
+
+
+SharedRef<InSyncFolder> parseSession(const SessionData& sessionL, const SessionData& sessionR, //throw FileError
+                                     const std::wstring& displayFilePathL, //for diagnostics only
+                                     const std::wstring& displayFilePathR,
+                                     DbBlockCache* blockCache /*optional*/)
+{
+    SharedRef<InSyncFolder> lastSyncState = StreamParser::execute(sessionL.isLeadStream,
+                                                                  sessionL.rawStream,
+                                                                  sessionR.rawStream,
+                                                                  displayFilePathL,
+                                                                  displayFilePathR,
+                                                                  blockCache); //throw FileError
+    //apply journaled updates:
+    try
+    {
+        for (const std::string& rawDelta : (sessionL.isLeadStream ? sessionL : sessionR).rawDeltas)
+            if (sessionL.isLeadStream)
+                DeltaParser::execute<SelectSide::left>(lastSyncState.ref(), rawDelta); //throw SysError
+            else
+                DeltaParser::execute<SelectSide::right>(lastSyncState.ref(), rawDelta); //throw SysError
+    }
+    catch (const SysError& e)
+    {
+        throw FileError(replaceCpy(_("Cannot read database file %x."), L"%x", fmtPath(displayFilePathL) + L", " + fmtPath(displayFilePathR)), e.toString());
+    }
+    return lastSyncState;
+}
+
+//#######################################################################################################################################
+
 class LastSynchronousStateUpdater
 {
     /* 1. filter by file name does *not* create a new hierarchy, but merely gives a different *view* on the existing file hierarchy
@@ -578,9 +1320,11 @@ private:
                     //create or update new "in-sync" state
                     dbFiles.insert_or_assign(file.getItemNameAny(),
                                              InSyncFile(InSyncDescrFile(file.getLastWriteTime<SelectSide::left >(),
-                                                                        file.getFilePrint    <SelectSide::left >()),
+                                                                        file.getFilePrint    <SelectSide::left >(),
+                                                                        file.getContentHash  <SelectSide::left >()),
                                                         InSyncDescrFile(file.getLastWriteTime<SelectSide::right>(),
-                                                                        file.getFilePrint    <SelectSide::right>()),
+                                                                        file.getFilePrint    <SelectSide::right>(),
+                                                                        file.getContentHash  <SelectSide::right>()),
                                                         activeCmpVar_,
                                                         file.getFileSize<SelectSide::left>()));
                     toPreserve.insert(file.getItemNameAny());
@@ -766,20 +1510,35 @@ std::pair<DbStreams::const_iterator,
 
 //#######################################################################################################################################
 
-std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> fff::loadLastSynchronousState(const std::vector<const BaseFolderPair*>& baseFolders,
-                                                                      PhaseCallback& callback /*throw X*/) //throw X
+size_t fff::getMemoryUsage(const InSyncFolder& folder)
+{
+    const size_t MAP_NODE_OVERHEAD = 4 * sizeof(void*); //red-black tree: color + parent, left, right (libstdc++)
+
+    size_t bytes = (folder.files   .size() * (MAP_NODE_OVERHEAD + sizeof(InSyncFolder::FileList   ::value_type))) +
+                   (folder.symlinks.size() * (MAP_NODE_OVERHEAD + sizeof(InSyncFolder::SymlinkList::value_type))) +
+                   (folder.folders .size() * (MAP_NODE_OVERHEAD + sizeof(InSyncFolder::FolderList ::value_type)));
+
+    for (const auto& [fileName, file] : folder.files)
+        bytes += getHeapSize(fileName);
+    for (const auto& [linkName, symlink] : folder.symlinks)
+        bytes += getHeapSize(linkName);
+    for (const auto& [folderName, subFolder] : folder.folders)
+        bytes += getHeapSize(folderName) + getMemoryUsage(subFolder); //recurse
+    return bytes;
+}
+
+
+std::map<std::pair<AbstractPath, AbstractPath>, SharedRef<const InSyncFolder>> fff::loadLastSynchronousState(const std::vector<std::pair<AbstractPath, AbstractPath>>& baseFolderPaths,
+                                                                              const std::map<AfsDevice, size_t>& deviceParallelOps,
+                                                                              PhaseCallback& callback /*throw X*/) //throw X
 {
     std::set<AbstractPath> dbFilePaths;
 
-    for (const BaseFolderPair* baseFolder : baseFolders)
-        //avoid race condition with directory existence check: reading sync.ffs_db may succeed although first dir check had failed => conflicts!
-        if (baseFolder->getFolderStatus<SelectSide::left >() == BaseFolderStatus::existing &&
-            baseFolder->getFolderStatus<SelectSide::right>() == BaseFolderStatus::existing)
-        {
-            dbFilePaths.insert(getDatabaseFilePath<SelectSide::left >(*baseFolder));
-            dbFilePaths.insert(getDatabaseFilePath<SelectSide::right>(*baseFolder));
-        }
-    //else: ignore; there's no value in reporting it other than to confuse users
+    for (const auto& [folderPathL, folderPathR] : baseFolderPaths)
+    {
+        dbFilePaths.insert(getDatabaseFilePath(folderPathL));
+        dbFilePaths.insert(getDatabaseFilePath(folderPathR));
+    }
 
     std::map<AbstractPath, DbStreams> dbStreamsByPath;
     //------------ (try to) load DB files in parallel -------------------------
@@ -791,12 +1550,14 @@ std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> fff::lo
             parallelWorkload.emplace_back(dbPath, [&dbStreamsByPathShared](ParallelContext& ctx) //throw ThreadStopRequest
         {
             StreamStatusNotifier notifyLoad(replaceCpy(_("Loading file %x..."), L"%x", fmtPath(AFS::getDisplayPath(ctx.itemPath))), ctx.acb);
+            TraceSpan span("load db", [&] { return utfTo<std::string>(AFS::getDisplayPath(ctx.itemPath)); });
 
             tryReportingError([&] //throw ThreadStopRequest
             {
                 try
                 {
-                    DbStreams dbStreams = ::loadStreams(ctx.itemPath, notifyLoad); //throw FileError, FileErrorDatabaseNotExisting, ThreadStopRequest
+                    bool journalAware = false;
+                    DbStreams dbStreams = loadDbStreams(ctx.itemPath, journalAware, notifyLoad); //throw FileError, FileErrorDatabaseNotExisting, ThreadStopRequest
 
                     dbStreamsByPathShared.access([&](auto& dbStreamsByPath2) { dbStreamsByPath2.emplace(ctx.itemPath, std::move(dbStreams)); });
                 }
@@ -804,30 +1565,31 @@ std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> fff::lo
             }, ctx.acb);
         });
 
-        massParallelExecute(parallelWorkload,
+        massParallelExecute(parallelWorkload, deviceParallelOps,
                             Zstr("Load sync.ffs_db"), callback /*throw X*/); //throw X
     }
     //----------------------------------------------------------------
 
-    std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> output;
+    //------------ decompress + parse sessions in parallel -----------
+    std::vector<std::shared_ptr<const InSyncFolder>> lastSyncStates(baseFolderPaths.size());
+    std::vector<std::wstring> errorMsgs(baseFolderPaths.size());
+    {
+        DbBlockThreadGroup tg(std::max<size_t>(std::min<size_t>(std::thread::hardware_concurrency(), baseFolderPaths.size()), 1), Zstr("Parse sync.ffs_db"));
 
-    for (const BaseFolderPair* baseFolder : baseFolders)
-        if (baseFolder->getFolderStatus<SelectSide::left >() == BaseFolderStatus::existing &&
-            baseFolder->getFolderStatus<SelectSide::right>() == BaseFolderStatus::existing)
+        for (size_t i = 0; i < baseFolderPaths.size(); ++i)
         {
-            const AbstractPath dbPathL = getDatabaseFilePath<SelectSide::left >(*baseFolder);
-            const AbstractPath dbPathR = getDatabaseFilePath<SelectSide::right>(*baseFolder);
+            const AbstractPath dbPathL = getDatabaseFilePath(baseFolderPaths[i].first);
+            const AbstractPath dbPathR = getDatabaseFilePath(baseFolderPaths[i].second);
 
             auto itL = dbStreamsByPath.find(dbPathL);
             auto itR = dbStreamsByPath.find(dbPathR);
 
             if (itL != dbStreamsByPath.end() &&
                 itR != dbStreamsByPath.end())
+                tg.run([&, i, dbPathL, dbPathR, &streamsL = itL->second, &streamsR = itR->second]
+            {
                 try
                 {
-                    const DbStreams& streamsL = itL->second;
-                    const DbStreams& streamsR = itR->second;
-
                     //find associated session: there can be at most one session within intersection of left and right IDs
                     const auto [itStreamL, itStreamR] = findCommonSession(streamsL, streamsR,
                                                                           AFS::getDisplayPath(dbPathL),
@@ -835,23 +1597,70 @@ std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> fff::lo
                     if (itStreamL != streamsL.end())
                     {
                         assert(itStreamL->second.isLeadStream != itStreamR->second.isLeadStream);
-                        SharedRef<InSyncFolder> lastSyncState = StreamParser::execute(itStreamL->second.isLeadStream,
-                                                                                      itStreamL->second.rawStream,
-                                                                                      itStreamR->second.rawStream,
-                                                                                      AFS::getDisplayPath(dbPathL),
-                                                                                      AFS::getDisplayPath(dbPathR)); //throw FileError
-                        output.emplace(baseFolder, lastSyncState);
+                        lastSyncStates[i] = parseSession(itStreamL->second,
+                                                         itStreamR->second,
+                                                         AFS::getDisplayPath(dbPathL),
+                                                         AFS::getDisplayPath(dbPathR),
+                                                         nullptr /*blockCache*/).ptr(); //throw FileError
                     }
                 }
-                catch (const FileError& e) { callback.reportFatalError(e.toString()); } //throw X
+                catch (const FileError& e) { errorMsgs[i] = e.toString(); }
+            });
         }
+        tg.wait();
+    }
+    //----------------------------------------------------------------
+
+    std::map<std::pair<AbstractPath, AbstractPath>, SharedRef<const InSyncFolder>> output;
+
+    for (size_t i = 0; i < baseFolderPaths.size(); ++i)
+        if (!errorMsgs[i].empty())
+            callback.reportFatalError(errorMsgs[i]); //throw X
+        else if (lastSyncStates[i])
+            output.emplace(baseFolderPaths[i], SharedRef<const InSyncFolder>(lastSyncStates[i]));
+
+    if (metricsEnabled()) //estimate is O(items): only if requested
+    {
+        size_t bytes = 0;
+        for (const auto& [folderPaths, lastSyncState] : output)
+            bytes += getMemoryUsage(lastSyncState.ref());
+        setMemoryUsage("sync database", bytes);
+    }
+    return output;
+}
+
+
+std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> fff::loadLastSynchronousState(const std::vector<const BaseFolderPair*>& baseFolders,
+                                                                      const std::map<AfsDevice, size_t>& deviceParallelOps,
+                                                                      PhaseCallback& callback /*throw X*/) //throw X
+{
+    std::vector<std::pair<AbstractPath, AbstractPath>> baseFolderPaths;
+
+    for (const BaseFolderPair* baseFolder : baseFolders)
+        //avoid race condition with directory existence check: reading sync.ffs_db may succeed although first dir check had failed => conflicts!
+        if (baseFolder->getFolderStatus<SelectSide::left >() == BaseFolderStatus::existing &&
+            baseFolder->getFolderStatus<SelectSide::right>() == BaseFolderStatus::existing)
+            baseFolderPaths.emplace_back(baseFolder->getAbstractPath<SelectSide::left >(),
+                                         baseFolder->getAbstractPath<SelectSide::right>());
+    //else: ignore; there's no value in reporting it other than to confuse users
+
+    const std::map<std::pair<AbstractPath, AbstractPath>, SharedRef<const InSyncFolder>> lastSyncStates = loadLastSynchronousState(baseFolderPaths, deviceParallelOps, callback); //throw X
+
+    std::unordered_map<const BaseFolderPair*, SharedRef<const InSyncFolder>> output;
+
+    for (const BaseFolderPair* baseFolder : baseFolders)
+        if (auto it = lastSyncStates.find({baseFolder->getAbstractPath<SelectSide::left >(),
+                                           baseFolder->getAbstractPath<SelectSide::right>()});
+            it != lastSyncStates.end())
+            output.emplace(baseFolder, it->second);
 
     return output;
 }
 
 
 void fff::saveLastSynchronousState(const BaseFolderPair& baseFolder, bool transactionalCopy,
-                                   PhaseCallback& callback /*throw X*/) //throw X
+                                   const std::map<AfsDevice, size_t>& deviceParallelOps,
+                                   PhaseCallback& callback /*throw X*/, bool commitCheckpoints) //throw X
 {
     const AbstractPath dbPathL = getDatabaseFilePath<SelectSide::left >(baseFolder);
     const AbstractPath dbPathR = getDatabaseFilePath<SelectSide::right>(baseFolder);
@@ -859,29 +1668,32 @@ void fff::saveLastSynchronousState(const BaseFolderPair& baseFolder, bool transa
     //------------ (try to) load DB files in parallel -------------------------
     DbStreams streamsL; //list of session ID + DirInfo-stream
     DbStreams streamsR; //
+    bool journalAwareL = false;
+    bool journalAwareR = false;
     {
         bool loadSuccessL = false;
         bool loadSuccessR = false;
         std::vector<std::pair<AbstractPath, ParallelWorkItem>> parallelWorkload;
 
-        for (const auto& [dbPath, streamsOut, loadSuccess] :
+        for (const auto& [dbPath, streamsOut, journalAware, loadSuccess] :
              {
-                 std::tuple(dbPathL, &streamsL, &loadSuccessL),
-                 std::tuple(dbPathR, &streamsR, &loadSuccessR)
+                 std::tuple(dbPathL, &streamsL, &journalAwareL, &loadSuccessL),
+                 std::tuple(dbPathR, &streamsR, &journalAwareR, &loadSuccessR)
              })
-            parallelWorkload.emplace_back(dbPath, [&streamsOut = *streamsOut, &loadSuccess = *loadSuccess](ParallelContext& ctx) //throw ThreadStopRequest
+            parallelWorkload.emplace_back(dbPath, [&streamsOut = *streamsOut, &journalAware = *journalAware, &loadSuccess = *loadSuccess](ParallelContext& ctx) //throw ThreadStopRequest
         {
             StreamStatusNotifier notifyLoad(replaceCpy(_("Loading file %x..."), L"%x", fmtPath(AFS::getDisplayPath(ctx.itemPath))), ctx.acb);
+            TraceSpan span("load db", [&] { return utfTo<std::string>(AFS::getDisplayPath(ctx.itemPath)); });
 
             const std::wstring errMsg = tryReportingError([&] //throw ThreadStopRequest
             {
-                try { streamsOut = ::loadStreams(ctx.itemPath, notifyLoad); } //throw FileError, FileErrorDatabaseNotExisting, ThreadStopRequest
+                try { streamsOut = loadDbStreams(ctx.itemPath, journalAware, notifyLoad); } //throw FileError, FileErrorDatabaseNotExisting, ThreadStopRequest
                 catch (FileErrorDatabaseNotExisting&) {}
             }, ctx.acb);
             loadSuccess = errMsg.empty();
         });
 
-        massParallelExecute(parallelWorkload,
+        massParallelExecute(parallelWorkload, deviceParallelOps,
                             Zstr("Load sync.ffs_db"), callback /*throw X*/); //throw X
 
         if (!loadSuccessL || !loadSuccessR)
@@ -896,6 +1708,8 @@ void fff::saveLastSynchronousState(const BaseFolderPair& baseFolder, bool transa
     auto itStreamOldL = streamsL.cend();
     auto itStreamOldR = streamsR.cend();
     InSyncFolder lastSyncState(InSyncFolder::DIR_STATUS_IN_SYNC);
+    DbBlockCache blockCache;
+    bool parseError = false;
     try
     {
         //find associated session: there can be at most one session within intersection of left and right IDs
@@ -903,38 +1717,108 @@ void fff::saveLastSynchronousState(const BaseFolderPair& baseFolder, bool transa
                                                                  AFS::getDisplayPath(dbPathL),
                                                                  AFS::getDisplayPath(dbPathR)); //throw FileError
         if (itStreamOldL != streamsL.end())
-            lastSyncState = std::move(StreamParser::execute(itStreamOldL->second.isLeadStream /*leadStreamLeft*/,
-                                                            itStreamOldL->second.rawStream,
-                                                            itStreamOldR->second.rawStream,
-                                                            AFS::getDisplayPath(dbPathL),
-                                                            AFS::getDisplayPath(dbPathR)).ref()); //throw FileError
+            lastSyncState = std::move(parseSession(itStreamOldL->second,
+                                                   itStreamOldR->second,
+                                                   AFS::getDisplayPath(dbPathL),
+                                                   AFS::getDisplayPath(dbPathR),
+                                                   &blockCache).ref()); //throw FileError
     }
-    catch (const FileError& e) { callback.reportFatalError(e.toString()); } //throw X
+    catch (const FileError& e) { callback.reportFatalError(e.toString()); parseError = true; } //throw X
     //if database files are corrupted: just overwrite! User is already informed about errors right after comparing!
 
+    /* journaled update: write small delta instead of rewriting the database files
+        - only for database files written by a journal-aware version (v12+) => older versions fail instead of reading stale state
+        - left is lead stream in this context => no need for a right-lead delta generator
+        - compact after DB_JOURNAL_DELTAS_MAX updates or when deltas become too large    */
+    std::optional<InSyncFolder> lastSyncStateOld;
+    if (!parseError && itStreamOldL != streamsL.end() && itStreamOldL->second.isLeadStream &&
+        journalAwareL && journalAwareR &&
+        itStreamOldL->second.rawDeltas.size() < DB_JOURNAL_DELTAS_MAX)
+        lastSyncStateOld = lastSyncState;
+
     //update last synchrounous state
     LastSynchronousStateUpdater::execute(baseFolder, lastSyncState);
 
+    //changes after comparison are not part of lastSyncState => next incremental comparison starts from the checkpoint set during comparison
+    auto commitChangeCheckpoints = [&] //throw X
+    {
+        if (!commitCheckpoints)
+            return;
+
+        for (const SelectSide side : {SelectSide::left, SelectSide::right})
+            try
+            {
+                AFS::commitChangeCheckpoint(side == SelectSide::left ? baseFolder.getAbstractPath<SelectSide::left>() : baseFolder.getAbstractPath<SelectSide::right>(), //throw FileError
+                                            getChangeCheckpointId(baseFolder.getAbstractPath<SelectSide::left>(), baseFolder.getAbstractPath<SelectSide::right>(), side));
+            }
+            catch (const FileError& e) { callback.logInfo(e.toString()); } //not critical: old checkpoint still covers all changes
+    };
+
     //serialize again
     SessionData sessionDataL = {};
     SessionData sessionDataR = {};
-    sessionDataL.isLeadStream = true;
-    sessionDataR.isLeadStream = false;
 
-    if (const std::wstring errMsg = tryReportingError([&] //throw X
-{
-    StreamGenerator::execute(lastSyncState, //throw FileError
-                             AFS::getDisplayPath(dbPathL),
-                             AFS::getDisplayPath(dbPathR),
-                             sessionDataL.rawStream,
-                             sessionDataR.rawStream);
-    }, callback /*throw X*/); !errMsg.empty())
-    return;
-
-    //check if there is some work to do at all
-    if (itStreamOldL != streamsL.end() && itStreamOldL->second == sessionDataL &&
-        itStreamOldR != streamsR.end() && itStreamOldR->second == sessionDataR)
-        return; //some users monitor the *.ffs_db file with RTS => don't touch the file if it isnt't strictly needed
+    if (lastSyncStateOld)
+    {
+        std::string rawDelta;
+        if (const std::wstring errMsg = tryReportingError([&] //throw X
+    {
+        try
+        {
+            rawDelta = DeltaGenerator::execute(*lastSyncStateOld, lastSyncState); //throw SysError
+            }
+            catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(AFS::getDisplayPath(dbPathL) + L"/" + AFS::getDisplayPath(dbPathR))), e.toString()); }
+        }, callback /*throw X*/); !errMsg.empty())
+        return;
+
+        if (rawDelta.empty()) //no changes: some users monitor the *.ffs_db file with RTS => don't touch the file if it isnt't strictly needed
+        {
+            commitChangeCheckpoints(); //throw X
+            return;
+        }
+
+        SessionData& sessionOldL = streamsL.find(itStreamOldL->first)->second; //non-const: old session data is moved and erased below
+        SessionData& sessionOldR = streamsR.find(itStreamOldR->first)->second; //
+
+        size_t journalSize = rawDelta.size();
+        for (const std::string& rawDeltaOld : sessionOldL.rawDeltas)
+            journalSize += rawDeltaOld.size();
+
+        if (journalSize * DB_JOURNAL_SIZE_RATIO <= sessionOldL.rawStream.size() + sessionOldR.rawStream.size())
+        {
+            sessionDataL = std::move(sessionOldL);
+            sessionDataR = std::move(sessionOldR);
+            if (sessionDataL.baseSessionID.empty()) sessionDataL.baseSessionID = itStreamOldL->first;
+            if (sessionDataR.baseSessionID.empty()) sessionDataR.baseSessionID = itStreamOldR->first;
+            sessionDataL.rawDeltas.push_back(std::move(rawDelta));
+        }
+    }
+
+    const bool journaled = !sessionDataL.baseSessionID.empty();
+    if (!journaled)
+    {
+        sessionDataL.isLeadStream = true;
+        sessionDataR.isLeadStream = false;
+
+        if (const std::wstring errMsg = tryReportingError([&] //throw X
+    {
+        StreamGenerator::execute(lastSyncState, //throw FileError
+                                 AFS::getDisplayPath(dbPathL),
+                                 AFS::getDisplayPath(dbPathR),
+                                 blockCache,
+                                 sessionDataL.rawStream,
+                                 sessionDataR.rawStream);
+        }, callback /*throw X*/); !errMsg.empty())
+        return;
+
+        //check if there is some work to do at all
+        if (itStreamOldL != streamsL.end() && itStreamOldL->second == sessionDataL &&
+            itStreamOldR != streamsR.end() && itStreamOldR->second == sessionDataR) //some users monitor the *.ffs_db file with RTS => don't touch the file if it isnt't strictly needed
+        {
+            commitChangeCheckpoints(); //throw X
+            return;
+        }
+    }
 
     //erase old session data
     if (itStreamOldL != streamsL.end())
@@ -950,44 +1834,78 @@ void fff::saveLastSynchronousState(const BaseFolderPair& baseFolder, bool transa
 
     //------------ save DB files in parallel -------------------------
     {
+        bool saveSuccessL = false;
+        bool saveSuccessR = false;
         std::vector<std::pair<AbstractPath, ParallelWorkItem>> parallelWorkload;
 
-        for (const auto& [dbPath, streams] :
+        for (const auto& [dbPath, streams, saveSuccess] :
              {
-                 std::pair(dbPathL, &streamsL),
-                 std::pair(dbPathR, &streamsR)
+                 std::tuple(dbPathL, &streamsL, &saveSuccessL),
+                 std::tuple(dbPathR, &streamsR, &saveSuccessR)
              })
-            parallelWorkload.emplace_back(dbPath, [&streams = *streams, transactionalCopy](ParallelContext& ctx) //throw ThreadStopRequest
+            parallelWorkload.emplace_back(dbPath, [&streams = *streams, &saveSuccess = *saveSuccess, journaled, transactionalCopy](ParallelContext& ctx) //throw ThreadStopRequest
         {
-            tryReportingError([&] //throw ThreadStopRequest
+            saveSuccess = tryReportingError([&] //throw ThreadStopRequest
             {
-                StreamStatusNotifier notifySave(replaceCpy(_("Saving file %x..."), L"%x", fmtPath(AFS::getDisplayPath(ctx.itemPath))), ctx.acb);
-
-                if (transactionalCopy && !AFS::hasNativeTransactionalCopy(ctx.itemPath))
+                auto saveFile = [&](const AbstractPath& filePath, const std::function<void(const AbstractPath& filePathTmp, const IoCallback& notifyUnbufferedIO)>& writeFile) //throw FileError, ThreadStopRequest
                 {
-                    //write (temp-) files as a transaction
-                    const Zstring shortGuid = printNumber<Zstring>(Zstr("%04x"), static_cast<unsigned int>(getCrc16(generateGUID())));
-                    const AbstractPath dbPathTmp = AFS::appendRelPath(*AFS::getParentPath(ctx.itemPath), AFS::getItemName(ctx.itemPath) + Zstr('.') + shortGuid + AFS::TEMP_FILE_ENDING);
-
-                    saveStreams(streams, dbPathTmp, notifySave); //throw FileError, ThreadStopRequest
-                    ZEN_ON_SCOPE_FAIL(try { AFS::removeFilePlain(dbPathTmp); }
-                    catch (FileError&) {});
-
-                    //operation finished: rename temp file -> this should work (almost) transactionally:
-                    //if there were no write access, creation of temp file would have failed
-                    AFS::removeFileIfExists(ctx.itemPath);           //throw FileError
-                    AFS::moveAndRenameItem(dbPathTmp, ctx.itemPath); //throw FileError, (ErrorMoveUnsupported)
-                }
-                else //some MTP devices don't even allow renaming files: https://freefilesync.org/forum/viewtopic.php?t=6531
-                {
-                    AFS::removeFileIfExists(ctx.itemPath);          //throw FileError
-                    saveStreams(streams, ctx.itemPath, notifySave); //throw FileError, ThreadStopRequest
-                }
-            }, ctx.acb);
+                    StreamStatusNotifier notifySave(replaceCpy(_("Saving file %x..."), L"%x", fmtPath(AFS::getDisplayPath(filePath))), ctx.acb);
+                    TraceSpan span("save db", [&] { return utfTo<std::string>(AFS::getDisplayPath(filePath)); });
+
+                    if (transactionalCopy && !AFS::hasNativeTransactionalCopy(filePath))
+                    {
+                        //write (temp-) files as a transaction
+                        const Zstring shortGuid = printNumber<Zstring>(Zstr("%04x"), static_cast<unsigned int>(getCrc16(generateGUID())));
+                        const AbstractPath filePathTmp = AFS::appendRelPath(*AFS::getParentPath(filePath), AFS::getItemName(filePath) + Zstr('.') + shortGuid + AFS::TEMP_FILE_ENDING);
+
+                        writeFile(filePathTmp, notifySave); //throw FileError, ThreadStopRequest
+                        ZEN_ON_SCOPE_FAIL(try { AFS::removeFilePlain(filePathTmp); }
+                        catch (FileError&) {});
+
+                        //operation finished: rename temp file -> this should work (almost) transactionally:
+                        //if there were no write access, creation of temp file would have failed
+                        AFS::removeFileIfExists(filePath);             //throw FileError
+                        AFS::moveAndRenameItem(filePathTmp, filePath); //throw FileError, (ErrorMoveUnsupported)
+                    }
+                    else //some MTP devices don't even allow renaming files: https://freefilesync.org/forum/viewtopic.php?t=6531
+                    {
+                        AFS::removeFileIfExists(filePath);  //throw FileError
+                        writeFile(filePath, notifySave);    //throw FileError, ThreadStopRequest
+                    }
+                };
+
+                bool dbFileExisting = true;
+                const AbstractPath savePath = prepareDbSavePath(ctx.itemPath, dbFileExisting); //throw FileError
+
+                //database file first: journal entries of other sessions refer to it (while entries of the replaced session become stale)
+                if (!journaled || !dbFileExisting) //new catalog entry: journaled sessions need their base session
+                    saveFile(savePath, [&](const AbstractPath& filePath, const IoCallback& notifyUnbufferedIO) { saveStreams(streams, filePath, notifyUnbufferedIO); }); //throw FileError, ThreadStopRequest
+
+                const AbstractPath journalPath = getDatabaseJournalPath(savePath);
+                if (std::any_of(streams.begin(), streams.end(), [](const auto& v) { return !v.second.baseSessionID.empty(); }))
+                    saveFile(journalPath, [&](const AbstractPath& filePath, const IoCallback& notifyUnbufferedIO) { saveJournal(streams, filePath, notifyUnbufferedIO); }); //throw FileError, ThreadStopRequest
+                else
+                    AFS::removeFileIfExists(journalPath); //throw FileError
+            }, ctx.acb).empty();
         });
 
-        massParallelExecute(parallelWorkload,
+        massParallelExecute(parallelWorkload, deviceParallelOps,
                             Zstr("Save sync.ffs_db"), callback /*throw X*/); //throw X
+
+        if (saveSuccessL && saveSuccessR)
+            commitChangeCheckpoints(); //throw X
     }
     //----------------------------------------------------------------
 }
+
+
+void fff::setDatabaseCatalogFolder(const Zstring& folderPath)
+{
+    globalDbCatalogFolderPath.access([&](Zstring& folderPath2) { folderPath2 = folderPath; });
+}
+
+
+std::string fff::getChangeCheckpointId(const AbstractPath& folderPathL, const AbstractPath& folderPathR, SelectSide side)
+{
+    return utfTo<std::string>(AFS::getInitPathPhrase(folderPathL) + Zstr('|') + AFS::getInitPathPhrase(folderPathR)) + (side == SelectSide::left ? "|left" : "|right");
+}
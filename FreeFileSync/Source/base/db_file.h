@@ -19,12 +19,16 @@ const Zchar SYNC_DB_FILE_ENDING[] = Zstr(".ffs_db"); //don't use Zstring as glob
 
 struct InSyncDescrFile //subset of FileAttributes
 {
-    InSyncDescrFile(time_t modTimeIn, AFS::FingerPrint filePrintIn) :
+    InSyncDescrFile(time_t modTimeIn, AFS::FingerPrint filePrintIn, const ContentHash& contentHashIn = {}) :
         modTime(modTimeIn),
-        filePrint(filePrintIn) {}
+        filePrint(filePrintIn),
+        contentHash(contentHashIn) {}
 
     time_t modTime = 0;
     AFS::FingerPrint filePrint = 0; //optional!
+    ContentHash contentHash{}; //optional! valid for (fileSize, modTime, filePrint) of this side
+
+    bool operator==(const InSyncDescrFile&) const = default;
 };
 
 struct InSyncDescrLink
@@ -32,6 +36,8 @@ struct InSyncDescrLink
     explicit InSyncDescrLink(time_t modTimeIn) : modTime(modTimeIn) {}
 
     time_t modTime = 0;
+
+    bool operator==(const InSyncDescrLink&) const = default;
 };
 
 
@@ -43,6 +49,8 @@ struct InSyncFile
     InSyncDescrFile right; //
     CompareVariant cmpVar = CompareVariant::timeSize; //the one active while finding "file in sync"
     uint64_t fileSize = 0; //file size must be identical on both sides!
+
+    bool operator==(const InSyncFile&) const = default;
 };
 
 struct InSyncSymlink
@@ -51,6 +59,8 @@ struct InSyncSymlink
     InSyncDescrLink left;
     InSyncDescrLink right;
     CompareVariant cmpVar = CompareVariant::timeSize;
+
+    bool operator==(const InSyncSymlink&) const = default;
 };
 
 struct InSyncFolder
@@ -93,12 +103,30 @@ struct InSyncFolder
     }
 };
 
+size_t getMemoryUsage(const InSyncFolder& folder); //estimate (bytes), recursive
+
+
+//key: left/right base folder paths; only for existing base folders!
+std::map<std::pair<AbstractPath, AbstractPath>, zen::SharedRef<const InSyncFolder>> loadLastSynchronousState(const std::vector<std::pair<AbstractPath, AbstractPath>>& baseFolderPaths,
+                                                                                 const std::map<AfsDevice, size_t>& deviceParallelOps,
+                                                                                 PhaseCallback& callback /*throw X*/); //throw X
 
 std::unordered_map<const BaseFolderPair*, zen::SharedRef<const InSyncFolder>> loadLastSynchronousState(const std::vector<const BaseFolderPair*>& baseFolders,
+                                                                           const std::map<AfsDevice, size_t>& deviceParallelOps,
                                                                            PhaseCallback& callback /*throw X*/); //throw X
 
+
+//commits the change checkpoints of both base folders once the last synchronous state is saved, see AFS::getChangesSinceCheckpoint()
+//interim save during sync (commitCheckpoints == false): keep old checkpoint until final save => still covers all changes
 void saveLastSynchronousState(const BaseFolderPair& baseFolder, bool transactionalCopy, //throw X
-                              PhaseCallback& callback /*throw X*/);
+                              const std::map<AfsDevice, size_t>& deviceParallelOps,
+                              PhaseCallback& callback /*throw X*/, bool commitCheckpoints = true);
+
+//keep the databases of remote base folders in a local folder: only a small marker file in the remote folder; empty: disabled
+void setDatabaseCatalogFolder(const Zstring& folderPath);
+
+//incremental comparison: change checkpoint of one side of a folder pair, corresponding to its last synchronous state
+std::string getChangeCheckpointId(const AbstractPath& folderPathL, const AbstractPath& folderPathR, SelectSide side);
 }
 
 #endif //DB_FILE_H_834275398588021574
@@ -17,6 +17,8 @@ namespace fff
 {
 const int DEFAULT_FOLDER_ACCESS_TIME_OUT_SEC = 20; //consider CD-ROM insert or hard disk spin up time from sleep
 
+const int FOLDER_STATUS_DEFER_SEC = 2; //optional: don't let one slow device hold up all the others
+
 namespace
 {
 //directory existence checking may hang for non-existent network drives => run asynchronously and update UI!
@@ -27,11 +29,57 @@ struct FolderStatus
     std::set<AbstractPath> existing;
     std::set<AbstractPath> notExisting;
     std::map<AbstractPath, zen::FileError> failedChecks;
+
+    struct PendingCheck
+    {
+        std::shared_future<bool> ftIsExisting; //throw FileError
+        std::chrono::steady_clock::time_point timeoutTime;
+        int timeoutSec = 0;
+    };
+    std::map<AbstractPath, PendingCheck> pending; //deferSlowChecks: still running => see resolvePendingFolderStatus()
 };
 
 
+namespace impl
+{
+void evalFolderCheck(FolderStatus& output, const AbstractPath& folderPath, const std::shared_future<bool>& ftIsExisting,
+                     std::chrono::steady_clock::time_point waitUntil, const FolderStatus::PendingCheck* deferWith, int deviceTimeOutSec, PhaseCallback& procCallback /*throw X*/)
+{
+    using namespace zen;
+
+    const std::wstring& displayPathFmt = fmtPath(AFS::getDisplayPath(folderPath));
+
+    procCallback.updateStatus(replaceCpy(_("Searching for folder %x..."), L"%x", displayPathFmt)); //throw X
+
+    while (std::chrono::steady_clock::now() < waitUntil &&
+           ftIsExisting.wait_for(UI_UPDATE_INTERVAL / 2) == std::future_status::timeout)
+        procCallback.requestUiUpdate(); //throw X
+
+    if (ftIsExisting.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        if (deferWith)
+            output.pending.emplace(folderPath, *deferWith);
+        else
+            output.failedChecks.emplace(folderPath, FileError(replaceCpy(_("Timeout while searching for folder %x."), L"%x", displayPathFmt) +
+                                                              L" [" + _P("1 sec", "%x sec", deviceTimeOutSec) + L']'));
+    }
+    else
+        try
+        {
+            if (ftIsExisting.get()) //throw FileError
+                output.existing.emplace(folderPath);
+            else
+                output.notExisting.insert(folderPath);
+        }
+        catch (const FileError& e) { output.failedChecks.emplace(folderPath, e); }
+}
+}
+
+
+/*  deferSlowChecks: checks still running after FOLDER_STATUS_DEFER_SEC are returned as "pending" (until their device timeout)
+    => e.g. comparison: start traversing the devices that are ready, report failure for the slow ones per folder pair   */
 FolderStatus getFolderStatusNonBlocking(const std::set<AbstractPath>& folderPaths,
-                                        bool allowUserInteraction, PhaseCallback& procCallback /*throw X*/)
+                                        bool allowUserInteraction, PhaseCallback& procCallback /*throw X*/, bool deferSlowChecks = false)
 {
     using namespace zen;
 
@@ -42,7 +90,7 @@ FolderStatus getFolderStatusNonBlocking(const std::set<AbstractPath>& folderPath
         if (!AFS::isNullPath(folderPath)) //skip empty folders
             perDevicePaths[folderPath.afsDevice].insert(folderPath);
 
-    std::vector<std::pair<AbstractPath, std::future<bool>>> futureDetails;
+    std::vector<std::pair<AbstractPath, std::shared_future<bool>>> futureDetails;
 
     std::vector<ThreadGroup<std::packaged_task<bool()>>> perDeviceThreads;
     for (const auto& [afsDevice, deviceFolderPaths] : perDevicePaths)
@@ -52,6 +100,7 @@ FolderStatus getFolderStatusNonBlocking(const std::set<AbstractPath>& folderPath
         threadGroup.detach(); //don't wait on threads hanging longer than "folderAccessTimeout"
 
         //1. login to network share, connect with Google Drive, etc.
+        //=> session is kept by the device (e.g. Google Drive account, SFTP/FTP idle sessions, see AFS::prepareSessions()) and reused for traversal
         std::shared_future<void> ftAuth = runAsync([afsDevice /*clang bug*/= afsDevice, allowUserInteraction]
         { AFS::authenticateAccess(afsDevice, allowUserInteraction); /*throw FileError*/ });
 
@@ -73,7 +122,7 @@ FolderStatus getFolderStatusNonBlocking(const std::set<AbstractPath>& folderPath
                 return static_cast<bool>(AFS::itemStillExists(folderPath)); //throw FileError
                 //consider ItemType::file a failure instead? Meanwhile: return "false" IFF nothing (of any type) exists
             });
-            auto ftIsExisting = pt.get_future();
+            std::shared_future<bool> ftIsExisting = pt.get_future();
             threadGroup.run(std::move(pt));
 
             futureDetails.emplace_back(folderPath, std::move(ftIsExisting));
@@ -85,38 +134,35 @@ FolderStatus getFolderStatusNonBlocking(const std::set<AbstractPath>& folderPath
 
     FolderStatus output;
 
-    for (auto& [folderPath, ftIsExisting] : futureDetails)
+    for (const auto& [folderPath, ftIsExisting] : futureDetails)
     {
-        const std::wstring& displayPathFmt = fmtPath(AFS::getDisplayPath(folderPath));
-
-        procCallback.updateStatus(replaceCpy(_("Searching for folder %x..."), L"%x", displayPathFmt)); //throw X
-
         int deviceTimeOutSec = AFS::getAccessTimeout(folderPath); //0 if no timeout in force
         if (deviceTimeOutSec <= 0)
             deviceTimeOutSec = DEFAULT_FOLDER_ACCESS_TIME_OUT_SEC;
 
         const auto timeoutTime = startTime + std::chrono::seconds(deviceTimeOutSec);
 
-        while (std::chrono::steady_clock::now() < timeoutTime &&
-               ftIsExisting.wait_for(UI_UPDATE_INTERVAL / 2) == std::future_status::timeout)
-            procCallback.requestUiUpdate(); //throw X
-
-        if (!isReady(ftIsExisting))
-            output.failedChecks.emplace(folderPath, FileError(replaceCpy(_("Timeout while searching for folder %x."), L"%x", displayPathFmt) +
-                                                              L" [" + _P("1 sec", "%x sec", deviceTimeOutSec) + L']'));
+        if (deferSlowChecks && deviceTimeOutSec > FOLDER_STATUS_DEFER_SEC)
+        {
+            const FolderStatus::PendingCheck pc{ftIsExisting, timeoutTime, deviceTimeOutSec};
+            impl::evalFolderCheck(output, folderPath, ftIsExisting, startTime + std::chrono::seconds(FOLDER_STATUS_DEFER_SEC), &pc, deviceTimeOutSec, procCallback); //throw X
+        }
         else
-            try
-            {
-                //call future::get() only *once*! otherwise: undefined behavior!
-                if (ftIsExisting.get()) //throw FileError
-                    output.existing.emplace(folderPath);
-                else
-                    output.notExisting.insert(folderPath);
-            }
-            catch (const FileError& e) { output.failedChecks.emplace(folderPath, e); }
+            impl::evalFolderCheck(output, folderPath, ftIsExisting, timeoutTime, nullptr, deviceTimeOutSec, procCallback); //throw X
     }
     return output;
 }
+
+
+//wait for deferred checks: move results from "pending" to existing, notExisting, failedChecks
+void resolvePendingFolderStatus(FolderStatus& status, PhaseCallback& procCallback /*throw X*/)
+{
+    const std::map<AbstractPath, FolderStatus::PendingCheck> pending = std::move(status.pending);
+    status.pending.clear();
+
+    for (const auto& [folderPath, pc] : pending)
+        impl::evalFolderCheck(status, folderPath, pc.ftIsExisting, pc.timeoutTime, nullptr, pc.timeoutSec, procCallback); //throw X
+}
 }
 }
 
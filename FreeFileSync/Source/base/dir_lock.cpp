@@ -21,6 +21,8 @@
     #include <fcntl.h>  //open()
     #include <unistd.h> //close()
     #include <signal.h> //kill()
+    #include <sys/file.h> //flock()
+    #include <sys/vfs.h>  //fstatfs()
 
 using namespace zen;
 using namespace fff;
@@ -302,6 +304,32 @@ ProcessStatus getProcessStatus(const LockInformation& lockInfo) //throw FileErro
 }
 
 
+/*  fast path: the lock owner holds an advisory flock() on the lock file => waiting processes can tell immediately when it is released (or the owner crashed)
+    - flock() instead of fcntl(): POSIX record locks are dropped when *any* handle to the file is closed by the process (e.g. LifeSigns::emitLifeSign())
+    - network file systems: locks not reliably shared between clients (CIFS), or expensive round trips (NFS) => keep life sign protocol only     */
+bool supportsAdvisoryLock(int fd) //noexcept
+{
+    struct statfs info = {};
+    if (::fstatfs(fd, &info) != 0)
+        return false;
+
+    switch (info.f_type)
+    {
+        case 0x6969:     //NFS_SUPER_MAGIC
+        case 0x517B:     //SMB_SUPER_MAGIC
+        case 0xFF534D42: //CIFS_SUPER_MAGIC
+        case 0xFE534D42: //SMB2_SUPER_MAGIC
+        case 0x65735546: //FUSE_SUPER_MAGIC: e.g. sshfs
+        case 0x01021997: //V9FS_MAGIC
+        case 0x5346414F: //AFS_SUPER_MAGIC
+        case 0x73757245: //CODA_SUPER_MAGIC
+        case 0x00c36400: //CEPH_SUPER_MAGIC
+            return false;
+    }
+    return true;
+}
+
+
 DEFINE_NEW_FILE_ERROR(ErrorFileNotExisting)
 uint64_t getLockFileSize(const Zstring& filePath) //throw FileError, ErrorFileNotExisting
 {
@@ -345,6 +373,19 @@ void waitOnDirLock(const Zstring& lockFilePath, const DirLockCallback& notifySta
     catch (FileError&) {} //logfile may be only partly written -> this is no error!
     //------------------------------------------------------------------------------
 
+    int fdLockFile = lockOwnderDead ? -1 : ::open(lockFilePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fdLockFile == -1 && errno == ENOENT)
+        return; //what we are waiting for...
+    ZEN_ON_SCOPE_EXIT(if (fdLockFile != -1) ::close(fdLockFile));
+
+    if (fdLockFile != -1 && !supportsAdvisoryLock(fdLockFile))
+    {
+        ::close(fdLockFile);
+        fdLockFile = -1;
+    }
+    bool lockReleased = false; //advisory lock not (or no longer) held by lock owner
+    //------------------------------------------------------------------------------
+
     uint64_t fileSizeOld = 0;
     auto lastLifeSign = std::chrono::steady_clock::now();
 
@@ -357,6 +398,22 @@ void waitOnDirLock(const Zstring& lockFilePath, const DirLockCallback& notifySta
         }
         catch (ErrorFileNotExisting&) { return; } //what we are waiting for...
 
+        if (lockReleased) //but the lock file is still there: crashed owner or an owner not using advisory locks (e.g. older version)
+        {
+            try
+            {
+                const LockInformation& lockInfo = retrieveLockInfo(lockFilePath); //throw FileError
+                if (lockInfo.lockId == originalLockId &&
+                    getProcessStatus(lockInfo) == ProcessStatus::notRunning) //throw FileError
+                    lockOwnderDead = true;
+            }
+            catch (FileError&) {}
+
+            ::close(fdLockFile); //=> life sign protocol only
+            fdLockFile = -1;
+            lockReleased = false;
+        }
+
         const auto lastCheckTime = std::chrono::steady_clock::now();
 
         if (fileSizeNew != fileSizeOld) //received life sign from lock
@@ -404,6 +461,13 @@ void waitOnDirLock(const Zstring& lockFilePath, const DirLockCallback& notifySta
                 else
                     notifyStatus(std::wstring(infoMsg)); //throw X; emit a message in any case (might clear other one)
             }
+
+            if (fdLockFile != -1 && ::flock(fdLockFile, LOCK_SH | LOCK_NB) == 0)
+            {
+                ::flock(fdLockFile, LOCK_UN);
+                lockReleased = true;
+                break; //check lock file right now
+            }
             std::this_thread::sleep_for(cbInterval);
         }
     }
@@ -420,7 +484,8 @@ void releaseLock(const Zstring& lockFilePath) //noexcept
 }
 
 
-bool tryLock(const Zstring& lockFilePath) //throw FileError
+//returns advisory lock handle if supported, -1 otherwise; "no value" if lock file is already existing
+std::optional<int> tryLock(const Zstring& lockFilePath) //throw FileError
 {
     //important: we want the lock file to have exactly the permissions specified
     //=> yes, disabling umask() is messy (per-process!), but fchmod() may not be supported: https://freefilesync.org/forum/viewtopic.php?t=8096
@@ -436,10 +501,20 @@ bool tryLock(const Zstring& lockFilePath) //throw FileError
     if (hFile == -1)
     {
         if (errno == EEXIST)
-            return false;
+            return {};
 
         THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(lockFilePath)), "open");
     }
+
+    //lock before writing lock info: waiting processes must not see a lock file without advisory lock held by a running owner
+    int fdAdvisoryLock = supportsAdvisoryLock(hFile) ? ::dup(hFile) : -1; //same open file description => flock() survives closing hFile
+    if (fdAdvisoryLock != -1 && ::flock(fdAdvisoryLock, LOCK_EX | LOCK_NB) != 0)
+    {
+        ::close(fdAdvisoryLock);
+        fdAdvisoryLock = -1;
+    }
+    ZEN_ON_SCOPE_FAIL(if (fdAdvisoryLock != -1) ::close(fdAdvisoryLock));
+
     FileOutput fileOut(hFile, lockFilePath, nullptr /*notifyUnbufferedIO*/); //pass handle ownership
 
     //write housekeeping info: user, process info, lock GUID
@@ -447,7 +522,7 @@ bool tryLock(const Zstring& lockFilePath) //throw FileError
 
     fileOut.write(byteStream.c_str(), byteStream.size()); //throw FileError, (X)
     fileOut.finalize();                                   //
-    return true;
+    return fdAdvisoryLock;
 }
 }
 
@@ -460,10 +535,16 @@ public:
     {
         if (notifyStatus) notifyStatus(replaceCpy(_("Creating file %x"), L"%x", fmtPath(lockFilePath))); //throw X
 
-        while (!::tryLock(lockFilePath)) //throw FileError
+        for (;;)
         {
+            if (const std::optional<int> fdAdvisoryLock = ::tryLock(lockFilePath)) //throw FileError
+            {
+                fdAdvisoryLock_ = *fdAdvisoryLock;
+                break;
+            }
             ::waitOnDirLock(lockFilePath, notifyStatus, cbInterval); //throw FileError
         }
+        ZEN_ON_SCOPE_FAIL(if (fdAdvisoryLock_ != -1) ::close(fdAdvisoryLock_));
 
         lifeSignthread_ = InterruptibleThread(LifeSigns(lockFilePath));
     }
@@ -474,6 +555,9 @@ public:
         lifeSignthread_.join();
 
         ::releaseLock(lockFilePath_); //noexcept
+
+        if (fdAdvisoryLock_ != -1) //*after* deleting the lock file: wake up waiting processes
+            ::close(fdAdvisoryLock_);
     }
 
 private:
@@ -481,6 +565,7 @@ private:
     SharedDirLock& operator=(const DirLock&) = delete;
 
     const Zstring lockFilePath_;
+    int fdAdvisoryLock_ = -1; //optional
     InterruptibleThread lifeSignthread_;
 };
 
@@ -5,9 +5,11 @@
 // *****************************************************************************
 
 #include "file_hierarchy.h"
+#include <numeric>
 #include <zen/i18n.h>
 #include <zen/utf.h>
 #include <zen/file_error.h>
+#include <zen/thread.h>
 
 using namespace zen;
 using namespace fff;
@@ -55,6 +57,99 @@ std::wstring fff::getShortDisplayNameForFolderPair(const AbstractPath& itemPathL
 }
 
 
+namespace
+{
+//sort by upper-case name, then raw name; among equal raw names (traverser "retry") keep insertion order => stable
+template <class ItemList, class MergeDuplicate>
+void sortAndRemoveDuplicates(ItemList& items, std::vector<Zstring>& upperCaseNames, MergeDuplicate mergeDup /*(older item, newer item)*/)
+{
+    assert(items.size() == upperCaseNames.size());
+    if (items.empty())
+        return;
+
+    std::vector<size_t> order(items.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs)
+    {
+        if (upperCaseNames[lhs] != upperCaseNames[rhs])
+            return upperCaseNames[lhs] < upperCaseNames[rhs];
+
+        const Zstring& itemNameL = items[lhs].first;
+        const Zstring& itemNameR = items[rhs].first;
+        if (itemNameL != itemNameR)
+            return itemNameL < itemNameR;
+
+        return lhs < rhs;
+    });
+
+    ItemList output;
+    std::vector<Zstring> outputNames;
+    output     .reserve(items.size());
+    outputNames.reserve(items.size());
+    for (const size_t index : order)
+        if (!output.empty() && output.back().first == items[index].first) //duplicate
+            mergeDup(output.back(), items[index]);
+        else
+        {
+            output     .push_back(std::move(items[index]));
+            outputNames.push_back(std::move(upperCaseNames[index]));
+        }
+
+    items         .swap(output);
+    upperCaseNames.swap(outputNames);
+}
+}
+
+
+void FolderContainer::sortItems()
+{
+    auto replaceOlder = [](auto& older, auto& newer) { older = std::move(newer); };
+    sortAndRemoveDuplicates(files,    fileKeys,    replaceOlder);
+    sortAndRemoveDuplicates(symlinks, symlinkKeys, replaceOlder);
+
+    sortAndRemoveDuplicates(folders, folderKeys, [](FolderList::value_type& older, FolderList::value_type& newer)
+    {
+        //same folder traversed again: keep content from both traversals
+        FolderContainer& contOld = *older.second.second;
+        FolderContainer& contNew = *newer.second.second;
+        auto append = [](auto& target, auto& source) { std::move(source.begin(), source.end(), std::back_inserter(target)); };
+        append(contOld.files,       contNew.files);
+        append(contOld.symlinks,    contNew.symlinks);
+        append(contOld.folders,     contNew.folders);
+        append(contOld.fileKeys,    contNew.fileKeys);
+        append(contOld.symlinkKeys, contNew.symlinkKeys);
+        append(contOld.folderKeys,  contNew.folderKeys);
+        older.second.first = newer.second.first;
+    });
+
+    for (auto& [folderName, attrAndSub] : folders)
+        attrAndSub.second->sortItems(); //recurse
+}
+
+
+size_t FolderContainer::getMemoryUsage() const
+{
+    size_t bytes = files   .capacity() * sizeof(FileList   ::value_type) + (fileKeys   .capacity() + symlinkKeys.capacity() + folderKeys.capacity()) * sizeof(Zstring) +
+                   symlinks.capacity() * sizeof(SymlinkList::value_type) +
+                   folders .capacity() * sizeof(FolderList ::value_type);
+
+    auto addNames = [&](const auto& itemList, const std::vector<Zstring>& keys)
+    {
+        for (size_t i = 0; i < itemList.size(); ++i)
+            bytes += getHeapSize(itemList[i].first) +
+                     (keys[i].c_str() == itemList[i].first.c_str() ? 0 : getHeapSize(keys[i])); //ref-counted if already upper-case
+    };
+    addNames(files,    fileKeys);
+    addNames(symlinks, symlinkKeys);
+    addNames(folders,  folderKeys);
+
+    for (const auto& [folderName, attrAndSub] : folders)
+        bytes += sizeof(FolderContainer) + attrAndSub.second->getMemoryUsage(); //recurse
+    return bytes;
+}
+
+
 void ContainerObject::removeEmptyRec()
 {
     bool emptyExisting = false;
@@ -78,6 +173,70 @@ void ContainerObject::removeEmptyRec()
 }
 
 
+void BaseFolderPair::releaseObjectIdsRec(ContainerObject& conObj)
+{
+    for (FileSystemObject& file : conObj.refSubFiles())
+        file.releaseObjectId();
+    for (FileSystemObject& symlink : conObj.refSubLinks())
+        symlink.releaseObjectId();
+
+    for (FolderPair& folder : conObj.refSubFolders())
+    {
+        static_cast<FileSystemObject&>(folder).releaseObjectId();
+        releaseObjectIdsRec(folder); //recurse
+    }
+}
+
+
+size_t BaseFolderPair::getMemoryUsageRec(const ContainerObject& conObj)
+{
+    size_t bytes = conObj.getSyncOpTotalsBuffered() ? sizeof(SyncOpTotals) : 0;
+
+    auto addStrings = [&](const FileSystemObject& fsObj)
+    {
+        bytes += getHeapSize(fsObj.itemNameL_) +
+                 (fsObj.itemNameR_.c_str() == fsObj.itemNameL_.c_str() ? 0 : getHeapSize(fsObj.itemNameR_)) + //ref-counted if equal
+                 getHeapSize(fsObj.cmpResultDescr_) + getHeapSize(fsObj.syncDirectionConflict_); //shared between items: counted by each
+    };
+    for (const FilePair& file : conObj.refSubFiles())
+        addStrings(file);
+    for (const SymlinkPair& symlink : conObj.refSubLinks())
+        addStrings(symlink);
+
+    for (const FolderPair& folder : conObj.refSubFolders())
+    {
+        addStrings(folder);
+        bytes += getMemoryUsageRec(folder); //recurse
+    }
+    return bytes;
+}
+
+
+size_t BaseFolderPair::getMemoryUsage() const
+{
+    return sizeof(BaseFolderPair) + arena.getBytesAllocated() + getMemoryUsageRec(*this); //list nodes (= items) are allocated from the arena
+}
+
+
+size_t fff::getMemoryUsage(const FolderComparison& folderCmp)
+{
+    size_t bytes = FileSystemObject::getTableMemoryUsage() + folderCmp.capacity() * sizeof(FolderComparison::value_type);
+    for (const std::shared_ptr<BaseFolderPair>& baseFolder : folderCmp)
+        bytes += baseFolder->getMemoryUsage();
+    return bytes;
+}
+
+
+void BaseFolderPair::destroyAsync(BaseFolderPair* baseFolder)
+{
+    //same thread as all other object table accesses (main thread, or sync worker holding the lock):
+    releaseObjectIdsRec(*baseFolder); //a fraction of the destruction time: no deallocations
+
+    //references to the remaining members (filter, AFS) are atomic => safe on any thread
+    runAsync([baseFolder] { delete baseFolder; });
+}
+
+
 namespace
 {
 SyncOperation getIsolatedSyncOperation(bool itemExistsLeft,
@@ -9,14 +9,15 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include <memory>
 #include <list>
 #include <functional>
-#include <unordered_set>
 #include <zen/zstring.h>
 #include <zen/stl_tools.h>
 #include "structures.h"
 #include "path_filter.h"
+#include "binary.h"
 #include "../afs/abstract.h"
 
 
@@ -28,11 +29,13 @@ struct FileAttributes
     FileAttributes(time_t modTimeIn,
                    uint64_t fileSizeIn,
                    AFS::FingerPrint filePrintIn,
-                   bool followedSymlink) :
+                   bool followedSymlink,
+                   uint32_t linkCountIn = 0) :
         modTime(modTimeIn),
         fileSize(fileSizeIn),
         filePrint(filePrintIn),
-        isFollowedSymlink(followedSymlink)
+        isFollowedSymlink(followedSymlink),
+        linkCount(linkCountIn)
     {
         static_assert(std::is_signed_v<time_t>, "... and signed!");
     }
@@ -41,6 +44,7 @@ struct FileAttributes
     uint64_t fileSize = 0;
     AFS::FingerPrint filePrint = 0; //optional
     bool isFollowedSymlink = false;
+    uint32_t linkCount = 0; //optional: > 1 => hard link sharing filePrint with other items; not persisted, reset by setSyncedTo()
 
     std::strong_ordering operator<=>(const FileAttributes&) const = default;
 };
@@ -104,47 +108,54 @@ std::wstring getShortDisplayNameForFolderPair(const AbstractPath& itemPathL, con
 
 //------------------------------------------------------------------
 
+/* build-then-sort: traversal appends items (cheap, no tree node allocations), sortItems() once the folder is complete
+    => item order: upper-case name (= primary sort used by comparison's merge-join), then raw name
+    => sub folder containers are heap-allocated: stable addresses while traversal is still appending siblings
+    => match keys (upper-case names) are computed when adding an item, i.e. on the parallel scan threads, not during the merge  */
 struct FolderContainer
 {
     //------------------------------------------------------------------
-    using FolderList  = std::map<Zstring, std::pair<FolderAttributes, FolderContainer>>; //
-    using FileList    = std::map<Zstring, FileAttributes>; //key: raw file name, without any (Unicode) normalization, preserving original upper-/lower-case
-    using SymlinkList = std::map<Zstring, LinkAttributes>; //"Changing data [...] to NFC would cause interoperability problems. Always leave data as it is."
+    using FolderList  = std::vector<std::pair<Zstring, std::pair<FolderAttributes, std::unique_ptr<FolderContainer>>>>; //
+    using FileList    = std::vector<std::pair<Zstring, FileAttributes>>; //item name: raw file name, without any (Unicode) normalization, preserving original upper-/lower-case
+    using SymlinkList = std::vector<std::pair<Zstring, LinkAttributes>>; //"Changing data [...] to NFC would cause interoperability problems. Always leave data as it is."
     //------------------------------------------------------------------
 
     FolderContainer() = default;
     FolderContainer           (const FolderContainer&) = delete; //catch accidental (and unnecessary) copying
     FolderContainer& operator=(const FolderContainer&) = delete; //
+    FolderContainer(FolderContainer&&) = default; //hand over scan results, see parallelDeviceTraversal()
 
     FileList    files;
     SymlinkList symlinks; //non-followed symlinks
     FolderList  folders;
 
+    //same size and order as the item lists: upper-case item names
+    std::vector<Zstring> fileKeys;
+    std::vector<Zstring> symlinkKeys;
+    std::vector<Zstring> folderKeys;
+
+    //duplicate item names (e.g. during folder traverser "retry") are resolved by sortItems(): last one wins
     void addSubFile(const Zstring& itemName, const FileAttributes& attr)
     {
-        const auto [it, inserted] = files.emplace(itemName, attr);
-        if (!inserted) //update entry if already existing (e.g. during folder traverser "retry")
-            it->second = attr;
+        files.emplace_back(itemName, attr);
+        fileKeys.push_back(getUpperCase(itemName));
     }
 
     void addSubLink(const Zstring& itemName, const LinkAttributes& attr)
     {
-        const auto [it, inserted] = symlinks.emplace(itemName, attr);
-        if (!inserted)
-            it->second = attr;
+        symlinks.emplace_back(itemName, attr);
+        symlinkKeys.push_back(getUpperCase(itemName));
     }
 
     FolderContainer& addSubFolder(const Zstring& itemName, const FolderAttributes& attr)
     {
-        auto& p = folders[itemName]; //value default-construction is okay here
-        p.first = attr;
-        return p.second;
-
-        //const auto [it, inserted] = folders.emplace(itemName, std::pair<FolderAttributes, FolderContainer>(attr, FolderContainer()));
-        //if (!inserted)
-        //  it->second.first = attr;
-        //return it->second.second;
+        folderKeys.push_back(getUpperCase(itemName));
+        return *folders.emplace_back(itemName, std::pair(attr, std::make_unique<FolderContainer>())).second.second;
     }
+
+    void sortItems(); //recursive; call after traversal is complete
+
+    size_t getMemoryUsage() const; //estimate (bytes), recursive
 };
 
 class BaseFolderPair;
@@ -153,6 +164,66 @@ class FilePair;
 class SymlinkPair;
 class FileSystemObject;
 
+/* bump allocator for all items of one BaseFolderPair:
+    - avoid one heap allocation per FilePair/FolderPair/SymlinkPair (=> tens of millions for huge comparisons)
+    - memory is released in one go when the BaseFolderPair is destroyed
+    - deallocation is a no-op: items removed meanwhile (e.g. removeEmpty()) don't give back memory before  */
+class ObjectArena
+{
+public:
+    ObjectArena() {}
+
+    void* allocate(size_t bytes, size_t alignment)
+    {
+        assert(alignment <= alignof(std::max_align_t) && bytes > 0);
+        std::byte* const pos = pos_ + (alignment - reinterpret_cast<uintptr_t>(pos_) % alignment) % alignment;
+
+        if (pos + bytes > end_) //also for pos_ == nullptr
+        {
+            const size_t blockSize = std::max(bytes, BLOCK_SIZE);
+            blocks_.emplace_back(new std::byte[blockSize]); //aligned by max_align_t
+            bytesAllocated_ += blockSize;
+
+            pos_ = blocks_.back().get();
+            end_ = pos_ + blockSize;
+            return allocate(bytes, alignment);
+        }
+        pos_ = pos + bytes;
+        return pos;
+    }
+
+    size_t getBytesAllocated() const { return bytesAllocated_; } //memory accounting
+
+private:
+    ObjectArena           (const ObjectArena&) = delete;
+    ObjectArena& operator=(const ObjectArena&) = delete;
+
+    static constexpr size_t BLOCK_SIZE = 1024 * 1024;
+
+    std::vector<std::unique_ptr<std::byte[]>> blocks_;
+    std::byte* pos_ = nullptr; //
+    std::byte* end_ = nullptr; //of current block
+    size_t bytesAllocated_ = 0;
+};
+
+
+template <class T>
+struct ArenaAllocator
+{
+    using value_type = T;
+
+    explicit ArenaAllocator(ObjectArena& arena) : arena_(&arena) {}
+    template <class U> ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena_) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {} //memory is owned by the arena
+
+    template <class U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena_ == other.arena_; }
+
+    ObjectArena* arena_;
+};
+
 /*------------------------------------------------------------------
     inheritance diagram:
 
@@ -192,15 +263,34 @@ template <> inline Zstring PathInformation::getRelativePath<SelectSide::right>()
 
 //------------------------------------------------------------------
 
+struct SyncOpTotals //aggregated sync operations of a ContainerObject's sub items (recursively): evaluated by SyncStatistics
+{
+    int createLeft  = 0;
+    int createRight = 0;
+    int updateLeft  = 0;
+    int updateRight = 0;
+    int deleteLeft  = 0;
+    int deleteRight = 0;
+    int conflictCount = 0;
+    bool physicalDeleteLeft  = false;
+    bool physicalDeleteRight = false;
+
+    int64_t bytesToProcess = 0;
+    int64_t spaceNeededLeft  = 0; //may be negative
+    int64_t spaceNeededRight = 0; //
+    size_t rowsTotal = 0;
+};
+
+
 class ContainerObject : public virtual PathInformation
 {
     friend class FolderPair;
     friend class FileSystemObject;
 
 public:
-    using FileList    = std::list<FilePair>;    //MergeSides::execute() requires a structure that doesn't invalidate pointers after push_back()
-    using SymlinkList = std::list<SymlinkPair>; //
-    using FolderList  = std::list<FolderPair>;
+    using FileList    = std::list<FilePair,    ArenaAllocator<FilePair>>;    //MergeSides::execute() requires a structure that doesn't invalidate pointers after push_back()
+    using SymlinkList = std::list<SymlinkPair, ArenaAllocator<SymlinkPair>>; //
+    using FolderList  = std::list<FolderPair,  ArenaAllocator<FolderPair>>;  //nodes are allocated from BaseFolderPair's ObjectArena
 
     FolderPair& addSubFolder(const Zstring&          itemNameL,
                              const FolderAttributes& left,    //file exists on both sides
@@ -243,37 +333,45 @@ public:
 
     BaseFolderPair& getBase() { return base_; }
 
+    //buffer sync statistics: O(changed items) instead of O(tree) after setSyncDir()/setActive(); reset by notifySyncCfgChanged()
+    const SyncOpTotals* getSyncOpTotalsBuffered() const { return syncOpTotals_.get(); }
+    void setSyncOpTotalsBuffered(const SyncOpTotals& totals) const { syncOpTotals_ = std::make_unique<SyncOpTotals>(totals); }
+
+    void resetSyncCfgBufferedRec(); //required after FileSystemObject::suspendSyncCfgNotify()
+
 protected:
-    ContainerObject(BaseFolderPair& baseFolder) : //used during BaseFolderPair constructor
+    ContainerObject(BaseFolderPair& baseFolder, ObjectArena& arena) : //used during BaseFolderPair constructor
+        subFiles_  (ArenaAllocator<FilePair   >(arena)),
+        subLinks_  (ArenaAllocator<SymlinkPair>(arena)),
+        subFolders_(ArenaAllocator<FolderPair >(arena)),
         base_(baseFolder) {} //take reference only: baseFolder *not yet* fully constructed at this point!
 
     ContainerObject(const FileSystemObject& fsAlias); //used during FolderPair constructor
 
     virtual ~ContainerObject() {} //don't need polymorphic deletion, but we have a vtable anyway
 
-    virtual void flip();
+    //swap sides recursively; mirrorSyncDir: keep sync directions (left <-> right) instead of redetermining them afterwards
+    virtual void flip(bool mirrorSyncDir);
 
     void removeEmptyRec();
 
-    template <SelectSide side>
-    void updateRelPathsRecursion(const FileSystemObject& fsAlias);
+protected:
+    void flipItems(bool mirrorSyncDir); //files and symlinks only
+    static void flipFolder(FolderPair& folder, bool mirrorSyncDir);
 
 private:
     ContainerObject           (const ContainerObject&) = delete; //this class is referenced by its child elements => make it non-copyable/movable!
     ContainerObject& operator=(const ContainerObject&) = delete;
 
-    virtual void notifySyncCfgChanged() {}
+    virtual void notifySyncCfgChanged() { syncOpTotals_.reset(); }
 
-    Zstring getRelativePathL() const override { return relPathL_; }
-    Zstring getRelativePathR() const override { return relPathR_; }
+    mutable std::unique_ptr<SyncOpTotals> syncOpTotals_; //buffer only for larger sub trees: conserve memory!
+    //=> declare *before* the child lists: ~FilePair() notifies its move partner's parent, which may be a ContainerObject under destruction
 
     FileList    subFiles_;
     SymlinkList subLinks_;
     FolderList  subFolders_;
 
-    Zstring relPathL_; //path relative to base sync dir (without leading/trailing FILE_NAME_SEPARATOR)
-    Zstring relPathR_; //
-
     BaseFolderPair& base_;
 };
 
@@ -286,7 +384,13 @@ enum class BaseFolderStatus
     failure,
 };
 
-class BaseFolderPair : public ContainerObject //synchronization base directory
+struct ObjectArenaHolder //base-from-member: arena must outlive ContainerObject's child lists
+{
+    ObjectArena arena;
+};
+
+
+class BaseFolderPair final : private ObjectArenaHolder, public ContainerObject //synchronization base directory
 {
 public:
     BaseFolderPair(const AbstractPath& folderPathLeft,
@@ -297,7 +401,7 @@ public:
                    CompareVariant cmpVar,
                    int fileTimeTolerance,
                    const std::vector<unsigned int>& ignoreTimeShiftMinutes) :
-        ContainerObject(*this), //trust that ContainerObject knows that *this is not yet fully constructed!
+        ContainerObject(*this, ObjectArenaHolder::arena), //trust that ContainerObject knows that *this is not yet fully constructed!
         filter_(filter), cmpVar_(cmpVar), fileTimeTolerance_(fileTimeTolerance), ignoreTimeShiftMinutes_(ignoreTimeShiftMinutes),
         folderStatusLeft_ (folderStatusLeft),
         folderStatusRight_(folderStatusRight),
@@ -306,6 +410,9 @@ public:
 
     static void removeEmpty(BaseFolderPair& baseFolder) { baseFolder.removeEmptyRec(); } //physically remove all invalid entries (where both sides are empty) recursively
 
+    //static dispatch (shadows PathInformation::getAbstractPath()): hot when building item paths => no virtual call, no shared_ptr copy
+    template <SelectSide side> const AbstractPath& getAbstractPath() const { return side == SelectSide::left ? folderPathLeft_ : folderPathRight_; }
+
     template <SelectSide side> BaseFolderStatus getFolderStatus() const; //base folder status at the time of comparison!
     template <SelectSide side> void setFolderStatus(BaseFolderStatus value); //update after creating the directory in FFS
 
@@ -315,12 +422,27 @@ public:
     int  getFileTimeTolerance() const { return fileTimeTolerance_; }
     const std::vector<unsigned int>& getIgnoredTimeShift() const { return ignoreTimeShiftMinutes_; }
 
-    void flip() override;
+    void flip(bool mirrorSyncDir) override;
+    //parallel flip: flipBase() + flipSubFolder() for each sub folder (sub trees are independent)
+    void flipBase(bool mirrorSyncDir); //base folder and its files and symlinks only
+    static void flipSubFolder(FolderPair& folder, bool mirrorSyncDir) { flipFolder(folder, mirrorSyncDir); }
+
+    /* shared_ptr deleter: destroying millions of items takes seconds (e.g. GUI freezes on re-compare)
+        => release the object ids now (ObjectMgr's table is not thread-safe), then destroy the detached tree on a worker thread  */
+    static void destroyAsync(BaseFolderPair* baseFolder);
+
+    size_t getMemoryUsage() const; //estimate (bytes): item nodes (arena) + names + descriptions; excluding ObjectMgr's table
 
 private:
+    static void releaseObjectIdsRec(ContainerObject& conObj);
+    static size_t getMemoryUsageRec(const ContainerObject& conObj);
+
     AbstractPath getAbstractPathL() const override { return folderPathLeft_; }
     AbstractPath getAbstractPathR() const override { return folderPathRight_; }
 
+    Zstring getRelativePathL() const override { return {}; }
+    Zstring getRelativePathR() const override { return {}; }
+
     const FilterRef filter_; //filter used while scanning directory: represents sub-view of actual files!
     const CompareVariant cmpVar_;
     const int fileTimeTolerance_;
@@ -363,6 +485,8 @@ private:
 
 
 using FolderComparison = std::vector<std::shared_ptr<BaseFolderPair>>; //make sure pointers to sub-elements remain valid
+
+size_t getMemoryUsage(const FolderComparison& folderCmp); //estimate (bytes), including ObjectMgr's table
 //don't change this back to std::vector<BaseFolderPair> too easily: comparison uses push_back to add entries which may result in a full copy!
 
 DerefIter<typename FolderComparison::iterator,             BaseFolderPair> inline begin(      FolderComparison& vect) { return vect.begin(); }
@@ -380,35 +504,130 @@ struct FSObjectVisitor
 };
 
 
+template <class T> class ObjectMgr;
+
+//weak reference: slot in ObjectMgr's object table + generation (instead of raw pointer) => detect destroyed objects without a hash set lookup
+template <class T, bool isConst>
+class ObjectHandle
+{
+public:
+    ObjectHandle() {}
+    ObjectHandle(std::nullptr_t) {}
+
+    template <bool isConst2> requires (isConst && !isConst2) //ObjectId => ObjectIdConst
+    ObjectHandle(const ObjectHandle<T, isConst2>& other) : slot_(other.slot_), generation_(other.generation_) {}
+
+    explicit operator bool() const { return generation_ != 0; }
+
+    template <bool isConst2>
+    bool operator==(const ObjectHandle<T, isConst2>& other) const { return slot_ == other.slot_ && generation_ == other.generation_; }
+    bool operator==(std::nullptr_t) const { return generation_ == 0; }
+
+    struct Hash
+    {
+        size_t operator()(const ObjectHandle& id) const { return std::hash<uint64_t>()((static_cast<uint64_t>(id.generation_) << 32) | id.slot_); }
+    };
+
+private:
+    ObjectHandle(uint32_t slot, uint32_t generation) : slot_(slot), generation_(generation) {}
+
+    template <class, bool> friend class ObjectHandle;
+    friend class ObjectMgr<T>;
+
+    uint32_t slot_ = 0;
+    uint32_t generation_ = 0; //0: nullptr
+};
+
+
 //inherit from this class to allow safe random access by id instead of unsafe raw pointer
 //allow for similar semantics like std::weak_ptr without having to use std::shared_ptr
 template <class T>
 class ObjectMgr
 {
 public:
-    using ObjectId      =       ObjectMgr*;
-    using ObjectIdConst = const ObjectMgr*;
+    using ObjectId      = ObjectHandle<T, false>;
+    using ObjectIdConst = ObjectHandle<T, true>;
 
-    ObjectIdConst  getId() const { return this; }
-    /**/  ObjectId getId()       { return this; }
+    ObjectIdConst  getId() const { return {slot_, generation_}; }
+    /**/  ObjectId getId()       { return {slot_, generation_}; }
 
     static const T* retrieve(ObjectIdConst id) //returns nullptr if object is not valid anymore
     {
-        return static_cast<const T*>(activeObjects_.contains(id) ? id : nullptr);
+        if (id.slot_ < objectTable_.size())
+            if (const Slot& slot = objectTable_[id.slot_];
+                slot.generation == id.generation_)
+                return static_cast<const T*>(slot.obj);
+        return nullptr;
     }
     static T* retrieve(ObjectId id) { return const_cast<T*>(retrieve(static_cast<ObjectIdConst>(id))); }
 
+    static size_t getTableMemoryUsage() { return objectTable_.capacity() * sizeof(Slot); } //memory accounting
+
 protected:
-    ObjectMgr () { activeObjects_.insert(this); }
-    ~ObjectMgr() { activeObjects_.erase (this); }
+    ObjectMgr()
+    {
+        if (firstFreeSlot_ != NO_SLOT)
+        {
+            slot_ = firstFreeSlot_;
+            firstFreeSlot_ = objectTable_[slot_].nextFree;
+        }
+        else
+        {
+            slot_ = static_cast<uint32_t>(objectTable_.size());
+            objectTable_.emplace_back();
+        }
+        Slot& slot = objectTable_[slot_];
+        slot.obj = this;
+        generation_ = slot.generation;
+    }
+
+    ~ObjectMgr()
+    {
+        if (slot_ != NO_SLOT)
+            releaseSlot();
+    }
+
+    //invalidate id ahead of destruction: e.g. object destroyed on a worker thread => destructor must not access the (thread-unsafe) object table
+    void releaseId()
+    {
+        if (slot_ != NO_SLOT)
+        {
+            releaseSlot();
+            slot_ = NO_SLOT;
+        }
+    }
 
 private:
     ObjectMgr           (const ObjectMgr& rhs) = delete;
     ObjectMgr& operator=(const ObjectMgr& rhs) = delete; //it's not well-defined what copying an objects means regarding object-identity in this context
 
+    void releaseSlot()
+    {
+        Slot& slot = objectTable_[slot_];
+        assert(slot.obj == this);
+        slot.obj = nullptr;
+        if (++slot.generation == 0) //invalidate all ids referencing this slot
+            slot.generation = 1;     //0 is reserved for nullptr
+        slot.nextFree = firstFreeSlot_;
+        firstFreeSlot_ = slot_;
+    }
+
+    struct Slot
+    {
+        const ObjectMgr* obj = nullptr;
+        uint32_t generation = 1;
+        uint32_t nextFree = NO_SLOT; //only used while slot is free
+    };
+    static constexpr uint32_t NO_SLOT = std::numeric_limits<uint32_t>::max();
+
+    uint32_t slot_; //NO_SLOT: id released
+    uint32_t generation_;
+
     //our global ObjectMgr is not thread-safe (and currently does not need to be!)
     //assert(runningOnMainThread()); -> still, may be accessed by synchronization worker threads, one thread at a time
-    static inline std::unordered_set<const ObjectMgr*> activeObjects_; //external linkage!
+    //never shrinks: generations of freed slots must be kept to invalidate outstanding ids
+    static inline std::vector<Slot> objectTable_; //external linkage!
+    static inline uint32_t firstFreeSlot_ = NO_SLOT;
 };
 
 //------------------------------------------------------------------
@@ -425,6 +644,10 @@ public:
     Zstring getItemNameAny() const; //like getItemName() but without bias to which side is returned
     template <SelectSide side> Zstring getItemName() const; //case sensitive!
 
+    //static dispatch (shadows PathInformation's virtual accessors): same result, but inlinable in whole-tree passes
+    template <SelectSide side> AbstractPath getAbstractPath() const { return buildAbstractPath<side>(); }
+    template <SelectSide side> Zstring      getRelativePath() const { return buildRelativePath<side>(); }
+
     //comparison result
     CompareFileResult getCategory() const { return cmpResult_; }
     Zstringc getCatExtraDescription() const; //only filled if getCategory() == FILE_CONFLICT or FILE_DIFFERENT_METADATA
@@ -433,6 +656,7 @@ public:
     SyncDirection getSyncDir() const { return syncDir_; }
     void setSyncDir(SyncDirection newDir);
     void setSyncDirConflict(const Zstringc& description); //set syncDir = SyncDirection::none + fill conflict description
+    const Zstringc& getSyncDirConflict() const { return syncDirectionConflict_; } //empty if no conflict setting sync-direction
 
     bool isActive() const { return selectedForSync_; }
     void setActive(bool active);
@@ -444,6 +668,10 @@ public:
 
     template <SelectSide side> void removeObject(); //removes file or directory (recursively!) without physically removing the element: used by manual deletion
 
+    //bulk update of sync directions (current thread only): skip bottom-up notification, which costs O(folder depth) per item
+    //=> disjoint sub trees may be updated by multiple threads; call ContainerObject::resetSyncCfgBufferedRec() for the *whole* tree afterwards!
+    static void suspendSyncCfgNotify(bool suspend) { syncCfgNotifySuspended_ = suspend; }
+
     const ContainerObject& parent() const { return parent_; }
     /**/  ContainerObject& parent()       { return parent_; }
     const BaseFolderPair& base() const  { return parent_.getBase(); }
@@ -471,24 +699,32 @@ protected:
     virtual ~FileSystemObject() {} //don't need polymorphic deletion, but we have a vtable anyway
     //must not call parent here, it is already partially destroyed and nothing more than a pure ContainerObject!
 
-    virtual void flip();
-    virtual void notifySyncCfgChanged() { parent().notifySyncCfgChanged(); /*propagate!*/ }
+    virtual void flip(bool mirrorSyncDir);
+    virtual void notifySyncCfgChanged() { if (!syncCfgNotifySuspended_) parent().notifySyncCfgChanged(); /*propagate!*/ }
+    static bool syncCfgNotifySuspended() { return syncCfgNotifySuspended_; }
+
+    //tree is destroyed on a worker thread: drop everything referring to the global object table
+    virtual void releaseObjectId() { releaseId(); }
 
     void setSynced(const Zstring& itemName);
 
+    //relative paths are not stored, but built on demand from the item names along the parent chain (=> renames need no updates):
+    //append path relative to base folder to "buf" (adding FILE_NAME_SEPARATOR if needed) => single allocation
+    template <SelectSide side> void appendRelativePath(Zstring& buf) const;
+    template <SelectSide side> Zstring buildRelativePath() const { Zstring relPath; appendRelativePath<side>(relPath); return relPath; }
+
 private:
     FileSystemObject           (const FileSystemObject&) = delete;
     FileSystemObject& operator=(const FileSystemObject&) = delete;
 
-    AbstractPath getAbstractPathL() const override { return AFS::appendRelPath(base().getAbstractPath<SelectSide::left >(), getRelativePath<SelectSide::left >()); }
-    AbstractPath getAbstractPathR() const override { return AFS::appendRelPath(base().getAbstractPath<SelectSide::right>(), getRelativePath<SelectSide::right>()); }
+    AbstractPath getAbstractPathL() const override { return buildAbstractPath<SelectSide::left >(); }
+    AbstractPath getAbstractPathR() const override { return buildAbstractPath<SelectSide::right>(); }
+
+    template <SelectSide side> AbstractPath buildAbstractPath() const;
 
     virtual void removeObjectL() = 0;
     virtual void removeObjectR() = 0;
 
-    template <SelectSide side>
-    void propagateChangedItemName(const Zstring& itemNameOld); //required after any itemName changes
-
     //categorization
     Zstringc cmpResultDescr_; //only filled if getCategory() == FILE_CONFLICT or FILE_DIFFERENT_METADATA
     //conserve memory (avoid std::string SSO overhead + allow ref-counting!)
@@ -505,12 +741,16 @@ private:
     Zstring itemNameR_; //use as indicator: an empty name means: not existing on this side!
 
     ContainerObject& parent_;
+
+    static inline thread_local bool syncCfgNotifySuspended_ = false;
+
+    friend class BaseFolderPair; //releaseObjectIdsRec()
 };
 
 //------------------------------------------------------------------
 
 
-class FolderPair : public FileSystemObject, public ContainerObject
+class FolderPair final : public FileSystemObject, public ContainerObject
 {
     friend class ContainerObject;
 
@@ -538,11 +778,14 @@ public:
     void setSyncedTo(const Zstring& itemName, bool isSymlinkTrg, bool isSymlinkSrc); //call after sync, sets DIR_EQUAL
 
 private:
-    void flip         () override;
+    void flip(bool mirrorSyncDir) override;
     void removeObjectL() override;
     void removeObjectR() override;
     void notifySyncCfgChanged() override { syncOpBuffered_ = {}; FileSystemObject::notifySyncCfgChanged(); ContainerObject::notifySyncCfgChanged(); }
 
+    Zstring getRelativePathL() const override { return buildRelativePath<SelectSide::left >(); }
+    Zstring getRelativePathR() const override { return buildRelativePath<SelectSide::right>(); }
+
     mutable std::optional<SyncOperation> syncOpBuffered_; //determining sync-op for directory may be expensive as it depends on child-objects => buffer
 
     FolderAttributes attrL_;
@@ -552,7 +795,7 @@ private:
 
 //------------------------------------------------------------------
 
-class FilePair : public FileSystemObject
+class FilePair final : public FileSystemObject
 {
     friend class ContainerObject; //construction
 
@@ -569,14 +812,23 @@ public:
         attrL_(attrL),
         attrR_(attrR) {}
 
+    ~FilePair() { notifyMoveRef(); } //e.g. FolderPair child lists cleared during sync => move partner flips back to copy/delete
+
     template <SelectSide side> time_t       getLastWriteTime() const;
     template <SelectSide side> uint64_t          getFileSize() const;
     template <SelectSide side> bool        isFollowedSymlink() const;
     template <SelectSide side> FileAttributes  getAttributes() const;
     template <SelectSide side> AFS::FingerPrint getFilePrint() const;
+    template <SelectSide side> uint32_t        getLinkCount() const;
     template <SelectSide side> void clearFilePrint();
 
-    void setMoveRef(ObjectId refId) { moveFileRef_ = refId; } //reference to corresponding renamed file
+    template <SelectSide side> const ContentHash& getContentHash() const; //all zero if not available
+    void setContentHash(const ContentHash& hashL, const ContentHash& hashR) { contentHashL_ = hashL; contentHashR_ = hashR; }
+
+    uint64_t getEqualPrefix() const { return equalPrefix_; } //0 if not available
+    void setEqualPrefix(uint64_t byteCount) { equalPrefix_ = byteCount; }
+
+    void setMoveRef(ObjectId refId); //reference to corresponding renamed file
     ObjectId getMoveRef() const { return moveFileRef_; } //may be nullptr
 
     CompareFileResult getFileCategory() const;
@@ -595,24 +847,32 @@ public:
                      bool isSymlinkSrc);
 
 private:
-    Zstring getRelativePathL() const override { return nativeAppendPaths(parent().getRelativePath<SelectSide::left >(), getItemName<SelectSide::left >()); }
-    Zstring getRelativePathR() const override { return nativeAppendPaths(parent().getRelativePath<SelectSide::right>(), getItemName<SelectSide::right>()); }
+    Zstring getRelativePathL() const override { return buildRelativePath<SelectSide::left >(); }
+    Zstring getRelativePathR() const override { return buildRelativePath<SelectSide::right>(); }
 
     SyncOperation applyMoveOptimization(SyncOperation op) const;
+    void notifyMoveRef(); //move partner's sync operation depends on ours: see applyMoveOptimization()
 
-    void flip         () override;
-    void removeObjectL() override { attrL_ = FileAttributes(); }
-    void removeObjectR() override { attrR_ = FileAttributes(); }
+    void flip(bool mirrorSyncDir) override;
+    void notifySyncCfgChanged() override { notifyMoveRef(); FileSystemObject::notifySyncCfgChanged(); }
+    void releaseObjectId() override { moveFileRef_ = nullptr; /*=> ~FilePair() won't retrieve() the move partner*/ FileSystemObject::releaseObjectId(); }
+    void removeObjectL() override { attrL_ = FileAttributes(); contentHashL_ = {}; equalPrefix_ = 0; }
+    void removeObjectR() override { attrR_ = FileAttributes(); contentHashR_ = {}; equalPrefix_ = 0; }
 
     FileAttributes attrL_;
     FileAttributes attrR_;
 
+    ContentHash contentHashL_{}; //optional: set by "compare by content" for FILE_EQUAL, persisted in sync.ffs_db
+    ContentHash contentHashR_{}; //
+
+    uint64_t equalPrefix_ = 0; //optional: set by "compare by content" for FILE_DIFFERENT_CONTENT: leading bytes found equal on both sides
+
     ObjectId moveFileRef_ = nullptr; //optional, filled by redetermineSyncDirection()
 };
 
 //------------------------------------------------------------------
 
-class SymlinkPair : public FileSystemObject //this class models a TRUE symbolic link, i.e. one that is NEVER dereferenced: deref-links should be directly placed in class File/FolderPair
+class SymlinkPair final : public FileSystemObject //this class models a TRUE symbolic link, i.e. one that is NEVER dereferenced: deref-links should be directly placed in class File/FolderPair
 {
     friend class ContainerObject; //construction
 
@@ -639,10 +899,10 @@ public:
                      int64_t lastWriteTimeSrc);
 
 private:
-    Zstring getRelativePathL() const override { return nativeAppendPaths(parent().getRelativePath<SelectSide::left >(), getItemName<SelectSide::left >()); }
-    Zstring getRelativePathR() const override { return nativeAppendPaths(parent().getRelativePath<SelectSide::right>(), getItemName<SelectSide::right>()); }
+    Zstring getRelativePathL() const override { return buildRelativePath<SelectSide::left >(); }
+    Zstring getRelativePathR() const override { return buildRelativePath<SelectSide::right>(); }
 
-    void flip()          override;
+    void flip(bool mirrorSyncDir) override;
     void removeObjectL() override { attrL_ = LinkAttributes(); }
     void removeObjectR() override { attrR_ = LinkAttributes(); }
 
@@ -686,6 +946,23 @@ void visitFSObject(const FileSystemObject& fsObj, Function1 onFolder, Function2
 }
 
 
+//whole-tree passes: static dispatch over the concrete child lists => no virtual call or std::function per item, callbacks are inlined
+//order: files, symlinks, then each sub folder followed by its sub tree; Container: [const] ContainerObject
+template <class Container, class FunFolder, class FunFile, class FunSymlink> inline
+void visitSubTree(Container& conObj, FunFolder&& onFolder, FunFile&& onFile, FunSymlink&& onSymlink)
+{
+    for (auto& file : conObj.refSubFiles())
+        onFile(file);
+    for (auto& symlink : conObj.refSubLinks())
+        onSymlink(symlink);
+    for (auto& folder : conObj.refSubFolders())
+    {
+        onFolder(folder);
+        visitSubTree(folder, onFolder, onFile, onSymlink); //recurse
+    }
+}
+
+
 
 
 
@@ -808,44 +1085,32 @@ Zstring FileSystemObject::getItemNameAny() const
 template <> inline
 void FileSystemObject::removeObject<SelectSide::left>()
 {
-    const Zstring itemNameOld = getItemName<SelectSide::left>();
-
     cmpResult_ = isEmpty<SelectSide::right>() ? FILE_EQUAL : FILE_RIGHT_SIDE_ONLY;
     itemNameL_.clear();
     removeObjectL();
 
     setSyncDir(SyncDirection::none); //calls notifySyncCfgChanged()
-    propagateChangedItemName<SelectSide::left>(itemNameOld);
 }
 
 
 template <> inline
 void FileSystemObject::removeObject<SelectSide::right>()
 {
-    const Zstring itemNameOld = getItemName<SelectSide::right>();
-
     cmpResult_ = isEmpty<SelectSide::left>() ? FILE_EQUAL : FILE_LEFT_SIDE_ONLY;
     itemNameR_.clear();
     removeObjectR();
 
     setSyncDir(SyncDirection::none); //calls notifySyncCfgChanged()
-    propagateChangedItemName<SelectSide::right>(itemNameOld);
 }
 
 
 inline
 void FileSystemObject::setSynced(const Zstring& itemName)
 {
-    const Zstring itemNameOldL = getItemName<SelectSide::left>();
-    const Zstring itemNameOldR = getItemName<SelectSide::right>();
-
     assert(!isPairEmpty());
     itemNameR_ = itemNameL_ = itemName;
     cmpResult_ = FILE_EQUAL;
     setSyncDir(SyncDirection::none);
-
-    propagateChangedItemName<SelectSide::left >(itemNameOldL);
-    propagateChangedItemName<SelectSide::right>(itemNameOldR);
 }
 
 
@@ -876,10 +1141,20 @@ void FileSystemObject::setCategoryDiffMetadata(const Zstringc& description)
 }
 
 inline
-void FileSystemObject::flip()
+void FileSystemObject::flip(bool mirrorSyncDir)
 {
     std::swap(itemNameL_, itemNameR_);
 
+    if (mirrorSyncDir)
+        switch (syncDir_)
+        {
+            //*INDENT-OFF*
+            case SyncDirection::left:  syncDir_ = SyncDirection::right; break;
+            case SyncDirection::right: syncDir_ = SyncDirection::left;  break;
+            case SyncDirection::none: break; //conflict description: no orientation
+            //*INDENT-ON*
+        }
+
     switch (cmpResult_)
     {
         case FILE_LEFT_SIDE_ONLY:
@@ -906,56 +1181,100 @@ void FileSystemObject::flip()
 
 
 template <SelectSide side> inline
-void FileSystemObject::propagateChangedItemName(const Zstring& itemNameOld)
+void FileSystemObject::appendRelativePath(Zstring& buf) const
 {
-    if (itemNameL_.empty() && itemNameR_.empty()) return; //both sides might just have been deleted by removeObject<>
+    const ContainerObject& baseObj = base();
 
-    if (itemNameOld != getItemName<side>()) //perf: premature optimization?
-        if (auto hierObj = dynamic_cast<ContainerObject*>(this))
-            hierObj->updateRelPathsRecursion<side>(*this);
+    //measure first => fill back to front without reallocation
+    size_t relPathLen = 0;
+    for (const FileSystemObject* fsObj = this;;)
+    {
+        relPathLen += fsObj->getItemName<side>().size();
+        if (&fsObj->parent() == &baseObj)
+            break;
+        fsObj = &static_cast<const FolderPair&>(fsObj->parent());
+        ++relPathLen; //FILE_NAME_SEPARATOR
+    }
+
+    const size_t bufLenOld = buf.size();
+    const bool addSeparator = bufLenOld != 0 && !endsWith(buf, FILE_NAME_SEPARATOR);
+    buf.resize(bufLenOld + (addSeparator ? 1 : 0) + relPathLen);
+
+    auto it = buf.end();
+    for (const FileSystemObject* fsObj = this;;)
+    {
+        const Zstring& itemName = fsObj->getItemName<side>();
+        it -= itemName.size();
+        std::copy(itemName.begin(), itemName.end(), it);
+
+        if (&fsObj->parent() == &baseObj)
+            break;
+        fsObj = &static_cast<const FolderPair&>(fsObj->parent());
+        *--it = FILE_NAME_SEPARATOR;
+    }
+    if (addSeparator)
+        *--it = FILE_NAME_SEPARATOR;
+
+    assert(it == buf.begin() + bufLenOld);
 }
 
 
 template <SelectSide side> inline
-void ContainerObject::updateRelPathsRecursion(const FileSystemObject& fsAlias)
+AbstractPath FileSystemObject::buildAbstractPath() const
 {
-    assert(SelectParam<side>::ref(relPathL_, relPathR_) != //perf: only call if actual item name changed!
-           nativeAppendPaths(fsAlias.parent().getRelativePath<side>(), fsAlias.getItemName<side>()));
+    const AbstractPath& basePath = base().getAbstractPath<side>();
 
-    SelectParam<side>::ref(relPathL_, relPathR_) = nativeAppendPaths(fsAlias.parent().getRelativePath<side>(), fsAlias.getItemName<side>());
+    Zstring itemPath = basePath.afsPath.value; //same result as AFS::appendRelPath(), but without intermediate relative path
+    appendRelativePath<side>(itemPath);
+    return AbstractPath(basePath.afsDevice, AfsPath(std::move(itemPath)));
+}
+
+
+inline
+ContainerObject::ContainerObject(const FileSystemObject& fsAlias) :
+    subFiles_  (fsAlias.parent().subFiles_  .get_allocator()), //same arena for the whole hierarchy
+    subLinks_  (fsAlias.parent().subLinks_  .get_allocator()), //
+    subFolders_(fsAlias.parent().subFolders_.get_allocator()), //
+    base_(fsAlias.parent().base_) {}
+
+
+inline
+void ContainerObject::resetSyncCfgBufferedRec()
+{
+    syncOpTotals_.reset();
 
     for (FolderPair& folder : subFolders_)
-        folder.updateRelPathsRecursion<side>(folder);
+    {
+        folder.syncOpBuffered_ = {};
+        folder.resetSyncCfgBufferedRec(); //recurse
+    }
 }
 
 
 inline
-ContainerObject::ContainerObject(const FileSystemObject& fsAlias) :
-    relPathL_(nativeAppendPaths(fsAlias.parent().relPathL_, fsAlias.getItemName<SelectSide::left>())),
-    relPathR_(
-        fsAlias.parent().relPathL_.c_str() ==        //
-        fsAlias.parent().relPathR_.c_str() &&        //take advantage of FileSystemObject's Zstring reuse:
-        fsAlias.getItemName<SelectSide::left >().c_str() == //=> perf: 12% faster merge phase; -4% peak memory
-        fsAlias.getItemName<SelectSide::right>().c_str() ?  //
-        relPathL_ : //ternary-WTF! (implicit copy-constructor call!!) => no big deal for a Zstring
-        nativeAppendPaths(fsAlias.parent().relPathR_, fsAlias.getItemName<SelectSide::right>())),
-    base_(fsAlias.parent().base_)
-{
-    assert(relPathL_.c_str() == relPathR_.c_str() || relPathL_ != relPathR_);
+void ContainerObject::flip(bool mirrorSyncDir)
+{
+    flipItems(mirrorSyncDir);
+
+    for (FolderPair& folder : refSubFolders())
+        folder.flip(mirrorSyncDir);
 }
 
 
 inline
-void ContainerObject::flip()
+void ContainerObject::flipItems(bool mirrorSyncDir)
 {
     for (FilePair& file : refSubFiles())
-        file.flip();
+        file.flip(mirrorSyncDir);
     for (SymlinkPair& link : refSubLinks())
-        link.flip();
-    for (FolderPair& folder : refSubFolders())
-        folder.flip();
+        link.flip(mirrorSyncDir);
+}
 
-    std::swap(relPathL_, relPathR_);
+
+inline
+void ContainerObject::flipFolder(FolderPair& folder, bool mirrorSyncDir)
+{
+    folder.flip(mirrorSyncDir);
 }
 
 
@@ -1044,19 +1363,28 @@ SymlinkPair& ContainerObject::addSubLink<SelectSide::right>(const Zstring& itemN
 
 
 inline
-void BaseFolderPair::flip()
+void BaseFolderPair::flip(bool mirrorSyncDir)
+{
+    ContainerObject::flip(mirrorSyncDir);
+    std::swap(folderStatusLeft_, folderStatusRight_);
+    std::swap(folderPathLeft_,   folderPathRight_);
+}
+
+
+inline
+void BaseFolderPair::flipBase(bool mirrorSyncDir)
 {
-    ContainerObject::flip();
+    flipItems(mirrorSyncDir);
     std::swap(folderStatusLeft_, folderStatusRight_);
     std::swap(folderPathLeft_,   folderPathRight_);
 }
 
 
 inline
-void FolderPair::flip()
+void FolderPair::flip(bool mirrorSyncDir)
 {
-    ContainerObject ::flip(); //call base class versions
-    FileSystemObject::flip(); //
+    ContainerObject ::flip(mirrorSyncDir); //call base class versions
+    FileSystemObject::flip(mirrorSyncDir); //
     std::swap(attrL_, attrR_);
 }
 
@@ -1104,10 +1432,11 @@ void BaseFolderPair::setFolderStatus(BaseFolderStatus value)
 
 
 inline
-void FilePair::flip()
+void FilePair::flip(bool mirrorSyncDir)
 {
-    FileSystemObject::flip(); //call base class version
+    FileSystemObject::flip(mirrorSyncDir); //call base class version
     std::swap(attrL_, attrR_);
+    std::swap(contentHashL_, contentHashR_);
 }
 
 
@@ -1153,6 +1482,13 @@ AFS::FingerPrint FilePair::getFilePrint() const
 }
 
 
+template <SelectSide side> inline
+uint32_t FilePair::getLinkCount() const
+{
+    return SelectParam<side>::ref(attrL_, attrR_).linkCount;
+}
+
+
 template <SelectSide side> inline
 void FilePair::clearFilePrint()
 {
@@ -1160,6 +1496,31 @@ void FilePair::clearFilePrint()
 }
 
 
+template <SelectSide side> inline
+const ContentHash& FilePair::getContentHash() const
+{
+    return SelectParam<side>::ref(contentHashL_, contentHashR_);
+}
+
+
+inline
+void FilePair::setMoveRef(ObjectId refId)
+{
+    notifyMoveRef(); //old partner
+    moveFileRef_ = refId;
+    notifySyncCfgChanged();
+}
+
+
+inline
+void FilePair::notifyMoveRef()
+{
+    if (moveFileRef_ && !syncCfgNotifySuspended()) //partner may be in a sub tree updated by a different thread!
+        if (auto refFile = dynamic_cast<FilePair*>(FileSystemObject::retrieve(moveFileRef_)))
+            refFile->FileSystemObject::notifySyncCfgChanged(); //do *not* make a virtual call: endless recursion!
+}
+
+
 template <SelectSide sideTrg> inline
 void FilePair::setSyncedTo(const Zstring& itemName,
                            uint64_t fileSize,
@@ -1176,8 +1537,10 @@ void FilePair::setSyncedTo(const Zstring& itemName,
     SelectParam<sideTrg>::ref(attrL_, attrR_) = FileAttributes(lastWriteTimeTrg, fileSize, filePrintTrg, isSymlinkTrg);
     SelectParam<sideSrc>::ref(attrL_, attrR_) = FileAttributes(lastWriteTimeSrc, fileSize, filePrintSrc, isSymlinkSrc);
 
-    moveFileRef_ = nullptr;
+    contentHashL_ = contentHashR_ = {}; //not verified by content: don't let the next comparison skip it
+    equalPrefix_ = 0;
     FileSystemObject::setSynced(itemName); //set FileSystemObject specific part
+    moveFileRef_ = nullptr; //*after* setSynced(): move partner is notified via notifySyncCfgChanged()
 }
 
 
@@ -1224,9 +1587,9 @@ CompareSymlinkResult SymlinkPair::getLinkCategory() const
 
 
 inline
-void SymlinkPair::flip()
+void SymlinkPair::flip(bool mirrorSyncDir)
 {
-    FileSystemObject::flip(); //call base class versions
+    FileSystemObject::flip(mirrorSyncDir); //call base class versions
     std::swap(attrL_, attrR_);
 }
 }
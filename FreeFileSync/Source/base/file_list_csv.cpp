@@ -0,0 +1,194 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "file_list_csv.h"
+#include <clocale>
+#include <deque>
+#include <future>
+#include <zen/file_io.h>
+#include <zen/format_unit.h>
+#include <zen/thread.h>
+#include "cmp_columns.h"
+
+using namespace zen;
+using namespace fff;
+
+
+namespace
+{
+const size_t CSV_CHUNK_ROWS = 10'000; //rows formatted per worker thread task
+
+
+template <SelectSide side>
+void appendSideValues(std::string& buffer, const CsvFormatter& csv, const std::wstring& symlinkLabel,
+                      const ComparisonColumns& cols, size_t row, const FileSystemObject& fsObj)
+{
+    const char sep = csv.getSeparator();
+
+    if (!cols.isEmpty<side>(row))
+    {
+        csv.appendValue(buffer, AFS::getDisplayPath(fsObj.getAbstractPath<side>()));
+        buffer += sep;
+
+        switch (cols.getItemType(row))
+        {
+            case ComparisonColumns::ItemType::folder:
+                buffer += sep;
+                break;
+            case ComparisonColumns::ItemType::file:
+                csv.appendValue(buffer, formatNumber(cols.getFileSize<side>(row)));
+                buffer += sep;
+                csv.appendValue(buffer, formatUtcToLocalTime(cols.getLastWriteTime<side>(row)));
+                break;
+            case ComparisonColumns::ItemType::symlink:
+                csv.appendValue(buffer, symlinkLabel);
+                buffer += sep;
+                csv.appendValue(buffer, formatUtcToLocalTime(cols.getLastWriteTime<side>(row)));
+                break;
+        }
+    }
+    else
+    {
+        buffer += sep;
+        buffer += sep;
+    }
+}
+}
+
+
+CsvFormatter::CsvFormatter()
+{
+    const lconv* localInfo = ::localeconv(); //always bound according to doc
+    if (std::string(localInfo->decimal_point) == ",")
+        sep_ = ';';
+}
+
+
+void CsvFormatter::appendValue(std::string& buffer, const std::wstring& val) const
+{
+    const std::string& tmp = utfTo<std::string>(val);
+
+    if (std::any_of(tmp.begin(), tmp.end(), [&](char c) { return c == sep_ || c == '"' || c == '\n'; }))
+    {
+        buffer += '"';
+        buffer += replaceCpy(tmp, '"', "\"\"");
+        buffer += '"';
+    }
+    else
+        buffer += tmp;
+}
+
+
+void fff::writeCsvFile(const Zstring& csvFilePath, const std::string& header, size_t rowCount, const CsvRowFormatter& formatRow, PhaseCallback& callback) //throw FileError, X
+{
+    const std::wstring statusMsg = replaceCpy(_("Saving file %x..."), L"%x", fmtPath(csvFilePath));
+    auto reportProgress = [&](size_t rowsWritten) { callback.updateStatus(statusMsg + L' ' + formatNumber(rowsWritten) + L'/' + formatNumber(rowCount)); }; //throw X
+
+    reportProgress(0); //throw X
+
+    TempFileOutput fileOut(csvFilePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+    fileOut.write(header.data(), header.size()); //throw FileError, (X)
+
+    //keep all threads busy while the oldest chunk is written: bounded number of chunks in flight
+    const size_t threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    const size_t chunksInFlightMax = 2 * threadCount;
+
+    ThreadGroup<std::function<void()>> tg(threadCount, Zstr("CSV Export"));
+    std::deque<std::pair<size_t /*rows*/, std::future<std::string>>> chunksPending; //destroy *before* tg: running tasks reference nothing but formatRow and their own state
+
+    size_t rowsQueued  = 0;
+    size_t rowsWritten = 0;
+    for (;;)
+    {
+        while (chunksPending.size() < chunksInFlightMax && rowsQueued < rowCount)
+        {
+            const size_t rowFirst = rowsQueued;
+            const size_t rowLast  = std::min(rowFirst + CSV_CHUNK_ROWS, rowCount);
+            rowsQueued = rowLast;
+
+            auto task = std::make_shared<std::packaged_task<std::string()>>([&formatRow, rowFirst, rowLast]
+            {
+                std::string buffer;
+                for (size_t row = rowFirst; row < rowLast; ++row)
+                    formatRow(row, buffer);
+                return buffer;
+            });
+            chunksPending.emplace_back(rowLast - rowFirst, task->get_future());
+            tg.run([task] { (*task)(); }); //std::function doesn't support move-only types
+        }
+
+        if (chunksPending.empty())
+            break;
+
+        //fixed order: wait for the oldest chunk, no matter which ones are ready already
+        while (chunksPending.front().second.wait_for(UI_UPDATE_INTERVAL / 2) != std::future_status::ready)
+            callback.requestUiUpdate(); //throw X
+
+        const std::string& buffer = chunksPending.front().second.get();
+        fileOut.write(buffer.data(), buffer.size()); //throw FileError, (X)
+
+        rowsWritten += chunksPending.front().first;
+        chunksPending.pop_front();
+
+        reportProgress(rowsWritten); //throw X
+    }
+
+    fileOut.commit(); //throw FileError, (X)
+}
+
+
+void fff::writeFileListCsv(const Zstring& csvFilePath, const FolderComparison& folderCmp, PhaseCallback& callback) //throw FileError, X
+{
+    const CsvFormatter csv;
+    const char sep = csv.getSeparator();
+
+    std::string header;
+    header += BYTE_ORDER_MARK_UTF8;
+
+    csv.appendValue(header, _("Folder Pairs"));
+    header += LINE_BREAK;
+    for (const std::shared_ptr<BaseFolderPair>& baseFolder : folderCmp)
+    {
+        csv.appendValue(header, AFS::getDisplayPath(baseFolder->getAbstractPath<SelectSide::left >()));
+        header += sep;
+        csv.appendValue(header, AFS::getDisplayPath(baseFolder->getAbstractPath<SelectSide::right>()));
+        header += LINE_BREAK;
+    }
+    header += LINE_BREAK;
+
+    const std::wstring colLabels[] = {_("Full path"), _("Size"), _("Date"), _("Difference"), _("Action"), _("Full path"), _("Size"), _("Date")};
+    for (const std::wstring& label : colLabels)
+    {
+        if (&label != colLabels)
+            header += sep;
+        csv.appendValue(header, label);
+    }
+    header += LINE_BREAK;
+
+    //flat pre-order rows: same order as the tree
+    ComparisonColumns cols;
+    for (const std::shared_ptr<BaseFolderPair>& baseFolder : folderCmp)
+        cols.append(*baseFolder);
+
+    const std::wstring symlinkLabel = L'<' + _("Symlink") + L'>'; //translate once: not on worker threads
+
+    writeCsvFile(csvFilePath, header, cols.size(), [&](size_t row, std::string& buffer)
+    {
+        const FileSystemObject* fsObj = FileSystemObject::retrieve(cols.getObjectId(row));
+        assert(fsObj);
+        if (!fsObj)
+            return;
+
+        appendSideValues<SelectSide::left>(buffer, csv, symlinkLabel, cols, row, *fsObj);
+        buffer += sep;
+        csv.appendValue(buffer, getSymbol(cols.getCategory(row)));
+        buffer += sep;
+        csv.appendValue(buffer, getSymbol(cols.getSyncOperation(row)));
+        buffer += sep;
+        appendSideValues<SelectSide::right>(buffer, csv, symlinkLabel, cols, row, *fsObj);
+        buffer += LINE_BREAK;
+    }, callback); //throw FileError, X
+}
@@ -0,0 +1,49 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef FILE_LIST_CSV_H_8102937465012983746
+#define FILE_LIST_CSV_H_8102937465012983746
+
+#include <functional>
+#include <zen/file_error.h>
+#include "file_hierarchy.h"
+#include "process_callback.h"
+
+
+namespace fff
+{
+/*  export file lists as CSV: https://en.wikipedia.org/wiki/Comma-separated_values
+
+    - streaming: rows are formatted chunk by chunk and written to the (buffered) output file => memory bounded by the chunks in flight, not by the row count
+    - chunks are formatted in parallel on worker threads, but written in row order
+    - calling thread: file output + status updates => no extra GUI thread needed: StatusHandlerTemporaryPanel keeps the UI responsive and handles "cancel"  */
+class CsvFormatter
+{
+public:
+    CsvFormatter(); //separator depends on the locale: ';' if comma is the decimal separator
+
+    char getSeparator() const { return sep_; }
+
+    void appendValue(std::string& buffer, const std::wstring& val) const; //quoted if needed
+
+private:
+    char sep_ = ',';
+};
+
+
+//append one row including line break: called on worker threads => must be thread-safe (read-only access to the comparison result)!
+using CsvRowFormatter = std::function<void(size_t row, std::string& buffer)>;
+
+void writeCsvFile(const Zstring& csvFilePath,
+                  const std::string& header, //including BOM
+                  size_t rowCount, const CsvRowFormatter& formatRow,
+                  PhaseCallback& callback /*throw X*/); //throw FileError, X
+
+//headless: fixed columns (full path, size, date, difference, action) independent from any grid layout
+void writeFileListCsv(const Zstring& csvFilePath, const FolderComparison& folderCmp, PhaseCallback& callback /*throw X*/); //throw FileError, X
+}
+
+#endif //FILE_LIST_CSV_H_8102937465012983746
@@ -9,6 +9,8 @@
 #include <zen/file_error.h>
 //#include <zen/basic_math.h>
 #include <zen/thread.h>
+#include <zen/perf.h>
+#include <zen/process_priority.h>
 #include <zen/scope_guard.h>
 
 using namespace zen;
@@ -51,26 +53,32 @@ public:
     {
         assert(!runningOnMainThread());
         std::unique_lock dummy(lockRequest_);
-        interruptibleWait(conditionReadyForNewRequest_, dummy, [this] { return !errorRequest_ && !errorResponse_; }); //throw ThreadStopRequest
 
-        errorRequest_ = errorInfo;
-        conditionNewRequest.notify_all();
-
-        interruptibleWait(conditionHaveResponse_, dummy, [this] { return static_cast<bool>(errorResponse_); }); //throw ThreadStopRequest
+        //no waiting for other workers' errors: all pending requests are answered in one go by waitUntilDone()
+        errorRequests_.push_back({errorInfo, std::nullopt});
+        const auto itReq = std::prev(errorRequests_.end());
+        ZEN_ON_SCOPE_EXIT(errorRequests_.erase(itReq)); //also on ThreadStopRequest
 
-        AFS::TraverserCallback::HandleError rv = *errorResponse_;
+        conditionNewRequest.notify_all();
 
-        errorRequest_  = std::nullopt;
-        errorResponse_ = std::nullopt;
+        interruptibleWait(conditionHaveResponse_, dummy, [&] { return static_cast<bool>(itReq->response); }); //throw ThreadStopRequest
 
-        dummy.unlock(); //optimization for condition_variable::notify_all()
-        conditionReadyForNewRequest_.notify_all(); //instead of notify_one(); work around bug: https://svn.boost.org/trac/boost/ticket/7796
+        return *itReq->response;
+    }
 
-        return rv;
+    //context of worker thread: folder values of this device won't be touched by the worker anymore
+    void notifyFoldersDone(const std::vector<DirectoryKey>& folderKeys)
+    {
+        {
+            std::lock_guard dummy(lockRequest_);
+            append(foldersDone_, folderKeys);
+        }
+        conditionNewRequest.notify_all();
     }
 
     //context of main thread
-    void waitUntilDone(std::chrono::milliseconds duration, const TravErrorCb& onError, const TravStatusCb& onStatusUpdate) //throw X
+    void waitUntilDone(std::chrono::milliseconds duration, const TravErrorCb& onError, const TravStatusCb& onStatusUpdate, //throw X
+                       const std::function<void(const DirectoryKey& folderKey)>& onFolderDone /*throw X; optional*/)
     {
         assert(runningOnMainThread());
         for (;;)
@@ -79,25 +87,30 @@ public:
 
             for (std::unique_lock dummy(lockRequest_) ;;) //process all errors without delay
             {
-                const bool rv = conditionNewRequest.wait_until(dummy, callbackTime, [this] { return (errorRequest_ && !errorResponse_) || (threadsToFinish_ == 0); });
+                auto haveNewRequest = [this] { return std::any_of(errorRequests_.begin(), errorRequests_.end(), [](const ErrorRequest& req) { return !req.response; }); };
+
+                const bool rv = conditionNewRequest.wait_until(dummy, callbackTime, [&] { return haveNewRequest() || !foldersDone_.empty() || (threadsToFinish_ == 0); });
                 if (!rv) //time-out + condition not met
                     break;
 
-                if (errorRequest_ && !errorResponse_)
+                if (haveNewRequest())
                 {
                     assert(threadsToFinish_ != 0);
-                    switch (onError({errorRequest_->msg, errorRequest_->failTime, errorRequest_->retryNumber})) //throw X
-                    {
-                        case PhaseCallback::ignore:
-                            errorResponse_ = AFS::TraverserCallback::HandleError::ignore;
-                            break;
-
-                        case PhaseCallback::retry:
-                            errorResponse_ = AFS::TraverserCallback::HandleError::retry;
-                            break;
-                    }
+                    answerPendingErrors(onError); //throw X
                     conditionHaveResponse_.notify_all(); //instead of notify_one(); work around bug: https://svn.boost.org/trac/boost/ticket/7796
                 }
+                if (!foldersDone_.empty())
+                {
+                    std::vector<DirectoryKey> foldersDone;
+                    foldersDone.swap(foldersDone_);
+
+                    dummy.unlock(); //don't block error reporting of other workers while processing (e.g. comparing) finished folders
+                    if (onFolderDone)
+                        for (const DirectoryKey& folderKey : foldersDone)
+                            onFolderDone(folderKey); //throw X
+                    dummy.lock();
+                    continue; //check for errors reported meanwhile
+                }
                 if (threadsToFinish_ == 0)
                 {
                     dummy.unlock();
@@ -164,6 +177,67 @@ public:
     }
 
 private:
+    struct ErrorRequest
+    {
+        AFS::TraverserCallback::ErrorInfo errorInfo;
+        std::optional<AFS::TraverserCallback::HandleError> response;
+    };
+
+    /* similar errors == same retry number + same error details (= message without the first, path-specific paragraph)
+        e.g. network share dropped: hundreds of folders failing with the same system error at once
+        => ask only once per group of similar errors, showing all affected items, and apply the answer to all of them   */
+    void answerPendingErrors(const TravErrorCb& onError) //throw X; context of main thread, lockRequest_ held
+    {
+        std::vector<std::vector<ErrorRequest*>> similarGroups;
+        {
+            std::map<std::pair<size_t /*retryNumber*/, std::wstring /*details*/>, size_t /*group idx*/> groupIdxs;
+
+            for (ErrorRequest& req : errorRequests_)
+                if (!req.response)
+                {
+                    std::wstring details = getErrorDetails(req.errorInfo.msg);
+                    if (details.empty()) //no path-specific part to tell apart: identical messages only
+                        details = req.errorInfo.msg;
+
+                    const auto [it, inserted] = groupIdxs.emplace(std::pair(req.errorInfo.retryNumber, std::move(details)), similarGroups.size());
+                    if (inserted)
+                        similarGroups.emplace_back();
+                    similarGroups[it->second].push_back(&req);
+                }
+        }
+
+        for (const std::vector<ErrorRequest*>& group : similarGroups)
+        {
+            const AFS::TraverserCallback::ErrorInfo& firstError = group[0]->errorInfo;
+            std::wstring msg = firstError.msg;
+
+            if (group.size() > 1 && !getErrorDetails(firstError.msg).empty())
+            {
+                msg.clear();
+                for (const ErrorRequest* req : group)
+                    msg += beforeFirst(req->errorInfo.msg, L"\n\n", IfNotFoundReturn::all) + L'\n';
+                msg += L'\n' + getErrorDetails(firstError.msg);
+                trim(msg);
+            }
+
+            AFS::TraverserCallback::HandleError response = AFS::TraverserCallback::HandleError::ignore;
+            switch (onError({msg, firstError.failTime, firstError.retryNumber})) //throw X
+            {
+                case PhaseCallback::ignore:
+                    response = AFS::TraverserCallback::HandleError::ignore;
+                    break;
+
+                case PhaseCallback::retry:
+                    response = AFS::TraverserCallback::HandleError::retry;
+                    break;
+            }
+            for (ErrorRequest* req : group)
+                req->response = response;
+        }
+    }
+
+    static std::wstring getErrorDetails(const std::wstring& msg) { return afterFirst(msg, L"\n\n", IfNotFoundReturn::none); }
+
     std::wstring getStatusLine() //context of main thread, call repreatedly
     {
         assert(runningOnMainThread());
@@ -183,11 +257,10 @@ private:
 
     //---- main <-> worker communication channel ----
     std::mutex lockRequest_;
-    std::condition_variable conditionReadyForNewRequest_;
     std::condition_variable conditionNewRequest;
     std::condition_variable conditionHaveResponse_;
-    std::optional<AFS::TraverserCallback::ErrorInfo  > errorRequest_;
-    std::optional<AFS::TraverserCallback::HandleError> errorResponse_;
+    std::list<ErrorRequest> errorRequests_; //pending requests of all workers; erased by the requesting worker
+    std::vector<DirectoryKey> foldersDone_;
     size_t threadsToFinish_; //can't use activeThreadIdxs_.size() which is locked by different mutex!
     //also note: activeThreadIdxs_.size() may be 0 during worker thread construction!
 
@@ -205,6 +278,55 @@ private:
 
 //-------------------------------------------------------------------------------------------------
 
+/* intern item names: many names recur throughout a tree (desktop.ini, index.html, src, ...) and left/right scans on the same device
+    => share one ref-counted Zstring buffer for the scan, and later the comparison tree
+    bounded (direct-mapped, last one wins): no bookkeeping cost for the majority of unique names      */
+class ItemNamePool
+{
+public:
+    const Zstring& intern(const Zstring& itemName)
+    {
+        Zstring& pooledName = pool_[StringHash()(itemName) % pool_.size()];
+        if (pooledName != itemName)
+            pooledName = itemName;
+        return pooledName;
+    }
+
+private:
+    std::vector<Zstring> pool_ = std::vector<Zstring>(64 * 1024); //512 KB (empty Zstring: no allocation)
+};
+
+
+/* followed symlinks: traverse each link target folder only once per base folder (e.g. many links into the same shared folder)
+    => further aliases copy the first scan result, re-applying the filter for their own relative paths
+    => only valid if the first scan is complete: nothing excluded by filter, no read errors, no nested aliases; else traverse regularly
+    => link target identity is reported by single-threaded traversers only (native: st_dev + st_ino)      */
+struct LinkTargetScan
+{
+    const FolderContainer& folderCont; //of the first alias
+    const std::shared_ptr<LinkTargetScan> parent; //enclosing link target scan (if any): incomplete => parent incomplete, too
+    bool complete = true;
+    bool done = false; //traversal round finished => "complete" is final
+
+    void setIncomplete()
+    {
+        for (LinkTargetScan* lts = this; lts && lts->complete; lts = lts->parent.get())
+            lts->complete = false;
+    }
+};
+
+
+struct LinkAlias //waiting for the traversal round of its link target to finish
+{
+    Zstring relPath;
+    FolderFilterState filterState;
+    FolderContainer& folderCont;
+    int level;
+    std::shared_ptr<LinkTargetScan> target;
+    std::shared_ptr<LinkTargetScan> parentScan;
+};
+
+
 struct TraverserConfig
 {
     const AbstractPath baseFolderPath;  //thread-safe like an int! :)
@@ -217,20 +339,67 @@ struct TraverserConfig
     AsyncCallback& acb;
     const int threadIdx;
     std::chrono::steady_clock::time_point& lastReportTime; //thread-level
+    ItemNamePool& namePool;                                //
+
+    std::map<std::pair<uint64_t, AFS::FingerPrint>, std::shared_ptr<LinkTargetScan>> linkTargets = {}; //key: link target device + file print
+    std::vector<LinkAlias> linkAliases = {};
 };
 
 
+void copyLinkTarget(TraverserConfig& cfg, const FolderContainer& src, FolderContainer& trg, //throw ThreadStopRequest
+                    const Zstring& parentRelPathPf, const FolderFilterState& parentFilterState)
+{
+    interruptionPoint(); //throw ThreadStopRequest
+
+    //same filter logic as DirCallback, but without disk access:
+    for (const auto& [itemName, attr] : src.files)
+        if (cfg.filter.ref().passFileFilter(parentRelPathPf + itemName, parentFilterState))
+        {
+            trg.addSubFile(itemName, attr);
+            cfg.acb.incItemsScanned(); //add 1 element to the progress indicator
+        }
+
+    for (const auto& [itemName, attr] : src.symlinks)
+        if (cfg.filter.ref().passFileFilter(parentRelPathPf + itemName, parentFilterState))
+        {
+            trg.addSubLink(itemName, attr);
+            cfg.acb.incItemsScanned();
+        }
+
+    for (const auto& [itemName, attrAndSub] : src.folders)
+    {
+        const Zstring& relPath = parentRelPathPf + itemName;
+
+        bool childItemMightMatch = true;
+        FolderFilterState filterState;
+        const bool passFilter = cfg.filter.ref().passDirFilter(relPath, parentFilterState, childItemMightMatch, filterState);
+        if (passFilter || childItemMightMatch)
+        {
+            FolderContainer& subFolder = trg.addSubFolder(itemName, attrAndSub.first);
+            if (passFilter)
+                cfg.acb.incItemsScanned();
+
+            copyLinkTarget(cfg, *attrAndSub.second, subFolder, relPath + FILE_NAME_SEPARATOR, filterState); //throw ThreadStopRequest
+        }
+    }
+}
+
+
 class DirCallback : public AFS::TraverserCallback
 {
 public:
     DirCallback(TraverserConfig& cfg,
                 const Zstring& parentRelPathPf, //postfixed with FILE_NAME_SEPARATOR!
+                const FolderFilterState& parentFilterState,
                 FolderContainer& output,
-                int level) :
+                int level,
+                const std::shared_ptr<LinkTargetScan>& linkTargetScan /*optional*/) :
         cfg_(cfg),
         parentRelPathPf_(parentRelPathPf),
+        parentFilterState_(parentFilterState),
         output_(output),
-        level_(level) {} //MUST NOT use cfg_ during construction! see BaseDirCallback()
+        level_(level),
+        linkTargetScan_(linkTargetScan) {} //MUST NOT use cfg_ during construction! see BaseDirCallback()
 
     virtual void                               onFile   (const AFS::FileInfo&    fi) override; //
     virtual std::shared_ptr<TraverserCallback> onFolder (const AFS::FolderInfo&  fi) override; //throw ThreadStopRequest
@@ -242,10 +411,14 @@ public:
 private:
     HandleError reportError(const ErrorInfo& errorInfo, const Zstring& itemName /*optional*/); //throw ThreadStopRequest
 
+    void setIncomplete() { if (linkTargetScan_) linkTargetScan_->setIncomplete(); } //scan result depends on alias path
+
     TraverserConfig& cfg_;
     const Zstring parentRelPathPf_;
+    const FolderFilterState parentFilterState_; //perf: don't re-evaluate the filter for parent path components
     FolderContainer& output_;
     const int level_;
+    const std::shared_ptr<LinkTargetScan> linkTargetScan_; //enclosing link target folder, see LinkTargetScan
 };
 
 
@@ -253,8 +426,8 @@ class BaseDirCallback : public DirCallback
 {
 public:
     BaseDirCallback(const DirectoryKey& baseFolderKey, DirectoryValue& output,
-                    AsyncCallback& acb, int threadIdx, std::chrono::steady_clock::time_point& lastReportTime) :
-        DirCallback(travCfg_ /*not yet constructed!!!*/, Zstring(), output.folderCont, 0 /*level*/),
+                    AsyncCallback& acb, int threadIdx, std::chrono::steady_clock::time_point& lastReportTime, ItemNamePool& namePool) :
+        DirCallback(travCfg_ /*not yet constructed!!!*/, Zstring(), FolderFilterState(), output.folderCont, 0 /*level*/, nullptr /*linkTargetScan*/),
         travCfg_
     {
         baseFolderKey.folderPath,
@@ -264,18 +437,41 @@ public:
         output.failedItemReads,
         acb,
         threadIdx,
-        lastReportTime
+        lastReportTime,
+        namePool
     }
     {
         if (acb.mayReportCurrentFile(threadIdx, lastReportTime))
             acb.reportCurrentFile(AFS::getDisplayPath(baseFolderKey.folderPath)); //just in case first directory access is blocking
     }
 
+    //call after each traversal round: copy scan results to link aliases, return aliases that need regular traversal
+    AFS::TraverserWorkload resolveLinkAliases(); //throw ThreadStopRequest
+
 private:
     TraverserConfig travCfg_;
 };
 
 
+AFS::TraverserWorkload BaseDirCallback::resolveLinkAliases() //throw ThreadStopRequest
+{
+    for (const auto& [targetId, target] : travCfg_.linkTargets)
+        target->done = true;
+
+    std::vector<LinkAlias> linkAliases;
+    linkAliases.swap(travCfg_.linkAliases);
+
+    AFS::TraverserWorkload workload;
+    for (const LinkAlias& alias : linkAliases)
+        if (alias.target->complete)
+            copyLinkTarget(travCfg_, alias.target->folderCont, alias.folderCont, alias.relPath + FILE_NAME_SEPARATOR, alias.filterState); //throw ThreadStopRequest
+        else
+            workload.emplace_back(AFS::appendRelPath(travCfg_.baseFolderPath, alias.relPath).afsPath,
+                                  std::make_shared<DirCallback>(travCfg_, alias.relPath + FILE_NAME_SEPARATOR, alias.filterState, alias.folderCont, alias.level, alias.parentScan));
+    return workload;
+}
+
+
 void DirCallback::onFile(const AFS::FileInfo& fi) //throw ThreadStopRequest
 {
     interruptionPoint(); //throw ThreadStopRequest
@@ -288,8 +484,11 @@ void DirCallback::onFile(const AFS::FileInfo& fi) //throw ThreadStopRequest
 
     //------------------------------------------------------------------------------------
     //apply filter before processing (use relative name!)
-    if (!cfg_.filter.ref().passFileFilter(relPath))
+    if (!cfg_.filter.ref().passFileFilter(relPath, parentFilterState_))
+    {
+        setIncomplete();
         return;
+    }
 
     //sync.ffs_db database and lock files are excluded via filter!
 
@@ -303,7 +502,7 @@ void DirCallback::onFile(const AFS::FileInfo& fi) //throw ThreadStopRequest
 
         Linux: retrieveFileID takes about 50% longer in VM! (avoidable because of redundant stat() call!)       */
 
-    output_.addSubFile(fi.itemName, FileAttributes(fi.modTime, fi.fileSize, fi.filePrint, fi.isFollowedSymlink));
+    output_.addSubFile(cfg_.namePool.intern(fi.itemName), FileAttributes(fi.modTime, fi.fileSize, fi.filePrint, fi.isFollowedSymlink, fi.linkCount));
 
     cfg_.acb.incItemsScanned(); //add 1 element to the progress indicator
 }
@@ -322,12 +521,16 @@ std::shared_ptr<AFS::TraverserCallback> DirCallback::onFolder(const AFS::FolderI
     //------------------------------------------------------------------------------------
     //apply filter before processing (use relative name!)
     bool childItemMightMatch = true;
-    const bool passFilter = cfg_.filter.ref().passDirFilter(relPath, &childItemMightMatch);
+    FolderFilterState filterState;
+    const bool passFilter = cfg_.filter.ref().passDirFilter(relPath, parentFilterState_, childItemMightMatch, filterState);
     if (!passFilter && !childItemMightMatch)
+    {
+        setIncomplete();
         return nullptr; //do NOT traverse subdirs
+    }
     //else: attention! ensure directory filtering is applied later to exclude actually filtered directories
 
-    FolderContainer& subFolder = output_.addSubFolder(fi.itemName, FolderAttributes(fi.isFollowedSymlink));
+    FolderContainer& subFolder = output_.addSubFolder(cfg_.namePool.intern(fi.itemName), FolderAttributes(fi.isFollowedSymlink));
     if (passFilter)
         cfg_.acb.incItemsScanned(); //add 1 element to the progress indicator
 
@@ -341,10 +544,35 @@ std::shared_ptr<AFS::TraverserCallback> DirCallback::onFolder(const AFS::FolderI
                 case AFS::TraverserCallback::HandleError::retry:
                     break;
                 case AFS::TraverserCallback::HandleError::ignore:
+                    setIncomplete();
                     return nullptr;
             }
 
-    return std::make_shared<DirCallback>(cfg_, relPath + FILE_NAME_SEPARATOR, subFolder, level_ + 1);
+    if (fi.isFollowedSymlink && fi.linkTargetFilePrint != 0)
+    {
+        auto [it, inserted] = cfg_.linkTargets.try_emplace({fi.linkTargetDevice, fi.linkTargetFilePrint});
+        if (inserted) //first alias: regular traversal
+        {
+            it->second = std::make_shared<LinkTargetScan>(subFolder, linkTargetScan_);
+            return std::make_shared<DirCallback>(cfg_, relPath + FILE_NAME_SEPARATOR, filterState, subFolder, level_ + 1, it->second);
+        }
+
+        const std::shared_ptr<LinkTargetScan>& target = it->second;
+        if (!target->done) //e.g. still being traversed
+        {
+            cfg_.linkAliases.push_back({relPath, filterState, subFolder, level_ + 1, target, linkTargetScan_});
+            setIncomplete();
+            return nullptr;
+        }
+        if (target->complete)
+        {
+            copyLinkTarget(cfg_, target->folderCont, subFolder, relPath + FILE_NAME_SEPARATOR, filterState); //throw ThreadStopRequest
+            return nullptr;
+        }
+        //else: traverse regularly, e.g. link cycles => "Endless recursion." as before
+    }
+
+    return std::make_shared<DirCallback>(cfg_, relPath + FILE_NAME_SEPARATOR, filterState, subFolder, level_ + 1, linkTargetScan_);
 }
 
 
@@ -364,9 +592,9 @@ DirCallback::HandleLink DirCallback::onSymlink(const AFS::SymlinkInfo& si) //thr
             return HandleLink::skip;
 
         case SymLinkHandling::direct:
-            if (cfg_.filter.ref().passFileFilter(relPath)) //always use file filter: Link type may not be "stable" on Linux!
+            if (cfg_.filter.ref().passFileFilter(relPath, parentFilterState_)) //always use file filter: Link type may not be "stable" on Linux!
             {
-                output_.addSubLink(si.itemName, LinkAttributes(si.modTime));
+                output_.addSubLink(cfg_.namePool.intern(si.itemName), LinkAttributes(si.modTime));
                 cfg_.acb.incItemsScanned(); //add 1 element to the progress indicator
             }
             return HandleLink::skip;
@@ -374,12 +602,16 @@ DirCallback::HandleLink DirCallback::onSymlink(const AFS::SymlinkInfo& si) //thr
         case SymLinkHandling::follow:
             //filter symlinks before trying to follow them: handle user-excluded broken symlinks!
             //since we don't know yet what type the symlink will resolve to, only do this when both filter variants agree:
-            if (!cfg_.filter.ref().passFileFilter(relPath))
+            if (!cfg_.filter.ref().passFileFilter(relPath, parentFilterState_))
             {
                 bool childItemMightMatch = true;
-                if (!cfg_.filter.ref().passDirFilter(relPath, &childItemMightMatch))
+                FolderFilterState filterState;
+                if (!cfg_.filter.ref().passDirFilter(relPath, parentFilterState_, childItemMightMatch, filterState))
                     if (!childItemMightMatch)
+                    {
+                        setIncomplete();
                         return HandleLink::skip;
+                    }
             }
             return HandleLink::follow;
     }
@@ -395,6 +627,7 @@ DirCallback::HandleError DirCallback::reportError(const ErrorInfo& errorInfo, co
     switch (handleErr)
     {
         case HandleError::ignore:
+            setIncomplete();
             if (itemName.empty())
                 cfg_.failedDirReads.emplace(beforeLast(parentRelPathPf_, FILE_NAME_SEPARATOR, IfNotFoundReturn::none), utfTo<Zstringc>(errorInfo.msg));
             else
@@ -410,59 +643,149 @@ DirCallback::HandleError DirCallback::reportError(const ErrorInfo& errorInfo, co
 
 
 std::map<DirectoryKey, DirectoryValue> fff::parallelDeviceTraversal(const std::set<DirectoryKey>& foldersToRead,
+                                                                    const std::map<AfsDevice, size_t>& deviceParallelOps,
                                                                     const TravErrorCb& onError, const TravStatusCb& onStatusUpdate,
-                                                                    std::chrono::milliseconds cbInterval)
+                                                                    std::chrono::milliseconds cbInterval,
+                                                                    const TravFolderDoneCb& onFolderDone /*throw X*/)
 {
     std::map<DirectoryKey, DirectoryValue> output;
 
-    //aggregate folder paths that are on the same root device:
-    // => one worker thread *per device*: avoid excessive parallelism
-    // => parallel folder traversal considers "parallel file operations" as specified by user
+    //aggregate folder paths that are on the same *physical* device:
+    // => native: mount points and partitions of one disk share a budget, separate disks don't (AfsDevice is just the path root)
+    // => parallel folder traversal considers "parallel file operations" as specified by user: max. number of worker threads per physical device
     // => (S)FTP: avoid hitting connection limits inadvertently
-    std::map<AfsDevice, std::set<DirectoryKey>> perDeviceFolders;
+    struct PhysicalDevice
+    {
+        std::map<AfsDevice, std::vector<DirectoryKey>> folders;
+        size_t parallelOps = std::numeric_limits<size_t>::max();
+    };
+    std::vector<PhysicalDevice> physicalDevices;
+    std::map<std::string /*physical device ID*/, size_t> physicalDeviceById;
+    std::map<AfsDevice,                          size_t> physicalDeviceByAfs; //non-native or ID unknown (e.g. folder not existing)
+
+    auto getPhysicalDevice = [&](auto& deviceIdxs, const auto& deviceKey) -> PhysicalDevice&
+    {
+        const auto [it, inserted] = deviceIdxs.emplace(deviceKey, physicalDevices.size());
+        if (inserted)
+            physicalDevices.emplace_back();
+        return physicalDevices[it->second];
+    };
 
     for (const DirectoryKey& key : foldersToRead)
-        perDeviceFolders[key.folderPath.afsDevice].insert(key);
+    {
+        const AfsDevice& afsDevice = key.folderPath.afsDevice;
+        const std::string physicalId = AFS::getPhysicalDeviceId(key.folderPath); //noexcept
+
+        PhysicalDevice& pd = physicalId.empty() ?
+                             getPhysicalDevice(physicalDeviceByAfs, afsDevice) :
+                             getPhysicalDevice(physicalDeviceById,  physicalId);
+        pd.folders[afsDevice].push_back(key);
+        pd.parallelOps = std::min(pd.parallelOps, getDeviceParallelOps(deviceParallelOps, afsDevice)); //shared disk: most conservative setting wins
+    }
+
+    //distribute base folders of each physical device among its worker threads:
+    using ThreadWorkload = std::map<AfsDevice, std::vector<DirectoryKey>>;
+    std::vector<ThreadWorkload> threadWorkloads;
+
+    for (const PhysicalDevice& pd : physicalDevices)
+    {
+        size_t folderCount = 0;
+        for (const auto& [afsDevice, dirKeys] : pd.folders)
+            folderCount += dirKeys.size();
+
+        const size_t threadCount = std::min(pd.parallelOps, folderCount);
+        const size_t firstIdx = threadWorkloads.size();
+        threadWorkloads.resize(firstIdx + threadCount);
+
+        size_t folderIdx = 0;
+        for (const auto& [afsDevice, dirKeys] : pd.folders)
+            for (const DirectoryKey& key : dirKeys)
+                threadWorkloads[firstIdx + folderIdx++ % threadCount][afsDevice].push_back(key);
+    }
 
     //communication channel used by threads
-    AsyncCallback acb(perDeviceFolders.size() /*threadsToFinish*/, cbInterval); //manage life time: enclose InterruptibleThread's!!!
+    AsyncCallback acb(threadWorkloads.size() /*threadsToFinish*/, cbInterval); //manage life time: enclose InterruptibleThread's!!!
 
     std::vector<InterruptibleThread> worker;
     ZEN_ON_SCOPE_SUCCESS( for (InterruptibleThread& wt : worker) wt.join(); ); //no stop needed in success case => preempt ~InterruptibleThread()
     ZEN_ON_SCOPE_FAIL( for (InterruptibleThread& wt : worker) wt.requestStop(); ); //stop *all* at the same time before join!
 
     //init worker threads
-    for (const auto& [afsDevice, dirKeys] : perDeviceFolders)
+    for (const ThreadWorkload& threadWorkload : threadWorkloads)
     {
         const int threadIdx = static_cast<int>(worker.size());
-        Zstring threadName = Zstr("Comp Device[") + numberTo<Zstring>(threadIdx + 1) + Zstr('/') + numberTo<Zstring>(perDeviceFolders.size()) + Zstr(']');
+        Zstring threadName = Zstr("Comp Device[") + numberTo<Zstring>(threadIdx + 1) + Zstr('/') + numberTo<Zstring>(threadWorkloads.size()) + Zstr(']');
 
-        const size_t parallelOps = 1;
-        std::map<DirectoryKey, DirectoryValue*> workload;
+        const size_t parallelOps = 1; //device budget is spent on the number of worker threads
+        std::map<AfsDevice, std::map<DirectoryKey, DirectoryValue*>> workload;
 
-        for (const DirectoryKey& key : dirKeys)
-            workload.emplace(key, &output[key]); //=> DirectoryValue* unshared for lock-free worker-thread access
+        for (const auto& [afsDevice, dirKeys] : threadWorkload)
+            for (const DirectoryKey& key : dirKeys)
+                workload[afsDevice].emplace(key, &output[key]); //=> DirectoryValue* unshared for lock-free worker-thread access
 
-        worker.emplace_back([afsDevice /*clang bug*/= afsDevice, workload, threadIdx, &acb, parallelOps, threadName = std::move(threadName)]() mutable
+        const int numaNode = AFS::selectWorkerNumaNode(threadWorkload.begin()->second.front().folderPath);
+
+        worker.emplace_back([workload, threadIdx, &acb, parallelOps, numaNode, threadName = std::move(threadName)]() mutable
         {
             setCurrentThreadName(threadName);
+            const ScheduleThreadForBackground backgroundPrio(BackgroundWork::traverse);
+            const PinThreadToNumaNode numaAffinity(numaNode); //folder containers are allocated on the device's node
 
             acb.notifyWorkBegin(threadIdx, parallelOps);
             ZEN_ON_SCOPE_EXIT(acb.notifyWorkEnd(threadIdx));
 
             std::chrono::steady_clock::time_point lastReportTime; //keep thread-local!
+            ItemNamePool namePool;                                //
+
+            for (auto& [afsDevice, deviceWorkload] : workload) //native: same disk, but different roots (e.g. Windows drive letters)
+            {
+                AFS::TraverserWorkload travWorkload;
+                std::vector<std::shared_ptr<BaseDirCallback>> baseCallbacks;
+
+                for (auto& [folderKey, folderVal] : deviceWorkload)
+                {
+                    assert(folderKey.folderPath.afsDevice == afsDevice);
+                    travWorkload.emplace_back(folderKey.folderPath.afsPath, baseCallbacks.emplace_back(std::make_shared<BaseDirCallback>(folderKey, *folderVal, acb, threadIdx, lastReportTime, namePool)));
+                }
 
-            AFS::TraverserWorkload travWorkload;
+                TraceSpan span("traverse device", [&] { return utfTo<std::string>(AFS::getDisplayPath(AbstractPath(afsDevice, AfsPath()))); });
+                AFS::traverseFolderRecursive(afsDevice, travWorkload, parallelOps); //throw ThreadStopRequest
+
+                //followed symlinks: fill in aliases of link targets scanned meanwhile
+                for (;;)
+                {
+                    AFS::TraverserWorkload aliasWorkload;
+                    for (const std::shared_ptr<BaseDirCallback>& baseCb : baseCallbacks)
+                        append(aliasWorkload, baseCb->resolveLinkAliases()); //throw ThreadStopRequest
+                    if (aliasWorkload.empty())
+                        break;
 
-            for (auto& [folderKey, folderVal] : workload)
+                    AFS::traverseFolderRecursive(afsDevice, aliasWorkload, parallelOps); //throw ThreadStopRequest
+                }
+            }
+
+            //traversal complete => sort once, still on worker thread: prerequisite for comparison's merge-join
+            std::vector<DirectoryKey> foldersDone;
             {
-                assert(folderKey.folderPath.afsDevice == afsDevice);
-                travWorkload.emplace_back(folderKey.folderPath.afsPath, std::make_shared<BaseDirCallback>(folderKey, *folderVal, acb, threadIdx, lastReportTime));
+                TraceSpan span("sort folder items");
+                for (auto& [afsDevice, deviceWorkload] : workload)
+                    for (auto& [folderKey, folderVal] : deviceWorkload)
+                    {
+                        folderVal->folderCont.sortItems();
+                        foldersDone.push_back(folderKey);
+                    }
             }
-            AFS::traverseFolderRecursive(afsDevice, travWorkload, parallelOps); //throw ThreadStopRequest
+            acb.notifyFoldersDone(foldersDone);
         });
     }
-    acb.waitUntilDone(cbInterval, onError, onStatusUpdate); //throw X
+
+    //hand over scan results that are final *before* the slower devices are done: pipeline traversal and comparison
+    acb.waitUntilDone(cbInterval, onError, onStatusUpdate, onFolderDone ? [&](const DirectoryKey& folderKey) //throw X
+    {
+        auto node = output.extract(folderKey); //worker thread is done with this value
+        assert(!node.empty());
+        onFolderDone(folderKey, std::move(node.mapped())); //throw X
+    } : std::function<void(const DirectoryKey& folderKey)>());
 
     return output;
 }
@@ -45,10 +45,16 @@ struct DirectoryValue
 
 using TravErrorCb  = std::function<PhaseCallback::Response(const PhaseCallback::ErrorInfo& errorInfo)>;
 using TravStatusCb = std::function<void (const std::wstring& statusLine, int itemsTotal)>;
+using TravFolderDoneCb = std::function<void (const DirectoryKey& folderKey, DirectoryValue&& folderVal)>;
 
+//onFolderDone (optional): called on main thread as soon as all folders of a worker thread are traversed (while other devices are still scanning)
+//  => folder values handed over to onFolderDone are *not* part of the returned buffer
+//deviceParallelOps: max. worker threads per *physical* device (native: underlying disk, see AFS::getPhysicalDeviceId())
 std::map<DirectoryKey, DirectoryValue> parallelDeviceTraversal(const std::set<DirectoryKey>& foldersToRead,
+                                                               const std::map<AfsDevice, size_t>& deviceParallelOps,
                                                                const TravErrorCb& onError, const TravStatusCb& onStatusUpdate, //NOT optional
-                                                               std::chrono::milliseconds cbInterval);
+                                                               std::chrono::milliseconds cbInterval,
+                                                               const TravFolderDoneCb& onFolderDone = nullptr /*throw X*/);
 }
 
 #endif //PARALLEL_SCAN_H_924588904275284572857
@@ -100,6 +100,9 @@ void NameFilter::parseFilterPhrase(const Zstring& filterPhrase, FilterSet& filte
                 processTail(afterFirst(itemPhrase, asteriskSep, IfNotFoundReturn::none));
         }
     }
+
+    filter.fileFolderMasks.compile();
+    filter.folderMasks    .compile();
 }
 
 
@@ -108,18 +111,134 @@ void NameFilter::MaskMatcher::insert(const Zstring& mask)
     assert(mask == getUpperCase(mask));
     if (contains(mask, Zstr('?')) ||
         contains(mask, Zstr('*')))
-        realMasks_.insert(mask);
+    {
+        if (!realMasks_.insert(mask).second)
+            return;
+
+        //classify: "*", "*abc*", "*abc", "abc*" can be matched without backtracking
+        const Zchar* first = mask.begin();
+        const Zchar* last  = mask.end();
+        while (first != last && *first == Zstr('*')) ++first;
+        while (first != last && last[-1] == Zstr('*')) --last;
+
+        const bool leadingAsterisk  = first != mask.begin();
+        const bool trailingAsterisk = last  != mask.end();
+        if (leadingAsterisk)
+            anyLeadingAsterisk_ = true;
+
+        if (first == last)
+            matchAll_ = true;
+        else if (std::any_of(first, last, [](Zchar c) { return c == Zstr('*') || c == Zstr('?'); }))
+            otherMasks_.push_back(mask);
+        else if (leadingAsterisk)
+            insertLiteral(first, last, trailingAsterisk /*infix*/);
+        else //trailingAsterisk
+        {
+            const Zstring prefix(first, last);
+            prefixMasks_.insert(prefix);
+
+            if (const auto it = std::lower_bound(prefixLengths_.begin(), prefixLengths_.end(), prefix.size());
+                it == prefixLengths_.end() || *it != prefix.size())
+                prefixLengths_.insert(it, prefix.size());
+
+            addBeginParents(prefix, false /*strictSubMatch*/);
+        }
+    }
     else
     {
         relPaths_   .emplace(mask);
         relPathsCmp_.emplace(mask); //little memory wasted thanks to COW string!
+
+        addBeginParents(mask, true /*strictSubMatch*/);
     }
 }
 
 
+void NameFilter::MaskMatcher::insertLiteral(const Zchar* first, const Zchar* last, bool infix)
+{
+    uint32_t nodeIdx = 0;
+    for (auto it = first; it != last; ++it)
+    {
+        auto& children = automaton_[nodeIdx].children;
+        auto itC = std::lower_bound(children.begin(), children.end(), *it, [](const auto& child, Zchar c) { return child.first < c; });
+        if (itC == children.end() || itC->first != *it)
+        {
+            itC = children.emplace(itC, *it, static_cast<uint32_t>(automaton_.size()));
+            automaton_.emplace_back(); //caveat: invalidates "children"
+        }
+        nodeIdx = itC->second;
+    }
+
+    if (infix)
+        automaton_[nodeIdx].infixEnd = true;
+    else
+        automaton_[nodeIdx].suffixEnd = true;
+
+    automatonCompiled_ = false;
+}
+
+
+//record parent paths "abc" of "abc/def" => matchesBegin() in constant time
+void NameFilter::MaskMatcher::addBeginParents(const Zstring& mask, bool strictSubMatch)
+{
+    for (auto it = mask.begin(); it != mask.end(); ++it)
+        if (*it == FILE_NAME_SEPARATOR && (!strictSubMatch || mask.end() - it > 1))
+            beginParents_.emplace(mask.begin(), it);
+}
+
+
+void NameFilter::MaskMatcher::compile()
+{
+    if (automatonCompiled_)
+        return;
+
+    //breadth-first: fail links of shallower nodes are final before they're used
+    std::vector<uint32_t> queue;
+    for (const auto& [c, childIdx] : automaton_[0].children)
+    {
+        automaton_[childIdx].failLink = 0;
+        queue.push_back(childIdx);
+    }
+
+    for (size_t i = 0; i < queue.size(); ++i)
+    {
+        const uint32_t nodeIdx = queue[i];
+
+        for (const auto& [c, childIdx] : automaton_[nodeIdx].children)
+        {
+            uint32_t failIdx = automaton_[nodeIdx].failLink;
+            uint32_t failChildIdx = getChild(failIdx, c);
+            while (failChildIdx == 0 && failIdx != 0)
+            {
+                failIdx = automaton_[failIdx].failLink;
+                failChildIdx = getChild(failIdx, c);
+            }
+
+            AutomatonNode& child = automaton_[childIdx];
+            child.failLink = failChildIdx;
+            child.infixEnd  = child.infixEnd  || automaton_[failChildIdx].infixEnd;
+            child.suffixEnd = child.suffixEnd || automaton_[failChildIdx].suffixEnd;
+
+            queue.push_back(childIdx);
+        }
+    }
+    automatonCompiled_ = true;
+}
+
+
+inline
+uint32_t NameFilter::MaskMatcher::getChild(uint32_t nodeIdx, Zchar c) const
+{
+    const auto& children = automaton_[nodeIdx].children;
+    const auto it = std::lower_bound(children.begin(), children.end(), c, [](const auto& child, Zchar c2) { return child.first < c2; });
+    return it != children.end() && it->first == c ? it->second : 0;
+}
+
+
 namespace
 {
-//"true" if path or any parent path matches the mask
+//"true" if path or any parent path matches the mask (exactOnly: path only)
+template <bool exactOnly>
 bool matchesMask(const Zchar* path, const Zchar* const pathEnd, const Zchar* mask /*0-terminated*/)
 {
     for (;; ++mask, ++path)
@@ -128,7 +247,7 @@ bool matchesMask(const Zchar* path, const Zchar* const pathEnd, const Zchar* mas
         switch (m)
         {
             case 0:
-                return path == pathEnd || *path == FILE_NAME_SEPARATOR; //"full" or parent path match
+                return path == pathEnd || (!exactOnly && *path == FILE_NAME_SEPARATOR); //"full" or parent path match
 
             case Zstr('?'): //should not match FILE_NAME_SEPARATOR
                 if (path == pathEnd || *path == FILE_NAME_SEPARATOR)
@@ -150,13 +269,13 @@ bool matchesMask(const Zchar* path, const Zchar* const pathEnd, const Zchar* mas
                 {
                     while (path != pathEnd)
                         if (*path++ != FILE_NAME_SEPARATOR)
-                            if (matchesMask(path, pathEnd, mask))
+                            if (matchesMask<exactOnly>(path, pathEnd, mask))
                                 return true;
                 }
                 else //*[letter or /] pattern
                     while (path != pathEnd)
                         if (*path++ == m)
-                            if (matchesMask(path, pathEnd, mask))
+                            if (matchesMask<exactOnly>(path, pathEnd, mask))
                                 return true;
                 return false;
 
@@ -209,10 +328,52 @@ bool matchesMaskBegin<false /*haveWildcards*/>(const Zstring& relPath, const Zst
 }
 
 
+template <bool exactOnly>
+bool NameFilter::MaskMatcher::matchesWildcards(const Zchar* pathFirst, const Zchar* pathLast) const
+{
+    assert(automatonCompiled_);
+    if (matchAll_)
+        return true;
+
+    //"*abc*" and "*abc": single pass over the path
+    if (automaton_.size() > 1)
+    {
+        uint32_t nodeIdx = 0;
+        for (const Zchar* it = pathFirst; it != pathLast; ++it)
+        {
+            uint32_t childIdx = getChild(nodeIdx, *it);
+            while (childIdx == 0 && nodeIdx != 0)
+            {
+                nodeIdx = automaton_[nodeIdx].failLink;
+                childIdx = getChild(nodeIdx, *it);
+            }
+            nodeIdx = childIdx;
+
+            const AutomatonNode& node = automaton_[nodeIdx];
+            if (node.infixEnd)
+                return true;
+            if (node.suffixEnd && (it + 1 == pathLast || (!exactOnly && it[1] == FILE_NAME_SEPARATOR))) //"full" or parent path match
+                return true;
+        }
+    }
+
+    //"abc*"
+    for (const size_t prefixLen : prefixLengths_)
+    {
+        if (prefixLen > static_cast<size_t>(pathLast - pathFirst))
+            break;
+        if (prefixMasks_.contains(makeStringView(pathFirst, prefixLen))) //heterogenous lookup!
+            return true;
+    }
+
+    return std::any_of(otherMasks_.begin(), otherMasks_.end(), [&](const Zstring& mask) { return matchesMask<exactOnly>(pathFirst, pathLast, mask.c_str()); });
+}
+
+
 bool NameFilter::MaskMatcher::matches(const Zchar* pathFirst, const Zchar* pathLast) const
 {
-    if (std::any_of(realMasks_.begin(), realMasks_.end(), [&](const Zstring& mask) { return matchesMask(pathFirst, pathLast, mask.c_str()); }))
-    /**/return true;
+    if (matchesWildcards<false /*exactOnly*/>(pathFirst, pathLast))
+        return true;
 
     //perf: for relPaths_ we can go from linear to *constant* time!!! => annihilates https://freefilesync.org/forum/viewtopic.php?t=7768#p26519
     const Zchar* sepPos = pathFirst;
@@ -230,10 +391,31 @@ bool NameFilter::MaskMatcher::matches(const Zchar* pathFirst, const Zchar* pathL
     }
 }
 
+
+bool NameFilter::MaskMatcher::matchesExact(const Zchar* pathFirst, const Zchar* pathLast) const
+{
+    return matchesWildcards<true /*exactOnly*/>(pathFirst, pathLast) ||
+           relPaths_.contains(makeStringView(pathFirst, pathLast));
+}
+
 bool NameFilter::MaskMatcher::matchesBegin(const Zstring& relPath) const
 {
-    return std::any_of(realMasks_.begin(), realMasks_.end(), [&](const Zstring& mask) { return matchesMaskBegin<true  /*haveWildcards*/>(relPath, mask); }) ||
-    /**/   std::any_of(relPaths_ .begin(), relPaths_ .end(), [&](const Zstring& mask) { return matchesMaskBegin<false /*haveWildcards*/>(relPath, mask); });
+    if (anyLeadingAsterisk_) //"*" matches any relPath => same as matchesMaskBegin<true>()
+        return true;
+
+    if (beginParents_.contains(relPath)) //= matchesMaskBegin<false>() for relPaths_ + parent path part of matchesMaskBegin<true>() for prefixMasks_
+        return true;
+
+    //"abc*": relPath reaches the asterisk
+    for (const size_t prefixLen : prefixLengths_)
+    {
+        if (prefixLen > relPath.size())
+            break;
+        if (prefixMasks_.contains(makeStringView(relPath.begin(), prefixLen)))
+            return true;
+    }
+
+    return std::any_of(otherMasks_.begin(), otherMasks_.end(), [&](const Zstring& mask) { return matchesMaskBegin<true /*haveWildcards*/>(relPath, mask); });
 }
 
 //#################################################################################################
@@ -301,6 +483,49 @@ bool NameFilter::passDirFilter(const Zstring& relDirPath, bool* childItemMightMa
 }
 
 
+bool NameFilter::passFileFilterImpl(const Zstring& relFilePath, bool parentIncluded) const
+{
+    assert(!startsWith(relFilePath, FILE_NAME_SEPARATOR));
+
+    //normalize input: 1. ignore Unicode normalization form 2. ignore case
+    const Zstring& pathFmt = getUpperCase(relFilePath);
+
+    //parent paths were checked already: not excluded
+    if (excludeFilter.fileFolderMasks.matchesExact(pathFmt.begin(), pathFmt.end()))
+        return false;
+
+    return parentIncluded || includeFilter.fileFolderMasks.matchesExact(pathFmt.begin(), pathFmt.end());
+}
+
+
+bool NameFilter::passDirFilterImpl(const Zstring& relDirPath, bool parentIncluded, bool& childItemMightMatch, bool& dirIncluded) const
+{
+    assert(!startsWith(relDirPath, FILE_NAME_SEPARATOR));
+    assert(childItemMightMatch); //check correct usage
+
+    //normalize input: 1. ignore Unicode normalization form 2. ignore case
+    const Zstring& pathFmt = getUpperCase(relDirPath);
+
+    //parent paths were checked already: not excluded
+    if (excludeFilter.fileFolderMasks.matchesExact(pathFmt.begin(), pathFmt.end()) ||
+        excludeFilter.folderMasks    .matchesExact(pathFmt.begin(), pathFmt.end()))
+    {
+        childItemMightMatch = false; //see passDirFilter()
+        return false;
+    }
+
+    dirIncluded = parentIncluded ||
+                  includeFilter.fileFolderMasks.matchesExact(pathFmt.begin(), pathFmt.end()) ||
+                  includeFilter.folderMasks    .matchesExact(pathFmt.begin(), pathFmt.end());
+    if (dirIncluded)
+        return true;
+
+    childItemMightMatch = includeFilter.fileFolderMasks.matchesBegin(pathFmt) || //might match a file  or folder in subdirectory
+                          includeFilter.folderMasks    .matchesBegin(pathFmt);   //
+    return false;
+}
+
+
 bool NameFilter::isNull(const Zstring& includePhrase, const Zstring& excludePhrase)
 {
     return trimCpy(includePhrase) == Zstr("*") &&
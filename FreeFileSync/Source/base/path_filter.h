@@ -32,6 +32,13 @@ std::strong_ordering operator<=>(const FilterRef& lhs, const FilterRef& rhs); //
 
 const Zchar FILTER_ITEM_SEPARATOR = Zstr('|');
 
+
+struct FolderFilterState //filter result of a folder => evaluate its child items without re-checking the folder's path
+{
+    bool included       = false; //NameFilter: matched include filter
+    bool includedSecond = false; //CombinedFilter: second NameFilter
+};
+
 class PathFilter
 {
 public:
@@ -42,6 +49,11 @@ public:
     //childItemMightMatch: file/dir in subdirectories could(!) match
     //note: this hint is only set if passDirFilter returns false!
 
+    //perf: same as above, but for items of a folder that is known to be not excluded: parent folder was traversed, i.e. passDirFilter() returned true or childItemMightMatch
+    //parentState: dirState of the parent folder; default-constructed for items of the base folder
+    virtual bool passFileFilter(const Zstring& relFilePath, const FolderFilterState& parentState) const = 0;
+    virtual bool passDirFilter (const Zstring& relDirPath,  const FolderFilterState& parentState, bool& childItemMightMatch, FolderFilterState& dirState) const = 0;
+
     virtual bool isNull() const = 0; //filter is equivalent to NullFilter
 
     virtual FilterRef copyFilterAddingExclusion(const Zstring& excludePhrase) const = 0;
@@ -62,6 +74,8 @@ class NullFilter : public PathFilter //no filtering at all
 public:
     bool passFileFilter(const Zstring& relFilePath) const override { return true; }
     bool passDirFilter(const Zstring& relDirPath, bool* childItemMightMatch) const override;
+    bool passFileFilter(const Zstring& relFilePath, const FolderFilterState& parentState) const override { return true; }
+    bool passDirFilter (const Zstring& relDirPath,  const FolderFilterState& parentState, bool& childItemMightMatch, FolderFilterState& dirState) const override { return true; }
     bool isNull() const override { return true; }
     FilterRef copyFilterAddingExclusion(const Zstring& excludePhrase) const override;
 
@@ -79,6 +93,9 @@ public:
 
     bool passFileFilter(const Zstring& relFilePath) const override;
     bool passDirFilter(const Zstring& relDirPath, bool* childItemMightMatch) const override;
+    bool passFileFilter(const Zstring& relFilePath, const FolderFilterState& parentState) const override { return passFileFilterImpl(relFilePath, parentState.included); }
+    bool passDirFilter (const Zstring& relDirPath,  const FolderFilterState& parentState, bool& childItemMightMatch, FolderFilterState& dirState) const override
+    { return passDirFilterImpl(relDirPath, parentState.included, childItemMightMatch, dirState.included); }
 
     bool isNull() const override;
     static bool isNull(const Zstring& includePhrase, const Zstring& excludePhrase); //*fast* check without expensive NameFilter construction!
@@ -88,11 +105,16 @@ private:
     friend class CombinedFilter;
     std::strong_ordering compareSameType(const PathFilter& other) const override;
 
+    bool passFileFilterImpl(const Zstring& relFilePath, bool parentIncluded) const;
+    bool passDirFilterImpl (const Zstring& relDirPath,  bool parentIncluded, bool& childItemMightMatch, bool& dirIncluded) const;
+
     class MaskMatcher
     {
     public:
         void insert(const Zstring& mask); //expected: upper-case + Unicode-normalized!
-        bool matches(const Zchar* pathFirst, const Zchar* pathLast) const;
+        void compile(); //call after last insert()
+        bool matches(const Zchar* pathFirst, const Zchar* pathLast) const; //path or any parent path
+        bool matchesExact(const Zchar* pathFirst, const Zchar* pathLast) const; //path only, *not* the parent paths
         bool matchesBegin(const Zstring& relPath) const;
 
         inline friend std::strong_ordering operator<=>(const MaskMatcher& lhs, const MaskMatcher& rhs)
@@ -111,6 +133,29 @@ private:
         std::set<Zstring> realMasks_; //always containing ? or *       (use std::set<> to scrap duplicates!)
         std::unordered_set<Zstring, zen::StringHash, zen::StringEqual> relPaths_; //never containing ? or *
         std::set<Zstring>                                              relPathsCmp_; //req. for operator<=> only :(
+
+        //perf: compiled representation of realMasks_ => avoid calling matchesMask() for each mask on each path (300+ masks are not unusual)
+        struct AutomatonNode //Aho-Corasick
+        {
+            std::vector<std::pair<Zchar, uint32_t /*node index*/>> children; //sorted by Zchar
+            uint32_t failLink = 0;
+            bool infixEnd  = false; //"*abc*" ends here, or at any node along the fail links
+            bool suffixEnd = false; //"*abc"
+        };
+        template <bool exactOnly> bool matchesWildcards(const Zchar* pathFirst, const Zchar* pathLast) const;
+        uint32_t getChild(uint32_t nodeIdx, Zchar c) const; //returns 0 if not found
+        void insertLiteral(const Zchar* first, const Zchar* last, bool infix);
+        void addBeginParents(const Zstring& mask, bool strictSubMatch);
+
+        std::vector<AutomatonNode> automaton_ = std::vector<AutomatonNode>(1); //[0]: root
+        bool automatonCompiled_ = true;
+
+        bool matchAll_ = false;               //"*"
+        bool anyLeadingAsterisk_ = false;     //=> matchesBegin() always true
+        std::unordered_set<Zstring, zen::StringHash, zen::StringEqual> prefixMasks_; //"abc*"
+        std::vector<size_t>                                            prefixLengths_; //sorted, distinct
+        std::vector<Zstring>                                           otherMasks_; //remaining wildcard masks: matchesMask() fallback
+        std::unordered_set<Zstring, zen::StringHash, zen::StringEqual> beginParents_; //parent paths of relPaths_ and prefixMasks_ for matchesBegin()
     };
 
     struct FilterSet
@@ -135,6 +180,8 @@ public:
 
     bool passFileFilter(const Zstring& relFilePath) const override;
     bool passDirFilter(const Zstring& relDirPath, bool* childItemMightMatch) const override;
+    bool passFileFilter(const Zstring& relFilePath, const FolderFilterState& parentState) const override;
+    bool passDirFilter (const Zstring& relDirPath,  const FolderFilterState& parentState, bool& childItemMightMatch, FolderFilterState& dirState) const override;
     bool isNull() const override;
     FilterRef copyFilterAddingExclusion(const Zstring& excludePhrase) const override;
 
@@ -200,6 +247,28 @@ bool CombinedFilter::passDirFilter(const Zstring& relDirPath, bool* childItemMig
 }
 
 
+inline
+bool CombinedFilter::passFileFilter(const Zstring& relFilePath, const FolderFilterState& parentState) const
+{
+    return first_ .passFileFilterImpl(relFilePath, parentState.included) && //short-circuit behavior
+           second_.passFileFilterImpl(relFilePath, parentState.includedSecond);
+}
+
+
+inline
+bool CombinedFilter::passDirFilter(const Zstring& relDirPath, const FolderFilterState& parentState, bool& childItemMightMatch, FolderFilterState& dirState) const
+{
+    if (first_.passDirFilterImpl(relDirPath, parentState.included, childItemMightMatch, dirState.included))
+        return second_.passDirFilterImpl(relDirPath, parentState.includedSecond, childItemMightMatch, dirState.includedSecond);
+    else
+    {
+        if (childItemMightMatch) //dirState.includedSecond is needed only if child items are evaluated
+            second_.passDirFilterImpl(relDirPath, parentState.includedSecond, childItemMightMatch, dirState.includedSecond);
+        return false;
+    }
+}
+
+
 inline
 bool CombinedFilter::isNull() const
 {
@@ -18,6 +18,7 @@ namespace fff
 Semantics of SoftFilter:
 1. It potentially may match only one side => it MUST NOT be applied while traversing a single folder to avoid mismatches
 2. => it is applied after traversing and just marks rows, (NO deletions after comparison are allowed)
+      exception: rows excluded on both sides may be skipped while merging both traversals (see MergeSides in comparison.cpp)
 3. => equivalent to a user temporarily (de-)selecting rows => not relevant for <two way>-mode!
 */
 
@@ -92,6 +92,96 @@ std::wstring SpeedTest::getItemsPerSecFmt() const
 }
 
 
+ParallelOpsTuner::ParallelOpsTuner(size_t parallelOpsMax, std::chrono::milliseconds evalInterval) :
+    parallelOpsMax_(std::max<size_t>(parallelOpsMax, 1)),
+    evalInterval_(evalInterval) {}
+
+
+void ParallelOpsTuner::addSample(int itemsDone, int64_t bytesDone)
+{
+    if (parallelOpsMax_ == 1)
+        return;
+
+    const auto now = std::chrono::steady_clock::now();
+    speedTest_.addSample(now - startTime_, itemsDone, bytesDone);
+
+    if (now >= evalStartTime_ + evalInterval_)
+    {
+        //prefer bytes: items/sec is meaningless for mixed file sizes, but covers zero-byte items
+        std::optional<double> rate = speedTest_.getBytesPerSec();
+        if (!rate || *rate <= 0)
+            rate = speedTest_.getItemsPerSec();
+
+        if (rate) //else: not enough samples yet, e.g. huge files => extend interval
+        {
+            evaluate(*rate);
+            speedTest_.clear(); //each interval measures one parallelOps_ value only
+            speedTest_.addSample(now - startTime_, itemsDone, bytesDone);
+            evalStartTime_ = now;
+        }
+    }
+}
+
+
+void ParallelOpsTuner::evaluate(double rate)
+{
+    const int HOLD_INTERVALS = 5;
+
+    if (probeDirection_ != 0) //judge probe
+    {
+        assert(rateRef_);
+        if (rate > *rateRef_ * 1.1) //keep going in the same direction
+        {
+            parallelOpsRef_ = parallelOps_;
+            rateRef_ = rate;
+            if (!probe(probeDirection_))
+                holdIntervals_ = HOLD_INTERVALS;
+        }
+        else //no (significant) gain: revert
+        {
+            parallelOps_ = parallelOpsRef_;
+            probeDirection_ = 0;
+            rateRef_ = std::nullopt; //re-measure: conditions may have changed during probe
+            holdIntervals_ = HOLD_INTERVALS;
+        }
+    }
+    else if (!rateRef_)
+    {
+        rateRef_ = rate;
+        if (holdIntervals_ == 0)
+            probe(1);
+    }
+    else if (rate < *rateRef_ * 0.75) //getting worse at same parallelOps
+    {
+        rateRef_ = rate;
+        if (!probe(-1))
+            holdIntervals_ = HOLD_INTERVALS;
+    }
+    else if (holdIntervals_ > 0)
+        --holdIntervals_;
+    else
+    {
+        rateRef_ = rate;
+        if (!probe(1))
+            holdIntervals_ = HOLD_INTERVALS;
+    }
+}
+
+
+bool ParallelOpsTuner::probe(int direction)
+{
+    probeDirection_ = 0;
+    parallelOpsRef_ = parallelOps_;
+
+    if (direction > 0 ? parallelOps_ >= parallelOpsMax_ : parallelOps_ <= 1)
+        return false;
+
+    parallelOps_ += direction;
+    probeDirection_ = direction;
+    return true;
+}
+
+
 /*
 class for calculation of remaining time:
 ----------------------------------------
@@ -42,6 +42,39 @@ private:
     const std::chrono::milliseconds windowSize_;
     zen::RingBuffer<Sample> samples_;
 };
+
+
+/*  auto-tune number of parallel operations on a device, within [1, parallelOpsMax]:
+    hill-climbing on throughput measured over fixed intervals
+    - probe one more (or one less) operation: keep if throughput improves by at least 10%, else go back
+    - hold for a few intervals after each decision, then probe again: load and storage conditions change
+    - throughput drops by 25%+ while holding => probe one *less* operation: e.g. spinning disk thrashing      */
+class ParallelOpsTuner
+{
+public:
+    explicit ParallelOpsTuner(size_t parallelOpsMax, std::chrono::milliseconds evalInterval = std::chrono::seconds(2));
+
+    size_t getParallelOps() const { return parallelOps_; }
+
+    //call after each completed operation: cumulative numbers for this device
+    void addSample(int itemsDone, int64_t bytesDone);
+
+private:
+    void evaluate(double rate);
+    bool probe(int direction);
+
+    const size_t parallelOpsMax_;
+    const std::chrono::milliseconds evalInterval_;
+    const std::chrono::steady_clock::time_point startTime_ = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point evalStartTime_ = startTime_;
+    SpeedTest speedTest_{evalInterval_};
+
+    size_t parallelOps_ = 1;
+    int probeDirection_ = 0; //0: holding; +1/-1: probing parallelOpsRef_ + probeDirection_
+    size_t parallelOpsRef_ = 1;
+    std::optional<double> rateRef_; //throughput measured at parallelOpsRef_
+    int holdIntervals_ = 0;
+};
 }
 
 #endif //PERF_CHECK_H_87804217589312454
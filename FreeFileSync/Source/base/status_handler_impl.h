@@ -10,39 +10,48 @@
 #include <zen/basic_math.h>
 #include <zen/file_error.h>
 #include <zen/thread.h>
+#include <zen/perf.h>
 #include "process_callback.h"
 #include "speed_test.h"
+#include "structures.h"
 
 
 namespace fff
 {
+/*  progress reporting with near-zero overhead for the workers (thousands of small files per second):
+    - statistics: per-thread counters, written by their owning thread only (no locked RMW, no shared cache lines)
+                  => aggregated by the main thread at its callback interval
+    - status:     per-thread message slot, only the most recent one is kept => coalesced until the main thread picks it up  */
 class AsyncCallback //actor pattern
 {
 public:
     AsyncCallback() {}
 
-    //non-blocking: context of worker thread (and main thread, see reportStats())
+    //non-blocking: context of worker thread (or main thread)
     void updateDataProcessed(int itemsDelta, int64_t bytesDelta) //noexcept!
     {
-        itemsDeltaProcessed_ += itemsDelta;
-        bytesDeltaProcessed_ += bytesDelta;
+        ThreadSlot& slot = getThreadSlot();
+        addLocal(slot.itemsProcessed, itemsDelta);
+        addLocal(slot.bytesProcessed, bytesDelta);
     }
     void updateDataTotal(int itemsDelta, int64_t bytesDelta) //noexcept!
     {
-        itemsDeltaTotal_ += itemsDelta;
-        bytesDeltaTotal_ += bytesDelta;
+        ThreadSlot& slot = getThreadSlot();
+        addLocal(slot.itemsTotal, itemsDelta);
+        addLocal(slot.bytesTotal, bytesDelta);
     }
 
     //context of worker thread
     void updateStatus(std::wstring&& msg) //throw ThreadStopRequest
     {
         assert(!zen::runningOnMainThread());
+        ThreadSlot& slot = getThreadSlot();
+        assert(slot.taskActive);
         {
-            std::lock_guard dummy(lockCurrentStatus_);
-            if (ThreadStatus* ts = getThreadStatus()) //call while holding "lockCurrentStatus_" lock!!
-                ts->statusMsg = std::move(msg);
-            else assert(false);
+            std::lock_guard dummy(slot.lockStatus); //uncontended except for the main thread's (rare) getCurrentStatus()
+            slot.statusMsg.swap(msg);
         }
+        //free previous message outside the lock
         zen::interruptionPoint(); //throw ThreadStopRequest
     }
 
@@ -90,7 +99,8 @@ public:
     }
 
     //context of main thread
-    void waitUntilDone(std::chrono::milliseconds cbInterval, PhaseCallback& cb) //throw X
+    //onInterval: optional, called after each status update
+    void waitUntilDone(std::chrono::milliseconds cbInterval, PhaseCallback& cb, const std::function<void()>& onInterval = nullptr /*throw X*/) //throw X
     {
         assert(zen::runningOnMainThread());
         for (;;)
@@ -126,15 +136,20 @@ public:
             //call back outside of mutex scope:
             cb.updateStatus(getCurrentStatus()); //throw X
             reportStats(cb);
+
+            if (onInterval)
+                onInterval(); //throw X
         }
     }
 
     void notifyTaskBegin(size_t prio) //noexcept
     {
         assert(!zen::runningOnMainThread());
-        const std::thread::id threadId = std::this_thread::get_id();
+        ThreadSlot& slot = getThreadSlot();
+        assert(!slot.taskActive);
+        slot.taskActive = true;
+
         std::lock_guard dummy(lockCurrentStatus_);
-        assert(!getThreadStatus());
 
         //const size_t taskIdx = [&]() -> size_t
         //{
@@ -152,24 +167,34 @@ public:
         if (statusByPriority_.size() < prio + 1)
             statusByPriority_.resize(prio + 1);
 
-        statusByPriority_[prio].push_back({threadId, /*taskIdx,*/ std::wstring()});
+        statusByPriority_[prio].push_back({&slot /*, taskIdx*/});
     }
 
     void notifyTaskEnd() //noexcept
     {
         assert(!zen::runningOnMainThread());
-        const std::thread::id threadId = std::this_thread::get_id();
-        std::lock_guard dummy(lockCurrentStatus_);
+        ThreadSlot& slot = getThreadSlot();
+        assert(slot.taskActive);
+        slot.taskActive = false;
 
-        for (std::vector<ThreadStatus>& sbp : statusByPriority_)
-            for (ThreadStatus& ts : sbp)
-                if (ts.threadId == threadId)
-                {
-                    //usedIndexNums_[ts.taskIdx] = false;
-                    std::swap(ts, sbp.back());
-                    sbp.pop_back();
-                    return;
-                }
+        std::wstring oldMsg;
+        {
+            std::lock_guard dummy(lockCurrentStatus_);
+            {
+                std::lock_guard dummy2(slot.lockStatus);
+                oldMsg.swap(slot.statusMsg);
+            }
+
+            for (std::vector<ThreadStatus>& sbp : statusByPriority_)
+                for (ThreadStatus& ts : sbp)
+                    if (ts.slot == &slot)
+                    {
+                        //usedIndexNums_[ts.taskIdx] = false;
+                        std::swap(ts, sbp.back());
+                        sbp.pop_back();
+                        return;
+                    }
+        }
         assert(false);
     }
 
@@ -185,23 +210,62 @@ private:
     AsyncCallback           (const AsyncCallback&) = delete;
     AsyncCallback& operator=(const AsyncCallback&) = delete;
 
+    struct alignas(64) ThreadSlot //avoid false sharing between workers
+    {
+        explicit ThreadSlot(std::thread::id tid) : threadId(tid) {}
+
+        const std::thread::id threadId;
+
+        //cumulative: written by owning thread only, read by main thread
+        std::atomic<int64_t> itemsProcessed{0}; //
+        std::atomic<int64_t> bytesProcessed{0}; //std:atomic is uninitialized by default!
+        std::atomic<int64_t> itemsTotal    {0}; //
+        std::atomic<int64_t> bytesTotal    {0}; //
+
+        //main thread only: already passed to PhaseCallback
+        int64_t itemsProcessedReported = 0;
+        int64_t bytesProcessedReported = 0;
+        int64_t itemsTotalReported     = 0;
+        int64_t bytesTotalReported     = 0;
+
+        bool taskActive = false; //owning thread only
+
+        std::mutex lockStatus;
+        std::wstring statusMsg;
+    };
+
     struct ThreadStatus
     {
-        std::thread::id threadId;
+        ThreadSlot* slot;
         //size_t   taskIdx = 0; //nice human-readable task id for GUI
-        std::wstring statusMsg;
     };
 
-    ThreadStatus* getThreadStatus() //call while holding "lockCurrentStatus_" lock!!
+    static void addLocal(std::atomic<int64_t>& num, int64_t delta) //single writer => no need for (expensive) fetch_add()
     {
-        assert(!zen::runningOnMainThread());
-        const std::thread::id threadId = std::this_thread::get_id();
+        num.store(num.load(std::memory_order_relaxed) + delta, std::memory_order_release);
+    }
+
+    ThreadSlot& getThreadSlot() //noexcept
+    {
+        //cache lookup at thread level: instanceId_ instead of "this" => AsyncCallback may be recreated at the same address
+        thread_local struct
+        {
+            uint64_t    instanceId = 0;
+            ThreadSlot* slot = nullptr;
+        } cached;
 
-        for (std::vector<ThreadStatus>& sbp : statusByPriority_)
-            for (ThreadStatus& ts : sbp) //thread count is (hopefully) small enough so that linear search won't hurt perf
-                if (ts.threadId == threadId)
-                    return &ts;
-        return nullptr;
+        if (cached.instanceId != instanceId_)
+        {
+            const std::thread::id threadId = std::this_thread::get_id();
+            std::lock_guard dummy(lockThreadSlots_);
+
+            auto it = std::find_if(threadSlots_.begin(), threadSlots_.end(), [&](const std::unique_ptr<ThreadSlot>& ts) { return ts->threadId == threadId; });
+            if (it == threadSlots_.end()) //thread count is small: slots live until AsyncCallback is destroyed
+                it = threadSlots_.insert(threadSlots_.end(), std::make_unique<ThreadSlot>(threadId));
+
+            cached = {instanceId_, it->get()};
+        }
+        return *cached.slot;
     }
 
 #if 0 //maybe not that relevant after all!?
@@ -222,18 +286,33 @@ private:
     {
         assert(zen::runningOnMainThread());
 
-        const std::pair<int, int64_t> deltaProcessed(itemsDeltaProcessed_, bytesDeltaProcessed_);
-        if (deltaProcessed.first != 0 || deltaProcessed.second != 0)
+        int64_t itemsDeltaProcessed = 0;
+        int64_t bytesDeltaProcessed = 0;
+        int64_t itemsDeltaTotal     = 0;
+        int64_t bytesDeltaTotal     = 0;
+
+        auto collectDelta = [](const std::atomic<int64_t>& num, int64_t& reported, int64_t& delta)
         {
-            updateDataProcessed   (-deltaProcessed.first, -deltaProcessed.second); //careful with these atomics: don't just set to 0
-            cb.updateDataProcessed( deltaProcessed.first,  deltaProcessed.second); //noexcept!
-        }
-        const std::pair<int, int64_t> deltaTotal(itemsDeltaTotal_, bytesDeltaTotal_);
-        if (deltaTotal.first != 0 || deltaTotal.second != 0)
+            const int64_t current = num.load(std::memory_order_acquire);
+            delta += current - reported;
+            reported = current;
+        };
         {
-            updateDataTotal   (-deltaTotal.first, -deltaTotal.second);
-            cb.updateDataTotal( deltaTotal.first,  deltaTotal.second); //noexcept!
+            std::lock_guard dummy(lockThreadSlots_);
+            for (const std::unique_ptr<ThreadSlot>& slot : threadSlots_)
+            {
+                collectDelta(slot->itemsProcessed, slot->itemsProcessedReported, itemsDeltaProcessed);
+                collectDelta(slot->bytesProcessed, slot->bytesProcessedReported, bytesDeltaProcessed);
+                collectDelta(slot->itemsTotal,     slot->itemsTotalReported,     itemsDeltaTotal);
+                collectDelta(slot->bytesTotal,     slot->bytesTotalReported,     bytesDeltaTotal);
+            }
         }
+
+        if (itemsDeltaProcessed != 0 || bytesDeltaProcessed != 0)
+            cb.updateDataProcessed(static_cast<int>(itemsDeltaProcessed), bytesDeltaProcessed); //noexcept!
+
+        if (itemsDeltaTotal != 0 || bytesDeltaTotal != 0)
+            cb.updateDataTotal(static_cast<int>(itemsDeltaTotal), bytesDeltaTotal); //noexcept!
     }
 
     //context of main thread, call repreatedly
@@ -252,8 +331,11 @@ private:
             {
                 for (const std::vector<ThreadStatus>& sbp : statusByPriority_)
                     for (const ThreadStatus& ts : sbp)
-                        if (!ts.statusMsg.empty())
-                            return ts.statusMsg;
+                    {
+                        std::lock_guard dummy2(ts.slot->lockStatus);
+                        if (!ts.slot->statusMsg.empty())
+                            return ts.slot->statusMsg;
+                    }
                 return std::wstring();
             }();
         }
@@ -280,11 +362,11 @@ private:
 
     //std::vector<char/*bool*/> usedIndexNums_; //keep info for human-readable task index numbers
 
-    //---- status updates II (lock-free) ----
-    std::atomic<int>     itemsDeltaProcessed_{0}; //
-    std::atomic<int64_t> bytesDeltaProcessed_{0}; //std:atomic is uninitialized by default!
-    std::atomic<int>     itemsDeltaTotal_    {0}; //
-    std::atomic<int64_t> bytesDeltaTotal_    {0}; //
+    //---- status updates II (per thread) ----
+    std::mutex lockThreadSlots_; //only taken on first access per thread + by main thread every callback interval
+    std::vector<std::unique_ptr<ThreadSlot>> threadSlots_;
+
+    const uint64_t instanceId_ = [] { static std::atomic<uint64_t> instanceCount{0}; return ++instanceCount; }();
 };
 
 
@@ -468,6 +550,7 @@ using ParallelWorkItem = std::function<void(ParallelContext& ctx)> /*throw Threa
 namespace
 {
 void massParallelExecute(const std::vector<std::pair<AbstractPath, ParallelWorkItem>>& workload,
+                         const std::map<AfsDevice, size_t>& deviceParallelOps, //items on the same device are processed in parallel up to this limit
                          const Zstring& threadGroupName,
                          PhaseCallback& callback /*throw X*/) //throw X
 {
@@ -492,8 +575,9 @@ void massParallelExecute(const std::vector<std::pair<AbstractPath, ParallelWorkI
         const size_t statusPrio = deviceThreadGroups.size();
 
         auto& threadGroup = deviceThreadGroups.emplace(afsDevice, ThreadGroup<std::function<void()>>(
-                                                           1,
+                                                           std::min(getDeviceParallelOps(deviceParallelOps, afsDevice), wl.size()),
                                                            threadGroupName + Zstr(' ') + utfTo<Zstring>(AFS::getDisplayPath(AbstractPath(afsDevice, AfsPath()))))).first->second;
+        threadGroup.setNumaNode(AFS::selectWorkerNumaNode(wl.front()->first));
 
         for (const std::pair<AbstractPath, ParallelWorkItem>* item : wl)
             threadGroup.run([&acb, statusPrio, &itemPath = item->first, &task = item->second]
@@ -518,11 +602,21 @@ void massParallelExecute(const std::vector<std::pair<AbstractPath, ParallelWorkI
 
 //=====================================================================================================================
 
+//time spent waiting for the sync engine's lock: see progress dialog diagnostics, metrics file
+inline
+void lockSingleThread(std::mutex& singleThread)
+{
+    zen::TraceSpan span("wait for engine lock");
+    singleThread.lock();
+}
+
+
+//run file I/O outside the sync engine's lock: other workers may update file_hierarchy.cpp classes meanwhile
 template <class Function> inline
 auto parallelScope(Function&& fun, std::mutex& singleThread) //throw X
 {
     singleThread.unlock();
-    ZEN_ON_SCOPE_EXIT(singleThread.lock());
+    ZEN_ON_SCOPE_EXIT(lockSingleThread(singleThread));
 
     return fun(); //throw X
 }
@@ -366,6 +366,8 @@ struct MainConfiguration
 
     std::map<AfsDevice, size_t /*parallel operations*/> deviceParallelOps; //should only include devices with >= 2  parallel ops
 
+    bool cacheNeutralCopy = false; //bulk copies: don't evict the page cache of other applications (no GUI option)
+
     bool ignoreErrors = false; //true: errors will still be logged
     size_t autoRetryCount = 0;
     std::chrono::seconds autoRetryDelay{5};
@@ -6,11 +6,14 @@
 
 #include "synchronization.h"
 #include <tuple>
+#include <unordered_map>
 #include <zen/process_priority.h>
 #include <zen/perf.h>
 #include <zen/guid.h>
 #include <zen/crc.h>
+#include <zen/file_io.h>
 #include "algorithm.h"
+#include "bandwidth_limiter.h"
 #include "db_file.h"
 #include "dir_exist_async.h"
 #include "status_handler_impl.h"
@@ -29,6 +32,7 @@ using namespace fff;
 namespace
 {
 const size_t CONFLICTS_PREVIEW_MAX = 25; //=> consider memory consumption, log file size, email size!
+const size_t SYNC_TOTALS_BUFFER_ROWS_MIN = 100; //buffer SyncOpTotals for larger sub trees only => bounded memory, cheap recalculation for the rest
 const size_t MODTIME_ERRORS_PREVIEW_MAX = 25;
 
 
@@ -58,58 +62,245 @@ SyncStatistics::SyncStatistics(const ContainerObject& hierObj)
 SyncStatistics::SyncStatistics(const FilePair& file)
 {
     processFile(file);
-    ++rowsTotal_;
+    if (totals_.conflictCount > 0)
+        addConflictPreview(file.getId());
+    ++totals_.rowsTotal;
+}
+
+
+SyncStatistics::SyncStatistics(const ComparisonColumns& columns)
+{
+    for (size_t row = 0; row < columns.size(); ++row)
+    {
+        const SyncOperation so = columns.getSyncOperation(row);
+        switch (columns.getItemType(row))
+        {
+            case ComparisonColumns::ItemType::file:
+                processFileOp(so, columns.getFileSize<SelectSide::left >(row),
+                              /**/columns.getFileSize<SelectSide::right>(row));
+                break;
+            case ComparisonColumns::ItemType::symlink:
+                processLinkOp(so);
+                break;
+            case ComparisonColumns::ItemType::folder: //sub-items are separate rows => no recursion
+                processFolderOp(so);
+                break;
+        }
+        if (so == SO_UNRESOLVED_CONFLICT)
+            addConflictPreview(columns.getObjectId(row));
+    }
+
+    totals_.rowsTotal = columns.size();
 }
 
 
-inline
 void SyncStatistics::recurse(const ContainerObject& hierObj)
 {
+    addTotals(getSubTreeTotals(hierObj), true /*addSpaceNeeded*/);
+
+    if (conflictsPreview_.size() < CONFLICTS_PREVIEW_MAX &&
+        totals_.conflictCount > 0)
+        collectConflictsPreview(hierObj);
+}
+
+
+/*  toggling sync direction or selection of a single row would require recursing the complete tree: 20 million rows => seconds!
+    => buffer totals per ContainerObject: invalidated bottom-up for the changed item's parents only (FileSystemObject::notifySyncCfgChanged())
+       => O(changed items * folder depth) instead of O(tree)                     */
+SyncOpTotals SyncStatistics::getSubTreeTotals(const ContainerObject& hierObj)
+{
+    if (const SyncOpTotals* totals = hierObj.getSyncOpTotalsBuffered())
+        return *totals;
+
+    SyncStatistics stats;
     for (const FilePair& file : hierObj.refSubFiles())
-        processFile(file);
+        stats.processFile(file);
     for (const SymlinkPair& link : hierObj.refSubLinks())
-        processLink(link);
+        stats.processLink(link);
     for (const FolderPair& folder : hierObj.refSubFolders())
-        processFolder(folder);
+        stats.processFolder(folder);
+
+    stats.totals_.rowsTotal += hierObj.refSubFolders().size();
+    stats.totals_.rowsTotal += hierObj.refSubFiles  ().size();
+    stats.totals_.rowsTotal += hierObj.refSubLinks  ().size();
+
+    if (stats.totals_.rowsTotal >= SYNC_TOTALS_BUFFER_ROWS_MIN)
+        hierObj.setSyncOpTotalsBuffered(stats.totals_);
 
-    rowsTotal_ += hierObj.refSubFolders().size();
-    rowsTotal_ += hierObj.refSubFiles  ().size();
-    rowsTotal_ += hierObj.refSubLinks  ().size();
+    return stats.totals_;
 }
 
 
+void SyncStatistics::addTotals(const SyncOpTotals& totals, bool addSpaceNeeded)
+{
+    totals_.createLeft  += totals.createLeft;
+    totals_.createRight += totals.createRight;
+    totals_.updateLeft  += totals.updateLeft;
+    totals_.updateRight += totals.updateRight;
+    totals_.deleteLeft  += totals.deleteLeft;
+    totals_.deleteRight += totals.deleteRight;
+    totals_.conflictCount += totals.conflictCount;
+    totals_.physicalDeleteLeft  = totals_.physicalDeleteLeft  || totals.physicalDeleteLeft;
+    totals_.physicalDeleteRight = totals_.physicalDeleteRight || totals.physicalDeleteRight;
+
+    totals_.bytesToProcess += totals.bytesToProcess;
+    if (addSpaceNeeded)
+    {
+        totals_.spaceNeededLeft  += totals.spaceNeededLeft;
+        totals_.spaceNeededRight += totals.spaceNeededRight;
+    }
+    totals_.rowsTotal += totals.rowsTotal;
+}
+
+
+void SyncStatistics::collectConflictsPreview(const ContainerObject& hierObj)
+{
+    for (const FilePair& file : hierObj.refSubFiles())
+        if (file.getSyncOperation() == SO_UNRESOLVED_CONFLICT)
+            addConflictPreview(file.getId());
+
+    for (const SymlinkPair& link : hierObj.refSubLinks())
+        if (link.getSyncOperation() == SO_UNRESOLVED_CONFLICT)
+            addConflictPreview(link.getId());
+
+    for (const FolderPair& folder : hierObj.refSubFolders())
+    {
+        if (conflictsPreview_.size() >= CONFLICTS_PREVIEW_MAX)
+            return;
+
+        if (folder.getSyncOperation() == SO_UNRESOLVED_CONFLICT)
+            addConflictPreview(folder.getId());
+
+        if (getSubTreeTotals(folder).conflictCount > 0) //perf: skip sub trees without conflicts
+            collectConflictsPreview(folder); //recurse
+    }
+}
+
+
+/*    minimum disk space needed:
+      DeletionPolicy::permanent:  deletion frees space
+      DeletionPolicy::recycler:   won't free space until recycler is full, but then frees space
+      DeletionPolicy::versioning: depends on whether versioning folder is on a different volume
+    -> if deleted item is a followed symlink, no space is freed
+    -> created/updated/deleted item may be on a different volume than base directory: consider symlinks, junctions!
+
+    => generally assume deletion frees space; may avoid false-positive disk space warnings for recycler and versioning   */
 inline
 void SyncStatistics::processFile(const FilePair& file)
 {
-    switch (file.getSyncOperation()) //evaluate comparison result and sync direction
+    const SyncOperation so = file.getSyncOperation();
+
+    processFileOp(so, file.getFileSize<SelectSide::left >(),
+                  /**/file.getFileSize<SelectSide::right>());
+
+    switch (so) //minimum disk space needed
+    {
+        case SO_CREATE_NEW_LEFT:
+            totals_.spaceNeededLeft += static_cast<int64_t>(file.getFileSize<SelectSide::right>());
+            break;
+
+        case SO_CREATE_NEW_RIGHT:
+            totals_.spaceNeededRight += static_cast<int64_t>(file.getFileSize<SelectSide::left>());
+            break;
+
+        case SO_DELETE_LEFT:
+            if (!file.isFollowedSymlink<SelectSide::left>())
+                totals_.spaceNeededLeft -= static_cast<int64_t>(file.getFileSize<SelectSide::left>());
+            break;
+
+        case SO_DELETE_RIGHT:
+            if (!file.isFollowedSymlink<SelectSide::right>())
+                totals_.spaceNeededRight -= static_cast<int64_t>(file.getFileSize<SelectSide::right>());
+            break;
+
+        case SO_OVERWRITE_LEFT:
+            if (!file.isFollowedSymlink<SelectSide::left>())
+                totals_.spaceNeededLeft -= static_cast<int64_t>(file.getFileSize<SelectSide::left>());
+            totals_.spaceNeededLeft += static_cast<int64_t>(file.getFileSize<SelectSide::right>());
+            break;
+
+        case SO_OVERWRITE_RIGHT:
+            if (!file.isFollowedSymlink<SelectSide::right>())
+                totals_.spaceNeededRight -= static_cast<int64_t>(file.getFileSize<SelectSide::right>());
+            totals_.spaceNeededRight += static_cast<int64_t>(file.getFileSize<SelectSide::left>());
+            break;
+
+        case SO_DO_NOTHING:
+        case SO_EQUAL:
+        case SO_UNRESOLVED_CONFLICT:
+        case SO_COPY_METADATA_TO_LEFT:
+        case SO_COPY_METADATA_TO_RIGHT:
+        case SO_MOVE_LEFT_FROM:
+        case SO_MOVE_RIGHT_FROM:
+        case SO_MOVE_LEFT_TO:
+        case SO_MOVE_RIGHT_TO:
+            break;
+    }
+}
+
+
+inline
+void SyncStatistics::processLink(const SymlinkPair& link)
+{
+    processLinkOp(link.getSyncOperation());
+}
+
+
+inline
+void SyncStatistics::processFolder(const FolderPair& folder)
+{
+    const SyncOperation so = folder.getSyncOperation();
+    processFolderOp(so);
+
+    //since we model logical stats, we recurse, even if deletion variant is "recycler" or "versioning + same volume", which is a single physical operation!
+    addTotals(getSubTreeTotals(folder),
+              //disk space: not 100% correct: in fact more that what our model contains may be deleted (consider file filter!)
+              //what if left or right folder is symlink!? => file operations may happen on different volume!
+              !(so == SO_DELETE_LEFT  && folder.isFollowedSymlink<SelectSide::left >()) &&
+              !(so == SO_DELETE_RIGHT && folder.isFollowedSymlink<SelectSide::right>()));
+}
+
+
+void SyncStatistics::addConflictPreview(FileSystemObject::ObjectIdConst objId)
+{
+    if (conflictsPreview_.size() < CONFLICTS_PREVIEW_MAX)
+        if (const FileSystemObject* fsObj = FileSystemObject::retrieve(objId))
+            conflictsPreview_.push_back({fsObj->getRelativePathAny(), fsObj->getSyncOpConflict()});
+}
+
+
+inline
+void SyncStatistics::processFileOp(SyncOperation so, uint64_t fileSizeL, uint64_t fileSizeR)
+{
+    switch (so) //evaluate comparison result and sync direction
     {
         case SO_CREATE_NEW_LEFT:
-            ++createLeft_;
-            bytesToProcess_ += static_cast<int64_t>(file.getFileSize<SelectSide::right>());
+            ++totals_.createLeft;
+            totals_.bytesToProcess += static_cast<int64_t>(fileSizeR);
             break;
 
         case SO_CREATE_NEW_RIGHT:
-            ++createRight_;
-            bytesToProcess_ += static_cast<int64_t>(file.getFileSize<SelectSide::left>());
+            ++totals_.createRight;
+            totals_.bytesToProcess += static_cast<int64_t>(fileSizeL);
             break;
 
         case SO_DELETE_LEFT:
-            ++deleteLeft_;
-            physicalDeleteLeft_ = true;
+            ++totals_.deleteLeft;
+            totals_.physicalDeleteLeft = true;
             break;
 
         case SO_DELETE_RIGHT:
-            ++deleteRight_;
-            physicalDeleteRight_ = true;
+            ++totals_.deleteRight;
+            totals_.physicalDeleteRight = true;
             break;
 
         case SO_MOVE_LEFT_TO:
-            ++updateLeft_;
-            //physicalDeleteLeft_ ? -> usually, no; except when falling back to "copy + delete"
+            ++totals_.updateLeft;
+            //physicalDeleteLeft ? -> usually, no; except when falling back to "copy + delete"
             break;
 
         case SO_MOVE_RIGHT_TO:
-            ++updateRight_;
+            ++totals_.updateRight;
             break;
 
         case SO_MOVE_LEFT_FROM:  //ignore; already counted
@@ -117,29 +308,27 @@ void SyncStatistics::processFile(const FilePair& file)
             break;
 
         case SO_OVERWRITE_LEFT:
-            ++updateLeft_;
-            bytesToProcess_ += static_cast<int64_t>(file.getFileSize<SelectSide::right>());
-            physicalDeleteLeft_ = true;
+            ++totals_.updateLeft;
+            totals_.bytesToProcess += static_cast<int64_t>(fileSizeR);
+            totals_.physicalDeleteLeft = true;
             break;
 
         case SO_OVERWRITE_RIGHT:
-            ++updateRight_;
-            bytesToProcess_ += static_cast<int64_t>(file.getFileSize<SelectSide::left>());
-            physicalDeleteRight_ = true;
+            ++totals_.updateRight;
+            totals_.bytesToProcess += static_cast<int64_t>(fileSizeL);
+            totals_.physicalDeleteRight = true;
             break;
 
         case SO_UNRESOLVED_CONFLICT:
-            ++conflictCount_;
-            if (conflictsPreview_.size() < CONFLICTS_PREVIEW_MAX)
-                conflictsPreview_.push_back({file.getRelativePathAny(), file.getSyncOpConflict()});
+            ++totals_.conflictCount;
             break;
 
         case SO_COPY_METADATA_TO_LEFT:
-            ++updateLeft_;
+            ++totals_.updateLeft;
             break;
 
         case SO_COPY_METADATA_TO_RIGHT:
-            ++updateRight_;
+            ++totals_.updateRight;
             break;
 
         case SO_DO_NOTHING:
@@ -150,44 +339,42 @@ void SyncStatistics::processFile(const FilePair& file)
 
 
 inline
-void SyncStatistics::processLink(const SymlinkPair& link)
+void SyncStatistics::processLinkOp(SyncOperation so)
 {
-    switch (link.getSyncOperation()) //evaluate comparison result and sync direction
+    switch (so) //evaluate comparison result and sync direction
     {
         case SO_CREATE_NEW_LEFT:
-            ++createLeft_;
+            ++totals_.createLeft;
             break;
 
         case SO_CREATE_NEW_RIGHT:
-            ++createRight_;
+            ++totals_.createRight;
             break;
 
         case SO_DELETE_LEFT:
-            ++deleteLeft_;
-            physicalDeleteLeft_ = true;
+            ++totals_.deleteLeft;
+            totals_.physicalDeleteLeft = true;
             break;
 
         case SO_DELETE_RIGHT:
-            ++deleteRight_;
-            physicalDeleteRight_ = true;
+            ++totals_.deleteRight;
+            totals_.physicalDeleteRight = true;
             break;
 
         case SO_OVERWRITE_LEFT:
         case SO_COPY_METADATA_TO_LEFT:
-            ++updateLeft_;
-            physicalDeleteLeft_ = true;
+            ++totals_.updateLeft;
+            totals_.physicalDeleteLeft = true;
             break;
 
         case SO_OVERWRITE_RIGHT:
         case SO_COPY_METADATA_TO_RIGHT:
-            ++updateRight_;
-            physicalDeleteRight_ = true;
+            ++totals_.updateRight;
+            totals_.physicalDeleteRight = true;
             break;
 
         case SO_UNRESOLVED_CONFLICT:
-            ++conflictCount_;
-            if (conflictsPreview_.size() < CONFLICTS_PREVIEW_MAX)
-                conflictsPreview_.push_back({link.getRelativePathAny(), link.getSyncOpConflict()});
+            ++totals_.conflictCount;
             break;
 
         case SO_MOVE_LEFT_FROM:
@@ -204,42 +391,40 @@ void SyncStatistics::processLink(const SymlinkPair& link)
 
 
 inline
-void SyncStatistics::processFolder(const FolderPair& folder)
+void SyncStatistics::processFolderOp(SyncOperation so)
 {
-    switch (folder.getSyncOperation()) //evaluate comparison result and sync direction
+    switch (so) //evaluate comparison result and sync direction
     {
         case SO_CREATE_NEW_LEFT:
-            ++createLeft_;
+            ++totals_.createLeft;
             break;
 
         case SO_CREATE_NEW_RIGHT:
-            ++createRight_;
+            ++totals_.createRight;
             break;
 
         case SO_DELETE_LEFT: //if deletion variant == versioning with user-defined directory existing on other volume, this results in a full copy + delete operation!
-            ++deleteLeft_;    //however we cannot (reliably) anticipate this situation, fortunately statistics can be adapted during sync!
-            physicalDeleteLeft_ = true;
+            ++totals_.deleteLeft;    //however we cannot (reliably) anticipate this situation, fortunately statistics can be adapted during sync!
+            totals_.physicalDeleteLeft = true;
             break;
 
         case SO_DELETE_RIGHT:
-            ++deleteRight_;
-            physicalDeleteRight_ = true;
+            ++totals_.deleteRight;
+            totals_.physicalDeleteRight = true;
             break;
 
         case SO_UNRESOLVED_CONFLICT:
-            ++conflictCount_;
-            if (conflictsPreview_.size() < CONFLICTS_PREVIEW_MAX)
-                conflictsPreview_.push_back({folder.getRelativePathAny(), folder.getSyncOpConflict()});
+            ++totals_.conflictCount;
             break;
 
         case SO_OVERWRITE_LEFT:
         case SO_COPY_METADATA_TO_LEFT:
-            ++updateLeft_;
+            ++totals_.updateLeft;
             break;
 
         case SO_OVERWRITE_RIGHT:
         case SO_COPY_METADATA_TO_RIGHT:
-            ++updateRight_;
+            ++totals_.updateRight;
             break;
 
         case SO_MOVE_LEFT_FROM:
@@ -252,117 +437,9 @@ void SyncStatistics::processFolder(const FolderPair& folder)
         case SO_EQUAL:
             break;
     }
-
-    recurse(folder); //since we model logical stats, we recurse, even if deletion variant is "recycler" or "versioning + same volume", which is a single physical operation!
 }
 
 
-/*    DeletionPolicy::permanent:  deletion frees space
-      DeletionPolicy::recycler:   won't free space until recycler is full, but then frees space
-      DeletionPolicy::versioning: depends on whether versioning folder is on a different volume
-    -> if deleted item is a followed symlink, no space is freed
-    -> created/updated/deleted item may be on a different volume than base directory: consider symlinks, junctions!
-
-    => generally assume deletion frees space; may avoid false-positive disk space warnings for recycler and versioning   */
-class MinimumDiskSpaceNeeded
-{
-public:
-    static std::pair<int64_t, int64_t> calculate(const BaseFolderPair& baseFolder)
-    {
-        MinimumDiskSpaceNeeded inst;
-        inst.recurse(baseFolder);
-        return {inst.spaceNeededLeft_, inst.spaceNeededRight_};
-    }
-
-private:
-    void recurse(const ContainerObject& hierObj)
-    {
-        //process files
-        for (const FilePair& file : hierObj.refSubFiles())
-            switch (file.getSyncOperation()) //evaluate comparison result and sync direction
-            {
-                case SO_CREATE_NEW_LEFT:
-                    spaceNeededLeft_ += static_cast<int64_t>(file.getFileSize<SelectSide::right>());
-                    break;
-
-                case SO_CREATE_NEW_RIGHT:
-                    spaceNeededRight_ += static_cast<int64_t>(file.getFileSize<SelectSide::left>());
-                    break;
-
-                case SO_DELETE_LEFT:
-                    if (!file.isFollowedSymlink<SelectSide::left>())
-                        spaceNeededLeft_ -= static_cast<int64_t>(file.getFileSize<SelectSide::left>());
-                    break;
-
-                case SO_DELETE_RIGHT:
-                    if (!file.isFollowedSymlink<SelectSide::right>())
-                        spaceNeededRight_ -= static_cast<int64_t>(file.getFileSize<SelectSide::right>());
-                    break;
-
-                case SO_OVERWRITE_LEFT:
-                    if (!file.isFollowedSymlink<SelectSide::left>())
-                        spaceNeededLeft_ -= static_cast<int64_t>(file.getFileSize<SelectSide::left>());
-                    spaceNeededLeft_ += static_cast<int64_t>(file.getFileSize<SelectSide::right>());
-                    break;
-
-                case SO_OVERWRITE_RIGHT:
-                    if (!file.isFollowedSymlink<SelectSide::right>())
-                        spaceNeededRight_ -= static_cast<int64_t>(file.getFileSize<SelectSide::right>());
-                    spaceNeededRight_ += static_cast<int64_t>(file.getFileSize<SelectSide::left>());
-                    break;
-
-                case SO_DO_NOTHING:
-                case SO_EQUAL:
-                case SO_UNRESOLVED_CONFLICT:
-                case SO_COPY_METADATA_TO_LEFT:
-                case SO_COPY_METADATA_TO_RIGHT:
-                case SO_MOVE_LEFT_FROM:
-                case SO_MOVE_RIGHT_FROM:
-                case SO_MOVE_LEFT_TO:
-                case SO_MOVE_RIGHT_TO:
-                    break;
-            }
-
-        //symbolic links
-        //[...]
-
-        //recurse into sub-dirs
-        for (const FolderPair& folder : hierObj.refSubFolders())
-            switch (folder.getSyncOperation())
-            {
-                case SO_DELETE_LEFT:
-                    if (!folder.isFollowedSymlink<SelectSide::left>())
-                        recurse(folder); //not 100% correct: in fact more that what our model contains may be deleted (consider file filter!)
-                    break;
-                case SO_DELETE_RIGHT:
-                    if (!folder.isFollowedSymlink<SelectSide::right>())
-                        recurse(folder);
-                    break;
-
-                case SO_MOVE_LEFT_FROM:
-                case SO_MOVE_RIGHT_FROM:
-                case SO_MOVE_LEFT_TO:
-                case SO_MOVE_RIGHT_TO:
-                    assert(false);
-                    [[fallthrough]];
-                case SO_CREATE_NEW_LEFT:
-                case SO_CREATE_NEW_RIGHT:
-                case SO_OVERWRITE_LEFT:
-                case SO_OVERWRITE_RIGHT:
-                case SO_COPY_METADATA_TO_LEFT:
-                case SO_COPY_METADATA_TO_RIGHT:
-                case SO_DO_NOTHING:
-                case SO_EQUAL:
-                case SO_UNRESOLVED_CONFLICT:
-                    recurse(folder); //not 100% correct: what if left or right folder is symlink!? => file operations may happen on different volume!
-                    break;
-            }
-    }
-
-    int64_t spaceNeededLeft_  = 0;
-    int64_t spaceNeededRight_ = 0;
-};
-
 //-----------------------------------------------------------------------------------------------------------
 
 std::vector<FolderPairSyncCfg> fff::extractSyncCfg(const MainConfiguration& mainCfg)
@@ -394,6 +471,42 @@ std::vector<FolderPairSyncCfg> fff::extractSyncCfg(const MainConfiguration& main
     return output;
 }
 
+
+namespace
+{
+void prepareSyncSessions(const std::vector<const BaseFolderPair*>& baseFolders, const std::vector<SyncStatistics>& folderPairStats) //noexcept
+{
+    assert(baseFolders.size() == folderPairStats.size());
+    std::set<AfsDevice> devices;
+
+    for (size_t i = 0; i < baseFolders.size(); ++i)
+        if (getCUD(folderPairStats[i]) > 0) //copying from one side to the other needs both devices
+        {
+            devices.insert(baseFolders[i]->getAbstractPath<SelectSide::left >().afsDevice);
+            devices.insert(baseFolders[i]->getAbstractPath<SelectSide::right>().afsDevice);
+        }
+
+    for (const AfsDevice& afsDevice : devices)
+        if (!AFS::isNullDevice(afsDevice))
+            AFS::prepareSessions(afsDevice, 1 /*sessionCount: synchronization is sequential*/); //noexcept
+}
+}
+
+
+void fff::prepareSyncSessions(const FolderComparison& folderCmp) //noexcept
+{
+    std::vector<const BaseFolderPair*> baseFolders;
+    std::vector<SyncStatistics> folderPairStats;
+
+    std::for_each(begin(folderCmp), end(folderCmp), [&](const BaseFolderPair& baseFolder)
+    {
+        baseFolders.push_back(&baseFolder);
+        folderPairStats.emplace_back(baseFolder);
+    });
+
+    ::prepareSyncSessions(baseFolders, folderPairStats); //noexcept
+}
+
 //------------------------------------------------------------------------------------------------------------
 
 namespace
@@ -447,9 +560,223 @@ bool significantDifferenceDetected(const SyncStatistics& folderPairStat)
     return nonMatchingRows >= 10 && nonMatchingRows > 0.5 * folderPairStat.rowCount();
 }
 
+
+//--------------------- hard links -------------------------
+/*  source items of a hard link group: same file ID (inode) with link count > 1
+    - file ID is unique per device only: compare within one base folder pair, skip followed symlinks (may point to a different device)
+    - mount points inside the base folder: two different files with same file ID *and* same size + modification time? sufficiently unlikely  */
+struct HardLinkId
+{
+    AFS::FingerPrint filePrint;
+    uint64_t fileSize;
+    time_t modTime;
+
+    std::strong_ordering operator<=>(const HardLinkId&) const = default;
+};
+
+template <SelectSide side> inline
+std::optional<HardLinkId> getHardLinkId(const FilePair& file)
+{
+    if (file.getLinkCount<side>() > 1 && file.getFilePrint<side>() != 0 && !file.isFollowedSymlink<side>())
+        return HardLinkId{file.getFilePrint<side>(), file.getFileSize<side>(), file.getLastWriteTime<side>()};
+    return {};
+}
+
+
+//bytes to copy which are just additional names of source files already copied: created as hard links if supported by target device
+int64_t getHardLinkedBytesToCopy(const BaseFolderPair& baseFolder)
+{
+    int64_t bytesLinked = 0;
+    std::set<HardLinkId> copiedL; //source: right side
+    std::set<HardLinkId> copiedR; //source: left side
+
+    auto recurse = [&](const ContainerObject& hierObj, auto& recurseRef) -> void
+    {
+        for (const FilePair& file : hierObj.refSubFiles())
+            if (const SyncOperation so = file.getSyncOperation();
+                so == SO_CREATE_NEW_LEFT || so == SO_CREATE_NEW_RIGHT)
+                if (const std::optional<HardLinkId> hardLinkId = so == SO_CREATE_NEW_LEFT ?
+                                                                 getHardLinkId<SelectSide::right>(file) :
+                                                                 getHardLinkId<SelectSide::left >(file))
+                    if (!(so == SO_CREATE_NEW_LEFT ? copiedL : copiedR).insert(*hardLinkId).second)
+                        bytesLinked += static_cast<int64_t>(hardLinkId->fileSize);
+
+        for (const FolderPair& folder : hierObj.refSubFolders())
+            recurseRef(folder, recurseRef);
+    };
+    recurse(baseFolder, recurse);
+
+    return bytesLinked;
+}
+
+//--------------------- fan-out -------------------------
+/*  same source folder in several folder pairs: new files are read once and written to all targets, see AFS::copyNewFileFanOut()
+    - targets are items of *later* folder pairs => not yet processed, updated as if copied by their own folder pair
+    - failed targets are left unchanged => copied again (with regular error handling) by their folder pair          */
+const uint64_t FAN_OUT_COPY_MIN_SIZE = 1024 * 1024; //not worth the writer threads for small files
+
+struct FanOutTarget
+{
+    FilePair* file;
+    SelectSide sideTrg;
+};
+using FanOutTargets = std::map<const FilePair*, std::vector<FanOutTarget>>;
+
+
+template <SelectSide sideSrcI, SelectSide sideSrcJ>
+void addFanOutTargets(const ContainerObject& hierI, ContainerObject& hierJ, FanOutTargets& fanOutTargets)
+{
+    constexpr SyncOperation soCreateI = sideSrcI == SelectSide::left ? SO_CREATE_NEW_RIGHT : SO_CREATE_NEW_LEFT;
+    constexpr SyncOperation soCreateJ = sideSrcJ == SelectSide::left ? SO_CREATE_NEW_RIGHT : SO_CREATE_NEW_LEFT;
+
+    //hard links: see synchronizeFileInt()
+    std::map<Zstring, FilePair*> filesJ; //same source folder => same file system => compare case-sensitively
+    for (FilePair& file : hierJ.refSubFiles())
+        if (file.getSyncOperation() == soCreateJ && file.getFileSize<sideSrcJ>() >= FAN_OUT_COPY_MIN_SIZE && !getHardLinkId<sideSrcJ>(file))
+            filesJ.emplace(file.getItemName<sideSrcJ>(), &file);
+
+    if (!filesJ.empty())
+        for (const FilePair& file : hierI.refSubFiles())
+            if (file.getSyncOperation() == soCreateI && !getHardLinkId<sideSrcI>(file))
+                if (auto it = filesJ.find(file.getItemName<sideSrcI>());
+                    it != filesJ.end())
+                {
+                    FilePair& fileJ = *it->second;
+                    if (fileJ.getFileSize     <sideSrcJ>() == file.getFileSize     <sideSrcI>() &&
+                        fileJ.getLastWriteTime<sideSrcJ>() == file.getLastWriteTime<sideSrcI>())
+                        fanOutTargets[&file].push_back({&fileJ, OtherSide<sideSrcJ>::value});
+                }
+
+    std::map<Zstring, FolderPair*> foldersJ;
+    for (FolderPair& folder : hierJ.refSubFolders())
+        if (!folder.isEmpty<sideSrcJ>())
+            foldersJ.emplace(folder.getItemName<sideSrcJ>(), &folder);
+
+    if (!foldersJ.empty())
+        for (const FolderPair& folder : hierI.refSubFolders())
+            if (!folder.isEmpty<sideSrcI>())
+                if (auto it = foldersJ.find(folder.getItemName<sideSrcI>());
+                    it != foldersJ.end())
+                    addFanOutTargets<sideSrcI, sideSrcJ>(folder, *it->second, fanOutTargets);
+}
+
+
+template <SelectSide sideSrcI, SelectSide sideSrcJ>
+void addFanOutTargets(const BaseFolderPair& baseFolderI, BaseFolderPair& baseFolderJ, FanOutTargets& fanOutTargets)
+{
+    if (!AFS::isNullPath(baseFolderI.getAbstractPath<sideSrcI>()) &&
+        baseFolderI.getAbstractPath<sideSrcI>() == baseFolderJ.getAbstractPath<sideSrcJ>() &&
+        baseFolderI.getAbstractPath<OtherSide<sideSrcI>::value>() != baseFolderJ.getAbstractPath<OtherSide<sideSrcJ>::value>())
+        addFanOutTargets<sideSrcI, sideSrcJ>(static_cast<const ContainerObject&>(baseFolderI), baseFolderJ, fanOutTargets);
+}
+
+
+FanOutTargets getFanOutTargets(FolderComparison& folderCmp, const std::vector<int>& skipFolderPair)
+{
+    FanOutTargets fanOutTargets;
+    for (size_t i = 0; i < folderCmp.size(); ++i)
+        if (!skipFolderPair[i])
+            for (size_t j = i + 1; j < folderCmp.size(); ++j)
+                if (!skipFolderPair[j])
+                {
+                    const BaseFolderPair& baseFolderI = *folderCmp[i];
+                    /**/  BaseFolderPair& baseFolderJ = *folderCmp[j];
+                    addFanOutTargets<SelectSide::left,  SelectSide::left >(baseFolderI, baseFolderJ, fanOutTargets);
+                    addFanOutTargets<SelectSide::left,  SelectSide::right>(baseFolderI, baseFolderJ, fanOutTargets);
+                    addFanOutTargets<SelectSide::right, SelectSide::left >(baseFolderI, baseFolderJ, fanOutTargets);
+                    addFanOutTargets<SelectSide::right, SelectSide::right>(baseFolderI, baseFolderJ, fanOutTargets);
+                }
+    return fanOutTargets;
+}
+
+
+//still to be created when the source is copied, e.g. not yet done by a previous fan-out, parent folder existing (its folder pair did not run yet)
+template <SelectSide sideTrg>
+bool isFanOutTargetPending(const FilePair& file)
+{
+    if (file.getSyncOperation() != (sideTrg == SelectSide::left ? SO_CREATE_NEW_LEFT : SO_CREATE_NEW_RIGHT))
+        return false;
+
+    if (auto parentFolder = dynamic_cast<const FolderPair*>(&file.parent()))
+        return !parentFolder->isEmpty<sideTrg>();
+    return file.base().getFolderStatus<sideTrg>() == BaseFolderStatus::existing;
+}
+
+
+//update FilePair: same as if created by its own folder pair, see synchronizeFileInt()
+template <SelectSide sideTrg>
+void setFanOutTargetSynced(FilePair& file, const AFS::FileCopyResult& result)
+{
+    constexpr SelectSide sideSrc = OtherSide<sideTrg>::value;
+
+    file.setSyncedTo<sideTrg>(file.getItemName<sideSrc>(), result.fileSize,
+                              result.modTime, //target time set from source
+                              result.modTime,
+                              result.targetFilePrint,
+                              result.sourceFilePrint,
+                              false, file.isFollowedSymlink<sideSrc>());
+}
+
+//--------------------- target-side deduplication -------------------------
+/*  new file already existing elsewhere on the target device (e.g. folders reorganized beyond what move detection finds):
+    copy it within the target instead of transferring the source again, see AFS::copyFileTransactional() -> copyFileForSameAfsType()
+    - candidates: files in sync "by content" (=> SHA-256 known, e.g. from sync.ffs_db) with same size and modification time
+    - SHA-256 of the new file must be available without a transfer: server-side digest or native source
+    - source and target of different device types only: copyFileForSameAfsType() is used anyway otherwise            */
+const uint64_t TARGET_DEDUP_MIN_SIZE = 1024 * 1024; //not worth the source hashing for small files
+
+struct TargetDuplicate
+{
+    AbstractPath filePath;
+    AFS::StreamAttributes attr;
+    ContentHash contentHash;
+};
+using TargetDuplicates = std::map<std::pair<uint64_t /*file size*/, time_t /*modification time*/>, std::vector<TargetDuplicate>>;
+
+
+template <SelectSide side>
+void addTargetDuplicates(const ContainerObject& hierObj, TargetDuplicates& targetDups)
+{
+    for (const FilePair& file : hierObj.refSubFiles())
+        if (file.getSyncOperation() == SO_EQUAL && //=> not modified by synchronization
+            file.getFileSize<side>() >= TARGET_DEDUP_MIN_SIZE &&
+            file.getContentHash<side>() != ContentHash{})
+            targetDups[{file.getFileSize<side>(), file.getLastWriteTime<side>()}].push_back(
+        {
+            file.getAbstractPath<side>(),
+            {file.getLastWriteTime<side>(), file.getFileSize<side>(), file.getFilePrint<side>()},
+            file.getContentHash<side>()
+        });
+
+    for (const FolderPair& folder : hierObj.refSubFolders())
+        addTargetDuplicates<side>(folder, targetDups);
+}
+
+
+TargetDuplicates getTargetDuplicates(const FolderComparison& folderCmp, const std::vector<int>& skipFolderPair)
+{
+    TargetDuplicates targetDups;
+    for (size_t i = 0; i < folderCmp.size(); ++i)
+        if (!skipFolderPair[i])
+        {
+            const BaseFolderPair& baseFolder = *folderCmp[i];
+            const AbstractPath& basePathL = baseFolder.getAbstractPath<SelectSide::left >();
+            const AbstractPath& basePathR = baseFolder.getAbstractPath<SelectSide::right>();
+
+            //caveat: typeid returns static type for pointers, dynamic type for references!!!
+            if (typeid(basePathL.afsDevice.ref()) != typeid(basePathR.afsDevice.ref()))
+            {
+                if (AFS::hasServerSideCopy(basePathL)) addTargetDuplicates<SelectSide::left >(baseFolder, targetDups);
+                if (AFS::hasServerSideCopy(basePathR)) addTargetDuplicates<SelectSide::right>(baseFolder, targetDups);
+            }
+        }
+    return targetDups;
+}
+
 //#################################################################################################################
 
 //--------------------- data verification -------------------------
+//write file data to disk, then drop it from the page cache => verification reads what's *actually* on disk
 void flushFileBuffers(const Zstring& nativeFilePath) //throw FileError
 {
     const int fdFile = ::open(nativeFilePath.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
@@ -457,22 +784,40 @@ void flushFileBuffers(const Zstring& nativeFilePath) //throw FileError
         THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot open file %x."), L"%x", fmtPath(nativeFilePath)), "open");
     ZEN_ON_SCOPE_EXIT(::close(fdFile));
 
-    if (::fsync(fdFile) != 0)
-        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(nativeFilePath)), "fsync");
+    //fdatasync(): skip flushing metadata not needed to read the data back (e.g. access/modification time) => cheaper than fsync() for small files
+    if (::fdatasync(fdFile) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(nativeFilePath)), "fdatasync");
+
+    //pages are clean now => can be evicted; "advice": ignore errors
+    [[maybe_unused]] const int rv = ::posix_fadvise(fdFile, 0 /*offset*/, 0 /*len: until EOF*/, POSIX_FADV_DONTNEED);
 }
 
 
-void verifyFiles(const AbstractPath& sourcePath, const AbstractPath& targetPath, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+//sourceHash: optional; SHA-256 calculated while copying => read back target only (e.g. don't download from SFTP a second time)
+void verifyFiles(const AbstractPath& sourcePath, const AbstractPath& targetPath, const std::string& sourceHash, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
 {
     try
     {
-        //do like "copy /v": 1. flush target file buffers, 2. read again as usual (using OS buffers)
-        // => it seems OS buffers are not invalidated by this: snake oil???
+        //do like "copy /v": 1. flush target file buffers, 2. read again (native: evicted from OS buffers => read from disk)
         if (const Zstring& targetPathNative = getNativeItemPath(targetPath);
             !targetPathNative.empty())
             flushFileBuffers(targetPathNative); //throw FileError
 
-        if (!filesHaveSameContent(sourcePath, targetPath, notifyUnbufferedIO)) //throw FileError, X
+        bool sameContent = false;
+        if (!sourceHash.empty())
+        {
+            //server-side checksum (if available) saves reading back the target
+            std::string targetHash = AFS::getServerFileDigest(targetPath).sha256; //throw FileError
+            if (targetHash.empty())
+                targetHash = getFileSha256(targetPath, notifyUnbufferedIO); //throw FileError, X
+            sameContent = targetHash == sourceHash;
+        }
+        else if (const std::optional<bool> sameDigest = digestContentMatches(sourcePath, targetPath, nullptr /*contentHash*/, notifyUnbufferedIO)) //throw FileError, X
+            sameContent = *sameDigest;
+        else
+            sameContent = filesHaveSameContent(sourcePath, targetPath, 1 /*parallelOps*/, nullptr /*contentHash*/, nullptr /*equalPrefix*/, notifyUnbufferedIO); //throw FileError, X
+
+        if (!sameContent)
             throw FileError(replaceCpy(replaceCpy(_("%x and %y have different content."),
                                                   L"%x", L'\n' + fmtPath(AFS::getDisplayPath(sourcePath))),
                                        L"%y", L'\n' + fmtPath(AFS::getDisplayPath(targetPath))));
@@ -529,6 +874,14 @@ inline
 void removeFilePlain(const AbstractPath& ap, std::mutex& singleThread) //throw FileError
 { parallelScope([ap] { AFS::removeFilePlain(ap); /*throw FileError*/ }, singleThread); }
 
+inline
+bool createHardLink(const AbstractPath& apExisting, const AbstractPath& apNew, std::mutex& singleThread) //throw FileError
+{ return parallelScope([apExisting, apNew] { return AFS::createHardLink(apExisting, apNew); /*throw FileError*/ }, singleThread); }
+
+inline
+AFS::FileDigest getServerFileDigest(const AbstractPath& ap, std::mutex& singleThread) //throw FileError
+{ return parallelScope([ap] { return AFS::getServerFileDigest(ap); /*throw FileError*/ }, singleThread); }
+
 //--------------------------------------------------------------
 //ATTENTION CALLBACKS: they also run asynchronously *outside* the singleThread lock!
 //--------------------------------------------------------------
@@ -546,12 +899,53 @@ AFS::FileCopyResult copyFileTransactional(const AbstractPath& apSource, const AF
                                           bool copyFilePermissions,
                                           bool transactionalCopy,
                                           const std::function<void()>& onDeleteTargetFile /*throw X*/,
+                                          bool deleteTargetPermanently,
+                                          bool calcContentHash,
                                           const IoCallback& notifyUnbufferedIO /*throw X*/,
                                           std::mutex& singleThread)
 {
     return parallelScope([=]
     {
-        return AFS::copyFileTransactional(apSource, attrSource, apTarget, copyFilePermissions, transactionalCopy, onDeleteTargetFile, notifyUnbufferedIO); //throw FileError, ErrorFileLocked, X
+        return AFS::copyFileTransactional(apSource, attrSource, apTarget, copyFilePermissions, transactionalCopy, onDeleteTargetFile, deleteTargetPermanently, calcContentHash, notifyUnbufferedIO); //throw FileError, ErrorFileLocked, X
+    }, singleThread);
+}
+
+inline
+std::vector<std::variant<AFS::FileCopyResult, FileError>> copyNewFileFanOut(const AbstractPath& apSource, const AFS::StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
+                                                                            const std::vector<AbstractPath>& apTargets,
+                                                                            bool transactionalCopy,
+                                                                            const IoCallback& notifyUnbufferedIO /*throw X*/,
+                                                                            std::mutex& singleThread)
+{
+    return parallelScope([=]
+    {
+        return AFS::copyNewFileFanOut(apSource, attrSource, apTargets, transactionalCopy, notifyUnbufferedIO); //throw FileError, ErrorFileLocked, X
+    }, singleThread);
+}
+
+inline
+std::optional<std::vector<std::variant<AFS::FileCopyResult, FileError>>> copyNewFilesBulk(const std::vector<AFS::BulkCopyFile>& files, //throw X
+                                                                                          bool transactionalCopy,
+                                                                                          const IoCallback& notifyUnbufferedIO /*throw X*/,
+                                                                                          std::mutex& singleThread)
+{
+    return parallelScope([=] { return AFS::copyNewFilesBulk(files, transactionalCopy, notifyUnbufferedIO); /*throw X*/ }, singleThread);
+}
+
+inline
+std::optional<AFS::FileCopyResult> updateFileDelta(const AbstractPath& apSource, const AFS::StreamAttributes& attrSource, //throw FileError, ErrorFileLocked, X
+                                                   const AbstractPath& apTarget, uint64_t targetSize,
+                                                   const std::optional<AFS::EqualPrefix>& equalPrefix,
+                                                   bool transactionalCopy,
+                                                   const std::function<void()>& onDeleteTargetFile /*throw X*/,
+                                                   bool deleteTargetPermanently,
+                                                   bool calcContentHash,
+                                                   const IoCallback& notifyUnbufferedIO /*throw X*/,
+                                                   std::mutex& singleThread)
+{
+    return parallelScope([=]
+    {
+        return AFS::updateFileDelta(apSource, attrSource, apTarget, targetSize, equalPrefix, transactionalCopy, onDeleteTargetFile, deleteTargetPermanently, calcContentHash, notifyUnbufferedIO); //throw FileError, ErrorFileLocked, X
     }, singleThread);
 }
 
@@ -563,6 +957,10 @@ inline //FileVersioner::revisionFile() is internally synchronized!
 void revisionFile(FileVersioner& versioner, const FileDescriptor& fileDescr, const Zstring& relativePath, const IoCallback& notifyUnbufferedIO /*throw X*/, std::mutex& singleThread) //throw FileError, X
 { parallelScope([=, &versioner] { return versioner.revisionFile(fileDescr, relativePath, notifyUnbufferedIO); /*throw FileError, X*/ }, singleThread); }
 
+inline //FileVersioner::revisionFileAsClone() is internally synchronized!
+bool revisionFileAsClone(FileVersioner& versioner, const FileDescriptor& fileDescr, const Zstring& relativePath, std::mutex& singleThread) //throw FileError
+{ return parallelScope([=, &versioner] { return versioner.revisionFileAsClone(fileDescr, relativePath); /*throw FileError*/ }, singleThread); }
+
 inline //FileVersioner::revisionSymlink() is internally synchronized!
 void revisionSymlink(FileVersioner& versioner, const AbstractPath& linkPath, const Zstring& relativePath, std::mutex& singleThread) //throw FileError
 { parallelScope([=, &versioner] { return versioner.revisionSymlink(linkPath, relativePath); /*throw FileError*/ }, singleThread); }
@@ -577,8 +975,12 @@ void revisionFolder(FileVersioner& versioner,
 { parallelScope([=, &versioner] { versioner.revisionFolder(folderPath, relativePath, onBeforeFileMove, onBeforeFolderMove, notifyUnbufferedIO); /*throw FileError, X*/ }, singleThread); }
 
 inline
-void verifyFiles(const AbstractPath& apSource, const AbstractPath& apTarget, const IoCallback& notifyUnbufferedIO /*throw X*/, std::mutex& singleThread) //throw FileError, X
-{ parallelScope([=] { ::verifyFiles(apSource, apTarget, notifyUnbufferedIO); /*throw FileError, X*/ }, singleThread); }
+void verifyFiles(const AbstractPath& apSource, const AbstractPath& apTarget, const std::string& sourceHash, const IoCallback& notifyUnbufferedIO /*throw X*/, std::mutex& singleThread) //throw FileError, X
+{ parallelScope([=] { ::verifyFiles(apSource, apTarget, sourceHash, notifyUnbufferedIO); /*throw FileError, X*/ }, singleThread); }
+
+inline
+std::string getFileSha256(const AbstractPath& ap, const IoCallback& notifyUnbufferedIO /*throw X*/, std::mutex& singleThread) //throw FileError, X
+{ return parallelScope([=] { return fff::getFileSha256(ap, notifyUnbufferedIO); /*throw FileError, X*/ }, singleThread); }
 
 }
 
@@ -592,7 +994,9 @@ public:
                     DeletionPolicy deletionPolicy,
                     const AbstractPath& versioningFolderPath,
                     VersioningStyle versioningStyle,
-                    time_t syncStartTime);
+                    time_t syncStartTime,
+                    VersioningIndex& versioningIndex,
+                    size_t parallelOps); //versioning: move folder items in parallel
 
     //clean-up temporary directory (recycle bin optimization)
     void tryCleanup(PhaseCallback& cb /*throw X*/); //throw X
@@ -605,6 +1009,11 @@ public:
     const std::wstring& getTxtRemovingFolder () const { return txtRemovingFolder_;  } //buffered status texts
     const std::wstring& getTxtRemovingSymLink() const { return txtRemovingSymlink_; } //
 
+    bool deletesPermanently() const { return deletionPolicy_ == DeletionPolicy::permanent; }
+
+    //versioning only: keep a copy-on-write clone of the file as old version => true: file may be overwritten in place
+    bool revisionFileAsClone(const FileDescriptor& fileDescr, const Zstring& relativePath, std::mutex& singleThread); //throw FileError
+
 private:
     DeletionHandler           (const DeletionHandler&) = delete;
     DeletionHandler& operator=(const DeletionHandler&) = delete;
@@ -621,7 +1030,7 @@ private:
     {
         assert(deletionPolicy_ == DeletionPolicy::versioning);
         if (!versioner_)
-            versioner_ = std::make_unique<FileVersioner>(versioningFolderPath_, versioningStyle_, syncStartTime_); //throw FileError
+            versioner_ = std::make_unique<FileVersioner>(versioningFolderPath_, versioningStyle_, syncStartTime_, versioningIndex_, parallelOps_); //throw FileError
         return *versioner_;
     }
 
@@ -634,7 +1043,10 @@ private:
     const AbstractPath versioningFolderPath_;
     const VersioningStyle versioningStyle_;
     const time_t syncStartTime_;
+    VersioningIndex& versioningIndex_;
+    const size_t parallelOps_;
     std::unique_ptr<FileVersioner> versioner_;
+    bool versionCloneUnsupported_ = false; //e.g. ext4 or versioning folder on different volume: don't retry for each file
 
     //buffer status texts:
     const std::wstring txtRemovingFile_;
@@ -649,12 +1061,16 @@ DeletionHandler::DeletionHandler(const AbstractPath& baseFolderPath, //nothrow!
                                  DeletionPolicy deletionPolicy,
                                  const AbstractPath& versioningFolderPath,
                                  VersioningStyle versioningStyle,
-                                 time_t syncStartTime) :
+                                 time_t syncStartTime,
+                                 VersioningIndex& versioningIndex,
+                                 size_t parallelOps) :
     deletionPolicy_(deletionPolicy),
     baseFolderPath_(baseFolderPath),
     versioningFolderPath_(versioningFolderPath),
     versioningStyle_(versioningStyle),
     syncStartTime_(syncStartTime),
+    versioningIndex_(versioningIndex),
+    parallelOps_(parallelOps),
     //*INDENT-OFF*
     txtRemovingFile_([&]
     {
@@ -795,6 +1211,20 @@ void DeletionHandler::removeFileWithCallback(const FileDescriptor& fileDescr, //
 }
 
 
+bool DeletionHandler::revisionFileAsClone(const FileDescriptor& fileDescr, const Zstring& relativePath, std::mutex& singleThread) //throw FileError
+{
+    if (deletionPolicy_ != DeletionPolicy::versioning || versionCloneUnsupported_ ||
+        endsWith(relativePath, AFS::TEMP_FILE_ENDING))
+        return false;
+
+    if (parallel::revisionFileAsClone(getOrCreateVersioner(), fileDescr, relativePath, singleThread)) //throw FileError
+        return true;
+
+    versionCloneUnsupported_ = true;
+    return false;
+}
+
+
 void DeletionHandler::removeLinkWithCallback(const AbstractPath& linkPath, //throw FileError, throw ThreadStopRequest
                                              const Zstring& relativePath,
                                              AsyncItemStatReporter& statReporter, std::mutex& singleThread)
@@ -820,6 +1250,180 @@ void DeletionHandler::removeLinkWithCallback(const AbstractPath& linkPath, //thr
 //===================================================================================================
 //===================================================================================================
 
+//size-aware scheduling: start large files first, batch small files into a single work item (=> save scheduling overhead per file)
+const uint64_t WORK_ITEM_BATCH_FILE_SIZE_MAX = 64 * 1024;
+const size_t   WORK_ITEM_BATCH_FILES_MAX = 32;
+
+//read-ahead of the copy sources next in line (native paths only: page cache)
+const size_t   READ_AHEAD_FILES_MAX      = 8;                 //look-ahead among the folder's remaining work items
+const uint64_t READ_AHEAD_FILE_BYTES_MAX = 4 * 1024 * 1024;   //large files: first part only => copy is already streaming when the rest is needed
+const uint64_t READ_AHEAD_BYTES_MAX      = 64 * 1024 * 1024;  //memory budget: hinted, but not yet copied
+
+//interim save of sync.ffs_db during long syncs: an interrupted sync (crash, reboot, power loss) keeps the progress made so far
+const std::chrono::minutes SYNC_CHECKPOINT_INTERVAL(5);
+
+uint64_t getBytesToTransfer(const FilePair& file)
+{
+    switch (file.getSyncOperation())
+    {
+        case SO_CREATE_NEW_LEFT:
+        case SO_OVERWRITE_LEFT:
+            return file.getFileSize<SelectSide::right>();
+
+        case SO_CREATE_NEW_RIGHT:
+        case SO_OVERWRITE_RIGHT:
+            return file.getFileSize<SelectSide::left>();
+
+        case SO_DELETE_LEFT:
+        case SO_DELETE_RIGHT:
+        case SO_MOVE_LEFT_FROM:
+        case SO_MOVE_LEFT_TO:
+        case SO_MOVE_RIGHT_FROM:
+        case SO_MOVE_RIGHT_TO:
+        case SO_COPY_METADATA_TO_LEFT:
+        case SO_COPY_METADATA_TO_RIGHT:
+        case SO_DO_NOTHING:
+        case SO_EQUAL:
+        case SO_UNRESOLVED_CONFLICT:
+            break;
+    }
+    return 0;
+}
+
+
+//rotational media: read the sources of a batch in physical order instead of name order => fewer seeks
+void sortByPhysicalOffset(std::vector<FilePair*>& batch, std::mutex& singleThread) //noexcept
+{
+    if (batch.size() < 2)
+        return;
+
+    const BaseFolderPair& baseFolder = batch[0]->base();
+    const Zstring baseFolderPathL = getNativeItemPath(baseFolder.getAbstractPath<SelectSide::left >());
+    const Zstring baseFolderPathR = getNativeItemPath(baseFolder.getAbstractPath<SelectSide::right>());
+    if (baseFolderPathL.empty() && baseFolderPathR.empty())
+        return;
+
+    std::vector<std::pair<Zstring /*native source path*/, bool /*left side*/>> sourcePaths;
+    for (const FilePair* file : batch)
+        switch (file->getSyncOperation())
+        {
+            case SO_CREATE_NEW_LEFT:
+            case SO_OVERWRITE_LEFT:
+                sourcePaths.emplace_back(getNativeItemPath(file->getAbstractPath<SelectSide::right>()), false);
+                break;
+            case SO_CREATE_NEW_RIGHT:
+            case SO_OVERWRITE_RIGHT:
+                sourcePaths.emplace_back(getNativeItemPath(file->getAbstractPath<SelectSide::left>()), true);
+                break;
+            case SO_DELETE_LEFT:
+            case SO_DELETE_RIGHT:
+            case SO_MOVE_LEFT_FROM:
+            case SO_MOVE_LEFT_TO:
+            case SO_MOVE_RIGHT_FROM:
+            case SO_MOVE_RIGHT_TO:
+            case SO_COPY_METADATA_TO_LEFT:
+            case SO_COPY_METADATA_TO_RIGHT:
+            case SO_DO_NOTHING:
+            case SO_EQUAL:
+            case SO_UNRESOLVED_CONFLICT:
+                sourcePaths.emplace_back(Zstring(), false); //nothing to read
+                break;
+        }
+
+    std::vector<uint64_t> offsets(batch.size(), std::numeric_limits<uint64_t>::max()); //unknown: keep relative order at the end
+    const bool haveRotational = parallelScope([&] //don't hold the lock during file I/O
+    {
+        const bool rotationalL = !baseFolderPathL.empty() && isRotationalDevice(baseFolderPathL);
+        const bool rotationalR = !baseFolderPathR.empty() && isRotationalDevice(baseFolderPathR);
+
+        for (size_t i = 0; i < sourcePaths.size(); ++i)
+            if (const auto& [sourcePath, leftSide] = sourcePaths[i];
+                !sourcePath.empty() && (leftSide ? rotationalL : rotationalR))
+                if (const std::optional<uint64_t> offset = getPhysicalOffset(sourcePath))
+                    offsets[i] = *offset;
+        return rotationalL || rotationalR;
+    }, singleThread);
+    if (!haveRotational)
+        return;
+
+    std::vector<std::pair<uint64_t, FilePair*>> files;
+    for (size_t i = 0; i < batch.size(); ++i)
+        files.emplace_back(offsets[i], batch[i]);
+
+    std::stable_sort(files.begin(), files.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+    batch.clear();
+    for (const auto& [offset, file] : files)
+        batch.push_back(file);
+}
+
+
+/* read-ahead for copies next in line: a separate thread opens the source and queues its first bytes for reading (POSIX_FADV_WILLNEED)
+    => open() and first read() latency overlaps with the current copy, e.g. many medium-sized files on NFS/CIFS mounts
+    - budget: bytes hinted but not yet copied; the page cache may still evict them => lost work, but no harm
+    - remote AFS (SFTP, FTP, Google Drive): no page cache to fill => skipped                                  */
+class ReadAheadQueue
+{
+public:
+    //context of sync worker: protected by singleThread
+    void schedule(const FilePair& file)
+    {
+        Zstring sourcePath;
+        uint64_t fileSize = 0;
+        switch (file.getSyncOperation())
+        {
+            case SO_CREATE_NEW_LEFT:
+            case SO_OVERWRITE_LEFT:
+                sourcePath = getNativeItemPath(file.getAbstractPath<SelectSide::right>());
+                fileSize   = file.getFileSize<SelectSide::right>();
+                break;
+            case SO_CREATE_NEW_RIGHT:
+            case SO_OVERWRITE_RIGHT:
+                sourcePath = getNativeItemPath(file.getAbstractPath<SelectSide::left>());
+                fileSize   = file.getFileSize<SelectSide::left>();
+                break;
+            case SO_DELETE_LEFT:
+            case SO_DELETE_RIGHT:
+            case SO_MOVE_LEFT_FROM:
+            case SO_MOVE_LEFT_TO:
+            case SO_MOVE_RIGHT_FROM:
+            case SO_MOVE_RIGHT_TO:
+            case SO_COPY_METADATA_TO_LEFT:
+            case SO_COPY_METADATA_TO_RIGHT:
+            case SO_DO_NOTHING:
+            case SO_EQUAL:
+            case SO_UNRESOLVED_CONFLICT:
+                return; //nothing to read
+        }
+        const uint64_t byteCount = std::min(fileSize, READ_AHEAD_FILE_BYTES_MAX);
+
+        if (sourcePath.empty() || byteCount == 0 ||
+            bytesPending_ + byteCount > READ_AHEAD_BYTES_MAX ||
+            pending_.contains(&file))
+            return;
+
+        pending_.emplace(&file, byteCount);
+        bytesPending_ += byteCount;
+        worker_.run([sourcePath, byteCount] { adviseWillNeed(sourcePath, byteCount); /*noexcept*/ });
+    }
+
+    void release(const FilePair& file) //copy done (or failed)
+    {
+        if (auto it = pending_.find(&file);
+            it != pending_.end())
+        {
+            bytesPending_ -= it->second;
+            pending_.erase(it);
+        }
+    }
+
+private:
+    std::unordered_map<const FilePair*, uint64_t /*bytes hinted*/> pending_;
+    uint64_t bytesPending_ = 0;
+    ThreadGroup<std::function<void()>> worker_{1, Zstr("Read-ahead")}; //destructor: pending hints are discarded
+};
+
+
 class Workload
 {
 public:
@@ -897,15 +1501,57 @@ private:
     Workload           (const Workload&) = delete;
     Workload& operator=(const Workload&) = delete;
 
-    AsyncCallback& acb_;
+    AsyncCallback& acb_;
+
+    std::mutex lockWork_;
+    std::condition_variable conditionNewWork_;
+
+    size_t idleThreads_ = 0;
+
+    std::vector<WorkItems> workload_; //thread-specific buckets
+    RingBuffer<WorkItems> pendingWorkload_; //FIFO: buckets of work items for use by any thread
+};
+
+
+namespace
+{
+std::atomic<uint64_t> globalDeviceBandwidthLimit{0}; //bytes/sec; 0: unlimited
+}
+
+
+/* item states observed by the sync operations of this run: avoid repeated device round trips, e.g. for all items below a source folder deleted during sync
+    - not filled from the comparison tree: the remaining probes verify exactly what may have changed since comparison
+    - folders only (+ probe results): file operations don't need to be tracked
+    - not thread-safe: access while holding singleThread lock            */
+class ItemStateCache
+{
+public:
+    ItemStateCache() {}
+
+    //"no value": state unknown => ask device
+    std::optional<std::optional<AFS::ItemType>> getState(const AbstractPath& ap) const
+    {
+        //items below a missing folder (or a file) are missing, too: precedes state of item itself (might be outdated)
+        for (std::optional<AbstractPath> parentPath = AFS::getParentPath(ap); parentPath; parentPath = AFS::getParentPath(*parentPath))
+            if (auto it = states_.find(*parentPath);
+                it != states_.end() && (!it->second || *it->second == AFS::ItemType::file))
+                return std::optional<AFS::ItemType>();
+
+        if (auto it = states_.find(ap);
+            it != states_.end())
+            return it->second;
+        return {};
+    }
+
+    void setState(const AbstractPath& ap, std::optional<AFS::ItemType> type) { states_.insert_or_assign(ap, type); }
 
-    std::mutex lockWork_;
-    std::condition_variable conditionNewWork_;
+    void forgetState(const AbstractPath& ap) { states_.erase(ap); }
 
-    size_t idleThreads_ = 0;
+private:
+    ItemStateCache           (const ItemStateCache&) = delete;
+    ItemStateCache& operator=(const ItemStateCache&) = delete;
 
-    std::vector<WorkItems> workload_; //thread-specific buckets
-    RingBuffer<WorkItems> pendingWorkload_; //FIFO: buckets of work items for use by any thread
+    std::map<AbstractPath, std::optional<AFS::ItemType>> states_; //"no value": item not existing
 };
 
 
@@ -928,13 +1574,28 @@ public:
         std::vector<FileError>& errorsModTime;
         DeletionHandler& delHandlerLeft;
         DeletionHandler& delHandlerRight;
+        std::map<AfsDevice, BandwidthLimiter>& bandwidthLimiters; //devices without limit: not contained
+        ItemStateCache& itemStates;
+        const FanOutTargets& fanOutTargets; //shared by all folder pairs
+        const TargetDuplicates& targetDuplicates; //
+        bool concurrentSubTreePasses; //free disk space suffices even if deletions don't precede copies
+        std::function<void()> saveCheckpoint; //optional: context of main thread, while worker thread is blocked
+        std::chrono::steady_clock::time_point nextCheckpointTime;
     };
 
     static void runSync(SyncCtx& syncCtx, BaseFolderPair& baseFolder, PhaseCallback& cb)
     {
+        TraceSpan span("sync pair", [&] { return utfTo<std::string>(AFS::getDisplayPath(baseFolder.getAbstractPath<SelectSide::left >()) + L" | " +
+                                                                    AFS::getDisplayPath(baseFolder.getAbstractPath<SelectSide::right>())); });
         runPass(PassNo::zero, syncCtx, baseFolder, cb); //prepare file moves
-        runPass(PassNo::one,  syncCtx, baseFolder, cb); //delete files (or overwrite big ones with smaller ones)
-        runPass(PassNo::two,  syncCtx, baseFolder, cb); //copy rest
+
+        if (syncCtx.concurrentSubTreePasses)
+            runSubTreePasses(syncCtx, baseFolder, cb); //passes one and two without barrier between sub trees
+        else
+        {
+            runPass(PassNo::one, syncCtx, baseFolder, cb); //delete files (or overwrite big ones with smaller ones)
+            runPass(PassNo::two, syncCtx, baseFolder, cb); //copy rest
+        }
     }
 
 private:
@@ -955,6 +1616,10 @@ private:
         verifyCopiedFiles_  (syncCtx.verifyCopiedFiles),
         copyFilePermissions_(syncCtx.copyFilePermissions),
         failSafeFileCopy_   (syncCtx.failSafeFileCopy),
+        bandwidthLimiters_  (syncCtx.bandwidthLimiters),
+        itemStates_         (syncCtx.itemStates),
+        fanOutTargets_      (syncCtx.fanOutTargets),
+        targetDuplicates_   (syncCtx.targetDuplicates),
         singleThread_(singleThread),
         acb_(acb) {}
 
@@ -965,8 +1630,23 @@ private:
     static bool needZeroPass(const FolderPair& folder);
 
     static void runPass(PassNo pass, SyncCtx& syncCtx, BaseFolderPair& baseFolder, PhaseCallback& cb); //throw X
+    static void runSubTreePasses(SyncCtx& syncCtx, BaseFolderPair& baseFolder, PhaseCallback& cb); //throw X
+    static void runWorkload(SyncCtx& syncCtx, PhaseCallback& cb, const std::function<void(FolderPairSyncer& fps, Workload& workload)>& initWorkload); //throw X
+
+    //pass one of a sub tree: count outstanding work items (incl. those added later by folder items) => notify when all are done
+    struct PassTracker
+    {
+        size_t pendingItems = 0;
+        bool done = false;
+        std::function<void()> onDone; //called once, protected by singleThread_
+
+        void checkDone() { if (pendingItems == 0 && !done) { done = true; onDone(); } }
+    };
+    static Workload::WorkItem trackWorkItem(PassTracker* tracker, Workload::WorkItem&& workItem);
 
-    RingBuffer<Workload::WorkItems> getFolderLevelWorkItems(PassNo pass, ContainerObject& parentFolder, Workload& workload);
+    RingBuffer<Workload::WorkItems> getFolderLevelWorkItems(PassNo pass, ContainerObject& parentFolder, Workload& workload,
+                                                            PassTracker* tracker = nullptr, bool withSubFolders = true);
+    RingBuffer<Workload::WorkItems> getSubTreeWorkItems(PassNo pass, FolderPair& folder, Workload& workload, PassTracker* tracker); //folder + its sub tree
 
     static bool containsMoveTarget(const FolderPair& parent);
     void executeFileMove(FilePair& file); //throw ThreadStopRequest
@@ -981,6 +1661,8 @@ private:
     void synchronizeFolder(FolderPair& folder);                                                        //
     template <SelectSide sideTrg> void synchronizeFolderInt(FolderPair& folder, SyncOperation syncOp); //throw FileError, ThreadStopRequest
 
+    std::optional<AFS::ItemType> itemStillExistsCached(const AbstractPath& ap); //throw FileError
+
     void    logInfo(const std::wstring& rawText, const std::wstring& displayPath) { acb_.logInfo   (replaceCpy(rawText, L"%x", fmtPath(displayPath))); }
     void reportInfo(const std::wstring& rawText, const std::wstring& displayPath) { acb_.reportInfo(replaceCpy(rawText, L"%x", fmtPath(displayPath))); }
 
@@ -997,7 +1679,27 @@ private:
     AFS::FileCopyResult copyFileWithCallback(const FileDescriptor& sourceDescr, //throw FileError, ThreadStopRequest, X
                                              const AbstractPath& targetPath,
                                              const std::function<void()>& onDeleteTargetFile /*throw X*/, //optional!
+                                             bool deleteTargetPermanently, //onDeleteTargetFile() may be replaced by an atomic overwrite
+                                             std::optional<uint64_t> targetSizeOld, //existing target at same path: try updating only the changed blocks (if supported by device)
+                                             const std::optional<AFS::EqualPrefix>& equalPrefix, //optional: found by comparison => skipped by block update
                                              AsyncPercentStatReporter& statReporter);
+
+    std::vector<FanOutTarget> getPendingFanOutTargets(const FilePair& file) const;
+    //returns result for file's own target: other targets are updated or left unchanged on failure
+    template <SelectSide sideTrg>
+    AFS::FileCopyResult copyNewFileFanOut(FilePair& file, const std::vector<FanOutTarget>& fanOutTargets, AsyncPercentStatReporter& statReporter); //throw FileError, ThreadStopRequest
+
+    //none: no duplicate with the source's content found on the target device (or copy failed) => nothing done
+    template <SelectSide sideTrg>
+    std::optional<AFS::FileCopyResult> copyFromTargetDuplicate(const FilePair& file, const AbstractPath& targetPath, AsyncPercentStatReporter& statReporter); //throw ThreadStopRequest
+
+    //small new files of a batch: single bulk transfer (if supported by target device, e.g. SFTP "|bulkupload")
+    //returns files created => all others are left for synchronizeFile(): regular error handling + retry
+    template <SelectSide sideTrg>
+    std::set<const FilePair*> copyNewFilesBulk(const std::vector<FilePair*>& batch); //throw ThreadStopRequest
+
+    void reportModTimeError(const FilePair& file, const FileError& errorModTime); //throw ThreadStopRequest
+
     std::vector<FileError>& errorsModTime_;
 
     DeletionHandler& delHandlerLeft_;
@@ -1007,11 +1709,28 @@ private:
     const bool copyFilePermissions_;
     const bool failSafeFileCopy_;
 
+    std::map<AfsDevice, BandwidthLimiter>& bandwidthLimiters_;
+    ItemStateCache& itemStates_; //protected by singleThread_
+    const FanOutTargets& fanOutTargets_;
+    const TargetDuplicates& targetDuplicates_;
+
     std::mutex& singleThread_;
     AsyncCallback& acb_;
 
+    ReadAheadQueue readAhead_; //protected by singleThread_
+
+    struct HardLinkTarget
+    {
+        AbstractPath targetPath;
+        time_t modTime;
+        AFS::FingerPrint targetPrint;
+    };
+    std::map<HardLinkId, HardLinkTarget> hardLinkTargetsL_; //source hard link group => first copy created on left/right side
+    std::map<HardLinkId, HardLinkTarget> hardLinkTargetsR_; //(pass "two" only: file creation)
+
     //preload status texts (premature?)
     const std::wstring txtCreatingFile_      {_("Creating file %x"         )};
+    const std::wstring txtCreatingHardLink_  {_("Creating hard link %x"    )};
     const std::wstring txtCreatingLink_      {_("Creating symbolic link %x")};
     const std::wstring txtCreatingFolder_    {_("Creating folder %x"       )};
     const std::wstring txtUpdatingFile_      {_("Updating file %x"         )};
@@ -1019,6 +1738,7 @@ private:
     const std::wstring txtVerifyingFile_     {_("Verifying file %x"        )};
     const std::wstring txtUpdatingAttributes_{_("Updating attributes of %x")};
     const std::wstring txtMovingFileXtoY_    {_("Moving file %x to %y"     )};
+    const std::wstring txtCopyingFileXtoY_   {_("Copying file %x to %y"    )};
     const std::wstring txtSourceItemNotExist_{_("Source item %x not found" )};
 };
 
@@ -1041,20 +1761,90 @@ Callback     =============       --------------------
                                  --------------------
 
 Notes: - All threads share a single mutex, unlocked only during file I/O => do NOT require file_hierarchy.cpp classes to be thread-safe (i.e. internally synchronized)!
+         currently a single worker thread per pass => the mutex is uncontended (~ two atomic ops per file I/O): *not* a bottleneck
+         more workers need finer-grained ownership first: FilePair/SymlinkPair/FolderPair updates cross folder boundaries (file moves, parent
+         folder removal), DeletionHandler sessions are created lazily, errorsModTime_ is shared => see parallelScope()
        - Workload holds (folder-level-) items in buckets associated with each worker thread (FTP scenario: avoid CWDs)
        - If a worker is idle, its Workload bucket is empty and no more pending buckets available: steal from other threads (=> take half of largest bucket)
        - Maximize opportunity for parallelization ASAP: Workload buckets serve folder-items *before* files/symlinks => reduce risk of work-stealing
+       - Within a bucket, files are served largest first; small files are batched per work item => avoid a long tail + per-item overhead
+         rotational media: a batch reads its sources in physical order (first extent) => fewer seeks, see sortByPhysicalOffset()
+       - File work items hint the copy sources of the next items to the page cache (native paths only) => overlap open/first read latency, see ReadAheadQueue
        - Memory consumption: work items may grow indefinitely; however: test case "C:\" ~80MB per 1 million work items
+       - Passes one and two: no barrier between the direct sub folders of the base folder (if disk space permits, see runSubTreePasses())
 */
 
 void FolderPairSyncer::runPass(PassNo pass, SyncCtx& syncCtx, BaseFolderPair& baseFolder, PhaseCallback& cb) //throw X
+{
+    runWorkload(syncCtx, cb, [&](FolderPairSyncer& fps, Workload& workload)
+    {
+        workload.addWorkItems(fps.getFolderLevelWorkItems(pass, baseFolder, workload));
+    });
+}
+
+
+/*  dependencies of pass two (create, modify) on pass one (delete):
+      - name clashes (e.g. symlink replaced by file, case-only rename) => items of the same parent folder only
+      - disk space freed by deletions        => anywhere on the device: caller's job (SyncCtx::concurrentSubTreePasses)
+      - file moves, folders of move targets  => pass zero, still run before
+
+    => pass two of a direct sub folder of the base folder (including its sub tree) may start once pass one is done for
+       this sub tree *and* for the base folder's files and symlinks; pass two of the latter waits for all of pass one   */
+void FolderPairSyncer::runSubTreePasses(SyncCtx& syncCtx, BaseFolderPair& baseFolder, PhaseCallback& cb) //throw X
+{
+    std::vector<std::pair<FolderPair*, PassTracker>> subTrees; //don't reallocate after init: trackers are referenced by work items!
+    for (FolderPair& folder : baseFolder.refSubFolders())
+        subTrees.emplace_back(&folder, PassTracker());
+
+    PassTracker baseItemsPassOne; //files and symlinks of base folder
+    size_t subTreesPassOnePending = subTrees.size();
+
+    runWorkload(syncCtx, cb, [&](FolderPairSyncer& fps, Workload& workload)
+    {
+        auto startBaseItemsPassTwo = [&]
+        {
+            if (baseItemsPassOne.done && subTreesPassOnePending == 0)
+                workload.addWorkItems(fps.getFolderLevelWorkItems(PassNo::two, baseFolder, workload, nullptr, false /*withSubFolders*/));
+        };
+
+        baseItemsPassOne.onDone = [&]
+        {
+            for (auto& [folder, passOne] : subTrees)
+                if (passOne.done)
+                    workload.addWorkItems(fps.getSubTreeWorkItems(PassNo::two, *folder, workload, nullptr));
+            startBaseItemsPassTwo();
+        };
+
+        for (auto& [folder, passOne] : subTrees)
+            passOne.onDone = [&, folder = folder]
+        {
+            --subTreesPassOnePending;
+            if (baseItemsPassOne.done)
+                workload.addWorkItems(fps.getSubTreeWorkItems(PassNo::two, *folder, workload, nullptr));
+            startBaseItemsPassTwo();
+        };
+
+        workload.addWorkItems(fps.getFolderLevelWorkItems(PassNo::one, baseFolder, workload, &baseItemsPassOne, false /*withSubFolders*/));
+        for (auto& [folder, passOne] : subTrees)
+            workload.addWorkItems(fps.getSubTreeWorkItems(PassNo::one, *folder, workload, &passOne));
+
+        //nothing to delete?
+        baseItemsPassOne.checkDone();
+        for (auto& [folder, passOne] : subTrees)
+            passOne.checkDone();
+    });
+    assert(subTreesPassOnePending == 0 && baseItemsPassOne.done);
+}
+
+
+void FolderPairSyncer::runWorkload(SyncCtx& syncCtx, PhaseCallback& cb, const std::function<void(FolderPairSyncer& fps, Workload& workload)>& initWorkload) //throw X
 {
     std::mutex singleThread; //only a single worker thread may run at a time, except for parallel file I/O
 
     AsyncCallback acb;                                //
     FolderPairSyncer fps(syncCtx, singleThread, acb); //manage life time: enclose InterruptibleThread's!!!
     Workload workload(1, acb);
-    workload.addWorkItems(fps.getFolderLevelWorkItems(pass, baseFolder, workload)); //initial workload: set *before* threads get access!
+    initWorkload(fps, workload); //initial workload: set *before* threads get access!
 
     std::vector<InterruptibleThread> worker;
     ZEN_ON_SCOPE_EXIT( for (InterruptibleThread& wt : worker) wt.requestStop(); ); //stop *all* at the same time before join!
@@ -1064,22 +1854,72 @@ void FolderPairSyncer::runPass(PassNo pass, SyncCtx& syncCtx, BaseFolderPair& ba
         worker.emplace_back([threadIdx, &singleThread, &acb, &workload, threadName = std::move(threadName)]
         {
             setCurrentThreadName(threadName);
+            const ScheduleThreadForBackground backgroundPrio(BackgroundWork::copy);
 
             while (/*blocking call:*/ std::function<void()> workItem = workload.getNext(threadIdx)) //throw ThreadStopRequest
             {
                 acb.notifyTaskBegin(0 /*prio*/); //same prio, while processing only one folder pair at a time
                 ZEN_ON_SCOPE_EXIT(acb.notifyTaskEnd());
 
-                std::lock_guard dummy(singleThread); //protect ALL accesses to "fps" and workItem execution!
+                lockSingleThread(singleThread);
+                std::lock_guard dummy(singleThread, std::adopt_lock); //protect ALL accesses to "fps" and workItem execution!
                 workItem(); //throw ThreadStopRequest
             }
         });
-    acb.waitUntilDone(UI_UPDATE_INTERVAL / 2 /*every ~50 ms*/, cb); //throw X
+    acb.waitUntilDone(UI_UPDATE_INTERVAL / 2 /*every ~50 ms*/, cb, [&] //throw X
+    {
+        if (syncCtx.saveCheckpoint && std::chrono::steady_clock::now() >= syncCtx.nextCheckpointTime)
+            //don't block: worker might be waiting for main thread while holding the lock (e.g. error response) => retry on next call
+            if (std::unique_lock dummy(singleThread, std::try_to_lock); dummy.owns_lock()) //items being processed (during file I/O) are saved as not yet synced
+            {
+                syncCtx.saveCheckpoint(); //throw X
+                syncCtx.nextCheckpointTime = std::chrono::steady_clock::now() + SYNC_CHECKPOINT_INTERVAL;
+            }
+    });
+}
+
+
+Workload::WorkItem FolderPairSyncer::trackWorkItem(PassTracker* tracker, Workload::WorkItem&& workItem)
+{
+    if (!tracker)
+        return std::move(workItem);
+
+    ++tracker->pendingItems;
+    return [tracker, workItem = std::move(workItem)]
+    {
+        workItem(); //throw ThreadStopRequest
+        //folder items: sub items already added to tracker
+
+        assert(tracker->pendingItems > 0);
+        --tracker->pendingItems;
+        tracker->checkDone();
+    };
+}
+
+
+//thread-safe thanks to std::mutex singleThread
+RingBuffer<Workload::WorkItems> FolderPairSyncer::getSubTreeWorkItems(PassNo pass, FolderPair& folder, Workload& workload, PassTracker* tracker)
+{
+    if (pass != getPass(folder))
+        return getFolderLevelWorkItems(pass, folder, workload, tracker);
+
+    RingBuffer<Workload::WorkItem> workItems;
+    workItems.push_back(trackWorkItem(tracker, [this, &folder, &workload, pass, tracker]
+    {
+        tryReportingError([&] { synchronizeFolder(folder); }, acb_); //throw ThreadStopRequest
+
+        workload.addWorkItems(getFolderLevelWorkItems(pass, folder, workload, tracker));
+    }));
+
+    RingBuffer<Workload::WorkItems> buckets;
+    buckets.push_back(std::move(workItems));
+    return buckets;
 }
 
 
 //thread-safe thanks to std::mutex singleThread
-RingBuffer<Workload::WorkItems> FolderPairSyncer::getFolderLevelWorkItems(PassNo pass, ContainerObject& parentFolder, Workload& workload)
+RingBuffer<Workload::WorkItems> FolderPairSyncer::getFolderLevelWorkItems(PassNo pass, ContainerObject& parentFolder, Workload& workload,
+                                                                          PassTracker* tracker, bool withSubFolders)
 {
     RingBuffer<Workload::WorkItems> buckets;
 
@@ -1116,32 +1956,82 @@ RingBuffer<Workload::WorkItems> FolderPairSyncer::getFolderLevelWorkItems(PassNo
         else
         {
             //synchronize folders:
-            for (FolderPair& folder : hierObj.refSubFolders())
-                if (pass == getPass(folder))
-                    workItems.push_back([this, &folder, &workload, pass]
-                {
-                    tryReportingError([&] { synchronizeFolder(folder); }, acb_); //throw ThreadStopRequest
+            if (withSubFolders)
+            {
+                for (FolderPair& folder : hierObj.refSubFolders())
+                    if (pass == getPass(folder))
+                        workItems.push_back(trackWorkItem(tracker, [this, &folder, &workload, pass, tracker]
+                    {
+                        tryReportingError([&] { synchronizeFolder(folder); }, acb_); //throw ThreadStopRequest
 
-                    workload.addWorkItems(getFolderLevelWorkItems(pass, folder, workload));
-                });
-            else
-                foldersToInspect.push_back(&folder);
+                        workload.addWorkItems(getFolderLevelWorkItems(pass, folder, workload, tracker));
+                    }));
+                else
+                    foldersToInspect.push_back(&folder);
+            }
 
-            //synchronize files:
+            //synchronize files: largest first => parallel workers finish around the same time
+            std::vector<std::pair<uint64_t /*bytes to transfer*/, FilePair*>> files;
             for (FilePair& file : hierObj.refSubFiles())
                 if (pass == getPass(file))
-                    workItems.push_back([this, &file]
+                    files.emplace_back(getBytesToTransfer(file), &file);
+
+            std::stable_sort(files.begin(), files.end(), [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+
+            //copy sources of the work items that follow => read-ahead while this one is processed
+            auto getUpcoming = [&](auto itFrom)
+            {
+                std::vector<const FilePair*> upcoming;
+                for (; itFrom != files.end() && upcoming.size() < READ_AHEAD_FILES_MAX; ++itFrom)
+                    upcoming.push_back(itFrom->second);
+                return upcoming;
+            };
+
+            for (auto it = files.begin(); it != files.end();)
+                if (it->first > WORK_ITEM_BATCH_FILE_SIZE_MAX)
                 {
-                    tryReportingError([&] { synchronizeFile(file); }, acb_); //throw ThreadStopRequest
-                });
+                    FilePair& file = *it++->second;
+                    workItems.push_back(trackWorkItem(tracker, [this, &file, upcoming = getUpcoming(it)]
+                    {
+                        for (const FilePair* fileNext : upcoming)
+                            readAhead_.schedule(*fileNext);
+
+                        tryReportingError([&] { synchronizeFile(file); }, acb_); //throw ThreadStopRequest
+                        readAhead_.release(file);
+                    }));
+                }
+                else //small files (=> all remaining): batch
+                {
+                    std::vector<FilePair*> batch;
+                    for (; it != files.end() && batch.size() < WORK_ITEM_BATCH_FILES_MAX; ++it)
+                        batch.push_back(it->second);
+
+                    workItems.push_back(trackWorkItem(tracker, [this, batch = std::move(batch), upcoming = getUpcoming(it)]() mutable
+                    {
+                        sortByPhysicalOffset(batch, singleThread_); //rotational media
+
+                        for (const FilePair* fileNext : upcoming)
+                            readAhead_.schedule(*fileNext);
+
+                        std::set<const FilePair*> filesDone = copyNewFilesBulk<SelectSide::left>(batch); //throw ThreadStopRequest
+                        filesDone.merge(copyNewFilesBulk<SelectSide::right>(batch));                      //
+
+                        for (FilePair* file : batch)
+                        {
+                            if (!filesDone.contains(file))
+                                tryReportingError([&] { synchronizeFile(*file); }, acb_); //throw ThreadStopRequest
+                            readAhead_.release(*file);
+                        }
+                    }));
+                }
 
             //synchronize symbolic links:
             for (SymlinkPair& symlink : hierObj.refSubLinks())
                 if (pass == getPass(symlink))
-                    workItems.push_back([this, &symlink]
+                    workItems.push_back(trackWorkItem(tracker, [this, &symlink]
                 {
                     tryReportingError([&] { synchronizeLink(symlink); }, acb_); //throw ThreadStopRequest
-                });
+                }));
         }
 
         if (!workItems.empty())
@@ -1500,19 +2390,74 @@ void FolderPairSyncer::synchronizeFileInt(FilePair& file, SyncOperation syncOp)
 
             const AbstractPath targetPath = file.getAbstractPath<sideTrg>();
 
+            //another item of the source's hard link group was copied before => re-create the link instead of copying the data again
+            const std::optional<HardLinkId> hardLinkId = getHardLinkId<sideSrc>(file);
+            auto& hardLinkTargets = SelectParam<sideTrg>::ref(hardLinkTargetsL_, hardLinkTargetsR_);
+
+            if (hardLinkId)
+                if (const auto it = hardLinkTargets.find(*hardLinkId);
+                    it != hardLinkTargets.end())
+                {
+                    const HardLinkTarget linkTarget = it->second; //copy: don't hold reference while singleThread_ lock is released
+
+                    logInfo(txtCreatingHardLink_, AFS::getDisplayPath(targetPath)); //throw ThreadStopRequest
+
+                    bool linkCreated = false;
+                    try { linkCreated = parallel::createHardLink(linkTarget.targetPath, targetPath, singleThread_); /*throw FileError*/ }
+                    catch (const FileError& e) { acb_.logInfo(e.toString()); } //e.g. first copy was renamed/deleted meanwhile => fall back to copying
+
+                    if (linkCreated)
+                    {
+                        AsyncItemStatReporter statReporter(1, file.getFileSize<sideSrc>(), acb_); //no data copied => reduce total bytes
+                        statReporter.reportDelta(1, 0);
+
+                        //update FilePair: shares data and attributes with the first copy
+                        file.setSyncedTo<sideTrg>(file.getItemName<sideSrc>(), file.getFileSize<sideSrc>(),
+                                                  linkTarget.modTime,
+                                                  linkTarget.modTime,
+                                                  linkTarget.targetPrint,
+                                                  file.getFilePrint<sideSrc>(),
+                                                  false, file.isFollowedSymlink<sideSrc>());
+                        return;
+                    }
+                    //not supported (e.g. non-native target, different volume, link count limit) => copy
+                }
+
+            //same source file to be created by later folder pairs => read once, write all targets
+            const std::vector<FanOutTarget> fanOutTargets = hardLinkId ? std::vector<FanOutTarget>() : getPendingFanOutTargets(file);
+
             std::wstring statusMsg = replaceCpy(txtCreatingFile_, L"%x", fmtPath(AFS::getDisplayPath(targetPath)));
             acb_.logInfo(statusMsg); //throw ThreadStopRequest
-            AsyncPercentStatReporter statReporter(std::move(statusMsg), file.getFileSize<sideSrc>(), acb_); //throw ThreadStopRequest
+            for (const FanOutTarget& fot : fanOutTargets)
+                logInfo(txtCreatingFile_, AFS::getDisplayPath(fot.sideTrg == SelectSide::left ? //throw ThreadStopRequest
+                                                              fot.file->getAbstractPath<SelectSide::left >() :
+                                                              fot.file->getAbstractPath<SelectSide::right>()));
+            AsyncPercentStatReporter statReporter(std::move(statusMsg), file.getFileSize<sideSrc>() * (1 + fanOutTargets.size()), acb_); //throw ThreadStopRequest
 
             try
             {
-                const AFS::FileCopyResult result = copyFileWithCallback({file.getAbstractPath<sideSrc>(), file.getAttributes<sideSrc>()},
-                                                                        targetPath,
-                                                                        nullptr, //onDeleteTargetFile: nothing to delete
-                                                                        //if existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
-                                                                        statReporter); //throw FileError, ThreadStopRequest
+                const AFS::FileCopyResult result = [&]
+                {
+                    if (!fanOutTargets.empty())
+                        return copyNewFileFanOut<sideTrg>(file, fanOutTargets, statReporter); //throw FileError, ThreadStopRequest
+
+                    if (std::optional<AFS::FileCopyResult> resultDup = copyFromTargetDuplicate<sideTrg>(file, targetPath, statReporter)) //throw ThreadStopRequest
+                        return *resultDup;
+
+                    return copyFileWithCallback({file.getAbstractPath<sideSrc>(), file.getAttributes<sideSrc>()},
+                                                targetPath,
+                                                nullptr, //onDeleteTargetFile: nothing to delete
+                                                false,   //deleteTargetPermanently
+                                                std::nullopt, //targetSizeOld
+                                                std::nullopt, //equalPrefix
+                                                //if existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
+                                                statReporter); //throw FileError, ThreadStopRequest
+                }();
                 statReporter.updateStatus(1, 0); //throw ThreadStopRequest
 
+                if (hardLinkId)
+                    hardLinkTargets.emplace(*hardLinkId, HardLinkTarget{targetPath, result.modTime, result.targetFilePrint});
+
                 //update FilePair
                 file.setSyncedTo<sideTrg>(file.getItemName<sideSrc>(), result.fileSize,
                                           result.modTime, //target time set from source
@@ -1520,23 +2465,16 @@ void FolderPairSyncer::synchronizeFileInt(FilePair& file, SyncOperation syncOp)
                                           result.targetFilePrint,
                                           result.sourceFilePrint,
                                           false, file.isFollowedSymlink<sideSrc>());
+                if (!result.contentHash.empty()) //verified copy: hash is valid for both sides => persisted in sync.ffs_db
+                    file.setContentHash(toContentHash(result.contentHash), toContentHash(result.contentHash));
 
                 if (result.errorModTime)
-                    switch (file.base().getCompVariant())
-                    {
-                        case CompareVariant::timeSize:
-                            errorsModTime_.push_back(*result.errorModTime); //show all warnings later as a single message
-                            break;
-                        case CompareVariant::content: //just log, no warning:
-                        case CompareVariant::size:    //e.g. FTP server not supporting MFMT command
-                            acb_.logInfo(result.errorModTime->toString());
-                            break;
-                    }
+                    reportModTimeError(file, *result.errorModTime); //throw ThreadStopRequest
             }
             catch (const FileError& e)
             {
                 bool sourceExists = true;
-                try { sourceExists = !!parallel::itemStillExists(file.getAbstractPath<sideSrc>(), singleThread_); /*throw FileError*/ }
+                try { sourceExists = !!itemStillExistsCached(file.getAbstractPath<sideSrc>()); /*throw FileError*/ }
                 //abstract context => unclear which exception is more relevant/useless:
                 //e could be "item not found": doh; e2 devoid of any details after SFTP error: https://freefilesync.org/forum/viewtopic.php?t=7138#p24064
                 catch (const FileError& e2) { throw FileError(replaceCpy(e.toString(), L"\n\n", L'\n'), replaceCpy(e2.toString(), L"\n\n", L'\n')); }
@@ -1627,13 +2565,22 @@ void FolderPairSyncer::synchronizeFileInt(FilePair& file, SyncOperation syncOp)
                     //already existing: undefined behavior! (e.g. fail/overwrite)
                     parallel::moveAndRenameItem(file.getAbstractPath<sideTrg>(), targetPathLogical, singleThread_); //throw FileError, (ErrorMoveUnsupported)
 
+            FileAttributes followedTargetAttr = file.getAttributes<sideTrg>();
+            followedTargetAttr.isFollowedSymlink = false;
+
+            /*  versioning + in-place update: old version is normally *moved* away => delta update of the target not possible
+                => copy-on-write file system (Btrfs, XFS): versioning folder gets a reflink instead, target is then patched in place
+                - fail-safe copy: not needed, delta update works on a reflinked temp file already (+ old version is moved via rename)   */
+            const bool oldVersionCloned = !failSafeFileCopy_ && !copyFilePermissions_ && targetPathResolvedOld == targetPathResolvedNew &&
+                                          delHandlerTrg.revisionFileAsClone({targetPathResolvedOld, followedTargetAttr}, file.getRelativePath<sideTrg>(), singleThread_); //throw FileError
+
             auto onDeleteTargetFile = [&] //delete target at appropriate time
             {
                 assert(isLocked(singleThread_));
                 //updateStatus(this->delHandlerTrg.getTxtRemovingFile(), AFS::getDisplayPath(targetPathResolvedOld)); -> superfluous/confuses user
 
-                FileAttributes followedTargetAttr = file.getAttributes<sideTrg>();
-                followedTargetAttr.isFollowedSymlink = false;
+                if (oldVersionCloned) //old version is already in versioning folder
+                    return parallel::removeFileIfExists(targetPathResolvedOld, singleThread_); //throw FileError
 
                 AsyncItemStatReporter delStatReporter(0, 0, acb_); //=> decouple from AsyncPercentStatReporter above!
                 //no (logical) item count update desired - but total byte count may change, e.g. move(copy) old file to versioning dir
@@ -1649,6 +2596,10 @@ void FolderPairSyncer::synchronizeFileInt(FilePair& file, SyncOperation syncOp)
             const AFS::FileCopyResult result = copyFileWithCallback({file.getAbstractPath<sideSrc>(), file.getAttributes<sideSrc>()},
                                                                     targetPathResolvedNew,
                                                                     onDeleteTargetFile,
+                                                                    //no versioning/recycling + no case change => old target may be replaced via rename
+                                                                    (delHandlerTrg.deletesPermanently() || oldVersionCloned) && targetPathResolvedOld == targetPathResolvedNew,
+                                                                    targetPathResolvedOld == targetPathResolvedNew ? std::optional(file.getFileSize<sideTrg>()) : std::nullopt,
+                                                                    file.getEqualPrefix() > 0 ? std::optional(AFS::EqualPrefix{file.getEqualPrefix(), file.getLastWriteTime<sideTrg>()}) : std::nullopt,
                                                                     statReporter); //throw FileError, ThreadStopRequest, X
             statReporter.updateStatus(1, 0); //throw ThreadStopRequest
             //we model "delete + copy" as ONE logical operation
@@ -1661,18 +2612,11 @@ void FolderPairSyncer::synchronizeFileInt(FilePair& file, SyncOperation syncOp)
                                       result.sourceFilePrint,
                                       file.isFollowedSymlink<sideTrg>(),
                                       file.isFollowedSymlink<sideSrc>());
+            if (!result.contentHash.empty()) //verified copy: hash is valid for both sides => persisted in sync.ffs_db
+                file.setContentHash(toContentHash(result.contentHash), toContentHash(result.contentHash));
 
             if (result.errorModTime)
-                switch (file.base().getCompVariant())
-                {
-                    case CompareVariant::timeSize:
-                        errorsModTime_.push_back(*result.errorModTime); //show all warnings later as a single message
-                        break;
-                    case CompareVariant::content: //just log, no warning:
-                    case CompareVariant::size:    //e.g. FTP server not supporting MFMT command
-                        acb_.logInfo(result.errorModTime->toString());
-                        break;
-                }
+                reportModTimeError(file, *result.errorModTime); //throw ThreadStopRequest
         }
         break;
 
@@ -1773,7 +2717,7 @@ void FolderPairSyncer::synchronizeLinkInt(SymlinkPair& symlink, SyncOperation sy
             catch (const FileError& e)
             {
                 bool sourceExists = true;
-                try { sourceExists = !!parallel::itemStillExists(symlink.getAbstractPath<sideSrc>(), singleThread_); /*throw FileError*/ }
+                try { sourceExists = !!itemStillExistsCached(symlink.getAbstractPath<sideSrc>()); /*throw FileError*/ }
                 //abstract context => unclear which exception is more relevant/useless:
                 catch (const FileError& e2) { throw FileError(replaceCpy(e.toString(), L"\n\n", L'\n'), replaceCpy(e2.toString(), L"\n\n", L'\n')); }
 
@@ -1908,7 +2852,7 @@ void FolderPairSyncer::synchronizeFolderInt(FolderPair& folder, SyncOperation sy
             reportInfo(txtCreatingFolder_, AFS::getDisplayPath(targetPath)); //throw ThreadStopRequest
 
             //shallow-"copying" a folder might not fail if source is missing, so we need to check this first:
-            if (parallel::itemStillExists(folder.getAbstractPath<sideSrc>(), singleThread_)) //throw FileError
+            if (itemStillExistsCached(folder.getAbstractPath<sideSrc>())) //throw FileError
             {
                 AsyncItemStatReporter statReporter(1, 0, acb_);
                 try
@@ -1927,6 +2871,7 @@ void FolderPairSyncer::synchronizeFolderInt(FolderPair& folder, SyncOperation sy
                 }
 
                 statReporter.reportDelta(1, 0);
+                itemStates_.setState(targetPath, AFS::ItemType::folder);
 
                 //update FolderPair
                 folder.setSyncedTo<sideTrg>(folder.getItemName<sideSrc>(),
@@ -1959,6 +2904,7 @@ void FolderPairSyncer::synchronizeFolderInt(FolderPair& folder, SyncOperation sy
                 AsyncItemStatReporter statReporter(1 + getCUD(subStats), subStats.getBytesToProcess(), acb_);
 
                 delHandlerTrg.removeDirWithCallback(folder.getAbstractPath<sideTrg>(), folder.getRelativePath<sideTrg>(), statReporter, singleThread_); //throw FileError, X
+                itemStates_.setState(folder.getAbstractPath<sideTrg>(), std::nullopt);
 
                 //TODO: implement parallel folder deletion
 
@@ -1980,8 +2926,11 @@ void FolderPairSyncer::synchronizeFolderInt(FolderPair& folder, SyncOperation sy
                 if (getUnicodeNormalForm(folder.getItemName<sideTrg>()) !=
                     getUnicodeNormalForm(folder.getItemName<sideSrc>())) //have difference in case?
                     //already existing: undefined behavior! (e.g. fail/overwrite)
+                {
                     parallel::moveAndRenameItem(folder.getAbstractPath<sideTrg>(), //throw FileError, (ErrorMoveUnsupported)
                                                 AFS::appendRelPath(folder.parent().getAbstractPath<sideTrg>(), folder.getItemName<sideSrc>()), singleThread_);
+                    itemStates_.forgetState(folder.getAbstractPath<sideTrg>()); //case-insensitive file system: old path still valid
+                }
                 else
                     assert(false);
                 //copyFileTimes -> useless: modification time changes with each child-object creation/deletion
@@ -2009,35 +2958,96 @@ void FolderPairSyncer::synchronizeFolderInt(FolderPair& folder, SyncOperation sy
 
 //###########################################################################################
 
+std::optional<AFS::ItemType> FolderPairSyncer::itemStillExistsCached(const AbstractPath& ap) //throw FileError
+{
+    if (const std::optional<std::optional<AFS::ItemType>> state = itemStates_.getState(ap))
+        return *state;
+
+    const std::optional<AFS::ItemType> type = parallel::itemStillExists(ap, singleThread_); //throw FileError
+    itemStates_.setState(ap, type);
+
+    if (!type) //parent folder missing, too? => no more probes for the siblings
+        if (const std::optional<AbstractPath> parentPath = AFS::getParentPath(ap))
+            try { itemStillExistsCached(*parentPath); /*throw FileError*/ }
+            catch (FileError&) {} //not our problem: just an optimization
+
+    return type;
+}
+
+
 //returns current attributes of source file
 AFS::FileCopyResult FolderPairSyncer::copyFileWithCallback(const FileDescriptor& sourceDescr, //throw FileError, ThreadStopRequest, X
                                                            const AbstractPath& targetPath,
                                                            const std::function<void()>& onDeleteTargetFile /*throw X*/,
+                                                           bool deleteTargetPermanently,
+                                                           std::optional<uint64_t> targetSizeOld,
+                                                           const std::optional<AFS::EqualPrefix>& equalPrefix,
                                                            AsyncPercentStatReporter& statReporter) /*throw ThreadStopRequest*/
 {
     const AbstractPath& sourcePath = sourceDescr.path;
     const AFS::StreamAttributes sourceAttr{sourceDescr.attr.modTime, sourceDescr.attr.fileSize, sourceDescr.attr.filePrint};
 
+    TraceSpan span("copy file", [&] { return utfTo<std::string>(AFS::getDisplayPath(sourcePath) + L" -> " + AFS::getDisplayPath(targetPath)); });
+
+    auto onDeleteTargetFileLocked = [&]
+    {
+        if (onDeleteTargetFile) //running *outside* singleThread_ lock! => onDeleteTargetFile-callback expects lock being held:
+        {
+            std::lock_guard dummy(singleThread_);
+            onDeleteTargetFile(); //throw X
+        }
+    };
+
+    auto getBandwidthLimiter = [&](const AfsDevice& afsDevice) -> BandwidthLimiter*
+    {
+        auto it = bandwidthLimiters_.find(afsDevice); //no need for singleThread_ lock: map is not modified during sync
+        return it != bandwidthLimiters_.end() ? &it->second : nullptr;
+    };
+    BandwidthLimiter* const limiterSource = getBandwidthLimiter(sourcePath.afsDevice);
+    BandwidthLimiter* const limiterTarget = getBandwidthLimiter(targetPath.afsDevice);
+
+    auto throttleIO = [&](int64_t bytesDelta) //throw ThreadStopRequest
+    {
+        if (limiterSource || limiterTarget)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            const auto resumeTime = std::max(limiterSource ? limiterSource->consume(bytesDelta) : now,
+                                             limiterTarget ? limiterTarget->consume(bytesDelta) : now);
+            if (resumeTime > now)
+                interruptibleSleep(resumeTime - now); //throw ThreadStopRequest
+        }
+    };
+
+    auto notifyUnbufferedIO = [&](int64_t bytesDelta) //callback runs *outside* singleThread_ lock! => fine
+    {
+        statReporter.updateStatus(0, bytesDelta); //throw ThreadStopRequest
+        throttleIO(bytesDelta); //throw ThreadStopRequest
+        interruptionPoint(); //throw ThreadStopRequest => not reliably covered by AsyncPercentStatReporter::updateStatus()!
+    };
+
     auto copyOperation = [&](const AbstractPath& sourcePathTmp)
     {
-        //already existing + no onDeleteTargetFile: undefined behavior! (e.g. fail/overwrite/auto-rename)
-        const AFS::FileCopyResult result = parallel::copyFileTransactional(sourcePathTmp, sourceAttr, //throw FileError, ErrorFileLocked, ThreadStopRequest, X
+        std::optional<AFS::FileCopyResult> resultDelta;
+        if (targetSizeOld && onDeleteTargetFile && !copyFilePermissions_) //permissions are not copied
+            resultDelta = parallel::updateFileDelta(sourcePathTmp, sourceAttr, //throw FileError, ErrorFileLocked, ThreadStopRequest, X
+                                                    targetPath, *targetSizeOld, equalPrefix,
+                                                    failSafeFileCopy_, //false: update target in place
+                                                    onDeleteTargetFileLocked,
+                                                    deleteTargetPermanently,
+                                                    verifyCopiedFiles_, //calcContentHash
+                                                    notifyUnbufferedIO,
+                                                    singleThread_);
+        const AFS::FileCopyResult result = resultDelta ? *resultDelta :
+                                           //already existing + no onDeleteTargetFile: undefined behavior! (e.g. fail/overwrite/auto-rename)
+                                           parallel::copyFileTransactional(sourcePathTmp, sourceAttr, //throw FileError, ErrorFileLocked, ThreadStopRequest, X
                                                                            targetPath,
                                                                            copyFilePermissions_,
-                                                                           failSafeFileCopy_, [&]
-        {
-            if (onDeleteTargetFile) //running *outside* singleThread_ lock! => onDeleteTargetFile-callback expects lock being held:
-            {
-                std::lock_guard dummy(singleThread_);
-                onDeleteTargetFile(); //throw X
-            }
-        },
-        [&](int64_t bytesDelta) //callback runs *outside* singleThread_ lock! => fine
-        {
-            statReporter.updateStatus(0, bytesDelta); //throw ThreadStopRequest
-            interruptionPoint(); //throw ThreadStopRequest => not reliably covered by AsyncPercentStatReporter::updateStatus()!
-        },
-        singleThread_);
+                                                                           failSafeFileCopy_,
+                                                                           onDeleteTargetFileLocked,
+                                                                           onDeleteTargetFile && deleteTargetPermanently,
+                                                                           verifyCopiedFiles_, //calcContentHash
+                                                                           notifyUnbufferedIO,
+                                                                           singleThread_);
 
         //#################### Verification #############################
         if (verifyCopiedFiles_)
@@ -2048,9 +3058,9 @@ AFS::FileCopyResult FolderPairSyncer::copyFileWithCallback(const FileDescriptor&
             reportInfo(txtVerifyingFile_, AFS::getDisplayPath(targetPath)); //throw ThreadStopRequest
 
             //callback runs *outside* singleThread_ lock! => fine
-            auto verifyCallback = [&](int64_t bytesDelta) { interruptionPoint(); }; //throw ThreadStopRequest
+            auto verifyCallback = [&](int64_t bytesDelta) { throttleIO(bytesDelta); interruptionPoint(); }; //throw ThreadStopRequest
 
-            parallel::verifyFiles(sourcePathTmp, targetPath, verifyCallback, singleThread_); //throw FileError, ThreadStopRequest
+            parallel::verifyFiles(sourcePathTmp, targetPath, result.contentHash, verifyCallback, singleThread_); //throw FileError, ThreadStopRequest
         }
         //#################### /Verification #############################
 
@@ -2060,6 +3070,255 @@ AFS::FileCopyResult FolderPairSyncer::copyFileWithCallback(const FileDescriptor&
     return copyOperation(sourcePath); //throw FileError, (ErrorFileLocked), ThreadStopRequest
 }
 
+
+template <SelectSide sideTrg>
+std::set<const FilePair*> FolderPairSyncer::copyNewFilesBulk(const std::vector<FilePair*>& batch) //throw ThreadStopRequest
+{
+    constexpr SelectSide sideSrc = OtherSide<sideTrg>::value;
+    assert(isLocked(singleThread_));
+
+    if (verifyCopiedFiles_ || copyFilePermissions_) //not supported by bulk transfer
+        return {};
+
+    std::vector<FilePair*> files;
+    for (FilePair* file : batch) //same parent folder
+        if (file->getSyncOperation() == (sideTrg == SelectSide::left ? SO_CREATE_NEW_LEFT : SO_CREATE_NEW_RIGHT) &&
+            !getHardLinkId<sideSrc>(*file) &&        //=> hard link instead of a copy
+            getPendingFanOutTargets(*file).empty() && //=> read once, write all targets
+            !targetDuplicates_.contains({file->getFileSize<sideSrc>(), file->getLastWriteTime<sideSrc>()})) //=> copy on target device
+            files.push_back(file);
+
+    if (files.size() < 2)
+        return {};
+
+    const AbstractPath& targetPath0 = files[0]->getAbstractPath<sideTrg>();
+    if (!AFS::supportsBulkCopy(targetPath0) ||
+        bandwidthLimiters_.contains(targetPath0.afsDevice) || //no need for singleThread_ lock: map is not modified during sync
+        bandwidthLimiters_.contains(files[0]->getAbstractPath<sideSrc>().afsDevice))
+        return {};
+
+    if (auto parentFolder = dynamic_cast<const FolderPair*>(&files[0]->parent()))
+        if (parentFolder->isEmpty<sideTrg>()) //parent creation failed => let synchronizeFile() skip silently
+            return {};
+
+    std::vector<AFS::BulkCopyFile> bulkFiles;
+    for (const FilePair* file : files)
+    {
+        const FileAttributes& attr = file->getAttributes<sideSrc>();
+        bulkFiles.push_back({file->getAbstractPath<sideSrc>(), {attr.modTime, attr.fileSize, attr.filePrint}, file->getAbstractPath<sideTrg>()});
+    }
+
+    acb_.updateStatus(replaceCpy(txtCreatingFile_, L"%x", fmtPath(AFS::getDisplayPath(targetPath0)))); //throw ThreadStopRequest
+
+    //files left for synchronizeFile() are reported there once again => track bytes manually instead of via AsyncItemStatReporter
+    int64_t bytesStreamed = 0;
+    ZEN_ON_SCOPE_FAIL(acb_.updateDataTotal(0, bytesStreamed)); //=> unexpected increase of total workload
+
+    auto notifyUnbufferedIO = [&](int64_t bytesDelta) //callback runs *outside* singleThread_ lock! => fine
+    {
+        acb_.updateDataProcessed(0, bytesDelta); //noexcept!
+        bytesStreamed += bytesDelta;
+        interruptionPoint(); //throw ThreadStopRequest
+    };
+
+    const std::optional<std::vector<std::variant<AFS::FileCopyResult, FileError>>> results =
+        parallel::copyNewFilesBulk(bulkFiles, failSafeFileCopy_, notifyUnbufferedIO, singleThread_); //throw ThreadStopRequest
+    if (!results)
+    {
+        acb_.updateDataTotal(0, bytesStreamed);
+        return {};
+    }
+    assert(results->size() == files.size());
+
+    std::set<const FilePair*> filesDone;
+    int64_t bytesExpected = 0; //of files done
+
+    for (size_t i = 0; i < files.size() && i < results->size(); ++i)
+        if (const AFS::FileCopyResult* result = std::get_if<AFS::FileCopyResult>(&(*results)[i]))
+        {
+            FilePair& file = *files[i];
+            logInfo(txtCreatingFile_, AFS::getDisplayPath(file.getAbstractPath<sideTrg>())); //throw ThreadStopRequest
+
+            bytesExpected += file.getFileSize<sideSrc>();
+            acb_.updateDataProcessed(1, 0); //noexcept!
+
+            //update FilePair: see synchronizeFileInt()
+            file.setSyncedTo<sideTrg>(file.getItemName<sideSrc>(), result->fileSize,
+                                      result->modTime, //target time set from source
+                                      result->modTime,
+                                      result->targetFilePrint,
+                                      result->sourceFilePrint,
+                                      false, file.isFollowedSymlink<sideSrc>());
+            if (result->errorModTime)
+                reportModTimeError(file, *result->errorModTime); //throw ThreadStopRequest
+
+            filesDone.insert(&file);
+        }
+    //bytes of files left for synchronizeFile() (and deviations from the expected file sizes) add to the total
+    acb_.updateDataTotal(0, bytesStreamed - bytesExpected); //noexcept!
+    bytesStreamed = 0; //already accounted for
+    return filesDone;
+}
+
+
+void FolderPairSyncer::reportModTimeError(const FilePair& file, const FileError& errorModTime) //throw ThreadStopRequest
+{
+    switch (file.base().getCompVariant())
+    {
+        case CompareVariant::timeSize:
+            errorsModTime_.push_back(errorModTime); //show all warnings later as a single message
+            break;
+        case CompareVariant::content: //just log, no warning:
+        case CompareVariant::size:    //e.g. FTP server not supporting MFMT command
+            acb_.logInfo(errorModTime.toString()); //throw ThreadStopRequest
+            break;
+    }
+}
+
+
+template <SelectSide sideTrg>
+std::optional<AFS::FileCopyResult> FolderPairSyncer::copyFromTargetDuplicate(const FilePair& file, const AbstractPath& targetPath, AsyncPercentStatReporter& statReporter) //throw ThreadStopRequest
+{
+    constexpr SelectSide sideSrc = OtherSide<sideTrg>::value;
+    const AbstractPath sourcePath = file.getAbstractPath<sideSrc>();
+
+    auto it = targetDuplicates_.find({file.getFileSize<sideSrc>(), file.getLastWriteTime<sideSrc>()}); //no need for singleThread_ lock: map is not modified during sync
+    if (it == targetDuplicates_.end() ||
+        typeid(sourcePath.afsDevice.ref()) == typeid(targetPath.afsDevice.ref()))
+        return {};
+
+    std::vector<const TargetDuplicate*> candidates;
+    for (const TargetDuplicate& dup : it->second)
+        if (dup.filePath.afsDevice == targetPath.afsDevice)
+            candidates.push_back(&dup);
+    if (candidates.empty())
+        return {};
+
+    //callback runs *outside* singleThread_ lock! => fine
+    auto notifyUnbufferedIO = [&statReporter](int64_t bytesDelta)
+    {
+        statReporter.updateStatus(0, bytesDelta); //throw ThreadStopRequest
+        interruptionPoint(); //throw ThreadStopRequest => not reliably covered by AsyncPercentStatReporter::updateStatus()!
+    };
+
+    std::string sourceSha256;
+    try
+    {
+        sourceSha256 = parallel::getServerFileDigest(sourcePath, singleThread_).sha256; //throw FileError
+        if (sourceSha256.empty() && !getNativeItemPath(sourcePath).empty()) //local read instead of a transfer
+            sourceSha256 = parallel::getFileSha256(sourcePath, notifyUnbufferedIO, singleThread_); //throw FileError, ThreadStopRequest
+    }
+    catch (const FileError& e) { acb_.logInfo(e.toString()); } //=> regular copy reports source errors
+    if (sourceSha256.empty())
+        return {};
+
+    const ContentHash sourceHash = toContentHash(sourceSha256);
+    for (const TargetDuplicate* dup : candidates)
+        if (dup->contentHash == sourceHash)
+        {
+            logInfo(txtCopyingFileXtoY_, AFS::getDisplayPath(dup->filePath), AFS::getDisplayPath(targetPath)); //throw ThreadStopRequest
+            try
+            {
+                //no transfer: don't count as bytes copied
+                AFS::FileCopyResult result = parallel::copyFileTransactional(dup->filePath, dup->attr, //throw FileError, ErrorFileLocked, ThreadStopRequest
+                                                                             targetPath,
+                                                                             false, //copyFilePermissions
+                                                                             failSafeFileCopy_,
+                                                                             nullptr, //onDeleteTargetFile: nothing to delete
+                                                                             false,   //deleteTargetPermanently
+                                                                             false,   //calcContentHash
+                                                                             [](int64_t bytesDelta) { interruptionPoint(); }, //throw ThreadStopRequest
+                                                                             singleThread_);
+                if (result.fileSize != file.getFileSize<sideSrc>() ||
+                    result.modTime  != file.getLastWriteTime<sideSrc>()) //duplicate changed since comparison
+                {
+                    parallel::removeFilePlain(targetPath, singleThread_); //throw FileError
+                    continue;
+                }
+                //attributes of the copy derive from the source:
+                result.sourceFilePrint = file.getFilePrint<sideSrc>();
+                result.contentHash = sourceSha256; //=> persisted in sync.ffs_db
+                return result;
+            }
+            catch (const FileError& e) { acb_.logInfo(e.toString()); } //e.g. duplicate renamed/deleted meanwhile => try next or fall back to copying
+        }
+    return {};
+}
+
+
+std::vector<FanOutTarget> FolderPairSyncer::getPendingFanOutTargets(const FilePair& file) const
+{
+    std::vector<FanOutTarget> pendingTargets;
+    if (auto it = fanOutTargets_.find(&file);
+        it != fanOutTargets_.end())
+        for (const FanOutTarget& fot : it->second)
+            if (fot.sideTrg == SelectSide::left ?
+                isFanOutTargetPending<SelectSide::left >(*fot.file) :
+                isFanOutTargetPending<SelectSide::right>(*fot.file))
+                pendingTargets.push_back(fot);
+    return pendingTargets;
+}
+
+
+template <SelectSide sideTrg>
+AFS::FileCopyResult FolderPairSyncer::copyNewFileFanOut(FilePair& file, const std::vector<FanOutTarget>& fanOutTargets, //throw FileError, ThreadStopRequest
+                                                        AsyncPercentStatReporter& statReporter)
+{
+    constexpr SelectSide sideSrc = OtherSide<sideTrg>::value;
+
+    const AbstractPath sourcePath = file.getAbstractPath<sideSrc>();
+    const AFS::StreamAttributes sourceAttr{file.getLastWriteTime<sideSrc>(), file.getFileSize<sideSrc>(), file.getFilePrint<sideSrc>()};
+
+    std::vector<AbstractPath> targetPaths{file.getAbstractPath<sideTrg>()};
+    for (const FanOutTarget& fot : fanOutTargets)
+        targetPaths.push_back(fot.sideTrg == SelectSide::left ?
+                              fot.file->getAbstractPath<SelectSide::left >() :
+                              fot.file->getAbstractPath<SelectSide::right>());
+
+    TraceSpan span("copy file fan-out", [&] { return utfTo<std::string>(AFS::getDisplayPath(sourcePath) + L" -> " + numberTo<std::wstring>(targetPaths.size()) + L" targets"); });
+
+    auto notifyUnbufferedIO = [&](int64_t bytesDelta) //callback runs *outside* singleThread_ lock! => fine
+    {
+        statReporter.updateStatus(0, bytesDelta); //throw ThreadStopRequest
+        interruptionPoint(); //throw ThreadStopRequest
+    };
+
+    const std::vector<std::variant<AFS::FileCopyResult, FileError>> results =
+        parallel::copyNewFileFanOut(sourcePath, sourceAttr, targetPaths, //throw FileError, ErrorFileLocked, ThreadStopRequest
+                                    failSafeFileCopy_, //transactionalCopy
+                                    notifyUnbufferedIO,
+                                    singleThread_);
+    assert(results.size() == targetPaths.size());
+
+    for (size_t i = 0; i < fanOutTargets.size(); ++i)
+    {
+        FilePair& fileTrg = *fanOutTargets[i].file;
+        const std::variant<AFS::FileCopyResult, FileError>& resultTrg = results[i + 1];
+
+        if (const AFS::FileCopyResult* result = std::get_if<AFS::FileCopyResult>(&resultTrg))
+        {
+            if (fanOutTargets[i].sideTrg == SelectSide::left)
+                setFanOutTargetSynced<SelectSide::left>(fileTrg, *result);
+            else
+                setFanOutTargetSynced<SelectSide::right>(fileTrg, *result);
+
+            acb_.updateDataProcessed(1, 0); //bytes: see notifyUnbufferedIO
+
+            if (result->errorModTime)
+                reportModTimeError(fileTrg, *result->errorModTime); //throw ThreadStopRequest
+        }
+        else //target's folder pair will copy again => keep statistics consistent
+        {
+            acb_.logInfo(std::get<FileError>(resultTrg).toString()); //throw ThreadStopRequest
+            acb_.updateDataTotal(0, static_cast<int64_t>(sourceAttr.fileSize));
+        }
+    }
+
+    if (const FileError* e = std::get_if<FileError>(&results[0]))
+        throw *e;
+    return std::get<AFS::FileCopyResult>(results[0]);
+}
+
 //###########################################################################################
 
 template <SelectSide side>
@@ -2167,14 +3426,19 @@ bool createBaseFolder(BaseFolderPair& baseFolder, bool copyFilePermissions, Phas
 }
 
 
+void fff::setDeviceBandwidthLimit(uint64_t bytesPerSec) { globalDeviceBandwidthLimit = bytesPerSec; }
+
+
 void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime,
                       bool verifyCopiedFiles,
                       bool copyLockedFiles,
                       bool copyFilePermissions,
                       bool failSafeFileCopy,
+                      bool cacheNeutralCopy,
                       bool runWithBackgroundPriority,
                       const std::vector<FolderPairSyncCfg>& syncConfig,
                       FolderComparison& folderCmp,
+                      const std::map<AfsDevice, size_t>& deviceParallelOps,
                       WarningDialogs& warnings,
                       ProcessCallback& callback)
 {
@@ -2202,6 +3466,23 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
         callback.initNewPhase(itemsTotal, //throw X
                               bytesTotal,
                               ProcessPhase::synchronizing);
+
+        //logical vs unique bytes: bytesTotal is corrected while syncing, once hard links are actually created
+        int64_t bytesHardLinked = 0;
+        std::for_each(begin(folderCmp), end(folderCmp), [&](const BaseFolderPair& baseFolder) { bytesHardLinked += getHardLinkedBytesToCopy(baseFolder); });
+
+        if (bytesHardLinked > 0)
+            callback.logInfo(replaceCpy(replaceCpy(_("Data to copy: %x logical, %y unique (hard links)"), //throw X
+                                                   L"%x", formatFilesizeShort(bytesTotal)),
+                                        L"%y", formatFilesizeShort(bytesTotal - bytesHardLinked)));
+    }
+
+    //(re-)connect while running the checks below
+    {
+        std::vector<const BaseFolderPair*> baseFolders;
+        std::for_each(begin(folderCmp), end(folderCmp), [&](const BaseFolderPair& baseFolder) { baseFolders.push_back(&baseFolder); });
+
+        ::prepareSyncSessions(baseFolders, folderPairStats); //noexcept
     }
 
     //-------------------------------------------------------------------------------
@@ -2214,6 +3495,11 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
         backgroundPrio = std::make_unique<ScheduleForBackgroundProcessing>(); //throw FileError
     }, callback); //throw X
 
+    //applies to native file streams created during sync (copy, verification)
+    const bool cacheNeutralOld = getFileCacheNeutral();
+    setFileCacheNeutral(cacheNeutralCopy);
+    ZEN_ON_SCOPE_EXIT(setFileCacheNeutral(cacheNeutralOld));
+
     //prevent operating system going into sleep state
     std::unique_ptr<PreventStandby> noStandby;
     try
@@ -2229,6 +3515,8 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
 
     std::vector<int /*we really want bool*/> skipFolderPair(folderCmp.size(), false); //folder pairs may be skipped after fatal errors were found
 
+    std::vector<int /*we really want bool*/> concurrentSubTreePasses(folderCmp.size(), false); //copies need not wait for deletions to free disk space
+
     std::map<const BaseFolderPair*, std::pair<int, std::vector<SyncStatistics::ConflictInfo>>> checkUnresolvedConflicts;
 
     std::vector<std::tuple<AbstractPath, const PathFilter*, bool /*write access*/>> checkReadWriteBaseFolders;
@@ -2365,9 +3653,12 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
                                                        baseFolder.getAbstractPath<SelectSide::right>());
 
         //check for sufficient free diskspace
-        auto checkSpace = [&](const AbstractPath& baseFolderPath, int64_t minSpaceNeeded)
+        //return "free space suffices without prior deletions" => pass two may start before pass one is done for the whole tree
+        auto checkSpace = [&](const AbstractPath& baseFolderPath, int64_t minSpaceNeeded, bool physicalDeletion)
         {
-            if (!AFS::isNullPath(baseFolderPath) && minSpaceNeeded > 0)
+            bool spaceIndependentOfDeletion = !physicalDeletion;
+
+            if (!AFS::isNullPath(baseFolderPath) && (minSpaceNeeded > 0 || physicalDeletion))
                 try
                 {
                     const int64_t freeSpace = AFS::getFreeDiskSpace(baseFolderPath); //throw FileError, returns < 0 if not available
@@ -2375,15 +3666,20 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
                     if (0 <= freeSpace &&
                         freeSpace < minSpaceNeeded)
                         checkDiskSpaceMissing.push_back({baseFolderPath, {minSpaceNeeded, freeSpace}});
+
+                    if (0 <= freeSpace &&
+                        static_cast<uint64_t>(freeSpace) >= static_cast<uint64_t>(folderPairStat.getBytesToProcess())) //upper bound for bytes written to this side
+                        spaceIndependentOfDeletion = true;
                 }
                 catch (const FileError& e) //not critical => log only
                 {
                     callback.logInfo(e.toString()); //throw X
                 }
+            return spaceIndependentOfDeletion;
         };
-        const std::pair<int64_t, int64_t> spaceNeeded = MinimumDiskSpaceNeeded::calculate(baseFolder);
-        checkSpace(baseFolder.getAbstractPath<SelectSide::left >(), spaceNeeded.first);
-        checkSpace(baseFolder.getAbstractPath<SelectSide::right>(), spaceNeeded.second);
+        const bool spaceOkL = checkSpace(baseFolder.getAbstractPath<SelectSide::left >(), folderPairStat.getSpaceNeeded<SelectSide::left >(), folderPairStat.expectPhysicalDeletion<SelectSide::left >());
+        const bool spaceOkR = checkSpace(baseFolder.getAbstractPath<SelectSide::right>(), folderPairStat.getSpaceNeeded<SelectSide::right>(), folderPairStat.expectPhysicalDeletion<SelectSide::right>());
+        concurrentSubTreePasses[folderIndex] = spaceOkL && spaceOkR;
 
         //Windows: check if recycle bin really exists; if not, Windows will silently delete, which is just wrong
         if (folderPairCfg.handleDeletion == DeletionPolicy::recycler)
@@ -2564,6 +3860,7 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
     std::vector<FileError> errorsModTime; //show all warnings as a single message
 
     std::set<VersioningLimitFolder> versionLimitFolders;
+    VersioningIndex versioningIndex(checkVersioningLimitPaths); //keep track of new versions => applyVersioningLimit() without full traversal
 
     //------------------- show warnings after synchronization --------------------------------------
     //report errors when setting modification time as (a single) warning only!
@@ -2619,6 +3916,30 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
         ProcessCallback& cb_;
     } callbackNoThrow(callback);
 
+    ItemStateCache itemStates; //shared by all folder pairs: may overlap
+
+    //one token bucket per device: shared by all folder pairs
+    std::map<AfsDevice, BandwidthLimiter> bandwidthLimiters;
+    if (const uint64_t bandwidthLimit = globalDeviceBandwidthLimit;
+        bandwidthLimit > 0)
+        std::for_each(begin(folderCmp), end(folderCmp), [&](const BaseFolderPair& baseFolder)
+    {
+        bandwidthLimiters.try_emplace(baseFolder.getAbstractPath<SelectSide::left >().afsDevice, bandwidthLimit);
+        bandwidthLimiters.try_emplace(baseFolder.getAbstractPath<SelectSide::right>().afsDevice, bandwidthLimit);
+    });
+
+    //new files with the same source in several folder pairs: read source once
+    //stream copy only: no permissions, no verification (needs per-target read back), no per-device throttling
+    FanOutTargets fanOutTargets;
+    if (folderCmp.size() > 1 && !verifyCopiedFiles && !copyFilePermissions && bandwidthLimiters.empty())
+        fanOutTargets = getFanOutTargets(folderCmp, skipFolderPair);
+
+    //new files already existing on the target device: copy there instead of transferring the source
+    //not with verification (reads the target back) or permission copy
+    TargetDuplicates targetDuplicates;
+    if (!verifyCopiedFiles && !copyFilePermissions)
+        targetDuplicates = getTargetDuplicates(folderCmp, skipFolderPair);
+
     try
     {
         //loop through all directory pairs
@@ -2658,7 +3979,7 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
             auto guardDbSave = makeGuard<ScopeGuardRunMode::onFail>([&]
             {
                 if (folderPairCfg.saveSyncDB)
-                    saveLastSynchronousState(baseFolder, failSafeFileCopy,
+                    saveLastSynchronousState(baseFolder, failSafeFileCopy, deviceParallelOps,
                                              callbackNoThrow);
             });
 
@@ -2693,13 +4014,17 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
                                         getEffectiveDeletionPolicy(baseFolder.getAbstractPath<SelectSide::left>()),
                                         versioningFolderPath,
                                         folderPairCfg.versioningStyle,
-                                        std::chrono::system_clock::to_time_t(syncStartTime));
+                                        std::chrono::system_clock::to_time_t(syncStartTime),
+                                        versioningIndex,
+                                        getDeviceParallelOps(deviceParallelOps, baseFolder.getAbstractPath<SelectSide::left>().afsDevice));
 
             DeletionHandler delHandlerR(baseFolder.getAbstractPath<SelectSide::right>(),
                                         getEffectiveDeletionPolicy(baseFolder.getAbstractPath<SelectSide::right>()),
                                         versioningFolderPath,
                                         folderPairCfg.versioningStyle,
-                                        std::chrono::system_clock::to_time_t(syncStartTime));
+                                        std::chrono::system_clock::to_time_t(syncStartTime),
+                                        versioningIndex,
+                                        getDeviceParallelOps(deviceParallelOps, baseFolder.getAbstractPath<SelectSide::right>().afsDevice));
 
             //always (try to) clean up, even if synchronization is aborted!
             auto guardDelCleanup = makeGuard<ScopeGuardRunMode::onFail>([&]
@@ -2714,6 +4039,17 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
                 verifyCopiedFiles, copyPermissionsFp, failSafeFileCopy,
                 errorsModTime,
                 delHandlerL, delHandlerR,
+                bandwidthLimiters,
+                itemStates,
+                fanOutTargets,
+                targetDuplicates,
+                static_cast<bool>(concurrentSubTreePasses[folderIndex]),
+                folderPairCfg.saveSyncDB ? [&]
+                {
+                    saveLastSynchronousState(baseFolder, failSafeFileCopy, deviceParallelOps,
+                                             callbackNoThrow, false /*commitCheckpoints*/);
+                } : std::function<void()>(),
+                std::chrono::steady_clock::now() + SYNC_CHECKPOINT_INTERVAL,
             };
             FolderPairSyncer::runSync(syncCtx, baseFolder, callback);
 
@@ -2735,14 +4071,14 @@ void fff::synchronize(const std::chrono::system_clock::time_point& syncStartTime
             //(try to gracefully) write database file
             if (folderPairCfg.saveSyncDB)
             {
-                saveLastSynchronousState(baseFolder, failSafeFileCopy, //throw X
+                saveLastSynchronousState(baseFolder, failSafeFileCopy, deviceParallelOps, //throw X
                                          callback /*throw X*/);
                 guardDbSave.dismiss(); //[!] after "graceful" try: user might have cancelled during DB write: ensure DB is still written
             }
         }
         //-----------------------------------------------------------------------------------------------------
 
-        applyVersioningLimit(versionLimitFolders,
+        applyVersioningLimit(versionLimitFolders, versioningIndex, deviceParallelOps,
                              callback /*throw X*/);
     }
     catch (const std::exception& e)
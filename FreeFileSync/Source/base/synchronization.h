@@ -10,6 +10,7 @@
 #include <chrono>
 #include "structures.h"
 #include "file_hierarchy.h"
+#include "cmp_columns.h"
 #include "process_callback.h"
 
 
@@ -22,24 +23,29 @@ public:
     SyncStatistics(const FolderComparison& folderCmp);
     SyncStatistics(const ContainerObject& hierObj);
     SyncStatistics(const FilePair& file);
+    SyncStatistics(const ComparisonColumns& columns); //same result as SyncStatistics(const FolderComparison&) if columns contain the full comparison
 
     template <SelectSide side>
-    int createCount() const { return SelectParam<side>::ref(createLeft_, createRight_); }
-    int createCount() const { return createLeft_ + createRight_; }
+    int createCount() const { return SelectParam<side>::ref(totals_.createLeft, totals_.createRight); }
+    int createCount() const { return totals_.createLeft + totals_.createRight; }
 
     template <SelectSide side>
-    int updateCount() const { return SelectParam<side>::ref(updateLeft_, updateRight_); }
-    int updateCount() const { return updateLeft_ + updateRight_; }
+    int updateCount() const { return SelectParam<side>::ref(totals_.updateLeft, totals_.updateRight); }
+    int updateCount() const { return totals_.updateLeft + totals_.updateRight; }
 
     template <SelectSide side>
-    int deleteCount() const { return SelectParam<side>::ref(deleteLeft_, deleteRight_); }
-    int deleteCount() const { return deleteLeft_ + deleteRight_; }
+    int deleteCount() const { return SelectParam<side>::ref(totals_.deleteLeft, totals_.deleteRight); }
+    int deleteCount() const { return totals_.deleteLeft + totals_.deleteRight; }
 
     template <SelectSide side>
-    bool expectPhysicalDeletion() const { return SelectParam<side>::ref(physicalDeleteLeft_, physicalDeleteRight_); }
+    bool expectPhysicalDeletion() const { return SelectParam<side>::ref(totals_.physicalDeleteLeft, totals_.physicalDeleteRight); }
 
-    int64_t getBytesToProcess() const { return bytesToProcess_; }
-    size_t  rowCount         () const { return rowsTotal_; }
+    //minimum disk space needed (negative if space is freed): not available for ComparisonColumns
+    template <SelectSide side>
+    int64_t getSpaceNeeded() const { return SelectParam<side>::ref(totals_.spaceNeededLeft, totals_.spaceNeededRight); }
+
+    int64_t getBytesToProcess() const { return totals_.bytesToProcess; }
+    size_t  rowCount         () const { return totals_.rowsTotal; }
 
     struct ConflictInfo
     {
@@ -47,28 +53,26 @@ public:
         std::wstring msg;
     };
     const std::vector<ConflictInfo>& getConflictsPreview() const { return conflictsPreview_; }
-    int conflictCount() const { return conflictCount_; }
+    int conflictCount() const { return totals_.conflictCount; }
 
 private:
+    SyncStatistics() {}
+
     void recurse(const ContainerObject& hierObj);
+    static SyncOpTotals getSubTreeTotals(const ContainerObject& hierObj); //buffered by ContainerObject
+    void addTotals(const SyncOpTotals& totals, bool addSpaceNeeded);
+    void collectConflictsPreview(const ContainerObject& hierObj);
 
     void processFile  (const FilePair& file);
     void processLink  (const SymlinkPair& link);
     void processFolder(const FolderPair& folder);
 
-    int createLeft_  = 0;
-    int createRight_ = 0;
-    int updateLeft_  = 0;
-    int updateRight_ = 0;
-    int deleteLeft_  = 0;
-    int deleteRight_ = 0;
-    bool physicalDeleteLeft_  = false; //at least 1 item will be deleted; considers most "update" cases which also delete items
-    bool physicalDeleteRight_ = false; //
+    void processFileOp  (SyncOperation so, uint64_t fileSizeL, uint64_t fileSizeR);
+    void processLinkOp  (SyncOperation so);
+    void processFolderOp(SyncOperation so);
+    void addConflictPreview(FileSystemObject::ObjectIdConst objId);
 
-    int64_t bytesToProcess_ = 0;
-    size_t rowsTotal_ = 0;
-
-    int conflictCount_ = 0;
+    SyncOpTotals totals_;
     std::vector<ConflictInfo> conflictsPreview_; //conflict texts to display as a warning message
     //limit conflict count! e.g. there may be hundred thousands of "same date but a different size"
 };
@@ -87,6 +91,12 @@ struct FolderPairSyncCfg
 };
 std::vector<FolderPairSyncCfg> extractSyncCfg(const MainConfiguration& mainCfg);
 
+//hint sessions needed by synchronize() => connect early and keep (S)FTP sessions alive between comparison and sync
+void prepareSyncSessions(const FolderComparison& folderCmp); //noexcept
+
+
+//limit file copy throughput per device (shared by all copies reading from or writing to it): 0 = unlimited
+void setDeviceBandwidthLimit(uint64_t bytesPerSec); //applies to synchronize() calls started afterwards
 
 //FFS core routine:
 void synchronize(const std::chrono::system_clock::time_point& syncStartTime,
@@ -94,9 +104,11 @@ void synchronize(const std::chrono::system_clock::time_point& syncStartTime,
                  bool copyLockedFiles,
                  bool copyFilePermissions,
                  bool failSafeFileCopy,
+                 bool cacheNeutralCopy,
                  bool runWithBackgroundPriority,
                  const std::vector<FolderPairSyncCfg>& syncConfig, //CONTRACT: syncConfig and folderCmp correspond row-wise!
                  FolderComparison& folderCmp,                      //
+                 const std::map<AfsDevice, size_t>& deviceParallelOps,
                  WarningDialogs& warnings,
                  ProcessCallback& callback);
 }
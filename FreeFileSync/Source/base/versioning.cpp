@@ -5,9 +5,16 @@
 // *****************************************************************************
 
 #include "versioning.h"
+#include <deque>
+#include <future>
+#include <zen/crc.h>
+#include <zen/zlib_wrap.h>
+#include <zen/perf.h>
+#include <zen/file_access.h>
 #include "parallel_scan.h"
 #include "status_handler_impl.h"
 #include "dir_exist_async.h"
+#include "../afs/native.h"
 
 using namespace zen;
 using namespace fff;
@@ -15,6 +22,12 @@ using namespace fff;
 
 namespace
 {
+const char VERSIONING_INDEX_DESCR[] = "FreeFileSync";
+const int  VERSIONING_INDEX_VERSION = 1; //2026-10-14
+
+const int VERSIONING_INDEX_RESCAN_DAYS = 30; //traverse versioning folder from time to time: catch versions added or deleted by other means
+
+
 inline
 Zstring getDotExtension(const Zstring& filePath) //including "." if extension is existing, returns empty string otherwise
 {
@@ -71,7 +84,7 @@ time_t fff::impl::parseVersionedFolderName(const Zstring& folderName)
 }
 
 
-AbstractPath FileVersioner::generateVersionedPath(const Zstring& relativePath) const
+Zstring FileVersioner::generateVersionedRelPath(const Zstring& relativePath) const
 {
     assert(isValidRelPath(relativePath));
     assert(!relativePath.empty());
@@ -89,10 +102,9 @@ AbstractPath FileVersioner::generateVersionedPath(const Zstring& relativePath) c
             versionedRelPath = relativePath + Zstr(' ') + timeStamp_ + getDotExtension(relativePath);
             assert(impl::parseVersionedFileName(afterLast(versionedRelPath, FILE_NAME_SEPARATOR, IfNotFoundReturn::all)) ==
                    std::pair(syncStartTime_, afterLast(relativePath, FILE_NAME_SEPARATOR, IfNotFoundReturn::all)));
-            (void)syncStartTime_; //clang: -Wunused-private-field
             break;
     }
-    return AFS::appendRelPath(versioningFolderPath_, versionedRelPath);
+    return versionedRelPath;
 }
 
 
@@ -104,6 +116,7 @@ namespace
     - target parent directories are created if missing                                 */
 template <class Function>
 void moveExistingItemToVersioning(const AbstractPath& sourcePath, const AbstractPath& targetPath, //throw FileError
+                                  ExistingFolderCache& knownFolders,
                                   Function copyNewItemPlain /*throw FileError*/)
 {
     //start deleting existing target as required by copyFileTransactional()/moveAndRenameItem():
@@ -135,7 +148,7 @@ void moveExistingItemToVersioning(const AbstractPath& sourcePath, const Abstract
         //parent folder missing  => create + retry
         //parent folder existing => maybe created shortly after move attempt by parallel thread! => retry
         if (const std::optional<AbstractPath> targetParentPath = AFS::getParentPath(targetPath))
-            AFS::createFolderIfMissingRecursion(*targetParentPath); //throw FileError
+            AFS::createFolderIfMissingRecursion(*targetParentPath, knownFolders); //throw FileError
     };
 
     try //first try to move directly without copying
@@ -181,6 +194,8 @@ void moveExistingItemToVersioning(const AbstractPath& sourcePath, const Abstract
 
 void FileVersioner::revisionFile(const FileDescriptor& fileDescr, const Zstring& relativePath, const IoCallback& notifyUnbufferedIO /*throw X*/) const //throw FileError, X
 {
+    TraceSpan span("versioning file", [&] { return utfTo<std::string>(AFS::getDisplayPath(fileDescr.path)); });
+
     if (std::optional<AFS::ItemType> type = AFS::itemStillExists(fileDescr.path)) //throw FileError
     {
         if (*type == AFS::ItemType::symlink)
@@ -198,13 +213,17 @@ void FileVersioner::revisionFileImpl(const FileDescriptor& fileDescr, const Zstr
 {
     const AbstractPath& filePath = fileDescr.path;
 
-    const AbstractPath targetPath = generateVersionedPath(relativePath);
+    const Zstring targetRelPath = generateVersionedRelPath(relativePath);
+    const AbstractPath targetPath = AFS::appendRelPath(versioningFolderPath_, targetRelPath);
     const AFS::StreamAttributes fileAttr{fileDescr.attr.modTime, fileDescr.attr.fileSize, fileDescr.attr.filePrint};
 
     if (onBeforeMove)
         onBeforeMove(AFS::getDisplayPath(filePath), AFS::getDisplayPath(targetPath));
 
-    moveExistingItemToVersioning(filePath, targetPath, [&] //throw FileError
+    if (versioningStyle_ != VersioningStyle::replace)
+        versioningIndex_.prepareAddVersion(versioningFolderPath_); //throw FileError
+
+    moveExistingItemToVersioning(filePath, targetPath, knownFolders_, [&] //throw FileError
     {
         //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
         //=> not expected, but possible if target deletion failed
@@ -212,14 +231,62 @@ void FileVersioner::revisionFileImpl(const FileDescriptor& fileDescr, const Zstr
         /*const AFS::FileCopyResult result =*/ AFS::copyFileTransactional(filePath, fileAttr, targetPath, //throw FileError, ErrorFileLocked, X
                                                                           false, //copyFilePermissions
                                                                           false,  //transactionalCopy: not needed for versioning! partial copy will be overwritten next time
-                                                                          nullptr /*onDeleteTargetFile*/, notifyUnbufferedIO);
+                                                                          nullptr /*onDeleteTargetFile*/, false /*deleteTargetPermanently*/,
+                                                                          false /*calcContentHash*/, notifyUnbufferedIO);
         //result.errorModTime? => irrelevant for versioning!
     });
+
+    if (versioningStyle_ != VersioningStyle::replace)
+        versioningIndex_.addVersion(versioningFolderPath_, {relativePath, targetRelPath, syncStartTime_, fileDescr.attr.fileSize, false /*isSymlink*/});
+}
+
+
+bool FileVersioner::revisionFileAsClone(const FileDescriptor& fileDescr, const Zstring& relativePath) const //throw FileError
+{
+    TraceSpan span("versioning file (clone)", [&] { return utfTo<std::string>(AFS::getDisplayPath(fileDescr.path)); });
+
+    const Zstring targetRelPath = generateVersionedRelPath(relativePath);
+    const AbstractPath targetPath = AFS::appendRelPath(versioningFolderPath_, targetRelPath);
+
+    const Zstring filePathNative   = getNativeItemPath(fileDescr.path);
+    const Zstring targetPathNative = getNativeItemPath(targetPath);
+    if (filePathNative.empty() || targetPathNative.empty())
+        return false;
+
+    if (versioningStyle_ != VersioningStyle::replace)
+        versioningIndex_.prepareAddVersion(versioningFolderPath_); //throw FileError
+
+    //replace already existing target (supports retry): see moveExistingItemToVersioning()
+    try { AFS::removeFilePlain(targetPath); /*throw FileError*/ }
+    catch (FileError&) {} //probably "not existing" error
+
+    bool cloned = false;
+    try
+    {
+        cloned = cloneFile(filePathNative, targetPathNative); //throw FileError, ErrorTargetExisting
+    }
+    catch (FileError&)
+    {
+        //parent folder missing  => create + retry
+        //parent folder existing => maybe created shortly after clone attempt by parallel thread! => retry
+        if (const std::optional<AbstractPath> targetParentPath = AFS::getParentPath(targetPath))
+            AFS::createFolderIfMissingRecursion(*targetParentPath, knownFolders_); //throw FileError
+
+        cloned = cloneFile(filePathNative, targetPathNative); //throw FileError, ErrorTargetExisting
+    }
+    if (!cloned)
+        return false;
+
+    if (versioningStyle_ != VersioningStyle::replace)
+        versioningIndex_.addVersion(versioningFolderPath_, {relativePath, targetRelPath, syncStartTime_, fileDescr.attr.fileSize, false /*isSymlink*/});
+    return true;
 }
 
 
 void FileVersioner::revisionSymlink(const AbstractPath& linkPath, const Zstring& relativePath) const //throw FileError
 {
+    TraceSpan span("versioning symlink", [&] { return utfTo<std::string>(AFS::getDisplayPath(linkPath)); });
+
     if (AFS::itemStillExists(linkPath)) //throw FileError
         revisionSymlinkImpl(linkPath, relativePath, nullptr /*onBeforeMove*/); //throw FileError
     //else -> missing source item is not an error => check BEFORE deleting target
@@ -229,13 +296,19 @@ void FileVersioner::revisionSymlink(const AbstractPath& linkPath, const Zstring&
 void FileVersioner::revisionSymlinkImpl(const AbstractPath& linkPath, const Zstring& relativePath, //throw FileError
                                         const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeMove) const
 {
-
-    const AbstractPath targetPath = generateVersionedPath(relativePath);
+    const Zstring targetRelPath = generateVersionedRelPath(relativePath);
+    const AbstractPath targetPath = AFS::appendRelPath(versioningFolderPath_, targetRelPath);
 
     if (onBeforeMove)
         onBeforeMove(AFS::getDisplayPath(linkPath), AFS::getDisplayPath(targetPath));
 
-    moveExistingItemToVersioning(linkPath, targetPath, [&] { AFS::copySymlink(linkPath, targetPath, false /*copy filesystem permissions*/); }); //throw FileError
+    if (versioningStyle_ != VersioningStyle::replace)
+        versioningIndex_.prepareAddVersion(versioningFolderPath_); //throw FileError
+
+    moveExistingItemToVersioning(linkPath, targetPath, knownFolders_, [&] { AFS::copySymlink(linkPath, targetPath, false /*copy filesystem permissions*/); }); //throw FileError
+
+    if (versioningStyle_ != VersioningStyle::replace)
+        versioningIndex_.addVersion(versioningFolderPath_, {relativePath, targetRelPath, syncStartTime_, 0 /*fileSize*/, true /*isSymlink*/});
 }
 
 
@@ -244,13 +317,20 @@ void FileVersioner::revisionFolder(const AbstractPath& folderPath, const Zstring
                                    const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeFolderMove /*throw X*/,
                                    const IoCallback& notifyUnbufferedIO /*throw X*/) const
 {
+    TraceSpan span("versioning folder", [&] { return utfTo<std::string>(AFS::getDisplayPath(folderPath)); });
+
     //no error situation if directory is not existing! manual deletion relies on it!
     if (std::optional<AFS::ItemType> type = AFS::itemStillExists(folderPath)) //throw FileError
     {
         if (*type == AFS::ItemType::symlink) //on Linux there is just one type of symlink, and since we do revision file symlinks, we should revision dir symlinks as well!
             revisionSymlinkImpl(folderPath, relativePath, onBeforeFileMove); //throw FileError
-        else
-            revisionFolderImpl(folderPath, relativePath, onBeforeFileMove, onBeforeFolderMove, notifyUnbufferedIO); //throw FileError, X
+        else if (!revisionFolderByRename(folderPath, relativePath, onBeforeFolderMove)) //throw FileError
+        {
+            if (parallelOps_ > 1)
+                revisionFolderParallel(folderPath, relativePath, onBeforeFileMove, onBeforeFolderMove, notifyUnbufferedIO); //throw FileError, X
+            else
+                revisionFolderImpl(folderPath, relativePath, onBeforeFileMove, onBeforeFolderMove, notifyUnbufferedIO); //throw FileError, X
+        }
     }
     else //even if the folder did not exist anymore, significant I/O work was done => report
         if (onBeforeFolderMove) onBeforeFolderMove(AFS::getDisplayPath(folderPath), AFS::getDisplayPath(AFS::appendRelPath(versioningFolderPath_, relativePath)));
@@ -299,52 +379,393 @@ void FileVersioner::revisionFolderImpl(const AbstractPath& folderPath, const Zst
     AFS::removeFolderPlain(folderPath); //throw FileError
 }
 
-//###########################################################################################
+
+bool FileVersioner::revisionFolderByRename(const AbstractPath& folderPath, const Zstring& relativePath, //throw FileError
+                                           const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeFolderMove) const
+{
+    if (versioningStyle_ == VersioningStyle::timestampFile) //every file gets renamed
+        return false;
+
+    const Zstring targetRelPath = generateVersionedRelPath(relativePath);
+    const AbstractPath targetPath = AFS::appendRelPath(versioningFolderPath_, targetRelPath);
+
+    //already existing: merge required (e.g. VersioningStyle::replace) => item by item
+    try
+    {
+        if (AFS::itemStillExists(targetPath)) //throw FileError
+            return false;
+    }
+    catch (FileError&) { return false; } //e.g. versioning folder not yet existing on some AFS => let item-wise move sort it out
+
+    if (onBeforeFolderMove)
+        onBeforeFolderMove(AFS::getDisplayPath(folderPath), AFS::getDisplayPath(targetPath));
+
+    if (versioningStyle_ != VersioningStyle::replace)
+        versioningIndex_.prepareAddVersion(versioningFolderPath_); //throw FileError
+
+    try
+    {
+        try
+        {
+            //already existing: undefined behavior! (e.g. fail/overwrite)
+            AFS::moveAndRenameItem(folderPath, targetPath); //throw FileError, ErrorMoveUnsupported
+        }
+        catch (ErrorMoveUnsupported&) { return false; } //e.g. versioning folder on different device
+        catch (FileError&)
+        {
+            //parent folder missing => create + retry
+            if (const std::optional<AbstractPath> targetParentPath = AFS::getParentPath(targetPath))
+                AFS::createFolderIfMissingRecursion(*targetParentPath, knownFolders_); //throw FileError
+
+            AFS::moveAndRenameItem(folderPath, targetPath); //throw FileError, ErrorMoveUnsupported
+        }
+    }
+    catch (FileError&) { return false; } //nothing moved (rename is atomic) => item by item, reporting the actual error if any
+
+    //versions of the moved folder are unknown in detail => full traversal when applying versioning limits
+    if (versioningStyle_ != VersioningStyle::replace)
+        versioningIndex_.invalidate(versioningFolderPath_);
+    return true;
+}
+
 
 namespace
 {
-struct VersionInfo
+struct VersioningItems
 {
-    time_t       versionTime = 0;
-    AbstractPath filePath;
-    bool         isSymlink = false;
+    std::vector<std::pair<FileDescriptor, Zstring /*relPath*/>> files;
+    std::vector<std::pair<AbstractPath,   Zstring /*relPath*/>> symlinks;
+    std::vector<std::vector<std::pair<AbstractPath, Zstring /*relPath*/>>> foldersByLevel; //sub folders only
+};
+
+
+//traverser callbacks run on the calling thread => plain access to "items"
+class VersioningTraverser : public AFS::TraverserCallback
+{
+public:
+    VersioningTraverser(const AbstractPath& folderPath, const Zstring& relativePath, size_t level, VersioningItems& items) :
+        folderPath_(folderPath), relPathPf_(appendSeparator(relativePath)), level_(level), items_(items) {}
+
+private:
+    void onFile(const AFS::FileInfo& fi) override
+    {
+        assert(!fi.isFollowedSymlink);
+        items_.files.emplace_back(FileDescriptor{AFS::appendRelPath(folderPath_, fi.itemName),
+                                                 FileAttributes(fi.modTime, fi.fileSize, fi.filePrint, false /*isFollowedSymlink*/)},
+                                  relPathPf_ + fi.itemName);
+    }
+
+    HandleLink onSymlink(const AFS::SymlinkInfo& si) override
+    {
+        items_.symlinks.emplace_back(AFS::appendRelPath(folderPath_, si.itemName), relPathPf_ + si.itemName);
+        return HandleLink::skip;
+    }
+
+    std::shared_ptr<TraverserCallback> onFolder(const AFS::FolderInfo& fi) override
+    {
+        const AbstractPath subFolderPath = AFS::appendRelPath(folderPath_, fi.itemName);
+        const Zstring subRelPath = relPathPf_ + fi.itemName;
+
+        if (items_.foldersByLevel.size() <= level_)
+            items_.foldersByLevel.resize(level_ + 1);
+        items_.foldersByLevel[level_].emplace_back(subFolderPath, subRelPath);
+
+        return std::make_shared<VersioningTraverser>(subFolderPath, subRelPath, level_ + 1, items_);
+    }
+
+    HandleError reportDirError (const ErrorInfo& errorInfo)                          override { throw FileError(errorInfo.msg); }
+    HandleError reportItemError(const ErrorInfo& errorInfo, const Zstring& itemName) override { throw FileError(errorInfo.msg); }
+
+    const AbstractPath folderPath_;
+    const Zstring relPathPf_;
+    const size_t level_;
+    VersioningItems& items_;
 };
-using VersionInfoMap = std::map<Zstring, std::vector<VersionInfo>>; //relPathOrig => <version infos>
+
+
+/*  run doWork(0..itemCount-1) on "parallelOps" worker threads:
+    - reportBefore(i) and onWait() run on the calling thread (status callbacks, throw X)
+    - bounded number of items in flight; first error (in item order) is rethrown on the calling thread  */
+template <class ReportBefore, class Work, class OnWait>
+void executeParallel(size_t itemCount, size_t parallelOps, ReportBefore reportBefore /*throw X*/, Work doWork /*throw FileError, ThreadStopRequest*/, OnWait onWait /*throw X*/) //throw FileError, X
+{
+    if (itemCount == 0)
+        return;
+
+    ThreadGroup<std::function<void()>> tg(std::min(itemCount, parallelOps), Zstr("Versioning Folder"));
+    std::deque<std::future<void>> itemsPending; //destroy *before* tg
+
+    const size_t itemsInFlightMax = 2 * parallelOps;
+    size_t itemsQueued = 0;
+    for (;;)
+    {
+        while (itemsPending.size() < itemsInFlightMax && itemsQueued < itemCount)
+        {
+            const size_t i = itemsQueued++;
+            reportBefore(i); //throw X
+
+            auto task = std::make_shared<std::packaged_task<void()>>([&doWork, i] { doWork(i); });
+            itemsPending.push_back(task->get_future());
+            tg.run([task] { (*task)(); }); //std::function doesn't support move-only types
+        }
+
+        if (itemsPending.empty())
+            break;
+
+        while (itemsPending.front().wait_for(UI_UPDATE_INTERVAL / 2) != std::future_status::ready)
+            onWait(); //throw X
+
+        itemsPending.front().get(); //throw FileError
+        itemsPending.pop_front();
+        onWait(); //throw X
+    }
+}
+}
+
+
+void FileVersioner::revisionFolderParallel(const AbstractPath& folderPath, const Zstring& relativePath, //throw FileError, X
+                                           const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeFileMove,
+                                           const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeFolderMove,
+                                           const IoCallback& notifyUnbufferedIO /*throw X*/) const
+{
+    VersioningItems items;
+    AFS::traverseFolderRecursive(folderPath.afsDevice, {{folderPath.afsPath, std::make_shared<VersioningTraverser>(folderPath, relativePath, 0, items)}}, parallelOps_); //throw FileError
+
+    //worker threads: collect bytes copied; reported by calling thread (notifyUnbufferedIO is not thread-safe and may throw X)
+    std::atomic<int64_t> bytesPending(0);
+    auto notifyIoWorker = [&bytesPending](int64_t bytesDelta) { bytesPending += bytesDelta; interruptionPoint(); }; //throw ThreadStopRequest
+    auto onWait = [&] { if (notifyUnbufferedIO) notifyUnbufferedIO(bytesPending.exchange(0)); }; //throw X; even if zero: check for cancellation
+
+    auto getTargetDisplayPath = [&](const Zstring& relPath) { return AFS::getDisplayPath(AFS::appendRelPath(versioningFolderPath_, generateVersionedRelPath(relPath))); };
+
+    //create target directories only when needed in moveExistingItemToVersioning(): avoid empty directories!
+    executeParallel(items.files.size(), parallelOps_, [&](size_t i) //throw FileError, X
+    {
+        if (onBeforeFileMove)
+            onBeforeFileMove(AFS::getDisplayPath(items.files[i].first.path), getTargetDisplayPath(items.files[i].second)); //throw X
+    },
+    [&](size_t i) { revisionFileImpl(items.files[i].first, items.files[i].second, nullptr /*onBeforeMove*/, notifyIoWorker); }, onWait); //throw FileError, ThreadStopRequest
+
+    executeParallel(items.symlinks.size(), parallelOps_, [&](size_t i) //throw FileError, X
+    {
+        if (onBeforeFileMove)
+            onBeforeFileMove(AFS::getDisplayPath(items.symlinks[i].first), getTargetDisplayPath(items.symlinks[i].second)); //throw X
+    },
+    [&](size_t i) { revisionSymlinkImpl(items.symlinks[i].first, items.symlinks[i].second, nullptr /*onBeforeMove*/); }, onWait); //throw FileError
+
+    //delete source folders: children before parents
+    for (auto itLevel = items.foldersByLevel.rbegin(); itLevel != items.foldersByLevel.rend(); ++itLevel)
+        executeParallel(itLevel->size(), parallelOps_, [&](size_t i) //throw FileError, X
+    {
+        if (onBeforeFolderMove)
+            onBeforeFolderMove(AFS::getDisplayPath((*itLevel)[i].first), AFS::getDisplayPath(AFS::appendRelPath(versioningFolderPath_, (*itLevel)[i].second))); //throw X
+    },
+    [&](size_t i) { AFS::removeFolderPlain((*itLevel)[i].first); }, onWait); //throw FileError
+
+    if (onBeforeFolderMove)
+        onBeforeFolderMove(AFS::getDisplayPath(folderPath), AFS::getDisplayPath(AFS::appendRelPath(versioningFolderPath_, relativePath)));
+
+    AFS::removeFolderPlain(folderPath); //throw FileError
+}
+
+//###########################################################################################
+
+AbstractPath VersioningIndex::getIndexFilePath(const AbstractPath& versioningFolderPath)
+{
+    //*.ffs_db: excluded from comparison; no time stamp => never mistaken for a file version
+    return AFS::appendRelPath(versioningFolderPath, Zstr(".versions.ffs_db"));
+}
+
+
+void VersioningIndex::prepareAddVersion(const AbstractPath& versioningFolderPath) //throw FileError
+{
+    updatedIndexes_.access([&](auto& updatedIndexes)
+    {
+        if (updatedIndexes.contains(versioningFolderPath))
+            return;
+
+        const AbstractPath indexFilePath = getIndexFilePath(versioningFolderPath);
+
+        std::optional<IndexData> index;
+        if (limitedFolderPaths_.contains(versioningFolderPath)) //else: no need to load => just invalidate
+            try { index = loadIndex(indexFilePath); /*throw FileError*/ }
+            catch (FileError&) {} //not existing or corrupted => full traversal when applying versioning limits
+
+        AFS::removeFileIfExists(indexFilePath); //throw FileError
+
+        updatedIndexes.emplace(versioningFolderPath, std::move(index));
+    });
+}
+
+
+void VersioningIndex::addVersion(const AbstractPath& versioningFolderPath, const Version& version) //noexcept
+{
+    updatedIndexes_.access([&](auto& updatedIndexes)
+    {
+        auto it = updatedIndexes.find(versioningFolderPath);
+        assert(it != updatedIndexes.end()); //prepareAddVersion() called?
+        if (it != updatedIndexes.end() && it->second)
+            it->second->versions.push_back(version);
+    });
+}
+
+
+void VersioningIndex::invalidate(const AbstractPath& versioningFolderPath) //noexcept
+{
+    updatedIndexes_.access([&](auto& updatedIndexes)
+    {
+        auto it = updatedIndexes.find(versioningFolderPath);
+        assert(it != updatedIndexes.end()); //prepareAddVersion() called?
+        if (it != updatedIndexes.end())
+            it->second = std::nullopt; //keep "updated" status => no index => full traversal
+    });
+}
+
+
+std::optional<VersioningIndex::IndexData> VersioningIndex::takeUpdatedIndex(const AbstractPath& versioningFolderPath, bool& updated)
+{
+    return updatedIndexes_.access([&](auto& updatedIndexes) -> std::optional<IndexData>
+    {
+        auto it = updatedIndexes.find(versioningFolderPath);
+        updated = it != updatedIndexes.end();
+        if (!updated)
+            return std::nullopt;
+
+        std::optional<IndexData> index = std::move(it->second);
+        it->second = std::nullopt; //keep "updated" status
+        return index;
+    });
+}
+
+
+void VersioningIndex::saveIndex(const IndexData& index, const AbstractPath& indexFilePath) //throw FileError
+{
+    MemoryStreamOut<std::string> streamOutBody;
+    writeNumber<int64_t>(streamOutBody, index.lastFullScanTime);
+
+    writeNumber<uint32_t>(streamOutBody, static_cast<uint32_t>(index.versions.size()));
+    for (const Version& v : index.versions)
+    {
+        writeContainer(streamOutBody, utfTo<std::string>(v.relPathOrig));
+        writeContainer(streamOutBody, utfTo<std::string>(v.relPath));
+        writeNumber<int64_t >(streamOutBody, v.versionTime);
+        writeNumber<uint64_t>(streamOutBody, v.fileSize);
+        writeNumber<int8_t  >(streamOutBody, v.isSymlink);
+    }
+
+    MemoryStreamOut<std::string> streamOut;
+    writeArray(streamOut, VERSIONING_INDEX_DESCR, sizeof(VERSIONING_INDEX_DESCR));
+    writeNumber<int32_t>(streamOut, VERSIONING_INDEX_VERSION);
+    try
+    {
+        writeContainer(streamOut, compress(streamOutBody.ref(), 3 /*best compression level: see db_file.cpp*/)); //throw SysError
+    }
+    catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(AFS::getDisplayPath(indexFilePath))), e.toString()); }
+
+    writeNumber<uint32_t>(streamOut, getCrc32(streamOut.ref()));
+
+    //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
+    AFS::removeFileIfExists(indexFilePath); //throw FileError
+
+    const std::unique_ptr<AFS::OutputStream> fileStreamOut = AFS::getOutputStream(indexFilePath, //throw FileError
+                                                                                  streamOut.ref().size(),
+                                                                                  std::nullopt /*modTime*/,
+                                                                                  nullptr /*notifyUnbufferedIO*/);
+    fileStreamOut->write(streamOut.ref().c_str(), streamOut.ref().size()); //throw FileError
+    fileStreamOut->finalize();                                             //throw FileError
+}
+
+
+VersioningIndex::IndexData VersioningIndex::loadIndex(const AbstractPath& indexFilePath) //throw FileError
+{
+    std::string byteStream;
+    {
+        const std::unique_ptr<AFS::InputStream> fileStreamIn = AFS::getInputStream(indexFilePath, nullptr /*notifyUnbufferedIO*/); //throw FileError, ErrorFileLocked
+        byteStream = bufferedLoad<std::string>(*fileStreamIn); //throw FileError, ErrorFileLocked
+    }
+
+    try
+    {
+        MemoryStreamIn<std::string_view> streamIn(byteStream);
+
+        char formatDescr[sizeof(VERSIONING_INDEX_DESCR)] = {};
+        readArray(streamIn, formatDescr, sizeof(formatDescr)); //throw SysErrorUnexpectedEos
+
+        if (!std::equal(std::begin(formatDescr), std::end(formatDescr), std::begin(VERSIONING_INDEX_DESCR)))
+            throw SysError(_("File content is corrupted.") + L" (invalid header)");
+
+        const int version = readNumber<int32_t>(streamIn); //throw SysErrorUnexpectedEos
+        if (version != VERSIONING_INDEX_VERSION)
+            throw SysError(_("Unsupported data format.") + L' ' + replaceCpy(_("Version: %x"), L"%x", numberTo<std::wstring>(version)));
+
+        MemoryStreamOut<std::string> crcStreamOut;
+        writeNumber<uint32_t>(crcStreamOut, getCrc32(byteStream.begin(), byteStream.end() - std::min(byteStream.size(), sizeof(uint32_t))));
+        if (!endsWith(byteStream, crcStreamOut.ref()))
+            throw SysError(_("File content is corrupted.") + L" (invalid checksum)");
+
+        const std::string body = decompress(readContainer<std::string>(streamIn)); //throw SysError, SysErrorUnexpectedEos
+        MemoryStreamIn<std::string_view> streamInBody(body);
+
+        IndexData index;
+        index.lastFullScanTime = readNumber<int64_t>(streamInBody); //throw SysErrorUnexpectedEos
+
+        size_t versionCount = readNumber<uint32_t>(streamInBody); //throw SysErrorUnexpectedEos
+        while (versionCount-- != 0)
+        {
+            Version v;
+            v.relPathOrig = utfTo<Zstring>(readContainer<std::string>(streamInBody)); //
+            v.relPath     = utfTo<Zstring>(readContainer<std::string>(streamInBody)); //
+            v.versionTime = readNumber<int64_t >(streamInBody);                        //throw SysErrorUnexpectedEos
+            v.fileSize    = readNumber<uint64_t>(streamInBody);                        //
+            v.isSymlink   = readNumber<int8_t  >(streamInBody) != 0;                   //
+            index.versions.push_back(std::move(v));
+        }
+        return index;
+    }
+    catch (const SysError& e)
+    {
+        throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(AFS::getDisplayPath(indexFilePath))), e.toString());
+    }
+}
+
+//###########################################################################################
+
+namespace
+{
+using Version = VersioningIndex::Version;
 
 //subfolder\Sample.txt 2012-05-15 131513.txt  =>  subfolder\Sample.txt     version:2012-05-15 131513
 //2012-05-15 131513\subfolder\Sample.txt      =>          "                          "
 
-void findFileVersions(VersionInfoMap& versions,
+void findFileVersions(std::vector<Version>& versions,
                       const FolderContainer& folderCont,
-                      const AbstractPath& parentFolderPath,
+                      const Zstring& relPathParent,
                       const Zstring& relPathOrigParent,
                       const time_t* versionTimeParent)
 {
-    auto addVersion = [&](const Zstring& fileName, const Zstring& fileNameOrig, time_t versionTime, bool isSymlink)
+    auto addVersion = [&](const Zstring& fileName, const Zstring& fileNameOrig, time_t versionTime, uint64_t fileSize, bool isSymlink)
     {
-        const Zstring& relPathOrig   = nativeAppendPaths(relPathOrigParent, fileNameOrig);
-        const AbstractPath& filePath = AFS::appendRelPath(parentFolderPath, fileName);
-
-        versions[relPathOrig].push_back(VersionInfo{versionTime, filePath, isSymlink});
+        versions.push_back({nativeAppendPaths(relPathOrigParent, fileNameOrig),
+                            nativeAppendPaths(relPathParent, fileName), versionTime, fileSize, isSymlink});
     };
 
-    auto extractFileVersion = [&](const Zstring& fileName, bool isSymlink)
+    auto extractFileVersion = [&](const Zstring& fileName, uint64_t fileSize, bool isSymlink)
     {
         if (versionTimeParent) //VersioningStyle::timestampFolder
-            addVersion(fileName, fileName, *versionTimeParent, isSymlink);
+            addVersion(fileName, fileName, *versionTimeParent, fileSize, isSymlink);
         else
         {
             const std::pair<time_t, Zstring> vfn = fff::impl::parseVersionedFileName(fileName);
             if (vfn.first != 0) //VersioningStyle::timestampFile
-                addVersion(fileName, vfn.second, vfn.first, isSymlink);
+                addVersion(fileName, vfn.second, vfn.first, fileSize, isSymlink);
         }
     };
 
     for (const auto& [fileName, attr] : folderCont.files)
-        extractFileVersion(fileName, false /*isSymlink*/);
+        extractFileVersion(fileName, attr.fileSize, false /*isSymlink*/);
 
     for (const auto& [linkName, attr] : folderCont.symlinks)
-        extractFileVersion(linkName, true /*isSymlink*/);
+        extractFileVersion(linkName, 0 /*fileSize*/, true /*isSymlink*/);
 
     for (const auto& [folderName, attrAndSub] : folderCont.folders)
     {
@@ -354,16 +775,16 @@ void findFileVersions(VersionInfoMap& versions,
             const time_t versionTime = fff::impl::parseVersionedFolderName(folderName);
             if (versionTime != 0)
             {
-                findFileVersions(versions, attrAndSub.second,
-                                 AFS::appendRelPath(parentFolderPath, folderName),
+                findFileVersions(versions, *attrAndSub.second,
+                                 nativeAppendPaths(relPathParent, folderName),
                                  Zstring(), //[!] skip time-stamped folder
                                  &versionTime);
                 continue;
             }
         }
 
-        findFileVersions(versions, attrAndSub.second,
-                         AFS::appendRelPath(parentFolderPath, folderName),
+        findFileVersions(versions, *attrAndSub.second,
+                         nativeAppendPaths(relPathParent, folderName),
                          nativeAppendPaths(relPathOrigParent, folderName),
                          versionTimeParent);
     }
@@ -378,7 +799,49 @@ void getFolderItemCount(std::map<AbstractPath, size_t>& folderItemCount, const F
     //e.g. "subfolder" for versioning folders c:\folder and c:\folder\subfolder
 
     for (const auto& [folderName, attrAndSub] : folderCont.folders)
-        getFolderItemCount(folderItemCount, attrAndSub.second, AFS::appendRelPath(parentFolderPath, folderName));
+        getFolderItemCount(folderItemCount, *attrAndSub.second, AFS::appendRelPath(parentFolderPath, folderName));
+}
+
+
+//index doesn't know about items other than file versions => item count is a lower bound only
+void getFolderItemCount(std::map<AbstractPath, size_t>& folderItemCount, const std::vector<Version>& versions, const AbstractPath& versioningFolderPath)
+{
+    std::map<Zstring /*relPath*/, size_t> itemCountByRelPath;
+
+    for (const Version& v : versions)
+        for (Zstring relPath = v.relPath; !relPath.empty();)
+        {
+            const Zstring parentRelPath = beforeLast(relPath, FILE_NAME_SEPARATOR, IfNotFoundReturn::none);
+            if (itemCountByRelPath[parentRelPath]++ != 0) //parent already counted as an item of its own parent
+                break;
+            relPath = parentRelPath;
+        }
+
+    for (const auto& [relPath, itemCount] : itemCountByRelPath)
+    {
+        size_t& itemCountMax = folderItemCount[AFS::appendRelPath(versioningFolderPath, relPath)];
+        itemCountMax = std::max(itemCountMax, itemCount);
+    }
+}
+
+
+//same version found more than once, e.g. already indexed version overwritten during retry => keep last
+void sortAndRemoveDuplicates(std::vector<Version>& versions)
+{
+    std::stable_sort(versions.begin(), versions.end(), [](const Version& lhs, const Version& rhs)
+    {
+        return std::tie(lhs.relPathOrig, lhs.relPath) < std::tie(rhs.relPathOrig, rhs.relPath);
+    });
+
+    auto itOut = versions.begin();
+    for (auto it = versions.begin(); it != versions.end(); ++it)
+        if (it + 1 == versions.end() || it->relPath != (it + 1)->relPath)
+        {
+            if (itOut != it)
+                *itOut = std::move(*it);
+            ++itOut;
+        }
+    versions.erase(itOut, versions.end());
 }
 }
 
@@ -399,8 +862,26 @@ std::weak_ordering fff::operator<=>(const VersioningLimitFolder& lhs, const Vers
 
 
 void fff::applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimits,
+                               VersioningIndex& versioningIndex,
+                               const std::map<AfsDevice, size_t>& deviceParallelOps,
                                PhaseCallback& callback /*throw X*/)
 {
+    struct FolderVersions
+    {
+        time_t lastFullScanTime = 0;
+        std::vector<Version> versions; //sorted by relPathOrig
+        bool fromIndex = false;
+        bool indexComplete = true; //false: traversal errors => don't save index
+    };
+    std::map<AbstractPath, FolderVersions> versionDetails; //versioningFolderPath => <version details>
+
+    const time_t now = std::time(nullptr);
+
+    auto indexIsRecent = [now](const VersioningIndex::IndexData& index)
+    {
+        return now - VERSIONING_INDEX_RESCAN_DAYS * 24 * 3600 <= index.lastFullScanTime && index.lastFullScanTime <= now + 24 * 3600; //clock changes
+    };
+
     //--------- determine existing folder paths for traversal ---------
     std::set<DirectoryKey> foldersToRead;
     std::set<VersioningLimitFolder> folderLimitsTmp;
@@ -414,6 +895,49 @@ void fff::applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimi
                 folderLimitsTmp.insert(vlf);
             }
 
+        //--------- use versioning index instead of traversal if available ---------
+        std::vector<std::pair<AbstractPath, ParallelWorkItem>> parallelWorkload;
+        Protected<std::map<AbstractPath, FolderVersions>&> versionDetailsShared(versionDetails);
+
+        for (const AbstractPath& folderPath : pathsToCheck)
+        {
+            bool updated = false;
+            std::optional<VersioningIndex::IndexData> index = versioningIndex.takeUpdatedIndex(folderPath, updated);
+            if (updated)
+            {
+                if (index && indexIsRecent(*index))
+                    versionDetails[folderPath] = {index->lastFullScanTime, std::move(index->versions), true /*fromIndex*/};
+            }
+            else
+                parallelWorkload.emplace_back(folderPath, [&versionDetailsShared, &indexIsRecent](ParallelContext& ctx) //throw ThreadStopRequest
+            {
+                const AbstractPath indexFilePath = VersioningIndex::getIndexFilePath(ctx.itemPath);
+                try
+                {
+                    ctx.acb.updateStatus(replaceCpy(_("Loading file %x..."), L"%x", fmtPath(AFS::getDisplayPath(indexFilePath)))); //throw ThreadStopRequest
+
+                    VersioningIndex::IndexData index2 = VersioningIndex::loadIndex(indexFilePath); //throw FileError
+                    if (indexIsRecent(index2))
+                    {
+                        //remove *before* deleting versions; written again afterwards
+                        AFS::removeFileIfExists(indexFilePath); //throw FileError
+
+                        versionDetailsShared.access([&](auto& versionDetails2)
+                        {
+                            versionDetails2[ctx.itemPath] = {index2.lastFullScanTime, std::move(index2.versions), true /*fromIndex*/};
+                        });
+                    }
+                }
+                catch (FileError&) {} //not existing or corrupted => full traversal
+            });
+        }
+
+        massParallelExecute(parallelWorkload, deviceParallelOps,
+                            Zstr("Versioning Index"), callback /*throw X*/); //throw X
+
+        for (const auto& [folderPath, folderVersions] : versionDetails)
+            pathsToCheck.erase(folderPath);
+
         //what if versioning folder paths differ only in case? => perf pessimization, but already checked, see fff::synchronize()
 
         //we don't want to show an error if version path does not yet exist!
@@ -441,7 +965,7 @@ void fff::applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimi
         }, callback); //throw X
     }
 
-    //--------- traverse all versioning folders ---------
+    //--------- traverse remaining versioning folders ---------
     const std::wstring textScanning = _("Searching for old file versions:") + L' ';
 
     auto onStatusUpdate = [&](const std::wstring& statusLine, int itemsTotal)
@@ -449,40 +973,64 @@ void fff::applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimi
         callback.updateStatus(textScanning + statusLine); //throw X
     };
 
-    const std::map<DirectoryKey, DirectoryValue> folderBuf = parallelDeviceTraversal(foldersToRead,
+    const std::map<DirectoryKey, DirectoryValue> folderBuf = parallelDeviceTraversal(foldersToRead, deviceParallelOps,
     [&](const PhaseCallback::ErrorInfo& errorInfo) { return callback.reportError(errorInfo); }, //throw X
     onStatusUpdate, //throw X
     UI_UPDATE_INTERVAL / 2); //every ~50 ms
 
     //--------- group versions per (original) relative path ---------
-    std::map<AbstractPath, VersionInfoMap> versionDetails; //versioningFolderPath => <version details>
     std::map<AbstractPath, size_t> folderItemCount; //<folder path> => <item count> for determination of empty folders
+    std::set<AbstractPath> foldersToVerify; //item count from index: might contain other items
 
     for (const auto& [folderKey, folderVal] : folderBuf)
     {
         const AbstractPath versioningFolderPath = folderKey.folderPath;
 
         assert(!versionDetails.contains(versioningFolderPath));
+        FolderVersions& folderVersions = versionDetails[versioningFolderPath];
+        folderVersions.lastFullScanTime = now;
 
-        findFileVersions(versionDetails[versioningFolderPath],
+        findFileVersions(folderVersions.versions,
                          folderVal.folderCont,
-                         versioningFolderPath,
+                         Zstring() /*relPathParent*/,
                          Zstring() /*relPathOrigParent*/,
                          nullptr /*versionTimeParent*/);
 
         //determine item count per folder for later detection and removal of empty folders:
         getFolderItemCount(folderItemCount, folderVal.folderCont, versioningFolderPath);
 
-        //make sure the versioning folder is never found empty and is not deleted:
-        ++folderItemCount[versioningFolderPath];
-
         //similarly, failed folder traversal should not make folders look empty:
         for (const auto& [relPath, errorMsg] : folderVal.failedFolderReads) ++folderItemCount[AFS::appendRelPath(versioningFolderPath, relPath)];
         for (const auto& [relPath, errorMsg] : folderVal.failedItemReads  ) ++folderItemCount[AFS::appendRelPath(versioningFolderPath, beforeLast(relPath, FILE_NAME_SEPARATOR, IfNotFoundReturn::none))];
+
+        if (!folderVal.failedFolderReads.empty() || !folderVal.failedItemReads.empty())
+            folderVersions.indexComplete = false;
+    }
+
+    for (auto& [versioningFolderPath, folderVersions] : versionDetails)
+    {
+        sortAndRemoveDuplicates(folderVersions.versions);
+
+        if (folderVersions.fromIndex)
+        {
+            std::map<AbstractPath, size_t> itemCountIdx;
+            getFolderItemCount(itemCountIdx, folderVersions.versions, versioningFolderPath);
+
+            for (const auto& [folderPath, itemCount] : itemCountIdx)
+            {
+                size_t& itemCountMax = folderItemCount[folderPath];
+                itemCountMax = std::max(itemCountMax, itemCount);
+                foldersToVerify.insert(folderPath);
+            }
+        }
+
+        //make sure the versioning folder is never found empty and is not deleted:
+        ++folderItemCount[versioningFolderPath];
     }
 
     //--------- calculate excess file versions ---------
-    std::map<AbstractPath, bool /*isSymlink*/> itemsToDelete;
+    std::map<AbstractPath, std::pair<bool /*isSymlink*/, uint8_t* /*deleted*/>> itemsToDelete;
+    std::map<AbstractPath, std::vector<uint8_t /*bool*/>> versionsDeleted; //per versioning folder: same order as FolderVersions::versions
 
     const time_t lastMidnightTime = []
     {
@@ -497,14 +1045,25 @@ void fff::applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimi
     {
         auto it = versionDetails.find(vlf.versioningFolderPath);
         if (it != versionDetails.end())
-            for (auto& [versioningFolderPath, versions] : it->second)
+        {
+            std::vector<Version>& allVersions = it->second.versions;
+            std::vector<uint8_t>& deleted = versionsDeleted[vlf.versioningFolderPath];
+            deleted.resize(allVersions.size(), 0);
+
+            std::vector<size_t> versions; //one original relative path
+            for (size_t i = 0; i < allVersions.size();)
             {
+                versions.clear();
+                for (size_t j = i; j < allVersions.size() && allVersions[j].relPathOrig == allVersions[i].relPathOrig; ++j)
+                    versions.push_back(j);
+                i += versions.size();
+
                 size_t versionsToKeep = versions.size();
                 if (vlf.versionMaxAgeDays > 0)
                 {
                     const time_t cutOffTime = lastMidnightTime - static_cast<time_t>(vlf.versionMaxAgeDays) * 24 * 3600;
 
-                    versionsToKeep = std::count_if(versions.begin(), versions.end(), [cutOffTime](const VersionInfo& vi) { return vi.versionTime >= cutOffTime; });
+                    versionsToKeep = std::count_if(versions.begin(), versions.end(), [&](size_t idx) { return allVersions[idx].versionTime >= cutOffTime; });
 
                     if (vlf.versionCountMin > 0)
                         versionsToKeep = std::max<size_t>(versionsToKeep, vlf.versionCountMin);
@@ -515,15 +1074,17 @@ void fff::applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimi
                 if (versions.size() > versionsToKeep)
                 {
                     std::nth_element(versions.begin(), versions.end() - versionsToKeep, versions.end(),
-                    [](const VersionInfo& lhs, const VersionInfo& rhs) { return lhs.versionTime < rhs.versionTime; });
+                    [&](size_t lhs, size_t rhs) { return allVersions[lhs].versionTime < allVersions[rhs].versionTime; });
                     //oldest versions sorted to the front
 
-                    std::for_each(versions.begin(), versions.end() - versionsToKeep, [&](const VersionInfo& vi)
+                    std::for_each(versions.begin(), versions.end() - versionsToKeep, [&](size_t idx)
                     {
-                        itemsToDelete.emplace(vi.filePath, vi.isSymlink);
+                        itemsToDelete.emplace(AFS::appendRelPath(vlf.versioningFolderPath, allVersions[idx].relPath),
+                                              std::pair(allVersions[idx].isSymlink, &deleted[idx]));
                     });
                 }
             }
+        }
     }
 
     //--------- remove excess file versions ---------
@@ -532,15 +1093,25 @@ void fff::applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimi
     const std::wstring txtDeletingFolder = _("Deleting folder %x");
 
     std::function<void(const AbstractPath& folderPath, AsyncCallback& acb)> deleteEmptyFolderTask;
-    deleteEmptyFolderTask = [&txtDeletingFolder, &folderItemCountShared, &deleteEmptyFolderTask](const AbstractPath& folderPath, AsyncCallback& acb) //throw ThreadStopRequest
+    deleteEmptyFolderTask = [&txtDeletingFolder, &folderItemCountShared, &foldersToVerify, &deleteEmptyFolderTask](const AbstractPath& folderPath, AsyncCallback& acb) //throw ThreadStopRequest
     {
+        bool folderEmpty = true;
         const std::wstring errMsg = tryReportingError([&] //throw ThreadStopRequest
         {
-            acb.updateStatus(replaceCpy(txtDeletingFolder, L"%x", fmtPath(AFS::getDisplayPath(folderPath)))); //throw ThreadStopRequest
-            AFS::removeEmptyFolderIfExists(folderPath); //throw FileError
+            if (foldersToVerify.contains(folderPath))
+                AFS::traverseFolderFlat(folderPath, //throw FileError
+                [&](const AFS::FileInfo&    fi) { folderEmpty = false; },
+                [&](const AFS::FolderInfo&  fi) { folderEmpty = false; },
+                [&](const AFS::SymlinkInfo& si) { folderEmpty = false; });
+
+            if (folderEmpty)
+            {
+                acb.updateStatus(replaceCpy(txtDeletingFolder, L"%x", fmtPath(AFS::getDisplayPath(folderPath)))); //throw ThreadStopRequest
+                AFS::removeEmptyFolderIfExists(folderPath); //throw FileError
+            }
         }, acb);
 
-        if (errMsg.empty())
+        if (errMsg.empty() && folderEmpty)
             if (const std::optional<AbstractPath> parentPath = AFS::getParentPath(folderPath))
             {
                 bool deleteParent = false;
@@ -559,8 +1130,8 @@ void fff::applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimi
             deleteEmptyFolderTask(ctx.itemPath, ctx.acb); //throw ThreadStopRequest
         });
 
-    for (const auto& [itemPath, isSymlink] : itemsToDelete)
-        parallelWorkload.emplace_back(itemPath, [isSymlink /*clang bug*/= isSymlink, &txtRemoving, &folderItemCountShared, &deleteEmptyFolderTask](ParallelContext& ctx) //throw ThreadStopRequest
+    for (const auto& [itemPath, deleteInfo] : itemsToDelete)
+        parallelWorkload.emplace_back(itemPath, [isSymlink = deleteInfo.first, &deleted = *deleteInfo.second, &txtRemoving, &folderItemCountShared, &deleteEmptyFolderTask](ParallelContext& ctx) //throw ThreadStopRequest
     {
         const std::wstring errMsg = tryReportingError([&] //throw ThreadStopRequest
         {
@@ -572,6 +1143,9 @@ void fff::applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimi
         }, ctx.acb);
 
         if (errMsg.empty())
+        {
+            deleted = 1; //each item is owned by a single task
+
             if (const std::optional<AbstractPath> parentPath = AFS::getParentPath(ctx.itemPath))
             {
                 bool deleteParent = false;
@@ -579,8 +1153,33 @@ void fff::applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimi
                 if (deleteParent)
                     deleteEmptyFolderTask(*parentPath, ctx.acb); //throw ThreadStopRequest
             }
+        }
     });
 
-    massParallelExecute(parallelWorkload,
+    massParallelExecute(parallelWorkload, deviceParallelOps,
                         Zstr("Versioning Limit"), callback /*throw X*/); //throw X
+
+    //--------- (re-)write versioning index ---------
+    parallelWorkload.clear();
+
+    for (const auto& [versioningFolderPath, folderVersions] : versionDetails)
+        if (folderVersions.indexComplete)
+            parallelWorkload.emplace_back(versioningFolderPath, [&folderVersions, &deleted = versionsDeleted[versioningFolderPath]](ParallelContext& ctx) //throw ThreadStopRequest
+        {
+            VersioningIndex::IndexData index{folderVersions.lastFullScanTime, {}};
+            for (size_t i = 0; i < folderVersions.versions.size(); ++i)
+                if (i >= deleted.size() || !deleted[i])
+                    index.versions.push_back(folderVersions.versions[i]);
+
+            const AbstractPath indexFilePath = VersioningIndex::getIndexFilePath(ctx.itemPath);
+
+            tryReportingError([&] //throw ThreadStopRequest
+            {
+                ctx.acb.updateStatus(replaceCpy(_("Saving file %x..."), L"%x", fmtPath(AFS::getDisplayPath(indexFilePath)))); //throw ThreadStopRequest
+                VersioningIndex::saveIndex(index, indexFilePath); //throw FileError
+            }, ctx.acb);
+        });
+
+    massParallelExecute(parallelWorkload, deviceParallelOps,
+                        Zstr("Versioning Index"), callback /*throw X*/); //throw X
 }
@@ -10,6 +10,7 @@
 #include <functional>
 #include <zen/time.h>
 #include <zen/file_error.h>
+#include <zen/thread.h>
 #include "structures.h"
 #include "algorithm.h"
 #include "../afs/abstract.h"
@@ -17,6 +18,55 @@
 
 namespace fff
 {
+/*  persistent list of file versions inside the versioning folder: apply versioning limits without traversing all of it
+
+    - the index file is loaded and removed *before* FileVersioner adds the first new version
+      => a cancelled sync can't leave an outdated index: fall back to full traversal instead
+    - full traversal also if the index is missing, corrupted or too old (catch versions added/deleted manually)
+    - only maintained for versioning folders with limits: for all others, the index file is just removed  */
+class VersioningIndex
+{
+public:
+    explicit VersioningIndex(const std::set<AbstractPath>& limitedFolderPaths) : limitedFolderPaths_(limitedFolderPaths) {}
+
+    struct Version
+    {
+        Zstring relPathOrig; //e.g. subfolder\Sample.txt
+        Zstring relPath;     //e.g. subfolder\Sample.txt 2012-05-15 131513.txt (relative to versioning folder)
+        time_t versionTime = 0;
+        uint64_t fileSize = 0;
+        bool isSymlink = false;
+    };
+
+    struct IndexData
+    {
+        time_t lastFullScanTime = 0;
+        std::vector<Version> versions;
+    };
+
+    //multi-threaded access: internally synchronized!
+    void prepareAddVersion(const AbstractPath& versioningFolderPath); //throw FileError; call before moving a new version into the versioning folder
+    void addVersion(const AbstractPath& versioningFolderPath, const Version& version); //noexcept
+    void invalidate(const AbstractPath& versioningFolderPath); //noexcept; versions added without details (e.g. folder moved as a whole) => full traversal
+
+    //index including versions added meanwhile; std::nullopt: no (valid) index; updated == false: prepareAddVersion() not called => load from disk instead
+    std::optional<IndexData> takeUpdatedIndex(const AbstractPath& versioningFolderPath, bool& updated);
+
+    static AbstractPath getIndexFilePath(const AbstractPath& versioningFolderPath);
+
+    static IndexData loadIndex(const AbstractPath& indexFilePath);                    //throw FileError
+    static void      saveIndex(const IndexData& index, const AbstractPath& indexFilePath); //throw FileError
+
+private:
+    VersioningIndex           (const VersioningIndex&) = delete;
+    VersioningIndex& operator=(const VersioningIndex&) = delete;
+
+    const std::set<AbstractPath> limitedFolderPaths_;
+    zen::Protected<std::map<AbstractPath, std::optional<IndexData>>> updatedIndexes_; //versioning folders where prepareAddVersion() was called
+};
+
+//--------------------------------------------------------------------------------
+
 /* e.g. move C:\Source\subdir\Sample.txt -> D:\Revisions\subdir\Sample.txt 2012-05-15 131513.txt
     scheme: <revisions directory>\<relpath>\<filename>.<ext> YYYY-MM-DD HHMMSS.<ext>
 
@@ -27,17 +77,23 @@ namespace fff
     - multi-threading: internally synchronized
     - replaces already existing target files/dirs (supports retry)
         => (unlikely) risk of data loss for naming convention "versioning":
-        race-condition if multiple folder pairs process the same filepath!!                */
+        race-condition if multiple folder pairs process the same filepath!!
+    - folders: single rename of the whole folder if item names are kept and the target folder is not yet existing (=> may include empty sub folders)
+               else move items in parallel (parallelOps of the source device)                                                                        */
 
 class FileVersioner
 {
 public:
     FileVersioner(const AbstractPath& versioningFolderPath, //throw FileError
                   VersioningStyle versioningStyle,
-                  time_t syncStartTime) :
+                  time_t syncStartTime,
+                  VersioningIndex& versioningIndex,
+                  size_t parallelOps) :
         versioningFolderPath_(versioningFolderPath),
         versioningStyle_(versioningStyle),
         syncStartTime_(syncStartTime),
+        versioningIndex_(versioningIndex),
+        parallelOps_(std::max<size_t>(parallelOps, 1)),
         timeStamp_(zen::formatTime(Zstr("%Y-%m-%d %H%M%S"), zen::getLocalTime(syncStartTime))) //e.g. "2012-05-15 131513"
     {
         using namespace zen;
@@ -55,6 +111,10 @@ public:
                       //called frequently if move has to revert to copy + delete => see zen::copyFile for limitations when throwing exceptions!
                       const zen::IoCallback& notifyUnbufferedIO /*throw X*/) const;
 
+    /*  copy-on-write alternative to revisionFile() for native paths (Btrfs, XFS): reflink the file into the versioning folder, but leave it in place
+        => caller may then update it in place, e.g. block-level delta; false: no reflink support or not native => nothing versioned   */
+    bool revisionFileAsClone(const FileDescriptor& fileDescr, const Zstring& relativePath) const; //throw FileError
+
     void revisionSymlink(const AbstractPath& linkPath, const Zstring& relativePath) const; //throw FileError
 
     void revisionFolder(const AbstractPath& folderPath, const Zstring& relativePath, //throw FileError, X
@@ -79,12 +139,23 @@ private:
                             const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeFolderMove,
                             const zen::IoCallback& notifyUnbufferedIO) const; //throw FileError, X
 
-    AbstractPath generateVersionedPath(const Zstring& relativePath) const;
+    void revisionFolderParallel(const AbstractPath& folderPath, const Zstring& relativePath,
+                                const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeFileMove,
+                                const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeFolderMove,
+                                const zen::IoCallback& notifyUnbufferedIO) const; //throw FileError, X
+
+    bool revisionFolderByRename(const AbstractPath& folderPath, const Zstring& relativePath, //throw FileError
+                                const std::function<void(const std::wstring& displayPathFrom, const std::wstring& displayPathTo)>& onBeforeFolderMove) const;
+
+    Zstring generateVersionedRelPath(const Zstring& relativePath) const;
 
     const AbstractPath versioningFolderPath_;
     const VersioningStyle versioningStyle_;
     const time_t syncStartTime_;
+    VersioningIndex& versioningIndex_;
+    const size_t parallelOps_;
     const Zstring timeStamp_;
+    mutable ExistingFolderCache knownFolders_; //intermediate folders created below versioningFolderPath_ (or found existing)
 };
 
 //--------------------------------------------------------------------------------
@@ -100,6 +171,8 @@ std::weak_ordering operator<=>(const VersioningLimitFolder& lhs, const Versionin
 
 
 void applyVersioningLimit(const std::set<VersioningLimitFolder>& folderLimits,
+                          VersioningIndex& versioningIndex,
+                          const std::map<AfsDevice, size_t>& deviceParallelOps,
                           PhaseCallback& callback /*throw X*/);
 
 
@@ -6,7 +6,15 @@
 
 #include "base_tools.h"
 #include <wx/app.h>
+#include <zen/file_io.h>
+#include <zen/format_unit.h>
+#include <zen/perf.h>
+#include <zen/thread.h>
+#include <iostream>
+#include "base/db_file.h"
 #include "base/path_filter.h"
+#include "base/synchronization.h"
+#include "afs/snapshot_changes.h"
 
 using namespace zen;
 using namespace fff;
@@ -75,11 +83,87 @@ void fff::logNonDefaultSettings(const XmlGlobalSettings& activeSettings, PhaseCa
     if (activeSettings.verifyFileCopy != defaultSettings.verifyFileCopy)
         changedSettingsMsg += L"\n    " + _("Verify copied files") + L" - " + (activeSettings.verifyFileCopy ? _("Enabled") : _("Disabled"));
 
+    if (activeSettings.asyncFileIo != defaultSettings.asyncFileIo)
+        changedSettingsMsg += L"\n    " + _("Asynchronous file I/O") + L" - " + (activeSettings.asyncFileIo ? _("Enabled") : _("Disabled"));
+
+    if (activeSettings.contentPrefilterMinSizeMB != defaultSettings.contentPrefilterMinSizeMB)
+        changedSettingsMsg += L"\n    " + _("Sample large files before comparing content") + L" - " +
+                              (activeSettings.contentPrefilterMinSizeMB > 0 ? formatFilesizeShort(static_cast<int64_t>(activeSettings.contentPrefilterMinSizeMB) * 1024 * 1024) : _("Disabled"));
+
+    if (activeSettings.autoTuneParallelOps != defaultSettings.autoTuneParallelOps)
+        changedSettingsMsg += L"\n    " + _("Auto-tune parallel file operations") + L" - " + (activeSettings.autoTuneParallelOps ? _("Enabled") : _("Disabled"));
+
+    if (activeSettings.deviceBandwidthLimitKB != defaultSettings.deviceBandwidthLimitKB)
+        changedSettingsMsg += L"\n    " + _("Bandwidth limit per device") + L" - " +
+                              (activeSettings.deviceBandwidthLimitKB > 0 ? replaceCpy(_("%x/sec"), L"%x", formatFilesizeShort(static_cast<int64_t>(activeSettings.deviceBandwidthLimitKB) * 1024)) : _("Disabled"));
+
+    if (activeSettings.snapshotChangeSource != defaultSettings.snapshotChangeSource)
+        changedSettingsMsg += L"\n    " + _("Detect changes via file system snapshots") + L" - " + (activeSettings.snapshotChangeSource ? _("Enabled") : _("Disabled"));
+
+    if (activeSettings.rotationalMode != defaultSettings.rotationalMode)
+        changedSettingsMsg += L"\n    " + _("Seek-optimized order for hard disks") + L" - " +
+                              (activeSettings.rotationalMode == RotationalMode::always ? _("Enabled") : _("Disabled"));
+
+    if (activeSettings.numaAffinity != defaultSettings.numaAffinity)
+        changedSettingsMsg += L"\n    " + _("NUMA-aware worker placement") + L" - " + (activeSettings.numaAffinity ? _("Enabled") : _("Disabled"));
+
+    if (activeSettings.dbCatalogFolderPath != defaultSettings.dbCatalogFolderPath)
+        changedSettingsMsg += L"\n    " + _("Database catalog for remote folders") + L" - " + fmtPath(activeSettings.dbCatalogFolderPath);
+
     if (!changedSettingsMsg.empty())
         callback.logInfo(_("Using non-default global settings:") + changedSettingsMsg); //throw X
 }
 
 
+uint64_t fff::getContentPrefilterMinSize(const XmlGlobalSettings& globalSettings)
+{
+    return globalSettings.contentPrefilterMinSizeMB > 0 ? static_cast<uint64_t>(globalSettings.contentPrefilterMinSizeMB) * 1024 * 1024 : 0;
+}
+
+
+void fff::applyProcessSettings(const XmlGlobalSettings& globalSettings)
+{
+    setFileIoMode(globalSettings.asyncFileIo ? FileIoMode::ioUring : FileIoMode::synchronous);
+    setDeviceBandwidthLimit(globalSettings.deviceBandwidthLimitKB > 0 ? static_cast<uint64_t>(globalSettings.deviceBandwidthLimitKB) * 1024 : 0);
+    setSnapshotChangeSource(globalSettings.snapshotChangeSource);
+    setRotationalMode(globalSettings.rotationalMode);
+    enableNumaAffinity(globalSettings.numaAffinity);
+    setDatabaseCatalogFolder(globalSettings.dbCatalogFolderPath);
+    enableTraceFile(globalSettings.traceFilePath);
+    if (!globalSettings.metricsFilePath.empty() || globalSettings.progressDlgDiagnostics)
+        enableMetrics(true);
+}
+
+
+namespace
+{
+Zstring globalTraceFilePath; //main thread only
+}
+
+
+void fff::enableTraceFile(const Zstring& traceFilePath)
+{
+    assert(runningOnMainThread());
+    if (!traceFilePath.empty() && globalTraceFilePath.empty())
+    {
+        globalTraceFilePath = traceFilePath;
+        enableTracing(true);
+    }
+}
+
+
+void fff::writeTraceFile() //noexcept
+{
+    assert(runningOnMainThread());
+    if (!globalTraceFilePath.empty())
+        try
+        {
+            setFileContent(globalTraceFilePath, getTraceJson(), nullptr /*notifyUnbufferedIO*/); //throw FileError
+        }
+        catch (const FileError& e) { std::cerr << utfTo<std::string>(e.toString()) << '\n'; }
+}
+
+
 namespace
 {
 FilterConfig mergeFilterConfig(const FilterConfig& global, const FilterConfig& local)
@@ -258,6 +342,7 @@ MainConfiguration fff::merge(const std::vector<MainConfiguration>& mainCfgs)
     cfgOut.firstPair    = mergedCfgs[0];
     cfgOut.additionalPairs.assign(mergedCfgs.begin() + 1, mergedCfgs.end());
     cfgOut.deviceParallelOps = mergedParallelOps;
+    cfgOut.cacheNeutralCopy = std::any_of(mainCfgs.begin(), mainCfgs.end(), [](const MainConfiguration& mainCfg) { return mainCfg.cacheNeutralCopy; });
 
     cfgOut.ignoreErrors = std::all_of(mainCfgs.begin(), mainCfgs.end(), [](const MainConfiguration& mainCfg) { return mainCfg.ignoreErrors; });
 
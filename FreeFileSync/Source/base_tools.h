@@ -21,6 +21,15 @@ std::wstring              toTimeShiftPhrase  (const std::vector<unsigned int>& i
 //inform about (important) non-default global settings related to comparison and synchronization
 void logNonDefaultSettings(const XmlGlobalSettings& currentSettings, PhaseCallback& callback);
 
+//global settings that are not passed explicitly, but apply process-wide (e.g. low-level file I/O)
+void applyProcessSettings(const XmlGlobalSettings& globalSettings);
+
+//record zen::TraceSpan's and write them as Chrome trace JSON (https://ui.perfetto.dev) at process end
+void enableTraceFile(const Zstring& traceFilePath); //first non-empty path wins: command line before global settings
+void writeTraceFile(); //noexcept
+
+uint64_t getContentPrefilterMinSize(const XmlGlobalSettings& globalSettings); //bytes; 0 if disabled
+
 //facilitate drag & drop config merge:
 MainConfiguration merge(const std::vector<MainConfiguration>& mainCfgs);
 }
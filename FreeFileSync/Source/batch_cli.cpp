@@ -0,0 +1,822 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include <atomic>
+#include <csignal>
+#include <iostream>
+#include <thread>
+#include <zen/file_access.h>
+#include <zen/format_unit.h>
+#include <zen/perf.h>
+#include <zen/process_priority.h>
+#include <zen/resolve_path.h>
+#include <zen/shutdown.h>
+#include <wx/init.h>
+#include "afs/concrete.h"
+#include "afs/native.h"
+#include "base/comparison.h"
+#include "base/db_file.h"
+#include "base/file_list_csv.h"
+#include "base/synchronization.h"
+#include "base_tools.h"
+#include "config.h"
+#include "fatal_error.h"
+#include "log_file.h"
+#include "metrics_file.h"
+#include "RealTimeSync/monitor.h"
+
+    #include <unistd.h> //isatty
+
+using namespace zen;
+using namespace fff;
+
+
+/*  headless batch runner: executes .ffs_batch jobs from the console, e.g. run by cron on servers without X
+    - no wxApp, no event loop, no progress dialog: wxWidgets is initialized as console application only
+    - errors and warnings cannot be answered interactively => BatchErrorHandling::showPopup is treated like "ignore" (errors are logged and set the exit code)
+    - multiple jobs are merged into a single run (like selecting multiple configurations on main dialog):
+        => one comparison: traversal of folders shared by jobs is done once, per-device parallel operations are merged (see fff::merge())
+        => one set of directory locks and (S)FTP/Google Drive sessions for all jobs
+    - -Watch: RealTimeSync in-process, i.e. monitor the local base folders and synchronize incrementally after changes
+        => configuration, translations and (S)FTP/Google Drive sessions stay warm between runs instead of a cold start per change
+    - -ExportFileList: comparison result as CSV, like the main dialog's file list export, but with fixed columns
+    - -IndexHashes: pre-warm the content hash cache in sync.ffs_db (e.g. scheduled at night, or run by RealTimeSync): compare only, no synchronization
+        => only folder pairs comparing by content *and* using sync.ffs_db: only these read the cache, see comparison.cpp findContentVerifiedDbFile()
+        => idle I/O priority + bandwidth cap for content reads: the real job later only hashes files changed in the meantime                  */
+namespace
+{
+constexpr std::chrono::seconds      WATCH_RETRY_AFTER_ERROR_INTERVAL(15);
+constexpr std::chrono::milliseconds WATCH_UPDATE_INTERVAL(100);
+
+std::atomic<bool> cancelRequested{false}; //set by signal handler
+
+extern "C" void onCancelSignal(int /*sig*/) { cancelRequested = true; }
+
+
+void printConsole(const std::wstring& msg, MessageType type)
+{
+    (type == MSG_TYPE_INFO ? std::cout : std::cerr) << formatMessage({std::time(nullptr), type, utfTo<Zstringc>(msg)}) << std::flush;
+}
+
+
+class ConsoleStatusHandler : public StatusHandler
+{
+public:
+    ConsoleStatusHandler(const std::vector<std::wstring>& jobNames, //should not be empty for a batch job!
+                         const std::chrono::system_clock::time_point& startTime,
+                         bool ignoreErrors,
+                         size_t autoRetryCount,
+                         std::chrono::seconds autoRetryDelay,
+                         BatchErrorHandling batchErrorHandling) :
+        jobNames_(jobNames),
+        startTime_(startTime),
+        ignoreErrors_(ignoreErrors),
+        autoRetryCount_(autoRetryCount),
+        autoRetryDelay_(autoRetryDelay),
+        batchErrorHandling_(batchErrorHandling) {}
+
+    void initNewPhase(int itemsTotal, int64_t bytesTotal, ProcessPhase phaseID) override //throw AbortProcess
+    {
+        StatusHandler::initNewPhase(itemsTotal, bytesTotal, phaseID);
+        requestUiUpdate(true /*force*/); //throw AbortProcess
+    }
+
+    void logInfo(const std::wstring& msg) override //throw AbortProcess
+    {
+        logMsg(msg, MSG_TYPE_INFO);
+        requestUiUpdate(false /*force*/); //throw AbortProcess
+    }
+
+    void reportWarning(const std::wstring& msg, bool& warningActive) override //throw AbortProcess
+    {
+        logMsg(msg, MSG_TYPE_WARNING);
+
+        if (warningActive && !ignoreErrors_ && batchErrorHandling_ == BatchErrorHandling::cancel)
+            abortProcessNow(AbortTrigger::program); //throw AbortProcess
+    }
+
+    Response reportError(const ErrorInfo& errorInfo) override //throw AbortProcess
+    {
+        //auto-retry
+        if (errorInfo.retryNumber < autoRetryCount_)
+        {
+            logMsg(errorInfo.msg + L"\n-> " + _("Automatic retry"), MSG_TYPE_INFO);
+            addMetricCount("retries", [] { return std::string(); }, 1);
+            const TraceSpan span("retry backoff"); //metrics: waiting for automatic retry
+            delayAndCountDown(errorInfo.failTime + autoRetryDelay_, [&](const std::wstring& timeRemMsg)
+            { this->updateStatus(_("Automatic retry") + L" | " + timeRemMsg); }, std::chrono::seconds(1) /*console: no GUI input*/); //throw AbortProcess
+            return ProcessCallback::retry;
+        }
+
+        logMsg(errorInfo.msg, MSG_TYPE_ERROR);
+
+        if (!ignoreErrors_ && batchErrorHandling_ == BatchErrorHandling::cancel)
+            abortProcessNow(AbortTrigger::program); //throw AbortProcess
+
+        return ProcessCallback::ignore;
+    }
+
+    void reportFatalError(const std::wstring& msg) override //throw AbortProcess
+    {
+        logMsg(msg, MSG_TYPE_ERROR);
+
+        if (!ignoreErrors_ && batchErrorHandling_ == BatchErrorHandling::cancel)
+            abortProcessNow(AbortTrigger::program); //throw AbortProcess
+    }
+
+    void forceUiUpdateNoThrow() override //noexcept
+    {
+        if (cancelRequested)
+            userRequestAbort(); //=> StatusHandler::requestUiUpdate() throws AbortProcess
+
+        if (showProgress_)
+        {
+            std::wstring statusLine = currentStatusText();
+
+            if (const ProgressStats statsTotal = getStatsTotal();
+                statsTotal.items >= 0)
+            {
+                const ProgressStats statsCurrent = getStatsCurrent();
+                statusLine = formatNumber(statsCurrent.items) + L'/' + formatNumber(statsTotal.items) + L"  " +
+                             formatFilesizeShort(statsCurrent.bytes) + L'/' + formatFilesizeShort(statsTotal.bytes) + L"  " + statusLine;
+            }
+            const size_t COLUMNS_MAX = 100; //don't wrap: '\r' only returns to start of current terminal line
+            if (statusLine.size() > COLUMNS_MAX)
+                statusLine.resize(COLUMNS_MAX);
+
+            std::cerr << '\r' << utfTo<std::string>(statusLine) << "\x1b[K" /*erase to end of line*/ << std::flush;
+            statusLinePending_ = true;
+        }
+    }
+
+    struct Result
+    {
+        SyncResult syncResult;
+        ErrorLog::Stats logStats;
+        AbstractPath logFilePath;
+        bool shutdownRequested;
+    };
+    //post sync commands and email notifications are evaluated per job (duplicates are run once)
+    Result reportResults(const std::vector<MainConfiguration>& jobCfgs,
+                         const Zstring& altLogFolderPathPhrase, int logfilesMaxAgeDays, LogFileFormat logFormat, bool logFileGzip, const std::set<AbstractPath>& logFilePathsToKeep,
+                         const Zstring& metricsFilePath /*optional*/,
+                         PostSyncAction postSyncAction) //noexcept!!
+    {
+        const auto totalTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTimeSteady_);
+
+        //determine post-sync status irrespective of further errors during tear-down
+        const SyncResult syncResult = [&]
+        {
+            if (getAbortStatus())
+            {
+                logMsg(_("Stopped"), MSG_TYPE_ERROR); //= user cancel
+                return SyncResult::aborted;
+            }
+            const ErrorLog::Stats logCount = errorLog_.getStats();
+            if (logCount.error > 0)
+                return SyncResult::finishedError;
+            else if (logCount.warning > 0)
+                return SyncResult::finishedWarning;
+
+            if (getStatsTotal() == ProgressStats())
+                logMsg(_("Nothing to synchronize"), MSG_TYPE_INFO);
+            return SyncResult::finishedSuccess;
+        }();
+
+        const ProcessSummary summary
+        {
+            startTime_, syncResult, jobNames_,
+            getStatsCurrent(),
+            getStatsTotal  (),
+            totalTime,
+            getPeakMemory()
+        };
+
+        const AbstractPath logFilePath = generateLogFilePath(logFormat, logFileGzip, summary, altLogFolderPathPhrase);
+
+        auto notifyStatusNoThrow = [&](std::wstring&& msg) { try { updateStatus(std::move(msg)); /*throw AbortProcess*/ } catch (AbortProcess&) {} };
+
+        bool suspend  = false;
+        bool shutdown = false;
+
+        if (getAbortStatus() && *getAbortStatus() == AbortTrigger::user)
+            ; /* user cancelled => don't run post sync command
+                                => don't send email notification
+                                => don't run post sync action     */
+        else
+        {
+            std::set<Zstring>     cmdLinesDone;
+            std::set<std::string> emailsDone;
+
+            for (const MainConfiguration& jobCfg : jobCfgs)
+            {
+                //--------------------- post sync command ----------------------
+                if (const Zstring cmdLine = trimCpy(jobCfg.postSyncCommand);
+                    !cmdLine.empty())
+                    if (jobCfg.postSyncCondition == PostSyncCondition::completion ||
+                        (jobCfg.postSyncCondition == PostSyncCondition::errors) == (syncResult == SyncResult::aborted ||
+                                                                                    syncResult == SyncResult::finishedError))
+                        if (cmdLinesDone.insert(cmdLine).second)
+                            runCommandAndLogErrors(expandMacros(cmdLine), errorLog_);
+
+                //--------------------- email notification ----------------------
+                if (const std::string notifyEmail = trimCpy(jobCfg.emailNotifyAddress);
+                    !notifyEmail.empty())
+                    if (jobCfg.emailNotifyCondition == ResultsNotification::always ||
+                        (jobCfg.emailNotifyCondition == ResultsNotification::errorWarning && (syncResult == SyncResult::aborted       ||
+                                                                                              syncResult == SyncResult::finishedError ||
+                                                                                              syncResult == SyncResult::finishedWarning)) ||
+                        (jobCfg.emailNotifyCondition == ResultsNotification::errorOnly && (syncResult == SyncResult::aborted ||
+                                                                                           syncResult == SyncResult::finishedError)))
+                        if (emailsDone.insert(notifyEmail).second)
+                            try
+                            {
+                                sendLogAsEmail(notifyEmail, summary, errorLog_, logFilePath, notifyStatusNoThrow); //throw FileError
+                                logMsg(replaceCpy(_("Sending email notification to %x..."), L"%x", utfTo<std::wstring>(notifyEmail)), MSG_TYPE_INFO);
+                            }
+                            catch (const FileError& e) { logMsg(e.toString(), MSG_TYPE_ERROR); }
+            }
+
+            //--------------------- post sync actions ----------------------
+            switch (postSyncAction)
+            {
+                case PostSyncAction::none:
+                    break;
+                case PostSyncAction::sleep:
+                    suspend = true;
+                    break;
+                case PostSyncAction::shutdown:
+                    shutdown = true; //system shutdown must be handled by calling context!
+                    break;
+            }
+        }
+
+        //--------------------- memory usage ----------------------
+        if (metricsEnabled())
+        {
+            setMemoryUsage("error log", errorLog_.getMemoryUsage());
+            if (const std::wstring memoryMsg = getMemoryUsageMsg(getPhaseTimes());
+                !memoryMsg.empty())
+                logMsg(memoryMsg, MSG_TYPE_INFO);
+        }
+
+        //--------------------- save metrics file ----------------------
+        if (!metricsFilePath.empty())
+            try
+            {
+                saveMetricsFile(metricsFilePath, summary, getPhaseTimes(), errorLog_.getStats()); //throw FileError
+            }
+            catch (const FileError& e) { logMsg(e.toString(), MSG_TYPE_ERROR); }
+
+        //--------------------- save log file ----------------------
+        try //create not before destruction: 1. avoid issues with FFS trying to sync open log file 2. include status in log file name without extra rename
+        {
+            //do NOT use tryReportingError()! saving log files should not be cancellable!
+            saveLogFile(logFilePath, summary, errorLog_, logfilesMaxAgeDays, logFormat, logFilePathsToKeep, notifyStatusNoThrow); //throw FileError
+        }
+        catch (const FileError& e) { logMsg(e.toString(), MSG_TYPE_ERROR); logFatalError(e.toString()); }
+        //----------------------------------------------------------
+
+        if (suspend)
+            try
+            {
+                suspendSystem(); //throw FileError
+            }
+            catch (const FileError& e) { logMsg(e.toString(), MSG_TYPE_ERROR); }
+
+        clearStatusLine();
+        printConsole(getSyncResultLabel(syncResult) + L" | " + AFS::getDisplayPath(logFilePath), MSG_TYPE_INFO);
+
+        return {syncResult, errorLog_.getStats(), logFilePath, shutdown};
+    }
+
+private:
+    void logMsg(const std::wstring& msg, MessageType type)
+    {
+        errorLog_.logMsg(msg, type);
+
+        clearStatusLine();
+        printConsole(msg, type);
+    }
+
+    void clearStatusLine()
+    {
+        if (statusLinePending_)
+        {
+            std::cerr << "\r\x1b[K" << std::flush;
+            statusLinePending_ = false;
+        }
+    }
+
+    const std::vector<std::wstring> jobNames_;
+    const std::chrono::system_clock::time_point startTime_;
+    const std::chrono::steady_clock::time_point startTimeSteady_ = std::chrono::steady_clock::now();
+    const bool ignoreErrors_;
+    const size_t autoRetryCount_;
+    const std::chrono::seconds autoRetryDelay_;
+    const BatchErrorHandling batchErrorHandling_;
+
+    const bool showProgress_ = ::isatty(STDERR_FILENO) == 1; //no progress output for cron/log redirection
+    bool statusLinePending_ = false;
+
+    ErrorLog errorLog_; //list of non-resolved errors and warnings
+};
+
+
+FfsExitCode runBatch(const Zstring& globalConfigFilePath, const std::vector<std::pair<Zstring /*cfg file path*/, XmlBatchConfig>>& jobs,
+                     const Zstring& changeJournalPath, const std::optional<ChangeJournal>& changeJournalWatch,
+                     const Zstring& exportFileListPath /*optional*/,
+                     bool indexHashesOnly, int indexHashesLimitKB /*< 0: use DeviceBandwidthLimit*/)
+{
+    assert(!jobs.empty());
+    std::vector<std::wstring> jobNames;
+    std::vector<MainConfiguration> jobCfgs;
+    BatchExclusiveConfig batchExCfg = jobs[0].second.batchExCfg;
+
+    for (const auto& [cfgFilePath, batchCfg] : jobs)
+    {
+        jobNames.push_back(extractJobName(cfgFilePath));
+        jobCfgs .push_back(batchCfg.mainCfg);
+
+        if (batchCfg.batchExCfg.batchErrorHandling == BatchErrorHandling::cancel) //a job cancelling on errors cancels the merged run
+            batchExCfg.batchErrorHandling = BatchErrorHandling::cancel;
+
+        batchExCfg.postSyncAction = std::max(batchExCfg.postSyncAction, batchCfg.batchExCfg.postSyncAction); //none < sleep < shutdown
+    }
+    const MainConfiguration mainCfg = merge(jobCfgs);
+
+    FfsExitCode exitCode = FFS_EXIT_SUCCESS;
+
+    auto notifyError = [&](const std::wstring& msg, FfsExitCode rc)
+    {
+        logFatalError(msg);
+        printConsole(msg, MSG_TYPE_ERROR);
+        raiseExitCode(exitCode, rc);
+    };
+
+    XmlGlobalSettings globalCfg;
+    try
+    {
+        std::wstring warningMsg;
+        std::tie(globalCfg, warningMsg) = readGlobalConfig(globalConfigFilePath); //throw FileError
+        assert(warningMsg.empty()); //ignore parsing errors: should be migration problems only *cross-fingers*
+    }
+    catch (const FileError& e)
+    {
+        try
+        {
+            bool cfgFileExists = true;
+            try { cfgFileExists  = !!itemStillExists(globalConfigFilePath); /*throw FileError*/ } //=> unclear which exception is more relevant/useless:
+            catch (const FileError& e2) { throw FileError(replaceCpy(e.toString(), L"\n\n", L'\n'), replaceCpy(e2.toString(), L"\n\n", L'\n')); }
+
+            if (cfgFileExists)
+                throw;
+        }
+        catch (const FileError& e3)
+        {
+            notifyError(e3.toString(), FFS_EXIT_ABORTED); //abort sync!
+            return exitCode;
+        }
+    }
+
+    try
+    {
+        setLanguage(globalCfg.programLanguage); //throw FileError
+    }
+    catch (const FileError& e)
+    {
+        notifyError(e.toString(), FFS_EXIT_WARNING);
+        //continue!
+    }
+
+    applyProcessSettings(globalCfg);
+
+    std::set<AbstractPath> logFilePathsToKeep;
+    for (const ConfigFileItem& item : globalCfg.mainDlg.config.fileHistory)
+        logFilePathsToKeep.insert(item.logFilePath);
+
+    const std::chrono::system_clock::time_point syncStartTime = std::chrono::system_clock::now();
+
+    ConsoleStatusHandler statusHandler(jobNames,
+                                       syncStartTime,
+                                       mainCfg.ignoreErrors,
+                                       mainCfg.autoRetryCount,
+                                       mainCfg.autoRetryDelay,
+                                       batchExCfg.batchErrorHandling);
+    try
+    {
+        //inform about (important) non-default global settings
+        logNonDefaultSettings(globalCfg, statusHandler); //throw AbortProcess
+
+        //batch mode: place directory locks on directories during both comparison AND synchronization
+        std::unique_ptr<LockHolder> dirLocks;
+
+        std::optional<ChangeJournal> changeJournal = changeJournalWatch;
+        if (!changeJournalPath.empty())
+            try
+            {
+                changeJournal = loadChangeJournal(changeJournalPath); //throw FileError
+            }
+            catch (const FileError& e) { statusHandler.logInfo(e.toString()); } //not critical: fall back to full comparison
+
+        std::vector<FolderPairCfg> fpCfgList = extractCompareCfg(mainCfg);
+
+        std::unique_ptr<ScheduleForBackgroundProcessing> idlePrio;
+        if (indexHashesOnly)
+        {
+            std::erase_if(fpCfgList, [](const FolderPairCfg& fpCfg)
+            {
+                return fpCfg.compareVar != CompareVariant::content || !detectMovedFilesEnabled(fpCfg.directionCfg);
+            });
+            if (fpCfgList.empty())
+                statusHandler.logInfo(_("No folder pair compares by content and uses a database file: there are no content hashes to calculate.")); //throw AbortProcess
+
+            try
+            {
+                idlePrio = std::make_unique<ScheduleForBackgroundProcessing>(true /*idleIo*/); //throw FileError
+            }
+            catch (const FileError& e) { statusHandler.logInfo(e.toString()); } //not critical: bandwidth limit still applies
+
+            const int limitKB = indexHashesLimitKB >= 0 ? indexHashesLimitKB : globalCfg.deviceBandwidthLimitKB;
+            setContentBandwidthLimit(limitKB > 0 ? static_cast<uint64_t>(limitKB) * 1024 : 0);
+        }
+
+        //COMPARE DIRECTORIES
+        FolderComparison cmpResult;
+        if (!fpCfgList.empty())
+            cmpResult = compare(globalCfg.warnDlgs,
+                                globalCfg.fileTimeTolerance,
+                                getContentPrefilterMinSize(globalCfg),
+                                true /*pruneSoftFiltered*/,
+                                false /*allowUserInteraction*/,
+                                globalCfg.runWithBackgroundPriority,
+                                globalCfg.createLockFile,
+                                dirLocks,
+                                fpCfgList,
+                                mainCfg.deviceParallelOps,
+                                globalCfg.autoTuneParallelOps,
+                                changeJournal,
+                                statusHandler); //throw AbortProcess
+
+        //e.g. nightly diff reports: comparison result *before* synchronization
+        if (!exportFileListPath.empty())
+            try
+            {
+                writeFileListCsv(exportFileListPath, cmpResult, statusHandler); //throw FileError, AbortProcess
+            }
+            catch (const FileError& e) { statusHandler.reportFatalError(e.toString()); } //throw AbortProcess
+
+        if (indexHashesOnly)
+        {
+            //persist the hashes calculated during comparison: items not in sync keep their last synchronous state, see db_file.cpp LastSynchronousStateUpdater
+            //keep the change checkpoints: nothing was synchronized
+            for (const std::shared_ptr<BaseFolderPair>& baseFolder : cmpResult)
+                if (baseFolder->getFolderStatus<SelectSide::left >() == BaseFolderStatus::existing &&
+                    baseFolder->getFolderStatus<SelectSide::right>() == BaseFolderStatus::existing)
+                    saveLastSynchronousState(*baseFolder, globalCfg.failSafeFileCopy, mainCfg.deviceParallelOps,
+                                             statusHandler, false /*commitCheckpoints*/); //throw AbortProcess
+        }
+        //START SYNCHRONIZATION
+        //no overlap with comparison of remaining folder pairs:
+        //  - both phases report through the same (main-thread) status handler
+        //  - FileSystemObject's ObjectMgr table is not thread-safe: comparison creates items while sync workers retrieve them
+        //  - checks (conflicts, significant difference, disk space, dependent base folders) are evaluated across *all* folder pairs
+        else if (!cmpResult.empty())
+            synchronize(syncStartTime,
+                        globalCfg.verifyFileCopy,
+                        globalCfg.copyLockedFiles,
+                        globalCfg.copyFilePermissions,
+                        globalCfg.failSafeFileCopy,
+                        mainCfg.cacheNeutralCopy,
+                        globalCfg.runWithBackgroundPriority,
+                        extractSyncCfg(mainCfg),
+                        cmpResult,
+                        mainCfg.deviceParallelOps,
+                        globalCfg.warnDlgs,
+                        statusHandler); //throw AbortProcess
+    }
+    catch (AbortProcess&) {} //exit used by statusHandler
+
+    const ConsoleStatusHandler::Result r = statusHandler.reportResults(jobCfgs,
+                                                                       mainCfg.altLogFolderPathPhrase, globalCfg.logfilesMaxAgeDays, globalCfg.logFormat, globalCfg.logFileGzip, logFilePathsToKeep,
+                                                                       globalCfg.metricsFilePath,
+                                                                       batchExCfg.postSyncAction); //noexcept
+    //----------------------------------------------------------------------
+    switch (r.syncResult)
+    {
+        //*INDENT-OFF*
+        case SyncResult::finishedSuccess: raiseExitCode(exitCode, FFS_EXIT_SUCCESS); break;
+        case SyncResult::finishedWarning: raiseExitCode(exitCode, FFS_EXIT_WARNING); break;
+        case SyncResult::finishedError:   raiseExitCode(exitCode, FFS_EXIT_ERROR  ); break;
+        case SyncResult::aborted:         raiseExitCode(exitCode, FFS_EXIT_ABORTED); break;
+        //*INDENT-ON*
+    }
+
+    //email sending, or saving log file failed? at the very least this should affect the exit code:
+    if (r.logStats.error > 0)
+        raiseExitCode(exitCode, FFS_EXIT_ERROR);
+    else if (r.logStats.warning > 0)
+        raiseExitCode(exitCode, FFS_EXIT_WARNING);
+
+    //update last sync stats for the selected cfg files
+    for (ConfigFileItem& cfi : globalCfg.mainDlg.config.fileHistory)
+        if (std::any_of(jobs.begin(), jobs.end(), [&](const auto& job) { return equalNativePath(cfi.cfgFilePath, job.first); }))
+        {
+            if (r.syncResult != SyncResult::aborted)
+                cfi.lastSyncTime = std::chrono::system_clock::to_time_t(syncStartTime);
+            assert(!AFS::isNullPath(r.logFilePath));
+            if (!AFS::isNullPath(r.logFilePath))
+            {
+                cfi.logFilePath = r.logFilePath;
+                cfi.logResult   = r.syncResult;
+            }
+        }
+
+    //---------------------------------------------------------------------------
+    try //save global settings to XML: e.g. ignored warnings, last sync stats
+    {
+        writeConfig(globalCfg, globalConfigFilePath); //FileError
+    }
+    catch (const FileError& e)
+    {
+        notifyError(e.toString(), FFS_EXIT_WARNING);
+    }
+
+    if (r.shutdownRequested) //run *after* last sync stats were updated and saved!
+        try
+        {
+            shutdownSystem(); //throw FileError
+            terminateProcess(exitCode); //no point in continuing while the OS will kill us anytime!
+        }
+        catch (const FileError& e) { notifyError(e.toString(), FFS_EXIT_ERROR); }
+
+    return exitCode;
+}
+
+
+//monitor the native base folders of all jobs like RealTimeSync, but synchronize in-process: no process start, config and session setup per change
+FfsExitCode runBatchWatch(const Zstring& globalConfigFilePath, const std::vector<std::pair<Zstring /*cfg file path*/, XmlBatchConfig>>& jobs, std::chrono::seconds delay)
+{
+    std::vector<Zstring> folderPathPhrases;
+    for (const auto& [cfgFilePath, batchCfg] : jobs)
+    {
+        std::vector<LocalPairConfig> localPairs{batchCfg.mainCfg.firstPair};
+        append(localPairs, batchCfg.mainCfg.additionalPairs);
+
+        for (const LocalPairConfig& lpc : localPairs)
+            for (const Zstring& phrase : {lpc.folderPathPhraseLeft, lpc.folderPathPhraseRight})
+                if (!trimCpy(phrase).empty() &&
+                    !getNativeItemPath(createAbstractPath(phrase)).empty() && //(S)FTP/Google Drive: no directory monitoring
+                    std::find(folderPathPhrases.begin(), folderPathPhrases.end(), phrase) == folderPathPhrases.end())
+                    folderPathPhrases.push_back(phrase);
+    }
+
+    if (folderPathPhrases.empty())
+    {
+        const std::wstring msg = _("A folder input field is empty.");
+        logFatalError(msg);
+        printConsole(msg, MSG_TYPE_ERROR);
+        return FFS_EXIT_ABORTED;
+    }
+
+    struct WatchCancelled {};
+    auto checkCancel = [] { if (cancelRequested) throw WatchCancelled(); };
+
+    FfsExitCode exitCode = FFS_EXIT_SUCCESS;
+    try
+    {
+        rts::monitorDirectories(folderPathPhrases, delay, Zstring() /*journalFilePath*/,
+                                [&](const Zstring& /*changedItemPath*/, const std::wstring& /*actionName*/, const ChangeJournal& journal) //throw FileError
+        {
+            checkCancel(); //throw WatchCancelled
+
+            exitCode = runBatch(globalConfigFilePath, jobs, Zstring() /*changeJournalPath*/, journal, Zstring() /*exportFileListPath*/, false /*indexHashesOnly*/, -1 /*indexHashesLimitKB*/);
+
+            checkCancel(); //throw WatchCancelled
+            if (exitCode != FFS_EXIT_SUCCESS) //keep journal: changes may not have been synced yet
+                throw FileError(replaceCpy(_("Exit code %x"), L"%x", numberTo<std::wstring>(exitCode)));
+        },
+        [&](const Zstring* /*missingFolderPath*/) { checkCancel(); /*throw WatchCancelled*/ },
+        [&](const std::wstring& msg)
+        {
+            printConsole(msg, MSG_TYPE_ERROR);
+
+            //wait some time, then return to retry
+            const auto delayUntil = std::chrono::steady_clock::now() + WATCH_RETRY_AFTER_ERROR_INTERVAL;
+            while (std::chrono::steady_clock::now() < delayUntil)
+            {
+                checkCancel(); //throw WatchCancelled
+                std::this_thread::sleep_for(WATCH_UPDATE_INTERVAL);
+            }
+        },
+        WATCH_UPDATE_INTERVAL);
+        assert(false);
+    }
+    catch (WatchCancelled&) {}
+
+    return exitCode;
+}
+
+
+void showSyntaxHelp()
+{
+    std::cout << utfTo<std::string>(_("Syntax:") + L"\n\n" +
+                                    L"FreeFileSync_Batch" + L'\n' +
+                                    L"    " + _("config files:") + L" *.ffs_batch" + L'\n' +
+                                    L"    [-ChangeJournal " + _("file") + L"]" + L'\n' +
+                                    L"    [-ExportFileList " + _("file") + L"]" + L'\n' +
+                                    L"    [-IndexHashes [KB/s]]" + L'\n' +
+                                    L"    [-Watch " + _("seconds") + L"]" + L'\n' +
+                                    L"    [-Trace " + _("file") + L"]" + L'\n' +
+                                    L"    [" + _("global config file:") + L" GlobalSettings.xml]" + L"\n\n" +
+
+                                    _("config files:") + L'\n' +
+                                    _("Any number of FreeFileSync \"ffs_batch\" configuration files.") + L' ' +
+                                    _("Multiple jobs are merged into a single synchronization.") + L"\n\n" +
+
+                                    L"-ChangeJournal " + _("file") + L'\n' +
+                                    _("Compare only items changed since the last synchronization as reported by RealTimeSync (%change_journal%).") + L"\n\n" +
+
+                                    L"-ExportFileList " + _("file") + L'\n' +
+                                    _("Save the comparison result as a CSV file before synchronization.") + L"\n\n" +
+
+                                    L"-IndexHashes [KB/s]" + L'\n' +
+                                    _("Compare only, with idle file I/O priority and limited bandwidth, and save the content hashes to the database files. Later synchronizations comparing by content skip these files if they are unchanged.") + L"\n\n" +
+
+                                    L"-Watch " + _("seconds") + L'\n' +
+                                    _("Keep running: monitor the local folders and synchronize after the given delay once changes are detected (like RealTimeSync).") + L"\n\n" +
+
+                                    L"-Trace " + _("file") + L'\n' +
+                                    _("Record where the time is spent and save it as a trace file (Chrome trace format).") + L"\n\n" +
+
+                                    _("global config file:") + L'\n' +
+                                    _("Path to an alternate GlobalSettings.xml file.")) << '\n';
+}
+}
+
+
+int main(int argc, char* argv[])
+{
+    //console initialization only: no GTK, no X display required
+    wxInitializer wxInit(argc, argv);
+    if (!wxInit.IsOk())
+    {
+        std::cerr << "FreeFileSync: Failed to initialize wxWidgets.\n";
+        return FFS_EXIT_ABORTED;
+    }
+
+    if (std::signal(SIGINT,  onCancelSignal) == SIG_ERR ||
+        std::signal(SIGTERM, onCancelSignal) == SIG_ERR)
+        assert(false);
+
+    try { localizationInit(getResourceDirPf() + Zstr("Languages.zip")); } //throw FileError
+    catch (const FileError& e) { printConsole(e.toString(), MSG_TYPE_WARNING); }
+    ZEN_ON_SCOPE_EXIT(localizationCleanup());
+
+    auto notifyFatalError = [&](const std::wstring& msg, const std::wstring& title)
+    {
+        logFatalError(msg);
+        printConsole(title + SPACED_DASH + msg, MSG_TYPE_ERROR);
+        return FFS_EXIT_ABORTED;
+    };
+
+    ZEN_ON_SCOPE_EXIT(writeTraceFile()); //noexcept
+
+    //parse command line arguments
+    std::vector<Zstring> batchFilePaths;
+    Zstring globalConfigFile;
+    Zstring changeJournalPath;
+    Zstring exportFileListPath;
+    bool indexHashesOnly = false;
+    int indexHashesLimitKB = -1;
+    std::optional<std::chrono::seconds> watchDelay;
+    {
+        const char* optionChangeJournal = "-changejournal";
+        const char* optionExportFileList = "-exportfilelist";
+        const char* optionIndexHashes = "-indexhashes";
+        const char* optionTrace = "-trace";
+        const char* optionWatch = "-watch";
+
+        auto isHelpRequest = [](const Zstring& arg)
+        {
+            auto it = std::find_if(arg.begin(), arg.end(), [](Zchar c) { return c != Zstr('/') && c != Zstr('-'); });
+            if (it == arg.begin()) return false; //require at least one prefix character
+
+            const Zstring argTmp(it, arg.end());
+            return equalAsciiNoCase(argTmp, "help") ||
+                   equalAsciiNoCase(argTmp, "h")    ||
+                   argTmp == Zstr("?");
+        };
+
+        for (int i = 1; i < argc; ++i)
+            if (const Zstring arg = argv[i];
+                isHelpRequest(arg))
+            {
+                showSyntaxHelp();
+                return FFS_EXIT_SUCCESS;
+            }
+            else if (equalAsciiNoCase(arg, optionChangeJournal))
+            {
+                if (++i == argc)
+                    return notifyFatalError(replaceCpy(_("A file path is expected after %x."), L"%x", utfTo<std::wstring>(optionChangeJournal)), _("Syntax error"));
+                changeJournalPath = argv[i]; //may be empty if RealTimeSync failed to write the journal => full comparison
+            }
+            else if (equalAsciiNoCase(arg, optionExportFileList))
+            {
+                if (++i == argc)
+                    return notifyFatalError(replaceCpy(_("A file path is expected after %x."), L"%x", utfTo<std::wstring>(optionExportFileList)), _("Syntax error"));
+                exportFileListPath = getResolvedFilePath(argv[i]);
+            }
+            else if (equalAsciiNoCase(arg, optionIndexHashes))
+            {
+                indexHashesOnly = true;
+                if (i + 1 < argc && isDigit(argv[i + 1][0])) //optional
+                    indexHashesLimitKB = stringTo<int>(argv[++i]);
+            }
+            else if (equalAsciiNoCase(arg, optionWatch))
+            {
+                if (++i == argc || !isDigit(argv[i][0]))
+                    return notifyFatalError(replaceCpy(_("A number is expected after %x."), L"%x", utfTo<std::wstring>(optionWatch)), _("Syntax error"));
+                watchDelay = std::chrono::seconds(stringTo<int>(argv[i]));
+            }
+            else if (equalAsciiNoCase(arg, optionTrace))
+            {
+                if (++i == argc)
+                    return notifyFatalError(replaceCpy(_("A file path is expected after %x."), L"%x", utfTo<std::wstring>(optionTrace)), _("Syntax error"));
+                enableTraceFile(getResolvedFilePath(argv[i])); //takes precedence over GlobalSettings.xml
+            }
+            else
+            {
+                Zstring filePath = getResolvedFilePath(arg);
+
+                if (!fileAvailable(filePath)) //...be a little tolerant
+                {
+                    if (fileAvailable(filePath + Zstr(".ffs_batch")))
+                        filePath += Zstr(".ffs_batch");
+                    else if (fileAvailable(filePath + Zstr(".xml")))
+                        filePath += Zstr(".xml");
+                    else
+                        return notifyFatalError(replaceCpy(_("Cannot find file %x."), L"%x", fmtPath(filePath)), _("Error"));
+                }
+
+                try
+                {
+                    switch (getXmlType(filePath)) //throw FileError
+                    {
+                        case XmlType::batch:
+                            batchFilePaths.push_back(filePath);
+                            break;
+                        case XmlType::global:
+                            globalConfigFile = filePath;
+                            break;
+                        case XmlType::gui:
+                        case XmlType::other:
+                            return notifyFatalError(replaceCpy(_("File %x does not contain a valid configuration."), L"%x", fmtPath(filePath)), _("Error"));
+                    }
+                }
+                catch (const FileError& e) { return notifyFatalError(e.toString(), _("Error")); }
+            }
+    }
+
+    if (batchFilePaths.empty())
+    {
+        showSyntaxHelp();
+        return FFS_EXIT_ABORTED;
+    }
+
+    std::vector<std::pair<Zstring /*cfg file path*/, XmlBatchConfig>> jobs;
+    for (const Zstring& batchFilePath : batchFilePaths)
+        try
+        {
+            auto [batchCfg, warningMsg] = readBatchConfig(batchFilePath); //throw FileError
+
+            if (!warningMsg.empty())
+                throw FileError(warningMsg); //batch mode: break on errors AND even warnings!
+
+            jobs.emplace_back(batchFilePath, std::move(batchCfg));
+        }
+        catch (const FileError& e) { return notifyFatalError(e.toString(), _("Error")); }
+
+    initAfs({getResourceDirPf(), getConfigDirPathPf()});
+    ZEN_ON_SCOPE_EXIT
+    (
+        if (const std::wstring& warningMsg = teardownAfs();
+            !warningMsg.empty())
+        printConsole(warningMsg, MSG_TYPE_WARNING);
+    );
+
+    const Zstring& globalConfigFilePath = !globalConfigFile.empty() ? globalConfigFile : getGlobalConfigFile();
+
+    if (watchDelay)
+    {
+        if (indexHashesOnly)
+            return notifyFatalError(replaceCpy(replaceCpy(_("%x cannot be combined with %y."), L"%x", L"-IndexHashes"), L"%y", L"-Watch"), _("Syntax error"));
+
+        return runBatchWatch(globalConfigFilePath, jobs, *watchDelay);
+    }
+
+    return runBatch(globalConfigFilePath, jobs, changeJournalPath, std::nullopt /*changeJournalWatch*/, exportFileListPath, indexHashesOnly, indexHashesLimitKB);
+}
@@ -0,0 +1,539 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <zen/base64.h>
+#include <zen/crc.h>
+#include <zen/file_access.h>
+#include <zen/file_io.h>
+#include <zen/json.h>
+#include <zen/resolve_path.h>
+#include <wx/init.h>
+#include "../afs/concrete.h"
+#include "../base/algorithm.h"
+#include "../base/comparison.h"
+#include "../base/db_file.h"
+#include "../base/parallel_scan.h"
+#include "../base/synchronization.h"
+#include "../ui/file_view.h"
+#include "../version/version.h"
+#include "../base_tools.h"
+#include "../config.h"
+#include "../return_codes.h"
+#include "../status_handler.h"
+
+    #include <unistd.h> //getpid
+
+using namespace zen;
+using namespace fff;
+
+
+/*  reproducible benchmarks for the core algorithms against native temp folders:
+    - synthetic folder tree generated from a fixed seed: same parameters => same tree (names, sizes, contents, modification times)
+    - left side: generated once; right side: regenerated before each run with deterministic differences (changed, left-/right-only items)
+    - results are written as JSON (minimum/median/maximum over all runs) => compare releases
+    - file system caches are warm after the first run: use the minimum to compare CPU cost, the first run's numbers are noisy */
+namespace
+{
+struct TreeParams
+{
+    size_t depth       = 3;  //folder levels below the base folder
+    size_t fanOut      = 4;  //sub folders per folder
+    size_t filesPerFolder = 50;
+    uint64_t fileSizeMax  = 64 * 1024; //log-uniform distribution: mostly small files, a few large ones
+    size_t nameLengthMax  = 24;
+    int unicodePercent    = 20; //share of non-ASCII characters in item names (incl. decomposed and 4-byte UTF-8)
+    uint64_t seed         = 0;
+};
+
+
+struct FileSpec
+{
+    Zstring relPath;
+    uint64_t fileSize = 0;
+    time_t modTime = 0;
+    uint64_t contentSeed = 0;
+};
+
+struct TreeSpec
+{
+    std::vector<Zstring> folders; //relative paths; parent before child
+    std::vector<FileSpec> files;
+};
+
+enum class RightDiff
+{
+    same,
+    changed,     //different size and newer => detected by all compare variants
+    contentOnly, //same size and time, different content => detected by CompareVariant::content only
+    leftOnly,
+};
+const size_t RIGHT_ONLY_PERCENT = 5;
+
+const time_t TREE_TIME_BASE = 1'600'000'000; //fixed: reproducible modification times
+
+
+Zstring generateItemName(std::mt19937_64& rng, const TreeParams& params)
+{
+    static const char* const asciiChars = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 -_.";
+    static const char* const unicodeChars[] = {"\xc3\xa4" /*a umlaut*/, "\xc3\x9f" /*sharp s*/, "A\xcc\x8a" /*A + combining ring*/,
+                                               "\xd0\x96" /*Cyrillic*/, "\xe4\xb8\xad" /*CJK*/, "\xe6\x96\x87" /*CJK*/, "\xf0\x9f\x98\x80" /*emoji*/
+                                              };
+    const size_t nameLength = std::uniform_int_distribution<size_t>(1, std::max<size_t>(params.nameLengthMax, 1))(rng);
+
+    Zstring name;
+    for (size_t i = 0; i < nameLength; ++i)
+        if (static_cast<int>(rng() % 100) < params.unicodePercent)
+            name += unicodeChars[rng() % std::size(unicodeChars)];
+        else
+            name += asciiChars[rng() % std::strlen(asciiChars)];
+
+    trim(name, true /*fromLeft*/, false /*fromRight*/); //caller appends a unique suffix
+    return name;
+}
+
+
+TreeSpec generateTreeSpec(const TreeParams& params)
+{
+    std::mt19937_64 rng(params.seed);
+
+    static const Zchar* const extensions[] = {Zstr(".txt"), Zstr(".jpg"), Zstr(".docx"), Zstr(".bin"), Zstr("")};
+    const double logSizeMax = std::log(static_cast<double>(params.fileSizeMax) + 1);
+
+    TreeSpec spec;
+    std::function<void(const Zstring& relPath, size_t level)> addFolder;
+    addFolder = [&](const Zstring& relPath, size_t level)
+    {
+        size_t itemNo = 0; //make names unique within folder
+        for (size_t i = 0; i < params.filesPerFolder; ++i)
+        {
+            FileSpec fs;
+            fs.relPath = nativeAppendPaths(relPath, generateItemName(rng, params) + Zstr('_') + numberTo<Zstring>(itemNo++) + extensions[rng() % std::size(extensions)]);
+            fs.fileSize = static_cast<uint64_t>(std::exp(std::uniform_real_distribution<double>(0, logSizeMax)(rng))) - 1;
+            fs.modTime = TREE_TIME_BASE + static_cast<time_t>(rng() % (365 * 24 * 3600));
+            fs.contentSeed = rng();
+            spec.files.push_back(fs);
+        }
+
+        if (level < params.depth)
+            for (size_t i = 0; i < params.fanOut; ++i)
+            {
+                const Zstring folderRelPath = nativeAppendPaths(relPath, generateItemName(rng, params) + Zstr('_') + numberTo<Zstring>(itemNo++));
+                spec.folders.push_back(folderRelPath);
+                addFolder(folderRelPath, level + 1);
+            }
+    };
+    addFolder(Zstring(), 0);
+    return spec;
+}
+
+
+std::string generateFileContent(uint64_t fileSize, uint64_t contentSeed)
+{
+    std::mt19937_64 rng(contentSeed);
+    std::string content(fileSize, '\0');
+    for (size_t i = 0; i < content.size(); i += sizeof(uint64_t))
+    {
+        const uint64_t val = rng();
+        std::memcpy(&content[i], &val, std::min(sizeof(val), content.size() - i));
+    }
+    return content;
+}
+
+
+void writeFile(const Zstring& filePath, uint64_t fileSize, time_t modTime, uint64_t contentSeed) //throw FileError
+{
+    setFileContent(filePath, generateFileContent(fileSize, contentSeed), nullptr /*notifyUnbufferedIO*/); //throw FileError
+    setFileTime(filePath, modTime, ProcSymlink::follow); //throw FileError
+}
+
+
+void writeTree(const Zstring& baseFolderPath, const TreeSpec& spec, bool rightSide, uint64_t seed) //throw FileError
+{
+    createDirectoryIfMissingRecursion(baseFolderPath); //throw FileError
+    for (const Zstring& relPath : spec.folders)
+        createDirectory(nativeAppendPaths(baseFolderPath, relPath)); //throw FileError, (ErrorTargetExisting)
+
+    std::mt19937_64 rng(seed ^ 0x9e3779b97f4a7c15); //independent from tree layout: same differences for each run
+    for (const FileSpec& fs : spec.files)
+    {
+        const Zstring filePath = nativeAppendPaths(baseFolderPath, fs.relPath);
+        if (!rightSide)
+            writeFile(filePath, fs.fileSize, fs.modTime, fs.contentSeed); //throw FileError
+        else
+        {
+            const unsigned int val = rng() % 100;
+            const RightDiff diff = val < 10 ? RightDiff::changed : val < 15 ? RightDiff::contentOnly : val < 20 ? RightDiff::leftOnly : RightDiff::same;
+            switch (diff)
+            {
+                case RightDiff::same:
+                    writeFile(filePath, fs.fileSize, fs.modTime, fs.contentSeed); //throw FileError
+                    break;
+                case RightDiff::changed:
+                    writeFile(filePath, fs.fileSize + 1 + rng() % 1024, fs.modTime + 3600, rng()); //throw FileError
+                    break;
+                case RightDiff::contentOnly:
+                    writeFile(filePath, fs.fileSize, fs.modTime, fs.fileSize > 0 ? rng() : fs.contentSeed); //throw FileError
+                    break;
+                case RightDiff::leftOnly:
+                    break;
+            }
+            if (rng() % 100 < RIGHT_ONLY_PERCENT)
+                writeFile(filePath + Zstr(".right"), fs.fileSize, fs.modTime, rng()); //throw FileError
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------
+
+class BenchStatusHandler : public StatusHandler //no UI: just count errors; they invalidate the results
+{
+public:
+    void logInfo(const std::wstring& msg) override {}
+
+    void reportWarning(const std::wstring& msg, bool& warningActive) override {}
+
+    Response reportError(const ErrorInfo& errorInfo) override
+    {
+        reportMsg(errorInfo.msg);
+        return ProcessCallback::ignore;
+    }
+
+    void reportFatalError(const std::wstring& msg) override { reportMsg(msg); }
+
+    void forceUiUpdateNoThrow() override {}
+
+    size_t getErrorCount() const { return errorCount_; }
+
+private:
+    void reportMsg(const std::wstring& msg)
+    {
+        ++errorCount_;
+        std::cerr << utfTo<std::string>(msg) << '\n';
+    }
+
+    size_t errorCount_ = 0;
+};
+
+
+struct BenchResult
+{
+    std::string name;
+    std::vector<std::chrono::nanoseconds> runTimes;
+};
+
+
+class BenchRecorder
+{
+public:
+    template <class Function>
+    auto measure(const std::string& name, Function fun) //return result: don't measure its destruction
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        if constexpr (std::is_void_v<decltype(fun())>)
+        {
+            fun();
+            addRunTime(name, std::chrono::steady_clock::now() - startTime);
+        }
+        else
+        {
+            auto result = fun();
+            addRunTime(name, std::chrono::steady_clock::now() - startTime);
+            return result;
+        }
+    }
+
+    const std::vector<BenchResult>& getResults() const { return results_; }
+
+private:
+    void addRunTime(const std::string& name, std::chrono::nanoseconds runTime)
+    {
+        auto it = std::find_if(results_.begin(), results_.end(), [&](const BenchResult& r) { return r.name == name; });
+        if (it == results_.end())
+            it = results_.insert(results_.end(), BenchResult{name, {}});
+        it->runTimes.push_back(runTime);
+    }
+
+    std::vector<BenchResult> results_; //in order of first execution
+};
+
+
+std::string generateResultJson(const TreeParams& params, const TreeSpec& spec, size_t runs, const std::vector<BenchResult>& results, size_t errorCount)
+{
+    auto toSeconds = [](std::chrono::nanoseconds d) { return std::chrono::duration<double>(d).count(); };
+
+    uint64_t bytesTotal = 0;
+    for (const FileSpec& fs : spec.files)
+        bytesTotal += fs.fileSize;
+
+    JsonValue tree(JsonValue::Type::object);
+    tree.objectVal.emplace("seed", static_cast<int64_t>(params.seed));
+    tree.objectVal.emplace("depth", static_cast<int64_t>(params.depth));
+    tree.objectVal.emplace("fan_out", static_cast<int64_t>(params.fanOut));
+    tree.objectVal.emplace("files_per_folder", static_cast<int64_t>(params.filesPerFolder));
+    tree.objectVal.emplace("file_size_max", static_cast<int64_t>(params.fileSizeMax));
+    tree.objectVal.emplace("name_length_max", static_cast<int64_t>(params.nameLengthMax));
+    tree.objectVal.emplace("unicode_percent", static_cast<int64_t>(params.unicodePercent));
+    tree.objectVal.emplace("folders", static_cast<int64_t>(spec.folders.size()));
+    tree.objectVal.emplace("files", static_cast<int64_t>(spec.files.size()));
+    tree.objectVal.emplace("bytes", static_cast<int64_t>(bytesTotal));
+
+    JsonValue benchmarks(JsonValue::Type::array);
+    for (const BenchResult& br : results)
+    {
+        std::vector<std::chrono::nanoseconds> times = br.runTimes;
+        std::sort(times.begin(), times.end());
+
+        JsonValue bench(JsonValue::Type::object);
+        bench.objectVal.emplace("name", br.name);
+        bench.objectVal.emplace("runs", static_cast<int64_t>(times.size()));
+        bench.objectVal.emplace("seconds_min",    toSeconds(times.front()));
+        bench.objectVal.emplace("seconds_median", toSeconds(times[times.size() / 2]));
+        bench.objectVal.emplace("seconds_max",    toSeconds(times.back()));
+        benchmarks.arrayVal.push_back(std::move(bench));
+    }
+
+    JsonValue root(JsonValue::Type::object);
+    root.objectVal.emplace("version", ffsVersion);
+    root.objectVal.emplace("hardware_threads", static_cast<int64_t>(std::thread::hardware_concurrency()));
+    root.objectVal.emplace("runs", static_cast<int64_t>(runs));
+    root.objectVal.emplace("errors", static_cast<int64_t>(errorCount));
+    root.objectVal.emplace("tree", std::move(tree));
+    root.objectVal.emplace("benchmarks", std::move(benchmarks));
+    return serializeJson(root) + '\n';
+}
+
+
+void runBenchmarks(const Zstring& tempFolderPath, const TreeParams& params, size_t runs, BenchRecorder& recorder, BenchStatusHandler& statusHandler) //throw FileError
+{
+    const XmlGlobalSettings globalCfg; //defaults: benchmark does not depend on the user's GlobalSettings.xml
+    WarningDialogs warnings;
+    warnings.warnSignificantDifference = false;
+    warnings.warnRecyclerMissing = false;
+
+    const Zstring leftPath  = nativeAppendPaths(tempFolderPath, Zstr("left"));
+    const Zstring rightPath = nativeAppendPaths(tempFolderPath, Zstr("right"));
+
+    const TreeSpec spec = generateTreeSpec(params);
+    writeTree(leftPath, spec, false /*rightSide*/, params.seed); //throw FileError
+
+    auto getMainConfig = [&](CompareVariant cmpVar, SyncVariant syncVar)
+    {
+        MainConfiguration mainCfg;
+        mainCfg.firstPair.folderPathPhraseLeft  = leftPath;
+        mainCfg.firstPair.folderPathPhraseRight = rightPath;
+        mainCfg.cmpCfg.compareVar = cmpVar;
+        mainCfg.syncCfg.directionCfg.var = syncVar;
+        mainCfg.syncCfg.handleDeletion = DeletionPolicy::permanent;
+        return mainCfg;
+    };
+
+    auto runCompare = [&](const MainConfiguration& mainCfg)
+    {
+        std::unique_ptr<LockHolder> dirLocks;
+        return compare(warnings,
+                       globalCfg.fileTimeTolerance,
+                       getContentPrefilterMinSize(globalCfg),
+                       false /*allowUserInteraction*/,
+                       false /*runWithBackgroundPriority*/,
+                       false /*createDirLocks*/,
+                       dirLocks,
+                       extractCompareCfg(mainCfg),
+                       mainCfg.deviceParallelOps,
+                       false /*autoTuneParallelOps*/,
+                       std::nullopt /*changeJournal*/,
+                       statusHandler); //throw AbortProcess
+    };
+
+    std::string crcBuf(64 * 1024 * 1024, '\0'); //checksum throughput: db files, dir locks, versioning logs
+    {
+        std::mt19937_64 rng(params.seed);
+        std::generate(crcBuf.begin(), crcBuf.end(), [&] { return static_cast<char>(rng()); });
+    }
+    const std::string base64Buf = stringEncodeBase64(crcBuf);
+
+    for (size_t runNo = 0; runNo < runs; ++runNo)
+    {
+        recorder.measure("crc32 (64 MiB)", [&] { return getCrc32(crcBuf); });
+        recorder.measure("crc16 (64 MiB)", [&] { return getCrc16(crcBuf); });
+        recorder.measure("base64 encode (64 MiB)", [&] { return stringEncodeBase64(crcBuf); });
+        recorder.measure("base64 decode (64 MiB)", [&] { return stringDecodeBase64(base64Buf); });
+
+        if (itemStillExists(rightPath)) //throw FileError
+            removeDirectoryPlainRecursion(rightPath); //throw FileError
+        writeTree(rightPath, spec, true /*rightSide*/, params.seed); //throw FileError
+
+        recorder.measure("traverse", [&]
+        {
+            std::set<DirectoryKey> foldersToRead;
+            for (const Zstring& folderPath : {leftPath, rightPath})
+                foldersToRead.insert(DirectoryKey({createAbstractPath(folderPath), makeSharedRef<NullFilter>(), SymLinkHandling::exclude}));
+
+            return parallelDeviceTraversal(foldersToRead, {} /*deviceParallelOps*/,
+            [&](const PhaseCallback::ErrorInfo& errorInfo) { return statusHandler.reportError(errorInfo); },
+            [](const std::wstring& statusLine, int itemsTotal) {}, UI_UPDATE_INTERVAL);
+        });
+
+        recorder.measure("compare time and size", [&] { return runCompare(getMainConfig(CompareVariant::timeSize, SyncVariant::mirror)); });
+        recorder.measure("compare size",          [&] { return runCompare(getMainConfig(CompareVariant::size,     SyncVariant::mirror)); });
+        recorder.measure("compare content",       [&] { return runCompare(getMainConfig(CompareVariant::content,  SyncVariant::mirror)); });
+
+        const MainConfiguration mainCfgTwoWay = getMainConfig(CompareVariant::timeSize, SyncVariant::twoWay);
+        FolderComparison folderCmp = runCompare(mainCfgTwoWay);
+
+        auto getDirectionCfgs = [&]
+        {
+            std::vector<std::pair<BaseFolderPair*, SyncDirectionConfig>> directCfgs;
+            for (const std::shared_ptr<BaseFolderPair>& baseFolder : folderCmp)
+                directCfgs.emplace_back(baseFolder.get(), mainCfgTwoWay.syncCfg.directionCfg);
+            return directCfgs;
+        };
+        recorder.measure("redetermine sync direction (no db)", [&] { redetermineSyncDirection(getDirectionCfgs(), mainCfgTwoWay.deviceParallelOps, statusHandler); });
+
+        {
+            FileView fileView(folderCmp);
+            recorder.measure("sort view by path",      [&] { fileView.sortView(ColumnTypeRim::path,      ItemPathFormat::full, true /*onLeft*/, true /*ascending*/); });
+            recorder.measure("sort view by name",      [&] { fileView.sortView(ColumnTypeRim::path,      ItemPathFormat::name, true /*onLeft*/, true /*ascending*/); });
+            recorder.measure("sort view by size",      [&] { fileView.sortView(ColumnTypeRim::size,      ItemPathFormat::full, true /*onLeft*/, true /*ascending*/); });
+            recorder.measure("sort view by date",      [&] { fileView.sortView(ColumnTypeRim::date,      ItemPathFormat::full, true /*onLeft*/, true /*ascending*/); });
+            recorder.measure("sort view by extension", [&] { fileView.sortView(ColumnTypeRim::extension, ItemPathFormat::full, true /*onLeft*/, true /*ascending*/); });
+        }
+
+        for (const Zchar* dbFileName : {Zstr(".sync.ffs_db"), Zstr(".sync.journal.ffs_db")}) //left over from previous run: always save from scratch
+            if (const Zstring dbFilePath = nativeAppendPaths(leftPath, dbFileName);
+                itemStillExists(dbFilePath)) //throw FileError
+                removeFilePlain(dbFilePath); //throw FileError
+
+        for (const std::shared_ptr<BaseFolderPair>& baseFolder : folderCmp)
+            recorder.measure("save db", [&] { saveLastSynchronousState(*baseFolder, globalCfg.failSafeFileCopy, mainCfgTwoWay.deviceParallelOps, statusHandler); });
+
+        recorder.measure("load db", [&]
+        {
+            std::vector<const BaseFolderPair*> baseFolders;
+            for (const std::shared_ptr<BaseFolderPair>& baseFolder : folderCmp)
+                baseFolders.push_back(baseFolder.get());
+            return loadLastSynchronousState(baseFolders, mainCfgTwoWay.deviceParallelOps, statusHandler);
+        });
+        recorder.measure("redetermine sync direction (with db)", [&] { redetermineSyncDirection(getDirectionCfgs(), mainCfgTwoWay.deviceParallelOps, statusHandler); });
+
+        //mirror left => right
+        const MainConfiguration mainCfgMirror = getMainConfig(CompareVariant::timeSize, SyncVariant::mirror);
+        FolderComparison folderCmpMirror = runCompare(mainCfgMirror);
+
+        recorder.measure("synchronize (mirror)", [&]
+        {
+            synchronize(std::chrono::system_clock::now(),
+                        globalCfg.verifyFileCopy,
+                        globalCfg.copyLockedFiles,
+                        globalCfg.copyFilePermissions,
+                        globalCfg.failSafeFileCopy,
+                        false /*cacheNeutralCopy*/,
+                        false /*runWithBackgroundPriority*/,
+                        extractSyncCfg(mainCfgMirror),
+                        folderCmpMirror,
+                        mainCfgMirror.deviceParallelOps,
+                        warnings,
+                        statusHandler); //throw AbortProcess
+        });
+        std::cerr << "Run " << runNo + 1 << '/' << runs << " completed\n";
+    }
+}
+
+
+void showSyntaxHelp()
+{
+    std::cout << "FreeFileSync_Bench [options]\n\n"
+              "    -TempFolder <path>        benchmark folder (default: system temp folder); deleted when done\n"
+              "    -Output <file>            write JSON results to file (default: stdout)\n"
+              "    -Runs <n>                 repetitions (default: 3)\n"
+              "    -Seed <n>                 tree generator seed (default: 0)\n"
+              "    -Depth <n>                folder levels (default: 3)\n"
+              "    -FanOut <n>               sub folders per folder (default: 4)\n"
+              "    -FilesPerFolder <n>       (default: 50)\n"
+              "    -FileSizeMax <bytes>      log-uniform file size distribution (default: 65536)\n"
+              "    -NameLengthMax <n>        characters per name (default: 24)\n"
+              "    -UnicodePercent <n>       share of non-ASCII characters in names (default: 20)\n";
+}
+}
+
+
+int main(int argc, char* argv[])
+{
+    wxInitializer wxInit(argc, argv); //XmlGlobalSettings
+    if (!wxInit.IsOk())
+    {
+        std::cerr << "FreeFileSync: Failed to initialize wxWidgets.\n";
+        return FFS_EXIT_ABORTED;
+    }
+
+    TreeParams params;
+    size_t runs = 3;
+    Zstring tempFolderPath;
+    Zstring outputFilePath;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const Zstring arg = argv[i];
+        if (equalAsciiNoCase(arg, "-help") || equalAsciiNoCase(arg, "-h"))
+        {
+            showSyntaxHelp();
+            return FFS_EXIT_SUCCESS;
+        }
+        if (++i == argc)
+        {
+            std::cerr << "Value expected after " << utfTo<std::string>(arg) << '\n';
+            return FFS_EXIT_ABORTED;
+        }
+        const Zstring val = argv[i];
+
+        if      (equalAsciiNoCase(arg, "-TempFolder"))     tempFolderPath = getResolvedFilePath(val);
+        else if (equalAsciiNoCase(arg, "-Output"))         outputFilePath = getResolvedFilePath(val);
+        else if (equalAsciiNoCase(arg, "-Runs"))           runs = std::max(stringTo<size_t>(val), size_t(1));
+        else if (equalAsciiNoCase(arg, "-Seed"))           params.seed = stringTo<uint64_t>(val);
+        else if (equalAsciiNoCase(arg, "-Depth"))          params.depth = stringTo<size_t>(val);
+        else if (equalAsciiNoCase(arg, "-FanOut"))         params.fanOut = stringTo<size_t>(val);
+        else if (equalAsciiNoCase(arg, "-FilesPerFolder")) params.filesPerFolder = stringTo<size_t>(val);
+        else if (equalAsciiNoCase(arg, "-FileSizeMax"))    params.fileSizeMax = stringTo<uint64_t>(val);
+        else if (equalAsciiNoCase(arg, "-NameLengthMax"))  params.nameLengthMax = stringTo<size_t>(val);
+        else if (equalAsciiNoCase(arg, "-UnicodePercent")) params.unicodePercent = std::clamp(stringTo<int>(val), 0, 100);
+        else
+        {
+            std::cerr << "Unknown option " << utfTo<std::string>(arg) << '\n';
+            showSyntaxHelp();
+            return FFS_EXIT_ABORTED;
+        }
+    }
+
+    BenchRecorder recorder;
+    BenchStatusHandler statusHandler;
+    try
+    {
+        if (tempFolderPath.empty())
+            tempFolderPath = getTempFolderPath(); //throw FileError
+        const Zstring benchFolderPath = nativeAppendPaths(tempFolderPath, Zstr("FFS Bench ") + numberTo<Zstring>(::getpid()));
+
+        ZEN_ON_SCOPE_EXIT(try { removeDirectoryPlainRecursion(benchFolderPath); /*throw FileError*/ }
+        catch (const FileError& e) { std::cerr << utfTo<std::string>(e.toString()) << '\n'; });
+
+        runBenchmarks(benchFolderPath, params, runs, recorder, statusHandler); //throw FileError, AbortProcess
+
+        const std::string json = generateResultJson(params, generateTreeSpec(params), runs, recorder.getResults(), statusHandler.getErrorCount());
+        if (outputFilePath.empty())
+            std::cout << json;
+        else
+            setFileContent(outputFilePath, json, nullptr /*notifyUnbufferedIO*/); //throw FileError
+    }
+    catch (const FileError& e)
+    {
+        std::cerr << utfTo<std::string>(e.toString()) << '\n';
+        return FFS_EXIT_ABORTED;
+    }
+    catch (AbortProcess&) { return FFS_EXIT_ABORTED; }
+
+    return statusHandler.getErrorCount() > 0 ? FFS_EXIT_ERROR : FFS_EXIT_SUCCESS;
+}
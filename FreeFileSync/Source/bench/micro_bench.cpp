@@ -0,0 +1,519 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <zen/base64.h>
+#include <zen/crc.h>
+#include <zen/file_io.h>
+#include <zen/json.h>
+#include <zen/resolve_path.h>
+#include <zen/ring_buffer.h>
+#include <zen/serialize.h>
+#include <zen/thread.h>
+#include <zen/utf.h>
+#include "../base/path_filter.h"
+#include "../version/version.h"
+#include "../return_codes.h"
+
+using namespace zen;
+using namespace fff;
+
+
+/*  micro benchmarks for the string, path and filter primitives called per item (sorting, comparison, filtering, db files):
+    - corpora generated from a fixed seed: mixed-script file names, deep relative paths, a real-world exclude filter list
+    - ns/op: minimum over several samples => least affected by scheduling noise
+    - allocations/op: counted via replaced global operator new (all threads)
+    - results are written as JSON; "-Baseline <file>" prints the relative change against an earlier run => compare builds before/after an optimization  */
+namespace
+{
+std::atomic<uint64_t> allocationCount{0};
+
+void* allocateCounted(size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size != 0 ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+}
+
+void* operator new  (size_t size) { return allocateCounted(size); }
+void* operator new[](size_t size) { return allocateCounted(size); }
+
+void operator delete  (void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete  (void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+
+namespace
+{
+template <class T> inline
+void keepResult(const T& val) { asm volatile("" : : "g"(&val) : "memory"); } //don't let the optimizer remove the benchmarked calls
+
+
+struct Corpus
+{
+    std::vector<Zstring> fileNames;
+    std::vector<Zstring> fileNamesSorted; //byte-wise: neighbors share prefixes like in a real sort
+    std::vector<Zstring> relPaths;
+    std::vector<Zstring> relPathsSorted;
+    std::vector<std::wstring> fileNamesWide;
+    Zstring excludeFilter;
+    std::vector<std::string> blocks4k;
+    std::vector<std::string> digests; //32 bytes: content hashes, db ids
+};
+
+
+Zstring generateFileName(std::mt19937_64& rng)
+{
+    static const char* const words[] = {"Report", "invoice", "IMG", "DSC", "Track", "Chapter", "backup", "notes", "final", "draft", "Copy of", "Scan",
+                                        "Resume", "readme", "index", "main", "config", "photo", "video", "Screenshot", "New Folder", "project"
+                                       };
+    static const char* const unicodeWords[] = {"\xc3\x9c" "bersicht" /*U umlaut, precomposed*/, "Expe\xcc\x81rience" /*e + combining acute: macOS, NFD*/,
+                                               "\xd0\xa4\xd0\xbe\xd1\x82\xd0\xbe" /*Cyrillic*/, "\xce\x88\xce\xb3\xce\xb3\xcf\x81\xce\xb1\xcf\x86\xce\xbf" /*Greek*/,
+                                               "\xe5\x86\x99\xe7\x9c\x9f" /*CJK*/, "\xe3\x83\x95\xe3\x82\xa1\xe3\x82\xa4\xe3\x83\xab" /*Katakana*/,
+                                               "\xeb\xac\xb8\xec\x84\x9c" /*Hangul*/, "\xd9\x85\xd9\x84\xd9\x81" /*Arabic*/, "stra\xc3\x9f" "e" /*sharp s*/,
+                                               "\xf0\x9f\x98\x80" /*emoji: 4-byte UTF-8*/
+                                              };
+    static const Zchar* const extensions[] = {Zstr(".jpg"), Zstr(".JPG"), Zstr(".txt"), Zstr(".docx"), Zstr(".pdf"), Zstr(".mp3"), Zstr(".cpp"), Zstr(".h"),
+                                              Zstr(".tmp"), Zstr(".bak"), Zstr(".tar.gz"), Zstr("")
+                                             };
+    Zstring name;
+    const size_t wordCount = 1 + rng() % 3;
+    for (size_t i = 0; i < wordCount; ++i)
+    {
+        if (i > 0)
+            name += rng() % 2 == 0 ? Zstr(' ') : Zstr('_');
+
+        if (rng() % 100 < 30) //roughly a third of the names are non-ASCII
+            name += utfTo<Zstring>(unicodeWords[rng() % std::size(unicodeWords)]);
+        else
+            name += utfTo<Zstring>(words[rng() % std::size(words)]);
+    }
+    if (rng() % 100 < 60) //numbered series: natural sort
+    {
+        std::string num = numberTo<std::string>(rng() % 2000);
+        if (rng() % 2 == 0)
+            num = std::string(4 - std::min<size_t>(num.size(), 4), '0') + num;
+        name += Zstr(' ') + utfTo<Zstring>(num);
+    }
+    return name + extensions[rng() % std::size(extensions)];
+}
+
+
+Corpus generateCorpus(uint64_t seed, size_t itemCount)
+{
+    std::mt19937_64 rng(seed);
+    Corpus corpus;
+
+    for (size_t i = 0; i < itemCount; ++i)
+        corpus.fileNames.push_back(generateFileName(rng));
+
+    static const char* const folderNames[] = {"src", "Documents", "Pictures", "2023", "2024", "node_modules", ".git", "objects", "build", "Release",
+                                              "AppData", "Local", "Temp", "Music", "Artist - Album (Deluxe Edition)", "\xd0\x94\xd0\xbe\xd0\xba\xd1\x83\xd0\xbc\xd0\xb5\xd0\xbd\xd1\x82\xd1\x8b",
+                                              "\xe5\x86\x99\xe7\x9c\x9f", "Projekte \xc3\x84nderungen", "vendor", "lib", "include", "test data"
+                                             };
+    for (size_t i = 0; i < itemCount; ++i)
+    {
+        Zstring relPath;
+        const size_t depth = 1 + rng() % 12;
+        for (size_t d = 0; d < depth; ++d)
+            relPath = nativeAppendPaths(relPath, utfTo<Zstring>(folderNames[rng() % std::size(folderNames)]));
+        corpus.relPaths.push_back(nativeAppendPaths(relPath, corpus.fileNames[rng() % corpus.fileNames.size()]));
+    }
+
+    corpus.fileNamesSorted = corpus.fileNames;
+    std::sort(corpus.fileNamesSorted.begin(), corpus.fileNamesSorted.end());
+    corpus.relPathsSorted = corpus.relPaths;
+    std::sort(corpus.relPathsSorted.begin(), corpus.relPathsSorted.end());
+
+    for (const Zstring& name : corpus.fileNames)
+        corpus.fileNamesWide.push_back(utfTo<std::wstring>(name));
+
+    //typical user exclude list on top of the default filter: extensions, build/VCS folders, exact paths
+    corpus.excludeFilter =
+        Zstr("*/.Trash-*/\n*/.recycle/\n")
+        Zstr("*.tmp\n*.bak\n*~\n*.swp\n*.o\n*.obj\n*.pyc\n*.log\n~$*\nThumbs.db\ndesktop.ini\n.DS_Store\n")
+        Zstr("*/.git/\n*/.svn/\n*/node_modules/\n*/__pycache__/\n*/build/Release/\n*/AppData/Local/Temp/\n")
+        Zstr("*/Copy of *\n*/backup ????.*\n*IMG ?0??.JPG\n");
+    for (size_t i = 0; i < 200; ++i) //long lists of exact paths are common: "exclude via context menu"
+        corpus.excludeFilter += Zstr('/') + corpus.relPaths[rng() % corpus.relPaths.size()] + Zstr('\n');
+
+    auto randomBytes = [&](size_t len)
+    {
+        std::string buf(len, '\0');
+        std::generate(buf.begin(), buf.end(), [&] { return static_cast<char>(rng()); });
+        return buf;
+    };
+    for (size_t i = 0; i < 256; ++i)
+        corpus.blocks4k.push_back(randomBytes(4096));
+    for (size_t i = 0; i < itemCount; ++i)
+        corpus.digests.push_back(randomBytes(32));
+
+    return corpus;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------
+
+struct MicroResult
+{
+    std::string name;
+    uint64_t ops = 0;
+    double nsPerOp = 0;
+    double allocsPerOp = 0;
+};
+
+
+class MicroRecorder
+{
+public:
+    MicroRecorder(std::chrono::milliseconds minTime, const std::string& nameFilter) : minTime_(minTime), nameFilter_(nameFilter) {}
+
+    //fun: one pass over the corpus = "opsPerCall" operations
+    template <class Function>
+    void measure(const std::string& name, size_t opsPerCall, Function fun)
+    {
+        if (!nameFilter_.empty() && !contains(name, nameFilter_))
+            return;
+
+        fun(); //warm-up: caches, lazy initialization, RingBuffer/ThreadGroup growth
+
+        const size_t sampleCount = 5;
+        const auto sampleTimeMin = minTime_ / sampleCount;
+
+        double nsPerOpMin = std::numeric_limits<double>::infinity();
+        uint64_t opsTotal = 0;
+        const uint64_t allocsBefore = allocationCount.load(std::memory_order_relaxed);
+
+        for (size_t i = 0; i < sampleCount; ++i)
+        {
+            uint64_t ops = 0;
+            const auto startTime = std::chrono::steady_clock::now();
+            std::chrono::nanoseconds elapsed{};
+            do
+            {
+                fun();
+                ops += opsPerCall;
+                elapsed = std::chrono::steady_clock::now() - startTime;
+            }
+            while (elapsed < sampleTimeMin);
+
+            nsPerOpMin = std::min(nsPerOpMin, static_cast<double>(elapsed.count()) / ops);
+            opsTotal += ops;
+        }
+        const uint64_t allocs = allocationCount.load(std::memory_order_relaxed) - allocsBefore;
+
+        results_.push_back({name, opsTotal, nsPerOpMin, static_cast<double>(allocs) / opsTotal});
+        std::cerr << name << ": " << std::fixed << std::setprecision(1) << nsPerOpMin << " ns/op, " << std::setprecision(2) << results_.back().allocsPerOp << " allocs/op\n";
+    }
+
+    const std::vector<MicroResult>& getResults() const { return results_; }
+
+private:
+    const std::chrono::milliseconds minTime_;
+    const std::string nameFilter_;
+    std::vector<MicroResult> results_; //in order of execution
+};
+
+
+void runMicroBenchmarks(const Corpus& corpus, MicroRecorder& recorder)
+{
+    const size_t nameCount = corpus.fileNames.size();
+    const size_t pathCount = corpus.relPaths.size();
+
+    //---------- strings ----------
+    recorder.measure("getUpperCase", nameCount, [&]
+    {
+        for (const Zstring& name : corpus.fileNames)
+            keepResult(getUpperCase(name));
+    });
+    recorder.measure("getUnicodeNormalForm", nameCount, [&]
+    {
+        for (const Zstring& name : corpus.fileNames)
+            keepResult(getUnicodeNormalForm(name));
+    });
+    recorder.measure("compareNatural (sorted neighbors)", nameCount - 1, [&]
+    {
+        for (size_t i = 1; i < nameCount; ++i)
+            keepResult(compareNatural(corpus.fileNamesSorted[i - 1], corpus.fileNamesSorted[i]));
+    });
+    recorder.measure("compareNatural (random pairs)", nameCount - 1, [&]
+    {
+        for (size_t i = 1; i < nameCount; ++i)
+            keepResult(compareNatural(corpus.fileNames[i - 1], corpus.fileNames[i]));
+    });
+    recorder.measure("utfTo<std::wstring>", nameCount, [&]
+    {
+        for (const Zstring& name : corpus.fileNames)
+            keepResult(utfTo<std::wstring>(name));
+    });
+    recorder.measure("utfTo<Zstring> (from std::wstring)", nameCount, [&]
+    {
+        for (const std::wstring& name : corpus.fileNamesWide)
+            keepResult(utfTo<Zstring>(name));
+    });
+
+    //---------- paths ----------
+    recorder.measure("compareNativePath (sorted neighbors)", pathCount - 1, [&]
+    {
+        for (size_t i = 1; i < pathCount; ++i)
+            keepResult(compareNativePath(corpus.relPathsSorted[i - 1], corpus.relPathsSorted[i]));
+    });
+    recorder.measure("appendPaths", pathCount, [&]
+    {
+        const Zstring basePath = Zstr("/home/user/Sync Folder");
+        for (const Zstring& relPath : corpus.relPaths)
+            keepResult(nativeAppendPaths(basePath, relPath));
+    });
+
+    //---------- filter ----------
+    recorder.measure("NameFilter construction", 1, [&] { keepResult(NameFilter(Zstr("*"), corpus.excludeFilter)); });
+    {
+        const NameFilter filter(Zstr("*"), corpus.excludeFilter);
+        recorder.measure("NameFilter::passFileFilter", pathCount, [&]
+        {
+            for (const Zstring& relPath : corpus.relPaths)
+                keepResult(filter.passFileFilter(relPath));
+        });
+        recorder.measure("NameFilter::passDirFilter", pathCount, [&]
+        {
+            for (const Zstring& relPath : corpus.relPaths)
+            {
+                bool childItemMightMatch = true; //in/out
+                keepResult(filter.passDirFilter(relPath, &childItemMightMatch));
+            }
+        });
+    }
+
+    //---------- checksums, encoding ----------
+    recorder.measure("getCrc32 (4 KiB)", corpus.blocks4k.size(), [&]
+    {
+        for (const std::string& block : corpus.blocks4k)
+            keepResult(getCrc32(block));
+    });
+    recorder.measure("stringEncodeBase64 (4 KiB)", corpus.blocks4k.size(), [&]
+    {
+        for (const std::string& block : corpus.blocks4k)
+            keepResult(stringEncodeBase64(block));
+    });
+    recorder.measure("encodeBase64 (32 bytes, iterator)", corpus.digests.size(), [&]
+    {
+        for (const std::string& digest : corpus.digests)
+        {
+            std::string out;
+            encodeBase64(digest.begin(), digest.end(), std::back_inserter(out));
+            keepResult(out);
+        }
+    });
+
+    //---------- serialization: db file-like records ----------
+    auto writeRecords = [&]
+    {
+        MemoryStreamOut<std::string> streamOut;
+        for (size_t i = 0; i < nameCount; ++i)
+        {
+            writeContainer(streamOut, utfTo<std::string>(corpus.fileNames[i]));
+            writeNumber<int64_t>(streamOut, 1'600'000'000 + i);
+            writeNumber<uint64_t>(streamOut, i * 4096);
+            writeContainer(streamOut, corpus.digests[i]);
+        }
+        return std::move(streamOut.ref());
+    };
+    recorder.measure("serialize: write record", nameCount, [&] { keepResult(writeRecords()); });
+    {
+        const std::string stream = writeRecords();
+        recorder.measure("serialize: read record", nameCount, [&]
+        {
+            MemoryStreamIn streamIn(stream);
+            for (size_t i = 0; i < nameCount; ++i)
+            {
+                keepResult(readContainer<std::string>(streamIn)); //throw SysErrorUnexpectedEos
+                keepResult(readNumber<int64_t>(streamIn));        //
+                keepResult(readNumber<uint64_t>(streamIn));       //
+                keepResult(readContainer<std::string>(streamIn)); //
+            }
+        });
+    }
+
+    //---------- containers, threads ----------
+    {
+        RingBuffer<Zstring> buf;
+        recorder.measure("RingBuffer push_back/pop_front", nameCount, [&]
+        {
+            for (size_t i = 0; i < nameCount; ++i)
+            {
+                buf.push_back(corpus.fileNames[i]);
+                if (i % 4 == 3) //work queue: items drained behind the producer
+                    while (!buf.empty())
+                        buf.pop_front();
+            }
+            while (!buf.empty())
+                buf.pop_front();
+        });
+    }
+    {
+        const size_t taskCount = 1000;
+        const size_t threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        std::atomic<size_t> tasksDone{0};
+
+        ThreadGroup<std::function<void()>> tg(threadCount, Zstr("Bench ThreadGroup"));
+        recorder.measure("ThreadGroup dispatch", taskCount, [&]
+        {
+            for (size_t i = 0; i < taskCount; ++i)
+                tg.run([&] { tasksDone.fetch_add(1, std::memory_order_relaxed); });
+            tg.wait();
+        });
+
+        WorkStealingThreadGroup<std::function<void()>> wstg(threadCount, Zstr("Bench WorkStealing"));
+        recorder.measure("WorkStealingThreadGroup dispatch", taskCount, [&]
+        {
+            for (size_t i = 0; i < taskCount; ++i)
+                wstg.run([&] { tasksDone.fetch_add(1, std::memory_order_relaxed); });
+            wstg.wait();
+        });
+    }
+}
+
+
+std::string generateResultJson(uint64_t seed, size_t itemCount, const std::vector<MicroResult>& results)
+{
+    JsonValue benchmarks(JsonValue::Type::array);
+    for (const MicroResult& mr : results)
+    {
+        JsonValue bench(JsonValue::Type::object);
+        bench.objectVal.emplace("name", mr.name);
+        bench.objectVal.emplace("ops", static_cast<int64_t>(mr.ops));
+        bench.objectVal.emplace("ns_per_op", mr.nsPerOp);
+        bench.objectVal.emplace("allocs_per_op", mr.allocsPerOp);
+        benchmarks.arrayVal.push_back(std::move(bench));
+    }
+
+    JsonValue root(JsonValue::Type::object);
+    root.objectVal.emplace("version", ffsVersion);
+    root.objectVal.emplace("seed", static_cast<int64_t>(seed));
+    root.objectVal.emplace("items", static_cast<int64_t>(itemCount));
+    root.objectVal.emplace("benchmarks", std::move(benchmarks));
+    return serializeJson(root) + '\n';
+}
+
+
+void printBaselineComparison(const std::string& baselineJson, const std::vector<MicroResult>& results) //throw JsonParsingError
+{
+    const JsonValue root = parseJson(baselineJson); //throw JsonParsingError
+
+    std::map<std::string, std::pair<double /*ns/op*/, double /*allocs/op*/>> baseline;
+    if (const JsonValue* benchmarks = getChildFromJsonObject(root, "benchmarks"))
+        for (const JsonValue& bench : benchmarks->arrayVal)
+            if (const std::optional<std::string> name = getPrimitiveFromJsonObject(bench, "name"))
+                baseline[*name] = {stringTo<double>(getPrimitiveFromJsonObject(bench, "ns_per_op"    ).value_or("0")),
+                                   stringTo<double>(getPrimitiveFromJsonObject(bench, "allocs_per_op").value_or("0"))};
+
+    std::cerr << "\nChange against baseline (ns/op, allocs/op):\n";
+    for (const MicroResult& mr : results)
+        if (auto it = baseline.find(mr.name); it != baseline.end())
+        {
+            const auto [nsPerOpBase, allocsPerOpBase] = it->second;
+            std::cerr << std::left  << std::setw(40) << mr.name <<
+                      std::right << std::fixed << std::setprecision(1) << std::setw(10) << nsPerOpBase << " -> " << std::setw(10) << mr.nsPerOp;
+            if (nsPerOpBase > 0)
+                std::cerr << std::showpos << std::setw(8) << (mr.nsPerOp / nsPerOpBase - 1) * 100 << '%' << std::noshowpos;
+            std::cerr << std::setprecision(2) << std::setw(10) << allocsPerOpBase << " -> " << mr.allocsPerOp << '\n';
+        }
+        else
+            std::cerr << std::left << std::setw(40) << mr.name << " (not in baseline)\n";
+}
+
+
+void showSyntaxHelp()
+{
+    std::cout << "FreeFileSync_MicroBench [options]\n\n"
+              "    -Output <file>            write JSON results to file (default: stdout)\n"
+              "    -Baseline <file>          JSON results of an earlier run: print relative change\n"
+              "    -Filter <text>            run benchmarks with matching name only\n"
+              "    -MinTime <ms>             measurement time per benchmark (default: 500)\n"
+              "    -Items <n>                corpus size: file names, paths, digests (default: 10000)\n"
+              "    -Seed <n>                 corpus generator seed (default: 0)\n";
+}
+}
+
+
+int main(int argc, char* argv[])
+{
+    uint64_t seed = 0;
+    size_t itemCount = 10'000;
+    std::chrono::milliseconds minTime(500);
+    std::string nameFilter;
+    Zstring outputFilePath;
+    Zstring baselineFilePath;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const Zstring arg = argv[i];
+        if (equalAsciiNoCase(arg, "-help") || equalAsciiNoCase(arg, "-h"))
+        {
+            showSyntaxHelp();
+            return FFS_EXIT_SUCCESS;
+        }
+        if (++i == argc)
+        {
+            std::cerr << "Value expected after " << utfTo<std::string>(arg) << '\n';
+            return FFS_EXIT_ABORTED;
+        }
+        const Zstring val = argv[i];
+
+        if      (equalAsciiNoCase(arg, "-Output"))   outputFilePath   = getResolvedFilePath(val);
+        else if (equalAsciiNoCase(arg, "-Baseline")) baselineFilePath = getResolvedFilePath(val);
+        else if (equalAsciiNoCase(arg, "-Filter"))   nameFilter = utfTo<std::string>(val);
+        else if (equalAsciiNoCase(arg, "-MinTime"))  minTime = std::chrono::milliseconds(std::max(stringTo<int>(val), 1));
+        else if (equalAsciiNoCase(arg, "-Items"))    itemCount = std::max(stringTo<size_t>(val), size_t(2));
+        else if (equalAsciiNoCase(arg, "-Seed"))     seed = stringTo<uint64_t>(val);
+        else
+        {
+            std::cerr << "Unknown option " << utfTo<std::string>(arg) << '\n';
+            showSyntaxHelp();
+            return FFS_EXIT_ABORTED;
+        }
+    }
+
+    try
+    {
+        const Corpus corpus = generateCorpus(seed, itemCount);
+
+        MicroRecorder recorder(minTime, nameFilter);
+        runMicroBenchmarks(corpus, recorder); //throw SysErrorUnexpectedEos
+
+        if (!baselineFilePath.empty())
+            try
+            {
+                printBaselineComparison(getFileContent(baselineFilePath, nullptr /*notifyUnbufferedIO*/), recorder.getResults()); //throw FileError, JsonParsingError
+            }
+            catch (JsonParsingError&) { std::cerr << "Invalid baseline file: " << utfTo<std::string>(baselineFilePath) << '\n'; }
+
+        const std::string json = generateResultJson(seed, itemCount, recorder.getResults());
+        if (outputFilePath.empty())
+            std::cout << json;
+        else
+            setFileContent(outputFilePath, json, nullptr /*notifyUnbufferedIO*/); //throw FileError
+    }
+    catch (const FileError& e)
+    {
+        std::cerr << utfTo<std::string>(e.toString()) << '\n';
+        return FFS_EXIT_ABORTED;
+    }
+    catch (const SysError& e) //SysErrorUnexpectedEos: serialization round trip is broken
+    {
+        std::cerr << utfTo<std::string>(e.toString()) << '\n';
+        return FFS_EXIT_ABORTED;
+    }
+
+    return FFS_EXIT_SUCCESS;
+}
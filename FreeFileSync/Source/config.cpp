@@ -9,6 +9,7 @@
 #include <zen/file_access.h>
 #include <zen/file_io.h>
 #include <zen/time.h>
+#include <zen/perf.h>
 #include <zen/process_exec.h>
 #include <wx/intl.h>
 #include "ffs_paths.h"
@@ -708,6 +709,39 @@ bool readText(const std::string& input, UnitTime& value)
 }
 
 
+template <> inline
+void writeText(const RotationalMode& value, std::string& output)
+{
+    switch (value)
+    {
+        case RotationalMode::autoDetect:
+            output = "Auto";
+            break;
+        case RotationalMode::always:
+            output = "Always";
+            break;
+        case RotationalMode::never:
+            output = "Never";
+            break;
+    }
+}
+
+template <> inline
+bool readText(const std::string& input, RotationalMode& value)
+{
+    const std::string tmp = trimCpy(input);
+    if (tmp == "Auto")
+        value = RotationalMode::autoDetect;
+    else if (tmp == "Always")
+        value = RotationalMode::always;
+    else if (tmp == "Never")
+        value = RotationalMode::never;
+    else
+        return false;
+    return true;
+}
+
+
 template <> inline
 void writeText(const LogFileFormat& value, std::string& output)
 {
@@ -1316,6 +1350,9 @@ void readConfig(const XmlIn& in, MainConfiguration& mainCfg, int formatVer)
             inMain["Errors"].attribute("Delay",  mainCfg.autoRetryDelay);
         }
 
+    if (inMain["CacheNeutralCopy"]) //optional: expert setting
+        inMain["CacheNeutralCopy"].attribute("Enabled", mainCfg.cacheNeutralCopy);
+
     //TODO: remove if parameter migration after some time! 2017-10-24
     if (formatVer < 8)
         inMain["OnCompletion"](mainCfg.postSyncCommand);
@@ -1503,8 +1540,30 @@ void readConfig(const XmlIn& in, XmlGlobalSettings& cfg, int formatVer)
     in2["RunWithBackgroundPriority"].attribute("Enabled", cfg.runWithBackgroundPriority);
     in2["LockDirectoriesDuringSync"].attribute("Enabled", cfg.createLockFile);
     in2["VerifyCopiedFiles"        ].attribute("Enabled", cfg.verifyFileCopy);
+    if (in2["AsyncFileIO"]) //optional: expert setting
+        in2["AsyncFileIO"].attribute("Enabled", cfg.asyncFileIo);
+    if (in2["ContentPrefilter"]) //optional: expert setting
+        in2["ContentPrefilter"].attribute("MinFileSizeMB", cfg.contentPrefilterMinSizeMB);
+    if (in2["AutoTuneParallelOps"]) //optional: expert setting
+        in2["AutoTuneParallelOps"].attribute("Enabled", cfg.autoTuneParallelOps);
+    if (in2["DeviceBandwidthLimit"]) //optional: expert setting
+        in2["DeviceBandwidthLimit"].attribute("KBPerSec", cfg.deviceBandwidthLimitKB);
+    if (in2["SnapshotChanges"]) //optional: expert setting
+        in2["SnapshotChanges"].attribute("Enabled", cfg.snapshotChangeSource);
+    if (in2["RotationalMedia"]) //optional: expert setting
+        in2["RotationalMedia"].attribute("Mode", cfg.rotationalMode);
+    if (in2["NumaAffinity"]) //optional: expert setting
+        in2["NumaAffinity"].attribute("Enabled", cfg.numaAffinity);
+    if (in2["DatabaseCatalog"]) //optional: expert setting
+        in2["DatabaseCatalog"].attribute("Path", cfg.dbCatalogFolderPath);
+    if (in2["TraceFile"]) //optional: expert setting
+        in2["TraceFile"].attribute("Path", cfg.traceFilePath);
+    if (in2["MetricsFile"]) //optional: expert setting
+        in2["MetricsFile"].attribute("Path", cfg.metricsFilePath);
     in2["LogFiles"                 ].attribute("MaxAge",  cfg.logfilesMaxAgeDays);
     in2["LogFiles"                 ].attribute("Format",  cfg.logFormat);
+    if (in2["LogFiles"].hasAttribute("Gzip")) //*no error* if not available
+        in2["LogFiles"].attribute("Gzip", cfg.logFileGzip);
 
     //TODO: remove old parameter after migration! 2021-03-06
     if (formatVer < 21)
@@ -1515,6 +1574,8 @@ void readConfig(const XmlIn& in, XmlGlobalSettings& cfg, int formatVer)
     }
 
     in2["ProgressDialog"].attribute("AutoClose", cfg.progressDlgAutoClose);
+    if (in2["ProgressDialog"].hasAttribute("Diagnostics")) //optional: expert setting
+        in2["ProgressDialog"].attribute("Diagnostics", cfg.progressDlgDiagnostics);
 
     //TODO: remove if parameter migration after some time! 2018-08-13
     if (formatVer < 14)
@@ -1720,6 +1781,10 @@ void readConfig(const XmlIn& in, XmlGlobalSettings& cfg, int formatVer)
         inFileGrid.attribute("ShowIcons",  cfg.mainDlg.showIcons);
         inFileGrid.attribute("IconSize",   cfg.mainDlg.iconSize);
     }
+    if (inFileGrid.hasAttribute("ThumbnailCache")) //*no error* if not available
+        inFileGrid.attribute("ThumbnailCache", cfg.mainDlg.thumbnailCache);
+    if (inFileGrid.hasAttribute("RestoreComparison")) //*no error* if not available
+        inFileGrid.attribute("RestoreComparison", cfg.mainDlg.restoreComparison);
     inFileGrid.attribute("SashOffset", cfg.mainDlg.sashOffset);
 
     //TODO: remove if parameter migration after some time! 2018-09-09
@@ -2028,6 +2093,8 @@ void readConfig(const XmlIn& in, XmlGlobalSettings& cfg, int formatVer)
 template <class ConfigType>
 std::pair<ConfigType, std::wstring /*warningMsg*/>  readConfig(const Zstring& filePath, XmlType type, int currentXmlFormatVer) //throw FileError
 {
+    TraceSpan span("load config", [&] { return utfTo<std::string>(filePath); });
+
     XmlDoc doc = loadXml(filePath); //throw FileError
 
     if (getXmlTypeNoThrow(doc) != type) //noexcept
@@ -2291,6 +2358,9 @@ void writeConfig(const MainConfiguration& mainCfg, XmlOut& out)
     outMain["Errors"].attribute("Retry",  mainCfg.autoRetryCount);
     outMain["Errors"].attribute("Delay",  mainCfg.autoRetryDelay);
 
+    if (mainCfg.cacheNeutralCopy) //optional: expert setting
+        outMain["CacheNeutralCopy"].attribute("Enabled", mainCfg.cacheNeutralCopy);
+
     outMain["PostSyncCommand"](mainCfg.postSyncCommand);
     outMain["PostSyncCommand"].attribute("Condition", mainCfg.postSyncCondition);
 
@@ -2341,10 +2411,22 @@ void writeConfig(const XmlGlobalSettings& cfg, XmlOut& out)
     out["RunWithBackgroundPriority"].attribute("Enabled", cfg.runWithBackgroundPriority);
     out["LockDirectoriesDuringSync"].attribute("Enabled", cfg.createLockFile);
     out["VerifyCopiedFiles"        ].attribute("Enabled", cfg.verifyFileCopy);
+    out["AsyncFileIO"              ].attribute("Enabled", cfg.asyncFileIo);
+    out["ContentPrefilter"         ].attribute("MinFileSizeMB", cfg.contentPrefilterMinSizeMB);
+    out["AutoTuneParallelOps"      ].attribute("Enabled", cfg.autoTuneParallelOps);
+    out["DeviceBandwidthLimit"     ].attribute("KBPerSec", cfg.deviceBandwidthLimitKB);
+    out["SnapshotChanges"          ].attribute("Enabled", cfg.snapshotChangeSource);
+    out["RotationalMedia"          ].attribute("Mode",    cfg.rotationalMode);
+    out["NumaAffinity"             ].attribute("Enabled", cfg.numaAffinity);
+    out["DatabaseCatalog"          ].attribute("Path",    cfg.dbCatalogFolderPath);
+    out["TraceFile"                ].attribute("Path",    cfg.traceFilePath);
+    out["MetricsFile"              ].attribute("Path",    cfg.metricsFilePath);
     out["LogFiles"                 ].attribute("MaxAge",  cfg.logfilesMaxAgeDays);
     out["LogFiles"                 ].attribute("Format",  cfg.logFormat);
+    out["LogFiles"                 ].attribute("Gzip",    cfg.logFileGzip);
 
-    out["ProgressDialog"].attribute("AutoClose", cfg.progressDlgAutoClose);
+    out["ProgressDialog"].attribute("AutoClose",   cfg.progressDlgAutoClose);
+    out["ProgressDialog"].attribute("Diagnostics", cfg.progressDlgDiagnostics);
 
     XmlOut outOpt = out["OptionalDialogs"];
     outOpt["ConfirmStartSync"              ].attribute("Show", cfg.confirmDlgs.confirmSyncStart);
@@ -2401,6 +2483,8 @@ void writeConfig(const XmlGlobalSettings& cfg, XmlOut& out)
     XmlOut outFileGrid = outMainWin["FilePanel"];
     outFileGrid.attribute("ShowIcons",  cfg.mainDlg.showIcons);
     outFileGrid.attribute("IconSize",   cfg.mainDlg.iconSize);
+    outFileGrid.attribute("ThumbnailCache", cfg.mainDlg.thumbnailCache);
+    outFileGrid.attribute("RestoreComparison", cfg.mainDlg.restoreComparison);
     outFileGrid.attribute("SashOffset", cfg.mainDlg.sashOffset);
     outFileGrid.attribute("FolderPairsMax", cfg.mainDlg.folderPairsVisibleMax);
     outFileGrid.attribute("PathFormatLeft",  cfg.mainDlg.itemPathFormatLeftGrid);
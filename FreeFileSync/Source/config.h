@@ -160,8 +160,19 @@ struct XmlGlobalSettings
     bool runWithBackgroundPriority = false;
     bool createLockFile = true;
     bool verifyFileCopy = false;
+    bool asyncFileIo = false; //io_uring for local file streams (no GUI option)
+    int contentPrefilterMinSizeMB = 256; //compare by content: sample blocks of larger files first; <= 0 to disable (no GUI option)
+    bool autoTuneParallelOps = false; //adapt parallel operations per device at runtime; configured count is the ceiling (no GUI option)
+    int deviceBandwidthLimitKB = 0; //KB/sec per device for file copies during sync; <= 0 to disable (no GUI option)
+    bool snapshotChangeSource = false; //incremental comparison of native ZFS/Btrfs folders via file system snapshots (no GUI option)
+    zen::RotationalMode rotationalMode = zen::RotationalMode::autoDetect; //HDD: stat by inode number, copy batches in physical order (no GUI option)
+    bool numaAffinity = false; //multi-socket servers: pin device worker pools to the NUMA node of the device (no GUI option)
+    Zstring dbCatalogFolderPath; //keep sync.ffs_db of remote base folders in this local folder; empty: disabled (no GUI option)
+    Zstring traceFilePath; //record tracing spans and write Chrome trace JSON on exit; empty: disabled (no GUI option)
+    Zstring metricsFilePath; //batch runs: write JSON (or Prometheus textfile if *.prom) metrics; empty: disabled (no GUI option)
     int logfilesMaxAgeDays = 30; //<= 0 := no limit; for log files under %AppData%\FreeFileSync\Logs
     LogFileFormat logFormat = LogFileFormat::html;
+    bool logFileGzip = false;
 
     Zstring soundFileCompareFinished;
     Zstring soundFileSyncFinished;
@@ -212,6 +223,8 @@ struct XmlGlobalSettings
 
         bool showIcons = true;
         FileIconSize iconSize = FileIconSize::small;
+        bool thumbnailCache = true; //persist thumbnails of medium/large icon sizes
+        bool restoreComparison = true; //persist comparison result: review again after restart without comparing (no GUI option)
         int sashOffset = 0;
 
         ItemPathFormat itemPathFormatLeftGrid  = defaultItemPathFormatLeftGrid;
@@ -221,6 +234,7 @@ struct XmlGlobalSettings
     } mainDlg;
 
     bool progressDlgAutoClose = false;
+    bool progressDlgDiagnostics = false; //per-device activity, latencies, engine lock waits; enables metrics (no GUI option)
 
     FilterConfig defaultFilter = []
     {
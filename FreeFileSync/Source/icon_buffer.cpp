@@ -8,12 +8,19 @@
 #include <map>
 #include <set>
 #include <variant>
+#include <cstring>
 #include <zen/thread.h> //includes <std/thread.hpp>
 #include <zen/scope_guard.h>
+#include <zen/file_access.h>
+#include <zen/file_io.h>
+#include <zen/perf.h>
+#include <zen/zlib_wrap.h>
 #include <wx+/dc.h>
 #include <wx+/image_resources.h>
 #include <wx+/image_tools.h>
 #include "base/icon_loader.h"
+#include "afs/native.h"
+    #include <sys/stat.h>
 
 
 using namespace zen;
@@ -25,12 +32,274 @@ namespace
 {
 const size_t BUFFER_SIZE_MAX = 1000; //maximum number of icons to hold in buffer: must be big enough to hold visible icons + preload buffer!
 
+const size_t WORKER_COUNT_MAX = 16; //icon loading is latency-bound (e.g. network shares) => parallel ops as configured per device
 
+const char   THUMB_DB_FILE_DESCR[] = "FreeFileSync";
+const int    THUMB_DB_FILE_VERSION = 1; //2026-10-14
+const size_t THUMB_CACHE_BYTES_MAX = 64 * 1024 * 1024; //compressed pixel data
 }
 
 //################################################################################################################################################
 
-std::variant<ImageHolder, FileIconHolder> getDisplayIcon(const AbstractPath& itemPath, IconBuffer::IconSize sz)
+/*  persistent thumbnails keyed by native file path, validated by modification time and file size:
+    - creating a thumbnail means reading (and decoding) the full image: expensive for big photos on network shares
+    - called by worker threads; DB file is loaded lazily on first use, saved by main thread after all workers are joined  */
+class ThumbnailCache
+{
+public:
+    explicit ThumbnailCache(const Zstring& dbFilePath) : dbFilePath_(dbFilePath) {}
+
+    ImageHolder getThumbnailImage(const AbstractPath& itemPath, int pixelSize) //throw SysError; optional return value
+    {
+        const Zstring& filePath = getNativeItemPath(itemPath);
+        if (dbFilePath_.empty() || filePath.empty())
+            return AFS::getThumbnailImage(itemPath, pixelSize); //throw SysError
+
+        struct stat fileInfo = {};
+        if (::stat(filePath.c_str(), &fileInfo) != 0)
+            return AFS::getThumbnailImage(itemPath, pixelSize); //throw SysError => let it report the error
+
+        const time_t   modTime  = fileInfo.st_mtime;
+        const uint64_t fileSize = fileInfo.st_size;
+
+        if (ImageHolder ih = lookup(filePath, modTime, fileSize, pixelSize)) //noexcept
+            return ih;
+
+        ImageHolder ih = AFS::getThumbnailImage(itemPath, pixelSize); //throw SysError
+        if (ih)
+            store(filePath, modTime, fileSize, pixelSize, ih); //noexcept
+        return ih;
+    }
+
+    void save() //throw FileError
+    {
+        entries_.access([&](std::optional<EntryMap>& entries)
+        {
+            if (!entries || !modified_)
+                return;
+
+            MemoryStreamOut<std::string> streamOut;
+            writeArray(streamOut, THUMB_DB_FILE_DESCR, sizeof(THUMB_DB_FILE_DESCR));
+            writeNumber<int32_t>(streamOut, THUMB_DB_FILE_VERSION);
+
+            writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(entries->size()));
+            for (const auto& [filePath, entry] : *entries)
+            {
+                writeContainer(streamOut, utfTo<std::string>(filePath));
+                writeNumber<int64_t >(streamOut, entry.modTime);
+                writeNumber<uint64_t>(streamOut, entry.fileSize);
+                writeNumber<int32_t >(streamOut, entry.pixelSize);
+                writeNumber<int64_t >(streamOut, entry.lastAccess);
+                writeNumber<int32_t >(streamOut, entry.width);
+                writeNumber<int32_t >(streamOut, entry.height);
+                writeNumber<int8_t  >(streamOut, entry.hasAlpha);
+                writeContainer(streamOut, entry.pixels); //already compressed
+            }
+            setFileContent(dbFilePath_, streamOut.ref(), nullptr /*notifyUnbufferedIO*/); //throw FileError
+            modified_ = false;
+        });
+    }
+
+private:
+    ThumbnailCache           (const ThumbnailCache&) = delete;
+    ThumbnailCache& operator=(const ThumbnailCache&) = delete;
+
+    struct Entry
+    {
+        time_t   modTime  = 0;
+        uint64_t fileSize = 0;
+        int      pixelSize = 0;
+        time_t   lastAccess = 0;
+        int      width  = 0;
+        int      height = 0;
+        bool     hasAlpha = false;
+        std::string pixels; //zlib-compressed: RGB followed by optional alpha channel
+    };
+    using EntryMap = std::map<Zstring /*native file path*/, Entry>;
+
+    ImageHolder lookup(const Zstring& filePath, time_t modTime, uint64_t fileSize, int pixelSize) //noexcept
+    {
+        Entry entry;
+        const bool found = entries_.access([&](std::optional<EntryMap>& entries)
+        {
+            EntryMap& em = getEntries(entries);
+            auto it = em.find(filePath);
+            if (it == em.end() ||
+                it->second.modTime   != modTime  ||
+                it->second.fileSize  != fileSize ||
+                it->second.pixelSize != pixelSize)
+                return false;
+
+            it->second.lastAccess = std::time(nullptr);
+            entry = it->second; //decompress outside of lock
+            return true;
+        });
+        if (!found)
+            return {};
+
+        try
+        {
+            const size_t pixelCount = static_cast<size_t>(entry.width) * entry.height;
+            const std::string pixels = decompress(entry.pixels); //throw SysError
+
+            if (entry.width > 0 && entry.height > 0 &&
+                pixels.size() == pixelCount * (entry.hasAlpha ? 4 : 3))
+            {
+                ImageHolder ih(entry.width, entry.height, entry.hasAlpha);
+                std::memcpy(ih.getRgb(), pixels.data(), pixelCount * 3);
+                if (entry.hasAlpha)
+                    std::memcpy(ih.getAlpha(), pixels.data() + pixelCount * 3, pixelCount);
+                return ih;
+            }
+        }
+        catch (SysError&) {}
+
+        entries_.access([&](std::optional<EntryMap>& entries) { getEntries(entries).erase(filePath); modified_ = true; }); //corrupted
+        return {};
+    }
+
+    void store(const Zstring& filePath, time_t modTime, uint64_t fileSize, int pixelSize, ImageHolder& ih) //noexcept
+    {
+        Entry entry;
+        entry.modTime    = modTime;
+        entry.fileSize   = fileSize;
+        entry.pixelSize  = pixelSize;
+        entry.lastAccess = std::time(nullptr);
+        entry.width      = ih.getWidth();
+        entry.height     = ih.getHeight();
+        entry.hasAlpha   = ih.getAlpha() != nullptr;
+        try
+        {
+            const size_t pixelCount = static_cast<size_t>(entry.width) * entry.height;
+
+            std::string pixels(reinterpret_cast<const char*>(ih.getRgb()), pixelCount * 3);
+            if (entry.hasAlpha)
+                pixels.append(reinterpret_cast<const char*>(ih.getAlpha()), pixelCount);
+
+            entry.pixels = compress(pixels, 3 /*best compression level: see db_file.cpp*/); //throw SysError
+        }
+        catch (SysError&) { return; } //it's just a cache
+
+        entries_.access([&](std::optional<EntryMap>& entries)
+        {
+            EntryMap& em = getEntries(entries);
+            if (auto it = em.find(filePath);
+                it != em.end())
+            {
+                bytesTotal_ -= it->second.pixels.size();
+                em.erase(it);
+            }
+            bytesTotal_ += entry.pixels.size();
+            em.emplace(filePath, std::move(entry));
+            modified_ = true;
+
+            if (bytesTotal_ > THUMB_CACHE_BYTES_MAX)
+                limitSize(em);
+
+            setMemoryUsage("thumbnail cache", bytesTotal_);
+        });
+    }
+
+    //call while holding lock:
+    EntryMap& getEntries(std::optional<EntryMap>& entries) //noexcept
+    {
+        if (!entries)
+        {
+            entries = EntryMap();
+            bytesTotal_ = 0;
+            try
+            {
+                *entries = loadEntries(dbFilePath_); //throw FileError
+                for (const auto& [filePath, entry] : *entries)
+                    bytesTotal_ += entry.pixels.size();
+            }
+            catch (FileError&) { modified_ = true; } //start from scratch; corrupted DB file will be overwritten at teardown
+
+            setMemoryUsage("thumbnail cache", bytesTotal_);
+        }
+        return *entries;
+    }
+
+    //call while holding lock: amortize by removing least recently used items down to 3/4 of the limit
+    void limitSize(EntryMap& em)
+    {
+        std::vector<EntryMap::iterator> entryByAge;
+        for (auto it = em.begin(); it != em.end(); ++it)
+            entryByAge.push_back(it);
+
+        std::sort(entryByAge.begin(), entryByAge.end(), [](const EntryMap::iterator& lhs, const EntryMap::iterator& rhs)
+        { return lhs->second.lastAccess < rhs->second.lastAccess; });
+
+        for (const EntryMap::iterator& it : entryByAge)
+        {
+            if (bytesTotal_ <= THUMB_CACHE_BYTES_MAX / 4 * 3)
+                break;
+            bytesTotal_ -= it->second.pixels.size();
+            em.erase(it);
+        }
+    }
+
+    static EntryMap loadEntries(const Zstring& dbFilePath) //throw FileError
+    {
+        std::string byteStream;
+        try
+        {
+            byteStream = getFileContent(dbFilePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+        }
+        catch (FileError&)
+        {
+            if (itemStillExists(dbFilePath)) //throw FileError
+                throw;
+
+            return {};
+        }
+
+        try
+        {
+            MemoryStreamIn streamIn(byteStream);
+            //-------- file format header --------
+            char tmp[sizeof(THUMB_DB_FILE_DESCR)] = {};
+            readArray(streamIn, &tmp, sizeof(tmp)); //throw SysErrorUnexpectedEos
+
+            if (!std::equal(std::begin(tmp), std::end(tmp), std::begin(THUMB_DB_FILE_DESCR)))
+                throw SysError(_("File content is corrupted.") + L" (invalid header)");
+
+            const int version = readNumber<int32_t>(streamIn); //throw SysErrorUnexpectedEos
+            if (version != THUMB_DB_FILE_VERSION)
+                throw SysError(_("Unsupported data format.") + L' ' + replaceCpy(_("Version: %x"), L"%x", numberTo<std::wstring>(version)));
+
+            EntryMap em;
+            size_t entryCount = readNumber<uint32_t>(streamIn); //throw SysErrorUnexpectedEos
+            while (entryCount-- != 0)
+            {
+                const Zstring filePath = utfTo<Zstring>(readContainer<std::string>(streamIn)); //
+                Entry& entry = em[filePath];
+                entry.modTime    = readNumber<int64_t >(streamIn); //
+                entry.fileSize   = readNumber<uint64_t>(streamIn); //
+                entry.pixelSize  = readNumber<int32_t >(streamIn); //
+                entry.lastAccess = readNumber<int64_t >(streamIn); //throw SysErrorUnexpectedEos
+                entry.width      = readNumber<int32_t >(streamIn); //
+                entry.height     = readNumber<int32_t >(streamIn); //
+                entry.hasAlpha   = readNumber<int8_t  >(streamIn) != 0;   //
+                entry.pixels     = readContainer<std::string>(streamIn); //
+            }
+            return em;
+        }
+        catch (const SysError& e)
+        {
+            throw FileError(replaceCpy(_("Cannot read database file %x."), L"%x", fmtPath(dbFilePath)), e.toString());
+        }
+    }
+
+    const Zstring dbFilePath_; //empty: no persistent cache
+    Protected<std::optional<EntryMap>> entries_;
+    size_t bytesTotal_ = 0; //
+    bool modified_ = false; //protected by entries_ lock
+};
+
+//################################################################################################################################################
+
+std::variant<ImageHolder, FileIconHolder> getDisplayIcon(const AbstractPath& itemPath, IconBuffer::IconSize sz, ThumbnailCache& thumbCache)
 {
     //1. try to load thumbnails
     switch (sz)
@@ -41,7 +310,7 @@ std::variant<ImageHolder, FileIconHolder> getDisplayIcon(const AbstractPath& ite
         case IconBuffer::SIZE_LARGE:
             try
             {
-                if (ImageHolder ih = AFS::getThumbnailImage(itemPath, IconBuffer::getSize(sz))) //throw SysError; optional return value
+                if (ImageHolder ih = thumbCache.getThumbnailImage(itemPath, IconBuffer::getSize(sz))) //throw SysError; optional return value
                     return ih;
             }
             catch (SysError&) {}
@@ -65,11 +334,18 @@ std::variant<ImageHolder, FileIconHolder> getDisplayIcon(const AbstractPath& ite
 //################################################################################################################################################
 
 //---------------------- Shared Data -------------------------
+struct WorkItem
+{
+    AbstractPath filePath;
+    size_t parallelOps = 1; //max. number of icons to load at the same time on filePath's device
+};
+
+
 class WorkLoad
 {
 public:
     //context of main thread
-    void set(const std::vector<AbstractPath>& newLoad)
+    void set(const std::vector<WorkItem>& newLoad)
     {
         assert(runningOnMainThread());
         {
@@ -80,40 +356,80 @@ public:
         //condition handling, see: https://www.boost.org/doc/libs/1_43_0/doc/html/thread/synchronization.html#thread.synchronization.condvar_ref
     }
 
-    void add(const AbstractPath& filePath) //context of main thread
+    void add(const WorkItem& item) //context of main thread
     {
         assert(runningOnMainThread());
         {
             std::lock_guard dummy(lockFiles_);
-            workLoad_.emplace_back(filePath); //set as next item to retrieve
+            workLoad_.push_back(item); //set as next item to retrieve
         }
         conditionNewWork_.notify_all();
     }
 
-    //context of worker thread, blocking:
+    //context of worker thread, blocking: returns most important item whose device has an idle slot; call itemDone() when finished!
     AbstractPath extractNext() //throw ThreadStopRequest
     {
         assert(!runningOnMainThread());
         std::unique_lock dummy(lockFiles_);
 
-        interruptibleWait(conditionNewWork_, dummy, [this] { return !workLoad_.empty(); }); //throw ThreadStopRequest
+        auto itNext = workLoad_.end();
+        interruptibleWait(conditionNewWork_, dummy, [&] //throw ThreadStopRequest
+        {
+            for (auto it = workLoad_.end(); it != workLoad_.begin();)
+            {
+                --it;
+                if (std::find(itemsActive_.begin(), itemsActive_.end(), it->filePath) != itemsActive_.end())
+                    it = workLoad_.erase(it); //duplicate: already being loaded by another worker
+                else if (getActiveCount(it->filePath.afsDevice) < it->parallelOps)
+                {
+                    itNext = it;
+                    return true;
+                }
+            }
+            return false;
+        });
 
-        AbstractPath filePath = workLoad_.    back(); //yes, no strong exception guarantee (std::bad_alloc)
-        /**/                    workLoad_.pop_back(); //
+        AbstractPath filePath = itNext->filePath; //yes, no strong exception guarantee (std::bad_alloc)
+        workLoad_.erase(itNext);                  //
+        itemsActive_.push_back(filePath);         //
         return filePath;
     }
 
+    void itemDone(const AbstractPath& filePath) //context of worker thread
+    {
+        {
+            std::lock_guard dummy(lockFiles_);
+            std::erase(itemsActive_, filePath);
+        }
+        conditionNewWork_.notify_all(); //device slot available
+    }
+
 private:
+    //call while holding lock:
+    size_t getActiveCount(const AfsDevice& afsDevice) const
+    {
+        return std::count_if(itemsActive_.begin(), itemsActive_.end(), [&](const AbstractPath& ap) { return ap.afsDevice == afsDevice; });
+    }
+
     //AbstractPath is thread-safe like an int!
     std::mutex                lockFiles_;
     std::condition_variable   conditionNewWork_; //signal event: data for processing available
-    std::vector<AbstractPath> workLoad_; //processes last elements of vector first!
+    std::vector<WorkItem>     workLoad_; //processes last elements of vector first!
+    std::vector<AbstractPath> itemsActive_; //currently loading: at most one per worker thread
 };
 
 
 class Buffer
 {
 public:
+    Buffer() {}
+
+    ~Buffer()
+    {
+        for (const auto& [filePath, idata] : iconList)
+            addMemoryUsage("icon cache", -idata.bytes);
+    }
+
     //called by main and worker thread:
     bool hasIcon(const AbstractPath& filePath) const
     {
@@ -167,8 +483,12 @@ public:
         assert(rc.second); //insertion took place
         if (rc.second)
         {
-            refData(rc.first).iconHolder = std::move(ih);
+            IconData& idata = refData(rc.first);
+            idata.bytes = getMemoryUsage(ih);
+            idata.iconHolder = std::move(ih);
             priorityListPushBack(rc.first);
+
+            addMemoryUsage("icon cache", idata.bytes);
         }
     }
 
@@ -183,13 +503,28 @@ public:
         {
             auto itDelPos = firstInsertPos_;
             priorityListPopFront();
+            addMemoryUsage("icon cache", -refData(itDelPos).bytes);
             iconList.erase(itDelPos); //remove oldest element
         }
     }
 
 private:
+    Buffer           (const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+
     struct IconData;
     using FileIconMap = std::map<AbstractPath, IconData>;
+
+    //memory accounting estimate: pixel data, the same after conversion to wxImage
+    static int64_t getMemoryUsage(std::variant<ImageHolder, FileIconHolder>& ih)
+    {
+        if (ImageHolder* img = std::get_if<ImageHolder>(&ih))
+            return *img ? static_cast<int64_t>(img->getWidth()) * img->getHeight() * (img->getAlpha() ? 4 : 3) : 0;
+
+        const FileIconHolder& fih = std::get<FileIconHolder>(ih);
+        return fih ? static_cast<int64_t>(fih.maxSize) * fih.maxSize * 4 : 0; //RGB + alpha, at most maxSize x maxSize
+    }
+
     IconData& refData(FileIconMap::iterator it) { return it->second; }
 
     //call while holding lock:
@@ -252,7 +587,7 @@ private:
     struct IconData
     {
         IconData() {}
-        IconData(IconData&& tmp) noexcept : iconHolder(std::move(tmp.iconHolder)), iconFmt(std::move(tmp.iconFmt)), prev(tmp.prev), next(tmp.next) {}
+        IconData(IconData&& tmp) noexcept : iconHolder(std::move(tmp.iconHolder)), iconFmt(std::move(tmp.iconFmt)), bytes(tmp.bytes), prev(tmp.prev), next(tmp.next) {}
 
         std::variant<ImageHolder, FileIconHolder> iconHolder; //native icon representation: may be used by any thread
 
@@ -262,6 +597,8 @@ private:
         //- prohibit calls to ~wxImage() and transitively ~IconData()
         //- prohibit even wxImage() default constructor - better be safe than sorry!
 
+        int64_t bytes = 0; //memory accounting
+
         FileIconMap::iterator prev; //store list sorted by time of insertion into buffer
         FileIconMap::iterator next; //
     };
@@ -279,40 +616,58 @@ private:
 
 struct IconBuffer::Impl
 {
+    explicit Impl(const Zstring& thumbnailCacheFilePath) : thumbCache(thumbnailCacheFilePath) {}
+
     //communication channel used by threads:
-    WorkLoad workload; //manage life time: enclose InterruptibleThread's (until joined)!!!
-    Buffer   buffer;   //
+    WorkLoad       workload;   //manage life time: enclose InterruptibleThread's (until joined)!!!
+    Buffer         buffer;     //
+    ThumbnailCache thumbCache; //
 
-    InterruptibleThread worker;
+    std::vector<InterruptibleThread> workers; //started on demand: as many as the most parallel device needs
     //-------------------------
     //-------------------------
     std::map<Zstring, wxImage, LessAsciiNoCase> extensionIcons; //no item count limit!? Test case C:\ ~ 3800 unique file extensions
 };
 
 
-IconBuffer::IconBuffer(IconSize sz) : pimpl_(std::make_unique<Impl>()), iconSizeType_(sz)
+IconBuffer::IconBuffer(IconSize sz, const std::function<size_t(const AfsDevice& afsDevice)>& getDeviceParallelOps, const Zstring& thumbnailCacheFilePath) :
+    pimpl_(std::make_unique<Impl>(thumbnailCacheFilePath)),
+    iconSizeType_(sz),
+    getDeviceParallelOps_(getDeviceParallelOps)
 {
-    pimpl_->worker = InterruptibleThread([&workload = pimpl_->workload, &buffer = pimpl_->buffer, sz]
-    {
-        setCurrentThreadName(Zstr("Icon Buffer"));
-
-        for (;;)
-        {
-            //start work: blocks until next icon to load is retrieved:
-            const AbstractPath itemPath = workload.extractNext(); //throw ThreadStopRequest
-
-            if (!buffer.hasIcon(itemPath)) //perf: workload may contain duplicate entries?
-                buffer.insert(itemPath, getDisplayIcon(itemPath, sz));
-        }
-    });
+    startWorkers(1);
 }
 
 
 IconBuffer::~IconBuffer()
 {
     setWorkload({}); //make sure interruption point is always reached! needed???
-    pimpl_->worker.requestStop(); //end thread life time *before*
-    pimpl_->worker.join();      //IconBuffer::Impl member clean up!
+    for (InterruptibleThread& worker : pimpl_->workers) worker.requestStop(); //end thread life time *before*
+    for (InterruptibleThread& worker : pimpl_->workers) worker.join();        //IconBuffer::Impl member clean up!
+
+    try { pimpl_->thumbCache.save(); /*throw FileError*/ }
+    catch (FileError&) {} //it's just a cache
+}
+
+
+void IconBuffer::startWorkers(size_t parallelOps)
+{
+    assert(runningOnMainThread());
+    while (pimpl_->workers.size() < std::min(parallelOps, WORKER_COUNT_MAX))
+        pimpl_->workers.push_back(InterruptibleThread([&workload = pimpl_->workload, &buffer = pimpl_->buffer, &thumbCache = pimpl_->thumbCache, sz = iconSizeType_]
+        {
+            setCurrentThreadName(Zstr("Icon Buffer"));
+
+            for (;;)
+            {
+                //start work: blocks until next icon to load is retrieved:
+                const AbstractPath itemPath = workload.extractNext(); //throw ThreadStopRequest
+                ZEN_ON_SCOPE_EXIT(workload.itemDone(itemPath));
+
+                if (!buffer.hasIcon(itemPath)) //perf: workload may contain duplicate entries?
+                    buffer.insert(itemPath, getDisplayIcon(itemPath, sz, thumbCache));
+            }
+        }));
 }
 
 
@@ -352,7 +707,9 @@ std::optional<wxImage> IconBuffer::retrieveFileIcon(const AbstractPath& filePath
     }
 
     //since this icon seems important right now, we don't want to wait until next setWorkload() to start retrieving
-    pimpl_->workload.add(filePath);
+    const size_t parallelOps = getDeviceParallelOps_(filePath.afsDevice);
+    startWorkers(parallelOps);
+    pimpl_->workload.add({filePath, parallelOps});
     pimpl_->buffer.limitSize();
     return {};
 }
@@ -362,7 +719,20 @@ void IconBuffer::setWorkload(const std::vector<AbstractPath>& load)
 {
     assert(load.size() < BUFFER_SIZE_MAX / 2);
 
-    pimpl_->workload.set(load); //since buffer can only increase due to new workload,
+    std::vector<WorkItem> newLoad;
+    size_t parallelOpsMax = 1;
+    for (const AbstractPath& filePath : load)
+    {
+        if (newLoad.empty() || newLoad.back().filePath.afsDevice != filePath.afsDevice) //consecutive items are typically on the same device
+            newLoad.push_back({filePath, getDeviceParallelOps_(filePath.afsDevice)});
+        else
+            newLoad.push_back({filePath, newLoad.back().parallelOps});
+
+        parallelOpsMax = std::max(parallelOpsMax, newLoad.back().parallelOps);
+    }
+    startWorkers(parallelOpsMax);
+
+    pimpl_->workload.set(newLoad); //since buffer can only increase due to new workload,
     pimpl_->buffer.limitSize(); //this is the place to impose the limit from main thread!
 }
 
@@ -9,6 +9,7 @@
 
 #include <vector>
 #include <memory>
+#include <functional>
 #include <zen/zstring.h>
 #include <wx/image.h>
 #include "afs/abstract.h"
@@ -26,7 +27,9 @@ public:
         SIZE_LARGE
     };
 
-    IconBuffer(IconSize sz);
+    IconBuffer(IconSize sz,
+               const std::function<size_t(const AfsDevice& afsDevice)>& getDeviceParallelOps, //number of icons to load in parallel per device
+               const Zstring& thumbnailCacheFilePath); //optional: persist thumbnails across sessions
     ~IconBuffer();
 
     static int getSize(IconSize sz); //expected and *maximum* icon size in pixel
@@ -45,10 +48,13 @@ public:
     static wxImage minusOverlayIcon(IconSize sz);
 
 private:
+    void startWorkers(size_t parallelOps);
+
     struct Impl;
     const std::unique_ptr<Impl> pimpl_;
 
     const IconSize iconSizeType_;
+    const std::function<size_t(const AfsDevice& afsDevice)> getDeviceParallelOps_;
 };
 
 bool hasLinkExtension(const Zstring& filepath);
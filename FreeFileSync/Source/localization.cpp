@@ -10,6 +10,8 @@
 #include <map>
 #include <list>
 #include <iterator>
+#include <bit>
+#include <optional>
 #include <zen/string_tools.h>
 #include <zen/file_traverser.h>
 #include <zen/file_io.h>
@@ -32,6 +34,116 @@ using namespace fff;
 
 namespace
 {
+const int64_t PLURAL_FORM_TABLE_SIZE = 200; //cover the numbers most frequently seen in messages without evaluating the expression tree
+
+
+/*  compact, read-only translation catalog: compiled once per language selection
+    - all UTF-8 strings in a single buffer, items addressed by offset via an open-addressing hash table
+    - no per-item allocations: a fraction of the memory of std::unordered_map<std::wstring, std::wstring>   */
+class TranslationCatalog
+{
+public:
+    TranslationCatalog(const lng::TranslationMap& trans, const lng::TranslationPluralMap& transPlural)
+    {
+        for (const auto& [original, translation] : trans)
+            if (!translation.empty()) //=> fallback to original
+                addItem(original, {translation});
+
+        for (const auto& [singAndPlural, pluralForms] : transPlural)
+            if (!pluralForms.empty())
+                addItem(getPluralKey(singAndPlural.first, singAndPlural.second), pluralForms);
+
+        buffer_.shrink_to_fit();
+        items_ .shrink_to_fit();
+
+        slots_.resize(std::bit_ceil(2 * items_.size() + 1)); //load factor <= 1/2
+        const size_t mask = slots_.size() - 1;
+
+        for (size_t i = 0; i < items_.size(); ++i)
+        {
+            size_t pos = getHash(getKey(items_[i])) & mask;
+            while (slots_[pos] != 0)
+                pos = (pos + 1) & mask;
+            slots_[pos] = static_cast<uint32_t>(i + 1);
+        }
+    }
+
+    std::optional<std::string_view> find(const std::string& original) const
+    {
+        if (const Item* item = findItem(original))
+            return getValue(*item);
+        return std::nullopt;
+    }
+
+    //plural forms as '\0'-separated list
+    std::optional<std::pair<std::string_view, size_t /*form count*/>> findPlural(const std::string& singular, const std::string& plural) const
+    {
+        if (const Item* item = findItem(getPluralKey(singular, plural)))
+            return std::pair(getValue(*item), item->valueCount);
+        return std::nullopt;
+    }
+
+private:
+    struct Item
+    {
+        uint32_t keyPos     = 0;
+        uint32_t keyLen     = 0;
+        uint32_t valuePos   = 0;
+        uint32_t valueLen   = 0;
+        uint32_t valueCount = 0;
+    };
+
+    //'\0' is not part of any .lng text => plural keys never collide with regular keys
+    static std::string getPluralKey(const std::string& singular, const std::string& plural) { return singular + '\0' + plural; }
+
+    static size_t getHash(std::string_view key)
+    {
+        FNV1aHash<size_t> hash;
+        for (const char c : key)
+            hash.add(c);
+        return hash.get();
+    }
+
+    void addItem(const std::string& key, const std::vector<std::string>& values)
+    {
+        Item item;
+        item.keyPos = static_cast<uint32_t>(buffer_.size());
+        item.keyLen = static_cast<uint32_t>(key.size());
+        buffer_ += key;
+
+        item.valuePos = static_cast<uint32_t>(buffer_.size());
+        for (const std::string& val : values)
+        {
+            if (&val != &values[0])
+                buffer_ += '\0';
+            buffer_ += val;
+        }
+        item.valueLen   = static_cast<uint32_t>(buffer_.size() - item.valuePos);
+        item.valueCount = static_cast<uint32_t>(values.size());
+
+        items_.push_back(item);
+    }
+
+    const Item* findItem(std::string_view key) const
+    {
+        const size_t mask = slots_.size() - 1;
+
+        for (size_t pos = getHash(key) & mask; slots_[pos] != 0; pos = (pos + 1) & mask)
+            if (const Item& item = items_[slots_[pos] - 1];
+                getKey(item) == key)
+                return &item;
+        return nullptr;
+    }
+
+    std::string_view getKey  (const Item& item) const { return std::string_view(buffer_.data() + item.keyPos,   item.keyLen); }
+    std::string_view getValue(const Item& item) const { return std::string_view(buffer_.data() + item.valuePos, item.valueLen); }
+
+    std::string buffer_;
+    std::vector<Item> items_;
+    std::vector<uint32_t> slots_; //item index + 1; 0 if empty
+};
+
+
 class FFSTranslation : public TranslationHandler
 {
 public:
@@ -40,32 +152,35 @@ public:
     std::wstring translate(const std::wstring& text) const override
     {
         //look for translation in buffer table
-        auto it = transMapping_.find(text);
-        if (it != transMapping_.end() && !it->second.empty())
-            return it->second;
+        if (const std::optional<std::string_view> translation = catalog_->find(utfTo<std::string>(text)))
+            return utfTo<std::wstring>(*translation);
         return text; //fallback
     }
 
     std::wstring translate(const std::wstring& singular, const std::wstring& plural, int64_t n) const override
     {
-        auto it = transMappingPl_.find({singular, plural});
-        if (it != transMappingPl_.end())
+        if (const auto pluralForms = catalog_->findPlural(utfTo<std::string>(singular), utfTo<std::string>(plural)))
         {
-            const size_t formNo = pluralParser_->getForm(n);
-            assert(formNo < it->second.size());
-            if (formNo < it->second.size())
-                return replaceCpy(it->second[formNo], L"%x", formatNumber(n));
+            const auto& [forms, formCount] = *pluralForms;
+
+            const size_t formNo = std::abs(n) < PLURAL_FORM_TABLE_SIZE ? pluralFormTable_[static_cast<size_t>(std::abs(n))] : pluralParser_->getForm(n);
+            assert(formNo < formCount);
+            if (formNo < formCount)
+            {
+                std::string_view pf = forms;
+                for (size_t i = 0; i < formNo; ++i)
+                    pf = afterFirst(pf, '\0', IfNotFoundReturn::none);
+
+                return replaceCpy(utfTo<std::wstring>(beforeFirst(pf, '\0', IfNotFoundReturn::all)), L"%x", formatNumber(n));
+            }
         }
         return replaceCpy(std::abs(n) == 1 ? singular : plural, L"%x", formatNumber(n)); //fallback
     }
 
 private:
-    using Translation       = std::unordered_map<std::wstring, std::wstring>; //hash_map is 15% faster than std::map on GCC
-    using TranslationPlural = std::map<std::pair<std::wstring, std::wstring>, std::vector<std::wstring>>;
-
-    Translation       transMapping_; //map original text |-> translation
-    TranslationPlural transMappingPl_;
+    std::unique_ptr<TranslationCatalog> catalog_;
     std::unique_ptr<plural::PluralForm> pluralParser_; //bound!
+    std::vector<size_t> pluralFormTable_; //precomputed plural forms for n < PLURAL_FORM_TABLE_SIZE
 };
 
 
@@ -78,26 +193,15 @@ FFSTranslation::FFSTranslation(const std::string& lngStream) //throw lng::Parsin
 
     pluralParser_ = std::make_unique<plural::PluralForm>(header.pluralDefinition); //throw plural::ParsingError
 
-    for (const auto& [original, translation] : transUtf)
-        transMapping_.emplace(utfTo<std::wstring>(original),
-                              utfTo<std::wstring>(translation));
+    for (int64_t n = 0; n < PLURAL_FORM_TABLE_SIZE; ++n)
+        pluralFormTable_.push_back(pluralParser_->getForm(n));
 
-    for (const auto& [singAndPlural, pluralForms] : transPluralUtf)
-    {
-        std::vector<std::wstring> transPluralForms;
-        for (const std::string& pf : pluralForms)
-            transPluralForms.push_back(utfTo<std::wstring>(pf));
-
-        transMappingPl_.insert({{
-                utfTo<std::wstring>(singAndPlural.first),
-                utfTo<std::wstring>(singAndPlural.second)
-            },
-            std::move(transPluralForms)});
-    }
+    catalog_ = std::make_unique<TranslationCatalog>(transUtf, transPluralUtf);
 }
 
 
-std::vector<TranslationInfo> loadTranslations(const Zstring& zipPath) //throw FileError
+//fileName empty: load all .lng files
+std::vector<std::pair<Zstring /*file name*/, std::string /*byte stream*/>> loadLngFiles(const Zstring& zipPath, const Zstring& fileName) //throw FileError
 {
     std::vector<std::pair<Zstring /*file name*/, std::string /*byte stream*/>> streams;
 
@@ -108,11 +212,15 @@ std::vector<TranslationInfo> loadTranslations(const Zstring& zipPath) //throw Fi
         wxZipInputStream zipStream(memStream, wxConvUTF8);
 
         while (const auto& entry = std::unique_ptr<wxZipEntry>(zipStream.GetNextEntry())) //take ownership!
-            if (std::string stream(entry->GetSize(), '\0');
-                zipStream.ReadAll(stream.data(), stream.size()))
-                streams.emplace_back(utfTo<Zstring>(entry->GetName()), std::move(stream));
-            else
-                assert(false);
+            if (const Zstring entryName = utfTo<Zstring>(entry->GetName());
+                fileName.empty() || entryName == fileName)
+            {
+                if (std::string stream(entry->GetSize(), '\0');
+                    zipStream.ReadAll(stream.data(), stream.size()))
+                    streams.emplace_back(entryName, std::move(stream));
+                else
+                    assert(false);
+            }
     }
     catch (FileError&) //fall back to folder
     {
@@ -120,7 +228,7 @@ std::vector<TranslationInfo> loadTranslations(const Zstring& zipPath) //throw Fi
         if (dirAvailable(fallbackFolder)) //Debug build (only!?)
             traverseFolder(fallbackFolder, [&](const FileInfo& fi)
         {
-            if (endsWith(fi.fullPath, Zstr(".lng")))
+            if (endsWith(fi.fullPath, Zstr(".lng")) && (fileName.empty() || fi.itemName == fileName))
             {
                 std::string stream = getFileContent(fi.fullPath, nullptr /*notifyUnbufferedIO*/); //throw FileError
                 streams.emplace_back(fi.itemName, std::move(stream));
@@ -129,8 +237,12 @@ std::vector<TranslationInfo> loadTranslations(const Zstring& zipPath) //throw Fi
         else
             throw;
     }
-    //--------------------------------------------------------------------
+    return streams;
+}
+
 
+std::vector<TranslationInfo> loadTranslations(const Zstring& zipPath) //throw FileError
+{
     std::vector<TranslationInfo> locMapping;
     {
         //default entry:
@@ -140,11 +252,11 @@ std::vector<TranslationInfo> loadTranslations(const Zstring& zipPath) //throw Fi
         newEntry.translatorName = L"Zenju";
         newEntry.languageFlag   = "flag_usa";
         newEntry.lngFileName    = Zstr("");
-        newEntry.lngStream      = "";
         locMapping.push_back(newEntry);
     }
 
-    for (/*const*/ auto& [fileName, stream] : streams)
+    //don't keep the .lng streams of all languages in memory: only the selected one is (re-)loaded by setLanguage()
+    for (const auto& [fileName, stream] : loadLngFiles(zipPath, Zstring())) //throw FileError
         try
         {
             const lng::TransHeader lngHeader = lng::parseHeader(stream); //throw ParsingError
@@ -168,7 +280,6 @@ std::vector<TranslationInfo> loadTranslations(const Zstring& zipPath) //throw Fi
                 newEntry.translatorName = utfTo<std::wstring>(lngHeader.translatorName);
                 newEntry.languageFlag   = lngHeader.flagFile;
                 newEntry.lngFileName    = fileName;
-                newEntry.lngStream      = std::move(stream);
                 locMapping.push_back(newEntry);
             }
             else assert(false);
@@ -477,6 +588,7 @@ private:
 
 
 std::vector<TranslationInfo> globalTranslations;
+Zstring globalLngZipPath;
 }
 
 
@@ -491,6 +603,7 @@ void fff::localizationInit(const Zstring& zipPath) //throw FileError
 {
     assert(globalTranslations.empty());
     globalTranslations = loadTranslations(zipPath); //throw FileError
+    globalLngZipPath = zipPath;
     setLanguage(getDefaultLanguage()); //throw FileError
 }
 
@@ -501,6 +614,7 @@ void fff::localizationCleanup()
     ZenLocale::getInstance().tearDown();
     setTranslator(nullptr); //good place for clean up rather than some time during static destruction: is this an actual benefit???
     globalTranslations.clear();
+    globalLngZipPath.clear();
 }
 
 
@@ -510,19 +624,17 @@ void fff::setLanguage(wxLanguage lng) //throw FileError
         return; //support polling
 
     //(try to) retrieve language file
-    std::string lngStream;
     Zstring lngFileName;
 
     for (const TranslationInfo& e : getAvailableTranslations())
         if (e.languageID == lng)
         {
-            lngStream   = e.lngStream;
             lngFileName = e.lngFileName;
             break;
         }
 
     //load language file into buffer
-    if (lngStream.empty()) //if file stream is empty, texts will be English by default
+    if (lngFileName.empty()) //if no file is available, texts will be English by default
     {
         setTranslator(nullptr);
         lng = wxLANGUAGE_ENGLISH_US;
@@ -530,7 +642,11 @@ void fff::setLanguage(wxLanguage lng) //throw FileError
     else
         try
         {
-            setTranslator(std::make_unique<FFSTranslation>(lngStream)); //throw lng::ParsingError, plural::ParsingError
+            const auto& streams = loadLngFiles(globalLngZipPath, lngFileName); //throw FileError
+            if (streams.empty())
+                throw FileError(replaceCpy(_("Cannot open file %x."), L"%x", fmtPath(lngFileName))); //removed after localizationInit()!?
+
+            setTranslator(std::make_unique<FFSTranslation>(streams[0].second)); //throw lng::ParsingError, plural::ParsingError
         }
         catch (lng::ParsingError& e)
         {
@@ -8,6 +8,7 @@
 #include <zen/file_io.h>
 #include <zen/http.h>
 #include <zen/sys_info.h>
+#include <zen/zlib_wrap.h>
 #include <wx/datetime.h>
 #include "ffs_paths.h"
 #include "afs/concrete.h"
@@ -62,6 +63,9 @@ std::string generateLogHeaderTxt(const ProcessSummary& s, const ErrorLog& log, i
     const int64_t totalTimeSec = std::chrono::duration_cast<std::chrono::seconds>(s.totalTime).count();
     summary.push_back(tabSpace + utfTo<std::string>(_("Total time:")) + ' ' + utfTo<std::string>(wxTimeSpan::Seconds(totalTimeSec).Format()));
 
+    if (s.peakMemoryBytes >= 0)
+        summary.push_back(tabSpace + utfTo<std::string>(_("Peak memory:") + L' ' + formatFilesizeShort(s.peakMemoryBytes)));
+
     size_t sepLineLen = 0; //calculate max width (considering Unicode!)
     for (const std::string& str : summary) sepLineLen = std::max(sepLineLen, unicodeLength(str));
 
@@ -81,14 +85,13 @@ std::string generateLogHeaderTxt(const ProcessSummary& s, const ErrorLog& log, i
         output += std::string(SEPARATION_LINE_LEN, '_') + '\n';
 
         int previewCount = 0;
-        if (logPreviewFailsMax > 0)
-            for (const LogEntry& entry : log)
-                if (entry.type & (MSG_TYPE_WARNING | MSG_TYPE_ERROR))
-                {
-                    output += utfTo<std::string>(formatMessage(entry));
-                    if (++previewCount >= logPreviewFailsMax)
-                        break;
-                }
+        if (logPreviewFailsMax > 0) //use log index: don't scan (possibly millions of) info messages
+            for (const ErrorLog::EntryRef& ref : log.getEntryRefs(MSG_TYPE_WARNING | MSG_TYPE_ERROR, logPreviewFailsMax))
+            {
+                const LogEntry& entry = log.getEntry(ref.pos);
+                output += utfTo<std::string>(formatMessage(entry));
+                ++previewCount;
+            }
         if (logFailTotal > previewCount)
             output += "  [...]  " + utfTo<std::string>(replaceCpy(_P("Showing %y of 1 item", "Showing %y of %x items", logFailTotal), //%x used as plural form placeholder!
                                                                   L"%y", formatNumber(previewCount))) + '\n';
@@ -288,7 +291,17 @@ std::string generateLogHeaderHtml(const ProcessSummary& s, const ErrorLog& log,
                 <td>)" + htmlTxt(_("Total time:")) + R"(</td>
                 <td><img src="https://freefilesync.org/images/log/clock.png" width="24" height="24" alt=""></td>
                 <td><span style="font-weight: 600;">)" + htmlTxt(wxTimeSpan::Seconds(totalTimeSec).Format()) + R"(</span></td>
-            </tr>
+            </tr>)";
+
+    if (s.peakMemoryBytes >= 0)
+        output += R"(
+            <tr>
+                <td>)" + htmlTxt(_("Peak memory:")) + R"(</td>
+                <td></td>
+                <td><span style="font-weight: 600;">)" + htmlTxt(formatFilesizeShort(s.peakMemoryBytes)) + R"(</span></td>
+            </tr>)";
+
+    output += R"(
         </table>
     </div>
 )";
@@ -303,14 +316,13 @@ std::string generateLogHeaderHtml(const ProcessSummary& s, const ErrorLog& log,
     <table class="log-items" style="line-height:1em; border-spacing:0;">
 )";
         int previewCount = 0;
-        if (logPreviewFailsMax > 0)
-            for (const LogEntry& entry : log)
-                if (entry.type & (MSG_TYPE_WARNING | MSG_TYPE_ERROR))
-                {
-                    output += formatMessageHtml(entry);
-                    if (++previewCount >= logPreviewFailsMax)
-                        break;
-                }
+        if (logPreviewFailsMax > 0) //use log index: don't scan (possibly millions of) info messages
+            for (const ErrorLog::EntryRef& ref : log.getEntryRefs(MSG_TYPE_WARNING | MSG_TYPE_ERROR, logPreviewFailsMax))
+            {
+                const LogEntry& entry = log.getEntry(ref.pos);
+                output += formatMessageHtml(entry);
+                ++previewCount;
+            }
         output += R"(	</table>
 )";
         if (logFailTotal > previewCount)
@@ -369,37 +381,69 @@ std::string generateLogFooterHtml(const std::wstring& logFilePath /*optional*/,
 //-> Astyle fucks up! => no INDENT-ON
 
 
-void streamToLogFile(const ProcessSummary& summary, //throw FileError
-                     const ErrorLog& log,
-                     AFS::OutputStream& streamOut,
-                     LogFileFormat logFormat)
+//generate log file content on the fly: don't hold formatted log entries in memory (think 1 million entries!)
+//=> entries spilled to disk by ErrorLog are loaded chunk-wise while streaming
+class LogFileContentStream
 {
-    const int logItemsTotal = log.end() - log.begin();
-    const int logPreviewItemsMax = std::numeric_limits<int>::max();
-
-    std::string buffer = logFormat == LogFileFormat::html ? 
-                         generateLogHeaderHtml(summary, log, LOG_PREVIEW_FAIL_MAX) :
-                         generateLogHeaderTxt (summary, log, LOG_PREVIEW_FAIL_MAX);
-
-    //write log items in blocks instead of creating one big string: memory allocation might fail; think 1 million entries!
-    for (const LogEntry& entry : log)
+public:
+    LogFileContentStream(const ProcessSummary& summary, const ErrorLog& log, LogFileFormat logFormat) :
+        log_(log),
+        logFormat_(logFormat),
+        logIt_(log.begin()),
+        buffer_(logFormat == LogFileFormat::html ?
+                generateLogHeaderHtml(summary, log, LOG_PREVIEW_FAIL_MAX) :
+                generateLogHeaderTxt (summary, log, LOG_PREVIEW_FAIL_MAX)) {}
+
+    size_t read(void* buffer, size_t bytesToRead) //throw FileError; return "bytesToRead" bytes unless end of stream!
     {
-        buffer += logFormat == LogFileFormat::html ?
-                  formatMessageHtml(entry) :
-                  formatMessage    (entry);
+        if (bufPos_ > 0 && buffer_.size() - bufPos_ < bytesToRead)
+        {
+            buffer_.erase(0, bufPos_);
+            bufPos_ = 0;
+        }
+
+        while (buffer_.size() < bytesToRead && !footerWritten_)
+            if (logIt_ != log_.end())
+            {
+                buffer_ += logFormat_ == LogFileFormat::html ?
+                           formatMessageHtml(*logIt_) :
+                           formatMessage    (*logIt_);
+                ++logIt_;
+            }
+            else
+            {
+                const int logItemsTotal = static_cast<int>(log_.size());
+                const int logPreviewItemsMax = std::numeric_limits<int>::max();
+
+                buffer_ += logFormat_ == LogFileFormat::html ?
+                           generateLogFooterHtml(std::wstring() /*logFilePath*/, logItemsTotal, logPreviewItemsMax) : //throw FileError
+                           generateLogFooterTxt (std::wstring() /*logFilePath*/, logItemsTotal, logPreviewItemsMax);  //throw FileError
+                //=> log file path is irrelevant, except when sending email!
+                footerWritten_ = true;
+            }
 
-        streamOut.write(&buffer[0], buffer.size()); //throw FileError, X
-        buffer.clear();
+        const size_t bytesRead = std::min(bytesToRead, buffer_.size() - bufPos_);
+        std::memcpy(buffer, buffer_.data() + bufPos_, bytesRead);
+        bufPos_ += bytesRead;
+        return bytesRead;
     }
 
-    buffer += logFormat == LogFileFormat::html ? 
-              generateLogFooterHtml(std::wstring() /*logFilePath*/, logItemsTotal, logPreviewItemsMax) : //throw FileError
-              generateLogFooterTxt (std::wstring() /*logFilePath*/, logItemsTotal, logPreviewItemsMax);  //throw FileError
-    //=> log file path is irrelevant, except when sending email!
+private:
+    LogFileContentStream           (const LogFileContentStream&) = delete;
+    LogFileContentStream& operator=(const LogFileContentStream&) = delete;
 
-    //don't forget to flush:
-    streamOut.write(&buffer[0], buffer.size()); //throw FileError, X
-}
+    const ErrorLog& log_;
+    const LogFileFormat logFormat_;
+    ErrorLog::const_iterator logIt_;
+    bool footerWritten_ = false;
+
+    std::string buffer_;
+    size_t bufPos_ = 0;
+};
+
+
+const size_t LOG_FILE_BLOCK_SIZE = 128 * 1024;
+const Zchar LOG_FILE_GZIP_EXT[] = Zstr(".gz");
 
 
 void saveNewLogFile(const AbstractPath& logFilePath, //throw FileError, X
@@ -431,8 +475,33 @@ void saveNewLogFile(const AbstractPath& logFilePath, //throw FileError, X
 
     //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
     std::unique_ptr<AFS::OutputStream> logFileStream = AFS::getOutputStream(logFilePath, std::nullopt /*streamSize*/, std::nullopt /*modTime*/, notifyUnbufferedIO); //throw FileError
-    streamToLogFile(summary, log, *logFileStream, logFormat); //throw FileError, X
-    logFileStream->finalize();                                //throw FileError, X
+
+    LogFileContentStream contentStream(summary, log, logFormat);
+    std::string buffer(LOG_FILE_BLOCK_SIZE, '\0');
+
+    if (endsWith(AFS::getItemName(logFilePath), LOG_FILE_GZIP_EXT))
+        try
+        {
+            InputStreamAsGzip gzipStream([&](void* buf, size_t bytesToRead) { return contentStream.read(buf, bytesToRead); }); //throw SysError
+            for (;;)
+            {
+                const size_t bytesRead = gzipStream.read(buffer.data(), buffer.size()); //throw SysError, FileError
+                logFileStream->write(buffer.data(), bytesRead); //throw FileError, X
+                if (bytesRead < buffer.size()) //end of stream
+                    break;
+            }
+        }
+        catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(AFS::getDisplayPath(logFilePath))), e.toString()); }
+    else
+        for (;;)
+        {
+            const size_t bytesRead = contentStream.read(buffer.data(), buffer.size()); //throw FileError
+            logFileStream->write(buffer.data(), bytesRead); //throw FileError, X
+            if (bytesRead < buffer.size()) //end of stream
+                break;
+        }
+
+    logFileStream->finalize(); //throw FileError, X
 }
 
 
@@ -447,49 +516,62 @@ struct LogFileInfo
     time_t       timeStamp;
     std::wstring jobNames; //may be empty
 };
-std::vector<LogFileInfo> getLogFiles(const AbstractPath& logFolderPath) //throw FileError
+std::optional<LogFileInfo> parseLogFileName(const AbstractPath& logFolderPath, const Zstring& fileName)
 {
-    std::vector<LogFileInfo> logfiles;
+    //"Backup FreeFileSync 2013-09-15 015052.123.html"
+    //"Jobname1 + Jobname2 2013-09-15 015052.123.log"
+    //"2013-09-15 015052.123 [Error].log"
+    //"2013-09-15 015052.123 [Error].log.gz"
+    static_assert(TIME_STAMP_LENGTH == 21);
 
-    AFS::traverseFolderFlat(logFolderPath, [&](const AFS::FileInfo& fi) //throw FileError
-    {
-        //"Backup FreeFileSync 2013-09-15 015052.123.html"
-        //"Jobname1 + Jobname2 2013-09-15 015052.123.log"
-        //"2013-09-15 015052.123 [Error].log"
-        static_assert(TIME_STAMP_LENGTH == 21);
+    Zstring itemName = fileName;
+    if (endsWith(itemName, LOG_FILE_GZIP_EXT))
+        itemName.resize(itemName.size() - strLength(LOG_FILE_GZIP_EXT));
 
-        if (endsWith(fi.itemName, Zstr(".log")) || //case-sensitive: e.g. ".LOG" is not from FFS, right?
-            endsWith(fi.itemName, Zstr(".html")))
+    if (endsWith(itemName, Zstr(".log")) || //case-sensitive: e.g. ".LOG" is not from FFS, right?
+        endsWith(itemName, Zstr(".html")))
+    {
+        auto tsBegin = itemName.begin();
+        auto tsEnd   = tsBegin + itemName.rfind('.');
+
+        if (tsBegin != tsEnd && tsEnd[-1] == STATUS_END_TOKEN)
+            tsEnd = searchLast(tsBegin, tsEnd,
+                               std::begin(STATUS_BEGIN_TOKEN), std::end(STATUS_BEGIN_TOKEN) - 1);
+
+        if (tsEnd - tsBegin >= TIME_STAMP_LENGTH &&
+            tsEnd[-4] == Zstr('.') &&
+            isdigit(tsEnd[-3]) &&
+            isdigit(tsEnd[-2]) &&
+            isdigit(tsEnd[-1]))
         {
-            auto tsBegin = fi.itemName.begin();
-            auto tsEnd   = tsBegin + fi.itemName.rfind('.');
-
-            if (tsBegin != tsEnd && tsEnd[-1] == STATUS_END_TOKEN)
-                tsEnd = searchLast(tsBegin, tsEnd,
-                                   std::begin(STATUS_BEGIN_TOKEN), std::end(STATUS_BEGIN_TOKEN) - 1);
-
-            if (tsEnd - tsBegin >= TIME_STAMP_LENGTH &&
-                tsEnd[-4] == Zstr('.') &&
-                isdigit(tsEnd[-3]) &&
-                isdigit(tsEnd[-2]) &&
-                isdigit(tsEnd[-1]))
+            tsBegin = tsEnd - TIME_STAMP_LENGTH;
+            const TimeComp tc = parseTime(Zstr("%Y-%m-%d %H%M%S"), makeStringView(tsBegin, 17)); //returns TimeComp() on error
+            const time_t t = localToTimeT(tc); //returns -1 on error
+            if (t != -1)
             {
-                tsBegin = tsEnd - TIME_STAMP_LENGTH;
-                const TimeComp tc = parseTime(Zstr("%Y-%m-%d %H%M%S"), makeStringView(tsBegin, 17)); //returns TimeComp() on error
-                const time_t t = localToTimeT(tc); //returns -1 on error
-                if (t != -1)
+                Zstring jobNames(itemName.begin(), tsBegin);
+                if (!jobNames.empty())
                 {
-                    Zstring jobNames(fi.itemName.begin(), tsBegin);
-                    if (!jobNames.empty())
-                    {
-                        assert(jobNames.size() >= 2 && endsWith(jobNames, Zstr(' ')));
-                        jobNames.pop_back();
-                    }
-
-                    logfiles.push_back({AFS::appendRelPath(logFolderPath, fi.itemName), t, utfTo<std::wstring>(jobNames)});
+                    assert(jobNames.size() >= 2 && endsWith(jobNames, Zstr(' ')));
+                    jobNames.pop_back();
                 }
+
+                return LogFileInfo{AFS::appendRelPath(logFolderPath, fileName), t, utfTo<std::wstring>(jobNames)};
             }
         }
+    }
+    return std::nullopt;
+}
+
+
+std::vector<LogFileInfo> getLogFiles(const AbstractPath& logFolderPath) //throw FileError
+{
+    std::vector<LogFileInfo> logfiles;
+
+    AFS::traverseFolderFlat(logFolderPath, [&](const AFS::FileInfo& fi) //throw FileError
+    {
+        if (std::optional<LogFileInfo> lfi = parseLogFileName(logFolderPath, fi.itemName))
+            logfiles.push_back(std::move(*lfi));
     },
     nullptr /*onFolder*/, //traverse only one level deep
     nullptr /*onSymlink*/);
@@ -498,7 +580,92 @@ std::vector<LogFileInfo> getLogFiles(const AbstractPath& logFolderPath) //throw
 }
 
 
+/*  log retention index: names of log files within the log folder => no need to traverse the (possibly remote) log folder each time
+    - full folder scan only if index is missing/corrupted or after LOG_INDEX_RESCAN_DAYS: pick up log files we don't know about
+      (written by old versions, other FreeFileSync instances, copied by user)
+    - index is just an optimization: log files deleted by user are ignored during clean up         */
+const char LOG_INDEX_FILE_DESCR[] = "FreeFileSync";
+const int  LOG_INDEX_FILE_VERSION = 1; //2026-10-14
+const Zchar LOG_INDEX_FILE_NAME[] = Zstr("LogFiles.ffs_db");
+const int LOG_INDEX_RESCAN_DAYS = 7;
+
+struct LogIndex
+{
+    time_t lastFullScan = 0;
+    std::vector<Zstring> logFileNames;
+};
+
+
+LogIndex loadLogIndex(const AbstractPath& indexFilePath) //throw FileError
+{
+    std::string byteStream;
+    try
+    {
+        const std::unique_ptr<AFS::InputStream> fileStreamIn = AFS::getInputStream(indexFilePath, nullptr /*notifyUnbufferedIO*/); //throw FileError, ErrorFileLocked
+        byteStream = bufferedLoad<std::string>(*fileStreamIn); //throw FileError, ErrorFileLocked
+    }
+    catch (FileError&)
+    {
+        if (AFS::itemStillExists(indexFilePath)) //throw FileError
+            throw;
+        return {}; //=> full scan
+    }
+
+    try
+    {
+        MemoryStreamIn streamIn(byteStream);
+
+        char tmp[sizeof(LOG_INDEX_FILE_DESCR)] = {};
+        readArray(streamIn, &tmp, sizeof(tmp)); //throw SysErrorUnexpectedEos
+
+        if (!std::equal(std::begin(tmp), std::end(tmp), std::begin(LOG_INDEX_FILE_DESCR)))
+            throw SysError(_("File content is corrupted.") + L" (invalid header)");
+
+        const int version = readNumber<int32_t>(streamIn); //throw SysErrorUnexpectedEos
+        if (version != LOG_INDEX_FILE_VERSION)
+            throw SysError(_("Unsupported data format.") + L' ' + replaceCpy(_("Version: %x"), L"%x", numberTo<std::wstring>(version)));
+
+        LogIndex index;
+        index.lastFullScan = readNumber<int64_t>(streamIn); //throw SysErrorUnexpectedEos
+
+        size_t fileCount = readNumber<uint32_t>(streamIn); //throw SysErrorUnexpectedEos
+        while (fileCount-- != 0)
+            index.logFileNames.push_back(utfTo<Zstring>(readContainer<std::string>(streamIn))); //throw SysErrorUnexpectedEos
+
+        return index;
+    }
+    catch (const SysError& e)
+    {
+        throw FileError(replaceCpy(_("Cannot read database file %x."), L"%x", fmtPath(AFS::getDisplayPath(indexFilePath))), e.toString());
+    }
+}
+
+
+void saveLogIndex(const AbstractPath& indexFilePath, const LogIndex& index) //throw FileError
+{
+    MemoryStreamOut<std::string> streamOut;
+    writeArray(streamOut, LOG_INDEX_FILE_DESCR, sizeof(LOG_INDEX_FILE_DESCR));
+    writeNumber<int32_t>(streamOut, LOG_INDEX_FILE_VERSION);
+
+    writeNumber<int64_t>(streamOut, index.lastFullScan);
+
+    writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(index.logFileNames.size()));
+    for (const Zstring& fileName : index.logFileNames)
+        writeContainer(streamOut, utfTo<std::string>(fileName));
+
+    AFS::removeFileIfExists(indexFilePath); //throw FileError
+    //already existing: undefined behavior! (e.g. fail/overwrite/auto-rename)
+    const std::unique_ptr<AFS::OutputStream> fileStreamOut = AFS::getOutputStream(indexFilePath, //throw FileError
+                                                                                  streamOut.ref().size(),
+                                                                                  std::nullopt /*modTime*/,
+                                                                                  nullptr /*notifyUnbufferedIO*/);
+    fileStreamOut->write(streamOut.ref().c_str(), streamOut.ref().size()); //throw FileError
+    fileStreamOut->finalize();                                             //throw FileError
+}
+
+
 void limitLogfileCount(const AbstractPath& logFolderPath, //throw FileError, X
+                       const Zstring& newLogFileName,
                        int logfilesMaxAgeDays, //<= 0 := no limit
                        const std::set<AbstractPath>& logFilePathsToKeep,
                        const std::function<void(std::wstring&& msg)>& notifyStatus /*throw X*/)
@@ -509,7 +676,33 @@ void limitLogfileCount(const AbstractPath& logFolderPath, //throw FileError, X
 
         if (notifyStatus) notifyStatus(statusPrefix + fmtPath(AFS::getDisplayPath(logFolderPath))); //throw X
 
-        std::vector<LogFileInfo> logFiles = getLogFiles(logFolderPath); //throw FileError
+        const AbstractPath indexFilePath = AFS::appendRelPath(logFolderPath, LOG_INDEX_FILE_NAME);
+        const time_t now = std::time(nullptr);
+
+        LogIndex index;
+        try
+        {
+            index = loadLogIndex(indexFilePath); //throw FileError
+        }
+        catch (FileError&) {} //corrupted index => start from scratch
+
+        std::vector<LogFileInfo> logFiles;
+        if (index.lastFullScan <= now - LOG_INDEX_RESCAN_DAYS * 24 * 3600 ||
+            index.lastFullScan > now) //clock changed?
+        {
+            logFiles = getLogFiles(logFolderPath); //throw FileError
+            index.lastFullScan = now;
+        }
+        else
+        {
+            for (const Zstring& fileName : index.logFileNames)
+                if (std::optional<LogFileInfo> lfi = parseLogFileName(logFolderPath, fileName))
+                    logFiles.push_back(std::move(*lfi));
+
+            if (std::optional<LogFileInfo> lfi = parseLogFileName(logFolderPath, newLogFileName))
+                if (std::none_of(logFiles.begin(), logFiles.end(), [&](const LogFileInfo& lfi2) { return lfi2.filePath == lfi->filePath; }))
+                    logFiles.push_back(std::move(*lfi));
+        }
 
         const time_t lastMidnightTime = []
         {
@@ -523,6 +716,7 @@ void limitLogfileCount(const AbstractPath& logFolderPath, //throw FileError, X
 
         std::exception_ptr firstError;
 
+        index.logFileNames.clear();
         for (const LogFileInfo& lfi : logFiles)
             if (lfi.timeStamp < cutOffTime &&
                 !logFilePathsToKeep.contains(lfi.filePath)) //don't trim latest log files corresponding to last used config files!
@@ -531,10 +725,22 @@ void limitLogfileCount(const AbstractPath& logFolderPath, //throw FileError, X
                 if (notifyStatus) notifyStatus(statusPrefix + fmtPath(AFS::getDisplayPath(lfi.filePath))); //throw X
                 try
                 {
-                    AFS::removeFilePlain(lfi.filePath); //throw FileError
+                    AFS::removeFileIfExists(lfi.filePath); //throw FileError
+                }
+                catch (const FileError&)
+                {
+                    if (!firstError) firstError = std::current_exception();
+                    index.logFileNames.push_back(AFS::getItemName(lfi.filePath)); //retry next time
                 }
-                catch (const FileError&) { if (!firstError) firstError = std::current_exception(); };
             }
+            else
+                index.logFileNames.push_back(AFS::getItemName(lfi.filePath));
+
+        try
+        {
+            saveLogIndex(indexFilePath, index); //throw FileError
+        }
+        catch (const FileError&) { if (!firstError) firstError = std::current_exception(); };
 
         if (firstError) //late failure!
             std::rethrow_exception(firstError);
@@ -549,7 +755,7 @@ Zstring fff::getLogFolderDefaultPath() { return getConfigDirPathPf() + Zstr("Log
 //"Backup FreeFileSync 2013-09-15 015052.123.html"
 //"Backup FreeFileSync 2013-09-15 015052.123 [Error].html"
 //"Backup FreeFileSync + RealTimeSync 2013-09-15 015052.123 [Error].log"
-AbstractPath fff::generateLogFilePath(LogFileFormat logFormat, const ProcessSummary& summary, const Zstring& altLogFolderPathPhrase /*optional*/)
+AbstractPath fff::generateLogFilePath(LogFileFormat logFormat, bool logFileGzip, const ProcessSummary& summary, const Zstring& altLogFolderPathPhrase /*optional*/)
 {
     //const std::string colon = "\xcb\xb8"; //="modifier letter raised colon" => regular colon is forbidden in file names on Windows and OS X
     //=> too many issues, most notably cmd.exe is not Unicode-aware: https://freefilesync.org/forum/viewtopic.php?t=1679
@@ -606,6 +812,9 @@ AbstractPath fff::generateLogFilePath(LogFileFormat logFormat, const ProcessSumm
     else
         logFileName += Zstr(".log");
 
+    if (logFileGzip)
+        logFileName += LOG_FILE_GZIP_EXT;
+
     AbstractPath logFolderPath = createAbstractPath(altLogFolderPathPhrase);
     if (AFS::isNullPath(logFolderPath))
         logFolderPath = createAbstractPath(getLogFolderDefaultPath());
@@ -634,7 +843,7 @@ void fff::saveLogFile(const AbstractPath& logFilePath, //throw FileError, X
         const std::optional<AbstractPath> logFolderPath = AFS::getParentPath(logFilePath);
         assert(logFolderPath);
         if (logFolderPath) //else: logFilePath == device root; not possible with generateLogFilePath()
-            limitLogfileCount(*logFolderPath, logfilesMaxAgeDays, logFilePathsToKeep, notifyStatus); //throw FileError, X
+            limitLogfileCount(*logFolderPath, AFS::getItemName(logFilePath), logfilesMaxAgeDays, logFilePathsToKeep, notifyStatus); //throw FileError, X
     }
     catch (const FileError&) { if (!firstError) firstError = std::current_exception(); };
 
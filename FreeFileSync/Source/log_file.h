@@ -24,8 +24,9 @@ enum class LogFileFormat
     text
 };
 
-AbstractPath generateLogFilePath(LogFileFormat logFormat, const ProcessSummary& summary, const Zstring& altLogFolderPathPhrase /*optional*/);
+AbstractPath generateLogFilePath(LogFileFormat logFormat, bool logFileGzip, const ProcessSummary& summary, const Zstring& altLogFolderPathPhrase /*optional*/);
 
+//log file is gzip-compressed if logFilePath ends with ".gz" (see generateLogFilePath())
 void saveLogFile(const AbstractPath& logFilePath, //throw FileError, X
                  const ProcessSummary& summary,
                  const zen::ErrorLog& log,
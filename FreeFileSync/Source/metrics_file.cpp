@@ -0,0 +1,442 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#include "metrics_file.h"
+#include <zen/file_io.h>
+#include <zen/format_unit.h>
+#include <zen/json.h>
+#include <zen/perf.h>
+#include <zen/thread.h>
+    #include <sys/resource.h> //getrusage
+
+using namespace zen;
+using namespace fff;
+
+
+namespace
+{
+struct DeviceThroughput
+{
+    int64_t items = 0;
+    int64_t bytes = 0;
+    std::chrono::microseconds copyTime{};
+    int64_t bytesRead    = 0; //all AFS input/output streams, not only file copy
+    int64_t bytesWritten = 0; //
+};
+
+struct NumaNodeMetrics
+{
+    int64_t threadsPinned = 0;
+    std::map<std::string /*device*/, int64_t> devicePools; //worker pools assigned to this node
+};
+
+struct PhaseMetrics
+{
+    std::string name;
+    std::chrono::milliseconds duration{};
+    int64_t peakMemoryBytes = -1; //-1 if not measured
+};
+
+struct RunMetrics
+{
+    std::vector<PhaseMetrics> phaseTimes; //phases may repeat, e.g. multiple compare runs
+    std::vector<SpanStats> spanStats;
+    std::map<std::string, DeviceThroughput> devices;
+    int64_t retries = 0;
+    int64_t peakMemoryBytes = -1; //-1 if not available
+    std::vector<MemoryUsage> memory; //per subsystem
+    size_t numaNodeCount = 0; //0 if NUMA affinity is disabled
+    std::map<std::string /*node*/, NumaNodeMetrics> numaNodes;
+};
+
+
+const char* getPhaseName(ProcessPhase phase)
+{
+    switch (phase)
+    {
+        //*INDENT-OFF*
+        case ProcessPhase::none:             return "init";
+        case ProcessPhase::scanning:         return "scan";
+        case ProcessPhase::comparingContent: return "compare";
+        case ProcessPhase::synchronizing:    return "sync";
+        //*INDENT-ON*
+    }
+    assert(false);
+    return "unknown";
+}
+
+
+const char* getResultName(SyncResult result)
+{
+    switch (result)
+    {
+        //*INDENT-OFF*
+        case SyncResult::finishedSuccess: return "success";
+        case SyncResult::finishedWarning: return "warning";
+        case SyncResult::finishedError:   return "error";
+        case SyncResult::aborted:         return "aborted";
+        //*INDENT-ON*
+    }
+    assert(false);
+    return "unknown";
+}
+
+
+bool isEmptyInitPhase(const PhaseTime& pt) { return pt.phase == ProcessPhase::none && pt.duration.count() == 0; } //e.g. consecutive runs
+
+
+RunMetrics getRunMetrics(const std::vector<PhaseTime>& phaseTimes)
+{
+    RunMetrics rm;
+
+    for (const PhaseTime& pt : phaseTimes)
+        if (!isEmptyInitPhase(pt))
+            rm.phaseTimes.push_back({getPhaseName(pt.phase), pt.duration, pt.peakMemoryBytes});
+
+    rm.spanStats = getSpanStats();
+
+    for (const MetricCount& mc : getMetricCounts())
+        if (mc.name == "items copied")
+            rm.devices[mc.label].items += mc.value;
+        else if (mc.name == "bytes copied")
+            rm.devices[mc.label].bytes += mc.value;
+        else if (mc.name == "copy time us")
+            rm.devices[mc.label].copyTime += std::chrono::microseconds(mc.value);
+        else if (mc.name == "bytes read")
+            rm.devices[mc.label].bytesRead += mc.value;
+        else if (mc.name == "bytes written")
+            rm.devices[mc.label].bytesWritten += mc.value;
+        else if (mc.name == "retries")
+            rm.retries += mc.value;
+        else if (mc.name == "numa threads pinned")
+            rm.numaNodes[mc.label].threadsPinned += mc.value;
+        else if (mc.name == "numa device pools") //label: "<node>\t<device>"
+            rm.numaNodes[beforeFirst(mc.label, '\t', IfNotFoundReturn::all)].devicePools[afterFirst(mc.label, '\t', IfNotFoundReturn::none)] += mc.value;
+
+    if (numaAffinityEnabled())
+        rm.numaNodeCount = getNumaNodeCount();
+
+    if (rusage ru = {}; ::getrusage(RUSAGE_SELF, &ru) == 0)
+        rm.peakMemoryBytes = static_cast<int64_t>(ru.ru_maxrss) * 1024; //Linux: kilobytes
+
+    for (const PhaseMetrics& pm : rm.phaseTimes) //per-phase peak measurement resets the process peak seen by getrusage()
+        rm.peakMemoryBytes = std::max(rm.peakMemoryBytes, pm.peakMemoryBytes);
+
+    rm.memory = getMemoryUsage();
+    return rm;
+}
+
+
+double toSeconds(std::chrono::nanoseconds d) { return std::chrono::duration<double>(d).count(); }
+
+
+int64_t getBytesPerSec(const DeviceThroughput& dt)
+{
+    return dt.copyTime.count() > 0 ? static_cast<int64_t>(dt.bytes / toSeconds(dt.copyTime)) : 0;
+}
+
+
+std::string generateMetricsJson(const ProcessSummary& s, const RunMetrics& rm, const ErrorLog::Stats& logStats)
+{
+    JsonValue jobs(JsonValue::Type::array);
+    for (const std::wstring& jobName : s.jobNames)
+        jobs.arrayVal.emplace_back(utfTo<std::string>(jobName));
+
+    JsonValue phases(JsonValue::Type::array);
+    for (const PhaseMetrics& pm : rm.phaseTimes)
+    {
+        JsonValue phase(JsonValue::Type::object);
+        phase.objectVal.emplace("phase", pm.name);
+        phase.objectVal.emplace("seconds", toSeconds(pm.duration));
+        if (pm.peakMemoryBytes >= 0)
+            phase.objectVal.emplace("peak_memory_bytes", pm.peakMemoryBytes);
+        phases.arrayVal.push_back(std::move(phase));
+    }
+
+    JsonValue spans(JsonValue::Type::array);
+    for (const SpanStats& st : rm.spanStats)
+    {
+        JsonValue histogram(JsonValue::Type::array); //non-cumulative; upper bound in microseconds
+        for (size_t i = 0; i < st.histogram.size(); ++i)
+            if (st.histogram[i] > 0)
+            {
+                JsonValue bucket(JsonValue::Type::object);
+                if (i + 1 < st.histogram.size())
+                    bucket.objectVal.emplace("lt_us", int64_t(1) << i);
+                bucket.objectVal.emplace("count", st.histogram[i]);
+                histogram.arrayVal.push_back(std::move(bucket));
+            }
+
+        JsonValue span(JsonValue::Type::object);
+        span.objectVal.emplace("name", st.name);
+        if (!st.label.empty())
+            span.objectVal.emplace("device", st.label);
+        span.objectVal.emplace("count", st.count);
+        span.objectVal.emplace("seconds_total", toSeconds(st.totalTime));
+        span.objectVal.emplace("seconds_max", toSeconds(st.maxTime));
+        span.objectVal.emplace("histogram", std::move(histogram));
+        spans.arrayVal.push_back(std::move(span));
+    }
+
+    JsonValue devices(JsonValue::Type::array);
+    for (const auto& [deviceName, dt] : rm.devices)
+    {
+        JsonValue device(JsonValue::Type::object);
+        device.objectVal.emplace("device", deviceName);
+        device.objectVal.emplace("items_copied", dt.items);
+        device.objectVal.emplace("bytes_copied", dt.bytes);
+        device.objectVal.emplace("copy_seconds", toSeconds(dt.copyTime));
+        device.objectVal.emplace("bytes_per_second", getBytesPerSec(dt));
+        device.objectVal.emplace("bytes_read", dt.bytesRead);
+        device.objectVal.emplace("bytes_written", dt.bytesWritten);
+        devices.arrayVal.push_back(std::move(device));
+    }
+
+    JsonValue memory(JsonValue::Type::array);
+    for (const MemoryUsage& mu : rm.memory)
+    {
+        JsonValue subsystem(JsonValue::Type::object);
+        subsystem.objectVal.emplace("subsystem", mu.subsystem);
+        subsystem.objectVal.emplace("current_bytes", mu.current);
+        subsystem.objectVal.emplace("peak_bytes", mu.peak);
+        memory.arrayVal.push_back(std::move(subsystem));
+    }
+
+    JsonValue numaNodes(JsonValue::Type::array);
+    for (const auto& [nodeName, nm] : rm.numaNodes)
+    {
+        JsonValue devicePools(JsonValue::Type::array);
+        for (const auto& [deviceName, pools] : nm.devicePools)
+        {
+            JsonValue pool(JsonValue::Type::object);
+            pool.objectVal.emplace("device", deviceName);
+            pool.objectVal.emplace("worker_pools", pools);
+            devicePools.arrayVal.push_back(std::move(pool));
+        }
+        JsonValue node(JsonValue::Type::object);
+        node.objectVal.emplace("node", nodeName);
+        node.objectVal.emplace("threads_pinned", nm.threadsPinned);
+        node.objectVal.emplace("devices", std::move(devicePools));
+        numaNodes.arrayVal.push_back(std::move(node));
+    }
+
+    JsonValue root(JsonValue::Type::object);
+    root.objectVal.emplace("jobs", std::move(jobs));
+    root.objectVal.emplace("start_time", static_cast<int64_t>(std::chrono::system_clock::to_time_t(s.startTime)));
+    root.objectVal.emplace("result", getResultName(s.syncResult));
+    root.objectVal.emplace("seconds_total", toSeconds(s.totalTime));
+    root.objectVal.emplace("items_processed", s.statsProcessed.items);
+    root.objectVal.emplace("bytes_processed", s.statsProcessed.bytes);
+    root.objectVal.emplace("items_total", s.statsTotal.items);
+    root.objectVal.emplace("bytes_total", s.statsTotal.bytes);
+    root.objectVal.emplace("errors", logStats.error);
+    root.objectVal.emplace("warnings", logStats.warning);
+    root.objectVal.emplace("retries", rm.retries);
+    if (rm.peakMemoryBytes >= 0)
+        root.objectVal.emplace("peak_memory_bytes", rm.peakMemoryBytes);
+    root.objectVal.emplace("phases", std::move(phases));
+    root.objectVal.emplace("spans", std::move(spans));
+    root.objectVal.emplace("devices", std::move(devices));
+    if (!rm.memory.empty())
+        root.objectVal.emplace("memory", std::move(memory));
+    if (rm.numaNodeCount > 0)
+    {
+        JsonValue numa(JsonValue::Type::object);
+        numa.objectVal.emplace("node_count", static_cast<int64_t>(rm.numaNodeCount));
+        numa.objectVal.emplace("nodes", std::move(numaNodes));
+        root.objectVal.emplace("numa", std::move(numa));
+    }
+
+    return serializeJson(root) + '\n';
+}
+
+
+//https://prometheus.io/docs/instrumenting/exposition_formats/
+std::string generateMetricsPrometheus(const ProcessSummary& s, const RunMetrics& rm, const ErrorLog::Stats& logStats)
+{
+    auto escapeLabel = [](const std::string& str)
+    {
+        std::string output;
+        for (const char c : str)
+            switch (c)
+            {
+                //*INDENT-OFF*
+                case '\\': output += "\\\\"; break;
+                case  '"': output += "\\\""; break;
+                case '\n': output += "\\n";  break;
+                default:   output += c;      break;
+                //*INDENT-ON*
+            }
+        return output;
+    };
+
+    std::string jobLabel;
+    for (const std::wstring& jobName : s.jobNames)
+        jobLabel += (jobLabel.empty() ? "" : ", ") + utfTo<std::string>(jobName);
+    const std::string jobLabels = "job=\"" + escapeLabel(jobLabel) + '"';
+
+    std::string output;
+    auto addMetric = [&](const std::string& name, const std::string& type, const std::string& help)
+    {
+        output += "# HELP " + name + ' ' + help + '\n';
+        output += "# TYPE " + name + ' ' + type + '\n';
+    };
+    auto addSample = [&](const std::string& name, const std::string& labels, const std::string& value)
+    {
+        output += name + '{' + jobLabels + (labels.empty() ? "" : ',' + labels) + "} " + value + '\n';
+    };
+    auto fmtSec = [](std::chrono::nanoseconds d) { return numberTo<std::string>(toSeconds(d)); };
+
+    addMetric("ffs_run_start_time_seconds", "gauge", "Start time of the run (Unix time).");
+    addSample("ffs_run_start_time_seconds", "", numberTo<std::string>(std::chrono::system_clock::to_time_t(s.startTime)));
+
+    addMetric("ffs_run_result", "gauge", "1 for the result of the run.");
+    addSample("ffs_run_result", "result=\"" + std::string(getResultName(s.syncResult)) + '"', "1");
+
+    addMetric("ffs_run_duration_seconds", "gauge", "Total duration of the run.");
+    addSample("ffs_run_duration_seconds", "", fmtSec(s.totalTime));
+
+    addMetric("ffs_run_items", "gauge", "Items processed and total.");
+    addSample("ffs_run_items", "state=\"processed\"", numberTo<std::string>(s.statsProcessed.items));
+    addSample("ffs_run_items", "state=\"total\"",     numberTo<std::string>(s.statsTotal.items));
+
+    addMetric("ffs_run_bytes", "gauge", "Bytes processed and total.");
+    addSample("ffs_run_bytes", "state=\"processed\"", numberTo<std::string>(s.statsProcessed.bytes));
+    addSample("ffs_run_bytes", "state=\"total\"",     numberTo<std::string>(s.statsTotal.bytes));
+
+    addMetric("ffs_run_log_messages", "gauge", "Errors and warnings logged.");
+    addSample("ffs_run_log_messages", "type=\"error\"",   numberTo<std::string>(logStats.error));
+    addSample("ffs_run_log_messages", "type=\"warning\"", numberTo<std::string>(logStats.warning));
+
+    addMetric("ffs_run_retries", "gauge", "Operations retried after an error.");
+    addSample("ffs_run_retries", "", numberTo<std::string>(rm.retries));
+
+    if (rm.peakMemoryBytes >= 0)
+    {
+        addMetric("ffs_run_peak_memory_bytes", "gauge", "Peak resident memory of the process.");
+        addSample("ffs_run_peak_memory_bytes", "", numberTo<std::string>(rm.peakMemoryBytes));
+    }
+
+    std::map<std::string, std::chrono::milliseconds> phaseTimesSum;
+    std::map<std::string, int64_t> phasePeakMemory;
+    for (const PhaseMetrics& pm : rm.phaseTimes)
+    {
+        phaseTimesSum[pm.name] += pm.duration;
+        if (pm.peakMemoryBytes >= 0)
+            phasePeakMemory[pm.name] = std::max(phasePeakMemory[pm.name], pm.peakMemoryBytes);
+    }
+
+    addMetric("ffs_phase_duration_seconds", "gauge", "Wall-clock time per phase.");
+    for (const auto& [phaseName, duration] : phaseTimesSum)
+        addSample("ffs_phase_duration_seconds", "phase=\"" + phaseName + '"', fmtSec(duration));
+
+    if (!phasePeakMemory.empty())
+    {
+        addMetric("ffs_phase_peak_memory_bytes", "gauge", "Peak resident memory of the process per phase.");
+        for (const auto& [phaseName, peakMemory] : phasePeakMemory)
+            addSample("ffs_phase_peak_memory_bytes", "phase=\"" + phaseName + '"', numberTo<std::string>(peakMemory));
+    }
+
+    if (!rm.memory.empty())
+    {
+        addMetric("ffs_subsystem_memory_bytes", "gauge", "Memory per subsystem (counted or estimated): current and peak.");
+        for (const MemoryUsage& mu : rm.memory)
+        {
+            addSample("ffs_subsystem_memory_bytes", "subsystem=\"" + escapeLabel(mu.subsystem) + "\",state=\"current\"", numberTo<std::string>(mu.current));
+            addSample("ffs_subsystem_memory_bytes", "subsystem=\"" + escapeLabel(mu.subsystem) + "\",state=\"peak\"",    numberTo<std::string>(mu.peak));
+        }
+    }
+
+    if (!rm.spanStats.empty())
+    {
+        addMetric("ffs_span_duration_seconds", "histogram", "Duration of traced operations.");
+        for (const SpanStats& st : rm.spanStats)
+        {
+            std::string spanLabel = "span=\"" + escapeLabel(st.name) + '"';
+            if (!st.label.empty())
+                spanLabel += ",device=\"" + escapeLabel(st.label) + '"';
+            int64_t cumulative = 0;
+            for (size_t i = 0; i + 1 < st.histogram.size(); ++i)
+            {
+                cumulative += st.histogram[i];
+                addSample("ffs_span_duration_seconds_bucket", spanLabel + ",le=\"" + numberTo<std::string>(toSeconds(std::chrono::microseconds(int64_t(1) << i))) + '"',
+                          numberTo<std::string>(cumulative));
+            }
+            addSample("ffs_span_duration_seconds_bucket", spanLabel + ",le=\"+Inf\"", numberTo<std::string>(st.count));
+            addSample("ffs_span_duration_seconds_sum",    spanLabel, fmtSec(st.totalTime));
+            addSample("ffs_span_duration_seconds_count",  spanLabel, numberTo<std::string>(st.count));
+        }
+    }
+
+    if (!rm.devices.empty())
+    {
+        addMetric("ffs_device_copied_items", "gauge", "Files copied per target device.");
+        for (const auto& [deviceName, dt] : rm.devices)
+            addSample("ffs_device_copied_items", "device=\"" + escapeLabel(deviceName) + '"', numberTo<std::string>(dt.items));
+
+        addMetric("ffs_device_copied_bytes", "gauge", "Bytes copied per target device.");
+        for (const auto& [deviceName, dt] : rm.devices)
+            addSample("ffs_device_copied_bytes", "device=\"" + escapeLabel(deviceName) + '"', numberTo<std::string>(dt.bytes));
+
+        addMetric("ffs_device_copy_bytes_per_second", "gauge", "Copy throughput per target device (bytes / accumulated copy time).");
+        for (const auto& [deviceName, dt] : rm.devices)
+            addSample("ffs_device_copy_bytes_per_second", "device=\"" + escapeLabel(deviceName) + '"', numberTo<std::string>(getBytesPerSec(dt)));
+
+        addMetric("ffs_device_io_bytes", "gauge", "Bytes read and written per device (all file streams).");
+        for (const auto& [deviceName, dt] : rm.devices)
+        {
+            addSample("ffs_device_io_bytes", "device=\"" + escapeLabel(deviceName) + "\",direction=\"read\"",  numberTo<std::string>(dt.bytesRead));
+            addSample("ffs_device_io_bytes", "device=\"" + escapeLabel(deviceName) + "\",direction=\"write\"", numberTo<std::string>(dt.bytesWritten));
+        }
+    }
+
+    if (rm.numaNodeCount > 0)
+    {
+        addMetric("ffs_numa_nodes", "gauge", "NUMA nodes available for worker placement.");
+        addSample("ffs_numa_nodes", "", numberTo<std::string>(rm.numaNodeCount));
+
+        addMetric("ffs_numa_threads_pinned", "gauge", "Worker threads pinned per NUMA node.");
+        for (const auto& [nodeName, nm] : rm.numaNodes)
+            addSample("ffs_numa_threads_pinned", "node=\"" + escapeLabel(nodeName) + '"', numberTo<std::string>(nm.threadsPinned));
+
+        addMetric("ffs_numa_device_worker_pools", "gauge", "Device worker pools assigned per NUMA node.");
+        for (const auto& [nodeName, nm] : rm.numaNodes)
+            for (const auto& [deviceName, pools] : nm.devicePools)
+                addSample("ffs_numa_device_worker_pools", "node=\"" + escapeLabel(nodeName) + "\",device=\"" + escapeLabel(deviceName) + '"', numberTo<std::string>(pools));
+    }
+    return output;
+}
+}
+
+
+void fff::saveMetricsFile(const Zstring& filePath, //throw FileError
+                          const ProcessSummary& summary,
+                          const std::vector<PhaseTime>& phaseTimes,
+                          const ErrorLog::Stats& logStats)
+{
+    const RunMetrics rm = getRunMetrics(phaseTimes);
+
+    const std::string stream = endsWithAsciiNoCase(filePath, Zstr(".prom")) ?
+                               generateMetricsPrometheus(summary, rm, logStats) :
+                               generateMetricsJson      (summary, rm, logStats);
+
+    //Prometheus textfile collector requires atomic updates: setFileContent() writes a temp file first
+    setFileContent(filePath, stream, nullptr /*notifyUnbufferedIO*/); //throw FileError
+}
+
+
+std::wstring fff::getMemoryUsageMsg(const std::vector<PhaseTime>& phaseTimes)
+{
+    std::wstring msg;
+    for (const PhaseTime& pt : phaseTimes)
+        if (pt.peakMemoryBytes >= 0 && !isEmptyInitPhase(pt))
+            msg += L"\n    " + utfTo<std::wstring>(getPhaseName(pt.phase)) + L" - " + formatFilesizeShort(pt.peakMemoryBytes);
+
+    for (const MemoryUsage& mu : getMemoryUsage())
+        msg += L"\n    " + utfTo<std::wstring>(mu.subsystem) + L" - " + formatFilesizeShort(mu.peak);
+
+    return msg.empty() ? msg : _("Peak memory usage:") + msg;
+}
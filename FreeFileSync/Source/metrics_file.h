@@ -0,0 +1,32 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef METRICS_FILE_H_4782013648917346
+#define METRICS_FILE_H_4782013648917346
+
+#include <zen/error_log.h>
+#include "status_handler.h"
+
+
+namespace fff
+{
+/*  machine-readable metrics of a (batch) run for monitoring:
+        - Prometheus textfile format if file path ends with ".prom", JSON otherwise
+        - per-phase wall-clock time, zen::TraceSpan statistics (db load/save, versioning, AFS calls),
+          per-device copy throughput, retries, peak memory (process per phase + zen::getMemoryUsage() per subsystem),
+          NUMA worker placement (if enabled)
+
+    requires zen::enableMetrics(true) before the run, see applyProcessSettings()  */
+void saveMetricsFile(const Zstring& filePath, //throw FileError
+                     const ProcessSummary& summary,
+                     const std::vector<PhaseTime>& phaseTimes,
+                     const zen::ErrorLog::Stats& logStats);
+
+//log summary: peak memory per phase and per subsystem; empty if not measured (metrics disabled)
+std::wstring getMemoryUsageMsg(const std::vector<PhaseTime>& phaseTimes);
+}
+
+#endif //METRICS_FILE_H_4782013648917346
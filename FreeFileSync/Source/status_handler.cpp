@@ -13,7 +13,26 @@ using namespace zen;
 
 namespace
 {
+/*  adaptive refresh rate: keep time spent updating the GUI below UI_UPDATE_CPU_BUDGET_PERCENT of wall time
+    e.g. remote desktop sessions: a single progress dialog refresh may take 10 ms and more!  */
+const int UI_UPDATE_CPU_BUDGET_PERCENT = 2;
+constexpr std::chrono::milliseconds UI_UPDATE_INTERVAL_MAX(1000); //stay responsive for user abort/pause
+
 std::chrono::steady_clock::time_point lastExec;
+std::chrono::nanoseconds uiUpdateCostAvg{}; //exponential moving average
+std::chrono::nanoseconds uiUpdateInterval = fff::UI_UPDATE_INTERVAL;
+}
+
+
+void fff::reportUiUpdateCost(std::chrono::nanoseconds cost)
+{
+    if (cost > UI_UPDATE_INTERVAL_MAX) //not rendering, but e.g. user paused the sync => ignore
+        return;
+
+    uiUpdateCostAvg = (uiUpdateCostAvg * 3 + cost) / 4;
+
+    uiUpdateInterval = std::clamp<std::chrono::nanoseconds>(uiUpdateCostAvg * 100 / UI_UPDATE_CPU_BUDGET_PERCENT,
+                                                            UI_UPDATE_INTERVAL, UI_UPDATE_INTERVAL_MAX);
 }
 
 
@@ -21,7 +40,7 @@ bool fff::uiUpdateDue(bool force)
 {
     const auto now = std::chrono::steady_clock::now();
 
-    if (now >= lastExec + UI_UPDATE_INTERVAL || force)
+    if (now >= lastExec + uiUpdateInterval || force)
     {
         lastExec = now;
         return true;
@@ -54,16 +73,20 @@ void fff::runCommandAndLogErrors(const Zstring& cmdLine, ErrorLog& errorLog)
 }
 
 
-void fff::delayAndCountDown(std::chrono::steady_clock::time_point delayUntil, const std::function<void(const std::wstring& timeRemMsg)>& notifyStatus)
+void fff::delayAndCountDown(std::chrono::steady_clock::time_point delayUntil, const std::function<void(const std::wstring& timeRemMsg)>& notifyStatus,
+                             std::chrono::milliseconds cbInterval)
 {
     for (auto now = std::chrono::steady_clock::now(); now < delayUntil; now = std::chrono::steady_clock::now())
     {
+        const auto timeRem = delayUntil - now;
         if (notifyStatus)
         {
-            const auto timeRemMs = std::chrono::duration_cast<std::chrono::milliseconds>(delayUntil - now).count();
+            const auto timeRemMs = std::chrono::duration_cast<std::chrono::milliseconds>(timeRem).count();
             notifyStatus(_P("1 sec", "%x sec", numeric::intDivCeil(timeRemMs, 1000)));
         }
 
-        std::this_thread::sleep_for(UI_UPDATE_INTERVAL / 2);
+        //sleep no longer than until the countdown text changes
+        const auto timeToNextSec = timeRem % std::chrono::seconds(1);
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(cbInterval, timeToNextSec == timeToNextSec.zero() ? std::chrono::seconds(1) : timeToNextSec));
     }
 }
@@ -10,12 +10,15 @@
 #include <thread>
 #include <functional>
 #include <zen/error_log.h>
+#include <zen/perf.h>
+#include <zen/sys_info.h>
 #include "base/process_callback.h"
 #include "return_codes.h"
 
 namespace fff
 {
-bool uiUpdateDue(bool force = false); //test if a specific amount of time is over
+bool uiUpdateDue(bool force = false); //test if a specific amount of time is over: UI_UPDATE_INTERVAL, or longer if GUI updates are slow
+void reportUiUpdateCost(std::chrono::nanoseconds cost); //time of last GUI update => adapt uiUpdateDue() interval
 
 /*  Updating GUI is fast! time per call to ProcessCallback::forceUiRefresh()
     - Comparison       0.025 ms
@@ -63,6 +66,14 @@ struct Statistics
 };
 
 
+struct PhaseTime
+{
+    ProcessPhase phase = ProcessPhase::none;
+    std::chrono::milliseconds duration{};
+    int64_t peakMemoryBytes = -1; //resident set size; -1 if not measured (metrics disabled)
+};
+
+
 struct ProcessSummary
 {
     std::chrono::system_clock::time_point startTime;
@@ -71,6 +82,7 @@ struct ProcessSummary
     ProgressStats statsProcessed;
     ProgressStats statsTotal;
     std::chrono::milliseconds totalTime{};
+    int64_t peakMemoryBytes = -1; //over all phases; -1 if not measured
 };
 
 
@@ -78,12 +90,17 @@ struct ProcessSummary
 class StatusHandler : public ProcessCallback, public AbortCallback, public Statistics
 {
 public:
-    //StatusHandler() {}
+    StatusHandler() { startPhaseMemory(); }
 
     //implement parts of ProcessCallback
     void initNewPhase(int itemsTotal, int64_t bytesTotal, ProcessPhase phase) override //(throw X)
     {
         assert((itemsTotal < 0) == (bytesTotal < 0));
+        const auto now = std::chrono::steady_clock::now();
+        phaseTimes_.push_back({currentPhase_, std::chrono::duration_cast<std::chrono::milliseconds>(now - phaseStartTime_), getPhasePeakMemory()});
+        phaseStartTime_ = now;
+        startPhaseMemory();
+
         currentPhase_ = phase;
         statsCurrent_ = {};
         statsTotal_ = {itemsTotal, bytesTotal};
@@ -98,7 +115,9 @@ public:
         {
             const bool abortRequestedBefore = static_cast<bool>(abortRequested_);
 
+            const auto startTime = std::chrono::steady_clock::now();
             forceUiUpdateNoThrow();
+            reportUiUpdateCost(std::chrono::steady_clock::now() - startTime);
 
             //triggered by userRequestAbort()
             // => sufficient to evaluate occasionally when uiUpdateDue()!
@@ -147,7 +166,28 @@ public:
 
     std::optional<AbortTrigger> getAbortStatus() const override { return abortRequested_; }
 
+    //wall-clock time and peak memory per phase in order of execution (including current phase), e.g. for metrics export
+    std::vector<PhaseTime> getPhaseTimes() const
+    {
+        std::vector<PhaseTime> output = phaseTimes_;
+        output.push_back({currentPhase_, std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - phaseStartTime_), getPhasePeakMemory()});
+        return output;
+    }
+
+    int64_t getPeakMemory() const //-1 if not measured
+    {
+        int64_t peakMemory = -1;
+        for (const PhaseTime& pt : getPhaseTimes())
+            peakMemory = std::max(peakMemory, pt.peakMemoryBytes);
+        return peakMemory;
+    }
+
 private:
+    //per-phase peak memory: only with metrics enabled (reset is process-wide and affects getrusage())
+    //reset not supported (e.g. restricted /proc) => phase peak = process peak so far
+    static void startPhaseMemory() { if (zen::metricsEnabled()) zen::resetProcessPeakMemory(); }
+    static int64_t getPhasePeakMemory() { return zen::metricsEnabled() ? zen::getProcessMemory().peak : -1; }
+
     void updateData(ProgressStats& stats, int itemsDelta, int64_t bytesDelta)
     {
         assert(stats.items >= 0);
@@ -161,11 +201,16 @@ private:
     ProgressStats statsTotal_ {-1, -1};
     std::wstring statusText_;
 
+    std::chrono::steady_clock::time_point phaseStartTime_ = std::chrono::steady_clock::now();
+    std::vector<PhaseTime> phaseTimes_;
+
     std::optional<AbortTrigger> abortRequested_;
 };
 
 
-void delayAndCountDown(std::chrono::steady_clock::time_point delayUntil, const std::function<void(const std::wstring& timeRemMsg)>& notifyStatus);
+//cbInterval: how often notifyStatus() must be called at least, e.g. to stay responsive to GUI input => no need for UI_UPDATE_INTERVAL if not a GUI
+void delayAndCountDown(std::chrono::steady_clock::time_point delayUntil, const std::function<void(const std::wstring& timeRemMsg)>& notifyStatus,
+                       std::chrono::milliseconds cbInterval = UI_UPDATE_INTERVAL / 2);
 void runCommandAndLogErrors(const Zstring& cmdLine, zen::ErrorLog& errorLog);
 }
 
@@ -7,11 +7,13 @@
 #include "batch_status_handler.h"
 #include <zen/shutdown.h>
 #include <zen/resolve_path.h>
+#include <zen/perf.h>
 #include <wx+/popup_dlg.h>
 #include <wx/app.h>
 #include <wx/sound.h>
 #include "../afs/concrete.h"
 #include "../log_file.h"
+#include "../metrics_file.h"
 #include "../fatal_error.h"
 
 using namespace zen;
@@ -28,6 +30,7 @@ BatchStatusHandler::BatchStatusHandler(bool showProgress,
                                        const Zstring& soundFileAlertPending,
                                        wxSize progressDlgSize, bool dlgMaximize,
                                        bool autoCloseDialog,
+                                       bool showDiagnostics,
                                        PostSyncAction postSyncAction,
                                        BatchErrorHandling batchErrorHandling) :
     jobName_(jobName),
@@ -36,7 +39,7 @@ BatchStatusHandler::BatchStatusHandler(bool showProgress,
     autoRetryDelay_(autoRetryDelay),
     soundFileSyncComplete_(soundFileSyncComplete),
     soundFileAlertPending_(soundFileAlertPending),
-    progressDlg_(SyncProgressDialog::create(progressDlgSize, dlgMaximize, [this] { userRequestAbort(); }, *this, nullptr /*parentWindow*/, showProgress, autoCloseDialog,
+    progressDlg_(SyncProgressDialog::create(progressDlgSize, dlgMaximize, [this] { userRequestAbort(); }, *this, nullptr /*parentWindow*/, showProgress, autoCloseDialog, showDiagnostics,
 {jobName}, std::chrono::system_clock::to_time_t(startTime), ignoreErrors, autoRetryCount, [&]
 {
     switch (postSyncAction)
@@ -66,9 +69,10 @@ BatchStatusHandler::~BatchStatusHandler()
 
 
 BatchStatusHandler::Result BatchStatusHandler::reportResults(const Zstring& postSyncCommand, PostSyncCondition postSyncCondition,
-                                                             const Zstring& altLogFolderPathPhrase, int logfilesMaxAgeDays, LogFileFormat logFormat,
+                                                             const Zstring& altLogFolderPathPhrase, int logfilesMaxAgeDays, LogFileFormat logFormat, bool logFileGzip,
                                                              const std::set<AbstractPath>& logFilePathsToKeep,
-                                                             const std::string& emailNotifyAddress, ResultsNotification emailNotifyCondition) //noexcept!!
+                                                             const std::string& emailNotifyAddress, ResultsNotification emailNotifyCondition,
+                                                             const Zstring& metricsFilePath /*optional*/) //noexcept!!
 {
     //keep correct summary window stats considering count down timer, system sleep
     const std::chrono::milliseconds totalTime = progressDlg_->pauseAndGetTotalTime();
@@ -99,10 +103,11 @@ BatchStatusHandler::Result BatchStatusHandler::reportResults(const Zstring& post
         startTime_, syncResult, {jobName_},
         getStatsCurrent(),
         getStatsTotal  (),
-        totalTime
+        totalTime,
+        getPeakMemory()
     };
 
-    const AbstractPath logFilePath = generateLogFilePath(logFormat, summary, altLogFolderPathPhrase);
+    const AbstractPath logFilePath = generateLogFilePath(logFormat, logFileGzip, summary, altLogFolderPathPhrase);
     //e.g. %AppData%\FreeFileSync\Logs\Backup FreeFileSync 2013-09-15 015052.123 [Error].log
 
     auto notifyStatusNoThrow = [&](std::wstring&& msg) { try { updateStatus(std::move(msg)); /*throw AbortProcess*/ } catch (AbortProcess&) {} };
@@ -206,6 +211,23 @@ BatchStatusHandler::Result BatchStatusHandler::reportResults(const Zstring& post
         //  RequestUserAttention(); -> probably too much since task bar is already colorized with Taskbar::STATUS_ERROR or STATUS_NORMAL
     }
 
+    //--------------------- memory usage ----------------------
+    if (metricsEnabled())
+    {
+        setMemoryUsage("error log", errorLog_.getMemoryUsage());
+        if (const std::wstring memoryMsg = getMemoryUsageMsg(getPhaseTimes());
+            !memoryMsg.empty())
+            errorLog_.logMsg(memoryMsg, MSG_TYPE_INFO);
+    }
+
+    //--------------------- save metrics file ----------------------
+    if (!metricsFilePath.empty())
+        try
+        {
+            saveMetricsFile(metricsFilePath, summary, getPhaseTimes(), errorLog_.getStats()); //throw FileError
+        }
+        catch (const FileError& e) { errorLog_.logMsg(e.toString(), MSG_TYPE_ERROR); }
+
     //--------------------- save log file ----------------------
     try //create not before destruction: 1. avoid issues with FFS trying to sync open log file 2. include status in log file name without extra rename
     {
@@ -321,6 +343,8 @@ ProcessCallback::Response BatchStatusHandler::reportError(const ErrorInfo& error
     if (errorInfo.retryNumber < autoRetryCount_)
     {
         errorLog_.logMsg(errorInfo.msg + L"\n-> " + _("Automatic retry"), MSG_TYPE_INFO);
+        addMetricCount("retries", [] { return std::string(); }, 1);
+        const TraceSpan span("retry backoff"); //metrics: waiting for automatic retry
         delayAndCountDown(errorInfo.failTime + autoRetryDelay_,
                           [&, statusPrefix  = _("Automatic retry") +
                                               (errorInfo.retryNumber == 0 ? L"" : L' ' + formatNumber(errorInfo.retryNumber + 1)) + L" | ",
@@ -355,6 +379,7 @@ ProcessCallback::Response BatchStatusHandler::reportError(const ErrorInfo& error
                     case ConfirmationButton3::decline: //retry
                         guardWriteLog.dismiss();
                         errorLog_.logMsg(errorInfo.msg + L"\n-> " + _("Retrying operation..."), MSG_TYPE_INFO);
+                        addMetricCount("retries", [] { return std::string(); }, 1);
                         return ProcessCallback::retry;
 
                     case ConfirmationButton3::cancel:
@@ -30,6 +30,7 @@ public:
                        const Zstring& soundFileAlertPending,
                        wxSize progressDlgSize, bool dlgMaximize,
                        bool autoCloseDialog,
+                       bool showDiagnostics,
                        PostSyncAction postSyncAction,
                        BatchErrorHandling batchErrorHandling); //noexcept!!
     ~BatchStatusHandler();
@@ -59,8 +60,9 @@ public:
         bool dlgIsMaximized;
     };
     Result reportResults(const Zstring& postSyncCommand, PostSyncCondition postSyncCondition,
-                         const Zstring& altLogFolderPathPhrase, int logfilesMaxAgeDays, LogFileFormat logFormat, const std::set<AbstractPath>& logFilePathsToKeep,
-                         const std::string& emailNotifyAddress, ResultsNotification emailNotifyCondition); //noexcept!!
+                         const Zstring& altLogFolderPathPhrase, int logfilesMaxAgeDays, LogFileFormat logFormat, bool logFileGzip, const std::set<AbstractPath>& logFilePathsToKeep,
+                         const std::string& emailNotifyAddress, ResultsNotification emailNotifyCondition,
+                         const Zstring& metricsFilePath /*optional*/); //noexcept!!
 
 private:
     const std::wstring jobName_;
@@ -6,6 +6,7 @@
 
 #include "file_grid.h"
 #include <set>
+#include <map>
 #include <wx/dc.h>
 #include <wx/settings.h>
 #include <zen/i18n.h>
@@ -205,7 +206,8 @@ struct IconManager
 {
     IconManager() {}
 
-    IconManager(GridDataLeft& provLeft, GridDataRight& provRight, IconBuffer::IconSize sz, bool showFileIcons) :
+    IconManager(GridDataLeft& provLeft, GridDataRight& provRight, IconBuffer::IconSize sz, bool showFileIcons,
+                const std::function<size_t(const AfsDevice& afsDevice)>& getDeviceParallelOps, const Zstring& thumbnailCacheFilePath) :
         fileIcon_        (IconBuffer::genericFileIcon (showFileIcons ? sz : IconBuffer::SIZE_SMALL)),
         dirIcon_         (IconBuffer::genericDirIcon  (showFileIcons ? sz : IconBuffer::SIZE_SMALL)),
         linkOverlayIcon_ (IconBuffer::linkOverlayIcon (showFileIcons ? sz : IconBuffer::SIZE_SMALL)),
@@ -214,7 +216,7 @@ struct IconManager
     {
         if (showFileIcons)
         {
-            iconBuffer_  = std::make_unique<IconBuffer>(sz);
+            iconBuffer_  = std::make_unique<IconBuffer>(sz, getDeviceParallelOps, thumbnailCacheFilePath);
             iconUpdater_ = std::make_unique<IconUpdater>(provLeft, provRight, *iconBuffer_);
         }
     }
@@ -535,6 +537,47 @@ private:
     }
 
 
+    struct CellTextBuf
+    {
+        const FileSystemObject* fsObj = nullptr; //DO NOT DEREFERENCE: only used to validate the buffer...
+        bool     isEmpty  = true;                //
+        uint64_t rawValue = 0;                   //...together with the raw value the text was formatted from
+        std::wstring text;
+        wxSize extent;
+    };
+
+    //per-row render buffer for size and date columns: formatting + wxDC::GetTextExtent() would otherwise run for every visible cell on each repaint
+    const CellTextBuf& getCellTextBuffered(wxDC& dc, size_t row, ColumnTypeRim colType, const FileView::PathDrawInfo& pdi)
+    {
+        assert(pdi.fsObj && (colType == ColumnTypeRim::size || colType == ColumnTypeRim::date));
+
+        //FileView::updateView() called? => rows now refer to different items
+        if (pdi.viewUpdateId != cellTextBufViewUpdateId_ || cellTextBuf_.size() > CELL_TEXT_BUF_SIZE_MAX)
+        {
+            cellTextBufViewUpdateId_ = pdi.viewUpdateId;
+            cellTextBuf_.clear();
+        }
+
+        const bool isEmpty = pdi.fsObj->isEmpty<side>();
+        uint64_t rawValue = 0;
+        if (!isEmpty)
+            visitFSObject(*pdi.fsObj, [](const FolderPair& folder) {},
+            [&](const FilePair& file) { rawValue = colType == ColumnTypeRim::size ? file.getFileSize<side>() : file.getLastWriteTime<side>(); },
+            [&](const SymlinkPair& symlink) { rawValue = colType == ColumnTypeRim::size ? 0 : symlink.getLastWriteTime<side>(); });
+
+        //items are updated in-place, e.g. during synchronization => validate buffer against the raw value
+        CellTextBuf& ctb = cellTextBuf_[{row, colType}];
+        if (ctb.fsObj != pdi.fsObj || ctb.isEmpty != isEmpty || ctb.rawValue != rawValue)
+        {
+            ctb.fsObj    = pdi.fsObj;
+            ctb.isEmpty  = isEmpty;
+            ctb.rawValue = rawValue;
+            ctb.text     = getValue(row, static_cast<ColumnType>(colType));
+            ctb.extent   = ctb.text.empty() ? wxSize() /*skip expensive GetTextExtent(): nothing to draw*/ : dc.GetTextExtent(ctb.text);
+        }
+        return ctb;
+    }
+
     int getGroupItemNamesWidth(wxDC& dc, const FileView::PathDrawInfo& pdi)
     {
         //FileView::updateView() called? => invalidates group item render buffer
@@ -1037,25 +1080,39 @@ private:
                 break;
 
                 case ColumnTypeRim::size:
+                {
+                    const CellTextBuf& ctb = getCellTextBuffered(dc, row, static_cast<ColumnTypeRim>(colType), pdi);
                     if (refGrid().GetLayoutDirection() != wxLayout_RightToLeft)
                     {
                         rectTmp.width -= gapSize_; //have file size right-justified (but don't change for RTL languages)
-                        drawCellText(dc, rectTmp, getValue(row, colType), wxALIGN_RIGHT | wxALIGN_CENTER_VERTICAL);
+                        drawCellText(dc, rectTmp, ctb.text, wxALIGN_RIGHT | wxALIGN_CENTER_VERTICAL, &ctb.extent);
                     }
                     else
                     {
                         rectTmp.x     += gapSize_;
                         rectTmp.width -= gapSize_;
-                        drawCellText(dc, rectTmp, getValue(row, colType), wxALIGN_LEFT | wxALIGN_CENTER_VERTICAL);
+                        drawCellText(dc, rectTmp, ctb.text, wxALIGN_LEFT | wxALIGN_CENTER_VERTICAL, &ctb.extent);
                     }
-                    break;
+                }
+                break;
 
                 case ColumnTypeRim::date:
+                {
+                    const CellTextBuf& ctb = getCellTextBuffered(dc, row, static_cast<ColumnTypeRim>(colType), pdi);
+                    rectTmp.x     += gapSize_;
+                    rectTmp.width -= gapSize_;
+                    drawCellText(dc, rectTmp, ctb.text, wxALIGN_LEFT | wxALIGN_CENTER_VERTICAL, &ctb.extent);
+                }
+                break;
+
                 case ColumnTypeRim::extension:
+                {
+                    const std::wstring& ext = getValue(row, colType);
                     rectTmp.x     += gapSize_;
                     rectTmp.width -= gapSize_;
-                    drawCellText(dc, rectTmp, getValue(row, colType), wxALIGN_LEFT | wxALIGN_CENTER_VERTICAL);
-                    break;
+                    drawCellText(dc, rectTmp, ext, wxALIGN_LEFT | wxALIGN_CENTER_VERTICAL, &getTextExtentBuffered(dc, ext)); //few distinct extensions
+                }
+                break;
             }
         }
     }
@@ -1264,6 +1321,10 @@ private:
 
     std::vector<int> groupItemNamesWidthBuf_; //buffer! groupItemNamesWidths essentially only depends on (groupIdx, side)
     uint64_t viewUpdateIdLast_ = 0;           //
+
+    static constexpr size_t CELL_TEXT_BUF_SIZE_MAX = 10'000; //a few screens of visible rows
+    std::map<std::pair<size_t /*row*/, ColumnTypeRim>, CellTextBuf> cellTextBuf_;
+    uint64_t cellTextBufViewUpdateId_ = 0;
 };
 
 
@@ -1472,7 +1533,7 @@ private:
                     if (getViewType() == GridViewType::difference)
                         drawIcon(getCmpResultImage(pdi.fsObj->getCategory()), wxALIGN_CENTER);
                     else if (pdi.fsObj->getCategory() != FILE_EQUAL) //don't show = in both middle columns
-                        drawIcon(greyScale(getCmpResultImage(pdi.fsObj->getCategory())), wxALIGN_CENTER);
+                        drawIcon(getCmpResultImageGrey(pdi.fsObj->getCategory()), wxALIGN_CENTER);
                 }
                 break;
 
@@ -1506,7 +1567,7 @@ private:
                             if (getViewType() == GridViewType::action)
                                 drawIcon(getSyncOpImage(pdi.fsObj->getSyncOperation()), wxALIGN_CENTER);
                             else if (pdi.fsObj->getSyncOperation() != SO_EQUAL) //don't show = in both middle columns
-                                drawIcon(greyScale(getSyncOpImage(pdi.fsObj->getSyncOperation())), wxALIGN_CENTER);
+                                drawIcon(getSyncOpImageGrey(pdi.fsObj->getSyncOperation()), wxALIGN_CENTER);
                             break;
                     }
                 }
@@ -1666,10 +1727,29 @@ private:
     }
     //*INDENT-ON*
 
+    //greyScale() for each row on every repaint is expensive => generate once per category/operation
+    const wxImage& getCmpResultImageGrey(CompareFileResult cmpResult)
+    {
+        auto [it, inserted] = cmpResultImagesGrey_.try_emplace(cmpResult);
+        if (inserted)
+            it->second = greyScale(getCmpResultImage(cmpResult));
+        return it->second;
+    }
+
+    const wxImage& getSyncOpImageGrey(SyncOperation syncOp)
+    {
+        auto [it, inserted] = syncOpImagesGrey_.try_emplace(syncOp);
+        if (inserted)
+            it->second = greyScale(getSyncOpImage(syncOp));
+        return it->second;
+    }
+
     bool selectionInProgress_ = false;
 
     std::optional<wxBitmap> renderBufCmp_; //avoid costs of recreating this temporary variable
     std::optional<wxBitmap> renderBufSync_;
+    std::map<CompareFileResult, wxImage> cmpResultImagesGrey_;
+    std::map<SyncOperation,     wxImage> syncOpImagesGrey_;
     Tooltip toolTip_;
     wxImage notch_ = loadImage("notch");
 };
@@ -2059,14 +2139,15 @@ void IconManager::startIconUpdater() { assert(iconUpdater_); if (iconUpdater_) i
 }
 
 
-void filegrid::setupIcons(Grid& gridLeft, Grid& gridCenter, Grid& gridRight, bool showFileIcons, IconBuffer::IconSize sz)
+void filegrid::setupIcons(Grid& gridLeft, Grid& gridCenter, Grid& gridRight, bool showFileIcons, IconBuffer::IconSize sz,
+                          const std::function<size_t(const AfsDevice& afsDevice)>& getDeviceParallelOps, const Zstring& thumbnailCacheFilePath)
 {
     auto* provLeft  = dynamic_cast<GridDataLeft*>(gridLeft .getDataProvider());
     auto* provRight = dynamic_cast<GridDataRight*>(gridRight.getDataProvider());
 
     if (provLeft && provRight)
     {
-        auto iconMgr = makeSharedRef<IconManager>(*provLeft, *provRight, sz, showFileIcons);
+        auto iconMgr = makeSharedRef<IconManager>(*provLeft, *provRight, sz, showFileIcons, getDeviceParallelOps, thumbnailCacheFilePath);
         provLeft ->setIconManager(iconMgr);
 
         const int newRowHeight = std::max(iconMgr.ref().getIconSize(), gridLeft.getMainWin().GetCharHeight()) + fastFromDIP(1); //add some space
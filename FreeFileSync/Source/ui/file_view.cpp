@@ -75,44 +75,30 @@ void FileView::updateView(Predicate pred)
     groupDetails_          .clear();
     rowPositions_          .clear();
     rowPositionsFirstChild_.clear();
+    rowPositionsValid_ = false;
+    columns_               .clear();
+    columns_.reserve(sortedRef_.size());
 
     static uint64_t globalViewUpdateId;
     viewUpdateId_ = ++globalViewUpdateId;
     assert(runningOnMainThread());
 
-    std::vector<const ContainerObject*> parentsBuf; //from bottom to top of hierarchy
     const ContainerObject* groupStartObj = nullptr;
 
     for (const FileSystemObject::ObjectId& objId : sortedRef_)
         if (const FileSystemObject* const fsObj = FileSystemObject::retrieve(objId))
-            if (pred(*fsObj))
+        {
+            const size_t colRow = columns_.size();
+            columns_.append(*fsObj);
+
+            if (pred(colRow))
             {
                 const size_t row = viewRef_.size();
 
-                //save row position for direct random access to FilePair or FolderPair
-                rowPositions_.emplace(objId, row); //costs: 0.28 µs per call - MSVC based on std::set
-
-                parentsBuf.clear();
-                for (const FileSystemObject* fsObj2 = fsObj;;)
-                {
-                    const ContainerObject& parent = fsObj2->parent();
-                    parentsBuf.push_back(&parent);
-
-                    fsObj2 = dynamic_cast<const FolderPair*>(&parent);
-                    if (!fsObj2)
-                        break;
-                }
-
-                //save row position to identify first child *on sorted subview* of FolderPair or BaseFolderPair in case latter are filtered out
-                for (const ContainerObject* parent : parentsBuf)
-                    if (const auto [it, inserted] = this->rowPositionsFirstChild_.emplace(parent, row);
-                        !inserted) //=> parents further up in hierarchy already inserted!
-                        break;
-
                 //------ save info to aggregate rows by parent folders ------
-                if (const auto folder = dynamic_cast<const FolderPair*>(fsObj))
+                if (columns_.getItemType(colRow) == ComparisonColumns::ItemType::folder)
                 {
-                    groupStartObj = folder;
+                    groupStartObj = static_cast<const FolderPair*>(fsObj);
                     groupDetails_.push_back({row});
                 }
                 else if (&fsObj->parent() != groupStartObj)
@@ -125,11 +111,49 @@ void FileView::updateView(Predicate pred)
                 //-----------------------------------------------------------
                 viewRef_.push_back({objId, groupIdx});
             }
+        }
+    //row positions are needed rarely (e.g. tree view navigation): don't fill hash maps for tens of millions of rows on each filter button click
+}
+
+
+void FileView::updateRowPositions() const
+{
+    if (rowPositionsValid_)
+        return;
+    rowPositionsValid_ = true;
+    assert(rowPositions_.empty() && rowPositionsFirstChild_.empty());
+
+    std::vector<const ContainerObject*> parentsBuf; //from bottom to top of hierarchy
+
+    for (size_t row = 0; row < viewRef_.size(); ++row)
+        if (const FileSystemObject* const fsObj = FileSystemObject::retrieve(viewRef_[row].objId))
+        {
+            //save row position for direct random access to FilePair or FolderPair
+            rowPositions_.emplace(viewRef_[row].objId, row); //costs: 0.28 µs per call - MSVC based on std::set
+
+            parentsBuf.clear();
+            for (const FileSystemObject* fsObj2 = fsObj;;)
+            {
+                const ContainerObject& parent = fsObj2->parent();
+                parentsBuf.push_back(&parent);
+
+                fsObj2 = dynamic_cast<const FolderPair*>(&parent);
+                if (!fsObj2)
+                    break;
+            }
+
+            //save row position to identify first child *on sorted subview* of FolderPair or BaseFolderPair in case latter are filtered out
+            for (const ContainerObject* parent : parentsBuf)
+                if (const auto [it, inserted] = rowPositionsFirstChild_.emplace(parent, row);
+                    !inserted) //=> parents further up in hierarchy already inserted!
+                    break;
+        }
 }
 
 
 ptrdiff_t FileView::findRowDirect(FileSystemObject::ObjectIdConst objId) const
 {
+    updateRowPositions();
     auto it = rowPositions_.find(objId);
     return it != rowPositions_.end() ? it->second : -1;
 }
@@ -137,6 +161,7 @@ ptrdiff_t FileView::findRowDirect(FileSystemObject::ObjectIdConst objId) const
 
 ptrdiff_t FileView::findRowFirstChild(const ContainerObject* hierObj) const
 {
+    updateRowPositions();
     auto it = rowPositionsFirstChild_.find(hierObj);
     return it != rowPositionsFirstChild_.end() ? it->second : -1;
 }
@@ -145,39 +170,39 @@ ptrdiff_t FileView::findRowFirstChild(const ContainerObject* hierObj) const
 namespace
 {
 template <class ViewStats>
-void addNumbers(const FileSystemObject& fsObj, ViewStats& stats)
+void addNumbers(const ComparisonColumns& columns, size_t row, ViewStats& stats)
 {
-    visitFSObject(fsObj, [&](const FolderPair& folder)
+    switch (columns.getItemType(row))
     {
-        if (!folder.isEmpty<SelectSide::left>())
-            ++stats.fileStatsLeft.folderCount;
+        case ComparisonColumns::ItemType::folder:
+            if (!columns.isEmpty<SelectSide::left>(row))
+                ++stats.fileStatsLeft.folderCount;
 
-        if (!folder.isEmpty<SelectSide::right>())
-            ++stats.fileStatsRight.folderCount;
-    },
+            if (!columns.isEmpty<SelectSide::right>(row))
+                ++stats.fileStatsRight.folderCount;
+            break;
 
-    [&](const FilePair& file)
-    {
-        if (!file.isEmpty<SelectSide::left>())
-        {
-            stats.fileStatsLeft.bytes += file.getFileSize<SelectSide::left>();
-            ++stats.fileStatsLeft.fileCount;
-        }
-        if (!file.isEmpty<SelectSide::right>())
-        {
-            stats.fileStatsRight.bytes += file.getFileSize<SelectSide::right>();
-            ++stats.fileStatsRight.fileCount;
-        }
-    },
+        case ComparisonColumns::ItemType::file:
+            if (!columns.isEmpty<SelectSide::left>(row))
+            {
+                stats.fileStatsLeft.bytes += columns.getFileSize<SelectSide::left>(row);
+                ++stats.fileStatsLeft.fileCount;
+            }
+            if (!columns.isEmpty<SelectSide::right>(row))
+            {
+                stats.fileStatsRight.bytes += columns.getFileSize<SelectSide::right>(row);
+                ++stats.fileStatsRight.fileCount;
+            }
+            break;
 
-    [&](const SymlinkPair& symlink)
-    {
-        if (!symlink.isEmpty<SelectSide::left>())
-            ++stats.fileStatsLeft.fileCount;
+        case ComparisonColumns::ItemType::symlink:
+            if (!columns.isEmpty<SelectSide::left>(row))
+                ++stats.fileStatsLeft.fileCount;
 
-        if (!symlink.isEmpty<SelectSide::right>())
-            ++stats.fileStatsRight.fileCount;
-    });
+            if (!columns.isEmpty<SelectSide::right>(row))
+                ++stats.fileStatsRight.fileCount;
+            break;
+    }
 }
 }
 
@@ -193,11 +218,11 @@ FileView::DifferenceViewStats FileView::applyDifferenceFilter(bool showExcluded,
 {
     DifferenceViewStats stats;
 
-    updateView([&](const FileSystemObject& fsObj)
+    updateView([&](size_t row)
     {
         auto categorize = [&](bool showCategory, int& categoryCount)
         {
-            if (!fsObj.isActive())
+            if (!columns_.isActive(row))
             {
                 ++stats.excluded;
                 if (!showExcluded)
@@ -207,11 +232,11 @@ FileView::DifferenceViewStats FileView::applyDifferenceFilter(bool showExcluded,
             if (!showCategory)
                 return false;
 
-            addNumbers(fsObj, stats); //calculate total number of bytes for each side
+            addNumbers(columns_, row, stats); //calculate total number of bytes for each side
             return true;
         };
 
-        switch (fsObj.getCategory())
+        switch (columns_.getCategory(row))
         {
             case FILE_LEFT_SIDE_ONLY:
                 return categorize(showLeftOnly, stats.leftOnly);
@@ -253,11 +278,11 @@ FileView::ActionViewStats FileView::applyActionFilter(bool showExcluded, //maps
     int moveLeft  = 0;
     int moveRight = 0;
 
-    updateView([&](const FileSystemObject& fsObj)
+    updateView([&](size_t row)
     {
         auto categorize = [&](bool showCategory, int& categoryCount)
         {
-            if (!fsObj.isActive())
+            if (!columns_.isActive(row))
             {
                 ++stats.excluded;
                 if (!showExcluded)
@@ -267,11 +292,11 @@ FileView::ActionViewStats FileView::applyActionFilter(bool showExcluded, //maps
             if (!showCategory)
                 return false;
 
-            addNumbers(fsObj, stats); //calculate total number of bytes for each side
+            addNumbers(columns_, row, stats); //calculate total number of bytes for each side
             return true;
         };
 
-        switch (fsObj.getSyncOperation()) //evaluate comparison result and sync direction
+        switch (columns_.getSyncOperation(row)) //evaluate comparison result and sync direction
         {
             case SO_CREATE_NEW_LEFT:
                 return categorize(showCreateLeft, stats.createLeft);
@@ -327,6 +352,21 @@ std::vector<FileSystemObject*> FileView::getAllFileRef(const std::vector<size_t>
 }
 
 
+std::vector<FileSystemObject*> FileView::getAllFileRef(const std::vector<std::pair<size_t, size_t>>& rowRanges)
+{
+    const size_t viewSize = viewRef_.size();
+
+    std::vector<FileSystemObject*> output;
+
+    for (const auto& [rowFirst, rowLast] : rowRanges)
+        for (size_t pos = rowFirst; pos < std::min(rowLast, viewSize); ++pos)
+            if (FileSystemObject* fsObj = FileSystemObject::retrieve(viewRef_[pos].objId))
+                output.push_back(fsObj);
+
+    return output;
+}
+
+
 FileView::PathDrawInfo FileView::getDrawInfo(size_t row)
 {
     if (row < viewRef_.size())
@@ -361,6 +401,7 @@ void FileView::removeInvalidRows()
     groupDetails_          .clear();
     rowPositions_          .clear();
     rowPositionsFirstChild_.clear();
+    rowPositionsValid_ = false;
 }
 
 
@@ -394,385 +435,373 @@ bool isDirectoryPair(const FileSystemObject& fsObj)
 }
 
 
-template <bool ascending, SelectSide side> inline
-bool lessFileName(const FileSystemObject& lhs, const FileSystemObject& rhs)
+template <bool ascending> inline
+bool lessCmpResult(const FileSystemObject& lhs, const FileSystemObject& rhs)
 {
-    //sort order: first files/symlinks, then directories then empty rows
-
-    //empty rows always last
-    if (lhs.isEmpty<side>())
-        return false;
-    else if (rhs.isEmpty<side>())
-        return true;
-
-    //directories after files/symlinks:
-    if (isDirectoryPair(lhs))
+    return zen::makeSortDirection([](CompareFileResult lhs2, CompareFileResult rhs2)
     {
-        if (!isDirectoryPair(rhs))
+        //presort: equal shall appear at end of list
+        if (lhs2 == FILE_EQUAL)
             return false;
-    }
-    else if (isDirectoryPair(rhs))
-        return true;
-
-    //sort directories and files/symlinks by short name
-    return zen::makeSortDirection(LessNaturalSort() /*even on Linux*/, std::bool_constant<ascending>())(lhs.getItemName<side>(), rhs.getItemName<side>());
+        if (rhs2 == FILE_EQUAL)
+            return true;
+        return lhs2 < rhs2;
+    },
+    std::bool_constant<ascending>())(lhs.getCategory(), rhs.getCategory());
 }
 
 
-template <bool ascending>  inline //side currently unused!
-bool lessFilePath(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs,
-                  const std::unordered_map<const void* /*BaseFolderPair*/, size_t /*position*/>& sortedPos,
-                  std::vector<const FolderPair*>& tempBuf)
+template <bool ascending> inline
+bool lessSyncDirection(const FileSystemObject& lhs, const FileSystemObject& rhs)
 {
-    const FileSystemObject* fsObjL = FileSystemObject::retrieve(lhs);
-    const FileSystemObject* fsObjR = FileSystemObject::retrieve(rhs);
-    if (!fsObjL) //invalid rows shall appear at the end
-        return false;
-    else if (!fsObjR)
-        return true;
+    return zen::makeSortDirection(std::less(), std::bool_constant<ascending>())(lhs.getSyncOperation(), rhs.getSyncOperation());
+}
+
 
-    //------- presort by folder pair ----------
+template <bool ascending>
+struct LessCmpResult
+{
+    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
     {
-        auto itL = sortedPos.find(&fsObjL->base());
-        auto itR = sortedPos.find(&fsObjR->base());
-        assert(itL != sortedPos.end() && itR != sortedPos.end());
-        if (itL == sortedPos.end()) //invalid rows shall appear at the end
+        const FileSystemObject* fsObjA = FileSystemObject::retrieve(lhs);
+        const FileSystemObject* fsObjB = FileSystemObject::retrieve(rhs);
+        if (!fsObjA) //invalid rows shall appear at the end
             return false;
-        else if (itR == sortedPos.end())
+        else if (!fsObjB)
             return true;
 
-        const size_t basePosL = itL->second;
-        const size_t basePosR = itR->second;
-
-        if (basePosL != basePosR)
-            return zen::makeSortDirection(std::less(), std::bool_constant<ascending>())(basePosL, basePosR);
+        return lessCmpResult<ascending>(*fsObjA, *fsObjB);
     }
+};
 
-    //------- sort component-wise ----------
-    const auto folderL = dynamic_cast<const FolderPair*>(fsObjL);
-    const auto folderR = dynamic_cast<const FolderPair*>(fsObjR);
-
-    std::vector<const FolderPair*>& parentsBuf = tempBuf; //from bottom to top of hierarchy, excluding base
-    parentsBuf.clear();
-
-    const auto collectParents = [&](const FileSystemObject* fsObj)
-    {
-        for (;;)
-            if (const auto folder = dynamic_cast<const FolderPair*>(&fsObj->parent())) //perf: most expensive part of this function!
-            {
-                parentsBuf.push_back(folder);
-                fsObj = folder;
-            }
-            else
-                break;
-    };
-    if (folderL)
-        parentsBuf.push_back(folderL);
-    collectParents(fsObjL);
-    const size_t parentsSizeL = parentsBuf.size();
-
-    if (folderR)
-        parentsBuf.push_back(folderR);
-    collectParents(fsObjR);
-
-    const std::span<const FolderPair*> parentsL(parentsBuf.data(), parentsSizeL); //no construction via iterator (yet): https://github.com/cplusplus/draft/pull/3456
-    const std::span<const FolderPair*> parentsR(parentsBuf.data() + parentsSizeL, parentsBuf.size() - parentsSizeL);
 
-    const auto& [itL, itR] = std::mismatch(parentsL.rbegin(), parentsL.rend(),
-                                           parentsR.rbegin(), parentsR.rend());
-    if (itL == parentsL.rend())
+template <bool ascending>
+struct LessSyncDirection
+{
+    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
     {
-        if (itR == parentsR.rend())
-        {
-            //make folders always appear before contained files
-            if (folderR)
-                return false;
-            else if (folderL)
-                return true;
-
-            return zen::makeSortDirection(LessNaturalSort(), std::bool_constant<ascending>())(fsObjL->getItemNameAny(), fsObjR->getItemNameAny());
-        }
-        else
+        const FileSystemObject* fsObjA = FileSystemObject::retrieve(lhs);
+        const FileSystemObject* fsObjB = FileSystemObject::retrieve(rhs);
+        if (!fsObjA) //invalid rows shall appear at the end
+            return false;
+        else if (!fsObjB)
             return true;
-    }
-    else if (itR == parentsR.rend())
-        return false;
 
-    //different components...
-    if (const std::weak_ordering cmp = compareNatural((*itL)->getItemNameAny(), (*itR)->getItemNameAny());
-        cmp != std::weak_ordering::equivalent)
-    {
-        if constexpr (ascending)
-            return std::is_lt(cmp);
-        else
-            return std::is_gt(cmp);
+        return lessSyncDirection<ascending>(*fsObjA, *fsObjB);
     }
-    //return zen::makeSortDirection(std::less(), std::bool_constant<ascending>())(rv, 0);
-
-    /*...with equivalent names:
-        1. functional correctness => must not compare equal!  e.g. a/a/x and a/A/y
-        2. ensure stable sort order                                                            */
-    return *itL < *itR;
-}
+};
 
 
-template <bool ascending, SelectSide side> inline
-bool lessFilesize(const FileSystemObject& lhs, const FileSystemObject& rhs)
+/*  tens of millions of rows: don't evaluate FileSystemObjects during each comparison (ObjectId lookup, dynamic_cast, string normalization, ...)
+    => precompute a sort key per row once, then sort the keys in parallel                                                                     */
+template <class Value>
+struct SortKey
 {
-    //empty rows always last
-    if (lhs.isEmpty<side>())
-        return false;
-    else if (rhs.isEmpty<side>())
-        return true;
-
-    //directories second last
-    if (isDirectoryPair(lhs))
-        return false;
-    else if (isDirectoryPair(rhs))
-        return true;
+    unsigned char tier = 0; //e.g. directories after files, empty rows last: independent from sort direction
+    Value value{};
+    FileSystemObject::ObjectId objId = nullptr;
+};
 
-    const FilePair* fileL = dynamic_cast<const FilePair*>(&lhs);
-    const FilePair* fileR = dynamic_cast<const FilePair*>(&rhs);
 
-    //then symlinks
-    if (!fileL)
-        return false;
-    else if (!fileR)
-        return true;
+template <class Value>
+struct LessSortKey
+{
+    bool ascending = true;
 
-    //return list beginning with largest files first
-    return zen::makeSortDirection(std::less(), std::bool_constant<ascending>())(fileL->getFileSize<side>(), fileR->getFileSize<side>());
-}
+    bool operator()(const SortKey<Value>& lhs, const SortKey<Value>& rhs) const
+    {
+        if (lhs.tier != rhs.tier)
+            return lhs.tier < rhs.tier;
 
+        return ascending ? lhs.value < rhs.value : rhs.value < lhs.value;
+    }
+};
 
-template <bool ascending, SelectSide side> inline
-bool lessFiletime(const FileSystemObject& lhs, const FileSystemObject& rhs)
-{
-    if (lhs.isEmpty<side>())
-        return false; //empty rows always last
-    else if (rhs.isEmpty<side>())
-        return true; //empty rows always last
 
-    const FilePair* fileL = dynamic_cast<const FilePair*>(&lhs);
-    const FilePair* fileR = dynamic_cast<const FilePair*>(&rhs);
+const size_t SORT_ROWS_PER_THREAD_MIN = 100'000; //don't bother with threads for small views
 
-    const SymlinkPair* symlinkL = dynamic_cast<const SymlinkPair*>(&lhs);
-    const SymlinkPair* symlinkR = dynamic_cast<const SymlinkPair*>(&rhs);
+size_t getSortThreadCount(size_t rowCount) { return std::clamp<size_t>(rowCount / SORT_ROWS_PER_THREAD_MIN, 1, std::max<size_t>(std::thread::hardware_concurrency(), 1)); }
 
-    if (!fileL && !symlinkL)
-        return false; //directories last
-    else if (!fileR && !symlinkR)
-        return true; //directories last
 
-    const int64_t dateL = fileL ? fileL->getLastWriteTime<side>() : symlinkL->getLastWriteTime<side>();
-    const int64_t dateR = fileR ? fileR->getLastWriteTime<side>() : symlinkR->getLastWriteTime<side>();
+template <class Function> //fun(size_t rowFirst, size_t rowLast)
+void runParallel(size_t rowCount, Function fun)
+{
+    const size_t threadCount = getSortThreadCount(rowCount);
+    if (threadCount == 1)
+        return fun(0, rowCount);
 
-    //return list beginning with newest files first
-    return zen::makeSortDirection(std::less(), std::bool_constant<ascending>())(dateL, dateR);
+    ThreadGroup<std::function<void()>> tg(threadCount, Zstr("Sort view"));
+    for (size_t i = 0; i < threadCount; ++i)
+        tg.run([&fun, rowFirst = rowCount * i / threadCount, rowLast = rowCount * (i + 1) / threadCount] { fun(rowFirst, rowLast); });
+    tg.wait();
 }
 
 
-template <bool ascending, SelectSide side> inline
-bool lessExtension(const FileSystemObject& lhs, const FileSystemObject& rhs)
+template <class Value>
+void parallelSort(std::vector<SortKey<Value>>& keys, const LessSortKey<Value>& less, bool stable)
 {
-    if (lhs.isEmpty<side>())
-        return false; //empty rows always last
-    else if (rhs.isEmpty<side>())
-        return true; //empty rows always last
+    const size_t threadCount = getSortThreadCount(keys.size());
 
-    if (dynamic_cast<const FolderPair*>(&lhs))
-        return false; //directories last
-    else if (dynamic_cast<const FolderPair*>(&rhs))
-        return true; //directories last
+    std::vector<size_t> bounds;
+    for (size_t i = 0; i <= threadCount; ++i)
+        bounds.push_back(keys.size() * i / threadCount);
 
-    auto getExtension = [](const FileSystemObject& fsObj)
+    runParallel(keys.size(), [&](size_t rowFirst, size_t rowLast)
     {
-        return afterLast(fsObj.getItemName<side>(), Zstr('.'), zen::IfNotFoundReturn::none);
-    };
-
-    return zen::makeSortDirection(LessNaturalSort() /*even on Linux*/, std::bool_constant<ascending>())(getExtension(lhs), getExtension(rhs));
-}
-
+        if (stable)
+            std::stable_sort(keys.begin() + rowFirst, keys.begin() + rowLast, less);
+        else
+            std::sort(keys.begin() + rowFirst, keys.begin() + rowLast, less);
+    });
 
-template <bool ascending> inline
-bool lessCmpResult(const FileSystemObject& lhs, const FileSystemObject& rhs)
-{
-    return zen::makeSortDirection([](CompareFileResult lhs2, CompareFileResult rhs2)
+    //merge sorted ranges pairwise: std::inplace_merge() is stable
+    ThreadGroup<std::function<void()>> tg(threadCount, Zstr("Sort view"));
+    for (size_t step = 1; step < threadCount; step *= 2)
     {
-        //presort: equal shall appear at end of list
-        if (lhs2 == FILE_EQUAL)
-            return false;
-        if (rhs2 == FILE_EQUAL)
-            return true;
-        return lhs2 < rhs2;
-    },
-    std::bool_constant<ascending>())(lhs.getCategory(), rhs.getCategory());
+        for (size_t i = 0; i + step < threadCount; i += 2 * step)
+            tg.run([&keys, &less, first  = bounds[i],
+                                  middle = bounds[i + step],
+                                  last   = bounds[std::min(i + 2 * step, threadCount)]]
+        { std::inplace_merge(keys.begin() + first, keys.begin() + middle, keys.begin() + last, less); });
+        tg.wait();
+    }
 }
 
 
-template <bool ascending> inline
-bool lessSyncDirection(const FileSystemObject& lhs, const FileSystemObject& rhs)
+size_t moveInvalidRowsToEnd(std::vector<FileSystemObject::ObjectId>& sortedRef) //return number of valid rows
 {
-    return zen::makeSortDirection(std::less(), std::bool_constant<ascending>())(lhs.getSyncOperation(), rhs.getSyncOperation());
+    //invalid rows shall appear at the end
+    return std::stable_partition(sortedRef.begin(), sortedRef.end(), [](FileSystemObject::ObjectId objId) { return FileSystemObject::retrieve(objId) != nullptr; }) - sortedRef.begin();
 }
 
 
-template <bool ascending, SelectSide side>
-struct LessFullPath
+//keys: one per valid row at the beginning of sortedRef
+template <class Value>
+void sortRows(std::vector<FileSystemObject::ObjectId>& sortedRef, std::vector<SortKey<Value>>& keys, bool ascending, bool stable)
 {
-    LessFullPath(std::vector<std::tuple<const void* /*BaseFolderPair*/, AbstractPath, AbstractPath>> folderPairs)
+    if (std::is_sorted(keys.begin(), keys.end(), LessSortKey<Value>{ascending}))
+        return;
+
+    if (std::is_sorted(keys.begin(), keys.end(), LessSortKey<Value>{!ascending})) //user clicked the same column again: just reverse
     {
-        //calculate positions of base folders sorted by name
-        std::sort(folderPairs.begin(), folderPairs.end(), [](const auto& a, const auto& b)
+        for (auto itTier = keys.begin(); itTier != keys.end();)
         {
-            const auto& [baseObjA, basePathLA, basePathRA] = a;
-            const auto& [baseObjB, basePathLB, basePathRB] = b;
+            const auto itTierEnd = std::find_if(itTier, keys.end(), [tier = itTier->tier](const SortKey<Value>& key) { return key.tier != tier; });
+            std::reverse(itTier, itTierEnd);
 
-            const AbstractPath& basePathA = SelectParam<side>::ref(basePathLA, basePathRA);
-            const AbstractPath& basePathB = SelectParam<side>::ref(basePathLB, basePathRB);
+            for (auto it = itTier; it != itTierEnd;) //keep order of equivalent items: same result as stable sort
+            {
+                const auto itRunEnd = std::find_if(it + 1, itTierEnd, [&](const SortKey<Value>& key) { return key.value != it->value; });
+                std::reverse(it, itRunEnd);
+                it = itRunEnd;
+            }
+            itTier = itTierEnd;
+        }
+    }
+    else
+        parallelSort(keys, LessSortKey<Value>{ascending}, stable);
 
-            return LessNaturalSort()/*even on Linux*/(zen::utfTo<Zstring>(AFS::getDisplayPath(basePathA)),
-                                                      zen::utfTo<Zstring>(AFS::getDisplayPath(basePathB)));
-        });
+    std::transform(keys.begin(), keys.end(), sortedRef.begin(), [](const SortKey<Value>& key) { return key.objId; });
+}
 
-        size_t pos = 0;
-        for (const auto& [baseObj, basePathL, basePathR] : folderPairs)
-            sortedPos_.ref().emplace(baseObj, pos++);
-    }
 
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
+//getKey(const FileSystemObject& fsObj, SortKey<Value>& key): thread-safe!
+template <class Value, class GetKey>
+void sortByKey(std::vector<FileSystemObject::ObjectId>& sortedRef, GetKey getKey, bool ascending, bool stable)
+{
+    std::vector<SortKey<Value>> keys(moveInvalidRowsToEnd(sortedRef));
+
+    runParallel(keys.size(), [&](size_t rowFirst, size_t rowLast)
     {
-        return lessFilePath<ascending>(lhs, rhs, sortedPos_.ref(), tempBuf_);
-    }
+        for (size_t row = rowFirst; row < rowLast; ++row)
+        {
+            keys[row].objId = sortedRef[row];
+            getKey(*FileSystemObject::retrieve(sortedRef[row]), keys[row]);
+        }
+    });
 
-private:
-    SharedRef<std::unordered_map<const void* /*BaseFolderPair*/, size_t /*position*/>> sortedPos_ = makeSharedRef<std::unordered_map<const void*, size_t>>();
-    mutable std::vector<const FolderPair*> tempBuf_; //avoid repeated memory allocation in lessFilePath()
-};
+    sortRows(sortedRef, keys, ascending, stable);
+}
 
 
-template <bool ascending>
-struct LessRelativeFolder
+template <SelectSide side>
+void sortByFileName(std::vector<FileSystemObject::ObjectId>& sortedRef, bool ascending)
 {
-    LessRelativeFolder(const std::vector<std::tuple<const void* /*BaseFolderPair*/, AbstractPath, AbstractPath>>& folderPairs)
+    //sort order: first files/symlinks, then directories then empty rows
+    sortByKey<std::string>(sortedRef, [](const FileSystemObject& fsObj, SortKey<std::string>& key)
     {
-        //take over positions of base folders as set up by user
-        size_t pos = 0;
-        for (const auto& [baseObj, basePathL, basePathR] : folderPairs)
-            sortedPos_.ref().emplace(baseObj, pos++);
-    }
+        if (fsObj.isEmpty<side>())
+            key.tier = 2; //empty rows always last
+        else
+        {
+            key.tier = isDirectoryPair(fsObj) ? 1 : 0; //directories after files/symlinks
+            key.value = getNaturalSortKey(fsObj.getItemName<side>()); //sort directories and files/symlinks by short name; LessNaturalSort even on Linux
+        }
+    }, ascending, false /*stable*/);
+}
 
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
-    {
-        return lessFilePath<ascending>(lhs, rhs, sortedPos_.ref(), tempBuf_);
-    }
 
-private:
-    SharedRef<std::unordered_map<const void* /*BaseFolderPair*/, size_t /*position*/>> sortedPos_ = makeSharedRef<std::unordered_map<const void*, size_t>>();
-    mutable std::vector<const FolderPair*> tempBuf_; //avoid repeated memory allocation in lessFilePath()
-};
+template <SelectSide side>
+void sortByFileSize(std::vector<FileSystemObject::ObjectId>& sortedRef, bool ascending)
+{
+    sortByKey<uint64_t>(sortedRef, [](const FileSystemObject& fsObj, SortKey<uint64_t>& key)
+    {
+        if (fsObj.isEmpty<side>())
+            key.tier = 3; //empty rows always last
+        else if (isDirectoryPair(fsObj))
+            key.tier = 2; //directories second last
+        else if (const FilePair* file = dynamic_cast<const FilePair*>(&fsObj))
+            key.value = file->getFileSize<side>();
+        else
+            key.tier = 1; //then symlinks
+    }, ascending, false /*stable*/);
+}
 
 
-template <bool ascending, SelectSide side>
-struct LessFileName
+template <SelectSide side>
+void sortByFileTime(std::vector<FileSystemObject::ObjectId>& sortedRef, bool ascending)
 {
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
+    sortByKey<int64_t>(sortedRef, [](const FileSystemObject& fsObj, SortKey<int64_t>& key)
     {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(lhs);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(rhs);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
-
-        return lessFileName<ascending, side>(*fsObjA, *fsObjB);
-    }
-};
+        if (fsObj.isEmpty<side>())
+            key.tier = 2; //empty rows always last
+        else if (const FilePair* file = dynamic_cast<const FilePair*>(&fsObj))
+            key.value = file->getLastWriteTime<side>();
+        else if (const SymlinkPair* symlink = dynamic_cast<const SymlinkPair*>(&fsObj))
+            key.value = symlink->getLastWriteTime<side>();
+        else
+            key.tier = 1; //directories last
+    }, ascending, false /*stable*/);
+}
 
 
-template <bool ascending, SelectSide side>
-struct LessFilesize
+template <SelectSide side>
+void sortByExtension(std::vector<FileSystemObject::ObjectId>& sortedRef, bool ascending)
 {
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
+    sortByKey<std::string>(sortedRef, [](const FileSystemObject& fsObj, SortKey<std::string>& key)
     {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(lhs);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(rhs);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
+        if (fsObj.isEmpty<side>())
+            key.tier = 2; //empty rows always last
+        else if (isDirectoryPair(fsObj))
+            key.tier = 1; //directories last
+        else
+            key.value = getNaturalSortKey(afterLast(fsObj.getItemName<side>(), Zstr('.'), zen::IfNotFoundReturn::none)); //LessNaturalSort even on Linux
+    }, ascending, true /*stable*/);
+}
 
-        return lessFilesize<ascending, side>(*fsObjA, *fsObjB);
-    }
-};
+
+//take over positions of base folders as set up by user
+std::unordered_map<const void* /*BaseFolderPair*/, size_t /*position*/> getBasePositions(const std::vector<std::tuple<const void* /*BaseFolderPair*/, AbstractPath, AbstractPath>>& folderPairs)
+{
+    std::unordered_map<const void*, size_t> sortedPos;
+    size_t pos = 0;
+    for (const auto& [baseObj, basePathL, basePathR] : folderPairs)
+        sortedPos.emplace(baseObj, pos++);
+    return sortedPos;
+}
 
 
-template <bool ascending, SelectSide side>
-struct LessFiletime
+//calculate positions of base folders sorted by name
+template <SelectSide side>
+std::unordered_map<const void* /*BaseFolderPair*/, size_t /*position*/> getBasePositionsByPath(std::vector<std::tuple<const void* /*BaseFolderPair*/, AbstractPath, AbstractPath>> folderPairs)
 {
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
+    std::sort(folderPairs.begin(), folderPairs.end(), [](const auto& a, const auto& b)
     {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(lhs);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(rhs);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
+        const auto& [baseObjA, basePathLA, basePathRA] = a;
+        const auto& [baseObjB, basePathLB, basePathRB] = b;
 
-        return lessFiletime<ascending, side>(*fsObjA, *fsObjB);
-    }
-};
+        const AbstractPath& basePathA = SelectParam<side>::ref(basePathLA, basePathRA);
+        const AbstractPath& basePathB = SelectParam<side>::ref(basePathLB, basePathRB);
+
+        return LessNaturalSort()/*even on Linux*/(zen::utfTo<Zstring>(AFS::getDisplayPath(basePathA)),
+                                                  zen::utfTo<Zstring>(AFS::getDisplayPath(basePathB)));
+    });
+    return getBasePositions(folderPairs);
+}
 
 
-template <bool ascending, SelectSide side>
-struct LessExtension
+/*  sort component-wise: byte-wise comparison of keys is equivalent to:
+        1. presort by folder pair
+        2. files/symlinks before sub folders
+        3. folders before contained items
+        4. equivalent folder names: must not compare equal! e.g. a/a/x and a/A/y  => sort by FolderPair address
+    sort direction applies to folder pair position and names only => bake into key                                */
+void sortByFilePath(std::vector<FileSystemObject::ObjectId>& sortedRef, const std::unordered_map<const void* /*BaseFolderPair*/, size_t /*position*/>& sortedPos, bool ascending)
 {
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
+    const auto appendName = [ascending](std::string& key, const Zstring& itemName)
     {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(lhs);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(rhs);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
+        const size_t nameBegin = key.size();
+        key += getNaturalSortKey(itemName);
+        key += '\0'; //"nothing" before "something": no name key is a prefix of a different one
+        if (!ascending)
+            std::for_each(key.begin() + nameBegin, key.end(), [](char& c) { c = static_cast<char>(~c); });
+    };
 
-        return lessExtension<ascending, side>(*fsObjA, *fsObjB);
-    }
-};
+    const auto appendNumber = [](std::string& key, uint64_t num) //big-endian: byte-wise comparison
+    {
+        for (int i = 7; i >= 0; --i)
+            key += static_cast<char>(num >> (8 * i));
+    };
 
+    //key prefixes for all parent folders: computed only once per folder
+    std::unordered_map<const ContainerObject*, std::string> prefixes;
 
-template <bool ascending>
-struct LessCmpResult
-{
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
+    const std::function<const std::string& (const ContainerObject& hierObj)> getPrefix = [&](const ContainerObject& hierObj) -> const std::string&
     {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(lhs);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(rhs);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
+        if (auto it = prefixes.find(&hierObj);
+            it != prefixes.end())
+            return it->second;
 
-        return lessCmpResult<ascending>(*fsObjA, *fsObjB);
-    }
-};
+        std::string prefix;
+        if (const auto folder = dynamic_cast<const FolderPair*>(&hierObj))
+        {
+            prefix = getPrefix(folder->parent());
+            prefix += '\x02'; //sub folders after files/symlinks
+            appendName(prefix, folder->getItemNameAny());
+            appendNumber(prefix, reinterpret_cast<uintptr_t>(folder)); //ensure stable sort order
+        }
+        else
+        {
+            auto itPos = sortedPos.find(static_cast<const void*>(dynamic_cast<const BaseFolderPair*>(&hierObj)));
+            assert(itPos != sortedPos.end());
+            const size_t basePos = itPos != sortedPos.end() ? itPos->second : sortedPos.size();
+            appendNumber(prefix, ascending ? basePos : ~static_cast<uint64_t>(basePos));
+        }
+        return prefixes.emplace(&hierObj, std::move(prefix)).first->second;
+    };
 
+    std::vector<SortKey<std::string>> keys(moveInvalidRowsToEnd(sortedRef));
 
-template <bool ascending>
-struct LessSyncDirection
-{
-    bool operator()(const FileSystemObject::ObjectId& lhs, const FileSystemObject::ObjectId& rhs) const
+    //not thread-safe: fill prefixes before going parallel
+    std::vector<const std::string*> rowPrefixes(keys.size());
+    for (size_t row = 0; row < keys.size(); ++row)
     {
-        const FileSystemObject* fsObjA = FileSystemObject::retrieve(lhs);
-        const FileSystemObject* fsObjB = FileSystemObject::retrieve(rhs);
-        if (!fsObjA) //invalid rows shall appear at the end
-            return false;
-        else if (!fsObjB)
-            return true;
-
-        return lessSyncDirection<ascending>(*fsObjA, *fsObjB);
+        const FileSystemObject& fsObj = *FileSystemObject::retrieve(sortedRef[row]);
+        if (const auto folder = dynamic_cast<const FolderPair*>(&fsObj))
+            rowPrefixes[row] = &getPrefix(*folder);
+        else
+            rowPrefixes[row] = &getPrefix(fsObj.parent());
     }
-};
+
+    runParallel(keys.size(), [&](size_t rowFirst, size_t rowLast)
+    {
+        for (size_t row = rowFirst; row < rowLast; ++row)
+        {
+            const FileSystemObject& fsObj = *FileSystemObject::retrieve(sortedRef[row]);
+            SortKey<std::string>& key = keys[row];
+
+            key.objId = sortedRef[row];
+            key.value = *rowPrefixes[row];
+            if (!isDirectoryPair(fsObj))
+            {
+                key.value += '\x01'; //files/symlinks before sub folders
+                appendName(key.value, fsObj.getItemNameAny());
+            }
+        }
+    });
+
+    sortRows(sortedRef, keys, true /*ascending: sort direction is part of the key*/, false /*stable*/);
+}
 }
 
 //-------------------------------------------------------------------------------------------------------
@@ -783,6 +812,7 @@ void FileView::sortView(ColumnTypeRim type, ItemPathFormat pathFmt, bool onLeft,
     groupDetails_          .clear();
     rowPositions_          .clear();
     rowPositionsFirstChild_.clear();
+    rowPositionsValid_ = false;
     currentSort_ = SortInfo({type, onLeft, ascending});
 
     switch (type)
@@ -791,43 +821,33 @@ void FileView::sortView(ColumnTypeRim type, ItemPathFormat pathFmt, bool onLeft,
             switch (pathFmt)
             {
                 case ItemPathFormat::name:
-                    if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFileName<true,   SelectSide::left>());
-                    else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFileName<true,  SelectSide::right>());
-                    else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFileName<false,  SelectSide::left>());
-                    else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFileName<false, SelectSide::right>());
+                    if (onLeft) sortByFileName<SelectSide::left >(sortedRef_, ascending);
+                    else        sortByFileName<SelectSide::right>(sortedRef_, ascending);
                     break;
 
                 case ItemPathFormat::relative:
-                    if      ( ascending) std::sort(sortedRef_.begin(), sortedRef_.end(), LessRelativeFolder<true >(folderPairs_));
-                    else if (!ascending) std::sort(sortedRef_.begin(), sortedRef_.end(), LessRelativeFolder<false>(folderPairs_));
+                    sortByFilePath(sortedRef_, getBasePositions(folderPairs_), ascending);
                     break;
 
                 case ItemPathFormat::full:
-                    if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<true,   SelectSide::left>(folderPairs_));
-                    else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<true,  SelectSide::right>(folderPairs_));
-                    else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<false,  SelectSide::left>(folderPairs_));
-                    else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFullPath<false, SelectSide::right>(folderPairs_));
+                    sortByFilePath(sortedRef_, onLeft ?
+                                   getBasePositionsByPath<SelectSide::left >(folderPairs_) :
+                                   getBasePositionsByPath<SelectSide::right>(folderPairs_), ascending);
                     break;
             }
             break;
 
         case ColumnTypeRim::size:
-            if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<true,   SelectSide::left>());
-            else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<true,  SelectSide::right>());
-            else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<false,  SelectSide::left>());
-            else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFilesize<false, SelectSide::right>());
+            if (onLeft) sortByFileSize<SelectSide::left >(sortedRef_, ascending);
+            else        sortByFileSize<SelectSide::right>(sortedRef_, ascending);
             break;
         case ColumnTypeRim::date:
-            if      ( ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<true,   SelectSide::left>());
-            else if ( ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<true,  SelectSide::right>());
-            else if (!ascending &&  onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<false,  SelectSide::left>());
-            else if (!ascending && !onLeft) std::sort(sortedRef_.begin(), sortedRef_.end(), LessFiletime<false, SelectSide::right>());
+            if (onLeft) sortByFileTime<SelectSide::left >(sortedRef_, ascending);
+            else        sortByFileTime<SelectSide::right>(sortedRef_, ascending);
             break;
         case ColumnTypeRim::extension:
-            if      ( ascending &&  onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<true,   SelectSide::left>());
-            else if ( ascending && !onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<true,  SelectSide::right>());
-            else if (!ascending &&  onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<false,  SelectSide::left>());
-            else if (!ascending && !onLeft) std::stable_sort(sortedRef_.begin(), sortedRef_.end(), LessExtension<false, SelectSide::right>());
+            if (onLeft) sortByExtension<SelectSide::left >(sortedRef_, ascending);
+            else        sortByExtension<SelectSide::right>(sortedRef_, ascending);
             break;
     }
 }
@@ -839,6 +859,7 @@ void FileView::sortView(ColumnTypeCenter type, bool ascending)
     groupDetails_          .clear();
     rowPositions_          .clear();
     rowPositionsFirstChild_.clear();
+    rowPositionsValid_ = false;
     currentSort_ = SortInfo({type, false, ascending});
 
     switch (type)
@@ -14,6 +14,7 @@
 #include <zen/stl_tools.h>
 #include "file_grid_attr.h"
 #include "../base/file_hierarchy.h"
+#include "../base/cmp_columns.h"
 
 
 namespace fff
@@ -33,6 +34,7 @@ public:
 
     //references to FileSystemObject: no nullptr-check needed! everything is bound
     std::vector<FileSystemObject*> getAllFileRef(const std::vector<size_t>& rows);
+    std::vector<FileSystemObject*> getAllFileRef(const std::vector<std::pair<size_t, size_t>>& rowRanges); //half-open [rowFirst, rowLast)
 
     struct PathDrawInfo
     {
@@ -125,16 +127,22 @@ public:
     //count non-empty pairs to distinguish single/multiple folder pair cases
     size_t getEffectiveFolderPairCount() const;
 
+    //all rows (visible or not) as of the last applyDifferenceFilter()/applyActionFilter()
+    const ComparisonColumns& getColumns() const { return columns_; }
+
 private:
     FileView           (const FileView&) = delete;
     FileView& operator=(const FileView&) = delete;
 
-    template <class Predicate> void updateView(Predicate pred);
+    template <class Predicate> void updateView(Predicate pred); //pred(size_t colRow): row index into columns_
+
 
+    void updateRowPositions() const; //lazy: only needed for findRow*()
 
-    std::unordered_map<FileSystemObject::ObjectIdConst, size_t> rowPositions_; //find row positions on viewRef_ directly
-    std::unordered_map<const void* /*ContainerObject*/, size_t> rowPositionsFirstChild_; //find first child on sortedRef of a hierarchy object
+    mutable std::unordered_map<FileSystemObject::ObjectIdConst, size_t, FileSystemObject::ObjectIdConst::Hash> rowPositions_; //find row positions on viewRef_ directly
+    mutable std::unordered_map<const void* /*ContainerObject*/, size_t> rowPositionsFirstChild_; //find first child on sortedRef of a hierarchy object
     //void* instead of ContainerObject*: these are weak pointers and should *never be dereferenced*!
+    mutable bool rowPositionsValid_ = false;
 
     struct GroupDetail
     {
@@ -153,6 +161,8 @@ private:
     /*             /|\
                     | (applyFilterBy...)      */
     std::vector<FileSystemObject::ObjectId> sortedRef_; //flat view of weak pointers on folderCmp; may be sorted
+
+    ComparisonColumns columns_; //packed snapshot of all valid rows on sortedRef_, rebuilt by updateView()
     /*             /|\
                     | (constructor)
            FolderComparison folderCmp         */
@@ -8,6 +8,7 @@
 #include <zen/process_exec.h>
 #include <zen/shutdown.h>
 #include <zen/resolve_path.h>
+#include <zen/perf.h>
 #include <wx/app.h>
 #include <wx/sound.h>
 #include <wx/wupdlock.h>
@@ -15,6 +16,7 @@
 #include "main_dlg.h"
 #include "../afs/concrete.h"
 #include "../log_file.h"
+#include "../metrics_file.h"
 #include "../fatal_error.h"
 
 using namespace zen;
@@ -168,7 +170,8 @@ StatusHandlerTemporaryPanel::Result StatusHandlerTemporaryPanel::reportResults()
         startTime_, syncResult, {} /*jobName*/,
         getStatsCurrent(),
         getStatsTotal  (),
-        totalTime
+        totalTime,
+        getPeakMemory()
     };
 
     auto errorLogFinal = makeSharedRef<const ErrorLog>(std::move(errorLog_));
@@ -236,6 +239,8 @@ ProcessCallback::Response StatusHandlerTemporaryPanel::reportError(const ErrorIn
     if (errorInfo.retryNumber < autoRetryCount_)
     {
         errorLog_.logMsg(errorInfo.msg + L"\n-> " + _("Automatic retry"), MSG_TYPE_INFO);
+        addMetricCount("retries", [] { return std::string(); }, 1);
+        const TraceSpan span("retry backoff"); //metrics: waiting for automatic retry
         delayAndCountDown(errorInfo.failTime + autoRetryDelay_,
                           [&, statusPrefix  = _("Automatic retry") +
                                               (errorInfo.retryNumber == 0 ? L"" : L' ' + formatNumber(errorInfo.retryNumber + 1)) + L" | ",
@@ -352,6 +357,7 @@ StatusHandlerFloatingDialog::StatusHandlerFloatingDialog(wxFrame* parentDlg,
                                                          const Zstring& soundFileAlertPending,
                                                          const wxSize& progressDlgSize, bool dlgMaximize,
                                                          bool autoCloseDialog,
+                                                         bool showDiagnostics,
                                                          const ErrorLog* errorLogStart) :
     jobNames_(jobNames),
     startTime_(startTime),
@@ -359,7 +365,7 @@ StatusHandlerFloatingDialog::StatusHandlerFloatingDialog(wxFrame* parentDlg,
     autoRetryDelay_(autoRetryDelay),
     soundFileSyncComplete_(soundFileSyncComplete),
     soundFileAlertPending_(soundFileAlertPending),
-    progressDlg_(SyncProgressDialog::create(progressDlgSize, dlgMaximize, [this] { userRequestAbort(); }, *this, parentDlg, true /*showProgress*/, autoCloseDialog,
+    progressDlg_(SyncProgressDialog::create(progressDlgSize, dlgMaximize, [this] { userRequestAbort(); }, *this, parentDlg, true /*showProgress*/, autoCloseDialog, showDiagnostics,
 jobNames, std::chrono::system_clock::to_time_t(startTime), ignoreErrors, autoRetryCount, PostSyncAction2::none))
 {
     if (errorLogStart)
@@ -375,7 +381,7 @@ StatusHandlerFloatingDialog::~StatusHandlerFloatingDialog()
 
 
 StatusHandlerFloatingDialog::Result StatusHandlerFloatingDialog::reportResults(const Zstring& postSyncCommand, PostSyncCondition postSyncCondition,
-                                                                               const Zstring& altLogFolderPathPhrase, int logfilesMaxAgeDays, LogFileFormat logFormat,
+                                                                               const Zstring& altLogFolderPathPhrase, int logfilesMaxAgeDays, LogFileFormat logFormat, bool logFileGzip,
                                                                                const std::set<AbstractPath>& logFilePathsToKeep,
                                                                                const std::string& emailNotifyAddress, ResultsNotification emailNotifyCondition)
 {
@@ -409,10 +415,11 @@ StatusHandlerFloatingDialog::Result StatusHandlerFloatingDialog::reportResults(c
         startTime_, syncResult, jobNames_,
         getStatsCurrent(),
         getStatsTotal  (),
-        totalTime
+        totalTime,
+        getPeakMemory()
     };
 
-    const AbstractPath logFilePath = generateLogFilePath(logFormat, summary, altLogFolderPathPhrase);
+    const AbstractPath logFilePath = generateLogFilePath(logFormat, logFileGzip, summary, altLogFolderPathPhrase);
     //e.g. %AppData%\FreeFileSync\Logs\Backup FreeFileSync 2013-09-15 015052.123 [Error].log
 
     auto notifyStatusNoThrow = [&](std::wstring&& msg) { try { updateStatus(std::move(msg)); /*throw AbortProcess*/ } catch (AbortProcess&) {} };
@@ -517,6 +524,15 @@ StatusHandlerFloatingDialog::Result StatusHandlerFloatingDialog::reportResults(c
         //  RequestUserAttention(); -> probably too much since task bar is already colorized with Taskbar::STATUS_ERROR or STATUS_NORMAL
     }
 
+    //--------------------- memory usage ----------------------
+    if (metricsEnabled())
+    {
+        setMemoryUsage("error log", errorLog_.getMemoryUsage());
+        if (const std::wstring memoryMsg = getMemoryUsageMsg(getPhaseTimes());
+            !memoryMsg.empty())
+            errorLog_.logMsg(memoryMsg, MSG_TYPE_INFO);
+    }
+
     //--------------------- save log file ----------------------
     try //create not before destruction: 1. avoid issues with FFS trying to sync open log file 2. include status in log file name without extra rename
     {
@@ -606,6 +622,8 @@ ProcessCallback::Response StatusHandlerFloatingDialog::reportError(const ErrorIn
         warn_static("maybe we should consider errorInfo.failTime, and not 'now' when logging the error?")
 
         errorLog_.logMsg(errorInfo.msg + L"\n-> " + _("Automatic retry"), MSG_TYPE_INFO);
+        addMetricCount("retries", [] { return std::string(); }, 1);
+        const TraceSpan span("retry backoff"); //metrics: waiting for automatic retry
         delayAndCountDown(errorInfo.failTime + autoRetryDelay_,
                           [&, statusPrefix  = _("Automatic retry") +
                                               (errorInfo.retryNumber == 0 ? L"" : L' ' + formatNumber(errorInfo.retryNumber + 1)) + L" | ",
@@ -75,6 +75,7 @@ public:
                                 const Zstring& soundFileAlertPending,
                                 const wxSize& progressDlgSize, bool dlgMaximize,
                                 bool autoCloseDialog,
+                                bool showDiagnostics,
                                 const zen::ErrorLog* errorLogStart /*optional*/); //noexcept!
     ~StatusHandlerFloatingDialog();
 
@@ -104,7 +105,7 @@ public:
         bool autoCloseDialog;
     };
     Result reportResults(const Zstring& postSyncCommand, PostSyncCondition postSyncCondition,
-                         const Zstring& altLogFolderPathPhrase, int logfilesMaxAgeDays, LogFileFormat logFormat, const std::set<AbstractPath>& logFilePathsToKeep,
+                         const Zstring& altLogFolderPathPhrase, int logfilesMaxAgeDays, LogFileFormat logFormat, bool logFileGzip, const std::set<AbstractPath>& logFilePathsToKeep,
                          const std::string& emailNotifyAddress, ResultsNotification emailNotifyCondition); //noexcept!!
 
 private:
@@ -56,27 +56,36 @@ class fff::MessageView
 public:
     MessageView(const SharedRef<const ErrorLog>& log) : log_(log) {}
 
-    size_t rowsOnView() const { return viewRef_.size(); }
+    size_t rowsOnView() const { return viewRef_.empty() ? 0 : viewRef_.back().rowEnd; }
 
     struct LogEntryView
     {
         time_t      time = 0;
         MessageType type = MSG_TYPE_INFO;
         std::string_view messageLine;
+        Zstringc message; //keep messageLine alive: log entry may have been loaded from disk (ref-counted => no copy)
         bool firstLine = false; //if LogEntry::message spans multiple rows
     };
 
     std::optional<LogEntryView> getEntry(size_t row) const
     {
-        if (row < viewRef_.size())
+        if (row < rowsOnView())
         {
-            const Line& line = viewRef_[row];
+            const auto it = std::upper_bound(viewRef_.begin(), viewRef_.end(), row, [](size_t row2, const EntryRows& er) { return row2 < er.rowEnd; });
+            assert(it != viewRef_.end());
+            const size_t textRow = row - (it->rowEnd - it->rowCount);
+
+            //entries may be loaded from disk => buffer the one currently painted (getEntry() is called multiple times per row)
+            if (!entryBuf_ || entryBuf_->first != it->logPos)
+                entryBuf_ = {it->logPos, log_.ref().getEntry(it->logPos)};
+            const LogEntry& entry = entryBuf_->second;
 
             LogEntryView output;
-            output.time = line.logIt->time;
-            output.type = line.logIt->type;
-            output.messageLine = extractLine(line.logIt->message, line.row);
-            output.firstLine = line.row == 0; //this is virtually always correct, unless first line of the original message is empty!
+            output.time = entry.time;
+            output.type = entry.type;
+            output.message = entry.message;
+            output.messageLine = extractLine(output.message, textRow);
+            output.firstLine = textRow == 0;
             return output;
         }
         return {};
@@ -86,35 +95,23 @@ public:
     {
         viewRef_.clear();
 
-        for (auto it = log_.ref().begin(); it != log_.ref().end(); ++it)
-            if (it->type & includedTypes)
+        //use log index: no need to load (possibly millions of) log entries
+        size_t rowEnd = 0;
+        for (const ErrorLog::EntryRef& ref : log_.ref().getEntryRefs(includedTypes))
+            if (ref.lineCount > 0) //do not reference empty messages!
             {
-                assert(!startsWith(it->message, '\n'));
-
-                size_t rowNumber = 0;
-                bool lastCharNewline = true;
-                for (const char c : it->message)
-                    if (c == '\n')
-                    {
-                        if (!lastCharNewline) //do not reference empty lines!
-                            viewRef_.push_back({it, rowNumber});
-                        ++rowNumber;
-                        lastCharNewline = true;
-                    }
-                    else
-                        lastCharNewline = false;
-
-                if (!lastCharNewline)
-                    viewRef_.push_back({it, rowNumber});
+                rowEnd += ref.lineCount;
+                viewRef_.push_back({ref.pos, ref.lineCount, rowEnd});
             }
     }
 
 private:
-    static std::string_view extractLine(const Zstringc& message, size_t textRow)
+    static std::string_view extractLine(const Zstringc& message, size_t textRow) //textRow: skipping empty lines
     {
         auto it1 = message.begin();
         for (;;)
         {
+            it1 = std::find_if(it1, message.end(), [](char c) { return c != '\n'; }); //skip empty lines
             auto it2 = std::find_if(it1, message.end(), [](char c) { return c == '\n'; });
             if (textRow == 0)
                 return makeStringView(it1, it2 - it1);
@@ -125,21 +122,23 @@ private:
                 return makeStringView(it1, 0);
             }
 
-            it1 = it2 + 1; //skip newline
+            it1 = it2;
             --textRow;
         }
     }
 
-    struct Line
+    struct EntryRows
     {
-        ErrorLog::const_iterator logIt; //always bound!
-        size_t row; //LogEntry::message may span multiple rows
+        size_t logPos;   //=> ErrorLog::getEntry()
+        size_t rowCount; //LogEntry::message may span multiple rows
+        size_t rowEnd;   //accumulated row count including this entry: binary search
     };
 
-    std::vector<Line> viewRef_; //partial view on log_
+    std::vector<EntryRows> viewRef_; //partial view on log_
     /*          /|\
                  | updateView()
                  |                      */
+    mutable std::optional<std::pair<size_t /*logPos*/, LogEntry>> entryBuf_;
     const SharedRef<const ErrorLog> log_;
 };
 
@@ -10,6 +10,7 @@
 #include <zen/file_path.h>
 #include <zen/file_io.h>
 #include <zen/thread.h>
+#include <zen/time.h>
 #include <zen/process_exec.h>
 #include <zen/perf.h>
 #include <zen/shutdown.h>
@@ -42,7 +43,9 @@
 #include "app_icon.h"
 #include "../afs/concrete.h"
 #include "../afs/native.h"
+#include "../base/cmp_snapshot.h"
 #include "../base/comparison.h"
+#include "../base/file_list_csv.h"
 #include "../base/synchronization.h"
 #include "../base/algorithm.h"
 #include "../base/lock_holder.h"
@@ -426,6 +429,8 @@ void MainDialog::create(const Zstring& globalConfigFilePath,
         //continue!
     }
 
+    applyProcessSettings(globSett);
+
     MainDialog* frame = new MainDialog(globalConfigFilePath, guiCfg, referenceFiles, globSett, startComparison);
     frame->Show();
 }
@@ -958,6 +963,12 @@ onSystemShutdownRegister(onBeforeSystemShutdownCookie_);
 MainDialog::~MainDialog()
 {
             std::wstring errorMsg;
+    try //review comparison result after restart
+    {
+        saveCmpSnapshot(); //throw FileError
+    }
+    catch (const FileError& e) { errorMsg += e.toString() + L"\n\n"; }
+
     try //LastRun.ffs_gui
     {
         writeConfig(getConfig(), lastRunConfigPath_); //throw FileError
@@ -986,6 +997,9 @@ MainDialog::~MainDialog()
 
 void MainDialog::onBeforeSystemShutdown()
 {
+    try { saveCmpSnapshot(); } //throw FileError
+    catch (const FileError& e) { logFatalError(e.toString()); }
+
     try { writeConfig(getConfig(), lastRunConfigPath_); }
     catch (const FileError& e) { logFatalError(e.toString()); }
 
@@ -1073,7 +1087,7 @@ void MainDialog::setGlobalCfgOnInit(const XmlGlobalSettings& globalSettings)
     m_folderPathRight->setHistory(folderHistoryRight_);
 
     //show/hide file icons
-    filegrid::setupIcons(*m_gridMainL, *m_gridMainC, *m_gridMainR, globalSettings.mainDlg.showIcons, convert(globalSettings.mainDlg.iconSize));
+    setupFileIcons();
 
     filegrid::setItemPathForm(*m_gridMainL, globalSettings.mainDlg.itemPathFormatLeftGrid);
     filegrid::setItemPathForm(*m_gridMainR, globalSettings.mainDlg.itemPathFormatRightGrid);
@@ -1251,6 +1265,34 @@ std::vector<FileSystemObject*> expandSelectionForPartialSync(const std::vector<F
 }
 
 
+//perf: recursive operations on a selected folder already cover its child items => don't process them once more per selected child
+//(select all: O(items * depth) => O(items))
+std::vector<FileSystemObject*> removeSelectedDescendants(const std::vector<FileSystemObject*>& selection)
+{
+    std::unordered_set<const FileSystemObject*> selectedFolders;
+    for (const FileSystemObject* fsObj : selection)
+        if (dynamic_cast<const FolderPair*>(fsObj))
+            selectedFolders.insert(fsObj);
+
+    if (selectedFolders.empty())
+        return selection;
+
+    auto ancestorSelected = [&](const FileSystemObject& fsObj)
+    {
+        for (const FolderPair* folder = dynamic_cast<const FolderPair*>(&fsObj.parent()); folder; folder = dynamic_cast<const FolderPair*>(&folder->parent()))
+            if (selectedFolders.contains(folder))
+                return true;
+        return false;
+    };
+
+    std::vector<FileSystemObject*> output;
+    for (FileSystemObject* fsObj : selection)
+        if (!ancestorSelected(*fsObj))
+            output.push_back(fsObj);
+    return output;
+}
+
+
 bool selectionIncludesNonEqualItem(const std::vector<FileSystemObject*>& selection)
 {
     struct ItemFound {};
@@ -1270,10 +1312,12 @@ bool selectionIncludesNonEqualItem(const std::vector<FileSystemObject*>& selecti
 
 void MainDialog::setSyncDirManually(const std::vector<FileSystemObject*>& selection, SyncDirection direction)
 {
-    if (!selectionIncludesNonEqualItem(selection))
+    const std::vector<FileSystemObject*> selectionRoots = removeSelectedDescendants(selection);
+
+    if (!selectionIncludesNonEqualItem(selectionRoots))
         return; //harmonize with onGridContextRim(): this function should be a no-op iff context menu option is disabled!
 
-    for (FileSystemObject* fsObj : selection)
+    for (FileSystemObject* fsObj : selectionRoots)
     {
         setSyncDirectionRec(direction, *fsObj); //set new direction (recursively)
         setActiveStatus(true, *fsObj); //works recursively for directories
@@ -1290,7 +1334,7 @@ void MainDialog::setIncludedManually(const std::vector<FileSystemObject*>& selec
     if (selection.empty())
         return; //harmonize with onGridContextRim(): this function should be a no-op iff context menu option is disabled!
 
-    for (FileSystemObject* fsObj : selection)
+    for (FileSystemObject* fsObj : removeSelectedDescendants(selection))
         setActiveStatus(setActive, *fsObj); //works recursively for directories
 
     updateGuiDelayedIf(!m_bpButtonShowExcluded->isActive()); //show update GUI before removing rows
@@ -1308,16 +1352,17 @@ void MainDialog::copyGridSelectionToClipboard(const zen::Grid& grid)
             std::vector<Grid::ColAttributes> colAttr = grid.getColumnConfig();
             std::erase_if(colAttr, [](const Grid::ColAttributes& ca) { return !ca.visible; });
             if (!colAttr.empty())
-                for (size_t row : grid.getSelectedRows())
-                {
-                    std::for_each(colAttr.begin(), colAttr.end() - 1, [&](const Grid::ColAttributes& ca)
+                for (const auto& [rowFirst, rowLast] : grid.getSelectedRanges())
+                    for (size_t row = rowFirst; row < rowLast; ++row)
                     {
-                        clipBuf += prov->getValue(row, ca.type);
-                        clipBuf += L'\t';
-                    });
-                    clipBuf += prov->getValue(row, colAttr.back().type);
-                    clipBuf += L'\n';
-                }
+                        std::for_each(colAttr.begin(), colAttr.end() - 1, [&](const Grid::ColAttributes& ca)
+                        {
+                            clipBuf += prov->getValue(row, ca.type);
+                            clipBuf += L'\t';
+                        });
+                        clipBuf += prov->getValue(row, colAttr.back().type);
+                        clipBuf += L'\n';
+                    }
         }
 
         if (!clipBuf.empty())
@@ -1373,18 +1418,25 @@ void MainDialog::copyPathsToClipboard(const std::vector<FileSystemObject*>& sele
 
 std::vector<FileSystemObject*> MainDialog::getGridSelection(bool fromLeft, bool fromRight) const
 {
-    std::vector<size_t> selectedRows;
+    //perf: work on row ranges: select all on a large comparison result is a single range
+    std::vector<std::pair<size_t, size_t>> selectedRanges;
 
     if (fromLeft)
-        append(selectedRows, m_gridMainL->getSelectedRows());
+        append(selectedRanges, m_gridMainL->getSelectedRanges());
 
     if (fromRight)
-        append(selectedRows, m_gridMainR->getSelectedRows());
-
-    removeDuplicates(selectedRows);
-    assert(std::is_sorted(selectedRows.begin(), selectedRows.end()));
+        append(selectedRanges, m_gridMainR->getSelectedRanges());
+
+    //union of both sides: sorted, disjoint
+    std::sort(selectedRanges.begin(), selectedRanges.end());
+    std::vector<std::pair<size_t, size_t>> mergedRanges;
+    for (const auto& [rowFirst, rowLast] : selectedRanges)
+        if (!mergedRanges.empty() && rowFirst <= mergedRanges.back().second)
+            mergedRanges.back().second = std::max(mergedRanges.back().second, rowLast);
+        else
+            mergedRanges.emplace_back(rowFirst, rowLast);
 
-    return filegrid::getDataView(*m_gridMainC).getAllFileRef(selectedRows);
+    return filegrid::getDataView(*m_gridMainC).getAllFileRef(mergedRanges);
 }
 
 
@@ -1451,6 +1503,7 @@ void MainDialog::copyToAlternateFolder(const std::vector<FileSystemObject*>& sel
                                    globalCfg_.mainDlg.copyToCfg.targetFolderPath,
                                    globalCfg_.mainDlg.copyToCfg.keepRelPaths,
                                    globalCfg_.mainDlg.copyToCfg.overwriteIfExists,
+                                   guiCfg.mainCfg.deviceParallelOps,
                                    globalCfg_.warnDlgs,
                                    statusHandler); //throw AbortProcess
 
@@ -1497,6 +1550,7 @@ void MainDialog::deleteSelectedFiles(const std::vector<FileSystemObject*>& selec
         deleteFromGridAndHD(selectionL, selectionR,
                             extractDirectionCfg(folderCmp_, getConfig().mainCfg),
                             moveToRecycler,
+                            guiCfg.mainCfg.deviceParallelOps,
                             globalCfg_.warnDlgs.warnRecyclerMissing,
                             statusHandler); //throw AbortProcess
     }
@@ -1546,14 +1600,12 @@ void extractFileDescriptor(const FileSystemObject& fsObj, Function onDescriptor)
 
 
 template <SelectSide side>
-void collectNonNativeFiles(const std::vector<FileSystemObject*>& selectedRows, const TempFileBuffer& tempFileBuf,
-                           std::set<FileDescriptor>& workLoad)
+void collectNonNativeFiles(const std::vector<FileSystemObject*>& selectedRows, std::set<FileDescriptor>& workLoad)
 {
     for (const FileSystemObject* fsObj : selectedRows)
         extractFileDescriptor<side>(*fsObj, [&](const FileDescriptor& descr)
     {
-        if (getNativeItemPath(descr.path).empty() &&
-            tempFileBuf.getTempPath(descr).empty()) //TempFileBuffer::createTempFiles() contract!
+        if (getNativeItemPath(descr.path).empty())
             workLoad.insert(descr);
     });
 }
@@ -1710,16 +1762,17 @@ void MainDialog::openExternalApplication(const Zstring& commandLinePhrase, bool
             std::set<FileDescriptor> nonNativeFiles;
             if (contains(commandLinePhrase, Zstr("%local_path%")))
             {
-                collectNonNativeFiles<SelectSide::left >(selectionL, tempFileBuf_, nonNativeFiles);
-                collectNonNativeFiles<SelectSide::right>(selectionR, tempFileBuf_, nonNativeFiles);
+                collectNonNativeFiles<SelectSide::left >(selectionL, nonNativeFiles);
+                collectNonNativeFiles<SelectSide::right>(selectionR, nonNativeFiles);
             }
             if (contains(commandLinePhrase, Zstr("%local_path2%")))
             {
-                collectNonNativeFiles<SelectSide::right>(selectionL, tempFileBuf_, nonNativeFiles);
-                collectNonNativeFiles<SelectSide::left >(selectionR, tempFileBuf_, nonNativeFiles);
+                collectNonNativeFiles<SelectSide::right>(selectionL, nonNativeFiles);
+                collectNonNativeFiles<SelectSide::left >(selectionR, nonNativeFiles);
             }
 
             //##################### create temporary files for non-native paths ######################
+            nonNativeFiles = tempFileBuf_.getFilesToCreate(nonNativeFiles); //TempFileBuffer::createTempFiles() contract!
             if (!nonNativeFiles.empty())
             {
                 FocusPreserver fp;
@@ -1737,7 +1790,7 @@ void MainDialog::openExternalApplication(const Zstring& commandLinePhrase, bool
                                                           globalCfg_.soundFileAlertPending);
                 try
                 {
-                    tempFileBuf_.createTempFiles(nonNativeFiles, statusHandler); //throw AbortProcess
+                    tempFileBuf_.createTempFiles(nonNativeFiles, guiCfg.mainCfg.deviceParallelOps, statusHandler); //throw AbortProcess
                     //"clearSelection" not needed/desired
                 }
                 catch (AbortProcess&) {}
@@ -2686,6 +2739,14 @@ void MainDialog::onGridLabelContextC(GridLabelClickEvent& event)
 }
 
 
+void MainDialog::setupFileIcons()
+{
+    filegrid::setupIcons(*m_gridMainL, *m_gridMainC, *m_gridMainR, globalCfg_.mainDlg.showIcons, convert(globalCfg_.mainDlg.iconSize),
+                         [this](const AfsDevice& afsDevice) { return getDeviceParallelOps(currentCfg_.mainCfg.deviceParallelOps, afsDevice); },
+                         globalCfg_.mainDlg.thumbnailCache ? getConfigDirPathPf() + Zstr("Thumbnails.db") : Zstring());
+}
+
+
 void MainDialog::onGridLabelContextRim(GridLabelClickEvent& event, bool leftSide)
 {
     ContextMenu menu;
@@ -2747,7 +2808,7 @@ void MainDialog::onGridLabelContextRim(GridLabelClickEvent& event, bool leftSide
     {
         globalCfg_.mainDlg.iconSize  = sz;
         globalCfg_.mainDlg.showIcons = showIcons;
-        filegrid::setupIcons(*m_gridMainL, *m_gridMainC, *m_gridMainR, globalCfg_.mainDlg.showIcons, convert(globalCfg_.mainDlg.iconSize));
+        setupFileIcons();
     };
 
     menu.addSeparator();
@@ -2943,33 +3004,53 @@ void MainDialog::onDirManualCorrection(wxCommandEvent& event)
 
 void MainDialog::cfgHistoryRemoveObsolete(const std::vector<Zstring>& filePaths)
 {
-    auto getUnavailableCfgFilesAsync = [filePaths] //don't use wxString: NOT thread-safe! (e.g. non-atomic ref-count)
+    //group by parent folder: offline network share or usb stick => a single hanging check instead of one per config file
+    std::map<Zstring, std::vector<Zstring>, LessNativePath> filePathsByFolder;
+    for (const Zstring& filePath : filePaths)
+        if (const std::optional<Zstring> parentPath = getParentFolderPath(filePath))
+            filePathsByFolder[*parentPath].push_back(filePath);
+
+    //potentially slow network access => limit maximum wait time!
+    const auto stopTime = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+
+    for (const auto& [folderPath, folderFilePaths] : filePathsByFolder)
     {
-        std::list<std::future<bool>> availableFiles; //check existence of all config files in parallel!
+        auto getUnavailableCfgFilesAsync = [folderPath = folderPath, folderFilePaths = folderFilePaths, stopTime] //don't use wxString: NOT thread-safe! (e.g. non-atomic ref-count)
+        {
+            std::future<bool> folderAvailable = runAsync([folderPath] { return dirAvailable(folderPath); });
+            if (folderAvailable.wait_until(stopTime) == std::future_status::timeout)
+                return std::vector<Zstring>(); //remove only files that are confirmed to be non-existent
 
-        for (const Zstring& filePath : filePaths)
-            availableFiles.push_back(runAsync([=] { return fileAvailable(filePath); }));
+            if (!folderAvailable.get())
+                return folderFilePaths; //folder access error? probably not accessible network share or usb stick => remove cfg
 
-        //potentially slow network access => limit maximum wait time!
-        waitForAllTimed(availableFiles.begin(), availableFiles.end(), std::chrono::seconds(1));
+            std::list<std::future<bool>> availableFiles; //check existence of all config files in parallel!
 
-        std::vector<Zstring> pathsToRemove;
+            for (const Zstring& filePath : folderFilePaths)
+                availableFiles.push_back(runAsync([=] { return fileAvailable(filePath); }));
 
-        auto itFut = availableFiles.begin();
-        for (auto it = filePaths.begin(); it != filePaths.end(); ++it, ++itFut)
-            if (isReady(*itFut) && !itFut->get()) //remove only files that are confirmed to be non-existent
-                pathsToRemove.push_back(*it); //file access error? probably not accessible network share or usb stick => remove cfg
+            std::vector<Zstring> pathsToRemove;
 
-        return pathsToRemove;
-    };
+            auto itFut = availableFiles.begin();
+            for (auto it = folderFilePaths.begin(); it != folderFilePaths.end(); ++it, ++itFut)
+                if (itFut->wait_until(stopTime) == std::future_status::ready && !itFut->get())
+                    pathsToRemove.push_back(*it); //file access error? probably not accessible network share or usb stick => remove cfg
 
-    guiQueue_.processAsync(getUnavailableCfgFilesAsync, [this](const std::vector<Zstring>& filePaths2)
-    {
-        cfggrid::getDataView(*m_gridCfgHistory).removeItems(filePaths2);
+            return pathsToRemove;
+        };
 
-        //restore grid selection (after rows were removed)
-        cfggrid::addAndSelect(*m_gridCfgHistory, activeConfigFiles_, false /*scrollToSelection*/);
-    });
+        //update grid as soon as each folder's check is done
+        guiQueue_.processAsync(std::move(getUnavailableCfgFilesAsync), [this](const std::vector<Zstring>& filePaths2)
+        {
+            if (filePaths2.empty())
+                return;
+
+            cfggrid::getDataView(*m_gridCfgHistory).removeItems(filePaths2);
+
+            //restore grid selection (after rows were removed)
+            cfggrid::addAndSelect(*m_gridCfgHistory, activeConfigFiles_, false /*scrollToSelection*/);
+        });
+    }
 }
 
 
@@ -3750,6 +3831,9 @@ void MainDialog::setLastUsedConfig(const XmlGuiConfig& guiConfig, const std::vec
 
 void MainDialog::setConfig(const XmlGuiConfig& newGuiCfg, const std::vector<Zstring>& referenceFiles)
 {
+    try { saveCmpSnapshot(); } //throw FileError
+    catch (const FileError& e) { logFatalError(e.toString()); }
+
     currentCfg_ = newGuiCfg;
 
     //evaluate new settings...
@@ -3772,6 +3856,8 @@ void MainDialog::setConfig(const XmlGuiConfig& newGuiCfg, const std::vector<Zstr
     clearGrid(); //+ update GUI!
 
     setLastUsedConfig(newGuiCfg, referenceFiles);
+
+    restoreCmpSnapshot();
 }
 
 
@@ -4113,11 +4199,16 @@ void MainDialog::onCompare(wxCommandEvent& event)
         //COMPARE DIRECTORIES
         folderCmp_ = compare(globalCfg_.warnDlgs,
                              globalCfg_.fileTimeTolerance,
+                             getContentPrefilterMinSize(globalCfg_),
+                             false, //pruneSoftFiltered
                              true, //allowUserInteraction
                              globalCfg_.runWithBackgroundPriority,
                              globalCfg_.createLockFile,
                              dirLocks,
                              fpCfgList,
+                             guiCfg.mainCfg.deviceParallelOps,
+                             globalCfg_.autoTuneParallelOps,
+                             std::nullopt /*changeJournal*/,
                              statusHandler); //throw AbortProcess
     }
     catch (AbortProcess&) {}
@@ -4136,6 +4227,15 @@ void MainDialog::onCompare(wxCommandEvent& event)
     treegrid::setData(*m_gridOverview, folderCmp_); //
     updateGui();
 
+    if (globalCfg_.mainDlg.restoreComparison && !folderCmp_.empty()) //crash-safe: don't wait until exit
+        try
+        {
+            cmpSnapshotFilePath_ = getConfigDirPathPf() + getComparisonSnapshotName(fpCfgList);
+            cmpSnapshotTime_ = std::chrono::system_clock::to_time_t(r.summary.startTime);
+            saveCmpSnapshot(); //throw FileError
+        }
+        catch (const FileError& e) { logFatalError(e.toString()); }
+
     m_gridMainL->clearSelection(GridEventPolicy::allow);
     m_gridMainC->clearSelection(GridEventPolicy::allow);
     m_gridMainR->clearSelection(GridEventPolicy::allow);
@@ -4239,12 +4339,52 @@ void MainDialog::clearGrid(ptrdiff_t pos)
     if (folderCmp_.empty())
         errorLogCmp_.reset();
 
+    cmpSnapshotFilePath_.clear();
+    cmpSnapshotRestored_ = false;
+
     filegrid::setData(*m_gridMainC,    folderCmp_);
     treegrid::setData(*m_gridOverview, folderCmp_);
     updateGui();
 }
 
 
+void MainDialog::saveCmpSnapshot() //throw FileError
+{
+    if (!cmpSnapshotFilePath_.empty() && !folderCmp_.empty())
+    {
+        wxBusyCursor dummy;
+        saveComparisonSnapshot(folderCmp_, cmpSnapshotTime_, cmpSnapshotFilePath_); //throw FileError
+    }
+}
+
+
+void MainDialog::restoreCmpSnapshot()
+{
+    if (!globalCfg_.mainDlg.restoreComparison || !folderCmp_.empty())
+        return;
+
+    const std::vector<FolderPairCfg>& fpCfgList = extractCompareCfg(getConfig().mainCfg);
+    const Zstring snapshotFilePath = getConfigDirPathPf() + getComparisonSnapshotName(fpCfgList);
+    try
+    {
+        wxBusyCursor dummy;
+        std::optional<ComparisonSnapshot> snapshot = loadComparisonSnapshot(snapshotFilePath, fpCfgList); //throw FileError
+        if (!snapshot)
+            return;
+
+        folderCmp_ = std::move(snapshot->folderCmp);
+        cmpSnapshotFilePath_ = snapshotFilePath;
+        cmpSnapshotTime_     = snapshot->compareTime;
+        cmpSnapshotRestored_ = true;
+
+        filegrid::setData(*m_gridMainC,    folderCmp_);
+        treegrid::setData(*m_gridOverview, folderCmp_);
+        updateGui();
+    }
+    catch (const FileError& e) { logFatalError(e.toString()); } //just a cache: compare again
+}
+
+
 void MainDialog::updateStatistics()
 {
     auto setValue = [](wxStaticText& txtControl, bool isZeroValue, const wxString& valueAsString, wxStaticBitmap& bmpControl, const char* imageName)
@@ -4266,7 +4406,7 @@ void MainDialog::updateStatistics()
     };
 
     //update preview of item count and bytes to be transferred:
-    const SyncStatistics st(folderCmp_);
+    const SyncStatistics st(filegrid::getDataView(*m_gridMainC).getColumns()); //reuse snapshot of updateGridViewData(): see updateGui()
 
     setValue(*m_staticTextData, st.getBytesToProcess() == 0, formatFilesizeShort(st.getBytesToProcess()), *m_bitmapData, "data");
     setIntValue(*m_staticTextCreateLeft,  st.createCount<SelectSide::left >(), *m_bitmapCreateLeft,  "so_create_left_sicon");
@@ -4356,6 +4496,7 @@ void MainDialog::onStartSync(wxCommandEvent& event)
                                                   globalCfg_.dpiLayouts[getDpiScalePercent()].progressDlg.dlgSize,
                                                   globalCfg_.dpiLayouts[getDpiScalePercent()].progressDlg.isMaximized,
                                                   globalCfg_.progressDlgAutoClose,
+                                                  globalCfg_.progressDlgDiagnostics,
                                                   errorLogStart.get());
         try
         {
@@ -4392,16 +4533,18 @@ void MainDialog::onStartSync(wxCommandEvent& event)
                         globalCfg_.copyLockedFiles,
                         globalCfg_.copyFilePermissions,
                         globalCfg_.failSafeFileCopy,
+                        guiCfg.mainCfg.cacheNeutralCopy,
                         globalCfg_.runWithBackgroundPriority,
                         extractSyncCfg(guiCfg.mainCfg),
                         folderCmp_,
+                        guiCfg.mainCfg.deviceParallelOps,
                         globalCfg_.warnDlgs,
                         statusHandler); //throw AbortProcess
         }
         catch (AbortProcess&) {}
 
         StatusHandlerFloatingDialog::Result r = statusHandler.reportResults(guiCfg.mainCfg.postSyncCommand, guiCfg.mainCfg.postSyncCondition,
-                                                                            guiCfg.mainCfg.altLogFolderPathPhrase, globalCfg_.logfilesMaxAgeDays, globalCfg_.logFormat, logFilePathsToKeep,
+                                                                            guiCfg.mainCfg.altLogFolderPathPhrase, globalCfg_.logfilesMaxAgeDays, globalCfg_.logFormat, globalCfg_.logFileGzip, logFilePathsToKeep,
                                                                             guiCfg.mainCfg.emailNotifyAddress, guiCfg.mainCfg.emailNotifyCondition); //noexcept
         //---------------------------------------------------------------------------
         setLastOperationLog(r.summary, r.errorLog.ptr());
@@ -4582,9 +4725,11 @@ void MainDialog::startSyncForSelecction(const std::vector<FileSystemObject*>& se
                         globalCfg_.copyLockedFiles,
                         globalCfg_.copyFilePermissions,
                         globalCfg_.failSafeFileCopy,
+                        guiCfg.mainCfg.cacheNeutralCopy,
                         globalCfg_.runWithBackgroundPriority,
                         fpCfgSelect,
                         folderCmpSelect,
+                        guiCfg.mainCfg.deviceParallelOps,
                         globalCfg_.warnDlgs,
                         statusHandler); //throw AbortProcess
         }
@@ -5081,6 +5226,8 @@ void MainDialog::setStatusBarFileStats(FileView::FileStats statsLeft,
         statusCenterNew = _P("Showing %y of 1 item", "Showing %y of %x items", filegrid::getDataView(*m_gridMainC).rowsTotal());
         replace(statusCenterNew, L"%y", formatNumber(filegrid::getDataView(*m_gridMainC).rowsOnView())); //%x used as plural form placeholder!
     }
+    if (cmpSnapshotRestored_) //restored comparison result: outdated => press "Compare" to refresh
+        statusCenterNew += L"  (" + replaceCpy(_("Comparison result of %x"), L"%x", utfTo<std::wstring>(formatTime(formatDateTimeTag, getLocalTime(cmpSnapshotTime_)))) + L')';
 
     //fill middle text (considering flashStatusInformation())
     if (oldStatusMsgs_.empty())
@@ -5121,7 +5268,7 @@ void MainDialog::applySyncDirections()
         try
         {
             statusHandler.initNewPhase(-1, -1, ProcessPhase::none);
-            redetermineSyncDirection(directCfgs,
+            redetermineSyncDirection(directCfgs, guiCfg.mainCfg.deviceParallelOps,
                                      statusHandler); //throw AbortProcess
         }
         catch (AbortProcess&) {}
@@ -5596,33 +5743,21 @@ void MainDialog::onMenuOptions(wxCommandEvent& event)
 
 void MainDialog::onMenuExportFileList(wxCommandEvent& event)
 {
-    wxBusyCursor dummy;
-
-    //https://en.wikipedia.org/wiki/Comma-separated_values
-    const lconv* localInfo = ::localeconv(); //always bound according to doc
-    const bool haveCommaAsDecimalSep = std::string(localInfo->decimal_point) == ",";
-
-    const char CSV_SEP = haveCommaAsDecimalSep ? ';' : ',';
-
-    auto fmtValue = [&](const std::wstring& val) -> std::string
-    {
-        std::string&& tmp = utfTo<std::string>(val);
-
-        if (contains(tmp, CSV_SEP))
-            return '"' + tmp + '"';
-        else
-            return std::move(tmp);
-    };
+    const CsvFormatter csv;
+    const char CSV_SEP = csv.getSeparator();
 
     //generate header
     std::string header; //perf: wxString doesn't model exponential growth => unsuitable for large data sets
     header += BYTE_ORDER_MARK_UTF8;
 
-    header += fmtValue(_("Folder Pairs")) + LINE_BREAK;
+    csv.appendValue(header, _("Folder Pairs"));
+    header += LINE_BREAK;
     std::for_each(begin(folderCmp_), end(folderCmp_), [&](BaseFolderPair& baseFolder)
     {
-        header += fmtValue(AFS::getDisplayPath(baseFolder.getAbstractPath<SelectSide::left >())) + CSV_SEP;
-        header += fmtValue(AFS::getDisplayPath(baseFolder.getAbstractPath<SelectSide::right>())) + LINE_BREAK;
+        csv.appendValue(header, AFS::getDisplayPath(baseFolder.getAbstractPath<SelectSide::left >()));
+        header += CSV_SEP;
+        csv.appendValue(header, AFS::getDisplayPath(baseFolder.getAbstractPath<SelectSide::right>()));
+        header += LINE_BREAK;
     });
     header += LINE_BREAK;
 
@@ -5642,12 +5777,12 @@ void MainDialog::onMenuExportFileList(wxCommandEvent& event)
     {
         for (const Grid::ColAttributes& ca : colAttrLeft)
         {
-            header += fmtValue(provLeft->getColumnLabel(ca.type));
+            csv.appendValue(header, provLeft->getColumnLabel(ca.type));
             header += CSV_SEP;
         }
         for (const Grid::ColAttributes& ca : colAttrCenter)
         {
-            header += fmtValue(provCenter->getColumnLabel(ca.type));
+            csv.appendValue(header, provCenter->getColumnLabel(ca.type));
             header += CSV_SEP;
         }
         if (!colAttrRight.empty())
@@ -5655,72 +5790,90 @@ void MainDialog::onMenuExportFileList(wxCommandEvent& event)
             std::for_each(colAttrRight.begin(), colAttrRight.end() - 1,
                           [&](const Grid::ColAttributes& ca)
             {
-                header += fmtValue(provRight->getColumnLabel(ca.type));
+                csv.appendValue(header, provRight->getColumnLabel(ca.type));
                 header += CSV_SEP;
             });
-            header += fmtValue(provRight->getColumnLabel(colAttrRight.back().type));
+            csv.appendValue(header, provRight->getColumnLabel(colAttrRight.back().type));
         }
         header += LINE_BREAK;
 
+        Zstring title = Zstr("FreeFileSync");
+        if (const std::vector<std::wstring>& jobNames = getJobNames();
+            !jobNames.empty())
+        {
+            title = utfTo<Zstring>(jobNames[0]);
+            std::for_each(jobNames.begin() + 1, jobNames.end(), [&](const std::wstring& jobName)
+            { title += Zstr(" + ") + utfTo<Zstring>(jobName); });
+        }
+
+        /* main grid: stream chunks of rows instead of creating one big string: memory allocation might fail; think 20 million rows!
+            => rows are formatted on worker threads (read-only access to the grid data), this thread writes them in order and keeps the UI responsive */
+        FocusPreserver fp;
+
+        disableGuiElements(true /*enableAbort*/); //StatusHandlerTemporaryPanel will internally process Window messages, so avoid unexpected callbacks!
+        auto app = wxTheApp; //fix lambda/wxWigets/VC fuck up
+        ZEN_ON_SCOPE_EXIT(app->Yield(); enableGuiElements()); //ui update before enabling buttons again: prevent strange behaviour of delayed button clicks
+
+        const auto& guiCfg = getConfig();
+
+        StatusHandlerTemporaryPanel statusHandler(*this, std::chrono::system_clock::now() /*startTime*/,
+                                                  false /*ignoreErrors*/,
+                                                  guiCfg.mainCfg.autoRetryCount,
+                                                  guiCfg.mainCfg.autoRetryDelay,
+                                                  Zstr("") /*soundFileAlertPending*/);
+        std::optional<Zstring> csvFilePathDone;
+        std::optional<FileError> exportError;
         try
         {
-            Zstring title = Zstr("FreeFileSync");
-            if (const std::vector<std::wstring>& jobNames = getJobNames();
-                !jobNames.empty())
-            {
-                title = utfTo<Zstring>(jobNames[0]);
-                std::for_each(jobNames.begin() + 1, jobNames.end(), [&](const std::wstring& jobName)
-                { title += Zstr(" + ") + utfTo<Zstring>(jobName); });
-            }
+            statusHandler.initNewPhase(-1, -1, ProcessPhase::none);
 
             const Zstring shortGuid = printNumber<Zstring>(Zstr("%04x"), static_cast<unsigned int>(getCrc16(generateGUID())));
             const Zstring csvFilePath = appendSeparator(tempFileBuf_.getAndCreateFolderPath()) + //throw FileError
                                         title + Zstr("~") + shortGuid + Zstr(".csv");
 
-
-            TempFileOutput fileOut(csvFilePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
-
-            fileOut.write(&header[0], header.size()); //throw FileError, (X)
-            /* main grid: write rows one after the other instead of creating one big string: memory allocation might fail; think 1 million rows!
-                    performance test case "export 600.000 rows" to CSV:
-                    aproach 1. assemble single temporary string, then write file:   4.6s
-                    aproach 2. write to buffered file output directly for each row: 6.4s                     */
-            std::string buffer;
-            const size_t rowCount = m_gridMainL->getRowCount();
-            for (size_t row = 0; row < rowCount; ++row)
+            writeCsvFile(csvFilePath, header, m_gridMainL->getRowCount(), [&](size_t row, std::string& buffer)
             {
                 for (const Grid::ColAttributes& ca : colAttrLeft)
                 {
-                    buffer += fmtValue(provLeft->getValue(row, ca.type));
+                    csv.appendValue(buffer, provLeft->getValue(row, ca.type));
                     buffer += CSV_SEP;
                 }
 
                 for (const Grid::ColAttributes& ca : colAttrCenter)
                 {
-                    buffer += fmtValue(provCenter->getValue(row, ca.type));
+                    csv.appendValue(buffer, provCenter->getValue(row, ca.type));
                     buffer += CSV_SEP;
                 }
 
                 for (const Grid::ColAttributes& ca : colAttrRight)
                 {
-                    buffer += fmtValue(provRight->getValue(row, ca.type));
+                    csv.appendValue(buffer, provRight->getValue(row, ca.type));
                     buffer += CSV_SEP;
                 }
                 buffer += LINE_BREAK;
+            }, statusHandler); //throw FileError, AbortProcess
 
-                fileOut.write(&buffer[0], buffer.size()); //throw FileError, (X)
-                buffer.clear();
-            }
-            fileOut.commit(); //throw FileError, (X)
+            csvFilePathDone = csvFilePath;
+        }
+        catch (const FileError& e) { exportError = e; }
+        catch (AbortProcess&) {}
 
-            openWithDefaultApp(csvFilePath); //throw FileError
+        const StatusHandlerTemporaryPanel::Result r = statusHandler.reportResults(); //noexcept
+        setLastOperationLog(r.summary, r.errorLog.ptr());
 
-            flashStatusInformation(_("File list exported"));
-        }
-        catch (const FileError& e)
-        {
-            showNotificationDialog(this, DialogInfoType::error, PopupDialogCfg().setDetailInstructions(e.toString()));
-        }
+        if (exportError)
+            showNotificationDialog(this, DialogInfoType::error, PopupDialogCfg().setDetailInstructions(exportError->toString()));
+        else if (csvFilePathDone)
+            try
+            {
+                openWithDefaultApp(*csvFilePathDone); //throw FileError
+
+                flashStatusInformation(_("File list exported"));
+            }
+            catch (const FileError& e)
+            {
+                showNotificationDialog(this, DialogInfoType::error, PopupDialogCfg().setDetailInstructions(e.toString()));
+            }
     }
 }
 
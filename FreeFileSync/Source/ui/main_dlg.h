@@ -174,6 +174,8 @@ private:
     void onGridLabelContextRim(zen::GridLabelClickEvent& event, bool leftSide);
     void onGridLabelContextC  (zen::GridLabelClickEvent& event);
 
+    void setupFileIcons(); //according to globalCfg_.mainDlg
+
     void onToggleViewType  (wxCommandEvent& event) override;
     void onToggleViewButton(wxCommandEvent& event) override;
 
@@ -289,6 +291,10 @@ private:
 
     void clearGrid(ptrdiff_t pos = -1);
 
+    //persisted comparison result, see cmp_snapshot.h
+    void saveCmpSnapshot(); //throw FileError
+    void restoreCmpSnapshot();
+
     //***********************************************
     //application variables are stored here:
 
@@ -313,6 +319,10 @@ private:
     FolderComparison folderCmp_; //optional!: sync button not available if empty
     std::shared_ptr<const zen::ErrorLog> errorLogCmp_;
 
+    Zstring cmpSnapshotFilePath_; //empty: folderCmp_ doesn't (or no longer) match the folder pairs of a snapshot
+    time_t cmpSnapshotTime_ = 0;  //time of comparison
+    bool cmpSnapshotRestored_ = false; //folderCmp_ is outdated: show in status bar until next comparison
+
     //folder pairs:
     std::unique_ptr<FolderPairFirst> firstFolderPair_; //always bound!!!
     std::vector<FolderPairPanel*> additionalFolderPairs_; //additional pairs to the first pair
@@ -9,6 +9,7 @@
 #include <wx/imaglist.h>
 #include <wx/wupdlock.h>
 #include <wx/app.h>
+#include <wx/textctrl.h>
 #include <zen/format_unit.h>
 #include <zen/scope_guard.h>
 #include <wx+/toggle_button.h>
@@ -43,8 +44,8 @@ constexpr std::chrono::seconds PERF_WINDOW_REMAINING_TIME(60); //USB memory stic
 constexpr std::chrono::seconds      SPEED_ESTIMATE_SAMPLE_SKIP(1);
 constexpr std::chrono::milliseconds SPEED_ESTIMATE_UPDATE_INTERVAL(500);
 constexpr std::chrono::seconds      GRAPH_TOTAL_TIME_UPDATE_INTERVAL(2);
+constexpr std::chrono::seconds      DIAGNOSTICS_UPDATE_INTERVAL(1);
 
-const size_t PROGRESS_GRAPH_SAMPLE_SIZE_MAX = 2'500'000; //sizeof(CurveDataStatistics::Sample) == 16 byte key/value
 
 inline wxColor getColorBytes() { return {111, 255,  99}; } //light green
 inline wxColor getColorItems() { return {127, 147, 255}; } //light blue
@@ -86,6 +87,116 @@ std::wstring getDialogPhaseText(const Statistics& syncStat, bool paused)
 }
 
 
+//window minimized, hidden in systray, or graph not shown: don't waste CPU on redraws nobody sees
+bool isVisibleOnScreen(wxWindow& win)
+{
+    if (!win.IsShownOnScreen())
+        return false;
+
+    if (const auto tlw = dynamic_cast<const wxTopLevelWindow*>(wxGetTopLevelParent(&win)))
+        return !tlw->IsIconized();
+    return true;
+}
+
+
+std::wstring formatLatency(std::chrono::microseconds latency)
+{
+    if (latency < std::chrono::milliseconds(1))
+        return numberTo<std::wstring>(latency.count()) + L" \u00b5s";
+    if (latency < std::chrono::seconds(1))
+        return numberTo<std::wstring>(std::chrono::duration_cast<std::chrono::milliseconds>(latency).count()) + L" ms";
+    return numberTo<std::wstring>(std::chrono::duration_cast<std::chrono::seconds>(latency).count()) + L" s";
+}
+
+
+/*  live view of the metrics (see zen/perf.h, afs/abstract.cpp):
+    - per device: operations in flight, throughput, latency percentiles per operation type (upper bounds of histogram buckets)
+    - engine lock: workers waiting and total wait time
+    - automatic retries                                                                                 */
+class DiagnosticsView
+{
+public:
+    std::wstring format(double timeElapsedSec)
+    {
+        const std::vector<SpanStats>   spanStats    = getSpanStats();
+        const std::vector<MetricCount> metricCounts = getMetricCounts();
+
+        struct DeviceInfo
+        {
+            int64_t opsActive = 0;
+            int64_t bytesRead    = 0;
+            int64_t bytesWritten = 0;
+            std::vector<const SpanStats*> ops;
+        };
+        std::map<std::string /*label*/, DeviceInfo> devices;
+        const SpanStats* lockWait = nullptr;
+        const SpanStats* retryWait = nullptr;
+        int64_t retries = 0;
+
+        for (const SpanStats& st : spanStats)
+            if (!st.label.empty())
+            {
+                DeviceInfo& di = devices[st.label];
+                di.opsActive += st.active;
+                di.ops.push_back(&st);
+            }
+            else if (st.name == "wait for engine lock")
+                lockWait = &st;
+            else if (st.name == "retry backoff")
+                retryWait = &st;
+
+        for (const MetricCount& mc : metricCounts)
+            if (mc.name == "bytes read" && !mc.label.empty())
+                devices[mc.label].bytesRead = mc.value;
+            else if (mc.name == "bytes written" && !mc.label.empty())
+                devices[mc.label].bytesWritten = mc.value;
+            else if (mc.name == "retries")
+                retries += mc.value;
+
+        const double timeDeltaSec = timeElapsedSec - timeLastSec_;
+        timeLastSec_ = timeElapsedSec;
+
+        auto formatSpeed = [&](int64_t bytesNow, int64_t& bytesLast)
+        {
+            const int64_t bytesDelta = bytesNow - bytesLast;
+            bytesLast = bytesNow;
+            return replaceCpy(_("%x/sec"), L"%x", formatFilesizeShort(timeDeltaSec > 0 ? std::llround(bytesDelta / timeDeltaSec) : 0));
+        };
+
+        std::wstring output;
+        for (const auto& [label, di] : devices)
+        {
+            auto& [bytesReadLast, bytesWrittenLast] = bytesLast_[label];
+
+            output += utfTo<std::wstring>(label) + L'\n';
+            output += L"    Active: " + formatNumber(di.opsActive) +
+                      L" | Read: "    + formatSpeed(di.bytesRead,    bytesReadLast) +
+                      L" | Write: "   + formatSpeed(di.bytesWritten, bytesWrittenLast) + L'\n';
+
+            for (const SpanStats* st : di.ops)
+                if (st->count > 0)
+                    output += L"    " + utfTo<std::wstring>(st->name) + L": " + formatNumber(st->count) +
+                              L" | p50 < " + formatLatency(getLatencyPercentile(*st, 0.5)) +
+                              L" | p99 < " + formatLatency(getLatencyPercentile(*st, 0.99)) +
+                              (st->active > 0 ? L" | active: " + formatNumber(st->active) : L"") + L'\n';
+        }
+
+        if (lockWait)
+            output += L"Engine lock: waiting: " + formatNumber(lockWait->active) +
+                      L" | total wait: " + formatLatency(std::chrono::duration_cast<std::chrono::microseconds>(lockWait->totalTime)) + L'\n';
+
+        output += L"Retries: " + formatNumber(retries);
+        if (retryWait && retryWait->active > 0)
+            output += L" | waiting for automatic retry";
+        return output;
+    }
+
+private:
+    double timeLastSec_ = 0;
+    std::map<std::string /*label*/, std::pair<int64_t /*bytes read*/, int64_t /*bytes written*/>> bytesLast_;
+};
+
+
 class CurveDataProgressBar : public CurveData
 {
 public:
@@ -388,7 +499,7 @@ void CompareProgressPanel::Impl::updateProgressGui()
             setText(*m_staticTextTimeRemaining, remTimeSec ? formatRemainingTime(*remTimeSec) : std::wstring(1, EM_DASH), &layoutChanged);
         }
 
-    if (haveTotalStats)
+    if (haveTotalStats && isVisibleOnScreen(*m_panelProgressGraph))
         m_panelProgressGraph->Refresh();
 
     //adapt layout after content changes above
@@ -421,19 +532,19 @@ std::chrono::milliseconds CompareProgressPanel::pauseAndGetTotalTime() { return
 
 namespace
 {
-class CurveDataStatistics : public SparseCurveData
+class CurveDataStatistics : public DecimatedCurveData
 {
 public:
-    CurveDataStatistics() : SparseCurveData(true /*addSteps*/) {}
+    CurveDataStatistics() : DecimatedCurveData(true /*addSteps*/) {}
 
-    void clear() { samples_.clear(); lastSample_ = {}; }
+    void clear() { DecimatedCurveData::clear(); lastSampleTime_ = -1; lastSample_ = {}; }
 
     void addSample(double timeElapsed /*[sec]*/, double value /*[items|bytes]*/)
     {
-        assert(( samples_.empty() && lastSample_.x == 0 && lastSample_.y == 0) ||
-               (!samples_.empty() && samples_.back().x <= lastSample_.x));
+        assert(( empty() && lastSample_.x == 0 && lastSample_.y == 0) ||
+               (!empty() && lastSampleTime_ <= lastSample_.x));
 
-        if (timeElapsed < lastSample_.x) //time *required* to be monotonously ascending for std::partition_point
+        if (timeElapsed < lastSample_.x) //time *required* to be monotonously ascending
         {
             assert(false);
             return;
@@ -442,19 +553,17 @@ public:
         lastSample_ = {timeElapsed, value};
 
         //allow for at most one sample per 100ms (handles duplicate inserts, too!) => unrelated to UI_UPDATE_INTERVAL!
-        if (!samples_.empty() && timeElapsed - samples_.back().x < 0.1)
+        if (!empty() && timeElapsed - lastSampleTime_ < 0.1)
             return;
 
-        samples_.push_back(CurvePoint{timeElapsed, value});
-
-        if (samples_.size() > PROGRESS_GRAPH_SAMPLE_SIZE_MAX) //limit buffer size
-            samples_.pop_front();
+        DecimatedCurveData::addSample(CurvePoint{timeElapsed, value}); //memory bounded for long runs: see DecimatedCurveData
+        lastSampleTime_ = timeElapsed;
     }
 
 private:
     std::pair<double, double> getRangeX() const override
     {
-        if (samples_.empty())
+        if (empty())
             return {};
         /*
             //report some additional width by 5% elapsed time to make graph recalibrate before hitting the right border
@@ -462,42 +571,26 @@ private:
             //=> consider width of current sample set!
             upperEndMs += 0.05 *(upperEndMs - samples.begin()->first);
         */
-        return {samples_.front().x, //need not start with 0, e.g. "binary comparison, graph reset, followed by sync"
+        return {DecimatedCurveData::getRangeX().first, //need not start with 0, e.g. "binary comparison, graph reset, followed by sync"
                 lastSample_.x};
     }
 
-    std::optional<CurvePoint> getLessEq(double x) const override //x: seconds since begin
-    {
-        //--------- add artifical last sample value --------
-        if (!samples_.empty() && lastSample_.x <= x)
-            return lastSample_;
-        //--------------------------------------------------
-
-        //find first item > x, then go one step back:
-        auto it = std::partition_point(samples_.begin(), samples_.end(),
-        /*find first item for which "!pred"*/ [x](const CurvePoint& p) { return p.x <= x; });
-        if (it == samples_.begin())
-            return std::nullopt;
-        --it; //bound!
-        return *it;
-    }
-
-    std::optional<CurvePoint> getGreaterEq(double x) const override
+    std::vector<CurvePoint> getPoints(double minX, double maxX, const wxSize& areaSizePx) const override
     {
-        //find first item >= x
-        const auto it = std::partition_point(samples_.begin(), samples_.end(),
-        /*find first item for which "!pred"*/ [x](const CurvePoint& p) { return p.x < x; });
-        if (it != samples_.end())
-            return *it;
+        std::vector<CurvePoint> points = DecimatedCurveData::getPoints(minX, maxX, areaSizePx);
 
         //--------- add artifical last sample value --------
-        if (!samples_.empty() && x <= lastSample_.x)
-            return lastSample_;
+        if (!points.empty() && points.back().x < lastSample_.x)
+        {
+            if (points.back().y != lastSample_.y) //staircase effect
+                points.push_back(CurvePoint{lastSample_.x, points.back().y});
+            points.push_back(lastSample_);
+        }
         //--------------------------------------------------
-        return std::nullopt;
+        return points;
     }
 
-    RingBuffer<CurvePoint> samples_; //x: monotonously ascending with time!
+    double lastSampleTime_ = -1; //x of latest sample added to DecimatedCurveData
     CurvePoint lastSample_; //artificial record after end of samples to visualize current time!
 };
 
@@ -654,6 +747,7 @@ public:
                            wxFrame* parentFrame,
                            bool showProgress,
                            bool autoCloseDialog,
+                           bool showDiagnostics,
                            const std::vector<std::wstring>& jobNames,
                            time_t syncStartTime,
                            bool ignoreErrors,
@@ -749,6 +843,10 @@ private:
     bool ignoreErrors_ = false;
     EnumDescrList<PostSyncAction2> enumPostSyncAction_;
 
+    wxTextCtrl* diagnosticsText_ = nullptr; //optional
+    DiagnosticsView diagnosticsView_;
+    std::chrono::nanoseconds timeLastDiagnostics_ = std::chrono::seconds(-100);
+
     wxSize dlgSizeBuf_;
 };
 
@@ -761,6 +859,7 @@ SyncProgressDialogImpl<TopLevelDialog>::SyncProgressDialogImpl(long style, //wxF
                                                                wxFrame* parentFrame,
                                                                bool showProgress,
                                                                bool autoCloseDialog,
+                                                               bool showDiagnostics,
                                                                const std::vector<std::wstring>& jobNames,
                                                                time_t syncStartTime,
                                                                bool ignoreErrors,
@@ -829,6 +928,24 @@ dlgSizeBuf_(dlgSize)
     }
     catch (const TaskbarNotAvailable&) {}
 
+    if (showDiagnostics)
+    {
+        assert(metricsEnabled()); //see applyProcessSettings()
+        diagnosticsText_ = new wxTextCtrl(pnl_.m_panelProgress, wxID_ANY, wxString(), wxDefaultPosition, wxDefaultSize,
+                                          wxTE_DONTWRAP | wxTE_MULTILINE | wxTE_READONLY | wxBORDER_NONE); //owned by m_panelProgress
+        diagnosticsText_->SetFont(wxFont(wxFontInfo(diagnosticsText_->GetFont().GetPointSize()).Family(wxFONTFAMILY_TELETYPE)));
+        diagnosticsText_->SetMinSize({-1, fastFromDIP(120)});
+        //insert below the graphs, above the footer
+        wxSizer& graphSizer = *pnl_.m_panelGraphItems->GetContainingSizer();
+        size_t pos = 0;
+        for (const wxSizerItem* item : graphSizer.GetChildren())
+            if (item->GetWindow() == pnl_.m_panelGraphItems)
+                break;
+            else
+                ++pos;
+        graphSizer.Insert(pos + 1, diagnosticsText_, 0, wxEXPAND | wxLEFT | wxTOP, fastFromDIP(10));
+    }
+
     //hide until end of process:
     pnl_.m_notebookResult     ->Hide();
     pnl_.m_buttonClose        ->Show(false);
@@ -1078,6 +1195,9 @@ void SyncProgressDialogImpl<TopLevelDialog>::updateProgressGui(bool allowYield)
     const std::chrono::nanoseconds timeElapsed = stopWatch_.elapsed();
     const double timeElapsedDouble = std::chrono::duration<double>(timeElapsed).count();
 
+    //minimized or in systray: still update dialog caption, taskbar, systray and statistics, but skip the redraws
+    const bool dlgVisible = isVisibleOnScreen(*this);
+
     const int     itemsCurrent = syncStat_->getStatsCurrent().items;
     const int64_t bytesCurrent = syncStat_->getStatsCurrent().bytes;
     const int     itemsTotal   = syncStat_->getStatsTotal  ().items;
@@ -1128,31 +1248,35 @@ void SyncProgressDialogImpl<TopLevelDialog>::updateProgressGui(bool allowYield)
     curveBytes_.ref().addSample(timeElapsedDouble, bytesCurrent);
     curveItems_.ref().addSample(timeElapsedDouble, itemsCurrent);
 
-    //item and data stats
-    if (!haveTotalStats)
+    //item and data stats (dialog hidden: updated as soon as it is visible again)
+    if (dlgVisible)
     {
-        setText(*pnl_.m_staticTextItemsProcessed, formatNumber(itemsCurrent), &layoutChanged);
-        setText(*pnl_.m_staticTextBytesProcessed, L"", &layoutChanged);
+        if (!haveTotalStats)
+        {
+            setText(*pnl_.m_staticTextItemsProcessed, formatNumber(itemsCurrent), &layoutChanged);
+            setText(*pnl_.m_staticTextBytesProcessed, L"", &layoutChanged);
 
-        setText(*pnl_.m_staticTextItemsRemaining, std::wstring(1, EM_DASH), &layoutChanged);
-        setText(*pnl_.m_staticTextBytesRemaining, L"",  &layoutChanged);
-    }
-    else
-    {
-        setText(*pnl_.m_staticTextItemsProcessed,               formatNumber(itemsCurrent), &layoutChanged);
-        setText(*pnl_.m_staticTextBytesProcessed, L'(' + formatFilesizeShort(bytesCurrent) + L')', &layoutChanged);
+            setText(*pnl_.m_staticTextItemsRemaining, std::wstring(1, EM_DASH), &layoutChanged);
+            setText(*pnl_.m_staticTextBytesRemaining, L"",  &layoutChanged);
+        }
+        else
+        {
+            setText(*pnl_.m_staticTextItemsProcessed,               formatNumber(itemsCurrent), &layoutChanged);
+            setText(*pnl_.m_staticTextBytesProcessed, L'(' + formatFilesizeShort(bytesCurrent) + L')', &layoutChanged);
 
-        setText(*pnl_.m_staticTextItemsRemaining,               formatNumber(itemsTotal - itemsCurrent), &layoutChanged);
-        setText(*pnl_.m_staticTextBytesRemaining, L'(' + formatFilesizeShort(bytesTotal - bytesCurrent) + L')', &layoutChanged);
-        //it's possible data remaining becomes shortly negative if last file synced has ADS data and the bytesTotal was not yet corrected!
+            setText(*pnl_.m_staticTextItemsRemaining,               formatNumber(itemsTotal - itemsCurrent), &layoutChanged);
+            setText(*pnl_.m_staticTextBytesRemaining, L'(' + formatFilesizeShort(bytesTotal - bytesCurrent) + L')', &layoutChanged);
+            //it's possible data remaining becomes shortly negative if last file synced has ADS data and the bytesTotal was not yet corrected!
+        }
     }
 
     //current time elapsed
     const int64_t timeElapSec = std::chrono::duration_cast<std::chrono::seconds>(timeElapsed).count();
 
-    setText(*pnl_.m_staticTextTimeElapsed, timeElapSec < 3600 ?
-            wxTimeSpan::Seconds(timeElapSec).Format(   L"%M:%S") :
-            wxTimeSpan::Seconds(timeElapSec).Format(L"%H:%M:%S"), &layoutChanged);
+    if (dlgVisible)
+        setText(*pnl_.m_staticTextTimeElapsed, timeElapSec < 3600 ?
+                wxTimeSpan::Seconds(timeElapSec).Format(   L"%M:%S") :
+                wxTimeSpan::Seconds(timeElapSec).Format(L"%H:%M:%S"), &layoutChanged);
 
     //remaining time and speed
     if (numeric::dist(timeLastSpeedEstimate_, timeElapsed) >= SPEED_ESTIMATE_UPDATE_INTERVAL)
@@ -1203,8 +1327,20 @@ void SyncProgressDialogImpl<TopLevelDialog>::updateProgressGui(bool allowYield)
         }
     }
 
-    pnl_.m_panelGraphBytes->Refresh();
-    pnl_.m_panelGraphItems->Refresh();
+    if (diagnosticsText_ && dlgVisible && numeric::dist(timeLastDiagnostics_, timeElapsed) >= DIAGNOSTICS_UPDATE_INTERVAL)
+    {
+        timeLastDiagnostics_ = timeElapsed;
+
+        const wxString diagText = diagnosticsView_.format(timeElapsedDouble);
+        if (diagnosticsText_->GetValue() != diagText)
+            diagnosticsText_->ChangeValue(diagText); //no layout update needed: fixed size
+    }
+
+    if (dlgVisible)
+    {
+        if (isVisibleOnScreen(*pnl_.m_panelGraphBytes)) pnl_.m_panelGraphBytes->Refresh();
+        if (isVisibleOnScreen(*pnl_.m_panelGraphItems)) pnl_.m_panelGraphItems->Refresh();
+    }
 
     //adapt layout after content changes above
     if (layoutChanged)
@@ -1237,7 +1373,7 @@ void SyncProgressDialogImpl<TopLevelDialog>::updateProgressGui(bool allowYield)
             */
             wxTheApp->Yield(); //receive UI message that sets pause status OR forceful termination!
     }
-    else
+    else if (dlgVisible)
         this->Update(); //don't wait until next idle event (who knows what blocking process comes next?)
 }
 
@@ -1662,6 +1798,7 @@ SyncProgressDialog* SyncProgressDialog::create(wxSize dlgSize, bool dlgMaximize,
                                                wxFrame* parentWindow, //may be nullptr
                                                bool showProgress,
                                                bool autoCloseDialog,
+                                               bool showDiagnostics,
                                                const std::vector<std::wstring>& jobNames,
                                                time_t syncStartTime,
                                                bool ignoreErrors,
@@ -1673,16 +1810,16 @@ SyncProgressDialog* SyncProgressDialog::create(wxSize dlgSize, bool dlgMaximize,
 #if 0 //macOS; update 08-2021: Bug seems to be fixed!?
         //due to usual "wxBugs", wxDialog on OS X does not float on its parent; wxFrame OTOH does => hack! https://groups.google.com/forum/#!topic/wx-users/J5SjjLaBOQE
         return new SyncProgressDialogImpl<wxFrame>(wxDEFAULT_FRAME_STYLE | wxFRAME_FLOAT_ON_PARENT,
-                                                   dlgSize, dlgMaximize, userRequestAbort, syncStat, parentWindow, showProgress, autoCloseDialog, jobNames, syncStartTime, ignoreErrors, autoRetryCount, postSyncAction);
+                                                   dlgSize, dlgMaximize, userRequestAbort, syncStat, parentWindow, showProgress, autoCloseDialog, showDiagnostics, jobNames, syncStartTime, ignoreErrors, autoRetryCount, postSyncAction);
 #else //GNOME bug: wxDialog seems to ignore wxMAXIMIZE_BOX | wxMINIMIZE_BOX! :( wxFrame OTOH has them, but adds an extra taskbar entry
         return new SyncProgressDialogImpl<wxDialog>(wxDEFAULT_DIALOG_STYLE | wxMAXIMIZE_BOX | wxMINIMIZE_BOX | wxRESIZE_BORDER,
-                                                    dlgSize, dlgMaximize, userRequestAbort, syncStat, parentWindow, showProgress, autoCloseDialog, jobNames, syncStartTime, ignoreErrors, autoRetryCount, postSyncAction);
+                                                    dlgSize, dlgMaximize, userRequestAbort, syncStat, parentWindow, showProgress, autoCloseDialog, showDiagnostics, jobNames, syncStartTime, ignoreErrors, autoRetryCount, postSyncAction);
 #endif
     }
     else //FFS batch job
     {
         auto dlg = new SyncProgressDialogImpl<wxFrame>(wxDEFAULT_FRAME_STYLE,
-                                                       dlgSize, dlgMaximize, userRequestAbort, syncStat, parentWindow, showProgress, autoCloseDialog, jobNames, syncStartTime, ignoreErrors, autoRetryCount, postSyncAction);
+                                                       dlgSize, dlgMaximize, userRequestAbort, syncStat, parentWindow, showProgress, autoCloseDialog, showDiagnostics, jobNames, syncStartTime, ignoreErrors, autoRetryCount, postSyncAction);
         dlg->SetIcon(getFfsIcon()); //only top level windows should have an icon
         return dlg;
     }
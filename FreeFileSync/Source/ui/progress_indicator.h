@@ -64,6 +64,7 @@ struct SyncProgressDialog
                                       wxFrame* parentWindow, //may be nullptr
                                       bool showProgress,
                                       bool autoCloseDialog,
+                                      bool showDiagnostics, //per-device activity from zen::getSpanStats(): requires zen::enableMetrics()
                                       const std::vector<std::wstring>& jobNames,
                                       time_t syncStartTime,
                                       bool ignoreErrors,
@@ -7,6 +7,7 @@
 #include "search_grid.h"
 #include <zen/zstring.h>
 #include <zen/utf.h>
+#include <zen/thread.h>
 
 using namespace zen;
 using namespace fff;
@@ -69,6 +70,8 @@ private:
 
 //###########################################################################################
 
+const size_t SEARCH_BLOCK_ROWS = 10'000; //unit of work per thread: small enough to stop soon after the first match
+
 template <bool respectCase>
 ptrdiff_t findRow(const Grid& grid, //return -1 if no matching row found
                   const std::wstring& searchString,
@@ -80,22 +83,76 @@ ptrdiff_t findRow(const Grid& grid, //return -1 if no matching row found
     {
         std::vector<Grid::ColAttributes> colAttr = grid.getColumnConfig();
         std::erase_if(colAttr, [](const Grid::ColAttributes& ca) { return !ca.visible; });
-        if (!colAttr.empty())
+        if (!colAttr.empty() && rowFirst < rowLast)
         {
             const MatchFound<respectCase> matchFound(searchString);
 
-            if (searchAscending)
+            auto rowMatches = [&](size_t row)
+            {
+                for (const Grid::ColAttributes& ca : colAttr)
+                    if (matchFound(prov->getValue(row, ca.type)))
+                        return true;
+                return false;
+            };
+
+            //blocks are numbered in search direction
+            const size_t blockCount = (rowLast - rowFirst + SEARCH_BLOCK_ROWS - 1) / SEARCH_BLOCK_ROWS;
+
+            auto searchBlock = [&](size_t blockIdx) -> ptrdiff_t
             {
-                for (size_t row = rowFirst; row < rowLast; ++row)
-                    for (const Grid::ColAttributes& ca : colAttr)
-                        if (matchFound(prov->getValue(row, ca.type)))
+                if (searchAscending)
+                {
+                    const size_t blockFirst = rowFirst + blockIdx * SEARCH_BLOCK_ROWS;
+                    const size_t blockLast  = std::min(blockFirst + SEARCH_BLOCK_ROWS, rowLast);
+                    for (size_t row = blockFirst; row < blockLast; ++row)
+                        if (rowMatches(row))
                             return row;
-            }
-            else
-                for (size_t row = rowLast; row-- > rowFirst;)
-                    for (const Grid::ColAttributes& ca : colAttr)
-                        if (matchFound(prov->getValue(row, ca.type)))
+                }
+                else
+                {
+                    const size_t blockLast  = rowLast - blockIdx * SEARCH_BLOCK_ROWS;
+                    const size_t blockFirst = blockLast - std::min(SEARCH_BLOCK_ROWS, blockLast - rowFirst);
+                    for (size_t row = blockLast; row-- > blockFirst;)
+                        if (rowMatches(row))
                             return row;
+                }
+                return -1;
+            };
+
+            const size_t threadCount = std::clamp<size_t>(blockCount, 1, std::max<size_t>(std::thread::hardware_concurrency(), 1));
+            if (threadCount == 1)
+            {
+                for (size_t blockIdx = 0; blockIdx < blockCount; ++blockIdx)
+                    if (const ptrdiff_t row = searchBlock(blockIdx);
+                        row >= 0)
+                        return row;
+                return -1;
+            }
+
+            //formatting each cell's text is expensive (e.g. 10M rows x date column) => scan in parallel
+            //main thread is blocked meanwhile => no concurrent changes to the grid data
+            std::atomic<size_t> nextBlock{0};
+            std::atomic<size_t> firstMatchBlock{blockCount}; //no more need to search blocks after the first one with a match
+            std::vector<ptrdiff_t> blockMatches(blockCount, -1); //each block is owned by a single thread
+
+            ThreadGroup<std::function<void()>> tg(threadCount, Zstr("Grid search"));
+            for (size_t i = 0; i < threadCount; ++i)
+                tg.run([&]
+            {
+                for (size_t blockIdx = nextBlock++; blockIdx < blockCount && blockIdx < firstMatchBlock; blockIdx = nextBlock++)
+                    if (const ptrdiff_t row = searchBlock(blockIdx);
+                        row >= 0)
+                    {
+                        blockMatches[blockIdx] = row;
+
+                        for (size_t matchBlock = firstMatchBlock; blockIdx < matchBlock;)
+                            if (firstMatchBlock.compare_exchange_weak(matchBlock, blockIdx))
+                                break;
+                    }
+            });
+            tg.wait();
+
+            return firstMatchBlock < blockCount ? blockMatches[firstMatchBlock] : -1;
         }
     }
     return -1;
@@ -14,6 +14,7 @@ namespace fff
 {
 std::pair<const zen::Grid*, ptrdiff_t> findGridMatch(const zen::Grid& grid1, const zen::Grid& grid2, const std::wstring& searchString, bool respectCase, bool searchAscending);
 //returns (grid/row) where the value was found, (nullptr, -1) if not found
+//grid data providers must support concurrent getValue() calls: cells are scanned in parallel
 }
 
 #endif //SEARCH_H_423905762345342526587
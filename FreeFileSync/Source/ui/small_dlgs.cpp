@@ -229,6 +229,17 @@ private:
     const SftpLogin sftpDefault_;
 
     SftpAuthType sftpAuthType_ = sftpDefault_.authType;
+    bool listingCache_ = false; //no GUI control: preserve setting of the (S)FTP folder path
+    int sftpConnectionsPerFileTransfer_ = sftpDefault_.connectionsPerFileTransfer; //no GUI control: preserve setting of the SFTP folder path
+    bool sftpDeltaTransfer_ = sftpDefault_.deltaTransfer;                          //
+    bool sftpAutoZlib_      = sftpDefault_.autoZlib;                               //
+    bool sftpRemoteCopy_    = sftpDefault_.remoteCopy;                             //
+    bool sftpRemoteHash_    = sftpDefault_.remoteHash;                             //
+    bool sftpRemoteScan_    = sftpDefault_.remoteScan;                             //
+    bool sftpBulkUpload_    = sftpDefault_.bulkUpload;                             //
+    int socketBufferBytes_  = 0; //no GUI control: preserve TCP tuning of the (S)FTP folder path
+    int socketNotSentLowAt_ = 0; //
+    Zstring congestionControl_;  //
 
     AsyncGuiQueue guiQueue_;
 
@@ -344,6 +355,17 @@ CloudSetupDlg::CloudSetupDlg(wxWindow* parent, Zstring& folderPathPhrase, Zstrin
         m_checkBoxAllowZlib     ->SetValue(login.allowZlib);
         m_spinCtrlTimeout       ->SetValue(login.timeoutSec);
         m_spinCtrlChannelCountSftp->SetValue(login.traverserChannelsPerConnection);
+        listingCache_ = login.listingCache;
+        sftpConnectionsPerFileTransfer_ = login.connectionsPerFileTransfer;
+        sftpDeltaTransfer_ = login.deltaTransfer;
+        sftpAutoZlib_      = login.autoZlib;
+        sftpRemoteCopy_    = login.remoteCopy;
+        sftpRemoteHash_    = login.remoteHash;
+        sftpRemoteScan_    = login.remoteScan;
+        sftpBulkUpload_    = login.bulkUpload;
+        socketBufferBytes_  = login.socketBufferBytes;
+        socketNotSentLowAt_ = login.socketNotSentLowAt;
+        congestionControl_  = login.congestionControl;
     }
     else if (acceptsItemPathPhraseFtp(folderPathPhrase))
     {
@@ -359,6 +381,10 @@ CloudSetupDlg::CloudSetupDlg(wxWindow* parent, Zstring& folderPathPhrase, Zstrin
         m_textCtrlServerPath     ->ChangeValue(utfTo<wxString>(FILE_NAME_SEPARATOR + folderPath.afsPath.value));
         (login.useTls ? m_radioBtnEncryptSsl : m_radioBtnEncryptNone)->SetValue(true);
         m_spinCtrlTimeout        ->SetValue(login.timeoutSec);
+        listingCache_ = login.listingCache;
+        socketBufferBytes_  = login.socketBufferBytes;
+        socketNotSentLowAt_ = login.socketNotSentLowAt;
+        congestionControl_  = login.congestionControl;
     }
 
     m_spinCtrlConnectionCount->SetValue(parallelOps);
@@ -681,6 +707,17 @@ AbstractPath CloudSetupDlg::getFolderPath() const
             login.allowZlib  = m_checkBoxAllowZlib->GetValue();
             login.timeoutSec = m_spinCtrlTimeout->GetValue();
             login.traverserChannelsPerConnection = m_spinCtrlChannelCountSftp->GetValue();
+            login.listingCache = listingCache_;
+            login.connectionsPerFileTransfer = sftpConnectionsPerFileTransfer_;
+            login.deltaTransfer = sftpDeltaTransfer_;
+            login.autoZlib      = sftpAutoZlib_;
+            login.remoteCopy    = sftpRemoteCopy_;
+            login.remoteHash    = sftpRemoteHash_;
+            login.remoteScan    = sftpRemoteScan_;
+            login.bulkUpload    = sftpBulkUpload_;
+            login.socketBufferBytes  = socketBufferBytes_;
+            login.socketNotSentLowAt = socketNotSentLowAt_;
+            login.congestionControl  = congestionControl_;
             return AbstractPath(condenseToSftpDevice(login), serverRelPath); //noexcept
         }
 
@@ -693,6 +730,10 @@ AbstractPath CloudSetupDlg::getFolderPath() const
             login.password = utfTo<Zstring>((m_checkBoxShowPassword->GetValue() ? m_textCtrlPasswordVisible : m_textCtrlPasswordHidden)->GetValue());
             login.useTls = m_radioBtnEncryptSsl->GetValue();
             login.timeoutSec = m_spinCtrlTimeout->GetValue();
+            login.listingCache = listingCache_;
+            login.socketBufferBytes  = socketBufferBytes_;
+            login.socketNotSentLowAt = socketNotSentLowAt_;
+            login.congestionControl  = congestionControl_;
             return AbstractPath(condenseToFtpDevice(login), serverRelPath); //noexcept
         }
     }
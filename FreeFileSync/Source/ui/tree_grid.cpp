@@ -48,7 +48,7 @@ TreeView::TreeView(FolderComparison& folderCmp, const SortInfo& si) : folderCmp_
 inline
 void TreeView::compressNode(Container& cont) //remove single-element sub-trees -> gain clarity + usability (call *after* inclusion check!!!)
 {
-    if (cont.subDirs.empty()) //single files node
+    if (!cont.hasSubDirs) //single files node
         cont.firstFileId = nullptr;
 
 #if 0 //let's not go overboard: empty folders should not be condensed => used for file exclusion filter; user expects to see them
@@ -61,10 +61,16 @@ void TreeView::compressNode(Container& cont) //remove single-element sub-trees -
 }
 
 
-template <class Function> //(const FileSystemObject&) -> bool
-void TreeView::extractVisibleSubtree(ContainerObject& hierObj,  //in
-                                     TreeView::Container& cont, //out
-                                     Function pred)
+namespace
+{
+const size_t TREE_TOTALS_BUFFER_ROWS_MIN = 100; //buffer totals for larger sub trees only => bounded memory, cheap recalculation for the rest
+}
+
+
+template <class Predicate> //(const FileSystemObject&) -> bool
+size_t TreeView::calcTotals(ContainerObject& hierObj,  //in
+                            TreeView::Container& cont, //out
+                            const Predicate& pred)
 {
     auto getBytes = [](const FilePair& file) //MSVC screws up miserably if we put this lambda into std::for_each
     {
@@ -85,6 +91,8 @@ void TreeView::extractVisibleSubtree(ContainerObject& hierObj,  //in
         return std::max(file.getFileSize<SelectSide::left>(), file.getFileSize<SelectSide::right>());
     };
 
+    size_t rowCount = hierObj.refSubFiles().size() + hierObj.refSubLinks().size() + hierObj.refSubFolders().size();
+
     cont.firstFileId = nullptr;
     for (FilePair& file : hierObj.refSubFiles())
         if (pred(file))
@@ -108,27 +116,63 @@ void TreeView::extractVisibleSubtree(ContainerObject& hierObj,  //in
     cont.bytesGross     += cont.bytesNet;
     cont.itemCountGross += cont.itemCountNet;
 
-    cont.subDirs.reserve(hierObj.refSubFolders().size()); //avoid expensive reallocations!
-
     for (FolderPair& folder : hierObj.refSubFolders())
     {
         const bool included = pred(folder);
 
-        cont.subDirs.emplace_back(); //
-        auto& subDirCont = cont.subDirs.back();
-        TreeView::extractVisibleSubtree(folder, subDirCont, pred);
+        Container subDirCont;
+        rowCount += calcSubDirTotals(folder, subDirCont, pred);
         if (included)
             ++subDirCont.itemCountGross;
 
         cont.bytesGross     += subDirCont.bytesGross;
         cont.itemCountGross += subDirCont.itemCountGross;
 
-        if (!included && !subDirCont.firstFileId && subDirCont.subDirs.empty())
-            cont.subDirs.pop_back();
-        else
+        if (included || subDirCont.firstFileId || subDirCont.hasSubDirs)
+            cont.hasSubDirs = true;
+    }
+    return rowCount;
+}
+
+
+template <class Predicate> //(const FileSystemObject&) -> bool
+size_t TreeView::calcSubDirTotals(FolderPair& folder, TreeView::Container& cont, const Predicate& pred)
+{
+    if (auto it = subDirTotalsBuf_.find(folder.getId());
+        it != subDirTotalsBuf_.end())
+    {
+        cont = it->second;
+        return TREE_TOTALS_BUFFER_ROWS_MIN;
+    }
+
+    const size_t rowCount = calcTotals(folder, cont, pred);
+    if (rowCount >= TREE_TOTALS_BUFFER_ROWS_MIN)
+        subDirTotalsBuf_.emplace(folder.getId(), cont);
+    return rowCount;
+}
+
+
+void TreeView::loadSubDirs(const Container& cont, ContainerObject& hierObj)
+{
+    assert(!cont.subDirsLoaded && cont.subDirs.empty());
+    cont.subDirsLoaded = true;
+
+    cont.subDirs.reserve(hierObj.refSubFolders().size()); //avoid expensive reallocations!
+
+    for (FolderPair& folder : hierObj.refSubFolders())
+    {
+        const bool included = lastViewFilterPred_(folder);
+
+        DirNodeImpl subDir;
+        calcSubDirTotals(folder, subDir, lastViewFilterPred_);
+        if (included)
+            ++subDir.itemCountGross;
+
+        if (included || subDir.firstFileId || subDir.hasSubDirs)
         {
-            subDirCont.objId = folder.getId();
-            compressNode(subDirCont);
+            subDir.objId = folder.getId();
+            compressNode(subDir);
+            cont.subDirs.push_back(std::move(subDir));
         }
     }
 }
@@ -267,8 +311,28 @@ void TreeView::sortSingleLevel(std::vector<TreeLine>& items, ColumnTypeOverview
 }
 
 
-void TreeView::getChildren(const Container& cont, unsigned int level, std::vector<TreeLine>& output)
+void TreeView::getChildren(const Container& cont, NodeType type, unsigned int level, std::vector<TreeLine>& output)
 {
+    if (!cont.subDirsLoaded)
+    {
+        ContainerObject* hierObj = nullptr;
+        switch (type)
+        {
+            case NodeType::root:
+                hierObj = static_cast<const RootNodeImpl&>(cont).baseFolder.get();
+                break;
+            case NodeType::folder:
+                hierObj = dynamic_cast<FolderPair*>(FileSystemObject::retrieve(static_cast<const DirNodeImpl&>(cont).objId));
+                break;
+            case NodeType::files:
+                break;
+        }
+        if (hierObj)
+            loadSubDirs(cont, *hierObj);
+        else
+            cont.subDirsLoaded = true; //folder not existing anymore
+    }
+
     output.clear();
     output.reserve(cont.subDirs.size() + 1); //keep pointers in "workList" valid
     std::vector<std::pair<uint64_t, int*>> workList;
@@ -333,7 +397,7 @@ void TreeView::applySubView(std::vector<RootNodeImpl>&& newView)
     if (folderCmp_.size() == 1) //single folder pair case (empty pairs were already removed!) do NOT use folderCmpView for this check!
     {
         if (!folderCmpView_.empty()) //possibly empty!
-            getChildren(folderCmpView_[0], 0, flatTree_); //do not show root
+            getChildren(folderCmpView_[0], NodeType::root, 0, flatTree_); //do not show root
     }
     else
     {
@@ -366,7 +430,7 @@ void TreeView::applySubView(std::vector<RootNodeImpl>&& newView)
             if (expandedNodes.contains(hierObj))
             {
                 std::vector<TreeLine> newLines;
-                getChildren(*line.node, line.level + 1, newLines);
+                getChildren(*line.node, line.type, line.level + 1, newLines);
 
                 flatTree_.insert(flatTree_.begin() + row + 1, newLines.begin(), newLines.end());
             }
@@ -377,7 +441,10 @@ void TreeView::applySubView(std::vector<RootNodeImpl>&& newView)
 template <class Predicate>
 void TreeView::updateView(Predicate pred)
 {
-    //update view on full data
+    //update view on full data: totals only, child nodes are created on demand
+    subDirTotalsBuf_.clear();
+    lastViewFilterPred_ = pred;
+
     std::vector<RootNodeImpl> newView;
     newView.reserve(folderCmp_.size()); //avoid expensive reallocations!
 
@@ -385,11 +452,11 @@ void TreeView::updateView(Predicate pred)
     {
         newView.emplace_back();
         RootNodeImpl& root = newView.back();
-        this->extractVisibleSubtree(*baseObj, root, pred); //"this->" is bogus for a static method, but GCC screws this one up
+        calcTotals(*baseObj, root, pred);
 
-        //warning: the following lines are almost 1:1 copy from extractVisibleSubtree:
+        //warning: the following lines are almost 1:1 copy from loadSubDirs:
         //however we *cannot* reuse code here; this were only possible if we replaced "std::vector<RootNodeImpl>" with "Container"!
-        if (!root.firstFileId && root.subDirs.empty())
+        if (!root.firstFileId && !root.hasSubDirs)
             newView.pop_back();
         else
         {
@@ -401,7 +468,6 @@ void TreeView::updateView(Predicate pred)
         }
     }
 
-    lastViewFilterPred_ = pred;
     applySubView(std::move(newView));
 }
 
@@ -427,7 +493,7 @@ TreeView::NodeStatus TreeView::getStatus(size_t row) const
         {
             case NodeType::root:
             case NodeType::folder:
-                return flatTree_[row].node->firstFileId || !flatTree_[row].node->subDirs.empty() ? TreeView::STATUS_REDUCED : TreeView::STATUS_EMPTY;
+                return flatTree_[row].node->firstFileId || flatTree_[row].node->hasSubDirs ? TreeView::STATUS_REDUCED : TreeView::STATUS_EMPTY;
 
             case NodeType::files:
                 return TreeView::STATUS_EMPTY;
@@ -453,7 +519,7 @@ void TreeView::expandNode(size_t row)
         {
             case NodeType::root:
             case NodeType::folder:
-                getChildren(*flatTree_[row].node, flatTree_[row].level + 1, newLines);
+                getChildren(*flatTree_[row].node, flatTree_[row].type, flatTree_[row].level + 1, newLines);
                 break;
             case NodeType::files:
                 break;
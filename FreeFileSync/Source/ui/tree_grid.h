@@ -8,6 +8,7 @@
 #define TREE_VIEW_H_841703190201835280256673425
 
 #include <functional>
+#include <unordered_map>
 #include <wx+/grid.h>
 #include "tree_grid_attr.h"
 #include "../base/file_hierarchy.h"
@@ -118,7 +119,9 @@ private:
         int itemCountGross  = 0;
         int itemCountNet    = 0; //number of files on view for in this directory only
 
-        std::vector<DirNodeImpl> subDirs;
+        bool hasSubDirs = false; //sub folders on view, even if not yet loaded:
+        mutable bool subDirsLoaded = false;           //child nodes are created lazily when a node is expanded
+        mutable std::vector<DirNodeImpl> subDirs;     //=> don't build millions of nodes nobody looks at
         FileSystemObject::ObjectId firstFileId = nullptr; //weak pointer to first FilePair or SymlinkPair
         //- "compress" algorithm may hide file nodes for directories with a single included file, i.e. itemCountGross == itemCountNet == 1
         //- a ContainerObject* would be a better fit, but we need weak pointer semantics!
@@ -152,9 +155,10 @@ private:
     };
 
     static void compressNode(Container& cont);
-    template <class Function>
-    static void extractVisibleSubtree(ContainerObject& hierObj, Container& cont, Function includeObject);
-    void getChildren(const Container& cont, unsigned int level, std::vector<TreeLine>& output);
+    template <class Predicate> size_t /*rows in sub tree*/ calcTotals      (ContainerObject& hierObj, Container& cont, const Predicate& pred); //no child nodes
+    template <class Predicate> size_t /*rows in sub tree*/ calcSubDirTotals(FolderPair& folder,       Container& cont, const Predicate& pred); //buffered
+    void loadSubDirs(const Container& cont, ContainerObject& hierObj);
+    void getChildren(const Container& cont, NodeType type, unsigned int level, std::vector<TreeLine>& output);
     template <class Predicate> void updateView(Predicate pred);
     void applySubView(std::vector<RootNodeImpl>&& newView);
 
@@ -167,6 +171,8 @@ private:
                     |                         */
     std::vector<RootNodeImpl> folderCmpView_; //partial view on folderCmp -> unsorted (cannot be, because files are not a separate entity)
     std::function<bool(const FileSystemObject& fsObj)> lastViewFilterPred_; //buffer view filter predicate for lazy evaluation of files/symlinks corresponding to a TYPE_FILES node
+    std::unordered_map<FileSystemObject::ObjectIdConst, Container, FileSystemObject::ObjectIdConst::Hash> subDirTotalsBuf_; //totals of larger sub trees (child nodes not loaded)
+    //=> cheap lazy loading; valid for lastViewFilterPred_ only
     /*             /|\
                     | (update...)
                     |                         */
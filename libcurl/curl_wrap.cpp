@@ -18,20 +18,31 @@ namespace
 {
 int curlInitLevel = 0; //support interleaving initialization calls!
 //zero-initialized POD => not subject to static initialization order fiasco
+
+constinit std::once_flag curlInitOnce;           //trivially destructible + constant-initialized
+constinit std::atomic<bool> curlInitDone{false}; //=> no static initialization order fiasco either
 }
 
 void zen::libcurlInit()
 {
-    assert(runningOnMainThread()); //all OpenSSL/libssh2/libcurl require init on main thread!
+    assert(runningOnMainThread());
     assert(curlInitLevel >= 0);
-    if (++curlInitLevel != 1) //non-atomic => require call from main thread
-        return;
+    ++curlInitLevel; //non-atomic => require call from main thread
+    //=> actual init is deferred until first use: see libcurlEnsureInit()
+}
 
 
-    openSslInit();
+void zen::libcurlEnsureInit()
+{
+    //OpenSSL 1.1.0+ and libcurl 7.84+ (CURL_VERSION_THREADSAFE) support init on any thread: only guard against repeated/concurrent calls
+    std::call_once(curlInitOnce, []
+    {
+        openSslInit();
 
-    [[maybe_unused]] const CURLcode rc2 = ::curl_global_init(CURL_GLOBAL_NOTHING /*CURL_GLOBAL_DEFAULT = CURL_GLOBAL_SSL|CURL_GLOBAL_WIN32*/);
-    assert(rc2 == CURLE_OK);
+        [[maybe_unused]] const CURLcode rc2 = ::curl_global_init(CURL_GLOBAL_NOTHING /*CURL_GLOBAL_DEFAULT = CURL_GLOBAL_SSL|CURL_GLOBAL_WIN32*/);
+        assert(rc2 == CURLE_OK);
+        curlInitDone = true;
+    });
 }
 
 
@@ -42,14 +53,129 @@ void zen::libcurlTearDown()
     if (--curlInitLevel != 0)
         return;
 
+    std::call_once(curlInitOnce, [] {}); //wait for init still running on some thread (if any), prevent later ones
+    if (!curlInitDone)
+        return; //never used
+
     ::curl_global_cleanup();
     openSslTearDown();
 }
 
 
-HttpSession::HttpSession(const Zstring& server, bool useTls, const Zstring& caCertFilePath) : //throw SysError
+HttpMultiplexer::HttpMultiplexer() //throw SysError
+{
+    libcurlEnsureInit();
+
+    multiHandle_ = ::curl_multi_init();
+    if (!multiHandle_)
+        throw SysError(formatSystemError("curl_multi_init", formatCurlStatusCode(CURLE_OUT_OF_MEMORY), L""));
+
+    //CURLPIPE_MULTIPLEX is libcurl default, but let's be explicit
+    if (const CURLMcode rc = ::curl_multi_setopt(multiHandle_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+        rc != CURLM_OK)
+    {
+        ::curl_multi_cleanup(multiHandle_);
+        throw SysError(formatSystemError("curl_multi_setopt(CURLMOPT_PIPELINING)", L"", utfTo<std::wstring>(::curl_multi_strerror(rc))));
+    }
+
+    worker_ = InterruptibleThread([this]
+    {
+        setCurrentThreadName(Zstr("HTTP Multiplexer"));
+        runEventLoop(); //throw ThreadStopRequest
+    });
+}
+
+
+HttpMultiplexer::~HttpMultiplexer()
+{
+    worker_.requestStop();
+    ::curl_multi_wakeup(multiHandle_);
+    worker_.join();
+
+    ::curl_multi_cleanup(multiHandle_);
+}
+
+
+CURLcode HttpMultiplexer::perform(CURL* easyHandle) //throw SysError
+{
+    auto transfer = std::make_shared<Transfer>();
+    transfer->easyHandle = easyHandle;
+    std::future<CURLcode> futDone = transfer->promiseDone.get_future();
+    {
+        std::lock_guard dummy(lockTransfers_);
+        newTransfers_.push_back(transfer);
+    }
+    //"curl_multi_wakeup() [...] can be called from any thread"
+    if (const CURLMcode rc = ::curl_multi_wakeup(multiHandle_);
+        rc != CURLM_OK)
+        throw SysError(formatSystemError("curl_multi_wakeup", L"", utfTo<std::wstring>(::curl_multi_strerror(rc)))); //=> no way to cancel a transfer that may already be running!?
+
+    return futDone.get(); //no time out needed: CURLOPT_LOW_SPEED_TIME applies
+}
+
+
+//context of worker thread: multi handle is *not* thread-safe => exclusive access from here
+void HttpMultiplexer::runEventLoop() //throw ThreadStopRequest
+{
+    std::unordered_map<CURL*, std::shared_ptr<Transfer>> activeTransfers;
+
+    auto finishTransfer = [&](CURL* easyHandle, CURLcode rc)
+    {
+        ::curl_multi_remove_handle(multiHandle_, easyHandle);
+
+        auto it = activeTransfers.find(easyHandle);
+        assert(it != activeTransfers.end());
+        if (it != activeTransfers.end())
+        {
+            it->second->promiseDone.set_value(rc);
+            activeTransfers.erase(it);
+        }
+    };
+    ZEN_ON_SCOPE_EXIT( //shutdown: don't leave any caller hanging
+        while (!activeTransfers.empty())
+            finishTransfer(activeTransfers.begin()->first, CURLE_ABORTED_BY_CALLBACK);
+
+        std::lock_guard dummy(lockTransfers_);
+        for (const std::shared_ptr<Transfer>& transfer : newTransfers_)
+            transfer->promiseDone.set_value(CURLE_ABORTED_BY_CALLBACK);
+        newTransfers_.clear();
+    );
+
+    for (;;)
+    {
+        interruptionPoint(); //throw ThreadStopRequest
+
+        std::vector<std::shared_ptr<Transfer>> newTransfers;
+        {
+            std::lock_guard dummy(lockTransfers_);
+            newTransfers.swap(newTransfers_);
+        }
+        for (const std::shared_ptr<Transfer>& transfer : newTransfers)
+            if (const CURLMcode rc = ::curl_multi_add_handle(multiHandle_, transfer->easyHandle);
+                rc != CURLM_OK)
+                transfer->promiseDone.set_value(CURLE_OUT_OF_MEMORY); //only error possible for a valid, unused easy handle
+            else
+                activeTransfers.emplace(transfer->easyHandle, transfer);
+
+        int runningTransfers = 0;
+        ::curl_multi_perform(multiHandle_, &runningTransfers);
+
+        int msgsLeft = 0;
+        while (const CURLMsg* msg = ::curl_multi_info_read(multiHandle_, &msgsLeft))
+            if (msg->msg == CURLMSG_DONE)
+                finishTransfer(msg->easy_handle, msg->data.result);
+
+        //returns early on activity or curl_multi_wakeup()
+        ::curl_multi_poll(multiHandle_, nullptr, 0, 1000 /*timeout_ms*/, nullptr);
+    }
+}
+
+//==========================================================================================
+
+HttpSession::HttpSession(const Zstring& server, bool useTls, const Zstring& caCertFilePath, HttpMultiplexer* multiplexer) : //throw SysError
     serverPrefix_((useTls ? "https://" : "http://") + utfTo<std::string>(server)),
-    caCertFilePath_(utfTo<std::string>(caCertFilePath)) {}
+    caCertFilePath_(utfTo<std::string>(caCertFilePath)),
+    multiplexer_(multiplexer) { libcurlEnsureInit(); }
 
 
 HttpSession::~HttpSession()
@@ -236,12 +362,20 @@ HttpSession::Result HttpSession::perform(const std::string& serverRelPath,
         options.emplace_back(CURLOPT_HTTPHEADER, headers);
     //---------------------------------------------------
 
+    if (multiplexer_)
+    {
+        options.emplace_back(CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS); //libcurl default since 7.62, but let's be explicit
+        options.emplace_back(CURLOPT_PIPEWAIT, 1); //rather wait for a connection that is being set up than open a new one => multiplex!
+    }
+
     append(options, extraOptions);
 
     applyCurlOptions(easyHandle_, options); //throw SysError
 
     //=======================================================================================================
-    const CURLcode rcPerf = ::curl_easy_perform(easyHandle_);
+    const CURLcode rcPerf = multiplexer_ ?
+                            multiplexer_->perform(easyHandle_) : //throw SysError
+                            ::curl_easy_perform(easyHandle_);
     //WTF: curl_easy_perform() considers FTP response codes 4XX, 5XX as failure, but for HTTP response codes 4XX are considered success!! CONSISTENCY, people!!!
     //=> at least libcurl is aware: CURLOPT_FAILONERROR: "request failure on HTTP response >= 400"; default: "0, do not fail on error"
     //https://curl.haxx.se/docs/faq.html#curl_doesn_t_return_error_for_HT
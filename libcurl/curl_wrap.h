@@ -10,7 +10,9 @@
 #include <chrono>
 #include <span>
 #include <functional>
+#include <future>
 #include <zen/sys_error.h>
+#include <zen/thread.h>
 #include <zen/zstring.h>
 
 
@@ -24,8 +26,12 @@
 
 namespace zen
 {
+/*  libcurlInit()/libcurlTearDown(): main thread only, e.g. static UniInitializer => no network library is touched yet
+    libcurlEnsureInit(): thread-safe, one-time OpenSSL + curl_global_init() on first use (HttpSession, HttpMultiplexer, FTP session)
+    => purely local jobs don't pay for initializing the network stack          */
 void libcurlInit();
 void libcurlTearDown();
+void libcurlEnsureInit(); //noexcept
 
 
 struct CurlOption
@@ -41,10 +47,40 @@ struct CurlOption
 };
 
 
+/*  HTTP/2 multiplexing: run transfers of many HttpSessions over shared connections (one per server, if supported)
+    - curl multi event loop on a dedicated worker thread; calling threads block until their transfer is done
+    - CAVEAT: curl callbacks run on the worker thread => must not block! (e.g. streaming file content: use a dedicated HttpSession)  */
+class HttpMultiplexer
+{
+public:
+    HttpMultiplexer(); //throw SysError
+    ~HttpMultiplexer();
+
+    CURLcode perform(CURL* easyHandle); //throw SysError
+
+private:
+    HttpMultiplexer           (const HttpMultiplexer&) = delete;
+    HttpMultiplexer& operator=(const HttpMultiplexer&) = delete;
+
+    void runEventLoop(); //throw ThreadStopRequest
+
+    struct Transfer
+    {
+        CURL* easyHandle = nullptr;
+        std::promise<CURLcode> promiseDone;
+    };
+
+    CURLM* multiHandle_ = nullptr;
+    std::mutex lockTransfers_;
+    std::vector<std::shared_ptr<Transfer>> newTransfers_; //protected by lockTransfers_
+    InterruptibleThread worker_; //accesses multiHandle_ => declare last
+};
+
+
 class HttpSession
 {
 public:
-    HttpSession(const Zstring& server, bool useTls, const Zstring& caCertFilePath /*optional*/); //throw SysError
+    HttpSession(const Zstring& server, bool useTls, const Zstring& caCertFilePath /*optional*/, HttpMultiplexer* multiplexer /*optional*/); //throw SysError
     ~HttpSession();
 
     struct Result
@@ -67,6 +103,7 @@ private:
 
     const std::string serverPrefix_;
     const std::string caCertFilePath_; //optional
+    HttpMultiplexer* const multiplexer_; //optional
     CURL* easyHandle_ = nullptr;
     std::chrono::steady_clock::time_point lastSuccessfulUseTime_ = std::chrono::steady_clock::now();
 };
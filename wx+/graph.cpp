@@ -435,6 +435,128 @@ std::vector<CurvePoint> SparseCurveData::getPoints(double minX, double maxX, con
 }
 
 
+void DecimatedCurveData::mergeBucket(Bucket& bucket, const Bucket& other)
+{
+    assert(bucket.last.x <= other.first.x);
+    bucket.last = other.last;
+    if (other.min.y < bucket.min.y) bucket.min = other.min;
+    if (other.max.y > bucket.max.y) bucket.max = other.max;
+    bucket.sampleCount += other.sampleCount;
+}
+
+
+void DecimatedCurveData::addSample(const CurvePoint& pt)
+{
+    assert(levels_.empty() || levels_[0].back().last.x <= pt.x);
+    const Bucket sample{pt, pt, pt, pt, 1};
+
+    if (levels_.empty())
+    {
+        levels_.emplace_back();
+        levelBucketSize_.push_back(1);
+    }
+
+    //update all levels immediately: coarse levels need to reflect the latest sample, too
+    for (size_t level = 0; level < levels_.size(); ++level)
+    {
+        RingBuffer<Bucket>& buckets = levels_[level];
+        if (buckets.empty() || buckets.back().sampleCount >= levelBucketSize_[level])
+            buckets.push_back(sample);
+        else
+            mergeBucket(buckets.back(), sample);
+    }
+
+    if (RingBuffer<Bucket>& top = levels_.back();
+        top.size() > LEVEL_SIZE_MAX) //top level is complete since first sample => aggregate into new level
+    {
+        RingBuffer<Bucket> buckets;
+        for (const Bucket& b : top)
+            if (buckets.empty() || buckets.back().sampleCount >= levelBucketSize_.back() * LEVEL_FACTOR)
+                buckets.push_back(b);
+            else
+                mergeBucket(buckets.back(), b);
+
+        levelBucketSize_.push_back(levelBucketSize_.back() * LEVEL_FACTOR);
+        levels_.push_back(std::move(buckets));
+    }
+
+    for (size_t level = 0; level + 1 < levels_.size(); ++level)
+        while (levels_[level].size() > LEVEL_SIZE_MAX) //limit buffer size
+            levels_[level].pop_front();
+}
+
+
+std::pair<double, double> DecimatedCurveData::getRangeX() const
+{
+    if (levels_.empty())
+        return {};
+    return {levels_.back().front().first.x, levels_[0].back().last.x};
+}
+
+
+std::vector<CurvePoint> DecimatedCurveData::getPoints(double minX, double maxX, const wxSize& areaSizePx) const
+{
+    std::vector<CurvePoint> points;
+
+    const int pixelWidth = areaSizePx.GetWidth();
+    if (pixelWidth <= 1 || levels_.empty()) return points;
+
+    const double rangeMinX = std::max(minX, getRangeX().first);
+
+    for (size_t level = 0; level < levels_.size(); ++level)
+    {
+        const RingBuffer<Bucket>& buckets = levels_[level];
+        const bool isTopLevel = level + 1 == levels_.size();
+
+        if (!isTopLevel && buckets.front().first.x > rangeMinX) //older samples already dropped from this level
+            continue;
+
+        auto itFirst = std::partition_point(buckets.begin(), buckets.end(), [&](const Bucket& b) { return b.last.x < minX; });
+        auto itLast  = std::partition_point(itFirst,         buckets.end(), [&](const Bucket& b) { return b.first.x <= maxX; });
+
+        if (!isTopLevel && itLast - itFirst > 2 * pixelWidth)
+            continue;
+
+        //top level may still be too dense: merge buckets on the fly
+        const ptrdiff_t groupSize = std::max<ptrdiff_t>(1, (itLast - itFirst + 2 * pixelWidth - 1) / (2 * pixelWidth));
+
+        //include neighbor buckets to keep the line stable at the borders (points outside the draw area are trimmed)
+        if (itFirst != buckets.begin()) --itFirst;
+        if (itLast  != buckets.end  ()) ++itLast;
+
+        auto addPoint = [&](const CurvePoint& pt)
+        {
+            if (!points.empty())
+            {
+                if (pt.x <= points.back().x) //allow ascending x-positions only! (first/min/max/last may coincide)
+                    return;
+
+                if (addSteps_)
+                    if (pt.y != points.back().y)
+                        points.emplace_back(CurvePoint{pt.x, points.back().y});
+            }
+            points.push_back(pt);
+        };
+
+        for (auto it = itFirst; it != itLast;)
+        {
+            Bucket b = *it;
+            for (ptrdiff_t i = 1; ++it != itLast && i < groupSize; ++i)
+                mergeBucket(b, *it);
+
+            //keep min and max in x-order => the visual envelope is preserved
+            const bool minFirst = b.min.x <= b.max.x;
+            addPoint(b.first);
+            addPoint(minFirst ? b.min : b.max);
+            addPoint(minFirst ? b.max : b.min);
+            addPoint(b.last);
+        }
+        break;
+    }
+    return points;
+}
+
+
 Graph2D::Graph2D(wxWindow* parent,
                  wxWindowID winid,
                  const wxPoint& pos,
@@ -14,6 +14,7 @@
 #include <wx/settings.h>
 #include <wx/bitmap.h>
 #include <zen/string_tools.h>
+#include <zen/ring_buffer.h>
 #include "dc.h"
 
 
@@ -102,6 +103,43 @@ private:
     std::vector<double> data_;
 };
 
+
+/*  min/max-preserving multi-resolution sample store (LOD pyramid) for long-running series, e.g. progress graphs:
+    - level 0: raw samples, level n: buckets of LEVEL_FACTOR^n samples keeping first, last, min and max
+    - every level but the top one only keeps its latest LEVEL_SIZE_MAX buckets => memory bounded by O(log(sample count))
+    - rendering picks the finest level covering the x-range with at most ~2 buckets per pixel => O(pixels), independent of sample count */
+class DecimatedCurveData : public CurveData
+{
+public:
+    explicit DecimatedCurveData(bool addSteps = false) : addSteps_(addSteps) {} //addSteps: see SparseCurveData
+
+    void addSample(const CurvePoint& pt); //x: monotonously ascending!
+    void clear() { levels_.clear(); }
+    bool empty() const { return levels_.empty(); }
+
+protected:
+    std::pair<double, double> getRangeX() const override;
+    std::vector<CurvePoint> getPoints(double minX, double maxX, const wxSize& areaSizePx) const override;
+
+private:
+    static constexpr size_t LEVEL_SIZE_MAX = 16 * 1024;
+    static constexpr size_t LEVEL_FACTOR = 4;
+
+    struct Bucket
+    {
+        CurvePoint first;
+        CurvePoint last;
+        CurvePoint min;
+        CurvePoint max;
+        size_t sampleCount = 0;
+    };
+    static void mergeBucket(Bucket& bucket, const Bucket& other);
+
+    std::vector<RingBuffer<Bucket>> levels_; //x: monotonously ascending within each level
+    std::vector<size_t> levelBucketSize_;    //LEVEL_FACTOR^n
+    const bool addSteps_;
+};
+
 //------------------------------------------------------------------------------------------------------------
 
 struct LabelFormatter
@@ -188,6 +188,8 @@ public:
     void showScrollBars(ScrollBarStatus horizontal, ScrollBarStatus vertical);
 
     std::vector<size_t> getSelectedRows() const { return selection_.get(); }
+    //perf: prefer over getSelectedRows() for large grids: half-open [rowFirst, rowLast), sorted, disjoint
+    const std::vector<std::pair<size_t, size_t>>& getSelectedRanges() const { return selection_.getRanges(); }
 
     void selectRow(size_t row, GridEventPolicy rangeEventPolicy);
     void selectAllRows (GridEventPolicy rangeEventPolicy); //turn off range selection event when calling this function in an event handler to avoid recursion!
@@ -251,40 +253,66 @@ private:
     class ColLabelWin;
     class MainWin;
 
-    class Selection
+    class Selection //interval set: select all on millions of rows => a single range, no per-row state
     {
     public:
-        void init(size_t rowCount) { selected_.resize(rowCount); clear(); }
+        void init(size_t rowCount) { rowCount_ = rowCount; clear(); }
 
-        size_t gridSize() const { return selected_.size(); }
+        size_t gridSize() const { return rowCount_; }
 
         std::vector<size_t> get() const
         {
             std::vector<size_t> result;
-            for (size_t row = 0; row < selected_.size(); ++row)
-                if (selected_[row] != 0)
+            for (const auto& [rowFirst, rowLast] : ranges_)
+                for (size_t row = rowFirst; row < rowLast; ++row)
                     result.push_back(row);
             return result;
         }
 
-        void clear() { selectRange(0, selected_.size(), false); }
+        const std::vector<std::pair<size_t, size_t>>& getRanges() const { return ranges_; } //half-open [rowFirst, rowLast): sorted, disjoint, not adjacent
 
-        bool isSelected(size_t row) const { return row < selected_.size() ? selected_[row] != 0 : false; }
+        void clear() { ranges_.clear(); }
+
+        bool isSelected(size_t row) const //O(log #ranges)
+        {
+            auto it = std::upper_bound(ranges_.begin(), ranges_.end(), row, [](size_t r, const std::pair<size_t, size_t>& range) { return r < range.first; });
+            return it != ranges_.begin() && row < (--it)->second;
+        }
 
         void selectRange(size_t rowFirst, size_t rowLast, bool positive = true) //select [rowFirst, rowLast), trims if required!
         {
             if (rowFirst <= rowLast)
             {
-                rowFirst = std::clamp<size_t>(rowFirst, 0, selected_.size());
-                rowLast  = std::clamp<size_t>(rowLast,  0, selected_.size());
-
-                std::fill(selected_.begin() + rowFirst, selected_.begin() + rowLast, positive);
+                rowFirst = std::clamp<size_t>(rowFirst, 0, rowCount_);
+                rowLast  = std::clamp<size_t>(rowLast,  0, rowCount_);
+                if (rowFirst == rowLast)
+                    return;
+
+                //affected ranges: overlapping (and adjacent if positive => merge)
+                auto itFirst = std::find_if(ranges_.begin(), ranges_.end(), [&](const std::pair<size_t, size_t>& range)
+                { return positive ? range.second >= rowFirst : range.second > rowFirst; });
+                auto itLast = std::find_if(itFirst, ranges_.end(), [&](const std::pair<size_t, size_t>& range)
+                { return positive ? range.first > rowLast : range.first >= rowLast; });
+
+                std::vector<std::pair<size_t, size_t>> replacement;
+                if (positive)
+                    replacement.emplace_back(itFirst != itLast ? std::min(rowFirst, itFirst->first)          : rowFirst,
+                                             itFirst != itLast ? std::max(rowLast, std::prev(itLast)->second) : rowLast);
+                else if (itFirst != itLast)
+                {
+                    if (itFirst->first < rowFirst)
+                        replacement.emplace_back(itFirst->first, rowFirst);
+                    if (rowLast < std::prev(itLast)->second)
+                        replacement.emplace_back(rowLast, std::prev(itLast)->second);
+                }
+                ranges_.insert(ranges_.erase(itFirst, itLast), replacement.begin(), replacement.end());
             }
             else assert(false);
         }
 
     private:
-        std::vector<unsigned char> selected_; //effectively a vector<bool> of size "number of rows"
+        size_t rowCount_ = 0;
+        std::vector<std::pair<size_t, size_t>> ranges_;
     };
 
     struct VisibleColumn
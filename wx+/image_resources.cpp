@@ -6,7 +6,9 @@
 
 #include "image_resources.h"
 #include <map>
+#include <zen/crc.h>
 #include <zen/utf.h>
+#include <zen/file_access.h>
 #include <zen/perf.h>
 #include <zen/thread.h>
 #include <zen/file_io.h>
@@ -25,42 +27,38 @@ using namespace zen;
 
 namespace
 {
-ImageHolder xbrzScale(int width, int height, const unsigned char* imageRgb, const unsigned char* imageAlpha, int hqScale)
-{
-    assert(imageRgb && imageAlpha && width > 0 && height > 0); //see convertToVanillaImage()
-    if (width <= 0 || height <= 0)
-        return ImageHolder(0, 0, true /*withAlpha*/);
+const char IMAGE_DB_FILE_DESCR[] = "FreeFileSync";
+const int  IMAGE_DB_FILE_VERSION = 1; //2026-10-14
 
-    const int hqWidth  = width  * hqScale;
-    const int hqHeight = height * hqScale;
+const int XBRZ_SLICE_ROWS_MIN = 16; //see xbrz::scale(): "avoid processing single rows only; suggestion: process at least 8-16 rows"
 
-    //get rid of allocation and buffer std::vector<> at thread-level? => no discernable perf improvement
-    std::vector<uint32_t> buf(hqWidth * hqHeight + width * height);
-    uint32_t* const argbSrc = &buf[0] + hqWidth * hqHeight;
-    uint32_t* const xbrTrg  = &buf[0];
 
-    //convert RGB (RGB byte order) to ARGB (BGRA byte order)
-    {
-        const unsigned char* rgb = imageRgb;
-        const unsigned char* rgbEnd = rgb + 3 * width * height;
-        const unsigned char* alpha  = imageAlpha;
-        uint32_t* out = argbSrc;
+//shared by all slice tasks of one image
+struct XbrzScaleJob
+{
+    XbrzScaleJob(const std::string& name, int w, int h, int scale) : imageName(name), width(w), height(h), hqScale(scale),
+        //get rid of allocation and buffer std::vector<> at thread-level? => no discernable perf improvement
+        argbSrc(w * h), xbrTrg(w * scale * h * scale) {}
+
+    const std::string imageName;
+    const int width;
+    const int height;
+    const int hqScale;
+    std::vector<uint32_t> argbSrc;
+    std::vector<uint32_t> xbrTrg;
+    std::atomic<int> slicesPending{0};
+};
+
+
+ImageHolder convertXbrzResult(const XbrzScaleJob& job)
+{
+    const int hqWidth  = job.width  * job.hqScale;
+    const int hqHeight = job.height * job.hqScale;
 
-        for (; rgb < rgbEnd; rgb += 3)
-            *out++ = xbrz::makePixel(*alpha++, rgb[0], rgb[1], rgb[2]);
-    }
-    //-----------------------------------------------------
-    xbrz::scale(hqScale,       //size_t factor - valid range: 2 - SCALE_FACTOR_MAX
-                argbSrc,       //const uint32_t* src
-                xbrTrg,        //uint32_t* trg
-                width, height, //int srcWidth, int srcHeight
-                xbrz::ColorFormat::argbUnbuffered); //ColorFormat colFmt
-    //test: total xBRZ scaling time with ARGB: 300ms, ARGB unbuffered: 50ms
-    //-----------------------------------------------------
     //convert BGRA to RGB + alpha
     ImageHolder trgImg(hqWidth, hqHeight, true /*withAlpha*/);
 
-    std::for_each(xbrTrg, xbrTrg + hqWidth * hqHeight, [rgb = trgImg.getRgb(), alpha = trgImg.getAlpha()](uint32_t col) mutable
+    std::for_each(job.xbrTrg.begin(), job.xbrTrg.end(), [rgb = trgImg.getRgb(), alpha = trgImg.getAlpha()](uint32_t col) mutable
     {
         *alpha++ = xbrz::getAlpha(col);
         *rgb++   = xbrz::getRed  (col);
@@ -71,19 +69,53 @@ ImageHolder xbrzScale(int width, int height, const unsigned char* imageRgb, cons
 }
 
 
-auto getScalerTask(const std::string& imageName, const wxImage& img, int hqScale, Protected<std::vector<std::pair<std::string, ImageHolder>>>& result)
+//split large images into row slices: xBRZ supports scaling non-overlapping [yFirst, yLast) ranges of the same image in parallel
+std::vector<std::function<void()>> getScalerTasks(const std::string& imageName, const wxImage& img, int hqScale, size_t threadCount,
+                                                  Protected<std::vector<std::pair<std::string, ImageHolder>>>& result)
 {
     assert(runningOnMainThread());
-    return [imageName,
-            width  = img.GetWidth(),  //
-            height = img.GetHeight(), //don't call wxWidgets functions from worker thread
-            rgb    = img.GetData(),   //
-            alpha  = img.GetAlpha(),  //
-            hqScale, &result]
+    const int width  = img.GetWidth();  //don't call wxWidgets functions from worker thread
+    const int height = img.GetHeight(); //
+    assert(img.GetData() && img.GetAlpha() && width > 0 && height > 0); //see convertToVanillaImage()
+    if (width <= 0 || height <= 0)
+        return {};
+
+    auto job = std::make_shared<XbrzScaleJob>(imageName, width, height, hqScale);
+
+    //convert RGB (RGB byte order) to ARGB (BGRA byte order)
     {
-        ImageHolder ih = xbrzScale(width, height, rgb, alpha, hqScale);
-        result.access([&](std::vector<std::pair<std::string, ImageHolder>>& r) { r.emplace_back(imageName, std::move(ih)); });
-    };
+        const unsigned char* rgb = img.GetData();
+        const unsigned char* rgbEnd = rgb + 3 * width * height;
+        const unsigned char* alpha  = img.GetAlpha();
+        uint32_t* out = job->argbSrc.data();
+
+        for (; rgb < rgbEnd; rgb += 3)
+            *out++ = xbrz::makePixel(*alpha++, rgb[0], rgb[1], rgb[2]);
+    }
+
+    const int sliceRows = std::max(XBRZ_SLICE_ROWS_MIN, numeric::intDivCeil(height, static_cast<int>(threadCount)));
+
+    std::vector<std::function<void()>> tasks;
+    for (int yFirst = 0; yFirst < height; yFirst += sliceRows)
+        tasks.push_back([job, yFirst, yLast = std::min(yFirst + sliceRows, height), &result]
+        {
+            xbrz::scale(job->hqScale,                      //size_t factor - valid range: 2 - SCALE_FACTOR_MAX
+                        job->argbSrc.data(),                //const uint32_t* src
+                        job->xbrTrg.data(),                 //uint32_t* trg
+                        job->width, job->height,            //int srcWidth, int srcHeight
+                        xbrz::ColorFormat::argbUnbuffered,  //ColorFormat colFmt
+                        xbrz::ScalerCfg(), yFirst, yLast);  //slice of source image
+            //test: total xBRZ scaling time with ARGB: 300ms, ARGB unbuffered: 50ms
+
+            if (--job->slicesPending == 0) //last slice finished (memory order: seq_cst => all slices' writes are visible)
+            {
+                ImageHolder ih = convertXbrzResult(*job);
+                result.access([&](std::vector<std::pair<std::string, ImageHolder>>& r) { r.emplace_back(job->imageName, std::move(ih)); });
+            }
+        });
+
+    job->slicesPending = static_cast<int>(tasks.size());
+    return tasks;
 }
 
 
@@ -92,19 +124,17 @@ class HqParallelScaler
 public:
     explicit HqParallelScaler(int hqScale) : hqScale_(hqScale) { assert(hqScale > 1); }
 
-    ~HqParallelScaler() { threadGroup_ = {}; } //imgKeeper_ must out-live threadGroup!!!
-
     void add(const std::string& imageName, const wxImage& img)
     {
         assert(runningOnMainThread());
-        imgKeeper_.push_back(img); //retain (ref-counted) wxImage so that the rgb/alpha pointers remain valid after passed to threads
-        threadGroup_->run(getScalerTask(imageName, img, hqScale_, result_));
+        for (std::function<void()>& task : getScalerTasks(imageName, img, hqScale_, threadCount_, result_))
+            threadGroup_.run(std::move(task));
     }
 
     std::unordered_map<std::string, wxImage> waitAndGetResult()
     {
         assert(runningOnMainThread());
-        threadGroup_->wait();
+        threadGroup_.wait();
 
         std::unordered_map<std::string, wxImage> output;
 
@@ -123,12 +153,181 @@ public:
 
 private:
     const int hqScale_;
-    std::vector<wxImage> imgKeeper_;
     Protected<std::vector<std::pair<std::string, ImageHolder>>> result_;
 
-    using TaskType = FunctionReturnTypeT<decltype(&getScalerTask)>;
-    std::optional<ThreadGroup<TaskType>> threadGroup_{ThreadGroup<TaskType>(std::max<int>(std::thread::hardware_concurrency(), 1), Zstr("xBRZ Scaler"))};
-    //hardware_concurrency() == 0 if "not computable or well defined"
+    const size_t threadCount_ = std::max<int>(std::thread::hardware_concurrency(), 1); //hardware_concurrency() == 0 if "not computable or well defined"
+    WorkStealingThreadGroup<std::function<void()>> threadGroup_{threadCount_, Zstr("xBRZ Scaler")}; //tasks don't reference wxImage data => no need to retain input images
+};
+
+//================================================================================================
+//================================================================================================
+
+/*  persistent cache of xBRZ-scaled images: avoid the scaling cost at every startup (FreeFileSync is frequently started from scheduled tasks)
+    - keyed by image name, validated by CRC32 of the PNG stream and the DPI scale factor
+    - pixels are stored uncompressed: loading must be cheaper than xBRZ-scaling, and zlib is not linked into all consumers  */
+class ScaledImageCache
+{
+public:
+    ScaledImageCache(const Zstring& dbFilePath, int hqScale) : dbFilePath_(dbFilePath), hqScale_(hqScale)
+    {
+        if (!dbFilePath_.empty())
+            try
+            {
+                entries_ = loadEntries(dbFilePath_, hqScale_); //throw FileError
+            }
+            catch (FileError&) { modified_ = true; } //it's just a cache: start from scratch; corrupted DB file will be overwritten at teardown
+    }
+
+    std::optional<wxImage> lookup(const std::string& imageName, uint32_t streamCrc)
+    {
+        auto it = entries_.find(imageName);
+        if (it == entries_.end())
+            return std::nullopt;
+
+        const Entry& entry = it->second;
+        if (entry.streamCrc != streamCrc)
+        {
+            entries_.erase(it);
+            modified_ = true;
+            return std::nullopt;
+        }
+
+        wxImage img(entry.width, entry.height, false /*clear*/);
+        img.InitAlpha();
+        std::copy(entry.rgb  .begin(), entry.rgb  .end(), img.GetData ());
+        std::copy(entry.alpha.begin(), entry.alpha.end(), img.GetAlpha());
+        return img;
+    }
+
+    void store(const std::string& imageName, uint32_t streamCrc, const wxImage& img)
+    {
+        if (dbFilePath_.empty())
+            return;
+
+        const int width  = img.GetWidth();
+        const int height = img.GetHeight();
+        assert(img.GetData() && img.GetAlpha());
+
+        Entry& entry = entries_[imageName];
+        entry.streamCrc = streamCrc;
+        entry.width  = width;
+        entry.height = height;
+        entry.rgb  .assign(reinterpret_cast<const char*>(img.GetData ()), 3 * width * height);
+        entry.alpha.assign(reinterpret_cast<const char*>(img.GetAlpha()),     width * height);
+        modified_ = true;
+    }
+
+    //drop images no longer part of the resources
+    void limitTo(const std::unordered_map<std::string, std::string>& pngStreams)
+    {
+        std::erase_if(entries_, [&](const auto& item)
+        {
+            if (pngStreams.contains(item.first))
+                return false;
+            modified_ = true;
+            return true;
+        });
+    }
+
+    void save() //throw FileError
+    {
+        if (dbFilePath_.empty() || !modified_)
+            return;
+
+        MemoryStreamOut<std::string> streamOut;
+        writeArray(streamOut, IMAGE_DB_FILE_DESCR, sizeof(IMAGE_DB_FILE_DESCR));
+        writeNumber<int32_t>(streamOut, IMAGE_DB_FILE_VERSION);
+        writeNumber<int32_t>(streamOut, hqScale_);
+
+        writeNumber<uint32_t>(streamOut, static_cast<uint32_t>(entries_.size()));
+        for (const auto& [imageName, entry] : entries_)
+        {
+            writeContainer(streamOut, imageName);
+            writeNumber<uint32_t>(streamOut, entry.streamCrc);
+            writeNumber<int32_t >(streamOut, entry.width);
+            writeNumber<int32_t >(streamOut, entry.height);
+            writeContainer(streamOut, entry.rgb);
+            writeContainer(streamOut, entry.alpha);
+        }
+        setFileContent(dbFilePath_, streamOut.ref(), nullptr /*notifyUnbufferedIO*/); //throw FileError
+        modified_ = false;
+    }
+
+private:
+    ScaledImageCache           (const ScaledImageCache&) = delete;
+    ScaledImageCache& operator=(const ScaledImageCache&) = delete;
+
+    struct Entry
+    {
+        uint32_t streamCrc = 0;
+        int width  = 0;
+        int height = 0;
+        std::string rgb;
+        std::string alpha;
+    };
+    using EntryMap = std::map<std::string /*image name*/, Entry>;
+
+    static EntryMap loadEntries(const Zstring& dbFilePath, int hqScale) //throw FileError
+    {
+        std::string byteStream;
+        try
+        {
+            byteStream = getFileContent(dbFilePath, nullptr /*notifyUnbufferedIO*/); //throw FileError
+        }
+        catch (FileError&)
+        {
+            if (itemStillExists(dbFilePath)) //throw FileError
+                throw;
+
+            return {};
+        }
+
+        try
+        {
+            MemoryStreamIn streamIn(byteStream);
+            //-------- file format header --------
+            char tmp[sizeof(IMAGE_DB_FILE_DESCR)] = {};
+            readArray(streamIn, &tmp, sizeof(tmp)); //throw SysErrorUnexpectedEos
+
+            if (!std::equal(std::begin(tmp), std::end(tmp), std::begin(IMAGE_DB_FILE_DESCR)))
+                throw SysError(_("File content is corrupted.") + L" (invalid header)");
+
+            const int version = readNumber<int32_t>(streamIn); //throw SysErrorUnexpectedEos
+            if (version != IMAGE_DB_FILE_VERSION)
+                throw SysError(_("Unsupported data format.") + L' ' + replaceCpy(_("Version: %x"), L"%x", numberTo<std::wstring>(version)));
+
+            if (readNumber<int32_t>(streamIn) != hqScale) //throw SysErrorUnexpectedEos
+                return {}; //DPI changed: scaled images are useless
+
+            EntryMap em;
+            size_t entryCount = readNumber<uint32_t>(streamIn); //throw SysErrorUnexpectedEos
+            while (entryCount-- != 0)
+            {
+                const std::string imageName = readContainer<std::string>(streamIn); //
+                Entry& entry = em[imageName];
+                entry.streamCrc = readNumber<uint32_t>(streamIn);       //
+                entry.width     = readNumber<int32_t >(streamIn);       //throw SysErrorUnexpectedEos
+                entry.height    = readNumber<int32_t >(streamIn);       //
+                entry.rgb       = readContainer<std::string>(streamIn); //
+                entry.alpha     = readContainer<std::string>(streamIn); //
+
+                if (entry.width <= 0 || entry.height <= 0 ||
+                    entry.rgb  .size() != 3 * static_cast<size_t>(entry.width) * entry.height ||
+                    entry.alpha.size() !=     static_cast<size_t>(entry.width) * entry.height)
+                    throw SysError(_("File content is corrupted.") + L" (invalid image size)");
+            }
+            return em;
+        }
+        catch (const SysError& e)
+        {
+            throw FileError(replaceCpy(_("Cannot read database file %x."), L"%x", fmtPath(dbFilePath)), e.toString());
+        }
+    }
+
+    const Zstring dbFilePath_; //empty: no persistent cache
+    const int hqScale_;
+    EntryMap entries_;
+    bool modified_ = false;
 };
 
 //================================================================================================
@@ -137,10 +336,12 @@ private:
 class ImageBuffer
 {
 public:
-    explicit ImageBuffer(const Zstring& filePath); //throw FileError
+    ImageBuffer(const Zstring& zipPath, const Zstring& cacheFilePath); //throw FileError
 
     const wxImage& getImage(const std::string& name, int maxWidth /*optional*/, int maxHeight /*optional*/);
 
+    void saveCache() { scaledCache_.save(); } //throw FileError
+
 private:
     ImageBuffer           (const ImageBuffer&) = delete;
     ImageBuffer& operator=(const ImageBuffer&) = delete;
@@ -148,10 +349,15 @@ private:
     const wxImage& getRawImage   (const std::string& name);
     const wxImage& getScaledImage(const std::string& name);
 
+    //do we need xBRZ scaling for high quality DPI images?
+    const int hqScale_ = std::clamp(numeric::intDivCeil(fastFromDIP(1000), 1000), 1, xbrz::SCALE_FACTOR_MAX);
+    //even for 125% DPI scaling, "2xBRZ + bilinear downscale" gives a better result than mere "125% bilinear upscale"!
+
+    std::unordered_map<std::string, std::string> pngStreams_; //decode on first access: most images are never shown during a session
     std::unordered_map<std::string, wxImage> imagesRaw_;
     std::unordered_map<std::string, wxImage> imagesScaled_;
 
-    std::unique_ptr<HqParallelScaler> hqScaler_;
+    ScaledImageCache scaledCache_;
 
     using OutImageKey = std::tuple<std::string /*name*/, int /*height*/>;
 
@@ -174,7 +380,8 @@ private:
 };
 
 
-ImageBuffer::ImageBuffer(const Zstring& zipPath) //throw FileError
+ImageBuffer::ImageBuffer(const Zstring& zipPath, const Zstring& cacheFilePath) : //throw FileError
+    scaledCache_(hqScale_ > 1 ? cacheFilePath : Zstring(), hqScale_)
 {
     std::vector<std::pair<Zstring /*file name*/, std::string /*byte stream*/>> streams;
 
@@ -213,37 +420,13 @@ ImageBuffer::ImageBuffer(const Zstring& zipPath) //throw FileError
     //activate support for .png files
     wxImage::AddHandler(new wxPNGHandler); //ownership passed
 
-    //do we need xBRZ scaling for high quality DPI images?
-    const int hqScale = std::clamp(numeric::intDivCeil(fastFromDIP(1000), 1000), 1, xbrz::SCALE_FACTOR_MAX);
-    //even for 125% DPI scaling, "2xBRZ + bilinear downscale" gives a better result than mere "125% bilinear upscale"!
-    if (hqScale > 1)
-        hqScaler_ = std::make_unique<HqParallelScaler>(hqScale);
-
-    for (const auto& [fileName, stream] : streams)
+    for (auto& [fileName, stream] : streams)
         if (endsWith(fileName, Zstr(".png")))
-        {
-            wxMemoryInputStream wxstream(stream.c_str(), stream.size()); //stream does not take ownership of data
-
-            wxImage img(wxstream, wxBITMAP_TYPE_PNG);
-            assert(img.IsOk());
-
-            //end this alpha/no-alpha/mask/wxDC::DrawBitmap/RTL/high-contrast-scheme interoperability nightmare here and now!!!!
-            //=> there's only one type of wxImage: with alpha channel, no mask!!!
-            convertToVanillaImage(img);
-
-            const std::string imageName = utfTo<std::string>(beforeLast(fileName, Zstr("."), IfNotFoundReturn::none));
-
-            imagesRaw_.emplace(imageName, img);
-            if (hqScaler_)
-                hqScaler_->add(imageName, img); //scale in parallel!
-            else
-                imagesScaled_.emplace(imageName, img);
-
-            //wxBitmap::NewFromPNGData(stream.c_str(), stream.size())?
-            //  => Windows: just a (slow!) wrapper for wxBitmap(wxImage())!
-        }
+            pngStreams_.emplace(utfTo<std::string>(beforeLast(fileName, Zstr("."), IfNotFoundReturn::none)), std::move(stream));
         else
             assert(false);
+
+    scaledCache_.limitTo(pngStreams_);
 }
 
 
@@ -253,6 +436,24 @@ const wxImage& ImageBuffer::getRawImage(const std::string& name)
         it != imagesRaw_.end())
         return it->second;
 
+    if (auto itStream = pngStreams_.find(name);
+        itStream != pngStreams_.end())
+    {
+        const std::string& stream = itStream->second;
+        wxMemoryInputStream wxstream(stream.c_str(), stream.size()); //stream does not take ownership of data
+
+        wxImage img(wxstream, wxBITMAP_TYPE_PNG);
+        assert(img.IsOk());
+
+        //end this alpha/no-alpha/mask/wxDC::DrawBitmap/RTL/high-contrast-scheme interoperability nightmare here and now!!!!
+        //=> there's only one type of wxImage: with alpha channel, no mask!!!
+        convertToVanillaImage(img);
+
+        //wxBitmap::NewFromPNGData(stream.c_str(), stream.size())?
+        //  => Windows: just a (slow!) wrapper for wxBitmap(wxImage())!
+        return imagesRaw_.emplace(name, std::move(img)).first->second;
+    }
+
     assert(false);
     return wxNullImage;
 }
@@ -260,21 +461,32 @@ const wxImage& ImageBuffer::getRawImage(const std::string& name)
 
 const wxImage& ImageBuffer::getScaledImage(const std::string& name)
 {
-    //test: this function is first called about 220ms after ImageBuffer::ImageBuffer() has ended
-    //      => should be enough time to finish xBRZ scaling in parallel (which takes 50ms)
-    //debug perf: extra 800-1000ms during startup
-    if (hqScaler_)
-    {
-        imagesScaled_ = hqScaler_->waitAndGetResult();
-        hqScaler_.reset();
-    }
-
     if (auto it = imagesScaled_.find(name);
         it != imagesScaled_.end())
         return it->second;
 
-    assert(false);
-    return wxNullImage;
+    const wxImage& rawImg = getRawImage(name);
+    if (hqScale_ <= 1 || !rawImg.IsOk())
+        return rawImg;
+
+    const uint32_t streamCrc = getCrc32(pngStreams_.find(name)->second); //getRawImage() succeeded => PNG stream exists
+
+    if (std::optional<wxImage> img = scaledCache_.lookup(name, streamCrc))
+        return imagesScaled_.emplace(name, std::move(*img)).first->second;
+
+    //scale this image only, but split into row slices to use all cores
+    HqParallelScaler hqScaler(hqScale_);
+    hqScaler.add(name, rawImg);
+    std::unordered_map<std::string, wxImage> result = hqScaler.waitAndGetResult();
+
+    auto itResult = result.find(name);
+    if (itResult == result.end())
+    {
+        assert(false);
+        return rawImg;
+    }
+    scaledCache_.store(name, streamCrc, itResult->second);
+    return imagesScaled_.emplace(name, std::move(itResult->second)).first->second;
 }
 
 
@@ -313,11 +525,11 @@ std::unique_ptr<ImageBuffer> globalImageBuffer;
 }
 
 
-void zen::imageResourcesInit(const Zstring& zipPath) //throw FileError
+void zen::imageResourcesInit(const Zstring& zipPath, const Zstring& cacheFilePath) //throw FileError
 {
     assert(runningOnMainThread()); //wxWidgets is not thread-safe!
     assert(!globalImageBuffer);
-    globalImageBuffer = std::make_unique<ImageBuffer>(zipPath); //throw FileError
+    globalImageBuffer = std::make_unique<ImageBuffer>(zipPath, cacheFilePath); //throw FileError
 }
 
 
@@ -325,6 +537,10 @@ void zen::imageResourcesCleanup()
 {
     assert(runningOnMainThread()); //wxWidgets is not thread-safe!
     assert(globalImageBuffer);
+    if (globalImageBuffer)
+        try { globalImageBuffer->saveCache(); /*throw FileError*/ }
+        catch (FileError&) {} //it's just a cache
+
     globalImageBuffer.reset();
 }
 
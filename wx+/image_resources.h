@@ -13,8 +13,8 @@
 
 namespace zen
 {
-//pass resources .zip file at application startup
-void imageResourcesInit(const Zstring& zipPath); //throw FileError
+//pass resources .zip file at application startup; images are decoded (and DPI-scaled) on first access
+void imageResourcesInit(const Zstring& zipPath, const Zstring& cacheFilePath /*optional: persist xBRZ-scaled images*/ = Zstring()); //throw FileError
 void imageResourcesCleanup();
 
 const wxImage& loadImage(const std::string& name, int maxWidth /*optional*/, int maxHeight /*optional*/);
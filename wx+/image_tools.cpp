@@ -94,18 +94,31 @@ void copyImageLayover(const wxImage& src,
         for (int x = 0; x < srcWidth; ++x)
         {
             const int w1 = *srcAlpha; //alpha-composition interpreted as weighted average
-            const int w2 = numeric::intDivRound(*trgAlpha * (255 - w1), 255);
-            const int wSum = w1 + w2;
 
-            auto calcColor = [w1, w2, wSum](unsigned char colsrc, unsigned char colTrg)
+            if (w1 == 0) //fast paths: icons are mostly fully transparent or opaque pixels
+                ; //keep target pixel
+            else if (w1 == 255 || *trgAlpha == 0)
             {
-                return static_cast<unsigned char>(wSum == 0 ? 0 : numeric::intDivRound(colsrc * w1 + colTrg * w2, wSum));
-            };
-            trgRgb[0] = calcColor(srcRgb[0], trgRgb[0]);
-            trgRgb[1] = calcColor(srcRgb[1], trgRgb[1]);
-            trgRgb[2] = calcColor(srcRgb[2], trgRgb[2]);
+                trgRgb[0] = srcRgb[0];
+                trgRgb[1] = srcRgb[1];
+                trgRgb[2] = srcRgb[2];
+                *trgAlpha = static_cast<unsigned char>(w1);
+            }
+            else
+            {
+                const int w2 = numeric::intDivRound(*trgAlpha * (255 - w1), 255);
+                const int wSum = w1 + w2;
 
-            *trgAlpha = static_cast<unsigned char>(wSum);
+                auto calcColor = [w1, w2, wSum](unsigned char colsrc, unsigned char colTrg)
+                {
+                    return static_cast<unsigned char>(wSum == 0 ? 0 : numeric::intDivRound(colsrc * w1 + colTrg * w2, wSum));
+                };
+                trgRgb[0] = calcColor(srcRgb[0], trgRgb[0]);
+                trgRgb[1] = calcColor(srcRgb[1], trgRgb[1]);
+                trgRgb[2] = calcColor(srcRgb[2], trgRgb[2]);
+
+                *trgAlpha = static_cast<unsigned char>(wSum);
+            }
 
             srcRgb += 3;
             trgRgb += 3;
@@ -279,6 +292,80 @@ wxImage zen::layOver(const wxImage& back, const wxImage& front, int alignment)
 }
 
 
+//pixel loops below: plain integer arithmetics over contiguous arrays => auto-vectorized by the compiler (-O3)
+wxImage zen::greyScale(const wxImage& img)
+{
+    if (img.HasMask()) //wxImage::ConvertToGreyscale() skips mask color
+    {
+        wxImage output = img.ConvertToGreyscale(1.0 / 3, 1.0 / 3, 1.0 / 3); //treat all channels equally!
+        adjustBrightness(output, 160);
+        return output;
+    }
+
+    wxImage output = img.Copy(); //caveat: wxImage is ref-counted *without* copy on write
+    if (unsigned char* rgb = output.GetData())
+    {
+        const int pixelCount = output.GetWidth() * output.GetHeight();
+        for (int i = 0; i < pixelCount; ++i, rgb += 3)
+            rgb[0] = rgb[1] = rgb[2] = static_cast<unsigned char>((rgb[0] + rgb[1] + rgb[2] + 1) / 3); //= numeric::intDivRound(sum, 3)
+    }
+    adjustBrightness(output, 160);
+    return output;
+}
+
+
+double zen::getAvgBrightness(const wxImage& img)
+{
+    const int pixelCount = img.GetWidth() * img.GetHeight();
+    const unsigned char* rgb = img.GetData();
+
+    if (pixelCount > 0 && rgb)
+    {
+        if (const unsigned char* alpha = img.GetAlpha())
+        {
+            //calculate average weighted by alpha channel
+            uint64_t dividend = 0; //no overflow: 3 * 255 * 255 * pixelCount
+            uint64_t divisor  = 0;
+            for (int i = 0; i < pixelCount; ++i, rgb += 3)
+            {
+                dividend += static_cast<uint32_t>(rgb[0] + rgb[1] + rgb[2]) * alpha[i];
+                divisor  += alpha[i];
+            }
+            return divisor == 0 ? 0 : static_cast<double>(dividend) / (3.0 * divisor);
+        }
+        else
+        {
+            uint64_t sum = 0;
+            for (int i = 0; i < 3 * pixelCount; ++i)
+                sum += rgb[i];
+            return static_cast<double>(sum) / (3.0 * pixelCount);
+        }
+    }
+    return 0;
+}
+
+
+void zen::brighten(wxImage& img, int level)
+{
+    if (unsigned char* rgb = img.GetData())
+    {
+        unsigned char lookup[256] = {};
+        for (int c = 0; c < 256; ++c)
+            lookup[c] = static_cast<unsigned char>(std::clamp(c + level, 0, 255));
+
+        const int byteCount = 3 * img.GetWidth() * img.GetHeight(); //RGB
+        for (int i = 0; i < byteCount; ++i)
+            rgb[i] = lookup[rgb[i]];
+    }
+}
+
+
+void zen::adjustBrightness(wxImage& img, int targetLevel)
+{
+    brighten(img, targetLevel - getAvgBrightness(img));
+}
+
+
 wxImage zen::resizeCanvas(const wxImage& img, wxSize newSize, int alignment)
 {
     if (newSize == img.GetSize())
@@ -77,15 +77,6 @@ int getDefaultMenuIconSize()
 
 //################################### implementation ###################################
 
-inline
-wxImage greyScale(const wxImage& img)
-{
-    wxImage output = img.ConvertToGreyscale(1.0 / 3, 1.0 / 3, 1.0 / 3); //treat all channels equally!
-    adjustBrightness(output, 160);
-    return output;
-}
-
-
 inline
 wxImage greyScaleIfDisabled(const wxImage& img, bool enabled)
 {
@@ -96,58 +87,6 @@ wxImage greyScaleIfDisabled(const wxImage& img, bool enabled)
 }
 
 
-inline
-double getAvgBrightness(const wxImage& img)
-{
-    const int pixelCount = img.GetWidth() * img.GetHeight();
-    auto pixBegin = img.GetData();
-
-    if (pixelCount > 0 && pixBegin)
-    {
-        auto pixEnd = pixBegin + 3 * pixelCount; //RGB
-
-        if (img.HasAlpha())
-        {
-            const unsigned char* alphaFirst = img.GetAlpha();
-
-            //calculate average weighted by alpha channel
-            double dividend = 0;
-            for (auto it = pixBegin; it != pixEnd; ++it)
-                dividend += *it * static_cast<double>(alphaFirst[(it - pixBegin) / 3]);
-
-            const double divisor = 3.0 * std::accumulate(alphaFirst, alphaFirst + pixelCount, 0.0);
-
-            return numeric::isNull(divisor) ? 0 : dividend / divisor;
-        }
-        else
-            return std::accumulate(pixBegin, pixEnd, 0.0) / (3.0 * pixelCount);
-    }
-    return 0;
-}
-
-
-inline
-void brighten(wxImage& img, int level)
-{
-    if (auto pixBegin = img.GetData())
-    {
-        const int pixelCount = img.GetWidth() * img.GetHeight();
-        auto pixEnd = pixBegin + 3 * pixelCount; //RGB
-        if (level > 0)
-            std::for_each(pixBegin, pixEnd, [&](unsigned char& c) { c = static_cast<unsigned char>(std::min(255, c + level)); });
-        else
-            std::for_each(pixBegin, pixEnd, [&](unsigned char& c) { c = static_cast<unsigned char>(std::max(0, c + level)); });
-    }
-}
-
-
-inline
-void adjustBrightness(wxImage& img, int targetLevel)
-{
-    brighten(img, targetLevel - getAvgBrightness(img));
-}
-
-
 /*
 inline
 wxColor gradient(const wxColor& from, const wxColor& to, double fraction)
@@ -1121,6 +1121,9 @@ struct ColorDistanceUnbufferedARGB
 {
     static double dist(uint32_t pix1, uint32_t pix2, double testAttribute)
     {
+        if (pix1 == pix2) //frequent for icons (uniform and transparent areas) => skip sqrt; same result as below
+            return 0;
+
         const double a1 = getAlpha(pix1) / 255.0 ;
         const double a2 = getAlpha(pix2) / 255.0 ;
 
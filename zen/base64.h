@@ -7,9 +7,18 @@
 #ifndef BASE64_H_08473021856321840873021487213453214
 #define BASE64_H_08473021856321840873021487213453214
 
+#include <cassert>
 #include <iterator>
+#include <string>
+#include <string_view>
 #include "type_traits.h"
 
+#if defined __x86_64__ || defined __i386__
+    #include <tmmintrin.h> //SSSE3
+#elif defined __aarch64__
+    #include <arm_neon.h>
+#endif
+
 
 namespace zen
 {
@@ -19,7 +28,9 @@ namespace zen
         const std::string input = "Sample text";
         std::string output;
         zen::encodeBase64(input.begin(), input.end(), std::back_inserter(output));
-        //output contains "U2FtcGxlIHRleHQ="                                       */
+        //output contains "U2FtcGxlIHRleHQ="
+
+    contiguous buffers: prefer stringEncodeBase64()/stringDecodeBase64() => SIMD fast path (SSSE3, NEON)   */
 
 template <class InputIterator, class OutputIterator>
 OutputIterator encodeBase64(InputIterator first, InputIterator last, OutputIterator result); //nothrow!
@@ -27,8 +38,8 @@ OutputIterator encodeBase64(InputIterator first, InputIterator last, OutputItera
 template <class InputIterator, class OutputIterator>
 OutputIterator decodeBase64(InputIterator first, InputIterator last, OutputIterator result); //nothrow!
 
-std::string stringEncodeBase64(const std::string& str);
-std::string stringDecodeBase64(const std::string& str);
+std::string stringEncodeBase64(std::string_view str);
+std::string stringDecodeBase64(std::string_view str);
 
 
 
@@ -154,20 +165,193 @@ OutputIterator decodeBase64(InputIterator first, InputIterator last, OutputItera
 }
 
 
+namespace impl
+{
+/*  SIMD: 6-bit index <-> char mapping without table loads
+    https://arxiv.org/abs/1704.00605 (Mula, Lemire: Faster Base64 Encoding and Decoding Using AVX2 Instructions)
+
+    return number of input bytes processed: multiple of 3 (encode) or 4 (decode); remainder is left to the scalar iterator version
+    decode: stops before the first block containing padding or any char to skip (e.g. line breaks) */
+#if defined __x86_64__ || defined __i386__
+__attribute__((target("ssse3")))
+inline size_t encodeBase64Ssse3(const unsigned char* src, size_t len, char* trg)
+{
+    const unsigned char* const srcBegin = src;
+
+    for (; len >= 16; len -= 12, src += 12, trg += 16) //loads 16 bytes, consumes 12
+    {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+
+        //split 3 bytes into 4 x 6 bits per 32-bit lane
+        const __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+        const __m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+        const __m128i indices = _mm_or_si128(t0, t1);
+
+        //add offset of the char range: A-Z, a-z, 0-9, +, /
+        __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+
+        const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                              '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(trg), _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices));
+    }
+    return src - srcBegin;
+}
+
+
+__attribute__((target("ssse3")))
+inline size_t decodeBase64Ssse3(const char* src, size_t len, unsigned char* trg) //trg: 4 bytes slack
+{
+    const char* const srcBegin = src;
+
+    for (; len >= 16; len -= 16, src += 16, trg += 12)
+    {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        const __m128i hiNibble = _mm_and_si128(_mm_srli_epi32(in, 4), _mm_set1_epi8(0x0f));
+        const __m128i loNibble = _mm_and_si128(in, _mm_set1_epi8(0x0f));
+
+        //valid chars have no bit in common between both lookups
+        const __m128i lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+        const __m128i lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m128i invalid = _mm_and_si128(_mm_shuffle_epi8(lutLo, loNibble), _mm_shuffle_epi8(lutHi, hiNibble));
+        if (_mm_movemask_epi8(_mm_cmpgt_epi8(invalid, _mm_setzero_si128())) != 0)
+            break;
+
+        const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(_mm_cmpeq_epi8(in, _mm_set1_epi8('/')), hiNibble));
+        const __m128i indices = _mm_add_epi8(in, roll);
+
+        //merge 4 x 6 bits into 3 bytes per 32-bit lane
+        const __m128i mergedAbBc = _mm_maddubs_epi16(indices, _mm_set1_epi32(0x01400140));
+        const __m128i merged     = _mm_madd_epi16(mergedAbBc, _mm_set1_epi32(0x00011000));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(trg), _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)));
+    }
+    return src - srcBegin;
+}
+
+
+inline bool cpuSupportsSsse3()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3");
+}
+
+#elif defined __aarch64__
+inline uint8x16x4_t getBase64EncodingNeon()
+{
+    return {{vld1q_u8(reinterpret_cast<const uint8_t*>(ENCODING_MIME)),      vld1q_u8(reinterpret_cast<const uint8_t*>(ENCODING_MIME) + 16),
+             vld1q_u8(reinterpret_cast<const uint8_t*>(ENCODING_MIME) + 32), vld1q_u8(reinterpret_cast<const uint8_t*>(ENCODING_MIME) + 48)}};
+}
+
+
+inline size_t encodeBase64Neon(const unsigned char* src, size_t len, char* trg)
+{
+    const unsigned char* const srcBegin = src;
+    const uint8x16x4_t lut = getBase64EncodingNeon();
+
+    for (; len >= 48; len -= 48, src += 48, trg += 64)
+    {
+        const uint8x16x3_t in = vld3q_u8(src); //de-interleave a, b, c
+        uint8x16x4_t out;
+        out.val[0] = vshrq_n_u8(in.val[0], 2);
+        out.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[0], 4), vshrq_n_u8(in.val[1], 4)), vdupq_n_u8(0x3f));
+        out.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(in.val[1], 2), vshrq_n_u8(in.val[2], 6)), vdupq_n_u8(0x3f));
+        out.val[3] = vandq_u8(in.val[2], vdupq_n_u8(0x3f));
+
+        for (uint8x16_t& v : out.val)
+            v = vqtbl4q_u8(lut, v);
+
+        vst4q_u8(reinterpret_cast<uint8_t*>(trg), out);
+    }
+    return src - srcBegin;
+}
+
+
+inline size_t decodeBase64Neon(const char* src, size_t len, unsigned char* trg)
+{
+    const char* const srcBegin = src;
+
+    static_assert(arraySize(DECODING_MIME) == 128);
+    const uint8_t* decoding = reinterpret_cast<const uint8_t*>(DECODING_MIME);
+    const uint8x16x4_t lutLo = {{vld1q_u8(decoding),      vld1q_u8(decoding + 16), vld1q_u8(decoding + 32), vld1q_u8(decoding + 48)}};
+    const uint8x16x4_t lutHi = {{vld1q_u8(decoding + 64), vld1q_u8(decoding + 80), vld1q_u8(decoding + 96), vld1q_u8(decoding + 112)}};
+
+    for (; len >= 64; len -= 64, src += 64, trg += 48)
+    {
+        uint8x16x4_t in = vld4q_u8(reinterpret_cast<const uint8_t*>(src)); //de-interleave 4 chars per quad
+
+        uint8x16_t invalid = vdupq_n_u8(0);
+        for (uint8x16_t& v : in.val)
+        {
+            //chars >= 128: out of range for both tables => 0, but flagged by "v >> 1"
+            const uint8x16_t index = vqtbx4q_u8(vqtbl4q_u8(lutLo, v), lutHi, vsubq_u8(v, vdupq_n_u8(64)));
+            invalid = vorrq_u8(invalid, vorrq_u8(index, vshrq_n_u8(v, 1))); //-1 (unknown char) and 64 (padding): >= 64
+            v = index;
+        }
+        if (vmaxvq_u8(invalid) >= 64)
+            break;
+
+        uint8x16x3_t out;
+        out.val[0] = vorrq_u8(vshlq_n_u8(in.val[0], 2), vshrq_n_u8(in.val[1], 4));
+        out.val[1] = vorrq_u8(vshlq_n_u8(in.val[1], 4), vshrq_n_u8(in.val[2], 2));
+        out.val[2] = vorrq_u8(vshlq_n_u8(in.val[2], 6),            in.val[3]);
+        vst3q_u8(trg, out);
+    }
+    return src - srcBegin;
+}
+#endif
+
+
+inline size_t encodeBase64Simd(const unsigned char* src, size_t len, char* trg)
+{
+#if defined __x86_64__ || defined __i386__
+    static const bool haveSsse3 = cpuSupportsSsse3(); //evaluate once
+    return haveSsse3 ? encodeBase64Ssse3(src, len, trg) : 0;
+#elif defined __aarch64__
+    return encodeBase64Neon(src, len, trg);
+#else
+    return 0;
+#endif
+}
+
+
+inline size_t decodeBase64Simd(const char* src, size_t len, unsigned char* trg) //trg: 4 bytes slack
+{
+#if defined __x86_64__ || defined __i386__
+    static const bool haveSsse3 = cpuSupportsSsse3(); //evaluate once
+    return haveSsse3 ? decodeBase64Ssse3(src, len, trg) : 0;
+#elif defined __aarch64__
+    return decodeBase64Neon(src, len, trg);
+#else
+    return 0;
+#endif
+}
+}
+
+
 inline
-std::string stringEncodeBase64(const std::string& str)
+std::string stringEncodeBase64(std::string_view str)
 {
-    std::string out;
-    encodeBase64(str.begin(), str.end(), std::back_inserter(out));
+    std::string out((str.size() + 2) / 3 * 4, '\0');
+
+    const size_t bytesDone = impl::encodeBase64Simd(reinterpret_cast<const unsigned char*>(str.data()), str.size(), out.data());
+
+    [[maybe_unused]] char* const outEnd = encodeBase64(str.begin() + bytesDone, str.end(), out.data() + bytesDone / 3 * 4);
+    assert(outEnd == out.data() + out.size());
     return out;
 }
 
 
 inline
-std::string stringDecodeBase64(const std::string& str)
+std::string stringDecodeBase64(std::string_view str)
 {
-    std::string out;
-    decodeBase64(str.begin(), str.end(), std::back_inserter(out));
+    std::string out(str.size() / 4 * 3 + 3 /*no padding*/ + 4 /*SIMD slack*/, '\0');
+
+    const size_t charsDone = impl::decodeBase64Simd(str.data(), str.size(), reinterpret_cast<unsigned char*>(out.data()));
+
+    char* const outEnd = decodeBase64(str.begin() + charsDone, str.end(), out.data() + charsDone / 4 * 3);
+    out.resize(outEnd - out.data());
     return out;
 }
 }
@@ -12,10 +12,12 @@
 
     #include <map>
     #include <sys/inotify.h>
-    #include <fcntl.h> //fcntl
+    #include <sys/fanotify.h>
+    #include <fcntl.h> //fcntl, open_by_handle_at
     #include <unistd.h> //close
     #include <limits.h> //NAME_MAX
     #include "file_traverser.h"
+    #include "symlink_target.h"
 
 
 using namespace zen;
@@ -25,6 +27,11 @@ struct DirWatcher::Impl
 {
     int notifDescr = 0;
     std::map<int, Zstring> watchedPaths; //watch descriptor and (sub-)directory paths -> owned by "notifDescr"
+
+    //fanotify: a single filesystem-wide mark instead of one inotify watch per subdirectory
+    bool fanotify = false;
+    int mountDescr = -1;         //any directory on the watched file system: reference for open_by_handle_at()
+    Zstring baseDirPathResolved; //event paths are reported with symlinks resolved
 };
 
 
@@ -32,6 +39,50 @@ DirWatcher::DirWatcher(const Zstring& dirPath) : //throw FileError
     baseDirPath_(dirPath),
     pimpl_(std::make_unique<Impl>())
 {
+    /*  fanotify with FAN_REPORT_DFID_NAME (Linux 5.9): events carry the parent directory's file handle + item name
+        - FAN_MARK_FILESYSTEM: new subdirectories are covered automatically => no traversal, no max_user_watches limit
+        - requires CAP_SYS_ADMIN (mark) and CAP_DAC_READ_SEARCH (open_by_handle_at) => fall back to inotify if not available
+        - watches the whole file system => filter events by path                                                          */
+    const bool fanotifyAvailable = [&]
+    {
+        try
+        {
+            pimpl_->baseDirPathResolved = getSymlinkResolvedPath(baseDirPath_); //throw FileError
+        }
+        catch (FileError&) { return false; }
+
+        const int notifDescr = ::fanotify_init(FAN_CLASS_NOTIF | FAN_REPORT_DFID_NAME | FAN_CLOEXEC | FAN_NONBLOCK, O_RDONLY | O_LARGEFILE);
+        if (notifDescr == -1) //EPERM: not privileged, EINVAL: kernel too old
+            return false;
+        auto guardNotif = makeGuard<ScopeGuardRunMode::onExit>([&] { ::close(notifDescr); });
+
+        const int mountDescr = ::open(pimpl_->baseDirPathResolved.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (mountDescr == -1)
+            return false;
+        auto guardMount = makeGuard<ScopeGuardRunMode::onExit>([&] { ::close(mountDescr); });
+
+        if (::fanotify_mark(notifDescr, FAN_MARK_ADD | FAN_MARK_FILESYSTEM,
+                            FAN_CREATE      |
+                            FAN_MODIFY      |
+                            FAN_CLOSE_WRITE |
+                            FAN_DELETE      |
+                            FAN_MOVED_FROM  |
+                            FAN_MOVED_TO    |
+                            FAN_ONDIR, //also report directory entries of subdirectories
+                            AT_FDCWD, pimpl_->baseDirPathResolved.c_str()) != 0)
+            return false;
+
+        guardNotif.dismiss();
+        guardMount.dismiss();
+
+        pimpl_->notifDescr = notifDescr;
+        pimpl_->mountDescr = mountDescr;
+        pimpl_->fanotify = true;
+        return true;
+    }();
+    if (fanotifyAvailable)
+        return;
+
     //get all subdirectories
     std::vector<Zstring> fullFolderList {baseDirPath_};
     {
@@ -96,11 +147,28 @@ DirWatcher::DirWatcher(const Zstring& dirPath) : //throw FileError
 DirWatcher::~DirWatcher()
 {
     ::close(pimpl_->notifDescr); //associated watches are removed automatically!
+    if (pimpl_->mountDescr != -1)
+        ::close(pimpl_->mountDescr);
+}
+
+
+bool DirWatcher::watchesNewSubfolders() const
+{
+    return pimpl_->fanotify;
+}
+
+
+int DirWatcher::getNotifyHandle() const
+{
+    return pimpl_->notifDescr;
 }
 
 
 std::vector<DirWatcher::Change> DirWatcher::fetchChanges(const std::function<void()>& requestUiUpdate, std::chrono::milliseconds cbInterval) //throw FileError
 {
+    if (pimpl_->fanotify)
+        return fetchChangesFanotify(); //throw FileError
+
     std::vector<std::byte> buffer(512 * (sizeof(inotify_event) + NAME_MAX + 1));
 
     ssize_t bytesRead = 0;
@@ -126,7 +194,10 @@ std::vector<DirWatcher::Change> DirWatcher::fetchChanges(const std::function<voi
     {
         inotify_event& evt = reinterpret_cast<inotify_event&>(buffer[bytePos]);
 
-        if (evt.len != 0) //exclude case: deletion of "self", already reported by parent directory watch
+        if (evt.mask & IN_Q_OVERFLOW) //events were dropped: we can't tell what changed => report base directory
+            output.push_back({ChangeType::update, baseDirPath_});
+
+        else if (evt.len != 0) //exclude case: deletion of "self", already reported by parent directory watch
         {
             auto it = pimpl_->watchedPaths.find(evt.wd);
             if (it != pimpl_->watchedPaths.end())
@@ -154,3 +225,95 @@ std::vector<DirWatcher::Change> DirWatcher::fetchChanges(const std::function<voi
     return output;
 }
 
+
+
+std::vector<DirWatcher::Change> DirWatcher::fetchChangesFanotify() //throw FileError
+{
+    std::vector<std::byte> buffer(256 * 1024);
+
+    ssize_t bytesRead = 0;
+    do
+    {
+        //non-blocking call, see FAN_NONBLOCK
+        bytesRead = ::read(pimpl_->notifDescr, &buffer[0], buffer.size());
+    }
+    while (bytesRead < 0 && errno == EINTR);
+
+    if (bytesRead < 0)
+    {
+        if (errno == EAGAIN)
+            return std::vector<Change>();
+
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot monitor directory %x."), L"%x", fmtPath(baseDirPath_)), "read");
+    }
+
+    //coalesce: burst of events for the same directory (e.g. file written in chunks) => resolve directory path only once
+    std::map<std::string /*directory file handle*/, std::map<Zstring /*item name*/, ChangeType>> dirChanges;
+    bool overflow = false;
+
+    const fanotify_event_metadata* evt = reinterpret_cast<const fanotify_event_metadata*>(&buffer[0]);
+    for (ssize_t len = bytesRead; FAN_EVENT_OK(evt, len); evt = FAN_EVENT_NEXT(evt, len))
+    {
+        if (evt->vers != FANOTIFY_METADATA_VERSION)
+            throw FileError(replaceCpy(_("Cannot monitor directory %x."), L"%x", fmtPath(baseDirPath_)), formatSystemError("read", L"", L"Unexpected fanotify metadata version."));
+
+        if (evt->mask & FAN_Q_OVERFLOW) //events were dropped: we can't tell what changed => report base directory
+        {
+            overflow = true;
+            continue;
+        }
+
+        const auto& info = *reinterpret_cast<const fanotify_event_info_fid*>(evt + 1);
+        if (evt->event_len < sizeof(fanotify_event_metadata) + sizeof(fanotify_event_info_fid) ||
+            info.hdr.info_type != FAN_EVENT_INFO_TYPE_DFID_NAME)
+            continue;
+
+        const auto& fileHandle = *reinterpret_cast<const file_handle*>(info.handle);
+        const char* itemName = reinterpret_cast<const char*>(fileHandle.f_handle + fileHandle.handle_bytes);
+        if (itemName[0] == 0 || (itemName[0] == '.' && itemName[1] == 0)) //event on the directory itself: already reported by parent
+            continue;
+
+        const ChangeType changeType = evt->mask & (FAN_CREATE | FAN_MOVED_TO)  ? ChangeType::create :
+                                      evt->mask & (FAN_DELETE | FAN_MOVED_FROM) ? ChangeType::remove : ChangeType::update;
+
+        const std::string handleKey(reinterpret_cast<const char*>(&fileHandle), sizeof(file_handle) + fileHandle.handle_bytes);
+
+        auto [it, inserted] = dirChanges[handleKey].emplace(itemName, changeType);
+        if (!inserted && changeType != ChangeType::update) //update is the least informative
+            it->second = changeType;
+    }
+
+    std::vector<Change> output;
+    if (overflow)
+        output.push_back({ChangeType::update, baseDirPath_});
+
+    for (const auto& [handleKey, itemChanges] : dirChanges)
+    {
+        std::string handleBuf = handleKey; //open_by_handle_at() takes non-const
+        const int dirDescr = ::open_by_handle_at(pimpl_->mountDescr, reinterpret_cast<file_handle*>(&handleBuf[0]), O_PATH | O_CLOEXEC);
+        if (dirDescr == -1) //ESTALE: directory was deleted meanwhile => removal is reported for its parent
+            continue;
+        ZEN_ON_SCOPE_EXIT(::close(dirDescr));
+
+        Zstring dirPath;
+        try
+        {
+            dirPath = getSymlinkRawContent("/proc/self/fd/" + numberTo<Zstring>(dirDescr)).targetPath; //throw FileError
+        }
+        catch (FileError&) { continue; }
+
+        //return paths relative to the base directory as passed by caller:
+        if (equalNativePath(dirPath, pimpl_->baseDirPathResolved))
+            dirPath = baseDirPath_;
+        else if (const Zstring& basePrefix = appendSeparator(pimpl_->baseDirPathResolved);
+                 startsWith(dirPath, basePrefix))
+            dirPath = appendSeparator(baseDirPath_) + Zstring(dirPath.begin() + basePrefix.size(), dirPath.end());
+        else //file system-wide mark: not our business
+            continue;
+
+        for (const auto& [itemName, changeType] : itemChanges)
+            output.push_back({changeType, appendSeparator(dirPath) + itemName});
+    }
+
+    return output;
+}
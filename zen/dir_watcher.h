@@ -18,6 +18,7 @@ namespace zen
 {
 //Windows: ReadDirectoryChangesW https://docs.microsoft.com/en-us/windows/win32/api/winbase/nf-winbase-readdirectorychangesw
 //Linux:   inotify               https://linux.die.net/man/7/inotify
+//         fanotify (if permitted) https://man7.org/linux/man-pages/man7/fanotify.7.html
 //macOS:   kqueue                https://developer.apple.com/library/mac/documentation/Darwin/Reference/ManPages/man2/kqueue.2.html
 
 //watch directory including subdirectories
@@ -29,7 +30,7 @@ namespace zen
              Renaming of top watched directory handled incorrectly: Not notified(!) + additional changes in subfolders
              now do report FILE_ACTION_MODIFIED for directory (check that should prevent this fails!)
 
-    Linux: newly added subdirectories are reported but not automatically added for watching! -> reset Dirwatcher!
+    Linux: newly added subdirectories are reported but not automatically added for watching! -> reset Dirwatcher! (inotify only, see watchesNewSubfolders())
            removal of base directory is NOT notified!
 
     macOS: everything works as expected; renaming of base directory is also detected
@@ -59,10 +60,18 @@ public:
     //extract accumulated changes since last call
     std::vector<Change> fetchChanges(const std::function<void()>& requestUiUpdate, std::chrono::milliseconds cbInterval); //throw FileError
 
+    //true: fanotify => no need to reset DirWatcher after subdirectories were added
+    bool watchesNewSubfolders() const;
+
+    //file descriptor that becomes readable when there are changes to fetch: e.g. wait for it in the UI event loop instead of polling
+    int getNotifyHandle() const;
+
 private:
     DirWatcher           (const DirWatcher&) = delete;
     DirWatcher& operator=(const DirWatcher&) = delete;
 
+    std::vector<Change> fetchChangesFanotify(); //throw FileError
+
     const Zstring baseDirPath_;
 
     struct Impl;
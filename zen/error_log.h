@@ -8,10 +8,14 @@
 #define ERROR_LOG_H_8917590832147915
 
 #include <cassert>
+#include <cstdio>
+#include <mutex>
+#include <optional>
 #include <vector>
 #include "time.h"
 #include "i18n.h"
 #include "utf.h"
+#include "serialize.h"
 #include "zstring.h"
 
 
@@ -34,6 +38,11 @@ struct LogEntry
 std::string formatMessage(const LogEntry& entry);
 
 
+/*  ErrorLog: keep memory consumption bounded even for millions of log entries (e.g. a failing job ignoring errors)
+    - severity counters and per-severity indices are updated incrementally => getStats(), getEntryRefs() don't need to scan the log
+    - only the latest ENTRIES_IN_MEMORY_MAX entries are kept in memory, older ones are moved to an anonymous temp file in chunks
+      of SPILL_CHUNK_ENTRIES and loaded on demand (most recently used chunks are buffered)
+    - copies share the (append-only) temp file                                                                                     */
 class ErrorLog
 {
 public:
@@ -47,14 +56,68 @@ public:
     };
     Stats getStats() const;
 
-    //subset of std::vector<> interface:
-    using const_iterator = std::vector<LogEntry>::const_iterator;
-    const_iterator begin() const { return entries_.begin(); }
-    const_iterator end  () const { return entries_.end  (); }
-    bool           empty() const { return entries_.empty(); }
+    size_t size() const { return spillChunks_.size() * SPILL_CHUNK_ENTRIES + entries_.size(); }
+    bool  empty() const { return size() == 0; }
+
+    LogEntry getEntry(size_t pos) const; //pos < size()
+
+    size_t getMemoryUsage() const; //estimate (bytes): in-memory entries + indices, excluding spilled entries
+
+    struct EntryRef
+    {
+        size_t pos = 0;       //=> getEntry()
+        size_t lineCount = 0; //number of non-empty lines of LogEntry::message
+    };
+    //entries with (type & types) != 0 in log order; no need to load spilled entries
+    std::vector<EntryRef> getEntryRefs(int types /*MSG_TYPE_INFO | MSG_TYPE_WARNING, etc.*/, size_t countMax = std::numeric_limits<size_t>::max()) const;
+
+    //forward iterator: dereferences by value (entries may be loaded from disk); intended for range-based for loops
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = LogEntry;
+        using difference_type   = ptrdiff_t;
+        using pointer           = void;
+        using reference         = LogEntry;
+
+        const_iterator(const ErrorLog& log, size_t pos) : log_(&log), pos_(pos) {}
+
+        LogEntry operator*() const { return log_->getEntry(pos_); }
+        const_iterator& operator++() { ++pos_; return *this; }
+        const_iterator  operator++(int) { const_iterator tmp(*this); ++pos_; return tmp; }
+        bool operator==(const const_iterator&) const = default;
+
+    private:
+        const ErrorLog* log_;
+        size_t pos_;
+    };
+    const_iterator begin() const { return {*this, 0}; }
+    const_iterator end  () const { return {*this, size()}; }
 
 private:
-    std::vector<LogEntry> entries_;
+    static constexpr size_t ENTRIES_IN_MEMORY_MAX = 100'000;
+    static constexpr size_t SPILL_CHUNK_ENTRIES   =  10'000;
+    static constexpr size_t SPILL_CHUNK_BUFFER_MAX = 4;
+
+    class SpillFile;
+
+    struct SpillChunk
+    {
+        uint64_t offset    = 0;
+        size_t   byteCount = 0;
+    };
+
+    static int getTypeIdx(MessageType type);
+    static size_t getLineCount(const Zstringc& message);
+    void spillOldestEntries();
+
+    std::vector<LogEntry> entries_; //in-memory tail of the log, starting at position spillChunks_.size() * SPILL_CHUNK_ENTRIES
+    std::vector<SpillChunk> spillChunks_;
+    std::shared_ptr<SpillFile> spillFile_; //shared by copies: chunks are never modified after writing
+    bool spillFailed_ = false; //=> keep everything in memory
+
+    std::vector<EntryRef> entryRefs_[3]; //for each MessageType
 };
 
 
@@ -65,32 +128,223 @@ private:
 
 
 //######################## implementation ##########################
+class ErrorLog::SpillFile
+{
+public:
+    static std::shared_ptr<SpillFile> create() //return nullptr on error
+    {
+        if (std::FILE* handle = std::tmpfile()) //deleted automatically when closed
+            return std::make_shared<SpillFile>(handle);
+        return nullptr;
+    }
+
+    explicit SpillFile(std::FILE* handle) : handle_(handle) {}
+    ~SpillFile() { std::fclose(handle_); }
+
+    std::optional<SpillChunk> append(const std::string& byteStream)
+    {
+        std::lock_guard dummy(lockFile_);
+
+        if (std::fseek(handle_, 0, SEEK_END) != 0 ||
+            std::fwrite(byteStream.data(), 1, byteStream.size(), handle_) != byteStream.size() ||
+            std::fflush(handle_) != 0)
+            return std::nullopt;
+
+        const SpillChunk chunk{fileSize_, byteStream.size()};
+        fileSize_ += byteStream.size();
+        return chunk;
+    }
+
+    std::shared_ptr<const std::vector<LogEntry>> getChunk(const SpillChunk& chunk)
+    {
+        std::lock_guard dummy(lockFile_);
+
+        if (auto it = std::find_if(chunkBuf_.begin(), chunkBuf_.end(), [&](const auto& item) { return item.first == chunk.offset; });
+            it != chunkBuf_.end())
+        {
+            std::rotate(chunkBuf_.begin(), it, it + 1); //move to front: most recently used
+            return chunkBuf_.front().second;
+        }
+
+        auto entries = std::make_shared<std::vector<LogEntry>>();
+        try
+        {
+            std::string byteStream(chunk.byteCount, '\0');
+            if (std::fseek(handle_, static_cast<long>(chunk.offset), SEEK_SET) != 0 ||
+                std::fread(byteStream.data(), 1, byteStream.size(), handle_) != byteStream.size())
+                throw SysError(L"Failed to read log entries from temporary file.");
+
+            MemoryStreamIn streamIn(byteStream);
+            for (size_t i = 0; i < SPILL_CHUNK_ENTRIES; ++i)
+            {
+                LogEntry& entry = entries->emplace_back();
+                entry.time    = readNumber<int64_t>(streamIn);          //
+                entry.type    = readNumber<MessageType>(streamIn);      //throw SysErrorUnexpectedEos
+                entry.message = readContainer<Zstringc>(streamIn);      //
+            }
+        }
+        catch (const SysError& e) //not expected for a temp file we wrote ourselves, but don't lose position info
+        {
+            assert(false);
+            entries->resize(SPILL_CHUNK_ENTRIES, {0, MSG_TYPE_ERROR, utfTo<Zstringc>(e.toString())});
+        }
+
+        chunkBuf_.emplace(chunkBuf_.begin(), chunk.offset, entries);
+        if (chunkBuf_.size() > SPILL_CHUNK_BUFFER_MAX)
+            chunkBuf_.pop_back();
+        return entries;
+    }
+
+private:
+    SpillFile           (const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    std::mutex lockFile_; //the same ErrorLog may be read from different threads, e.g. log panel and saveLogFile()
+    std::FILE* const handle_;
+    uint64_t fileSize_ = 0;
+    std::vector<std::pair<uint64_t /*offset*/, std::shared_ptr<const std::vector<LogEntry>>>> chunkBuf_; //most recently used first
+};
+
+
+inline
+int ErrorLog::getTypeIdx(MessageType type)
+{
+    switch (type)
+    {
+        case MSG_TYPE_INFO:
+            return 0;
+        case MSG_TYPE_WARNING:
+            return 1;
+        case MSG_TYPE_ERROR:
+            return 2;
+    }
+    assert(false);
+    return 2;
+}
+
+
+inline
+size_t ErrorLog::getLineCount(const Zstringc& message)
+{
+    size_t lineCount = 0;
+    bool lastCharNewline = true;
+    for (const char c : message)
+        if (c == '\n')
+            lastCharNewline = true;
+        else
+        {
+            if (lastCharNewline) //do not count empty lines!
+                ++lineCount;
+            lastCharNewline = false;
+        }
+    return lineCount;
+}
+
+
 inline
 void ErrorLog::logMsg(const std::wstring& msg, MessageType type)
 {
     entries_.push_back({std::time(nullptr), type, utfTo<Zstringc>(msg)});
-}
 
+    entryRefs_[getTypeIdx(type)].push_back({size() - 1, getLineCount(entries_.back().message)});
+
+    if (entries_.size() > ENTRIES_IN_MEMORY_MAX && !spillFailed_)
+        spillOldestEntries();
+}
 
 
 inline
-ErrorLog::Stats ErrorLog::getStats() const
+void ErrorLog::spillOldestEntries()
 {
-    Stats count;
-    for (const LogEntry& entry : entries_)
-        switch (entry.type)
+    if (!spillFile_)
+        spillFile_ = SpillFile::create();
+
+    if (spillFile_)
+    {
+        MemoryStreamOut<std::string> streamOut;
+        std::for_each(entries_.begin(), entries_.begin() + SPILL_CHUNK_ENTRIES, [&](const LogEntry& entry)
         {
-            case MSG_TYPE_INFO:
-                ++count.info;
-                break;
-            case MSG_TYPE_WARNING:
-                ++count.warning;
-                break;
-            case MSG_TYPE_ERROR:
-                ++count.error;
-                break;
+            writeNumber<int64_t>(streamOut, entry.time);
+            writeNumber<MessageType>(streamOut, entry.type);
+            writeContainer(streamOut, entry.message);
+        });
+
+        if (const std::optional<SpillChunk> chunk = spillFile_->append(streamOut.ref()))
+        {
+            spillChunks_.push_back(*chunk);
+            entries_.erase(entries_.begin(), entries_.begin() + SPILL_CHUNK_ENTRIES);
+            return;
         }
-    assert(std::ssize(entries_) == count.info + count.warning + count.error);
+    }
+    spillFailed_ = true; //e.g. no temp file available: better than failing to log
+}
+
+
+inline
+LogEntry ErrorLog::getEntry(size_t pos) const
+{
+    assert(pos < size());
+    const size_t spilledCount = spillChunks_.size() * SPILL_CHUNK_ENTRIES;
+    if (pos >= spilledCount)
+        return entries_[pos - spilledCount];
+
+    return (*spillFile_->getChunk(spillChunks_[pos / SPILL_CHUNK_ENTRIES]))[pos % SPILL_CHUNK_ENTRIES];
+}
+
+
+inline
+size_t ErrorLog::getMemoryUsage() const
+{
+    size_t bytes = entries_.capacity() * sizeof(LogEntry) + spillChunks_.capacity() * sizeof(SpillChunk);
+    for (const LogEntry& entry : entries_)
+        bytes += getHeapSize(entry.message);
+    for (const std::vector<EntryRef>& refs : entryRefs_)
+        bytes += refs.capacity() * sizeof(EntryRef);
+    return bytes;
+}
+
+
+inline
+std::vector<ErrorLog::EntryRef> ErrorLog::getEntryRefs(int types, size_t countMax) const
+{
+    std::vector<const std::vector<EntryRef>*> refLists;
+    for (const MessageType type : {MSG_TYPE_INFO, MSG_TYPE_WARNING, MSG_TYPE_ERROR})
+        if (type & types)
+            refLists.push_back(&entryRefs_[getTypeIdx(type)]);
+
+    size_t refsTotal = 0;
+    for (const std::vector<EntryRef>* refs : refLists)
+        refsTotal += refs->size();
+
+    //merge sorted lists
+    std::vector<EntryRef> output;
+    output.reserve(std::min(refsTotal, countMax));
+
+    std::vector<size_t> listPos(refLists.size());
+    while (output.size() < std::min(refsTotal, countMax))
+    {
+        size_t nextList = 0;
+        for (size_t i = 1; i < refLists.size(); ++i)
+            if (listPos[nextList] == refLists[nextList]->size() ||
+                (listPos[i] < refLists[i]->size() && (*refLists[i])[listPos[i]].pos < (*refLists[nextList])[listPos[nextList]].pos))
+                nextList = i;
+
+        output.push_back((*refLists[nextList])[listPos[nextList]++]);
+    }
+    return output;
+}
+
+
+inline
+ErrorLog::Stats ErrorLog::getStats() const
+{
+    const Stats count
+    {
+        static_cast<int>(entryRefs_[getTypeIdx(MSG_TYPE_INFO   )].size()),
+        static_cast<int>(entryRefs_[getTypeIdx(MSG_TYPE_WARNING)].size()),
+        static_cast<int>(entryRefs_[getTypeIdx(MSG_TYPE_ERROR  )].size()),
+    };
+    assert(static_cast<int>(size()) == count.info + count.warning + count.error);
     return count;
 }
 
@@ -9,12 +9,15 @@
 #include <algorithm>
 #include <stdexcept>
 #include <chrono>
+#include <atomic>
+#include <mutex>
 #include "file_traverser.h"
 #include "scope_guard.h"
 #include "symlink_target.h"
 #include "file_io.h"
 #include "crc.h"
 #include "guid.h"
+#include "mem_compare.h"
 
     #include <sys/vfs.h> //statfs
     //#include <sys/time.h> //lutimes
@@ -25,6 +28,12 @@
 
     #include <fcntl.h> //open, close, AT_SYMLINK_NOFOLLOW, UTIME_OMIT
     #include <sys/stat.h>
+    #include <dirent.h> //fdopendir
+    #include <sys/ioctl.h> //ioctl
+    #include <linux/fs.h>  //FICLONE
+    #include <linux/fiemap.h> //FS_IOC_FIEMAP
+    #include <sys/sysmacros.h> //major, minor
+    #include <linux/magic.h> //*_SUPER_MAGIC
 
 using namespace zen;
 
@@ -136,6 +145,132 @@ uint64_t zen::getFileSize(const Zstring& filePath) //throw FileError
 }
 
 
+namespace
+{
+std::atomic<RotationalMode> globalRotationalMode{RotationalMode::autoDetect};
+}
+
+void zen::setRotationalMode(RotationalMode mode) { globalRotationalMode = mode; }
+RotationalMode zen::getRotationalMode() { return globalRotationalMode; }
+
+
+bool zen::isRotationalDevice(const Zstring& path) //noexcept
+{
+    switch (getRotationalMode())
+    {
+        case RotationalMode::always:
+            return true;
+        case RotationalMode::never:
+            return false;
+        case RotationalMode::autoDetect:
+            break;
+    }
+
+    struct stat itemInfo = {};
+    if (::stat(path.c_str(), &itemInfo) != 0)
+        return false;
+
+    static std::mutex lockCache;
+    static std::map<dev_t, bool> rotationalByDevice; //sysfs reads are cheap, but not free: traverser asks once per base folder, sync once per batch
+    {
+        std::lock_guard dummy(lockCache);
+        if (auto it = rotationalByDevice.find(itemInfo.st_dev);
+            it != rotationalByDevice.end())
+            return it->second;
+    }
+
+    //e.g. /sys/dev/block/8:1 -> ../../devices/pci0000:00/.../block/sda/sda1
+    const std::string devLinkPath = "/sys/dev/block/" + numberTo<std::string>(major(itemInfo.st_dev)) + ':' + numberTo<std::string>(minor(itemInfo.st_dev));
+
+    auto readFlag = [](const std::string& flagPath) -> std::optional<bool>
+    {
+        const int fd = ::open(flagPath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+            return std::nullopt;
+        ZEN_ON_SCOPE_EXIT(::close(fd));
+
+        char buf[8] = {};
+        if (::read(fd, buf, sizeof(buf) - 1) <= 0)
+            return std::nullopt;
+        return buf[0] == '1';
+    };
+
+    std::optional<bool> rotational = readFlag(devLinkPath + "/queue/rotational"); //whole disk, device mapper, md
+    if (!rotational)
+        rotational = readFlag(devLinkPath + "/../queue/rotational"); //partition: ".." after resolving the symlink is the disk
+
+    std::lock_guard dummy(lockCache);
+    return rotationalByDevice[itemInfo.st_dev] = rotational && *rotational; //not a block device (e.g. network share, Btrfs): false
+}
+
+
+std::string zen::getPhysicalDeviceId(const Zstring& path) //noexcept
+{
+    struct stat itemInfo = {};
+    if (::stat(path.c_str(), &itemInfo) != 0)
+        return {};
+
+    static std::mutex lockCache;
+    static std::map<dev_t, std::string> idByDevice;
+    {
+        std::lock_guard dummy(lockCache);
+        if (auto it = idByDevice.find(itemInfo.st_dev);
+            it != idByDevice.end())
+            return it->second;
+    }
+
+    const std::string devNo = numberTo<std::string>(major(itemInfo.st_dev)) + ':' + numberTo<std::string>(minor(itemInfo.st_dev));
+
+    std::string deviceId = "dev:" + devNo; //not a block device: one "physical device" per file system
+    //e.g. /sys/dev/block/8:1 -> ../../devices/pci0000:00/.../block/sda/sda1
+    if (char* devPath = ::realpath(("/sys/dev/block/" + devNo).c_str(), nullptr))
+    {
+        ZEN_ON_SCOPE_EXIT(::free(devPath));
+        std::string diskPath = devPath;
+
+        if (::access((diskPath + "/partition").c_str(), F_OK) == 0) //partition: parent folder is the disk
+            diskPath = beforeLast(diskPath, '/', IfNotFoundReturn::none);
+
+        deviceId = "block:" + afterLast(diskPath, '/', IfNotFoundReturn::all); //e.g. sda, nvme0n1, md0, dm-0
+    }
+
+    std::lock_guard dummy(lockCache);
+    return idByDevice[itemInfo.st_dev] = deviceId;
+}
+
+
+std::optional<uint64_t> zen::getPhysicalOffset(const Zstring& filePath) //noexcept
+{
+    const int fd = openNoAtime(filePath, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return std::nullopt;
+    ZEN_ON_SCOPE_EXIT(::close(fd));
+
+    alignas(struct fiemap) std::byte buf[sizeof(struct fiemap) + sizeof(struct fiemap_extent)] = {}; //header + a single extent
+    auto& extentMap = *reinterpret_cast<struct fiemap*>(buf);
+    extentMap.fm_start  = 0;
+    extentMap.fm_length = FIEMAP_MAX_OFFSET;
+    extentMap.fm_flags  = 0; //no FIEMAP_FLAG_SYNC: don't force write-back of the source just to find its position
+    extentMap.fm_extent_count = 1;
+
+    if (::ioctl(fd, FS_IOC_FIEMAP, &extentMap) != 0 || //e.g. ENOTTY, EOPNOTSUPP: file system without FIEMAP
+        extentMap.fm_mapped_extents == 0)
+        return std::nullopt;
+
+    return extentMap.fm_extents[0].fe_physical;
+}
+
+
+
+
+int zen::openNoAtime(const Zstring& itemPath, int flags)
+{
+    const int fd = ::open(itemPath.c_str(), flags | O_NOATIME);
+    if (fd != -1 || errno != EPERM) //EPERM: neither owner nor CAP_FOWNER
+        return fd;
+
+    return ::open(itemPath.c_str(), flags);
+}
 
 
 Zstring zen::getTempFolderPath() //throw FileError
@@ -196,40 +331,114 @@ void zen::removeDirectoryPlain(const Zstring& dirPath) //throw FileError
 
 namespace
 {
-void removeDirectoryImpl(const Zstring& folderPath) //throw FileError
+//delete relative to the parent folder's descriptor: no repeated path resolution for each item (slow on network shares)
+//and no risk of following a folder that was replaced by a symlink in the meantime
+void removeDirectoryAt(int parentFd, const Zstring& folderName, const Zstring& folderPath, //throw FileError, X
+                       const std::function<void(const Zstring& itemPath)>& onBeforeFileDeletion /*throw X*/,
+                       const std::function<void(const Zstring& folderPath)>& onBeforeFolderDeletion)
 {
-    std::vector<Zstring> filePaths;
-    std::vector<Zstring> symlinkPaths;
-    std::vector<Zstring> folderPaths;
+    const int folderFd = ::openat(parentFd, folderName.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (folderFd == -1)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot open directory %x."), L"%x", fmtPath(folderPath)), "openat");
+    ZEN_ON_SCOPE_EXIT(::close(folderFd));
 
-    //get all files and directories from current directory (WITHOUT subdirectories!)
-    traverseFolder(folderPath,
-    [&](const    FileInfo& fi) {    filePaths.push_back(fi.fullPath); },
-    [&](const  FolderInfo& fi) {  folderPaths.push_back(fi.fullPath); }, //defer recursion => save stack space and allow deletion of extremely deep hierarchies!
-    [&](const SymlinkInfo& si) { symlinkPaths.push_back(si.fullPath); },
-    [](const std::wstring& errorMsg) { throw FileError(errorMsg); });
+    std::vector<Zstring> itemNames;   //files and symlinks
+    std::vector<Zstring> folderNames; //defer recursion => don't keep more than one directory stream open per level
+    {
+        const int dirFd = ::dup(folderFd); //fdopendir() takes ownership
+        if (dirFd == -1)
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot open directory %x."), L"%x", fmtPath(folderPath)), "dup");
 
-    for (const Zstring& filePath : filePaths)
-        removeFilePlain(filePath); //throw FileError
+        DIR* dirObj = ::fdopendir(dirFd);
+        if (!dirObj)
+        {
+            const ErrorCode ec = getLastError(); //copy before making other system calls!
+            ::close(dirFd);
+            throw FileError(replaceCpy(_("Cannot open directory %x."), L"%x", fmtPath(folderPath)), formatSystemError("fdopendir", ec));
+        }
+        ZEN_ON_SCOPE_EXIT(::closedir(dirObj)); //never close nullptr handles! -> crash
 
-    for (const Zstring& symlinkPath : symlinkPaths)
-        removeSymlinkPlain(symlinkPath); //throw FileError
+        for (;;)
+        {
+            errno = 0;
+            const dirent* dirEntry = ::readdir(dirObj);
+            if (!dirEntry)
+            {
+                if (errno == 0) //no more items
+                    break;
+                THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read directory %x."), L"%x", fmtPath(folderPath)), "readdir");
+            }
+
+            const char* itemNameRaw = dirEntry->d_name;
 
-    //delete directories recursively
-    for (const Zstring& subFolderPath : folderPaths)
-        removeDirectoryImpl(subFolderPath); //throw FileError; call recursively to correctly handle symbolic links
+            //skip "." and ".."
+            if (itemNameRaw[0] == '.' &&
+                (itemNameRaw[1] == 0 || (itemNameRaw[1] == '.' && itemNameRaw[2] == 0)))
+                continue;
 
-    removeDirectoryPlain(folderPath); //throw FileError
+            bool isFolder = dirEntry->d_type == DT_DIR;
+            if (dirEntry->d_type == DT_UNKNOWN) //file system doesn't support d_type: e.g. some network file systems
+            {
+                struct stat itemInfo = {};
+                if (::fstatat(folderFd, itemNameRaw, &itemInfo, AT_SYMLINK_NOFOLLOW) != 0)
+                    THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(nativeAppendPaths(folderPath, itemNameRaw))), "fstatat");
+                isFolder = S_ISDIR(itemInfo.st_mode);
+            }
+            (isFolder ? folderNames : itemNames).push_back(itemNameRaw);
+        }
+    }
+
+    for (const Zstring& itemName : itemNames)
+    {
+        const Zstring& itemPath = nativeAppendPaths(folderPath, itemName);
+        if (onBeforeFileDeletion)
+            onBeforeFileDeletion(itemPath); //throw X
+
+        if (::unlinkat(folderFd, itemName.c_str(), 0) != 0)
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot delete file %x."), L"%x", fmtPath(itemPath)), "unlinkat");
+    }
+
+    for (const Zstring& childName : folderNames)
+        removeDirectoryAt(folderFd, childName, nativeAppendPaths(folderPath, childName), onBeforeFileDeletion, onBeforeFolderDeletion); //throw FileError, X
+
+    if (onBeforeFolderDeletion)
+        onBeforeFolderDeletion(folderPath); //throw X
+
+    if (::unlinkat(parentFd, folderName.c_str(), AT_REMOVEDIR) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot delete directory %x."), L"%x", fmtPath(folderPath)), "unlinkat");
 }
 }
 
 
-void zen::removeDirectoryPlainRecursion(const Zstring& dirPath) //throw FileError
+void zen::removeDirectoryPlainRecursion(const Zstring& dirPath, //throw FileError, X
+                                        const std::function<void(const Zstring& itemPath)>& onBeforeFileDeletion /*throw X*/,
+                                        const std::function<void(const Zstring& folderPath)>& onBeforeFolderDeletion)
 {
     if (getItemType(dirPath) == ItemType::symlink) //throw FileError
+    {
+        if (onBeforeFileDeletion)
+            onBeforeFileDeletion(dirPath); //throw X
         removeSymlinkPlain(dirPath); //throw FileError
+    }
     else
-        removeDirectoryImpl(dirPath); //throw FileError
+    {
+        const std::optional<Zstring> parentPath = getParentFolderPath(dirPath);
+        if (!parentPath) //device root
+            throw FileError(replaceCpy(_("Cannot delete directory %x."), L"%x", fmtPath(dirPath)), L"Cannot delete device root.");
+
+        const int parentFd = ::open(parentPath->c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (parentFd == -1)
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot open directory %x."), L"%x", fmtPath(*parentPath)), "open");
+        ZEN_ON_SCOPE_EXIT(::close(parentFd));
+
+        removeDirectoryAt(parentFd, afterLast(dirPath, FILE_NAME_SEPARATOR, IfNotFoundReturn::all), dirPath, onBeforeFileDeletion, onBeforeFolderDeletion); //throw FileError, X
+    }
+}
+
+
+void zen::removeDirectoryPlainRecursion(const Zstring& dirPath) //throw FileError
+{
+    removeDirectoryPlainRecursion(dirPath, nullptr /*onBeforeFileDeletion*/, nullptr /*onBeforeFolderDeletion*/); //throw FileError
 }
 
 
@@ -560,7 +769,246 @@ void zen::copySymlink(const Zstring& sourcePath, const Zstring& targetPath) //th
 }
 
 
-FileCopyResult zen::copyNewFile(const Zstring& sourceFile, const Zstring& targetFile, //throw FileError, ErrorTargetExisting, (ErrorFileLocked), X
+bool zen::tryCreateHardLink(const Zstring& existingPath, const Zstring& newPath) //throw FileError, ErrorTargetExisting
+{
+    if (::link(existingPath.c_str(), newPath.c_str()) != 0) //does not follow symlinks (Linux)
+    {
+        const int lastError = errno; //copy before directly or indirectly making other system calls!
+        if (lastError == EXDEV  || //not on the same mounted file system
+            lastError == EMLINK || //maximum number of links reached
+            lastError == EPERM  || //file system does not support hard links (e.g. FAT)
+            lastError == EOPNOTSUPP)
+            return false;
+
+        const std::wstring errorMsg = replaceCpy(replaceCpy(_("Cannot create a hard link from %x to %y."), L"%x", L'\n' + fmtPath(existingPath)), L"%y", L'\n' + fmtPath(newPath));
+        const std::wstring errorDescr = formatSystemError("link", lastError);
+
+        if (lastError == EEXIST)
+            throw ErrorTargetExisting(errorMsg, errorDescr);
+        throw FileError(errorMsg, errorDescr);
+    }
+    return true;
+}
+
+
+namespace
+{
+void writeAtFully(FileBase::FileHandle hFile, const Zstring& filePath, uint64_t offset, const std::byte* buffer, size_t bytesToWrite) //throw FileError
+{
+    while (bytesToWrite > 0)
+    {
+        ssize_t bytesWritten = 0;
+        do
+        {
+            bytesWritten = ::pwrite(hFile, buffer, bytesToWrite, offset);
+        }
+        while (bytesWritten < 0 && errno == EINTR);
+
+        if (bytesWritten <= 0)
+        {
+            if (bytesWritten == 0) //comment in safe-read.c suggests to treat this as an error due to buggy drivers
+                errno = ENOSPC;
+
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(filePath)), "pwrite");
+        }
+        if (makeUnsigned(bytesWritten) > bytesToWrite) //better safe than sorry
+            throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(filePath)), formatSystemError("pwrite", L"", L"Buffer overflow."));
+
+        buffer       += bytesWritten;
+        offset       += bytesWritten;
+        bytesToWrite -= bytesWritten;
+    }
+}
+
+
+//copy-on-write clone: target must be empty and on the same file system (and mount point!)
+bool tryCloneFileContent(FileBase::FileHandle hIn, FileBase::FileHandle hOut, const Zstring& targetPath) //throw FileError
+{
+    if (::ioctl(hOut, FICLONE, hIn) == 0)
+        return true;
+
+    switch (errno)
+    {
+        case EXDEV:      //different file systems or mount points
+        case EOPNOTSUPP: //file system doesn't support reflinks (ext4, tmpfs, ...)
+        case ENOTTY:     //ioctl not supported (e.g. older kernels, FUSE)
+        case EINVAL:     //e.g. unaligned file sizes (XFS), files with incompatible attributes (Btrfs: NOCOW vs COW)
+        case EPERM:      //e.g. immutable/append-only target
+        case ETXTBSY:    //swap file
+        case EISDIR:
+            return false;
+    }
+    THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(targetPath)), "ioctl(FICLONE)");
+}
+
+
+/* copy_file_range(): data transfer stays in the kernel (zero-copy), may be offloaded to storage (NFS 4.2 server-side copy, SMB)
+    - Linux 5.3+ supports cross-file-system copies (5.19+: only if file system has explicit support => EXDEV otherwise)
+    - returns 0 for pseudo files with zero st_size (e.g. /proc, /sys) => fall back to buffered copy     */
+bool tryCopyFileRangeKernel(FileInput& fileIn, FileOutput& fileOut, uint64_t expectedSize, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+{
+    if (expectedSize == 0) //nothing to gain; pseudo files need buffered copy anyway
+        return false;
+
+    //limit chunk size to get regular progress updates (and to allow cancellation)
+    const size_t chunkSize = 64 * FileBase::getDefaultBlockSize(); //8 MB
+
+    uint64_t bytesCopied = 0;
+    for (;;)
+    {
+        ssize_t bytesWritten = 0;
+        do
+        {
+            bytesWritten = ::copy_file_range(fileIn.getHandle(), nullptr, fileOut.getHandle(), nullptr, chunkSize, 0);
+        }
+        while (bytesWritten < 0 && errno == EINTR);
+
+        if (bytesWritten < 0)
+        {
+            if (bytesCopied == 0) //file offsets still unchanged => safe to use buffered copy instead
+                switch (errno)
+                {
+                    case ENOSYS:     //kernel < 4.5
+                    case EXDEV:      //cross-file-system copy not supported
+                    case EOPNOTSUPP: //
+                    case EINVAL:     //e.g. file system without copy_file_range support (< Linux 5.3), special files
+                    case EBADF:      //e.g. target opened with O_APPEND (not by us, but better safe than sorry)
+                    case EIO:        //seen with CIFS/FUSE when server-side copy fails
+                        return false;
+                }
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(fileOut.getFilePath())), "copy_file_range");
+        }
+
+        if (bytesWritten == 0) //end of file
+            return bytesCopied != 0; //nothing copied? file size unreliable => buffered copy is still possible
+
+        bytesCopied += bytesWritten;
+        fileIn .dropCacheBehind(bytesCopied); //cache-neutral mode: chunkSize == drop-behind interval
+        fileOut.dropCacheBehind(bytesCopied); //
+        if (notifyUnbufferedIO) notifyUnbufferedIO(bytesWritten); //throw X
+    }
+}
+
+
+//st_blocks: 512-byte units, independent from file system block size
+inline
+bool isSparseFile(const struct stat& fileInfo) { return fileInfo.st_size > 0 && makeUnsigned(fileInfo.st_blocks) * 512 < makeUnsigned(fileInfo.st_size); }
+
+
+/* sparse files (VM disks, databases): copy data extents only => holes stay unallocated on target, no time wasted on copying zeros
+    - copy_file_range() and read/write loops would write all holes as zeros!
+    - SEEK_DATA/SEEK_HOLE: Linux 3.1+; file systems without native support report a single data extent => still correct
+    - trailing hole: ftruncate()                                                                         */
+bool trySparseFileCopy(FileInput& fileIn, FileOutput& fileOut, uint64_t fileSize, uint64_t& bytesCopied, const IoCallback& notifyUnbufferedIO /*throw X*/) //throw FileError, X
+{
+    const size_t chunkSize = 64 * FileBase::getDefaultBlockSize(); //8 MB: regular progress updates (and allow cancellation)
+    std::vector<std::byte> buf; //only needed if copy_file_range() is not available
+    bytesCopied = 0;
+
+    for (off_t offset = 0;;)
+    {
+        const off_t dataFirst = ::lseek(fileIn.getHandle(), offset, SEEK_DATA);
+        if (dataFirst < 0)
+        {
+            if (errno == ENXIO) //no more data after offset
+                break;
+            if (offset == 0 && (errno == EINVAL || errno == EOPNOTSUPP)) //SEEK_DATA not supported => nothing written yet: fall back to regular copy
+                return false;
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(fileIn.getFilePath())), "lseek(SEEK_DATA)");
+        }
+        const off_t dataLast = ::lseek(fileIn.getHandle(), dataFirst, SEEK_HOLE); //at least implicit hole at end of file
+        if (dataLast < 0)
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(fileIn.getFilePath())), "lseek(SEEK_HOLE)");
+
+        for (off_t pos = dataFirst; pos < dataLast;)
+        {
+            const size_t bytesToCopy = static_cast<size_t>(std::min<off_t>(dataLast - pos, chunkSize));
+            ssize_t bytesDone = -1;
+
+            if (buf.empty())
+            {
+                off_t posIn  = pos;
+                off_t posOut = pos;
+                do
+                {
+                    bytesDone = ::copy_file_range(fileIn.getHandle(), &posIn, fileOut.getHandle(), &posOut, bytesToCopy, 0);
+                }
+                while (bytesDone < 0 && errno == EINTR);
+
+                if (bytesDone < 0)
+                    switch (errno)
+                    {
+                        case ENOSYS:     //see tryCopyFileRangeKernel()
+                        case EXDEV:      //
+                        case EOPNOTSUPP: //
+                        case EINVAL:     //
+                        case EIO:        //
+                            buf.resize(chunkSize); //explicit offsets: file positions unchanged => safe to continue with pread/pwrite
+                            continue;
+                        default:
+                            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(fileOut.getFilePath())), "copy_file_range");
+                    }
+            }
+            else
+            {
+                do
+                {
+                    bytesDone = ::pread(fileIn.getHandle(), buf.data(), bytesToCopy, pos);
+                }
+                while (bytesDone < 0 && errno == EINTR);
+
+                if (bytesDone < 0)
+                    THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(fileIn.getFilePath())), "pread");
+                if (makeUnsigned(bytesDone) > bytesToCopy) //better safe than sorry
+                    throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(fileIn.getFilePath())), formatSystemError("pread", L"", L"Buffer overflow."));
+
+                writeAtFully(fileOut.getHandle(), fileOut.getFilePath(), pos, buf.data(), bytesDone); //throw FileError
+            }
+
+            if (bytesDone == 0) //source file shrunk in the meantime
+                break;
+
+            pos         += bytesDone;
+            bytesCopied += bytesDone;
+            fileIn .dropCacheBehind(pos); //cache-neutral mode
+            fileOut.dropCacheBehind(pos); //
+            if (notifyUnbufferedIO) notifyUnbufferedIO(bytesDone); //throw X
+        }
+        offset = dataLast;
+    }
+
+    if (::ftruncate(fileOut.getHandle(), fileSize) != 0) //holes up to end of file
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(fileOut.getFilePath())), "ftruncate");
+    return true;
+}
+}
+
+
+namespace
+{
+//local file systems known to keep file times set via an open handle after writing => see Samba bug below
+bool canSetFileTimeBeforeClose(int fd) //noexcept
+{
+    struct statfs volInfo = {};
+    if (::fstatfs(fd, &volInfo) != 0)
+        return false;
+
+    switch (volInfo.f_type)
+    {
+        case EXT4_SUPER_MAGIC: //also ext2/ext3
+        case XFS_SUPER_MAGIC:
+        case BTRFS_SUPER_MAGIC:
+        case F2FS_SUPER_MAGIC:
+        case TMPFS_MAGIC:
+        case 0x2FC12FC1: //ZFS
+            return true;
+    }
+    return false;
+}
+}
+
+
+FileCopyResult zen::copyNewFile(const Zstring& sourceFile, const Zstring& targetFile, bool copyFilePermissions, //throw FileError, ErrorTargetExisting, (ErrorFileLocked), X
                                 const IoCallback& notifyUnbufferedIO /*throw X*/)
 {
     int64_t totalUnbufferedIO = 0;
@@ -589,10 +1037,30 @@ FileCopyResult zen::copyNewFile(const Zstring& sourceFile, const Zstring& target
     }
     FileOutput fileOut(fdTarget, targetFile, IOCallbackDivider(notifyUnbufferedIO, totalUnbufferedIO)); //pass ownership
 
-    //preallocate disk space + reduce fragmentation (perf: no real benefit)
-    fileOut.reserveSpace(sourceInfo.st_size); //throw FileError
+    uint64_t bytesCopied = sourceInfo.st_size;
+
+    const FileCopyMethod copyMethod = [&]
+    {
+        if (tryCloneFileContent(fileIn.getHandle(), fileOut.getHandle(), targetFile)) //throw FileError
+        {
+            if (notifyUnbufferedIO) notifyUnbufferedIO(sourceInfo.st_size); //throw X
+            bytesCopied = 0;
+            return FileCopyMethod::reflink;
+        }
+
+        if (isSparseFile(sourceInfo)) //don't reserveSpace(): would allocate the holes
+            if (trySparseFileCopy(fileIn, fileOut, sourceInfo.st_size, bytesCopied, notifyUnbufferedIO)) //throw FileError, X
+                return FileCopyMethod::sparseCopy;
+
+        //preallocate disk space + reduce fragmentation (perf: no real benefit)
+        fileOut.reserveSpace(sourceInfo.st_size); //throw FileError
+
+        if (tryCopyFileRangeKernel(fileIn, fileOut, sourceInfo.st_size, notifyUnbufferedIO)) //throw FileError, X
+            return FileCopyMethod::kernelCopy;
 
-    bufferedStreamCopy(fileIn, fileOut); //throw FileError, (ErrorFileLocked), X
+        bufferedStreamCopy(fileIn, fileOut); //throw FileError, (ErrorFileLocked), X
+        return FileCopyMethod::bufferedStream;
+    }();
 
     //flush intermediate buffers before fiddling with the raw file handle
     fileOut.flushBuffers(); //throw FileError, X
@@ -601,6 +1069,35 @@ FileCopyResult zen::copyNewFile(const Zstring& sourceFile, const Zstring& target
     if (::fstat(fileOut.getHandle(), &targetInfo) != 0)
         THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(targetFile)), "fstat");
 
+    //apply metadata via the open handle: no more path lookups; failure => FileOutput deletes the new file
+    if (copyFilePermissions) //=> analog to copyItemPermissions(ProcSymlink::follow)
+    {
+#ifdef HAVE_SELINUX  //copy SELinux security context
+        copySecurityContext(sourceFile, targetFile, ProcSymlink::follow); //throw FileError
+#endif
+        if (::fchown(fileOut.getHandle(), sourceInfo.st_uid, sourceInfo.st_gid) != 0) // may require admin rights!
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write permissions of %x."), L"%x", fmtPath(targetFile)), "fchown");
+
+        if (::fchmod(fileOut.getHandle(), sourceInfo.st_mode) != 0) //*after* fchown(), which may clear S_ISUID/S_ISGID
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write permissions of %x."), L"%x", fmtPath(targetFile)), "fchmod");
+    }
+
+    /*  we cannot set the target file times (::futimes) while the file descriptor is still open after a write operation:
+        this triggers bugs on Samba shares where the modification time is set to current time instead.
+        Linux: https://bugs.debian.org/cgi-bin/bugreport.cgi?bug=340236
+               http://comments.gmane.org/gmane.linux.file-systems.cifs/2854
+        macOS: https://freefilesync.org/forum/viewtopic.php?t=356
+        => fine for local file systems: save the path lookup of setWriteTimeNative()     */
+    std::optional<FileError> errorModTime;
+    bool modTimeSet = false;
+    if (canSetFileTimeBeforeClose(fileOut.getHandle()))
+    {
+        timespec newTimes[2] = {};
+        newTimes[0].tv_sec = ::time(nullptr); //access time: see setWriteTimeNative()
+        newTimes[1] = sourceInfo.st_mtim;     //modification time
+        modTimeSet = ::futimens(fileOut.getHandle(), newTimes) == 0; //else: retry by path for a detailed error
+    }
+
     //close output file handle before setting file time; also good place to catch errors when closing stream!
     fileOut.finalize(); //throw FileError, (X)  essentially a close() since  buffers were already flushed
 
@@ -608,15 +1105,201 @@ FileCopyResult zen::copyNewFile(const Zstring& sourceFile, const Zstring& target
     //take fileOut ownership => from this point on, WE are responsible for calling removeFilePlain() on failure!!
     //===========================================================================================================
 
+    if (!modTimeSet)
+        try
+        {
+            setWriteTimeNative(targetFile, sourceInfo.st_mtim, ProcSymlink::follow); //throw FileError
+        }
+        catch (const FileError& e)
+        {
+            errorModTime = FileError(e.toString()); //avoid slicing
+        }
+
+    FileCopyResult result;
+    result.fileSize = sourceInfo.st_size;
+    result.bytesCopied = bytesCopied;
+    result.copyMethod = copyMethod;
+    result.sourceModTime = sourceInfo.st_mtim;
+    result.sourceFileIdx = sourceInfo.st_ino;
+    result.targetFileIdx = targetInfo.st_ino;
+    result.errorModTime = errorModTime;
+    return result;
+}
+
+
+bool zen::cloneFile(const Zstring& sourceFile, const Zstring& targetFile) //throw FileError, ErrorTargetExisting
+{
+    FileInput fileIn(sourceFile, nullptr /*notifyUnbufferedIO*/); //throw FileError, (ErrorFileLocked -> Windows-only)
+
+    struct stat sourceInfo = {};
+    if (::fstat(fileIn.getHandle(), &sourceInfo) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(sourceFile)), "fstat");
+
+    const int fdTarget = ::open(targetFile.c_str(), O_CREAT | O_EXCL | O_WRONLY | O_CLOEXEC, sourceInfo.st_mode & (S_IRWXU | S_IRWXG | S_IRWXO)); //analog to copyNewFile()
+    if (fdTarget == -1)
+    {
+        const int ec = errno; //copy before making other system calls!
+        const std::wstring errorMsg = replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(targetFile));
+        const std::wstring errorDescr = formatSystemError("open", ec);
+
+        if (ec == EEXIST)
+            throw ErrorTargetExisting(errorMsg, errorDescr);
+
+        throw FileError(errorMsg, errorDescr);
+    }
+    FileOutput fileOut(fdTarget, targetFile, nullptr /*notifyUnbufferedIO*/); //pass ownership
+
+    if (!tryCloneFileContent(fileIn.getHandle(), fileOut.getHandle(), targetFile)) //throw FileError
+        return false; //=> FileOutput deletes the new file
+
+    //nothing was written => no Samba issue with setting file times via the open handle (see copyNewFile())
+    timespec newTimes[2] = {};
+    newTimes[0].tv_sec = ::time(nullptr); //access time: see setWriteTimeNative()
+    newTimes[1] = sourceInfo.st_mtim;     //modification time
+    if (::futimens(fileOut.getHandle(), newTimes) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write modification time of %x."), L"%x", fmtPath(targetFile)), "futimens");
+
+    fileOut.finalize(); //throw FileError, (X)
+    return true;
+}
+
+
+
+
+
+std::optional<FileCopyResult> zen::updateFileDelta(const Zstring& sourceFile, const Zstring& targetFile, const Zstring& targetFileTmp, //throw FileError, ErrorFileLocked, X
+                                                   const std::optional<EqualPrefixHint>& equalPrefix,
+                                                   const IoCallback& notifyUnbufferedIO /*throw X*/)
+{
+    FileInput fileIn(sourceFile, notifyUnbufferedIO); //throw FileError, (ErrorFileLocked -> Windows-only)
+
+    struct stat sourceInfo = {};
+    if (::fstat(fileIn.getHandle(), &sourceInfo) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(sourceFile)), "fstat");
+
+    FileInput fileOld(targetFile, nullptr /*notifyUnbufferedIO*/); //throw FileError, (ErrorFileLocked); progress: count source bytes only
+
+    struct stat targetInfo = {};
+    if (::fstat(fileOld.getHandle(), &targetInfo) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(targetFile)), "fstat");
+
+    if (sourceInfo.st_dev == targetInfo.st_dev) //same file system: copyNewFile() can do better: reflink/copy_file_range() without reading the target
+        return {};
+
+    const bool inPlace = targetFileTmp.empty();
+    if (inPlace && targetInfo.st_nlink > 1) //don't modify the other hard links, too!
+        return {};
+
+    const Zstring& filePathOut = inPlace ? targetFile : targetFileTmp;
+
+    const int fdOut = inPlace ?
+                      ::open(targetFile.c_str(), O_WRONLY | O_CLOEXEC) :
+                      ::open(targetFileTmp.c_str(), O_CREAT | O_EXCL | O_WRONLY | O_CLOEXEC, sourceInfo.st_mode & (S_IRWXU | S_IRWXG | S_IRWXO)); //analog to copyNewFile()
+    if (fdOut == -1)
+    {
+        const int ec = errno; //copy before making other system calls!
+        if (inPlace && (ec == EACCES || ec == EPERM || ec == ETXTBSY)) //e.g. read-only target: can still be replaced by copyNewFile()
+            return {};
+        throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(filePathOut)), formatSystemError("open", ec));
+    }
+    bool fdOutClosed = false;
+    ZEN_ON_SCOPE_EXIT(if (!fdOutClosed) ::close(fdOut));
+
+    //at this point we know we created a new file, so it's fine to delete it for cleanup!
+    ZEN_ON_SCOPE_FAIL(if (!inPlace) try { removeFilePlain(targetFileTmp); /*throw FileError*/ }
+    catch (FileError&) {});
+
+    if (!inPlace)
+        if (!tryCloneFileContent(fileOld.getHandle(), fdOut, targetFileTmp)) //throw FileError
+        {
+            //no copy-on-write: patching a full copy would not save any writes
+            ::close(fdOut);
+            fdOutClosed = true;
+            try { removeFilePlain(targetFileTmp); /*throw FileError*/ }
+            catch (FileError&) {}
+            return {};
+        }
+
+    //compare in large chunks, but write with finer granularity
+    const size_t chunkSize = 16 * FileBase::getDefaultBlockSize(); //2 MB
+    const size_t deltaBlockSize = 64 * 1024;
+
+    //leading bytes already compared equal (e.g. "compare by content"): skip, unless either file changed meanwhile
+    uint64_t bytesSkipped = 0;
+    if (equalPrefix &&
+        makeUnsigned(sourceInfo.st_size) == equalPrefix->fileSize &&
+        makeUnsigned(targetInfo.st_size) == equalPrefix->fileSize &&
+        nativeFileTimeToTimeT(sourceInfo.st_mtim) == equalPrefix->modTimeSource &&
+        nativeFileTimeToTimeT(targetInfo.st_mtim) == equalPrefix->modTimeTarget)
+        bytesSkipped = std::min(equalPrefix->byteCount, equalPrefix->fileSize) / deltaBlockSize * deltaBlockSize;
+
+    if (bytesSkipped > 0)
+    {
+        //before first read(): FileInput starts reading (and io_uring read-ahead) at the current stream position
+        if (::lseek(fileIn.getHandle(), bytesSkipped, SEEK_SET) == -1)
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(sourceFile)), "lseek");
+        if (::lseek(fileOld.getHandle(), bytesSkipped, SEEK_SET) == -1)
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(targetFile)), "lseek");
+
+        if (notifyUnbufferedIO) notifyUnbufferedIO(bytesSkipped); //throw X; progress: as if read
+    }
+
+    std::vector<std::byte> bufNew(chunkSize);
+    std::vector<std::byte> bufOld(chunkSize);
+
+    uint64_t chunkOffset = bytesSkipped;
+    uint64_t bytesWrittenTotal = 0;
+    for (;;)
+    {
+        const size_t bytesNew = fileIn .read(bufNew.data(), bufNew.size()); //throw FileError, ErrorFileLocked, X
+        const size_t bytesOld = fileOld.read(bufOld.data(), bufOld.size()); //throw FileError, ErrorFileLocked; 0 after end of stream
+
+        std::optional<size_t> diffFirst; //coalesce adjacent differing blocks into a single write
+        for (size_t pos = 0; pos < bytesNew; pos += deltaBlockSize)
+        {
+            const size_t blockSize = std::min(deltaBlockSize, bytesNew - pos);
+
+            if (pos + blockSize <= bytesOld && equalBytes(&bufNew[pos], &bufOld[pos], blockSize))
+            {
+                if (diffFirst)
+                {
+                    writeAtFully(fdOut, filePathOut, chunkOffset + *diffFirst, &bufNew[*diffFirst], pos - *diffFirst); //throw FileError
+                    bytesWrittenTotal += pos - *diffFirst;
+                    diffFirst = std::nullopt;
+                }
+            }
+            else if (!diffFirst)
+                diffFirst = pos;
+        }
+        if (diffFirst)
+        {
+            writeAtFully(fdOut, filePathOut, chunkOffset + *diffFirst, &bufNew[*diffFirst], bytesNew - *diffFirst); //throw FileError
+            bytesWrittenTotal += bytesNew - *diffFirst;
+        }
+
+        chunkOffset += bytesNew;
+
+        if (bytesNew < bufNew.size()) //end of stream
+            break;
+    }
+
+    //source smaller than target: cut off remainder
+    if (::ftruncate(fdOut, chunkOffset) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(filePathOut)), "ftruncate");
+
+    struct stat outInfo = {};
+    if (::fstat(fdOut, &outInfo) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(filePathOut)), "fstat");
+
+    //close before setting file time: see copyNewFile(); also good place to catch errors when closing stream!
+    fdOutClosed = true;
+    if (::close(fdOut) != 0)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(filePathOut)), "close");
+
     std::optional<FileError> errorModTime;
     try
     {
-        /*  we cannot set the target file times (::futimes) while the file descriptor is still open after a write operation:
-            this triggers bugs on Samba shares where the modification time is set to current time instead.
-            Linux: https://bugs.debian.org/cgi-bin/bugreport.cgi?bug=340236
-                   http://comments.gmane.org/gmane.linux.file-systems.cifs/2854
-            macOS: https://freefilesync.org/forum/viewtopic.php?t=356             */
-        setWriteTimeNative(targetFile, sourceInfo.st_mtim, ProcSymlink::follow); //throw FileError
+        setWriteTimeNative(filePathOut, sourceInfo.st_mtim, ProcSymlink::follow); //throw FileError
     }
     catch (const FileError& e)
     {
@@ -624,12 +1307,12 @@ FileCopyResult zen::copyNewFile(const Zstring& sourceFile, const Zstring& target
     }
 
     FileCopyResult result;
-    result.fileSize = sourceInfo.st_size;
+    result.fileSize = chunkOffset;
+    result.bytesCopied = bytesWrittenTotal;
+    result.copyMethod = FileCopyMethod::deltaUpdate;
     result.sourceModTime = sourceInfo.st_mtim;
     result.sourceFileIdx = sourceInfo.st_ino;
-    result.targetFileIdx = targetInfo.st_ino;
+    result.targetFileIdx = outInfo.st_ino;
     result.errorModTime = errorModTime;
     return result;
 }
-
-
@@ -61,6 +61,32 @@ void setFileTime(const Zstring& filePath, time_t modTime, ProcSymlink procSl); /
 int64_t getFreeDiskSpace(const Zstring& path); //throw FileError, returns < 0 if not available
 uint64_t getFileSize(const Zstring& filePath); //throw FileError
 
+/* seek-aware ordering for rotational media (HDD): stat() directory entries by inode number, read files by physical position
+    - detection: sysfs "queue/rotational" of the block device (or of its parent disk for partitions); cached per device
+    - network shares, Btrfs (anonymous device numbers), etc.: not detected => use "always" to force      */
+enum class RotationalMode
+{
+    autoDetect,
+    always,
+    never,
+};
+//process-wide setting
+void setRotationalMode(RotationalMode mode);
+RotationalMode getRotationalMode();
+
+bool isRotationalDevice(const Zstring& path); //noexcept; follows symlinks; false if unknown
+
+//identity of the underlying disk for I/O scheduling: partitions and mount points of the same disk (or md/device mapper volume) yield the same ID
+//not a block device (e.g. network share, Btrfs, tmpfs): ID of the file system; empty if unknown
+std::string getPhysicalDeviceId(const Zstring& path); //noexcept; follows symlinks
+
+//start of first extent on disk (FIEMAP); std::nullopt if not available (e.g. empty or inline file, no FIEMAP support)
+std::optional<uint64_t> getPhysicalOffset(const Zstring& filePath); //noexcept
+
+/* read-only access without access time update: no inode write per read on "atime"/"relatime" mounts (=> no write amplification, no snapshot churn)
+    O_NOATIME requires file owner or CAP_FOWNER => falls back to a regular open() otherwise    */
+int openNoAtime(const Zstring& itemPath, int flags); //returns -1 and sets errno on error (like open())
+
 //get per-user directory designated for temporary files:
 Zstring getTempFolderPath(); //throw FileError
 
@@ -68,6 +94,9 @@ void removeFilePlain     (const Zstring& filePath);         //throw FileError; E
 void removeSymlinkPlain  (const Zstring& linkPath);         //throw FileError; ERROR if not existing
 void removeDirectoryPlain(const Zstring& dirPath );         //throw FileError; ERROR if not existing
 void removeDirectoryPlainRecursion(const Zstring& dirPath); //throw FileError; ERROR if not existing
+void removeDirectoryPlainRecursion(const Zstring& dirPath, //throw FileError, X; ERROR if not existing
+                                   const std::function<void(const Zstring& itemPath)>& onBeforeFileDeletion /*throw X*/, //optional
+                                   const std::function<void(const Zstring& folderPath)>& onBeforeFolderDeletion);        //one call for each object!
 
 void moveAndRenameItem(const Zstring& pathFrom, const Zstring& pathTo, bool replaceExisting); //throw FileError, ErrorMoveUnsupported, ErrorTargetExisting
 
@@ -88,18 +117,54 @@ void tryCopyDirectoryAttributes(const Zstring& sourcePath, const Zstring& target
 
 void copySymlink(const Zstring& sourcePath, const Zstring& targetPath); //throw FileError
 
+//additional name for an existing file
+//already existing: fail
+//returns false if not supported (e.g. different devices, link count limit reached, file system without hard links): nothing done
+bool tryCreateHardLink(const Zstring& existingPath, const Zstring& newPath); //throw FileError, ErrorTargetExisting
+
+enum class FileCopyMethod
+{
+    bufferedStream, //user-space read/write loop
+    kernelCopy,     //copy_file_range(): no user-space round trip, may be offloaded by the file system (NFS server-side copy, etc.)
+    reflink,        //FICLONE: copy-on-write clone (Btrfs, XFS): no data is copied at all
+    sparseCopy,     //SEEK_DATA/SEEK_HOLE: data extents only, holes are not allocated on target
+    deltaUpdate,    //updateFileDelta(): only the blocks different from the existing target were written
+};
+
 struct FileCopyResult
 {
-    uint64_t fileSize = 0;
+    uint64_t fileSize = 0;    //logical size
+    uint64_t bytesCopied = 0; //data actually transferred: less than fileSize for sparse files and delta updates, 0 for reflink
+    FileCopyMethod copyMethod = FileCopyMethod::bufferedStream;
     FileTimeNative sourceModTime = {};
     FileIndex sourceFileIdx = 0;
     FileIndex targetFileIdx = 0;
     std::optional<FileError> errorModTime; //failure to set modification time
 };
 
-FileCopyResult copyNewFile(const Zstring& sourceFile, const Zstring& targetFile, //throw FileError, ErrorTargetExisting, ErrorFileLocked, X
+//copyFilePermissions: analog to copyItemPermissions(), but applied via the open file handle
+FileCopyResult copyNewFile(const Zstring& sourceFile, const Zstring& targetFile, bool copyFilePermissions, //throw FileError, ErrorTargetExisting, ErrorFileLocked, X
                            //accummulated delta != file size! consider ADS, sparse, compressed files
                            const IoCallback& notifyUnbufferedIO /*throw X*/);
+
+//copy-on-write clone incl. modification time, but without copying any data: false if not supported (no reflinks, different file systems) => nothing done
+bool cloneFile(const Zstring& sourceFile, const Zstring& targetFile); //throw FileError, ErrorTargetExisting
+
+/* update existing target by writing only those blocks that differ from source: saves write bandwidth, SSD endurance, CoW snapshot space
+    - targetFileTmp empty: modify targetFile in place (non-transactional!)
+    - else: create targetFileTmp (not yet existing) as copy-on-write clone of targetFile, then patch it
+    returns none if not worth it, e.g. same file system (=> copyNewFile() clones the source), no reflink support, hard links => nothing done   */
+struct EqualPrefixHint //e.g. found by a previous content comparison: only valid while both files are unchanged since
+{
+    uint64_t byteCount = 0; //leading bytes known to be equal => neither read nor written
+    uint64_t fileSize = 0;  //of source and target when byteCount was determined
+    time_t modTimeSource = 0;
+    time_t modTimeTarget = 0;
+};
+
+std::optional<FileCopyResult> updateFileDelta(const Zstring& sourceFile, const Zstring& targetFile, const Zstring& targetFileTmp, //throw FileError, ErrorFileLocked, X
+                                              const std::optional<EqualPrefixHint>& equalPrefix, //optional: ignored if either file has changed
+                                              const IoCallback& notifyUnbufferedIO /*throw X*/);
 }
 
 #endif //FILE_ACCESS_H_8017341345614857
@@ -6,13 +6,576 @@
 
 #include "file_io.h"
 
+#include <atomic>
+#include "perf.h"
     #include <sys/stat.h>
     #include <fcntl.h>  //open
     #include <unistd.h> //close, read, write
+    #include <sys/mman.h>    //mmap
+    #include <sys/syscall.h> //__NR_io_uring_setup
+    #include <linux/io_uring.h>
 
 using namespace zen;
 
 
+namespace
+{
+std::atomic<FileIoMode> globalFileIoMode{FileIoMode::synchronous};
+std::atomic<bool> ioUringUnavailable{false}; //don't retry io_uring_setup() for each file after first failure
+std::atomic<bool> globalFileCacheNeutral{false};
+}
+
+
+void zen::setFileIoMode(FileIoMode mode) { globalFileIoMode = mode; }
+FileIoMode zen::getFileIoMode() { return globalFileIoMode; }
+
+void zen::setFileCacheNeutral(bool enabled) { globalFileCacheNeutral = enabled; }
+bool zen::getFileCacheNeutral() { return globalFileCacheNeutral; }
+
+
+namespace
+{
+/* minimal io_uring submission/completion queue pair: https://kernel.dk/io_uring.pdf
+    - no liburing dependency: raw syscalls + shared ring memory
+    - single producer, single consumer: owned by exactly one stream object => no locking needed     */
+class IoUring
+{
+public:
+    explicit IoUring(unsigned entries) //throw SysError
+    {
+        io_uring_params params = {};
+        const int fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0)
+            THROW_LAST_SYS_ERROR("io_uring_setup");
+        ringFd_ = fd;
+        ZEN_ON_SCOPE_FAIL(cleanup());
+
+        if (!(params.features & IORING_FEAT_RW_CUR_POS)) //=> IORING_OP_READ/IORING_OP_WRITE are available, too (Linux 5.6+)
+            throw SysError(formatSystemError("io_uring_setup", L"", L"Kernel does not support IORING_OP_READ."));
+
+        sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize_ = params.cq_off.cqes  + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP)
+            sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+
+        sqRing_ = ::mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQ_RING);
+        if (sqRing_ == MAP_FAILED)
+        {
+            sqRing_ = nullptr;
+            THROW_LAST_SYS_ERROR("mmap(IORING_OFF_SQ_RING)");
+        }
+
+        if (params.features & IORING_FEAT_SINGLE_MMAP)
+            cqRing_ = sqRing_;
+        else
+        {
+            cqRing_ = ::mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_CQ_RING);
+            if (cqRing_ == MAP_FAILED)
+            {
+                cqRing_ = nullptr;
+                THROW_LAST_SYS_ERROR("mmap(IORING_OFF_CQ_RING)");
+            }
+        }
+
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED)
+            THROW_LAST_SYS_ERROR("mmap(IORING_OFF_SQES)");
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        auto sqPtr = [&](uint32_t offset) { return reinterpret_cast<unsigned*>(static_cast<char*>(sqRing_) + offset); };
+        auto cqPtr = [&](uint32_t offset) { return reinterpret_cast<unsigned*>(static_cast<char*>(cqRing_) + offset); };
+
+        sqTail_  = sqPtr(params.sq_off.tail);
+        sqMask_  = *sqPtr(params.sq_off.ring_mask);
+        sqArray_ = sqPtr(params.sq_off.array);
+        sqEntries_ = params.sq_entries;
+
+        cqHead_ = cqPtr(params.cq_off.head);
+        cqTail_ = cqPtr(params.cq_off.tail);
+        cqMask_ = *cqPtr(params.cq_off.ring_mask);
+        cqes_   = reinterpret_cast<io_uring_cqe*>(static_cast<char*>(cqRing_) + params.cq_off.cqes);
+    }
+
+    ~IoUring() { cleanup(); }
+
+    unsigned capacity() const { return sqEntries_; }
+
+    void submitRead (int fd, void* buffer,       unsigned len, uint64_t offset, uint64_t userData) { submit(IORING_OP_READ,  fd, buffer,                  len, offset, userData); } //throw SysError
+    void submitWrite(int fd, const void* buffer, unsigned len, uint64_t offset, uint64_t userData) { submit(IORING_OP_WRITE, fd, const_cast<void*>(buffer), len, offset, userData); } //
+
+    //wait for next completion; CONTRACT: at least one request must be in flight!
+    io_uring_cqe waitCompletion() //throw SysError
+    {
+        for (;;)
+        {
+            const unsigned head = *cqHead_; //we're the only consumer
+            if (head != std::atomic_ref(*cqTail_).load(std::memory_order_acquire))
+            {
+                const io_uring_cqe cqe = cqes_[head & cqMask_];
+                std::atomic_ref(*cqHead_).store(head + 1, std::memory_order_release);
+                return cqe;
+            }
+            enter(0 /*toSubmit*/, 1 /*minComplete*/, IORING_ENTER_GETEVENTS); //throw SysError
+        }
+    }
+
+private:
+    IoUring           (const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    void submit(uint8_t opcode, int fd, void* buffer, unsigned len, uint64_t offset, uint64_t userData) //throw SysError
+    {
+        const unsigned tail = *sqTail_; //we're the only producer
+        const unsigned idx = tail & sqMask_;
+
+        io_uring_sqe& sqe = sqes_[idx];
+        sqe = {};
+        sqe.opcode    = opcode;
+        sqe.fd        = fd;
+        sqe.addr      = reinterpret_cast<uint64_t>(buffer);
+        sqe.len       = len;
+        sqe.off       = offset;
+        sqe.user_data = userData;
+
+        sqArray_[idx] = idx;
+        std::atomic_ref(*sqTail_).store(tail + 1, std::memory_order_release);
+
+        enter(1 /*toSubmit*/, 0 /*minComplete*/, 0 /*flags*/); //throw SysError
+    }
+
+    void enter(unsigned toSubmit, unsigned minComplete, unsigned flags) //throw SysError
+    {
+        for (;;)
+        {
+            const int rv = static_cast<int>(::syscall(__NR_io_uring_enter, ringFd_, toSubmit, minComplete, flags, nullptr, 0));
+            if (rv >= 0)
+            {
+                assert(static_cast<unsigned>(rv) == toSubmit); //we submit one entry at a time, so either all or nothing
+                return;
+            }
+            if (errno != EINTR && errno != EAGAIN)
+                THROW_LAST_SYS_ERROR("io_uring_enter");
+        }
+    }
+
+    void cleanup()
+    {
+        if (sqes_)                        ::munmap(sqes_,   sqesSize_);
+        if (cqRing_ && cqRing_ != sqRing_) ::munmap(cqRing_, cqRingSize_);
+        if (sqRing_)                      ::munmap(sqRing_, sqRingSize_);
+        if (ringFd_ != -1)                ::close(ringFd_);
+    }
+
+    int ringFd_ = -1;
+
+    void*  sqRing_ = nullptr;
+    void*  cqRing_ = nullptr;
+    size_t sqRingSize_ = 0;
+    size_t cqRingSize_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqesSize_ = 0;
+
+    unsigned* sqTail_  = nullptr;
+    unsigned  sqMask_  = 0;
+    unsigned* sqArray_ = nullptr;
+    unsigned  sqEntries_ = 0;
+
+    unsigned*     cqHead_ = nullptr;
+    unsigned*     cqTail_ = nullptr;
+    unsigned      cqMask_ = 0;
+    io_uring_cqe* cqes_   = nullptr;
+};
+
+
+const unsigned IO_URING_QUEUE_DEPTH = 4; //blocks in flight per stream: 4 x 128 kB
+
+const uint64_t CACHE_DROP_BEHIND_INTERVAL = 8 * 1024 * 1024; //cache-neutral mode: release page cache every 8 MB
+
+
+//"advice" only => ignore errors (e.g. ESPIPE for pipes)
+void dropCachedPages(int fd, uint64_t offset, uint64_t len)
+{
+    if (len > 0) //len == 0 means "until end of file"
+        ::posix_fadvise(fd, offset, len, POSIX_FADV_DONTNEED);
+}
+
+
+std::unique_ptr<IoUring> tryCreateIoUring()
+{
+    if (getFileIoMode() != FileIoMode::ioUring || ioUringUnavailable)
+        return nullptr;
+    try
+    {
+        return std::make_unique<IoUring>(IO_URING_QUEUE_DEPTH); //throw SysError
+    }
+    catch (SysError&) //ENOSYS (kernel < 5.1), EPERM (seccomp, kernel.io_uring_disabled), ...
+    {
+        ioUringUnavailable = true;
+        return nullptr;
+    }
+}
+
+
+std::optional<uint64_t> getStreamPosition(int fd)
+{
+    const off_t pos = ::lseek(fd, 0, SEEK_CUR);
+    if (pos < 0) //e.g. pipes: ESPIPE
+        return std::nullopt;
+    return pos;
+}
+}
+
+
+/* keep IO_URING_QUEUE_DEPTH sequential reads in flight:
+    - completed blocks are handed out by swapping std::vector buffers => no extra memcpy
+    - short read (not end of file): restart pipeline at the actual stream position       */
+class zen::IoUringReader
+{
+public:
+    IoUringReader(std::unique_ptr<IoUring>&& ring, int fd, uint64_t streamPos, size_t blockSize) :
+        ring_(std::move(ring)), fd_(fd), blockSize_(blockSize), nextOffset_(streamPos)
+    {
+        for (Slot& slot : slots_)
+            slot.buf = getIoBuffer(blockSize_);
+    }
+
+    ~IoUringReader() //kernel must not write into freed buffers!
+    {
+        try { drain(); } /*throw SysError*/
+        catch (SysError&) { assert(false); return; } //buffer might still be in use => don't recycle
+
+        for (Slot& slot : slots_)
+            releaseIoBuffer(std::move(slot.buf));
+    }
+
+    //return next sequential block; may return short, only 0 means EOF!
+    size_t readBlock(std::vector<std::byte>& buffer) //throw SysError
+    {
+        assert(buffer.size() >= blockSize_);
+        if (eof_)
+            return 0;
+
+        if (inFlight_ == 0)
+            fillPipeline(); //throw SysError
+
+        Slot& slot = slots_[headIdx_];
+        while (!slot.completed)
+            processCompletion(); //throw SysError
+
+        slot.completed = false;
+        headIdx_ = (headIdx_ + 1) % slots_.size();
+
+        if (slot.result < 0)
+        {
+            drain(); //pipeline is broken => don't continue
+            eof_ = true;
+            errno = -slot.result;
+            THROW_LAST_SYS_ERROR("io_uring(IORING_OP_READ)");
+        }
+        const size_t bytesRead = slot.result;
+        if (bytesRead > blockSize_) //better safe than sorry
+            throw SysError(formatSystemError("io_uring(IORING_OP_READ)", L"", L"Buffer overflow."));
+
+        buffer.swap(slot.buf);
+        slot.buf.resize(blockSize_);
+
+        if (bytesRead == 0)
+        {
+            drain(); //remaining requests are beyond end of file
+            eof_ = true;
+        }
+        else if (bytesRead < blockSize_) //short read: requests in flight have wrong offsets (or are beyond EOF)
+        {
+            drain();
+            nextOffset_ = slot.offset + bytesRead;
+            fillPipeline(); //throw SysError
+        }
+        else
+            submitSlot(slot); //keep pipeline full; throw SysError
+
+        return bytesRead;
+    }
+
+private:
+    struct Slot
+    {
+        std::vector<std::byte> buf;
+        uint64_t offset = 0;
+        int result = 0;
+        bool pending = false;
+        bool completed = false;
+    };
+
+    void fillPipeline() //throw SysError
+    {
+        assert(inFlight_ == 0);
+        headIdx_ = 0;
+        for (Slot& slot : slots_)
+        {
+            slot.completed = false;
+            submitSlot(slot); //throw SysError
+        }
+    }
+
+    void submitSlot(Slot& slot) //throw SysError
+    {
+        slot.offset = nextOffset_;
+        ring_->submitRead(fd_, &slot.buf[0], static_cast<unsigned>(blockSize_), slot.offset, &slot - &slots_[0]); //throw SysError
+        slot.pending = true;
+        ++inFlight_;
+        nextOffset_ += blockSize_;
+    }
+
+    void processCompletion() //throw SysError
+    {
+        const io_uring_cqe cqe = ring_->waitCompletion(); //throw SysError
+        Slot& slot = slots_[cqe.user_data];
+        assert(slot.pending);
+        slot.result = cqe.res;
+        slot.pending = false;
+        slot.completed = true;
+        --inFlight_;
+    }
+
+    void drain() //throw SysError
+    {
+        while (inFlight_ > 0)
+            processCompletion(); //throw SysError
+
+        for (Slot& slot : slots_)
+            slot.completed = false;
+    }
+
+    std::unique_ptr<IoUring> ring_;
+    const int fd_;
+    const size_t blockSize_;
+    uint64_t nextOffset_;
+    std::array<Slot, IO_URING_QUEUE_DEPTH> slots_;
+    size_t headIdx_ = 0;
+    size_t inFlight_ = 0;
+    bool eof_ = false;
+};
+
+
+/* keep up to IO_URING_QUEUE_DEPTH sequential writes in flight:
+    - caller's buffer is swapped with a free slot buffer => no extra memcpy
+    - short write: write remainder synchronously (rare: e.g. disk full)         */
+class zen::IoUringWriter
+{
+public:
+    IoUringWriter(std::unique_ptr<IoUring>&& ring, int fd, uint64_t streamPos, size_t blockSize) :
+        ring_(std::move(ring)), fd_(fd), blockSize_(blockSize), nextOffset_(streamPos)
+    {
+        for (Slot& slot : slots_)
+            slot.buf = getIoBuffer(blockSize_);
+    }
+
+    ~IoUringWriter() //kernel must not read from freed buffers!
+    {
+        try
+        {
+            for (; inFlight_ > 0; --inFlight_) //ignore results: stream is abandoned anyway
+                ring_->waitCompletion(); //throw SysError
+        }
+        catch (SysError&) { assert(false); return; } //buffer might still be in use => don't recycle
+
+        for (Slot& slot : slots_)
+            releaseIoBuffer(std::move(slot.buf));
+    }
+
+    //return number of bytes confirmed as written (by this and previous requests)
+    size_t write(std::vector<std::byte>& buffer, size_t bytesToWrite) //throw SysError
+    {
+        assert(0 < bytesToWrite && bytesToWrite <= blockSize_ && buffer.size() >= blockSize_);
+        size_t bytesConfirmed = 0;
+
+        Slot* freeSlot = nullptr;
+        for (;;)
+        {
+            for (Slot& slot : slots_)
+                if (!slot.pending)
+                {
+                    freeSlot = &slot;
+                    break;
+                }
+            if (freeSlot)
+                break;
+            bytesConfirmed += processCompletion(); //throw SysError
+        }
+
+        buffer.swap(freeSlot->buf);
+        freeSlot->buf.resize(blockSize_); //=> buffer
+        buffer.resize(blockSize_);        //
+
+        freeSlot->offset = nextOffset_;
+        freeSlot->len = bytesToWrite;
+        ring_->submitWrite(fd_, &freeSlot->buf[0], static_cast<unsigned>(bytesToWrite), freeSlot->offset, freeSlot - &slots_[0]); //throw SysError
+        freeSlot->pending = true;
+        ++inFlight_;
+        nextOffset_ += bytesToWrite;
+
+        return bytesConfirmed;
+    }
+
+    size_t flush() //throw SysError
+    {
+        size_t bytesConfirmed = 0;
+        while (inFlight_ > 0)
+            bytesConfirmed += processCompletion(); //throw SysError
+        return bytesConfirmed;
+    }
+
+    uint64_t getStreamPosition() const { return nextOffset_; }
+
+private:
+    struct Slot
+    {
+        std::vector<std::byte> buf;
+        uint64_t offset = 0;
+        size_t len = 0;
+        bool pending = false;
+    };
+
+    size_t processCompletion() //throw SysError
+    {
+        const io_uring_cqe cqe = ring_->waitCompletion(); //throw SysError
+        Slot& slot = slots_[cqe.user_data];
+        assert(slot.pending);
+        slot.pending = false;
+        --inFlight_;
+
+        if (cqe.res < 0)
+        {
+            errno = -cqe.res;
+            THROW_LAST_SYS_ERROR("io_uring(IORING_OP_WRITE)");
+        }
+        size_t bytesWritten = cqe.res;
+        if (bytesWritten > slot.len) //better safe than sorry
+            throw SysError(formatSystemError("io_uring(IORING_OP_WRITE)", L"", L"Buffer overflow."));
+
+        while (bytesWritten < slot.len) //short write
+        {
+            ssize_t rv = 0;
+            do
+            {
+                rv = ::pwrite(fd_, &slot.buf[bytesWritten], slot.len - bytesWritten, slot.offset + bytesWritten);
+            }
+            while (rv < 0 && errno == EINTR);
+
+            if (rv <= 0)
+            {
+                if (rv == 0) //comment in safe-read.c suggests to treat this as an error due to buggy drivers
+                    errno = ENOSPC;
+                THROW_LAST_SYS_ERROR("pwrite");
+            }
+            bytesWritten += rv;
+        }
+        return bytesWritten;
+    }
+
+    std::unique_ptr<IoUring> ring_;
+    const int fd_;
+    const size_t blockSize_;
+    uint64_t nextOffset_;
+    std::array<Slot, IO_URING_QUEUE_DEPTH> slots_;
+    size_t inFlight_ = 0;
+};
+
+
+namespace
+{
+const size_t IO_BLOCK_SIZE_MAX = 1024 * 1024; //st_blksize may be anything: e.g. 2 GB reported by some FUSE file systems
+
+size_t getPreferredBlockSize(FileBase::FileHandle handle)
+{
+    struct stat fileInfo = {};
+    if (::fstat(handle, &fileInfo) == 0 &&
+        static_cast<size_t>(fileInfo.st_blksize) > FileBase::getDefaultBlockSize())
+        //multiple of default: see IoUringReader short read handling, tryRead()
+        return std::min(static_cast<size_t>(fileInfo.st_blksize) / FileBase::getDefaultBlockSize() * FileBase::getDefaultBlockSize(), IO_BLOCK_SIZE_MAX);
+
+    return FileBase::getDefaultBlockSize();
+}
+
+
+const size_t IO_BUFFER_CACHE_BYTES_MAX = 4 * 1024 * 1024; //per thread: e.g. FileInput + FileOutput + io_uring slots of one file copy
+
+struct IoBufferCache
+{
+    ~IoBufferCache() { addMemoryUsage("I/O buffers", -static_cast<int64_t>(bytesTotal)); } //thread exit
+
+    std::vector<std::vector<std::byte>> buffers; //most recently released last
+    size_t bytesTotal = 0;
+};
+thread_local IoBufferCache ioBufferCache;
+}
+
+
+std::vector<std::byte> zen::getIoBuffer(size_t size)
+{
+    IoBufferCache& cache = ioBufferCache;
+
+    //most recently used first: probably still in CPU cache
+    for (auto it = cache.buffers.end(); it != cache.buffers.begin();)
+        if ((--it)->size() == size)
+        {
+            std::vector<std::byte> buf = std::move(*it);
+            cache.buffers.erase(it);
+            cache.bytesTotal -= size;
+            return buf;
+        }
+
+    addMemoryUsage("I/O buffers", static_cast<int64_t>(size)); //memory accounting: buffers in use + cached
+    return std::vector<std::byte>(size);
+}
+
+
+void zen::releaseIoBuffer(std::vector<std::byte>&& buf) //noexcept
+{
+    if (buf.empty())
+        return;
+
+    const int64_t bufSize = static_cast<int64_t>(buf.size());
+    if (buf.size() > IO_BUFFER_CACHE_BYTES_MAX)
+    {
+        addMemoryUsage("I/O buffers", -bufSize);
+        return;
+    }
+
+    IoBufferCache& cache = ioBufferCache;
+    try
+    {
+        while (cache.bytesTotal + buf.size() > IO_BUFFER_CACHE_BYTES_MAX) //evict least recently used
+        {
+            addMemoryUsage("I/O buffers", -static_cast<int64_t>(cache.buffers.front().size()));
+            cache.bytesTotal -= cache.buffers.front().size();
+            cache.buffers.erase(cache.buffers.begin());
+        }
+        cache.buffers.push_back(std::move(buf));
+        cache.bytesTotal += cache.buffers.back().size();
+    }
+    catch (const std::bad_alloc&) { addMemoryUsage("I/O buffers", -bufSize); } //just an optimization
+}
+
+
+void zen::adviseWillNeed(const Zstring& filePath, uint64_t byteCount) //noexcept
+{
+    const int fd = openNoAtime(filePath, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return; //the copy will report real errors
+    ZEN_ON_SCOPE_EXIT(::close(fd));
+
+    ::posix_fadvise(fd, 0, static_cast<off_t>(byteCount), POSIX_FADV_WILLNEED); //queues the reads, doesn't wait for them; page cache survives close()
+}
+
+
+FileBase::FileBase(FileHandle handle, const Zstring& filePath) :
+    hFile_(handle),
+    filePath_(filePath),
+    blockSize_(getPreferredBlockSize(handle)) {}
+
+
 FileBase::~FileBase()
 {
     if (hFile_ != invalidFileHandle)
@@ -66,7 +629,7 @@ FileBase::FileHandle openHandleForRead(const Zstring& filePath) //throw FileErro
     //else: let ::open() fail for errors like "not existing"
 
     //don't use O_DIRECT: https://yarchive.net/comp/linux/o_direct.html
-    const int fdFile = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    const int fdFile = openNoAtime(filePath, O_RDONLY | O_CLOEXEC); //compare by content, copy: don't write the source's inode
     if (fdFile == -1) //don't check "< 0" -> docu seems to allow "-2" to be a valid file handle
         THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot open file %x."), L"%x", fmtPath(filePath)), "open");
     return fdFile; //pass ownership
@@ -75,7 +638,18 @@ FileBase::FileHandle openHandleForRead(const Zstring& filePath) //throw FileErro
 
 
 FileInput::FileInput(FileHandle handle, const Zstring& filePath, const IoCallback& notifyUnbufferedIO) :
-    FileBase(handle, filePath), notifyUnbufferedIO_(notifyUnbufferedIO) {}
+    FileBase(handle, filePath), notifyUnbufferedIO_(notifyUnbufferedIO)
+{
+    if (cacheNeutral_)
+        cacheDroppedPos_ = streamPos_ = getStreamPosition(handle).value_or(0);
+}
+
+
+FileInput::~FileInput() //IoUringReader is incomplete in header
+{
+    ioUringReader_.reset(); //wait for requests in flight *before* recycling buffers
+    releaseIoBuffer(std::move(memBuf_));
+}
 
 
 FileInput::FileInput(const Zstring& filePath, const IoCallback& notifyUnbufferedIO) :
@@ -115,6 +689,47 @@ size_t FileInput::tryRead(void* buffer, size_t bytesToRead) //throw FileError, E
 }
 
 
+size_t FileInput::readBlock() //throw FileError, ErrorFileLocked; may return short, only 0 means EOF!
+{
+    const size_t blockSize = getBlockSize();
+
+    //start asynchronous I/O only after the first block: don't waste a ring setup on small files
+    if (firstBlockRead_ && !ioUringReader_)
+        if (std::unique_ptr<IoUring> ring = tryCreateIoUring())
+            if (const std::optional<uint64_t> streamPos = getStreamPosition(getHandle()))
+                ioUringReader_ = std::make_unique<IoUringReader>(std::move(ring), getHandle(), *streamPos, blockSize);
+    firstBlockRead_ = true;
+
+    size_t bytesRead = 0;
+    if (ioUringReader_)
+        try
+        {
+            bytesRead = ioUringReader_->readBlock(memBuf_); //throw SysError
+        }
+        catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getFilePath())), e.toString()); }
+    else
+        bytesRead = tryRead(&memBuf_[0], blockSize); //throw FileError, ErrorFileLocked; may return short, only 0 means EOF! => CONTRACT: bytesToRead > 0
+
+    if (cacheNeutral_)
+    {
+        streamPos_ += bytesRead;
+        if (bytesRead == 0 || streamPos_ - cacheDroppedPos_ >= CACHE_DROP_BEHIND_INTERVAL)
+            dropCacheBehind(streamPos_);
+    }
+    return bytesRead;
+}
+
+
+void FileInput::dropCacheBehind(uint64_t streamPos)
+{
+    if (cacheNeutral_ && streamPos > cacheDroppedPos_)
+    {
+        dropCachedPages(getHandle(), cacheDroppedPos_, streamPos - cacheDroppedPos_); //pages just read are clean => dropped right away
+        cacheDroppedPos_ = streamPos;
+    }
+}
+
+
 size_t FileInput::read(void* buffer, size_t bytesToRead) //throw FileError, ErrorFileLocked, X; return "bytesToRead" bytes unless end of stream!
 {
     /*
@@ -130,8 +745,7 @@ size_t FileInput::read(void* buffer, size_t bytesToRead) //throw FileError, Erro
             - replacing std::copy() with memcpy() also *seems* to have improved speed "somewhat"
     */
 
-    const size_t blockSize = getBlockSize();
-    assert(memBuf_.size() >= blockSize);
+    assert(memBuf_.size() >= getBlockSize());
     assert(bufPos_ <= bufPosEnd_ && bufPosEnd_ <= memBuf_.size());
 
     auto       it    = static_cast<std::byte*>(buffer);
@@ -146,7 +760,7 @@ size_t FileInput::read(void* buffer, size_t bytesToRead) //throw FileError, Erro
         if (it == itEnd)
             break;
         //--------------------------------------------------------------------
-        const size_t bytesRead = tryRead(&memBuf_[0], blockSize); //throw FileError, ErrorFileLocked; may return short, only 0 means EOF! => CONTRACT: bytesToRead > 0
+        const size_t bytesRead = readBlock(); //throw FileError, ErrorFileLocked; may return short, only 0 means EOF!
         bufPos_ = 0;
         bufPosEnd_ = bytesRead;
 
@@ -158,6 +772,35 @@ size_t FileInput::read(void* buffer, size_t bytesToRead) //throw FileError, Erro
     return it - static_cast<std::byte*>(buffer);
 }
 
+
+size_t FileInput::readAt(uint64_t offset, void* buffer, size_t bytesToRead) //throw FileError, X; return "bytesToRead" bytes unless end of stream!
+{
+    assert(!ioUringReader_); //don't mix with read()
+
+    size_t bytesReadTotal = 0;
+    while (bytesReadTotal < bytesToRead)
+    {
+        ssize_t bytesRead = 0;
+        do
+        {
+            bytesRead = ::pread(getHandle(), static_cast<std::byte*>(buffer) + bytesReadTotal, bytesToRead - bytesReadTotal, offset + bytesReadTotal);
+        }
+        while (bytesRead < 0 && errno == EINTR);
+
+        if (bytesRead < 0)
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getFilePath())), "pread");
+        if (static_cast<size_t>(bytesRead) > bytesToRead - bytesReadTotal) //better safe than sorry
+            throw FileError(replaceCpy(_("Cannot read file %x."), L"%x", fmtPath(getFilePath())), formatSystemError("pread", L"", L"Buffer overflow."));
+
+        if (notifyUnbufferedIO_) notifyUnbufferedIO_(bytesRead); //throw X
+
+        if (bytesRead == 0) //end of file
+            break;
+        bytesReadTotal += bytesRead;
+    }
+    return bytesReadTotal;
+}
+
 //----------------------------------------------------------------------------------------------------
 
 namespace
@@ -193,6 +836,8 @@ FileBase::FileHandle openHandleForWrite(const Zstring& filePath) //throw FileErr
 FileOutput::FileOutput(FileHandle handle, const Zstring& filePath, const IoCallback& notifyUnbufferedIO) :
     FileBase(handle, filePath), notifyUnbufferedIO_(notifyUnbufferedIO)
 {
+    if (cacheNeutral_)
+        cacheDroppedPos_ = cacheWritebackPos_ = streamPos_ = getStreamPosition(handle).value_or(0);
 }
 
 
@@ -202,6 +847,8 @@ FileOutput::FileOutput(const Zstring& filePath, const IoCallback& notifyUnbuffer
 
 FileOutput::~FileOutput()
 {
+    ioUringWriter_.reset(); //wait for requests in flight *before* deleting the file
+    releaseIoBuffer(std::move(memBuf_));
 
     if (getHandle() != invalidFileHandle) //not finalized => clean up garbage
     {
@@ -267,22 +914,105 @@ void FileOutput::write(const void* buffer, size_t bytesToWrite) //throw FileErro
         if (it == itEnd)
             return;
         //--------------------------------------------------------------------
+        if (tryWriteAsync(blockSize)) //throw FileError, X
+            continue;
+
         const size_t bytesWritten = tryWrite(&memBuf_[bufPos_], blockSize); //throw FileError; may return short! CONTRACT: bytesToWrite > 0
         bufPos_ += bytesWritten;
-        if (notifyUnbufferedIO_) notifyUnbufferedIO_(bytesWritten); //throw X!
+        reportBytesWritten(bytesWritten); //throw X!
     }
 }
 
 
+void FileOutput::reportBytesWritten(size_t bytesWritten) //throw X
+{
+    if (cacheNeutral_)
+    {
+        streamPos_ += bytesWritten;
+        if (streamPos_ - cacheWritebackPos_ >= CACHE_DROP_BEHIND_INTERVAL)
+            dropCacheBehind(streamPos_);
+    }
+    if (notifyUnbufferedIO_ && bytesWritten != 0) notifyUnbufferedIO_(bytesWritten); //throw X!
+}
+
+
+void FileOutput::dropCacheBehind(uint64_t streamPos)
+{
+    if (!cacheNeutral_ || streamPos <= cacheWritebackPos_)
+        return;
+    streamPos_ = std::max(streamPos_, streamPos); //data written bypassing write(), e.g. copy_file_range()
+
+    //"advice" only => ignore errors; caveat: nbytes == 0 means "until end of file"
+    //1. start asynchronous write-back of the new interval
+    ::sync_file_range(getHandle(), cacheWritebackPos_, streamPos - cacheWritebackPos_, SYNC_FILE_RANGE_WRITE);
+
+    //2. previous interval has had time to be written back: wait for completion (no disk cache flush!) => clean pages can be dropped
+    if (cacheWritebackPos_ > cacheDroppedPos_)
+    {
+        ::sync_file_range(getHandle(), cacheDroppedPos_, cacheWritebackPos_ - cacheDroppedPos_,
+                          SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+        dropCachedPages(getHandle(), cacheDroppedPos_, cacheWritebackPos_ - cacheDroppedPos_);
+    }
+    cacheDroppedPos_   = cacheWritebackPos_;
+    cacheWritebackPos_ = streamPos;
+}
+
+
+bool FileOutput::tryWriteAsync(size_t bytesToWrite) //throw FileError, X
+{
+    if (!ioUringChecked_ && bufPos_ == 0) //start asynchronous I/O only when there's at least one full block (=> don't waste a ring setup on small files)
+    {
+        ioUringChecked_ = true;
+        if (bytesToWrite == getBlockSize())
+            if (std::unique_ptr<IoUring> ring = tryCreateIoUring())
+                if (const std::optional<uint64_t> streamPos = getStreamPosition(getHandle()))
+                    ioUringWriter_ = std::make_unique<IoUringWriter>(std::move(ring), getHandle(), *streamPos, getBlockSize());
+    }
+    if (!ioUringWriter_)
+        return false;
+
+    assert(bufPos_ == 0 && bufPosEnd_ == bytesToWrite);
+    size_t bytesConfirmed = 0;
+    try
+    {
+        bytesConfirmed = ioUringWriter_->write(memBuf_, bytesToWrite); //throw SysError
+    }
+    catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(getFilePath())), e.toString()); }
+
+    bufPosEnd_ = 0;
+    reportBytesWritten(bytesConfirmed); //throw X!
+    return true;
+}
+
+
 void FileOutput::flushBuffers() //throw FileError, X
 {
     assert(bufPosEnd_ - bufPos_ <= getBlockSize());
     assert(bufPos_ <= bufPosEnd_ && bufPosEnd_ <= memBuf_.size());
+    if (ioUringWriter_)
+    {
+        if (bufPos_ != bufPosEnd_)
+            tryWriteAsync(bufPosEnd_ - bufPos_); //throw FileError, X
+
+        size_t bytesConfirmed = 0;
+        try
+        {
+            bytesConfirmed = ioUringWriter_->flush(); //throw SysError
+            //file offset of the handle was not updated by positional writes => keep it in sync for users of getHandle()
+            if (::lseek(getHandle(), ioUringWriter_->getStreamPosition(), SEEK_SET) < 0)
+                THROW_LAST_SYS_ERROR("lseek");
+        }
+        catch (const SysError& e) { throw FileError(replaceCpy(_("Cannot write file %x."), L"%x", fmtPath(getFilePath())), e.toString()); }
+
+        reportBytesWritten(bytesConfirmed); //throw X!
+        return;
+    }
+
     while (bufPos_ != bufPosEnd_)
     {
         const size_t bytesWritten = tryWrite(&memBuf_[bufPos_], bufPosEnd_ - bufPos_); //throw FileError; may return short! CONTRACT: bytesToWrite > 0
         bufPos_ += bytesWritten;
-        if (notifyUnbufferedIO_) notifyUnbufferedIO_(bytesWritten); //throw X!
+        reportBytesWritten(bytesWritten); //throw X!
     }
 }
 
@@ -290,6 +1020,12 @@ void FileOutput::flushBuffers() //throw FileError, X
 void FileOutput::finalize() //throw FileError, X
 {
     flushBuffers(); //throw FileError, X
+
+    if (cacheNeutral_) //start write-back of the tail + drop what's clean already: don't wait (unlike fsync())
+    {
+        dropCacheBehind(streamPos_);
+        dropCachedPages(getHandle(), 0, streamPos_);
+    }
     close();        //throw FileError
     //~FileBase() calls this one, too, but we want to propagate errors if any
 }
@@ -23,6 +23,39 @@ namespace zen
     - better error reporting
     - long path support
     - follows symlinks                     */
+enum class FileIoMode
+{
+    synchronous, //one read()/write() at a time
+    ioUring,     //asynchronous: keep several requests in flight per stream (Linux 5.6+); falls back to synchronous I/O if not available
+};
+//process-wide setting for all FileInput/FileOutput streams created afterwards
+void setFileIoMode(FileIoMode mode);
+FileIoMode getFileIoMode();
+
+/* cache-neutral streaming (bulk copies): drop pages behind the read/write position => don't evict the page cache of other applications
+    - input: clean pages => POSIX_FADV_DONTNEED
+    - output: start write-back via sync_file_range(), wait for the *previous* interval only, then POSIX_FADV_DONTNEED
+    - no O_DIRECT: https://yarchive.net/comp/linux/o_direct.html                                                        */
+//process-wide setting for all FileInput/FileOutput streams created afterwards
+void setFileCacheNeutral(bool enabled);
+bool getFileCacheNeutral();
+
+
+/* bounded thread-local cache of I/O buffers: streams (FileInput/FileOutput, io_uring slots, SFTP) take their block buffers from here and give them back when done
+    => copying many small files doesn't allocate (+ mmap(), zero-fill, munmap()) new buffers for each stream
+    - recycled by exact size only; content is undefined
+    - no page alignment needed: no O_DIRECT (see openHandleForRead())           */
+std::vector<std::byte> getIoBuffer(size_t size);
+void releaseIoBuffer(std::vector<std::byte>&& buf); //noexcept
+
+//start asynchronous read-ahead of the first "byteCount" bytes into the page cache (local and NFS/CIFS mounts) => open() + first read() of a later copy don't wait
+void adviseWillNeed(const Zstring& filePath, uint64_t byteCount); //noexcept, best effort: blocks only for open()
+
+
+class IoUringReader;
+class IoUringWriter;
+//-----------------------------------------------------------------------------------------------
+
 class FileBase
 {
 public:
@@ -32,13 +65,15 @@ public:
     FileHandle getHandle() { return hFile_; }
 
     //Windows: use 64kB ?? https://docs.microsoft.com/en-us/previous-versions/windows/it-pro/windows-2000-server/cc938632%28v=technet.10%29
-    //macOS, Linux: use st_blksize?
-    static size_t getBlockSize() { return 128 * 1024; };
+    static size_t getDefaultBlockSize() { return 128 * 1024; };
+
+    //per device: st_blksize if larger than default, e.g. NFS/SMB (rsize/wsize: up to 1 MB) => fewer round trips; local file systems: 4 kB => default
+    size_t getBlockSize() const { return blockSize_; }
 
     const Zstring& getFilePath() const { return filePath_; }
 
 protected:
-    FileBase(FileHandle handle, const Zstring& filePath) : hFile_(handle), filePath_(filePath) {}
+    FileBase(FileHandle handle, const Zstring& filePath);
     ~FileBase();
 
     void close(); //throw FileError -> optional, but good place to catch errors when closing stream!
@@ -49,6 +84,7 @@ private:
 
     FileHandle hFile_ = invalidFileHandle;
     const Zstring filePath_;
+    const size_t blockSize_;
 };
 
 //-----------------------------------------------------------------------------------------------
@@ -58,17 +94,32 @@ class FileInput : public FileBase
 public:
     FileInput(                   const Zstring& filePath, const IoCallback& notifyUnbufferedIO /*throw X*/); //throw FileError, ErrorFileLocked
     FileInput(FileHandle handle, const Zstring& filePath, const IoCallback& notifyUnbufferedIO /*throw X*/); //takes ownership!
+    ~FileInput();
 
     size_t read(void* buffer, size_t bytesToRead); //throw FileError, ErrorFileLocked, X; return "bytesToRead" bytes unless end of stream!
 
+    //positional read: independent from read() stream position; don't mix both on the same stream
+    size_t readAt(uint64_t offset, void* buffer, size_t bytesToRead); //throw FileError, X; return "bytesToRead" bytes unless end of stream!
+
+    //cache-neutral mode: release page cache before "streamPos" (e.g. after copy_file_range() bypassing read()); noexcept
+    void dropCacheBehind(uint64_t streamPos);
+
 private:
     size_t tryRead(void* buffer, size_t bytesToRead); //throw FileError, ErrorFileLocked; may return short, only 0 means EOF! =>  CONTRACT: bytesToRead > 0!
+    size_t readBlock(); //throw FileError, ErrorFileLocked; fill memBuf_; may return short, only 0 means EOF!
 
     const IoCallback notifyUnbufferedIO_; //throw X
 
-    std::vector<std::byte> memBuf_ = std::vector<std::byte>(getBlockSize());
+    std::vector<std::byte> memBuf_ = getIoBuffer(getBlockSize());
     size_t bufPos_   = 0;
     size_t bufPosEnd_= 0;
+
+    bool firstBlockRead_ = false;
+    std::unique_ptr<IoUringReader> ioUringReader_; //optional; destroy *before* memBuf_ and file handle!
+
+    const bool cacheNeutral_ = getFileCacheNeutral();
+    uint64_t streamPos_ = 0; //only maintained for cacheNeutral_
+    uint64_t cacheDroppedPos_ = 0;
 };
 
 
@@ -87,13 +138,27 @@ public:
 
     void finalize(); /*= flushBuffers() + close()*/      //throw FileError, X
 
+    //cache-neutral mode: release page cache before "streamPos" (e.g. after copy_file_range() bypassing write()); noexcept
+    void dropCacheBehind(uint64_t streamPos);
+
 private:
     size_t tryWrite(const void* buffer, size_t bytesToWrite); //throw FileError; may return short! CONTRACT: bytesToWrite > 0
+    bool tryWriteAsync(size_t bytesToWrite); //throw FileError, X; write memBuf_[0, bytesToWrite) if asynchronous I/O is active
 
     IoCallback notifyUnbufferedIO_; //throw X
-    std::vector<std::byte> memBuf_ = std::vector<std::byte>(getBlockSize());
+    std::vector<std::byte> memBuf_ = getIoBuffer(getBlockSize());
     size_t bufPos_    = 0;
     size_t bufPosEnd_ = 0;
+
+    bool ioUringChecked_ = false;
+    std::unique_ptr<IoUringWriter> ioUringWriter_; //optional; destroy *before* memBuf_ and file handle!
+
+    void reportBytesWritten(size_t bytesWritten); //throw X
+
+    const bool cacheNeutral_ = getFileCacheNeutral();
+    uint64_t streamPos_ = 0; //only maintained for cacheNeutral_
+    uint64_t cacheWritebackPos_ = 0; //write-back started for [cacheDroppedPos_, cacheWritebackPos_)
+    uint64_t cacheDroppedPos_ = 0;
 };
 //-----------------------------------------------------------------------------------------------
 //native stream I/O convenience functions:
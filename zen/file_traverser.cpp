@@ -6,80 +6,202 @@
 
 #include "file_traverser.h"
 #include "file_error.h"
+#include "file_access.h"
+#include <algorithm>
 
 
     #include <sys/stat.h>
+    #include <sys/syscall.h> //SYS_getdents64
     #include <dirent.h>
+    #include <fcntl.h>  //open, AT_SYMLINK_NOFOLLOW
+    #include <unistd.h> //close
 
 using namespace zen;
 
 
-void zen::traverseFolder(const Zstring& dirPath,
-                         const std::function<void (const FileInfo&    fi)>& onFile,
-                         const std::function<void (const FolderInfo&  fi)>& onFolder,
-                         const std::function<void (const SymlinkInfo& si)>& onSymlink,
-                         const std::function<void (const std::wstring& errorMsg)>& onError)
+std::vector<DirEntryDetails> zen::getDirContentDetailed(const Zstring& dirPath, bool statFiles, bool statSymlinks, bool statInodeOrder) //throw FileError
 {
-    try
+    const int dirFd = openNoAtime(dirPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC); //getdents64() updates the folder's atime, too
+    if (dirFd == -1)
+        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot open directory %x."), L"%x", fmtPath(dirPath)), "open");
+    ZEN_ON_SCOPE_EXIT(::close(dirFd));
+
+    //glibc's readdir() uses a 32 kB buffer => larger batches for huge folders (and network file systems!)
+    std::vector<std::byte> buf(256 * 1024);
+
+    std::vector<DirEntryDetails> output;
+    std::vector<std::pair<uint64_t /*d_ino*/, size_t /*output index*/>> pendingStat;
+
+    auto statItem = [&](DirEntryDetails& de)
     {
-        DIR* folder = ::opendir(dirPath.c_str()); //directory must NOT end with path separator, except "/"
-        if (!folder)
-            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot open directory %x."), L"%x", fmtPath(dirPath)), "opendir");
-        ZEN_ON_SCOPE_EXIT(::closedir(folder)); //never close nullptr handles! -> crash
+        struct statx sx = {};
+        if (::statx(dirFd, de.itemName.c_str(), AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT, //statx() does not resolve symlinks
+                    STATX_TYPE | STATX_SIZE | STATX_MTIME | STATX_INO | STATX_NLINK, &sx) == 0) //requesting less => file system may skip work (e.g. network round trips)
+        {
+            de.type = S_ISLNK(sx.stx_mode) ? DirEntryDetails::Type::symlink : //on Linux there is no distinction between file and directory symlinks!
+                      S_ISDIR(sx.stx_mode) ? DirEntryDetails::Type::folder : DirEntryDetails::Type::file;
+            de.haveDetails = true;
+            de.fileSize  = sx.stx_size;
+            de.modTime   = sx.stx_mtime.tv_sec;
+            de.fileIndex = sx.stx_ino;
+            de.linkCount = sx.stx_mask & STATX_NLINK ? sx.stx_nlink : 0;
+        }
+        //else: let caller report error (e.g. item deleted in the meantime)
+    };
 
-        for (;;)
+    for (;;)
+    {
+        long bytesRead = 0;
+        do
         {
-            errno = 0;
-            const dirent* dirEntry = ::readdir(folder); //don't use readdir_r(), see comment in native.cpp
-            if (!dirEntry)
-            {
-                if (errno == 0) //errno left unchanged => no more items
-                    return;
+            bytesRead = ::syscall(SYS_getdents64, dirFd, &buf[0], buf.size()); //no glibc wrapper before 2.30
+        }
+        while (bytesRead < 0 && errno == EINTR);
 
-                THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read directory %x."), L"%x", fmtPath(dirPath)), "readdir");
-                //don't retry but restart dir traversal on error! https://devblogs.microsoft.com/oldnewthing/20140612-00/?p=753/
-            }
+        if (bytesRead < 0)
+            THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read directory %x."), L"%x", fmtPath(dirPath)), "getdents64");
+        //don't retry but restart dir traversal on error! https://devblogs.microsoft.com/oldnewthing/20140612-00/?p=753/
 
-            //don't return "." and ".."
-            const char* itemNameRaw = dirEntry->d_name;
+        if (bytesRead == 0) //no more items
+        {
+            //rotational media: inode tables are laid out in inode number order (ext4, XFS) => stat in this order instead of name hash order to avoid seeking
+            std::sort(pendingStat.begin(), pendingStat.end());
+
+            for (const auto& [inode, idx] : pendingStat)
+                statItem(output[idx]);
+            return output;
+        }
 
+        for (long pos = 0; pos < bytesRead;)
+        {
+            //struct linux_dirent64 is not exported by glibc headers, but layout is stable kernel ABI:
+            struct LinuxDirent64
+            {
+                uint64_t       d_ino;
+                int64_t        d_off;
+                unsigned short d_reclen;
+                unsigned char  d_type;
+                char           d_name[1]; //null-terminated
+            };
+            const auto& dirEntry = *reinterpret_cast<const LinuxDirent64*>(&buf[pos]);
+            pos += dirEntry.d_reclen;
+
+            const char* itemNameRaw = dirEntry.d_name;
+
+            //skip "." and ".."
             if (itemNameRaw[0] == '.' &&
                 (itemNameRaw[1] == 0 || (itemNameRaw[1] == '.' && itemNameRaw[2] == 0)))
                 continue;
 
-            const Zstring& itemName = itemNameRaw;
-            if (itemName.empty()) //checks result of normalizeUtfForPosix, too!
-                throw FileError(replaceCpy(_("Cannot read directory %x."), L"%x", fmtPath(dirPath)), formatSystemError("readdir", L"", L"Folder contains an item without name."));
+            if (itemNameRaw[0] == 0) //show error instead of endless recursion!!!
+                throw FileError(replaceCpy(_("Cannot read directory %x."), L"%x", fmtPath(dirPath)), formatSystemError("getdents64", L"", L"Folder contains an item without name."));
 
-            const Zstring& itemPath = appendSeparator(dirPath) + itemName;
+            DirEntryDetails& de = output.emplace_back();
+            de.itemName = itemNameRaw;
 
-            struct stat statData = {};
-            try
-            {
-                if (::lstat(itemPath.c_str(), &statData) != 0) //lstat() does not resolve symlinks
-                    THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(itemPath)), "lstat");
-            }
-            catch (const FileError& e)
-            {
-                if (onError)
-                    onError(e.toString());
-                continue; //ignore error: skip file
-            }
+            /* Unicode normalization is file-system-dependent:
 
-            if (S_ISLNK(statData.st_mode)) //on Linux there is no distinction between file and directory symlinks!
-            {
-                if (onSymlink)
-                    onSymlink({ itemName, itemPath, statData.st_mtime});
-            }
-            else if (S_ISDIR(statData.st_mode)) //a directory
+                   OS                 Accepts   Gives back
+                   ----------         -------   ----------
+                   macOS (HFS+)         all        NFD
+                   Linux                all      <input>
+                   Windows (NTFS, FAT)  all      <input>
+
+                some file systems return precomposed others decomposed UTF8: https://developer.apple.com/library/archive/qa/qa1173/_index.html
+                      - OS X edit controls and text fields may return precomposed UTF as directly received by keyboard or decomposed UTF that was copy & pasted!
+                      - Posix APIs require decomposed form: https://freefilesync.org/forum/viewtopic.php?t=2480
+
+                => General recommendation: always preserve input UNCHANGED (both unicode normalization and case sensitivity)
+                => normalize only when needed during string comparison
+
+                Create sample files on Linux: touch  decomposed-$'\x6f\xcc\x81'.txt
+                                              touch precomposed-$'\xc3\xb3'.txt
+
+                - list file name hex chars in terminal:  ls | od -c -t x1
+
+                - SMB sharing case-sensitive or NFD file names is fundamentally broken on macOS:
+                    => the macOS SMB manager internally buffers file names as case-insensitive and NFC (= just like NTFS on Windows)
+                    => test: create SMB share from Linux => *boom* on macOS: "Error Code 2: No such file or directory [lstat]"
+                        or WORSE: folders "test" and "Test" *both* incorrectly return the content of one of the two
+                    => Update 2020-04-24: converting to NFC doesn't help: both NFD/NFC forms fail(ENOENT) lstat in FFS, AS WELL AS IN FINDER => macOS bug!         */
+
+            bool needStat = true;
+            switch (dirEntry.d_type)
             {
-                if (onFolder)
-                    onFolder({itemName, itemPath});
+                case DT_DIR:
+                    de.type = DirEntryDetails::Type::folder;
+                    needStat = false; //no attributes needed for folders
+                    break;
+                case DT_LNK:
+                    de.type = DirEntryDetails::Type::symlink;
+                    needStat = statSymlinks;
+                    break;
+                case DT_UNKNOWN: //file system doesn't support d_type: e.g. some network file systems
+                    break;
+                default: //a file or named pipe, etc.
+                    de.type = DirEntryDetails::Type::file;
+                    needStat = statFiles;
+                    break;
             }
-            else //a file or named pipe, etc.
+
+            if (!needStat)
+                de.haveDetails = true;
+            else if (statInodeOrder)
+                pendingStat.emplace_back(dirEntry.d_ino, output.size() - 1);
+            else
+                statItem(de);
+        }
+    }
+}
+
+
+void zen::traverseFolder(const Zstring& dirPath,
+                         const std::function<void (const FileInfo&    fi)>& onFile,
+                         const std::function<void (const FolderInfo&  fi)>& onFolder,
+                         const std::function<void (const SymlinkInfo& si)>& onSymlink,
+                         const std::function<void (const std::wstring& errorMsg)>& onError)
+{
+    try
+    {
+        for (DirEntryDetails& de : getDirContentDetailed(dirPath, static_cast<bool>(onFile), static_cast<bool>(onSymlink), false /*statInodeOrder*/)) //throw FileError
+        {
+            const Zstring& itemPath = appendSeparator(dirPath) + de.itemName;
+
+            if (!de.haveDetails)
+                try
+                {
+                    struct stat statData = {};
+                    if (::lstat(itemPath.c_str(), &statData) != 0) //lstat() does not resolve symlinks
+                        THROW_LAST_FILE_ERROR(replaceCpy(_("Cannot read file attributes of %x."), L"%x", fmtPath(itemPath)), "lstat");
+
+                    de.type = S_ISLNK(statData.st_mode) ? DirEntryDetails::Type::symlink :
+                              S_ISDIR(statData.st_mode) ? DirEntryDetails::Type::folder : DirEntryDetails::Type::file;
+                    de.fileSize = makeUnsigned(statData.st_size);
+                    de.modTime  = statData.st_mtime;
+                }
+                catch (const FileError& e)
+                {
+                    if (onError)
+                        onError(e.toString());
+                    continue; //ignore error: skip file
+                }
+
+            switch (de.type)
             {
-                if (onFile)
-                    onFile({itemName, itemPath, makeUnsigned(statData.st_size), statData.st_mtime});
+                case DirEntryDetails::Type::symlink: //on Linux there is no distinction between file and directory symlinks!
+                    if (onSymlink)
+                        onSymlink({de.itemName, itemPath, de.modTime});
+                    break;
+
+                case DirEntryDetails::Type::folder:
+                    if (onFolder)
+                        onFolder({de.itemName, itemPath});
+                    break;
+
+                case DirEntryDetails::Type::file: //a file or named pipe, etc.
+                    if (onFile)
+                        onFile({de.itemName, itemPath, de.fileSize, de.modTime});
+                    break;
             }
 
             /* It may be a good idea to not check "S_ISREG(statData.st_mode)" explicitly and to not issue an error message on other types to support these scenarios:
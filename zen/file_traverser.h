@@ -8,6 +8,7 @@
 #define FILER_TRAVERSER_H_127463214871234
 
 #include <cstdint>
+#include <vector>
 #include <functional>
 #include "zstring.h"
 
@@ -37,11 +38,35 @@ struct SymlinkInfo
 
 //- non-recursive
 //- directory path may end with PATH_SEPARATOR
+//- stat() calls are skipped if not needed: e.g. onFile == nullptr
 void traverseFolder(const Zstring& dirPath, //noexcept
                     const std::function<void (const FileInfo&    fi)>& onFile,          //
                     const std::function<void (const FolderInfo&  fi)>& onFolder,        //optional
                     const std::function<void (const SymlinkInfo& si)>& onSymlink,       //
                     const std::function<void (const std::wstring& errorMsg)>& onError); //
+
+
+/* low-level, non-recursive enumeration optimized for huge folders:
+    - getdents64(): read raw directory entries in large batches
+    - d_type: no stat() for folders (and for files/symlinks, too, if details are not needed)
+    - statx() relative to the directory handle, minimal mask: no full path building, no kernel path lookup per item
+    - statInodeOrder: statx() after reading the whole folder, sorted by inode number => fewer seeks on rotational media (see isRotationalDevice())  */
+struct DirEntryDetails
+{
+    Zstring itemName;
+    enum class Type
+    {
+        file, //or named pipe, etc.
+        folder,
+        symlink,
+    } type = Type::file;
+    bool haveDetails = false; //false: not requested or statx() failed (=> caller should lstat() full path for error message)
+    uint64_t fileSize = 0; //[bytes]
+    time_t   modTime = 0;  //number of seconds since Jan. 1st 1970 UTC
+    uint64_t fileIndex = 0;
+    uint32_t linkCount = 0; //number of hard links; 0 if unknown
+};
+std::vector<DirEntryDetails> getDirContentDetailed(const Zstring& dirPath, bool statFiles, bool statSymlinks, bool statInodeOrder); //throw FileError
 }
 
 #endif //FILER_TRAVERSER_H_127463214871234
@@ -8,6 +8,9 @@
 #include <ctime>
 #include <cstdio>
 #include <stdexcept>
+#include <climits>
+#include <algorithm>
+#include <vector>
 #include "basic_math.h"
 #include "sys_error.h"
 #include "i18n.h"
@@ -159,21 +162,271 @@ std::wstring zen::formatPercent0(double fraction)
 
 
 
+namespace
+{
+/*  fast paths for grid rendering: every visible cell is formatted on each paint
+    - printf("%'lld") and strftime() parse their format, query the locale and (localtime_r) the time zone for each call
+    - locale settings are re-checked per call (cheap pointer/string compares): locale is set by localization.cpp, but maybe after first use   */
+struct NumberFormat
+{
+    std::string sepUtf8;
+    std::string grouping;
+    bool groupByThree = false; //common case: every 3 digits, else (e.g. Indian "\3\2"): printf() handles it
+    std::wstring sep;
+};
+
+
+const NumberFormat& getNumberFormat()
+{
+    thread_local NumberFormat fmt{"?", "?"};
+
+    const lconv* lc = ::localeconv();
+    const char* sepUtf8  = lc && lc->thousands_sep ? lc->thousands_sep : "";
+    const char* grouping = lc && lc->grouping      ? lc->grouping      : "";
+
+    if (fmt.sepUtf8 != sepUtf8 || fmt.grouping != grouping)
+    {
+        fmt.sepUtf8  = sepUtf8;
+        fmt.grouping = grouping;
+        fmt.groupByThree = grouping[0] == 3 && (grouping[1] == 0 || (grouping[1] == 3 && grouping[2] == 0)); //last group size repeats
+        fmt.sep = utfTo<std::wstring>(fmt.sepUtf8);
+        if (grouping[0] == 0 || grouping[0] == CHAR_MAX) //no grouping
+        {
+            fmt.groupByThree = true;
+            fmt.sep.clear();
+        }
+    }
+    return fmt;
+}
+}
+
+
 std::wstring zen::formatNumber(int64_t n)
 {
     //::setlocale (LC_ALL, ""); -> see localization.cpp::wxWidgetsLocale
+    const NumberFormat& fmt = getNumberFormat();
+    if (fmt.groupByThree)
+    {
+        uint64_t absVal = n < 0 ? 0 - static_cast<uint64_t>(n) : static_cast<uint64_t>(n);
+
+        wchar_t digits[20] = {}; //max uint64_t: 18446744073709551615
+        size_t digitCount = 0;
+        do
+            digits[digitCount++] = static_cast<wchar_t>(L'0' + absVal % 10);
+        while ((absVal /= 10) != 0);
+
+        std::wstring output;
+        output.reserve(1 + digitCount + digitCount / 3 * fmt.sep.size());
+        if (n < 0)
+            output += L'-';
+        for (size_t i = digitCount; i-- > 0;)
+        {
+            output += digits[i];
+            if (i != 0 && i % 3 == 0)
+                output += fmt.sep;
+        }
+        return output;
+    }
+
     static_assert(sizeof(long long int) == sizeof(n));
     return printNumber<std::wstring>(L"%'lld", n); //considers grouping (')
 }
 
 
+namespace
+{
+class LocalTimeFormatter
+{
+public:
+    std::wstring format(time_t utcTime) //returns empty string on error
+    {
+        checkLocale();
+
+        const DayInfo* day = findDay(utcTime);
+        if (!day)
+        {
+            const TimeComp loc = getLocalTime(utcTime);
+            if (loc == TimeComp())
+                return std::wstring();
+
+            day = addDay(utcTime, loc);
+            if (!day) //e.g. day with DST switch: no fixed offset
+                return utfTo<std::wstring>(formatTime(Zstr("%x  %X"), loc));
+        }
+
+        const int secOfDay = static_cast<int>(utcTime - day->dayBegin);
+        TimeComp tc = day->dayBegin0;
+        tc.hour   = secOfDay / 3600;
+        tc.minute = secOfDay / 60 % 60;
+        tc.second = secOfDay % 60;
+
+        std::wstring output = day->dateTxt;
+        output += L"  ";
+        if (!timeTokens_.empty())
+            formatTimeFast(output, tc);
+        else
+            output += utfTo<std::wstring>(formatTime(formatTimeTag, tc));
+        return output;
+    }
+
+private:
+    struct DayInfo
+    {
+        time_t dayBegin = 0; //[dayBegin, dayBegin + 24h) with a fixed UTC offset
+        TimeComp dayBegin0;
+        std::wstring dateTxt;
+    };
+
+    enum class TimeToken
+    {
+        hour24,
+        hour12,
+        minute,
+        second,
+        amPm,
+        literal,
+    };
+
+    void checkLocale()
+    {
+        const char* dateFmt = ::nl_langinfo(D_FMT);
+        const char* timeFmt = ::nl_langinfo(T_FMT);
+        if (!dateFmt) dateFmt = "";
+        if (!timeFmt) timeFmt = "";
+
+        if (dateFmt_ == dateFmt && timeFmt_ == timeFmt && localeInit_)
+            return;
+
+        localeInit_ = true;
+        dateFmt_ = dateFmt;
+        timeFmt_ = timeFmt;
+        days_.clear();
+        compileTimeFormat();
+    }
+
+    //%X is usually "%H:%M:%S" or "%r" == "%I:%M:%S %p" => no strftime() needed per cell; anything else: fall back
+    void compileTimeFormat()
+    {
+        timeTokens_.clear();
+        literals_.clear();
+
+        std::string fmt = timeFmt_;
+        if (fmt == "%r")
+            if (const char* fmtAmPm = ::nl_langinfo(T_FMT_AMPM))
+                fmt = fmtAmPm;
+        if (fmt == "%T")
+            fmt = "%H:%M:%S";
+
+        const char* amStr = ::nl_langinfo(AM_STR);
+        const char* pmStr = ::nl_langinfo(PM_STR);
+        amTxt_ = utfTo<std::wstring>(amStr ? amStr : "");
+        pmTxt_ = utfTo<std::wstring>(pmStr ? pmStr : "");
+
+        std::vector<TimeToken> tokens;
+        std::string literal;
+        auto flushLiteral = [&]
+        {
+            if (!literal.empty())
+            {
+                tokens.push_back(TimeToken::literal);
+                literals_.push_back(utfTo<std::wstring>(literal));
+                literal.clear();
+            }
+        };
+
+        for (auto it = fmt.begin(); it != fmt.end(); ++it)
+            if (*it != '%')
+                literal += *it;
+            else
+            {
+                if (++it == fmt.end())
+                    return literals_.clear(); //unsupported
+                flushLiteral();
+                switch (*it)
+                {
+                    //*INDENT-OFF*
+                    case 'H': tokens.push_back(TimeToken::hour24); break;
+                    case 'I': tokens.push_back(TimeToken::hour12); break;
+                    case 'M': tokens.push_back(TimeToken::minute); break;
+                    case 'S': tokens.push_back(TimeToken::second); break;
+                    case 'p': tokens.push_back(TimeToken::amPm);   break;
+                    default: return literals_.clear(); //unsupported, e.g. %EX, %l, %P
+                    //*INDENT-ON*
+                }
+            }
+        flushLiteral();
+        timeTokens_ = std::move(tokens);
+    }
+
+    void formatTimeFast(std::wstring& output, const TimeComp& tc) const
+    {
+        auto appendTwoDigits = [&](int val) { output += static_cast<wchar_t>(L'0' + val / 10); output += static_cast<wchar_t>(L'0' + val % 10); };
+
+        size_t literalIdx = 0;
+        for (const TimeToken token : timeTokens_)
+            switch (token)
+            {
+                //*INDENT-OFF*
+                case TimeToken::hour24: appendTwoDigits(tc.hour); break;
+                case TimeToken::hour12: appendTwoDigits(tc.hour % 12 == 0 ? 12 : tc.hour % 12); break;
+                case TimeToken::minute: appendTwoDigits(tc.minute); break;
+                case TimeToken::second: appendTwoDigits(tc.second); break;
+                case TimeToken::amPm:   output += tc.hour < 12 ? amTxt_ : pmTxt_; break;
+                case TimeToken::literal: output += literals_[literalIdx++]; break;
+                //*INDENT-ON*
+            }
+    }
+
+    const DayInfo* findDay(time_t utcTime)
+    {
+        for (auto it = days_.begin(); it != days_.end(); ++it)
+            if (it->dayBegin <= utcTime && utcTime < it->dayBegin + 24 * 3600)
+            {
+                std::rotate(days_.begin(), it, it + 1); //LRU: move to front
+                return &days_.front();
+            }
+        return nullptr;
+    }
+
+    const DayInfo* addDay(time_t utcTime, const TimeComp& loc)
+    {
+        const time_t dayBegin = utcTime - (loc.hour * 3600 + loc.minute * 60 + loc.second);
+
+        //same date and no offset change (DST) within the whole day? also rejects leap seconds
+        if (getLocalTime(dayBegin) != TimeComp{loc.year, loc.month, loc.day, 0, 0, 0} ||
+            getLocalTime(dayBegin + 24 * 3600 - 1) != TimeComp{loc.year, loc.month, loc.day, 23, 59, 59})
+            return nullptr;
+
+        const TimeComp dayBegin0{loc.year, loc.month, loc.day, 0, 0, 0};
+        std::wstring dateTxt = utfTo<std::wstring>(formatTime(formatDateTag, dayBegin0));
+        if (dateTxt.empty())
+            return nullptr;
+
+        if (days_.size() >= 16) //grid shows a few distinct days at a time
+            days_.pop_back();
+        days_.insert(days_.begin(), {dayBegin, dayBegin0, std::move(dateTxt)});
+        return &days_.front();
+    }
+
+    bool localeInit_ = false;
+    std::string dateFmt_;
+    std::string timeFmt_;
+    std::vector<TimeToken> timeTokens_; //empty: not supported => strftime()
+    std::vector<std::wstring> literals_;
+    std::wstring amTxt_;
+    std::wstring pmTxt_;
+    std::vector<DayInfo> days_; //LRU order
+};
+}
+
+
 std::wstring zen::formatUtcToLocalTime(time_t utcTime)
 {
     auto errorMsg = [&] { return _("Error") + L" (time_t: " + numberTo<std::wstring>(utcTime) + L')'; };
 
-    const TimeComp& loc = getLocalTime(utcTime);
+    thread_local LocalTimeFormatter formatter;
 
-    std::wstring dateString = utfTo<std::wstring>(formatTime(Zstr("%x  %X"), loc));
+    std::wstring dateString = formatter.format(utcTime);
     return !dateString.empty() ? dateString : errorMsg();
 }
 
@@ -9,13 +9,76 @@
     #include <libcurl/curl_wrap.h> //DON'T include <curl/curl.h> directly!
     #include "stream_buffer.h"
     #include "thread.h"
+    #include "globals.h"
 
 using namespace zen;
 
 const int HTTP_ACCESS_TIME_OUT_SEC = 20;
 
+constexpr std::chrono::seconds HTTP_SESSION_MAX_IDLE_TIME(20); //don't reuse connections the server has likely closed already
+const size_t HTTP_SESSION_IDLE_MAX_PER_SERVER = 4;
 
 
+namespace
+{
+/*  reuse HTTP sessions for subsequent requests to the same server: e.g. redirects, OAuth token exchange followed by API calls, version check
+    => libcurl easy handle keeps the connection alive and caches the TLS session (both survive curl_easy_reset())
+    => skip TCP connect + TLS handshake (+ proxy CONNECT)       */
+class HttpSessionPool
+{
+public:
+    ~HttpSessionPool()
+    {
+        //process shutdown: libcurl may already be torn down => no curl_easy_cleanup() anymore: leak remaining handles
+        for (auto& [sessionId, sessions] : idleSessions_)
+            for (std::unique_ptr<HttpSession>& session : sessions)
+                [[maybe_unused]] HttpSession* leaked = session.release();
+    }
+
+    std::unique_ptr<HttpSession> takeSession(const Zstring& server, bool useTls, const Zstring& caCertFilePath) //throw SysError
+    {
+        {
+            std::lock_guard dummy(lockSessions_);
+
+            auto it = idleSessions_.find({server, useTls, caCertFilePath});
+            if (it != idleSessions_.end())
+                while (!it->second.empty())
+                {
+                    std::unique_ptr<HttpSession> session = std::move(it->second.back());
+                    it->second.pop_back();
+
+                    if (isHealthy(*session))
+                        return session;
+                }
+        }
+        return std::make_unique<HttpSession>(server, useTls, caCertFilePath, nullptr /*multiplexer*/); //throw SysError
+    }
+
+    //call after successful request only: connection state is undefined after errors or cancellation
+    void returnSession(const Zstring& server, bool useTls, const Zstring& caCertFilePath, std::unique_ptr<HttpSession>&& session)
+    {
+        std::lock_guard dummy(lockSessions_);
+
+        std::vector<std::unique_ptr<HttpSession>>& sessions = idleSessions_[{server, useTls, caCertFilePath}];
+        std::erase_if(sessions, [](const std::unique_ptr<HttpSession>& s) { return !isHealthy(*s); });
+
+        if (sessions.size() < HTTP_SESSION_IDLE_MAX_PER_SERVER)
+            sessions.push_back(std::move(session));
+    }
+
+private:
+    static bool isHealthy(const HttpSession& s) { return std::chrono::steady_clock::now() - s.getLastUseTime() <= HTTP_SESSION_MAX_IDLE_TIME; }
+
+    using SessionId = std::tuple<Zstring /*server*/, bool /*useTls*/, Zstring /*caCertFilePath*/>;
+
+    std::mutex lockSessions_;
+    std::map<SessionId, std::vector<std::unique_ptr<HttpSession>>> idleSessions_;
+};
+
+constinit Global<HttpSessionPool> globalHttpSessionPool;
+GLOBAL_RUN_ONCE(globalHttpSessionPool.set(std::make_unique<HttpSessionPool>()));
+}
+
 
 class HttpInputStream::Impl
 {
@@ -102,7 +165,11 @@ public:
                     }
                 };
 
-                HttpSession httpSession(server, useTls, caCertFilePath); //throw SysError
+                const std::shared_ptr<HttpSessionPool> sessionPool = globalHttpSessionPool.get();
+                if (!sessionPool)
+                    throw SysError(formatSystemError("HttpInputStream", L"", L"Function call not allowed during init/shutdown."));
+
+                std::unique_ptr<HttpSession> httpSession = sessionPool->takeSession(server, useTls, caCertFilePath); //throw SysError
 
                 auto writeResponse = [&](std::span<const char> buf)
                 {
@@ -112,16 +179,18 @@ public:
                     return asyncStreamOut->write(buf.data(), buf.size()); //throw ThreadStopRequest
                 };
 
-                httpSession.perform(serverRelPath,
-                                    curlHeaders, extraOptions,
-                                    writeResponse /*throw ThreadStopRequest*/,
-                                    nullptr /*readRequest*/,
-                                    onHeaderData /*throw SysError*/,
-                                    HTTP_ACCESS_TIME_OUT_SEC); //throw SysError, ThreadStopRequest
+                httpSession->perform(serverRelPath,
+                                     curlHeaders, extraOptions,
+                                     writeResponse /*throw ThreadStopRequest*/,
+                                     nullptr /*readRequest*/,
+                                     onHeaderData /*throw SysError*/,
+                                     HTTP_ACCESS_TIME_OUT_SEC); //throw SysError, ThreadStopRequest
 
                 if (!headerReceived)
                     throw SysError(L"HTTP response is missing header.");
 
+                sessionPool->returnSession(server, useTls, caCertFilePath, std::move(httpSession));
+
                 asyncStreamOut->closeStream();
             }
             catch (SysError&) //let ThreadStopRequest pass through!
@@ -8,6 +8,7 @@
 #define JSON_H_0187348321748321758934215734
 
 #include <zen/string_tools.h>
+#include <zen/utf.h>
 
 
 namespace zen
@@ -59,6 +60,8 @@ struct JsonParsingError
 };
 JsonValue parseJson(const std::string& stream); //throw JsonParsingError
 
+class JsonPullParser; //streaming alternative to parseJson(): no intermediate JsonValue tree
+
 
 
 //helper functions for JsonValue access:
@@ -128,7 +131,7 @@ namespace
 }
 
 
-[[nodiscard]] std::string jsonUnescape(const std::string& str)
+[[nodiscard]] std::string jsonUnescape(std::string_view str)
 {
     std::string output;
     std::basic_string<impl::Char16> utf16Buf;
@@ -552,6 +555,244 @@ JsonValue parseJson(const std::string& stream) //throw JsonParsingError
 {
     return json_impl::JsonParser(stream).parse(); //throw JsonParsingError
 }
+
+
+/*  pull parser: read values straight into the client's data structures, no JsonValue tree, no copies of skipped data
+    => e.g. huge server responses with thousands of items
+
+    JsonPullParser jp(response);
+    jp.beginObject();
+    while (const std::optional<std::string_view> name = jp.nextMember())
+        if (*name == "files")
+        {
+            jp.beginArray();
+            while (jp.nextElement())
+                ... read value ...
+        }
+        else
+            jp.skipValue();
+    jp.finish();
+
+    - stream must outlive JsonPullParser
+    - member name returned by nextMember() is valid until the next call     */
+class JsonPullParser
+{
+public:
+    explicit JsonPullParser(std::string_view stream) : stream_(stream)
+    {
+        if (zen::startsWith(stream_, BYTE_ORDER_MARK_UTF8))
+            pos_ = strLength(BYTE_ORDER_MARK_UTF8);
+    }
+
+    JsonValue::Type peekType() //throw JsonParsingError
+    {
+        skipWhiteSpace();
+        if (pos_ == stream_.size())
+            throw JsonParsingError(posRow(), posCol());
+
+        switch (stream_[pos_])
+        {
+            //*INDENT-OFF*
+            case '{': return JsonValue::Type::object;
+            case '[': return JsonValue::Type::array;
+            case '"': return JsonValue::Type::string;
+            case 'n': return JsonValue::Type::null;
+            case 't':
+            case 'f': return JsonValue::Type::boolean;
+            default:  return JsonValue::Type::number;
+            //*INDENT-ON*
+        }
+    }
+
+    void beginObject() { consumeChar('{'); firstInScope_.push_back(true); } //throw JsonParsingError
+    void beginArray () { consumeChar('['); firstInScope_.push_back(true); } //
+
+    //nullopt: end of object (consumed)
+    std::optional<std::string_view> nextMember() //throw JsonParsingError
+    {
+        if (!nextInScope('}')) //throw JsonParsingError
+            return std::nullopt;
+
+        const std::string_view name = readStringView(nameBuf_); //throw JsonParsingError
+        consumeChar(':'); //throw JsonParsingError
+        return name;
+    }
+
+    //false: end of array (consumed)
+    bool nextElement() { return nextInScope(']'); } //throw JsonParsingError
+
+    std::string readString() //throw JsonParsingError
+    {
+        std::string buf;
+        const std::string_view str = readStringView(buf); //throw JsonParsingError
+        if (buf.empty())
+            return std::string(str);
+        return buf;
+    }
+
+    //same as JsonValue::primVal: string (unescaped), number, boolean, null (empty)
+    std::string readPrimitive() //throw JsonParsingError
+    {
+        switch (peekType()) //throw JsonParsingError
+        {
+            case JsonValue::Type::string:
+                return readString(); //throw JsonParsingError
+            case JsonValue::Type::null:
+                consumeLiteral("null"); //throw JsonParsingError
+                return {};
+            case JsonValue::Type::boolean:
+                return std::string(stream_[pos_] == 't' ? consumeLiteral("true") : consumeLiteral("false")); //throw JsonParsingError
+            case JsonValue::Type::number:
+            {
+                const size_t posFirst = pos_;
+                while (pos_ != stream_.size() && isJsonNumDigit(stream_[pos_]))
+                    ++pos_;
+                if (pos_ == posFirst)
+                    throw JsonParsingError(posRow(), posCol());
+                return std::string(stream_.substr(posFirst, pos_ - posFirst));
+            }
+            case JsonValue::Type::object:
+            case JsonValue::Type::array:
+                break;
+        }
+        throw JsonParsingError(posRow(), posCol());
+    }
+
+    void skipValue() //throw JsonParsingError
+    {
+        switch (peekType()) //throw JsonParsingError
+        {
+            case JsonValue::Type::object:
+                beginObject(); //throw JsonParsingError
+                while (nextMember()) //
+                    skipValue();     //
+                break;
+            case JsonValue::Type::array:
+                beginArray(); //throw JsonParsingError
+                while (nextElement()) //
+                    skipValue();      //
+                break;
+            case JsonValue::Type::string:
+                skipString(); //throw JsonParsingError
+                break;
+            case JsonValue::Type::null:
+            case JsonValue::Type::boolean:
+            case JsonValue::Type::number:
+                readPrimitive(); //throw JsonParsingError
+                break;
+        }
+    }
+
+    void finish() //throw JsonParsingError
+    {
+        skipWhiteSpace();
+        if (pos_ != stream_.size() || !firstInScope_.empty())
+            throw JsonParsingError(posRow(), posCol());
+    }
+
+    //raw JSON consumed since stream position "posFirst", e.g. for error messages
+    size_t getPos() const { return pos_; }
+    std::string_view getRawSince(size_t posFirst) const { return stream_.substr(posFirst, pos_ - posFirst); }
+
+private:
+    JsonPullParser           (const JsonPullParser&) = delete;
+    JsonPullParser& operator=(const JsonPullParser&) = delete;
+
+    static bool isJsonWhiteSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+    static bool isJsonNumDigit  (char c) { return ('0' <= c && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e'|| c == 'E'; }
+
+    void skipWhiteSpace()
+    {
+        while (pos_ != stream_.size() && isJsonWhiteSpace(stream_[pos_]))
+            ++pos_;
+    }
+
+    void consumeChar(char c) //throw JsonParsingError
+    {
+        skipWhiteSpace();
+        if (pos_ == stream_.size() || stream_[pos_] != c)
+            throw JsonParsingError(posRow(), posCol());
+        ++pos_;
+    }
+
+    std::string_view consumeLiteral(std::string_view literal) //throw JsonParsingError
+    {
+        if (!zen::startsWith(stream_.substr(pos_), literal))
+            throw JsonParsingError(posRow(), posCol());
+        pos_ += literal.size();
+        return literal;
+    }
+
+    bool nextInScope(char scopeEnd) //throw JsonParsingError
+    {
+        if (firstInScope_.empty())
+            throw JsonParsingError(posRow(), posCol());
+
+        skipWhiteSpace();
+        if (pos_ != stream_.size() && stream_[pos_] == scopeEnd)
+        {
+            ++pos_;
+            firstInScope_.pop_back();
+            return false;
+        }
+
+        if (firstInScope_.back())
+            firstInScope_.back() = false;
+        else
+            consumeChar(','); //throw JsonParsingError
+        return true;
+    }
+
+    //returns range [posFirst, posLast) of string content without quotes
+    std::pair<size_t, size_t> skipString() //throw JsonParsingError
+    {
+        consumeChar('"'); //throw JsonParsingError
+        const size_t posFirst = pos_;
+        for (; pos_ != stream_.size(); ++pos_)
+            if (stream_[pos_] == '"')
+                return {posFirst, pos_++};
+            else if (stream_[pos_] == '\\') //skip next char
+                if (++pos_ == stream_.size())
+                    break;
+
+        throw JsonParsingError(posRow(), posCol());
+    }
+
+    //buf: used only if unescaping is needed
+    std::string_view readStringView(std::string& buf) //throw JsonParsingError
+    {
+        const auto [posFirst, posLast] = skipString(); //throw JsonParsingError
+        const std::string_view str = stream_.substr(posFirst, posLast - posFirst);
+
+        if (!contains(str, '\\')) //fast path: nothing to unescape
+        {
+            buf.clear();
+            return str;
+        }
+        buf = json_impl::jsonUnescape(str);
+        return buf;
+    }
+
+    size_t posRow() const //current row beginning with 0
+    {
+        const size_t crSum = std::count(stream_.begin(), stream_.begin() + pos_, '\r'); //carriage returns
+        const size_t nlSum = std::count(stream_.begin(), stream_.begin() + pos_, '\n'); //new lines
+        return std::max(crSum, nlSum); //be compatible with Linux/Mac/Win
+    }
+
+    size_t posCol() const //current col beginning with 0
+    {
+        for (size_t i = pos_; i != 0; --i)
+            if (isLineBreak(stream_[i - 1]))
+                return pos_ - i;
+        return pos_;
+    }
+
+    const std::string_view stream_;
+    size_t pos_ = 0;
+    std::vector<bool> firstInScope_; //one entry per open object/array
+    std::string nameBuf_; //unescaped member name
+};
 }
 
 #endif //JSON_H_0187348321748321758934215734
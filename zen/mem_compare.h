@@ -0,0 +1,134 @@
+// *****************************************************************************
+// * This file is part of the FreeFileSync project. It is distributed under    *
+// * GNU General Public License: https://www.gnu.org/licenses/gpl-3.0          *
+// * Copyright (C) Zenju (zenju AT freefilesync DOT org) - All Rights Reserved *
+// *****************************************************************************
+
+#ifndef MEM_COMPARE_H_3874059823740598237
+#define MEM_COMPARE_H_3874059823740598237
+
+#include <cstddef>
+#include <cstring>
+
+#if defined __x86_64__ || defined __i386__
+    #include <immintrin.h>
+#elif defined __aarch64__
+    #include <arm_neon.h>
+#endif
+
+
+namespace zen
+{
+bool equalBytes(const std::byte* a, const std::byte* b, size_t len); //SIMD: faster than memcmp() if position of first difference is not needed
+
+
+
+
+
+
+
+
+
+//######################## implementation ########################
+namespace impl
+{
+/* equality-only compare kernel: unlike memcmp() there's no need to find the position of the first difference
+    => XOR/OR-accumulate wide vectors, check for early exit once per 128 bytes
+    => runtime dispatch: AVX2 if supported by CPU, else SSE2 (x86-64 baseline), NEON on ARM64    */
+using EqualBytesFun = bool (*)(const std::byte* a, const std::byte* b, size_t len);
+
+inline bool equalBytesGeneric(const std::byte* a, const std::byte* b, size_t len)
+{
+    return len == 0 || std::memcmp(a, b, len) == 0;
+}
+
+#if defined __x86_64__ || defined __i386__
+__attribute__((target("avx2"))) inline
+bool equalBytesAvx2(const std::byte* a, const std::byte* b, size_t len)
+{
+    size_t i = 0;
+    for (; i + 128 <= len; i += 128)
+    {
+        const auto pa = reinterpret_cast<const __m256i*>(a + i);
+        const auto pb = reinterpret_cast<const __m256i*>(b + i);
+
+        const __m256i diff0 = _mm256_xor_si256(_mm256_loadu_si256(pa),     _mm256_loadu_si256(pb));
+        const __m256i diff1 = _mm256_xor_si256(_mm256_loadu_si256(pa + 1), _mm256_loadu_si256(pb + 1));
+        const __m256i diff2 = _mm256_xor_si256(_mm256_loadu_si256(pa + 2), _mm256_loadu_si256(pb + 2));
+        const __m256i diff3 = _mm256_xor_si256(_mm256_loadu_si256(pa + 3), _mm256_loadu_si256(pb + 3));
+
+        const __m256i diff = _mm256_or_si256(_mm256_or_si256(diff0, diff1), _mm256_or_si256(diff2, diff3));
+        if (!_mm256_testz_si256(diff, diff))
+            return false;
+    }
+    return equalBytesGeneric(a + i, b + i, len - i);
+}
+
+__attribute__((target("sse2"))) inline
+bool equalBytesSse2(const std::byte* a, const std::byte* b, size_t len)
+{
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64)
+    {
+        const auto pa = reinterpret_cast<const __m128i*>(a + i);
+        const auto pb = reinterpret_cast<const __m128i*>(b + i);
+
+        const __m128i eq0 = _mm_cmpeq_epi8(_mm_loadu_si128(pa),     _mm_loadu_si128(pb));
+        const __m128i eq1 = _mm_cmpeq_epi8(_mm_loadu_si128(pa + 1), _mm_loadu_si128(pb + 1));
+        const __m128i eq2 = _mm_cmpeq_epi8(_mm_loadu_si128(pa + 2), _mm_loadu_si128(pb + 2));
+        const __m128i eq3 = _mm_cmpeq_epi8(_mm_loadu_si128(pa + 3), _mm_loadu_si128(pb + 3));
+
+        const __m128i eq = _mm_and_si128(_mm_and_si128(eq0, eq1), _mm_and_si128(eq2, eq3));
+        if (_mm_movemask_epi8(eq) != 0xffff)
+            return false;
+    }
+    return equalBytesGeneric(a + i, b + i, len - i);
+}
+
+inline EqualBytesFun getEqualBytesKernel()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return equalBytesAvx2;
+    if (__builtin_cpu_supports("sse2"))
+        return equalBytesSse2;
+    return equalBytesGeneric;
+}
+
+#elif defined __aarch64__
+inline bool equalBytesNeon(const std::byte* a, const std::byte* b, size_t len)
+{
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64)
+    {
+        auto load = [](const std::byte* p) { return vld1q_u8(reinterpret_cast<const uint8_t*>(p)); };
+
+        const uint8x16_t diff0 = veorq_u8(load(a + i),      load(b + i));
+        const uint8x16_t diff1 = veorq_u8(load(a + i + 16), load(b + i + 16));
+        const uint8x16_t diff2 = veorq_u8(load(a + i + 32), load(b + i + 32));
+        const uint8x16_t diff3 = veorq_u8(load(a + i + 48), load(b + i + 48));
+
+        const uint8x16_t diff = vorrq_u8(vorrq_u8(diff0, diff1), vorrq_u8(diff2, diff3));
+        if (vmaxvq_u8(diff) != 0)
+            return false;
+    }
+    return equalBytesGeneric(a + i, b + i, len - i);
+}
+
+inline EqualBytesFun getEqualBytesKernel() { return equalBytesNeon; } //NEON is mandatory on ARMv8
+
+#else
+inline EqualBytesFun getEqualBytesKernel() { return equalBytesGeneric; }
+#endif
+}
+
+
+inline
+bool equalBytes(const std::byte* a, const std::byte* b, size_t len)
+{
+    static const impl::EqualBytesFun kernel = impl::getEqualBytesKernel(); //thread-safe init (C++11)
+    return kernel(a, b, len);
+}
+}
+
+#endif //MEM_COMPARE_H_3874059823740598237
@@ -35,8 +35,7 @@ void zen::openSslInit()
     //see apps_shutdown():     https://github.com/openssl/openssl/blob/master/apps/openssl.c
     //see Curl_ossl_cleanup(): https://github.com/curl/curl/blob/master/lib/vtls/openssl.c
 
-    assert(runningOnMainThread());
-    //excplicitly init OpenSSL on main thread: seems to initialize atomically! But it still might help to avoid issues:
+    //OpenSSL 1.1.0+ initializes atomically (CRYPTO_THREAD_run_once) => fine to call on worker thread: see libcurlEnsureInit()
     [[maybe_unused]] const int rv = ::OPENSSL_init_ssl(OPENSSL_INIT_SSL_DEFAULT | OPENSSL_INIT_NO_LOAD_CONFIG, nullptr);
     assert(rv == 1); //https://www.openssl.org/docs/man1.1.0/ssl/OPENSSL_init_ssl.html
 }
@@ -392,6 +391,78 @@ void verifySignature(const std::string& message, const std::string& signature, E
 }
 
 
+namespace
+{
+EVP_MD_CTX* createDigestContext(const EVP_MD* type) //throw SysError
+{
+    EVP_MD_CTX* mdctx = ::EVP_MD_CTX_create();
+    if (!mdctx)
+        throw SysError(formatSystemError("EVP_MD_CTX_create", L"", L"Unexpected failure.")); //no more error details
+    ZEN_ON_SCOPE_FAIL(::EVP_MD_CTX_destroy(mdctx));
+
+    //https://www.openssl.org/docs/manmaster/man3/EVP_DigestInit.html
+    if (::EVP_DigestInit_ex(mdctx,         //EVP_MD_CTX* ctx
+                            type,          //const EVP_MD* type
+                            nullptr) != 1) //ENGINE* impl
+        throw SysError(formatLastOpenSSLError("EVP_DigestInit_ex"));
+
+    return mdctx;
+}
+
+
+void updateDigest(void* mdctx, const void* buffer, size_t bytesToHash) //throw SysError
+{
+    if (::EVP_DigestUpdate(static_cast<EVP_MD_CTX*>(mdctx), //EVP_MD_CTX* ctx
+                           buffer,                          //const void* d
+                           bytesToHash) != 1)               //size_t cnt
+        throw SysError(formatLastOpenSSLError("EVP_DigestUpdate"));
+}
+
+
+std::string finalizeDigest(void* mdctx) //throw SysError
+{
+    std::string hash(EVP_MAX_MD_SIZE, '\0');
+    unsigned int hashLen = 0;
+
+    if (::EVP_DigestFinal_ex(static_cast<EVP_MD_CTX*>(mdctx),           //EVP_MD_CTX* ctx
+                             reinterpret_cast<unsigned char*>(&hash[0]), //unsigned char* md
+                             &hashLen) != 1)                             //unsigned int* s
+        throw SysError(formatLastOpenSSLError("EVP_DigestFinal_ex"));
+
+    hash.resize(hashLen);
+    return hash;
+}
+}
+
+
+zen::Sha256Hasher::Sha256Hasher() : mdctx_(createDigestContext(EVP_sha256())) {} //throw SysError
+
+zen::Sha256Hasher::~Sha256Hasher() { ::EVP_MD_CTX_destroy(static_cast<EVP_MD_CTX*>(mdctx_)); }
+
+void zen::Sha256Hasher::update(const void* buffer, size_t bytesToHash) { updateDigest(mdctx_, buffer, bytesToHash); } //throw SysError
+
+std::string zen::Sha256Hasher::finalize() //throw SysError
+{
+    std::string hash = finalizeDigest(mdctx_); //throw SysError
+    assert(hash.size() == 32);
+    return hash;
+}
+
+
+zen::Md5Hasher::Md5Hasher() : mdctx_(createDigestContext(EVP_md5())) {} //throw SysError
+
+zen::Md5Hasher::~Md5Hasher() { ::EVP_MD_CTX_destroy(static_cast<EVP_MD_CTX*>(mdctx_)); }
+
+void zen::Md5Hasher::update(const void* buffer, size_t bytesToHash) { updateDigest(mdctx_, buffer, bytesToHash); } //throw SysError
+
+std::string zen::Md5Hasher::finalize() //throw SysError
+{
+    std::string hash = finalizeDigest(mdctx_); //throw SysError
+    assert(hash.size() == 16);
+    return hash;
+}
+
+
 std::string zen::convertRsaKey(const std::string& keyStream, RsaStreamType typeFrom, RsaStreamType typeTo, bool publicKey) //throw SysError
 {
     assert(typeFrom != typeTo);
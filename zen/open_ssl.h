@@ -36,6 +36,42 @@ std::string convertRsaKey(const std::string& keyStream, RsaStreamType typeFrom,
 
 bool isPuttyKeyStream(const std::string& keyStream);
 std::string convertPuttyKeyToPkix(const std::string& keyStream, const std::string& passphrase); //throw SysError
+
+
+//incremental SHA-256 hash calculation, e.g. for file content
+class Sha256Hasher
+{
+public:
+    Sha256Hasher(); //throw SysError
+    ~Sha256Hasher();
+
+    void update(const void* buffer, size_t bytesToHash); //throw SysError
+    std::string finalize(); //throw SysError; returns 32 raw bytes; no more update() afterwards!
+
+private:
+    Sha256Hasher           (const Sha256Hasher&) = delete;
+    Sha256Hasher& operator=(const Sha256Hasher&) = delete;
+
+    void* mdctx_ = nullptr; //EVP_MD_CTX*: don't leak OpenSSL headers
+};
+
+
+//incremental MD5 hash calculation: only to match server-provided checksums, e.g. Google Drive "md5Checksum"
+class Md5Hasher
+{
+public:
+    Md5Hasher(); //throw SysError
+    ~Md5Hasher();
+
+    void update(const void* buffer, size_t bytesToHash); //throw SysError
+    std::string finalize(); //throw SysError; returns 16 raw bytes; no more update() afterwards!
+
+private:
+    Md5Hasher           (const Md5Hasher&) = delete;
+    Md5Hasher& operator=(const Md5Hasher&) = delete;
+
+    void* mdctx_ = nullptr; //EVP_MD_CTX*
+};
 }
 
 #endif //OPEN_SSL_H_801974580936508934568792347506
@@ -8,8 +8,17 @@
 #define PERF_H_83947184145342652456
 
 #include <chrono>
+#include <atomic>
+#include <array>
+#include <bit>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <pthread.h>
 #include "scope_guard.h"
 #include "string_tools.h"
+#include "ring_buffer.h"
+#include "json.h"
 
     #include <iostream>
 
@@ -110,6 +119,434 @@ private:
     StopWatch watch_;
     bool resultShown_ = false;
 };
+
+//###########################################################################
+
+/* Always-built tracing: named spans recorded into per-thread ring buffers, exported in Chrome trace event format
+   => view via https://ui.perfetto.dev or chrome://tracing
+
+   Example:
+        TraceSpan span("copy file", [&] { return utfTo<std::string>(AFS::getDisplayPath(filePath)); });
+
+   - disabled: one relaxed atomic load per span; tag function is not evaluated
+   - span name must be a string literal (*not* copied)                               */
+void enableTracing(bool enable);
+bool tracingEnabled();
+
+std::string getTraceJson(); //spans of all threads recorded so far
+
+/* Metrics: aggregated span statistics (count, duration, latency histogram) + labeled counters,
+   independent from tracing; kept for the lifetime of the process                    */
+void enableMetrics(bool enable);
+bool metricsEnabled();
+
+struct SpanStats
+{
+    static constexpr size_t BUCKET_COUNT = 24; //bucket i: duration < 2^i microseconds; last bucket: unbounded
+
+    std::string name;
+    std::string label; //e.g. device; empty for unlabeled spans
+    int64_t count = 0;
+    int64_t active = 0; //spans currently running, e.g. AFS operations in flight
+    std::chrono::nanoseconds totalTime{};
+    std::chrono::nanoseconds maxTime{};
+    std::array<int64_t, BUCKET_COUNT> histogram{};
+};
+std::vector<SpanStats> getSpanStats(); //sorted by name, label
+
+//upper bound of the histogram bucket containing the given fraction of finished spans, e.g. 0.99 for p99; 0 if none
+std::chrono::microseconds getLatencyPercentile(const SpanStats& stats, double fraction);
+
+struct MetricCount
+{
+    std::string name;
+    std::string label; //e.g. device
+    int64_t value = 0;
+};
+std::vector<MetricCount> getMetricCounts(); //sorted by name, label
+
+template <class Function>
+void addMetricCount(const char* name /*string literal!*/, Function getLabel, int64_t value);
+
+/* Memory accounting per subsystem (bytes), process-wide: current value + peak
+    - counting: addMemoryUsage() on allocation (+) and release (-), e.g. I/O buffers, icon cache
+    - size estimate: setMemoryUsage() after a structure was (re-)built, e.g. comparison tree
+    - disabled with metrics: one relaxed atomic load                                            */
+struct MemoryUsage
+{
+    std::string subsystem;
+    int64_t current = 0;
+    int64_t peak    = 0;
+};
+std::vector<MemoryUsage> getMemoryUsage(); //sorted by subsystem
+
+void addMemoryUsage(const char* subsystem /*string literal!*/, int64_t bytesDelta);
+void setMemoryUsage(const char* subsystem /*string literal!*/, int64_t bytes);
+
+
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char* name) : TraceSpan(name, [] { return std::string(); }) {}
+
+    template <class Function> //tag: e.g. device or file path
+    TraceSpan(const char* name, Function getTag) : TraceSpan(name, getTag, [] { return std::string(); }) {}
+
+    template <class Function, class Function2> //label: aggregate metrics separately per label, e.g. device
+    TraceSpan(const char* name, Function getTag, Function2 getLabel);
+
+    ~TraceSpan();
+
+private:
+    TraceSpan           (const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    const char* name_ = nullptr;
+    bool traced_ = false;
+    std::string tag_;
+    SpanStats* stats_ = nullptr; //metrics enabled: entry of the current thread's buffer (std::map: stable address)
+    std::chrono::steady_clock::time_point startTime_;
+};
+
+
+
+
+
+
+
+
+//---------------------------- implementation ----------------------------
+namespace perf_impl
+{
+const size_t TRACE_EVENTS_PER_THREAD_MAX = 100'000; //ring buffer: keep most recent
+const size_t TRACE_THREADS_MAX = 1000; //buffers of finished threads are kept until this limit is exceeded
+
+struct TraceEvent
+{
+    const char* name = nullptr;
+    std::string tag;
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::steady_clock::time_point endTime;
+};
+
+struct ThreadMetrics
+{
+    std::map<std::pair<std::string_view /*span name: string literal*/, std::string /*label*/>, SpanStats> spanStats;
+    std::map<std::pair<std::string_view /*name: string literal*/, std::string /*label*/>, int64_t> counts;
+
+    void merge(const ThreadMetrics& other)
+    {
+        for (const auto& [key, statsOther] : other.spanStats)
+        {
+            SpanStats& stats = spanStats[key];
+            stats.count     += statsOther.count;
+            stats.active    += statsOther.active;
+            stats.totalTime += statsOther.totalTime;
+            stats.maxTime = std::max(stats.maxTime, statsOther.maxTime);
+            for (size_t i = 0; i < SpanStats::BUCKET_COUNT; ++i)
+                stats.histogram[i] += statsOther.histogram[i];
+        }
+        for (const auto& [key, value] : other.counts)
+            counts[key] += value;
+    }
+};
+
+struct TraceThreadBuffer
+{
+    std::mutex lockEvents; //uncontended except while exporting
+    RingBuffer<TraceEvent> events;
+    ThreadMetrics metrics;
+    size_t threadNo = 0;
+    std::string threadName;
+};
+
+struct MemoryGauge
+{
+    int64_t current = 0;
+    int64_t peak    = 0;
+};
+
+struct TraceRegistry
+{
+    std::atomic<bool> tracingEnabled{false};
+    std::atomic<bool> metricsEnabled{false};
+    const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    std::mutex lockMemory; //not per thread: current value is shared, e.g. buffer allocated and released by different threads
+    std::map<std::string_view /*subsystem: string literal*/, MemoryGauge> memory;
+
+    std::mutex lockBuffers;
+    std::vector<std::shared_ptr<TraceThreadBuffer>> buffers; //in order of creation
+    ThreadMetrics metricsDiscarded; //of buffers removed due to TRACE_THREADS_MAX
+    size_t threadsTotal = 0;
+};
+
+inline
+TraceRegistry& getTraceRegistry()
+{
+    static TraceRegistry reg; //function-scope static: spans may be recorded during static initialization
+    return reg;
+}
+
+
+inline
+TraceThreadBuffer& getThreadTraceBuffer()
+{
+    thread_local const std::shared_ptr<TraceThreadBuffer> threadBuf = []
+    {
+        auto buf = std::make_shared<TraceThreadBuffer>();
+
+        char threadName[16] = {}; //Linux: max. 16 bytes incl. null-terminator
+        if (::pthread_getname_np(::pthread_self(), threadName, sizeof(threadName)) == 0)
+            buf->threadName = threadName;
+
+        TraceRegistry& reg = getTraceRegistry();
+        std::lock_guard dummy(reg.lockBuffers);
+
+        buf->threadNo = ++reg.threadsTotal;
+
+        if (reg.buffers.size() >= TRACE_THREADS_MAX) //discard oldest buffer of a finished thread
+            if (auto it = std::find_if(reg.buffers.begin(), reg.buffers.end(), [](const auto& b) { return b.use_count() == 1; });
+                it != reg.buffers.end())
+            {
+                reg.metricsDiscarded.merge((*it)->metrics); //finished thread: no lock required
+                reg.buffers.erase(it);
+            }
+
+        reg.buffers.push_back(buf);
+        return buf;
+    }();
+    return *threadBuf;
+}
+
+
+inline
+ThreadMetrics getMetricsAllThreads()
+{
+    TraceRegistry& reg = getTraceRegistry();
+    std::lock_guard dummy(reg.lockBuffers);
+
+    ThreadMetrics output = reg.metricsDiscarded;
+    for (const std::shared_ptr<TraceThreadBuffer>& buf : reg.buffers)
+    {
+        std::lock_guard dummy2(buf->lockEvents);
+        output.merge(buf->metrics);
+    }
+    return output;
+}
+}
+
+
+inline void enableTracing(bool enable) { perf_impl::getTraceRegistry().tracingEnabled.store(enable, std::memory_order_relaxed); }
+inline bool tracingEnabled() { return perf_impl::getTraceRegistry().tracingEnabled.load(std::memory_order_relaxed); }
+
+inline void enableMetrics(bool enable) { perf_impl::getTraceRegistry().metricsEnabled.store(enable, std::memory_order_relaxed); }
+inline bool metricsEnabled() { return perf_impl::getTraceRegistry().metricsEnabled.load(std::memory_order_relaxed); }
+
+
+template <class Function, class Function2> inline
+TraceSpan::TraceSpan(const char* name, Function getTag, Function2 getLabel)
+{
+    traced_ = tracingEnabled();
+    const bool metrics = metricsEnabled();
+    if (traced_ || metrics)
+    {
+        name_ = name;
+        if (traced_)
+            tag_ = getTag();
+        if (metrics)
+        {
+            std::string label = getLabel();
+
+            perf_impl::TraceThreadBuffer& buf = perf_impl::getThreadTraceBuffer();
+            std::lock_guard dummy(buf.lockEvents);
+            stats_ = &buf.metrics.spanStats[{name_, std::move(label)}];
+            ++stats_->active;
+        }
+        startTime_ = std::chrono::steady_clock::now();
+    }
+}
+
+
+inline
+TraceSpan::~TraceSpan()
+{
+    if (name_)
+    {
+        const auto endTime = std::chrono::steady_clock::now();
+
+        perf_impl::TraceThreadBuffer& buf = perf_impl::getThreadTraceBuffer();
+        std::lock_guard dummy(buf.lockEvents);
+
+        if (stats_)
+        {
+            const std::chrono::nanoseconds duration = endTime - startTime_;
+            const int64_t durationUs = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+
+            SpanStats& stats = *stats_;
+            --stats.active;
+            ++stats.count;
+            stats.totalTime += duration;
+            stats.maxTime = std::max(stats.maxTime, duration);
+            ++stats.histogram[std::min<size_t>(std::bit_width(static_cast<uint64_t>(durationUs)), SpanStats::BUCKET_COUNT - 1)];
+        }
+
+        if (traced_)
+        {
+            if (buf.events.size() >= perf_impl::TRACE_EVENTS_PER_THREAD_MAX)
+                buf.events.pop_front();
+            buf.events.push_back(perf_impl::TraceEvent{name_, std::move(tag_), startTime_, endTime});
+        }
+    }
+}
+
+
+template <class Function> inline
+void addMetricCount(const char* name, Function getLabel, int64_t value)
+{
+    if (metricsEnabled())
+    {
+        std::string label = getLabel();
+
+        perf_impl::TraceThreadBuffer& buf = perf_impl::getThreadTraceBuffer();
+        std::lock_guard dummy(buf.lockEvents);
+        buf.metrics.counts[{name, std::move(label)}] += value;
+    }
+}
+
+
+inline
+std::vector<SpanStats> getSpanStats()
+{
+    std::vector<SpanStats> output;
+    for (auto& [key, stats] : perf_impl::getMetricsAllThreads().spanStats)
+    {
+        output.push_back(stats);
+        output.back().name  = key.first;
+        output.back().label = key.second;
+    }
+    return output;
+}
+
+
+inline
+std::chrono::microseconds getLatencyPercentile(const SpanStats& stats, double fraction)
+{
+    int64_t countTotal = 0;
+    for (const int64_t bucketCount : stats.histogram)
+        countTotal += bucketCount;
+    if (countTotal == 0)
+        return {};
+
+    int64_t countCumulative = 0;
+    for (size_t i = 0; i < SpanStats::BUCKET_COUNT - 1; ++i)
+    {
+        countCumulative += stats.histogram[i];
+        if (countCumulative >= fraction * countTotal)
+            return std::chrono::microseconds(int64_t(1) << i);
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(stats.maxTime); //unbounded bucket
+}
+
+
+inline
+std::vector<MetricCount> getMetricCounts()
+{
+    std::vector<MetricCount> output;
+    for (const auto& [key, value] : perf_impl::getMetricsAllThreads().counts)
+        output.push_back({std::string(key.first), key.second, value});
+    return output;
+}
+
+
+inline
+void addMemoryUsage(const char* subsystem, int64_t bytesDelta)
+{
+    if (metricsEnabled())
+    {
+        perf_impl::TraceRegistry& reg = perf_impl::getTraceRegistry();
+        std::lock_guard dummy(reg.lockMemory);
+
+        perf_impl::MemoryGauge& gauge = reg.memory[subsystem];
+        gauge.current = std::max<int64_t>(gauge.current + bytesDelta, 0); //allocated before enableMetrics() but released later
+        gauge.peak    = std::max(gauge.peak, gauge.current);
+    }
+}
+
+
+inline
+void setMemoryUsage(const char* subsystem, int64_t bytes)
+{
+    if (metricsEnabled())
+    {
+        perf_impl::TraceRegistry& reg = perf_impl::getTraceRegistry();
+        std::lock_guard dummy(reg.lockMemory);
+
+        perf_impl::MemoryGauge& gauge = reg.memory[subsystem];
+        gauge.current = bytes;
+        gauge.peak    = std::max(gauge.peak, gauge.current);
+    }
+}
+
+
+inline
+std::vector<MemoryUsage> getMemoryUsage()
+{
+    perf_impl::TraceRegistry& reg = perf_impl::getTraceRegistry();
+    std::lock_guard dummy(reg.lockMemory);
+
+    std::vector<MemoryUsage> output;
+    for (const auto& [subsystem, gauge] : reg.memory)
+        output.push_back({std::string(subsystem), gauge.current, gauge.peak});
+    return output;
+}
+
+
+inline
+std::string getTraceJson()
+{
+    perf_impl::TraceRegistry& reg = perf_impl::getTraceRegistry();
+
+    std::vector<std::shared_ptr<perf_impl::TraceThreadBuffer>> buffers;
+    {
+        std::lock_guard dummy(reg.lockBuffers);
+        buffers = reg.buffers;
+    }
+
+    auto toMicroSec = [](std::chrono::steady_clock::duration d) { return numberTo<std::string>(std::chrono::duration_cast<std::chrono::microseconds>(d).count()); };
+
+    std::string output = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool firstEvent = true;
+    auto addEvent = [&](const std::string& jsonObj)
+    {
+        output += firstEvent ? "\n" : ",\n";
+        output += jsonObj;
+        firstEvent = false;
+    };
+
+    for (const std::shared_ptr<perf_impl::TraceThreadBuffer>& buf : buffers)
+    {
+        const std::string tid = numberTo<std::string>(buf->threadNo);
+
+        if (!buf->threadName.empty())
+            addEvent("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + tid +
+                     ",\"args\":{\"name\":\"" + json_impl::jsonEscape(buf->threadName) + "\"}}");
+
+        std::lock_guard dummy(buf->lockEvents);
+        for (const perf_impl::TraceEvent& te : buf->events)
+        {
+            std::string jsonObj = "{\"name\":\"" + json_impl::jsonEscape(te.name) + "\",\"ph\":\"X\",\"pid\":1,\"tid\":" + tid +
+                                  ",\"ts\":" + toMicroSec(te.startTime - reg.startTime) +
+                                  ",\"dur\":" + toMicroSec(te.endTime - te.startTime);
+            if (!te.tag.empty())
+                jsonObj += ",\"args\":{\"tag\":\"" + json_impl::jsonEscape(te.tag) + "\"}";
+            jsonObj += '}';
+            addEvent(jsonObj);
+        }
+    }
+    output += "\n]}\n";
+    return output;
+}
 }
 
 #endif //PERF_H_83947184145342652456
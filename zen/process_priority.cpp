@@ -5,6 +5,10 @@
 // *****************************************************************************
 
 #include "process_priority.h"
+#include <atomic>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #include "i18n.h"
 
 
@@ -17,38 +21,107 @@ PreventStandby::~PreventStandby() {}
 
 //solution for GNOME?: https://people.gnome.org/~mccann/gnome-session/docs/gnome-session.html#org.gnome.SessionManager.Inhibit
 
-struct ScheduleForBackgroundProcessing::Impl {};
-ScheduleForBackgroundProcessing::ScheduleForBackgroundProcessing() {}
-ScheduleForBackgroundProcessing::~ScheduleForBackgroundProcessing() {}
-
-/*
-struct ScheduleForBackgroundProcessing
+namespace
 {
-    - required functions ioprio_get/ioprio_set are not part of glibc: https://linux.die.net/man/2/ioprio_set
+/*  - required functions ioprio_get/ioprio_set are not part of glibc: https://linux.die.net/man/2/ioprio_set
     - and probably never will: https://sourceware.org/bugzilla/show_bug.cgi?id=4464
     - /usr/include/linux/ioprio.h not available on Ubuntu, so we can't use it instead
+    - IOPRIO_WHO_PROCESS + "who == 0": calling *thread* only (Linux schedules I/O per thread); inherited by threads created afterwards  */
+constexpr int IOPRIO_CLASS_SHIFT = 13;
+constexpr int IOPRIO_CLASS_BE   = 2;
+constexpr int IOPRIO_CLASS_IDLE = 3;
+constexpr int IOPRIO_WHO_PROCESS = 1;
+constexpr int IOPRIO_BE_LEVEL_LOWEST = 7;
+
+constexpr int makeIoPriority(int ioClass, int level) { return (ioClass << IOPRIO_CLASS_SHIFT) | level; }
+
+int getThreadIoPriority() //returns -1 on error
+{
+    return static_cast<int>(::syscall(SYS_ioprio_get, IOPRIO_WHO_PROCESS, 0 /*calling thread*/));
+}
+
+bool setThreadIoPriority(int ioPrio)
+{
+    return ::syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0 /*calling thread*/, ioPrio) == 0;
+}
+
+std::atomic<int> backgroundProcessingCount{0}; //number of ScheduleForBackgroundProcessing instances
+std::atomic<int> idleIoProcessingCount{0};    //number of ScheduleForBackgroundProcessing instances with idleIo
+}
+
 
-    ScheduleForBackgroundProcessing() : oldIoPrio(getIoPriority(IOPRIO_WHO_PROCESS, ::getpid()))
-    {
-        if (oldIoPrio != -1)
-            setIoPriority(::getpid(), IOPRIO_PRIO_VALUE(IOPRIO_CLASS_IDLE, 0));
-    }
-    ~ScheduleForBackgroundProcessing()
-    {
-        if (oldIoPrio != -1)
-            setIoPriority(::getpid(), oldIoPrio);
-    }
-
-private:
-    static int getIoPriority(pid_t pid)
-    {
-        return ::syscall(SYS_ioprio_get, IOPRIO_WHO_PROCESS, pid);
-    }
-    static int setIoPriority(pid_t pid, int ioprio)
-    {
-        return ::syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, pid, ioprio);
-    }
-
-    const int oldIoPrio;
+struct ScheduleForBackgroundProcessing::Impl
+{
+    int oldIoPrio = -1;
+    bool idleIo = false;
 };
-*/
+
+
+ScheduleForBackgroundProcessing::ScheduleForBackgroundProcessing(bool idleIo) : pimpl_(std::make_unique<Impl>()) //throw FileError
+{
+    pimpl_->oldIoPrio = getThreadIoPriority();
+    if (pimpl_->oldIoPrio == -1)
+        THROW_LAST_FILE_ERROR(_("Cannot change process I/O priorities."), "ioprio_get");
+
+    if (!setThreadIoPriority(idleIo ?
+                             makeIoPriority(IOPRIO_CLASS_IDLE, 0) :
+                             makeIoPriority(IOPRIO_CLASS_BE, IOPRIO_BE_LEVEL_LOWEST)))
+        THROW_LAST_FILE_ERROR(_("Cannot change process I/O priorities."), "ioprio_set");
+
+    pimpl_->idleIo = idleIo;
+    ++backgroundProcessingCount;
+    if (idleIo)
+        ++idleIoProcessingCount;
+}
+
+
+ScheduleForBackgroundProcessing::~ScheduleForBackgroundProcessing()
+{
+    if (pimpl_->idleIo)
+        --idleIoProcessingCount;
+    --backgroundProcessingCount;
+    setThreadIoPriority(pimpl_->oldIoPrio); //best effort
+}
+
+//--------------------------------------------------------------------------------------------
+
+struct ScheduleThreadForBackground::Impl
+{
+    int oldIoPrio = -1; //-1: unchanged
+
+    bool cpuChanged = false;
+    int oldPolicy = SCHED_OTHER;
+    sched_param oldParam = {};
+};
+
+
+ScheduleThreadForBackground::ScheduleThreadForBackground(BackgroundWork work) : pimpl_(std::make_unique<Impl>())
+{
+    if (backgroundProcessingCount == 0)
+        return;
+
+    if (const int oldIoPrio = getThreadIoPriority();
+        oldIoPrio != -1)
+        if (setThreadIoPriority(work == BackgroundWork::copy || idleIoProcessingCount > 0 ?
+                                makeIoPriority(IOPRIO_CLASS_IDLE, 0) :
+                                makeIoPriority(IOPRIO_CLASS_BE, IOPRIO_BE_LEVEL_LOWEST)))
+            pimpl_->oldIoPrio = oldIoPrio;
+
+    if (work == BackgroundWork::compute)
+        if (::pthread_getschedparam(::pthread_self(), &pimpl_->oldPolicy, &pimpl_->oldParam) == 0)
+        {
+            const sched_param param = {}; //SCHED_IDLE: priority must be 0
+            pimpl_->cpuChanged = ::pthread_setschedparam(::pthread_self(), SCHED_IDLE, &param) == 0;
+        }
+}
+
+
+ScheduleThreadForBackground::~ScheduleThreadForBackground()
+{
+    //best effort: returning from SCHED_IDLE may be denied by RLIMIT_NICE (doesn't matter for short-lived worker threads)
+    if (pimpl_->cpuChanged)
+        ::pthread_setschedparam(::pthread_self(), pimpl_->oldPolicy, &pimpl_->oldParam);
+
+    if (pimpl_->oldIoPrio != -1)
+        setThreadIoPriority(pimpl_->oldIoPrio);
+}
@@ -25,15 +25,40 @@ private:
 };
 
 //lower CPU and file I/O priorities
+//Linux: calling thread's file I/O only (e.g. GUI thread: keep CPU priority); worker threads are lowered via ScheduleThreadForBackground
+//idleIo: all file I/O in idle class while this instance exists, e.g. pre-computing content hashes only when the devices are otherwise unused
 class ScheduleForBackgroundProcessing
 {
 public:
-    ScheduleForBackgroundProcessing(); //throw FileError
+    explicit ScheduleForBackgroundProcessing(bool idleIo = false); //throw FileError
     ~ScheduleForBackgroundProcessing();
 private:
     struct Impl;
     const std::unique_ptr<Impl> pimpl_;
 };
+
+
+enum class BackgroundWork
+{
+    traverse, //file I/O: best-effort class, lowest level => metadata latency still matters
+    copy,     //file I/O: idle class => only when the device is otherwise unused
+    compute,  //file I/O: best-effort class, lowest level + CPU: SCHED_IDLE (compare by content, hashing)
+};
+
+//lower priorities of the *calling thread* according to its kind of work: no-op unless a ScheduleForBackgroundProcessing instance exists
+//best effort: errors are ignored; previous priorities restored on destruction
+class ScheduleThreadForBackground
+{
+public:
+    explicit ScheduleThreadForBackground(BackgroundWork work);
+    ~ScheduleThreadForBackground();
+private:
+    ScheduleThreadForBackground           (const ScheduleThreadForBackground&) = delete;
+    ScheduleThreadForBackground& operator=(const ScheduleThreadForBackground&) = delete;
+
+    struct Impl;
+    const std::unique_ptr<Impl> pimpl_;
+};
 }
 
 #endif //PROCESS_PRIORITY_H_83421759082143245
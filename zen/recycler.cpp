@@ -8,17 +8,156 @@
 #include "file_access.h"
 
     #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
     #include <gio/gio.h>
     #include "scope_guard.h"
+    #include "guid.h"
+    #include "time.h"
 
 using namespace zen;
 
 
+namespace
+{
+/*  freedesktop.org home trash: https://specifications.freedesktop.org/trash-spec/trashspec-latest.html
+    g_file_trash() is a lot of overhead (and syscalls) per item, while trashing an item on the same device as the home trash is simply:
+        1. reserve name: create "info/<name>.trashinfo" with O_EXCL
+        2. rename item to "files/<name>"
+    => other devices (topdir trash "$topdir/.Trash-$uid", trash not available) are left to GIO         */
+struct HomeTrash
+{
+    Zstring filesPath;
+    Zstring infoPath;
+    dev_t deviceId = 0;
+};
+
+
+std::optional<HomeTrash> getHomeTrash() //noexcept
+{
+    static const std::optional<HomeTrash> homeTrash = []() -> std::optional<HomeTrash>
+    {
+        Zstring dataHomePath;
+        if (const char* xdgDataHome = ::getenv("XDG_DATA_HOME"); xdgDataHome && xdgDataHome[0] == '/')
+            dataHomePath = xdgDataHome;
+        else if (const char* homePath = ::getenv("HOME"); homePath && homePath[0] == '/')
+            dataHomePath = appendPaths(homePath, Zstr(".local/share"), FILE_NAME_SEPARATOR);
+        else
+            return std::nullopt;
+
+        const Zstring trashPath = appendPaths(dataHomePath, Zstr("Trash"), FILE_NAME_SEPARATOR);
+        HomeTrash trash{appendPaths(trashPath, Zstr("files"), FILE_NAME_SEPARATOR),
+                        appendPaths(trashPath, Zstr("info"),  FILE_NAME_SEPARATOR)};
+
+        try { createDirectoryIfMissingRecursion(dataHomePath); /*throw FileError*/ }
+        catch (FileError&) { return std::nullopt; } //=> GIO knows best
+
+        for (const Zstring& dirPath : {trashPath, trash.filesPath, trash.infoPath})
+            if (::mkdir(dirPath.c_str(), 0700) != 0 && errno != EEXIST)
+                return std::nullopt;
+
+        struct stat filesInfo = {};
+        struct stat infoInfo  = {};
+        if (::stat(trash.filesPath.c_str(), &filesInfo) != 0 || !S_ISDIR(filesInfo.st_mode) ||
+            ::stat(trash.infoPath .c_str(), &infoInfo ) != 0 || !S_ISDIR(infoInfo .st_mode) ||
+            filesInfo.st_dev != infoInfo.st_dev)
+            return std::nullopt;
+
+        trash.deviceId = filesInfo.st_dev;
+        return trash;
+    }();
+    return homeTrash;
+}
+
+
+std::string formatTrashInfo(const Zstring& itemPath)
+{
+    std::string pathEsc; //"URL-escaped" as per RFC 2396 (excessive escaping is fine)
+    for (const char c : itemPath)
+        if (isAsciiAlpha(c) || isDigit(c) || c == '/' || c == '-' || c == '_' || c == '.' || c == '~')
+            pathEsc += c;
+        else
+        {
+            const auto [high, low] = hexify(static_cast<unsigned char>(c));
+            pathEsc += '%';
+            pathEsc += high;
+            pathEsc += low;
+        }
+
+    return "[Trash Info]\n"
+           "Path=" + pathEsc + "\n"
+           "DeletionDate=" + utfTo<std::string>(formatTime(Zstr("%Y-%m-%dT%H:%M:%S"))) + "\n"; //local time
+}
+
+
+//return false if not applicable or failed => fall back to g_file_trash()
+bool tryMoveToHomeTrash(const Zstring& itemPath, dev_t itemDeviceId) //noexcept
+{
+    const std::optional<HomeTrash>& trash = getHomeTrash();
+    if (!trash || trash->deviceId != itemDeviceId)
+        return false;
+
+    const Zstring itemName = afterLast(itemPath, FILE_NAME_SEPARATOR, IfNotFoundReturn::all);
+    if (itemName.empty())
+        return false;
+
+    const std::string trashInfo = formatTrashInfo(itemPath);
+
+    //name clash: <name>, <name>.2, ... <name>.9, then <name>.<random> => avoid quadratic probing for many items of the same name
+    for (int i = 1; i <= 10; ++i)
+    {
+        const Zstring trashName = i == 1  ? itemName :
+                                  i < 10  ? itemName + Zstr('.') + numberTo<Zstring>(i) :
+                                  itemName + Zstr('.') + utfTo<Zstring>(formatAsHexString(generateGUID()).substr(0, 8));
+
+        const Zstring infoFilePath = appendPaths(trash->infoPath, trashName + Zstr(".trashinfo"), FILE_NAME_SEPARATOR);
+
+        const int fdInfo = ::open(infoFilePath.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+        if (fdInfo == -1)
+        {
+            if (errno == EEXIST)
+                continue;
+            return false; //e.g. ENAMETOOLONG: GIO shortens the name
+        }
+
+        bool infoWritten = false;
+        {
+            ZEN_ON_SCOPE_EXIT(::close(fdInfo));
+            const ssize_t bytesWritten = ::write(fdInfo, trashInfo.c_str(), trashInfo.size()); //small size => no partial write for regular files
+            infoWritten = bytesWritten == static_cast<ssize_t>(trashInfo.size());
+        }
+        if (!infoWritten)
+        {
+            ::unlink(infoFilePath.c_str());
+            return false;
+        }
+
+        try
+        {
+            moveAndRenameItem(itemPath, appendPaths(trash->filesPath, trashName, FILE_NAME_SEPARATOR), false /*replaceExisting*/); //throw FileError, ErrorMoveUnsupported, ErrorTargetExisting
+            return true;
+        }
+        catch (ErrorTargetExisting&) { ::unlink(infoFilePath.c_str()); } //stale file without .trashinfo => try next name
+        catch (FileError&) //e.g. EXDEV if item is a bind mount, EINVAL if item contains the trash
+        {
+            ::unlink(infoFilePath.c_str());
+            return false;
+        }
+    }
+    return false;
+}
+}
 
 
 //*INDENT-OFF*
 bool zen::recycleOrDeleteIfExists(const Zstring& itemPath) //throw FileError
 {
+    //fast path: plain rename into home trash
+    if (struct stat itemInfo = {};
+        ::lstat(itemPath.c_str(), &itemInfo) == 0 &&
+        tryMoveToHomeTrash(itemPath, itemInfo.st_dev)) //noexcept
+        return true;
+
     GFile* file = ::g_file_new_for_path(itemPath.c_str()); //never fails according to docu
     ZEN_ON_SCOPE_EXIT(g_object_unref(file);)
 
@@ -28,7 +28,10 @@ namespace zen
     Compiler flags: `pkg-config --cflags gio-2.0`
     Linker   flags: `pkg-config --libs gio-2.0`
 
-    Already included in package "gtk+-2.0"!                  */
+    Already included in package "gtk+-2.0"!
+
+    Items on the same device as the home trash ($XDG_DATA_HOME/Trash) are moved by a plain rename + .trashinfo record (thread-safe)
+    => everything else is left to g_file_trash()          */
 
 
 //move a file or folder to Recycle Bin (deletes permanently if recycler is not available) -> crappy semantics, but we have no choice thanks to Windows' design
@@ -12,6 +12,8 @@
     #include <unistd.h> //close
     #include <sys/socket.h>
     #include <netdb.h> //getaddrinfo
+    #include <netinet/in.h>
+    #include <netinet/tcp.h> //TCP_NOTSENT_LOWAT, TCP_CONGESTION
 
 
 
@@ -27,12 +29,49 @@ const SocketType invalidSocket = -1;
 inline void closeSocket(SocketType s) { ::close(s); }
 
 
+/*  optional TCP tuning for links with a large bandwidth-delay product, e.g. 10 Gbit/s x 80 ms = 100 MB in flight
+    - apply before connect(): TCP window scale is negotiated during the handshake
+    - bufferBytes: explicit SO_SNDBUF/SO_RCVBUF *disables* Linux auto-tuning and is capped by net.core.wmem_max/rmem_max
+                   => only set if the system limits were raised accordingly (BDP = bandwidth x RTT)
+    - congestionControl: must be listed in net.ipv4.tcp_allowed_congestion_control (unless root), e.g. "bbr"     */
+struct SocketTuning
+{
+    int bufferBytes = 0;           //SO_SNDBUF + SO_RCVBUF; 0: OS auto-tuning
+    int notSentLowAtBytes = 0;     //TCP_NOTSENT_LOWAT: limit unsent data in kernel buffer; 0: OS default
+    std::string congestionControl; //TCP_CONGESTION; empty: OS default
+};
+
+
+inline
+void applySocketTuning(SocketType socket, const SocketTuning& tuning) //throw SysError
+{
+    auto setIntOption = [socket](int level, int optName, int value, const char* functionName)
+    {
+        if (::setsockopt(socket, level, optName, &value, sizeof(value)) != 0)
+            THROW_LAST_SYS_ERROR_WSA(functionName);
+    };
+
+    if (tuning.bufferBytes > 0)
+    {
+        setIntOption(SOL_SOCKET, SO_SNDBUF, tuning.bufferBytes, "setsockopt(SO_SNDBUF)");
+        setIntOption(SOL_SOCKET, SO_RCVBUF, tuning.bufferBytes, "setsockopt(SO_RCVBUF)");
+    }
+
+    if (tuning.notSentLowAtBytes > 0)
+        setIntOption(IPPROTO_TCP, TCP_NOTSENT_LOWAT, tuning.notSentLowAtBytes, "setsockopt(TCP_NOTSENT_LOWAT)");
+
+    if (!tuning.congestionControl.empty())
+        if (::setsockopt(socket, IPPROTO_TCP, TCP_CONGESTION, tuning.congestionControl.c_str(), static_cast<socklen_t>(tuning.congestionControl.size())) != 0)
+            THROW_LAST_SYS_ERROR_WSA("setsockopt(TCP_CONGESTION, " + tuning.congestionControl + ')');
+}
+
+
 //Winsock needs to be initialized before calling any of these functions! (WSAStartup/WSACleanup)
 
 class Socket //throw SysError
 {
 public:
-    Socket(const Zstring& server, const Zstring& serviceName) //throw SysError
+    Socket(const Zstring& server, const Zstring& serviceName, const SocketTuning& tuning = {}) //throw SysError
     {
         ::addrinfo hints = {};
         hints.ai_socktype = SOCK_STREAM; //we *do* care about this one!
@@ -47,7 +86,7 @@ public:
         if (!servinfo)
             throw SysError(formatSystemError("getaddrinfo", L"", L"Empty server info."));
 
-        const auto getConnectedSocket = [](const auto& /*::addrinfo*/ ai)
+        const auto getConnectedSocket = [&tuning](const auto& /*::addrinfo*/ ai)
         {
             SocketType testSocket = ::socket(ai.ai_family,    //int socket_family
                                              SOCK_CLOEXEC |
@@ -57,6 +96,7 @@ public:
                 THROW_LAST_SYS_ERROR_WSA("socket");
             ZEN_ON_SCOPE_FAIL(closeSocket(testSocket));
 
+            applySocketTuning(testSocket, tuning); //throw SysError
 
             if (::connect(testSocket, ai.ai_addr, static_cast<int>(ai.ai_addrlen)) != 0)
                 THROW_LAST_SYS_ERROR_WSA("connect");
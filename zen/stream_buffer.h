@@ -7,8 +7,9 @@
 #ifndef STREAM_BUFFER_H_08492572089560298
 #define STREAM_BUFFER_H_08492572089560298
 
-#include <condition_variable>
-#include "ring_buffer.h"
+#include <atomic>
+#include <mutex>
+#include <cstring>
 #include "string_tools.h"
 
 
@@ -21,7 +22,11 @@ namespace zen
 class AsyncStreamBuffer
 {
 public:
-    explicit AsyncStreamBuffer(size_t bufferSize) : bufSize_(bufferSize) { ringBuf_.reserve(bufferSize); }
+    explicit AsyncStreamBuffer(size_t bufferSize) : bufSize_(bufferSize), buf_(std::make_unique<std::byte[]>(bufferSize))
+    {
+        if (bufferSize == 0)
+            throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
+    }
 
     //context of input thread, blocking
     //return "bytesToRead" bytes unless end of stream!
@@ -33,21 +38,36 @@ public:
         auto       it    = static_cast<std::byte*>(buffer);
         const auto itEnd = it + bytesToRead;
 
-        for (std::unique_lock dummy(lockStream_); it != itEnd;)
+        uint64_t readPos = readPos_.load(std::memory_order_relaxed); //modified by this thread only
+        while (it != itEnd)
         {
-            assert(!errorRead_);
-            conditionBytesWritten_.wait(dummy, [this] { return errorWrite_ || !ringBuf_.empty() || eof_; });
+            assert(!haveErrorRead_);
+            bool eof = false;
+            uint64_t writePos = 0;
+            for (;;)
+            {
+                const uint32_t seq = writeSeq_.load(std::memory_order_acquire);
 
-            if (errorWrite_)
-                std::rethrow_exception(errorWrite_); //throw <write error>
+                if (haveErrorWrite_.load(std::memory_order_acquire))
+                    rethrowError(errorWrite_); //throw <write error>
+
+                eof      = eof_     .load(std::memory_order_acquire); //[!] before writePos_: all bytes are published when eof_ is seen
+                writePos = writePos_.load(std::memory_order_acquire);
 
-            const size_t junkSize = std::min(static_cast<size_t>(itEnd - it), ringBuf_.size());
-            ringBuf_.extract_front(it, it + junkSize);
-            it += junkSize;
+                if (writePos != readPos || eof)
+                    break;
+                writeSeq_.wait(seq, std::memory_order_acquire); //lost wake-up? => no: any change of state increments writeSeq_
+            }
 
-            conditionBytesRead_.notify_all();
+            const size_t junkSize = std::min(static_cast<size_t>(itEnd - it), static_cast<size_t>(writePos - readPos));
+            copyFromRing(readPos, it, junkSize);
+            it      += junkSize;
+            readPos += junkSize;
 
-            if (eof_) //end of file
+            readPos_.store(readPos, std::memory_order_release);
+            signal(readSeq_);
+
+            if (eof && readPos == writePos) //end of file
                 break;
         }
 
@@ -64,76 +84,87 @@ public:
         auto       it    = static_cast<const std::byte*>(buffer);
         const auto itEnd = it + bytesToWrite;
 
-        for (std::unique_lock dummy(lockStream_); it != itEnd;)
+        uint64_t writePos = writePos_.load(std::memory_order_relaxed); //modified by this thread only
+        while (it != itEnd)
         {
-            assert(!eof_ && !errorWrite_);
+            assert(!eof_ && !haveErrorWrite_);
             /*  => can't use InterruptibleThread's interruptibleWait() :(
                 -> AsyncStreamBuffer is used for input and output streaming
                 => both AsyncStreamBuffer::write()/read() would have to implement interruptibleWait()
                 => one of these usually called from main thread
                 => but interruptibleWait() cannot be called from main thread!          */
-            conditionBytesRead_.wait(dummy, [this] { return errorRead_ || ringBuf_.size() < bufSize_; });
-
-            if (errorRead_)
-                std::rethrow_exception(errorRead_); //throw <read error>
-
-            const size_t junkSize = std::min(static_cast<size_t>(itEnd - it), bufSize_ - ringBuf_.size());
-            ringBuf_.insert_back(it, it + junkSize);
-            it += junkSize;
-
-            conditionBytesWritten_.notify_all();
+            uint64_t readPos = 0;
+            for (;;)
+            {
+                const uint32_t seq = readSeq_.load(std::memory_order_acquire);
+
+                if (haveErrorRead_.load(std::memory_order_acquire))
+                    rethrowError(errorRead_); //throw <read error>
+
+                readPos = readPos_.load(std::memory_order_acquire);
+                if (writePos - readPos < bufSize_)
+                    break;
+                readSeq_.wait(seq, std::memory_order_acquire);
+            }
+
+            const size_t junkSize = std::min(static_cast<size_t>(itEnd - it), bufSize_ - static_cast<size_t>(writePos - readPos));
+            copyToRing(it, writePos, junkSize);
+            it       += junkSize;
+            writePos += junkSize;
+
+            writePos_.store(writePos, std::memory_order_release);
+            signal(writeSeq_);
         }
     }
 
     //context of output thread
     void closeStream()
     {
-        {
-            std::lock_guard dummy(lockStream_);
-            assert(!eof_ && !errorWrite_);
-            eof_ = true;
-        }
-        conditionBytesWritten_.notify_all();
+        assert(!eof_ && !haveErrorWrite_);
+        eof_.store(true, std::memory_order_release);
+        signal(writeSeq_);
     }
 
     //context of input thread
     void setReadError(const std::exception_ptr& error)
     {
         {
-            std::lock_guard dummy(lockStream_);
+            std::lock_guard dummy(lockErrors_);
             assert(!errorRead_);
-            if (!errorRead_)
-                errorRead_ = error;
+            if (errorRead_)
+                return;
+            errorRead_ = error;
         }
-        conditionBytesRead_.notify_all();
+        haveErrorRead_.store(true, std::memory_order_release);
+        signal(readSeq_);
     }
 
     //context of output thread
     void setWriteError(const std::exception_ptr& error)
     {
         {
-            std::lock_guard dummy(lockStream_);
+            std::lock_guard dummy(lockErrors_);
             assert(!errorWrite_);
-            if (!errorWrite_)
-                errorWrite_ = error;
+            if (errorWrite_)
+                return;
+            errorWrite_ = error;
         }
-        conditionBytesWritten_.notify_all();
+        haveErrorWrite_.store(true, std::memory_order_release);
+        signal(writeSeq_);
     }
 
     //context of *output* thread
     void checkReadErrors() //throw <read error>
     {
-        std::lock_guard dummy(lockStream_);
-        if (errorRead_)
-            std::rethrow_exception(errorRead_); //throw <read error>
+        if (haveErrorRead_.load(std::memory_order_acquire))
+            rethrowError(errorRead_); //throw <read error>
     }
 
 #if 0 //function not needed: when EOF is reached (without errors), reading is done => no further error can occur!
     void checkWriteErrors() //throw <write error>
     {
-        std::lock_guard dummy(lockStream_);
-        if (errorWrite_)
-            std::rethrow_exception(errorWrite_); //throw <write error>
+        if (haveErrorWrite_.load(std::memory_order_acquire))
+            rethrowError(errorWrite_); //throw <write error>
     }
 #endif
 
@@ -144,14 +175,54 @@ private:
     AsyncStreamBuffer           (const AsyncStreamBuffer&) = delete;
     AsyncStreamBuffer& operator=(const AsyncStreamBuffer&) = delete;
 
+    void copyToRing(const std::byte* src, uint64_t writePos, size_t len)
+    {
+        const size_t bufPos = static_cast<size_t>(writePos % bufSize_);
+        const size_t len1 = std::min(len, bufSize_ - bufPos);
+        std::memcpy(&buf_[bufPos], src, len1);
+        std::memcpy(&buf_[0], src + len1, len - len1); //wrap around
+    }
+
+    void copyFromRing(uint64_t readPos, std::byte* trg, size_t len) const
+    {
+        const size_t bufPos = static_cast<size_t>(readPos % bufSize_);
+        const size_t len1 = std::min(len, bufSize_ - bufPos);
+        std::memcpy(trg, &buf_[bufPos], len1);
+        std::memcpy(trg + len1, &buf_[0], len - len1); //wrap around
+    }
+
+    //notify_all(): the other side may wait on the same counter from a different thread, e.g. during destruction
+    static void signal(std::atomic<uint32_t>& seq) { seq.fetch_add(1, std::memory_order_release); seq.notify_all(); } //no syscall if nobody is waiting
+
+    [[noreturn]] void rethrowError(const std::exception_ptr& error)
+    {
+        std::exception_ptr errorCopy;
+        {
+            std::lock_guard dummy(lockErrors_);
+            errorCopy = error;
+        }
+        std::rethrow_exception(errorCopy);
+    }
+
+    /*  single producer/single consumer without locks:
+        - read/write positions are monotonic byte counts (no wrap-around in practice), modified by one thread only
+        - blocking via atomic wait (Linux: futex) on per-direction sequence counters: incremented for *any* state change (data, EOF, errors)
+        - separate cache lines: avoid false sharing between producer and consumer                                                             */
     const size_t bufSize_;
-    std::mutex lockStream_;
-    RingBuffer<std::byte> ringBuf_; //prefetch/output buffer
-    bool eof_ = false;
+    const std::unique_ptr<std::byte[]> buf_; //prefetch/output buffer
+
+    alignas(64) std::atomic<uint64_t> writePos_{0}; //producer
+    std::atomic<uint32_t> writeSeq_{0};             //
+    std::atomic<bool> eof_{false};                  //
+    std::atomic<bool> haveErrorWrite_{false};       //
+
+    alignas(64) std::atomic<uint64_t> readPos_{0}; //consumer
+    std::atomic<uint32_t> readSeq_{0};             //
+    std::atomic<bool> haveErrorRead_{false};       //
+
+    alignas(64) std::mutex lockErrors_; //rarely accessed
     std::exception_ptr errorWrite_;
     std::exception_ptr errorRead_;
-    std::condition_variable conditionBytesWritten_;
-    std::condition_variable conditionBytesRead_;
 
     std::atomic<uint64_t> totalBytesWritten_{0}; //std:atomic is uninitialized by default!
     std::atomic<uint64_t> totalBytesRead_   {0}; //
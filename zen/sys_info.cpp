@@ -18,6 +18,7 @@
 
 
     #include "process_exec.h"
+    #include <fcntl.h>  //open()
     #include <unistd.h> //getuid()
     #include <pwd.h>    //getpwuid_r()
 
@@ -178,6 +179,45 @@ Zstring zen::getRealProcessPath() //throw FileError
 }
 
 
+ProcessMemory zen::getProcessMemory() //noexcept
+{
+    ProcessMemory pm;
+
+    const int fd = ::open("/proc/self/status", O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return pm;
+    ZEN_ON_SCOPE_EXIT(::close(fd));
+
+    char buf[8192] = {}; //~1.5 KB
+    const ssize_t bytesRead = ::read(fd, buf, sizeof(buf) - 1);
+    if (bytesRead <= 0)
+        return pm;
+
+    //e.g. "VmHWM:\t  123456 kB"
+    auto getKBytes = [](const std::string& line) { return stringTo<int64_t>(beforeFirst(trimCpy(afterFirst(line, ':', IfNotFoundReturn::none)), ' ', IfNotFoundReturn::all)); };
+
+    for (const std::string& line : split(std::string(buf, bytesRead), '\n', SplitOnEmpty::skip))
+        if (startsWith(line, "VmRSS:"))
+            pm.current = getKBytes(line) * 1024;
+        else if (startsWith(line, "VmHWM:"))
+            pm.peak = getKBytes(line) * 1024;
+
+    return pm;
+}
+
+
+bool zen::resetProcessPeakMemory() //noexcept
+{
+    //"5": reset VmHWM to current VmRSS, leave page reference bits alone: https://docs.kernel.org/filesystems/proc.html
+    const int fd = ::open("/proc/self/clear_refs", O_WRONLY | O_CLOEXEC);
+    if (fd == -1)
+        return false;
+    ZEN_ON_SCOPE_EXIT(::close(fd));
+
+    return ::write(fd, "5", 1) == 1;
+}
+
+
 namespace
 {
 Zstring getUserDir() //throw FileError
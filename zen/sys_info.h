@@ -32,6 +32,17 @@ std::wstring getOsDescription(); //throw FileError
 
 Zstring getRealProcessPath(); //throw FileError
 
+
+struct ProcessMemory
+{
+    int64_t current = -1; //resident set size (bytes); -1 if not available
+    int64_t peak    = -1; //since process start or last resetProcessPeakMemory()
+};
+ProcessMemory getProcessMemory(); //noexcept
+
+//start new peak measurement, e.g. per phase; false if not supported => peak remains the one since process start
+bool resetProcessPeakMemory(); //noexcept
+
 Zstring getUserDownloadsPath(); //throw FileError
 Zstring getUserDataPath(); //throw FileError
 
@@ -5,7 +5,16 @@
 // *****************************************************************************
 
 #include "thread.h"
+#include <map>
+#include "globals.h"
+#include "perf.h"
     #include <sys/prctl.h>
+    #include <sys/stat.h>
+    #include <sys/sysmacros.h> //major(), minor()
+    #include <dirent.h>
+    #include <fcntl.h>
+    #include <sched.h>
+    #include <unistd.h>
 
 using namespace zen;
 
@@ -26,6 +35,81 @@ const std::thread::id globalMainThreadId = std::this_thread::get_id();
 }
 
 
+namespace
+{
+//keep threads around for the next phase (e.g. comparison => synchronization), but not forever
+constexpr std::chrono::seconds THREAD_IDLE_TIME_MAX(30);
+const size_t THREAD_IDLE_COUNT_MAX = 64;
+
+
+class ThreadCache
+{
+public:
+    void run(std::function<void()>&& task)
+    {
+        {
+            std::lock_guard dummy(state_.ref().lock);
+            if (state_.ref().threadsIdle > state_.ref().tasks.size()) //each queued task is taken by a different idle thread
+            {
+                state_.ref().tasks.push_back(std::move(task));
+                state_.ref().conditionNewTask.notify_one(); //notify while locked: idle thread might time out and exit otherwise
+                return;
+            }
+        }
+        std::thread([state = state_ /*share ownership!*/, task = std::move(task)]() mutable { workerLoop(state.ref(), std::move(task)); }).detach();
+        //we have to explicitly detach since C++11: [thread.thread.destr] ~thread() calls std::terminate() if joinable()!!!
+    }
+
+private:
+    struct State
+    {
+        std::mutex lock;
+        RingBuffer<std::function<void()>> tasks;
+        size_t threadsIdle = 0;
+        std::condition_variable conditionNewTask;
+    };
+
+    static void workerLoop(State& state, std::function<void()>&& task)
+    {
+        for (;;)
+        {
+            task();
+            task = nullptr; //destroy captured state before waiting
+
+            setCurrentThreadName(Zstr("Idle thread"));
+
+            std::unique_lock dummy(state.lock);
+            if (state.threadsIdle >= THREAD_IDLE_COUNT_MAX)
+                return;
+
+            ++state.threadsIdle;
+            const bool haveTask = state.conditionNewTask.wait_for(dummy, THREAD_IDLE_TIME_MAX, [&] { return !state.tasks.empty(); });
+            --state.threadsIdle;
+            if (!haveTask)
+                return;
+
+            task = std::move(state.tasks.    front()); //noexcept thanks to move
+            /**/             state.tasks.pop_front();  //
+        }
+    }
+
+    SharedRef<State> state_ = makeSharedRef<State>(); //shared with threads: outlives ThreadCache during shutdown
+};
+
+constinit Global<ThreadCache> globalThreadCache;
+GLOBAL_RUN_ONCE(globalThreadCache.set(std::make_unique<ThreadCache>()));
+}
+
+
+void zen::impl::runOnPooledThread(std::function<void()>&& task)
+{
+    if (const std::shared_ptr<ThreadCache> tc = globalThreadCache.get())
+        tc->run(std::move(task));
+    else //during init/shutdown
+        std::thread(std::move(task)).detach();
+}
+
+
 bool zen::runningOnMainThread()
 {
     if (globalMainThreadId == std::thread::id()) //if called during static initialization!
@@ -35,3 +119,208 @@ bool zen::runningOnMainThread()
 }
 
 
+
+
+namespace
+{
+std::atomic<bool> globalNumaAffinity{false};
+
+std::optional<std::string> readSysfsLine(const std::string& filePath) //noexcept
+{
+    const int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return std::nullopt;
+    ZEN_ON_SCOPE_EXIT(::close(fd));
+
+    char buf[4096] = {};
+    const ssize_t bytesRead = ::read(fd, buf, sizeof(buf) - 1);
+    if (bytesRead <= 0)
+        return std::nullopt;
+    return trimCpy(std::string(buf, bytesRead));
+}
+
+
+//sysfs numa_node: -1 if the platform doesn't tell
+int readNumaNode(const std::string& filePath) //noexcept
+{
+    if (const std::optional<std::string> line = readSysfsLine(filePath);
+        line && !line->empty())
+        return stringTo<int>(*line);
+    return -1;
+}
+
+
+std::vector<std::string> getSysfsDirItems(const std::string& dirPath, const std::string& prefix) //noexcept
+{
+    std::vector<std::string> items;
+    if (DIR* dir = ::opendir(dirPath.c_str()))
+    {
+        ZEN_ON_SCOPE_EXIT(::closedir(dir));
+        while (const dirent* entry = ::readdir(dir))
+            if (startsWith(entry->d_name, prefix))
+                items.push_back(entry->d_name);
+    }
+    return items;
+}
+
+
+struct NumaTopology
+{
+    std::map<int /*node*/, cpu_set_t> nodeCpus; //only nodes with CPUs the process may run on
+};
+
+
+NumaTopology readNumaTopology() //noexcept
+{
+    NumaTopology topo;
+
+    cpu_set_t processCpus; //affinity at startup, e.g. "taskset", cgroup cpuset
+    CPU_ZERO(&processCpus);
+    if (::sched_getaffinity(0, sizeof(processCpus), &processCpus) != 0)
+        return topo;
+
+    for (const std::string& itemName : getSysfsDirItems("/sys/devices/system/node", "node"))
+        if (itemName.size() > 4 && std::all_of(itemName.begin() + 4, itemName.end(), isDigit<char>)) //e.g. "node0"
+            if (const std::optional<std::string> cpuList = readSysfsLine("/sys/devices/system/node/" + itemName + "/cpulist"))
+            {
+                cpu_set_t cpus;
+                CPU_ZERO(&cpus);
+
+                //e.g. "0-7,16-23"
+                for (const std::string& block : split(*cpuList, ',', SplitOnEmpty::skip))
+                {
+                    const int cpuFirst = stringTo<int>(beforeFirst(block, '-', IfNotFoundReturn::all));
+                    const int cpuLast  = stringTo<int>(afterFirst (block, '-', IfNotFoundReturn::all));
+                    for (int cpu = cpuFirst; cpu <= cpuLast && cpu < CPU_SETSIZE; ++cpu)
+                        if (CPU_ISSET(cpu, &processCpus))
+                            CPU_SET(cpu, &cpus);
+                }
+
+                if (CPU_COUNT(&cpus) > 0)
+                    topo.nodeCpus.emplace(stringTo<int>(itemName.substr(4)), cpus);
+            }
+    return topo;
+}
+
+
+const NumaTopology& getNumaTopology()
+{
+    static const NumaTopology topo = readNumaTopology(); //static init is thread-safe since C++11; sysfs doesn't change at runtime
+    return topo;
+}
+}
+
+
+void zen::enableNumaAffinity(bool enable) { globalNumaAffinity = enable; }
+bool zen::numaAffinityEnabled() { return globalNumaAffinity; }
+
+
+size_t zen::getNumaNodeCount()
+{
+    return std::max<size_t>(getNumaTopology().nodeCpus.size(), 1);
+}
+
+
+int zen::selectNumaNode(int preferredNode)
+{
+    if (!numaAffinityEnabled())
+        return -1;
+
+    const NumaTopology& topo = getNumaTopology();
+    if (topo.nodeCpus.size() < 2)
+        return -1;
+
+    if (topo.nodeCpus.contains(preferredNode))
+        return preferredNode;
+
+    //unknown device location: spread worker pools over all nodes
+    static std::atomic<size_t> nextIdx{0};
+    auto it = topo.nodeCpus.begin();
+    std::advance(it, nextIdx++ % topo.nodeCpus.size());
+    return it->first;
+}
+
+
+int zen::getBlockDeviceNumaNode(const Zstring& path) //noexcept
+{
+    struct stat itemInfo = {};
+    if (::stat(path.c_str(), &itemInfo) != 0)
+        return -1;
+
+    static std::mutex lockCache;
+    static std::map<dev_t, int> nodeByDevice;
+    {
+        std::lock_guard dummy(lockCache);
+        if (auto it = nodeByDevice.find(itemInfo.st_dev);
+            it != nodeByDevice.end())
+            return it->second;
+    }
+
+    //e.g. /sys/dev/block/8:1 -> ../../devices/pci0000:00/0000:00:17.0/.../block/sda/sda1
+    const std::string devLinkPath = "/sys/dev/block/" + numberTo<std::string>(major(itemInfo.st_dev)) + ':' + numberTo<std::string>(minor(itemInfo.st_dev));
+
+    int node = -1;
+    for (const char* subPath : {"/device/numa_node",           //SCSI/SATA disk => HBA
+                                "/device/device/numa_node",    //NVMe namespace => controller => PCI device
+                                "/../device/numa_node",        //partition: ".." after resolving the symlink is the disk
+                                "/../device/device/numa_node"}) //
+        if (node = readNumaNode(devLinkPath + subPath); node >= 0)
+            break;
+
+    std::lock_guard dummy(lockCache);
+    return nodeByDevice[itemInfo.st_dev] = node; //not a block device (e.g. network share, Btrfs, device mapper): -1
+}
+
+
+int zen::getNetworkNumaNode() //noexcept
+{
+    static const int node = []
+    {
+        int nicNode = -1;
+        for (const std::string& itemName : getSysfsDirItems("/sys/class/net", ""))
+            if (itemName != "." && itemName != "..")
+            {
+                const int n = readNumaNode("/sys/class/net/" + itemName + "/device/numa_node"); //virtual interfaces (lo, bridges, ...) have no "device"
+                if (n < 0)
+                    continue;
+                if (nicNode >= 0 && nicNode != n)
+                    return -1; //NICs on different nodes: route unknown
+                nicNode = n;
+            }
+        return nicNode;
+    }();
+    return node;
+}
+
+
+struct PinThreadToNumaNode::Impl
+{
+    cpu_set_t oldCpus;
+};
+
+
+PinThreadToNumaNode::PinThreadToNumaNode(int numaNode)
+{
+    if (numaNode < 0)
+        return;
+
+    const NumaTopology& topo = getNumaTopology();
+    auto it = topo.nodeCpus.find(numaNode);
+    if (it == topo.nodeCpus.end())
+        return;
+
+    auto impl = std::make_unique<Impl>();
+    if (::sched_getaffinity(0 /*calling thread*/, sizeof(impl->oldCpus), &impl->oldCpus) != 0 ||
+        ::sched_setaffinity(0, sizeof(it->second), &it->second) != 0)
+        return; //best effort
+
+    pimpl_ = std::move(impl);
+    addMetricCount("numa threads pinned", [&] { return numberTo<std::string>(numaNode); }, 1);
+}
+
+
+PinThreadToNumaNode::~PinThreadToNumaNode()
+{
+    if (pimpl_)
+        ::sched_setaffinity(0, sizeof(pimpl_->oldCpus), &pimpl_->oldCpus);
+}
@@ -20,6 +20,7 @@ namespace zen
 class InterruptionStatus;
 
 //migrate towards https://en.cppreference.com/w/cpp/thread/jthread
+//runs on a pooled thread (see runAsync()): join() waits until the function has returned and its captured state is destroyed
 class InterruptibleThread
 {
 public:
@@ -32,8 +33,8 @@ public:
             requestStop();
             join();
         }
-        stdThread_ = std::move(tmp.stdThread_);
-        intStatus_ = std::move(tmp.intStatus_);
+        threadDone_ = std::move(tmp.threadDone_);
+        intStatus_  = std::move(tmp.intStatus_);
         return *this;
     }
 
@@ -49,13 +50,13 @@ public:
         }
     }
 
-    bool joinable () const { return stdThread_.joinable(); }
+    bool joinable () const { return threadDone_.valid(); }
     void requestStop();
-    void join     () { stdThread_.join(); }
-    void detach   () { stdThread_.detach(); }
+    void join     () { threadDone_.get(); }
+    void detach   () { threadDone_ = {}; }
 
 private:
-    std::thread stdThread_;
+    std::future<void> threadDone_;
     std::shared_ptr<InterruptionStatus> intStatus_ = std::make_shared<InterruptionStatus>();
 };
 
@@ -76,9 +77,39 @@ void setCurrentThreadName(const Zstring& threadName);
 bool runningOnMainThread();
 //------------------------------------------------------------------------------------------
 
+/*  NUMA-aware worker placement: optional, process-wide; no-op on single-node systems
+    - topology: sysfs /sys/devices/system/node/node<N>/cpulist, restricted to the CPUs the process may run on
+    - pinned threads allocate node-local memory (first-touch policy) => I/O buffers created by a device's workers stay on its node
+    - device => node: block devices via their disk controller (HBA/NVMe), network devices via the NICs (only if all on the same node)  */
+void enableNumaAffinity(bool enable);
+bool numaAffinityEnabled();
+size_t getNumaNodeCount(); //nodes with usable CPUs; 1 if not NUMA or unknown
+
+//node for a worker pool: "preferredNode" if valid, else round-robin; -1 if NUMA affinity is disabled or not applicable
+int selectNumaNode(int preferredNode);
+
+int getBlockDeviceNumaNode(const Zstring& path); //noexcept; follows symlinks; -1 if unknown (e.g. network share)
+int getNetworkNumaNode(); //noexcept; -1 if unknown or NICs on different nodes
+
+//pin the *calling thread* to the CPUs of a NUMA node: no-op if numaNode < 0; previous affinity restored on destruction (=> pooled threads)
+class PinThreadToNumaNode
+{
+public:
+    explicit PinThreadToNumaNode(int numaNode);
+    ~PinThreadToNumaNode();
+private:
+    PinThreadToNumaNode           (const PinThreadToNumaNode&) = delete;
+    PinThreadToNumaNode& operator=(const PinThreadToNumaNode&) = delete;
+
+    struct Impl;
+    std::unique_ptr<Impl> pimpl_; //nullptr if not pinned
+};
+//------------------------------------------------------------------------------------------
+
 /*  std::async replacement without crappy semantics:
         1. guaranteed to run asynchronously
         2. does not follow C++11 [futures.async], Paragraph 5, where std::future waits for thread in destructor
+        3. runs on a process-wide cache of idle threads: no thread creation + teardown per call
 
     Example:
             Zstring dirPath = ...
@@ -214,6 +245,9 @@ public:
     //context of controlling thread:
     void detach() { detach_ = true; } //not expected to also interrupt!
 
+    //context of controlling thread, before first run(): pin all workers to a NUMA node, see selectNumaNode()
+    void setNumaNode(int numaNode) { numaNode_ = numaNode; }
+
 private:
     ThreadGroup           (const ThreadGroup&) = delete;
     ThreadGroup& operator=(const ThreadGroup&) = delete;
@@ -222,9 +256,10 @@ private:
     {
         Zstring threadName = groupName_ + Zstr('[') + numberTo<Zstring>(worker_.size() + 1) + Zstr('/') + numberTo<Zstring>(threadCountMax_) + Zstr(']');
 
-        worker_.emplace_back([workLoad_ /*clang bug*/= workLoad_ /*share ownership!*/, threadName = std::move(threadName)]() mutable //don't capture "this"! consider detach() and move operations
+        worker_.emplace_back([workLoad_ /*clang bug*/= workLoad_ /*share ownership!*/, threadName = std::move(threadName), numaNode = numaNode_]() mutable //don't capture "this"! consider detach() and move operations
         {
             setCurrentThreadName(threadName);
+            const PinThreadToNumaNode numaAffinity(numaNode);
             WorkLoad& workLoad = workLoad_.ref();
 
             std::unique_lock dummy(workLoad.lock);
@@ -263,6 +298,247 @@ private:
         std::vector<std::function<void()>> onCompletionCallbacks;
     };
 
+    std::vector<InterruptibleThread> worker_;
+    SharedRef<WorkLoad> workLoad_ = makeSharedRef<WorkLoad>();
+    bool detach_ = false;
+    int numaNode_ = -1;
+    size_t threadCountMax_;
+    Zstring groupName_;
+};
+
+
+/*  same interface as ThreadGroup, but scheduling with per-worker task queues and work stealing:
+    - run() from a worker thread of the same group => push to that worker's own queue (e.g. follow-up tasks)
+    - run() from any other thread                  => push to shared injection queue; workers take a batch at a time
+    - idle worker: own queue (FIFO) -> injection queue -> steal from the back of the other workers' queues
+    - wake up a single sleeping worker per new task instead of notify_all()
+    => less lock contention and no thundering herd for many workers and short tasks
+    - task order is FIFO per queue only, not globally!                              */
+template <class Function>
+class WorkStealingThreadGroup
+{
+public:
+    WorkStealingThreadGroup(size_t threadCountMax, const Zstring& groupName) : threadCountMax_(threadCountMax), groupName_(groupName)
+    { if (threadCountMax == 0) throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__)); }
+
+    WorkStealingThreadGroup           (WorkStealingThreadGroup&& tmp) noexcept = default;
+    WorkStealingThreadGroup& operator=(WorkStealingThreadGroup&& tmp) noexcept = default;
+
+    ~WorkStealingThreadGroup()
+    {
+        for (InterruptibleThread& w : worker_)
+            w.requestStop(); //stop *all* at the same time before join!
+
+        if (detach_) //detach() without requestStop() doesn't make sense
+            for (InterruptibleThread& w : worker_)
+                w.detach();
+    }
+
+    //context of controlling OR worker thread, non-blocking:
+    void run(Function&& wi /*should throw ThreadStopRequest when needed*/, bool insertFront = false)
+    {
+        WorkLoad& workLoad = workLoad_.ref();
+        const size_t tasksPending = ++workLoad.tasksPending;
+
+        if (localQueue_ && localQueue_->owner == &workLoad) //called by one of our workers
+            pushTask(workLoad, localQueue_->lock, localQueue_->tasks, std::move(wi), insertFront);
+        else
+            pushTask(workLoad, workLoad.injectLock, workLoad.injectTasks, std::move(wi), insertFront);
+
+        if (workLoad.workerCount < std::min(tasksPending, threadCountMax_))
+        {
+            std::lock_guard dummy(workLoad.spawnLock);
+            if (worker_.size() < std::min(tasksPending, threadCountMax_))
+                addWorkerThread();
+        }
+    }
+
+    //context of controlling thread, blocking:
+    void wait()
+    {
+        auto promiseDone = std::make_shared<std::promise<void>>();
+        std::future<void> allDone = promiseDone->get_future();
+
+        notifyWhenDone([promiseDone] { promiseDone->set_value(); });
+        allDone.get();
+    }
+
+    //non-blocking wait()-alternative: context of controlling thread:
+    void notifyWhenDone(const std::function<void()>& onCompletion /*noexcept! runs on worker thread!*/)
+    {
+        WorkLoad& workLoad = workLoad_.ref();
+        std::lock_guard dummy(workLoad.completionLock);
+
+        if (workLoad.tasksPending == 0)
+            onCompletion();
+        else
+            workLoad.onCompletionCallbacks.push_back(onCompletion);
+    }
+
+    //context of controlling thread:
+    void detach() { detach_ = true; } //not expected to also interrupt!
+
+private:
+    WorkStealingThreadGroup           (const WorkStealingThreadGroup&) = delete;
+    WorkStealingThreadGroup& operator=(const WorkStealingThreadGroup&) = delete;
+
+    struct WorkerQueue
+    {
+        const void* owner = nullptr; //WorkLoad
+        std::mutex lock;
+        RingBuffer<Function> tasks;
+        std::atomic<WorkerQueue*> next{nullptr};
+    };
+
+    struct WorkLoad
+    {
+        std::mutex injectLock;
+        RingBuffer<Function> injectTasks; //tasks from non-worker threads
+
+        std::atomic<WorkerQueue*> queuesFirst{nullptr}; //append-only list of all worker queues
+        std::vector<std::unique_ptr<WorkerQueue>> queuesOwner; //protected by spawnLock
+        std::mutex spawnLock;
+        std::atomic<size_t> workerCount{0};
+
+        std::atomic<size_t> tasksQueued{0};  //tasks not yet taken by a worker
+        std::atomic<size_t> tasksPending{0}; //tasks queued or running
+        std::atomic<size_t> workersSleeping{0};
+        std::mutex sleepLock;
+        std::condition_variable conditionNewTask;
+
+        std::mutex completionLock;
+        std::vector<std::function<void()>> onCompletionCallbacks;
+    };
+
+    static void pushTask(WorkLoad& workLoad, std::mutex& lock, RingBuffer<Function>& tasks, Function&& wi, bool insertFront)
+    {
+        {
+            std::lock_guard dummy(lock);
+            if (insertFront)
+                tasks.push_front(std::move(wi));
+            else
+                tasks.push_back(std::move(wi));
+            ++workLoad.tasksQueued;
+        }
+        //seq_cst: either we see the sleeping worker, or the worker sees tasksQueued > 0 before waiting
+        if (workLoad.workersSleeping > 0)
+        {
+            { std::lock_guard dummy(workLoad.sleepLock); } //don't notify between worker's predicate check and wait
+            workLoad.conditionNewTask.notify_one();
+        }
+    }
+
+    static std::optional<Function> takeTask(WorkLoad& workLoad, WorkerQueue& ownQueue)
+    {
+        std::optional<Function> task;
+        auto takeFront = [&](RingBuffer<Function>& tasks)
+        {
+            task.emplace(std::move(tasks.front())); //noexcept thanks to move
+            tasks.pop_front();
+            --workLoad.tasksQueued;
+        };
+
+        {
+            std::lock_guard dummy(ownQueue.lock);
+            if (!ownQueue.tasks.empty())
+            {
+                takeFront(ownQueue.tasks);
+                return task;
+            }
+        }
+        {
+            std::lock_guard dummy(workLoad.injectLock);
+            if (!workLoad.injectTasks.empty())
+            {
+                takeFront(workLoad.injectTasks);
+
+                //take a fair share for later, so that the injection queue isn't hit for every single task
+                if (const size_t batchSize = std::min<size_t>(workLoad.injectTasks.size() / workLoad.workerCount, 16);
+                    batchSize > 0)
+                {
+                    std::lock_guard dummy2(ownQueue.lock); //lock order: injectLock before WorkerQueue::lock
+                    for (size_t i = 0; i < batchSize; ++i)
+                    {
+                        ownQueue.tasks.push_back(std::move(workLoad.injectTasks.front()));
+                        workLoad.injectTasks.pop_front();
+                    }
+                }
+                return task;
+            }
+        }
+
+        //steal starting with the queue following our own => spread victims among thieves
+        auto nextQueue = [&](const WorkerQueue& queue)
+        {
+            WorkerQueue* next = queue.next;
+            return next ? next : workLoad.queuesFirst.load();
+        };
+        for (WorkerQueue* victim = nextQueue(ownQueue); victim != &ownQueue; victim = nextQueue(*victim))
+        {
+            std::lock_guard dummy(victim->lock);
+            if (!victim->tasks.empty())
+            {
+                task.emplace(std::move(victim->tasks.back()));
+                victim->tasks.pop_back();
+                --workLoad.tasksQueued;
+                return task;
+            }
+        }
+        return task;
+    }
+
+    void addWorkerThread() //context: spawnLock held
+    {
+        Zstring threadName = groupName_ + Zstr('[') + numberTo<Zstring>(worker_.size() + 1) + Zstr('/') + numberTo<Zstring>(threadCountMax_) + Zstr(']');
+
+        WorkLoad& wl = workLoad_.ref();
+        WorkerQueue& ownQueue = *wl.queuesOwner.emplace_back(std::make_unique<WorkerQueue>());
+        ownQueue.owner = &wl;
+        if (wl.queuesOwner.size() == 1) //publish: append-only list, queues live as long as WorkLoad
+            wl.queuesFirst = &ownQueue;
+        else
+            wl.queuesOwner[wl.queuesOwner.size() - 2]->next = &ownQueue;
+        ++wl.workerCount; //before thread start: takeTask() divides by it
+
+        worker_.emplace_back([workLoad_ /*clang bug*/= workLoad_ /*share ownership!*/, &ownQueue, threadName = std::move(threadName)]() mutable //don't capture "this"! consider detach() and move operations
+        {
+            setCurrentThreadName(threadName);
+            WorkLoad& workLoad = workLoad_.ref();
+            localQueue_ = &ownQueue;
+            ZEN_ON_SCOPE_EXIT(localQueue_ = nullptr); //pooled thread: don't leak into the next task
+
+            for (;;)
+            {
+                std::optional<Function> task = takeTask(workLoad, ownQueue);
+                if (!task)
+                {
+                    std::unique_lock dummy(workLoad.sleepLock);
+                    ++workLoad.workersSleeping;
+                    ZEN_ON_SCOPE_EXIT(--workLoad.workersSleeping);
+                    interruptibleWait(workLoad.conditionNewTask, dummy, [&] { return workLoad.tasksQueued > 0; }); //throw ThreadStopRequest
+                    continue;
+                }
+
+                (*task)(); //throw ThreadStopRequest?
+                task.reset();
+
+                if (--workLoad.tasksPending == 0)
+                {
+                    std::vector<std::function<void()>> callbacks;
+                    {
+                        std::lock_guard dummy(workLoad.completionLock);
+                        if (workLoad.tasksPending == 0) //there might be new work meanwhile
+                            callbacks.swap(workLoad.onCompletionCallbacks);
+                    }
+                    for (const auto& cb : callbacks)
+                        cb(); //noexcept!
+                }
+            }
+        });
+    }
+
+    static inline thread_local WorkerQueue* localQueue_ = nullptr; //worker threads only
+
     std::vector<InterruptibleThread> worker_;
     SharedRef<WorkLoad> workLoad_ = makeSharedRef<WorkLoad>();
     bool detach_ = false;
@@ -281,15 +557,22 @@ private:
 
 namespace impl
 {
+/*  process-wide cache of idle threads shared by runAsync(), AsyncFirstResult and InterruptibleThread (=> ThreadGroup, WorkStealingThreadGroup)
+    => jobs with hundreds of folder pairs don't create and tear down threads for every phase and device
+    - task is run on an idle thread if available, otherwise on a new (detached) thread
+    - thread-local state survives between tasks: reset in the task if it must not leak into the next one!   */
+void runOnPooledThread(std::function<void()>&& task);
+
+
 template <class Function> inline
 auto runAsync(Function&& fun, std::true_type /*copy-constructible*/)
 {
     using ResultType = decltype(fun());
 
     //note: std::packaged_task does NOT support move-only function objects!
-    std::packaged_task<ResultType()> pt(std::forward<Function>(fun));
-    auto fut = pt.get_future();
-    std::thread(std::move(pt)).detach(); //we have to explicitly detach since C++11: [thread.thread.destr] ~thread() calls std::terminate() if joinable()!!!
+    auto pt = std::make_shared<std::packaged_task<ResultType()>>(std::forward<Function>(fun)); //std::function requires copy-constructible
+    auto fut = pt->get_future();
+    runOnPooledThread([pt] { (*pt)(); });
     return fut;
 }
 
@@ -373,9 +656,9 @@ template <class T>
 template <class Fun> inline
 void AsyncFirstResult<T>::addJob(Fun&& f) //f must return a std::optional<T> containing a value on success
 {
-    std::thread t([asyncResult = this->asyncResult_, f = std::forward<Fun>(f)] { asyncResult->reportFinished(f()); });
+    auto fun = std::make_shared<std::decay_t<Fun>>(std::forward<Fun>(f)); //std::function requires copy-constructible
+    impl::runOnPooledThread([asyncResult = this->asyncResult_, fun] { asyncResult->reportFinished((*fun)()); });
     ++jobsTotal_;
-    t.detach(); //we have to be explicit since C++11: [thread.thread.destr] ~thread() calls std::terminate() if joinable()!!!
 }
 
 
@@ -502,18 +785,26 @@ void interruptibleSleep(const std::chrono::duration<Rep, Period>& relTime) //thr
 template <class Function> inline
 InterruptibleThread::InterruptibleThread(Function&& f)
 {
-    stdThread_ = std::thread([f = std::forward<Function>(f),
-                                intStatus = this->intStatus_]() mutable
-    {
-        assert(!impl::threadLocalInterruptionStatus);
-        impl::threadLocalInterruptionStatus = intStatus.get();
-        ZEN_ON_SCOPE_EXIT(impl::threadLocalInterruptionStatus = nullptr);
+    auto promiseDone = std::make_shared<std::promise<void>>();
+    threadDone_ = promiseDone->get_future();
 
-        try
+    impl::runOnPooledThread([fun = std::make_shared<std::decay_t<Function>>(std::forward<Function>(f)), //std::function requires copy-constructible
+                                   intStatus = this->intStatus_, promiseDone]() mutable
+    {
         {
-            f(); //throw ThreadStopRequest
+            assert(!impl::threadLocalInterruptionStatus);
+            impl::threadLocalInterruptionStatus = intStatus.get();
+            ZEN_ON_SCOPE_EXIT(impl::threadLocalInterruptionStatus = nullptr);
+
+            try
+            {
+                (*fun)(); //throw ThreadStopRequest
+            }
+            catch (ThreadStopRequest&) {}
+
+            fun.reset(); //captured state must be gone when join() returns, just like for a finished std::thread
         }
-        catch (ThreadStopRequest&) {}
+        promiseDone->set_value();
     });
 }
 
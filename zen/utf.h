@@ -9,8 +9,16 @@
 
 #include <cstdint>
 #include <iterator>
+#include <algorithm>
+#include <optional>
 #include "string_tools.h" //copyStringTo
 
+#if defined __x86_64__ || defined __i386__
+    #include <immintrin.h>
+#elif defined __aarch64__
+    #include <arm_neon.h>
+#endif
+
 
 namespace zen
 {
@@ -306,17 +314,171 @@ using UtfDecoder = impl::UtfDecoderImpl<CharType, sizeof(CharType)>;
 
 //-------------------------------------------------------------------------------------------
 
+namespace impl
+{
+/* ASCII fast path: most item names, paths and log lines are plain ASCII => find length of ASCII run with wide vectors,
+   then widen/narrow it without decoding code point by code point; the scalar decoders remain the reference for everything else
+    => UTF-8  runtime dispatch: AVX2 if supported by CPU, else SSE2 (x86-64 baseline), NEON on ARM64
+    => UTF-32 SSE2/NEON                                                                                        */
+template <class CharType> inline
+bool isAsciiUnit(CharType c) { return static_cast<std::make_unsigned_t<CharType>>(c) < 0x80; }
+
+template <class CharType> inline
+size_t getAsciiLengthGeneric(const CharType* str, size_t len)
+{
+    size_t i = 0;
+    while (i < len && isAsciiUnit(str[i]))
+        ++i;
+    return i;
+}
+
+using AsciiLengthFun = size_t (*)(const Char8* str, size_t len);
+
+#if defined __x86_64__ || defined __i386__
+__attribute__((target("avx2"))) inline
+size_t getAsciiLengthAvx2(const Char8* str, size_t len)
+{
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32)
+        if (const int mask = _mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(str + i)))) //high bit set => non-ASCII
+            return i + __builtin_ctz(mask);
+    return i + getAsciiLengthGeneric(str + i, len - i);
+}
+
+__attribute__((target("sse2"))) inline
+size_t getAsciiLengthSse2(const Char8* str, size_t len)
+{
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16)
+        if (const int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i))))
+            return i + __builtin_ctz(mask);
+    return i + getAsciiLengthGeneric(str + i, len - i);
+}
+
+__attribute__((target("sse2"))) inline
+size_t getAsciiLengthSse2(const CodePoint* str, size_t len)
+{
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8)
+    {
+        const auto p = reinterpret_cast<const __m128i*>(str + i);
+        const __m128i highBits = _mm_srli_epi32(_mm_or_si128(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)), 7);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(highBits, _mm_setzero_si128())) != 0xffff)
+            break; //=> find exact position below
+    }
+    return i + getAsciiLengthGeneric(str + i, len - i);
+}
+
+inline AsciiLengthFun getAsciiLengthKernel()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return getAsciiLengthAvx2;
+    if (__builtin_cpu_supports("sse2"))
+        return getAsciiLengthSse2;
+    return getAsciiLengthGeneric<Char8>;
+}
+
+inline size_t getAsciiLengthUtf32(const CodePoint* str, size_t len)
+{
+    static const bool haveSse2 = [] { __builtin_cpu_init(); return __builtin_cpu_supports("sse2"); }(); //thread-safe init (C++11)
+    return haveSse2 ? getAsciiLengthSse2(str, len) : getAsciiLengthGeneric(str, len);
+}
+
+#elif defined __aarch64__
+inline size_t getAsciiLengthNeon(const Char8* str, size_t len)
+{
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16)
+        if (vmaxvq_u8(vld1q_u8(str + i)) >= 0x80)
+            break; //=> find exact position below
+    return i + getAsciiLengthGeneric(str + i, len - i);
+}
+
+inline AsciiLengthFun getAsciiLengthKernel() { return getAsciiLengthNeon; } //NEON is mandatory on ARMv8
+
+inline size_t getAsciiLengthUtf32(const CodePoint* str, size_t len)
+{
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8)
+        if (vmaxvq_u32(vorrq_u32(vld1q_u32(str + i), vld1q_u32(str + i + 4))) >= 0x80)
+            break;
+    return i + getAsciiLengthGeneric(str + i, len - i);
+}
+
+#else
+inline AsciiLengthFun getAsciiLengthKernel() { return getAsciiLengthGeneric<Char8>; }
+inline size_t getAsciiLengthUtf32(const CodePoint* str, size_t len) { return getAsciiLengthGeneric(str, len); }
+#endif
+
+
+template <class CharType> inline
+size_t getAsciiLength(const CharType* str, size_t len) //length of leading ASCII run
+{
+    if constexpr (sizeof(CharType) == 1)
+    {
+        static const AsciiLengthFun kernel = getAsciiLengthKernel(); //thread-safe init (C++11)
+        return kernel(reinterpret_cast<const Char8*>(str), len);
+    }
+    else if constexpr (sizeof(CharType) == 4)
+        return getAsciiLengthUtf32(reinterpret_cast<const CodePoint*>(str), len);
+    else //Windows: UTF16-wchar_t
+        return getAsciiLengthGeneric(str, len);
+}
+
+
+template <class CharTrg, class String, class CharSrc> inline
+void appendAscii(String& output, const CharSrc* first, const CharSrc* last)
+{
+    CharTrg buf[256]; //widen/narrow in blocks: loop is auto-vectorized
+    while (first != last)
+    {
+        const size_t blockSize = std::min(static_cast<size_t>(last - first), std::size(buf));
+        for (size_t i = 0; i < blockSize; ++i)
+            buf[i] = static_cast<CharTrg>(first[i]);
+        output.append(buf, blockSize);
+        first += blockSize;
+    }
+}
+
+
+/*  split into ASCII and non-ASCII runs: a non-ASCII run ends before an ASCII unit which is never part of a multi-unit encoding
+    => decoding each non-ASCII run separately yields the same result as decoding the whole string (incl. replacement chars)   */
+template <class CharType, class OnAsciiRun, class OnCodePoint> inline
+void forEachUtfRun(const CharType* it, const CharType* last, OnAsciiRun onAsciiRun, OnCodePoint onCodePoint)
+{
+    while (it != last)
+    {
+        const CharType* const itAsciiEnd = it + getAsciiLength(it, last - it);
+        if (itAsciiEnd != it)
+        {
+            onAsciiRun(it, itAsciiEnd);
+            it = itAsciiEnd;
+        }
+
+        const CharType* const itNonAsciiEnd = std::find_if(it, last, [](CharType c) { return isAsciiUnit(c); });
+        UtfDecoder<CharType> decoder(it, itNonAsciiEnd - it);
+        while (const std::optional<CodePoint> cp = decoder.getNext())
+            if (!onCodePoint(*cp))
+                return;
+        it = itNonAsciiEnd;
+    }
+}
+}
+
+//-------------------------------------------------------------------------------------------
+
 template <class UtfString> inline
 bool isValidUtf(const UtfString& str)
 {
     using namespace impl;
+    using CharType = GetCharTypeT<UtfString>;
 
-    UtfDecoder<GetCharTypeT<UtfString>> decoder(strBegin(str), strLength(str));
-    while (const std::optional<CodePoint> cp = decoder.getNext())
-        if (*cp == REPLACEMENT_CHAR)
-            return false;
-
-    return true;
+    bool valid = true;
+    const CharType* const first = strBegin(str);
+    forEachUtfRun(first, first + strLength(str), [](const CharType*, const CharType*) {},
+                  [&](CodePoint cp) { return valid = cp != REPLACEMENT_CHAR; });
+    return valid;
 }
 
 
@@ -363,12 +525,14 @@ TargetString utfTo(const SourceString& str, std::false_type)
     using CharTrg = GetCharTypeT<TargetString>;
     static_assert(sizeof(CharSrc) != sizeof(CharTrg));
 
-    TargetString output;
+    const CharSrc* const first = strBegin(str);
+    const size_t len = strLength(str);
 
-    UtfDecoder<CharSrc> decoder(strBegin(str), strLength(str));
-    while (const std::optional<CodePoint> cp = decoder.getNext())
-        codePointToUtf<CharTrg>(*cp, [&](CharTrg c) { output += c; });
+    TargetString output;
+    output.reserve(len); //exact for ASCII
 
+    forEachUtfRun(first, first + len, [&](const CharSrc* itAscii, const CharSrc* itAsciiEnd) { appendAscii<CharTrg>(output, itAscii, itAsciiEnd); },
+                  [&](CodePoint cp) { codePointToUtf<CharTrg>(cp, [&](CharTrg c) { output += c; }); return true; });
     return output;
 }
 
@@ -82,7 +82,7 @@ size_t zen::impl::zlib_decompress(const void* src, size_t srcLen, void* trg, siz
 class InputStreamAsGzip::Impl
 {
 public:
-    Impl(const std::function<size_t(void* buffer, size_t bytesToRead)>& readBlock /*throw X*/) : //throw SysError; returning 0 signals EOF: Posix read() semantics
+    Impl(const std::function<size_t(void* buffer, size_t bytesToRead)>& readBlock /*throw X*/, int level) : //throw SysError; returning 0 signals EOF: Posix read() semantics
         readBlock_(readBlock)
     {
         const int windowBits = MAX_WBITS + 16; //"add 16 to windowBits to write a simple gzip header"
@@ -92,7 +92,7 @@ public:
         static_assert(memLevel <= MAX_MEM_LEVEL);
 
         const int rv = ::deflateInit2(&gzipStream_,          //z_streamp strm
-                                      3 /*see db_file.cpp*/, //int level
+                                      level,                 //int level
                                       Z_DEFLATED,            //int method
                                       windowBits,            //int windowBits
                                       memLevel,              //int memLevel
@@ -148,7 +148,7 @@ private:
 };
 
 
-zen::InputStreamAsGzip::InputStreamAsGzip(const std::function<size_t(void* buffer, size_t bytesToRead)>& readBlock /*throw X*/) : pimpl_(std::make_unique<Impl>(readBlock)) {} //throw SysError
+zen::InputStreamAsGzip::InputStreamAsGzip(const std::function<size_t(void* buffer, size_t bytesToRead)>& readBlock /*throw X*/, int level) : pimpl_(std::make_unique<Impl>(readBlock, level)) {} //throw SysError
 zen::InputStreamAsGzip::~InputStreamAsGzip() {}
 size_t zen::InputStreamAsGzip::read(void* buffer, size_t bytesToRead) { return pimpl_->read(buffer, bytesToRead); } //throw SysError, X
 
@@ -171,3 +171,177 @@ std::string zen::compressAsGzip(const void* buffer, size_t bufSize) //throw SysE
     });
     return bufferedLoad<std::string>(gzipStream); //throw SysError
 }
+
+
+namespace
+{
+const size_t ZLIB_STREAM_BLOCK_SIZE = 128 * 1024; //bounded buffers for both input and output
+}
+
+
+class OutputStreamAsZlib::Impl
+{
+public:
+    Impl(int level, const std::function<void(const void* buffer, size_t bytesToWrite)>& writeBlock /*throw X*/) : //throw SysError
+        writeBlock_(writeBlock)
+    {
+        const int rv = ::deflateInit2(&zlibStream_,          //z_streamp strm
+                                      level,                 //int level
+                                      Z_DEFLATED,            //int method
+                                      MAX_WBITS,             //int windowBits: zlib format, same as compress2()
+                                      9,                     //int memLevel: see InputStreamAsGzip
+                                      Z_DEFAULT_STRATEGY);   //int strategy
+        if (rv != Z_OK)
+            throw SysError(formatSystemError("zlib deflateInit2", getZlibErrorLiteral(rv), L""));
+    }
+
+    ~Impl()
+    {
+        [[maybe_unused]] const int rv = ::deflateEnd(&zlibStream_);
+        assert(rv == Z_OK || rv == Z_DATA_ERROR /*freed prematurely, e.g. exception before finalize()*/);
+    }
+
+    void write(const void* buffer, size_t bytesToWrite) //throw SysError, X
+    {
+        //collect small writes (serialize.h: writeNumber()) => don't call deflate() for every few bytes
+        while (bytesToWrite > 0)
+        {
+            const size_t chunkSize = std::min(bytesToWrite, bufIn_.size() - bufInEnd_);
+            std::memcpy(&bufIn_[bufInEnd_], buffer, chunkSize);
+            bufInEnd_    += chunkSize;
+            buffer        = static_cast<const std::byte*>(buffer) + chunkSize;
+            bytesToWrite -= chunkSize;
+
+            if (bufInEnd_ == bufIn_.size())
+                deflateBuffer(Z_NO_FLUSH); //throw SysError, X
+        }
+    }
+
+    void finalize() { deflateBuffer(Z_FINISH); } //throw SysError, X
+
+private:
+    void deflateBuffer(int flush) //throw SysError, X
+    {
+        zlibStream_.next_in  = reinterpret_cast<z_const Bytef*>(&bufIn_[0]);
+        zlibStream_.avail_in = static_cast<uInt>(bufInEnd_);
+
+        for (;;)
+        {
+            zlibStream_.next_out  = reinterpret_cast<Bytef*>(&bufOut_[0]);
+            zlibStream_.avail_out = static_cast<uInt>(bufOut_.size());
+
+            const int rv = ::deflate(&zlibStream_, flush);
+            if (rv != Z_OK && rv != Z_STREAM_END && rv != Z_BUF_ERROR /*no progress possible: not fatal*/)
+                throw SysError(formatSystemError("zlib deflate", getZlibErrorLiteral(rv), L""));
+
+            if (const size_t bytesOut = bufOut_.size() - zlibStream_.avail_out;
+                bytesOut > 0)
+                writeBlock_(&bufOut_[0], bytesOut); //throw X
+
+            if (flush == Z_FINISH ? rv == Z_STREAM_END :
+                zlibStream_.avail_in == 0 && zlibStream_.avail_out != 0)
+                break;
+        }
+        bufInEnd_ = 0;
+    }
+
+    const std::function<void(const void* buffer, size_t bytesToWrite)> writeBlock_; //throw X
+    std::vector<std::byte> bufIn_  = std::vector<std::byte>(ZLIB_STREAM_BLOCK_SIZE);
+    size_t bufInEnd_ = 0;
+    std::vector<std::byte> bufOut_ = std::vector<std::byte>(ZLIB_STREAM_BLOCK_SIZE);
+    z_stream zlibStream_ = {};
+};
+
+
+zen::OutputStreamAsZlib::OutputStreamAsZlib(int level, const std::function<void(const void* buffer, size_t bytesToWrite)>& writeBlock /*throw X*/) :
+    pimpl_(std::make_unique<Impl>(level, writeBlock)) {} //throw SysError
+zen::OutputStreamAsZlib::~OutputStreamAsZlib() {}
+void zen::OutputStreamAsZlib::write(const void* buffer, size_t bytesToWrite) { pimpl_->write(buffer, bytesToWrite); } //throw SysError, X
+void zen::OutputStreamAsZlib::finalize() { pimpl_->finalize(); } //throw SysError, X
+
+
+class InputStreamFromZlib::Impl
+{
+public:
+    Impl(const std::function<size_t(void* buffer, size_t bytesToRead)>& readBlock /*throw X*/) : //throw SysError; returning 0 signals EOF: Posix read() semantics
+        readBlock_(readBlock)
+    {
+        const int windowBits = MAX_WBITS + 32; //"add 32 to windowBits to enable zlib and gzip decoding with automatic header detection"
+
+        const int rv = ::inflateInit2(&zlibStream_, windowBits);
+        if (rv != Z_OK)
+            throw SysError(formatSystemError("zlib inflateInit2", getZlibErrorLiteral(rv), L""));
+    }
+
+    ~Impl()
+    {
+        [[maybe_unused]] const int rv = ::inflateEnd(&zlibStream_);
+        assert(rv == Z_OK);
+    }
+
+    size_t read(void* buffer, size_t bytesToRead) //throw SysError, X; return "bytesToRead" bytes unless end of stream!
+    {
+        if (bytesToRead == 0) //"read() with a count of 0 returns zero" => indistinguishable from end of file! => check!
+            throw std::logic_error("Contract violation! " + std::string(__FILE__) + ':' + numberTo<std::string>(__LINE__));
+
+        //serve small reads (serialize.h: readNumber()) from decompressed buffer => don't call inflate() for every few bytes
+        std::byte*       it    = static_cast<std::byte*>(buffer);
+        std::byte* const itEnd = it + bytesToRead;
+        for (;;)
+        {
+            const size_t chunkSize = std::min<size_t>(itEnd - it, bufOutEnd_ - bufOutPos_);
+            std::memcpy(it, &bufOut_[bufOutPos_], chunkSize);
+            bufOutPos_ += chunkSize;
+            it         += chunkSize;
+
+            if (it == itEnd || streamEnd_)
+                return it - static_cast<std::byte*>(buffer);
+
+            inflateBuffer(); //throw SysError, X
+        }
+    }
+
+private:
+    void inflateBuffer() //throw SysError, X
+    {
+        zlibStream_.next_out  = reinterpret_cast<Bytef*>(&bufOut_[0]);
+        zlibStream_.avail_out = static_cast<uInt>(bufOut_.size());
+
+        while (zlibStream_.avail_out != 0)
+        {
+            if (zlibStream_.avail_in == 0)
+            {
+                const size_t bytesRead = readBlock_(&bufIn_[0], bufIn_.size()); //throw X; returning 0 signals EOF: Posix read() semantics
+                if (bytesRead == 0)
+                    throw SysError(formatSystemError("zlib inflate", L"", L"Unexpected end of stream."));
+
+                zlibStream_.next_in  = reinterpret_cast<z_const Bytef*>(&bufIn_[0]);
+                zlibStream_.avail_in = static_cast<uInt>(bytesRead);
+            }
+
+            const int rv = ::inflate(&zlibStream_, Z_NO_FLUSH);
+            if (rv == Z_STREAM_END) //trailing input (if any) is ignored
+            {
+                streamEnd_ = true;
+                break;
+            }
+            if (rv != Z_OK)
+                throw SysError(formatSystemError("zlib inflate", getZlibErrorLiteral(rv), L""));
+        }
+        bufOutPos_ = 0;
+        bufOutEnd_ = bufOut_.size() - zlibStream_.avail_out;
+    }
+
+    const std::function<size_t(void* buffer, size_t bytesToRead)> readBlock_; //throw X
+    bool streamEnd_ = false;
+    std::vector<std::byte> bufIn_  = std::vector<std::byte>(ZLIB_STREAM_BLOCK_SIZE);
+    std::vector<std::byte> bufOut_ = std::vector<std::byte>(ZLIB_STREAM_BLOCK_SIZE);
+    size_t bufOutPos_ = 0;
+    size_t bufOutEnd_ = 0;
+    z_stream zlibStream_ = {};
+};
+
+
+zen::InputStreamFromZlib::InputStreamFromZlib(const std::function<size_t(void* buffer, size_t bytesToRead)>& readBlock /*throw X*/) : pimpl_(std::make_unique<Impl>(readBlock)) {} //throw SysError
+zen::InputStreamFromZlib::~InputStreamFromZlib() {}
+size_t zen::InputStreamFromZlib::read(void* buffer, size_t bytesToRead) { return pimpl_->read(buffer, bytesToRead); } //throw SysError, X
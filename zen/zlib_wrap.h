@@ -28,7 +28,8 @@ class InputStreamAsGzip //convert input stream into gzip on the fly
 {
 public:
     explicit InputStreamAsGzip( //throw SysError
-        const std::function<size_t(void* buffer, size_t bytesToRead)>& readBlock /*throw X;  returning 0 signals EOF: Posix read() semantics*/);
+        const std::function<size_t(void* buffer, size_t bytesToRead)>& readBlock /*throw X;  returning 0 signals EOF: Posix read() semantics*/,
+        int level = 3 /*see db_file.cpp*/);
     ~InputStreamAsGzip();
 
     size_t read(void* buffer, size_t bytesToRead); //throw SysError, X; return "bytesToRead" bytes unless end of stream!
@@ -41,6 +42,40 @@ private:
 std::string compressAsGzip(const void* buffer, size_t bufSize); //throw SysError
 
 
+/*  chunked streaming with bounded buffers: peak memory independent from payload size
+    - raw zlib format: same as compress() output *after* its 8-byte uncompressed size prefix
+    - decompression also detects gzip format (e.g. output of InputStreamAsGzip)             */
+class OutputStreamAsZlib //push data, receive compressed blocks
+{
+public:
+    OutputStreamAsZlib(int level, //throw SysError
+                       const std::function<void(const void* buffer, size_t bytesToWrite)>& writeBlock /*throw X*/);
+    ~OutputStreamAsZlib();
+
+    void write(const void* buffer, size_t bytesToWrite); //throw SysError, X
+    void finalize();                                     //throw SysError, X; call exactly once after last write()
+
+private:
+    class Impl;
+    const std::unique_ptr<Impl> pimpl_;
+};
+
+
+class InputStreamFromZlib //pull decompressed data from compressed input stream
+{
+public:
+    explicit InputStreamFromZlib( //throw SysError
+        const std::function<size_t(void* buffer, size_t bytesToRead)>& readBlock /*throw X;  returning 0 signals EOF: Posix read() semantics*/);
+    ~InputStreamFromZlib();
+
+    size_t read(void* buffer, size_t bytesToRead); //throw SysError, X; return "bytesToRead" bytes unless end of stream!
+
+private:
+    class Impl;
+    const std::unique_ptr<Impl> pimpl_;
+};
+
+
 
 
 
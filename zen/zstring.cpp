@@ -21,6 +21,9 @@ Zstring getUpperCase(const Zstring& str)
     //fast pre-check:
     if (isAsciiString(str)) //perf: in the range of 3.5ns
     {
+        if (std::none_of(str.begin(), str.end(), [](Zchar c) { return Zstr('a') <= c && c <= Zstr('z'); }))
+            return str; //perf: return ref-counted copy => no memory allocation
+
         Zstring output = str;
         for (Zchar& c : output)
             c = asciiToUpper(c);
@@ -143,8 +146,14 @@ std::weak_ordering compareNoCaseUtf8(const char* lhs, size_t lhsLen, const char*
     //- wcsncasecmp: https://opensource.apple.com/source/Libc/Libc-763.12/string/wcsncasecmp-fbsd.c
     // => re-implement comparison based on g_unichar_tolower() to avoid memory allocations
 
-    UtfDecoder<char> decL(lhs, lhsLen);
-    UtfDecoder<char> decR(rhs, rhsLen);
+    //fast path: skip common ASCII prefix without UTF decoding and glib calls (ASCII upper-case is identical to Unicode's)
+    size_t pos = 0;
+    for (const size_t posEnd = std::min(lhsLen, rhsLen); pos < posEnd && isAsciiChar(lhs[pos]) && isAsciiChar(rhs[pos]); ++pos)
+        if (const char charL = asciiToUpper(lhs[pos]), charR = asciiToUpper(rhs[pos]); charL != charR)
+            return makeUnsigned(charL) <=> makeUnsigned(charR); //unsigned char-comparison is the convention!
+
+    UtfDecoder<char> decL(lhs + pos, lhsLen - pos);
+    UtfDecoder<char> decR(rhs + pos, rhsLen - pos);
     for (;;)
     {
         const std::optional<impl::CodePoint> cpL = decL.getNext();
@@ -245,3 +254,57 @@ std::weak_ordering compareNatural(const Zstring& lhs, const Zstring& rhs)
     }
 
 }
+
+
+std::string getNaturalSortKey(const Zstring& str)
+{
+    /*  same blocks as compareNatural(), each starting with a tag byte: "nothing" < whitespace < number < text
+        - number: leading zeros removed; order-preserving digit count, then the digits
+        - text:   upper-case code points as UTF-8 (preserves code point order) + null-termination: "nothing" before "something"
+        => no block is a prefix of a different block                                                                        */
+    const Zstring& strNorm = getUnicodeNormalForm(str);
+
+    std::string key;
+    key.reserve(strNorm.size() + 8);
+
+    const char*       it    = strNorm.c_str();
+    const char* const itEnd = it + strNorm.size();
+    while (it != itEnd)
+        if (isWhiteSpace(*it))
+        {
+            key += '\x01';
+            while (++it != itEnd && isWhiteSpace(*it))
+                ;
+        }
+        else if (isDigit(*it))
+        {
+            while (it != itEnd && *it == '0') ++it;
+            const char* const digitsBegin = it;
+            while (it != itEnd && isDigit(*it)) ++it;
+
+            const size_t digitCount = it - digitsBegin; //more digits means bigger number
+            key += '\x02';
+            if (digitCount < 0xff)
+                key += static_cast<char>(digitCount);
+            else
+            {
+                key += '\xff';
+                for (int i = 3; i >= 0; --i)
+                    key += static_cast<char>(static_cast<uint32_t>(digitCount) >> (8 * i));
+            }
+            key.append(digitsBegin, it);
+        }
+        else
+        {
+            const char* const textBegin = it++;
+            while (it != itEnd && !isWhiteSpace(*it) && !isDigit(*it)) ++it;
+
+            key += '\x03';
+            UtfDecoder<char> decoder(textBegin, it - textBegin);
+            while (const std::optional<impl::CodePoint> cp = decoder.getNext())
+                impl::codePointToUtf<char>(::g_unichar_toupper(*cp), [&](char c) { key += c; }); //same as compareNoCaseUtf8()
+            key += '\0';
+        }
+
+    return key;
+}
@@ -23,6 +23,10 @@ using Zstring = zen::Zbase<Zchar>;
 using Zstringc = zen::Zbase<char>;
 //using Zstringw = zen::Zbase<wchar_t>;
 
+//memory accounting estimate: descriptor + null-terminated buffer (capacity may be larger); ref-counted copies are counted by every owner
+template <class Char> inline
+size_t getHeapSize(const zen::Zbase<Char>& str) { return str.empty() ? 0 : 3 * sizeof(uint32_t) + (str.size() + 1) * sizeof(Char); }
+
 
 /* Caveat: don't expect input/output string sizes to match:
     - different UTF-8 encoding length of upper-case chars
@@ -43,7 +47,14 @@ Zstring replaceCpyAsciiNoCase(const Zstring& str, const Zstring& oldTerm, const
 
 //------------------------------------------------------------------------------------------
 
-inline bool equalNoCase(const Zstring& lhs, const Zstring& rhs) { return getUpperCase(lhs) == getUpperCase(rhs); }
+inline
+bool equalNoCase(const Zstring& lhs, const Zstring& rhs)
+{
+    if (zen::isAsciiString(lhs) && zen::isAsciiString(rhs)) //perf: avoid memory allocations of getUpperCase()
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](Zchar charL, Zchar charR) { return zen::asciiToUpper(charL) == zen::asciiToUpper(charR); });
+
+    return getUpperCase(lhs) == getUpperCase(rhs);
+}
 
 struct ZstringNoCase //use as STL container key: avoid needless upper-case conversions during std::map<>::find()
 {
@@ -69,6 +80,9 @@ struct LessNativePath { bool operator()(const Zstring& lhs, const Zstring& rhs)
 std::weak_ordering compareNatural(const Zstring& lhs, const Zstring& rhs);
 
 struct LessNaturalSort { bool operator()(const Zstring& lhs, const Zstring& rhs) const { return std::is_lt(compareNatural(lhs, rhs)); } };
+
+//binary collation key: byte-wise comparison (std::string) is equivalent to compareNatural() => precompute when sorting many items
+std::string getNaturalSortKey(const Zstring& str);
 //------------------------------------------------------------------------------------------
 
 
@@ -76,13 +76,17 @@ public:
     {
         std::string attrValue;
         writeText(value, attrValue);
+        setAttribute(std::move(name), std::move(attrValue));
+    }
 
+    void setAttribute(std::string name, std::string&& value) //perf
+    {
         auto it = attributesSorted_.find(name);
         if (it != attributesSorted_.end())
-            it->second->value = std::move(attrValue);
+            it->second->value = std::move(value);
         else
         {
-            auto itBack = attributes_.insert(attributes_.end(), {name, std::move(attrValue)});
+            auto itBack = attributes_.insert(attributes_.end(), {name, std::move(value)});
             attributesSorted_.emplace(std::move(name), itBack);
         }
     }
@@ -9,6 +9,8 @@
 
 #include <cstdio>
 #include <cstddef> //ptrdiff_t; req. on Linux
+#include <unordered_map>
+#include <unordered_set>
 #include <zen/string_tools.h>
 #include "dom.h"
 
@@ -301,17 +303,18 @@ struct Token
     };
 
     Token(Type t) : type(t) {}
-    Token(const std::string&  txt) : type(TK_NAME), name(txt) {}
-    Token(      std::string&& txt) : type(TK_NAME), name(std::move(txt)) {}
+    Token(std::string_view txt) : type(TK_NAME), name(txt) {}
 
     Type type;
-    std::string name; //filled if type == TK_NAME
+    std::string_view name; //filled if type == TK_NAME: *not* yet denormalized, points into the input stream
 };
 
+
+//single pass over the input buffer: no copy of the stream, tokens and values are string_views until stored in the DOM
 class Scanner
 {
 public:
-    explicit Scanner(const std::string& stream) : stream_(stream), pos_(stream_.begin())
+    explicit Scanner(std::string_view stream) : stream_(stream), pos_(stream_.begin())
     {
         if (zen::startsWith(stream_, BYTE_ORDER_MARK_UTF8))
             pos_ += strLength(BYTE_ORDER_MARK_UTF8);
@@ -319,29 +322,44 @@ public:
 
     Token getNextToken() //throw XmlParsingError
     {
-        //skip whitespace
-        pos_ = std::find_if_not(pos_, stream_.end(), isWhiteSpace<char>);
+        for (;;)
+        {
+            //skip whitespace
+            pos_ = std::find_if_not(pos_, stream_.end(), isWhiteSpace<char>);
 
-        if (pos_ == stream_.end())
-            return Token::TK_END;
+            if (pos_ == stream_.end())
+                return Token::TK_END;
 
-        //skip XML comments
-        if (startsWith(xmlCommentBegin_))
-        {
-            auto it = std::search(pos_ + xmlCommentBegin_.size(), stream_.end(), xmlCommentEnd_.begin(), xmlCommentEnd_.end());
-            if (it != stream_.end())
-            {
-                pos_ = it + xmlCommentEnd_.size();
-                return getNextToken(); //throw XmlParsingError
-            }
+            //skip XML comments
+            if (!startsWith("<!--"))
+                break;
+
+            const std::string_view xmlCommentEnd = "-->";
+            auto it = std::search(pos_ + strLength("<!--"), stream_.end(), xmlCommentEnd.begin(), xmlCommentEnd.end());
+            if (it == stream_.end())
+                break;
+            pos_ = it + xmlCommentEnd.size();
         }
 
-        for (auto it = tokens_.begin(); it != tokens_.end(); ++it)
-            if (startsWith(it->first))
-            {
-                pos_ += it->first.size();
-                return it->second;
-            }
+        switch (*pos_)
+        {
+            //*INDENT-OFF*
+            case '<':
+                if (startsWith("<?xml")) { pos_ += strLength("<?xml"); return Token::TK_DECL_BEGIN; }
+                if (startsWith("</"))    { pos_ += 2;                  return Token::TK_LESS_SLASH; }
+                ++pos_; return Token::TK_LESS;
+            case '?':
+                if (startsWith("?>")) { pos_ += 2; return Token::TK_DECL_END; }
+                break;
+            case '/':
+                if (startsWith("/>")) { pos_ += 2; return Token::TK_SLASH_GREATER; }
+                break;
+            case '>':  ++pos_; return Token::TK_GREATER;
+            case '=':  ++pos_; return Token::TK_EQUAL;
+            case '"':
+            case '\'': ++pos_; return Token::TK_QUOTE;
+            //*INDENT-ON*
+        }
 
         const auto itNameEnd = std::find_if(pos_, stream_.end(), [](char c)
         {
@@ -358,14 +376,14 @@ public:
         {
             const std::string_view name = makeStringView(pos_, itNameEnd);
             pos_ = itNameEnd;
-            return denormalize(name);
+            return name;
         }
 
         //unknown token
         throw XmlParsingError(posRow(), posCol());
     }
 
-    std::string extractElementValue()
+    std::string_view extractElementValue() //denormalize only if needed: structured elements discard their (whitespace) value
     {
         auto it = std::find_if(pos_, stream_.end(), [](char c)
         {
@@ -374,10 +392,10 @@ public:
         });
         const std::string_view output = makeStringView(pos_, it);
         pos_ = it;
-        return denormalize(output);
+        return output;
     }
 
-    std::string extractAttributeValue()
+    std::string_view extractAttributeValue()
     {
         auto it = std::find_if(pos_, stream_.end(), [](char c)
         {
@@ -388,7 +406,7 @@ public:
         });
         const std::string_view output = makeStringView(pos_, it);
         pos_ = it;
-        return denormalize(output);
+        return output;
     }
 
     size_t posRow() const //current row beginning with 0
@@ -415,37 +433,30 @@ private:
     Scanner           (const Scanner&) = delete;
     Scanner& operator=(const Scanner&) = delete;
 
-    bool startsWith(const std::string& prefix) const
+    bool startsWith(const std::string_view prefix) const
     {
         return zen::startsWith(makeStringView(pos_, stream_.end()), prefix);
     }
 
-    using TokenList = std::vector<std::pair<std::string, Token::Type>>;
-    const TokenList tokens_
-    {
-        {"<?xml", Token::TK_DECL_BEGIN   },
-        {"?>",    Token::TK_DECL_END     },
-        {"</",    Token::TK_LESS_SLASH   },
-        {"/>",    Token::TK_SLASH_GREATER},
-        {"<",     Token::TK_LESS         }, //evaluate after TK_DECL_BEGIN!
-        {">",     Token::TK_GREATER      },
-        {"=",     Token::TK_EQUAL        },
-        {"\"",    Token::TK_QUOTE        },
-        {"\'",    Token::TK_QUOTE        },
-    };
+    const std::string_view stream_;
+    std::string_view::const_iterator pos_;
+};
 
-    const std::string xmlCommentBegin_ = "<!--";
-    const std::string xmlCommentEnd_   = "-->";
 
-    const std::string stream_;
-    std::string::const_iterator pos_;
-};
+inline
+std::string denormalizeValue(const std::string_view& str)
+{
+    //fast path: most names and values contain neither entities nor CR
+    if (std::none_of(str.begin(), str.end(), [](char c) { return c == '&' || c == '\r'; }))
+        return std::string(str);
+    return denormalize(str);
+}
 
 
 class XmlParser
 {
 public:
-    explicit XmlParser(const std::string& stream) :
+    explicit XmlParser(std::string_view stream) :
         scn_(stream),
         tk_(scn_.getNextToken()) {} //throw XmlParsingError
 
@@ -460,12 +471,12 @@ public:
 
             while (token().type == Token::TK_NAME)
             {
-                std::string attribName = token().name;
+                const std::string& attribName = internName(token().name);
                 nextToken(); //throw XmlParsingError
 
                 consumeToken(Token::TK_EQUAL); //throw XmlParsingError
                 expectToken (Token::TK_QUOTE); //
-                std::string attribValue = scn_.extractAttributeValue();
+                std::string attribValue = denormalizeValue(scn_.extractAttributeValue());
                 nextToken(); //throw XmlParsingError
 
                 consumeToken(Token::TK_QUOTE); //throw XmlParsingError
@@ -502,7 +513,7 @@ private:
             nextToken(); //throw XmlParsingError
 
             expectToken(Token::TK_NAME); //throw XmlParsingError
-            const std::string elementName = token().name;
+            const std::string& elementName = internName(token().name);
             nextToken(); //throw XmlParsingError
 
             XmlElement& newElement = parent.addChild(elementName);
@@ -516,19 +527,19 @@ private:
             }
 
             expectToken(Token::TK_GREATER); //throw XmlParsingError
-            std::string elementValue = scn_.extractElementValue();
+            const std::string_view elementValue = scn_.extractElementValue();
             nextToken(); //throw XmlParsingError
 
             //no support for mixed-mode content
             if (token().type == Token::TK_LESS) //structure-element
                 parseChildElements(newElement);
             else                                //value-element
-                newElement.setValue(std::move(elementValue));
+                newElement.setValue(denormalizeValue(elementValue));
 
             consumeToken(Token::TK_LESS_SLASH); //throw XmlParsingError
 
             expectToken(Token::TK_NAME); //throw XmlParsingError
-            if (token().name != elementName)
+            if (&internName(token().name) != &elementName)
                 throw XmlParsingError(scn_.posRow(), scn_.posCol());
             nextToken(); //throw XmlParsingError
 
@@ -540,19 +551,32 @@ private:
     {
         while (token().type == Token::TK_NAME)
         {
-            const std::string attribName = token().name;
+            const std::string& attribName = internName(token().name);
             nextToken(); //throw XmlParsingError
 
             consumeToken(Token::TK_EQUAL); //throw XmlParsingError
             expectToken (Token::TK_QUOTE); //
-            std::string attribValue = scn_.extractAttributeValue();
+            std::string attribValue = denormalizeValue(scn_.extractAttributeValue());
             nextToken(); //throw XmlParsingError
 
             consumeToken(Token::TK_QUOTE); //throw XmlParsingError
-            element.setAttribute(attribName, attribValue);
+            element.setAttribute(attribName, std::move(attribValue));
         }
     }
 
+    //element and attribute names repeat a lot (e.g. thousands of <Pair>, <Item>): denormalize each raw name only once
+    const std::string& internName(std::string_view rawName)
+    {
+        auto it = rawNames_.find(rawName);
+        if (it == rawNames_.end())
+        {
+            const std::string name = denormalizeValue(rawName);
+            auto itName = names_.emplace(name).first; //distinct raw names may denormalize to the same name!
+            it = rawNames_.emplace(rawName, &*itName).first;
+        }
+        return *it->second;
+    }
+
     const Token& token() const { return tk_; }
 
     void nextToken() { tk_ = scn_.getNextToken(); } //throw XmlParsingError
@@ -571,6 +595,9 @@ private:
 
     Scanner scn_;
     Token tk_;
+
+    std::unordered_map<std::string_view, const std::string*> rawNames_; //raw name views point into the input stream
+    std::unordered_set<std::string> names_;                             //node-based: stable references
 };
 }
 